@@ -88,3 +88,23 @@ namespace xtl {
   }
 
 }
+
+namespace mch {
+
+  /// boost::any holds its value on the heap, so Match statements cannot get to
+  /// it by a fixed offset. Once the vtbl map found the statement's entry for
+  /// the pointer to type() of the subject, the type of the value is known and
+  /// it is accessed without comparing type_info again.
+  template <>
+  struct indirect_subject<boost::any>
+  {
+    static const bool value = true;
+
+    template <class T>
+    static T* get(boost::any* p) noexcept { return boost::unsafe_any_cast<T>(p); }
+
+    template <class T>
+    static const T* get(const boost::any* p) noexcept { return boost::unsafe_any_cast<T>(p); }
+  };
+
+}
@@ -32,7 +32,20 @@
 ///
 /// \file
 ///
-/// This file is a part of Mach7 library test suite.
+/// This file is a part of Mach7 library.
+///
+/// Adapts boost::variant to be a subject of Match statements from 
+/// type_switchN-patterns-xtl.hpp. The alternative held by a variant is its
+/// dynamic type, and a Match statement on a single variant keeps its jump 
+/// targets in an array indexed by which() of the subject, so subtyping is 
+/// resolved once per alternative and the statement then becomes a plain 
+/// switch on which() without any vtbl map lookup. Case clauses naming an 
+/// alternative check it with boost::get, while clauses naming a subtype of an
+/// alternative visit it.
+///
+/// \note An alternative held in heap backup of the variant, which boost::variant
+///       only resorts to when none of its types is nothrow default constructible
+///       and assignment throws, is not at the offset its jump target remembers.
 ///
 /// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
 ///
@@ -45,6 +58,8 @@
 #pragma once
 
 #include "boost/variant.hpp"
+#include "boost/mpl/contains.hpp"
+#include "boost/mpl/size.hpp"
 #include "../../type_switchN-patterns-xtl.hpp"
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -58,11 +73,13 @@ namespace boost
 #if XTL_SUPPORT(variadics)
     // Default implementation of vtbl_of grabs sizeof(intptr_t) bytes from the beginning
     // of the object, which on 64-bit machines is larger that size of variant's which member.
+    // Vtbl maps take 0 for a vacant entry and ignore the lowest bits, so the index
+    // is offset and shifted to look like an aligned vtbl-pointer.
     template <class... Ts>
-    inline std::intptr_t vtbl_of(const boost::variant<Ts...>* p) noexcept { return p->which(); }
+    inline std::intptr_t vtbl_of(const boost::variant<Ts...>* p) noexcept { return std::intptr_t(p->which() + 2) << XTL_IRRELEVANT_VTBL_BITS; }
 #else
     template <VARIANT_P(class Ts)>
-    inline std::intptr_t vtbl_of(const boost::variant<VARIANT_P(Ts)>* p) noexcept { return p->which(); }
+    inline std::intptr_t vtbl_of(const boost::variant<VARIANT_P(Ts)>* p) noexcept { return std::intptr_t(p->which() + 2) << XTL_IRRELEVANT_VTBL_BITS; }
 #endif
 }
 
@@ -123,37 +140,72 @@ namespace xtl
         }
     };
 
+    /// Whether T is exactly one of the alternatives of boost::variant V
+    template <class T, class V>
+    struct is_boost_alternative : std::integral_constant<bool, boost::mpl::contains<typename V::types, typename std::remove_const<T>::type>::value> {};
+
+    template <class T, class V>
+    inline T* subtype_dynamic_cast_boost_variant(V* pv, std::true_type) noexcept
+    {
+        return boost::get<typename std::remove_const<T>::type>(pv);
+    }
+
+    template <class T, class V>
+    inline T* subtype_dynamic_cast_boost_variant(V* pv, std::false_type) noexcept
+    {
+        is_subtype_visitor<T> visitor;
+        return boost::apply_visitor(visitor, *pv);
+    }
+
 #if XTL_SUPPORT(variadics)
     template <class T, class... Ts>
     inline typename std::enable_if<xtl::is_subtype<T, boost::variant<Ts...>>::value, T*>::type
     subtype_dynamic_cast_impl(target<T*>, boost::variant<Ts...>* pv) noexcept
     {
-        is_subtype_visitor<T> visitor;
-        return boost::apply_visitor(visitor, *pv);
+        return subtype_dynamic_cast_boost_variant<T>(pv, is_boost_alternative<T, boost::variant<Ts...>>());
     }
 
     template <class T, class... Ts>
     inline typename std::enable_if<xtl::is_subtype<T, boost::variant<Ts...>>::value, const T*>::type
     subtype_dynamic_cast_impl(target<const T*>, const boost::variant<Ts...>* pv) noexcept
     {
-        is_subtype_visitor<const T> visitor;
-        return boost::apply_visitor(visitor, *pv);
+        return subtype_dynamic_cast_boost_variant<const T>(pv, is_boost_alternative<T, boost::variant<Ts...>>());
     }
 #else
     template <class T, VARIANT_P(class Ts)>
     inline typename std::enable_if<xtl::is_subtype<T, boost::variant<VARIANT_P(Ts)>>::value, T*>::type
     subtype_dynamic_cast_impl(target<T*>, boost::variant<VARIANT_P(Ts)>* pv) noexcept
     {
-        is_subtype_visitor<T> visitor;
-        return boost::apply_visitor(visitor, *pv);
+        return subtype_dynamic_cast_boost_variant<T>(pv, is_boost_alternative<T, boost::variant<VARIANT_P(Ts)>>());
     }
 
     template <class T, VARIANT_P(class Ts)>
     inline typename std::enable_if<xtl::is_subtype<T, boost::variant<VARIANT_P(Ts)>>::value, const T*>::type
     subtype_dynamic_cast_impl(target<const T*>, const boost::variant<VARIANT_P(Ts)>* pv) noexcept
     {
-        is_subtype_visitor<const T> visitor;
-        return boost::apply_visitor(visitor, *pv);
+        return subtype_dynamic_cast_boost_variant<const T>(pv, is_boost_alternative<T, boost::variant<VARIANT_P(Ts)>>());
     }
 #endif
 }
+
+namespace mch
+{
+    /// Match statements on a single variant index their jump targets with which()
+#if XTL_SUPPORT(variadics)
+    template <class... Ts>
+    struct indexed_subject<boost::variant<Ts...>>
+    {
+        static const bool        value = true;
+        static const std::size_t size  = boost::mpl::size<typename boost::variant<Ts...>::types>::value;
+        static std::size_t index_of(const boost::variant<Ts...>* p) noexcept { return std::size_t(p->which()); }
+    };
+#else
+    template <VARIANT_P(class Ts)>
+    struct indexed_subject<boost::variant<VARIANT_P(Ts)>>
+    {
+        static const bool        value = true;
+        static const std::size_t size  = boost::mpl::size<typename boost::variant<VARIANT_P(Ts)>::types>::value;
+        static std::size_t index_of(const boost::variant<VARIANT_P(Ts)>* p) noexcept { return std::size_t(p->which()); }
+    };
+#endif
+}
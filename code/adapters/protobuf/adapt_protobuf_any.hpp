@@ -0,0 +1,164 @@
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library.
+///
+/// Adapts google::protobuf::Any to be a subject of Match statements from 
+/// type_switchN-patterns-xtl.hpp. The message packed into an Any is its 
+/// dynamic type, identified by the type URL. Type URLs are interned, so the 
+/// address of the canonical copy of the URL plays the role of a vtbl-pointer 
+/// and the vtbl map of a Match statement caches the clause for each URL it 
+/// has seen. Case clauses naming a message type check the URL with Is<T>() 
+/// only on a cache miss and bind to the message unpacked from the Any.
+///
+/// \code
+///     Match(any)
+///     {
+///         Case(C<google::protobuf::Duration>()) ... match0.seconds() ...
+///         Case(C<google::protobuf::StringValue>()) ...
+///         Otherwise() ... // Unknown type URL
+///     }
+///     EndMatch
+/// \endcode
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/xtl/
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+/// \note Unpacking parses the payload into an instance of T kept per thread 
+///       (and per type T), so a binding of a Case clause remains valid only 
+///       until the next Match statement on an Any holding T in the same thread.
+///       A payload that fails to parse binds to a default T.
+///
+
+#pragma once
+
+#include "../../type_switchN-patterns-xtl.hpp"
+#include <google/protobuf/any.pb.h>
+#include <string>
+#include <unordered_set>
+
+#if XTL_MULTI_THREADING
+    #if !XTL_SUPPORT(thread_local)
+        #error Matching google::protobuf::Any with XTL_MULTI_THREADING requires compiler support of thread_local storage duration
+    #endif
+    #include <mutex>
+#endif
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace mch
+{
+    /// Canonical copy of type URL, whose address is the same for all equal URLs
+    inline const std::string* interned_type_url(const std::string& url)
+    {
+        static std::unordered_set<std::string> urls; // Nodes never move, so addresses of elements are stable
+    #if XTL_MULTI_THREADING
+        static std::mutex mutex;
+        std::lock_guard<std::mutex> guard(mutex);
+    #endif
+        return &*urls.insert(url).first;
+    }
+
+    /// Message of type T packed into any, unpacked into an instance per thread
+    template <typename T>
+    inline T* unpacked(const google::protobuf::Any& any)
+    {
+    #if XTL_SUPPORT(thread_local)
+        static thread_local T message;
+    #else
+        static T message;
+    #endif
+
+        if (!any.UnpackTo(&message))
+            message.Clear();
+
+        return &message;
+    }
+}
+
+// NOTE: We declare vtbl_of in google::protobuf namespace because we want it to 
+//       be found via two-phase name lookup due to its argument google::protobuf::Any
+namespace google
+{
+    namespace protobuf
+    {
+        inline std::intptr_t vtbl_of(const Any* p) { return reinterpret_cast<std::intptr_t>(mch::interned_type_url(p->type_url())); }
+    }
+}
+
+namespace xtl
+{
+    template <>
+    struct is_poly_morphic<google::protobuf::Any>
+    {
+        static const bool value = true;
+    };
+
+    /// Any message other than Any itself can be packed into an Any
+    template <class S>
+    struct is_subtype<S, google::protobuf::Any, typename std::enable_if<!std::is_base_of<google::protobuf::Any,S>::value>::type>
+    {
+        static const bool value = std::is_base_of<google::protobuf::Message,S>::value;
+    };
+
+    template <class T>
+    inline typename std::enable_if<xtl::is_subtype<T,google::protobuf::Any>::value, const T*>::type
+    subtype_dynamic_cast_impl(target<const T*>, const google::protobuf::Any* p)
+    {
+        return p->Is<T>() ? mch::unpacked<T>(*p) : nullptr;
+    }
+}
+
+namespace mch
+{
+    /// The message is not stored in the Any, so once the vtbl map found the 
+    /// entry of the statement for the type URL of the subject, the type of 
+    /// the message is known and it is unpacked without checking the URL again.
+    template <>
+    struct indirect_subject<google::protobuf::Any>
+    {
+        static const bool value = true;
+
+        template <class T>
+        static T* get(google::protobuf::Any* p) { return unpacked<T>(*p); }
+
+        template <class T>
+        static const T* get(const google::protobuf::Any* p) { return unpacked<T>(*p); }
+    };
+}
@@ -0,0 +1,236 @@
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library.
+///
+/// Adapts oneof fields of Protocol Buffers messages to be subjects of Match 
+/// statements from type_switchN-patterns-xtl.hpp. Generated code does not 
+/// give a oneof a type of its own, so the field is described by mch::oneof, a
+/// view over the message naming its generated *_case() accessor and the 
+/// accessors of its alternatives. The field number returned by *_case() is 
+/// the dynamic type of the view, and a Match statement on a single view keeps
+/// its jump targets in an array indexed by it, so after seeing each 
+/// alternative once it becomes a plain switch on *_case() without any vtbl map
+/// lookup, while Case clauses bind to the results of the generated accessors.
+///
+/// The adapter relies only on the conventions of generated code and does not
+/// include any Protocol Buffers headers.
+///
+/// \code
+///     typedef mch::oneof<Event, Event::KindCase, &Event::kind_case,
+///                 mch::oneof_alternative<Event, Event::kClick, Click,       &Event::click>,
+///                 mch::oneof_alternative<Event, Event::kText,  std::string, &Event::text>,
+///                 mch::oneof_scalar     <Event, Event::kKey,   int32_t,     &Event::key>
+///             > event_kind;
+///
+///     Match(event_kind(event))
+///     {
+///         Case(C<Click>(x,y))       ...
+///         Case(C<std::string>())    ... match0 ...
+///         Case(C<int32_t>(k))       ...
+///         Otherwise()               ... // Not set
+///     }
+///     EndMatch
+/// \endcode
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/xtl/
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+/// \note Alternatives are told apart by their types, so a oneof with two 
+///       alternatives of the same type can only name one of them.
+///
+
+#pragma once
+
+#include "../../type_switchN-patterns-xtl.hpp"
+#include <cstdint>
+#include <new>
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace mch
+{
+    /// Alternative with field number N of a oneof of message M, whose generated
+    /// accessor Get returns a const reference to T, i.e. a message or a string.
+    template <typename M, int N, typename T, const T& (M::*Get)() const>
+    struct oneof_alternative
+    {
+        typedef T type;
+        static const int number = N;
+        static const T* get(const M& m, void*) noexcept { return &(m.*Get)(); }
+    };
+
+    /// Alternative with field number N of a oneof of message M, whose generated
+    /// accessor Get returns a scalar T by value. The value is copied into the 
+    /// view for Case clauses to bind to it.
+    template <typename M, int N, typename T, T (M::*Get)() const>
+    struct oneof_scalar
+    {
+        static_assert(sizeof(T) <= sizeof(std::int64_t), "Scalar alternatives of a oneof are at most 64 bits");
+        typedef T type;
+        static const int number = N;
+        static const T* get(const M& m, void* storage) noexcept { return new(storage) T((m.*Get)()); }
+    };
+
+    /// The first of alternatives As whose type is T or void when there is none
+    template <typename T, typename... As>
+    struct oneof_alternative_for
+    {
+        typedef void type;
+    };
+
+    template <typename T, typename A, typename... As>
+    struct oneof_alternative_for<T,A,As...>
+    {
+        typedef typename std::conditional<
+                    std::is_same<T,typename A::type>::value,
+                    A,
+                    typename oneof_alternative_for<T,As...>::type
+                >::type type;
+    };
+
+    /// The largest field number among alternatives As
+    template <typename... As>
+    struct oneof_max_number
+    {
+        static const int value = 0;
+    };
+
+    template <typename A, typename... As>
+    struct oneof_max_number<A,As...>
+    {
+        static const int value = A::number > oneof_max_number<As...>::value ? A::number : oneof_max_number<As...>::value;
+    };
+
+    /// View of the oneof field of message M, whose generated accessor Case 
+    /// returns the field number of the alternative set (0 when none) and whose
+    /// alternatives are described by As with mch::oneof_alternative and 
+    /// mch::oneof_scalar. Alternatives not listed in As behave as not set.
+    template <typename M, typename E, E (M::*Case)() const, typename... As>
+    class oneof
+    {
+    public:
+
+        explicit oneof(const M& m) noexcept : msg(&m) {}
+
+        /// The message whose field is viewed
+        const M& message() const noexcept { return *msg; }
+
+        /// Field number of the alternative set or 0 when the field is not set
+        int number() const noexcept { return int((msg->*Case)()); }
+
+        /// Alternative of type T when it is set, nullptr otherwise
+        template <typename T>
+        const T* get() const noexcept
+        {
+            typedef typename oneof_alternative_for<T,As...>::type alternative;
+            return number() == alternative::number ? unchecked<T>() : nullptr;
+        }
+
+        /// Alternative of type T, which must be set
+        template <typename T>
+        const T* unchecked() const noexcept
+        {
+            return oneof_alternative_for<T,As...>::type::get(*msg, &storage);
+        }
+
+    private:
+
+        const M* msg;                           ///< Message whose field is viewed
+        mutable union { std::int64_t i; double d; } storage; ///< Copy of the scalar alternative bound by a Case clause
+    };
+
+    /// Views are C++-non-polymorphic, so the dynamic type is taken from the 
+    /// field number, offset and shifted to look like an aligned vtbl-pointer.
+    template <typename M, typename E, E (M::*Case)() const, typename... As>
+    inline std::intptr_t vtbl_of(const oneof<M,E,Case,As...>* p) noexcept { return std::intptr_t(p->number() + 2) << XTL_IRRELEVANT_VTBL_BITS; }
+}
+
+namespace xtl
+{
+    template <typename M, typename E, E (M::*Case)() const, typename... As>
+    struct is_poly_morphic<mch::oneof<M,E,Case,As...>>
+    {
+        static const bool value = true;
+    };
+
+    template <typename S, typename M, typename E, E (M::*Case)() const, typename... As>
+    struct is_subtype<S,mch::oneof<M,E,Case,As...>>
+    {
+        static const bool value = !std::is_void<typename mch::oneof_alternative_for<S,As...>::type>::value;
+    };
+
+    template <typename T, typename M, typename E, E (M::*Case)() const, typename... As>
+    inline typename std::enable_if<xtl::is_subtype<T,mch::oneof<M,E,Case,As...>>::value, const T*>::type
+    subtype_dynamic_cast_impl(target<const T*>, const mch::oneof<M,E,Case,As...>* p) noexcept
+    {
+        return p->template get<T>();
+    }
+}
+
+namespace mch
+{
+    /// The alternatives are not stored in the view, so Match statements get to
+    /// them through the generated accessors once the jump target was found.
+    /// Generated code only gives const access to them, so the bindings of a
+    /// Case clause on a view that is not const must not be modified either.
+    template <typename M, typename E, E (M::*Case)() const, typename... As>
+    struct indirect_subject<oneof<M,E,Case,As...>>
+    {
+        static const bool value = true;
+
+        template <typename T>
+        static T* get(oneof<M,E,Case,As...>* p) noexcept { return const_cast<T*>(p->template unchecked<T>()); }
+
+        template <typename T>
+        static const T* get(const oneof<M,E,Case,As...>* p) noexcept { return p->template unchecked<T>(); }
+    };
+
+    /// Match statements on a single view index their jump targets with the 
+    /// field number, as long as the numbers of the alternatives are small 
+    /// enough for an array. Unlisted alternatives with larger numbers share 
+    /// entry 0 with the field not being set.
+    template <typename M, typename E, E (M::*Case)() const, typename... As>
+    struct indexed_subject<oneof<M,E,Case,As...>>
+    {
+        static const bool        value = oneof_max_number<As...>::value < 1024;
+        static const std::size_t size  = oneof_max_number<As...>::value + 1;
+        static std::size_t index_of(const oneof<M,E,Case,As...>* p) noexcept { std::size_t n = p->number(); return n < size ? n : 0; }
+    };
+}
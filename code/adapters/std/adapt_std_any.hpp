@@ -0,0 +1,127 @@
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library.
+///
+/// Adapts std::any to be a subject of Match statements from 
+/// type_switchN-patterns-xtl.hpp. The type of the value held by an any is its
+/// dynamic type, and the address of its std::type_info plays the role of a 
+/// vtbl-pointer, so the vtbl map of a Match statement caches the clause for 
+/// each type it has seen and a hit costs comparing that address. Case clauses
+/// naming a type check it with std::any_cast only on a cache miss.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/xtl/
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+/// \note Requires C++17.
+/// \note Like boost::any, this relies on std::type_info objects being unique 
+///       per type, which may not hold across shared libraries on some platforms.
+///
+
+#pragma once
+
+#include "../../type_switchN-patterns-xtl.hpp"
+
+#if !XTL_SUPPORT(any)
+    #error std::any is not supported by this compiler or standard library
+#endif
+
+#include <any>
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// NOTE: We declare vtbl_of in std namespace because we want it to be found 
+//       via two-phase name lookup due to its argument std::any
+namespace std
+{
+    inline std::intptr_t vtbl_of(const std::any* p) noexcept { return reinterpret_cast<std::intptr_t>(&p->type()); }
+}
+
+namespace xtl
+{
+    template <>
+    struct is_poly_morphic<std::any>
+    {
+        static const bool value = true;
+    };
+
+    /// A value of any type other than std::any itself can be held by std::any
+    template <class S>
+    struct is_subtype<S, std::any, typename std::enable_if<!std::is_same<typename std::remove_cv<S>::type, std::any>::value>::type>
+    {
+        static const bool value = true;
+    };
+
+    template <class S>
+    inline std::any subtype_cast_impl(target<std::any>, const S& s)
+    {
+        return std::any(s);
+    }
+
+    template <class T>
+    inline T* subtype_dynamic_cast_impl(target<T*>, std::any* p) noexcept
+    {
+        return std::any_cast<T>(p);
+    }
+
+    template <class T>
+    inline const T* subtype_dynamic_cast_impl(target<const T*>, const std::any* p) noexcept
+    {
+        return std::any_cast<T>(p);
+    }
+}
+
+namespace mch
+{
+    /// std::any may hold its value on the heap, so Match statements cannot get
+    /// to it by a fixed offset. Once the vtbl map found the entry of the 
+    /// statement for the type of the subject, the value is accessed with 
+    /// std::any_cast, whose check of the type the standard does not let skip.
+    template <>
+    struct indirect_subject<std::any>
+    {
+        static const bool value = true;
+
+        template <class T>
+        static T* get(std::any* p) noexcept { return std::any_cast<T>(p); }
+
+        template <class T>
+        static const T* get(const std::any* p) noexcept { return std::any_cast<T>(p); }
+    };
+}
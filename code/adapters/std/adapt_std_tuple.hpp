@@ -0,0 +1,71 @@
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library.
+///
+/// Adapts std::tuple, std::pair and std::array to be decomposed by constructor
+/// patterns without writing their bindings: the I-th sub-pattern is applied to
+/// the element taken with std::get<I>, \see mch::tuple_bindings.
+/// Example: Case(C<std::pair<int,double>>(1, d)) 
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+/// \note Programs that include this file cannot have their own bindings of 
+///       these types with the default layout.
+///
+
+#pragma once
+
+#include "../../patterns/bindings.hpp"
+#include <array>
+#include <tuple>
+#include <utility>
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace mch
+{
+    template <class... Ts>
+    struct bindings<std::tuple<Ts...>> : tuple_bindings<std::tuple<Ts...>> {};
+
+    template <class T1, class T2>
+    struct bindings<std::pair<T1,T2>> : tuple_bindings<std::pair<T1,T2>> {};
+
+    template <class T, std::size_t N>
+    struct bindings<std::array<T,N>> : tuple_bindings<std::array<T,N>> {};
+}
@@ -0,0 +1,167 @@
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library.
+///
+/// Adapts std::variant to be a subject of Match statements from 
+/// type_switchN-patterns-xtl.hpp. The alternative held by a variant is its
+/// dynamic type, and a Match statement on a single variant keeps its jump 
+/// targets in an array indexed by index() of the subject, so after seeing 
+/// each alternative once it becomes a plain switch on index() without any 
+/// vtbl map lookup. Case clauses naming an alternative check it with 
+/// std::get_if, while clauses naming a subtype of an alternative visit it.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/xtl/
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+/// \note Requires C++17.
+///
+
+#pragma once
+
+#include "../../type_switchN-patterns-xtl.hpp"
+
+#if !XTL_SUPPORT(variant)
+    #error std::variant is not supported by this compiler or standard library
+#endif
+
+#include <variant>
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// NOTE: We declare vtbl_of in std namespace because we want it to be found 
+//       via two-phase name lookup due to its argument std::variant
+namespace std
+{
+    // Default implementation of vtbl_of grabs sizeof(intptr_t) bytes from the beginning
+    // of the object, which is the storage of the alternative and not its index.
+    // Vtbl maps take 0 for a vacant entry and ignore the lowest bits, so the index
+    // is offset and shifted to look like an aligned vtbl-pointer, even for variant_npos.
+    template <class... Ts>
+    inline std::intptr_t vtbl_of(const std::variant<Ts...>* p) noexcept { return std::intptr_t(p->index() + 2) << XTL_IRRELEVANT_VTBL_BITS; }
+}
+
+namespace xtl
+{
+    template <class... Ts>
+    struct is_poly_morphic<std::variant<Ts...>>
+    {
+        static const bool value = true;
+    };
+
+    template <class S, class T, class... Ts>
+    struct is_subtype<S,std::variant<T,Ts...>>
+    {
+        static const bool value = is_subtype<S,T>::value
+                               || is_subtype<S,std::variant<Ts...>>::value;
+    };
+
+    template <class S, class T>
+    struct is_subtype<S,std::variant<T>> : is_subtype<S,T> {};
+
+    template <class... Ts, class S>
+    inline std::variant<Ts...> subtype_cast_impl(target<std::variant<Ts...>>, const S& s)
+    {
+        return std::variant<Ts...>(s); // FIX: Actually this should be std::variant<Ts...>(xtl::subtype_cast<Ti>(s)) where S <: Ti
+    }
+
+    /// Whether T is exactly one of the alternatives Ts
+    template <class T, class... Ts>
+    struct is_alternative : std::integral_constant<bool, (std::is_same<T,Ts>::value || ...)> {};
+
+    template <typename T>
+    struct is_subtype_std_visitor
+    {
+        template <typename S>
+        inline T* operator()(S& s) const noexcept
+        {
+            return xtl::subtype_dynamic_cast<T*>(&s);
+        }
+    };
+
+    template <class T, class... Ts>
+    inline T* subtype_dynamic_cast_std_variant(std::variant<Ts...>* pv, std::true_type) noexcept
+    {
+        return std::get_if<T>(pv);
+    }
+
+    template <class T, class... Ts>
+    inline T* subtype_dynamic_cast_std_variant(std::variant<Ts...>* pv, std::false_type) noexcept
+    {
+        return pv->valueless_by_exception() ? nullptr : std::visit(is_subtype_std_visitor<T>(), *pv);
+    }
+
+    template <class T, class... Ts>
+    inline const T* subtype_dynamic_cast_std_variant(const std::variant<Ts...>* pv, std::true_type) noexcept
+    {
+        return std::get_if<T>(pv);
+    }
+
+    template <class T, class... Ts>
+    inline const T* subtype_dynamic_cast_std_variant(const std::variant<Ts...>* pv, std::false_type) noexcept
+    {
+        return pv->valueless_by_exception() ? nullptr : std::visit(is_subtype_std_visitor<const T>(), *pv);
+    }
+
+    template <class T, class... Ts>
+    inline typename std::enable_if<xtl::is_subtype<T, std::variant<Ts...>>::value, T*>::type
+    subtype_dynamic_cast_impl(target<T*>, std::variant<Ts...>* pv) noexcept
+    {
+        return subtype_dynamic_cast_std_variant<T>(pv, is_alternative<T,Ts...>());
+    }
+
+    template <class T, class... Ts>
+    inline typename std::enable_if<xtl::is_subtype<T, std::variant<Ts...>>::value, const T*>::type
+    subtype_dynamic_cast_impl(target<const T*>, const std::variant<Ts...>* pv) noexcept
+    {
+        return subtype_dynamic_cast_std_variant<T>(pv, is_alternative<T,Ts...>());
+    }
+}
+
+namespace mch
+{
+    /// Match statements on a single variant index their jump targets with 
+    /// index() + 1, so that a variant valueless by exception gets entry 0.
+    template <class... Ts>
+    struct indexed_subject<std::variant<Ts...>>
+    {
+        static const bool        value = true;
+        static const std::size_t size  = sizeof...(Ts) + 1;
+        static std::size_t index_of(const std::variant<Ts...>* p) noexcept { return p->index() + 1; }
+    };
+}
@@ -0,0 +1,281 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// \file
+///
+/// This file defines class adt<Ts...> - a closed algebraic data type, whose 
+/// values are one of the alternatives Ts kept inline next to a tag that tells
+/// which. MatchK on it switches on the tag, so matching needs neither a vtbl 
+/// lookup nor a heap allocation per value.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#pragma once
+
+// --------------------[ Design Notes ]--------------------
+// - The tag is the first member, so the kind selector reads the same bytes a 
+//   vtbl-based Match would have read for the vtbl-pointer, and it is the index
+//   of the alternative in Ts. The kind values of the alternatives are thus 
+//   derived from Ts and do not need KV in their bindings, \see kind_value_of.
+// - Bindings of the alternatives themselves are the user's, e.g. with Members
+//   or aggregate_bindings, since Mach7 cannot name their data members in C++11.
+// - Recursive types refer to their subterms through pointers to the adt, e.g.
+//   struct Add { const Expr* e1; const Expr* e2; }; with the nodes allocated 
+//   in arena<Expr>. The adt is trivially destructible when all alternatives 
+//   are, in which case the arena does not record its destructor either.
+// - Alternatives are copied, moved and destroyed through tables of functions 
+//   indexed by the tag. Assignment that changes the alternative destroys the
+//   old one and move-constructs the new one, so it expects alternatives whose
+//   move constructors do not throw.
+//------------------------------------------------------------------------------
+
+#include "config.hpp"
+#include "patterns/bindings.hpp"
+#include <cstddef>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace mch ///< Mach7 library namespace
+{
+
+//------------------------------------------------------------------------------
+
+/// Index of T among Ts or sizeof...(Ts) when T is not one of them
+template <typename T, typename... Ts> struct adt_index;
+template <typename T>                             struct adt_index<T>           { enum : size_t { value = 0 }; };
+template <typename T, typename... Ts>             struct adt_index<T,T,Ts...>   { enum : size_t { value = 0 }; };
+template <typename T, typename U, typename... Ts> struct adt_index<T,U,Ts...>   { enum : size_t { value = 1 + adt_index<T,Ts...>::value }; };
+
+/// The largest of Ns
+template <size_t... Ns> struct adt_max;
+template <>                        struct adt_max<>        { enum : size_t { value = 1 }; };
+template <size_t N, size_t... Ns>  struct adt_max<N,Ns...> { enum : size_t { value = N > size_t(adt_max<Ns...>::value) ? N : size_t(adt_max<Ns...>::value) }; };
+
+/// Whether all of Bs are true
+template <bool... Bs> struct adt_all;
+template <>                    struct adt_all<>        { enum { value = true }; };
+template <bool B, bool... Bs>  struct adt_all<B,Bs...> { enum { value = B && adt_all<Bs...>::value }; };
+
+//------------------------------------------------------------------------------
+
+/// Tag and inline storage of adt<Ts...> with a trivial destructor when all Ts
+/// are trivially destructible.
+template <bool trivial, typename... Ts>
+struct adt_storage
+{
+    /// Type of the tag: the smallest unsigned type that can number alternatives
+    typedef typename std::conditional<(sizeof...(Ts) < 256), unsigned char, unsigned short>::type kind_type;
+
+    kind_type m_kind; ///< Index of the alternative kept in m_storage
+    typename std::aligned_storage<adt_max<sizeof(Ts)...>::value, adt_max<std::alignment_of<Ts>::value...>::value>::type m_storage;
+
+    void destroy() noexcept {}
+};
+
+template <typename... Ts>
+struct adt_storage<false,Ts...> : adt_storage<true,Ts...>
+{
+   ~adt_storage() { destroy(); }
+
+    void destroy() noexcept
+    {
+        static void (* const table[])(void*) = { &destroy_as<Ts>... };
+        table[this->m_kind](&this->m_storage);
+    }
+
+    template <typename T>
+    static void destroy_as(void* p) noexcept { static_cast<T*>(p)->~T(); }
+};
+
+//------------------------------------------------------------------------------
+
+/// Closed algebraic data type, whose value is one of Ts kept inline
+template <typename... Ts>
+class adt : public adt_storage<adt_all<std::is_trivially_destructible<Ts>::value...>::value, Ts...>
+{
+    static_assert(sizeof...(Ts) > 0, "Algebraic data type should have at least one alternative");
+
+    typedef adt_storage<adt_all<std::is_trivially_destructible<Ts>::value...>::value, Ts...> base_type;
+
+    /// Limits converting constructor to alternatives, so that it does not take over copying of adt
+    template <typename T>
+    using alternative = typename std::enable_if<(adt_index<typename std::decay<T>::type,Ts...>::value < sizeof...(Ts))>::type;
+
+public:
+
+    typedef typename base_type::kind_type kind_type;
+
+    /// Kind of values holding alternative T
+    template <typename T>
+    static constexpr kind_type kind_of() noexcept
+    {
+        static_assert(adt_index<T,Ts...>::value < sizeof...(Ts), "Type is not an alternative of this algebraic data type");
+        return kind_type(adt_index<T,Ts...>::value);
+    }
+
+    /// Holds default-constructed first alternative
+    adt() { construct<typename std::tuple_element<0,std::tuple<Ts...>>::type>(); }
+
+    /// Holds a copy of the alternative t
+    template <typename T, typename = alternative<T>>
+    adt(T&& t) { construct<typename std::decay<T>::type>(std::forward<T>(t)); }
+
+    adt(const adt& other) { copy_from(other); }
+    adt(adt&& other)      { move_from(std::move(other)); }
+
+    adt& operator=(const adt& other)
+    {
+        if (this != &other)
+        {
+            if (this->m_kind == other.m_kind)
+            {
+                static void (* const table[])(void*, const void*) = { &copy_assign_as<Ts>... };
+                table[this->m_kind](&this->m_storage, &other.m_storage);
+            }
+            else
+                *this = adt(other);
+        }
+
+        return *this;
+    }
+
+    adt& operator=(adt&& other)
+    {
+        if (this != &other)
+        {
+            if (this->m_kind == other.m_kind)
+            {
+                static void (* const table[])(void*, void*) = { &move_assign_as<Ts>... };
+                table[this->m_kind](&this->m_storage, &other.m_storage);
+            }
+            else
+            {
+                this->destroy();
+                move_from(std::move(other));
+            }
+        }
+
+        return *this;
+    }
+
+    /// Replaces the held alternative with T constructed from args
+    template <typename T, typename... A>
+    T& emplace(A&&... args)
+    {
+        static_assert(adt_index<T,Ts...>::value < sizeof...(Ts), "Type is not an alternative of this algebraic data type");
+        this->destroy();
+        return *construct<T>(std::forward<A>(args)...);
+    }
+
+    /// Index of the held alternative in Ts
+    kind_type kind() const noexcept { return this->m_kind; }
+
+    /// Whether the held alternative is T
+    template <typename T>
+    bool is() const noexcept { return this->m_kind == kind_of<T>(); }
+
+    /// Held alternative T or nullptr when the value holds another one
+    template <typename T> const T* get_if() const noexcept { return is<T>() ? storage_as<T>() : nullptr; }
+    template <typename T>       T* get_if()       noexcept { return is<T>() ? storage_as<T>() : nullptr; }
+
+    /// Held alternative T, which has to be the one held
+    template <typename T> const T& get() const noexcept { XTL_ASSERT(is<T>()); return *storage_as<T>(); }
+    template <typename T>       T& get()       noexcept { XTL_ASSERT(is<T>()); return *storage_as<T>(); }
+
+    /// Held alternative as T without checking the tag \see stat_cast
+    template <typename T> const T* storage_as() const noexcept { return reinterpret_cast<const T*>(&this->m_storage); }
+    template <typename T>       T* storage_as()       noexcept { return reinterpret_cast<      T*>(&this->m_storage); }
+
+private:
+
+    template <typename T, typename... A>
+    T* construct(A&&... args)
+    {
+        T* p = make<T>(typename std::is_constructible<T,A...>::type(), std::forward<A>(args)...);
+        this->m_kind = kind_of<T>(); // Set after the constructor succeeded, so that a throwing one leaves nothing to destroy
+        return p;
+    }
+
+    /// Aggregates without a constructor taking args are initialized from them member-wise
+    template <typename T, typename... A> T* make(std::true_type,  A&&... args) { return new(&this->m_storage) T(std::forward<A>(args)...); }
+    template <typename T, typename... A> T* make(std::false_type, A&&... args) { return new(&this->m_storage) T{std::forward<A>(args)...}; }
+
+    void copy_from(const adt& other)
+    {
+        static void (* const table[])(void*, const void*) = { &copy_as<Ts>... };
+        table[other.m_kind](&this->m_storage, &other.m_storage);
+        this->m_kind = other.m_kind;
+    }
+
+    void move_from(adt&& other)
+    {
+        static void (* const table[])(void*, void*) = { &move_as<Ts>... };
+        table[other.m_kind](&this->m_storage, &other.m_storage);
+        this->m_kind = other.m_kind;
+    }
+
+    template <typename T> static void copy_as(void* p, const void* q)        { new(p) T(*static_cast<const T*>(q)); }
+    template <typename T> static void move_as(void* p, void* q)              { new(p) T(std::move(*static_cast<T*>(q))); }
+    template <typename T> static void copy_assign_as(void* p, const void* q) { *static_cast<T*>(p) = *static_cast<const T*>(q); }
+    template <typename T> static void move_assign_as(void* p, void* q)       { *static_cast<T*>(p) = std::move(*static_cast<T*>(q)); }
+};
+
+//------------------------------------------------------------------------------
+
+/// The tag of adt is its kind selector, so MatchK switches on it
+template <typename... Ts>
+struct bindings<adt<Ts...>> { KS(adt<Ts...>::m_kind); };
+
+/// Kind value of alternative C of adt<Ts...> is its index in Ts
+template <typename... Ts, typename C>
+struct kind_value_of<adt<Ts...>,C>
+{
+    static_assert(adt_index<C,Ts...>::value < sizeof...(Ts), "Case type is not an alternative of the algebraic data type being matched");
+    enum { value = adt_index<C,Ts...>::value };
+};
+
+/// Alternative held by adt, which MatchK had established from the tag
+template <typename T, typename... Ts> inline const T* stat_cast(const adt<Ts...>* p) noexcept { return p->template storage_as<T>(); }
+template <typename T, typename... Ts> inline       T* stat_cast(      adt<Ts...>* p) noexcept { return p->template storage_as<T>(); }
+
+//------------------------------------------------------------------------------
+
+} // of namespace mch
@@ -0,0 +1,197 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file defines class arena<T> that allocates objects of classes derived
+/// from T one after another in large chunks of memory, so that a traversal of
+/// them in the order of their creation reads consecutive memory.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#pragma once
+
+// --------------------[ Design Notes ]--------------------
+// - Nodes of trees matched by Match statements are typically small objects 
+//   whose vtbl-pointer is the first thing read from them. Allocated one by one
+//   with new, they get scattered over the heap between unrelated allocations,
+//   so every Match on them is likely to start with a cache miss on the object
+//   before vtbl map is even consulted.
+// - The arena bumps a pointer in the current chunk, which keeps each object 
+//   right after the previously created one and costs no header per object.
+// - Objects are destroyed with the arena, not individually. Destructors are 
+//   only recorded for classes that are not trivially destructible, and they 
+//   are run in the reverse order of creation.
+// - Chunks are never reused by another arena, so a program building several
+//   trees can keep each of them compact by giving every tree its own arena.
+// - An observer, e.g. an instance_index, can be told of every object made in
+//   the arena and of the arena being cleared, so that it knows all of the 
+//   objects without the arena keeping a list of them.
+//------------------------------------------------------------------------------
+
+#include "config.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace mch ///< Mach7 library namespace
+{
+
+//------------------------------------------------------------------------------
+
+/// Receiver of notifications about objects of an arena<T> \see arena::observe
+template <typename T>
+struct arena_observer
+{
+    virtual ~arena_observer() {}
+    virtual void made(const T* object) = 0; ///< An object was made in the arena
+    virtual void cleared() = 0;             ///< All objects of the arena were destroyed
+};
+
+//------------------------------------------------------------------------------
+
+/// Memory of objects of classes derived from T (or of T itself), which live as
+/// long as the arena does.
+template <typename T>
+class arena
+{
+public:
+
+    /// Creates an empty arena that will get memory in chunks of at least size bytes
+    explicit arena(size_t chunk_size = XTL_ARENA_CHUNK_SIZE) : m_chunks(0), m_next(0), m_left(0), m_chunk_size(chunk_size), m_count(0), m_observer(0) {}
+   ~arena() { clear(); }
+
+    /// Creates an object of class D with given arguments of its constructor
+    template <typename D, typename... A>
+    D* make(A&&... args)
+    {
+        static_assert(std::is_base_of<T,D>::value || std::is_same<T,D>::value, "Objects allocated in arena<T> should be of class T or derived from it");
+
+        void* p = allocate(sizeof(D), std::alignment_of<D>::value);
+        D*    d = new(p) D(std::forward<A>(args)...); // Memory is reclaimed with the chunk if this throws
+
+        if (!std::is_trivially_destructible<D>::value)
+            m_destructors.push_back(destructor(d, &destroy<D>));
+
+        ++m_count;
+
+        if (m_observer)
+            m_observer->made(d);
+
+        return d;
+    }
+
+    /// Destroys all the objects in the arena and releases its memory
+    void clear()
+    {
+        if (m_observer && m_count)
+            m_observer->cleared();
+
+        for (size_t i = m_destructors.size(); i-- > 0; )
+            m_destructors[i].second(m_destructors[i].first);
+
+        m_destructors.clear();
+
+        while (m_chunks)
+        {
+            void* p = m_chunks;
+            m_chunks = *static_cast<void**>(p);
+            ::operator delete(p);
+        }
+
+        m_next  = 0;
+        m_left  = 0;
+        m_count = 0;
+    }
+
+    /// Number of objects made in the arena since it was created or cleared
+    size_t size() const { return m_count; }
+
+    /// Tells observer about objects made from now on and about the arena being
+    /// cleared, including on its destruction. A null observer stops that.
+    void observe(arena_observer<T>* observer) { m_observer = observer; }
+
+private:
+
+    arena(const arena&);            ///< No copy constructor
+    arena& operator=(const arena&); ///< No assignment operator
+
+    typedef std::pair<void*, void (*)(void*)> destructor; ///< Object and a function to destroy it
+
+    template <typename D>
+    static void destroy(void* p) { static_cast<D*>(p)->~D(); }
+
+    void* allocate(size_t size, size_t alignment)
+    {
+        size_t skip = (alignment - uintptr_t(m_next) % alignment) % alignment;
+
+        if (size + skip > m_left)
+        {
+            // Chunks are linked through their first bytes, which are followed by objects
+            const size_t header = sizeof(void*) + alignment;
+            const size_t chunk  = size + header > m_chunk_size ? size + header : m_chunk_size;
+            char*        p      = static_cast<char*>(::operator new(chunk));
+
+            *reinterpret_cast<void**>(p) = m_chunks;
+            m_chunks = p;
+            m_next   = p + sizeof(void*);
+            m_left   = chunk - sizeof(void*);
+            skip     = (alignment - uintptr_t(m_next) % alignment) % alignment;
+        }
+
+        void* result = m_next + skip;
+        m_next += skip + size;
+        m_left -= skip + size;
+        return result;
+    }
+
+    void*                   m_chunks;      ///< The most recently allocated chunk, which points to the previous one
+    char*                   m_next;        ///< Next free byte in the most recent chunk
+    size_t                  m_left;        ///< Number of free bytes left in the most recent chunk
+    size_t                  m_chunk_size;  ///< Smallest size of chunks requested from the heap
+    size_t                  m_count;       ///< Number of objects made in the arena
+    arena_observer<T>*      m_observer;    ///< Receiver of notifications about objects of the arena or null
+    std::vector<destructor> m_destructors; ///< Objects that need their destructors called in order of creation
+};
+
+//------------------------------------------------------------------------------
+
+} // of namespace mch
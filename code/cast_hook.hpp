@@ -0,0 +1,205 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file defines mch::cast_hook through which Match statements and 
+/// memoized_cast test the dynamic type of subjects in builds without RTTI,
+/// \see #XTL_RTTI. Only misses of vtbl maps test types, so hits cost the same
+/// with and without RTTI. By default a test for T on a subject of static type
+/// S is resolved in the first way that applies:
+/// - T is a base of S, which needs no test at all;
+/// - T defines static bool classof(const S*) in the style of LLVM;
+/// - S has a #class_hierarchy declared whose classes have their kinds given
+///   with KS in #bindings of S and KV in #bindings of each of them.
+/// For other pairs users specialize the trait themselves:
+/// \code
+/// namespace mch
+/// {
+///     template <> struct cast_hook<Circle,Shape>
+///     {
+///         static const Circle* go(const Shape* s) noexcept { return s->is_circle() ? static_cast<const Circle*>(s) : nullptr; }
+///     };
+/// }
+/// \endcode
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#pragma once
+
+#include "config.hpp"
+#include <memory>            // std::addressof
+#include <type_traits>
+#include <typeinfo>          // std::bad_cast
+#include <utility>
+
+#if !XTL_RTTI
+#include "hierarchy.hpp"     // Closed hierarchies with kinds
+#endif
+
+namespace mch ///< Mach7 library namespace
+{
+
+//------------------------------------------------------------------------------
+
+#if !XTL_RTTI
+
+/// Whether T defines static bool classof(const S*)
+template <typename T, typename S>
+struct has_classof
+{
+private:
+    template <typename U> static auto test(int) -> decltype(U::classof(std::declval<const S*>()) ? 0 : 0, std::true_type());
+    template <typename U> static std::false_type test(...);
+public:
+    enum { value = decltype(test<T>(0))::value };
+};
+
+/// Ways of testing whether a subject of static type S is a T
+enum cast_resolution
+{
+    by_upcast,  ///< T is a base of S
+    by_classof, ///< T::classof(const S*) 
+    by_kind,    ///< Kinds of the classes of a closed hierarchy
+    unresolved  ///< None of the above, so the user has to specialize mch::cast_hook
+};
+
+/// Test of whether a subject of static type S is a T done on misses of vtbl 
+/// maps without RTTI. Users specialize it for pairs it cannot resolve itself.
+template <typename T, typename S, typename C = void>
+struct cast_hook
+{
+    /// Returns pointer to T subobject of s or nullptr when s is not a T
+    static inline const T* go(const S* s) noexcept
+    {
+        return go(s, std::integral_constant<cast_resolution,
+                    std::is_convertible<const S*,const T*>::value ? by_upcast  :
+                    has_classof<T,S>::value                      ? by_classof :
+                    class_hierarchy<S>::declared && has_member_kind_selector<bindings<S>>::value ? by_kind : unresolved>());
+    }
+
+private:
+
+    static inline const T* go(const S* s, std::integral_constant<cast_resolution,by_upcast>)  noexcept { return s; }
+    static inline const T* go(const S* s, std::integral_constant<cast_resolution,by_classof>) noexcept { return T::classof(s) ? static_cast<const T*>(s) : nullptr; }
+
+    /// The kind of the subject identifies its dynamic class among the declared
+    /// ones, from whose complete object the table of the hierarchy converts to T.
+    /// Dynamic classes that are not declared are not a T.
+    /// \note dynamic_cast to void only reads the offset to the complete object
+    ///       from the vtbl and is allowed without RTTI.
+    static inline const T* go(const S* s, std::integral_constant<cast_resolution,by_kind>) noexcept
+    {
+        typedef class_hierarchy<S> hierarchy;
+        const std::size_t index = hierarchy::index_of_kind(std::size_t(kind_selector(s)));
+        return index < std::size_t(hierarchy::size) 
+             ? static_cast<const T*>(hierarchy::template upcasts<T>::table[index](dynamic_cast<const void*>(s))) 
+             : nullptr;
+    }
+
+    template <cast_resolution R>
+    static inline const T* go(const S*, std::integral_constant<cast_resolution,R>) noexcept
+    {
+        static_assert(R != unresolved, "Without RTTI the test for T on subjects of static type S needs T::classof(const S*), a class_hierarchy of S with kinds (KS and KV) or a specialization of mch::cast_hook<T,S>");
+        return nullptr;
+    }
+};
+
+#endif
+
+//------------------------------------------------------------------------------
+
+/// This general case is not defined on purpose as expected types are only 
+/// pointer and reference types, handled by the partial specializations below.
+template <typename T>
+struct hooked_cast_helper;
+
+/// Partial specialization handling pointers as target type.
+template <typename T>
+struct hooked_cast_helper<T*>
+{
+#if XTL_RTTI
+    template <typename S>
+    static inline T* go(S* p) noexcept { return dynamic_cast<T*>(p); }
+#else
+    template <typename S>
+    static inline T* go(S* p) noexcept 
+    { 
+        return go(p, std::is_void<typename std::remove_cv<T>::type>());
+    }
+
+    /// Casts to the complete object only read the vtbl and need no RTTI
+    template <typename S>
+    static inline T* go(S* p, std::true_type) noexcept { return dynamic_cast<T*>(p); }
+
+    template <typename S>
+    static inline T* go(S* p, std::false_type) noexcept
+    {
+        typedef typename std::remove_cv<T>::type target_type;
+        typedef typename std::remove_cv<S>::type source_type;
+        return p ? const_cast<T*>(cast_hook<target_type,source_type>::go(p)) : nullptr;
+    }
+#endif
+};
+
+/// Partial specialization handling references as target type.
+template <typename T>
+struct hooked_cast_helper<T&>
+{
+    template <typename S>
+    static inline T& go(S& s)
+    {
+        if (T* t = hooked_cast_helper<T*>::go(std::addressof(s)))
+            return *t;
+        else
+            throw std::bad_cast();
+    }
+};
+
+/// Behaves as dynamic_cast<T> when RTTI is available, otherwise tests the 
+/// type with #cast_hook. Without RTTI, match.hpp defines dynamic_cast to be 
+/// it, the way it does with memoized_cast under #XTL_USE_MEMOIZED_CAST.
+template <typename T, typename S>
+inline T hooked_cast(S&& s)
+{
+    return hooked_cast_helper<T>::go(std::forward<S>(s));
+}
+
+//------------------------------------------------------------------------------
+
+} // of namespace mch
@@ -0,0 +1,139 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file defines function mch::classify(first,last,result,p0,...,pn) that
+/// matches each element of a contiguous array against a list of patterns and
+/// stores into result the index of the first pattern that matched it, or n+1
+/// when none did.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+/// \note Unlike Match statement, every pattern is tried on every element and
+///       there are no clause bodies: bindings of variables are thus only
+///       useful inside guards and equivalence patterns of the same clause.
+///
+
+#pragma once
+
+#include "patterns/primitive.hpp" // Value, Variable and Wildcard patterns
+#include <algorithm>              // std::fill_n
+#include <cstddef>
+#include <type_traits>            // std::integral_constant
+
+//------------------------------------------------------------------------------
+// Design Notes:
+//
+// - A Match over a single element either branches on every pattern or jumps 
+//   through a switch, neither of which lets compiler use vector instructions.
+//   Here each pattern is instead tried on a block of elements in a tight loop
+//   that stores its index with a select rather than a branch. For value 
+//   patterns, relational guards and n+k patterns the loop body reduces to a 
+//   comparison, which compilers vectorize.
+// - Patterns are tried from the last to the first, so that the index stored by
+//   the earlier pattern overwrites that of the later one, which gives the 
+//   first-fit semantics of Match without tracking which elements are decided.
+// - Blocks keep the elements and their indices in L1 while all the patterns 
+//   are tried on them.
+//
+
+namespace mch ///< Mach7 library namespace
+{
+
+//------------------------------------------------------------------------------
+
+/// Number of elements all the patterns are tried on before moving to the next ones
+enum { classify_block_size = 256 };
+
+//------------------------------------------------------------------------------
+
+/// Terminates recursion over the patterns
+template <typename N, typename T, typename R>
+inline void classify_block(N, const T*, R*, R) noexcept {}
+
+/// Tries patterns p,ps... on n elements starting from first, assuming index is that of p.
+/// \note N is either std::size_t or std::integral_constant for full blocks, 
+///       whose known number of iterations lets compilers vectorize at -O2.
+template <typename N, typename T, typename R, typename P, typename... Ps>
+inline void classify_block(N n, const T* XTL_RESTRICT first, R* XTL_RESTRICT result, R index, const P& p, const Ps&... ps)
+{
+    classify_block(n, first, result, R(index+1), ps...); // Later patterns first
+
+    for (std::size_t i = 0; i < std::size_t(n); ++i)
+        result[i] = p(first[i]) ? index : result[i];
+}
+
+//------------------------------------------------------------------------------
+
+/// Implementation of #classify taking already filtered patterns
+template <typename T, typename R, typename... Ps>
+inline R* classify_filtered(const T* first, const T* last, R* result, const Ps&... ps)
+{
+    typedef std::integral_constant<std::size_t, classify_block_size> full_block;
+
+    for (; last - first >= std::ptrdiff_t(classify_block_size); first += classify_block_size, result += classify_block_size)
+    {
+        std::fill_n(result, std::size_t(classify_block_size), R(sizeof...(Ps))); // None of the patterns matched
+        classify_block(full_block(), first, result, R(0), ps...);
+    }
+
+    if (std::size_t n = std::size_t(last - first))
+    {
+        std::fill_n(result, n, R(sizeof...(Ps)));
+        classify_block(n, first, result, R(0), ps...);
+        result += n;
+    }
+
+    return result;
+}
+
+//------------------------------------------------------------------------------
+
+/// Stores into result[i] the index of the first of patterns ps that matches 
+/// first[i], or sizeof...(ps) when none does. Just like in Case clauses, 
+/// constants are turned into value patterns and variables into var patterns.
+/// \returns Iterator past the last index stored
+template <typename T, typename R, typename... Ps>
+inline R* classify(const T* first, const T* last, R* result, Ps&&... ps)
+{
+    return classify_filtered(first, last, result, filter(std::forward<Ps>(ps))...);
+}
+
+//------------------------------------------------------------------------------
+
+} // of namespace mch
@@ -139,6 +139,14 @@
 #define XTL_SUPPORT_static_assert 1
 #endif
 
+//------------------------------------------------------------------------------
+
+#if __has_feature(cxx_thread_local)
+/// Support of thread-local storage duration
+/// \see http://www.open-std.org/jtc1/sc22/wg21/docs/papers/2008/n2659.htm
+#define XTL_SUPPORT_thread_local 1
+#endif
+
 //------------------------------------------------------------------------------
 /// Supports variadic templates
 /// \see http://www.open-std.org/jtc1/sc22/wg21/docs/papers/2007/n2242.pdf
@@ -164,6 +172,12 @@
     #define XTL_IRRELEVANT_VTBL_BITS 4
 #endif
 
+#if __has_feature(ptrauth_calls)
+    #include <ptrauth.h>
+    /// Strips pointer authentication code from a signed vtbl-pointer on arm64e
+    #define XTL_STRIP_VTBL_SIGNATURE(vtbl) std::intptr_t(ptrauth_strip(reinterpret_cast<void*>(vtbl), ptrauth_key_cxx_vtable_pointer))
+#endif
+
 //------------------------------------------------------------------------------
 
 #define XTL_FUNCTION __func__
@@ -188,8 +202,8 @@
     /// \note We use ... (__VA_ARGS__ parameters) to allow expressions 
     ///       containing comma as argument. Essentially this is a one arg macro
 #if __has_builtin(__builtin_expect)
-    #define   XTL_LIKELY(...) (__builtin_expect((long int)(__VA_ARGS__), 1))
-    #define XTL_UNLIKELY(...) (__builtin_expect((long int)(__VA_ARGS__), 0))
+    #define   XTL_LIKELY(...) (__builtin_expect((long int)(__VA_ARGS__), XTL_EXPECTED(1,#__VA_ARGS__)))
+    #define XTL_UNLIKELY(...) (__builtin_expect((long int)(__VA_ARGS__), XTL_EXPECTED(0,#__VA_ARGS__)))
 #endif
 #endif
 
@@ -205,10 +219,32 @@
 /// A macro that is supposed to be put after  the function definition whose body must be inlined
 #define XTL_FORCE_INLINE_END
 #endif
+#if __has_attribute(section)
+/// An attribute placing the variable it is put before into the given section
+#define XTL_SECTION(name) __attribute__((section(name)))
+#endif
+#if __has_feature(is_final)
+/// Whether class T is declared final
+#define XTL_IS_FINAL(T) __is_final(T)
+#endif
 #if __has_attribute(unused)
 /// An attribute used in GCC code to silence warning about potentially unused typedef target_type, which we
 /// generate to fall back on from Case clauses. The typedef is required in some cases, do not remove.
 #define XTL_UNUSED_TYPEDEF __attribute__((unused))
+
+/// An attribute marking entities whose use should make the compiler emit a warning with given message
+#define XTL_DEPRECATED(msg) __attribute__((deprecated(msg)))
+
+/// Qualifier of pointers through which only the objects they point to are accessed
+#define XTL_RESTRICT __restrict__
+
+/// Hint to bring the cache line with given address into all levels of the cache
+#define XTL_PREFETCH(addr) __builtin_prefetch(addr)
+#endif
+
+#if __has_builtin(__builtin_readcyclecounter)
+/// Current value of the time stamp counter of the processor
+#define XTL_CYCLE_COUNTER() ((unsigned long long)__builtin_readcyclecounter())
 #endif
 
 //------------------------------------------------------------------------------
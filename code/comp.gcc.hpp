@@ -139,6 +139,14 @@
 #define XTL_SUPPORT_static_assert 1
 #endif
 
+//------------------------------------------------------------------------------
+
+#if XTL_GCC_VERSION >= 40800
+/// Support of thread-local storage duration
+/// \see http://www.open-std.org/jtc1/sc22/wg21/docs/papers/2008/n2659.htm
+#define XTL_SUPPORT_thread_local 1
+#endif
+
 //------------------------------------------------------------------------------
 /// Supports variadic templates
 /// \see http://www.open-std.org/jtc1/sc22/wg21/docs/papers/2007/n2242.pdf
@@ -185,8 +193,8 @@
     ///       user's code since they explicitly expect a pointer argument
     /// \note We use ... (__VA_ARGS__ parameters) to allow expressions 
     ///       containing comma as argument. Essentially this is a one arg macro
-    #define   XTL_LIKELY(...) (__builtin_expect((long int)(__VA_ARGS__), 1))
-    #define XTL_UNLIKELY(...) (__builtin_expect((long int)(__VA_ARGS__), 0))
+    #define   XTL_LIKELY(...) (__builtin_expect((long int)(__VA_ARGS__), XTL_EXPECTED(1,#__VA_ARGS__)))
+    #define XTL_UNLIKELY(...) (__builtin_expect((long int)(__VA_ARGS__), XTL_EXPECTED(0,#__VA_ARGS__)))
 #endif
 
 /// A macro that is supposed to be put before the function definition whose inlining should be disabled
@@ -197,11 +205,35 @@
 #define XTL_FORCE_INLINE_BEGIN __attribute__ ((always_inline)) static inline 
 /// A macro that is supposed to be put after  the function definition whose body must be inlined
 #define XTL_FORCE_INLINE_END
+/// A macro that is supposed to be put before the function definition that should be optimized even in unoptimized builds
+#define XTL_OPTIMIZED_BEGIN __attribute__ ((optimize("O2")))
 
 /// An attribute used in GCC code to silence warning about potentially unused typedef target_type, which we
 /// generate to fall back on from Case clauses. The typedef is required in some cases, do not remove.
 #define XTL_UNUSED_TYPEDEF __attribute__((unused))
 
+/// An attribute marking entities whose use should make the compiler emit a warning with given message
+#define XTL_DEPRECATED(msg) __attribute__((deprecated(msg)))
+
+/// An attribute placing the variable it is put before into the given section
+#define XTL_SECTION(name) __attribute__((section(name)))
+
+#if XTL_GCC_VERSION >= 40700
+/// Whether class T is declared final
+#define XTL_IS_FINAL(T) __is_final(T)
+#endif
+
+/// Qualifier of pointers through which only the objects they point to are accessed
+#define XTL_RESTRICT __restrict__
+
+/// Hint to bring the cache line with given address into all levels of the cache
+#define XTL_PREFETCH(addr) __builtin_prefetch(addr)
+
+/// Current value of the time stamp counter of the processor
+#if defined(__i386__) || defined(__x86_64__)
+#define XTL_CYCLE_COUNTER() ((unsigned long long)__builtin_ia32_rdtsc())
+#endif
+
 //------------------------------------------------------------------------------
 
 /// Helper macro to use the sandard _Pragma operator
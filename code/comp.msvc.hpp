@@ -138,6 +138,12 @@
 #define static_assert(cond,text) _STATIC_ASSERT(cond)
 #endif
 
+//------------------------------------------------------------------------------
+
+#if _MSC_VER >= 1900 /// Visual C++ 2015 supports thread_local
+#define XTL_SUPPORT_thread_local 1
+#endif
+
 //------------------------------------------------------------------------------
 /// Supports variadic templates
 /// \see http://www.open-std.org/jtc1/sc22/wg21/docs/papers/2007/n2242.pdf
@@ -222,6 +228,29 @@
 /// generate to fall back on from Case clauses. The typedef is required in some cases, do not remove.
 #define XTL_UNUSED_TYPEDEF
 
+/// An attribute marking entities whose use should make the compiler emit a warning with given message
+#define XTL_DEPRECATED(msg) __declspec(deprecated(msg))
+
+/// Whether class T is declared final (or sealed)
+#define XTL_IS_FINAL(T) __is_sealed(T)
+
+/// Qualifier of pointers through which only the objects they point to are accessed
+#define XTL_RESTRICT __restrict
+
+/// Hint to bring the cache line with given address into all levels of the cache
+#if defined(_M_IX86) || defined(_M_X64)
+#include <xmmintrin.h>
+#define XTL_PREFETCH(addr) _mm_prefetch(reinterpret_cast<const char*>(addr), _MM_HINT_T0)
+#else
+#define XTL_PREFETCH(addr) ((void)(addr))
+#endif
+
+/// Current value of the time stamp counter of the processor
+#if defined(_M_IX86) || defined(_M_X64)
+#include <intrin.h>
+#define XTL_CYCLE_COUNTER() ((unsigned long long)__rdtsc())
+#endif
+
 //------------------------------------------------------------------------------
 
 /// MSVC10 doesn't seem to support the standard _Pragma operator
@@ -78,6 +78,19 @@
 
 //------------------------------------------------------------------------------
 
+#if !defined(XTL_SUPPORT_relaxed_constexpr)
+/// Support of relaxed constraints on constexpr functions: local variables,
+/// branches, loops and mutation of objects whose lifetime began in the evaluation
+/// \see http://www.open-std.org/jtc1/sc22/wg21/docs/papers/2013/n3652.html
+#if XTL_SUPPORT_constexpr && defined(__cpp_constexpr) && __cpp_constexpr >= 201304
+#define XTL_SUPPORT_relaxed_constexpr 1
+#else
+#define XTL_SUPPORT_relaxed_constexpr 0
+#endif
+#endif
+
+//------------------------------------------------------------------------------
+
 #if !defined(XTL_SUPPORT_ddf)
 /// Indicates support of defaulted and deleted functions.
 /// \see http://www.open-std.org/jtc1/sc22/wg21/docs/papers/2007/n2346.htm
@@ -110,6 +123,17 @@
 #define XTL_SUPPORT_noexcept 0
 #endif
 
+#if !defined(XTL_SUPPORT_noexcept_function_type)
+/// Support of noexcept as a part of function types, so that pointers to 
+/// functions and members keep it
+/// \see http://www.open-std.org/jtc1/sc22/wg21/docs/papers/2015/p0012r1.html
+#if XTL_SUPPORT_noexcept && defined(__cpp_noexcept_function_type)
+#define XTL_SUPPORT_noexcept_function_type 1
+#else
+#define XTL_SUPPORT_noexcept_function_type 0
+#endif
+#endif
+
 //------------------------------------------------------------------------------
 
 #if !defined(XTL_SUPPORT_nullptr)
@@ -130,6 +154,61 @@
 #define XTL_SUPPORT_static_assert 0
 #endif
 
+//------------------------------------------------------------------------------
+
+#if !defined(XTL_SUPPORT_string_view)
+/// Support of std::string_view by the standard library
+/// \see http://www.open-std.org/jtc1/sc22/wg21/docs/papers/2014/n3921.html
+#if __cplusplus >= 201703L
+#define XTL_SUPPORT_string_view 1
+#else
+#define XTL_SUPPORT_string_view 0
+#endif
+#endif
+
+//------------------------------------------------------------------------------
+
+#if !defined(XTL_SUPPORT_structured_bindings)
+/// Support of structured binding declarations and of the standard library 
+/// they are used with: std::index_sequence and std::void_t
+/// \see http://www.open-std.org/jtc1/sc22/wg21/docs/papers/2016/p0217r3.html
+#if __cplusplus >= 201703L && defined(__cpp_structured_bindings)
+#define XTL_SUPPORT_structured_bindings 1
+#else
+#define XTL_SUPPORT_structured_bindings 0
+#endif
+#endif
+
+//------------------------------------------------------------------------------
+
+#if !defined(XTL_SUPPORT_variant)
+/// Support of std::variant by the standard library
+/// \see http://www.open-std.org/jtc1/sc22/wg21/docs/papers/2016/p0088r3.html
+#if __cplusplus >= 201703L
+#define XTL_SUPPORT_variant 1
+#else
+#define XTL_SUPPORT_variant 0
+#endif
+#endif
+
+//------------------------------------------------------------------------------
+
+#if !defined(XTL_SUPPORT_any)
+/// Support of std::any by the standard library
+/// \see http://www.open-std.org/jtc1/sc22/wg21/docs/papers/2016/p0220r1.html
+#if __cplusplus >= 201703L
+#define XTL_SUPPORT_any 1
+#else
+#define XTL_SUPPORT_any 0
+#endif
+#endif
+
+//------------------------------------------------------------------------------
+
+#if !defined(XTL_SUPPORT_thread_local)
+#define XTL_SUPPORT_thread_local 0
+#endif
+
 //------------------------------------------------------------------------------
 /// Supports variadic templates
 /// \see http://www.open-std.org/jtc1/sc22/wg21/docs/papers/2007/n2242.pdf
@@ -230,12 +309,62 @@
     #define XTL_FORCE_INLINE_END
 #endif
 
+#if !defined(XTL_OPTIMIZED_BEGIN)
+    /// A macro that is supposed to be put before the function definition that should be optimized even in unoptimized builds
+    #define XTL_OPTIMIZED_BEGIN
+#endif
+
+#if !defined(XTL_HOST_DEVICE)
+  #if defined(__CUDACC__) || defined(__HIPCC__)
+    /// A macro that is put before functions that GPU kernels may call, \see kind_match.hpp
+    #define XTL_HOST_DEVICE __host__ __device__
+  #else
+    #define XTL_HOST_DEVICE
+  #endif
+#endif
+
+#if !defined(XTL_SECTION)
+    /// An attribute placing the variable it is put before into the given section
+    #define XTL_SECTION(name)
+#endif
+
+#if !defined(XTL_IS_FINAL)
+    /// Whether class T is declared final
+    #if __cplusplus >= 201402L
+    #define XTL_IS_FINAL(T) std::is_final<T>::value
+    #else
+    #define XTL_IS_FINAL(T) false
+    #endif
+#endif
+
 #if !defined(XTL_UNUSED_TYPEDEF)
     /// An attribute used in GCC code to silence warning about potentially unused typedef target_type, which we
     /// generate to fall back on from Case clauses. The typedef is required in some cases, do not remove.
     #define  XTL_UNUSED_TYPEDEF
 #endif
 
+#if !defined(XTL_DEPRECATED)
+    /// An attribute marking entities whose use should make the compiler emit a warning with given message
+    #define  XTL_DEPRECATED(msg)
+#endif
+
+#if !defined(XTL_RESTRICT)
+    /// Qualifier of pointers through which only the objects they point to are accessed
+    #define  XTL_RESTRICT
+#endif
+
+#if !defined(XTL_PREFETCH)
+    /// Hint to bring the cache line with given address into all levels of the cache
+    #define  XTL_PREFETCH(addr) ((void)(addr))
+#endif
+
+#if !defined(XTL_CYCLE_COUNTER)
+    #include <ctime>
+    /// Current value of the time stamp counter of the processor, which we 
+    /// approximate with processor time where we don't know how to read it
+    #define  XTL_CYCLE_COUNTER() ((unsigned long long)std::clock())
+#endif
+
 //------------------------------------------------------------------------------
 
 #if !defined(XTL_PRAGMA)
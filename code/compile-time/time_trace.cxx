@@ -0,0 +1,346 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Summarizes where a compiler spent its time compiling a source of the 
+/// compile-time benchmarks, and compares such summaries of two runs (\see 
+/// trace target of the Makefile):
+/// \code
+///     time_trace source trace.json report.txt
+///     time_trace --compare baseline.jsonl current.jsonl [threshold-in-percent]
+/// \endcode
+/// The first form writes one line of JSON with times in milliseconds taken
+/// from the trace Clang writes with -ftime-trace and the report GCC prints 
+/// with -ftime-report, whichever of them is not empty. Clang's trace breaks
+/// template instantiation down by the templates instantiated, so the time
+/// spent instantiating constructor patterns (mch::constr*), vtbl maps 
+/// (mch::vtbl_map), any template of the library (mch::) and of XTL (xtl::) 
+/// is reported as well. Nested instantiations of the same group count once.
+/// GCC only reports instantiation as a whole, but it reports preprocessing,
+/// which is mostly the expansion of XTL_REPEAT and other macros of Match 
+/// statements.
+///
+/// The second form reports each time of each source that grew by more than
+/// the threshold, 10% by default, and more than #min_growth_ms. It exits 
+/// with 1 when there were such regressions.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../test/time/testresults.hpp"
+
+//------------------------------------------------------------------------------
+
+/// Growth of a time smaller than this is considered noise regardless of threshold
+const double min_growth_ms = 20.0;
+
+/// Times reported for each source in the order they are written
+const char* const time_names[] = { "total", "frontend", "preprocessing", "instantiation", "constr", "vtbl_map", "mch", "xtl" };
+
+/// Times of one compilation, absent when the compiler does not report them
+typedef std::map<std::string,double> compile_times;
+
+//------------------------------------------------------------------------------
+
+inline std::string read_file(const char* file_name)
+{
+    std::ifstream file(file_name, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+//------------------------------------------------------------------------------
+
+/// Value of key in an event of a trace, unescaped if it is a string
+std::string event_field(const std::string& event, const std::string& key)
+{
+    std::string::size_type p = event.find("\"" + key + "\":");
+
+    if (p == std::string::npos)
+        return std::string();
+
+    p += key.size() + 3;
+
+    if (event[p] != '"')
+        return event.substr(p, event.find_first_of(",}", p)-p);
+
+    std::string result;
+
+    for (++p; p < event.size() && event[p] != '"'; ++p)
+        result += event[p] == '\\' && p+1 < event.size() ? event[++p] : event[p];
+
+    return result;
+}
+
+//------------------------------------------------------------------------------
+
+/// Length of the union of intervals [first,second)
+double covered(std::vector<std::pair<double,double> > intervals)
+{
+    std::sort(intervals.begin(), intervals.end());
+    double total = 0.0, end = 0.0;
+
+    for (size_t i = 0; i < intervals.size(); ++i)
+    {
+        const double begin = std::max(intervals[i].first, end);
+
+        if (intervals[i].second > begin)
+        {
+            total += intervals[i].second - begin;
+            end    = intervals[i].second;
+        }
+    }
+
+    return total;
+}
+
+//------------------------------------------------------------------------------
+
+/// Times from a trace in Chrome's format written by clang -ftime-trace
+void parse_clang_trace(const std::string& trace, compile_times& times)
+{
+    // Groups of templates by what the name of the instantiated template starts with
+    static const char* const groups[][2] = { {"constr", "mch::constr"}, {"vtbl_map", "mch::vtbl_map"}, {"mch", "mch::"}, {"xtl", "xtl::"}, {"instantiation", ""} };
+    const size_t group_count = sizeof(groups)/sizeof(groups[0]);
+    std::vector<std::pair<double,double> > intervals[group_count];
+
+    for (std::string::size_type p = trace.find("{\"pid\":"); p != std::string::npos; )
+    {
+        std::string::size_type q = trace.find("{\"pid\":", p+1);
+        const std::string event = trace.substr(p, q == std::string::npos ? q : q-p);
+        const std::string name  = event_field(event, "name");
+        const double      dur   = std::atof(event_field(event, "dur").c_str()) / 1000.0;
+        p = q;
+
+        if (name == "Total ExecuteCompiler")
+            times["total"] = dur;
+        else
+        if (name == "Total Frontend")
+            times["frontend"] = dur;
+        else
+        if (name == "InstantiateClass" || name == "InstantiateFunction")
+        {
+            const std::string detail = event_field(event, "detail");
+            const double      ts     = std::atof(event_field(event, "ts").c_str()) / 1000.0;
+
+            for (size_t i = 0; i < group_count; ++i)
+                if (detail.compare(0, std::strlen(groups[i][1]), groups[i][1]) == 0)
+                    intervals[i].push_back(std::make_pair(ts, ts + dur));
+        }
+    }
+
+    for (size_t i = 0; i < group_count; ++i)
+        times[groups[i][0]] = covered(intervals[i]);
+}
+
+//------------------------------------------------------------------------------
+
+/// Times from the report printed by gcc -ftime-report, which are wall seconds
+/// in the third column of timing variables
+void parse_gcc_report(const std::string& report, compile_times& times)
+{
+    std::istringstream lines(report);
+
+    for (std::string line; std::getline(lines, line); )
+    {
+        std::string::size_type colon = line.find(':');
+
+        if (colon == std::string::npos)
+            continue;
+
+        std::string name = line.substr(0, colon);
+        name.erase(0, name.find_first_not_of(" |"));
+        name.erase(name.find_last_not_of(' ')+1);
+
+        // Columns of usr, sys and wall with optional percentages after each
+        std::string columns = line.substr(colon+1);
+        std::replace(columns.begin(), columns.end(), '(', ' ');
+        std::istringstream values(columns);
+        std::vector<double> numbers;
+
+        for (std::string word; values >> word && numbers.size() < 3; )
+            if (word.find('%') == std::string::npos)
+                numbers.push_back(std::atof(word.c_str()));
+
+        if (numbers.size() < 3)
+            continue;
+
+        const double ms = numbers[2] * 1000.0;
+
+        if (name == "TOTAL")                                            times["total"]          = ms;
+        else if (name == "phase parsing" || name == "phase lang. deferred") times["frontend"]   += ms;
+        else if (name == "preprocessing")                               times["preprocessing"]  = ms;
+        else if (name == "template instantiation")                      times["instantiation"]  = ms;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+int summarize(const char* source, const char* trace_file, const char* report_file)
+{
+    compile_times times;
+    const std::string trace  = read_file(trace_file);
+    const std::string report = read_file(report_file);
+    const char* compiler = "unknown";
+
+    if (trace.find("traceEvents") != std::string::npos)
+    {
+        parse_clang_trace(trace, times);
+        compiler = "clang";
+    }
+    else
+    if (report.find("TOTAL") != std::string::npos)
+    {
+        parse_gcc_report(report, times);
+        compiler = "gcc";
+    }
+    else
+    {
+        std::cerr << "ERROR: Neither " << trace_file << " nor " << report_file << " has times of compilation of " << source << std::endl;
+        return 2;
+    }
+
+    std::cout << "{\"source\":\"" << source << "\",\"compiler\":\"" << compiler << '"' << std::fixed << std::setprecision(1);
+
+    for (size_t i = 0; i < sizeof(time_names)/sizeof(time_names[0]); ++i)
+        if (times.count(time_names[i]))
+            std::cout << ",\"" << time_names[i] << "\":" << times[time_names[i]];
+
+    std::cout << '}' << std::endl;
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+bool load(const char* file_name, std::map<std::string,std::string>& lines)
+{
+    std::ifstream file(file_name);
+
+    if (!file)
+    {
+        std::cerr << "ERROR: Cannot open " << file_name << std::endl;
+        return false;
+    }
+
+    for (std::string line; std::getline(file, line); )
+        if (!line.empty())
+            lines[field(line,"source")] = line;
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+
+int compare(const char* baseline_file, const char* current_file, double threshold)
+{
+    std::map<std::string,std::string> baseline, current;
+
+    if (!load(baseline_file, baseline) || !load(current_file, current))
+        return 2;
+
+    size_t regressions = 0;
+
+    for (std::map<std::string,std::string>::const_iterator p = current.begin(); p != current.end(); ++p)
+    {
+        std::map<std::string,std::string>::const_iterator q = baseline.find(p->first);
+
+        if (q == baseline.end())
+        {
+            std::cout << "NEW         " << p->first << std::endl;
+            continue;
+        }
+
+        if (field(q->second,"compiler") != field(p->second,"compiler"))
+        {
+            std::cout << "INCOMPARABLE " << p->first << ": compiled by " << field(q->second,"compiler") << " and " << field(p->second,"compiler") << std::endl;
+            continue;
+        }
+
+        for (size_t i = 0; i < sizeof(time_names)/sizeof(time_names[0]); ++i)
+        {
+            const std::string b = field(q->second, time_names[i]);
+            const std::string c = field(p->second, time_names[i]);
+
+            if (b.empty() || c.empty())
+                continue;
+
+            const double old_ms = std::atof(b.c_str());
+            const double new_ms = std::atof(c.c_str());
+
+            if (new_ms - old_ms > min_growth_ms && new_ms > old_ms * (1.0 + threshold/100))
+            {
+                std::cout << "SLOWER      " << p->first << ' ' << time_names[i] << ": " << std::fixed << std::setprecision(1) 
+                          << old_ms << " -> " << new_ms << " ms (+" << (new_ms/old_ms-1.0)*100 << "%)" << std::endl;
+                ++regressions;
+            }
+        }
+    }
+
+    std::cout << regressions << " regressions of compilation time over " << threshold << "%" << std::endl;
+    return regressions != 0;
+}
+
+//------------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    if (argc > 3 && std::string(argv[1]) == "--compare")
+        return compare(argv[2], argv[3], argc > 4 ? std::atof(argv[4]) : 10.0);
+
+    if (argc == 4)
+        return summarize(argv[1], argv[2], argv[3]);
+
+    std::cerr << "Usage: " << argv[0] << " source trace.json report.txt" << std::endl
+              << "       " << argv[0] << " --compare baseline.jsonl current.jsonl [threshold-in-percent]" << std::endl;
+    return 2;
+}
+
+//------------------------------------------------------------------------------
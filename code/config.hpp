@@ -47,28 +47,88 @@
 ///
 /// Options with performance impact:
 /// - Use of multi-threading           \see #XTL_MULTI_THREADING
+/// - Use of per-thread front cache    \see #XTL_THREAD_LOCAL_CACHE
+/// - Reclamation of old descriptors   \see #XTL_RECLAIM_DESCRIPTORS
+/// - Use of saved type profiles       \see #XTL_TYPE_PROFILE
+/// - Classes registered at startup    \see #XTL_TYPE_REGISTRATION
+/// - Dispatch on integral subjects   \see #XTL_VALUE_SUBJECT_DISPATCH
+/// - Learning shared by vtbl copies  \see #XTL_CANONICAL_VTBLS
+/// - Static resolution of final types \see #XTL_EXACT_SUBJECTS
+/// - Default tuples out of the cache  \see #XTL_SEPARATE_DEFAULTS
+/// - Use of learned order of clauses  \see #XTL_LEARNED_CASE_ORDER
+/// - Jumps to addresses of clauses    \see #XTL_USE_COMPUTED_GOTO
+/// - Packed targets and offsets       \see #XTL_PACKED_SWITCH_INFO
+/// - Offsets known at compile time    \see #XTL_STATIC_OFFSETS
+/// - Cached clauses of fall-through  \see #XTL_APPLICABLE_CLAUSES
+/// - Use of class hierarchy index     \see #XTL_HIERARCHY_INDEX
+/// - Switch on closed hierarchies     \see #XTL_CLOSED_HIERARCHY_SWITCH
+/// - Class ids shared by Match sites  \see #XTL_SHARED_CLASS_IDS
+/// - Use of perfect hashing           \see #XTL_PERFECT_HASHING
+/// - Inline cache of vtbl maps       \see #XTL_INLINE_CACHE_SIZE
+/// - Engines picked per Match site   \see #XTL_ADAPTIVE_DISPATCH
+/// - Fewer values live over dispatch \see #XTL_LEAN_MATCH
+/// - Policy measured per compiler    \see #XTL_TUNED_VTBL_MAP_POLICY
+/// - Use of bit deposit instructions  \see #XTL_USE_PDEP
+/// - Use of dedicated vtbl map memory \see #XTL_VTBL_ARENA
+/// - Chunks of arenas of objects      \see #XTL_ARENA_CHUNK_SIZE
+/// - Results remembered by memoized   \see #XTL_MEMO_LOG_SIZE
+/// - Use of custom vtbl map allocator \see #XTL_VTBL_ALLOCATOR
+/// - Use of vtbl map compaction       \see #XTL_VTBL_COMPACTION
+/// - Use of deferred vtbl map updates \see #XTL_DEFERRED_VTBL_UPDATES
+/// - Incremental vtbl map updates     \see #XTL_INCREMENTAL_VTBL_UPDATES
+/// - Use of static vtbl map storage   \see #XTL_STATIC_VTBL_MAPS
+/// - Vtbl maps instantiated once    \see #XTL_EXTERN_TEMPLATES
+/// - Code size over speed of misses  \see #XTL_OPTIMIZE_FOR_SIZE
+/// - Irrelevant vtbl bits measured    \see #XTL_CALIBRATE_VTBL_BITS
+/// - Signatures of vtbl pointers      \see #XTL_STRIP_VTBL_SIGNATURES
 /// - Default syntax                   \see #XTL_DEFAULT_SYNTAX
+/// - Exception-free MatchE and MatchX \see #XTL_EXCEPTION_FREE_MATCHE
 /// - Use of vtbl frequencies          \see #XTL_USE_VTBL_FREQUENCY
 /// - Use of memoized_cast             \see #XTL_USE_MEMOIZED_CAST
+/// - Use of memoized nested type tests \see #XTL_MEMOIZE_NESTED_TYPE_TESTS
+/// - Use of memoized member values    \see #XTL_MEMOIZE_MEMBERS
+/// - One scan for all rex() clauses   \see #XTL_REGEX_SETS
+/// - Cheaper operands of && and ||    \see #XTL_REORDER_BY_COST
+/// - Patterns constructed once        \see #XTL_HOIST_PATTERNS
 /// - Whether extractors might throw   \see #XTL_EXTRACTORS_MIGHT_THROW
 /// - Use of static local variables    \see #XTL_PRELOAD_LOCAL_STATIC_VARIABLES
+/// - Sections of dispatch statics     \see #XTL_DISPATCH_SECTIONS
 /// - Use number of case clauses init  \see #XTL_CLAUSES_NUM_ESTIMATES_TYPES_NUM
 /// - Certain under-the-hood types     \see #vtbl_count_t
-/// - Certain under-the-hood constants \see #XTL_MIN_LOG_SIZE, #XTL_MAX_LOG_INC, #XTL_MAX_STACK_LOG_SIZE, #XTL_IRRELEVANT_VTBL_BITS
+/// - Certain under-the-hood constants \see #XTL_MIN_LOG_SIZE, #XTL_MAX_TUNED_LOG_SIZE, #XTL_MAX_LOG_INC, #XTL_MAX_STACK_LOG_SIZE, #XTL_IRRELEVANT_VTBL_BITS
+/// - Those constants set at run time  \see #XTL_RUNTIME_TUNING
 /// Most of the combinations of from this set are built with: make timing
 ///
 /// Options with semantic or convenience impact
 /// - Redundancy checking              \see #XTL_REDUNDANCY_CHECKING
+/// - Compile-time redundancy checks   \see #XTL_STATIC_REDUNDANCY_CHECKING
 /// - Fallthrough behavior             \see #XTL_FALL_THROUGH
 /// - Use of { & } around case clauses \see #XTL_USE_BRACES
 /// - Declarations in case clause      \see #XTL_CLAUSE_DECL
+/// - Variables bound at compile time  \see #XTL_CONSTEXPR_VARIABLES
+/// - Invalidation of unloaded vtbls   \see #XTL_VTBL_INVALIDATION
+/// - Read-only vtbl maps after fork   \see #XTL_SEALED_VTBL_MAPS
+/// - Type tests without RTTI          \see #XTL_RTTI
 /// Most of the combinations from this set are built with: make syntax
 ///
 /// Options for logging and debugging
 /// - Compile-time messages            \see #XTL_MESSAGE_ENABLED
 /// - Trace of performance             \see #XTL_DUMP_PERFORMANCE
+/// - Per-site statistics of vtbl maps \see #XTL_VTBL_STATISTICS
+/// - Export of vtbl cache layouts     \see #XTL_VTBL_LAYOUT
+/// - Cost of vtbl map updates         \see #XTL_VTBL_UPDATE_HISTOGRAM
+/// - Sampling of Match statements     \see #XTL_SAMPLE_MATCH_SITES
+/// - Trace of Match dispatch events   \see #XTL_TRACE_MATCH_SITES
+/// - Static probes on slow paths      \see #XTL_STATIC_PROBES
+/// - Allocations and casts made       \see #XTL_OVERHEAD_ACCOUNTING
+/// - Profile of memoized casts       \see #XTL_CAST_PROFILING
 /// - Trace of memory leaks with lines \see #XTL_LEAKED_NEW_LOCATIONS
 /// - Trace of conditions likeliness   \see #XTL_TRACE_LIKELINESS 
+/// - Hints of conditions likeliness   \see #XTL_LIKELINESS_PROFILE
+/// - Trace of classes frequencies     \see #XTL_TRACE_FREQUENCY
+/// - Profile of classes frequencies   \see #XTL_FREQUENCY_PROFILE
+/// - Counts of classes frequencies    \see #XTL_FREQUENCY_COUNTS
+/// - Checked debug builds             \see #XTL_CHECKED
 ///
 
 #pragma once
@@ -85,6 +145,165 @@
 
 //------------------------------------------------------------------------------
 
+#if !defined(XTL_VTBL_UPDATE_HISTOGRAM)
+    /// Flag enabling timing of each rearrangement of the cache of a vtbl map.
+    /// Cycles spent, log sizes and collisions before and after are recorded
+    /// in mch::vtbl_update_histogram of the map, which is part of the per-site
+    /// statistics of #XTL_VTBL_STATISTICS.
+    #define XTL_VTBL_UPDATE_HISTOGRAM 0
+#endif
+#define XTL_VTBL_UPDATE_HISTOGRAM_ONLY(...) XTL_IF(XTL_NOT(XTL_VTBL_UPDATE_HISTOGRAM), XTL_EMPTY(), XTL_EXPAND(__VA_ARGS__))
+
+#if !defined(XTL_VTBL_LAYOUT)
+    /// Flag enabling export of the layout of the cache of every vtbl map with
+    /// mch::write_vtbl_layouts(): which entries are occupied, how far along 
+    /// the probing sequence each tuple sits from its expected entry, which bits
+    /// of vtbl pointers the cache index is taken from and how many lookups 
+    /// found each tuple. Each cache entry gets a counter of its lookups for it.
+    /// Implies #XTL_VTBL_STATISTICS.
+    #define XTL_VTBL_LAYOUT 0
+#endif
+#define XTL_VTBL_LAYOUT_ONLY(...)        XTL_IF(XTL_NOT(XTL_VTBL_LAYOUT), XTL_EMPTY(), XTL_EXPAND(__VA_ARGS__))
+
+#if !defined(XTL_VTBL_STATISTICS)
+    /// Flag enabling per-site statistics of vtbl maps cheap enough to be kept
+    /// in production builds: each Match statement remembers its file, line and
+    /// function and counts its hits, misses, collisions and updates, while 
+    /// mch::for_each_vtbl_site() enumerates all the live ones.
+    /// By default we keep them when we time the updates of vtbl maps or 
+    /// export their layouts.
+    /// \note Unlike #XTL_DUMP_PERFORMANCE nothing is printed at exit.
+    #if XTL_VTBL_LAYOUT
+    #define XTL_VTBL_STATISTICS 1
+    #else
+    #define XTL_VTBL_STATISTICS XTL_VTBL_UPDATE_HISTOGRAM
+    #endif
+#endif
+
+#if XTL_VTBL_LAYOUT && !XTL_VTBL_STATISTICS
+    #error XTL_VTBL_LAYOUT needs XTL_VTBL_STATISTICS
+#endif
+#define XTL_VTBL_STATISTICS_ONLY(...)    XTL_IF(XTL_NOT(XTL_VTBL_STATISTICS), XTL_EMPTY(), XTL_EXPAND(__VA_ARGS__))
+
+/// Whether vtbl maps know the site of their Match statement and maintain the 
+/// counters needed by either #XTL_DUMP_PERFORMANCE or #XTL_VTBL_STATISTICS.
+#if XTL_DUMP_PERFORMANCE || XTL_VTBL_STATISTICS
+    #define XTL_VTBL_COUNTERS 1
+#else
+    #define XTL_VTBL_COUNTERS 0
+#endif
+#define XTL_VTBL_COUNTERS_ONLY(...)      XTL_IF(XTL_NOT(XTL_VTBL_COUNTERS), XTL_EMPTY(), XTL_EXPAND(__VA_ARGS__))
+
+//------------------------------------------------------------------------------
+
+#if !defined(XTL_SAMPLE_MATCH_SITES)
+    /// Flag enabling a hook that Match statements call on one out of every
+    /// mch::match_sampling_period() of their executions with the number of 
+    /// cycles spent in them (\see sampling.hpp). Until the hook is set at run 
+    /// time, each execution of a Match statement pays a decrement and a branch.
+    #define XTL_SAMPLE_MATCH_SITES 0
+#endif
+#define XTL_SAMPLE_MATCH_SITES_ONLY(...) XTL_IF(XTL_NOT(XTL_SAMPLE_MATCH_SITES), XTL_EMPTY(), XTL_EXPAND(__VA_ARGS__))
+
+#if !defined(XTL_MATCH_SAMPLING_PERIOD)
+    /// Initial value of mch::match_sampling_period()
+    #define XTL_MATCH_SAMPLING_PERIOD 1000
+#endif
+
+//------------------------------------------------------------------------------
+
+#if !defined(XTL_TRACE_MATCH_SITES)
+    /// Flag enabling a record of every execution of Match statements on vtbl 
+    /// pointers: the site, vtbl pointers of subjects, case clause and time 
+    /// stamp, appended to a ring buffer of the thread (\see tracing.hpp). The
+    /// records are written into a file with mch::match_trace_flush() and 
+    /// printed with the names of classes by mch::match_trace_dump().
+    /// \note Each execution pays reading the time stamp counter and a store
+    ///       of a record of #XTL_TRACE_MAX_SUBJECTS vtbl pointers.
+    #define XTL_TRACE_MATCH_SITES 0
+#endif
+#define XTL_TRACE_MATCH_SITES_ONLY(...) XTL_IF(XTL_NOT(XTL_TRACE_MATCH_SITES), XTL_EMPTY(), XTL_EXPAND(__VA_ARGS__))
+
+#if !defined(XTL_TRACE_BUFFER_SIZE)
+    /// Number of records in the ring buffer of each thread, a power of 2.
+    /// Older records are overwritten when it is not flushed often enough.
+    #define XTL_TRACE_BUFFER_SIZE 4096
+#endif
+
+#if !defined(XTL_TRACE_MAX_SUBJECTS)
+    /// Number of vtbl pointers in each record, the rest of subjects is not traced
+    #define XTL_TRACE_MAX_SUBJECTS 2
+#endif
+
+//------------------------------------------------------------------------------
+
+#if !defined(XTL_STATIC_PROBES)
+    /// Flag enabling static probes (SystemTap SDT/USDT notes on ELF platforms)
+    /// in provider mach7, fired with the address of the map and a vtbl pointer
+    /// on misses and updates of vtbl maps, on replacement of the cache
+    /// descriptor of a multi-threaded vtblmap, and with the vtbl pointer and 
+    /// index of the target type on the dynamic_cast of memoized_cast that 
+    /// computes an offset (\see probes.hpp). Tools like bpftrace or perf can
+    /// attach to them in a running program without rebuilding it.
+    /// \note An unattached probe is a nop on the slow path with its two 
+    ///       arguments in registers. The hit paths have none.
+    #define XTL_STATIC_PROBES 0
+#endif
+#define XTL_STATIC_PROBES_ONLY(...) XTL_IF(XTL_NOT(XTL_STATIC_PROBES), XTL_EMPTY(), XTL_EXPAND(__VA_ARGS__))
+
+//------------------------------------------------------------------------------
+
+#if !defined(XTL_OVERHEAD_ACCOUNTING)
+    /// Flag enabling global counters of the heap allocations made by the 
+    /// dispatch machinery (descriptors and entries of vtbl maps, offsets of 
+    /// memoized_cast, caches of Match statements on kinds, compiled regular
+    /// expressions), of the dynamic_casts it performs and of the updates of 
+    /// vtbl maps, reported by mch::overhead_report() (\see overhead.hpp).
+    /// Comparing two reports around a steady-state workload confirms that its
+    /// Match statements neither allocate nor call into RTTI anymore.
+    /// \note Each counted event pays a relaxed atomic increment. Nothing is 
+    ///       counted and no code is generated when the flag is off.
+    #define XTL_OVERHEAD_ACCOUNTING 0
+#endif
+#define XTL_OVERHEAD_ACCOUNTING_ONLY(...) XTL_IF(XTL_NOT(XTL_OVERHEAD_ACCOUNTING), XTL_EMPTY(), XTL_EXPAND(__VA_ARGS__))
+
+//------------------------------------------------------------------------------
+
+#if !defined(XTL_CAST_PROFILING)
+    /// Flag enabling counters of memoized_cast per pair of source and target 
+    /// types: calls, misses that had to call dynamic_cast and casts that
+    /// failed. mch::for_each_cast_profile() enumerates the pairs used so far 
+    /// together with the number of vtbls and bytes in the offsets of their 
+    /// source type, mch::dump_cast_profiles() prints them busiest first. The 
+    /// profile shows which uses of memoized_cast (e.g. through 
+    /// #define dynamic_cast memoized_cast) are worth a Match statement or a
+    /// dispatch on kinds instead (\see memoized_cast.hpp).
+    /// \note Each cast pays two or three relaxed atomic increments.
+    #define XTL_CAST_PROFILING 0
+#endif
+#define XTL_CAST_PROFILING_ONLY(...) XTL_IF(XTL_NOT(XTL_CAST_PROFILING), XTL_EMPTY(), XTL_EXPAND(__VA_ARGS__))
+
+#if !defined(XTL_CHECKED)
+    /// Flag turning debug builds (_DEBUG) into checked ones, whose Match 
+    /// statements run at close to the speed of release builds:
+    /// - the lookup functions of vtbl maps on the hit path of Match statements
+    ///   are compiled optimized even in unoptimized builds (\see #XTL_HOT_PATH);
+    /// - #XTL_ASSERT keeps checking its cheap invariants there, but reports 
+    ///   failures from an out-of-line function instead of inline std::cerr code;
+    /// - checks of a whole vtbl map (#XTL_CONSISTENCY_CHECK) run only on its
+    ///   update path, when a new vtbl pointer rearranges the map.
+    /// \note Only GCC can optimize individual functions, on other compilers 
+    ///       the flag only affects assertions.
+    #define XTL_CHECKED 0
+#endif
+#define XTL_CHECKED_ONLY(...) XTL_IF(XTL_NOT(XTL_CHECKED), XTL_EMPTY(), XTL_EXPAND(__VA_ARGS__))
+
+// XTL_TRACE_FILE is not defined by default. When it is defined as a string 
+// literal naming a file, a program built with #XTL_TRACE_MATCH_SITES flushes
+// the records left in the buffers into that file at exit.
+
+//------------------------------------------------------------------------------
+
 #if !defined(XTL_TRACE_LIKELINESS)
     /// A macro that enables tracing of XTL_LIKELY and XTL_UNLIKELY macros to 
     /// ensure the actual calls match what we've put in code. Not for user code.
@@ -99,6 +318,44 @@
     #define XTL_UNLIKELY(c) (mch::trace_likeliness<false,__LINE__,decltype(XTL_FUNCTION)>(c,#c,__FILE__))
 #endif
 
+// XTL_LIKELINESS_PROFILE is not defined by default. When it is defined as a 
+// string literal naming a header file, a program built with tracing of 
+// likeliness writes into that file at exit the conditions of XTL_LIKELY and 
+// XTL_UNLIKELY whose hint disagreed with how they actually went. A subsequent
+// build of the same sources without the tracing includes that file and hints
+// those conditions the other way, \see mch::likeliness_hint.
+#if defined(XTL_LIKELINESS_PROFILE) && !XTL_TRACE_LIKELINESS
+    #include "debug.hpp"
+    #include XTL_LIKELINESS_PROFILE
+    #define XTL_EXPECTED(d,text) mch::likeliness_hint<__LINE__>::get(__FILE__,text,d)
+#else
+    /// Value the condition with a given text is expected to have at this 
+    /// line when it is d by default. Used by compilers with branch hinting.
+    #define XTL_EXPECTED(d,text) d
+#endif
+
+#if !defined(XTL_TRACE_FREQUENCY)
+    /// Flag enabling counting of classes of subjects seen by Match statements
+    /// on vtbl-pointers, which is reported at exit along with the locations of
+    /// #FQ in bindings of those classes, \see mch::frequency_profile.
+    /// \note Has an overhead of a map lookup per execution of Match statement.
+    #define XTL_TRACE_FREQUENCY 0
+#endif
+#define XTL_TRACE_FREQUENCY_ONLY(...) XTL_IF(XTL_NOT(XTL_TRACE_FREQUENCY), XTL_EMPTY(), XTL_EXPAND(__VA_ARGS__))
+
+// XTL_FREQUENCY_PROFILE is not defined by default. When it is defined as a 
+// string literal naming a header file, a program built with tracing of 
+// frequencies writes into that file at exit the number of subjects of each 
+// class seen by its Match statements. A subsequent build of the same sources 
+// without the tracing includes that file and uses those numbers instead of 
+// the values given to #FQ in bindings of the classes, \see mch::frequency_hint.
+
+// XTL_FREQUENCY_COUNTS is not defined by default. When it is defined as a 
+// string literal naming a file, a program built with tracing of frequencies 
+// writes into that file at exit the same numbers keyed by type names, which 
+// test/time/merge_profiles.cpp adds up across runs and hosts into a single 
+// #XTL_FREQUENCY_PROFILE, \see mch::write_frequency_counts.
+
 //------------------------------------------------------------------------------
 
 #if !defined(XTL_MESSAGE_ENABLED)
@@ -108,11 +365,13 @@
 
 #if !defined(XTL_USE_VTBL_FREQUENCY)
     /// When this macro is defined, vtblmaps will count frequency of requests using a
-    /// given vtbl pointer and will take it into account during rearranging of the map.
+    /// given vtbl pointer and will take it into account during rearranging of the map:
+    /// the most requested vtbls keep their expected cache entries, while rarer ones
+    /// that collide with them are pushed along the LCG walk. The counts are halved
+    /// on each rearrangement, so they reflect recent requests.
     /// \note This introduces a slight performance overhead to the most frequent path,
-    ///       but supposedly will pay when no zero conflict is possible.
-    /// \deprecated This macro will be deprecated as tracing frequency was not improving
-    ///       performance enough to justify the overhead it introduces.
+    ///       but supposedly will pay when no zero conflict is possible. Compare the
+    ///       hits/misses/collisions counters of #XTL_DUMP_PERFORMANCE to decide.
     #define XTL_USE_VTBL_FREQUENCY 0
 #endif
 #define XTL_USE_VTBL_FREQUENCY_ONLY(...) XTL_IF(XTL_NOT(XTL_USE_VTBL_FREQUENCY), XTL_EMPTY(), XTL_EXPAND(__VA_ARGS__))
@@ -129,6 +388,21 @@
 #define XTL_REDUNDANCY_ONLY(...)     XTL_IF(XTL_NOT(XTL_REDUNDANCY_CHECKING), XTL_EMPTY(), XTL_EXPAND(__VA_ARGS__))
 #define XTL_NON_REDUNDANCY_ONLY(...) XTL_IF(        XTL_REDUNDANCY_CHECKING,  XTL_EMPTY(), XTL_EXPAND(__VA_ARGS__))
 
+#if !defined(XTL_STATIC_REDUNDANCY_CHECKING)
+    /// Whether Case clauses of Match statements of type_switchN-patterns.hpp 
+    /// should be checked at compile time against the preceding clauses that 
+    /// accept every subject of their target types, i.e. those of type patterns,
+    /// variables and wildcards only, as well as Otherwise(). A clause whose 
+    /// target types are those of such a clause or derived from them can only
+    /// be reached by falling through from a preceding clause. Such a clause does
+    /// no dynamic casts on cache misses, which are then known to fail, and when
+    /// #XTL_FALL_THROUGH is 0, the compiler reports it with a deprecation 
+    /// warning. Unlike #XTL_REDUNDANCY_CHECKING, Match statements are executed
+    /// as usual. Off by default, since the warning breaks builds with warnings
+    /// treated as errors.
+    #define XTL_STATIC_REDUNDANCY_CHECKING 0
+#endif
+
 #if !defined(XTL_CLAUSES_NUM_ESTIMATES_TYPES_NUM)
     /// When this macro is 1, we use the number of clauses in the Match statements
     /// as an estimate of the number of types that will pass through that statement.
@@ -152,6 +426,9 @@
     /// By default we enable preloading as it makes the code smaller and somewhat faster,
     /// but one should understand that preloading default initializes the object, so 
     /// passing additional arguments or deferred constatnt values is not possible.
+    /// Preloaded vtblmap<T> objects are constant-initialized and only allocate
+    /// their cache on the first lookup, so unexecuted Match statements cost
+    /// nothing at startup, \see vtblmap3st.hpp.
     #define XTL_PRELOAD_LOCAL_STATIC_VARIABLES 1
 #endif
 
@@ -164,6 +441,52 @@
     #define XTL_PRELOADABLE_LOCAL_STATIC(Type,Name,UID,...) static Type Name XTL_IF(XTL_IS_EMPTY(__VA_ARGS__), XTL_EMPTY(), (XTL_EXPAND(__VA_ARGS__)))
 #endif
 
+#if !defined(XTL_DISPATCH_SECTIONS)
+    /// Whether the variables preallocated for Match statements, like the 
+    /// headers of their vtbl maps, are placed into a section of their own 
+    /// (#XTL_DISPATCH_SECTION) instead of being scattered among other static
+    /// data, so that those of the statements executed together share cache 
+    /// lines and pages with each other rather than with cold data. The vtbl 
+    /// maps of the statements whose policy is mch::hot_dispatch go into yet 
+    /// another section (#XTL_HOT_DISPATCH_SECTION) and thus pack together.
+    /// Both sections keep their initial image in the file, as sections named
+    /// by the program do. GCC ignores the attribute on static members of class
+    /// templates and keeps each of them in a section of its own, which a linker
+    /// section ordering (e.g. --symbol-ordering-file) can then group by hotness.
+    /// \see mch::write_hot_vtbl_sites()
+    #define XTL_DISPATCH_SECTIONS 0
+#endif
+
+#if !defined(XTL_DISPATCH_SECTION)
+    /// Name of the section of variables preallocated for Match statements.
+    /// Names that are identifiers make ELF linkers define __start_ and __stop_
+    /// symbols around the section. \see #XTL_DISPATCH_SECTIONS
+    #if defined(__APPLE__)
+    #define XTL_DISPATCH_SECTION "__DATA,mch_dispatch"
+    #else
+    #define XTL_DISPATCH_SECTION "mch_dispatch"
+    #endif
+#endif
+
+#if !defined(XTL_HOT_DISPATCH_SECTION)
+    /// Name of the section of vtbl maps of Match statements with policy 
+    /// mch::hot_dispatch. \see #XTL_DISPATCH_SECTIONS
+    #if defined(__APPLE__)
+    #define XTL_HOT_DISPATCH_SECTION "__DATA,mch_hot_dispatch"
+    #else
+    #define XTL_HOT_DISPATCH_SECTION "mch_hot_dispatch"
+    #endif
+#endif
+
+#if XTL_DISPATCH_SECTIONS
+    /// Placement of the definitions of preallocated variables
+    #define XTL_DISPATCH_PLACEMENT     XTL_SECTION(XTL_DISPATCH_SECTION)
+    #define XTL_HOT_DISPATCH_PLACEMENT XTL_SECTION(XTL_HOT_DISPATCH_SECTION)
+#else
+    #define XTL_DISPATCH_PLACEMENT
+    #define XTL_HOT_DISPATCH_PLACEMENT
+#endif
+
 #if !defined(XTL_FALL_THROUGH)
     /// When this macro is 1 the fall-through behavior of the underlying switch
     /// statement is enabled. It becomes up to the user to use break statements to 
@@ -225,9 +548,350 @@
 
 #if !defined(XTL_MULTI_THREADING)
     /// Whether pattern-matching constructs can be used in multi-threading context
+    /// \note Affects both vtblmap<T> (\see vtblmap3mt.hpp) used by single-subject
+    ///       Match statements and vtbl_map<N,T> (\see vtblmap4mt.hpp) used by
+    ///       Match statements on multiple subjects.
     #define XTL_MULTI_THREADING 0
 #endif
 
+#if !defined(XTL_THREAD_LOCAL_CACHE)
+    /// Whether multi-threaded vtbl maps should be fronted by a small per-thread
+    /// direct-mapped cache (\see vtblcache.hpp) of #XTL_LOCAL_CACHE_LOG_SIZE 
+    /// entries. Hits in it only read thread-local memory, which avoids cache 
+    /// line traffic on the shared map when many threads dispatch on the same
+    /// Match statements. Only has effect together with #XTL_MULTI_THREADING.
+    #define XTL_THREAD_LOCAL_CACHE 0
+#endif
+
+#if !defined(XTL_RECLAIM_DESCRIPTORS)
+    /// Whether descriptors replaced in multi-threaded vtblmap<T> (\see vtblmap3mt.hpp)
+    /// should be deallocated once no thread can be reading them (\see vtblreclaim.hpp)
+    /// instead of being kept until the map is destroyed. Costs every lookup 
+    /// in the shared map a store to a thread-local counter. Only has effect
+    /// together with #XTL_MULTI_THREADING.
+    #define XTL_RECLAIM_DESCRIPTORS 0
+#endif
+
+#define XTL_RECLAIM_DESCRIPTORS_ONLY(...)     XTL_IF(XTL_NOT(XTL_RECLAIM_DESCRIPTORS), XTL_EMPTY(), XTL_EXPAND(__VA_ARGS__))
+#define XTL_NON_RECLAIM_DESCRIPTORS_ONLY(...) XTL_IF(        XTL_RECLAIM_DESCRIPTORS,  XTL_EMPTY(), XTL_EXPAND(__VA_ARGS__))
+
+#if !defined(XTL_TYPE_PROFILE)
+    /// Whether Match statements on multiple subjects should enroll with 
+    /// mch::type_profile (\see vtblprofile.hpp), which can save what they have
+    /// learned about the dynamic types of their subjects and reload it on the
+    /// next run of the program to avoid warming up their caches again.
+    #define XTL_TYPE_PROFILE 0
+#endif
+#define XTL_TYPE_PROFILE_ONLY(...)     XTL_IF(XTL_NOT(XTL_TYPE_PROFILE), XTL_EMPTY(), XTL_EXPAND(__VA_ARGS__))
+
+#if !defined(XTL_TYPE_REGISTRATION)
+    /// Whether Match statements on a single polymorphic subject should enroll
+    /// their clauses with mch::type_registry before main(), so that a call to
+    /// mch::register_types<S,Ds...>() resolves classes Ds against all the 
+    /// statements on subjects of static type S and fills their vtbl maps
+    /// before any of them is executed (\see type_registry.hpp).
+    #define XTL_TYPE_REGISTRATION 0
+#endif
+#define XTL_TYPE_REGISTRATION_ONLY(...) XTL_IF(XTL_NOT(XTL_TYPE_REGISTRATION), XTL_EMPTY(), XTL_EXPAND(__VA_ARGS__))
+
+#if XTL_TYPE_REGISTRATION && !XTL_PRELOAD_LOCAL_STATIC_VARIABLES
+    #error XTL_TYPE_REGISTRATION requires XTL_PRELOAD_LOCAL_STATIC_VARIABLES
+#endif
+
+#if !defined(XTL_CANONICAL_VTBLS)
+    /// Whether a tuple of vtbl pointers seen for the first time by a vtbl map
+    /// should take the value learned for another tuple in the map, whose vtbl
+    /// pointers belong to the same classes (as told by their type_info) and 
+    /// the same sub-objects of them. A class whose vtbl gets duplicated in 
+    /// several shared libraries then runs the clauses of a Match statement once
+    /// for all copies. Lookups remain keyed by vtbl pointers, so every copy 
+    /// still takes its own cache entry. Costs every miss that adds a tuple a 
+    /// scan of the cache. Has no effect together with #XTL_MULTI_THREADING.
+    /// \note Not available with #XTL_VALUE_SUBJECT_DISPATCH, whose keys are
+    ///       not all vtbl pointers.
+    #define XTL_CANONICAL_VTBLS 0
+#endif
+
+#if !defined(XTL_SEPARATE_DEFAULTS)
+    /// Whether a Match statement tells its vtbl map which tuples of vtbl 
+    /// pointers resolved to its Otherwise() clause or to no clause at all, so
+    /// that the map keeps them in a compact set of tuples sharing one value 
+    /// instead of in entries of its cache. A site that sees hundreds of classes
+    /// of which only a few reach a Case clause then keeps a cache sized for the
+    /// few, while the rest cost a miss and a lookup in the set. Default tuples 
+    /// stay in the cache until a new tuple needs their room. Has no effect 
+    /// together with #XTL_MULTI_THREADING.
+    #define XTL_SEPARATE_DEFAULTS 0
+#endif
+#define XTL_SEPARATE_DEFAULTS_ONLY(...) XTL_IF(XTL_NOT(XTL_SEPARATE_DEFAULTS), XTL_EMPTY(), XTL_EXPAND(__VA_ARGS__))
+
+#if !defined(XTL_VALUE_SUBJECT_DISPATCH)
+    /// Whether subjects of integral and enumeration types of a Match statement
+    /// that also has polymorphic subjects (e.g. Match(shape,code)) should take
+    /// part in the lookup of its vtbl map together with the vtbl pointers of 
+    /// the polymorphic ones. The map then jumps straight to the first clause 
+    /// whose target types and whose literal values for those subjects match,
+    /// instead of to the first clause whose target types do, from which the 
+    /// values of subsequent clauses are tested one by one. Only subjects that
+    /// some clause tests against a literal take part with their values, and
+    /// each distinct value of them becomes its own entry in the map, so this
+    /// is off by default: subjects that take many different values are better
+    /// matched without it.
+    /// \note Not available with #XTL_TYPE_PROFILE, which saves vtbl pointers 
+    ///       only, or #XTL_CANONICAL_VTBLS.
+    #define XTL_VALUE_SUBJECT_DISPATCH 0
+#endif
+
+#if XTL_CANONICAL_VTBLS && XTL_VALUE_SUBJECT_DISPATCH
+    #error XTL_CANONICAL_VTBLS is not available with XTL_VALUE_SUBJECT_DISPATCH
+#endif
+
+#if !defined(XTL_EXACT_SUBJECTS)
+    /// Whether subjects of Match statements whose static type is the dynamic
+    /// one, like those of final classes (\see mch::is_exact_type), should be
+    /// treated as non-polymorphic: they do not take part in the lookup of the
+    /// vtbl map and the type tests of clauses on them are resolved at compile
+    /// time, so that a statement on such subjects only compiles into the code
+    /// of the clause it selects.
+    #define XTL_EXACT_SUBJECTS 1
+#endif
+
+#if !defined(XTL_LEARNED_CASE_ORDER)
+    /// Whether Match statements on a single polymorphic subject should resolve
+    /// a cache miss by first trying the Case clauses most often selected for
+    /// other dynamic types of the subject (\see mch::case_order), and only
+    /// then evaluate all the clauses top to bottom. This makes the first 
+    /// encounter of a new class cost a few dynamic casts instead of one per
+    /// clause preceding its target.
+    /// \warning The first clause in learned order rather than in source order
+    ///          is taken, so only enable this when no class can be a target of
+    ///          two Case clauses with different target types, e.g. when the 
+    ///          target types are leaves of the hierarchy.
+    /// \note Not synchronized, even with #XTL_MULTI_THREADING.
+    #define XTL_LEARNED_CASE_ORDER 0
+#endif
+#define XTL_LEARNED_CASE_ORDER_ONLY(...) XTL_IF(XTL_NOT(XTL_LEARNED_CASE_ORDER), XTL_EMPTY(), XTL_EXPAND(__VA_ARGS__))
+
+#if !defined(XTL_HIERARCHY_INDEX)
+    /// Whether case clauses of Match statements should test dynamic types of
+    /// subjects, for whose static types users declared all the dynamic classes
+    /// via mch::class_hierarchy (\see hierarchy.hpp), with tables generated at
+    /// compile time instead of dynamic_cast. A cache miss then costs a lookup
+    /// of std::type_info per subject and a table lookup per clause.
+    #define XTL_HIERARCHY_INDEX 0
+#endif
+#define XTL_HIERARCHY_INDEX_ONLY(...) XTL_IF(XTL_NOT(XTL_HIERARCHY_INDEX), XTL_EMPTY(), XTL_EXPAND(__VA_ARGS__))
+
+#if !defined(XTL_CLOSED_HIERARCHY_SWITCH)
+    /// Whether Match statements on a single subject of a closed hierarchy, i.e.
+    /// one declared with mch::class_hierarchy whose #bindings specify the kind
+    /// selector with KS, should find their jump target in a table indexed by 
+    /// kind instead of in their vtbl_map. Not available with 
+    /// #XTL_MULTI_THREADING, under which such statements use vtbl_map.
+    #define XTL_CLOSED_HIERARCHY_SWITCH !XTL_MULTI_THREADING
+#endif
+
+#if !defined(XTL_SHARED_CLASS_IDS)
+    /// Whether Match statements on a single polymorphic subject should find
+    /// their jump target in a small table indexed by an id of the dynamic class
+    /// of the subject, learned once per vtbl-pointer and shared by all Match 
+    /// statements on the same static type, instead of in their own vtbl_map. 
+    /// Features working on vtbl maps (e.g. #XTL_TYPE_PROFILE or 
+    /// #XTL_VTBL_COMPACTION) do not see such statements. Not available with
+    /// #XTL_MULTI_THREADING.
+    #define XTL_SHARED_CLASS_IDS 0
+#endif
+
+#if XTL_SHARED_CLASS_IDS && XTL_MULTI_THREADING
+    #error XTL_SHARED_CLASS_IDS is not available with XTL_MULTI_THREADING
+#endif
+
+#if !defined(XTL_USE_COMPUTED_GOTO)
+    /// Whether #Match of type_switchN-patterns.hpp and MatchP of match.hpp 
+    /// should remember in their vtbl map the address of the clause selected
+    /// for the dynamic types of the subjects and jump to it with goto * of 
+    /// GCC's labels as values. This saves the bounds check of the switch and
+    /// the load from its jump table, while targets recorded otherwise (e.g. 
+    /// with #XTL_TYPE_PROFILE or #XTL_LEARNED_CASE_ORDER) still go through it.
+    /// \note GCC never inlines functions with computed gotos, but clones made 
+    ///       of them by IPA-CP at -O3 share the vtbl map with the original and
+    ///       have labels of their own, so such code has to be compiled with
+    ///       -fno-ipa-cp-clone. Clang rejects computed gotos that may enter the
+    ///       scope of variables other Match statements declare, so the option 
+    ///       is only available with GCC.
+    #define XTL_USE_COMPUTED_GOTO 0
+#endif
+#define XTL_COMPUTED_GOTO_ONLY(...)     XTL_IF(XTL_NOT(XTL_USE_COMPUTED_GOTO), XTL_EMPTY(), XTL_EXPAND(__VA_ARGS__))
+#define XTL_NON_COMPUTED_GOTO_ONLY(...) XTL_IF(        XTL_USE_COMPUTED_GOTO,  XTL_EMPTY(), XTL_EXPAND(__VA_ARGS__))
+
+#if XTL_USE_COMPUTED_GOTO && (!defined(__GNUC__) || defined(__clang__))
+    #error XTL_USE_COMPUTED_GOTO requires labels as values of GCC
+#endif
+
+#if !defined(XTL_PACKED_SWITCH_INFO)
+    /// Whether type_switch_info<N>, which Match statements keep in the entries
+    /// of their vtbl_map, stores the case label and the this-pointer offsets 
+    /// in 32 bits each instead of in words. An entry of a map on one subject 
+    /// then takes 16 bytes instead of 24, and of a map on two subjects 40 
+    /// instead of 48, so that more of them share a cache line. The address of
+    /// the clause of #XTL_USE_COMPUTED_GOTO still takes a word.
+    /// \note Offsets of base class sub-objects have to fit in 32 bits, i.e. 
+    ///       objects matched on have to be smaller than 2 GB.
+    #define XTL_PACKED_SWITCH_INFO 0
+#endif
+
+#if !defined(XTL_STATIC_OFFSETS)
+    /// Whether Case clauses of Match statements find their target in a 
+    /// polymorphic subject with static_cast, instead of adding the offset 
+    /// remembered in the entry of the vtbl map, when no virtual base is on the
+    /// path from the type of the subject to the target, so that the offset is
+    /// known at compile time. This removes the load of the offset, which 
+    /// depends on the load of the entry, from the hit path. Offsets are still
+    /// remembered on cache misses, where each is also compared with the 
+    /// static one: a subject whose dynamic type has several sub-objects of its
+    /// static type may reach the target by a cross-cast, in which case the 
+    /// entry of that dynamic type gets a label of the clause that uses the 
+    /// remembered offsets instead.
+    #define XTL_STATIC_OFFSETS 0
+#endif
+#define XTL_STATIC_OFFSETS_ONLY(...) XTL_IF(XTL_NOT(XTL_STATIC_OFFSETS), XTL_EMPTY(), XTL_EXPAND(__VA_ARGS__))
+
+#if !defined(XTL_APPLICABLE_CLAUSES)
+    /// Whether type_switch_info<N> remembers which Case clauses of a Match 
+    /// statement apply to the dynamic types of its subjects. With 
+    /// #XTL_FALL_THROUGH, control that falls from the body of one clause into 
+    /// the next then tests a bit instead of casting the subjects again, so a
+    /// Match statement costs one lookup plus the bodies of applicable clauses.
+    /// Adds two 64-bit sets of clauses to each entry of the vtbl map; clauses
+    /// past the 64th are tested as before.
+    #define XTL_APPLICABLE_CLAUSES 0
+#endif
+#define XTL_APPLICABLE_CLAUSES_ONLY(...) XTL_IF(XTL_NOT(XTL_APPLICABLE_CLAUSES), XTL_EMPTY(), XTL_EXPAND(__VA_ARGS__))
+
+#if !defined(XTL_CASE_CANDIDATES)
+    /// Maximum number of Case clauses a Match statement remembers with 
+    /// #XTL_LEARNED_CASE_ORDER and tries on a cache miss.
+    #define XTL_CASE_CANDIDATES 4
+#endif
+
+#if !defined(XTL_PERFECT_HASHING)
+    /// Whether vtbl_map<N,T> can be frozen with vtbl_map::freeze() or 
+    /// mch::freeze_vtbl_maps() into a collision-free cache, once the set of 
+    /// dynamic types it sees is known to not change anymore. The cache index 
+    /// is then computed with a multiplicative hash, which costs an extra 
+    /// multiplication on every lookup, frozen or not.
+    /// \note Only affects single-threaded vtbl_map<N,T> (\see vtblmap4.hpp).
+    #define XTL_PERFECT_HASHING 0
+#endif
+#define XTL_PERFECT_HASHING_ONLY(...)  XTL_IF(XTL_NOT(XTL_PERFECT_HASHING), XTL_EMPTY(), XTL_EXPAND(__VA_ARGS__))
+
+#if !defined(XTL_INLINE_CACHE_SIZE)
+    /// Number of the most recently looked up tuples of vtbl pointers, from 0 
+    /// to 4, that vtbl_map<N,T> of each Match statement keeps with their cache 
+    /// entries in front of the cache. They are compared with the tuple of the 
+    /// subjects before its cache index is computed, which saves the shifts, 
+    /// masks and interleaving of N>1 vtbl pointers on sites that see the same 
+    /// few dynamic types in long runs, while costing up to 4 compares on the
+    /// others. The inline_ratio() of #XTL_VTBL_STATISTICS tells which is which.
+    /// \note Only affects single-threaded vtbl_map<N,T> (\see vtblmap4.hpp).
+    #define XTL_INLINE_CACHE_SIZE 0
+#endif
+
+#if XTL_INLINE_CACHE_SIZE > 4
+    #error XTL_INLINE_CACHE_SIZE cannot exceed 4
+#endif
+
+/// Whether vtbl maps have an inline cache \see #XTL_INLINE_CACHE_SIZE
+#if XTL_INLINE_CACHE_SIZE > 0 && !XTL_MULTI_THREADING
+    #define XTL_INLINE_CACHE 1
+#else
+    #define XTL_INLINE_CACHE 0
+#endif
+#define XTL_INLINE_CACHE_ONLY(...)     XTL_IF(XTL_NOT(XTL_INLINE_CACHE), XTL_EMPTY(), XTL_EXPAND(__VA_ARGS__))
+
+#if !defined(XTL_ADAPTIVE_DISPATCH)
+    /// Whether vtbl_map<N,T> of each Match statement profiles its first 
+    /// #XTL_ADAPTIVE_PROFILE_LENGTH lookups and then picks the engine that 
+    /// serves them: straight compares with the only tuple of vtbl pointers of 
+    /// a monomorphic site, with the few tuples of a site that sees no more 
+    /// than 4 of them (2 when N is 1, where the hash costs as much) or the 
+    /// hash of the cache for all the others. The next as many lookups time 
+    /// the chosen engine against the profile, both over their second halves 
+    /// to leave out the first misses, which takes the site back to 
+    /// the hash when compares turn out slower than it, while a site that 
+    /// keeps seeing tuples outside of its compares profiles again. Decisions 
+    /// and their measured benefit are reported by #XTL_VTBL_STATISTICS. The 
+    /// compares come before those of the inline cache \see #XTL_INLINE_CACHE_SIZE.
+    /// \note Dense tables of class ids and switches on closed hierarchies 
+    ///       are not among the engines, since they depend on declarations 
+    ///       \see #XTL_SHARED_CLASS_IDS, #XTL_CLOSED_HIERARCHY_SWITCH.
+    /// \note Only affects vtbl_map<N,T> of vtblmap4.hpp and lookups not 
+    ///       pinned by a dispatch_scope.
+    #define XTL_ADAPTIVE_DISPATCH 0
+#endif
+
+#if XTL_ADAPTIVE_DISPATCH && XTL_MULTI_THREADING
+    #error XTL_ADAPTIVE_DISPATCH is not available with XTL_MULTI_THREADING
+#endif
+#define XTL_ADAPTIVE_DISPATCH_ONLY(...) XTL_IF(XTL_NOT(XTL_ADAPTIVE_DISPATCH), XTL_EMPTY(), XTL_EXPAND(__VA_ARGS__))
+
+#if !defined(XTL_ADAPTIVE_PROFILE_LENGTH)
+    /// Number of lookups a vtbl_map<N,T> profiles before picking its engine 
+    /// and then times it for \see #XTL_ADAPTIVE_DISPATCH
+    #define XTL_ADAPTIVE_PROFILE_LENGTH 1024
+#endif
+
+#if XTL_ADAPTIVE_PROFILE_LENGTH < 4
+    #error XTL_ADAPTIVE_PROFILE_LENGTH has to be at least 4 for its second half to be timed
+#endif
+
+#if !defined(XTL_LEAN_MATCH)
+    /// Whether Match statements keep as few values as possible live across 
+    /// their dispatch, so that the hit path saves fewer callee-saved registers
+    /// and stores nothing to the stack. The handling of a miss and the 
+    /// dynamic_cast of clauses are out-of-line as under #XTL_OPTIMIZE_FOR_SIZE,
+    /// which keeps the arguments of __dynamic_cast from being hoisted into 
+    /// registers across clauses, vtbl_map<N,T> hands the former a copy of 
+    /// the tuple of vtbl pointers, so that the array of the caller does not 
+    /// escape, and #MatchP does not test the pointer cast by its last clause,
+    /// where the target already tells that none matched. Set it to 0 to 
+    /// compare with the wider expansion \see make lean in test/time.
+    #define XTL_LEAN_MATCH 1
+#endif
+
+#define XTL_LEAN_MATCH_ONLY(...)     XTL_IF(XTL_NOT(XTL_LEAN_MATCH), XTL_EMPTY(), XTL_EXPAND(__VA_ARGS__))
+#define XTL_NON_LEAN_MATCH_ONLY(...) XTL_IF(        XTL_LEAN_MATCH,  XTL_EMPTY(), XTL_EXPAND(__VA_ARGS__))
+
+#if !defined(XTL_TUNED_VTBL_MAP_POLICY)
+    /// Whether type_switch.hpp sets #XTL_VTBL_MAP_POLICY to the policy of vtbl
+    /// maps that test/time/type_switch_strategies.cpp measured to be the 
+    /// fastest for the compiler and architecture in use. Off by default, so 
+    /// that including type_switch.hpp does not change the default policy of
+    /// vtblmap4.hpp on the strength of a few measurements.
+    #define XTL_TUNED_VTBL_MAP_POLICY 0
+#endif
+
+#if !defined(XTL_PERFECT_HASH_ATTEMPTS)
+    /// Number of multipliers vtbl_map::freeze() tries for each cache size and shift
+    #define XTL_PERFECT_HASH_ATTEMPTS 256
+#endif
+
+#if !defined(XTL_USE_PDEP)
+    /// Whether interleave() in ptrtools.hpp, which combines vtbl-pointers of 
+    /// subjects of N-ary Match statements into a key of their cache, deposits
+    /// bits with the PDEP instruction of BMI2 instead of spreading them with 
+    /// shifts or lookup tables. Selected at compile time, since a check of the
+    /// processor on every lookup would cost more than it saves, so it is on by
+    /// default only when the target is known to have BMI2 (e.g. -mbmi2 or 
+    /// -march=haswell).
+    /// \note PDEP is microcoded and slow on AMD processors before Zen 3.
+    #if defined(__BMI2__)
+        #define XTL_USE_PDEP 1
+    #else
+        #define XTL_USE_PDEP 0
+    #endif
+#endif
+
 //------------------------------------------------------------------------------
 
 #if !defined(XTL_DEFAULT_SYNTAX)
@@ -243,6 +907,17 @@
     #define XTL_DEFAULT_SYNTAX 'G'
 #endif
 
+#if !defined(XTL_EXCEPTION_FREE_MATCHE)
+    /// Whether MatchE and MatchX statements should select their clauses with
+    /// a hierarchy walk memoized per vtbl-pointer of the subject, instead of
+    /// raising the subject and catching it by the types of the clauses. The 
+    /// clause selected is the same: the first one whose target type is an 
+    /// unambiguous public base of the dynamic type of the subject, but #RS is
+    /// no longer required and matched refers to the subject itself rather than
+    /// to a copy of it.
+    #define XTL_EXCEPTION_FREE_MATCHE 0
+#endif
+
 //------------------------------------------------------------------------------
 
 #if !defined(XTL_EXTRACTORS_MIGHT_THROW)
@@ -253,6 +928,11 @@
     ///    * Treat it as failed match
     /// Note that in any case exceptions inside statements associated with case 
     /// clauses are not intercepted in any way.
+    /// Exception handling is only generated for clauses whose constructor 
+    /// patterns apply accessors of #bindings that might throw: data members 
+    /// never do, while member and external functions do unless declared 
+    /// noexcept and noexcept is a part of their type (C++17), 
+    /// \see mch::extractors_might_throw.
     /// By default we assume that for a given code using our library extractors 
     /// won't throw and thus we do not generate the necessary exception handling code
     #define XTL_EXTRACTORS_MIGHT_THROW 0
@@ -260,6 +940,8 @@
 
 #if XTL_EXTRACTORS_MIGHT_THROW
     #if !defined(EXTRACTORS_PROPAGATE_THROW)
+    /// Whether exceptions thrown by extractors propagate out of the Match 
+    /// statement (1) or make the clause fail to match (0)
     #define EXTRACTORS_PROPAGATE_THROW 0
     #endif
 #endif
@@ -268,10 +950,84 @@
 
 #if !defined(XTL_USE_MEMOIZED_CAST)
     /// Another choice is whether library code should try to benefit from memoized_cast 
-    /// or just use dynamic_cast 
+    /// or just use dynamic_cast. With type_switchN-patterns-xtl.hpp this memoizes
+    /// the user-defined casts plugged in through xtl::subtype_dynamic_cast.
     #define XTL_USE_MEMOIZED_CAST 0
 #endif
 
+#if !defined(XTL_MEMOIZE_NESTED_TYPE_TESTS)
+    /// Whether constructor patterns applied to subjects of a different static
+    /// type, e.g. because they are nested in other patterns, should memoize the
+    /// outcome of their type test per vtbl-pointer of the subject instead of 
+    /// calling dynamic_cast every time. The test is then shared by all the 
+    /// clauses that repeat it, e.g. C<Plus>(C<Times>(a,b),c) and 
+    /// C<Plus>(C<Times>(a,b),C<Value>()). Unlike #XTL_USE_MEMOIZED_CAST, this
+    /// does not affect uses of dynamic_cast outside of the library.
+    #define XTL_MEMOIZE_NESTED_TYPE_TESTS 0
+#endif
+
+#if !defined(XTL_MEMOIZE_MEMBERS)
+    /// Whether values of members returned by accessor functions named in
+    /// bindings should be memoized for the duration of a Match statement, so
+    /// that several clauses and Qua/When sub-clauses decomposing the same object
+    /// call each accessor only once. Only members returning references or 
+    /// values of scalar types are memoized, accessors are assumed to return the
+    /// same value while the Match statement is being evaluated.
+    #define XTL_MEMOIZE_MEMBERS 0
+#endif
+
+#define XTL_MEMOIZE_MEMBERS_ONLY(...) XTL_IF(XTL_NOT(XTL_MEMOIZE_MEMBERS), XTL_EMPTY(), XTL_EXPAND(__VA_ARGS__))
+
+#if !defined(XTL_REGEX_SETS)
+    /// Whether rex() patterns of the clauses of a Match statement should be
+    /// combined into a set of expressions, which finds the first of them that
+    /// matches the subject in one pass, so that the other clauses do not run 
+    /// their own expressions and only the one taken extracts capture groups.
+    /// Requires the engine to support sets, \see mch::std_regex_engine, and
+    /// pays off with engines that scan for all expressions of a set at once, 
+    /// e.g. built on RE2::Set, rather than std::regex, whose set is an ordered
+    /// alternation tried one expression after another. The subject is assumed
+    /// to not change while the Match statement is evaluated.
+    #define XTL_REGEX_SETS 0
+#endif
+
+#define XTL_REGEX_SETS_ONLY(...) XTL_IF(XTL_NOT(XTL_REGEX_SETS), XTL_EMPTY(), XTL_EXPAND(__VA_ARGS__))
+
+#if !defined(XTL_REORDER_BY_COST)
+    /// Whether conjunction and disjunction patterns should try first the operand
+    /// with smaller mch::pattern_cost instead of the one written first, e.g. a
+    /// value before a regular expression. The operands are assumed independent:
+    /// patterns that use values of variables (guards, equivalence) are never 
+    /// tried before others, but alternatives of a disjunction that bind the 
+    /// same variable may end up binding it differently.
+    #define XTL_REORDER_BY_COST 0
+#endif
+
+#if !defined(XTL_CONSTEXPR_VARIABLES)
+    /// Flag making variable patterns on non-class types bindable inside constexpr
+    /// functions (requires C++14 relaxed constexpr, see #XTL_CONSTEXPR14).
+    /// Constant evaluation does not allow reading mutable members, so the value
+    /// of such var<T> is then kept in a regular member that binding assigns 
+    /// through const_cast. Variables bound this way must not be declared const.
+    /// Variables on class types are always bindable and are not affected.
+    #define XTL_CONSTEXPR_VARIABLES 0
+#endif
+
+#if !defined(XTL_HOIST_PATTERNS)
+    /// Whether patterns of a clause that neither refer to variables nor change
+    /// when matched (\see mch::is_hoistable) should be constructed only the 
+    /// first time control reaches the clause instead of on every execution. 
+    /// Values in such patterns are assumed to be constants: a value pattern 
+    /// made of a const variable keeps the value the variable had the first time.
+    #define XTL_HOIST_PATTERNS 0
+#endif
+
+#if XTL_HOIST_PATTERNS
+    #define XTL_HOIST_PATTERN(...) mch::hoisted([&]() -> decltype(__VA_ARGS__) { return __VA_ARGS__; })
+#else
+    #define XTL_HOIST_PATTERN(...) __VA_ARGS__
+#endif
+
 //------------------------------------------------------------------------------
 
 #if !defined(XTL_MIN_LOG_SIZE)
@@ -280,23 +1036,310 @@
 #endif
 
 #if !defined(XTL_MAX_LOG_SIZE)
-    /// Log of the largest cache size to try
-    /// \deprecated This macro is deprecated now and is only used with old vtblmap implementations
+    /// Log of the largest cache size to try with old vtblmap implementations.
+    /// Also the log of the capacity of vtbl maps with static storage by default.
+    /// \see #XTL_STATIC_VTBL_MAPS
     #define XTL_MAX_LOG_SIZE 14
 #endif
 
+#if !defined(XTL_MAX_TUNED_LOG_SIZE)
+    /// Log of the largest cache of vtblmap<T> whose shift is tuned to the vtbl
+    /// pointers in it. Caches outgrowing it become open addressing tables that
+    /// double once 3/4 full, so that programs with generated hierarchies of
+    /// 10^5 classes neither search for a shift nor outgrow the cache.
+    #if XTL_MAX_LOG_SIZE < 8
+    #define XTL_MAX_TUNED_LOG_SIZE XTL_MAX_LOG_SIZE
+    #else
+    #define XTL_MAX_TUNED_LOG_SIZE 8
+    #endif
+#endif
+
+#if XTL_MAX_TUNED_LOG_SIZE > XTL_MAX_LOG_SIZE
+    #error XTL_MAX_TUNED_LOG_SIZE cannot exceed XTL_MAX_LOG_SIZE
+#endif
+
 #if !defined(XTL_MAX_LOG_INC)
     /// Log of the maximum allowed increased from the minimum requred log size (1 means twice from the min required size)
     #define XTL_MAX_LOG_INC 1
 #endif
 
+#if !defined(XTL_RUNTIME_TUNING)
+    /// Whether #XTL_MIN_LOG_SIZE, #XTL_MAX_LOG_INC and the number of collisions
+    /// vtbl_map<N,T> tolerates before its first update are only defaults that
+    /// environment variables XTL_MIN_LOG_SIZE, XTL_MAX_LOG_INC and 
+    /// XTL_INITIAL_COLLISIONS or changes of mch::vtbl_tuning() override, so 
+    /// that trying another setting does not take a rebuild.
+    /// \note Only constructors and updates of vtbl maps read them, not lookups.
+    ///       Maps of Match statements may be constructed during static 
+    ///       initialization (\see #XTL_PRELOAD_LOCAL_STATIC_VARIABLES), so 
+    ///       only the environment sets the cache size they start with.
+    #define XTL_RUNTIME_TUNING 0
+#endif
+#define XTL_RUNTIME_TUNING_ONLY(...) XTL_IF(XTL_NOT(XTL_RUNTIME_TUNING), XTL_EMPTY(), XTL_EXPAND(__VA_ARGS__))
+
+#if !defined(XTL_CALIBRATE_VTBL_BITS)
+    /// Whether the number of irrelevant lowest bits of vtbl-pointers, which 
+    /// vtbl maps start hashing with, should be measured at run time from 
+    /// the vtbl-pointers of a few probe classes instead of being taken from 
+    /// #XTL_IRRELEVANT_VTBL_BITS, which is only a per-compiler guess.
+    /// \see mch::vtbl_irrelevant_bits
+    #define XTL_CALIBRATE_VTBL_BITS 1
+#endif
+
+#if !defined(XTL_STRIP_VTBL_SIGNATURES)
+    /// Whether pointer authentication codes, which arm64e keeps in the high 
+    /// bits of vtbl-pointers stored in objects, should be stripped by 
+    /// mch::vtbl_of() before vtbl maps hash them. The codes of vtbl-pointers 
+    /// to the same vtbl differ when they are signed with addresses of the
+    /// objects too, and otherwise add high bits that differ between vtbls, 
+    /// which the shift learned by vtbl maps cannot ignore. Uses ptrauth_strip()
+    /// where the compiler provides it or #XTL_VTBL_ADDRESS_BITS.
+    #define XTL_STRIP_VTBL_SIGNATURES 1
+#endif
+
+#if !defined(XTL_VTBL_ADDRESS_BITS)
+    /// Number of lowest bits of vtbl-pointers that hold the address of the
+    /// vtbl on platforms that keep tags or authentication codes above them, 
+    /// which #XTL_STRIP_VTBL_SIGNATURES then clears instead of calling 
+    /// ptrauth_strip(). 0 when all bits are the address.
+    #define XTL_VTBL_ADDRESS_BITS 0
+#endif
+
 #if !defined(XTL_LOCAL_CACHE_LOG_SIZE)
     /// Log of the size of the local cache - the one we use to avoid allocating
     /// memory from heap in early stages.
-    /// \deprecated This macro is deprecated now and is only used with old vtblmap implementations
+    /// \note Also used as log of the size of the per-thread front cache when
+    ///       #XTL_THREAD_LOCAL_CACHE is enabled.
     #define XTL_LOCAL_CACHE_LOG_SIZE 7
 #endif
 
+#if !defined(XTL_CACHE_LINE_SIZE)
+    /// Size of the cache line in bytes, to which vtbl_map<N,T> aligns its 
+    /// cache descriptors and arrays of cache entries.
+    #define XTL_CACHE_LINE_SIZE 64
+#endif
+
+#if !defined(XTL_VTBL_ARENA)
+    /// Whether single-threaded vtbl_map<N,T> should place its cache descriptors
+    /// and cache entries in a dedicated arena (\see vtbl_arena) instead of the
+    /// global heap. The arena keeps the data of all vtbl maps next to each 
+    /// other and away from the objects of the program. Memory of descriptors
+    /// replaced during updates is not reused until the end of the program.
+    #define XTL_VTBL_ARENA 0
+#endif
+
+#if !defined(XTL_VTBL_ARENA_CHUNK_SIZE)
+    /// Size in bytes of the chunks in which #XTL_VTBL_ARENA gets memory from the heap
+    #define XTL_VTBL_ARENA_CHUNK_SIZE 65536
+#endif
+
+#if !defined(XTL_ARENA_CHUNK_SIZE)
+    /// Default size in bytes of the chunks in which mch::arena<T> gets memory
+    /// for objects of a class hierarchy from the heap, \see arena.hpp
+    #define XTL_ARENA_CHUNK_SIZE 65536
+#endif
+
+#if !defined(XTL_MEMO_LOG_SIZE)
+    /// Default log of the number of results mch::memoized remembers, after 
+    /// which new results replace old ones, \see memoize.hpp
+    #define XTL_MEMO_LOG_SIZE 12
+#endif
+
+#if !defined(XTL_VTBL_ALLOCATOR)
+    /// Whether single-threaded vtbl_map<N,T> should get the memory for its 
+    /// cache descriptors and cache entries (or for the chunks of #XTL_VTBL_ARENA)
+    /// through mch::vtbl_allocator_hook() instead of directly from the global
+    /// heap, e.g. to place them on huge pages or on a particular NUMA node.
+    #define XTL_VTBL_ALLOCATOR 0
+#endif
+
+#if !defined(XTL_VTBL_COMPACTION)
+    /// Whether single-threaded vtbl_map<N,T> instances can be compacted with 
+    /// mch::compact_vtbl_maps() once their total memory use exceeds 
+    /// mch::vtbl_memory_budget(). Every lookup then marks the map as used, 
+    /// which costs one store.
+    #define XTL_VTBL_COMPACTION 0
+#endif
+#define XTL_VTBL_COMPACTION_ONLY(...)  XTL_IF(XTL_NOT(XTL_VTBL_COMPACTION), XTL_EMPTY(), XTL_EXPAND(__VA_ARGS__))
+
+#if !defined(XTL_VTBL_MEMORY_BUDGET)
+    /// Initial value of mch::vtbl_memory_budget() in bytes
+    #define XTL_VTBL_MEMORY_BUDGET 1048576
+#endif
+
+#if !defined(XTL_DEFERRED_VTBL_UPDATES)
+    /// Whether vtbl_map<N,T> instances that had enough collisions to justify 
+    /// a rearrangement of their cache only mark themselves as needing one and
+    /// keep using their current cache, leaving the rearrangement to the next 
+    /// call of mch::rearrange_vtbl_maps(). Under #XTL_MULTI_THREADING it can 
+    /// be called from a helper thread, otherwise when the program is idle. 
+    /// Caches that are full are still grown right away.
+    #define XTL_DEFERRED_VTBL_UPDATES 0
+#endif
+#define XTL_DEFERRED_VTBL_UPDATES_ONLY(...) XTL_IF(XTL_NOT(XTL_DEFERRED_VTBL_UPDATES), XTL_EMPTY(), XTL_EXPAND(__VA_ARGS__))
+
+#if !defined(XTL_INCREMENTAL_VTBL_UPDATES)
+    /// Whether single-threaded vtbl_map<N,T> instances that had enough 
+    /// collisions to justify a rearrangement of their cache search for its 
+    /// new log size and shifts a step at a time, one candidate per subsequent
+    /// miss, and only rebuild the cache once the search is over. Caches that 
+    /// are full are doubled right away with their current shifts. No call thus
+    /// does more than a few passes over the cache, which bounds the latency of
+    /// the misses that would otherwise pay for the whole search at once. Caches
+    /// of mch::cuckoo_probing still do their displacements and updates at once.
+    #define XTL_INCREMENTAL_VTBL_UPDATES 0
+#endif
+#define XTL_INCREMENTAL_VTBL_UPDATES_ONLY(...) XTL_IF(XTL_NOT(XTL_INCREMENTAL_VTBL_UPDATES), XTL_EMPTY(), XTL_EXPAND(__VA_ARGS__))
+
+#if XTL_INCREMENTAL_VTBL_UPDATES && XTL_DEFERRED_VTBL_UPDATES
+    #error XTL_INCREMENTAL_VTBL_UPDATES is not available with XTL_DEFERRED_VTBL_UPDATES
+#endif
+
+#if !defined(XTL_STATIC_VTBL_MAPS)
+    /// Whether Match statements keep their vtbl maps in storage of fixed 
+    /// capacity reserved statically, so that they never allocate memory. Each
+    /// such map has room for 2^#XTL_MAX_LOG_SIZE tuples of vtbl pointers unless
+    /// a Match statement picks another capacity with #XTL_VTBL_MAP_POLICY. 
+    /// Match statements run their case clauses sequentially for the tuples
+    /// that didn't fit. \see mch::vtbl_static_policy
+    #define XTL_STATIC_VTBL_MAPS 0
+#endif
+
+#if !defined(XTL_STATIC_VTBL_REPORT)
+    /// Whether each vtbl map with static storage makes the compiler report in
+    /// a warning the number of bytes it reserves. \see #XTL_STATIC_VTBL_MAPS
+    #define XTL_STATIC_VTBL_REPORT 0
+#endif
+
+#if !defined(XTL_VTBL_INVALIDATION)
+    /// Whether vtbl_map<N,T> and vtblmap<T> instances of Match statements and
+    /// of memoized_cast register themselves, so that mch::invalidate_vtbl_range()
+    /// can drop their entries of vtbl pointers within a range of addresses, 
+    /// e.g. of a shared library about to be unloaded, whose addresses may be 
+    /// taken by vtbls of other classes of a library loaded later. Not available
+    /// with #XTL_MULTI_THREADING, #XTL_STATIC_VTBL_MAPS, #XTL_SHARED_CLASS_IDS 
+    /// or #XTL_MEMOIZE_NESTED_TYPE_TESTS, whose caches are not registered.
+    #define XTL_VTBL_INVALIDATION 0
+#endif
+
+#if XTL_VTBL_INVALIDATION && (XTL_MULTI_THREADING || XTL_STATIC_VTBL_MAPS || XTL_SHARED_CLASS_IDS || XTL_MEMOIZE_NESTED_TYPE_TESTS)
+    #error XTL_VTBL_INVALIDATION is not available with XTL_MULTI_THREADING, XTL_STATIC_VTBL_MAPS, XTL_SHARED_CLASS_IDS or XTL_MEMOIZE_NESTED_TYPE_TESTS
+#endif
+
+#if !defined(XTL_SEALED_VTBL_MAPS)
+    /// Whether mch::seal_vtbl_maps() can move the caches that vtbl_map<N,T> 
+    /// instances have learned so far into a single segment of memory, which is
+    /// then made read-only. A prefork server calls it in the parent process 
+    /// before forking its workers, so that they share the pages of the segment
+    /// instead of copying them on the first write into a neighbouring object. 
+    /// Tuples of vtbl pointers seen for the first time after sealing go into a
+    /// process-local overflow map of the sealed one. Not available with 
+    /// #XTL_MULTI_THREADING, #XTL_USE_VTBL_FREQUENCY and #XTL_VTBL_LAYOUT, 
+    /// whose lookups write into cache entries, or #XTL_VTBL_INVALIDATION.
+    #define XTL_SEALED_VTBL_MAPS 0
+#endif
+#define XTL_SEALED_VTBL_MAPS_ONLY(...)  XTL_IF(XTL_NOT(XTL_SEALED_VTBL_MAPS), XTL_EMPTY(), XTL_EXPAND(__VA_ARGS__))
+
+#if XTL_SEALED_VTBL_MAPS && (XTL_MULTI_THREADING || XTL_USE_VTBL_FREQUENCY || XTL_VTBL_LAYOUT || XTL_VTBL_INVALIDATION)
+    #error XTL_SEALED_VTBL_MAPS is not available with XTL_MULTI_THREADING, XTL_USE_VTBL_FREQUENCY, XTL_VTBL_LAYOUT or XTL_VTBL_INVALIDATION
+#endif
+
+#if !defined(XTL_RTTI)
+    /// Whether type tests of Match statements and memoized_cast may use RTTI.
+    /// When 0, e.g. in builds with -fno-rtti, the type tests done on a miss of
+    /// a vtbl map go through mch::cast_hook instead of dynamic_cast, which 
+    /// resolves them with T::classof(const S*) in the style of LLVM, with the
+    /// kinds of a closed hierarchy declared with #class_hierarchy and KS/KV, 
+    /// or with a specialization the user provides (\see cast_hook.hpp). Hits
+    /// never needed RTTI, since vtbl maps only read vtbl-pointers. Names of 
+    /// classes in dumps, #XTL_USE_VTBL_FREQUENCY, #XTL_TRACE_FREQUENCY and 
+    /// #XTL_CAST_PROFILING still need RTTI. Detected from the compiler by default.
+    #if defined(__GXX_RTTI) || defined(_CPPRTTI) || defined(__cpp_rtti)
+        #define XTL_RTTI 1
+    #elif defined(__clang__)
+        #if __has_feature(cxx_rtti)
+            #define XTL_RTTI 1
+        #else
+            #define XTL_RTTI 0
+        #endif
+    #elif defined(__GNUC__) || defined(_MSC_VER)
+        #define XTL_RTTI 0
+    #else
+        #define XTL_RTTI 1
+    #endif
+#endif
+#define XTL_RTTI_ONLY(...)              XTL_IF(XTL_NOT(XTL_RTTI), XTL_EMPTY(), XTL_EXPAND(__VA_ARGS__))
+
+#if !XTL_RTTI && (XTL_USE_VTBL_FREQUENCY || XTL_TRACE_FREQUENCY || XTL_CAST_PROFILING)
+    #error XTL_USE_VTBL_FREQUENCY, XTL_TRACE_FREQUENCY and XTL_CAST_PROFILING need RTTI
+#endif
+
+#if !defined(XTL_EXTERN_TEMPLATES)
+    /// Whether the slow path of vtbl maps used by Match statements on 1 and 2
+    /// polymorphic subjects is declared extern template, so that translation 
+    /// units using them do not instantiate and optimize it again. Exactly one
+    /// translation unit of the program has to define #XTL_INSTANTIATE_TEMPLATES
+    /// before including the library to provide the instantiations. Has no 
+    /// effect together with #XTL_MULTI_THREADING or #XTL_STATIC_VTBL_MAPS.
+    #define XTL_EXTERN_TEMPLATES 0
+#endif
+
+#if !defined(XTL_OPTIMIZE_FOR_SIZE)
+    /// Whether Match statements trade the speed of their cache misses for code
+    /// size. Only the test for a hit in the vtbl map stays inlined at each Match
+    /// statement, while the handling of a miss and the dynamic_cast of subjects
+    /// in case clauses become out-of-line functions shared by all the Match 
+    /// statements with the same type of vtbl map or the same pair of types.
+    #define XTL_OPTIMIZE_FOR_SIZE 0
+#endif
+
+#if XTL_OPTIMIZE_FOR_SIZE || XTL_LEAN_MATCH
+    /// Put around the definition of a function on the slow path of Match 
+    /// statements that should not be inlined into them. \see #XTL_OPTIMIZE_FOR_SIZE, #XTL_LEAN_MATCH
+    #define XTL_COLD_PATH_BEGIN XTL_DO_NOT_INLINE_BEGIN
+    #define XTL_COLD_PATH_END   XTL_DO_NOT_INLINE_END
+#else
+    #define XTL_COLD_PATH_BEGIN inline
+    #define XTL_COLD_PATH_END
+#endif
+
+#if XTL_CHECKED && defined(_DEBUG)
+    /// Put before the definition of a function on the hit path of Match 
+    /// statements that checked builds compile optimized. Release builds keep
+    /// their own optimization level. \see #XTL_CHECKED
+    #define XTL_HOT_PATH XTL_OPTIMIZED_BEGIN
+#else
+    #define XTL_HOT_PATH
+#endif
+
+#define XTL_STATIC_VTBL_REPORT_ONLY(...)  XTL_IF(XTL_NOT(XTL_STATIC_VTBL_REPORT), XTL_EMPTY(), XTL_EXPAND(__VA_ARGS__))
+
+#if !defined(XTL_BATCH_SIZE)
+    /// Number of subjects get_batch() of vtbl maps and #MatchEach statements 
+    /// look up at a time: first probing the expected cache entries of all of 
+    /// them, then resolving the misses one by one.
+    #define XTL_BATCH_SIZE 16
+#endif
+
+#if !defined(XTL_PREFETCH_SUBJECTS)
+    /// Whether #MatchEach statements, before looking up a batch of subjects, 
+    /// issue prefetches for the expected cache entries of the next batch and
+    /// for the objects of the batch after it, to overlap their loads with the
+    /// execution of case clauses. \see #XTL_BATCH_SIZE
+    #define XTL_PREFETCH_SUBJECTS 1
+#endif
+#define XTL_PREFETCH_SUBJECTS_ONLY(...)  XTL_IF(XTL_NOT(XTL_PREFETCH_SUBJECTS), XTL_EMPTY(), XTL_EXPAND(__VA_ARGS__))
+
+#if !defined(XTL_PREFETCH_NONNULL_MEMBERS)
+    /// Whether constructor patterns, before matching members of an object, issue
+    /// prefetches for the objects pointed to by its members declared with #NN,
+    /// whose sub-patterns will dereference them. This overlaps the loads of 
+    /// sibling objects, e.g. both children of a tree node, with matching the
+    /// first of them.
+    #define XTL_PREFETCH_NONNULL_MEMBERS 1
+#endif
+#define XTL_PREFETCH_NONNULL_MEMBERS_ONLY(...)  XTL_IF(XTL_NOT(XTL_PREFETCH_NONNULL_MEMBERS), XTL_EMPTY(), XTL_EXPAND(__VA_ARGS__))
+
 #if !defined(XTL_MAX_STACK_LOG_SIZE)
     /// Log of the maximum stack size the library can use to do some histogram 
     /// computations. Making this value smaller will still work, however the 
@@ -340,6 +1383,15 @@
 #define constexpr
 #endif
 
+#if XTL_SUPPORT(relaxed_constexpr)
+/// Marks functions whose bodies need C++14 relaxed constexpr rules (local 
+/// variables, branches, mutation of a bound variable) to be evaluated at 
+/// compile time. Expands to nothing on compilers with only C++11 constexpr.
+#define XTL_CONSTEXPR14 constexpr
+#else
+#define XTL_CONSTEXPR14
+#endif
+
 #if XTL_SUPPORT(noexcept)
 /// Since noexcept might be a macro in our library, we need a different syntax for noexcept specification with condition
 #define noexcept_when(cond) noexcept(cond)
@@ -362,13 +1414,35 @@
 //------------------------------------------------------------------------------
 
 #if defined(_DEBUG)
+    #include <cstdlib>  // std::abort of failed assertions
+    #include <iostream> // std::cerr of failed assertions
+
     /// Helper function to be used within XTL_ASSERT only that allows one to pass an explanation
     inline bool xtl_failure(const char*, bool condition) { return condition; }
 
     #define XTL_DEBUG_ONLY(...) __VA_ARGS__
+  #if XTL_CHECKED
+    /// Reports a failed assertion and aborts. Kept out of line so that the
+    /// functions asserting something on the hit path stay small.
+    XTL_DO_NOT_INLINE_BEGIN
+    inline void xtl_assertion_failed(const char* condition, const char* file, int line)
+    {
+        std::cerr << condition << " in file " << file << '[' << line << ']' << std::endl; 
+        std::abort();
+    }
+    XTL_DO_NOT_INLINE_END
+
+    /// Our own version of assert macro because of the fact that normal assert was 
+    /// not always removed in the release builds.
+    #define XTL_ASSERT(...) if (XTL_UNLIKELY(!(__VA_ARGS__))) xtl_assertion_failed(#__VA_ARGS__, __FILE__, __LINE__)
+  #else
     /// Our own version of assert macro because of the fact that normal assert was 
     /// not always removed in the release builds.
     #define XTL_ASSERT(...) if (!(__VA_ARGS__)) { std::cerr << #__VA_ARGS__ " in file " << __FILE__ << '[' << __LINE__ << ']' << std::endl; std::abort(); }
+  #endif
+    /// Assertion of an invariant of a whole data structure, e.g. a vtbl map, 
+    /// that takes time proportional to its size. Used on update paths only.
+    #define XTL_CONSISTENCY_CHECK(...) XTL_ASSERT(__VA_ARGS__)
 #else
     /// In release builds, xtl_failure is a macro that ignores its explanation argument
     #define xtl_failure(text, condition) condition
@@ -377,6 +1451,8 @@
     /// Our own version of assert macro because of the fact that normal assert was 
     /// not always removed in the release builds.
     #define XTL_ASSERT(...) XTL_ASSUME(__VA_ARGS__)
+    /// Consistency checks are too expensive to become assumptions in release builds
+    #define XTL_CONSISTENCY_CHECK(...)
 #endif
 
 /// Our own version of assert macro because of the fact that normal assert was 
@@ -501,10 +1577,10 @@
 #define XTL_BIT_SIZE(T) (8*sizeof(T))
 
 /// Sets i^th bit in bit_array
-#define XTL_BIT_SET(bit_array, i) ( (bit_array)[(i)/XTL_BIT_SIZE((bit_array)[0])] |= (1 << ((i) % XTL_BIT_SIZE((bit_array)[0]))) )
+#define XTL_BIT_SET(bit_array, i) ( (bit_array)[(i)/XTL_BIT_SIZE((bit_array)[0])] |= (1ULL << ((i) % XTL_BIT_SIZE((bit_array)[0]))) )
 
 /// Gets i^th bit in bit_array
-#define XTL_BIT_GET(bit_array, i) ( (bit_array)[(i)/XTL_BIT_SIZE((bit_array)[0])]  & (1 << ((i) % XTL_BIT_SIZE((bit_array)[0]))) )
+#define XTL_BIT_GET(bit_array, i) ( (bit_array)[(i)/XTL_BIT_SIZE((bit_array)[0])]  & (1ULL << ((i) % XTL_BIT_SIZE((bit_array)[0]))) )
 
 //------------------------------------------------------------------------------
 
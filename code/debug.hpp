@@ -46,6 +46,14 @@
 
 #include <ostream>
 #include <iomanip>
+#include <iostream>
+
+#if XTL_TRACE_LIKELINESS && defined(XTL_LIKELINESS_PROFILE)
+#include <fstream>
+#include <map>
+#include <string>
+#include <tuple>
+#endif
 
 namespace mch ///< Mach7 library namespace
 {
@@ -105,14 +113,124 @@ struct likliness_tracer
 
 //------------------------------------------------------------------------------
 
+#if XTL_TRACE_LIKELINESS && defined(XTL_LIKELINESS_PROFILE)
+/// Counts of all the conditions traced by the program, merged by their file, 
+/// line and text. Once the last tracer has been destroyed, conditions whose 
+/// hint disagrees with how they actually went are written into the header 
+/// #XTL_LIKELINESS_PROFILE as specializations of likeliness_hint.
+class likeliness_profile
+{
+public:
+
+    /// The profile of the program. Tracers get it in their constructors, which
+    /// makes it outlive all of them.
+    static likeliness_profile& get()
+    {
+        static likeliness_profile profile;
+        return profile;
+    }
+
+    /// Adds counts of a tracer whose condition was hinted as likely or not
+    void record(const likliness_tracer& t, bool likely)
+    {
+        entry& e = entries[key(t.line, t.file, t.text)];
+        e.yes   += t.counts[true];
+        e.no    += t.counts[false];
+        e.likely = likely;
+    }
+
+   ~likeliness_profile()
+    {
+        std::ofstream os(XTL_LIKELINESS_PROFILE);
+
+        os << "// Likeliness profile of XTL_LIKELY and XTL_UNLIKELY conditions whose hint was\n"
+              "// wrong, generated by mch::likeliness_profile, \\see XTL_LIKELINESS_PROFILE\n"
+              "#pragma once\n\nnamespace mch\n{\n";
+
+        int open = -1; // Line of the specialization being written
+
+        for (std::map<key,entry>::const_iterator p = entries.begin(); p != entries.end(); ++p)
+        {
+            const int    line = std::get<0>(p->first);
+            const entry& e    = p->second;
+
+            // Long strings would exceed the depth of constexpr recursion of same_text
+            if ((e.likely ? e.no <= e.yes : e.yes <= e.no) || std::get<1>(p->first).size() >= max_text || std::get<2>(p->first).size() >= max_text)
+                continue;
+
+            if (line != open)
+            {
+                if (open >= 0)
+                    os << "            d;\n    }\n};\n";
+
+                os << "\ntemplate <> struct likeliness_hint<" << line << ">\n{\n"
+                      "    static constexpr bool get(const char* f, const char* c, bool d)\n    {\n        return\n";
+                open = line;
+            }
+
+            os << "            same_text(f," << quoted(std::get<1>(p->first)) << ") && same_text(c," << quoted(std::get<2>(p->first)) << ") ? " 
+               << (e.likely ? "false" : "true ") << " : // Yes: " << e.yes << " No: " << e.no << "\n";
+        }
+
+        if (open >= 0)
+            os << "            d;\n    }\n};\n";
+
+        os << "\n} // of namespace mch\n";
+    }
+
+private:
+
+    likeliness_profile() {}
+
+    static const size_t max_text = 256; ///< Longest file name or condition in the profile
+
+    /// Text as a C++ string literal
+    static std::string quoted(const std::string& text)
+    {
+        std::string result(1, '"');
+
+        for (size_t i = 0; i < text.size(); ++i)
+        {
+            if (text[i] == '"' || text[i] == '\\')
+                result += '\\';
+            result += text[i];
+        }
+
+        return result += '"';
+    }
+
+    struct entry
+    {
+        entry() : yes(0), no(0), likely(false) {}
+        size_t yes;    ///< Number of times the condition held
+        size_t no;     ///< Number of times it did not
+        bool   likely; ///< Whether the condition was hinted as likely
+    };
+
+    typedef std::tuple<int,std::string,std::string> key; ///< Line, file and text of a condition
+
+    std::map<key,entry> entries; ///< Conditions ordered by line
+};
+#endif
+
+//------------------------------------------------------------------------------
+
 template <bool likely>
 struct likliness_tracer_of : likliness_tracer
 {
-    likliness_tracer_of(const char* s, const char* f, int l) : likliness_tracer(s,f,l) {}
+    likliness_tracer_of(const char* s, const char* f, int l) : likliness_tracer(s,f,l)
+    {
+    #if XTL_TRACE_LIKELINESS && defined(XTL_LIKELINESS_PROFILE)
+        likeliness_profile::get();
+    #endif
+    }
    ~likliness_tracer_of()
     {
         if (likely != (counts[true] >= counts[false]))
             std::clog << *this << std::endl;
+    #if XTL_TRACE_LIKELINESS && defined(XTL_LIKELINESS_PROFILE)
+        likeliness_profile::get().record(*this, likely);
+    #endif
     }
 };
 
@@ -128,4 +246,19 @@ static bool trace_likeliness(bool c, const char* text, const char* file)
 
 //------------------------------------------------------------------------------
 
+/// Compile-time comparison of C strings
+constexpr bool same_text(const char* a, const char* b) { return *a == *b && (*a == 0 || same_text(a+1,b+1)); }
+
+/// Whether the condition with text c at a given line of file f is expected to
+/// hold, when d is what its XTL_LIKELY or XTL_UNLIKELY says. Specializations for
+/// lines of the conditions that went the other way are generated by 
+/// likeliness_profile into the header #XTL_LIKELINESS_PROFILE.
+template <int line>
+struct likeliness_hint
+{
+    static constexpr bool get(const char*, const char*, bool d) { return d; }
+};
+
+//------------------------------------------------------------------------------
+
 } // of namespace mch
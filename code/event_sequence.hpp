@@ -0,0 +1,203 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library.
+///
+/// Detection of sequences of event types in a stream of polymorphic events,
+/// e.g. "a Login followed by a Failure followed by a Logout within 100 events":
+/// \code
+///     mch::event_sequence<Event, Login, Failure, Logout> alert(100);
+///
+///     for (const Event* e : stream)
+///         if (alert(*e))
+///             report(alert.last_start(), alert.position());
+/// \endcode
+/// An event counts as a step of the sequence when its dynamic type is the 
+/// step's type or is derived from it, so steps can be whole subhierarchies. 
+/// Events in between that do not match the next step are skipped. The window
+/// bounds the distance between the positions of the first and the last event 
+/// of an occurrence, and an occurrence is reported at its last event. 
+/// Occurrences may overlap, but an event is used by at most one step of each.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#pragma once
+
+// --------------------[ Design Notes ]--------------------
+// - The sequence is an automaton whose state after a prefix of j steps is 
+//   the latest position at which an occurrence of that prefix could have 
+//   started. The latest start dominates all earlier ones, since it leaves the
+//   most of the window to the remaining steps, so no history is buffered.
+// - Which steps an event advances depends only on its dynamic type, so the 
+//   bit mask of those steps is kept in a vtbl_map<1> and computed with a
+//   dynamic_cast per step only the first time an event of that class is seen.
+//   A hit is thus a vtbl map lookup followed by a loop over the steps, 
+//   which events of classes not in the sequence skip altogether.
+// - Steps are advanced from the last to the first, so that an event matching
+//   several consecutive steps does not advance through all of them at once.
+//------------------------------------------------------------------------------
+
+#include "type_switchN-patterns.hpp" // vtbl_map and its default policy
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace mch ///< Mach7 library namespace
+{
+
+//------------------------------------------------------------------------------
+
+/// Detector of occurrences of events of types S... in this order within a 
+/// window of events of polymorphic type E. \see event_sequence.hpp
+template <typename E, typename... S>
+class event_sequence
+{
+public:
+
+    static_assert(std::is_polymorphic<E>::value, "Events have to be of a polymorphic type");
+    static_assert(sizeof...(S) > 0 && sizeof...(S) <= 64, "Sequence has to have between 1 and 64 steps");
+
+    /// Number of steps of the sequence
+    static const size_t length = sizeof...(S);
+
+    /// Detects occurrences whose last event is at most window events after 
+    /// the first one
+    explicit event_sequence(size_t window) : m_window(window), m_clauses(length), m_map(m_clauses) { reset(); }
+
+    /// Feeds the next event of the stream. Returns true when it completes an 
+    /// occurrence of the sequence.
+    bool operator()(const E& e)
+    {
+        const step_mask steps = steps_of(e);
+        const size_t    i     = m_position++;
+        bool            found = false;
+
+        for (size_t j = length; steps && j-- > 0; )
+        {
+            if (!(steps & (step_mask(1) << j)))
+                continue;
+
+            size_t start = i;
+
+            if (j > 0)
+            {
+                start = m_latest[j-1];
+
+                if (start == none || i - start > m_window)
+                    continue;
+            }
+
+            if (j == length-1)
+            {
+                found = true;
+                m_last_start = start;
+                ++m_found;
+            }
+            else
+                m_latest[j] = start;
+        }
+
+        return found;
+    }
+
+    /// Forgets partial occurrences and restarts counting positions from 0
+    void reset()
+    {
+        for (size_t j = 0; j < length; ++j)
+            m_latest[j] = none;
+
+        m_position   = 0;
+        m_last_start = none;
+        m_found      = 0;
+    }
+
+    size_t position()   const { return m_position; }   ///< Number of events fed since the last reset
+    size_t last_start() const { return m_last_start; } ///< Position of the first event of the latest occurrence
+    size_t found()      const { return m_found; }      ///< Number of occurrences found since the last reset
+
+private:
+
+    event_sequence(const event_sequence&);            ///< No copy constructor
+    event_sequence& operator=(const event_sequence&); ///< No assignment operator
+
+    typedef std::uint64_t step_mask;
+
+    /// Marks positions of prefixes that have not occurred within the window
+    static const size_t none = std::numeric_limits<size_t>::max();
+
+    /// Steps advanced by events of a given dynamic type
+    struct steps_entry
+    {
+        steps_entry() : known(false), steps(0) {}
+        bool      known;
+        step_mask steps;
+    };
+
+    step_mask steps_of(const E& e)
+    {
+        steps_entry& se = m_map.get(&e);
+
+        if (XTL_UNLIKELY(!se.known))
+        {
+            const bool is[] = { dynamic_cast<const S*>(&e) != nullptr... };
+
+            for (size_t j = 0; j < length; ++j)
+                if (is[j])
+                    se.steps |= step_mask(1) << j;
+
+            se.known = true;
+        }
+
+        return se.steps;
+    }
+
+    size_t             m_window;          ///< Maximum distance between first and last event
+    size_t             m_latest[length];  ///< Latest start of an occurrence of steps [0..j]
+    size_t             m_position;        ///< Position of the next event
+    size_t             m_last_start;      ///< Start of the latest occurrence
+    size_t             m_found;           ///< Number of occurrences found
+    const vtbl_count_t m_clauses;         ///< Number of steps, to which m_map keeps a reference
+    vtbl_map<1,steps_entry,XTL_VTBL_MAP_POLICY> m_map; ///< Steps advanced by each class of events
+};
+
+//------------------------------------------------------------------------------
+
+} // of namespace mch
@@ -0,0 +1,136 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file defines function mch::fast_dynamic_cast<T>(U) that behaves as
+/// dynamic_cast, including casts in hierarchies with virtual and multiple 
+/// inheritance, but memoizes outcomes of casts that need the run-time check.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+/// \note To use it in place of dynamic_cast in a whole translation unit,
+///       include this file and then \#define dynamic_cast mch::fast_dynamic_cast
+///
+
+#pragma once
+
+#include "memoized_cast.hpp" // Memoized offsets of down- and cross-casts
+#include <type_traits>
+#include <typeinfo>
+
+//------------------------------------------------------------------------------
+// Design Notes:
+//
+// - Casts that dynamic_cast resolves at compile time, i.e. identity and casts
+//   to unambiguous accessible bases, are done with an implicit conversion. 
+// - All other casts, i.e. downcasts, cross-casts and casts to void* that give
+//   the most derived object, go through #memoized_cast. Its cache is one 
+//   vtblmap per source type mapping vtbl-pointers of subjects to offsets of 
+//   all the target types tried so far, so a repeated cast of an object of the 
+//   same dynamic type is one cache probe plus a pointer adjustment.
+// - A vtbl-pointer identifies both the dynamic type of the object and the 
+//   position of the subobject it is in, which is all dynamic_cast depends on,
+//   so its outcome can be memoized per vtbl-pointer even under virtual and 
+//   repeated inheritance. Casts to ambiguous bases memoize their failure.
+//------------------------------------------------------------------------------
+
+namespace mch ///< Mach7 library namespace
+{
+
+//------------------------------------------------------------------------------
+
+/// Whether dynamic_cast<T*> of an S* is resolved at compile time
+template <typename T, typename S>
+struct is_static_dynamic_cast : std::integral_constant<bool, 
+                                    std::is_convertible<S*,T*>::value && 
+                                   !std::is_void<T>::value
+                                > {};
+
+//------------------------------------------------------------------------------
+
+/// The general case is not defined on purpose as dynamic_cast only accepts
+/// pointer and reference types as target types.
+template <typename T>
+struct fast_dynamic_cast_helper;
+
+/// Partial specialization handling pointers as target type.
+template <typename T>
+struct fast_dynamic_cast_helper<T*>
+{
+    /// Identity and upcasts
+    template <typename S>
+    static inline T* go(S* p, std::true_type) noexcept { return p; }
+
+    /// Downcasts, cross-casts and casts to void*
+    template <typename S>
+    static inline T* go(S* p, std::false_type)
+    {
+        static_assert(std::is_polymorphic<S>::value, "Source type of a dynamic_cast that is not an upcast should be polymorphic");
+        return p ? memoized_cast_non_null<T*>(p) : 0;
+    }
+
+    template <typename S>
+    static inline T* go(S* p) { return go(p, is_static_dynamic_cast<T,S>()); }
+};
+
+/// Partial specialization handling references as target type.
+template <typename T>
+struct fast_dynamic_cast_helper<T&>
+{
+    template <typename S>
+    static inline T& go(S& s)
+    {
+        if (T* t = fast_dynamic_cast_helper<T*>::go(&s))
+            return *t;
+        else
+            throw std::bad_cast();
+    }
+};
+
+//------------------------------------------------------------------------------
+
+/// Behaves as dynamic_cast<T>(s) with memoized outcomes of run-time checks
+template <typename T, typename S>
+inline T fast_dynamic_cast(S&& s)
+{
+    return fast_dynamic_cast_helper<T>::go(std::forward<S>(s));
+}
+
+//------------------------------------------------------------------------------
+
+} // of namespace mch
@@ -0,0 +1,357 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file defines collection of the frequencies of classes of subjects seen
+/// by Match statements during a training run and their use in place of the 
+/// values given with #FQ in bindings of those classes.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#pragma once
+
+// --------------------[ Design Notes ]--------------------
+// - Classes are identified at run time by typeid of the subject, which is 
+//   always polymorphic in a Match statement on vtbl-pointers.
+// - #FQ has no name of the class it is used for in bindings, so the profile 
+//   keys its values by the file and line of #FQ, just like mch::likeliness_hint
+//   keys the hints of conditions. Case clauses record where #FQ of their class
+//   is, which lets the profile associate the counts with those locations.
+// - Bindings of a class template share one #FQ, which gets the largest count
+//   of the classes instantiated from it.
+// - Counts written into #XTL_FREQUENCY_COUNTS are keyed by type names rather
+//   than by addresses, so that counts of different processes and hosts can be
+//   added up, \see test/time/merge_profiles.cpp.
+//------------------------------------------------------------------------------
+
+#include "debug.hpp"       // same_text
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <istream>
+#include <map>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if XTL_TRACE_FREQUENCY
+#include <fstream>
+#include <typeindex>
+#if XTL_MULTI_THREADING
+#include <mutex>
+#endif
+#endif
+
+namespace mch ///< Mach7 library namespace
+{
+
+//------------------------------------------------------------------------------
+
+/// Frequency of the class whose bindings use #FQ at a given line of file f, 
+/// when d is what that #FQ says. Specializations for lines of #FQ of classes
+/// seen in a training run are generated by frequency_profile into the header
+/// #XTL_FREQUENCY_PROFILE.
+template <int line>
+struct frequency_hint
+{
+    static constexpr size_t get(const char*, size_t d) { return d; }
+};
+
+//------------------------------------------------------------------------------
+
+/// Number of subjects of a class seen by Match statements and the #FQ of it
+struct frequency_count
+{
+    frequency_count() : hits(0), sites(0), line(0), fq(0) {}
+    size_t      hits;  ///< Number of subjects of the class
+    size_t      sites; ///< Number of Match statements that saw them
+    int         line;  ///< Line of #FQ of the class or 0 when not known
+    std::string file;  ///< File of #FQ of the class
+    size_t      fq;    ///< Value given to #FQ
+};
+
+/// Counts of classes by std::type_info::name() of them
+typedef std::map<std::string,frequency_count> frequency_counts;
+
+//------------------------------------------------------------------------------
+
+/// Writes counts in the format read by read_frequency_counts()
+inline void write_frequency_counts(std::ostream& os, const frequency_counts& counts)
+{
+    os << "# Mach7 frequency counts\n";
+
+    for (frequency_counts::const_iterator p = counts.begin(); p != counts.end(); ++p)
+        os << "class\t" << p->first << '\t' << p->second.hits << '\t' << p->second.sites << '\t' << p->second.fq << '\t' << p->second.line << '\t' << p->second.file << '\n';
+}
+
+//------------------------------------------------------------------------------
+
+/// Adds counts written by write_frequency_counts() to those in counts. 
+/// Returns false on malformed input, in which case the counts read up to the
+/// error are kept.
+inline bool read_frequency_counts(std::istream& is, frequency_counts& counts)
+{
+    for (std::string line; std::getline(is, line);)
+    {
+        if (!line.empty() && line[line.size()-1] == '\r')
+            line.erase(line.size()-1); // Counts might have been edited on another platform
+
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        std::vector<std::string> fields;
+        std::istringstream       ss(line);
+
+        for (std::string f; std::getline(ss, f, '\t');)
+            fields.push_back(f);
+
+        if (fields.size() < 6 || fields[0] != "class")
+            return false;
+
+        frequency_count c;
+        std::istringstream(fields[2]) >> c.hits;
+        std::istringstream(fields[3]) >> c.sites;
+        std::istringstream(fields[4]) >> c.fq;
+        std::istringstream(fields[5]) >> c.line;
+
+        frequency_count& e = counts[fields[1]];
+        e.hits  += c.hits;
+        e.sites += c.sites;
+
+        if (c.line && fields.size() > 6)
+        {
+            e.line = c.line;
+            e.file = fields[6];
+            e.fq   = c.fq;
+        }
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+
+/// Text as a C++ string literal
+inline std::string quoted_text(const std::string& text)
+{
+    std::string result(1, '"');
+
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        if (text[i] == '"' || text[i] == '\\')
+            result += '\\';
+        result += text[i];
+    }
+
+    return result += '"';
+}
+
+//------------------------------------------------------------------------------
+
+/// Writes a header with specializations of mch::frequency_hint for the 
+/// locations of #FQ of classes in counts, \see #XTL_FREQUENCY_PROFILE
+inline void write_frequency_hints(std::ostream& os, const frequency_counts& counts)
+{
+    typedef std::pair<int,std::string> location; ///< Line and file of #FQ
+
+    const size_t max_text = 256; // Long file names would exceed the depth of constexpr recursion of same_text
+    std::map<location,size_t> values; // Largest count of classes with #FQ at a given location
+
+    for (frequency_counts::const_iterator p = counts.begin(); p != counts.end(); ++p)
+        if (p->second.line && p->second.file.size() < max_text)
+        {
+            size_t& value = values[location(p->second.line, p->second.file)];
+            value = (std::max)(value, (std::min)(p->second.hits, size_t(INT_MAX))); // FQ is an enumerator
+        }
+
+    os << "// Frequencies of classes seen by Match statements for their #FQ in bindings,\n"
+          "// generated by mch::frequency_profile, \\see XTL_FREQUENCY_PROFILE\n"
+          "#pragma once\n\nnamespace mch\n{\n";
+
+    int open = -1; // Line of the specialization being written
+
+    for (std::map<location,size_t>::const_iterator p = values.begin(); p != values.end(); ++p)
+    {
+        if (p->first.first != open)
+        {
+            if (open >= 0)
+                os << "            d;\n    }\n};\n";
+
+            os << "\ntemplate <> struct frequency_hint<" << p->first.first << ">\n{\n"
+                  "    static constexpr size_t get(const char* f, size_t d)\n    {\n        return\n";
+            open = p->first.first;
+        }
+
+        os << "            same_text(f," << quoted_text(p->first.second) << ") ? " << (std::max)(p->second, size_t(1)) << " :\n";
+    }
+
+    if (open >= 0)
+        os << "            d;\n    }\n};\n";
+
+    os << "\n} // of namespace mch\n";
+}
+
+#if XTL_TRACE_FREQUENCY
+
+//------------------------------------------------------------------------------
+
+#if XTL_MULTI_THREADING
+typedef std::mutex                  frequency_mutex;
+typedef std::lock_guard<std::mutex> frequency_lock;
+#else
+struct frequency_mutex {};
+struct frequency_lock { frequency_lock(frequency_mutex&) {} };
+#endif
+
+//------------------------------------------------------------------------------
+
+/// Frequencies of classes of subjects seen by all Match statements.
+class frequency_profile
+{
+public:
+
+    /// The profile of the program. Sites get it in their constructors, which
+    /// makes it outlive all of them.
+    static frequency_profile& get()
+    {
+        static frequency_profile profile;
+        return profile;
+    }
+
+    /// Remembers where #FQ of class C is, if its bindings use it
+    template <typename C>
+    bool bind() { bind_ex<bindings<C>>(typeid(C), 0); return true; }
+
+    /// Adds the counts of a Match statement
+    void record(const std::map<std::type_index,size_t>& counts)
+    {
+        frequency_lock guard(mutex);
+
+        for (std::map<std::type_index,size_t>::const_iterator p = counts.begin(); p != counts.end(); ++p)
+        {
+            frequency_count& e = classes[p->first];
+            e.hits  += p->second;
+            e.sites += 1;
+        }
+    }
+
+   ~frequency_profile()
+    {
+        frequency_counts counts;
+
+        for (std::map<std::type_index,frequency_count>::const_iterator p = classes.begin(); p != classes.end(); ++p)
+        {
+            const frequency_count& e = counts[p->first.name()] = p->second;
+
+            std::clog << "Frequency of " << p->first.name() << ": " << e.hits << " hits at " << e.sites << " Match statements";
+
+            if (e.line)
+                std::clog << " (FQ(" << e.fq << ") at " << e.file << '(' << e.line << "))";
+
+            std::clog << std::endl;
+        }
+
+    #if defined(XTL_FREQUENCY_PROFILE)
+        std::ofstream hints(XTL_FREQUENCY_PROFILE);
+        write_frequency_hints(hints, counts);
+    #endif
+
+    #if defined(XTL_FREQUENCY_COUNTS)
+        std::ofstream raw(XTL_FREQUENCY_COUNTS);
+        write_frequency_counts(raw, counts);
+    #endif
+    }
+
+private:
+
+    frequency_profile() {}
+
+    /// Bindings with #FQ, which defines fq_line and fq_file() under #XTL_TRACE_FREQUENCY
+    template <typename B>
+    void bind_ex(const std::type_info& t, decltype(B::fq_line)*)
+    {
+        frequency_lock guard(mutex);
+        frequency_count& e = classes[std::type_index(t)];
+        e.line = B::fq_line;
+        e.file = B::fq_file();
+        e.fq   = B::fq;
+    }
+
+    /// Bindings without #FQ
+    template <typename B>
+    void bind_ex(const std::type_info&, ...) {}
+
+    std::map<std::type_index,frequency_count> classes; ///< Classes seen or bound by Match statements
+    frequency_mutex                           mutex;   ///< Guards classes
+};
+
+//------------------------------------------------------------------------------
+
+/// Counts of classes of subjects seen by a Match statement
+class frequency_site
+{
+public:
+
+    frequency_site() { frequency_profile::get(); }
+   ~frequency_site() { frequency_profile::get().record(counts); }
+
+    /// Counts the class of a subject
+    template <typename S>
+    void hit(const S* subject)
+    {
+        if (subject)
+        {
+            frequency_lock guard(mutex);
+            ++counts[std::type_index(typeid(*subject))];
+        }
+    }
+
+private:
+
+    std::map<std::type_index,size_t> counts; ///< Subjects of each class
+    frequency_mutex                  mutex;  ///< Guards counts
+};
+
+#endif
+
+//------------------------------------------------------------------------------
+
+} // of namespace mch
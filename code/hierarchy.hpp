@@ -0,0 +1,389 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file defines class_hierarchy trait through which users can declare a
+/// closed set of classes that subjects of a given static type can have as 
+/// their dynamic types. With #XTL_HIERARCHY_INDEX, Match statements use tables
+/// generated at compile time from such a declaration to resolve cache misses 
+/// instead of calling dynamic_cast for each case clause. Hierarchies whose
+/// classes also store their kind are closed, and Match statements on them
+/// switch on the kind instead of looking up the vtbl-pointer. Subjects of 
+/// other hierarchies can share what one Match statement learned about their
+/// vtbl-pointers with all the others, \see #XTL_SHARED_CLASS_IDS.
+///
+/// \note This file is not meant to be included directly. It is included by
+///       type_switchN-patterns.hpp.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#pragma once
+
+#include "config.hpp"
+#include "has_member.hpp"        // Meta-functions to check use of certain #bindings facilities
+#include "patterns/bindings.hpp" // Access to the kind selector of a class
+#include "ptrtools.hpp"          // vtbl_of
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <typeindex>
+#include <typeinfo>
+#include <type_traits>
+#include <unordered_map>
+
+// --------------------[ Design Notes ]--------------------
+// - A dynamic class is identified by its position in the declared list of 
+//   classes, found by std::type_info of the complete object of a subject. 
+//   The lookup happens once per Match statement and subject on a cache miss.
+// - For each target type T of a case clause, a table generated at compile 
+//   time holds, for every declared class D, a function converting the 
+//   complete object to T or nullptr when D is not a T. A case clause test is
+//   thus a table lookup, and the conversion itself only reads the offset to 
+//   the complete object from the vtbl and does a static_cast from D to T.
+// - Conversion to T is allowed when const D* converts to const T*, i.e. when
+//   T is an unambiguous public base of D. These are exactly the cases in 
+//   which dynamic_cast from the complete object succeeds.
+// - Subjects whose dynamic class is not declared and static types for which
+//   no hierarchy is declared fall back to dynamic_cast.
+// - When a hierarchy is declared and #bindings of its static type specify 
+//   the kind selector with KS, the set of dynamic classes is closed and each 
+//   of them identifies itself with a kind. A Match statement on a single 
+//   such subject then finds its jump target in a table of its own indexed by
+//   kind instead of in its vtbl_map: there is no hashing, no collisions and
+//   nothing to rearrange, while the table is as dense as the kinds are.
+// - The table is a deque, so that growing it for a new kind does not move
+//   entries referenced by executions of the same Match statement further up
+//   the call stack. The kinds themselves are assumed to be small.
+// - With #XTL_SHARED_CLASS_IDS, subjects of other hierarchies are given ids
+//   in order of appearance of their vtbl-pointers, shared by all the Match 
+//   statements on the same static type, and each statement indexes the same
+//   kind of table by those ids. Ids are dense, so a table only grows to the
+//   number of classes seen on that static type, while the mapping from vtbl
+//   to id is learned once instead of once per Match statement. It is kept in
+//   a hash map fronted by a direct-mapped cache of recent vtbl-pointers.
+//------------------------------------------------------------------------------
+
+namespace mch ///< Mach7 library namespace
+{
+
+//------------------------------------------------------------------------------
+
+/// Users specialize this trait on a polymorphic static type S of subjects to
+/// declare all the classes that can be their dynamic types:
+/// \code
+/// namespace mch
+/// {
+///     template <> struct class_hierarchy<Shape> : classes<Circle,Oval,Square> {};
+/// }
+/// \endcode
+template <typename S>
+struct class_hierarchy
+{
+    enum { declared = false };
+};
+
+//------------------------------------------------------------------------------
+
+/// Helper base of #class_hierarchy specializations listing dynamic classes Ds.
+/// \note All the polymorphic classes that can be dynamic types of subjects 
+///       should be listed. The others are resolved with dynamic_cast.
+template <typename... Ds>
+struct classes
+{
+    enum { declared = true, size = sizeof...(Ds) };
+
+    /// Converts pointer to the complete object of a class to pointer to T
+    typedef const void* (*upcast_type)(const void* complete);
+
+#if XTL_RTTI
+    /// Position of class described by ti in Ds or size when it is not there
+    static std::size_t index_of(const std::type_info& ti)
+    {
+        static const std::unordered_map<std::type_index,std::size_t> index = make_index();
+        std::unordered_map<std::type_index,std::size_t>::const_iterator p = index.find(std::type_index(ti));
+        return p == index.end() ? std::size_t(size) : p->second;
+    }
+#endif
+
+    /// Position of the class whose #bindings give it kind k with KV or size 
+    /// when there is none. Unlike index_of() it needs no RTTI \see cast_hook.hpp
+    static std::size_t index_of_kind(std::size_t k) noexcept
+    {
+        static const std::size_t kinds[] = { std::size_t(bindings<Ds>::kind_value)... };
+
+        for (std::size_t i = 0; i < sizeof...(Ds); ++i)
+            if (kinds[i] == k)
+                return i;
+
+        return size;
+    }
+
+    /// Table of conversions of complete objects of each Ds to T
+    template <typename T>
+    struct upcasts
+    {
+        static const upcast_type table[sizeof...(Ds)];
+    };
+
+private:
+
+    /// Conversion of complete object of class D to T
+    template <typename T, typename D, bool = std::is_convertible<const D*, const T*>::value>
+    struct upcast
+    {
+        static const void* go(const void* complete) { return static_cast<const T*>(static_cast<const D*>(complete)); }
+    };
+
+    /// Class D is not a T
+    template <typename T, typename D>
+    struct upcast<T,D,false>
+    {
+        static const void* go(const void*) { return nullptr; }
+    };
+
+#if XTL_RTTI
+    static std::unordered_map<std::type_index,std::size_t> make_index()
+    {
+        const std::type_index ids[] = { std::type_index(typeid(Ds))... };
+        std::unordered_map<std::type_index,std::size_t> index;
+
+        for (std::size_t i = 0; i < sizeof...(Ds); ++i)
+            index.insert(std::make_pair(ids[i],i));
+
+        return index;
+    }
+#endif
+};
+
+template <typename... Ds>
+template <typename T>
+const typename classes<Ds...>::upcast_type classes<Ds...>::upcasts<T>::table[sizeof...(Ds)] = { &classes<Ds...>::template upcast<T,Ds>::go... };
+
+//------------------------------------------------------------------------------
+
+/// Value of \a index of a subject whose dynamic class has not been looked up yet
+const std::size_t unknown_class_index = ~std::size_t(0);
+
+/// Converts subject s to T using the hierarchy declared for S, falling back
+/// to dynamic_cast when the dynamic class of s is not declared.
+/// \param index Position of the dynamic class of s in the declared classes. 
+///        It is looked up on the first call for a given subject, which should
+///        pass #unknown_class_index, and reused on subsequent calls.
+/// \returns Pointer to T subobject of s or nullptr when s is not a T.
+#if XTL_RTTI
+template <typename T, typename S>
+inline const T* class_index_cast(const S* s, std::size_t& index)
+{
+    typedef class_hierarchy<S> hierarchy;
+
+    if (XTL_UNLIKELY(index == unknown_class_index))
+        index = hierarchy::index_of(typeid(*s));
+
+    if (XTL_UNLIKELY(index >= std::size_t(hierarchy::size)))
+        return dynamic_cast<const T*>(s);
+
+    // dynamic_cast to void only reads the offset to the complete object from the vtbl
+    return static_cast<const T*>(hierarchy::template upcasts<T>::table[index](dynamic_cast<const void*>(s)));
+}
+#endif
+
+//------------------------------------------------------------------------------
+
+/// Whether subjects of static type S belong to a closed hierarchy: all the 
+/// classes their dynamic types can have are declared with #class_hierarchy
+/// and each of them stores its kind, which #bindings of S expose with KS.
+template <typename S>
+struct is_closed_hierarchy : std::integral_constant<bool,
+                                 std::is_polymorphic<S>::value     && 
+                                 class_hierarchy<S>::declared      && 
+                                 has_member_kind_selector<bindings<S>>::value
+                             > {};
+
+/// Jump targets of the Match statement identified by UID indexed by kind of
+/// its subject or by its class id \see #shared_class_ids.
+template <typename UID, typename Info>
+struct indexed_switch_table
+{
+    static Info& get(std::size_t kind)
+    {
+        static std::deque<Info> table;
+
+        if (XTL_UNLIKELY(kind >= table.size()))
+            table.resize(kind+1, Info());
+
+        return table[kind];
+    }
+};
+
+/// Dense ids of dynamic classes of subjects of static type S, assigned in order
+/// of appearance of their vtbl-pointers and shared by all Match statements on
+/// subjects of type S. \see #XTL_SHARED_CLASS_IDS
+template <typename S>
+struct shared_class_ids
+{
+    static const std::size_t log_size = 6; ///< Log of the number of entries in the cache of recent vtbl-pointers
+
+    static std::size_t get(const S* s)
+    {
+        struct entry { std::intptr_t vtbl; std::size_t id; };
+        static entry cache[1 << log_size]; // Zero vtbl-pointer marks empty entries
+
+        const std::intptr_t vtbl = vtbl_of(s);
+        entry& e = cache[(vtbl >> XTL_IRRELEVANT_VTBL_BITS) & ((1 << log_size) - 1)];
+
+        if (XTL_UNLIKELY(e.vtbl != vtbl))
+        {
+            const std::size_t next = ids().size();
+            e.vtbl = vtbl;
+            e.id   = ids().insert(std::make_pair(vtbl,next)).first->second;
+        }
+
+        return e.id;
+    }
+
+    /// Number of ids assigned so far
+    static std::size_t size() { return ids().size(); }
+
+private:
+
+    static std::unordered_map<std::intptr_t,std::size_t>& ids()
+    {
+        static std::unordered_map<std::intptr_t,std::size_t> map;
+        return map;
+    }
+};
+
+/// Subject of static type S together with the id of its dynamic class among 
+/// \ref shared_class_ids of S, as returned by mch::resolve(). A #Match statement
+/// on a single token finds its jump target, with the offsets to the targets of
+/// the clause, in a table of its own indexed by the id, so a subject flowing 
+/// through a series of Match statements has its vtbl-pointer looked up once.
+/// \code
+///     auto t = mch::resolve(node);
+///     Match(t) { Case(C<Add>()) ... } EndMatch
+///     Match(t) { Case(C<Mul>()) ... } EndMatch
+/// \endcode
+template <typename S>
+struct class_token
+{
+    const S*    subject; ///< The resolved subject
+    std::size_t id;      ///< Dense id of its dynamic class \see shared_class_ids
+};
+
+#if !XTL_MULTI_THREADING
+/// Resolves dynamic class of s into a token Match statements can dispatch on
+/// with an indexed lookup. \see class_token
+/// \note Not available with #XTL_MULTI_THREADING, since neither the ids nor 
+///       the tables indexed by them are guarded.
+template <typename S>
+inline class_token<S> resolve(const S* s)
+{
+    static_assert(std::is_polymorphic<S>::value, "Only polymorphic subjects can be resolved into class tokens");
+    class_token<S> token = { s, shared_class_ids<S>::get(s) };
+    return token;
+}
+
+template <typename S>
+inline class_token<S> resolve(const S& s) { return resolve(std::addressof(s)); }
+#endif
+
+/// Match statements on a token match the subject it refers to
+template <typename S> inline const S* addr(const class_token<S>& t) noexcept { return t.subject; }
+template <typename S> inline const S* addr(      class_token<S>& t) noexcept { return t.subject; }
+
+/// Marks subjects that are not class tokens and thus carry no class id
+struct no_class_id {};
+
+/// Id of the dynamic class a subject carries, if it is a class token
+template <typename T> inline no_class_id class_id_of(const T&)                noexcept { return no_class_id(); }
+template <typename S> inline std::size_t class_id_of(const class_token<S>& t) noexcept { return t.id; }
+
+/// Ways a Match statement on a single subject can find its jump target
+enum switch_info_source
+{
+    from_vtbl_map,      ///< Its own vtbl_map
+    from_kind,          ///< Its own table indexed by kind \see #XTL_CLOSED_HIERARCHY_SWITCH
+    from_shared_class_id///< Its own table indexed by class id shared with other statements \see #XTL_SHARED_CLASS_IDS
+};
+
+/// Jump target of a Match statement on several subjects or on a subject of
+/// an open hierarchy is looked up in its vtbl_map.
+template <typename UID, typename Map, typename... S>
+inline auto switch_info_of(Map& map, const S*... s) -> decltype(map.get(s...))
+{
+    return map.get(s...);
+}
+
+/// Subject of an open hierarchy
+template <typename UID, typename Map, typename S>
+inline auto switch_info_of(Map& map, const S* s, std::integral_constant<switch_info_source,from_vtbl_map>) -> decltype(map.get(s))
+{
+    return map.get(s);
+}
+
+/// Subject of a closed hierarchy
+template <typename UID, typename Map, typename S>
+inline auto switch_info_of(Map& map, const S* s, std::integral_constant<switch_info_source,from_kind>) -> decltype(map.get(s))
+{
+    typedef typename std::remove_reference<decltype(map.get(s))>::type info_type;
+    return indexed_switch_table<UID,info_type>::get(std::size_t(kind_selector(s)));
+}
+
+/// Subject of an open hierarchy with ids of classes shared between statements
+template <typename UID, typename Map, typename S>
+inline auto switch_info_of(Map& map, const S* s, std::integral_constant<switch_info_source,from_shared_class_id>) -> decltype(map.get(s))
+{
+    typedef typename std::remove_reference<decltype(map.get(s))>::type info_type;
+    return indexed_switch_table<UID,info_type>::get(shared_class_ids<S>::get(s));
+}
+
+/// Jump target of a Match statement on a single subject
+template <typename UID, typename Map, typename S>
+inline auto switch_info_of(Map& map, const S* s) -> decltype(map.get(s))
+{
+    return switch_info_of<UID>(map, s, std::integral_constant<switch_info_source,
+        XTL_CLOSED_HIERARCHY_SWITCH && is_closed_hierarchy<S>::value ? from_kind            :
+        XTL_SHARED_CLASS_IDS        && std::is_polymorphic<S>::value ? from_shared_class_id :
+                                                                       from_vtbl_map>());
+}
+
+//------------------------------------------------------------------------------
+
+} // of namespace mch
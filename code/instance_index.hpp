@@ -0,0 +1,308 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file defines class instance_index<B> that keeps objects of classes 
+/// derived from B grouped by their dynamic type, so that searches for objects
+/// matching a pattern only look at objects of classes the outermost pattern 
+/// accepts, rather than traversing a whole graph and matching every node:
+/// \code
+///     mch::arena<Expr>          nodes;
+///     mch::instance_index<Expr> index;
+///     nodes.observe(&index);   // or index.add(p) for objects made elsewhere
+///     ...
+///     mch::var<std::string> name;
+///     for (const Call* c : index.find_all(C<Call>(C<Id_expr>(name), _))) ...
+/// \endcode
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#pragma once
+
+// --------------------[ Design Notes ]--------------------
+// - Objects are kept in buckets per vtbl-pointer, found through a 
+//   learned_ptr_map, since vtbl-pointers are what it hashes best. Objects of
+//   a bucket are kept in the order they were added, which for objects of an
+//   arena is the order of their addresses.
+// - A query for target type T casts the first object of every bucket to T
+//   once, and adjusts all other objects of the bucket by the same offset, as
+//   memoized_cast does. Buckets of classes not derived from T cost one cast 
+//   per query and none of their objects are looked at.
+// - Patterns are evaluated on objects of their target type directly, so the
+//   outermost constructor pattern does no type test of its own.
+// - Variables of patterns are bound while an object is matched, so patterns 
+//   with variables cannot be evaluated on several threads at once. Parallel
+//   queries thus take a predicate, in which every call can match a pattern
+//   with variables of its own.
+// - Removal searches the bucket of the object, so it is linear in the number
+//   of objects of its class. The index is meant for objects that mostly live
+//   as long as the graph does.
+//------------------------------------------------------------------------------
+
+#include "arena.hpp"
+#include "cast_hook.hpp"
+#include "learned_ptr_map.hpp"
+#include "metatools.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mch ///< Mach7 library namespace
+{
+
+//------------------------------------------------------------------------------
+
+/// Objects of classes derived from B grouped by dynamic type \see instance_index.hpp
+template <typename B>
+class instance_index : public arena_observer<B>
+{
+public:
+
+    /// Target type of the outermost pattern P on objects of type B
+    template <typename P>
+    struct pattern_target
+    {
+        typedef typename underlying<P>::type::template accepted_type_for<B>::type type;
+    };
+
+    instance_index() : m_size(0) {}
+
+    /// Adds object p, which has to stay alive until it is removed or the index is cleared
+    void add(const B* p)
+    {
+        XTL_ASSERT(p);
+        size_t& b = m_bucket_of[vtbl_of(p)]; // 1-based position of the bucket, 0 when new
+
+        if (!b)
+        {
+            m_buckets.push_back(std::vector<const B*>());
+            b = m_buckets.size();
+        }
+
+        m_buckets[b-1].push_back(p);
+        ++m_size;
+    }
+
+    /// Removes object p if it is in the index
+    /// \returns Whether it was
+    bool remove(const B* p)
+    {
+        typename learned_ptr_map<std::intptr_t,size_t>::const_iterator q = m_bucket_of.find(vtbl_of(p));
+
+        if (q == m_bucket_of.end())
+            return false;
+
+        std::vector<const B*>& objects = m_buckets[q->second-1];
+        typename std::vector<const B*>::iterator i = std::find(objects.begin(), objects.end(), p);
+
+        if (i == objects.end())
+            return false;
+
+        objects.erase(i);
+        --m_size;
+        return true;
+    }
+
+    /// Removes all objects
+    void clear()
+    {
+        m_bucket_of.clear();
+        m_buckets.clear();
+        m_size = 0;
+    }
+
+    /// Number of objects in the index
+    size_t size()    const noexcept { return m_size; }
+    /// Number of distinct dynamic types of objects that were added
+    size_t classes() const noexcept { return m_buckets.size(); }
+
+    /// Calls f with every object whose dynamic type is T or derived from it, as T
+    template <typename T, typename F>
+    void for_each_instance(F f) const
+    {
+        std::vector<bucket<T>> buckets = buckets_of<T>();
+
+        for (size_t i = 0; i < buckets.size(); ++i)
+            for (size_t j = 0; j < buckets[i].objects->size(); ++j)
+                f(*buckets[i].as((*buckets[i].objects)[j]));
+    }
+
+    /// Calls f with every object that pattern accepts, while variables of the
+    /// pattern are bound to it
+    template <typename P, typename F>
+    void for_each_match(const P& pattern, F f) const
+    {
+        typedef typename pattern_target<P>::type T;
+        for_each_instance<T>([&](const T& t) { if (pattern(t)) f(t); });
+    }
+
+    /// Objects that pattern accepts as its target type
+    template <typename P>
+    std::vector<const typename pattern_target<P>::type*> find_all(const P& pattern) const
+    {
+        typedef typename pattern_target<P>::type T;
+        std::vector<const T*> result;
+        for_each_instance<T>([&](const T& t) { if (pattern(t)) result.push_back(&t); });
+        return result;
+    }
+
+    /// Objects of type T for which predicate returns true, in the same order as
+    /// for_each_instance() visits them. Predicate is called concurrently on 
+    /// threads threads, one per hardware thread when 0, including the calling 
+    /// one, and has to be safe to call from several threads.
+    template <typename T, typename F>
+    std::vector<const T*> parallel_find_all(F predicate, size_t threads = 0) const
+    {
+        enum { grain = 1024 }; // Objects per chunk, which are taken by threads one at a time
+
+        std::vector<bucket<T>> buckets = buckets_of<T>();
+        std::vector<chunk>     chunks;
+
+        for (size_t i = 0; i < buckets.size(); ++i)
+            for (size_t b = 0, e = buckets[i].objects->size(); b < e; b += grain)
+                chunks.push_back(chunk(i, b, std::min(b + grain, e)));
+
+        if (!threads)
+            threads = std::thread::hardware_concurrency();
+
+        threads = std::max(size_t(1), std::min(threads, chunks.size()));
+
+        std::vector<std::vector<const T*>> found(chunks.size()); // Per chunk, so the order does not depend on threads
+        std::atomic<size_t> next(0);
+        std::atomic<bool>   failed(false);
+        std::mutex          error_mutex;
+        std::exception_ptr  error;
+
+        auto work = [&]()
+        {
+            for (size_t c; !failed && (c = next++) < chunks.size(); )
+            {
+                try
+                {
+                    const bucket<T>& b = buckets[chunks[c].bucket];
+
+                    for (size_t j = chunks[c].first; j < chunks[c].last; ++j)
+                    {
+                        const T* t = b.as((*b.objects)[j]);
+
+                        if (predicate(*t))
+                            found[c].push_back(t);
+                    }
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> guard(error_mutex);
+
+                    if (!failed.exchange(true))
+                        error = std::current_exception();
+                }
+            }
+        };
+
+        std::vector<std::thread> helpers;
+
+        for (size_t i = 1; i < threads; ++i)
+            helpers.push_back(std::thread(work));
+
+        work();
+
+        for (size_t i = 0; i < helpers.size(); ++i)
+            helpers[i].join();
+
+        if (error)
+            std::rethrow_exception(error);
+
+        std::vector<const T*> result;
+
+        for (size_t c = 0; c < found.size(); ++c)
+            result.insert(result.end(), found[c].begin(), found[c].end());
+
+        return result;
+    }
+
+private:
+
+    /// Objects of one dynamic type derived from T and their offset to T
+    template <typename T>
+    struct bucket
+    {
+        bucket(const std::vector<const B*>* o, std::ptrdiff_t d) : objects(o), offset(d) {}
+        const T* as(const B* p) const noexcept { return reinterpret_cast<const T*>(reinterpret_cast<const char*>(p) + offset); }
+        const std::vector<const B*>* objects;
+        std::ptrdiff_t               offset;
+    };
+
+    /// Range [first,last) of objects of a bucket
+    struct chunk
+    {
+        chunk(size_t b, size_t f, size_t l) : bucket(b), first(f), last(l) {}
+        size_t bucket;
+        size_t first;
+        size_t last;
+    };
+
+    /// Buckets of classes derived from T with their offsets to T
+    template <typename T>
+    std::vector<bucket<T>> buckets_of() const
+    {
+        std::vector<bucket<T>> result;
+
+        for (size_t i = 0; i < m_buckets.size(); ++i)
+            if (!m_buckets[i].empty())
+                if (const T* t = hooked_cast<const T*>(m_buckets[i].front()))
+                    result.push_back(bucket<T>(&m_buckets[i], reinterpret_cast<const char*>(t) - reinterpret_cast<const char*>(m_buckets[i].front())));
+
+        return result;
+    }
+
+    virtual void made(const B* object) { add(object); }
+    virtual void cleared()             { clear(); }
+
+    learned_ptr_map<std::intptr_t,size_t> m_bucket_of; ///< 1-based position of the bucket of each vtbl-pointer
+    std::vector<std::vector<const B*>>    m_buckets;   ///< Objects of each dynamic type in the order of addition
+    size_t                                m_size;      ///< Number of objects in all buckets
+};
+
+//------------------------------------------------------------------------------
+
+} // of namespace mch
@@ -0,0 +1,147 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file defines a subset of Match statements on kinds (\see #MatchK and 
+/// #MatchU) that can be used in GPU kernels of CUDA, HIP and SYCL as well as
+/// on the host:
+/// \code
+///     MatchKD(cell)
+///     {
+///     CaseKD(Fluid)  return flow(*matched);
+///     CaseKD(Solid)  return stress(*matched);
+///     OtherwiseKD()  return 0;
+///     }
+///     EndMatchKD
+/// \endcode
+/// The statements are a switch on the value of the kind selector of the subject
+/// (\see #KS and #KV) without statics, allocation, RTTI, exceptions or calls to 
+/// functions that are not #XTL_HOST_DEVICE. In exchange, clauses only name the
+/// kind and do not take patterns or guards, Otherwise clause, when present, has
+/// to be the last one, and clauses never fall through as with #XTL_FALL_THROUGH.
+/// Kind selectors have to be data members, or functions or member functions
+/// that are also #XTL_HOST_DEVICE, not the masked ones of #KSM, #KSN and #KSB.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#pragma once
+
+#include "patterns/bindings.hpp"
+#include <type_traits>
+
+namespace mch ///< Mach7 library namespace
+{
+
+//------------------------------------------------------------------------------
+
+/// Address of the subject of #MatchKD and #MatchUD given by reference or pointer
+template <typename T> XTL_HOST_DEVICE inline const T* device_addr(const T* t) noexcept { return t; }
+template <typename T> XTL_HOST_DEVICE inline       T* device_addr(      T* t) noexcept { return t; }
+template <typename T> XTL_HOST_DEVICE inline const T* device_addr(const T& t) noexcept { return &t; }
+template <typename T> XTL_HOST_DEVICE inline       T* device_addr(      T& t) noexcept { return &t; }
+
+//------------------------------------------------------------------------------
+
+/// Value of the kind selector of a subject, which is a data member ...
+template <class C, class T, typename R>
+XTL_HOST_DEVICE inline R device_kind(const C* c, R T::*field) noexcept { return c->*field; }
+
+/// ... or a member function or a function, which kernels can only call when they are #XTL_HOST_DEVICE
+template <class C, class T, typename R>
+XTL_HOST_DEVICE inline R device_kind(const C* c, R (T::*method)() const) { return (c->*method)(); }
+template <class C, class T, typename R>
+XTL_HOST_DEVICE inline R device_kind(const C* c, R (*func)(const T&))    { return (*func)(*c); }
+template <class C, class T, typename R>
+XTL_HOST_DEVICE inline R device_kind(const C* c, R (*func)(const T*))    { return (*func)(c); }
+
+//------------------------------------------------------------------------------
+
+/// Casts the subject of #MatchKD to the class of the clause, keeping its constness
+template <typename D, typename B> XTL_HOST_DEVICE inline const D* device_cast(const B* b) noexcept { return static_cast<const D*>(b); }
+template <typename D, typename B> XTL_HOST_DEVICE inline       D* device_cast(      B* b) noexcept { return static_cast<      D*>(b); }
+
+//------------------------------------------------------------------------------
+
+} // of namespace mch
+
+//------------------------------------------------------------------------------
+
+/// Macro that starts the switch on subjects of a class hierarchy whose classes
+/// have distinct kinds, \see #MatchK.
+#define MatchKD(s) {                                                           \
+        auto const __subject_ptr = mch::device_addr(s);                        \
+        typedef typename std::remove_cv<typename std::remove_pointer<decltype(__subject_ptr)>::type>::type __source_type; \
+        switch (mch::device_kind(__subject_ptr, mch::bindings<__source_type>::kind_selector())) { {
+
+/// Clause of #MatchKD on objects of class C, available to it as pointer matched
+#define CaseKD(C)                                                              \
+        } break;                                                               \
+        case mch::bindings<C>::kind_value: {                                   \
+            auto const matched = mch::device_cast<C>(__subject_ptr);          \
+            (void)matched;
+
+/// Clause of #MatchKD taken for kinds of no other clause, with the subject as matched
+#define OtherwiseKD()                                                          \
+        } break;                                                               \
+        default: {                                                             \
+            auto const matched = __subject_ptr;                                \
+            (void)matched;
+
+#define EndMatchKD } break; }}
+
+//------------------------------------------------------------------------------
+
+/// Macro that starts the switch on subjects of a single class whose layouts
+/// have distinct kinds, \see #MatchU.
+#define MatchUD(s) {                                                           \
+        auto const __subject_ptr = mch::device_addr(s);                        \
+        typedef typename std::remove_cv<typename std::remove_pointer<decltype(__subject_ptr)>::type>::type __source_type; \
+        switch (mch::device_kind(__subject_ptr, mch::bindings<__source_type>::kind_selector())) { {
+
+/// Clause of #MatchUD on the subject in layout L, which is available as matched
+#define CaseUD(L)                                                              \
+        } break;                                                               \
+        case mch::bindings<__source_type,L>::kind_value: {                     \
+            auto const matched = __subject_ptr;                                \
+            (void)matched;
+
+#define OtherwiseUD()   OtherwiseKD()
+#define EndMatchUD      EndMatchKD
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,494 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file defines class learned_ptr_map<K,V>: an associative container for
+/// small sets of pointer-like keys whose distribution is not known in advance,
+/// e.g. caches keyed by identity of objects, dispatch tables keyed by pointers
+/// to functions or maps of interned strings. It hashes keys the way vtbl maps
+/// of Match statements hash vtbl-pointers: by taking log_size() bits of the key
+/// starting from bit shift(), where both are learned from the keys in the map,
+/// so that as many keys as possible are found in their home slot right away.
+/// \code
+///     mch::learned_ptr_map<const char*,int> ids;
+///     ids[interned("add")] = 1;
+///     if (ids.count(name)) ...
+///     for (auto& kv : ids) std::cout << kv.first << '=' << kv.second;
+/// \endcode
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#pragma once
+
+// --------------------[ Design Notes ]--------------------
+// - Keys are pointers, pointers to functions, integers or enumerations, which
+//   are hashed by their bits. The key with all bits 0 (e.g. nullptr) marks
+//   empty slots and cannot be stored.
+// - Unlike vtbl maps, which never drop what they learned and keep references
+//   to their values valid forever, the container has erase. Keys not in their
+//   home slot are thus found by linear probing rather than by a scan of the
+//   whole cache, and slots are kept at most 3/4 full so that probing ends 
+//   quickly. Erase shifts the following keys of a probe sequence back instead
+//   of leaving tombstones, so lookups never probe past an erased key.
+// - A learned shift often lays keys out in one contiguous run of slots, which
+//   an absent key would probe to its end. The map thus keeps the longest 
+//   distance of a key from its home slot, and lookups give up after it.
+// - As in vtbl maps, the size and shift are relearned only when a new key 
+//   collides with another in its home slot, at first on the first collision 
+//   and afterwards on every #renewed_collisions_before_update-th one, and 
+//   only when keys were added since the last time. Log sizes from the one 
+//   needed for the keys to #XTL_MAX_LOG_INC more are tried, each with every
+//   shift between the lowest and the highest bit in which keys differ, and 
+//   the combination with most distinct home slots is taken. Above 
+//   #XTL_MAX_TUNED_LOG_SIZE the shift only drops the bits in which all keys 
+//   are equal, since a shift tuned to a few keys would pile others up. Those
+//   bits are accumulated as keys are inserted and are not recomputed on erase,
+//   so that relearning of large maps does not scan all the slots.
+// - Values live in the slots, so inserting, erasing and relearning move them
+//   and invalidate references and iterators, as in std::vector.
+// - Bulk insertion learns once after all the keys are in.
+//------------------------------------------------------------------------------
+
+#include "ptrtools.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace mch ///< Mach7 library namespace
+{
+
+//------------------------------------------------------------------------------
+
+/// Bits of a key of learned_ptr_map that are hashed
+template <typename K>
+inline typename std::enable_if<std::is_pointer<K>::value, std::uintptr_t>::type key_bits(K k) noexcept 
+{ 
+    return reinterpret_cast<std::uintptr_t>(k); 
+}
+
+template <typename K>
+inline typename std::enable_if<std::is_integral<K>::value || std::is_enum<K>::value, std::uintptr_t>::type key_bits(K k) noexcept
+{ 
+    return static_cast<std::uintptr_t>(k); 
+}
+
+//------------------------------------------------------------------------------
+
+/// Associative container of pointer-like keys hashed by learned bits of keys
+/// \see learned_ptr_map.hpp
+template <typename K, typename V>
+class learned_ptr_map
+{
+public:
+
+    typedef K                 key_type;
+    typedef V                 mapped_type;
+    typedef std::pair<K,V>    value_type;
+    typedef std::size_t       size_type;
+
+    /// Number of collisions of new keys after which the size and shift are
+    /// relearned once they were learned for the first time
+    static const int renewed_collisions_before_update = 16;
+
+private:
+
+    typedef std::vector<value_type> slots_type;
+
+    /// Iterator over occupied slots
+    template <typename Slot>
+    class basic_iterator
+    {
+    public:
+        typedef std::forward_iterator_tag                iterator_category;
+        typedef typename std::remove_const<Slot>::type value_type;
+        typedef std::ptrdiff_t                           difference_type;
+        typedef Slot*                                    pointer;
+        typedef Slot&                                    reference;
+
+        basic_iterator() noexcept : slot(0), last(0) {}
+        basic_iterator(Slot* s, Slot* l) noexcept : slot(s), last(l) { skip_empty(); }
+
+        /// Non-const iterators convert to const ones
+        template <typename S>
+        basic_iterator(const basic_iterator<S>& i) noexcept : slot(i.slot), last(i.last) {}
+
+        reference operator*()  const noexcept { return *slot; }
+        pointer   operator->() const noexcept { return  slot; }
+
+        basic_iterator& operator++()    noexcept { ++slot; skip_empty(); return *this; }
+        basic_iterator  operator++(int) noexcept { basic_iterator tmp(*this); ++*this; return tmp; }
+
+        template <typename S> bool operator==(const basic_iterator<S>& i) const noexcept { return slot == i.slot; }
+        template <typename S> bool operator!=(const basic_iterator<S>& i) const noexcept { return slot != i.slot; }
+
+    private:
+
+        void skip_empty() noexcept { while (slot != last && !key_bits(slot->first)) ++slot; }
+
+        template <typename S> friend class basic_iterator;
+        friend class learned_ptr_map;
+
+        Slot* slot; ///< Current slot
+        Slot* last; ///< Slot past the last one
+    };
+
+public:
+
+    typedef basic_iterator<value_type>       iterator;
+    typedef basic_iterator<const value_type> const_iterator;
+
+    /// \note Maps do not allocate until the first insertion
+    learned_ptr_map() noexcept : mask(0), key_shift(0), used(0), last_learned_size(0), collisions_before_update(1), max_probe(0), first_bits(0), diff_bits(0), update_count(0) {}
+
+    /// Creates map of keys and values in [first,last) \see insert(I,I)
+    template <typename I>
+    learned_ptr_map(I first, I last) : mask(0), key_shift(0), used(0), last_learned_size(0), collisions_before_update(1), max_probe(0), first_bits(0), diff_bits(0), update_count(0) { insert(first, last); }
+
+    iterator       begin()        noexcept { return iterator      (slots.data(), slots.data() + slots.size()); }
+    iterator       end()          noexcept { return iterator      (slots.data() + slots.size(), slots.data() + slots.size()); }
+    const_iterator begin()  const noexcept { return const_iterator(slots.data(), slots.data() + slots.size()); }
+    const_iterator end()    const noexcept { return const_iterator(slots.data() + slots.size(), slots.data() + slots.size()); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend()   const noexcept { return end(); }
+
+    size_type size()  const noexcept { return used; }
+    bool      empty() const noexcept { return used == 0; }
+
+    /// Iterator to the entry of key k or end()
+    iterator find(const K& k) noexcept
+    {
+        value_type* s = lookup(key_bits(k));
+        return s ? iterator(s, slots.data() + slots.size()) : end();
+    }
+
+    const_iterator find(const K& k) const noexcept
+    {
+        const value_type* s = const_cast<learned_ptr_map*>(this)->lookup(key_bits(k));
+        return s ? const_iterator(s, slots.data() + slots.size()) : end();
+    }
+
+    size_type count(const K& k) const noexcept { return find(k) != end(); }
+
+    /// Value of key k, inserted default constructed when absent
+    V& operator[](const K& k)
+    {
+        const std::uintptr_t b = key_bits(k);
+
+        if (value_type* s = lookup(b))
+            return s->second;
+
+        return place_and_learn(b, value_type(k, V()))->second;
+    }
+
+    /// Inserts v unless its key is already in the map
+    /// \returns Iterator to the entry of the key and whether v was inserted
+    std::pair<iterator,bool> insert(const value_type& v)
+    {
+        const std::uintptr_t b = key_bits(v.first);
+
+        if (value_type* s = lookup(b))
+            return std::make_pair(iterator(s, slots.data() + slots.size()), false);
+
+        value_type* s = place_and_learn(b, value_type(v));
+        return std::make_pair(iterator(s, slots.data() + slots.size()), true);
+    }
+
+    /// Inserts key-value pairs of [first,last) whose keys are not in the map
+    /// yet. The size and shift are learned once after all of them are in.
+    template <typename I>
+    void insert(I first, I last)
+    {
+        reserve(used + std::distance(first, last));
+
+        for (; first != last; ++first)
+        {
+            const std::uintptr_t b = key_bits(first->first);
+
+            if (!lookup(b))
+                place(b, value_type(first->first, first->second));
+        }
+
+        if (used != last_learned_size)
+            learn();
+    }
+
+    /// Erases the entry of key k if there is one
+    /// \returns The number of erased entries
+    size_type erase(const K& k)
+    {
+        value_type* s = lookup(key_bits(k));
+
+        if (!s)
+            return 0;
+
+        erase_slot(size_t(s - slots.data()));
+        return 1;
+    }
+
+    /// Erases the entry i refers to. Invalidates all iterators.
+    void erase(const_iterator i) { erase_slot(size_t(i.slot - slots.data())); }
+
+    /// Erases all entries and releases the memory
+    void clear() noexcept
+    {
+        slots_type().swap(slots);
+        mask = key_shift = used = last_learned_size = max_probe = first_bits = diff_bits = 0;
+        collisions_before_update = 1;
+    }
+
+    /// Grows the slots to take n keys without growing again
+    void reserve(size_type n)
+    {
+        const size_t k = needed_log_size(n);
+
+        if (slots.empty() || k > log_size())
+            rebuild(k, key_shift);
+    }
+
+    /// Number of slots is 2^log_size() or 0 before the first insertion
+    size_t log_size()       const noexcept { return slots.empty() ? 0 : req_bits(mask); }
+    /// Number of lowest bits of keys the hash drops
+    size_t shift()          const noexcept { return key_shift; }
+    /// Number of times slots were reallocated or rearranged
+    size_t updates()        const noexcept { return update_count; }
+    /// Number of keys that are not in their home slot
+    size_type displaced()   const noexcept
+    {
+        size_type result = 0;
+
+        for (size_t i = 0; i < slots.size(); ++i)
+            if (const std::uintptr_t b = key_bits(slots[i].first))
+                result += home(b) != i;
+
+        return result;
+    }
+
+    /// Number of bytes used by the map, not counting memory owned by keys and values
+    size_t memory_used() const noexcept { return sizeof(*this) + slots.capacity()*sizeof(value_type); }
+
+private:
+
+    size_t home(std::uintptr_t b) const noexcept { return (b >> key_shift) & mask; }
+
+    /// Smallest log size whose slots are at most 3/4 full with n keys
+    static size_t needed_log_size(size_type n) noexcept
+    {
+        size_t k = XTL_MIN_LOG_SIZE;
+
+        while ((size_type(3) << k) < 4*n)
+            ++k;
+
+        return k;
+    }
+
+    /// Slot of key with bits b or null when it is not in the map
+    value_type* lookup(std::uintptr_t b) noexcept
+    {
+        XTL_ASSERT(b); // Keys with all bits 0 mark empty slots
+
+        if (XTL_UNLIKELY(slots.empty()))
+            return 0;
+
+        for (size_t j = home(b), d = 0; d <= max_probe; j = (j+1) & mask, ++d)
+        {
+            const std::uintptr_t s = key_bits(slots[j].first);
+
+            if (XTL_LIKELY(s == b))
+                return &slots[j];
+
+            if (!s)
+                break;
+        }
+
+        return 0;
+    }
+
+    /// Puts v with key bits b that is not in the map into a vacant slot
+    /// \returns Whether its home slot was taken by another key
+    bool place(std::uintptr_t b, value_type&& v)
+    {
+        if (slots.empty() || 4*(used+1) > 3*slots.size())
+            rebuild(needed_log_size(used+1), key_shift);
+
+        size_t j = home(b), d = 0;
+
+        for (; key_bits(slots[j].first); j = (j+1) & mask)
+            ++d;
+
+        slots[j] = std::move(v);
+        max_probe = std::max(max_probe, d);
+        ++used;
+
+        if (!first_bits) first_bits = b;
+        diff_bits |= first_bits ^ b;
+
+        return d != 0;
+    }
+
+    /// Places v and relearns the size and shift when the collisions justify it
+    value_type* place_and_learn(std::uintptr_t b, value_type&& v)
+    {
+        if (place(b, std::move(v)) 
+            && --collisions_before_update <= 0 // We had sufficiently many collisions to justify call
+            && used != last_learned_size)      // There was at least one key added since last update
+            learn();
+
+        return lookup(b);
+    }
+
+    /// Erases the entry in slot i and shifts back the keys that probed past it.
+    /// Keys farther than #max_probe from the vacant slot cannot have probed past it.
+    void erase_slot(size_t i)
+    {
+        slots[i] = value_type();
+
+        for (size_t j = (i+1) & mask; ((j-i) & mask) <= max_probe && key_bits(slots[j].first); j = (j+1) & mask)
+        {
+            const size_t h = home(key_bits(slots[j].first));
+
+            // The key stays unless its home is not cyclically in (i,j]
+            if (i <= j ? (h <= i || h > j) : (h <= i && h > j))
+            {
+                slots[i] = std::move(slots[j]);
+                slots[j] = value_type();
+                i = j;
+            }
+        }
+
+        --used;
+    }
+
+    /// Chooses the log size and shift with most distinct home slots of the keys
+    void learn()
+    {
+        collisions_before_update = renewed_collisions_before_update;
+        last_learned_size        = used;
+
+        const std::uintptr_t diff = diff_bits;
+        size_t z = 0; // Lowest bits in which keys do not differ
+
+        while (z < XTL_BIT_SIZE(std::uintptr_t) && diff && !(diff & (std::uintptr_t(1) << z)))
+            ++z;
+
+        const size_t m  = diff ? req_bits(diff) : 0; // Highest bit in which keys differ
+        const size_t k  = log_size();
+        const size_t l1 = std::max(k, needed_log_size(used));
+
+        if (l1 > XTL_MAX_TUNED_LOG_SIZE)
+        {
+            if (l1 != k || z != key_shift)
+                rebuild(l1, z);
+            return;
+        }
+
+        const size_t l2 = std::min(size_t(XTL_MAX_TUNED_LOG_SIZE), l1 + XTL_MAX_LOG_INC);
+        size_t best_log = l1, best_shift = z, best_homes = 0;
+        std::vector<bool> taken;
+
+        for (size_t i = l1; i <= l2; ++i)
+            for (size_t j = z; j == z || j + i <= m; ++j)
+            {
+                taken.assign(size_t(1) << i, false);
+                size_t homes = 0;
+
+                for (size_t s = 0; s < slots.size(); ++s)
+                    if (const std::uintptr_t b = key_bits(slots[s].first))
+                    {
+                        const size_t h = (b >> j) & ((size_t(1) << i) - 1);
+                        homes += !taken[h];
+                        taken[h] = true;
+                    }
+
+                if (homes > best_homes)
+                {
+                    best_homes = homes;
+                    best_log   = i;
+                    best_shift = j;
+                }
+
+                if (homes == used)
+                    goto Found; // No collisions, exit both loops
+            }
+Found:
+        if (best_log != k || best_shift != key_shift)
+            rebuild(best_log, best_shift);
+    }
+
+    /// Reallocates the slots into 2^log_size of them hashed with shift
+    void rebuild(size_t new_log_size, size_t new_shift)
+    {
+        slots_type old(size_t(1) << new_log_size);
+        old.swap(slots);
+        mask      = slots.size() - 1;
+        key_shift = new_shift;
+        max_probe = 0;
+        ++update_count;
+
+        for (size_t i = 0; i < old.size(); ++i)
+            if (const std::uintptr_t b = key_bits(old[i].first))
+            {
+                size_t j = home(b), d = 0;
+
+                for (; key_bits(slots[j].first); j = (j+1) & mask)
+                    ++d;
+
+                slots[j] = std::move(old[i]);
+                max_probe = std::max(max_probe, d);
+            }
+    }
+
+    slots_type slots;                    ///< 2^log_size() slots, those with key bits 0 are vacant
+    size_t     mask;                     ///< Number of slots less one
+    size_t     key_shift;                ///< Lowest bits of keys dropped by the hash
+    size_type  used;                     ///< Number of keys in the map
+    size_type  last_learned_size;        ///< Number of keys when size and shift were learned last time
+    int        collisions_before_update; ///< Collisions of new keys left until size and shift are relearned
+    size_t     max_probe;                ///< No key is farther from its home slot, lookups of absent keys stop there
+    std::uintptr_t first_bits;           ///< Bits of the first key placed since the last clear()
+    std::uintptr_t diff_bits;            ///< Bits in which keys placed since the last clear() differ
+    size_t     update_count;             ///< Number of times slots were reallocated or rearranged
+};
+
+//------------------------------------------------------------------------------
+
+} // of namespace mch
@@ -110,6 +110,18 @@
 
 #include "unisyn.hpp"
 
+#if XTL_SAMPLE_MATCH_SITES
+#include "sampling.hpp"    // Hook called on sampled executions of Match statements
+#endif
+
+#if XTL_TRACE_MATCH_SITES
+#include "tracing.hpp"     // Records of executions of Match statements
+#endif
+
+#if XTL_REGEX_SETS
+#include "patterns/regex.hpp" // Sets of expressions of rex() clauses
+#endif
+
 #if defined(_MSC_VER) && !defined(_CPPRTTI)
     /// Disabling RTTI in MSVC is known to enable compiler optimizations that
     /// may render type switching on a polymorphic object type unsafe.
@@ -121,6 +133,9 @@
 #if XTL_USE_MEMOIZED_CAST
   #include "memoized_cast.hpp"
   #define dynamic_cast memoized_cast
+#elif !XTL_RTTI
+  #define memoized_cast dynamic_cast
+  #define dynamic_cast mch::hooked_cast
 #else
   #define memoized_cast dynamic_cast
 #endif
@@ -139,7 +154,7 @@ struct preallocated<vtblmap<T>,UID>
 };
 
 template <typename T, typename UID>
-vtblmap<T> preallocated<vtblmap<T>,UID>::value(
+XTL_DISPATCH_PLACEMENT vtblmap<T> preallocated<vtblmap<T>,UID>::value(
     deferred_constant<vtbl_count_t>::get<UID>::value 
         ? deferred_constant<vtbl_count_t>::get<UID>::value 
         : min_expected_size
@@ -173,23 +188,45 @@ template <typename T> inline size_t get_frequency(intptr_t vtbl) { return get_fr
 
 template <class T> inline void ignore_unused_warning(T const&) {}
 
+//------------------------------------------------------------------------------
+
+/// Type test with the semantics of catching a subject of static type S by a
+/// handler of type T: it fails unless T is an unambiguous public base of the 
+/// dynamic type of the subject. This is what dynamic_cast checks, except that
+/// it rejects statically ambiguous or inaccessible bases at compile time. Any
+/// class derived from S has them ambiguous or inaccessible as well, so such 
+/// tests always fail.
+template <typename T, typename S>
+inline const T* catch_cast(const S* s, std::false_type) noexcept { XTL_OVERHEAD_ACCOUNTING_ONLY(count_type_test_cast<T,S>()); return dynamic_cast<const T*>(s); }
+
+/// Handler type that is a statically ambiguous or inaccessible base of S
+template <typename T, typename S>
+inline const T* catch_cast(const S*,   std::true_type)  noexcept { return 0; }
+
+template <typename T, typename S>
+inline const T* catch_cast(const S* s) noexcept
+{
+    return catch_cast<T>(s, std::integral_constant<bool, std::is_base_of<T,S>::value && !std::is_convertible<const S*, const T*>::value>());
+}
+
 } // of namespace mch
 
 //------------------------------------------------------------------------------
 
 /// A helper macro to access kind value of a class
-#define BCK(D,B) (ignore_unused_warning(associate_kinds<D,B>::kinds),remapped<B>::lbl)
+#define BCK(D,B) remapped<B>::lbl
 
 /// A set of macros handling various amount of base classes passed to BCS macro.
-#define BCS0()                        static const lbl_type* get_kinds() { static const lbl_type kinds[] = { lbl_type(0) }; return kinds; }
-#define BCS1(x0)                      static const lbl_type* get_kinds() { static const lbl_type kinds[] = { BCK(D,x0), lbl_type(0) }; return kinds; }
-#define BCS2(x0,x1)                   static const lbl_type* get_kinds() { static const lbl_type kinds[] = { BCK(D,x0), BCK(D,x1), lbl_type(0) }; return kinds; }
-#define BCS3(x0,x1,x2)                static const lbl_type* get_kinds() { static const lbl_type kinds[] = { BCK(D,x0), BCK(D,x1), BCK(D,x2), lbl_type(0) }; return kinds; }
-#define BCS4(x0,x1,x2,x3)             static const lbl_type* get_kinds() { static const lbl_type kinds[] = { BCK(D,x0), BCK(D,x1), BCK(D,x2), BCK(D,x3), lbl_type(0) }; return kinds; }
-#define BCS5(x0,x1,x2,x3,x4)          static const lbl_type* get_kinds() { static const lbl_type kinds[] = { BCK(D,x0), BCK(D,x1), BCK(D,x2), BCK(D,x3), BCK(D,x4), lbl_type(0) }; return kinds; }
-#define BCS6(x0,x1,x2,x3,x4,x5)       static const lbl_type* get_kinds() { static const lbl_type kinds[] = { BCK(D,x0), BCK(D,x1), BCK(D,x2), BCK(D,x3), BCK(D,x4), BCK(D,x5), lbl_type(0) }; return kinds; }
-#define BCS7(x0,x1,x2,x3,x4,x5,x6)    static const lbl_type* get_kinds() { static const lbl_type kinds[] = { BCK(D,x0), BCK(D,x1), BCK(D,x2), BCK(D,x3), BCK(D,x4), BCK(D,x5), BCK(D,x6), lbl_type(0) }; return kinds; }
-#define BCS8(x0,x1,x2,x3,x4,x5,x6,x7) static const lbl_type* get_kinds() { static const lbl_type kinds[] = { BCK(D,x0), BCK(D,x1), BCK(D,x2), BCK(D,x3), BCK(D,x4), BCK(D,x5), BCK(D,x6), BCK(D,x7), lbl_type(0) }; return kinds; }
+/// The lists are constant arrays computed at compile time, \see mch::kinds_of.
+#define BCS0()                        static const lbl_type* get_kinds() { return kinds_of<D>::get(); }
+#define BCS1(x0)                      static const lbl_type* get_kinds() { return kinds_of<D,x0>::get(); }
+#define BCS2(x0,x1)                   static const lbl_type* get_kinds() { return kinds_of<D,x0,x1>::get(); }
+#define BCS3(x0,x1,x2)                static const lbl_type* get_kinds() { return kinds_of<D,x0,x1,x2>::get(); }
+#define BCS4(x0,x1,x2,x3)             static const lbl_type* get_kinds() { return kinds_of<D,x0,x1,x2,x3>::get(); }
+#define BCS5(x0,x1,x2,x3,x4)          static const lbl_type* get_kinds() { return kinds_of<D,x0,x1,x2,x3,x4>::get(); }
+#define BCS6(x0,x1,x2,x3,x4,x5)       static const lbl_type* get_kinds() { return kinds_of<D,x0,x1,x2,x3,x4,x5>::get(); }
+#define BCS7(x0,x1,x2,x3,x4,x5,x6)    static const lbl_type* get_kinds() { return kinds_of<D,x0,x1,x2,x3,x4,x5,x6>::get(); }
+#define BCS8(x0,x1,x2,x3,x4,x5,x6,x7) static const lbl_type* get_kinds() { return kinds_of<D,x0,x1,x2,x3,x4,x5,x6,x7>::get(); }
 
 /// Helper macro for the one below
 #define BCS_(N, ...) XTL_CONCAT(BCS, N)(__VA_ARGS__)
@@ -290,13 +327,24 @@ template <class T> inline void ignore_unused_warning(T const&) {}
         enum { target_layout = mch::default_layout, is_inside_case_clause = 0 }; \
         XTL_ASSERT(xtl_failure("Trying to match against a nullptr",subject_ptr));\
         auto const matched = subject_ptr;                                      \
+        XTL_MEMOIZE_MEMBERS_ONLY(mch::member_memo_scope __member_memo_scope;)  \
+        XTL_REGEX_SETS_ONLY(static mch::regex_site __regex_site; mch::regex_scope __regex_scope(__regex_site);) \
         XTL_UNUSED(matched);
 
+/// Matches the structure of the subject of a clause against constructor pattern.
+/// Under #XTL_EXTRACTORS_MIGHT_THROW only the clauses whose accessors might 
+/// throw get exception handling, \see mch::guarded_match_structure
+#if XTL_EXTRACTORS_MIGHT_THROW && !EXTRACTORS_PROPAGATE_THROW
+#define XTL_MATCH_STRUCTURE(...) mch::guarded_match_structure(__VA_ARGS__, matched)
+#else
+#define XTL_MATCH_STRUCTURE(...) (__VA_ARGS__).match_structure(matched)
+#endif
+
 #define XTL_SUBCLAUSE_FIRST           XTL_NON_FALL_THROUGH_ONLY(XTL_STATIC_IF(false)) XTL_NON_USE_BRACES_ONLY({)
-#define XTL_SUBCLAUSE_OPEN(T,...)                                     XTL_STATIC_IF(XTL_IF(XTL_IS_EMPTY(__VA_ARGS__), true,   XTL_LIKELY(mch::C<target_type,target_layout>(__VA_ARGS__).match_structure(matched)))) {
-#define XTL_SUBCLAUSE_CONTINUE(...) } XTL_NON_FALL_THROUGH_ONLY(else) XTL_STATIC_IF(XTL_IF(XTL_IS_EMPTY(__VA_ARGS__), true, XTL_UNLIKELY(mch::C<target_type,target_layout>(__VA_ARGS__).match_structure(matched)))) {
+#define XTL_SUBCLAUSE_OPEN(T,...)                                     XTL_STATIC_IF(XTL_IF(XTL_IS_EMPTY(__VA_ARGS__), true,   XTL_LIKELY(XTL_MATCH_STRUCTURE(XTL_HOIST_PATTERN(mch::C<target_type,target_layout>(__VA_ARGS__)))))) {
+#define XTL_SUBCLAUSE_CONTINUE(...) } XTL_NON_FALL_THROUGH_ONLY(else) XTL_STATIC_IF(XTL_IF(XTL_IS_EMPTY(__VA_ARGS__), true, XTL_UNLIKELY(XTL_MATCH_STRUCTURE(XTL_HOIST_PATTERN(mch::C<target_type,target_layout>(__VA_ARGS__)))))) {
 //#define XTL_SUBCLAUSE_PATTERN(...)} XTL_NON_FALL_THROUGH_ONLY(else) XTL_STATIC_IF(XTL_IF(XTL_IS_EMPTY(__VA_ARGS__), true, XTL_UNLIKELY(filter(__VA_ARGS__)(*matched)))) {
-#define XTL_SUBCLAUSE_PATTERN(...)                                    XTL_STATIC_IF(XTL_IF(XTL_IS_EMPTY(__VA_ARGS__), true, XTL_UNLIKELY(filter(__VA_ARGS__)(*matched)))) {
+#define XTL_SUBCLAUSE_PATTERN(...)                                    XTL_STATIC_IF(XTL_IF(XTL_IS_EMPTY(__VA_ARGS__), true, XTL_UNLIKELY(XTL_HOIST_PATTERN(filter(__VA_ARGS__))(*matched)))) {
 #define XTL_SUBCLAUSE_CLOSE         }                            XTL_NON_FALL_THROUGH_ONLY(XTL_STATIC_IF(is_inside_case_clause) break;)
 #define XTL_SUBCLAUSE_LAST            XTL_NON_USE_BRACES_ONLY(}) XTL_NON_FALL_THROUGH_ONLY(XTL_STATIC_IF(is_inside_case_clause) break;)
 
@@ -320,6 +368,16 @@ template<typename P>              struct target_disambiguator;           ///< In
 template<typename R, typename A1> struct target_disambiguator<R(A1)>  { typedef A1   type; template<R (&)(A1)>  struct layout { enum { value = default_layout }; }; };
 template<typename R, typename A1> struct target_disambiguator<R(A1&)> { typedef A1   type; template<R (&)(A1&)> struct layout { enum { value = default_layout }; }; };
 template<>                        struct target_disambiguator<int>    { typedef void type; template<int N>      struct layout { enum { value = N }; };              };
+
+/// The dynamic_cast of clauses of #MatchP, made out-of-line under #XTL_LEAN_MATCH,
+/// so that the arguments of __dynamic_cast are not kept live across clauses
+#if XTL_LEAN_MATCH
+template <typename T, typename S>
+XTL_DO_NOT_INLINE_BEGIN const T* clause_dynamic_cast(const S* s) noexcept { return dynamic_cast<const T*>(s); } XTL_DO_NOT_INLINE_END
+#else
+template <typename T, typename S>
+inline const T* clause_dynamic_cast(const S* s) noexcept { return dynamic_cast<const T*>(s); }
+#endif
 } // of namespace mch
 
 #if XTL_CLAUSE_DECL
@@ -372,6 +430,22 @@ template<>                        struct target_disambiguator<int>    { typedef
 ///   * Scope of user's statement to separate from scope of matched declaration
 //------------------------------------------------------------------------------
 
+#if XTL_USE_COMPUTED_GOTO && !XTL_REDUNDANCY_CHECKING
+/// Jumps to the address of the clause of #MatchP remembered for the subject,
+/// skipping the switch that would find it by its label \see #XTL_USE_COMPUTED_GOTO
+#define XTL_JUMP_TO_TARGET_P if (XTL_LIKELY(__switch_info.jump != 0)) goto *__switch_info.jump;
+/// Declaration of the label of a clause of #MatchP, which has to open its block
+#define XTL_DECLARE_JUMP_TARGET_P __label__ __jump_target;
+/// Remembers the address of the label of the clause next to its case label
+#define XTL_REMEMBER_JUMP_TARGET_P __switch_info.jump = &&__jump_target;
+#define XTL_JUMP_TARGET_P __jump_target:
+#else
+#define XTL_JUMP_TO_TARGET_P
+#define XTL_DECLARE_JUMP_TARGET_P
+#define XTL_REMEMBER_JUMP_TARGET_P
+#define XTL_JUMP_TARGET_P
+#endif
+
 /// Macro that starts the switch on pattern
 /// \note case 0: instead of default: will work in the same way because we 
 ///       initialize cache with 0, however through experiments we can see
@@ -382,8 +456,14 @@ template<>                        struct target_disambiguator<int>    { typedef
         enum { __base_counter = XTL_COUNTER };                                 \
         static_assert(std::is_polymorphic<source_type>::value, "Type of subject should be polymorphic when you use MatchP");\
         XTL_PRELOADABLE_LOCAL_STATIC(mch::vtblmap<mch::type_switch_info>,__vtbl2lines_map,match_uid_type,XTL_DUMP_PERFORMANCE_ONLY(__FILE__,__LINE__,XTL_FUNCTION,)XTL_GET_TYPES_NUM_ESTIMATE);\
+        XTL_SAMPLE_MATCH_SITES_ONLY(static const mch::match_site __match_site(__FILE__,__LINE__,XTL_FUNCTION); mch::match_sample __match_sample(__match_site);) \
+        XTL_TRACE_MATCH_SITES_ONLY(static const mch::match_trace_site __trace_site(__FILE__,__LINE__,XTL_FUNCTION); mch::match_trace __match_trace(__trace_site);) \
+        XTL_TRACE_FREQUENCY_ONLY(static mch::frequency_site __frequency_site; __frequency_site.hit(subject_ptr);) \
         register const void* __casted_ptr = 0;                                 \
         mch::type_switch_info& __switch_info = __vtbl2lines_map.get(subject_ptr); \
+        XTL_SAMPLE_MATCH_SITES_ONLY(__match_sample.observe(__switch_info.target);) \
+        XTL_TRACE_MATCH_SITES_ONLY(__match_trace.observe(__switch_info.target,subject_ptr);) \
+        XTL_JUMP_TO_TARGET_P                                                   \
         switch (__switch_info.target)                                          \
         {                                                                      \
             XTL_REDUNDANCY_ONLY(try)                                           \
@@ -397,17 +477,23 @@ template<>                        struct target_disambiguator<int>    { typedef
         XTL_SUBCLAUSE_CLOSE }}                                                 \
         XTL_REDUNDANCY_CATCH(XTL_SELECT_ARG_0(__VA_ARGS__,XTL_EMPTY()))        \
         {                                                                      \
+            XTL_DECLARE_JUMP_TARGET_P                                          \
             typedef XTL_SELECT_ARG_0(__VA_ARGS__,XTL_EMPTY()) C;               \
             XTL_CLAUSE_COMMON(C);                                              \
+            XTL_TRACE_FREQUENCY_ONLY(static const bool __frequency_bound = mch::frequency_profile::get().bind<C>(); XTL_UNUSED(__frequency_bound)) \
             enum { target_label = XTL_COUNTER-__base_counter };                \
-            __casted_ptr = dynamic_cast<const target_type*>(subject_ptr);      \
+            XTL_OVERHEAD_ACCOUNTING_ONLY(mch::count_type_test_cast<target_type,source_type>());\
+            __casted_ptr = mch::clause_dynamic_cast<target_type>(subject_ptr); \
             if (XTL_UNLIKELY(__casted_ptr))                                    \
             {                                                                  \
                 if (XTL_LIKELY((__switch_info.target == 0)))                   \
                 {                                                              \
                     __switch_info.target = target_label;                       \
                     __switch_info.offset = intptr_t(__casted_ptr)-intptr_t(subject_ptr); \
+                    XTL_REMEMBER_JUMP_TARGET_P                                 \
+                    XTL_USE_VTBL_FREQUENCY_ONLY(if (typeid(*subject_ptr) == typeid(C)) __vtbl2lines_map.expect(__switch_info, mch::expected_frequency<C>(0));) \
                 }                                                              \
+            XTL_JUMP_TARGET_P                                                  \
             XTL_NON_REDUNDANCY_ONLY(case target_label:)                        \
                 auto matched = mch::adjust_ptr<target_type>(subject_ptr,__switch_info.offset);\
                 XTL_CLAUSE_DECL_ONLY(C(*matched));                             \
@@ -419,16 +505,20 @@ template<>                        struct target_disambiguator<int>    { typedef
         XTL_SUBCLAUSE_CLOSE }}                                                 \
         XTL_REDUNDANCY_CATCH(mch::underlying<decltype(__VA_ARGS__)>::type::accepted_type_for<source_type>::type) \
         {                                                                      \
+            XTL_DECLARE_JUMP_TARGET_P                                          \
             XTL_CLAUSE_COMMON(mch::underlying<decltype(__VA_ARGS__)>::type::accepted_type_for<source_type>::type); \
             enum { target_label = XTL_COUNTER-__base_counter };                \
-            __casted_ptr = dynamic_cast<const target_type*>(subject_ptr);      \
+            XTL_OVERHEAD_ACCOUNTING_ONLY(mch::count_type_test_cast<target_type,source_type>());\
+            __casted_ptr = mch::clause_dynamic_cast<target_type>(subject_ptr); \
             if (XTL_UNLIKELY(__casted_ptr))                                    \
             {                                                                  \
                 if (XTL_LIKELY(__switch_info.target == 0))                     \
                 {                                                              \
                     __switch_info.target = target_label;                       \
                     __switch_info.offset = intptr_t(__casted_ptr)-intptr_t(subject_ptr); \
+                    XTL_REMEMBER_JUMP_TARGET_P                                 \
                 }                                                              \
+            XTL_JUMP_TARGET_P                                                  \
             XTL_NON_REDUNDANCY_ONLY(case target_label:)                        \
                 auto matched = mch::adjust_ptr<target_type>(subject_ptr,__switch_info.offset);\
                 XTL_UNUSED(matched);                                           \
@@ -445,7 +535,7 @@ template<>                        struct target_disambiguator<int>    { typedef
         XTL_SUBCLAUSE_LAST }}                                                  \
         enum { target_label = XTL_COUNTER-__base_counter };                    \
         XTL_SET_TYPES_NUM_ESTIMATE(target_label-1);                            \
-        if (XTL_UNLIKELY((__casted_ptr == 0 && __switch_info.target == 0))) { __switch_info.target = target_label; } \
+        if (XTL_UNLIKELY((XTL_NON_LEAN_MATCH_ONLY(__casted_ptr == 0 &&) __switch_info.target == 0))) { __switch_info.target = target_label; } \
         case target_label: ; }}
 
 //------------------------------------------------------------------------------
@@ -455,16 +545,18 @@ template<>                        struct target_disambiguator<int>    { typedef
 #define MatchK(s) {                                                            \
         XTL_MATCH_PREAMBULA(s)                                                 \
         static_assert(has_member_kind_selector<mch::bindings<source_type>>::value, "Before using MatchK, you have to specify kind selector on the source type using KS macro");\
+        XTL_SAMPLE_MATCH_SITES_ONLY(static const mch::match_site __match_site(__FILE__,__LINE__,XTL_FUNCTION); mch::match_sample __match_sample(__match_site);) \
         auto const __kind_selector = mch::kind_selector(subject_ptr);          \
+        XTL_SAMPLE_MATCH_SITES_ONLY(__match_sample.observe(__kind_selector);)  \
         switch (__kind_selector) { { XTL_SUBCLAUSE_FIRST
 
 /// Macro that defines the case statement for the above switch
 #define QuaK(...)                                                              \
         XTL_SUBCLAUSE_CLOSE }                                                  \
-        if (XTL_UNLIKELY((size_t(__kind_selector) == size_t(mch::bindings<XTL_SELECT_ARG_0(__VA_ARGS__,XTL_EMPTY())>::kind_value)))) \
+        if (XTL_UNLIKELY((size_t(__kind_selector) == size_t(mch::kind_value_of<source_type,XTL_SELECT_ARG_0(__VA_ARGS__,XTL_EMPTY())>::value)))) \
         {                                                                      \
             typedef XTL_SELECT_ARG_0(__VA_ARGS__,XTL_EMPTY()) C;               \
-        case mch::bindings<C>::kind_value:                                     \
+        case mch::kind_value_of<source_type,C>::value:                         \
             XTL_CLAUSE_COMMON(C);                                              \
             auto matched = mch::stat_cast<target_type>(subject_ptr);           \
             XTL_CLAUSE_DECL_ONLY(C(*matched));                                 \
@@ -485,7 +577,9 @@ template<>                        struct target_disambiguator<int>    { typedef
 //------------------------------------------------------------------------------
 
 /// Macro that starts the switch on types that carry their own dynamic type as
-/// a distinct integral value in one of their members.
+/// a distinct integral value in one of their members or in some bits of it,
+/// e.g. tagged pointers, NaN-boxed doubles or serialized messages (\see #KSM,
+/// #KSN, #KSB).
 #define MatchU(s) {                                                            \
         XTL_MATCH_PREAMBULA(s)                                                 \
         static_assert(has_member_kind_selector<mch::bindings<source_type>>::value, "Before using MatchU, you have to specify kind selector on the subject type using KS macro");\
@@ -515,6 +609,123 @@ template<>                        struct target_disambiguator<int>    { typedef
 
 //------------------------------------------------------------------------------
 
+/// Helpers of #CaseL comparing the subject with and labeling its i-th literal
+#define XTL_SUBJECT_IS_LITERAL(i,...) __subject_value == (XTL_SELECT_ARG(i,__VA_ARGS__))
+#define XTL_LITERAL_CASE_LABEL(i,...) case XTL_SELECT_ARG(i,__VA_ARGS__):
+
+/// Macro that starts the switch on subjects of integral or enumeration type, 
+/// whose clauses list integral literals. The literals become case labels of
+/// an actual switch statement, which a compiler lowers to a jump table or a 
+/// binary search instead of the sequence of comparisons that #MatchS or #Match
+/// would test with value patterns.
+/// Clauses keep their order: when #WhenL guards of the clause the subject was
+/// dispatched to all fail, the control falls through to the following clauses,
+/// which test the subject against their literals in order, as with #MatchK.
+/// \note A literal can label only one clause, since it becomes a case label.
+/// \code
+///     MatchL(opcode)
+///     {
+///     CaseL(0)              return nop();
+///     CaseL(1,2,3)  WhenL(n |= n > 0) return arith(n);
+///     CaseL(4)              return load();
+///     OtherwiseL()  WhenL(n |= n >= 100) return custom(n);
+///     }
+///     EndMatchL
+/// \endcode
+#define MatchL(s) {                                                            \
+        XTL_MATCH_PREAMBULA(s)                                                 \
+        static_assert(std::is_integral<source_type>::value || std::is_enum<source_type>::value, "Type of subject should be integral or enumeration when you use MatchL");\
+        auto const __subject_value = *subject_ptr;                             \
+        switch (__subject_value) { { XTL_SUBCLAUSE_FIRST
+
+/// Macro that defines the case statement for the above switch on N literals
+#define QuaL(N, ...)                                                           \
+        XTL_SUBCLAUSE_CLOSE }                                                  \
+        if (XTL_UNLIKELY((XTL_REPEAT_WITH(||, N, XTL_SUBJECT_IS_LITERAL, __VA_ARGS__)))) \
+        {                                                                      \
+        XTL_REPEAT(N, XTL_LITERAL_CASE_LABEL, __VA_ARGS__)                     \
+            enum { is_inside_case_clause = 1 };                                \
+            XTL_STATIC_IF(true) {
+
+#define CaseL(...)      QuaL(XTL_NARG(__VA_ARGS__),__VA_ARGS__)
+
+/// Guard of the above clauses matching the subject against given pattern
+#define WhenL(...)      } XTL_NON_FALL_THROUGH_ONLY(else) XTL_STATIC_IF(XTL_IF(XTL_IS_EMPTY(__VA_ARGS__), true, XTL_UNLIKELY(XTL_HOIST_PATTERN(mch::filter(__VA_ARGS__))(*matched)))) {
+#define OtherwiseL()                                                           \
+        } XTL_NON_FALL_THROUGH_ONLY(break;) }                                  \
+        default: { {
+#define EndMatchL       XTL_SUBCLAUSE_LAST } }}
+
+//------------------------------------------------------------------------------
+
+#if XTL_EXCEPTION_FREE_MATCHE
+
+/// Macro that starts the switch on types that implement polymorphic exception
+/// idiom without raising the subject, \see #XTL_EXCEPTION_FREE_MATCHE.
+/// Clauses are tried in order with the semantics of catch handlers and the
+/// first one accepted is memoized per vtbl-pointer as in MatchP.
+#define MatchE(s) {                                                            \
+        XTL_MATCH_PREAMBULA(s)                                                 \
+        enum { __base_counter = XTL_COUNTER };                                 \
+        static_assert(std::is_polymorphic<source_type>::value, "Type of subject should be polymorphic when you use MatchE");\
+        XTL_PRELOADABLE_LOCAL_STATIC(mch::vtblmap<mch::type_switch_info>,__vtbl2lines_map,match_uid_type,XTL_DUMP_PERFORMANCE_ONLY(__FILE__,__LINE__,XTL_FUNCTION,)XTL_GET_TYPES_NUM_ESTIMATE);\
+        XTL_SAMPLE_MATCH_SITES_ONLY(static const mch::match_site __match_site(__FILE__,__LINE__,XTL_FUNCTION); mch::match_sample __match_sample(__match_site);) \
+        XTL_TRACE_MATCH_SITES_ONLY(static const mch::match_trace_site __trace_site(__FILE__,__LINE__,XTL_FUNCTION); mch::match_trace __match_trace(__trace_site);) \
+        register const void* __casted_ptr = 0;                                 \
+        mch::type_switch_info& __switch_info = __vtbl2lines_map.get(subject_ptr); \
+        XTL_SAMPLE_MATCH_SITES_ONLY(__match_sample.observe(__switch_info.target);) \
+        XTL_TRACE_MATCH_SITES_ONLY(__match_trace.observe(__switch_info.target,subject_ptr);) \
+        switch (__switch_info.target)                                          \
+        {                                                                      \
+            {                                                                  \
+                {                                                              \
+                    default:                                                   \
+                    XTL_SUBCLAUSE_FIRST
+
+/// Macro that defines the case statement for the above switch
+#define QuaE(...)                                                              \
+        XTL_SUBCLAUSE_CLOSE }}                                                 \
+        {                                                                      \
+            typedef XTL_SELECT_ARG_0(__VA_ARGS__,XTL_EMPTY()) C;               \
+            XTL_CLAUSE_COMMON(C);                                              \
+            enum { target_label = XTL_COUNTER-__base_counter };                \
+            __casted_ptr = mch::catch_cast<target_type>(subject_ptr);          \
+            if (XTL_UNLIKELY(__casted_ptr))                                    \
+            {                                                                  \
+                if (XTL_LIKELY((__switch_info.target == 0)))                   \
+                {                                                              \
+                    __switch_info.target = target_label;                       \
+                    __switch_info.offset = intptr_t(__casted_ptr)-intptr_t(subject_ptr); \
+                }                                                              \
+            case target_label:                                                 \
+                auto matched = mch::adjust_ptr<target_type>(subject_ptr,__switch_info.offset);\
+                XTL_CLAUSE_DECL_ONLY(C(*matched));                             \
+                XTL_UNUSED(matched);                                           \
+                XTL_SUBCLAUSE_OPEN(__VA_ARGS__)
+
+#define CaseE_(...)     QuaE(XTL_SELECT_ARG_0(__VA_ARGS__,XTL_EMPTY()))
+#define CaseE(...)      QuaE(XTL_SELECT_ARG_0(__VA_ARGS__,XTL_EMPTY())) XTL_APPLY_VARIADIC_MACRO(XTL_DECL_BOUND_VARS,(__VA_ARGS__))
+#define WhenE(...)      XTL_SUBCLAUSE_CONTINUE(__VA_ARGS__) __casted_ptr = subject_ptr;
+#define OtherwiseE(...) XTL_CLAUSE_OTHERWISE(CaseE,__VA_ARGS__)
+#define EndMatchE                                                              \
+        XTL_SUBCLAUSE_LAST }}                                                  \
+        enum { target_label = XTL_COUNTER-__base_counter };                    \
+        XTL_SET_TYPES_NUM_ESTIMATE(target_label-1);                            \
+        if (XTL_UNLIKELY((XTL_NON_LEAN_MATCH_ONLY(__casted_ptr == 0 &&) __switch_info.target == 0))) { __switch_info.target = target_label; } \
+        case target_label: ; }}
+
+/// MatchX only differs from MatchE in what is raised, so without raising the
+/// subject they are the same statement.
+#define MatchX(s)       MatchE(s)
+#define QuaX(...)       QuaE(__VA_ARGS__)
+#define CaseX_(...)     CaseE_(__VA_ARGS__)
+#define CaseX(...)      CaseE(__VA_ARGS__)
+#define WhenX(...)      WhenE(__VA_ARGS__)
+#define OtherwiseX(...) XTL_CLAUSE_OTHERWISE(CaseX,__VA_ARGS__)
+#define EndMatchX       EndMatchE
+
+#else
+
 /// Macro that starts the switch on types that implement polymorphic exception idiom.
 /// \note Unlike the rest of our Match statements, MatchE does not allow {} 
 ///       around the case clauses.
@@ -574,12 +785,27 @@ template<>                        struct target_disambiguator<int>    { typedef
 #define OtherwiseX(...) XTL_CLAUSE_OTHERWISE(CaseX,__VA_ARGS__)
 #define EndMatchX       XTL_NON_USE_BRACES_ONLY(}) } catch (...) {} }
 
+#endif
+
 //------------------------------------------------------------------------------
 
+#if XTL_MULTI_THREADING
+    #if !XTL_SUPPORT(thread_local)
+    #error MatchF with XTL_MULTI_THREADING requires compiler support of thread_local storage duration
+    #endif
+    /// mch::kind_to_clause_map is not synchronized, so each thread gets its own
+    #define XTL_KINDS_CACHE(Name) static thread_local mch::kind_to_clause_map Name
+#else
+    #define XTL_KINDS_CACHE(Name) XTL_PRELOADABLE_LOCAL_STATIC(mch::kind_to_clause_map,Name,match_uid_type,XTL_EMPTY())
+#endif
+
 /// Macro that starts the switch on types that carry their own dynamic type as
 /// a distinct integral value in one of their members.
 /// Non-forwarding: Sequential:  33% faster; Random: 34% faster
 ///     Forwarding: Sequential: 251% faster; Random: 33% faster
+/// Kinds without a case clause of their own walk their tag precedence list 
+/// only the first time they are seen, after which they jump directly to the
+/// clause the walk has found, \see mch::kind_to_clause_map.
 /// FIX: The use of vector and resize in it assumes at the moment small tags in 
 ///      region 0..k. Tag randomization will overuse memory!
 #define MatchF(s) {                                                            \
@@ -591,19 +817,25 @@ template<>                        struct target_disambiguator<int>    { typedef
         XTL_CONCAT(ReMatch,__LINE__):                                          \
         switch (size_t(__kind_selector)) {                                     \
         default:                                                               \
+        {                                                                      \
+            XTL_KINDS_CACHE(__kinds_cache);                                    \
             if (XTL_LIKELY(!__kinds))                                          \
             {                                                                  \
-                XTL_PRELOADABLE_LOCAL_STATIC(std::vector<const mch::lbl_type*>,__kinds_cache,match_uid_type,XTL_EMPTY());\
-                if (XTL_UNLIKELY(size_t(__kind_selector) >= __kinds_cache.size()))\
-                    __kinds_cache.resize(__kind_selector+1);                   \
-                __kinds = __kinds_cache[__kind_selector];                      \
-                if (!__kinds)                                                  \
-                    __kinds = __kinds_cache[__kind_selector] = mch::get_kinds<source_type>(__kind_selector);\
+                const mch::lbl_type __target = __kinds_cache.get(__kind_selector);\
+                if (XTL_LIKELY(__target != mch::kind_to_clause_map::unknown()))\
+                {                                                              \
+                    __kind_selector = __target;                                \
+                    goto XTL_CONCAT(ReMatch,__LINE__);                         \
+                }                                                              \
+                __kinds = mch::get_kinds<source_type>(__kind_selector);        \
             }                                                                  \
             XTL_ASSERT(xtl_failure("Base classes for this kind were not specified",__kinds));\
             XTL_ASSERT(xtl_failure("Invalid list of kinds",*__kinds==__kind_selector));      \
             __kind_selector = __kinds ? *++__kinds : mch::lbl_type(0);         \
+            if (XTL_LIKELY(__kinds))                                           \
+                __kinds_cache.set(__most_derived_kind_selector, __kind_selector);\
             goto XTL_CONCAT(ReMatch,__LINE__);                                 \
+        }                                                                      \
         case 0: break; { XTL_SUBCLAUSE_FIRST
 
 /// Macro that defines the case statement for the above switch
@@ -855,6 +1087,7 @@ if (true) {
 /// * K  - tag encoding without forwarding to base classes         - implements exact-fit semantics
 /// * U  - tag encoding for discriminated union types              - implements exact-fit semantics
 /// * E  - dispatch based on exception handling mechanism of C++   - implements first-fit semantics
+/// * L  - literal encoding of integral subjects by switch statement - implements first-fit semantics
 ///
 /// The obvious question is why bother with so many encodings? Once the match 
 /// statement is written, one may wonder to experiment with it whether tag or 
@@ -0,0 +1,226 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library.
+///
+/// Function form of #Match on a single polymorphic subject:
+/// \code
+///     std::string s = mch::match(shape,
+///         mch::case_<Circle>([](const Circle& c) { return "circle"; }),
+///         mch::case_<Square>([](const Square& q) { return "square"; }),
+///         mch::otherwise    ([](const Shape&  x) { return "shape";  }));
+/// \endcode
+/// Clauses are tried top to bottom on a cache miss, just like Case clauses, 
+/// and the selected one is remembered in the same vtbl_map and type_switch_info
+/// the macros use. Being a function, mch::match can be used in expressions and
+/// returns the result of the selected clause without copying it again.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#pragma once
+
+#include "type_switchN-patterns.hpp"
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace mch ///< Mach7 library namespace
+{
+
+//------------------------------------------------------------------------------
+
+/// Clause of mch::match selected for subjects of dynamic type T \see case_
+template <typename T, typename F>
+struct case_clause
+{
+    typedef T target_type;
+    explicit case_clause(F&& f) : function(std::move(f)) {}
+    explicit case_clause(const F& f) : function(f) {}
+    F function; ///< Function called with the subject as T
+};
+
+/// Clause of mch::match selected for any subject \see otherwise
+template <typename F>
+struct otherwise_clause
+{
+    explicit otherwise_clause(F&& f) : function(std::move(f)) {}
+    explicit otherwise_clause(const F& f) : function(f) {}
+    F function; ///< Function called with the subject as is
+};
+
+/// Clause of mch::match calling f with subjects of dynamic type T
+template <typename T, typename F>
+inline case_clause<T,typename std::decay<F>::type> case_(F&& f)
+{
+    return case_clause<T,typename std::decay<F>::type>(std::forward<F>(f));
+}
+
+/// Clause of mch::match calling f with any subject. Has to be the last one.
+template <typename F>
+inline otherwise_clause<typename std::decay<F>::type> otherwise(F&& f)
+{
+    return otherwise_clause<typename std::decay<F>::type>(std::forward<F>(f));
+}
+
+//------------------------------------------------------------------------------
+
+/// Type of the result of calling clause C on subject of static type S
+template <typename S, typename C> struct clause_result;
+template <typename S, typename T, typename F> struct clause_result<S,case_clause<T,F>>  { typedef decltype(std::declval<F&>()(std::declval<const T&>())) type; };
+template <typename S, typename F>             struct clause_result<S,otherwise_clause<F>> { typedef decltype(std::declval<F&>()(std::declval<const S&>())) type; };
+
+/// Type of the result of mch::match on subject of static type S with clauses C...
+template <typename S, typename... C>
+struct match_result
+{
+    typedef typename std::common_type<typename clause_result<S,typename std::decay<C>::type>::type...>::type type;
+};
+
+/// Distinguishes vtbl maps of mch::match on different clauses
+template <typename S, typename... C> struct match_uid {};
+
+//------------------------------------------------------------------------------
+
+/// None of the clauses accepts the subject: jump past the last one
+template <size_t I, typename S>
+inline void resolve_clause(type_switch_info<1>& si, const S*) noexcept
+{
+    si.target = I+1;
+}
+
+/// Selects the first clause accepting the subject on a cache miss the same way
+/// Case clauses of #Match do.
+template <size_t I, typename S, typename T, typename F, typename... C>
+inline void resolve_clause(type_switch_info<1>& si, const S* s, const case_clause<T,F>&, const C&... cs) noexcept
+{
+    if (const T* t = dynamic_cast_when_polymorphic<const T*>(s))
+    {
+        si.offset[0] = intptr_t(t)-intptr_t(s);
+        si.target    = I+1;
+    }
+    else
+        resolve_clause<I+1>(si, s, cs...);
+}
+
+template <size_t I, typename S, typename F, typename... C>
+inline void resolve_clause(type_switch_info<1>& si, const S*, const otherwise_clause<F>&, const C&...) noexcept
+{
+    static_assert(sizeof...(C) == 0, "mch::otherwise has to be the last clause of mch::match");
+    si.offset[0] = 0;
+    si.target    = I+1;
+}
+
+//------------------------------------------------------------------------------
+
+/// Calls clause c with the subject adjusted to its target type
+template <typename R, typename S, typename T, typename F>
+inline R invoke_clause(case_clause<T,F>& c, const S* s, std::ptrdiff_t offset)
+{
+    return c.function(*adjust_ptr_if_polymorphic<T>(s, offset));
+}
+
+template <typename R, typename S, typename F>
+inline R invoke_clause(otherwise_clause<F>& c, const S* s, std::ptrdiff_t)
+{
+    return c.function(*s);
+}
+
+/// Entry I of the jump table of mch::match on clauses Cs
+template <typename R, size_t I, typename S, typename Cs>
+R call_clause(Cs& cs, const S* s, std::ptrdiff_t offset)
+{
+    return invoke_clause<R>(std::get<I>(cs), s, offset);
+}
+
+/// Last entry of the jump table, taken when no clause was selected: result 
+/// is value-initialized.
+template <typename R, typename S, typename Cs>
+R call_no_clause(Cs&, const S*, std::ptrdiff_t)
+{
+    return R();
+}
+
+/// Sequence of clause positions I...
+template <size_t... I> struct clause_indices {};
+template <size_t N, size_t... I> struct make_clause_indices : make_clause_indices<N-1,N-1,I...> {};
+template <size_t... I>           struct make_clause_indices<0,I...> { typedef clause_indices<I...> type; };
+
+/// Jumps to the selected clause through a table of functions calling each of 
+/// them, since a chain of comparisons with target is not turned into one.
+template <typename R, typename S, typename Cs, size_t... I>
+inline R dispatch_clause(const type_switch_info<1>& si, const S* s, Cs&& cs, clause_indices<I...>)
+{
+    typedef typename std::decay<Cs>::type clauses_type;
+    typedef R (*entry_type)(clauses_type&, const S*, std::ptrdiff_t);
+    static const entry_type table[] = { &call_clause<R,I,S,clauses_type>..., &call_no_clause<R,S,clauses_type> };
+    return table[si.target-1](cs, s, si.offset[0]);
+}
+
+//------------------------------------------------------------------------------
+
+/// Function form of #Match on a polymorphic subject with clauses made by
+/// mch::case_ and mch::otherwise. Returns the result of the selected clause,
+/// converted to the common type of the results of all clauses, or its 
+/// value-initialized value when no clause accepts the subject.
+template <typename S, typename... C>
+inline typename match_result<S,C...>::type match(const S& subject, C&&... clauses)
+{
+    static_assert(std::is_polymorphic<S>::value, "mch::match requires a polymorphic subject");
+    typedef match_uid<S,typename std::decay<C>::type...> match_uid_type;
+    typedef vtbl_map<1,type_switch_info<1>,XTL_VTBL_MAP_POLICY> vtbl_map_type;
+    static const vtbl_count_t clause_count = sizeof...(C); // The map keeps a reference to it
+    XTL_PRELOADABLE_LOCAL_STATIC(vtbl_map_type,__vtbl2case_map,match_uid_type,XTL_VTBL_COUNTERS_ONLY(__FILE__,__LINE__,XTL_FUNCTION,)clause_count);
+    XTL_UNUSED(clause_count); // Not passed to a preloaded map
+
+    const S* s = addr(subject);
+    type_switch_info<1>& si = switch_info_of<match_uid_type>(__vtbl2case_map, s);
+
+    if (XTL_UNLIKELY(si.target == 0))
+        resolve_clause<0>(si, s, clauses...);
+
+    // Clauses are moved into the tuple rather than referred to from it, which
+    // leaves nothing to materialize for clauses without state, e.g. lambdas 
+    // that do not capture anything.
+    return dispatch_clause<typename match_result<S,C...>::type>(si, s, std::tuple<typename std::decay<C>::type...>(std::forward<C>(clauses)...), typename make_clause_indices<sizeof...(C)>::type());
+}
+
+//------------------------------------------------------------------------------
+
+} // of namespace mch
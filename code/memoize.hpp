@@ -0,0 +1,242 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library.
+///
+/// Memoization of pure functions of values, e.g. recursive functions defined
+/// by Match statements on integers, tuples of them or hash-consed pointers. 
+/// The function keeps its Match statement and only has its recursive calls 
+/// go through a memoized version of it:
+/// \code
+///     int fib(int n);
+///
+///     int fib_match(int n)
+///     {
+///         var<int> m;
+///         Match(n)
+///         {
+///           Case(1)     return 1;
+///           Case(2)     return 1;
+///           Case(2*m)   return sqr(fib(m+1)) - sqr(fib(m-1));
+///           Case(2*m+1) return sqr(fib(m+1)) + sqr(fib(m));
+///         }
+///         EndMatch
+///     }
+///
+///     int fib(int n) { static mch::memoized<int(int)> f(fib_match); return f(n); }
+/// \endcode
+/// Results are kept in an open-addressing table of a fixed size, so memory 
+/// stays bounded however many arguments the function is called with: a new
+/// result replaces an old one once all the slots it may go to are taken.
+/// Arguments are hashed with mch::memo_hash, which defaults to std::hash and
+/// can be specialized for other types of arguments.
+///
+/// \note The function must be pure: its result may only depend on the values
+///       of its arguments. Pointers are compared by address, so only results
+///       of hash-consed objects can be reused.
+/// \note A memoized function is not thread-safe, make it thread_local instead
+///       of static for functions called from several threads.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#pragma once
+
+#include "config.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// --------------------[ Design Notes ]--------------------
+// - Each argument tuple has a window of memo_probes consecutive slots after
+//   its home slot. Lookups stop at the first empty slot of the window, while 
+//   a result that finds the window full replaces one of its slots in turn.
+// - Slots are never emptied individually, so stopping at an empty slot does
+//   not miss results stored further in the window.
+// - A result is stored after the call that computed it returns, since the 
+//   recursive calls it made may have stored their results in the same window.
+//------------------------------------------------------------------------------
+
+namespace mch ///< Mach7 library namespace
+{
+
+//------------------------------------------------------------------------------
+
+/// Hash of arguments of memoized functions. Specialize for types of arguments
+/// std::hash does not support.
+template <typename T>
+struct memo_hash : std::hash<T> {};
+
+template <typename T1, typename T2>
+struct memo_hash<std::pair<T1,T2>>
+{
+    std::size_t operator()(const std::pair<T1,T2>& p) const { return memo_hash<T1>()(p.first) * 31 + memo_hash<T2>()(p.second); }
+};
+
+/// Hash of arguments a combined from the hashes of each of them
+inline std::size_t memo_combine() noexcept { return 0; }
+
+template <typename A, typename... As>
+inline std::size_t memo_combine(const A& a, const As&... as)
+{
+    return memo_hash<A>()(a) + 0x9E3779B97F4A7C15ull * memo_combine(as...);
+}
+
+//------------------------------------------------------------------------------
+
+/// Number of consecutive slots of the table an argument tuple can be stored in
+const std::size_t memo_probes = 4;
+
+template <typename Signature, typename F = Signature*> class memoized;
+
+/// Function f of signature R(A...) whose results are remembered for the last
+/// arguments it was called with \see memoize.hpp
+template <typename R, typename... A, typename F>
+class memoized<R(A...),F>
+{
+public:
+
+    typedef std::tuple<typename std::decay<A>::type...> key_type;
+    typedef typename std::decay<R>::type                result_type;
+
+    /// Memoizes f with a table of 2^log_size results
+    explicit memoized(F f, std::size_t log_size = XTL_MEMO_LOG_SIZE) 
+      : m_function(std::move(f)), 
+        m_slots(std::size_t(1) << log_size), 
+        m_mask((std::size_t(1) << log_size) - 1), 
+        m_evicted(0), m_hits(0), m_misses(0) 
+    {}
+
+    /// Result of f on args, computed only when not remembered
+    result_type operator()(A... args)
+    {
+        const std::size_t h = home(args...);
+
+        for (std::size_t i = 0; i < memo_probes; ++i)
+        {
+            const slot& s = m_slots[(h + i) & m_mask];
+
+            if (!s.used)
+                break;
+
+            if (s.key == std::tie(args...))
+            {
+                ++m_hits;
+                return s.result;
+            }
+        }
+
+        ++m_misses;
+        result_type r = m_function(args...);
+        store(h, key_type(args...), r);
+        return r;
+    }
+
+    /// Forgets all the results, e.g. when hash-consed objects were released
+    void clear()
+    {
+        for (std::size_t i = 0; i < m_slots.size(); ++i)
+            m_slots[i].used = false;
+    }
+
+    std::size_t capacity() const { return m_slots.size(); } ///< Number of results the table can hold
+    std::size_t hits()     const { return m_hits;   }       ///< Number of calls answered from the table
+    std::size_t misses()   const { return m_misses; }       ///< Number of calls of the function itself
+
+private:
+
+    struct slot
+    {
+        slot() : key(), result(), used(false) {}
+        key_type    key;    ///< Arguments of the call
+        result_type result; ///< Result of the call
+        bool        used;   ///< Whether the slot holds a result
+    };
+
+    /// Home slot of argument tuple args
+    std::size_t home(const A&... args) const
+    {
+        std::size_t h = memo_combine(args...);
+        h ^= h >> 15;
+        h *= std::size_t(0xBF58476D1CE4E5B9ull); // Spreads hashes of small integers over the table
+        h ^= h >> 13;
+        return h & m_mask;
+    }
+
+    /// Remembers result r of the call with arguments k in the window of slot h
+    void store(std::size_t h, key_type&& k, const result_type& r)
+    {
+        std::size_t i = 0;
+
+        while (i < memo_probes && m_slots[(h + i) & m_mask].used && !(m_slots[(h + i) & m_mask].key == k))
+            ++i;
+
+        if (i == memo_probes)
+            i = m_evicted++ % memo_probes; // Full window: replace its slots in turn
+
+        slot& s  = m_slots[(h + i) & m_mask];
+        s.key    = std::move(k);
+        s.result = r;
+        s.used   = true;
+    }
+
+    F                 m_function; ///< Memoized function
+    std::vector<slot> m_slots;    ///< Open-addressing table of results
+    std::size_t       m_mask;     ///< Number of slots minus 1
+    std::size_t       m_evicted;  ///< Number of results replaced by others
+    std::size_t       m_hits;     ///< Number of calls answered from the table
+    std::size_t       m_misses;   ///< Number of calls of the function itself
+};
+
+//------------------------------------------------------------------------------
+
+/// Memoized version of function f of signature R(A...) \see memoize.hpp
+template <typename R, typename... A>
+inline memoized<R(A...)> memoize(R (*f)(A...), std::size_t log_size = XTL_MEMO_LOG_SIZE)
+{
+    return memoized<R(A...)>(f, log_size);
+}
+
+//------------------------------------------------------------------------------
+
+} // of namespace mch
@@ -59,50 +59,29 @@
 //    probably because of locality.
 
 #include "vtblmap.hpp"
+#include "cast_hook.hpp"     // Type tests without RTTI
+#include "memoized_offsets.hpp" // Offsets of target types per vtbl
 #include "metatools.hpp"     // Utility meta-functions
+#include <iterator>          // std::iterator_traits
 #include <vector>
 
-namespace mch ///< Mach7 library namespace
-{
-
-//------------------------------------------------------------------------------
-
-/// A class that keeps a run-time instantiation counter of different types. 
-/// The counter is one per each type U
-template <typename U>
-struct specific_to
-{
-    /// Returns the type index of a given type T among those instantiated in association with U
-    template <typename T>
-    static inline size_t type_index_of()
-    {
-        static const size_t ti = ++type_counter; // will be executed once upon first entry
-        return ti;
-    }
-
-private:
-
-    static size_t type_counter; ///< Actual counter of instantiated types
-
-};
-
-template <typename U> size_t specific_to<U>::type_counter = 0;
-
-//------------------------------------------------------------------------------
+#if XTL_STATIC_PROBES
+#include "probes.hpp"        // Static probe on calls to dynamic_cast
+#endif
 
-template <typename T> struct cast_target;
-template <typename T> struct cast_target<      T*> { typedef T type; };
-template <typename T> struct cast_target<const T*> { typedef T type; };
+#if XTL_OVERHEAD_ACCOUNTING
+#include "overhead.hpp"  // Counters of allocations, casts and updates
+#endif
 
-//------------------------------------------------------------------------------
+#if XTL_CAST_PROFILING
+#include <algorithm>         // Sorting profiles by the number of calls
+#include <atomic>            // Counters of casts are shared between threads
+#include <ostream>           // Dump of profiles
+#include <typeinfo>          // Names of source and target types
+#endif
 
-/// Appendix B of the C++ standard lists implementation quantities, among which 
-/// there is: Size of an object [262 144]. This is only a minimum guideline and 
-/// a concrete implementation might have it set larger, but it gives us some 
-/// reassurance that the following designated constants will be unlikely to 
-/// represent a valid offset within an object.
-static const std::ptrdiff_t no_cast_exists = 0x0FF1C1A1; // A dedicated constant marking impossible offset
-static const std::ptrdiff_t unknown_offset = 0x0FF1C1A0; // A dedicated constant marking an offset that hasn't been computed yet
+namespace mch ///< Mach7 library namespace
+{
 
 //------------------------------------------------------------------------------
 
@@ -112,14 +91,14 @@ static const std::ptrdiff_t unknown_offset = 0x0FF1C1A0; // A dedicated constant
 ///       types represent static type of an object while target types - its 
 ///       dynamic type.
 template <typename T>
-inline std::ptrdiff_t& per_target_offset_of(const void* p)
+inline memoized_offset& per_target_offset_of(const void* p)
 {
     /// The only purpose of this class is to have #unknown_offset be default
     /// value of otherwise a std::ptrdiff_t variable. 
     struct dyn_cast_info
     {
         dyn_cast_info() : offset(unknown_offset) {}
-        std::ptrdiff_t offset;
+        memoized_offset offset;
     };
 
     XTL_PRELOADABLE_LOCAL_STATIC(vtblmap<dyn_cast_info>,offset_map,T);
@@ -134,19 +113,146 @@ inline std::ptrdiff_t& per_target_offset_of(const void* p)
 ///       types represent static type of an object while target types - its 
 ///       dynamic type.
 template <typename S>
-inline std::ptrdiff_t& per_source_offset_of(const void* p, size_t ti)
+inline vtblmap<per_source_offsets>& per_source_offset_map()
+{
+    XTL_PRELOADABLE_LOCAL_STATIC(vtblmap<per_source_offsets>,offset_map,S);
+    return offset_map;
+}
+
+/// Offsets of all target types for the vtbl of p
+template <typename S>
+inline per_source_offsets& per_source_offsets_of(const void* p)
+{
+    return per_source_offset_map<S>().get(p);
+}
+
+//------------------------------------------------------------------------------
+
+#if XTL_VTBL_STATISTICS
+/// Number of bytes used by the memoized offsets of all source types 
+/// memoized_cast has been used with so far.
+inline size_t memoized_casts_memory_used()
+{
+    size_t result = 0;
+
+    vtblmap<per_source_offsets>::for_each_map([&result](const vtblmap<per_source_offsets>& offset_map)
+    {
+        result += offset_map.memory_used();
+        offset_map.for_each_value([&result](const per_source_offsets& offsets) { result += offsets.memory_used(); });
+    });
+
+    return result;
+}
+#endif
+
+//------------------------------------------------------------------------------
+
+#if XTL_CAST_PROFILING
+/// Counters of memoized_cast from one source type to one target type. Each 
+/// pair used links its profile into a list on the first cast.
+/// \see #XTL_CAST_PROFILING
+class cast_profile
+{
+public:
+
+    cast_profile(const std::type_info& s, const std::type_info& t, const vtblmap<per_source_offsets>& m) noexcept
+      : source(s), target(t), offset_map(m), call_count(0), miss_count(0), failure_count(0), next_profile(head().load(std::memory_order_relaxed))
+    {
+        while (!head().compare_exchange_weak(next_profile, this, std::memory_order_release, std::memory_order_relaxed))
+            ;
+    }
+
+    const std::type_info& source; ///< Static type of the casted pointers
+    const std::type_info& target; ///< Type casted to
+
+    size_t calls()    const noexcept { return call_count   .load(std::memory_order_relaxed); }
+    size_t hits()     const noexcept { return calls() - misses(); }                          ///< Calls that found a memoized offset or its absence
+    size_t misses()   const noexcept { return miss_count   .load(std::memory_order_relaxed); } ///< Calls that had to call dynamic_cast
+    size_t failures() const noexcept { return failure_count.load(std::memory_order_relaxed); } ///< Calls that returned null, whether memoized or not
+
+    /// Number of vtbls in the offsets of the source type, which it shares with
+    /// all of its target types
+    size_t source_vtbls() const
+    {
+        size_t result = 0;
+        offset_map.for_each_value([&result](const per_source_offsets&) { ++result; });
+        return result;
+    }
+
+    /// Number of bytes in the offsets of the source type \see source_vtbls()
+    size_t source_memory_used() const
+    {
+        size_t result = offset_map.memory_used();
+        offset_map.for_each_value([&result](const per_source_offsets& offsets) { result += offsets.memory_used(); });
+        return result;
+    }
+
+    /// Counts a call that missed the memoized offsets or not, and failed or not
+    void count(bool missed, bool failed) noexcept
+    {
+        call_count.fetch_add(1, std::memory_order_relaxed);
+
+        if (XTL_UNLIKELY(missed)) miss_count   .fetch_add(1, std::memory_order_relaxed);
+        if (failed)               failure_count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    const cast_profile* next() const noexcept { return next_profile; }
+
+    /// The profile linked last or null when there were no casts yet
+    static const cast_profile* first() noexcept { return head().load(std::memory_order_acquire); }
+
+private:
+
+    /// Head of the list, zero-initialized before any dynamic initialization that may already cast
+    static std::atomic<cast_profile*>& head() noexcept
+    {
+        static std::atomic<cast_profile*> profiles;
+        return profiles;
+    }
+
+    const vtblmap<per_source_offsets>& offset_map;
+    std::atomic<size_t> call_count;
+    std::atomic<size_t> miss_count;
+    std::atomic<size_t> failure_count;
+    cast_profile*       next_profile;
+};
+
+/// Profile of casts from S to T
+template <typename S, typename T>
+inline cast_profile& cast_profile_of()
+{
+    static cast_profile profile(typeid(S), typeid(T), per_source_offset_map<S>());
+    return profile;
+}
+
+/// Calls f(const cast_profile&) for each pair of types memoized_cast has been used with so far
+template <typename F>
+void for_each_cast_profile(F f)
 {
-    // FIX: vector here might create problems later when we implement 
-    //      multi-threaded solution because of reference invalidation
-    typedef std::vector<std::ptrdiff_t> dyn_cast_info;
-    XTL_PRELOADABLE_LOCAL_STATIC(vtblmap<dyn_cast_info>,offset_map,S);
-    dyn_cast_info& sdci = offset_map.get(p);
+    for (const cast_profile* p = cast_profile::first(); p; p = p->next())
+        f(*p);
+}
+
+/// Prints a line per pair of types memoized_cast has been used with, most 
+/// called first
+inline std::ostream& dump_cast_profiles(std::ostream& os)
+{
+    std::vector<const cast_profile*> profiles;
+    for_each_cast_profile([&profiles](const cast_profile& p) { profiles.push_back(&p); });
+    std::stable_sort(profiles.begin(), profiles.end(), [](const cast_profile* a, const cast_profile* b) { return a->calls() > b->calls(); });
 
-    if (XTL_UNLIKELY(ti >= sdci.size()))
-        sdci.resize(ti+1,unknown_offset);
+    for (size_t i = 0; i < profiles.size(); ++i)
+    {
+        const cast_profile& p = *profiles[i];
+        os << p.source.name() << " -> " << p.target.name() 
+           << ": calls=" << p.calls() << " hits=" << p.hits() << " misses=" << p.misses() << " failures=" << p.failures()
+           << " (" << (p.calls() ? 100*p.failures()/p.calls() : 0) << "% failed)"
+           << " source_vtbls=" << p.source_vtbls() << " source_bytes=" << p.source_memory_used() << std::endl;
+    }
 
-    return sdci[ti];
+    return os;
 }
+#endif
 
 //------------------------------------------------------------------------------
 
@@ -162,23 +268,36 @@ inline T memoized_cast_non_null(const S* p)
     // Per source version is much more efficient in the amount of used memory
     // and size of generated executable.
     size_t ti = specific_to<source_type>::template type_index_of<target_type>();
-    std::ptrdiff_t& offset = per_source_offset_of<source_type>(p,ti);
+    per_source_offsets& offsets = per_source_offsets_of<source_type>(p);
+    const std::ptrdiff_t offset = offsets.get(ti);
 #else
     // Per target version is simpler and straightforward, but very inefficient
     // in the size of generated code.
-    std::ptrdiff_t& offset = per_target_offset_of<target_type>(p);
+    memoized_offset& memo = per_target_offset_of<target_type>(p);
+    const std::ptrdiff_t offset = memo;
 #endif
 
     if (XTL_UNLIKELY(offset == unknown_offset))
     {
-        T t = dynamic_cast<T>(p);
-        offset = t 
-                 ? reinterpret_cast<const char*>(t)-reinterpret_cast<const char*>(p) 
-                 : no_cast_exists;
+        XTL_STATIC_PROBES_ONLY(XTL_PROBE(cast_miss, mch::vtbl_of(p), ti));
+        XTL_OVERHEAD_ACCOUNTING_ONLY(mch::count_dynamic_cast());
+        T t = hooked_cast<T>(p);
+        const std::ptrdiff_t computed = t 
+                                      ? reinterpret_cast<const char*>(t)-reinterpret_cast<const char*>(p) 
+                                      : no_cast_exists;
+#if 1
+        offsets.set(ti, computed);
+#else
+        memo = computed;
+#endif
+        XTL_CAST_PROFILING_ONLY(cast_profile_of<source_type,target_type>().count(true, !t));
         return t;
     }
     else
+    {
+        XTL_CAST_PROFILING_ONLY(cast_profile_of<source_type,target_type>().count(false, offset == no_cast_exists));
         return offset == no_cast_exists ? 0 : adjust_ptr<target_type>(p, offset);
+    }
 }
 
 //------------------------------------------------------------------------------
@@ -257,3 +376,67 @@ inline T memoized_cast(S&& s)
 }
 
 //------------------------------------------------------------------------------
+
+/// Casts each pointer in [first,last) as memoized_cast<T> would and writes the
+/// results to out. The type index of the target type is looked up once for the
+/// whole range and consecutive pointers with the same vtbl-pointer reuse the
+/// offset of the first of them without probing the vtblmap again.
+/// \note Type T here is assumed to be of pointer type!
+template <typename T, typename InputIterator, typename OutputIterator>
+inline OutputIterator memoized_cast_range(InputIterator first, InputIterator last, OutputIterator out)
+{
+    typedef typename std::iterator_traits<InputIterator>::value_type                    source_ptr;
+    typedef typename mch::cast_target<T>::type                                          target_type;
+    typedef typename std::remove_cv<typename mch::cast_target<source_ptr>::type>::type source_type;
+
+    const size_t   ti        = mch::specific_to<source_type>::template type_index_of<target_type>();
+    std::intptr_t  last_vtbl = 0; // No object has a null vtbl-pointer
+    std::ptrdiff_t offset    = mch::no_cast_exists;
+    XTL_CAST_PROFILING_ONLY(mch::cast_profile& profile = mch::cast_profile_of<source_type,target_type>());
+
+    for (; first != last; ++first, ++out)
+    {
+        const source_ptr p = *first;
+
+        if (XTL_UNLIKELY(!p))
+        {
+            *out = 0;
+            continue;
+        }
+
+        const std::intptr_t vtbl = mch::vtbl_of(p);
+        XTL_CAST_PROFILING_ONLY(bool missed = false);
+
+        if (XTL_UNLIKELY(vtbl != last_vtbl))
+        {
+            mch::per_source_offsets& offsets = mch::per_source_offsets_of<source_type>(p);
+            offset = offsets.get(ti);
+
+            if (XTL_UNLIKELY(offset == mch::unknown_offset))
+            {
+                XTL_CAST_PROFILING_ONLY(missed = true);
+                const target_type* t = mch::hooked_cast<const target_type*>(p);
+                offset = t 
+                       ? reinterpret_cast<const char*>(t)-reinterpret_cast<const char*>(p) 
+                       : mch::no_cast_exists;
+                offsets.set(ti, offset);
+            }
+
+            last_vtbl = vtbl;
+        }
+
+        XTL_CAST_PROFILING_ONLY(profile.count(missed, offset == mch::no_cast_exists));
+
+        if (offset == mch::no_cast_exists)
+            *out = 0;
+        else
+        {
+            T t = mch::adjust_ptr<target_type>(p, offset);
+            *out = t;
+        }
+    }
+
+    return out;
+}
+
+//------------------------------------------------------------------------------
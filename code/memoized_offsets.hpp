@@ -0,0 +1,289 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file defines the tables of offsets that memoized_cast keeps per
+/// vtbl-pointer of the source: type indices of target types per source type
+/// and the offsets of all target types for a given vtbl. They do not depend
+/// on the vtbl map they are kept in, so type_switchN-patterns-xtl.hpp uses
+/// them to memoize user-defined casts as well.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#pragma once
+
+#include "config.hpp"
+#include "ptrtools.hpp"      // req_bits
+#include <bitset>            // Counting of castable bits
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if XTL_OVERHEAD_ACCOUNTING
+#include "overhead.hpp"      // Counters of allocations, casts and updates
+#endif
+
+#if XTL_MULTI_THREADING
+#include <atomic>            // Counters and offsets are shared between threads
+#endif
+
+//------------------------------------------------------------------------------
+// Design Notes:
+//
+// - With #XTL_MULTI_THREADING the offsets live in the lock-free vtblmap, which
+//   never moves its values, so references to them stay valid. Offsets of a
+//   given vtbl for all target types are kept in segments of doubling sizes 
+//   that are allocated once and never moved either, instead of a vector that
+//   reallocates as new target types appear. Threads racing on a missing 
+//   segment allocate it, one of them wins and the others free their copy.
+// - Offsets are atomic, but no ordering is needed: all threads computing the
+//   offset for the same vtbl and target type come up with the same value.
+// - Otherwise offsets of a given vtbl are kept in a compact form: a source type
+//   used with many target types would make every vtbl carry a slot for each 
+//   of them, while most dynamic types can only be cast to a few. Two bits per
+//   target type tell whether the outcome is known and whether the cast exists
+//   and only offsets of existing casts are stored, packed in order of type 
+//   indices. The offset of a type index is found by counting castable bits 
+//   below it, which takes a population count per word of 64 type indices.
+//------------------------------------------------------------------------------
+
+namespace mch ///< Mach7 library namespace
+{
+
+//------------------------------------------------------------------------------
+
+/// A class that keeps a run-time instantiation counter of different types. 
+/// The counter is one per each type U
+template <typename U>
+struct specific_to
+{
+    /// Returns the type index of a given type T among those instantiated in association with U
+    template <typename T>
+    static inline size_t type_index_of()
+    {
+        static const size_t ti = ++type_counter; // will be executed once upon first entry
+        return ti;
+    }
+
+private:
+
+#if XTL_MULTI_THREADING
+    static std::atomic<size_t> type_counter; ///< Actual counter of instantiated types
+#else
+    static size_t type_counter; ///< Actual counter of instantiated types
+#endif
+
+};
+
+#if XTL_MULTI_THREADING
+template <typename U> std::atomic<size_t> specific_to<U>::type_counter(0);
+#else
+template <typename U> size_t specific_to<U>::type_counter = 0;
+#endif
+
+//------------------------------------------------------------------------------
+
+template <typename T> struct cast_target;
+template <typename T> struct cast_target<      T*> { typedef T type; };
+template <typename T> struct cast_target<const T*> { typedef T type; };
+
+//------------------------------------------------------------------------------
+
+/// Appendix B of the C++ standard lists implementation quantities, among which 
+/// there is: Size of an object [262 144]. This is only a minimum guideline and 
+/// a concrete implementation might have it set larger, but it gives us some 
+/// reassurance that the following designated constants will be unlikely to 
+/// represent a valid offset within an object.
+static const std::ptrdiff_t no_cast_exists = 0x0FF1C1A1; // A dedicated constant marking impossible offset
+static const std::ptrdiff_t unknown_offset = 0x0FF1C1A0; // A dedicated constant marking an offset that hasn't been computed yet
+
+//------------------------------------------------------------------------------
+
+#if XTL_MULTI_THREADING
+/// Memoized offset of a target type, shared between threads
+typedef std::atomic<std::ptrdiff_t> memoized_offset;
+#else
+/// Memoized offset of a target type
+typedef std::ptrdiff_t memoized_offset;
+#endif
+
+//------------------------------------------------------------------------------
+
+#if XTL_MULTI_THREADING
+/// Offsets of all target types for a given vtbl indexed by type index. Segment
+/// k holds first_segment_size*2^k offsets, giving room for about 
+/// first_segment_size*2^segments target types per source type.
+class segmented_offsets
+{
+public:
+
+    static const size_t first_segment_size = 8;
+    static const size_t segments           = 16;
+
+    segmented_offsets() noexcept { for (size_t k = 0; k < segments; ++k) segment[k] = nullptr; }
+   ~segmented_offsets()          { for (size_t k = 0; k < segments; ++k) delete[] segment[k].load(); }
+
+    /// Memoized offset of target type with index ti or #unknown_offset
+    std::ptrdiff_t get(size_t ti) { return (*this)[ti].load(std::memory_order_relaxed); }
+
+    /// Memoizes offset of target type with index ti
+    void set(size_t ti, std::ptrdiff_t offset) { (*this)[ti].store(offset, std::memory_order_relaxed); }
+
+    /// Number of bytes used by the segments allocated so far, not counting the object itself
+    size_t memory_used() const
+    {
+        size_t result = 0;
+
+        for (size_t k = 0; k < segments; ++k)
+            if (segment[k].load(std::memory_order_relaxed))
+                result += (first_segment_size << k)*sizeof(memoized_offset);
+
+        return result;
+    }
+
+private:
+
+    memoized_offset& operator[](size_t ti)
+    {
+        const size_t      k = req_bits(ti/first_segment_size + 1) - 1; // floor(log2(ti/first_segment_size + 1))
+        const size_t      i = ti - first_segment_size*((size_t(1) << k) - 1);
+        memoized_offset*  s = segment[k].load(std::memory_order_acquire);
+
+        XTL_ASSERT(k < segments); // Too many target types for a single source type
+
+        if (XTL_UNLIKELY(!s))
+        {
+            const size_t n = first_segment_size << k;
+            memoized_offset* fresh = new memoized_offset[n];
+            XTL_OVERHEAD_ACCOUNTING_ONLY(mch::count_allocation(n*sizeof(memoized_offset)));
+
+            for (size_t j = 0; j < n; ++j)
+                fresh[j].store(unknown_offset, std::memory_order_relaxed);
+
+            if (segment[k].compare_exchange_strong(s, fresh, std::memory_order_acq_rel))
+                s = fresh;
+            else
+                delete[] fresh; // Another thread was first, s now points to its segment
+        }
+
+        return s[i];
+    }
+
+    std::atomic<memoized_offset*> segment[segments]; ///< Segments allocated so far
+};
+
+/// Offsets of all target types for a given vtbl
+typedef segmented_offsets per_source_offsets;
+#else
+/// Offsets of all target types for a given vtbl indexed by type index. Only 
+/// offsets of existing casts are stored \see Design Notes above.
+class sparse_offsets
+{
+public:
+
+    /// Memoized offset of target type with index ti, #no_cast_exists or #unknown_offset
+    std::ptrdiff_t get(size_t ti) const noexcept
+    {
+        const size_t        w   = ti / bits;
+        const std::uintptr_t bit = std::uintptr_t(1) << (ti % bits);
+
+        if (XTL_UNLIKELY(2*w >= masks.size() || !(masks[2*w] & bit)))
+            return unknown_offset;
+
+        return masks[2*w+1] & bit ? offsets[rank(w,bit)] : no_cast_exists;
+    }
+
+    /// Memoizes offset of target type with index ti, which was not known yet
+    void set(size_t ti, std::ptrdiff_t offset)
+    {
+        const size_t        w   = ti / bits;
+        const std::uintptr_t bit = std::uintptr_t(1) << (ti % bits);
+
+        if (XTL_UNLIKELY(2*w >= masks.size()))
+        {
+            XTL_OVERHEAD_ACCOUNTING_ONLY(const size_t capacity = masks.capacity());
+            masks.resize(2*w+2, 0);
+            XTL_OVERHEAD_ACCOUNTING_ONLY(mch::count_growth(masks, capacity));
+        }
+
+        XTL_ASSERT(!(masks[2*w] & bit)); // Outcome of each cast is memoized once
+
+        masks[2*w] |= bit;
+
+        if (offset != no_cast_exists)
+        {
+            XTL_OVERHEAD_ACCOUNTING_ONLY(const size_t capacity = offsets.capacity());
+            offsets.insert(offsets.begin() + rank(w,bit), offset);
+            XTL_OVERHEAD_ACCOUNTING_ONLY(mch::count_growth(offsets, capacity));
+            masks[2*w+1] |= bit;
+        }
+    }
+
+    /// Number of bytes used by the masks and offsets, not counting the object itself
+    size_t memory_used() const noexcept
+    {
+        return masks.capacity()*sizeof(std::uintptr_t) + offsets.capacity()*sizeof(std::ptrdiff_t);
+    }
+
+private:
+
+    static const size_t bits = XTL_BIT_SIZE(std::uintptr_t);
+
+    /// Number of castable type indices below the one given by word w and bit
+    size_t rank(size_t w, std::uintptr_t bit) const noexcept
+    {
+        size_t r = std::bitset<bits>(masks[2*w+1] & (bit-1)).count();
+
+        for (size_t i = 0; i < w; ++i)
+            r += std::bitset<bits>(masks[2*i+1]).count();
+
+        return r;
+    }
+
+    std::vector<std::uintptr_t> masks;   ///< For each word of type indices: bits of known outcomes followed by bits of existing casts
+    std::vector<std::ptrdiff_t> offsets; ///< Offsets of existing casts in order of type indices
+};
+
+/// Offsets of all target types for a given vtbl
+typedef sparse_offsets per_source_offsets;
+#endif
+
+//------------------------------------------------------------------------------
+
+} // of namespace mch
@@ -46,9 +46,16 @@
 
 #include "config.hpp"
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <tuple>
 #include <utility>
 #include <type_traits>
 
+#if XTL_MEMOIZE_MEMBERS && XTL_MULTI_THREADING && !XTL_SUPPORT(thread_local)
+#error XTL_MEMOIZE_MEMBERS with XTL_MULTI_THREADING requires compiler support of thread_local storage duration
+#endif
+
 //#include <boost/mpl/print.hpp>
 
 //------------------------------------------------------------------------------
@@ -162,7 +169,7 @@ struct preallocated
 };
 
 template <typename T, typename UID>
-T preallocated<T,UID>::value;
+XTL_DISPATCH_PLACEMENT T preallocated<T,UID>::value;
 
 //------------------------------------------------------------------------------
 
@@ -176,6 +183,13 @@ template <typename R, typename A1> constexpr R (    * unary(R (    *f)(A1)
 template <typename R, typename A1> constexpr R (A1::* unary(R  A1::*f           ) noexcept)         { return f; }
 template <typename R, typename A1> constexpr R (A1::* unary(R (A1::*f)(  )      ) noexcept)()       { return f; }
 template <typename R, typename A1> constexpr R (A1::* unary(R (A1::*f)(  ) const) noexcept)() const { return f; }
+#if XTL_SUPPORT(noexcept_function_type)
+/// Overloads that keep noexcept, which is a part of function types since C++17
+/// and lets #is_nothrow_member tell accessors that cannot throw.
+template <typename R, typename A1> constexpr R (    * unary(R (    *f)(A1)       noexcept) noexcept)(A1)       noexcept { return f; }
+template <typename R, typename A1> constexpr R (A1::* unary(R (A1::*f)(  )       noexcept) noexcept)()         noexcept { return f; }
+template <typename R, typename A1> constexpr R (A1::* unary(R (A1::*f)(  ) const noexcept) noexcept)() const   noexcept { return f; }
+#endif
 
 //------------------------------------------------------------------------------
 
@@ -183,35 +197,149 @@ template <typename R, typename A1> constexpr R (A1::* unary(R (A1::*f)(  ) const
 
 //------------------------------------------------------------------------------
 
+#if XTL_MEMOIZE_MEMBERS
+
+/// State of memoization of members shared by all Match statements of a thread.
+/// Memoized values are tagged with the epoch in which they were computed and
+/// each Match statement starts a new one, so values never outlive it.
+/// \see #XTL_MEMOIZE_MEMBERS
+struct member_memo_state
+{
+    size_t epoch; ///< Current epoch, incremented by each Match statement
+    size_t depth; ///< Number of Match statements being evaluated
+
+    static member_memo_state& get() noexcept
+    {
+    #if XTL_MULTI_THREADING
+        static thread_local member_memo_state state = {0, 0};
+    #else
+        static member_memo_state state = {0, 0};
+    #endif
+        return state;
+    }
+};
+
+/// Scope guard declared by Match statements to let accessors they call be
+/// memoized while they are being evaluated.
+struct member_memo_scope
+{
+    member_memo_scope() noexcept { member_memo_state& s = member_memo_state::get(); ++s.epoch; ++s.depth; }
+   ~member_memo_scope() noexcept { member_memo_state& s = member_memo_state::get(); ++s.epoch; --s.depth; }
+};
+
+/// Members returning values of scalar types are memoized by value
+template <typename R>
+struct member_memo_traits
+{
+    enum { memoizable = std::is_scalar<R>::value };
+    typedef typename std::remove_cv<R>::type storage_type;
+    static storage_type store(R r) noexcept { return r; }
+    static R            load(storage_type r) noexcept { return r; }
+};
+
+/// Members returning references are memoized by address of the result
+template <typename R>
+struct member_memo_traits<R&>
+{
+    enum { memoizable = 1 };
+    typedef R* storage_type;
+    static storage_type store(R& r) noexcept { return &r; }
+    static R&           load(storage_type r) noexcept { return *r; }
+};
+
+/// Values of member m applied to objects of type C.
+/// A few entries replaced in round-robin order suffice since a Match 
+/// statement typically decomposes only a handful of objects at a time.
+template <typename C, typename M, typename R>
+struct member_memo
+{
+    static const size_t size = 4; ///< Number of entries in the table
+
+    struct entry
+    {
+        size_t      epoch;
+        const void* object;
+        M           member;
+        typename member_memo_traits<R>::storage_type value;
+    };
+
+    template <typename F>
+    static R get(const void* c, M m, const F& f)
+    {
+    #if XTL_MULTI_THREADING
+        static thread_local entry  table[size];
+        static thread_local size_t next;
+    #else
+        static entry  table[size];
+        static size_t next;
+    #endif
+        const size_t epoch = member_memo_state::get().epoch;
+
+        for (size_t i = 0; i < size; ++i)
+            if (table[i].epoch == epoch && table[i].object == c && table[i].member == m)
+                return member_memo_traits<R>::load(table[i].value);
+
+        R r = f();
+        entry& e = table[next++ % size];
+        e.epoch  = epoch;
+        e.object = c;
+        e.member = m;
+        e.value  = member_memo_traits<R>::store(r);
+        return member_memo_traits<R>::load(e.value);
+    }
+};
+
+/// Calls f to compute member m of c unless its value has already been 
+/// computed during the Match statement being evaluated.
+template <typename R, typename C, typename M, typename F>
+inline R memoized_member(const C* c, M m, const F& f, std::true_type)
+{
+    return member_memo_state::get().depth ? member_memo<C,M,R>::get(c, m, f) : f();
+}
+
+/// Results of other types are computed each time
+template <typename R, typename C, typename M, typename F>
+inline R memoized_member(const C*, M, const F& f, std::false_type) { return f(); }
+
+#define XTL_APPLY_MEMBER(R, c, m, ...) return memoized_member<R>(c, m, [&]() -> R { return __VA_ARGS__; }, std::integral_constant<bool, member_memo_traits<R>::memoizable>())
+
+#else
+
+#define XTL_APPLY_MEMBER(R, c, m, ...) return __VA_ARGS__
+
+#endif
+
+//------------------------------------------------------------------------------
+
 template <class C, class T, typename R>
-inline R apply_member(const C* c, R (T::*method)() const) noexcept_when(noexcept_of((c->*method)()))
+XTL_CONSTEXPR14 R apply_member(const C* c, R (T::*method)() const) noexcept_when(noexcept_of((c->*method)()))
 {
     XTL_DEBUG_APPLY_MEMBER("const member function to const instance ", c, method);
-    return (c->*method)();
+    XTL_APPLY_MEMBER(R, c, method, (c->*method)());
 }
 
 //------------------------------------------------------------------------------
 
 template <class C, class T, typename R>
-inline R apply_member(      C* c, R (T::*method)() const) noexcept_when(noexcept_of((c->*method)()))
+XTL_CONSTEXPR14 R apply_member(      C* c, R (T::*method)() const) noexcept_when(noexcept_of((c->*method)()))
 {
     XTL_DEBUG_APPLY_MEMBER("const member function to non-const instance ", c, method);
-    return (c->*method)();
+    XTL_APPLY_MEMBER(R, c, method, (c->*method)());
 }
 
 //------------------------------------------------------------------------------
 
 template <class C, class T, typename R>
-inline R apply_member(      C* c, R (T::*method)()      ) noexcept_when(noexcept_of((c->*method)()))
+XTL_CONSTEXPR14 R apply_member(      C* c, R (T::*method)()      ) noexcept_when(noexcept_of((c->*method)()))
 {
     XTL_DEBUG_APPLY_MEMBER("non-const member function to non-const instance ", c, method);
-    return (c->*method)();
+    XTL_APPLY_MEMBER(R, c, method, (c->*method)());
 }
 
 //------------------------------------------------------------------------------
 
 template <class C, class T, typename R>
-inline const R& apply_member(const C* c, R T::*field) noexcept
+XTL_CONSTEXPR14 const R& apply_member(const C* c, R T::*field) noexcept
 {
     XTL_DEBUG_APPLY_MEMBER("data member to const instance ", c, field);
     return c->*field;
@@ -220,7 +348,7 @@ inline const R& apply_member(const C* c, R T::*field) noexcept
 //------------------------------------------------------------------------------
 
 template <class C, class T, typename R>
-inline       R& apply_member(      C* c, R T::*field) noexcept
+XTL_CONSTEXPR14       R& apply_member(      C* c, R T::*field) noexcept
 {
     XTL_DEBUG_APPLY_MEMBER("data member to non-const instance ", c, field);
     return c->*field;
@@ -229,55 +357,352 @@ inline       R& apply_member(      C* c, R T::*field) noexcept
 //------------------------------------------------------------------------------
 
 template <class C, class T, typename R>
-inline R apply_member(const C* c, R (*func)(const T*)) noexcept_when(noexcept_of((*func)(c)))
+XTL_CONSTEXPR14 R apply_member(const C* c, R (*func)(const T*)) noexcept_when(noexcept_of((*func)(c)))
 {
     XTL_DEBUG_APPLY_MEMBER("external function taking const pointer to const instance ", c, func);
-    return (*func)(c);
+    XTL_APPLY_MEMBER(R, c, func, (*func)(c));
 }
 
 //------------------------------------------------------------------------------
 
 template <class C, class T, typename R>
-inline R apply_member(      C* c, R (*func)(const T*)) noexcept_when(noexcept_of((*func)(c)))
+XTL_CONSTEXPR14 R apply_member(      C* c, R (*func)(const T*)) noexcept_when(noexcept_of((*func)(c)))
 {
     XTL_DEBUG_APPLY_MEMBER("external function taking const pointer to non-const instance ", c, func);
-    return (*func)(c);
+    XTL_APPLY_MEMBER(R, c, func, (*func)(c));
 }
 
 //------------------------------------------------------------------------------
 
 template <class C, class T, typename R>
-inline R apply_member(      C* c, R (*func)(      T*)) noexcept_when(noexcept_of((*func)(c)))
+XTL_CONSTEXPR14 R apply_member(      C* c, R (*func)(      T*)) noexcept_when(noexcept_of((*func)(c)))
 {
     XTL_DEBUG_APPLY_MEMBER("external function taking non-const pointer to non-const instance ", c, func);
-    return (*func)(c);
+    XTL_APPLY_MEMBER(R, c, func, (*func)(c));
 }
 
 //------------------------------------------------------------------------------
 
 template <class C, class T, typename R>
-inline R apply_member(const C* c, R (*func)(const T&)) noexcept_when(noexcept_of((*func)(*c)))
+XTL_CONSTEXPR14 R apply_member(const C* c, R (*func)(const T&)) noexcept_when(noexcept_of((*func)(*c)))
 {
     XTL_DEBUG_APPLY_MEMBER("external function taking const reference to const instance ", c, func);
-    return (*func)(*c);
+    XTL_APPLY_MEMBER(R, c, func, (*func)(*c));
 }
 
 //------------------------------------------------------------------------------
 
 template <class C, class T, typename R>
-inline R apply_member(      C* c, R (*func)(const T&)) noexcept_when(noexcept_of((*func)(*c)))
+XTL_CONSTEXPR14 R apply_member(      C* c, R (*func)(const T&)) noexcept_when(noexcept_of((*func)(*c)))
 {
     XTL_DEBUG_APPLY_MEMBER("external function taking const reference to non-const instance ", c, func);
-    return (*func)(*c);
+    XTL_APPLY_MEMBER(R, c, func, (*func)(*c));
 }
 
 //------------------------------------------------------------------------------
 
 template <class C, class T, typename R>
-inline R apply_member(      C* c, R (*func)(      T&)) noexcept_when(noexcept_of((*func)(*c)))
+XTL_CONSTEXPR14 R apply_member(      C* c, R (*func)(      T&)) noexcept_when(noexcept_of((*func)(*c)))
 {
     XTL_DEBUG_APPLY_MEMBER("external function taking non-const reference to non-const instance ", c, func);
-    return (*func)(*c);
+    XTL_APPLY_MEMBER(R, c, func, (*func)(*c));
+}
+
+//------------------------------------------------------------------------------
+
+/// Accessor of a data member of type R located at a compile-time byte Offset
+/// within objects of a standard-layout class T, \see #CMO. Unlike pointers to 
+/// members and functions, the accessor carries no run-time value, so applying
+/// it is always a direct load from the object, even when the optimizer does
+/// not fold the accessor passed to generic pattern code.
+template <class T, typename R, size_t Offset>
+struct member_at
+{
+    static_assert(std::is_standard_layout<T>::value, "Offset-based bindings require a standard-layout class");
+};
+
+//------------------------------------------------------------------------------
+
+template <class C, class T, typename R, size_t Offset>
+inline const R& apply_member(const C* c, member_at<T,R,Offset>) noexcept
+{
+    XTL_DEBUG_APPLY_MEMBER("data member at offset to const instance ", c, Offset);
+    return *reinterpret_cast<const R*>(reinterpret_cast<const char*>(static_cast<const T*>(c)) + Offset);
+}
+
+//------------------------------------------------------------------------------
+
+template <class C, class T, typename R, size_t Offset>
+inline       R& apply_member(      C* c, member_at<T,R,Offset>) noexcept
+{
+    XTL_DEBUG_APPLY_MEMBER("data member at offset to non-const instance ", c, Offset);
+    return *reinterpret_cast<R*>(reinterpret_cast<char*>(static_cast<T*>(c)) + Offset);
+}
+
+//------------------------------------------------------------------------------
+
+/// Namespace in which get<I> of tuple-like types is looked up both in std and
+/// by argument-dependent lookup, which explicit template arguments otherwise
+/// disable before C++20.
+namespace tuple_like
+{
+    using std::get;
+
+    template <size_t I, class T>
+    XTL_CONSTEXPR14 auto element(T& t) noexcept_when(noexcept_of(get<I>(t))) -> decltype(get<I>(t)) { return get<I>(t); }
+}
+
+/// Accessor of the I-th element of an object of tuple-like type T, i.e. of a
+/// type whose elements are taken with get<I>, \see mch::tuple_bindings. Like
+/// member_at, the accessor carries no run-time value, so applying it inlines
+/// into a reference to the element.
+template <class T, size_t I>
+struct element_at {};
+
+//------------------------------------------------------------------------------
+
+template <class C, class T, size_t I>
+XTL_CONSTEXPR14 auto apply_member(const C* c, element_at<T,I>) noexcept_when(noexcept_of(tuple_like::element<I>(*static_cast<const T*>(c))))
+    -> decltype(tuple_like::element<I>(*static_cast<const T*>(c)))
+{
+    XTL_DEBUG_APPLY_MEMBER("element of tuple-like const instance ", c, I);
+    return tuple_like::element<I>(*static_cast<const T*>(c));
+}
+
+//------------------------------------------------------------------------------
+
+template <class C, class T, size_t I>
+XTL_CONSTEXPR14 auto apply_member(      C* c, element_at<T,I>) noexcept_when(noexcept_of(tuple_like::element<I>(*static_cast<T*>(c))))
+    -> decltype(tuple_like::element<I>(*static_cast<T*>(c)))
+{
+    XTL_DEBUG_APPLY_MEMBER("element of tuple-like non-const instance ", c, I);
+    return tuple_like::element<I>(*static_cast<T*>(c));
+}
+
+#if XTL_SUPPORT(structured_bindings)
+//------------------------------------------------------------------------------
+
+/// Accessor of the I-th of the Arity data members of an aggregate T, taken
+/// with a structured binding declaration, \see mch::aggregate_bindings. Like
+/// member_at, it carries no run-time value and inlines into a reference to 
+/// the data member.
+template <class T, size_t I, size_t Arity>
+struct field_at {};
+
+#define XTL_FIELD_NAME(I,...) XTL_CONCAT(f,I)
+#define XTL_AGGREGATE_FIELD(N)                                                  \
+    template <size_t I, class T>                                                \
+    inline auto& aggregate_field(T& t, std::integral_constant<size_t,N>) noexcept \
+    {                                                                           \
+        auto& [XTL_ENUM(N,XTL_FIELD_NAME,dummy)] = t;                           \
+        return std::get<I>(std::tie(XTL_ENUM(N,XTL_FIELD_NAME,dummy)));         \
+    }
+XTL_AGGREGATE_FIELD(1) XTL_AGGREGATE_FIELD(2) XTL_AGGREGATE_FIELD(3)
+XTL_AGGREGATE_FIELD(4) XTL_AGGREGATE_FIELD(5) XTL_AGGREGATE_FIELD(6)
+XTL_AGGREGATE_FIELD(7) XTL_AGGREGATE_FIELD(8) XTL_AGGREGATE_FIELD(9)
+#undef  XTL_AGGREGATE_FIELD
+#undef  XTL_FIELD_NAME
+
+//------------------------------------------------------------------------------
+
+template <class C, class T, size_t I, size_t Arity>
+inline const auto& apply_member(const C* c, field_at<T,I,Arity>) noexcept
+{
+    XTL_DEBUG_APPLY_MEMBER("data member of aggregate const instance ", c, I);
+    return aggregate_field<I>(*static_cast<const T*>(c), std::integral_constant<size_t,Arity>());
+}
+
+//------------------------------------------------------------------------------
+
+template <class C, class T, size_t I, size_t Arity>
+inline       auto& apply_member(      C* c, field_at<T,I,Arity>) noexcept
+{
+    XTL_DEBUG_APPLY_MEMBER("data member of aggregate non-const instance ", c, I);
+    return aggregate_field<I>(*static_cast<T*>(c), std::integral_constant<size_t,Arity>());
+}
+
+//------------------------------------------------------------------------------
+
+/// Argument of brace initialization converting to the type of any data member
+struct any_field { template <typename U> operator U() const; };
+
+/// Whether aggregate T can be initialized from sizeof...(I) braced values
+template <class T, class Indices, class = void>
+struct initializable_from : std::false_type {};
+
+template <class T, size_t... I>
+struct initializable_from<T, std::index_sequence<I...>, std::void_t<decltype(T{(void(I), any_field())...})>> : std::true_type {};
+
+/// Number of data members of aggregate T, i.e. the largest number of values,
+/// up to 9, it can be brace-initialized from. 
+/// \note Data members that are arrays or aggregates themselves take elements
+///       by brace elision, so the number may be larger for those.
+template <class T, size_t N = 9>
+struct aggregate_arity : std::conditional<initializable_from<T, std::make_index_sequence<N>>::value, 
+                                          std::integral_constant<size_t,N>, 
+                                          aggregate_arity<T,N-1>>::type {};
+
+template <class T>
+struct aggregate_arity<T,0> : std::integral_constant<size_t,0> {};
+#endif
+
+//------------------------------------------------------------------------------
+
+/// Whether applying accessor M of a member described in #bindings to an object
+/// of type U cannot throw. Data members never throw, while functions are only 
+/// known not to throw when noexcept is a part of their type.
+template <typename U, typename M>
+struct is_nothrow_member : std::integral_constant<bool, noexcept_of(apply_member(std::declval<U*>(), std::declval<M>()))> {};
+
+#if XTL_SUPPORT(noexcept_function_type)
+template <typename U, typename R, typename T> struct is_nothrow_member<U, R (T::*)() const noexcept> : std::true_type {};
+template <typename U, typename R, typename T> struct is_nothrow_member<U, R (T::*)()       noexcept> : std::true_type {};
+template <typename U, typename R, typename A> struct is_nothrow_member<U, R (*)(A)         noexcept> : std::true_type {};
+#endif
+
+//------------------------------------------------------------------------------
+
+/// Bits of a word that keeps a type tag next to its payload: an integral value,
+/// a pointer or the bit pattern of a double.
+template <typename R>
+inline auto word_of(const R& r) noexcept -> typename std::enable_if<std::is_integral<R>::value || std::is_enum<R>::value, std::uintmax_t>::type { return std::uintmax_t(r); }
+template <typename R>
+inline std::uintmax_t word_of(const R* r) noexcept { return reinterpret_cast<std::uintptr_t>(r); }
+inline std::uintmax_t word_of(const double& r) noexcept { std::uint64_t w; std::memcpy(&w, &r, sizeof(w)); return w; }
+
+//------------------------------------------------------------------------------
+
+/// Accessor of a tag kept in the bits selected by Mask of a data member of 
+/// type R located at a compile-time byte Offset within objects of a 
+/// standard-layout class T, \see #KSM. The tag is the selected bits shifted 
+/// down to bit 0, e.g. the lowest bits of an aligned pointer of an interpreter
+/// value. Applying it is a load, an and and a shift.
+template <class T, typename R, size_t Offset, std::uintmax_t Mask>
+struct masked_member_at
+{
+    static_assert(std::is_standard_layout<T>::value, "Offset-based bindings require a standard-layout class");
+    static_assert(Mask != 0, "Mask of a tag has to select some bits");
+
+    /// Position of the lowest bit of the tag
+    static constexpr unsigned shift(std::uintmax_t m = Mask) noexcept { return m & 1 ? 0 : 1 + shift(m >> 1); }
+};
+
+//------------------------------------------------------------------------------
+
+template <class C, class T, typename R, size_t Offset, std::uintmax_t Mask>
+inline std::size_t apply_member(const C* c, masked_member_at<T,R,Offset,Mask>) noexcept
+{
+    XTL_DEBUG_APPLY_MEMBER("masked data member at offset to const instance ", c, Offset);
+    const std::uintmax_t w = word_of(*reinterpret_cast<const R*>(reinterpret_cast<const char*>(static_cast<const T*>(c)) + Offset));
+    return std::size_t((w & Mask) >> masked_member_at<T,R,Offset,Mask>::shift());
+}
+
+//------------------------------------------------------------------------------
+
+/// Accessor of a tag of a NaN-boxed data member of type R (a double or a 
+/// 64-bit integer) located at a compile-time byte Offset within objects of a 
+/// standard-layout class T, \see #KSN. Boxes are negative quiet NaNs that 
+/// carry a non-zero tag in the bits selected by TagMask. Any other bit pattern,
+/// including the NaNs produced by arithmetic, is a double and has tag 0.
+template <class T, typename R, size_t Offset, std::uint64_t TagMask>
+struct nan_boxed_member_at
+{
+    /// Sign, exponent and quiet bits, which are all set in every box
+    static const std::uint64_t prefix = 0xFFF8000000000000ULL;
+
+    static_assert(std::is_standard_layout<T>::value, "Offset-based bindings require a standard-layout class");
+    static_assert(sizeof(R) == sizeof(std::uint64_t), "NaN-boxed member has to be 64 bits wide");
+    static_assert(TagMask != 0 && (TagMask & prefix) == 0, "Tag of a NaN-box has to be inside its payload bits");
+
+    /// Position of the lowest bit of the tag
+    static constexpr unsigned shift(std::uint64_t m = TagMask) noexcept { return m & 1 ? 0 : 1 + shift(m >> 1); }
+};
+
+//------------------------------------------------------------------------------
+
+template <class C, class T, typename R, size_t Offset, std::uint64_t TagMask>
+inline std::size_t apply_member(const C* c, nan_boxed_member_at<T,R,Offset,TagMask>) noexcept
+{
+    typedef nan_boxed_member_at<T,R,Offset,TagMask> accessor;
+    XTL_DEBUG_APPLY_MEMBER("NaN-boxed data member at offset to const instance ", c, Offset);
+    const std::uint64_t w = std::uint64_t(word_of(*reinterpret_cast<const R*>(reinterpret_cast<const char*>(static_cast<const T*>(c)) + Offset)));
+    // Branch-free: the tag is masked out unless all the bits of the prefix are set
+    return std::size_t(((w & TagMask) >> accessor::shift()) & (std::uint64_t(0) - std::uint64_t((w & accessor::prefix) == accessor::prefix)));
+}
+
+//------------------------------------------------------------------------------
+
+/// Accessor of a field of a trivially copyable type R serialized at a 
+/// compile-time byte Offset of the buffer viewed by objects of class T, 
+/// \see #CMB. T is a view of a received message with members data() and 
+/// size(), which is never deserialized: the field is copied out of the buffer
+/// when a pattern reads it. The buffer does not have to be aligned. Bounds 
+/// are not checked: the view is expected to be verified once, when it is made
+/// of the received bytes, instead of in every clause reading a field.
+template <class T, typename R, size_t Offset>
+struct buffer_field_at
+{
+    static_assert(std::is_trivially_copyable<R>::value, "Fields of a buffer have to be of trivially copyable types");
+};
+
+/// Accessor of a field of type R serialized at the byte offset that is kept 
+/// as a 32-bit unsigned integer at byte Slot of the buffer viewed by objects 
+/// of class T, \see #CMBI. This is how tables of FlatBuffers-like formats 
+/// address fields whose position depends on the message.
+template <class T, typename R, size_t Slot>
+struct buffer_indirect_field_at
+{
+    static_assert(std::is_trivially_copyable<R>::value, "Fields of a buffer have to be of trivially copyable types");
+};
+
+/// Accessor of the tag of a union serialized as integral type R at byte 
+/// Offset of the buffer viewed by objects of class T, \see #KSB. Buffers too
+/// short to hold the tag have tag 0, which such formats reserve for no value.
+/// This is the only bounds check on the buffer in a Match statement.
+template <class T, typename R, size_t Offset>
+struct buffer_kind_at
+{
+    static_assert(std::is_integral<R>::value || std::is_enum<R>::value, "Tag of a union in a buffer has to be integral");
+};
+
+/// Bytes of the buffer viewed by v
+template <class T>
+inline const char* buffer_of(const T& v) noexcept { return reinterpret_cast<const char*>(v.data()); }
+
+//------------------------------------------------------------------------------
+
+template <class C, class T, typename R, size_t Offset>
+inline R apply_member(const C* c, buffer_field_at<T,R,Offset>) noexcept
+{
+    XTL_DEBUG_APPLY_MEMBER("field at offset of buffer ", c, Offset);
+    R r;
+    std::memcpy(&r, buffer_of(*static_cast<const T*>(c)) + Offset, sizeof(R));
+    return r;
+}
+
+template <class C, class T, typename R, size_t Slot>
+inline R apply_member(const C* c, buffer_indirect_field_at<T,R,Slot>) noexcept
+{
+    XTL_DEBUG_APPLY_MEMBER("field at indirect offset of buffer ", c, Slot);
+    const char*   b = buffer_of(*static_cast<const T*>(c));
+    std::uint32_t o;
+    R             r;
+    std::memcpy(&o, b + Slot, sizeof(o));
+    std::memcpy(&r, b + o, sizeof(R));
+    return r;
+}
+
+template <class C, class T, typename R, size_t Offset>
+inline std::size_t apply_member(const C* c, buffer_kind_at<T,R,Offset>) noexcept
+{
+    XTL_DEBUG_APPLY_MEMBER("tag at offset of buffer ", c, Offset);
+    const T& v = *static_cast<const T*>(c);
+    R r = R();
+
+    if (XTL_LIKELY(v.size() >= Offset + sizeof(R)))
+        std::memcpy(&r, buffer_of(v) + Offset, sizeof(R));
+
+    return std::size_t(r);
 }
 
 //------------------------------------------------------------------------------
@@ -286,7 +711,7 @@ inline R apply_member(      C* c, R (*func)(      T&)) noexcept_when(noexcept_of
 /// match a meta variable _ of type wildcard, that matches everything of
 /// any type. In this case we don't even want to invoke the underlain member!
 template <typename E, typename C, typename M>
-inline bool apply_expression(const E& e, const C* c, M m) noexcept_when(noexcept_of(e(apply_member(c, m))))
+XTL_CONSTEXPR14 bool apply_expression(const E& e, const C* c, M m) noexcept_when(noexcept_of(e(apply_member(c, m))))
 {
     #ifdef _MSC_VER
     #pragma warning( disable : 4800 )
@@ -296,7 +721,7 @@ inline bool apply_expression(const E& e, const C* c, M m) noexcept_when(noexcept
 }
 
 template <typename E, typename C, typename M>
-inline bool apply_expression(const E& e,       C* c, M m) noexcept_when(noexcept_of(e(apply_member(c, m))))
+XTL_CONSTEXPR14 bool apply_expression(const E& e,       C* c, M m) noexcept_when(noexcept_of(e(apply_member(c, m))))
 {
     #ifdef _MSC_VER
     #pragma warning( disable : 4800 )
@@ -0,0 +1,313 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library.
+///
+/// Open multi-methods: a method is declared once on references to polymorphic
+/// base classes and its overriders for derived classes can be defined in any
+/// translation unit, e.g. by modules the declaring one does not know about:
+/// \code
+///     mch::open_method<double(const Shape&, const Shape&)>& intersect()
+///     {
+///         static mch::open_method<double(const Shape&, const Shape&)> method;
+///         return method;
+///     }
+///
+///     // In any other translation unit:
+///     double intersect_cs(const Circle&, const Square&);
+///     static bool registered = intersect().define(&intersect_cs);
+///
+///     double d = intersect()(shape1, shape2);
+/// \endcode
+/// Declaring the method as a local static avoids depending on the order in 
+/// which static initializers of different translation units run. A call is 
+/// dispatched to the most specific overrider accepting the dynamic types of 
+/// all the arguments, that is the one whose parameter types are derived from
+/// (or the same as) the respective parameter types of any other accepting 
+/// overrider. Calls without a unique most specific overrider return the 
+/// value-initialized result, just like mch::match without accepting clauses.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+/// \see Peter Pirkelbauer, Yuriy Solodkyy, Bjarne Stroustrup. "Open Multi-Methods for C++"
+///
+
+#pragma once
+
+// --------------------[ Design Notes ]--------------------
+// - Dispatch is a lookup of the vtbl pointers of all the arguments in a 
+//   vtbl_map<N>, whose entry holds the selected overrider together with the
+//   offsets of its parameter subobjects in the arguments, precomputed on the
+//   first call with that combination of dynamic types. A hit thus costs the
+//   same as a hit of #Match on N subjects followed by an indirect call.
+// - The overrider is stored as a generic function pointer next to a thunk 
+//   instantiated for its parameter types, which casts it back to its actual 
+//   type and adjusts the arguments by the stored offsets. No dynamic_cast 
+//   happens on a hit.
+// - Relation between parameter types of overriders is established on a miss
+//   by throwing a pointer to one of them and catching it as a pointer to the 
+//   other, which is the only portable way to test derivation between types 
+//   known only to separately instantiated functions.
+// - Defining an overrider after calls discards everything the map learned, 
+//   since the new overrider may be more specific for combinations seen. 
+//   Overriders are normally defined during static initialization, before any
+//   call.
+//------------------------------------------------------------------------------
+
+#include "match_function.hpp" // clause_indices, vtbl_map and its default policy
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace mch ///< Mach7 library namespace
+{
+
+//------------------------------------------------------------------------------
+
+/// Open multi-method with signature Signature \see open_method.hpp
+template <typename Signature> class open_method;
+
+//------------------------------------------------------------------------------
+
+/// Throws a pointer to D, letting a handler tell whether D derives from its type
+template <typename D>
+void throw_ptr_to()
+{
+    throw static_cast<const volatile D*>(nullptr);
+}
+
+/// Whether pointer thrown by thrower converts to pointer to B, i.e. whether 
+/// it points to B or to a class unambiguously and publicly derived from B.
+template <typename B>
+bool catches_ptr_to(void (*thrower)())
+{
+    try { thrower(); } 
+    catch (const volatile B*) { return true; } 
+    catch (...) {}
+    return false;
+}
+
+//------------------------------------------------------------------------------
+
+/// Open multi-method taking references to polymorphic classes B... and 
+/// returning R.
+template <typename R, typename... B>
+class open_method<R(B&...)>
+{
+private:
+
+    /// Whether parameter of type D& of an overrider can override parameter of
+    /// type S& of the method
+    template <typename S, typename D>
+    struct overrides : std::integral_constant<bool, 
+        std::is_base_of<typename std::remove_cv<S>::type, typename std::remove_cv<D>::type>::value && 
+        (std::is_const<D>::value || !std::is_const<S>::value)> {};
+
+    /// Tuple of boolean values, two of which are the same only when all are true
+    template <bool... V> struct bool_pack {};
+
+public:
+
+    static_assert(sizeof...(B) > 0, "Open multi-method needs at least one argument");
+    static_assert(count_types_if<std::is_polymorphic,B...>::value == sizeof...(B), "Parameters of an open multi-method have to be references to polymorphic classes");
+
+    /// Number of arguments of the method
+    static const size_t arity = sizeof...(B);
+
+    open_method() : count(0) {}
+
+    /// Defines overrider f of the method for dynamic types D... of the arguments.
+    /// An overrider defined again for the same types replaces the earlier one.
+    /// Returns true, so that the result can initialize a static variable.
+    template <typename... D>
+    bool define(R (*f)(D&...))
+    {
+        static_assert(sizeof...(D) == arity, "Overrider has to take as many arguments as the method");
+        static_assert(std::is_same<bool_pack<true,overrides<B,D>::value...>,bool_pack<overrides<B,D>::value...,true>>::value, "Parameters of an overrider have to be references to classes derived from those of the method");
+
+        overrider o = {
+            reinterpret_cast<generic_function>(f),
+            &call_overrider<D...>,
+            { &throw_ptr_to<typename std::remove_cv<D>::type>... },
+            { &catches_ptr_to<typename std::remove_cv<D>::type>... },
+            { &offset_of<B,D>... }
+        };
+        overriders.push_back(o);
+        count = vtbl_count_t(overriders.size());
+        map.reset(); // Combinations seen may have a more specific overrider now
+        return true;
+    }
+
+    /// Calls the most specific overrider for the dynamic types of the arguments
+    R operator()(B&... args)
+    {
+        if (XTL_UNLIKELY(!map))
+            map.reset(new map_type(count));
+
+        target& t = map->get(addr(args)...);
+
+        if (XTL_UNLIKELY(!t.thunk))
+            resolve(t, args...);
+
+        return t.thunk(t.function, t.offset, args...);
+    }
+
+    /// Number of overriders defined
+    size_t size() const { return overriders.size(); }
+
+private:
+
+    open_method(const open_method&);            ///< No copy constructor
+    open_method& operator=(const open_method&); ///< No assignment operator
+
+    /// Any function pointer converts to it and back to its original type
+    typedef void (*generic_function)();
+
+    /// Calls overrider with the arguments adjusted by the offsets
+    typedef R (*thunk_type)(generic_function, const std::ptrdiff_t*, B&...);
+
+    /// Value of the vtbl map: the selected overrider and its adjustments
+    struct target
+    {
+        target() : function(), thunk(), offset() {}
+        generic_function function;      ///< Overrider cast to generic function
+        thunk_type       thunk;         ///< Thunk calling it, 0 when not yet resolved
+        std::ptrdiff_t   offset[arity]; ///< Offset of each parameter subobject in the argument
+    };
+
+    /// Overrider together with what is needed to select and call it
+    struct overrider
+    {
+        generic_function function;                              ///< Overrider cast to generic function
+        thunk_type       thunk;                                 ///< Thunk calling it
+        void (*thrower[arity])();                               ///< Throws pointer to the type of each parameter
+        bool (*catcher[arity])(void (*)());                     ///< Catches pointer to the type of each parameter
+        bool (*accepts[arity])(const void*, std::ptrdiff_t&);   ///< Offset of each parameter in an argument if it is one
+
+        /// Whether types of all parameters are derived from or the same as those of o
+        bool refines(const overrider& o) const
+        {
+            for (size_t i = 0; i < arity; ++i)
+                if (!o.catcher[i](thrower[i]))
+                    return false;
+
+            return true;
+        }
+
+        /// Whether arguments are of types of the parameters
+        bool applies_to(const void* const* arg, std::ptrdiff_t* offset) const
+        {
+            for (size_t i = 0; i < arity; ++i)
+                if (!accepts[i](arg[i], offset[i]))
+                    return false;
+
+            return true;
+        }
+    };
+
+    typedef vtbl_map<sizeof...(B),target,XTL_VTBL_MAP_POLICY> map_type;
+
+    /// Offset of the D subobject in argument of static type S, if it is a D
+    template <typename S, typename D>
+    static bool offset_of(const void* arg, std::ptrdiff_t& offset)
+    {
+        const S* s = static_cast<const S*>(arg);
+
+        if (const D* d = dynamic_cast<const D*>(s))
+        {
+            offset = intptr_t(d)-intptr_t(s);
+            return true;
+        }
+
+        return false;
+    }
+
+    /// Thunk instantiated for overrider with parameter types D...
+    template <typename... D>
+    static R call_overrider(generic_function f, const std::ptrdiff_t* offset, B&... args)
+    {
+        return call_adjusted<D...>(f, offset, typename make_clause_indices<arity>::type(), args...);
+    }
+
+    template <typename... D, size_t... I>
+    static R call_adjusted(generic_function f, const std::ptrdiff_t* offset, clause_indices<I...>, B&... args)
+    {
+        return reinterpret_cast<R (*)(D&...)>(f)(*adjust_ptr_if_polymorphic<typename std::remove_cv<D>::type>(addr(args), offset[I])...);
+    }
+
+    /// Thunk of combinations without a unique most specific overrider
+    static R call_none(generic_function, const std::ptrdiff_t*, B&...)
+    {
+        return R();
+    }
+
+    /// Selects the most specific overrider applicable to the arguments
+    void resolve(target& t, B&... args) const
+    {
+        const void*    arg[arity] = { addr(args)... };
+        std::ptrdiff_t offset[arity];
+        const overrider* best = nullptr;
+
+        // Candidate is the last applicable overrider refining all applicable
+        // overriders before it ...
+        for (size_t j = 0; j < overriders.size(); ++j)
+            if (overriders[j].applies_to(arg, offset) && (!best || overriders[j].refines(*best)))
+                best = &overriders[j];
+
+        // ... but it is the most specific only if it refines all the others
+        for (size_t j = 0; best && j < overriders.size(); ++j)
+            if (overriders[j].applies_to(arg, offset) && !best->refines(overriders[j]))
+                best = nullptr;
+
+        if (best && best->applies_to(arg, t.offset))
+        {
+            t.function = best->function;
+            t.thunk    = best->thunk;
+        }
+        else
+            t.thunk    = &call_none;
+    }
+
+    std::vector<overrider>    overriders; ///< Overriders in the order of their definition
+    vtbl_count_t              count;      ///< Number of overriders, which the map refers to
+    std::unique_ptr<map_type> map;        ///< Overriders selected for combinations of dynamic types seen
+};
+
+//------------------------------------------------------------------------------
+
+} // of namespace mch
@@ -43,69 +43,69 @@
 ///
 
 #if defined(__GNUC__)
-template <typename E1> inline auto operator-(E1&& e1) noexcept -> typename std::enable_if<mch::is_expression<E1>::value, typename mch::filtered_result<mch::unary_minus,       E1>::type >::type { return mch::make_expr<mch::unary_minus>       (mch::filter(std::forward<E1>(e1))); }
-template <typename E1> inline auto operator~(E1&& e1) noexcept -> typename std::enable_if<mch::is_expression<E1>::value, typename mch::filtered_result<mch::bit_complement, E1>::type >::type { return mch::make_expr<mch::bit_complement> (mch::filter(std::forward<E1>(e1))); }
-// -- commented in favor of negation combinator template <typename E1> inline auto operator!(E1&& e1) noexcept -> typename std::enable_if<mch::is_expression<E1>::value, typename mch::filtered_result<mch::bool_complement,E1>::type >::type { return mch::make_expr<mch::bool_complement>(mch::filter(std::forward<E1>(e1))); }
+template <typename E1> constexpr auto operator-(E1&& e1) noexcept -> typename std::enable_if<mch::is_expression<E1>::value, typename mch::filtered_result<mch::unary_minus,       E1>::type >::type { return mch::make_expr<mch::unary_minus>       (mch::filter(std::forward<E1>(e1))); }
+template <typename E1> constexpr auto operator~(E1&& e1) noexcept -> typename std::enable_if<mch::is_expression<E1>::value, typename mch::filtered_result<mch::bit_complement, E1>::type >::type { return mch::make_expr<mch::bit_complement> (mch::filter(std::forward<E1>(e1))); }
+// -- commented in favor of negation combinator template <typename E1> constexpr auto operator!(E1&& e1) noexcept -> typename std::enable_if<mch::is_expression<E1>::value, typename mch::filtered_result<mch::bool_complement,E1>::type >::type { return mch::make_expr<mch::bool_complement>(mch::filter(std::forward<E1>(e1))); }
 
-template <typename E1, typename E2> inline auto operator+ (E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, typename mch::filtered_result<mch::addition,       E1,E2>::type >::type { return mch::make_expr<mch::addition>       (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
-template <typename E1, typename E2> inline auto operator- (E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, typename mch::filtered_result<mch::subtraction,    E1,E2>::type >::type { return mch::make_expr<mch::subtraction>    (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
-template <typename E1, typename E2> inline auto operator* (E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, typename mch::filtered_result<mch::multiplication, E1,E2>::type >::type { return mch::make_expr<mch::multiplication> (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
-template <typename E1, typename E2> inline auto operator/ (E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, typename mch::filtered_result<mch::division,       E1,E2>::type >::type { return mch::make_expr<mch::division>       (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
-template <typename E1, typename E2> inline auto operator% (E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, typename mch::filtered_result<mch::modulo,         E1,E2>::type >::type { return mch::make_expr<mch::modulo>         (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
-template <typename E1, typename E2> inline auto operator& (E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, typename mch::filtered_result<mch::bit_and,        E1,E2>::type >::type { return mch::make_expr<mch::bit_and>        (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
-template <typename E1, typename E2> inline auto operator| (E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, typename mch::filtered_result<mch::bit_or,         E1,E2>::type >::type { return mch::make_expr<mch::bit_or>         (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
-template <typename E1, typename E2> inline auto operator^ (E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, typename mch::filtered_result<mch::bit_xor,        E1,E2>::type >::type { return mch::make_expr<mch::bit_xor>        (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
-template <typename E1, typename E2> inline auto operator<<(E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, typename mch::filtered_result<mch::bit_shift_left, E1,E2>::type >::type { return mch::make_expr<mch::bit_shift_left> (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
-template <typename E1, typename E2> inline auto operator>>(E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, typename mch::filtered_result<mch::bit_shift_right,E1,E2>::type >::type { return mch::make_expr<mch::bit_shift_right>(mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
-// -- commented in favor of conjunction combinator template <typename E1, typename E2> inline auto operator&&(E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, typename mch::filtered_result<mch::bool_and,       E1,E2>::type >::type { return mch::make_expr<mch::bool_and>       (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
-//template <typename E1, typename E2> inline auto operator||(E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, typename mch::filtered_result<mch::bool_or,        E1,E2>::type >::type { return mch::make_expr<mch::bool_or>        (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
-template <typename E1, typename E2> inline auto operator==(E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, typename mch::filtered_result<mch::equal,          E1,E2>::type >::type { return mch::make_expr<mch::equal>          (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
-template <typename E1, typename E2> inline auto operator!=(E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, typename mch::filtered_result<mch::not_equal,      E1,E2>::type >::type { return mch::make_expr<mch::not_equal>      (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
-template <typename E1, typename E2> inline auto operator> (E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, typename mch::filtered_result<mch::greater,        E1,E2>::type >::type { return mch::make_expr<mch::greater>        (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
-template <typename E1, typename E2> inline auto operator>=(E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, typename mch::filtered_result<mch::greater_equal,  E1,E2>::type >::type { return mch::make_expr<mch::greater_equal>  (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
-template <typename E1, typename E2> inline auto operator< (E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, typename mch::filtered_result<mch::less,           E1,E2>::type >::type { return mch::make_expr<mch::less>           (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
-template <typename E1, typename E2> inline auto operator<=(E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, typename mch::filtered_result<mch::less_equal,     E1,E2>::type >::type { return mch::make_expr<mch::less_equal>     (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
+template <typename E1, typename E2> constexpr auto operator+ (E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, typename mch::filtered_result<mch::addition,       E1,E2>::type >::type { return mch::make_expr<mch::addition>       (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
+template <typename E1, typename E2> constexpr auto operator- (E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, typename mch::filtered_result<mch::subtraction,    E1,E2>::type >::type { return mch::make_expr<mch::subtraction>    (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
+template <typename E1, typename E2> constexpr auto operator* (E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, typename mch::filtered_result<mch::multiplication, E1,E2>::type >::type { return mch::make_expr<mch::multiplication> (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
+template <typename E1, typename E2> constexpr auto operator/ (E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, typename mch::filtered_result<mch::division,       E1,E2>::type >::type { return mch::make_expr<mch::division>       (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
+template <typename E1, typename E2> constexpr auto operator% (E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, typename mch::filtered_result<mch::modulo,         E1,E2>::type >::type { return mch::make_expr<mch::modulo>         (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
+template <typename E1, typename E2> constexpr auto operator& (E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, typename mch::filtered_result<mch::bit_and,        E1,E2>::type >::type { return mch::make_expr<mch::bit_and>        (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
+template <typename E1, typename E2> constexpr auto operator| (E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, typename mch::filtered_result<mch::bit_or,         E1,E2>::type >::type { return mch::make_expr<mch::bit_or>         (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
+template <typename E1, typename E2> constexpr auto operator^ (E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, typename mch::filtered_result<mch::bit_xor,        E1,E2>::type >::type { return mch::make_expr<mch::bit_xor>        (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
+template <typename E1, typename E2> constexpr auto operator<<(E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, typename mch::filtered_result<mch::bit_shift_left, E1,E2>::type >::type { return mch::make_expr<mch::bit_shift_left> (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
+template <typename E1, typename E2> constexpr auto operator>>(E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, typename mch::filtered_result<mch::bit_shift_right,E1,E2>::type >::type { return mch::make_expr<mch::bit_shift_right>(mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
+// -- commented in favor of conjunction combinator template <typename E1, typename E2> constexpr auto operator&&(E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, typename mch::filtered_result<mch::bool_and,       E1,E2>::type >::type { return mch::make_expr<mch::bool_and>       (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
+//template <typename E1, typename E2> constexpr auto operator||(E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, typename mch::filtered_result<mch::bool_or,        E1,E2>::type >::type { return mch::make_expr<mch::bool_or>        (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
+template <typename E1, typename E2> constexpr auto operator==(E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, typename mch::filtered_result<mch::equal,          E1,E2>::type >::type { return mch::make_expr<mch::equal>          (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
+template <typename E1, typename E2> constexpr auto operator!=(E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, typename mch::filtered_result<mch::not_equal,      E1,E2>::type >::type { return mch::make_expr<mch::not_equal>      (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
+template <typename E1, typename E2> constexpr auto operator> (E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, typename mch::filtered_result<mch::greater,        E1,E2>::type >::type { return mch::make_expr<mch::greater>        (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
+template <typename E1, typename E2> constexpr auto operator>=(E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, typename mch::filtered_result<mch::greater_equal,  E1,E2>::type >::type { return mch::make_expr<mch::greater_equal>  (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
+template <typename E1, typename E2> constexpr auto operator< (E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, typename mch::filtered_result<mch::less,           E1,E2>::type >::type { return mch::make_expr<mch::less>           (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
+template <typename E1, typename E2> constexpr auto operator<=(E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, typename mch::filtered_result<mch::less_equal,     E1,E2>::type >::type { return mch::make_expr<mch::less_equal>     (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
 #endif
 
 #if !defined(__GNUC__)
 
-template <typename E1> inline auto operator-(E1&& e1) noexcept -> typename std::enable_if<mch::is_expression<E1>::value, mch::expr<mch::unary_minus,       decltype(mch::filter(std::forward<E1>(e1)))> >::type { return mch::make_expr<mch::unary_minus>       (mch::filter(std::forward<E1>(e1))); }
-template <typename E1> inline auto operator~(E1&& e1) noexcept -> typename std::enable_if<mch::is_expression<E1>::value, mch::expr<mch::bit_complement, decltype(mch::filter(std::forward<E1>(e1)))> >::type { return mch::make_expr<mch::bit_complement> (mch::filter(std::forward<E1>(e1))); }
-// -- commented in favor of negation combinator template <typename E1> inline auto operator!(E1&& e1) noexcept -> typename std::enable_if<mch::is_expression<E1>::value, mch::expr<mch::bool_complement,decltype(mch::filter(std::forward<E1>(e1)))> >::type { return mch::make_expr<mch::bool_complement>(mch::filter(std::forward<E1>(e1))); }
+template <typename E1> constexpr auto operator-(E1&& e1) noexcept -> typename std::enable_if<mch::is_expression<E1>::value, mch::expr<mch::unary_minus,       decltype(mch::filter(std::forward<E1>(e1)))> >::type { return mch::make_expr<mch::unary_minus>       (mch::filter(std::forward<E1>(e1))); }
+template <typename E1> constexpr auto operator~(E1&& e1) noexcept -> typename std::enable_if<mch::is_expression<E1>::value, mch::expr<mch::bit_complement, decltype(mch::filter(std::forward<E1>(e1)))> >::type { return mch::make_expr<mch::bit_complement> (mch::filter(std::forward<E1>(e1))); }
+// -- commented in favor of negation combinator template <typename E1> constexpr auto operator!(E1&& e1) noexcept -> typename std::enable_if<mch::is_expression<E1>::value, mch::expr<mch::bool_complement,decltype(mch::filter(std::forward<E1>(e1)))> >::type { return mch::make_expr<mch::bool_complement>(mch::filter(std::forward<E1>(e1))); }
 
-template <typename E1, typename E2> inline auto operator+ (E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, mch::expr<mch::addition,       decltype(mch::filter(std::forward<E1>(e1))),decltype(mch::filter(std::forward<E2>(e2)))> >::type { return mch::make_expr<mch::addition>       (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
-template <typename E1, typename E2> inline auto operator- (E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, mch::expr<mch::subtraction,    decltype(mch::filter(std::forward<E1>(e1))),decltype(mch::filter(std::forward<E2>(e2)))> >::type { return mch::make_expr<mch::subtraction>    (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
-template <typename E1, typename E2> inline auto operator* (E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, mch::expr<mch::multiplication, decltype(mch::filter(std::forward<E1>(e1))),decltype(mch::filter(std::forward<E2>(e2)))> >::type { return mch::make_expr<mch::multiplication> (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
-template <typename E1, typename E2> inline auto operator/ (E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, mch::expr<mch::division,       decltype(mch::filter(std::forward<E1>(e1))),decltype(mch::filter(std::forward<E2>(e2)))> >::type { return mch::make_expr<mch::division>       (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
-template <typename E1, typename E2> inline auto operator% (E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, mch::expr<mch::modulo,         decltype(mch::filter(std::forward<E1>(e1))),decltype(mch::filter(std::forward<E2>(e2)))> >::type { return mch::make_expr<mch::modulo>         (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
-template <typename E1, typename E2> inline auto operator& (E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, mch::expr<mch::bit_and,        decltype(mch::filter(std::forward<E1>(e1))),decltype(mch::filter(std::forward<E2>(e2)))> >::type { return mch::make_expr<mch::bit_and>        (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
-template <typename E1, typename E2> inline auto operator| (E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, mch::expr<mch::bit_or,         decltype(mch::filter(std::forward<E1>(e1))),decltype(mch::filter(std::forward<E2>(e2)))> >::type { return mch::make_expr<mch::bit_or>         (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
-template <typename E1, typename E2> inline auto operator^ (E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, mch::expr<mch::bit_xor,        decltype(mch::filter(std::forward<E1>(e1))),decltype(mch::filter(std::forward<E2>(e2)))> >::type { return mch::make_expr<mch::bit_xor>        (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
-template <typename E1, typename E2> inline auto operator<<(E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, mch::expr<mch::bit_shift_left, decltype(mch::filter(std::forward<E1>(e1))),decltype(mch::filter(std::forward<E2>(e2)))> >::type { return mch::make_expr<mch::bit_shift_left> (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
-template <typename E1, typename E2> inline auto operator>>(E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, mch::expr<mch::bit_shift_right,decltype(mch::filter(std::forward<E1>(e1))),decltype(mch::filter(std::forward<E2>(e2)))> >::type { return mch::make_expr<mch::bit_shift_right>(mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
-// -- commented in favor of conjunction combinator template <typename E1, typename E2> inline auto operator&&(E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, mch::expr<mch::bool_and,       decltype(mch::filter(std::forward<E1>(e1))),decltype(mch::filter(std::forward<E2>(e2)))> >::type { return mch::make_expr<mch::bool_and>       (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
-//template <typename E1, typename E2> inline auto operator||(E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, mch::expr<mch::bool_or,        decltype(mch::filter(std::forward<E1>(e1))),decltype(mch::filter(std::forward<E2>(e2)))> >::type { return mch::make_expr<mch::bool_or>        (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
-template <typename E1, typename E2> inline auto operator==(E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, mch::expr<mch::equal,          decltype(mch::filter(std::forward<E1>(e1))),decltype(mch::filter(std::forward<E2>(e2)))> >::type { return mch::make_expr<mch::equal>          (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
-template <typename E1, typename E2> inline auto operator!=(E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, mch::expr<mch::not_equal,      decltype(mch::filter(std::forward<E1>(e1))),decltype(mch::filter(std::forward<E2>(e2)))> >::type { return mch::make_expr<mch::not_equal>      (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
-template <typename E1, typename E2> inline auto operator> (E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, mch::expr<mch::greater,        decltype(mch::filter(std::forward<E1>(e1))),decltype(mch::filter(std::forward<E2>(e2)))> >::type { return mch::make_expr<mch::greater>        (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
-template <typename E1, typename E2> inline auto operator>=(E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, mch::expr<mch::greater_equal,  decltype(mch::filter(std::forward<E1>(e1))),decltype(mch::filter(std::forward<E2>(e2)))> >::type { return mch::make_expr<mch::greater_equal>  (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
-template <typename E1, typename E2> inline auto operator< (E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, mch::expr<mch::less,           decltype(mch::filter(std::forward<E1>(e1))),decltype(mch::filter(std::forward<E2>(e2)))> >::type { return mch::make_expr<mch::less>           (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
-template <typename E1, typename E2> inline auto operator<=(E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, mch::expr<mch::less_equal,     decltype(mch::filter(std::forward<E1>(e1))),decltype(mch::filter(std::forward<E2>(e2)))> >::type { return mch::make_expr<mch::less_equal>     (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
+template <typename E1, typename E2> constexpr auto operator+ (E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, mch::expr<mch::addition,       decltype(mch::filter(std::forward<E1>(e1))),decltype(mch::filter(std::forward<E2>(e2)))> >::type { return mch::make_expr<mch::addition>       (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
+template <typename E1, typename E2> constexpr auto operator- (E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, mch::expr<mch::subtraction,    decltype(mch::filter(std::forward<E1>(e1))),decltype(mch::filter(std::forward<E2>(e2)))> >::type { return mch::make_expr<mch::subtraction>    (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
+template <typename E1, typename E2> constexpr auto operator* (E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, mch::expr<mch::multiplication, decltype(mch::filter(std::forward<E1>(e1))),decltype(mch::filter(std::forward<E2>(e2)))> >::type { return mch::make_expr<mch::multiplication> (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
+template <typename E1, typename E2> constexpr auto operator/ (E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, mch::expr<mch::division,       decltype(mch::filter(std::forward<E1>(e1))),decltype(mch::filter(std::forward<E2>(e2)))> >::type { return mch::make_expr<mch::division>       (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
+template <typename E1, typename E2> constexpr auto operator% (E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, mch::expr<mch::modulo,         decltype(mch::filter(std::forward<E1>(e1))),decltype(mch::filter(std::forward<E2>(e2)))> >::type { return mch::make_expr<mch::modulo>         (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
+template <typename E1, typename E2> constexpr auto operator& (E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, mch::expr<mch::bit_and,        decltype(mch::filter(std::forward<E1>(e1))),decltype(mch::filter(std::forward<E2>(e2)))> >::type { return mch::make_expr<mch::bit_and>        (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
+template <typename E1, typename E2> constexpr auto operator| (E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, mch::expr<mch::bit_or,         decltype(mch::filter(std::forward<E1>(e1))),decltype(mch::filter(std::forward<E2>(e2)))> >::type { return mch::make_expr<mch::bit_or>         (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
+template <typename E1, typename E2> constexpr auto operator^ (E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, mch::expr<mch::bit_xor,        decltype(mch::filter(std::forward<E1>(e1))),decltype(mch::filter(std::forward<E2>(e2)))> >::type { return mch::make_expr<mch::bit_xor>        (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
+template <typename E1, typename E2> constexpr auto operator<<(E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, mch::expr<mch::bit_shift_left, decltype(mch::filter(std::forward<E1>(e1))),decltype(mch::filter(std::forward<E2>(e2)))> >::type { return mch::make_expr<mch::bit_shift_left> (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
+template <typename E1, typename E2> constexpr auto operator>>(E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, mch::expr<mch::bit_shift_right,decltype(mch::filter(std::forward<E1>(e1))),decltype(mch::filter(std::forward<E2>(e2)))> >::type { return mch::make_expr<mch::bit_shift_right>(mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
+// -- commented in favor of conjunction combinator template <typename E1, typename E2> constexpr auto operator&&(E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, mch::expr<mch::bool_and,       decltype(mch::filter(std::forward<E1>(e1))),decltype(mch::filter(std::forward<E2>(e2)))> >::type { return mch::make_expr<mch::bool_and>       (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
+//template <typename E1, typename E2> constexpr auto operator||(E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, mch::expr<mch::bool_or,        decltype(mch::filter(std::forward<E1>(e1))),decltype(mch::filter(std::forward<E2>(e2)))> >::type { return mch::make_expr<mch::bool_or>        (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
+template <typename E1, typename E2> constexpr auto operator==(E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, mch::expr<mch::equal,          decltype(mch::filter(std::forward<E1>(e1))),decltype(mch::filter(std::forward<E2>(e2)))> >::type { return mch::make_expr<mch::equal>          (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
+template <typename E1, typename E2> constexpr auto operator!=(E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, mch::expr<mch::not_equal,      decltype(mch::filter(std::forward<E1>(e1))),decltype(mch::filter(std::forward<E2>(e2)))> >::type { return mch::make_expr<mch::not_equal>      (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
+template <typename E1, typename E2> constexpr auto operator> (E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, mch::expr<mch::greater,        decltype(mch::filter(std::forward<E1>(e1))),decltype(mch::filter(std::forward<E2>(e2)))> >::type { return mch::make_expr<mch::greater>        (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
+template <typename E1, typename E2> constexpr auto operator>=(E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, mch::expr<mch::greater_equal,  decltype(mch::filter(std::forward<E1>(e1))),decltype(mch::filter(std::forward<E2>(e2)))> >::type { return mch::make_expr<mch::greater_equal>  (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
+template <typename E1, typename E2> constexpr auto operator< (E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, mch::expr<mch::less,           decltype(mch::filter(std::forward<E1>(e1))),decltype(mch::filter(std::forward<E2>(e2)))> >::type { return mch::make_expr<mch::less>           (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
+template <typename E1, typename E2> constexpr auto operator<=(E1&& e1, E2&& e2) noexcept -> typename std::enable_if<mch::either_is_expression<E1,E2>::value, mch::expr<mch::less_equal,     decltype(mch::filter(std::forward<E1>(e1))),decltype(mch::filter(std::forward<E2>(e2)))> >::type { return mch::make_expr<mch::less_equal>     (mch::filter(std::forward<E1>(e1)),mch::filter(std::forward<E2>(e2))); }
 
 #else
 
 //template <typename T>                            inline auto operator-( mch::var<T>& v) noexcept -> decltype(mch::make_expr<mch::unary_minus>(mch::ref2<mch::var<T>>(v))) { return /*(*/mch::make_expr<mch::unary_minus>(mch::ref2<mch::var<T>>(v))/*)*/; }
 //template <typename T>                            inline auto operator-(const mch::value<T>& v) noexcept -> decltype(mch::make_expr<mch::unary_minus>(v)) { return /*(*/mch::make_expr<mch::unary_minus>(v)/*)*/; }
 //template <typename F1, typename E1>              inline auto operator-(const mch::expr<F1,E1>& v) noexcept -> decltype(mch::make_expr<mch::unary_minus>(v)) { return /*(*/mch::make_expr<mch::unary_minus>(v)/*)*/; }
-//template <typename F1, typename E1, typename E2> inline auto operator-(const mch::expr<F1,E1,E2>& v) noexcept -> decltype(mch::make_expr<mch::unary_minus>(v)) { return /*(*/mch::make_expr<mch::unary_minus>(v)/*)*/; }
+//template <typename F1, typename E1, typename E2> constexpr auto operator-(const mch::expr<F1,E1,E2>& v) noexcept -> decltype(mch::make_expr<mch::unary_minus>(v)) { return /*(*/mch::make_expr<mch::unary_minus>(v)/*)*/; }
 //template <typename T>                            inline auto operator~( mch::var<T>& v) noexcept -> decltype(mch::make_expr<mch::bit_complement>(mch::ref2<mch::var<T>>(v))) { return /*(*/mch::make_expr<mch::bit_complement>(mch::ref2<mch::var<T>>(v))/*)*/; }
 //template <typename T>                            inline auto operator~(const mch::value<T>& v) noexcept -> decltype(mch::make_expr<mch::bit_complement>(v)) { return /*(*/mch::make_expr<mch::bit_complement>(v)/*)*/; }
 //template <typename F1, typename E1>              inline auto operator~(const mch::expr<F1,E1>& v) noexcept -> decltype(mch::make_expr<mch::bit_complement>(v)) { return /*(*/mch::make_expr<mch::bit_complement>(v)/*)*/; }
-//template <typename F1, typename E1, typename E2> inline auto operator~(const mch::expr<F1,E1,E2>& v) noexcept -> decltype(mch::make_expr<mch::bit_complement>(v)) { return /*(*/mch::make_expr<mch::bit_complement>(v)/*)*/; }
+//template <typename F1, typename E1, typename E2> constexpr auto operator~(const mch::expr<F1,E1,E2>& v) noexcept -> decltype(mch::make_expr<mch::bit_complement>(v)) { return /*(*/mch::make_expr<mch::bit_complement>(v)/*)*/; }
 //template <typename T>                            inline auto operator!( mch::var<T>& v) noexcept -> decltype(mch::make_expr<mch::bool_complement>(mch::ref2<mch::var<T>>(v))) { return /*(*/mch::make_expr<mch::bool_complement>(mch::ref2<mch::var<T>>(v))/*)*/; }
 //template <typename T>                            inline auto operator!(const mch::value<T>& v) noexcept -> decltype(mch::make_expr<mch::bool_complement>(v)) { return /*(*/mch::make_expr<mch::bool_complement>(v)/*)*/; }
 //template <typename F1, typename E1>              inline auto operator!(const mch::expr<F1,E1>& v) noexcept -> decltype(mch::make_expr<mch::bool_complement>(v)) { return /*(*/mch::make_expr<mch::bool_complement>(v)/*)*/; }
-//template <typename F1, typename E1, typename E2> inline auto operator!(const mch::expr<F1,E1,E2>& v) noexcept -> decltype(mch::make_expr<mch::bool_complement>(v)) { return /*(*/mch::make_expr<mch::bool_complement>(v)/*)*/; }
+//template <typename F1, typename E1, typename E2> constexpr auto operator!(const mch::expr<F1,E1,E2>& v) noexcept -> decltype(mch::make_expr<mch::bool_complement>(v)) { return /*(*/mch::make_expr<mch::bool_complement>(v)/*)*/; }
 
 //template <typename T, typename E>                             inline auto operator+( mch::var<T>& v, E&& e) noexcept -> decltype(mch::make_expr<mch::addition>(mch::ref2<mch::var<T>>(v),mch::filter(std::forward<E>(e)))) { return /*(*/mch::make_expr<mch::addition>(mch::ref2<mch::var<T>>(v),mch::filter(std::forward<E>(e)))/*)*/; }
 //template <typename T, typename E>                             inline auto operator+( E&& e, mch::var<T>& v) noexcept -> mch::expr<mch::addition,decltype(mch::filter(std::forward<E>(e))),mch::ref2<mch::var<T>>> { return mch::make_expr<mch::addition>(mch::filter(std::forward<E>(e)),mch::ref2<mch::var<T>>(v)); }
@@ -0,0 +1,179 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// \file
+///
+/// This file defines counters of the overhead of the dispatch machinery: the
+/// heap it allocates, the dynamic_casts it performs and the updates of its
+/// vtbl maps, e.g.:
+///
+///     warm_up(); 
+///     mch::overhead_snapshot before = mch::overhead_report();
+///     serve();
+///     std::clog << mch::overhead_report() - before; // Expected to be all 0
+///
+/// \note This file is included by the headers allocating or casting when 
+///       #XTL_OVERHEAD_ACCOUNTING is enabled.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#pragma once
+
+// --------------------[ Design Notes ]--------------------
+// - Counters are global and not per map, so that allocations made before a 
+//   map exists (e.g. during static initialization) or by structures shared by
+//   many maps (offsets of memoized_cast) are accounted as well.
+// - Bytes are those requested by the library. Allocations made on its behalf
+//   by the standard library (nodes of std::regex automata, buffers of vectors
+//   beyond their capacity) are counted as the growth of their capacity or not
+//   at all, while the events themselves are always counted.
+// - Counters are relaxed atomics: they are only read when reported, so no 
+//   ordering with the rest of the program is needed.
+
+#include "config.hpp"
+#include <atomic>
+#include <cstddef>
+#include <ostream>
+#include <type_traits>
+
+namespace mch ///< Mach7 library namespace
+{
+
+//------------------------------------------------------------------------------
+
+/// Values of the overhead counters at some point of the program
+struct overhead_snapshot
+{
+    size_t allocations;     ///< Heap blocks allocated by the library
+    size_t allocated_bytes; ///< Bytes requested for them
+    size_t dynamic_casts;   ///< Calls to dynamic_cast made by Match statements, patterns and memoized_cast
+    size_t vtbl_updates;    ///< Rearrangements (rehashes) of caches of vtbl maps
+    size_t regex_compiles;  ///< Regular expressions compiled
+};
+
+/// Overhead accumulated between two snapshots
+inline overhead_snapshot operator-(const overhead_snapshot& a, const overhead_snapshot& b) noexcept
+{
+    overhead_snapshot result = {
+        a.allocations     - b.allocations,
+        a.allocated_bytes - b.allocated_bytes,
+        a.dynamic_casts   - b.dynamic_casts,
+        a.vtbl_updates    - b.vtbl_updates,
+        a.regex_compiles  - b.regex_compiles
+    };
+    return result;
+}
+
+inline std::ostream& operator<<(std::ostream& os, const overhead_snapshot& s)
+{
+    return os << "allocations="     << s.allocations
+              << " bytes="          << s.allocated_bytes
+              << " dynamic_casts="  << s.dynamic_casts
+              << " vtbl_updates="   << s.vtbl_updates
+              << " regex_compiles=" << s.regex_compiles;
+}
+
+//------------------------------------------------------------------------------
+
+/// The counters themselves, shared by all threads
+struct overhead_counters
+{
+    std::atomic<size_t> allocations;
+    std::atomic<size_t> allocated_bytes;
+    std::atomic<size_t> dynamic_casts;
+    std::atomic<size_t> vtbl_updates;
+    std::atomic<size_t> regex_compiles;
+};
+
+/// Returns the counters, zero-initialized before any dynamic initialization
+/// that may already allocate
+inline overhead_counters& overhead() noexcept
+{
+    static overhead_counters counters; // Static storage is zeroed before dynamic initialization
+    return counters;
+}
+
+inline void count_allocation(size_t bytes) noexcept
+{
+    overhead().allocations.fetch_add(1, std::memory_order_relaxed);
+    overhead().allocated_bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+inline void count_dynamic_cast()  noexcept { overhead().dynamic_casts .fetch_add(1, std::memory_order_relaxed); }
+inline void count_vtbl_update()   noexcept { overhead().vtbl_updates  .fetch_add(1, std::memory_order_relaxed); }
+inline void count_regex_compile() noexcept { overhead().regex_compiles.fetch_add(1, std::memory_order_relaxed); }
+
+/// Counts the dynamic_cast from S* to T* of a type test of a Match statement
+/// or pattern. Upcasts are resolved at compile time and are not counted. 
+/// Under #XTL_USE_MEMOIZED_CAST those casts are calls to memoized_cast, which
+/// counts the ones it has to forward to dynamic_cast itself.
+template <typename T, typename S>
+inline void count_type_test_cast() noexcept
+{
+#if !XTL_USE_MEMOIZED_CAST
+    if (!std::is_base_of<typename std::remove_cv<T>::type, typename std::remove_cv<S>::type>::value)
+        count_dynamic_cast();
+#endif
+}
+
+/// Counts growth of the capacity of a container c from old_capacity as an allocation
+template <typename C>
+inline void count_growth(const C& c, size_t old_capacity) noexcept
+{
+    if (c.capacity() != old_capacity)
+        count_allocation(c.capacity()*sizeof(typename C::value_type));
+}
+
+/// Current values of the counters
+inline overhead_snapshot overhead_report() noexcept
+{
+    const overhead_counters& c = overhead();
+    overhead_snapshot result = {
+        c.allocations    .load(std::memory_order_relaxed),
+        c.allocated_bytes.load(std::memory_order_relaxed),
+        c.dynamic_casts  .load(std::memory_order_relaxed),
+        c.vtbl_updates   .load(std::memory_order_relaxed),
+        c.regex_compiles .load(std::memory_order_relaxed)
+    };
+    return result;
+}
+
+//------------------------------------------------------------------------------
+
+} // of namespace mch
@@ -0,0 +1,240 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library.
+///
+/// Data-parallel form of mch::match over the elements of a random-access range:
+/// \code
+///     size_t area = mch::parallel_match(shapes, size_t(0), std::plus<size_t>(),
+///         mch::case_<Circle>([](const Circle& c) { return 3*c.r*c.r; }),
+///         mch::case_<Square>([](const Square& q) { return q.s*q.s;   }),
+///         mch::otherwise    ([](const Shape&  x) { return size_t(0); }));
+/// \endcode
+/// is the parallel equivalent of
+/// \code
+///     size_t area = 0;
+///     for (auto* p : shapes) area += mch::match(*p, clauses...);
+/// \endcode
+/// Elements of the range can be subjects or pointers to them. Results of the
+/// clauses are reduced with an associative function whose identity is the 
+/// initial value. Clauses are called concurrently and have to be safe to call
+/// from several threads.
+///
+/// \note Requires #XTL_MULTI_THREADING, since all threads share the vtbl map 
+///       of the clauses, just like iterations of a sequential loop do.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#pragma once
+
+// --------------------[ Design Notes ]--------------------
+// - The range is cut into chunks of about 1/8 of what each thread would get
+//   with an even split. Each thread starts with the chunks of its contiguous
+//   slice in its own deque, takes them from the front, so that it walks its
+//   slice in order, and when it has none left, steals from the back of deques
+//   of other threads, which gives it the chunks their owners would reach last.
+//   Classes whose clauses are expensive thus do not hold up the whole loop 
+//   when they cluster in one part of the range.
+// - Every thread reduces the results of its elements into its own partial 
+//   result, and the partial results are reduced in the order of threads at 
+//   the end. Nothing is shared between threads per element but the vtbl map.
+// - The first exception thrown by a clause stops all threads at the next 
+//   chunk and is rethrown by parallel_match.
+//------------------------------------------------------------------------------
+
+#include "match_function.hpp"
+
+#if !XTL_MULTI_THREADING
+#error mch::parallel_match requires thread-safe vtbl maps of XTL_MULTI_THREADING
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace mch ///< Mach7 library namespace
+{
+
+//------------------------------------------------------------------------------
+
+/// Number of threads used by parallel_match, including the calling one. 0
+/// means one per hardware thread.
+inline size_t& parallel_match_threads() { static size_t threads = 0; return threads; }
+
+//------------------------------------------------------------------------------
+
+/// Subject of mch::match for element of a range that is a subject itself ...
+template <typename E> inline const E& subject_of(const E& e) noexcept { return e; }
+/// ... or a pointer to it
+template <typename E> inline const E& subject_of(const E* e) noexcept { return *e; }
+template <typename E> inline const E& subject_of(E* e)       noexcept { return *e; }
+
+//------------------------------------------------------------------------------
+
+/// Chunks of a range of n elements distributed over deques of worker threads
+class chunk_queues
+{
+public:
+
+    /// Half-open range of element indices
+    typedef std::pair<size_t,size_t> chunk;
+
+    chunk_queues(size_t n, size_t threads) : m_queues(threads)
+    {
+        const size_t grain = std::max(size_t(1), n / (threads*8));
+
+        for (size_t i = 0; i < threads; ++i)
+            for (size_t b = n*i/threads, e = n*(i+1)/threads; b < e; b += grain)
+                m_queues[i].chunks.push_back(chunk(b, std::min(b+grain, e)));
+    }
+
+    /// Takes the next chunk of thread i or the last one of another thread.
+    /// Returns false once all chunks have been taken.
+    bool take(size_t i, chunk& c)
+    {
+        {
+            std::lock_guard<std::mutex> guard(m_queues[i].mutex);
+
+            if (!m_queues[i].chunks.empty())
+            {
+                c = m_queues[i].chunks.front();
+                m_queues[i].chunks.pop_front();
+                return true;
+            }
+        }
+
+        for (size_t k = 1; k < m_queues.size(); ++k)
+        {
+            queue& victim = m_queues[(i + k) % m_queues.size()];
+            std::lock_guard<std::mutex> guard(victim.mutex);
+
+            if (!victim.chunks.empty())
+            {
+                c = victim.chunks.back();
+                victim.chunks.pop_back();
+                return true;
+            }
+        }
+
+        return false; // No chunks are added after construction
+    }
+
+private:
+
+    /// Chunks not taken yet of the slice of a thread
+    struct queue
+    {
+        std::mutex        mutex;
+        std::deque<chunk> chunks;
+    };
+
+    std::vector<queue> m_queues;
+};
+
+//------------------------------------------------------------------------------
+
+/// Reduces with reduce, starting from init, the results of mch::match with 
+/// clauses on every element of random-access range, concurrently on 
+/// parallel_match_threads() threads. \see parallel_match.hpp
+template <typename Range, typename R, typename Reduce, typename... C>
+R parallel_match(const Range& range, R init, Reduce reduce, const C&... clauses)
+{
+    const auto   first   = std::begin(range);
+    const size_t n       = size_t(std::distance(first, std::end(range)));
+    const size_t threads = std::max(size_t(1), std::min(n, parallel_match_threads() ? parallel_match_threads() : size_t(std::thread::hardware_concurrency())));
+
+    chunk_queues       queues(n, threads);
+    std::vector<R>     partial(threads, init);
+    std::atomic<bool>  failed(false);
+    std::mutex         error_mutex;
+    std::exception_ptr error;
+
+    auto work = [&](size_t i)
+    {
+        chunk_queues::chunk c;
+
+        while (!failed && queues.take(i, c))
+        {
+            try
+            {
+                for (size_t j = c.first; j < c.second; ++j)
+                    partial[i] = reduce(std::move(partial[i]), match(subject_of(first[j]), clauses...));
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> guard(error_mutex);
+
+                if (!failed.exchange(true))
+                    error = std::current_exception();
+            }
+        }
+    };
+
+    std::vector<std::thread> helpers;
+
+    for (size_t i = 1; i < threads; ++i)
+        helpers.push_back(std::thread(work, i));
+
+    work(0);
+
+    for (size_t i = 0; i < helpers.size(); ++i)
+        helpers[i].join();
+
+    if (error)
+        std::rethrow_exception(error);
+
+    R result = std::move(init);
+
+    for (size_t i = 0; i < threads; ++i)
+        result = reduce(std::move(result), std::move(partial[i]));
+
+    return result;
+}
+
+//------------------------------------------------------------------------------
+
+} // of namespace mch
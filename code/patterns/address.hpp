@@ -81,6 +81,25 @@ struct address
 /// #is_pattern_ is a helper meta-predicate capable of distinguishing all our patterns
 template <typename P1> struct is_pattern_<address<P1>> { static const bool value = true; };
 
+/// #pattern_cost_ is a helper meta-function estimating the cost of trying a pattern
+template <typename P1> struct pattern_cost_<address<P1>> : pattern_cost<P1> {};
+
+/// #is_hoistable_ is a helper meta-predicate telling whether a pattern can be constructed once per clause
+template <typename P1> struct is_hoistable_<address<P1>> : is_hoistable<P1> {};
+
+/// #extractors_might_throw_ is a helper meta-predicate telling whether a pattern might throw from accessors of #bindings
+template <typename P1> struct extractors_might_throw_<address<P1>> : extractors_might_throw<P1> {};
+
+/// #dereferences_ is a helper meta-predicate telling whether a pattern loads the object it is applied to through a pointer
+template <typename P1> struct dereferences_<address<P1>> { static const bool value = true; };
+
+/// Pointers known not to be null are dereferenced without a check
+template <typename P1>
+struct nonnull_application_<address<P1>>
+{
+    template <typename U> static bool apply(const address<P1>& p, U* u) { XTL_ASSERT(u); return p.m_p1(*u); }
+};
+
 //------------------------------------------------------------------------------
 
 template <typename P1>
@@ -112,6 +131,15 @@ struct deref
 /// #is_pattern_ is a helper meta-predicate capable of distinguishing all our patterns
 template <typename P1> struct is_pattern_<deref<P1>> { static const bool value = true; };
 
+/// #pattern_cost_ is a helper meta-function estimating the cost of trying a pattern
+template <typename P1> struct pattern_cost_<deref<P1>> : pattern_cost<P1> {};
+
+/// #is_hoistable_ is a helper meta-predicate telling whether a pattern can be constructed once per clause
+template <typename P1> struct is_hoistable_<deref<P1>> : is_hoistable<P1> {};
+
+/// #extractors_might_throw_ is a helper meta-predicate telling whether a pattern might throw from accessors of #bindings
+template <typename P1> struct extractors_might_throw_<deref<P1>> : extractors_might_throw<P1> {};
+
 //------------------------------------------------------------------------------
 
 } // of namespace mch
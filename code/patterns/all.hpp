@@ -52,6 +52,8 @@
 #include "constructor.hpp"    // Constructor pattern
 #include "equivalence.hpp"    // Equivalence pattern
 #include "guard.hpp"          // Guard pattern
+#include "interval.hpp"       // Interval pattern
+#include "keyed.hpp"          // Keyed pattern
 #include "n+k.hpp"            // n+k pattern
 #include "predicate.hpp"      // Predicate patterns
 #include "primitive.hpp"      // Value, Variable and Wildcard patterns
@@ -46,6 +46,22 @@
 
 #include "common.hpp"
 #include <algorithm>
+#include <array>
+#include <cstdint>
+#include <type_traits>
+
+//------------------------------------------------------------------------------
+// Design Notes:
+//
+// - any({...}) keeps a copy of the values in std::array whose size is deduced
+//   from the braced list, so the pattern neither allocates nor refers to the
+//   temporary list, and can be stored and used after the full expression.
+// - any<T,V1,...,Vn>() knows the values at compile time. Their tables are
+//   built once per set of values in static storage, and the lookup is chosen
+//   by the number and the spread of values: a linear scan for small sets, a 
+//   bitset for integral values spanning a small range and a binary search in
+//   the sorted values otherwise.
+//
 
 namespace mch ///< Mach7 library namespace
 {
@@ -53,6 +69,7 @@ namespace mch ///< Mach7 library namespace
 //------------------------------------------------------------------------------
 
 /// One-of pattern
+/// \note Kept for compatibility, #any now creates #one_of_array that owns its values
 template <typename T>
 struct one_of
 {
@@ -74,17 +91,163 @@ struct one_of
 
 //------------------------------------------------------------------------------
 
+/// One-of pattern with a copy of N values known at run time
+template <typename T, std::size_t N>
+struct one_of_array
+{
+    explicit one_of_array(const T (&values)[N]) { std::copy(values, values+N, m_elements.begin()); }
+
+    /// Type function returning a type that will be accepted by the pattern for
+    /// a given subject type S. We use type function instead of an associated 
+    /// type, because there is no a single accepted type for a #wildcard pattern
+    /// for example. Requirement of #Pattern concept.
+    template <typename S> struct accepted_type_for { typedef T type; };
+
+    bool operator()(const T& s) const noexcept 
+    {
+        return std::find(m_elements.begin(),m_elements.end(),s) != m_elements.end(); 
+    }
+
+    std::array<T,N> m_elements;
+};
+
+//------------------------------------------------------------------------------
+
+///@{
+/// Smallest and largest of the values known at compile time
+template <typename T>                  constexpr T min_of(T a) noexcept { return a; }
+template <typename T, typename... Ts>  constexpr T min_of(T a, T b, Ts... ts) noexcept { return min_of(a < b ? a : b, ts...); }
+template <typename T>                  constexpr T max_of(T a) noexcept { return a; }
+template <typename T, typename... Ts>  constexpr T max_of(T a, T b, Ts... ts) noexcept { return max_of(a < b ? b : a, ts...); }
+///@}
+
+/// Ways #one_of_c looks up a subject among its values
+enum one_of_lookup 
+{
+    one_of_linear, ///< Compare with each value, best for small sets
+    one_of_bitset, ///< Test a bit of subject's offset from the smallest value, for integral values in a small range
+    one_of_sorted  ///< Binary search in sorted values, for the rest
+};
+
+//------------------------------------------------------------------------------
+
+/// One-of pattern with values V1,...,Vn known at compile time
+template <typename T, T... Vs>
+struct one_of_c
+{
+    static_assert(sizeof...(Vs) > 0, "One-of pattern must have at least one value");
+
+    enum 
+    { 
+        size         = sizeof...(Vs), ///< Number of values
+        linear_limit = 8,             ///< Sets up to this size are scanned linearly
+        bitset_limit = 1024           ///< Integral sets spanning up to this many values use bitset
+    };
+
+    /// Range of values, which we only use for integral types
+    static const std::uintmax_t span = std::uintmax_t(max_of(Vs...)) - std::uintmax_t(min_of(Vs...));
+
+    /// Lookup chosen for this set of values
+    static const one_of_lookup lookup = size <= linear_limit || !std::is_integral<T>::value 
+                                            ? one_of_linear 
+                                            : span < bitset_limit 
+                                                ? one_of_bitset 
+                                                : one_of_sorted;
+
+    /// Type function returning a type that will be accepted by the pattern for
+    /// a given subject type S. We use type function instead of an associated 
+    /// type, because there is no a single accepted type for a #wildcard pattern
+    /// for example. Requirement of #Pattern concept.
+    template <typename S> struct accepted_type_for { typedef T type; };
+
+    bool operator()(const T& s) const noexcept 
+    {
+        return contains(s, std::integral_constant<one_of_lookup,lookup>()); 
+    }
+
+private:
+
+    bool contains(const T& s, std::integral_constant<one_of_lookup,one_of_linear>) const noexcept
+    {
+        static const T values[] = {Vs...};
+
+        for (std::size_t i = 0; i < size; ++i)
+            if (values[i] == s)
+                return true;
+
+        return false;
+    }
+
+    /// Bits of offsets of values from the smallest one
+    struct bitset_table
+    {
+        bitset_table() noexcept
+        {
+            static const T values[] = {Vs...};
+            std::fill_n(words, std::size_t(span/64+1), std::uint64_t(0));
+
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                std::uintmax_t d = std::uintmax_t(values[i]) - std::uintmax_t(min_of(Vs...));
+                words[d/64] |= std::uint64_t(1) << (d%64);
+            }
+        }
+
+        std::uint64_t words[span/64+1];
+    };
+
+    bool contains(const T& s, std::integral_constant<one_of_lookup,one_of_bitset>) const noexcept
+    {
+        static const bitset_table table;
+        std::uintmax_t d = std::uintmax_t(s) - std::uintmax_t(min_of(Vs...)); // Values below smallest wrap around to large ones
+        return d <= span && (table.words[d/64] >> (d%64)) & 1;
+    }
+
+    /// Values in ascending order
+    struct sorted_table
+    {
+        sorted_table() noexcept : values{{Vs...}} { std::sort(values.begin(), values.end()); }
+        std::array<T,size> values;
+    };
+
+    bool contains(const T& s, std::integral_constant<one_of_lookup,one_of_sorted>) const noexcept
+    {
+        static const sorted_table table;
+        return std::binary_search(table.values.begin(), table.values.end(), s);
+    }
+};
+
+//------------------------------------------------------------------------------
+
 /// #is_pattern_ is a helper meta-predicate capable of distinguishing all our patterns
-template <typename T> struct is_pattern_<one_of<T>> { static const bool value = true; };
+template <typename T>                  struct is_pattern_<one_of<T>>          { static const bool value = true; };
+template <typename T, std::size_t N>   struct is_pattern_<one_of_array<T,N>>  { static const bool value = true; };
+template <typename T, T... Vs>         struct is_pattern_<one_of_c<T,Vs...>>  { static const bool value = true; };
+
+/// #pattern_cost_ is a helper meta-function estimating the cost of trying a pattern
+template <typename T, std::size_t N>   struct pattern_cost_<one_of_array<T,N>> { static const unsigned int value = N*cost_of_value; };
+template <typename T, T... Vs>         struct pattern_cost_<one_of_c<T,Vs...>> { static const unsigned int value = one_of_c<T,Vs...>::lookup == one_of_linear ? sizeof...(Vs)*cost_of_value : cost_of_expression; };
+
+/// #is_hoistable_ is a helper meta-predicate telling whether a pattern can be constructed once per clause
+template <typename T, std::size_t N>   struct is_hoistable_<one_of_array<T,N>> { static const bool value = true; };
+template <typename T, T... Vs>         struct is_hoistable_<one_of_c<T,Vs...>> { static const bool value = true; };
 
 //------------------------------------------------------------------------------
 
-/// Convenience function for creating any pattern out of initializer list holding 
-/// the set of acceptable values.
-template <typename T>
-inline one_of<T> any(std::initializer_list<T>&& init) noexcept 
+/// Convenience function for creating any pattern out of a braced list holding 
+/// the set of acceptable values, e.g. any({1,5,7}).
+template <typename T, std::size_t N>
+inline one_of_array<T,N> any(const T (&values)[N]) noexcept 
+{
+    return one_of_array<T,N>(values);
+}
+
+/// Convenience function for creating any pattern out of the set of acceptable
+/// values known at compile time, e.g. any<int,1,5,7>().
+template <typename T, T V, T... Vs>
+inline one_of_c<T,V,Vs...> any() noexcept 
 {
-    return one_of<T>(std::move(init));
+    return one_of_c<T,V,Vs...>();
 }
 
 //------------------------------------------------------------------------------
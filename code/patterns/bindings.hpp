@@ -48,6 +48,11 @@
 #include "../metatools.hpp"
 #include <tuple>
 
+#if defined(XTL_FREQUENCY_PROFILE) && !XTL_TRACE_FREQUENCY
+#include "../frequency.hpp"     // mch::frequency_hint used by FQ
+#include XTL_FREQUENCY_PROFILE
+#endif
+
 namespace mch ///< Mach7 library namespace
 {
 
@@ -93,8 +98,6 @@ struct reflection<std::tuple<T...>>
     template <size_t N> struct member { static constexpr auto value = static_cast<typename std::tuple_element<N, std::tuple<T...>>::type& (*)(std::tuple<T...>&)>(&std::get<N>); };
 };
 
-auto t = std::make_tuple(42, 3.14);
-auto v = reflection<decltype(t)>::member<0>::value(t); // static_cast<std::tuple_element<1, decltype(t)>::type& (*)(decltype(t)&)>(&std::get<1>);
 #endif
 //template <> template <> struct reflection<MyClass>::member<0> { static constexpr auto value = &MyClass::a; };
 //template <> template <> struct reflection<MyClass>::member<1> { static constexpr auto value = &MyClass::b; };
@@ -196,14 +199,14 @@ struct target_of<view<T,L>>
     ///       putting #unary here around taking the address of it saves the user
     ///       from having to disambiguate explicitly.
     #define CM(Index,...)                                           \
-        static inline decltype(unary(&__VA_ARGS__)) member##Index() noexcept \
+        static constexpr decltype(unary(&__VA_ARGS__)) member##Index() noexcept \
         {                                                           \
             return unary(&__VA_ARGS__);                             \
         }
   #else
     #define CM(Index,...)                                           \
     template <typename dummy> struct member<Index,dummy> { static constexpr auto value = unary(&__VA_ARGS__); }; \
-    static inline decltype(member<Index>::value) member##Index() noexcept { return member<Index>::value; }
+    static constexpr decltype(member<Index>::value) member##Index() noexcept { return member<Index>::value; }
   #endif
 #else
   #if XTL_MESSAGE_ENABLED
@@ -211,6 +214,46 @@ struct target_of<view<T,L>>
   #endif
 #endif
 
+#if !defined(CMO)
+    /// Macro to define position of a data member Member of a standard-layout 
+    /// class T within its decomposition by the member's offset in T rather than
+    /// by a pointer to it. The member is then accessed with a load from the 
+    /// object at a compile-time constant offset, \see mch::member_at. Intended 
+    /// for plain records, e.g. wire-format headers viewed with several layouts.
+    /// Example: CMO(0,Header,length)
+    /// \note Use this macro only inside specializations of #bindings
+    /// \note The macro should be followed by a semicolon!
+    /// \note Unlike #CM, T cannot be a template with commas in its arguments,
+    ///       use a typedef for those.
+    #define CMO(Index,T,Member)                                     \
+        static constexpr mch::member_at<T,decltype(T::Member),offsetof(T,Member)> member##Index() noexcept \
+        {                                                           \
+            return mch::member_at<T,decltype(T::Member),offsetof(T,Member)>(); \
+        }
+#else
+  #if XTL_MESSAGE_ENABLED
+    #error Macro CMO, used by Mach7 pattern-matching library, has already been defined
+  #endif
+#endif
+
+#if !defined(NN)
+    /// Macro to declare that members at given positions within decomposition of
+    /// a given data type are pointers that are never null, e.g. in structures 
+    /// that use a sentinel object in place of null. Address and constructor 
+    /// patterns applied to such members skip their null checks and constructor
+    /// patterns prefetch the objects they point to, \see #XTL_PREFETCH_NONNULL_MEMBERS.
+    /// Example: NN(1,2)
+    /// \note Use this macro only inside specializations of #bindings
+    /// \note The macro should be followed by a semicolon!
+    #define NN(...) XTL_NONNULL_MEMBERS(XTL_NARG(__VA_ARGS__),__VA_ARGS__)
+    #define XTL_NONNULL_MEMBERS(N,...) enum { nonnull_members = XTL_REPEAT_WITH(|,N,XTL_NONNULL_MEMBER_BIT,__VA_ARGS__) }
+    #define XTL_NONNULL_MEMBER_BIT(i,...) (1u << (XTL_SELECT_ARG(i,__VA_ARGS__)))
+#else
+  #if XTL_MESSAGE_ENABLED
+    #error Macro NN, used by Mach7 pattern-matching library, has already been defined
+  #endif
+#endif
+
 #if !defined(KS)
     /// Macro to define a kind selector - a member of the common base class that 
     /// carries a distinct integral value that uniquely identifies the derived 
@@ -221,10 +264,11 @@ struct target_of<view<T,L>>
     ///       templates, which might have commas, otherwise just a single argument
     ///       would be sufficient.
     /// FIX: KS doesn't accept now members qualified with base class, but CM does, check why.
+    /// \note The selector is also callable from GPU kernels, \see kind_match.hpp
     #define KS(...)                                                 \
-        static inline decltype(unary(&__VA_ARGS__)) kind_selector() noexcept \
+        static XTL_HOST_DEVICE inline decltype(unary(&__VA_ARGS__)) kind_selector() noexcept \
         {                                                           \
-            return unary(&__VA_ARGS__);                             \
+            return &__VA_ARGS__;                                    \
         }                                                           \
         bool kind_selector_dummy() const noexcept
 #else
@@ -233,6 +277,107 @@ struct target_of<view<T,L>>
   #endif
 #endif
 
+#if !defined(KSM)
+    /// Macro to define a kind selector of a standard-layout class T that keeps
+    /// the kind in the bits of its data member Member selected by Mask, e.g. 
+    /// a value of an interpreter that tags the lowest bits of aligned pointers.
+    /// The kind is the selected bits shifted down to bit 0, so MatchU on T 
+    /// switches directly on them. \see mch::masked_member_at
+    /// Example: KSM(Value,bits,0x7)
+    /// \note Use this macro only inside specializations of #bindings
+    /// \note The macro should be followed by a semicolon!
+    #define KSM(T,Member,Mask)                                      \
+        static constexpr mch::masked_member_at<T,decltype(T::Member),offsetof(T,Member),(Mask)> kind_selector() noexcept \
+        {                                                           \
+            return mch::masked_member_at<T,decltype(T::Member),offsetof(T,Member),(Mask)>(); \
+        }                                                           \
+        bool kind_selector_dummy() const noexcept
+#else
+  #if XTL_MESSAGE_ENABLED
+    #error Macro KSM, used by Mach7 pattern-matching library, has already been defined
+  #endif
+#endif
+
+#if !defined(KSN)
+    /// Macro to define a kind selector of a standard-layout class T whose 64-bit
+    /// data member Member is NaN-boxed: negative quiet NaNs with a non-zero tag 
+    /// in the bits selected by TagMask are boxes of the kind given by the tag 
+    /// shifted down to bit 0, while everything else is a double of kind 0.
+    /// \see mch::nan_boxed_member_at
+    /// Example: KSN(Value,bits,0x0007000000000000ULL)
+    /// \note Use this macro only inside specializations of #bindings
+    /// \note The macro should be followed by a semicolon!
+    #define KSN(T,Member,TagMask)                                   \
+        static constexpr mch::nan_boxed_member_at<T,decltype(T::Member),offsetof(T,Member),(TagMask)> kind_selector() noexcept \
+        {                                                           \
+            return mch::nan_boxed_member_at<T,decltype(T::Member),offsetof(T,Member),(TagMask)>(); \
+        }                                                           \
+        bool kind_selector_dummy() const noexcept
+#else
+  #if XTL_MESSAGE_ENABLED
+    #error Macro KSN, used by Mach7 pattern-matching library, has already been defined
+  #endif
+#endif
+
+#if !defined(KSB)
+    /// Macro to define a kind selector of a view T of a serialized message, 
+    /// e.g. of a FlatBuffers-like format, whose union tag of integral type R is
+    /// at byte Offset of the buffer, so that MatchU routes messages without 
+    /// deserializing them. Messages too short to hold the tag are of kind 0.
+    /// T has to have members data() and size(). \see mch::buffer_kind_at
+    /// Example: KSB(Message,std::uint8_t,4)
+    /// \note Use this macro only inside specializations of #bindings
+    /// \note The macro should be followed by a semicolon!
+    #define KSB(T,R,Offset)                                         \
+        static constexpr mch::buffer_kind_at<T,R,(Offset)> kind_selector() noexcept \
+        {                                                           \
+            return mch::buffer_kind_at<T,R,(Offset)>();             \
+        }                                                           \
+        bool kind_selector_dummy() const noexcept
+#else
+  #if XTL_MESSAGE_ENABLED
+    #error Macro KSB, used by Mach7 pattern-matching library, has already been defined
+  #endif
+#endif
+
+#if !defined(CMB)
+    /// Macro to define position of a field of type R serialized at byte Offset
+    /// of the buffer viewed by T within the decomposition of T. The field is
+    /// read from the buffer only when a pattern needs it, without checking the
+    /// bounds, which are expected to be verified when the view is made.
+    /// \see mch::buffer_field_at
+    /// Example: CMB(0,Order,std::uint32_t,8)
+    /// \note Use this macro only inside specializations of #bindings
+    /// \note The macro should be followed by a semicolon!
+    #define CMB(Index,T,R,Offset)                                   \
+        static constexpr mch::buffer_field_at<T,R,(Offset)> member##Index() noexcept \
+        {                                                           \
+            return mch::buffer_field_at<T,R,(Offset)>();            \
+        }
+#else
+  #if XTL_MESSAGE_ENABLED
+    #error Macro CMB, used by Mach7 pattern-matching library, has already been defined
+  #endif
+#endif
+
+#if !defined(CMBI)
+    /// Same as #CMB for a field whose byte offset in the buffer is itself kept
+    /// as a 32-bit unsigned integer at byte Slot of the buffer.
+    /// \see mch::buffer_indirect_field_at
+    /// Example: CMBI(1,Order,double,12)
+    /// \note Use this macro only inside specializations of #bindings
+    /// \note The macro should be followed by a semicolon!
+    #define CMBI(Index,T,R,Slot)                                    \
+        static constexpr mch::buffer_indirect_field_at<T,R,(Slot)> member##Index() noexcept \
+        {                                                           \
+            return mch::buffer_indirect_field_at<T,R,(Slot)>();     \
+        }
+#else
+  #if XTL_MESSAGE_ENABLED
+    #error Macro CMBI, used by Mach7 pattern-matching library, has already been defined
+  #endif
+#endif
+
 #if !defined(KV)
     /// Macro to define an integral constant that uniquely identifies the derived 
     /// class. Used in the decomposition of a derived class. 
@@ -262,7 +407,13 @@ struct target_of<view<T,L>>
     /// \note We use variadic macro parameter here in order to be able to handle 
     ///       templates, which might have commas, otherwise just a single argument
     ///       would be sufficient.
+  #if XTL_TRACE_FREQUENCY
+    #define FQ(...) enum { fq = __VA_ARGS__, fq_line = __LINE__ }; static const char* fq_file() noexcept { return __FILE__; }
+  #elif defined(XTL_FREQUENCY_PROFILE)
+    #define FQ(...) enum { fq = mch::frequency_hint<__LINE__>::get(__FILE__,__VA_ARGS__) }
+  #else
     #define FQ(...) enum { fq = __VA_ARGS__ }
+  #endif
 #else
   #if XTL_MESSAGE_ENABLED
     #error Macro FQ, used by Mach7 pattern-matching library, has already been defined
@@ -324,6 +475,38 @@ struct bindings { Members(mch::identity<type_being_matched>); };
 
 //------------------------------------------------------------------------------
 
+/// Bindings of a tuple-like type T, whose I-th member is the I-th element taken
+/// with get<I>, e.g. std::tuple, std::pair and std::array (\see 
+/// adapters/std/adapt_std_tuple.hpp) or a class providing its own get<I>.
+/// \note Derive specializations of #bindings from it instead of using #CM:
+///       template <> struct bindings<MyTuple> : tuple_bindings<MyTuple> {};
+template <typename T>
+struct tuple_bindings
+{
+    #define XTL_TUPLE_MEMBER(I,...) static constexpr element_at<T,I> member##I() noexcept { return element_at<T,I>(); }
+    XTL_REPEAT(10, XTL_TUPLE_MEMBER, dummy)
+    #undef  XTL_TUPLE_MEMBER
+};
+
+#if XTL_SUPPORT(structured_bindings)
+/// Bindings of an aggregate T, whose I-th member is its I-th data member, as
+/// in a structured binding declaration. Arity is the number of data members,
+/// which is deduced for aggregates without array or aggregate data members.
+/// \note Derive specializations of #bindings from it instead of using #CM:
+///       template <> struct bindings<Point> : aggregate_bindings<Point> {};
+template <typename T, size_t Arity = aggregate_arity<T>::value>
+struct aggregate_bindings
+{
+    static_assert(std::is_aggregate<T>::value, "Only aggregates can have their bindings derived from data members");
+    static_assert(0 < Arity && Arity < 10, "Aggregates with 1 to 9 data members can have their bindings derived from them");
+    #define XTL_FIELD_MEMBER(I,...) static constexpr field_at<T,I,Arity> member##I() noexcept { return field_at<T,I,Arity>(); }
+    XTL_REPEAT(9, XTL_FIELD_MEMBER, dummy)
+    #undef  XTL_FIELD_MEMBER
+};
+#endif
+
+//------------------------------------------------------------------------------
+
 /// Helper function to access the value of the member specified with #KS macro 
 /// on a given object.
 template <typename T>
@@ -332,6 +515,14 @@ inline auto kind_selector(const T* p) -> XTL_RETURN
     apply_member(p, bindings<T>::kind_selector())
 )
 
+/// Kind value of case C in MatchK on a subject of type S. By default it is the
+/// one given with #KV in bindings of C, while types, whose kinds are numbered
+/// by the types themselves, e.g. mch::adt, specialize it.
+template <typename S, typename C>
+struct kind_value_of { enum { value = bindings<C>::kind_value }; };
+
+//------------------------------------------------------------------------------
+
 /// Helper function to call a function specified with #RS macro on a given object.
 template <typename T>
 inline auto raise_selector(const T* p) -> XTL_RETURN
@@ -0,0 +1,328 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file defines zero-copy patterns on strings and byte buffers: prefix,
+/// suffix, fixed-width fields and delimiter-separated fields.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#pragma once
+
+#include "sequence.hpp"
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#if XTL_SUPPORT(string_view)
+#include <string_view>
+#endif
+
+// --------------------[ Design Notes ]--------------------
+// - Patterns never copy the subject: on success they pass to their argument
+//   patterns views of parts of the subject, which typically are bound into 
+//   var<string_view> or var<byte_view>. The views are only valid as long as
+//   the subject is.
+// - Text subjects (std::string, const char*, string_view) are split into
+//   #string_view, byte buffers (#byte_view, std::vector<unsigned char>) are
+//   split into #byte_view, so argument patterns may be the same patterns again
+//   and compose with constructor, guard and other patterns.
+// - mch::string_view is std::string_view when the library supports it and a
+//   minimal non-owning substitute otherwise.
+// --------------------------------------------------------
+
+namespace mch ///< Mach7 library namespace
+{
+
+//------------------------------------------------------------------------------
+
+#if XTL_SUPPORT(string_view)
+typedef std::string_view string_view;
+#else
+/// Minimal substitute of std::string_view: a non-owning view of characters
+class string_view
+{
+public:
+
+    typedef char        value_type;
+    typedef const char* iterator;
+    typedef const char* const_iterator;
+    typedef size_t      size_type;
+
+    static const size_type npos = size_type(-1);
+
+    string_view() noexcept : m_data(nullptr), m_size(0) {}
+    string_view(const char* s) noexcept : m_data(s), m_size(std::strlen(s)) {}
+    string_view(const char* s, size_type n) noexcept : m_data(s), m_size(n) {}
+    string_view(const std::string& s) noexcept : m_data(s.data()), m_size(s.size()) {}
+
+    const char* data()   const noexcept { return m_data; }
+    size_type   size()   const noexcept { return m_size; }
+    size_type   length() const noexcept { return m_size; }
+    bool        empty()  const noexcept { return m_size == 0; }
+    const char* begin()  const noexcept { return m_data; }
+    const char* end()    const noexcept { return m_data + m_size; }
+    char operator[](size_type i) const noexcept { return m_data[i]; }
+
+    string_view substr(size_type pos, size_type n = npos) const noexcept 
+    {
+        XTL_ASSERT(pos <= m_size);
+        return string_view(m_data + pos, n < m_size - pos ? n : m_size - pos);
+    }
+
+    friend bool operator==(string_view a, string_view b) noexcept { return a.m_size == b.m_size && (a.m_size == 0 || std::memcmp(a.m_data, b.m_data, a.m_size) == 0); }
+    friend bool operator!=(string_view a, string_view b) noexcept { return !(a == b); }
+    friend std::ostream& operator<<(std::ostream& os, string_view s) { return os.write(s.m_data, static_cast<std::streamsize>(s.m_size)); }
+
+private:
+
+    const char* m_data;
+    size_type   m_size;
+};
+#endif
+
+/// Non-owning view of bytes
+typedef range_view<const unsigned char*> byte_view;
+
+//------------------------------------------------------------------------------
+
+/// Views of parts [b,e) of a subject handed to argument patterns
+inline string_view make_view(const char*          b, const char*          e) noexcept { return string_view(b, size_t(e - b)); }
+inline byte_view   make_view(const unsigned char* b, const unsigned char* e) noexcept { return byte_view(b, e); }
+
+//------------------------------------------------------------------------------
+
+/// Common part of buffer patterns: kinds of subjects they accept. Derived 
+/// pattern D has to provide bool D::match(const Ch* b, const Ch* e) for both
+/// char and unsigned char.
+template <typename D>
+struct buffer_pattern
+{
+    /// Type function returning a type that will be accepted by the pattern for
+    /// a given subject type S. We use type function instead of an associated 
+    /// type, because there is no a single accepted type for a #wildcard pattern
+    /// for example. Requirement of #Pattern concept.
+    template <typename S> struct accepted_type_for { typedef S type; };
+
+    bool operator()(const std::string&   s) const { return self().match(s.data(), s.data() + s.size()); }
+    bool operator()(const char*          s) const { return s && self().match(s, s + std::strlen(s)); }
+    bool operator()(const string_view&   s) const { return self().match(s.data(), s.data() + s.size()); }
+    bool operator()(const byte_view&     s) const { return self().match(s.begin(), s.end()); }
+    bool operator()(const std::vector<unsigned char>& s) const { return self().match(s.data(), s.data() + s.size()); }
+
+    const D& self() const noexcept { return static_cast<const D&>(*this); }
+};
+
+//------------------------------------------------------------------------------
+
+/// Pattern matching subjects starting with a given sequence of characters,
+/// whose remainder matches P1
+template <typename P1>
+struct prefix_pattern : buffer_pattern<prefix_pattern<P1>>
+{
+    static_assert(is_pattern<P1>::value, "Argument P1 of a prefix pattern must be a pattern");
+
+    prefix_pattern(const char* s, size_t n, const P1&  p1) noexcept : m_str(s), m_size(n), m_p1(          p1 ) {}
+    prefix_pattern(const char* s, size_t n,       P1&& p1) noexcept : m_str(s), m_size(n), m_p1(std::move(p1)) {}
+
+    template <typename Ch>
+    bool match(const Ch* b, const Ch* e) const
+    {
+        return size_t(e - b) >= m_size 
+            && std::memcmp(b, m_str, m_size) == 0 
+            && m_p1(make_view(b + m_size, e));
+    }
+
+    const char* m_str;  ///< Not owned: usually a string literal
+    size_t      m_size;
+    P1          m_p1;
+};
+
+//------------------------------------------------------------------------------
+
+/// Pattern matching subjects ending with a given sequence of characters,
+/// whose beginning matches P1
+template <typename P1>
+struct suffix_pattern : buffer_pattern<suffix_pattern<P1>>
+{
+    static_assert(is_pattern<P1>::value, "Argument P1 of a suffix pattern must be a pattern");
+
+    suffix_pattern(const char* s, size_t n, const P1&  p1) noexcept : m_str(s), m_size(n), m_p1(          p1 ) {}
+    suffix_pattern(const char* s, size_t n,       P1&& p1) noexcept : m_str(s), m_size(n), m_p1(std::move(p1)) {}
+
+    template <typename Ch>
+    bool match(const Ch* b, const Ch* e) const
+    {
+        return size_t(e - b) >= m_size 
+            && std::memcmp(e - m_size, m_str, m_size) == 0 
+            && m_p1(make_view(b, e - m_size));
+    }
+
+    const char* m_str;  ///< Not owned: usually a string literal
+    size_t      m_size;
+    P1          m_p1;
+};
+
+//------------------------------------------------------------------------------
+
+/// Pattern splitting subjects of at least N elements after the N-th one: the
+/// first N elements have to match P1 and the rest P2
+template <typename P1, typename P2>
+struct field_pattern : buffer_pattern<field_pattern<P1,P2>>
+{
+    static_assert(is_pattern<P1>::value, "Argument P1 of a field pattern must be a pattern");
+    static_assert(is_pattern<P2>::value, "Argument P2 of a field pattern must be a pattern");
+
+    field_pattern(size_t n, const P1&  p1, const P2&  p2) noexcept : m_size(n), m_p1(          p1 ), m_p2(          p2 ) {}
+    field_pattern(size_t n,       P1&& p1,       P2&& p2) noexcept : m_size(n), m_p1(std::move(p1)), m_p2(std::move(p2)) {}
+
+    template <typename Ch>
+    bool match(const Ch* b, const Ch* e) const
+    {
+        return size_t(e - b) >= m_size 
+            && m_p1(make_view(b, b + m_size)) 
+            && m_p2(make_view(b + m_size, e));
+    }
+
+    size_t m_size;
+    P1     m_p1;
+    P2     m_p2;
+};
+
+//------------------------------------------------------------------------------
+
+/// Pattern splitting subjects around the first occurrence of a delimiter: the
+/// elements before it have to match P1 and the elements after it P2
+template <typename P1, typename P2>
+struct split_pattern : buffer_pattern<split_pattern<P1,P2>>
+{
+    static_assert(is_pattern<P1>::value, "Argument P1 of a split pattern must be a pattern");
+    static_assert(is_pattern<P2>::value, "Argument P2 of a split pattern must be a pattern");
+
+    split_pattern(unsigned char d, const P1&  p1, const P2&  p2) noexcept : m_delim(d), m_p1(          p1 ), m_p2(          p2 ) {}
+    split_pattern(unsigned char d,       P1&& p1,       P2&& p2) noexcept : m_delim(d), m_p1(std::move(p1)), m_p2(std::move(p2)) {}
+
+    template <typename Ch>
+    bool match(const Ch* b, const Ch* e) const
+    {
+        if (b == e)
+            return false;
+
+        const Ch* d = static_cast<const Ch*>(std::memchr(b, m_delim, size_t(e - b)));
+        return d && m_p1(make_view(b, d)) && m_p2(make_view(d + 1, e));
+    }
+
+    unsigned char m_delim;
+    P1            m_p1;
+    P2            m_p2;
+};
+
+//------------------------------------------------------------------------------
+
+/// #is_pattern_ is a helper meta-predicate capable of distinguishing all our patterns
+template <typename P1>              struct is_pattern_<prefix_pattern<P1>>   { static const bool value = true; };
+template <typename P1>              struct is_pattern_<suffix_pattern<P1>>   { static const bool value = true; };
+template <typename P1, typename P2> struct is_pattern_<field_pattern<P1,P2>> { static const bool value = true; };
+template <typename P1, typename P2> struct is_pattern_<split_pattern<P1,P2>> { static const bool value = true; };
+
+/// #pattern_cost_ is a helper meta-function estimating the cost of trying a pattern
+template <typename P1>              struct pattern_cost_<prefix_pattern<P1>>   { static const unsigned int value = cost_of_expression + pattern_cost<P1>::value; };
+template <typename P1>              struct pattern_cost_<suffix_pattern<P1>>   { static const unsigned int value = cost_of_expression + pattern_cost<P1>::value; };
+template <typename P1, typename P2> struct pattern_cost_<field_pattern<P1,P2>> { static const unsigned int value = cost_of_value      + pattern_cost<P1>::value + pattern_cost<P2>::value; };
+template <typename P1, typename P2> struct pattern_cost_<split_pattern<P1,P2>> { static const unsigned int value = cost_of_expression + pattern_cost<P1>::value + pattern_cost<P2>::value; };
+
+/// #is_hoistable_ is a helper meta-predicate telling whether a pattern can be constructed once per clause
+template <typename P1>              struct is_hoistable_<prefix_pattern<P1>>   : is_hoistable<P1> {};
+template <typename P1>              struct is_hoistable_<suffix_pattern<P1>>   : is_hoistable<P1> {};
+template <typename P1, typename P2> struct is_hoistable_<field_pattern<P1,P2>> { static const bool value = is_hoistable<P1>::value && is_hoistable<P2>::value; };
+template <typename P1, typename P2> struct is_hoistable_<split_pattern<P1,P2>> { static const bool value = is_hoistable<P1>::value && is_hoistable<P2>::value; };
+
+//------------------------------------------------------------------------------
+
+/// Matches subjects starting with characters s whose remainder matches p1
+template <typename P1>
+inline auto prefix(const char* s, P1&& p1) noexcept 
+        -> prefix_pattern<typename underlying<decltype(filter(std::forward<P1>(p1)))>::type>
+{
+    return prefix_pattern<typename underlying<decltype(filter(std::forward<P1>(p1)))>::type>(s, std::strlen(s), filter(std::forward<P1>(p1)));
+}
+
+/// Matches subjects ending with characters s whose beginning matches p1
+template <typename P1>
+inline auto suffix(const char* s, P1&& p1) noexcept 
+        -> suffix_pattern<typename underlying<decltype(filter(std::forward<P1>(p1)))>::type>
+{
+    return suffix_pattern<typename underlying<decltype(filter(std::forward<P1>(p1)))>::type>(s, std::strlen(s), filter(std::forward<P1>(p1)));
+}
+
+/// Matches subjects whose first n elements match p1 and the rest match p2
+template <typename P1, typename P2>
+inline auto field(size_t n, P1&& p1, P2&& p2) noexcept 
+        -> field_pattern<
+                typename underlying<decltype(filter(std::forward<P1>(p1)))>::type,
+                typename underlying<decltype(filter(std::forward<P2>(p2)))>::type
+           >
+{
+    return field_pattern<
+                typename underlying<decltype(filter(std::forward<P1>(p1)))>::type,
+                typename underlying<decltype(filter(std::forward<P2>(p2)))>::type
+           >(n, filter(std::forward<P1>(p1)), filter(std::forward<P2>(p2)));
+}
+
+/// Matches subjects having delimiter d, elements before whose first occurrence 
+/// match p1 and elements after it match p2
+template <typename P1, typename P2>
+inline auto split(unsigned char d, P1&& p1, P2&& p2) noexcept 
+        -> split_pattern<
+                typename underlying<decltype(filter(std::forward<P1>(p1)))>::type,
+                typename underlying<decltype(filter(std::forward<P2>(p2)))>::type
+           >
+{
+    return split_pattern<
+                typename underlying<decltype(filter(std::forward<P1>(p1)))>::type,
+                typename underlying<decltype(filter(std::forward<P2>(p2)))>::type
+           >(d, filter(std::forward<P1>(p1)), filter(std::forward<P2>(p2)));
+}
+
+//------------------------------------------------------------------------------
+
+} // of namespace mch
+
+//------------------------------------------------------------------------------
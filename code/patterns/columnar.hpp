@@ -0,0 +1,245 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file defines struct-of-arrays storage of records decomposed by their
+/// #bindings and selection of records by constructor patterns evaluated one
+/// column at a time into a bitmap.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#pragma once
+
+#include "constructor.hpp"
+#include "primitive.hpp"
+#include <algorithm>
+#include <bitset>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+// --------------------[ Design Notes ]--------------------
+// - Columns are kept in a chain of base classes, one per member, in the same
+//   way constr_members keeps sub-patterns, so that selection unrolls at compile
+//   time into one loop per column.
+// - Each loop applies a sub-pattern to a contiguous column and ANDs the 
+//   outcomes for 64 records into one word of the bitmap. The loop has no 
+//   early exit and for value patterns compiles into vector comparisons.
+// - Words in which all records have already been refuted are skipped, so 
+//   more selective sub-patterns are better put first.
+// - Wildcards are not evaluated at all.
+// - Sub-patterns are evaluated independently of each other, so a sub-pattern
+//   may not depend on variables bound by another one (e.g. a guard on one 
+//   member comparing it with a variable bound to another member). Variables 
+//   bound by a sub-pattern are left with the value of the last record the
+//   sub-pattern was applied to.
+
+namespace mch ///< Mach7 library namespace
+{
+
+//------------------------------------------------------------------------------
+
+/// Type of values of the I-th member of the decomposition of T with a given layout
+template <typename T, size_t layout, size_t I>
+struct member_type
+{
+    typedef typename std::decay<decltype(apply_member(static_cast<const T*>(0), binding_of<bindings<T,layout>,I>::get()))>::type type;
+};
+
+//------------------------------------------------------------------------------
+
+/// Columns of members I..N-1 of the decomposition of records of type T
+template <typename T, size_t layout, size_t I, size_t N>
+struct column_set : column_set<T,layout,I+1,N>
+{
+    typedef column_set<T,layout,I+1,N>                  rest_type;
+    typedef typename member_type<T,layout,I>::type      value_type;
+
+    void push_back(const T& t)
+    {
+        column.push_back(apply_member(&t, binding_of<bindings<T,layout>,I>::get()));
+        rest_type::push_back(t);
+    }
+
+    void reserve(size_t n) { column.reserve(n); rest_type::reserve(n); }
+    void clear()           { column.clear();    rest_type::clear();    }
+
+    std::vector<value_type> column; ///< Values of the I-th member of all the records
+};
+
+template <typename T, size_t layout, size_t N>
+struct column_set<T,layout,N,N>
+{
+    void push_back(const T&) {}
+    void reserve(size_t)     {}
+    void clear()             {}
+};
+
+//------------------------------------------------------------------------------
+
+/// Struct-of-arrays copy of records of type T, which keeps the first N members
+/// of their decomposition with a given layout in separate columns.
+template <typename T, size_t N, size_t layout = default_layout>
+class columns : column_set<T,layout,0,N>
+{
+public:
+
+    typedef column_set<T,layout,0,N> columns_type;
+
+    columns() : m_size(0) {}
+
+    /// Decomposes records [first,last) into columns
+    template <typename Iterator>
+    columns(Iterator first, Iterator last) : m_size(0)
+    {
+        columns_type::reserve(std::distance(first, last));
+
+        for (; first != last; ++first)
+            push_back(*first);
+    }
+
+    /// Appends a decomposition of t to the columns
+    void push_back(const T& t) { columns_type::push_back(t); ++m_size; }
+
+    /// Removes all records
+    void clear() { columns_type::clear(); m_size = 0; }
+
+    /// Number of records
+    size_t size() const { return m_size; }
+
+    /// Values of the I-th member of all the records
+    template <size_t I>
+    const std::vector<typename member_type<T,layout,I>::type>& column() const
+    {
+        static_assert(I < N, "Only the first N members of the decomposition are kept");
+        return static_cast<const column_set<T,layout,I,N>&>(*this).column;
+    }
+
+    /// Columns the constructor pattern with the given number of sub-patterns would be applied to
+    const columns_type& all() const { return *this; }
+
+private:
+
+    size_t m_size; ///< Number of records
+};
+
+//------------------------------------------------------------------------------
+
+/// Selection bitmap: bit i%64 of word i/64 tells whether record i was selected
+typedef std::vector<std::uint64_t> selection;
+
+/// Checks whether i-th record is selected in a given selection bitmap
+inline bool selected(const selection& s, size_t i) noexcept { return (s[i/64] >> (i%64)) & 1; }
+
+/// Number of records selected in a given selection bitmap
+inline size_t count_selected(const selection& s) noexcept
+{
+    size_t n = 0;
+
+    for (size_t w = 0; w < s.size(); ++w)
+        n += std::bitset<64>(s[w]).count();
+
+    return n;
+}
+
+//------------------------------------------------------------------------------
+
+/// Refutes in bitmap bits those of n values of a column that pattern p rejects
+template <typename P, typename V>
+void select_column(const P& p, const V* values, size_t n, std::uint64_t* bits)
+{
+    for (size_t i = 0; i < n; i += 64, ++bits)
+    {
+        if (!*bits)
+            continue; // All records in this word have already been refuted
+
+        const size_t   m = std::min(n-i, size_t(64));
+        std::uint64_t  r = 0;
+
+        for (size_t j = 0; j < m; ++j)
+            r |= std::uint64_t(bool(p(values[i+j]))) << j;
+
+        *bits &= r;
+    }
+}
+
+/// Wildcard accepts every value, so its column is not even looked at
+template <typename V>
+void select_column(const wildcard&, const V*, size_t, std::uint64_t*) {}
+
+//------------------------------------------------------------------------------
+
+/// Applies sub-patterns of a constructor pattern, starting from the I-th one, to
+/// the corresponding columns
+template <typename T, size_t L, size_t I, size_t N, typename P, typename... Ps>
+void select_columns(const constr_members<I,P,Ps...>& m, const column_set<T,L,I,N>& c, size_t n, std::uint64_t* bits)
+{
+    select_column(m.m_p, c.column.data(), n, bits);
+    select_columns(static_cast<const constr_members<I+1,Ps...>&>(m), static_cast<const column_set<T,L,I+1,N>&>(c), n, bits);
+}
+
+template <typename T, size_t L, size_t I, size_t N>
+void select_columns(const constr_members<I>&, const column_set<T,L,I,N>&, size_t, std::uint64_t*) {}
+
+//------------------------------------------------------------------------------
+
+/// Selects records kept in columns c that match constructor pattern p, which 
+/// is equivalent to applying p to each record, and returns their number. 
+/// Bit i of selection s is set when i-th record matched.
+/// \note Sub-patterns may not depend on variables bound by other sub-patterns,
+///       \see Design Notes above
+template <typename T, size_t L, size_t N, typename P1, typename P2, typename... Ps>
+size_t select(const constrN<T,L,P1,P2,Ps...>& p, const columns<T,N,L>& c, selection& s)
+{
+    static_assert(2 + sizeof...(Ps) <= N, "Pattern refers to members that are not kept in columns");
+
+    const size_t n = c.size();
+
+    s.assign((n + 63) / 64, ~std::uint64_t(0));
+
+    if (n % 64)
+        s.back() = (std::uint64_t(1) << (n % 64)) - 1; // Records past the end are not selected
+
+    select_columns(static_cast<const constr_members<0,P1,P2,Ps...>&>(p), static_cast<const column_set<T,L,0,N>&>(c.all()), n, s.data());
+    return count_selected(s);
+}
+
+//------------------------------------------------------------------------------
+
+} // of namespace mch
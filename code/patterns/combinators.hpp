@@ -90,8 +90,15 @@ struct conjunction
 
     /// We parameterize over accepted type since the actually accepted type is 
     /// a function of the subject type.
+    /// \note With #XTL_REORDER_BY_COST the cheaper of the operands is tried first
     template <typename T>
-    bool operator()(const T& subject) const { return m_p1(subject) && m_p2(subject); }
+    bool operator()(const T& subject) const 
+    {
+        XTL_STATIC_IF(XTL_REORDER_BY_COST && pattern_cost<P2>::value < pattern_cost<P1>::value)
+            return m_p2(subject) && m_p1(subject);
+        else
+            return m_p1(subject) && m_p2(subject);
+    }
 
     P1 m_p1; ///< The 1st pattern in conjunction
     P2 m_p2; ///< The 2nd pattern in conjunction
@@ -100,6 +107,15 @@ struct conjunction
 /// #is_pattern_ is a helper meta-predicate capable of distinguishing all our patterns
 template <typename P1, typename P2> struct is_pattern_<conjunction<P1,P2>> { static const bool value = true /*is_pattern<P1>::value && is_pattern<P2>::value*/; };
 
+/// #pattern_cost_ is a helper meta-function estimating the cost of trying a pattern
+template <typename P1, typename P2> struct pattern_cost_<conjunction<P1,P2>> { static const unsigned int value = pattern_cost<P1>::value + pattern_cost<P2>::value; };
+
+/// #is_hoistable_ is a helper meta-predicate telling whether a pattern can be constructed once per clause
+template <typename P1, typename P2> struct is_hoistable_<conjunction<P1,P2>> { static const bool value = is_hoistable<P1>::value && is_hoistable<P2>::value; };
+
+/// #extractors_might_throw_ is a helper meta-predicate telling whether a pattern might throw from accessors of #bindings
+template <typename P1, typename P2> struct extractors_might_throw_<conjunction<P1,P2>> { static const bool value = extractors_might_throw<P1>::value || extractors_might_throw<P2>::value; };
+
 /// #is_expression_ is a helper meta-predicate that separates lazily evaluatable expressions we support
 template <typename E1, typename E2> struct is_expression_<conjunction<E1,E2>> { static const bool value = is_expression<E1>::value && is_expression<E2>::value; };
 
@@ -141,8 +157,15 @@ struct disjunction
 
     /// We parameterize over accepted type since the actually accepted type is 
     /// a function of the subject type.
+    /// \note With #XTL_REORDER_BY_COST the cheaper of the operands is tried first
     template <typename T>
-    bool operator()(const T& subject) const { return m_p1(subject) || m_p2(subject); }
+    bool operator()(const T& subject) const 
+    {
+        XTL_STATIC_IF(XTL_REORDER_BY_COST && pattern_cost<P2>::value < pattern_cost<P1>::value)
+            return m_p2(subject) || m_p1(subject);
+        else
+            return m_p1(subject) || m_p2(subject);
+    }
 
     P1 m_p1; ///< The 1st pattern of disjunction combinator
     P2 m_p2; ///< The 2nd pattern of disjunction combinator
@@ -151,6 +174,15 @@ struct disjunction
 /// #is_pattern_ is a helper meta-predicate capable of distinguishing all our patterns
 template <typename P1, typename P2> struct is_pattern_<disjunction<P1,P2>> { static const bool value = true /*is_pattern<P1>::value && is_pattern<P2>::value*/; };
 
+/// #pattern_cost_ is a helper meta-function estimating the cost of trying a pattern
+template <typename P1, typename P2> struct pattern_cost_<disjunction<P1,P2>> { static const unsigned int value = pattern_cost<P1>::value + pattern_cost<P2>::value; };
+
+/// #is_hoistable_ is a helper meta-predicate telling whether a pattern can be constructed once per clause
+template <typename P1, typename P2> struct is_hoistable_<disjunction<P1,P2>> { static const bool value = is_hoistable<P1>::value && is_hoistable<P2>::value; };
+
+/// #extractors_might_throw_ is a helper meta-predicate telling whether a pattern might throw from accessors of #bindings
+template <typename P1, typename P2> struct extractors_might_throw_<disjunction<P1,P2>> { static const bool value = extractors_might_throw<P1>::value || extractors_might_throw<P2>::value; };
+
 /// #is_expression_ is a helper meta-predicate that separates lazily evaluatable expressions we support
 template <typename E1, typename E2> struct is_expression_<disjunction<E1,E2>> { static const bool value = is_expression<E1>::value && is_expression<E2>::value; };
 
@@ -186,6 +218,15 @@ struct negation
 /// #is_pattern_ is a helper meta-predicate capable of distinguishing all our patterns
 template <typename P1> struct is_pattern_<negation<P1>> { static const bool value = true /*is_pattern<P1>::value*/; };
 
+/// #pattern_cost_ is a helper meta-function estimating the cost of trying a pattern
+template <typename P1> struct pattern_cost_<negation<P1>> : pattern_cost<P1> {};
+
+/// #is_hoistable_ is a helper meta-predicate telling whether a pattern can be constructed once per clause
+template <typename P1> struct is_hoistable_<negation<P1>> : is_hoistable<P1> {};
+
+/// #extractors_might_throw_ is a helper meta-predicate telling whether a pattern might throw from accessors of #bindings
+template <typename P1> struct extractors_might_throw_<negation<P1>> : extractors_might_throw<P1> {};
+
 /// #is_expression_ is a helper meta-predicate that separates lazily evaluatable expressions we support
 template <typename E1> struct is_expression_<negation<E1>> { static const bool value = is_expression<E1>::value; };
 
@@ -45,6 +45,7 @@
 #pragma once
 
 #include "../metatools.hpp"
+#include <type_traits>
 #include <utility>           // All our patterns define move-constructors and use std::move
 
 namespace mch ///< Mach7 library namespace
@@ -80,6 +81,95 @@ template <typename T> struct is_expression : is_expression_<typename underlying<
 
 //------------------------------------------------------------------------------
 
+/// Estimated costs of trying patterns, in units of a comparison of two scalars
+enum pattern_costs
+{
+    cost_of_wildcard    = 0,   ///< Always matches, nothing to do
+    cost_of_value       = 1,   ///< A comparison or an assignment
+    cost_of_expression  = 2,   ///< An arithmetic followed by a comparison
+    cost_of_unknown     = 4,   ///< Patterns that did not specialize #pattern_cost_
+    cost_of_constructor = 8,   ///< A type test, not counting the sub-patterns
+    cost_of_regex       = 64,  ///< Running a regular expression engine
+    cost_of_uses        = 1024 ///< Patterns using values of variables, which should never be tried before the patterns that may bind them
+};
+
+/// #pattern_cost_ is a helper meta-function estimating the cost of trying a 
+/// pattern, which pattern combinators use under #XTL_REORDER_BY_COST.
+/// Specialize it for the pattern types you define.
+template <typename P> struct pattern_cost_ { static const unsigned int value = cost_of_unknown; };
+
+/// #pattern_cost is a helper meta-function estimating the cost of trying a pattern
+template <typename P> struct pattern_cost : pattern_cost_<typename underlying<P>::type> {};
+
+//------------------------------------------------------------------------------
+
+/// #is_hoistable_ is a helper meta-predicate telling whether a pattern can be
+/// constructed once and reused by every execution of its clause under 
+/// #XTL_HOIST_PATTERNS: it may not refer to anything on the stack and may not
+/// change when matched. Specialize it for the pattern types you define.
+template <typename P> struct is_hoistable_ { static const bool value = false; };
+
+/// #is_hoistable is a helper meta-predicate telling whether a pattern can be
+/// constructed once per clause
+template <typename P> struct is_hoistable : is_hoistable_<typename underlying<P>::type> {};
+
+/// #extractors_might_throw_ is a helper meta-predicate telling whether matching
+/// a pattern applies accessors of #bindings that might throw. Patterns that are
+/// not known to extract nothing are assumed to throw, so that a clause using 
+/// them is guarded under #XTL_EXTRACTORS_MIGHT_THROW. Specialize it for the 
+/// pattern types you define.
+template <typename P> struct extractors_might_throw_ { static const bool value = true; };
+
+/// #extractors_might_throw is a helper meta-predicate telling whether matching
+/// a pattern might throw from accessors of #bindings
+template <typename P> struct extractors_might_throw : extractors_might_throw_<typename underlying<P>::type> {};
+
+/// Returns the pattern made by f, constructing it only the first time for 
+/// patterns that are #is_hoistable. Every clause passes a lambda of its own
+/// type, which gives each clause its own static copy of the pattern.
+template <typename F>
+inline auto hoisted(const F& f) 
+        -> typename std::enable_if<
+                !std::is_reference<decltype(f())>::value && is_hoistable<decltype(f())>::value, 
+                const decltype(f())&
+           >::type
+{
+    static const decltype(f()) pattern = f();
+    return pattern;
+}
+
+/// Patterns that bind variables or refer to other objects are constructed on
+/// each execution, which only copies a few pointers
+template <typename F>
+inline auto hoisted(const F& f) 
+        -> typename std::enable_if<
+                !(!std::is_reference<decltype(f())>::value && is_hoistable<decltype(f())>::value), 
+                decltype(f())
+           >::type
+{
+    return f();
+}
+
+//------------------------------------------------------------------------------
+
+/// #nonnull_application_ is a helper trait applying pattern P to a pointer 
+/// that is known not to be null, e.g. a member declared with #NN. Patterns 
+/// that check their pointer subjects for null specialize it to skip the check.
+template <typename P> struct nonnull_application_
+{
+    template <typename U> static XTL_CONSTEXPR14 bool apply(const P& p, U* u) { return p(u); }
+};
+
+/// #dereferences_ is a helper meta-predicate telling whether a pattern applied
+/// to a pointer loads the object it points to, which makes prefetching of that
+/// object worthwhile. Specialize it for the pattern types you define.
+template <typename P> struct dereferences_ { static const bool value = false; };
+
+/// #dereferences is a helper meta-predicate telling whether a pattern loads the object it is applied to through a pointer
+template <typename P> struct dereferences : dereferences_<typename underlying<P>::type> {};
+
+//------------------------------------------------------------------------------
+
 /// #either_is_expression is a only used to workaround a compiler stack overflow 
 /// problem in MSVC when we were overloading operator||(E1&&,E2&&) and had || in
 /// enabling condition for that overload. Now we use either_is_expression there 
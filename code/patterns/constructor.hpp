@@ -47,12 +47,143 @@
 #include "bindings.hpp"
 #include "primitive.hpp" // FIX: Ideally this should be common.hpp, but GCC seem to disagree: http://gcc.gnu.org/bugzilla/show_bug.cgi?id=55460
 #include <cstddef>
+#include <type_traits>
+
+#if XTL_OVERHEAD_ACCOUNTING
+#include "../overhead.hpp" // Counters of allocations, casts and updates
+#endif
+
+#if XTL_MEMOIZE_NESTED_TYPE_TESTS
+#include "../ptrtools.hpp"
+#include <limits>
+
+#if XTL_MULTI_THREADING && !XTL_SUPPORT(thread_local)
+#error Memoized nested type tests require thread_local under multi-threading
+#endif
+#endif
 
 namespace mch ///< Mach7 library namespace
 {
 
 //------------------------------------------------------------------------------
 
+#if XTL_MEMOIZE_NESTED_TYPE_TESTS
+/// Outcomes of the type tests of constructor patterns with target type T on
+/// subjects of static type U. The outcome only depends on the vtbl-pointer of
+/// the subject, so it is kept in a small direct-mapped table indexed by it,
+/// where a conflict just costs another dynamic_cast. 
+/// \see #XTL_MEMOIZE_NESTED_TYPE_TESTS
+template <typename T, typename U>
+struct type_test_memo
+{
+    static const size_t log_size = 6; ///< Log of the number of entries in the table
+
+    /// Offset marking that the subject cannot be cast to T
+    static std::ptrdiff_t no_cast() noexcept { return std::numeric_limits<std::ptrdiff_t>::min(); }
+
+    static const T* get(const U* u) noexcept
+    {
+        struct entry { std::intptr_t vtbl; std::ptrdiff_t offset; };
+    #if XTL_MULTI_THREADING
+        static thread_local entry table[1 << log_size]; // Zero vtbl-pointer marks empty entries
+    #else
+        static              entry table[1 << log_size]; // Zero vtbl-pointer marks empty entries
+    #endif
+        const std::intptr_t vtbl = vtbl_of(u);
+        entry& e = table[(vtbl >> XTL_IRRELEVANT_VTBL_BITS) & ((1 << log_size) - 1)];
+
+        if (XTL_UNLIKELY(e.vtbl != vtbl))
+        {
+            XTL_OVERHEAD_ACCOUNTING_ONLY(mch::count_type_test_cast<T,U>());
+            const T* t = dynamic_cast<const T*>(u);
+            e.vtbl   = vtbl;
+            e.offset = t ? reinterpret_cast<const char*>(t) - reinterpret_cast<const char*>(u) : no_cast();
+            return t;
+        }
+
+        return e.offset == no_cast() ? 0 : adjust_ptr<T>(u, e.offset);
+    }
+};
+
+/// Type test that can be memoized: a downcast or a cross-cast from a polymorphic type
+template <typename T, typename U>
+inline const T* constructor_cast(const U* u, std::true_type) noexcept { return u ? type_test_memo<T,U>::get(u) : 0; }
+
+/// Type test that does not depend on the dynamic type: an upcast
+template <typename T, typename U>
+inline const T* constructor_cast(const U* u, std::false_type) noexcept { return dynamic_cast<const T*>(u); }
+#endif
+
+/// Type test of a constructor pattern applied to a subject whose static type U
+/// differs from the target type T of the pattern, e.g. because the pattern is
+/// nested in another one. \see #XTL_MEMOIZE_NESTED_TYPE_TESTS
+template <typename T, typename U>
+inline const T* constructor_cast(const U* u) noexcept
+{
+#if XTL_MEMOIZE_NESTED_TYPE_TESTS
+    return constructor_cast<T>(u, std::integral_constant<bool, std::is_polymorphic<U>::value && !std::is_base_of<T,U>::value>());
+#else
+    XTL_OVERHEAD_ACCOUNTING_ONLY(if (u) mch::count_type_test_cast<T,U>());
+    return dynamic_cast<const T*>(u);
+#endif
+}
+
+/// Non-const version of the above
+template <typename T, typename U>
+inline T* constructor_cast(U* u) noexcept { return const_cast<T*>(constructor_cast<T>(static_cast<const U*>(u))); }
+
+//------------------------------------------------------------------------------
+
+/// Access to the I-th member of the decomposition described by bindings B
+/// \note Members beyond XTL_REPEAT limit are not addressable by #Members either
+template <typename B, size_t I> struct binding_of;
+
+#define XTL_BINDING_OF(I,...) template <typename B> struct binding_of<B,I> { static constexpr auto get() noexcept -> decltype(B::member##I()) { return B::member##I(); } };
+XTL_REPEAT(10, XTL_BINDING_OF, dummy)
+#undef  XTL_BINDING_OF
+
+//------------------------------------------------------------------------------
+
+/// Whether the I-th member of the decomposition described by bindings B was
+/// declared with #NN to never be a null pointer
+template <typename B, size_t I, typename Condition = void> struct is_nonnull_member { static const bool value = false; };
+template <typename B, size_t I> struct is_nonnull_member<B,I,typename std::enable_if<((B::nonnull_members >> I) & 1) != 0>::type> { static const bool value = true; };
+
+/// Applies pattern p to the I-th member of *t described by bindings B
+template <typename B, size_t I, typename P, typename U>
+XTL_CONSTEXPR14 bool apply_binding(const P& p, U* t, std::false_type) { return apply_expression(p, t, binding_of<B,I>::get()); }
+
+/// Applies pattern p to the I-th member of *t that is known not to be null
+template <typename B, size_t I, typename P, typename U>
+XTL_CONSTEXPR14 bool apply_binding(const P& p, U* t, std::true_type)  { return nonnull_application_<P>::apply(p, apply_member(t, binding_of<B,I>::get())); }
+
+/// Applies pattern p to the I-th member of *t described by bindings B, skipping
+/// the null checks of p on members declared with #NN. A wildcard still does not
+/// load the member at all.
+template <typename B, size_t I, typename P, typename U>
+XTL_CONSTEXPR14 bool apply_binding(const P& p, U* t)
+{
+    return apply_binding<B,I>(p, t, std::integral_constant<bool, is_nonnull_member<B,I>::value && !std::is_same<P,wildcard>::value>());
+}
+
+/// Whether applying the accessors of members I, I+1, ... of type T described by
+/// bindings B to which sub-patterns Ps are applied, or the extractors of these
+/// sub-patterns, might throw. Members matched against a #wildcard are not loaded.
+template <typename B, typename T, size_t I, typename... Ps> struct members_might_throw : std::false_type {};
+template <typename B, typename T, size_t I, typename P, typename... Ps>
+struct members_might_throw<B,T,I,P,Ps...> : std::integral_constant<bool,
+        (!std::is_same<typename underlying<P>::type,wildcard>::value && !is_nothrow_member<T,decltype(binding_of<B,I>::get())>::value)
+        || extractors_might_throw<P>::value
+        || members_might_throw<B,T,I+1,Ps...>::value> {};
+
+/// Prefetches the object the I-th member of *t points to
+template <typename B, size_t I, typename U>
+XTL_CONSTEXPR14 void prefetch_binding(U*, std::false_type) noexcept {}
+template <typename B, size_t I, typename U>
+inline          void prefetch_binding(U* t, std::true_type) noexcept { XTL_PREFETCH(apply_member(t, binding_of<B,I>::get())); }
+
+//------------------------------------------------------------------------------
+
 /// Constructor/Type pattern of 0 arguments
 template <typename T, size_t layout>
 struct constr0
@@ -72,13 +203,13 @@ struct constr0
     ///  - the arguments passed by reference from those passed by pointers
     ///  - whether the target type matches the subject type (to avoid dynamic_cast)
     ///  - const from non-const arguments to propagate constness further.
-    template <typename U> const T* operator()(const U* u) const noexcept { return dynamic_cast<const T*>(u); }
-    template <typename U>       T* operator()(      U* u) const noexcept { return dynamic_cast<      T*>(u); }
-    template <typename U> const T* operator()(const U& u) const noexcept { return operator()(&u); }
+    template <typename U> XTL_CONSTEXPR14 const T* operator()(const U* u) const noexcept { return constructor_cast<T>(u); }
+    template <typename U>       T* operator()(      U* u) const noexcept { return constructor_cast<T>(u); }
+    template <typename U> XTL_CONSTEXPR14 const T* operator()(const U& u) const noexcept { return operator()(&u); }
     template <typename U>       T* operator()(      U& u) const noexcept { return operator()(&u); }
-                          const T* operator()(const T* t) const noexcept { return t; }
+                          XTL_CONSTEXPR14 const T* operator()(const T* t) const noexcept { return t; }
                                 T* operator()(      T* t) const noexcept { return t; }
-                          const T* operator()(const T& t) const noexcept { return &t; }
+                          XTL_CONSTEXPR14 const T* operator()(const T& t) const noexcept { return &t; }
                                 T* operator()(      T& t) const noexcept { return &t; }
     ///@}
 };
@@ -97,28 +228,28 @@ struct constr1
     /// for example. Requirement of #Pattern concept.
     template <typename S> struct accepted_type_for { typedef T type; };
 
-    explicit constr1(const P1&  p1) noexcept : m_p1(p1)            {}
-    explicit constr1(      P1&& p1) noexcept : m_p1(std::move(p1)) {}
-    constr1(const constr1&  src)    noexcept : m_p1(          src.m_p1 ) {} ///< Copy constructor    
-    constr1(      constr1&& src)    noexcept : m_p1(std::move(src.m_p1)) {} ///< Move constructor
+    constexpr explicit constr1(const P1&  p1) noexcept : m_p1(p1)            {}
+    constexpr explicit constr1(      P1&& p1) noexcept : m_p1(std::move(p1)) {}
+    constexpr constr1(const constr1&  src)    noexcept : m_p1(          src.m_p1 ) {} ///< Copy constructor    
+    constexpr constr1(      constr1&& src)    noexcept : m_p1(std::move(src.m_p1)) {} ///< Move constructor
     constr1& operator=(const constr1&); ///< Assignment is not allowed for this class
 
     /// Helper function that does the actual structural matching once we have
     /// uncovered a value of the target type. Applies to a const argument!
-    const T* match_structure(const T* t) const
+    XTL_CONSTEXPR14 const T* match_structure(const T* t) const
     {
         XTL_ASSERT(t); // This helper function assumes t cannot be a nullptr
-        return apply_expression(m_p1, t, bindings<T,layout>::member0()) // error C2027: use of undefined type 'bindings<type_being_matched,layout>'
+        return apply_binding<bindings<T,layout>,0>(m_p1, t)            // error C2027: use of undefined type 'bindings<type_being_matched,layout>'
                 ? t                                                     // here means you did not provide bindings for type_being_matched and layout
                 : 0;                                                    // described in the details of error message. See #bindings and #CM
                                                                         // error: incomplete type 'bindings<type_being_matched, layout>' used in nested name specifier (see above description for Visual C++)
     }
     /// Helper function that does the actual structural matching once we have
     /// uncovered a value of the target type. Applies to a non-const argument!
-          T* match_structure(      T* t) const
+    XTL_CONSTEXPR14       T* match_structure(      T* t) const
     {
         XTL_ASSERT(t); // This helper function assumes t cannot be a nullptr
-        return apply_expression(m_p1, t, bindings<T,layout>::member0()) // error C2027: use of undefined type 'bindings<type_being_matched,layout>'
+        return apply_binding<bindings<T,layout>,0>(m_p1, t)            // error C2027: use of undefined type 'bindings<type_being_matched,layout>'
                 ? t                                                     // here means you did not provide bindings for type_being_matched and layout
                 : 0;                                                    // described in the details of error message. See #bindings and #CM
                                                                         // error: incomplete type 'bindings<type_being_matched, layout>' used in nested name specifier (see above description for Visual C++)
@@ -133,13 +264,13 @@ struct constr1
     ///  - the arguments passed by reference from those passed by pointers
     ///  - whether the target type matches the subject type (to avoid dynamic_cast)
     ///  - const from non-const arguments to propagate constness further.
-    template <typename U> const T* operator()(const U* u) const { return operator()(dynamic_cast<const T*>(u)); }
-    template <typename U>       T* operator()(      U* u) const { return operator()(dynamic_cast<      T*>(u)); }
-    template <typename U> const T* operator()(const U& u) const { return operator()(&u); }
+    template <typename U> XTL_CONSTEXPR14 const T* operator()(const U* u) const { return operator()(constructor_cast<T>(u)); }
+    template <typename U>       T* operator()(      U* u) const { return operator()(constructor_cast<T>(u)); }
+    template <typename U> XTL_CONSTEXPR14 const T* operator()(const U& u) const { return operator()(&u); }
     template <typename U>       T* operator()(      U& u) const { return operator()(&u); }
-                          const T* operator()(const T* t) const { return t ? match_structure(t) : 0; }
+                          XTL_CONSTEXPR14 const T* operator()(const T* t) const { return t ? match_structure(t) : 0; }
                                 T* operator()(      T* t) const { return t ? match_structure(t) : 0; }
-                          const T* operator()(const T& t) const { return match_structure(&t); } // We assume references to be checked for not nullptr
+                          XTL_CONSTEXPR14 const T* operator()(const T& t) const { return match_structure(&t); } // We assume references to be checked for not nullptr
                                 T* operator()(      T& t) const { return match_structure(&t); } // and don't check it here to save on performance
     ///@}
 
@@ -172,22 +303,22 @@ struct constr1<T,layout,P1,typename std::enable_if<std::is_same<T,typename P1::t
     /// for example. Requirement of #Pattern concept.
     template <typename S> struct accepted_type_for { typedef T type; };
 
-    explicit constr1(const P1&  p1) noexcept : m_p1(p1)            {}
-    explicit constr1(      P1&& p1) noexcept : m_p1(std::move(p1)) {}
-    constr1(const constr1&  src)    noexcept : m_p1(          src.m_p1 ) {} ///< Copy constructor    
-    constr1(      constr1&& src)    noexcept : m_p1(std::move(src.m_p1)) {} ///< Move constructor
+    constexpr explicit constr1(const P1&  p1) noexcept : m_p1(p1)            {}
+    constexpr explicit constr1(      P1&& p1) noexcept : m_p1(std::move(p1)) {}
+    constexpr constr1(const constr1&  src)    noexcept : m_p1(          src.m_p1 ) {} ///< Copy constructor    
+    constexpr constr1(      constr1&& src)    noexcept : m_p1(std::move(src.m_p1)) {} ///< Move constructor
     constr1& operator=(const constr1&); ///< Assignment is not allowed for this class
 
     /// Helper function that does the actual structural matching once we have
     /// uncovered a value of the target type. Applies to a const argument!
-    const T* match_structure(const T* t) const
+    XTL_CONSTEXPR14 const T* match_structure(const T* t) const
     {
         XTL_ASSERT(t); // This helper function assumes t cannot be a nullptr
         return m_p1(*t) ? t : 0;
     }
     /// Helper function that does the actual structural matching once we have
     /// uncovered a value of the target type. Applies to a non-const argument!
-          T* match_structure(      T* t) const
+    XTL_CONSTEXPR14       T* match_structure(      T* t) const
     {
         XTL_ASSERT(t); // This helper function assumes t cannot be a nullptr
         return m_p1(*t) ? t : 0;
@@ -202,171 +333,80 @@ struct constr1<T,layout,P1,typename std::enable_if<std::is_same<T,typename P1::t
     ///  - the arguments passed by reference from those passed by pointers
     ///  - whether the target type matches the subject type (to avoid dynamic_cast)
     ///  - const from non-const arguments to propagate constness further.
-    template <typename U> const T* operator()(const U* u) const { return operator()(dynamic_cast<const T*>(u)); }
-    template <typename U>       T* operator()(      U* u) const { return operator()(dynamic_cast<      T*>(u)); }
-    template <typename U> const T* operator()(const U& u) const { return operator()(&u); }
+    template <typename U> XTL_CONSTEXPR14 const T* operator()(const U* u) const { return operator()(constructor_cast<T>(u)); }
+    template <typename U>       T* operator()(      U* u) const { return operator()(constructor_cast<T>(u)); }
+    template <typename U> XTL_CONSTEXPR14 const T* operator()(const U& u) const { return operator()(&u); }
     template <typename U>       T* operator()(      U& u) const { return operator()(&u); }
-                          const T* operator()(const T* t) const { return t ? match_structure(t) : 0; }
+                          XTL_CONSTEXPR14 const T* operator()(const T* t) const { return t ? match_structure(t) : 0; }
                                 T* operator()(      T* t) const { return t ? match_structure(t) : 0; }
-                          const T* operator()(const T& t) const { return match_structure(&t); } // We assume references to be checked for not nullptr
+                          XTL_CONSTEXPR14 const T* operator()(const T& t) const { return match_structure(&t); } // We assume references to be checked for not nullptr
                                 T* operator()(      T& t) const { return match_structure(&t); } // and don't check it here to save on performance
     ///@}
 
     P1 m_p1; ///< Pattern representing 1st operand
 };
 
+
 //------------------------------------------------------------------------------
 
-/// Constructor/Type pattern of 2 arguments
-template <typename T, size_t layout, typename P1, typename P2>
-struct constr2
+/// Sub-patterns of a constructor pattern starting from the one applied to the
+/// I-th member of the target type. Each sub-pattern is kept in its own base
+/// class, so that matching unrolls at compile time into a chain of &&.
+template <size_t I, typename... Ps>
+struct constr_members
 {
-    static_assert(is_pattern<P1>::value, "Argument P1 of constructor-pattern must be a pattern");
-    static_assert(is_pattern<P2>::value, "Argument P2 of constructor-pattern must be a pattern");
-
-    /// Type function returning a type that will be accepted by the pattern for
-    /// a given subject type S. We use type function instead of an associated 
-    /// type, because there is no a single accepted type for a #wildcard pattern
-    /// for example. Requirement of #Pattern concept.
-    template <typename S> struct accepted_type_for { typedef T type; };
+    static const unsigned int cost      = 0;    ///< Combined cost of the sub-patterns
+    static const bool         hoistable = true; ///< Whether all the sub-patterns are hoistable
 
-    constr2(const P1&  p1, const P2&  p2) noexcept : m_p1(          p1 ), m_p2(          p2 ) {}
-    constr2(      P1&& p1, const P2&  p2) noexcept : m_p1(std::move(p1)), m_p2(          p2 ) {}
-    constr2(const P1&  p1,       P2&& p2) noexcept : m_p1(          p1 ), m_p2(std::move(p2)) {}
-    constr2(      P1&& p1,       P2&& p2) noexcept : m_p1(std::move(p1)), m_p2(std::move(p2)) {}
-    constr2(const constr2&  src) noexcept : m_p1(          src.m_p1 ), m_p2(          src.m_p2 ) {} ///< Copy constructor    
-    constr2(      constr2&& src) noexcept : m_p1(std::move(src.m_p1)), m_p2(std::move(src.m_p2)) {} ///< Move constructor
-    constr2& operator=(const constr2&); ///< Assignment is not allowed for this class
+    constexpr constr_members() noexcept {}
 
-    /// Helper function that does the actual structural matching once we have
-    /// uncovered a value of the target type. Applies to a const argument!
-    const T* match_structure(const T* t) const
-    {
-        XTL_ASSERT(t); // This helper function assumes t cannot be a nullptr
-        return apply_expression(m_p1, t, bindings<T,layout>::member0()) // error C2027: use of undefined type 'bindings<type_being_matched,layout>'
-            && apply_expression(m_p2, t, bindings<T,layout>::member1()) // here means you did not provide bindings for type_being_matched and layout
-             ? t                                                        // described in the details of error message. See #bindings and #CM
-             : 0;                                                       // error: incomplete type 'bindings<type_being_matched, layout>' used in nested name specifier (see above description for Visual C++)
-    }
-    /// Helper function that does the actual structural matching once we have
-    /// uncovered a value of the target type. Applies to a non-const argument!
-          T* match_structure(      T* t) const
-    {
-        XTL_ASSERT(t); // This helper function assumes t cannot be a nullptr
-        return apply_expression(m_p1, t, bindings<T,layout>::member0()) // error C2027: use of undefined type 'bindings<type_being_matched,layout>'
-            && apply_expression(m_p2, t, bindings<T,layout>::member1()) // here means you did not provide bindings for type_being_matched and layout
-             ? t                                                        // described in the details of error message. See #bindings and #CM
-             : 0;                                                       // error: incomplete type 'bindings<type_being_matched, layout>' used in nested name specifier (see above description for Visual C++)
-    }
-
-    ///@{
-    /// Constructor patterns can be uniformly matched against pointers and 
-    /// references to polymorphic objects. This uniformity is needed for 
-    /// composability of constructor patterns, since application operators
-    /// return a pointer to indicate whether pattern was accepted or refuted.
-    /// The following set of application operators distinguishes:
-    ///  - the arguments passed by reference from those passed by pointers
-    ///  - whether the target type matches the subject type (to avoid dynamic_cast)
-    ///  - const from non-const arguments to propagate constness further.
-    template <typename U> const T* operator()(const U* u) const { return operator()(dynamic_cast<const T*>(u)); }
-    template <typename U>       T* operator()(      U* u) const { return operator()(dynamic_cast<      T*>(u)); }
-    template <typename U> const T* operator()(const U& u) const { return operator()(&u); }
-    template <typename U>       T* operator()(      U& u) const { return operator()(&u); }
-                          const T* operator()(const T* t) const { return t ? match_structure(t) : 0; }
-                                T* operator()(      T* t) const { return t ? match_structure(t) : 0; }
-                          const T* operator()(const T& t) const { return match_structure(&t); } // We assume references to be checked for not nullptr
-                                T* operator()(      T& t) const { return match_structure(&t); } // and don't check it here to save on performance
-    ///@}
+    template <typename B, typename U>
+    constexpr bool match_members(U*) const noexcept { return true; }
 
-    P1 m_p1; ///< Pattern representing 1st operand
-    P2 m_p2; ///< Pattern representing 2nd operand
+    template <typename B, typename U>
+    XTL_CONSTEXPR14 void prefetch_members(U*) const noexcept {}
 };
 
-//------------------------------------------------------------------------------
-
-/// Constructor/Type pattern of 3 arguments
-template <typename T, size_t layout, typename P1, typename P2, typename P3>
-struct constr3
+template <size_t I, typename P, typename... Ps>
+struct constr_members<I,P,Ps...> : constr_members<I+1,Ps...>
 {
-    static_assert(is_pattern<P1>::value, "Argument P1 of constructor-pattern must be a pattern");
-    static_assert(is_pattern<P2>::value, "Argument P2 of constructor-pattern must be a pattern");
-    static_assert(is_pattern<P3>::value, "Argument P3 of constructor-pattern must be a pattern");
+    static_assert(is_pattern<P>::value, "Arguments of constructor-pattern must be patterns");
 
-    /// Type function returning a type that will be accepted by the pattern for
-    /// a given subject type S. We use type function instead of an associated 
-    /// type, because there is no a single accepted type for a #wildcard pattern
-    /// for example. Requirement of #Pattern concept.
-    template <typename S> struct accepted_type_for { typedef T type; };
+    typedef constr_members<I+1,Ps...> rest_type;
 
-    constr3(const P1&  p1, const P2&  p2, const P3&  p3) noexcept : m_p1(          p1 ), m_p2(          p2 ), m_p3(          p3 ) {}
-    constr3(      P1&& p1, const P2&  p2, const P3&  p3) noexcept : m_p1(std::move(p1)), m_p2(          p2 ), m_p3(          p3 ) {}
-    constr3(const P1&  p1,       P2&& p2, const P3&  p3) noexcept : m_p1(          p1 ), m_p2(std::move(p2)), m_p3(          p3 ) {}
-    constr3(      P1&& p1,       P2&& p2, const P3&  p3) noexcept : m_p1(std::move(p1)), m_p2(std::move(p2)), m_p3(          p3 ) {}
-    constr3(const P1&  p1, const P2&  p2,       P3&& p3) noexcept : m_p1(          p1 ), m_p2(          p2 ), m_p3(std::move(p3)) {}
-    constr3(      P1&& p1, const P2&  p2,       P3&& p3) noexcept : m_p1(std::move(p1)), m_p2(          p2 ), m_p3(std::move(p3)) {}
-    constr3(const P1&  p1,       P2&& p2,       P3&& p3) noexcept : m_p1(          p1 ), m_p2(std::move(p2)), m_p3(std::move(p3)) {}
-    constr3(      P1&& p1,       P2&& p2,       P3&& p3) noexcept : m_p1(std::move(p1)), m_p2(std::move(p2)), m_p3(std::move(p3)) {}
-    constr3(const constr3&  src) noexcept : m_p1(          src.m_p1 ), m_p2(          src.m_p2 ), m_p3(          src.m_p3 ) {} ///< Copy constructor    
-    constr3(      constr3&& src) noexcept : m_p1(std::move(src.m_p1)), m_p2(std::move(src.m_p2)), m_p3(std::move(src.m_p3)) {} ///< Move constructor
-    constr3& operator=(const constr3&); ///< Assignment is not allowed for this class
+    static const unsigned int cost      = pattern_cost<P>::value + rest_type::cost;
+    static const bool         hoistable = is_hoistable<P>::value && rest_type::hoistable;
 
-    /// Helper function that does the actual structural matching once we have
-    /// uncovered a value of the target type. Applies to a const argument!
-    const T* match_structure(const T* t) const
+    template <typename Q, typename... Qs>
+    constexpr constr_members(Q&& q, Qs&&... qs) noexcept : rest_type(std::forward<Qs>(qs)...), m_p(std::forward<Q>(q)) {}
+
+    /// Applies sub-patterns to the members of *t described by bindings B
+    template <typename B, typename U>
+    XTL_CONSTEXPR14 bool match_members(U* t) const
     {
-        XTL_ASSERT(t); // This helper function assumes t cannot be a nullptr
-        return apply_expression(m_p1, t, bindings<T,layout>::member0()) // error C2027: use of undefined type 'bindings<type_being_matched,layout>'
-            && apply_expression(m_p2, t, bindings<T,layout>::member1()) // here means you did not provide bindings for type_being_matched and layout
-            && apply_expression(m_p3, t, bindings<T,layout>::member2()) // described in the details of error message. See #bindings and #CM
-             ? t                                                        // error: incomplete type 'bindings<type_being_matched, layout>' used in nested name specifier (see above description for Visual C++)
-             : 0;
+        return apply_binding<B,I>(m_p, t)                        // error: incomplete type 'bindings<type_being_matched, layout>' or 'binding_of<...>'
+            && rest_type::template match_members<B>(t);          // here means you did not provide bindings for type_being_matched and layout. See #bindings and #CM
     }
-    /// Helper function that does the actual structural matching once we have
-    /// uncovered a value of the target type. Applies to a non-const argument!
-          T* match_structure(      T* t) const
+
+    /// Prefetches objects pointed to by members of *t declared with #NN, which
+    /// the sub-patterns will dereference
+    template <typename B, typename U>
+    XTL_CONSTEXPR14 void prefetch_members(U* t) const noexcept
     {
-        XTL_ASSERT(t); // This helper function assumes t cannot be a nullptr
-        return apply_expression(m_p1, t, bindings<T,layout>::member0()) // error C2027: use of undefined type 'bindings<type_being_matched,layout>'
-            && apply_expression(m_p2, t, bindings<T,layout>::member1()) // here means you did not provide bindings for type_being_matched and layout
-            && apply_expression(m_p3, t, bindings<T,layout>::member2()) // described in the details of error message. See #bindings and #CM
-             ? t                                                        // error: incomplete type 'bindings<type_being_matched, layout>' used in nested name specifier (see above description for Visual C++)
-             : 0;
+        prefetch_binding<B,I>(t, std::integral_constant<bool, is_nonnull_member<B,I>::value && dereferences<P>::value>());
+        rest_type::template prefetch_members<B>(t);
     }
 
-    ///@{
-    /// Constructor patterns can be uniformly matched against pointers and 
-    /// references to polymorphic objects. This uniformity is needed for 
-    /// composability of constructor patterns, since application operators
-    /// return a pointer to indicate whether pattern was accepted or refuted.
-    /// The following set of application operators distinguishes:
-    ///  - the arguments passed by reference from those passed by pointers
-    ///  - whether the target type matches the subject type (to avoid dynamic_cast)
-    ///  - const from non-const arguments to propagate constness further.
-    template <typename U> const T* operator()(const U* u) const { return operator()(dynamic_cast<const T*>(u)); }
-    template <typename U>       T* operator()(      U* u) const { return operator()(dynamic_cast<      T*>(u)); }
-    template <typename U> const T* operator()(const U& u) const { return operator()(&u); }
-    template <typename U>       T* operator()(      U& u) const { return operator()(&u); }
-                          const T* operator()(const T* t) const { return t ? match_structure(t) : 0; }
-                                T* operator()(      T* t) const { return t ? match_structure(t) : 0; }
-                          const T* operator()(const T& t) const { return match_structure(&t); } // We assume references to be checked for not nullptr
-                                T* operator()(      T& t) const { return match_structure(&t); } // and don't check it here to save on performance
-    ///@}
-
-    P1 m_p1; ///< Pattern representing 1st operand
-    P2 m_p2; ///< Pattern representing 2nd operand
-    P3 m_p3; ///< Pattern representing 3rd operand
+    P m_p; ///< Pattern representing I-th operand
 };
 
 //------------------------------------------------------------------------------
 
-/// Constructor/Type pattern of 4 arguments
-template <typename T, size_t layout, typename P1, typename P2, typename P3, typename P4>
-struct constr4
+/// Constructor/Type pattern of 2 or more arguments
+template <typename T, size_t layout, typename P1, typename P2, typename... Ps>
+struct constrN : constr_members<0,P1,P2,Ps...>
 {
-    static_assert(is_pattern<P1>::value, "Argument P1 of constructor-pattern must be a pattern");
-    static_assert(is_pattern<P2>::value, "Argument P2 of constructor-pattern must be a pattern");
-    static_assert(is_pattern<P3>::value, "Argument P3 of constructor-pattern must be a pattern");
-    static_assert(is_pattern<P4>::value, "Argument P4 of constructor-pattern must be a pattern");
+    typedef constr_members<0,P1,P2,Ps...> members_type;
 
     /// Type function returning a type that will be accepted by the pattern for
     /// a given subject type S. We use type function instead of an associated 
@@ -374,49 +414,29 @@ struct constr4
     /// for example. Requirement of #Pattern concept.
     template <typename S> struct accepted_type_for { typedef T type; };
 
-    constr4(const P1&  p1, const P2&  p2, const P3&  p3, const P4&  p4) noexcept : m_p1(          p1 ), m_p2(          p2 ), m_p3(          p3 ), m_p4(          p4 ) {}
-    constr4(      P1&& p1, const P2&  p2, const P3&  p3, const P4&  p4) noexcept : m_p1(std::move(p1)), m_p2(          p2 ), m_p3(          p3 ), m_p4(          p4 ) {}
-    constr4(const P1&  p1,       P2&& p2, const P3&  p3, const P4&  p4) noexcept : m_p1(          p1 ), m_p2(std::move(p2)), m_p3(          p3 ), m_p4(          p4 ) {}
-    constr4(      P1&& p1,       P2&& p2, const P3&  p3, const P4&  p4) noexcept : m_p1(std::move(p1)), m_p2(std::move(p2)), m_p3(          p3 ), m_p4(          p4 ) {}
-    constr4(const P1&  p1, const P2&  p2,       P3&& p3, const P4&  p4) noexcept : m_p1(          p1 ), m_p2(          p2 ), m_p3(std::move(p3)), m_p4(          p4 ) {}
-    constr4(      P1&& p1, const P2&  p2,       P3&& p3, const P4&  p4) noexcept : m_p1(std::move(p1)), m_p2(          p2 ), m_p3(std::move(p3)), m_p4(          p4 ) {}
-    constr4(const P1&  p1,       P2&& p2,       P3&& p3, const P4&  p4) noexcept : m_p1(          p1 ), m_p2(std::move(p2)), m_p3(std::move(p3)), m_p4(          p4 ) {}
-    constr4(      P1&& p1,       P2&& p2,       P3&& p3, const P4&  p4) noexcept : m_p1(std::move(p1)), m_p2(std::move(p2)), m_p3(std::move(p3)), m_p4(          p4 ) {}
-    constr4(const P1&  p1, const P2&  p2, const P3&  p3,       P4&& p4) noexcept : m_p1(          p1 ), m_p2(          p2 ), m_p3(          p3 ), m_p4(std::move(p4)) {}
-    constr4(      P1&& p1, const P2&  p2, const P3&  p3,       P4&& p4) noexcept : m_p1(std::move(p1)), m_p2(          p2 ), m_p3(          p3 ), m_p4(std::move(p4)) {}
-    constr4(const P1&  p1,       P2&& p2, const P3&  p3,       P4&& p4) noexcept : m_p1(          p1 ), m_p2(std::move(p2)), m_p3(          p3 ), m_p4(std::move(p4)) {}
-    constr4(      P1&& p1,       P2&& p2, const P3&  p3,       P4&& p4) noexcept : m_p1(std::move(p1)), m_p2(std::move(p2)), m_p3(          p3 ), m_p4(std::move(p4)) {}
-    constr4(const P1&  p1, const P2&  p2,       P3&& p3,       P4&& p4) noexcept : m_p1(          p1 ), m_p2(          p2 ), m_p3(std::move(p3)), m_p4(std::move(p4)) {}
-    constr4(      P1&& p1, const P2&  p2,       P3&& p3,       P4&& p4) noexcept : m_p1(std::move(p1)), m_p2(          p2 ), m_p3(std::move(p3)), m_p4(std::move(p4)) {}
-    constr4(const P1&  p1,       P2&& p2,       P3&& p3,       P4&& p4) noexcept : m_p1(          p1 ), m_p2(std::move(p2)), m_p3(std::move(p3)), m_p4(std::move(p4)) {}
-    constr4(      P1&& p1,       P2&& p2,       P3&& p3,       P4&& p4) noexcept : m_p1(std::move(p1)), m_p2(std::move(p2)), m_p3(std::move(p3)), m_p4(std::move(p4)) {}
-    constr4(const constr4&  src) noexcept : m_p1(          src.m_p1 ), m_p2(          src.m_p2 ), m_p3(          src.m_p3 ), m_p4(          src.m_p4 ) {} ///< Copy constructor    
-    constr4(      constr4&& src) noexcept : m_p1(std::move(src.m_p1)), m_p2(std::move(src.m_p2)), m_p3(std::move(src.m_p3)), m_p4(std::move(src.m_p4)) {} ///< Move constructor
-    constr4& operator=(const constr4&); ///< Assignment is not allowed for this class
+    /// Takes 2 or more arguments, so unlike a single-argument variadic
+    /// constructor this one never hides copy and move constructors.
+    template <typename Q1, typename Q2, typename... Qs>
+    constexpr constrN(Q1&& q1, Q2&& q2, Qs&&... qs) noexcept : members_type(std::forward<Q1>(q1), std::forward<Q2>(q2), std::forward<Qs>(qs)...) {}
+    constexpr constrN(const constrN&  src) noexcept : members_type(static_cast<const members_type&>(src)) {} ///< Copy constructor
+    constexpr constrN(      constrN&& src) noexcept : members_type(static_cast<members_type&&>(src))      {} ///< Move constructor
+    constrN& operator=(const constrN&); ///< Assignment is not allowed for this class
 
     /// Helper function that does the actual structural matching once we have
     /// uncovered a value of the target type. Applies to a const argument!
-    const T* match_structure(const T* t) const
+    XTL_CONSTEXPR14 const T* match_structure(const T* t) const
     {
         XTL_ASSERT(t); // This helper function assumes t cannot be a nullptr
-        return apply_expression(m_p1, t, bindings<T,layout>::member0()) // error C2027: use of undefined type 'bindings<type_being_matched,layout>'
-            && apply_expression(m_p2, t, bindings<T,layout>::member1()) // here means you did not provide bindings for type_being_matched and layout
-            && apply_expression(m_p3, t, bindings<T,layout>::member2()) // described in the details of error message. See #bindings and #CM
-            && apply_expression(m_p4, t, bindings<T,layout>::member3()) // error: incomplete type 'bindings<type_being_matched, layout>' used in nested name specifier (see above description for Visual C++)
-             ? t
-             : 0;
+        XTL_PREFETCH_NONNULL_MEMBERS_ONLY(members_type::template prefetch_members<bindings<T,layout>>(t);)
+        return members_type::template match_members<bindings<T,layout>>(t) ? t : 0;
     }
     /// Helper function that does the actual structural matching once we have
     /// uncovered a value of the target type. Applies to a non-const argument!
-          T* match_structure(      T* t) const
+    XTL_CONSTEXPR14       T* match_structure(      T* t) const
     {
         XTL_ASSERT(t); // This helper function assumes t cannot be a nullptr
-        return apply_expression(m_p1, t, bindings<T,layout>::member0()) // error C2027: use of undefined type 'bindings<type_being_matched,layout>'
-            && apply_expression(m_p2, t, bindings<T,layout>::member1()) // here means you did not provide bindings for type_being_matched and layout
-            && apply_expression(m_p3, t, bindings<T,layout>::member2()) // described in the details of error message. See #bindings and #CM
-            && apply_expression(m_p4, t, bindings<T,layout>::member3()) // error: incomplete type 'bindings<type_being_matched, layout>' used in nested name specifier (see above description for Visual C++)
-             ? t
-             : 0;
+        XTL_PREFETCH_NONNULL_MEMBERS_ONLY(members_type::template prefetch_members<bindings<T,layout>>(t);)
+        return members_type::template match_members<bindings<T,layout>>(t) ? t : 0;
     }
 
     ///@{
@@ -428,20 +448,15 @@ struct constr4
     ///  - the arguments passed by reference from those passed by pointers
     ///  - whether the target type matches the subject type (to avoid dynamic_cast)
     ///  - const from non-const arguments to propagate constness further.
-    template <typename U> const T* operator()(const U* u) const { return operator()(dynamic_cast<const T*>(u)); }
-    template <typename U>       T* operator()(      U* u) const { return operator()(dynamic_cast<      T*>(u)); }
-    template <typename U> const T* operator()(const U& u) const { return operator()(&u); }
+    template <typename U> XTL_CONSTEXPR14 const T* operator()(const U* u) const { return operator()(constructor_cast<T>(u)); }
+    template <typename U>       T* operator()(      U* u) const { return operator()(constructor_cast<T>(u)); }
+    template <typename U> XTL_CONSTEXPR14 const T* operator()(const U& u) const { return operator()(&u); }
     template <typename U>       T* operator()(      U& u) const { return operator()(&u); }
-                          const T* operator()(const T* t) const { return t ? match_structure(t) : 0; }
+                          XTL_CONSTEXPR14 const T* operator()(const T* t) const { return t ? match_structure(t) : 0; }
                                 T* operator()(      T* t) const { return t ? match_structure(t) : 0; }
-                          const T* operator()(const T& t) const { return match_structure(&t); } // We assume references to be checked for not nullptr
+                          XTL_CONSTEXPR14 const T* operator()(const T& t) const { return match_structure(&t); } // We assume references to be checked for not nullptr
                                 T* operator()(      T& t) const { return match_structure(&t); } // and don't check it here to save on performance
     ///@}
-
-    P1 m_p1; ///< Pattern representing 1st operand
-    P2 m_p2; ///< Pattern representing 2nd operand
-    P3 m_p3; ///< Pattern representing 3rd operand
-    P4 m_p4; ///< Pattern representing 4th operand
 };
 
 //------------------------------------------------------------------------------
@@ -451,7 +466,7 @@ struct constr4
 /// #ref and constants into #value.
 /// \note This version will be called from #cons with a non-#view target type
 template <typename T, size_t layout>
-inline constr0<T,layout> cons_ex(const view<T,layout>&) noexcept
+XTL_CONSTEXPR14 constr0<T,layout> cons_ex(const view<T,layout>&) noexcept
 {
     return constr0<T,layout>();
 }
@@ -461,7 +476,7 @@ inline constr0<T,layout> cons_ex(const view<T,layout>&) noexcept
 /// #ref and constants into #value.
 /// \note This version will be called from #cons that had its target type a #view
 template <typename T, size_t layout>
-inline constr0<T,layout> cons_ex(const view<view<T,layout>>&) noexcept
+XTL_CONSTEXPR14 constr0<T,layout> cons_ex(const view<view<T,layout>>&) noexcept
 {
     return constr0<T,layout>();
 }
@@ -469,7 +484,7 @@ inline constr0<T,layout> cons_ex(const view<view<T,layout>>&) noexcept
 /// A 0-argument version of a tree-pattern constructor. Target type is allowed
 /// to be a #view here.
 template <typename T>
-inline auto C() noexcept -> XTL_RETURN(cons_ex(view<T>()))
+XTL_CONSTEXPR14 auto C() noexcept -> XTL_RETURN(cons_ex(view<T>()))
 
 /// A 0-argument version of a tree-pattern constructor that takes layout in
 /// addition to the target type.
@@ -478,7 +493,7 @@ inline auto C() noexcept -> XTL_RETURN(cons_ex(view<T>()))
 ///       layouts. Any layout different from #default_layout passed here will
 ///       result in a compile time error.
 template <typename T, size_t layout>
-inline auto C() noexcept -> XTL_RETURN(cons_ex(view<T,layout>()))
+XTL_CONSTEXPR14 auto C() noexcept -> XTL_RETURN(cons_ex(view<T,layout>()))
 
 //------------------------------------------------------------------------------
 
@@ -487,7 +502,7 @@ inline auto C() noexcept -> XTL_RETURN(cons_ex(view<T,layout>()))
 /// #ref and constants into #value.
 /// \note This version will be called from #cons with a non-#view target type
 template <typename T, size_t layout, typename P1>
-inline constr1<T,layout,
+XTL_CONSTEXPR14 constr1<T,layout,
             typename underlying<P1>::type
        > 
 cons_ex(const view<T,layout>&, P1&& p1) noexcept
@@ -504,7 +519,7 @@ cons_ex(const view<T,layout>&, P1&& p1) noexcept
 /// #ref and constants into #value.
 /// \note This version will be called from #cons that had its target type a #view
 template <typename T, size_t layout, typename P1>
-inline constr1<T,layout,
+XTL_CONSTEXPR14 constr1<T,layout,
             typename underlying<P1>::type
        > 
 cons_ex(const view<view<T,layout>>&, P1&& p1) noexcept
@@ -519,7 +534,7 @@ cons_ex(const view<view<T,layout>>&, P1&& p1) noexcept
 /// A 1-argument version of a tree-pattern constructor. Target type is allowed
 /// to be a #view here.
 template <typename T, typename P1>
-inline auto C(P1&& p1) noexcept -> XTL_RETURN
+XTL_CONSTEXPR14 auto C(P1&& p1) noexcept -> XTL_RETURN
 (
     cons_ex(
         view<T>(),
@@ -534,7 +549,7 @@ inline auto C(P1&& p1) noexcept -> XTL_RETURN
 ///       layouts. Any layout different from #default_layout passed here will
 ///       result in a compile time error.
 template <typename T, size_t layout, typename P1>
-inline auto C(P1&& p1) noexcept -> XTL_RETURN
+XTL_CONSTEXPR14 auto C(P1&& p1) noexcept -> XTL_RETURN
 (
     cons_ex(
         view<T,layout>(),
@@ -544,246 +559,146 @@ inline auto C(P1&& p1) noexcept -> XTL_RETURN
 
 //------------------------------------------------------------------------------
 
-/// 2-argument version of a helper function to #cons that accepts arguments that
-/// have been already preprocessed with #filter to convert regular variables into
-/// #ref and constants into #value.
+/// N-argument version of a helper function to #cons for N >= 2 that accepts
+/// arguments that have been already preprocessed with #filter to convert 
+/// regular variables into #ref and constants into #value.
 /// \note This version will be called from #cons with a non-#view target type
-template <typename T, size_t layout, typename P1, typename P2>
-inline constr2<T,layout,
-            typename underlying<P1>::type,
-            typename underlying<P2>::type
-       > 
-cons_ex(const view<T,layout>&, P1&& p1, P2&& p2) noexcept
-{
-    return constr2<T,layout,
-            typename underlying<P1>::type,
-            typename underlying<P2>::type
-           >(
-            std::forward<P1>(p1),
-            std::forward<P2>(p2)
-           );
-}
-
-/// 2-argument version of a helper function to #cons that accepts arguments that
-/// have been already preprocessed with #filter to convert regular variables into
-/// #ref and constants into #value.
-/// \note This version will be called from #cons that had its target type a #view
-template <typename T, size_t layout, typename P1, typename P2>
-inline constr2<T,layout,
-            typename underlying<P1>::type,
-            typename underlying<P2>::type
-       > 
-cons_ex(const view<view<T,layout>>&, P1&& p1, P2&& p2) noexcept
-{
-    return constr2<T,layout,
-            typename underlying<P1>::type,
-            typename underlying<P2>::type
-           >(
-            std::forward<P1>(p1),
-            std::forward<P2>(p2)
-           );
-}
-
-/// A 2-argument version of a tree-pattern constructor. Target type is allowed
-/// to be a #view here.
-template <typename T, typename P1, typename P2>
-inline auto C(P1&& p1, P2&& p2) noexcept -> XTL_RETURN
-(
-    cons_ex(
-        view<T>(),
-        filter(std::forward<P1>(p1)),
-        filter(std::forward<P2>(p2))
-    )
-)
-
-/// A 2-argument version of a tree-pattern constructor that takes layout in
-/// addition to the target type.
-/// \note #view is not supposed to be passed as a target type to this version
-///       of the function because we will then have two potentially conflicting
-///       layouts. Any layout different from #default_layout passed here will
-///       result in a compile time error.
-template <typename T, size_t layout, typename P1, typename P2>
-inline auto C(P1&& p1, P2&& p2) noexcept -> XTL_RETURN
-(
-    cons_ex(
-        view<T,layout>(),
-        filter(std::forward<P1>(p1)),
-        filter(std::forward<P2>(p2))
-    )
-)
-
-//------------------------------------------------------------------------------
-
-/// 3-argument version of a helper function to #cons that accepts arguments that
-/// have been already preprocessed with #filter to convert regular variables into
-/// #ref and constants into #value.
-/// \note This version will be called from #cons with a non-#view target type
-template <typename T, size_t layout, typename P1, typename P2, typename P3>
-inline constr3<T,layout,
+template <typename T, size_t layout, typename P1, typename P2, typename... Ps>
+XTL_CONSTEXPR14 constrN<T,layout,
             typename underlying<P1>::type,
             typename underlying<P2>::type,
-            typename underlying<P3>::type
+            typename underlying<Ps>::type...
        > 
-cons_ex(const view<T,layout>&, P1&& p1, P2&& p2, P3&& p3) noexcept
+cons_ex(const view<T,layout>&, P1&& p1, P2&& p2, Ps&&... ps) noexcept
 {
-    return constr3<T,layout,
+    return constrN<T,layout,
             typename underlying<P1>::type,
             typename underlying<P2>::type,
-            typename underlying<P3>::type
+            typename underlying<Ps>::type...
            >(
             std::forward<P1>(p1),
             std::forward<P2>(p2),
-            std::forward<P3>(p3)
+            std::forward<Ps>(ps)...
            );
 }
 
-/// 3-argument version of a helper function to #cons that accepts arguments that
-/// have been already preprocessed with #filter to convert regular variables into
-/// #ref and constants into #value.
+/// N-argument version of a helper function to #cons for N >= 2 that accepts
+/// arguments that have been already preprocessed with #filter to convert 
+/// regular variables into #ref and constants into #value.
 /// \note This version will be called from #cons that had its target type a #view
-template <typename T, size_t layout, typename P1, typename P2, typename P3>
-inline constr3<T,layout,
+template <typename T, size_t layout, typename P1, typename P2, typename... Ps>
+XTL_CONSTEXPR14 constrN<T,layout,
             typename underlying<P1>::type,
             typename underlying<P2>::type,
-            typename underlying<P3>::type
+            typename underlying<Ps>::type...
        > 
-cons_ex(const view<view<T,layout>>&, P1&& p1, P2&& p2, P3&& p3) noexcept
+cons_ex(const view<view<T,layout>>&, P1&& p1, P2&& p2, Ps&&... ps) noexcept
 {
-    return constr3<T,layout,
+    return constrN<T,layout,
             typename underlying<P1>::type,
             typename underlying<P2>::type,
-            typename underlying<P3>::type
+            typename underlying<Ps>::type...
            >(
             std::forward<P1>(p1),
             std::forward<P2>(p2),
-            std::forward<P3>(p3)
+            std::forward<Ps>(ps)...
            );
 }
 
-/// A 3-argument version of a tree-pattern constructor. Target type is allowed
-/// to be a #view here.
-template <typename T, typename P1, typename P2, typename P3>
-inline auto C(P1&& p1, P2&& p2, P3&& p3) noexcept -> XTL_RETURN
+/// An N-argument version of a tree-pattern constructor for N >= 2. Target 
+/// type is allowed to be a #view here.
+template <typename T, typename P1, typename P2, typename... Ps>
+XTL_CONSTEXPR14 auto C(P1&& p1, P2&& p2, Ps&&... ps) noexcept -> XTL_RETURN
 (
     cons_ex(
         view<T>(),
         filter(std::forward<P1>(p1)),
         filter(std::forward<P2>(p2)),
-        filter(std::forward<P3>(p3))
+        filter(std::forward<Ps>(ps))...
     )
 )
 
-/// A 3-argument version of a tree-pattern constructor that takes layout in
-/// addition to the target type.
+/// An N-argument version of a tree-pattern constructor for N >= 2 that takes
+/// layout in addition to the target type.
 /// \note #view is not supposed to be passed as a target type to this version
 ///       of the function because we will then have two potentially conflicting
 ///       layouts. Any layout different from #default_layout passed here will
 ///       result in a compile time error.
-template <typename T, size_t layout, typename P1, typename P2, typename P3>
-inline auto C(P1&& p1, P2&& p2, P3&& p3) noexcept -> XTL_RETURN
+template <typename T, size_t layout, typename P1, typename P2, typename... Ps>
+XTL_CONSTEXPR14 auto C(P1&& p1, P2&& p2, Ps&&... ps) noexcept -> XTL_RETURN
 (
     cons_ex(
         view<T,layout>(),
         filter(std::forward<P1>(p1)),
         filter(std::forward<P2>(p2)),
-        filter(std::forward<P3>(p3))
+        filter(std::forward<Ps>(ps))...
     )
 )
 
 //------------------------------------------------------------------------------
 
-/// 4-argument version of a helper function to #cons that accepts arguments that
-/// have been already preprocessed with #filter to convert regular variables into
-/// #ref and constants into #value.
-/// \note This version will be called from #cons with a non-#view target type
-template <typename T, size_t layout, typename P1, typename P2, typename P3, typename P4>
-inline constr4<T,layout,
-            typename underlying<P1>::type,
-            typename underlying<P2>::type,
-            typename underlying<P3>::type,
-            typename underlying<P4>::type
-       > 
-cons_ex(const view<T,layout>&, P1&& p1, P2&& p2, P3&& p3, P4&& p4) noexcept
-{
-    return constr4<T,layout,
-            typename underlying<P1>::type,
-            typename underlying<P2>::type,
-            typename underlying<P3>::type,
-            typename underlying<P4>::type
-           >(
-            std::forward<P1>(p1),
-            std::forward<P2>(p2),
-            std::forward<P3>(p3),
-            std::forward<P4>(p4)
-           );
-}
-
-/// 4-argument version of a helper function to #cons that accepts arguments that
-/// have been already preprocessed with #filter to convert regular variables into
-/// #ref and constants into #value.
-/// \note This version will be called from #cons that had its target type a #view
-template <typename T, size_t layout, typename P1, typename P2, typename P3, typename P4>
-inline constr4<T,layout,
-            typename underlying<P1>::type,
-            typename underlying<P2>::type,
-            typename underlying<P3>::type,
-            typename underlying<P4>::type
-       > 
-cons_ex(const view<view<T,layout>>&, P1&& p1, P2&& p2, P3&& p3, P4&& p4) noexcept
+/// #is_pattern_ is a helper meta-predicate capable of distinguishing all our patterns
+template <typename T, size_t L>                                                     struct is_pattern_<constr0<T,L>>              { static const bool value = true; };
+template <typename T, size_t L, typename P1>                                        struct is_pattern_<constr1<T,L,P1>>           { static const bool value = true; };
+template <typename T, size_t L, typename P1, typename P2, typename... Ps>           struct is_pattern_<constrN<T,L,P1,P2,Ps...>>  { static const bool value = true; };
+
+/// #pattern_cost_ is a helper meta-function estimating the cost of trying a pattern
+template <typename T, size_t L>                                                     struct pattern_cost_<constr0<T,L>>             { static const unsigned int value = cost_of_constructor; };
+template <typename T, size_t L, typename P1>                                        struct pattern_cost_<constr1<T,L,P1>>          { static const unsigned int value = cost_of_constructor + pattern_cost<P1>::value; };
+template <typename T, size_t L, typename P1, typename P2, typename... Ps>           struct pattern_cost_<constrN<T,L,P1,P2,Ps...>> { static const unsigned int value = cost_of_constructor + constr_members<0,P1,P2,Ps...>::cost; };
+
+/// #is_hoistable_ is a helper meta-predicate telling whether a pattern can be constructed once per clause
+template <typename T, size_t L>                                                     struct is_hoistable_<constr0<T,L>>             { static const bool value = true; };
+template <typename T, size_t L, typename P1>                                        struct is_hoistable_<constr1<T,L,P1>>          { static const bool value = is_hoistable<P1>::value; };
+template <typename T, size_t L, typename P1, typename P2, typename... Ps>           struct is_hoistable_<constrN<T,L,P1,P2,Ps...>> { static const bool value = constr_members<0,P1,P2,Ps...>::hoistable; };
+
+/// #extractors_might_throw_ is a helper meta-predicate telling whether a pattern might throw from accessors of #bindings
+template <typename T, size_t L>                                                     struct extractors_might_throw_<constr0<T,L>>             { static const bool value = false; };
+template <typename T, size_t L, typename P1>                                        struct extractors_might_throw_<constr1<T,L,P1>>          : members_might_throw<bindings<T,L>,T,0,P1> {};
+template <typename T, size_t L, typename P1, typename P2, typename... Ps>           struct extractors_might_throw_<constrN<T,L,P1,P2,Ps...>> : members_might_throw<bindings<T,L>,T,0,P1,P2,Ps...> {};
+
+/// #dereferences_ is a helper meta-predicate telling whether a pattern loads the object it is applied to through a pointer
+template <typename T, size_t L, typename P1>                                        struct dereferences_<constr1<T,L,P1>>          { static const bool value = true; };
+template <typename T, size_t L, typename P1, typename P2, typename... Ps>           struct dereferences_<constrN<T,L,P1,P2,Ps...>> { static const bool value = true; };
+
+/// Constructor patterns applied to pointers to their target type known not to
+/// be null match the structure without checking for null first
+template <typename P, typename T>
+struct nonnull_constructor_application
 {
-    return constr4<T,layout,
-            typename underlying<P1>::type,
-            typename underlying<P2>::type,
-            typename underlying<P3>::type,
-            typename underlying<P4>::type
-           >(
-            std::forward<P1>(p1),
-            std::forward<P2>(p2),
-            std::forward<P3>(p3),
-            std::forward<P4>(p4)
-           );
-}
-
-/// A 4-argument version of a tree-pattern constructor. Target type is allowed
-/// to be a #view here.
-template <typename T, typename P1, typename P2, typename P3, typename P4>
-inline auto C(P1&& p1, P2&& p2, P3&& p3, P4&& p4) noexcept -> XTL_RETURN
-(
-    cons_ex(
-        view<T>(),
-        filter(std::forward<P1>(p1)),
-        filter(std::forward<P2>(p2)),
-        filter(std::forward<P3>(p3)),
-        filter(std::forward<P4>(p4))
-    )
-)
+    template <typename U> static XTL_CONSTEXPR14 bool apply(const P& p, U* u) { return p(u) != 0; }
+                          static XTL_CONSTEXPR14 bool apply(const P& p, const T* t) { return p.match_structure(t) != 0; }
+                          static XTL_CONSTEXPR14 bool apply(const P& p,       T* t) { return p.match_structure(t) != 0; }
+};
 
-/// A 4-argument version of a tree-pattern constructor that takes layout in
-/// addition to the target type.
-/// \note #view is not supposed to be passed as a target type to this version
-///       of the function because we will then have two potentially conflicting
-///       layouts. Any layout different from #default_layout passed here will
-///       result in a compile time error.
-template <typename T, size_t layout, typename P1, typename P2, typename P3, typename P4>
-inline auto C(P1&& p1, P2&& p2, P3&& p3, P4&& p4) noexcept -> XTL_RETURN
-(
-    cons_ex(
-        view<T,layout>(),
-        filter(std::forward<P1>(p1)),
-        filter(std::forward<P2>(p2)),
-        filter(std::forward<P3>(p3)),
-        filter(std::forward<P4>(p4))
-    )
-)
+template <typename T, size_t L, typename P1>                              struct nonnull_application_<constr1<T,L,P1>>          : nonnull_constructor_application<constr1<T,L,P1>,T>          {};
+template <typename T, size_t L, typename P1, typename P2, typename... Ps> struct nonnull_application_<constrN<T,L,P1,P2,Ps...>> : nonnull_constructor_application<constrN<T,L,P1,P2,Ps...>,T> {};
 
 //------------------------------------------------------------------------------
 
-/// #is_pattern_ is a helper meta-predicate capable of distinguishing all our patterns
-template <typename T, size_t L>                                                     struct is_pattern_<constr0<T,L>>              { static const bool value = true; };
-template <typename T, size_t L, typename P1>                                        struct is_pattern_<constr1<T,L,P1>>           { static const bool value = true; };
-template <typename T, size_t L, typename P1, typename P2>                           struct is_pattern_<constr2<T,L,P1,P2>>        { static const bool value = true; };
-template <typename T, size_t L, typename P1, typename P2, typename P3>              struct is_pattern_<constr3<T,L,P1,P2,P3>>     { static const bool value = true; };
-template <typename T, size_t L, typename P1, typename P2, typename P3, typename P4> struct is_pattern_<constr4<T,L,P1,P2,P3,P4>>  { static const bool value = true; };
+/// Matches the structure of *t against constructor pattern p in a clause of a 
+/// Match statement under #XTL_EXTRACTORS_MIGHT_THROW. Patterns whose accessors
+/// cannot throw are matched directly, without any exception handling.
+template <typename P, typename T>
+inline auto guarded_match_structure(const P& p, T* t) -> typename std::enable_if<!extractors_might_throw<P>::value, decltype(p.match_structure(t))>::type
+{
+    return p.match_structure(t);
+}
+
+/// Matches the structure of *t against constructor pattern p, whose accessors 
+/// might throw, treating an exception thrown by them as a failed match.
+template <typename P, typename T>
+inline auto guarded_match_structure(const P& p, T* t) -> typename std::enable_if< extractors_might_throw<P>::value, decltype(p.match_structure(t))>::type
+{
+    try
+    {
+        return p.match_structure(t);
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
 
 //------------------------------------------------------------------------------
 
@@ -84,6 +84,9 @@ struct equivalence
 /// #is_pattern_ is a helper meta-predicate capable of distinguishing all our patterns
 template <typename E1> struct is_pattern_<equivalence<E1>>    { static const bool value = true; };
 
+/// #pattern_cost_ is a helper meta-function estimating the cost of trying a pattern
+template <typename E1> struct pattern_cost_<equivalence<E1>>   { static const unsigned int value = cost_of_uses + pattern_cost<E1>::value; };
+
 /// #is_expression_ is a helper meta-predicate that separates lazily evaluatable expressions we support
 template <typename E1> struct is_expression_<equivalence<E1>> { static const bool value = true; };
 
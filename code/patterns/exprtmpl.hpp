@@ -55,28 +55,28 @@ namespace mch ///< Mach7 library namespace
 // Functors implementing a particular operation for any pair of types
 //==============================================================================
 
-struct unary_minus     { template <class A>          auto operator()(A&& a)        const -> decltype(-std::forward<A>(a))     { return -std::forward<A>(a); } };
-struct bit_complement  { template <class A>          auto operator()(A&& a)        const -> decltype(~std::forward<A>(a))     { return ~std::forward<A>(a); } };
-struct bool_complement { template <class A>          auto operator()(A&& a)        const -> decltype(!std::forward<A>(a))     { return !std::forward<A>(a); } };
-
-struct addition        { template <class A, class B> auto operator()(A&& a, B&& b) const -> decltype(std::forward<A>(a) +  std::forward<B>(b)) { return std::forward<A>(a) +  std::forward<B>(b); } };
-struct subtraction     { template <class A, class B> auto operator()(A&& a, B&& b) const -> decltype(std::forward<A>(a) -  std::forward<B>(b)) { return std::forward<A>(a) -  std::forward<B>(b); } };
-struct multiplication  { template <class A, class B> auto operator()(A&& a, B&& b) const -> decltype(std::forward<A>(a) *  std::forward<B>(b)) { return std::forward<A>(a) *  std::forward<B>(b); } };
-struct division        { template <class A, class B> auto operator()(A&& a, B&& b) const -> decltype(std::forward<A>(a) /  std::forward<B>(b)) { return std::forward<A>(a) /  std::forward<B>(b); } };
-struct modulo          { template <class A, class B> auto operator()(A&& a, B&& b) const -> decltype(std::forward<A>(a) %  std::forward<B>(b)) { return std::forward<A>(a) %  std::forward<B>(b); } };
-struct bit_and         { template <class A, class B> auto operator()(A&& a, B&& b) const -> decltype(std::forward<A>(a) &  std::forward<B>(b)) { return std::forward<A>(a) &  std::forward<B>(b); } };
-struct bit_or          { template <class A, class B> auto operator()(A&& a, B&& b) const -> decltype(std::forward<A>(a) |  std::forward<B>(b)) { return std::forward<A>(a) |  std::forward<B>(b); } };
-struct bit_xor         { template <class A, class B> auto operator()(A&& a, B&& b) const -> decltype(std::forward<A>(a) ^  std::forward<B>(b)) { return std::forward<A>(a) ^  std::forward<B>(b); } };
-struct bit_shift_left  { template <class A, class B> auto operator()(A&& a, B&& b) const -> decltype(std::forward<A>(a) << std::forward<B>(b)) { return std::forward<A>(a) << std::forward<B>(b); } };
-struct bit_shift_right { template <class A, class B> auto operator()(A&& a, B&& b) const -> decltype(std::forward<A>(a) >> std::forward<B>(b)) { return std::forward<A>(a) >> std::forward<B>(b); } };
-struct bool_and        { template <class A, class B> auto operator()(A&& a, B&& b) const -> decltype(std::forward<A>(a) && std::forward<B>(b)) { return std::forward<A>(a) && std::forward<B>(b); } };
-struct bool_or         { template <class A, class B> auto operator()(A&& a, B&& b) const -> decltype(std::forward<A>(a) || std::forward<B>(b)) { return std::forward<A>(a) || std::forward<B>(b); } };
-struct equal           { template <class A, class B> auto operator()(A&& a, B&& b) const -> decltype(std::forward<A>(a) == std::forward<B>(b)) { return std::forward<A>(a) == std::forward<B>(b); } };
-struct not_equal       { template <class A, class B> auto operator()(A&& a, B&& b) const -> decltype(std::forward<A>(a) != std::forward<B>(b)) { return std::forward<A>(a) != std::forward<B>(b); } };
-struct greater         { template <class A, class B> auto operator()(A&& a, B&& b) const -> decltype(std::forward<A>(a) >  std::forward<B>(b)) { return std::forward<A>(a) >  std::forward<B>(b); } };
-struct greater_equal   { template <class A, class B> auto operator()(A&& a, B&& b) const -> decltype(std::forward<A>(a) >= std::forward<B>(b)) { return std::forward<A>(a) >= std::forward<B>(b); } };
-struct less            { template <class A, class B> auto operator()(A&& a, B&& b) const -> decltype(std::forward<A>(a) <  std::forward<B>(b)) { return std::forward<A>(a) <  std::forward<B>(b); } };
-struct less_equal      { template <class A, class B> auto operator()(A&& a, B&& b) const -> decltype(std::forward<A>(a) <= std::forward<B>(b)) { return std::forward<A>(a) <= std::forward<B>(b); } };
+struct unary_minus     { template <class A>          constexpr auto operator()(A&& a)        const -> decltype(-std::forward<A>(a))     { return -std::forward<A>(a); } };
+struct bit_complement  { template <class A>          constexpr auto operator()(A&& a)        const -> decltype(~std::forward<A>(a))     { return ~std::forward<A>(a); } };
+struct bool_complement { template <class A>          constexpr auto operator()(A&& a)        const -> decltype(!std::forward<A>(a))     { return !std::forward<A>(a); } };
+
+struct addition        { template <class A, class B> constexpr auto operator()(A&& a, B&& b) const -> decltype(std::forward<A>(a) +  std::forward<B>(b)) { return std::forward<A>(a) +  std::forward<B>(b); } };
+struct subtraction     { template <class A, class B> constexpr auto operator()(A&& a, B&& b) const -> decltype(std::forward<A>(a) -  std::forward<B>(b)) { return std::forward<A>(a) -  std::forward<B>(b); } };
+struct multiplication  { template <class A, class B> constexpr auto operator()(A&& a, B&& b) const -> decltype(std::forward<A>(a) *  std::forward<B>(b)) { return std::forward<A>(a) *  std::forward<B>(b); } };
+struct division        { template <class A, class B> constexpr auto operator()(A&& a, B&& b) const -> decltype(std::forward<A>(a) /  std::forward<B>(b)) { return std::forward<A>(a) /  std::forward<B>(b); } };
+struct modulo          { template <class A, class B> constexpr auto operator()(A&& a, B&& b) const -> decltype(std::forward<A>(a) %  std::forward<B>(b)) { return std::forward<A>(a) %  std::forward<B>(b); } };
+struct bit_and         { template <class A, class B> constexpr auto operator()(A&& a, B&& b) const -> decltype(std::forward<A>(a) &  std::forward<B>(b)) { return std::forward<A>(a) &  std::forward<B>(b); } };
+struct bit_or          { template <class A, class B> constexpr auto operator()(A&& a, B&& b) const -> decltype(std::forward<A>(a) |  std::forward<B>(b)) { return std::forward<A>(a) |  std::forward<B>(b); } };
+struct bit_xor         { template <class A, class B> constexpr auto operator()(A&& a, B&& b) const -> decltype(std::forward<A>(a) ^  std::forward<B>(b)) { return std::forward<A>(a) ^  std::forward<B>(b); } };
+struct bit_shift_left  { template <class A, class B> constexpr auto operator()(A&& a, B&& b) const -> decltype(std::forward<A>(a) << std::forward<B>(b)) { return std::forward<A>(a) << std::forward<B>(b); } };
+struct bit_shift_right { template <class A, class B> constexpr auto operator()(A&& a, B&& b) const -> decltype(std::forward<A>(a) >> std::forward<B>(b)) { return std::forward<A>(a) >> std::forward<B>(b); } };
+struct bool_and        { template <class A, class B> constexpr auto operator()(A&& a, B&& b) const -> decltype(std::forward<A>(a) && std::forward<B>(b)) { return std::forward<A>(a) && std::forward<B>(b); } };
+struct bool_or         { template <class A, class B> constexpr auto operator()(A&& a, B&& b) const -> decltype(std::forward<A>(a) || std::forward<B>(b)) { return std::forward<A>(a) || std::forward<B>(b); } };
+struct equal           { template <class A, class B> constexpr auto operator()(A&& a, B&& b) const -> decltype(std::forward<A>(a) == std::forward<B>(b)) { return std::forward<A>(a) == std::forward<B>(b); } };
+struct not_equal       { template <class A, class B> constexpr auto operator()(A&& a, B&& b) const -> decltype(std::forward<A>(a) != std::forward<B>(b)) { return std::forward<A>(a) != std::forward<B>(b); } };
+struct greater         { template <class A, class B> constexpr auto operator()(A&& a, B&& b) const -> decltype(std::forward<A>(a) >  std::forward<B>(b)) { return std::forward<A>(a) >  std::forward<B>(b); } };
+struct greater_equal   { template <class A, class B> constexpr auto operator()(A&& a, B&& b) const -> decltype(std::forward<A>(a) >= std::forward<B>(b)) { return std::forward<A>(a) >= std::forward<B>(b); } };
+struct less            { template <class A, class B> constexpr auto operator()(A&& a, B&& b) const -> decltype(std::forward<A>(a) <  std::forward<B>(b)) { return std::forward<A>(a) <  std::forward<B>(b); } };
+struct less_equal      { template <class A, class B> constexpr auto operator()(A&& a, B&& b) const -> decltype(std::forward<A>(a) <= std::forward<B>(b)) { return std::forward<A>(a) <= std::forward<B>(b); } };
 
 //struct unary_minus     { template <class A>          auto operator()(const A& a)             const -> decltype(-a)     { return -a; } };
 //struct bit_complement  { template <class A>          auto operator()(const A& a)             const -> decltype(~a)     { return ~a; } };
@@ -239,19 +239,19 @@ template <> struct solver<division>
 //------------------------------------------------------------------------------
 
 template <typename F, typename A1>
-inline bool do_solve(F f, A1& a1, const decltype(f(a1))& /*r*/)
+XTL_CONSTEXPR14 bool do_solve(F f, A1& a1, const decltype(f(a1))& /*r*/)
 {
     return false;
 }
 
 template <typename F, typename A1, typename A2>
-inline bool do_solve(F f, A1& a1, const A2& a2, const decltype(f(a1,a2))& /*r*/)
+XTL_CONSTEXPR14 bool do_solve(F f, A1& a1, const A2& a2, const decltype(f(a1,a2))& /*r*/)
 {
     return false;
 }
 
 template <typename F, typename A1, typename A2>
-inline bool do_solve(F f, const A1& a1, A2& a2, const decltype(f(a1,a2))& /*r*/)
+XTL_CONSTEXPR14 bool do_solve(F f, const A1& a1, A2& a2, const decltype(f(a1,a2))& /*r*/)
 {
     return false;
 }
@@ -261,7 +261,7 @@ inline bool do_solve(F f, const A1& a1, A2& a2, const decltype(f(a1,a2))& /*r*/)
 // Solver for unary_minus operation
 // Solver for the first argument: -a == r => a == -r
 template <class A>
-inline bool do_solve(unary_minus, A& a, const decltype(-a)& r)
+XTL_CONSTEXPR14 bool do_solve(unary_minus, A& a, const decltype(-a)& r)
 {
     a = -r;
     return -a == r;
@@ -272,7 +272,7 @@ inline bool do_solve(unary_minus, A& a, const decltype(-a)& r)
 // Solver for bit_complement operation
 // Solver for the first argument: ~a == r => a == ~r
 template <class A> 
-inline bool do_solve(bit_complement, A& a, const decltype(~a)& r)
+XTL_CONSTEXPR14 bool do_solve(bit_complement, A& a, const decltype(~a)& r)
 {
     a = ~r;
     return ~a == r;
@@ -283,7 +283,7 @@ inline bool do_solve(bit_complement, A& a, const decltype(~a)& r)
 // Solver for bool_complement operation
 // Solver for the first argument: !a == r => a == !r
 template <class A> 
-inline bool do_solve(bool_complement, A& a, const decltype(!a)& r)
+XTL_CONSTEXPR14 bool do_solve(bool_complement, A& a, const decltype(!a)& r)
 {
     a = !r;
     return !a == r;
@@ -294,7 +294,7 @@ inline bool do_solve(bool_complement, A& a, const decltype(!a)& r)
 // Solver for addition operation
 // Solver for the first argument: a+b == r => a == r-b
 template <class A, class B> 
-inline bool do_solve(addition,      A& a, const B& b, const decltype(a+b)& r)
+XTL_CONSTEXPR14 bool do_solve(addition,      A& a, const B& b, const decltype(a+b)& r)
 {
     a = r - b;
     return a + b == r; // Actually will always be true, even with overflows
@@ -302,7 +302,7 @@ inline bool do_solve(addition,      A& a, const B& b, const decltype(a+b)& r)
 
 // Solver for the second argument: a+b == r => b == r-a
 template <class A, class B> 
-inline bool do_solve(addition,const A& a,       B& b, const decltype(a+b)& r)
+XTL_CONSTEXPR14 bool do_solve(addition,const A& a,       B& b, const decltype(a+b)& r)
 {
     b = r - a;
     return a + b == r; // Actually will always be true, even with overflows
@@ -313,7 +313,7 @@ inline bool do_solve(addition,const A& a,       B& b, const decltype(a+b)& r)
 // Solver for subtraction operation
 // Solver for the first argument: a-b == r => a == r+b
 template <class A, class B> 
-inline bool do_solve(subtraction,      A& a, const B& b, const decltype(a-b)& r)
+XTL_CONSTEXPR14 bool do_solve(subtraction,      A& a, const B& b, const decltype(a-b)& r)
 {
     a = r + b;
     return a - b == r; // Actually will always be true, even with overflows
@@ -321,7 +321,7 @@ inline bool do_solve(subtraction,      A& a, const B& b, const decltype(a-b)& r)
 
 // Solver for the second argument: a-b == r => b == a-r
 template <class A, class B> 
-inline bool do_solve(subtraction,const A& a,       B& b, const decltype(a-b)& r)
+XTL_CONSTEXPR14 bool do_solve(subtraction,const A& a,       B& b, const decltype(a-b)& r)
 {
     b = a - r;
     return a - b == r; // Actually will always be true, even with overflows
@@ -332,7 +332,7 @@ inline bool do_solve(subtraction,const A& a,       B& b, const decltype(a-b)& r)
 // Solver for multiplication operation
 // Solver for the first argument: a*b == r => a == r/b
 template <class A, class B> 
-inline bool do_solve(multiplication,      A& a, const B& b, const decltype(a*b)& r)
+XTL_CONSTEXPR14 bool do_solve(multiplication,      A& a, const B& b, const decltype(a*b)& r)
 {
     a = r/b;
     return a*b == r; // We need this as for integer division several numbers divided by b will give same result
@@ -340,7 +340,7 @@ inline bool do_solve(multiplication,      A& a, const B& b, const decltype(a*b)&
 
 // Solver for the second argument: a*b == r => b == r/a
 template <class A, class B> 
-inline bool do_solve(multiplication,const A& a,       B& b, const decltype(a*b)& r)
+XTL_CONSTEXPR14 bool do_solve(multiplication,const A& a,       B& b, const decltype(a*b)& r)
 {
     b = r/a;
     return a*b == r; // We need this as for integer division several numbers divided by b will give same result
@@ -351,7 +351,7 @@ inline bool do_solve(multiplication,const A& a,       B& b, const decltype(a*b)&
 // Solver for division operation
 // Solver for the first argument: a/b == r => a == r*b
 template <class A, class B> 
-inline bool do_solve(division,      A& a, const B& b, const decltype(a/b)& r)
+XTL_CONSTEXPR14 bool do_solve(division,      A& a, const B& b, const decltype(a/b)& r)
 {
     a = r*b;
     return a/b == r; // We need this as for integer division several numbers divided by b will give same result
@@ -359,7 +359,7 @@ inline bool do_solve(division,      A& a, const B& b, const decltype(a/b)& r)
 
 // Solver for the second argument: a/b == r => b == a/r
 template <class A, class B> 
-inline bool do_solve(division,const A& a,       B& b, const decltype(a/b)& r)
+XTL_CONSTEXPR14 bool do_solve(division,const A& a,       B& b, const decltype(a/b)& r)
 {
     b = a/r;
     return a/b == r; // We need this as for integer division several numbers divided by b will give same result
@@ -84,6 +84,12 @@ struct guard
 /// #is_pattern_ is a helper meta-predicate capable of distinguishing all our patterns
 template <typename P1, typename E2> struct is_pattern_<guard<P1,E2>> { static const bool value = true; };
 
+/// #pattern_cost_ is a helper meta-function estimating the cost of trying a pattern
+template <typename P1, typename E2> struct pattern_cost_<guard<P1,E2>> { static const unsigned int value = cost_of_uses + pattern_cost<P1>::value + pattern_cost<E2>::value; };
+
+/// #extractors_might_throw_ is a helper meta-predicate telling whether a pattern might throw from accessors of #bindings
+template <typename P1, typename E2> struct extractors_might_throw_<guard<P1,E2>> : extractors_might_throw<P1> {};
+
 //------------------------------------------------------------------------------
 
 } // of namespace mch
@@ -0,0 +1,364 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file defines the interval pattern in(lo,hi) and a table of intervals 
+/// and literals that finds the first of them containing the subject with a 
+/// single search, which lets a single clause with a switch on its position 
+/// replace a chain of clauses with interval, value or guard patterns.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#pragma once
+
+#include "primitive.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+//------------------------------------------------------------------------------
+// Design Notes:
+//
+// - Clauses like Case(in(0,10)) ... Case(in(90,100)) or their guard forms 
+//   Case(x |= x >= 10 && x < 20) test the subject against each range in turn.
+//   Instead, the ranges are put into an interval_table once, while a single 
+//   clause Case(interval_of(table, i)) finds the subject once and binds the 
+//   position i of the first range containing it, on which the clause switches.
+// - Intervals are half-open [lo,hi), as in the guards above. A literal v is 
+//   the interval from v to the next representable value after it, or to the 
+//   end of the domain when there is none.
+// - The bounds of all the ranges split the domain into segments, in each of 
+//   which the first range containing it is the same. Neighbouring segments 
+//   with the same range are merged, and the lower bounds of the rest are kept
+//   sorted, so that a subject is found by a binary search, whose steps only 
+//   pick one of two pointers and thus compile into conditional moves instead
+//   of branches that are hard to predict.
+// - When the bounds of integral ranges span at most interval_table::lookup_limit
+//   values, the position of the range of each of them is kept in a lookup 
+//   table instead, which subjects within the span index directly.
+// - Overlapping ranges resolve to the first of them, as the first of several
+//   matching clauses would be chosen.
+//
+
+namespace mch ///< Mach7 library namespace
+{
+
+//------------------------------------------------------------------------------
+
+/// Interval pattern, which accepts subjects in the half-open range [lo,hi)
+template <typename T>
+struct interval
+{
+    /// Type function returning a type that will be accepted by the pattern for
+    /// a given subject type S. We use type function instead of an associated 
+    /// type, because there is no a single accepted type for a #wildcard pattern
+    /// for example. Requirement of #Pattern concept.
+    template <typename S> struct accepted_type_for { typedef T type; };
+
+    constexpr interval(const T& lo, const T& hi) noexcept : m_lo(lo), m_hi(hi) {}
+    constexpr bool operator()(const T& t) const noexcept { return m_lo <= t && t < m_hi; }
+
+    T m_lo; ///< Smallest value in the interval
+    T m_hi; ///< Smallest value past the interval
+};
+
+//------------------------------------------------------------------------------
+
+/// #is_pattern_ is a helper meta-predicate capable of distinguishing all our patterns
+template <typename T> struct is_pattern_<interval<T>>    { static const bool value = true; };
+
+/// #pattern_cost_ is a helper meta-function estimating the cost of trying a pattern
+template <typename T> struct pattern_cost_<interval<T>>  { static const unsigned int value = cost_of_expression; };
+
+/// #is_hoistable_ is a helper meta-predicate telling whether a pattern can be constructed once per clause
+template <typename T> struct is_hoistable_<interval<T>>  { static const bool value = true; };
+
+/// #extractors_might_throw_ is a helper meta-predicate telling whether a pattern might throw from accessors of #bindings
+template <typename T> struct extractors_might_throw_<interval<T>> { static const bool value = false; };
+
+//------------------------------------------------------------------------------
+
+/// Convenience function for creating an interval pattern, e.g. in(10,20) that
+/// accepts subjects x for which 10 <= x && x < 20.
+template <typename T, typename U>
+constexpr interval<typename std::common_type<T,U>::type> in(const T& lo, const U& hi) noexcept
+{
+    return interval<typename std::common_type<T,U>::type>(lo, hi);
+}
+
+//------------------------------------------------------------------------------
+
+/// Table of intervals and literals of an arithmetic type, which finds the 
+/// position of the first of them containing a given value
+template <typename T>
+class interval_table
+{
+    static_assert(std::is_arithmetic<T>::value, "Intervals can only be tabulated for arithmetic types");
+
+public:
+
+    /// Position returned by #find for values that are not in any of the ranges
+    static const std::size_t npos = std::size_t(-1);
+
+    /// Integral ranges whose bounds span up to this many values use a lookup table
+    enum { lookup_limit = 256 };
+
+    /// Each of the ranges is either an interval pattern, a value pattern or a
+    /// literal, e.g. interval_table<int>(in(0,10), 42, in(40,50))
+    template <typename... Rs>
+    explicit interval_table(const Rs&... ranges) : m_span(0)
+    {
+        const int dummy[] = { 0, (add(ranges), 0)... };
+        (void)dummy;
+        build(std::integral_constant<bool, std::is_integral<T>::value && !std::is_same<T,bool>::value>());
+    }
+
+    /// Returns position of the first range containing v or #npos when there is none
+    std::size_t find(const T& v) const noexcept
+    {
+        return find(v, std::integral_constant<bool, std::is_integral<T>::value && !std::is_same<T,bool>::value>());
+    }
+
+    std::size_t size()     const noexcept { return m_ranges.size(); } ///< Number of ranges
+    std::size_t segments() const noexcept { return m_lower.size(); }  ///< Number of segments the ranges split the domain into
+    bool        tabulated()const noexcept { return m_span != 0; }     ///< Whether a lookup table is used
+
+private:
+
+    /// Range [lo,hi) or [lo,...) when it is not bounded
+    struct range
+    {
+        T    lo;
+        T    hi;
+        bool bounded;
+
+        bool contains(const T& v) const noexcept { return lo <= v && (!bounded || v < hi); }
+    };
+
+    template <typename U> void add(const interval<U>& i) { range r = { T(i.m_lo), T(i.m_hi), true }; m_ranges.push_back(r); }
+    template <typename U> void add(const value<U>& v)    { add(v.m_value); }
+    template <typename U> void add(const U& v)
+    {
+        range r = { T(v), T(v), false };
+        r.bounded = successor(r.lo, r.hi, std::is_integral<T>());
+        m_ranges.push_back(r);
+    }
+
+    /// Sets next to the smallest value greater than v, if there is one
+    static bool successor(const T& v, T& next, std::true_type) noexcept
+    {
+        if (v == std::numeric_limits<T>::max())
+            return false;
+
+        next = T(v + 1);
+        return true;
+    }
+
+    static bool successor(const T& v, T& next, std::false_type) noexcept
+    {
+        next = std::nextafter(v, std::numeric_limits<T>::infinity());
+        return v < next;
+    }
+
+    /// Splits the domain into segments and assigns each the first range containing it
+    void build(std::false_type)
+    {
+        std::vector<T> bounds;
+
+        for (std::size_t i = 0; i < m_ranges.size(); ++i)
+        {
+            const range& r = m_ranges[i];
+
+            if (r.bounded && !(r.lo < r.hi))
+                continue; // Empty intervals never match
+
+            bounds.push_back(r.lo);
+
+            if (r.bounded)
+                bounds.push_back(r.hi);
+        }
+
+        std::sort(bounds.begin(), bounds.end());
+        bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+
+        m_index.assign(1, npos); // Values below all the bounds are in no range
+
+        for (std::size_t b = 0; b < bounds.size(); ++b)
+        {
+            std::size_t i = 0;
+
+            while (i < m_ranges.size() && !m_ranges[i].contains(bounds[b]))
+                ++i;
+
+            if (i == m_ranges.size())
+                i = npos;
+
+            if (i != m_index.back()) // Otherwise the segment extends the previous one
+            {
+                m_lower.push_back(bounds[b]);
+                m_index.push_back(i);
+            }
+        }
+    }
+
+    void build(std::true_type)
+    {
+        build(std::false_type());
+
+        if (m_lower.empty())
+            return;
+
+        typedef typename std::make_unsigned<T>::type U;
+        const std::uintmax_t span = std::uintmax_t(U(U(m_lower.back()) - U(m_lower.front()))) + 1u;
+
+        if (span == 0 || span > std::uintmax_t(lookup_limit))
+            return;
+
+        m_span = std::size_t(span);
+        m_table.resize(m_span);
+
+        for (std::size_t d = 0; d < m_span; ++d)
+            m_table[d] = m_index[upper(T(m_lower.front() + T(d)))];
+    }
+
+    /// Number of segments whose lower bound is not greater than v
+    std::size_t upper(const T& v) const noexcept
+    {
+        const T* first = m_lower.data();
+        const T* base  = first;
+        std::size_t n  = m_lower.size();
+
+        if (n == 0)
+            return 0;
+
+        while (n > 1)
+        {
+            const std::size_t half = n / 2;
+            base = base[half] <= v ? base + half : base; // Conditional move rather than branch
+            n   -= half;
+        }
+
+        return std::size_t(base - first) + (*base <= v);
+    }
+
+    std::size_t find(const T& v, std::false_type) const noexcept
+    {
+        return m_index[upper(v)];
+    }
+
+    std::size_t find(const T& v, std::true_type) const noexcept
+    {
+        if (m_span == 0)
+            return m_index[upper(v)];
+
+        typedef typename std::make_unsigned<T>::type U;
+        const U d = U(U(v) - U(m_lower.front()));
+
+        if (d < m_span)
+            return m_table[d];
+
+        return v < m_lower.front() ? m_index.front() : m_index.back();
+    }
+
+    std::vector<range>       m_ranges; ///< Ranges in the order they were given
+    std::vector<T>           m_lower;  ///< Sorted lower bounds of the segments
+    std::vector<std::size_t> m_index;  ///< Position of the range of values below m_lower[k] at k and of those above all at the end
+    std::vector<std::size_t> m_table;  ///< Position of the range of m_lower.front()+d at d when tabulated
+    std::size_t              m_span;   ///< Number of values in the lookup table or 0 when it is not used
+};
+
+template <typename T> const std::size_t interval_table<T>::npos;
+
+//------------------------------------------------------------------------------
+
+/// Pattern that accepts subjects in one of the ranges of a table when pattern
+/// P1 accepts position of the first of them
+template <typename T, typename P1>
+struct interval_indexed
+{
+    static_assert(is_pattern<P1>::value, "Argument P1 of an interval table pattern must be a pattern");
+
+    interval_indexed(const interval_table<T>& t, const P1&  p1) noexcept : m_table(t), m_p1(p1) {}
+    interval_indexed(const interval_table<T>& t,       P1&& p1) noexcept : m_table(t), m_p1(std::move(p1)) {}
+    interval_indexed(const interval_indexed&  k) noexcept : m_table(k.m_table), m_p1(          k.m_p1 ) {} ///< Copy constructor
+    interval_indexed(      interval_indexed&& k) noexcept : m_table(k.m_table), m_p1(std::move(k.m_p1)) {} ///< Move constructor
+    interval_indexed& operator=(const interval_indexed&); ///< Assignment is not allowed for this class
+
+    /// Type function returning a type that will be accepted by the pattern for
+    /// a given subject type S. We use type function instead of an associated 
+    /// type, because there is no a single accepted type for a #wildcard pattern
+    /// for example. Requirement of #Pattern concept.
+    template <typename S> struct accepted_type_for { typedef T type; };
+
+    bool operator()(const T& s) const
+    {
+        const std::size_t i = m_table.find(s);
+        return i != interval_table<T>::npos && m_p1(i);
+    }
+
+    const interval_table<T>& m_table; ///< Table of ranges
+    P1                       m_p1;    ///< Pattern the position of the range is matched with
+};
+
+//------------------------------------------------------------------------------
+
+/// #is_pattern_ is a helper meta-predicate capable of distinguishing all our patterns
+template <typename T, typename P1> struct is_pattern_<interval_indexed<T,P1>>   { static const bool value = true; };
+
+/// #pattern_cost_ is a helper meta-function estimating the cost of trying a pattern
+template <typename T, typename P1> struct pattern_cost_<interval_indexed<T,P1>> { static const unsigned int value = cost_of_expression + pattern_cost<P1>::value; };
+
+//------------------------------------------------------------------------------
+
+/// Convenience function for creating a pattern on a table of ranges, e.g.
+/// interval_of(grades, i) with a var<size_t> i to bind the position of the
+/// first range among grades that contains the subject.
+template <typename T, typename P1>
+inline auto interval_of(const interval_table<T>& t, P1&& p1) noexcept -> XTL_RETURN
+(
+    interval_indexed<T,typename underlying<decltype(filter(std::forward<P1>(p1)))>::type>(t, filter(std::forward<P1>(p1)))
+)
+
+//------------------------------------------------------------------------------
+
+} // of namespace mch
@@ -0,0 +1,209 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file defines a keyed pattern that looks subjects up in a hash table of
+/// keys and binds the position of the key found, which lets a single clause 
+/// with a switch on that position replace a chain of clauses with equivalence
+/// or value patterns on the same member.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#pragma once
+
+#include "primitive.hpp"
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <vector>
+
+//------------------------------------------------------------------------------
+// Design Notes:
+//
+// - Clauses of a Match statement are tried one after another, so N clauses 
+//   like Case(C<Call>(+name1)) ... Case(C<Call>(+nameN)) compare the subject
+//   with up to N keys. Instead, keys are put into a key_table once, while a 
+//   single clause Case(C<Call>(key_of(table, i))) hashes the subject once and
+//   binds the position i of its key, on which the clause then switches.
+// - The table uses open addressing with linear probing in a power of 2 array
+//   of slots at most half full. Slots keep the full hash of their key, so that
+//   keys are only compared when hashes are equal.
+// - When a key occurs several times, its first position is found, as the 
+//   first of several clauses with the same key would be chosen.
+//
+
+namespace mch ///< Mach7 library namespace
+{
+
+//------------------------------------------------------------------------------
+
+/// Hash table mapping keys to their positions in the sequence they were given in
+template <typename T, typename Hash = std::hash<T>, typename Equal = std::equal_to<T>>
+class key_table
+{
+public:
+
+    /// Position returned by #find for subjects that are not among the keys
+    static const std::size_t npos = std::size_t(-1);
+
+    key_table(std::initializer_list<T> keys, const Hash& h = Hash(), const Equal& e = Equal()) : 
+        m_keys(keys), m_hash(h), m_equal(e) 
+    { 
+        build(); 
+    }
+
+    template <typename Iterator>
+    key_table(Iterator first, Iterator last, const Hash& h = Hash(), const Equal& e = Equal()) : 
+        m_keys(first, last), m_hash(h), m_equal(e) 
+    { 
+        build(); 
+    }
+
+    /// Returns position of the first occurrence of key k or #npos when k is not a key
+    std::size_t find(const T& k) const
+    {
+        const std::size_t h = m_hash(k);
+
+        for (std::size_t i = h & m_mask; ; i = (i + 1) & m_mask)
+        {
+            const slot& s = m_slots[i];
+
+            if (s.index == npos)
+                return npos;
+
+            if (s.hash == h && m_equal(m_keys[s.index], k))
+                return s.index;
+        }
+    }
+
+    std::size_t size() const noexcept { return m_keys.size(); } ///< Number of keys
+    const T& operator[](std::size_t i) const { return m_keys[i]; } ///< Key at position i
+
+private:
+
+    struct slot
+    {
+        std::size_t hash;  ///< Hash of the key
+        std::size_t index; ///< Position of the key, #npos for empty slots
+    };
+
+    void build()
+    {
+        std::size_t n = 2;
+
+        while (n < 2*m_keys.size())
+            n *= 2;
+
+        slot empty = { 0, npos };
+        m_slots.assign(n, empty);
+        m_mask = n - 1;
+
+        for (std::size_t k = 0; k < m_keys.size(); ++k)
+            if (find(m_keys[k]) == npos) // Later occurrences of a key are never found
+            {
+                const std::size_t h = m_hash(m_keys[k]);
+                std::size_t i = h & m_mask;
+
+                while (m_slots[i].index != npos)
+                    i = (i + 1) & m_mask;
+
+                m_slots[i].hash  = h;
+                m_slots[i].index = k;
+            }
+    }
+
+    std::vector<T>    m_keys;  ///< Keys in the order they were given
+    std::vector<slot> m_slots; ///< Open addressing table of positions of keys
+    std::size_t       m_mask;  ///< Number of slots minus 1
+    Hash              m_hash;
+    Equal             m_equal;
+};
+
+//------------------------------------------------------------------------------
+
+/// Keyed pattern, which accepts subjects that are keys of a table when pattern
+/// P1 accepts position of the key in the table
+template <typename T, typename H, typename E, typename P1>
+struct keyed
+{
+    static_assert(is_pattern<P1>::value, "Argument P1 of a keyed pattern must be a pattern");
+
+    keyed(const key_table<T,H,E>& t, const P1&  p1) noexcept : m_table(t), m_p1(p1) {}
+    keyed(const key_table<T,H,E>& t,       P1&& p1) noexcept : m_table(t), m_p1(std::move(p1)) {}
+    keyed(const keyed&  k) noexcept : m_table(k.m_table), m_p1(          k.m_p1 ) {} ///< Copy constructor
+    keyed(      keyed&& k) noexcept : m_table(k.m_table), m_p1(std::move(k.m_p1)) {} ///< Move constructor
+    keyed& operator=(const keyed&); ///< Assignment is not allowed for this class
+
+    /// Type function returning a type that will be accepted by the pattern for
+    /// a given subject type S. We use type function instead of an associated 
+    /// type, because there is no a single accepted type for a #wildcard pattern
+    /// for example. Requirement of #Pattern concept.
+    template <typename S> struct accepted_type_for { typedef T type; };
+
+    bool operator()(const T& s) const
+    {
+        const std::size_t i = m_table.find(s);
+        return i != key_table<T,H,E>::npos && m_p1(i);
+    }
+
+    const key_table<T,H,E>& m_table; ///< Table of keys
+    P1                      m_p1;    ///< Pattern the position of the key is matched with
+};
+
+//------------------------------------------------------------------------------
+
+/// #is_pattern_ is a helper meta-predicate capable of distinguishing all our patterns
+template <typename T, typename H, typename E, typename P1> struct is_pattern_<keyed<T,H,E,P1>>   { static const bool value = true; };
+
+/// #pattern_cost_ is a helper meta-function estimating the cost of trying a pattern
+template <typename T, typename H, typename E, typename P1> struct pattern_cost_<keyed<T,H,E,P1>> { static const unsigned int value = cost_of_expression + pattern_cost<P1>::value; };
+
+//------------------------------------------------------------------------------
+
+/// Convenience function for creating a keyed pattern, e.g. key_of(names, i)
+/// with a var<size_t> i to bind the position of subject among names.
+template <typename T, typename H, typename E, typename P1>
+inline auto key_of(const key_table<T,H,E>& t, P1&& p1) noexcept -> XTL_RETURN
+(
+    keyed<T,H,E,typename underlying<decltype(filter(std::forward<P1>(p1)))>::type>(t, filter(std::forward<P1>(p1)))
+)
+
+//------------------------------------------------------------------------------
+
+} // of namespace mch
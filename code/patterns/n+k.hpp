@@ -85,6 +85,14 @@ template <typename F, typename E1, typename E2> struct is_pattern_<expr<F,E1,E2>
 /// #is_expression_ is a helper meta-predicate that separates lazily evaluatable expressions we support
 template <typename F, typename E1, typename E2> struct is_expression_<expr<F,E1,E2>> { static const bool value = true; };
 
+/// #pattern_cost_ is a helper meta-function estimating the cost of trying a pattern
+template <typename F, typename E1>              struct pattern_cost_<expr<F,E1>>     { static const unsigned int value = cost_of_expression + pattern_cost<E1>::value; };
+template <typename F, typename E1, typename E2> struct pattern_cost_<expr<F,E1,E2>>  { static const unsigned int value = cost_of_expression + pattern_cost<E1>::value + pattern_cost<E2>::value; };
+
+/// #is_hoistable_ is a helper meta-predicate telling whether a pattern can be constructed once per clause
+template <typename F, typename E1>              struct is_hoistable_<expr<F,E1>>     : is_hoistable<E1> {};
+template <typename F, typename E1, typename E2> struct is_hoistable_<expr<F,E1,E2>>  { static const bool value = is_hoistable<E1>::value && is_hoistable<E2>::value; };
+
 //------------------------------------------------------------------------------
 
 /// Expression pattern for unary operation
@@ -94,10 +102,10 @@ struct expr<F,E1>
     static_assert(is_expression<E1>::value, "Argument E1 of a unary expression-pattern must be a lazy expression");
     static_assert(!is_var<E1>::value,       "Attempting to host var<> directly. Use filter() to wrap it into ref2<>");
 
-    explicit expr(const E1&  e1) noexcept : m_e1(          e1 ) {}
-    explicit expr(      E1&& e1) noexcept : m_e1(std::move(e1)) {}
-    expr(const expr&  e) noexcept : m_e1(          e.m_e1 ) {} ///< Copy constructor    
-    expr(      expr&& e) noexcept : m_e1(std::move(e.m_e1)) {} ///< Move constructor
+    constexpr explicit expr(const E1&  e1) noexcept : m_e1(          e1 ) {}
+    constexpr explicit expr(      E1&& e1) noexcept : m_e1(std::move(e1)) {}
+    constexpr expr(const expr&  e) noexcept : m_e1(          e.m_e1 ) {} ///< Copy constructor    
+    constexpr expr(      expr&& e) noexcept : m_e1(std::move(e.m_e1)) {} ///< Move constructor
     expr& operator=(const expr&); ///< Assignment is not allowed for this class
 
     typedef typename std::remove_const<decltype(F()(std::declval<typename E1::result_type>()))>::type result_type;    ///< Type of result when used in expression. Requirement of #LazyExpression concept // We needed to add remove_const here as MSVC was returning const T
@@ -108,10 +116,10 @@ struct expr<F,E1>
     /// for example. Requirement of #Pattern concept.
     template <typename S> struct accepted_type_for { typedef result_type type; };
 
-    operator result_type() const { return eval(*this); } // FIX: avoid implicit conversion in lazy expressions
+    constexpr operator result_type() const { return eval(*this); } // FIX: avoid implicit conversion in lazy expressions
 
     template <typename U>
-    bool operator()(const U& u) const { return solve(*this,u); }
+    constexpr bool operator()(const U& u) const { return solve(*this,u); }
 
     E1 m_e1; ///< Expression template with the 1st operand
 };
@@ -127,12 +135,12 @@ struct expr
     static_assert(!is_var<E1>::value,       "Attempting to host var<> directly. Use filter() to wrap it into ref2<>");
     static_assert(!is_var<E2>::value,       "Attempting to host var<> directly. Use filter() to wrap it into ref2<>");
 
-    expr(const E1&  e1, const E2&  e2) noexcept : m_e1(          e1 ), m_e2(          e2 ) {}
-    expr(      E1&& e1, const E2&  e2) noexcept : m_e1(std::move(e1)), m_e2(          e2 ) {}
-    expr(const E1&  e1,       E2&& e2) noexcept : m_e1(          e1 ), m_e2(std::move(e2)) {}
-    expr(      E1&& e1,       E2&& e2) noexcept : m_e1(std::move(e1)), m_e2(std::move(e2)) {}
-    expr(const expr&  e) noexcept : m_e1(          e.m_e1 ), m_e2(          e.m_e2 ) {} ///< Copy constructor
-    expr(      expr&& e) noexcept : m_e1(std::move(e.m_e1)), m_e2(std::move(e.m_e2)) {} ///< Move constructor
+    constexpr expr(const E1&  e1, const E2&  e2) noexcept : m_e1(          e1 ), m_e2(          e2 ) {}
+    constexpr expr(      E1&& e1, const E2&  e2) noexcept : m_e1(std::move(e1)), m_e2(          e2 ) {}
+    constexpr expr(const E1&  e1,       E2&& e2) noexcept : m_e1(          e1 ), m_e2(std::move(e2)) {}
+    constexpr expr(      E1&& e1,       E2&& e2) noexcept : m_e1(std::move(e1)), m_e2(std::move(e2)) {}
+    constexpr expr(const expr&  e) noexcept : m_e1(          e.m_e1 ), m_e2(          e.m_e2 ) {} ///< Copy constructor
+    constexpr expr(      expr&& e) noexcept : m_e1(std::move(e.m_e1)), m_e2(std::move(e.m_e2)) {} ///< Move constructor
     expr& operator=(const expr&); ///< Assignment is not allowed for this class
 
     typedef typename std::remove_const<decltype(F()(std::declval<typename E1::result_type>(),std::declval<typename E2::result_type>()))>::type result_type;    ///< Type of result when used in expression. Requirement of #LazyExpression concept // We needed to add remove_const here as MSVC was returning const T
@@ -143,10 +151,10 @@ struct expr
     /// for example. Requirement of #Pattern concept.
     template <typename S> struct accepted_type_for { typedef result_type type; };
 
-    operator result_type() const { return eval(*this); }// FIX: avoid implicit conversion in lazy expressions
+    constexpr operator result_type() const { return eval(*this); }// FIX: avoid implicit conversion in lazy expressions
 
     template <typename U>
-    bool operator()(const U& u) const { return solve(*this,u); }
+    constexpr bool operator()(const U& u) const { return solve(*this,u); }
 
     E1 m_e1; ///< Expression template with the 1st operand
     E2 m_e2; ///< Expression template with the 2nd operand
@@ -156,14 +164,14 @@ struct expr
 
 /// Convenience function to create unary expression
 template <typename F, typename E1>
-    auto make_expr(E1&& e1) noexcept -> XTL_RETURN
+    constexpr auto make_expr(E1&& e1) noexcept -> XTL_RETURN
     (
         expr<F,typename underlying<E1>::type>(std::forward<E1>(e1))
     )
 
 /// Convenience function to create binary expression
 template <typename F, typename E1, typename E2>
-    auto make_expr(E1&& e1, E2&& e2) noexcept -> XTL_RETURN
+    constexpr auto make_expr(E1&& e1, E2&& e2) noexcept -> XTL_RETURN
     (
         expr<F,typename underlying<E1>::type,typename underlying<E2>::type>(std::forward<E1>(e1),std::forward<E2>(e2))
     )
@@ -175,9 +183,19 @@ template <typename F, typename E1, typename E2>
 /// an Expression concept and evaluating it.
 /// \note See header files of other patterns for more overloads!
 template <typename F, typename E1>              
-inline typename expr<F,E1>::result_type    eval(const expr<F,E1>&    e) { return F()(eval(e.m_e1)); }
+constexpr typename expr<F,E1>::result_type    eval(const expr<F,E1>&    e) { return F()(eval(e.m_e1)); }
 template <typename F, typename E1, typename E2> 
-inline typename expr<F,E1,E2>::result_type eval(const expr<F,E1,E2>& e) { return F()(eval(e.m_e1),eval(e.m_e2)); }
+constexpr typename expr<F,E1,E2>::result_type eval(const expr<F,E1,E2>& e) { return F()(eval(e.m_e1),eval(e.m_e2)); }
+///@}
+
+///@{
+/// Logical operations evaluate their second operand only when the first one
+/// does not determine the result, as the built-in && and || do, so that the
+/// second operand of a guard like `x |= x != 0 && n/x > 1` may rely on it.
+template <typename E1, typename E2> 
+constexpr typename expr<bool_and,E1,E2>::result_type eval(const expr<bool_and,E1,E2>& e) { return eval(e.m_e1) && eval(e.m_e2); }
+template <typename E1, typename E2> 
+constexpr typename expr<bool_or, E1,E2>::result_type eval(const expr<bool_or, E1,E2>& e) { return eval(e.m_e1) || eval(e.m_e2); }
 ///@}
 
 //------------------------------------------------------------------------------
@@ -265,7 +283,7 @@ inline auto operator<<(std::ostream& os, E&& e) throw()
 #if !defined(__GNUC__)
 #define FOR_EACH_UNARY_OPERATOR(FF,S)                                           \
     template <typename E1>                                                      \
-    inline auto XTL_CONCATENATE(operator,S)(E1&& e1) noexcept ->                \
+    constexpr auto XTL_CONCATENATE(operator,S)(E1&& e1) noexcept ->             \
     typename std::enable_if<                                                    \
                 mch::is_expression<E1>::value,                                  \
                 mch::expr<FF,decltype(mch::filter(std::forward<E1>(e1)))>       \
@@ -275,7 +293,7 @@ inline auto operator<<(std::ostream& os, E&& e) throw()
     }
 #define FOR_EACH_BINARY_OPERATOR(FF,S)                                          \
     template <typename E1, typename E2>                                         \
-    inline auto XTL_CONCATENATE(operator,S)(E1&& e1, E2&& e2) noexcept ->       \
+    constexpr auto XTL_CONCATENATE(operator,S)(E1&& e1, E2&& e2) noexcept ->    \
     typename std::enable_if<                                                    \
                 mch::either_is_expression<E1,E2>::value,                        \
                 mch::expr<FF,                                                   \
@@ -295,31 +313,31 @@ inline auto operator<<(std::ostream& os, E&& e) throw()
 ///      This was choosing the wrong overload, so maybe we should replace all operators
 ///      in that way, of rely on later GCC version where this (presumably) is fixed.
 #define FOR_EACH_UNARY_OPERATOR(FF,S)                                           \
-    template <typename T>                                         inline auto XTL_CONCATENATE(operator,S)(      mch::var<T>&         v) noexcept -> XTL_RETURN(mch::make_expr<FF>(mch::ref2<mch::var<T>>(v))) \
-    template <typename T>                                         inline auto XTL_CONCATENATE(operator,S)(const mch::value<T>&       v) noexcept -> XTL_RETURN(mch::make_expr<FF>(v))                        \
-    template <typename F1, typename E1>                           inline auto XTL_CONCATENATE(operator,S)(const mch::expr<F1,E1>&    v) noexcept -> XTL_RETURN(mch::make_expr<FF>(v))                        \
-    template <typename F1, typename E1, typename E2>              inline auto XTL_CONCATENATE(operator,S)(const mch::expr<F1,E1,E2>& v) noexcept -> XTL_RETURN(mch::make_expr<FF>(v))
+    template <typename T>                                         constexpr auto XTL_CONCATENATE(operator,S)(      mch::var<T>&         v) noexcept -> XTL_RETURN(mch::make_expr<FF>(mch::ref2<mch::var<T>>(v))) \
+    template <typename T>                                         constexpr auto XTL_CONCATENATE(operator,S)(const mch::value<T>&       v) noexcept -> XTL_RETURN(mch::make_expr<FF>(v))                        \
+    template <typename F1, typename E1>                           constexpr auto XTL_CONCATENATE(operator,S)(const mch::expr<F1,E1>&    v) noexcept -> XTL_RETURN(mch::make_expr<FF>(v))                        \
+    template <typename F1, typename E1, typename E2>              constexpr auto XTL_CONCATENATE(operator,S)(const mch::expr<F1,E1,E2>& v) noexcept -> XTL_RETURN(mch::make_expr<FF>(v))
 #define FOR_EACH_BINARY_OPERATOR(FF,S)                                          \
-  /*template <typename T,  typename E>                            inline auto XTL_CONCATENATE(operator,S)(      mch::var<T>&         v,       E&&                  e) noexcept -> XTL_RETURN(mch::make_expr<FF>(mch::ref2<mch::var<T>>(v),mch::filter(std::forward<E>(e))))*/ \
-    template <typename T,  typename E>                            inline auto XTL_CONCATENATE(operator,S)(      mch::var<T>&         v,       E&&                  e) noexcept -> mch::expr<FF,mch::ref2<mch::var<T>>,decltype(mch::filter(std::forward<E>(e)))> { return mch::make_expr<FF>(mch::ref2<mch::var<T>>(v),mch::filter(std::forward<E>(e))); } \
-  /*template <typename T,  typename E>                            inline auto XTL_CONCATENATE(operator,S)(      E&&                  e,            mch::var<T>&    v) noexcept -> XTL_RETURN(mch::make_expr<FF>(mch::filter(std::forward<E>(e)),mch::ref2<mch::var<T>>(v)))*/ \
-    template <typename T,  typename E>                            inline auto XTL_CONCATENATE(operator,S)(      E&&                  e,            mch::var<T>&    v) noexcept -> mch::expr<FF,decltype(mch::filter(std::forward<E>(e))),mch::ref2<mch::var<T>>> { return mch::make_expr<FF>(mch::filter(std::forward<E>(e)),mch::ref2<mch::var<T>>(v)); } \
-    template <typename T,  typename E>                            inline auto XTL_CONCATENATE(operator,S)(const mch::value<T>&       v,       E&&                  e) noexcept -> XTL_RETURN(mch::make_expr<FF>(v,mch::filter(std::forward<E>(e)))) \
-    template <typename T,  typename E>                            inline auto XTL_CONCATENATE(operator,S)(      E&&                  e, const mch::value<T>&       v) noexcept -> XTL_RETURN(mch::make_expr<FF>(mch::filter(std::forward<E>(e)),v)) \
-    template <typename F1, typename E1, typename E>               inline auto XTL_CONCATENATE(operator,S)(const mch::expr<F1,E1>&    v,       E&&                  e) noexcept -> XTL_RETURN(mch::make_expr<FF>(v,mch::filter(std::forward<E>(e)))) \
-    template <typename F1, typename E1, typename E>               inline auto XTL_CONCATENATE(operator,S)(      E&&                  e, const mch::expr<F1,E1>&    v) noexcept -> XTL_RETURN(mch::make_expr<FF>(mch::filter(std::forward<E>(e)),v)) \
-    template <typename F1, typename E1, typename E2, typename E>  inline auto XTL_CONCATENATE(operator,S)(const mch::expr<F1,E1,E2>& v,       E&&                  e) noexcept -> XTL_RETURN(mch::make_expr<FF>(v,mch::filter(std::forward<E>(e)))) \
-    template <typename F1, typename E1, typename E2, typename E>  inline auto XTL_CONCATENATE(operator,S)(      E&&                  e, const mch::expr<F1,E1,E2>& v) noexcept -> XTL_RETURN(mch::make_expr<FF>(mch::filter(std::forward<E>(e)),v)) \
-    template <typename T,  typename U>                            inline auto XTL_CONCATENATE(operator,S)(const mch::value<T>&       v, const mch::value<U>&       c) noexcept -> XTL_RETURN(mch::make_expr<FF>(v,c)) \
-    template <typename T,  typename U>                            inline auto XTL_CONCATENATE(operator,S)(      mch::var<T>&         v,       mch::var<U>&         w) noexcept -> XTL_RETURN(mch::make_expr<FF>(mch::ref2<mch::var<T>>(v),mch::ref2<mch::var<T>>(w))) \
+  /*template <typename T,  typename E>                            constexpr auto XTL_CONCATENATE(operator,S)(      mch::var<T>&         v,       E&&                  e) noexcept -> XTL_RETURN(mch::make_expr<FF>(mch::ref2<mch::var<T>>(v),mch::filter(std::forward<E>(e))))*/ \
+    template <typename T,  typename E>                            constexpr auto XTL_CONCATENATE(operator,S)(      mch::var<T>&         v,       E&&                  e) noexcept -> mch::expr<FF,mch::ref2<mch::var<T>>,decltype(mch::filter(std::forward<E>(e)))> { return mch::make_expr<FF>(mch::ref2<mch::var<T>>(v),mch::filter(std::forward<E>(e))); } \
+  /*template <typename T,  typename E>                            constexpr auto XTL_CONCATENATE(operator,S)(      E&&                  e,            mch::var<T>&    v) noexcept -> XTL_RETURN(mch::make_expr<FF>(mch::filter(std::forward<E>(e)),mch::ref2<mch::var<T>>(v)))*/ \
+    template <typename T,  typename E>                            constexpr auto XTL_CONCATENATE(operator,S)(      E&&                  e,            mch::var<T>&    v) noexcept -> mch::expr<FF,decltype(mch::filter(std::forward<E>(e))),mch::ref2<mch::var<T>>> { return mch::make_expr<FF>(mch::filter(std::forward<E>(e)),mch::ref2<mch::var<T>>(v)); } \
+    template <typename T,  typename E>                            constexpr auto XTL_CONCATENATE(operator,S)(const mch::value<T>&       v,       E&&                  e) noexcept -> XTL_RETURN(mch::make_expr<FF>(v,mch::filter(std::forward<E>(e)))) \
+    template <typename T,  typename E>                            constexpr auto XTL_CONCATENATE(operator,S)(      E&&                  e, const mch::value<T>&       v) noexcept -> XTL_RETURN(mch::make_expr<FF>(mch::filter(std::forward<E>(e)),v)) \
+    template <typename F1, typename E1, typename E>               constexpr auto XTL_CONCATENATE(operator,S)(const mch::expr<F1,E1>&    v,       E&&                  e) noexcept -> XTL_RETURN(mch::make_expr<FF>(v,mch::filter(std::forward<E>(e)))) \
+    template <typename F1, typename E1, typename E>               constexpr auto XTL_CONCATENATE(operator,S)(      E&&                  e, const mch::expr<F1,E1>&    v) noexcept -> XTL_RETURN(mch::make_expr<FF>(mch::filter(std::forward<E>(e)),v)) \
+    template <typename F1, typename E1, typename E2, typename E>  constexpr auto XTL_CONCATENATE(operator,S)(const mch::expr<F1,E1,E2>& v,       E&&                  e) noexcept -> XTL_RETURN(mch::make_expr<FF>(v,mch::filter(std::forward<E>(e)))) \
+    template <typename F1, typename E1, typename E2, typename E>  constexpr auto XTL_CONCATENATE(operator,S)(      E&&                  e, const mch::expr<F1,E1,E2>& v) noexcept -> XTL_RETURN(mch::make_expr<FF>(mch::filter(std::forward<E>(e)),v)) \
+    template <typename T,  typename U>                            constexpr auto XTL_CONCATENATE(operator,S)(const mch::value<T>&       v, const mch::value<U>&       c) noexcept -> XTL_RETURN(mch::make_expr<FF>(v,c)) \
+    template <typename T,  typename U>                            constexpr auto XTL_CONCATENATE(operator,S)(      mch::var<T>&         v,       mch::var<U>&         w) noexcept -> XTL_RETURN(mch::make_expr<FF>(mch::ref2<mch::var<T>>(v),mch::ref2<mch::var<T>>(w))) \
     template <typename F1, typename E1, typename E2,                           \
-              typename F2, typename E3, typename E4>              inline auto XTL_CONCATENATE(operator,S)(const mch::expr<F1,E1,E2>& a, const mch::expr<F2,E3,E4>& b) noexcept -> XTL_RETURN(mch::make_expr<FF>(a,b)) \
-    template <typename T,  typename U>                            inline auto XTL_CONCATENATE(operator,S)(      mch::var<T>&         v, const mch::value<U>&       c) noexcept -> XTL_RETURN(mch::make_expr<FF>(mch::ref2<mch::var<T>>(v),c)) \
-    template <typename T,  typename U>                            inline auto XTL_CONCATENATE(operator,S)(const mch::value<U>&       c,       mch::var<T>&         v) noexcept -> XTL_RETURN(mch::make_expr<FF>(c,mch::ref2<mch::var<T>>(v))) \
-    template <typename T,  typename F1, typename E1, typename E2> inline auto XTL_CONCATENATE(operator,S)(const mch::expr<F1,E1,E2>& e,       mch::var<T>&         v) noexcept -> XTL_RETURN(mch::make_expr<FF>(e,mch::ref2<mch::var<T>>(v))) \
-    template <typename T,  typename F1, typename E1, typename E2> inline auto XTL_CONCATENATE(operator,S)(      mch::var<T>&         v, const mch::expr<F1,E1,E2>& e) noexcept -> XTL_RETURN(mch::make_expr<FF>(mch::ref2<mch::var<T>>(v),e)) \
-    template <typename T,  typename F1, typename E1, typename E2> inline auto XTL_CONCATENATE(operator,S)(const mch::expr<F1,E1,E2>& e, const mch::value<T>&       c) noexcept -> XTL_RETURN(mch::make_expr<FF>(e,c))                       \
-    template <typename T,  typename F1, typename E1, typename E2> inline auto XTL_CONCATENATE(operator,S)(const mch::value<T>&       c, const mch::expr<F1,E1,E2>& e) noexcept -> XTL_RETURN(mch::make_expr<FF>(c,e))
+              typename F2, typename E3, typename E4>              constexpr auto XTL_CONCATENATE(operator,S)(const mch::expr<F1,E1,E2>& a, const mch::expr<F2,E3,E4>& b) noexcept -> XTL_RETURN(mch::make_expr<FF>(a,b)) \
+    template <typename T,  typename U>                            constexpr auto XTL_CONCATENATE(operator,S)(      mch::var<T>&         v, const mch::value<U>&       c) noexcept -> XTL_RETURN(mch::make_expr<FF>(mch::ref2<mch::var<T>>(v),c)) \
+    template <typename T,  typename U>                            constexpr auto XTL_CONCATENATE(operator,S)(const mch::value<U>&       c,       mch::var<T>&         v) noexcept -> XTL_RETURN(mch::make_expr<FF>(c,mch::ref2<mch::var<T>>(v))) \
+    template <typename T,  typename F1, typename E1, typename E2> constexpr auto XTL_CONCATENATE(operator,S)(const mch::expr<F1,E1,E2>& e,       mch::var<T>&         v) noexcept -> XTL_RETURN(mch::make_expr<FF>(e,mch::ref2<mch::var<T>>(v))) \
+    template <typename T,  typename F1, typename E1, typename E2> constexpr auto XTL_CONCATENATE(operator,S)(      mch::var<T>&         v, const mch::expr<F1,E1,E2>& e) noexcept -> XTL_RETURN(mch::make_expr<FF>(mch::ref2<mch::var<T>>(v),e)) \
+    template <typename T,  typename F1, typename E1, typename E2> constexpr auto XTL_CONCATENATE(operator,S)(const mch::expr<F1,E1,E2>& e, const mch::value<T>&       c) noexcept -> XTL_RETURN(mch::make_expr<FF>(e,c))                       \
+    template <typename T,  typename F1, typename E1, typename E2> constexpr auto XTL_CONCATENATE(operator,S)(const mch::value<T>&       c, const mch::expr<F1,E1,E2>& e) noexcept -> XTL_RETURN(mch::make_expr<FF>(c,e))
 #endif
 //#include "../loop_over_operators.hpp"
 #include "../operators_preprocessed.hpp"
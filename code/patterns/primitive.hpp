@@ -47,6 +47,10 @@
 #include <type_traits>
 #include "common.hpp"
 
+#if XTL_OVERHEAD_ACCOUNTING
+#include "../overhead.hpp" // Counters of allocations, casts and updates
+#endif
+
 namespace mch ///< Mach7 library namespace
 {
 
@@ -58,7 +62,7 @@ namespace mch ///< Mach7 library namespace
 /// use of this variable will make sure the actual member is never invoked!
 struct wildcard
 {
-    wildcard() {}
+    constexpr wildcard() noexcept {}
     /// Type function returning a type that will be accepted by the pattern for
     /// a given subject type S. We use type function instead of an associated 
     /// type, because there is no a single accepted type for a #wildcard pattern
@@ -72,9 +76,9 @@ struct wildcard
     //       left hand side of a guard
 #if defined(__GNUC__)
     template <typename T>
-    bool operator()(const T&) const noexcept { return true; }
+    constexpr bool operator()(const T&) const noexcept { return true; }
 #else
-    bool operator()(...) const noexcept { return true; }
+    constexpr bool operator()(...) const noexcept { return true; }
 #endif
 };
 
@@ -88,18 +92,27 @@ static wildcard _;
 /// #is_pattern_ is a helper meta-predicate capable of distinguishing all our patterns
 template <> struct is_pattern_<wildcard> { static const bool value = true; };
 
+/// #pattern_cost_ is a helper meta-function estimating the cost of trying a pattern
+template <> struct pattern_cost_<wildcard> { static const unsigned int value = cost_of_wildcard; };
+
+/// #is_hoistable_ is a helper meta-predicate telling whether a pattern can be constructed once per clause
+template <> struct is_hoistable_<wildcard> { static const bool value = true; };
+
+/// #extractors_might_throw_ is a helper meta-predicate telling whether a pattern might throw from accessors of #bindings
+template <> struct extractors_might_throw_<wildcard> { static const bool value = false; };
+
 //------------------------------------------------------------------------------
 
 /// This is the specialization that makes the member not to be invoked when we
 /// are matching against the meta variable _ that matches everything.
 template <typename C, typename M>
-inline bool apply_expression(const wildcard&, const C*, M) noexcept
+constexpr bool apply_expression(const wildcard&, const C*, M) noexcept
 {
     return true;
 }
 
 template <typename C, typename M>
-inline bool apply_expression(const wildcard&,       C*, M) noexcept
+constexpr bool apply_expression(const wildcard&,       C*, M) noexcept
 {
     return true;
 }
@@ -117,12 +130,12 @@ struct value
     template <typename S> struct accepted_type_for { typedef T type; };
 
     typedef T result_type;   ///< Type of result when used in expression. Requirement of #LazyExpression concept
-    explicit value(const T&  t) noexcept : m_value(          t ) {}
-    explicit value(      T&& t) noexcept : m_value(std::move(t)) {}
-    value(const value&  v) noexcept : m_value(          v.m_value ) {} ///< Copy constructor
-    value(      value&& v) noexcept : m_value(std::move(v.m_value)) {} ///< Move constructor
-    bool operator()(const T& t) const noexcept { return m_value == t; }
-    operator const result_type&() const noexcept { return m_value; }// FIX: avoid implicit conversion in lazy expressions
+    constexpr explicit value(const T&  t) noexcept : m_value(          t ) {}
+    constexpr explicit value(      T&& t) noexcept : m_value(std::move(t)) {}
+    constexpr value(const value&  v) noexcept : m_value(          v.m_value ) {} ///< Copy constructor
+    constexpr value(      value&& v) noexcept : m_value(std::move(v.m_value)) {} ///< Move constructor
+    constexpr bool operator()(const T& t) const noexcept { return m_value == t; }
+    constexpr operator const result_type&() const noexcept { return m_value; }// FIX: avoid implicit conversion in lazy expressions
     T m_value;
 };
 
@@ -144,10 +157,10 @@ struct value<std::nullptr_t>
     template <typename S> struct accepted_type_for<S*> { typedef const S* type; };
 
     typedef std::nullptr_t result_type;   ///< Type of result when used in expression. Requirement of #LazyExpression concept
-    explicit value(const std::nullptr_t&) {}
-    value(const value&) noexcept {} ///< Copy constructor
-    bool operator()(const void* p) const noexcept { return p == nullptr; }
-    operator result_type() const noexcept { return nullptr; }// FIX: avoid implicit conversion in lazy expressions
+    constexpr explicit value(const std::nullptr_t&) {}
+    constexpr value(const value&) noexcept {} ///< Copy constructor
+    constexpr bool operator()(const void* p) const noexcept { return p == nullptr; }
+    constexpr operator result_type() const noexcept { return nullptr; }// FIX: avoid implicit conversion in lazy expressions
 };
 
 #endif
@@ -157,13 +170,22 @@ struct value<std::nullptr_t>
 /// #is_pattern_ is a helper meta-predicate capable of distinguishing all our patterns
 template <typename T> struct is_pattern_<value<T>>    { static const bool value = true; };
 
+/// #pattern_cost_ is a helper meta-function estimating the cost of trying a pattern
+template <typename T> struct pattern_cost_<value<T>>   { static const unsigned int value = cost_of_value; };
+
+/// #is_hoistable_ is a helper meta-predicate telling whether a pattern can be constructed once per clause
+template <typename T> struct is_hoistable_<value<T>>   { static const bool value = true; };
+
+/// #extractors_might_throw_ is a helper meta-predicate telling whether a pattern might throw from accessors of #bindings
+template <typename T> struct extractors_might_throw_<value<T>> { static const bool value = false; };
+
 /// #is_expression_ is a helper meta-predicate that separates lazily evaluatable expressions we support
 template <typename T> struct is_expression_<value<T>> { static const bool value = true; };
 
 //------------------------------------------------------------------------------
 
 /// Convenience function for creating value patterns
-template <class T> inline value<typename underlying<T>::type> val(T&& t) 
+template <class T> constexpr value<typename underlying<T>::type> val(T&& t) 
 {
     return value<typename underlying<T>::type>(std::forward<T>(t)); 
 }
@@ -181,15 +203,21 @@ struct transparent_wrapper
 #if XTL_SUPPORT(ddf)
     transparent_wrapper() = default;
 #else // Emulate to the extent possible
-    transparent_wrapper() : m_value() {}
+    constexpr transparent_wrapper() : m_value() {}
 #endif
-    explicit transparent_wrapper(const T&  t) noexcept : m_value(          t ) {}
-    explicit transparent_wrapper(      T&& t) noexcept : m_value(std::move(t)) {}
+    constexpr explicit transparent_wrapper(const T&  t) noexcept : m_value(          t ) {}
+    constexpr explicit transparent_wrapper(      T&& t) noexcept : m_value(std::move(t)) {}
+
+#if XTL_CONSTEXPR_VARIABLES
+    T m_value; // Constant evaluation cannot read mutable members, see #XTL_CONSTEXPR_VARIABLES
 
+    XTL_CONSTEXPR14 T& value() const { return const_cast<T&>(m_value); }
+#else
     mutable T m_value;
 
-    T& value() const { return m_value; }
-    T& value()       { return m_value; }
+    XTL_CONSTEXPR14 T& value() const { return m_value; }
+#endif
+    XTL_CONSTEXPR14 T& value()       { return m_value; }
 };
 
 template <typename T>
@@ -198,16 +226,16 @@ struct transparent_wrapper<T,typename std::enable_if<std::is_class<T>::value>::t
 #if XTL_SUPPORT(inheriting_constructors)
     using T::T;
 #else // Emulate to the extent possible
-    transparent_wrapper() : T() {} // Assume T has default constructor
+    constexpr transparent_wrapper() : T() {} // Assume T has default constructor
 #endif
 #if XTL_SUPPORT(ddf)
     transparent_wrapper() = default;
 #endif
-    explicit transparent_wrapper(const T&  t) noexcept : T(          t ) {}
-    explicit transparent_wrapper(      T&& t) noexcept : T(std::move(t)) {}
+    constexpr explicit transparent_wrapper(const T&  t) noexcept : T(          t ) {}
+    constexpr explicit transparent_wrapper(      T&& t) noexcept : T(std::move(t)) {}
 
-    T& value() const { return *const_cast<T*>(static_cast<const T*>(this)); }
-    T& value()       { return *this; }
+    XTL_CONSTEXPR14 T& value() const { return *const_cast<T*>(static_cast<const T*>(this)); }
+    XTL_CONSTEXPR14 T& value()       { return *this; }
 };
 
 /// Variable binding for a value type
@@ -218,9 +246,9 @@ struct var : transparent_wrapper<T>
 #if XTL_SUPPORT(inheriting_constructors)
     using base::base;
 #endif
-    var() : base() {}
-    explicit var(const T&  t) noexcept : base(          t ) {}
-    explicit var(      T&& t) noexcept : base(std::move(t)) {}
+    constexpr var() : base() {}
+    constexpr explicit var(const T&  t) noexcept : base(          t ) {}
+    constexpr explicit var(      T&& t) noexcept : base(std::move(t)) {}
 //    var(const var&  v) noexcept : m_value(          v.m_value ) {} ///< Copy constructor
 //    var(      var&& v) noexcept : m_value(std::move(v.m_value)) {} ///< Move constructor
 
@@ -233,28 +261,36 @@ struct var : transparent_wrapper<T>
     typedef T result_type;   ///< Type of result when used in expression. Requirement of #LazyExpression concept
 
     /// We report that matching succeeded and bind the value
-    bool operator()(const T& t) const
+    XTL_CONSTEXPR14 bool operator()(const T& t) const
     {
         base::value() = t;
         return true;
     }
 
+    /// Values computed for the match (e.g. returned by a getter or an extractor)
+    /// are moved instead of copied, so binding them does not allocate
+    XTL_CONSTEXPR14 bool operator()(T&& t) const
+    {
+        base::value() = std::move(t);
+        return true;
+    }
+
     /// This operator is used when the type of the subject is different from
     /// the type of the variable. By default, we try to execute the assignment,
     /// but then check that the values are equal. This often helps when trying
     /// to match a negative value against an unsigned variable.
     template <typename U>
-    bool operator()(const U& u) const
+    XTL_CONSTEXPR14 bool operator()(const U& u) const
     {
         base::value() = u;
         return base::value() == u;
     }
 
-    var& operator=(const T& t) { base::value() = t; return *this; }
+    XTL_CONSTEXPR14 var& operator=(const T& t) { base::value() = t; return *this; }
 
     /// Helper conversion operator to let the variable be used in some places
     /// where T was allowed
-    operator const result_type&() const noexcept { return base::value(); }
+    XTL_CONSTEXPR14 operator const result_type&() const noexcept { return base::value(); }
 };
 
 //------------------------------------------------------------------------------
@@ -263,11 +299,11 @@ struct var : transparent_wrapper<T>
 template <class T>
 struct var
 {
-    var() : m_value() {}
-    explicit var(const T&  t) noexcept : m_value(          t ) {}
-    explicit var(      T&& t) noexcept : m_value(std::move(t)) {}
-    var(const var&  v) noexcept : m_value(          v.m_value ) {} ///< Copy constructor
-    var(      var&& v) noexcept : m_value(std::move(v.m_value)) {} ///< Move constructor
+    constexpr var() : m_value() {}
+    constexpr explicit var(const T&  t) noexcept : m_value(          t ) {}
+    constexpr explicit var(      T&& t) noexcept : m_value(std::move(t)) {}
+    constexpr var(const var&  v) noexcept : m_value(          v.m_value ) {} ///< Copy constructor
+    constexpr var(      var&& v) noexcept : m_value(std::move(v.m_value)) {} ///< Move constructor
 
     /// Type function returning a type that will be accepted by the pattern for
     /// a given subject type S. We use type function instead of an associated 
@@ -278,31 +314,39 @@ struct var
     typedef T result_type;   ///< Type of result when used in expression. Requirement of #LazyExpression concept
 
     /// We report that matching succeeded and bind the value
-    bool operator()(const T& t) const
+    XTL_CONSTEXPR14 bool operator()(const T& t) const
     {
         m_value = t;
         return true;
     }
 
+    /// Values computed for the match (e.g. returned by a getter or an extractor)
+    /// are moved instead of copied, so binding them does not allocate
+    XTL_CONSTEXPR14 bool operator()(T&& t) const
+    {
+        m_value = std::move(t);
+        return true;
+    }
+
     /// This operator is used when the type of the subject is different from
     /// the type of the variable. By default, we try to execute the assignment,
     /// but then check that the values are equal. This often helps when trying 
     /// to match a negative value against an unsigned variable.
     template <typename U>
-    bool operator()(const U& u) const
+    XTL_CONSTEXPR14 bool operator()(const U& u) const
     {
         m_value = u;
         return m_value == u;
     }
 
-    var& operator=(const T& t) { m_value = t; return *this; }
+    XTL_CONSTEXPR14 var& operator=(const T& t) { m_value = t; return *this; }
 
     /// Helper conversion operator to let the variable be used in some places
     /// where T was allowed
-    operator const result_type&() const noexcept { return m_value; }
+    constexpr operator const result_type&() const noexcept { return m_value; }
 
 #if !defined(XTL_TRANSPARENT_WRAPPER)
-    T& value() const { return m_value; } // Only used for compatibility with var implementation based on transparent_wrapper
+    XTL_CONSTEXPR14 T& value() const { return m_value; } // Only used for compatibility with var implementation based on transparent_wrapper
 #endif
     /// Member that will hold matching value in case of successful matching
     mutable T m_value;
@@ -310,13 +354,14 @@ struct var
 #endif
 //------------------------------------------------------------------------------
 
-/// Variable binding for a pointer type
+/// Variable binding by reference: binds a pointer to the matched object and
+/// thus never copies it, e.g. var<const std::string&> on a data member
 template <class T>
 struct var<T&>
 {
-    var() : m_value() {}
-    var(const var&  v) noexcept : m_value(          v.m_value ) {} ///< Copy constructor
-    var(      var&& v) noexcept : m_value(std::move(v.m_value)) {} ///< Move constructor
+    constexpr var() : m_value() {}
+    constexpr var(const var&  v) noexcept : m_value(          v.m_value ) {} ///< Copy constructor
+    constexpr var(      var&& v) noexcept : m_value(std::move(v.m_value)) {} ///< Move constructor
 
     /// Type function returning a type that will be accepted by the pattern for
     /// a given subject type S. We use type function instead of an associated 
@@ -334,6 +379,8 @@ struct var<T&>
     typename std::enable_if<std::is_polymorphic<U>::value && std::is_polymorphic<T>::value, bool>::type
     operator()(const U& u) const
     {
+        XTL_OVERHEAD_ACCOUNTING_ONLY(mch::count_type_test_cast<T,U>());
+
         if (const T* t = dynamic_cast<const T*>(&u))
             return operator()(*t);
         else
@@ -341,7 +388,7 @@ struct var<T&>
     }
 
     /// This distinguishes the case when type of the variable matches type of the member
-    bool operator()(const result_type& t) const
+    XTL_CONSTEXPR14 bool operator()(const result_type& t) const
     {
         // NOTE: This will also assign the null pointer. Should it?
         m_value = &t;
@@ -349,18 +396,23 @@ struct var<T&>
     }
 
     /// This distinguishes the case when type of the variable matches type of the member
-    bool operator()(result_type& t) const
+    XTL_CONSTEXPR14 bool operator()(result_type& t) const
     {
         // NOTE: This will also assign the null pointer. Should it?
         m_value = &t;
         return true;
     }
 
+    /// Binding a reference to a value computed for the match (e.g. returned by a
+    /// getter) would leave it dangling in the clause body: use var<T> instead,
+    /// which will move such a value.
+    bool operator()(result_type&& t) const = delete;
+
     /// NOTE: Only as a convinience to avoid too often used of address pattern, our
     ///       variable pattern on references will bind to pointer of the result type
     /// FIX:  To support this functionality, all pattern combinators like equivalence,
     ///       negation etc. will have to provide forwarding for pointers on them! 
-    bool operator()(const result_type* t) const
+    XTL_CONSTEXPR14 bool operator()(const result_type* t) const
     {
         m_value = t;
         return t;
@@ -370,21 +422,26 @@ struct var<T&>
     ///       variable pattern on references will bind to pointer of the result type
     /// FIX:  To support this functionality, all pattern combinators like equivalence,
     ///       negation etc. will have to provide forwarding for pointers on them! 
-    bool operator()(result_type* t) const
+    XTL_CONSTEXPR14 bool operator()(result_type* t) const
     {
         m_value = t;
         return t;
     }
 
     /// We overload assignment to allow variables be assigned in the RHS
-    var& operator=(const T& t) {*m_value = t; return *this; }
+    XTL_CONSTEXPR14 var& operator=(const T& t) {*m_value = t; return *this; }
 
     /// Helper conversion operator to let the variable be used in some places
     /// where T was allowed
     /// \note If you get assertion here, it means you are trying to use the 
     ///       value of this reference variable before it was bound (i.e. used 
     ///       in pattern matching context to get its value).
-    operator const result_type&() const noexcept { XTL_ASSERT(m_value); return *m_value; }
+    XTL_CONSTEXPR14 operator const result_type&() const noexcept { XTL_ASSERT(m_value); return *m_value; }
+
+    /// Access to the bound object, which lets clauses use its members without
+    /// copying it, e.g. s->size() or s.value().data()
+    XTL_CONSTEXPR14 T& value()      const noexcept { XTL_ASSERT(m_value); return *m_value; }
+    XTL_CONSTEXPR14 T* operator->() const noexcept { XTL_ASSERT(m_value); return  m_value; }
 
     /// Member that will hold matching value in case of successful matching
     mutable T* m_value;
@@ -395,6 +452,12 @@ struct var<T&>
 /// #is_pattern_ is a helper meta-predicate capable of distinguishing all our patterns
 template <typename T> struct is_pattern_<var<T>>    { static const bool value = true; };
 
+/// #pattern_cost_ is a helper meta-function estimating the cost of trying a pattern
+template <typename T> struct pattern_cost_<var<T>>   { static const unsigned int value = cost_of_value; };
+
+/// #extractors_might_throw_ is a helper meta-predicate telling whether a pattern might throw from accessors of #bindings
+template <typename T> struct extractors_might_throw_<var<T>> { static const bool value = false; };
+
 /// #is_expression_ is a helper meta-predicate that separates lazily evaluatable expressions we support
 template <typename T> struct is_expression_<var<T>> { static const bool value = true; };
 
@@ -413,9 +476,9 @@ template <typename T> struct is_var<var<T>> { static const bool value = true;  }
 template <class T>
 struct ref0
 {
-    explicit ref0(T& var) : m_var(var) {}
-    ref0(const ref0&  v) noexcept : m_var(v.m_var) {} ///< Copy constructor
-    ref0(      ref0&& v) noexcept : m_var(v.m_var) {} ///< Move constructor
+    constexpr explicit ref0(T& var) : m_var(var) {}
+    constexpr ref0(const ref0&  v) noexcept : m_var(v.m_var) {} ///< Copy constructor
+    constexpr ref0(      ref0&& v) noexcept : m_var(v.m_var) {} ///< Move constructor
     ref0& operator=(const ref0&); ///< Assignment is not allowed for this class
 
     /// Type function returning a type that will be accepted by the pattern for
@@ -425,11 +488,11 @@ struct ref0
     template <typename S> struct accepted_type_for { typedef T type; };
 
     typedef T result_type;   ///< Type of result when used in expression. Requirement of #LazyExpression concept
-    operator const result_type&() const noexcept { return m_var; } // FIX: avoid implicit conversion in lazy expressions
+    constexpr operator const result_type&() const noexcept { return m_var; } // FIX: avoid implicit conversion in lazy expressions
     //operator       result_type&() const noexcept { return m_var; }
 
     /// We report that matching succeeded and bind the value
-    bool operator()(const T& t) const
+    XTL_CONSTEXPR14 bool operator()(const T& t) const
     {
         m_var = t;
         return true;
@@ -440,7 +503,7 @@ struct ref0
     /// but then check that the values are equal. This often helps when trying 
     /// to match a negative value against an unsigned variable.
     template <typename U>
-    bool operator()(const U& u) const
+    XTL_CONSTEXPR14 bool operator()(const U& u) const
     {
         m_var = u;
         return m_var == u;
@@ -457,9 +520,9 @@ struct ref1
 {
     static_assert(is_pattern<P>::value, "ref1<P> can only be instantiated on classes P modeling Pattern concept");
 
-    explicit ref1(P& pat) : m_pat(pat) {}
-    ref1(const ref1&  v) noexcept : m_pat(v.m_pat) {} ///< Copy constructor
-    ref1(      ref1&& v) noexcept : m_pat(v.m_pat) {} ///< Move constructor
+    constexpr explicit ref1(P& pat) : m_pat(pat) {}
+    constexpr ref1(const ref1&  v) noexcept : m_pat(v.m_pat) {} ///< Copy constructor
+    constexpr ref1(      ref1&& v) noexcept : m_pat(v.m_pat) {} ///< Move constructor
     ref1& operator=(const ref1&); ///< Assignment is not allowed for this class
 
     /// Type function returning a type that will be accepted by the pattern for
@@ -469,7 +532,7 @@ struct ref1
     template <typename S> struct accepted_type_for : P::template accepted_type_for<S> {};
 
     /// We report that matching succeeded and bind the value
-    template <typename T> bool operator()(T&& t) const { return m_pat(std::forward<T>(t)); }
+    template <typename T> constexpr bool operator()(T&& t) const { return m_pat(std::forward<T>(t)); }
 
     /// Member that will hold matching value in case of successful matching
     P& m_pat;
@@ -482,14 +545,14 @@ struct ref2 : ref1<E>
 {
     static_assert(is_expression<E>::value, "ref2<E> can only be instantiated on classes E modeling LazyExpression concept");
 
-    explicit ref2(E& e) : ref1<E>(e) {}
-    ref2(const ref2&  v) noexcept : ref1<E>(          v ) {} ///< Copy constructor
-    ref2(      ref2&& v) noexcept : ref1<E>(std::move(v)) {} ///< Move constructor
+    constexpr explicit ref2(E& e) : ref1<E>(e) {}
+    constexpr ref2(const ref2&  v) noexcept : ref1<E>(          v ) {} ///< Copy constructor
+    constexpr ref2(      ref2&& v) noexcept : ref1<E>(std::move(v)) {} ///< Move constructor
     ref2& operator=(const ref2&); ///< Assignment is not allowed for this class
 
     typedef typename E::result_type result_type;   ///< Type of result when used in expression. Requirement of #LazyExpression concept
 
-    operator const result_type&() const noexcept { return eval(this->m_pat); } // FIX: avoid implicit conversion in lazy expressions
+    constexpr operator const result_type&() const noexcept { return eval(this->m_pat); } // FIX: avoid implicit conversion in lazy expressions
 };
 
 //------------------------------------------------------------------------------
@@ -499,6 +562,16 @@ template <typename T> struct is_pattern_<ref0<T>>    { static const bool value =
 template <typename T> struct is_pattern_<ref1<T>>    { static const bool value = true; };
 template <typename T> struct is_pattern_<ref2<T>>    { static const bool value = true; };
 
+/// #pattern_cost_ is a helper meta-function estimating the cost of trying a pattern
+template <typename T> struct pattern_cost_<ref0<T>>   { static const unsigned int value = cost_of_value; };
+template <typename T> struct pattern_cost_<ref1<T>> : pattern_cost<T> {};
+template <typename T> struct pattern_cost_<ref2<T>> : pattern_cost<T> {};
+
+/// #extractors_might_throw_ is a helper meta-predicate telling whether a pattern might throw from accessors of #bindings
+template <typename T> struct extractors_might_throw_<ref0<T>> { static const bool value = false; };
+template <typename T> struct extractors_might_throw_<ref1<T>> : extractors_might_throw<T> {};
+template <typename T> struct extractors_might_throw_<ref2<T>> : extractors_might_throw<T> {};
+
 /// #is_expression_ is a helper meta-predicate that separates lazily evaluatable expressions we support
 template <typename T> struct is_expression_<ref0<T>> { static const bool value = true; };
 template <typename T> struct is_expression_<ref2<T>> { static const bool value = true; };
@@ -506,7 +579,7 @@ template <typename T> struct is_expression_<ref2<T>> { static const bool value =
 //------------------------------------------------------------------------------
 
 /// Convenience function for creating variable patterns out of existing variables
-template <class T> inline ref0<T> var_from(T& t) { return ref0<T>(t); }
+template <class T> constexpr ref0<T> var_from(T& t) { return ref0<T>(t); }
 
 //------------------------------------------------------------------------------
 
@@ -516,11 +589,11 @@ template <class T> inline ref0<T> var_from(T& t) { return ref0<T>(t); }
 /// patterns. Various parts of the Mach7 library call this function to enable 
 /// this behavior. This particular overload does nothing on patterns, other 
 /// overloads can be found in the header with primitive patterns.
-template <typename P> inline typename std::enable_if< is_pattern<P>::value,       P >::type filter(          P&& p) noexcept { return std::forward<P>(p); }
-template <typename T> inline                                       ref2<const var<T>>       filter(const var<T>& t) noexcept { return ref2<const var<T>>(t); } // We need this because some patterns may not need to modify the variable: e.g. equivalence
-template <typename T> inline                                       ref2<      var<T>>       filter(      var<T>& t) noexcept { return ref2<      var<T>>(t); } // This one is needed for patterns that will modify the variable.
-template <typename T> inline typename std::enable_if<!is_pattern<T>::value, value<T>>::type filter(const     T & t) noexcept { return value<T>(t); }
-template <typename T> inline typename std::enable_if<!is_pattern<T>::value,  ref0<T>>::type filter(          T & t) noexcept { return ref0<T>(t); }
+template <typename P> constexpr typename std::enable_if< is_pattern<P>::value,       P >::type filter(          P&& p) noexcept { return std::forward<P>(p); }
+template <typename T> constexpr                                       ref2<const var<T>>       filter(const var<T>& t) noexcept { return ref2<const var<T>>(t); } // We need this because some patterns may not need to modify the variable: e.g. equivalence
+template <typename T> constexpr                                       ref2<      var<T>>       filter(      var<T>& t) noexcept { return ref2<      var<T>>(t); } // This one is needed for patterns that will modify the variable.
+template <typename T> constexpr typename std::enable_if<!is_pattern<T>::value, value<T>>::type filter(const     T & t) noexcept { return value<T>(t); }
+template <typename T> constexpr typename std::enable_if<!is_pattern<T>::value,  ref0<T>>::type filter(          T & t) noexcept { return ref0<T>(t); }
 ///@}
 
 //------------------------------------------------------------------------------
@@ -529,15 +602,15 @@ template <typename T> inline typename std::enable_if<!is_pattern<T>::value,  ref
 /// Set of overloads capable of decomposing an expression template that models
 /// an Expression concept and evaluating it.
 /// \note See header files of other patterns for more overloads!
-template <typename T> inline const T& eval(const value<T>& e) { return e.m_value; }
-template <typename T> inline const T& eval(const var<T >&  e) { return e.value(); }
-template <typename T> inline       T& eval(      var<T >&  e) { return e.value(); }
-template <typename T> inline const T& eval(const var<T&>&  e) { XTL_ASSERT(e.m_value); return *e.m_value; } ///< \note If you get assertion here, it means you are trying to use the value of this reference variable before it was bound (i.e. used in pattern matching context to get its value).
-template <typename T> inline       T& eval(      var<T&>&  e) { XTL_ASSERT(e.m_value); return *e.m_value; } ///< \note If you get assertion here, it means you are trying to use the value of this reference variable before it was bound (i.e. used in pattern matching context to get its value).
-template <typename T> inline const T& eval(const ref0<T>&  e) { return e.m_var; }
-template <typename T> inline       T& eval(      ref0<T>&  e) { return e.m_var; }
-template <typename E> inline     auto eval(const ref2<E>&  e) -> typename std::enable_if<is_expression<E>::value, decltype(eval(e.m_pat))>::type { return eval(e.m_pat); }
-template <typename E> inline     auto eval(      ref2<E>&  e) -> typename std::enable_if<is_expression<E>::value, decltype(eval(e.m_pat))>::type { return eval(e.m_pat); }
+template <typename T> constexpr const T& eval(const value<T>& e) { return e.m_value; }
+template <typename T> constexpr const T& eval(const var<T >&  e) { return e.value(); }
+template <typename T> constexpr       T& eval(      var<T >&  e) { return e.value(); }
+template <typename T> XTL_CONSTEXPR14 const T& eval(const var<T&>&  e) { XTL_ASSERT(e.m_value); return *e.m_value; } ///< \note If you get assertion here, it means you are trying to use the value of this reference variable before it was bound (i.e. used in pattern matching context to get its value).
+template <typename T> XTL_CONSTEXPR14       T& eval(      var<T&>&  e) { XTL_ASSERT(e.m_value); return *e.m_value; } ///< \note If you get assertion here, it means you are trying to use the value of this reference variable before it was bound (i.e. used in pattern matching context to get its value).
+template <typename T> constexpr const T& eval(const ref0<T>&  e) { return e.m_var; }
+template <typename T> constexpr       T& eval(      ref0<T>&  e) { return e.m_var; }
+template <typename E> constexpr     auto eval(const ref2<E>&  e) -> typename std::enable_if<is_expression<E>::value, decltype(eval(e.m_pat))>::type { return eval(e.m_pat); }
+template <typename E> constexpr     auto eval(      ref2<E>&  e) -> typename std::enable_if<is_expression<E>::value, decltype(eval(e.m_pat))>::type { return eval(e.m_pat); }
 ///@}
 
 //------------------------------------------------------------------------------
@@ -35,6 +35,19 @@
 ///
 /// This file defines existential patterns supported by our library.
 ///
+/// Quantifiers given the #par execution policy evaluate their pattern on the
+/// elements of a random-access subject concurrently:
+/// \code
+///     bool any_negative = exist(par,    is_negative)(v);
+///     bool all_small    = all  (par(4), is_small)(v); // On 4 threads
+/// \endcode
+/// Threads take blocks of elements from a shared counter and all of them stop
+/// at their next block once any thread finds a witness (a counterexample for
+/// #all). Since the pattern is applied from several threads, it has to be safe
+/// to apply concurrently: in particular it should not bind variables, as which
+/// of the witnesses a variable would end up bound to is not determined.
+/// Subjects that are not random-access are quantified over sequentially.
+///
 /// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
 ///
 /// \see https://parasol.tamu.edu/mach7/
@@ -45,6 +58,13 @@
 #pragma once
 
 #include "primitive.hpp" // FIX: Ideally this should be common.hpp, but GCC seem to disagree: http://gcc.gnu.org/bugzilla/show_bug.cgi?id=55460
+#include "sequence.hpp"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace mch ///< Mach7 library namespace
 {
@@ -71,7 +91,12 @@ struct existential
     template <typename C>
     bool operator()(const C& c) const 
     {
-        for (typename C::const_iterator p = c.begin(); p != c.end(); ++p)
+        // Elements are visited lazily and only until the first witness, so
+        // the subject can be any range, including a #range_view of single-pass
+        // or unbounded iterators.
+        typedef typename range_iterator<C>::type iterator;
+
+        for (iterator p = detail::range_begin(c), e = detail::range_end(c); p != e; ++p)
             if (m_p1(*p))
                 return true;
         return false; 
@@ -85,6 +110,9 @@ struct existential
 /// #is_pattern_ is a helper meta-predicate capable of distinguishing all our patterns
 template <typename P1> struct is_pattern_<existential<P1>> { static const bool value = true; };
 
+/// #is_hoistable_ is a helper meta-predicate telling whether a pattern can be constructed once per clause
+template <typename P1> struct is_hoistable_<existential<P1>> : is_hoistable<P1> {};
+
 //------------------------------------------------------------------------------
 
 template <typename P1>
@@ -122,7 +150,12 @@ struct universal
     template <typename C>
     bool operator()(const C& c) const 
     {
-        for (typename C::const_iterator p = c.begin(); p != c.end(); ++p)
+        // Elements are visited lazily and only until the first counterexample, so
+        // the subject can be any range, including a #range_view of single-pass
+        // or unbounded iterators.
+        typedef typename range_iterator<C>::type iterator;
+
+        for (iterator p = detail::range_begin(c), e = detail::range_end(c); p != e; ++p)
             if (!m_p1(*p))
                 return false;
         return true; 
@@ -136,6 +169,9 @@ struct universal
 /// #is_pattern_ is a helper meta-predicate capable of distinguishing all our patterns
 template <typename P1> struct is_pattern_<universal<P1>> { static const bool value = true; };
 
+/// #is_hoistable_ is a helper meta-predicate telling whether a pattern can be constructed once per clause
+template <typename P1> struct is_hoistable_<universal<P1>> : is_hoistable<P1> {};
+
 //------------------------------------------------------------------------------
 
 template <typename P1>
@@ -153,6 +189,220 @@ inline auto all(P1&& p1) noexcept
 
 //------------------------------------------------------------------------------
 
+/// Execution policy of quantifiers evaluating their pattern concurrently
+struct parallel_policy
+{
+    explicit parallel_policy(size_t threads = 0) noexcept : m_threads(threads) {}
+
+    /// Same policy limited to the given number of threads, e.g. par(4)
+    parallel_policy operator()(size_t threads) const noexcept { return parallel_policy(threads); }
+
+    size_t m_threads; ///< Number of threads including the calling one, 0 means hardware concurrency
+};
+
+/// Policy tag of parallel quantifiers: exist(par, p), all(par, p)
+const parallel_policy par;
+
+//------------------------------------------------------------------------------
+
+namespace detail
+{
+    /// Tells whether any element in [first,last) satisfies pred, trying them on
+    /// up to the given number of threads. Exceptions thrown by pred stop all
+    /// threads and the first one is rethrown.
+    template <typename I, typename F>
+    bool parallel_any(const I& first, const I& last, const F& pred, size_t threads, std::true_type /*random access*/)
+    {
+        const size_t n     = size_t(last - first);
+        const size_t block = 1024; // Elements taken by a thread at once and between checks for a witness
+
+        if (threads == 0)
+            threads = std::thread::hardware_concurrency();
+
+        threads = std::max(size_t(1), std::min(threads, (n + block - 1) / block));
+
+        if (threads == 1)
+        {
+            for (size_t j = 0; j < n; ++j)
+                if (pred(first[j]))
+                    return true;
+            return false;
+        }
+
+        std::atomic<size_t> next(0);
+        std::atomic<bool>   found(false);
+        std::mutex          error_mutex;
+        std::exception_ptr  error;
+
+        auto work = [&]()
+        {
+            try
+            {
+                for (size_t b; !found.load(std::memory_order_relaxed) && (b = next.fetch_add(block)) < n; )
+                    for (size_t j = b, e = std::min(n, b + block); j < e; ++j)
+                        if (pred(first[j]))
+                        {
+                            found = true;
+                            break;
+                        }
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> guard(error_mutex);
+
+                if (!error)
+                    error = std::current_exception();
+
+                found = true;
+            }
+        };
+
+        std::vector<std::thread> helpers;
+
+        for (size_t i = 1; i < threads; ++i)
+            helpers.push_back(std::thread(work));
+
+        work();
+
+        for (size_t i = 0; i < helpers.size(); ++i)
+            helpers[i].join();
+
+        if (error)
+            std::rethrow_exception(error);
+
+        return found;
+    }
+
+    /// Iterators that are not random-access are stepped through sequentially
+    template <typename I, typename F>
+    bool parallel_any(I first, const I& last, const F& pred, size_t, std::false_type /*random access*/)
+    {
+        for (; first != last; ++first)
+            if (pred(*first))
+                return true;
+        return false;
+    }
+
+    /// Predicate telling whether pattern P1 accepts an element when Accepts is 
+    /// true, and whether it rejects it otherwise
+    template <typename P1, bool Accepts>
+    struct pattern_accepts
+    {
+        explicit pattern_accepts(const P1& p1) noexcept : m_p1(p1) {}
+        template <typename T> bool operator()(const T& x) const { return bool(m_p1(x)) == Accepts; }
+        const P1& m_p1;
+    };
+
+    /// Tells whether pattern p1 accepts (or rejects, when Accepts is false) any
+    /// element of range c, trying elements concurrently when c is random-access
+    template <bool Accepts, typename C, typename P1>
+    bool parallel_any(const C& c, const P1& p1, size_t threads)
+    {
+        typedef typename range_iterator<C>::type iterator;
+        return parallel_any(range_begin(c), range_end(c), pattern_accepts<P1,Accepts>(p1), threads, std::integral_constant<bool, is_random_access<iterator>::value>());
+    }
+} // of namespace detail
+
+//------------------------------------------------------------------------------
+
+/// Existential quantifier evaluating its pattern concurrently, \see #par
+template <typename P1>
+struct parallel_existential
+{
+    static_assert(is_pattern<P1>::value, "Argument P1 of an existential quantifier pattern must be a pattern");
+
+    parallel_existential(const parallel_policy& pp, const P1&  p) noexcept : m_p1(          p ), m_threads(pp.m_threads) {}
+    parallel_existential(const parallel_policy& pp,       P1&& p) noexcept : m_p1(std::move(p)), m_threads(pp.m_threads) {}
+    parallel_existential(const parallel_existential&  e) noexcept : m_p1(          e.m_p1 ), m_threads(e.m_threads) {} ///< Copy constructor
+    parallel_existential(      parallel_existential&& e) noexcept : m_p1(std::move(e.m_p1)), m_threads(e.m_threads) {} ///< Move constructor
+    parallel_existential& operator=(const parallel_existential&); ///< Assignment is not allowed for this class
+
+    /// Type function returning a type that will be accepted by the pattern for
+    /// a given subject type S. \see existential::accepted_type_for
+    template <typename S> struct accepted_type_for { typedef S type; };
+
+    template <typename C>
+    bool operator()(const C& c) const 
+    {
+        return detail::parallel_any<true>(c, m_p1, m_threads);
+    }
+
+    P1     m_p1;
+    size_t m_threads;
+};
+
+//------------------------------------------------------------------------------
+
+/// Universal quantifier evaluating its pattern concurrently, \see #par
+template <typename P1>
+struct parallel_universal
+{
+    static_assert(is_pattern<P1>::value, "Argument P1 of an universal quantifier pattern must be a pattern");
+
+    parallel_universal(const parallel_policy& pp, const P1&  p) noexcept : m_p1(          p ), m_threads(pp.m_threads) {}
+    parallel_universal(const parallel_policy& pp,       P1&& p) noexcept : m_p1(std::move(p)), m_threads(pp.m_threads) {}
+    parallel_universal(const parallel_universal&  e) noexcept : m_p1(          e.m_p1 ), m_threads(e.m_threads) {} ///< Copy constructor
+    parallel_universal(      parallel_universal&& e) noexcept : m_p1(std::move(e.m_p1)), m_threads(e.m_threads) {} ///< Move constructor
+    parallel_universal& operator=(const parallel_universal&); ///< Assignment is not allowed for this class
+
+    /// Type function returning a type that will be accepted by the pattern for
+    /// a given subject type S. \see universal::accepted_type_for
+    template <typename S> struct accepted_type_for { typedef S type; };
+
+    template <typename C>
+    bool operator()(const C& c) const 
+    {
+        return !detail::parallel_any<false>(c, m_p1, m_threads);
+    }
+
+    P1     m_p1;
+    size_t m_threads;
+};
+
+//------------------------------------------------------------------------------
+
+/// #is_pattern_ is a helper meta-predicate capable of distinguishing all our patterns
+template <typename P1> struct is_pattern_<parallel_existential<P1>> { static const bool value = true; };
+template <typename P1> struct is_pattern_<parallel_universal<P1>>   { static const bool value = true; };
+
+/// #is_hoistable_ is a helper meta-predicate telling whether a pattern can be constructed once per clause
+template <typename P1> struct is_hoistable_<parallel_existential<P1>> : is_hoistable<P1> {};
+template <typename P1> struct is_hoistable_<parallel_universal<P1>>   : is_hoistable<P1> {};
+
+//------------------------------------------------------------------------------
+
+template <typename P1>
+inline auto exist(const parallel_policy& pp, P1&& p1) noexcept 
+        -> parallel_existential<
+                typename underlying<decltype(filter(std::forward<P1>(p1)))>::type
+           >
+{
+    return parallel_existential<
+                typename underlying<decltype(filter(std::forward<P1>(p1)))>::type
+           >(
+                pp,
+                filter(std::forward<P1>(p1))
+            );
+}
+
+//------------------------------------------------------------------------------
+
+template <typename P1>
+inline auto all(const parallel_policy& pp, P1&& p1) noexcept
+        -> parallel_universal<
+                typename underlying<decltype(filter(std::forward<P1>(p1)))>::type
+           >
+{
+    return parallel_universal<
+                typename underlying<decltype(filter(std::forward<P1>(p1)))>::type
+           >(
+                pp,
+                filter(std::forward<P1>(p1))
+            );
+}
+
+//------------------------------------------------------------------------------
+
 } // of namespace mch
 
 //------------------------------------------------------------------------------
@@ -45,16 +45,377 @@
 #pragma once
 
 #include "common.hpp"
+#include "primitive.hpp"   // Literals as argument patterns are filtered into value patterns
+#include <cstring>
+#include <memory>
 #include <regex>
+#include <sstream>
 #include <string>
+#include <unordered_map>
+
+#if XTL_MULTI_THREADING
+#include <mutex>
+#endif
+
+#if XTL_OVERHEAD_ACCOUNTING
+#include "../overhead.hpp"  // Counters of allocations, casts and updates
+#endif
+
+#if XTL_REGEX_SETS
+#include <algorithm>
+#include <vector>
+#endif
+
+#if XTL_SUPPORT(string_view)
+#include <string_view>
+#endif
+
+// --------------------[ Design Notes ]--------------------
+// - Patterns do not use std::regex directly, but go through an engine, which 
+//   can be replaced with a faster one (e.g. a DFA-based library like RE2) by
+//   defining #XTL_REGEX_ENGINE before including this file. An engine E has to
+//   provide:
+//     - E::compiled_type - compiled form of a regular expression;
+//     - static E::compiled_type* E::compile(const char* re) - compiles re;
+//     - static bool E::match(const E::compiled_type& re, const char* b, 
+//       const char* e, const char** sub, size_t n) - matches the entire [b,e)
+//       against re and on success stores the boundaries of the first n 
+//       capture groups into sub[0..2n).
+// - Subjects are matched in place: no std::string is created for const char*
+//   or std::string_view subjects.
+// - Boundaries of all capture groups are copied out of the engine before any
+//   of the argument patterns runs, so an engine may keep its match state in
+//   thread-local storage even when an argument pattern is itself a regex.
+// - Under #XTL_REGEX_SETS each Match statement keeps a mch::regex_site with 
+//   expressions of its rex() patterns in the order clauses first apply them.
+//   The first pattern applied during an evaluation scans the subject with the
+//   set of all of them, after which patterns before the first match fail 
+//   without running their expressions. The one of the first match runs its
+//   own expression only to extract capture groups, while the ones after it
+//   run theirs as usual, since they are reached only when argument patterns
+//   or guards of the first match reject the subject. The engine then has to 
+//   also provide:
+//     - E::set_type - compiled form of a set of regular expressions;
+//     - static E::set_type* E::compile_set(const char* const* res, size_t n)
+//       - combines res[0..n) into a set;
+//     - static size_t E::match_set(const E::set_type& s, const char* b, 
+//       const char* e) - returns the index of the first expression of s
+//       matching the entire [b,e) or the number of expressions when none does.
+// --------------------------------------------------------
 
 namespace mch ///< Mach7 library namespace
 {
 
 //------------------------------------------------------------------------------
 
-/// RegEx pattern of 0 arguments
-struct regex0 : std::regex
+/// Regular-expression engine built on top of std::regex
+struct std_regex_engine
+{
+    typedef std::regex compiled_type;
+
+    static compiled_type* compile(const char* re) { return new std::regex(re); }
+
+    static bool match(const compiled_type& re, const char* b, const char* e, const char** sub, size_t n)
+    {
+        if (n == 0)
+            return std::regex_match(b, e, re); // No capture groups have to be reported
+
+    #if XTL_SUPPORT(thread_local)
+        static thread_local std::cmatch m; // Reused to not allocate its sub-matches on every call
+    #else
+        std::cmatch m;
+    #endif
+
+        if (!std::regex_match(b, e, m, re))
+            return false;
+
+        XTL_ASSERT(m.size() > n); // There should be enough capture groups for each of the pattern arguments
+
+        for (size_t i = 0; i < n; ++i) // m[0] is the entire expression
+        {
+            sub[2*i]   = m[i+1].first;
+            sub[2*i+1] = m[i+1].second;
+        }
+
+        return true;
+    }
+
+#if XTL_REGEX_SETS
+    /// Set of expressions combined into an alternation of capture groups, of 
+    /// which std::regex takes the first alternative matching the subject. It
+    /// still tries alternatives one after another, so it saves little over 
+    /// matching them separately, but lets sets be used with the default engine.
+    struct set_type
+    {
+        std::regex          alternation;
+        std::vector<size_t> groups; ///< Capture group around each expression
+    };
+
+    static set_type* compile_set(const char* const* res, size_t n)
+    {
+        std::unique_ptr<set_type> s(new set_type);
+        std::string alternation;
+        size_t group = 1;
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (i)
+                alternation += '|';
+
+            alternation += '(';
+
+            // Back-references of an expression are shifted by the groups before it
+            for (const char* p = res[i]; *p; ++p)
+                if (p[0] == '\\' && p[1] >= '1' && p[1] <= '9')
+                {
+                    size_t k = 0;
+
+                    while (p[1] >= '0' && p[1] <= '9')
+                        k = 10*k + size_t(*++p - '0');
+
+                    alternation += '\\' + std::to_string(k + group);
+                }
+                else
+                {
+                    alternation += *p;
+
+                    if (p[0] == '\\' && p[1])
+                        alternation += *++p;
+                }
+
+            alternation += ')';
+            s->groups.push_back(group);
+            group += 1 + std::regex(res[i]).mark_count();
+        }
+
+        s->alternation.assign(alternation);
+        return s.release();
+    }
+
+    static size_t match_set(const set_type& s, const char* b, const char* e)
+    {
+    #if XTL_SUPPORT(thread_local)
+        static thread_local std::cmatch m;
+    #else
+        std::cmatch m;
+    #endif
+
+        if (std::regex_match(b, e, m, s.alternation))
+            for (size_t i = 0; i < s.groups.size(); ++i)
+                if (m[s.groups[i]].matched)
+                    return i;
+
+        return s.groups.size();
+    }
+#endif
+};
+
+//------------------------------------------------------------------------------
+
+/// Engine used by the regex patterns. \see mch::std_regex_engine for the 
+/// interface it has to provide.
+#if !defined(XTL_REGEX_ENGINE)
+#define XTL_REGEX_ENGINE mch::std_regex_engine
+#endif
+
+//------------------------------------------------------------------------------
+
+/// Entry of the table of compiled regular expressions: the text of one and
+/// its compiled form
+template <typename E>
+using compiled_regex_entry_type = std::pair<const std::string, std::unique_ptr<const typename E::compiled_type>>;
+
+/// Returns the entry of the table of compiled regular expressions for re, 
+/// compiling re the first time it is seen. \see mch::compiled_regex
+template <typename E = XTL_REGEX_ENGINE>
+inline const compiled_regex_entry_type<E>& compiled_regex_entry(const char* re)
+{
+    static std::unordered_map<std::string, std::unique_ptr<const typename E::compiled_type>> table;
+#if XTL_MULTI_THREADING
+    static std::mutex mutex;
+    std::lock_guard<std::mutex> lock(mutex);
+#endif
+    compiled_regex_entry_type<E>& r = *table.emplace(re, nullptr).first;
+
+    if (!r.second)
+    {
+        r.second.reset(E::compile(re));
+        XTL_OVERHEAD_ACCOUNTING_ONLY(mch::count_regex_compile(); mch::count_allocation(sizeof(typename E::compiled_type)));
+    }
+
+    return r;
+}
+
+/// Returns the compiled form of regular expression re. Each distinct regular 
+/// expression is compiled only the first time it is seen and is kept till the
+/// end of the program, so that a rex() pattern evaluated in a loop only pays
+/// for looking up its string instead of rebuilding the automaton.
+template <typename E = XTL_REGEX_ENGINE>
+inline const typename E::compiled_type& compiled_regex(const char* re)
+{
+    return *compiled_regex_entry<E>(re).second;
+}
+
+//------------------------------------------------------------------------------
+
+#if XTL_REGEX_SETS
+
+#if XTL_MULTI_THREADING && !XTL_SUPPORT(thread_local)
+#error XTL_REGEX_SETS with XTL_MULTI_THREADING requires compiler support of thread_local storage duration
+#endif
+
+/// Expressions of the rex() patterns of one Match statement, in the order its
+/// clauses first applied them, and the set combining them. \see #XTL_REGEX_SETS
+class regex_site
+{
+public:
+
+    typedef XTL_REGEX_ENGINE engine;
+
+    /// Set of the first size expressions of the site
+    struct snapshot
+    {
+        std::unique_ptr<const engine::set_type> set;
+        size_t                                  size;
+    };
+
+    /// Index of expression text, whose compiled form is re, adding it when new
+    size_t index_of(const engine::compiled_type& re, const char* text)
+    {
+    #if XTL_MULTI_THREADING
+        std::lock_guard<std::mutex> lock(m_mutex);
+    #endif
+        size_t i = std::find(m_keys.begin(), m_keys.end(), &re) - m_keys.begin();
+
+        if (i == m_keys.size())
+        {
+            m_keys.push_back(&re);
+            m_texts.push_back(text);
+        }
+
+        return i;
+    }
+
+    /// Set of all the expressions added so far, which is rebuilt once new ones
+    /// were added. A site of a single expression has no set.
+    std::shared_ptr<const snapshot> set()
+    {
+    #if XTL_MULTI_THREADING
+        std::lock_guard<std::mutex> lock(m_mutex);
+    #endif
+        if (m_texts.size() > 1 && (!m_set || m_set->size != m_texts.size()))
+        {
+            std::shared_ptr<snapshot> s(new snapshot);
+            s->set.reset(engine::compile_set(m_texts.data(), m_texts.size()));
+            XTL_OVERHEAD_ACCOUNTING_ONLY(mch::count_regex_compile(); mch::count_allocation(sizeof(snapshot) + sizeof(typename engine::set_type)));
+            s->size = m_texts.size();
+            m_set = s;
+        }
+
+        return m_set;
+    }
+
+    /// Number of expressions the site has seen
+    size_t size() const
+    {
+    #if XTL_MULTI_THREADING
+        std::lock_guard<std::mutex> lock(m_mutex);
+    #endif
+        return m_keys.size();
+    }
+
+private:
+
+    std::vector<const engine::compiled_type*> m_keys;  ///< Compiled forms shared through mch::compiled_regex
+    std::vector<const char*>                  m_texts; ///< Texts kept by the table of mch::compiled_regex
+    std::shared_ptr<const snapshot>           m_set;
+#if XTL_MULTI_THREADING
+    mutable std::mutex                        m_mutex;
+#endif
+};
+
+/// Evaluation of a Match statement, during which rex() patterns ask the set of
+/// its site whether they can match before running their own expressions. The
+/// subject is scanned once and again only when a pattern is applied to text
+/// that is different, e.g. in a Match statement on several subjects.
+class regex_scope
+{
+public:
+
+    typedef regex_site::engine engine;
+
+    /// What the set knows about an expression matching the subject
+    enum outcome
+    {
+        no_match,    ///< The expression does not match
+        first_match, ///< The expression is the first one of the set to match
+        unknown      ///< The expression is not in the set or follows the first match
+    };
+
+    explicit regex_scope(regex_site& site) noexcept : m_site(site), m_outer(current()), m_first(0), m_scanned(false) { current() = this; }
+            ~regex_scope() noexcept { current() = m_outer; }
+
+    /// Innermost scope of the thread, if any
+    static regex_scope*& current() noexcept
+    {
+    #if XTL_MULTI_THREADING
+        static thread_local regex_scope* scope = nullptr;
+    #else
+        static regex_scope* scope = nullptr;
+    #endif
+        return scope;
+    }
+
+    /// Whether expression text compiled into re can match [b,e)
+    outcome test(const engine::compiled_type& re, const char* text, const char* b, const char* e)
+    {
+        size_t i = m_site.index_of(re, text);
+
+        if (!m_scanned || m_subject.size() != size_t(e-b) || !std::equal(b, e, m_subject.begin()))
+        {
+            m_set = m_site.set();
+            m_subject.assign(b, e);
+            m_first = m_set ? engine::match_set(*m_set->set, b, e) : 0;
+            m_scanned = true;
+        }
+
+        if (!m_set || i >= m_set->size)
+            return unknown;
+
+        return i < m_first ? no_match : i == m_first ? first_match : unknown;
+    }
+
+private:
+
+    regex_scope(const regex_scope&);            ///< Scopes are not copyable
+    regex_scope& operator=(const regex_scope&); ///< Scopes are not assignable
+
+    regex_site&                                  m_site;
+    regex_scope*                                 m_outer;   ///< Scope of the enclosing Match statement
+    std::shared_ptr<const regex_site::snapshot> m_set;     ///< Set the subject was scanned with
+    std::string                                  m_subject; ///< Copy of the text that was scanned
+    size_t                                       m_first;   ///< Index of the first expression matching it
+    bool                                         m_scanned;
+};
+
+#endif
+
+//------------------------------------------------------------------------------
+
+/// Matches the text [b,e) of a capture group against argument pattern p
+template <typename P>
+inline bool match_capture_group(const P& p, const char* b, const char* e)
+{
+    typename P::template accepted_type_for<std::string>::type v;
+    std::stringstream ss(std::string(b, e));
+    return (ss >> v) && p(v);
+}
+
+//------------------------------------------------------------------------------
+
+/// Common part of regex patterns of N arguments: kinds of subjects they accept
+template <size_t N>
+struct regex_base
 {
     /// Type function returning a type that will be accepted by the pattern for
     /// a given subject type S. We use type function instead of an associated 
@@ -62,45 +423,74 @@ struct regex0 : std::regex
     /// for example. Requirement of #Pattern concept.
     template <typename S> struct accepted_type_for { typedef std::string type; };
 
-    regex0(const char* re) : std::regex(re) {}
-    bool operator()(const std::string& s) const noexcept { return operator()(s.c_str()); }
-    bool operator()(const char*        s) const noexcept { std::cmatch m; return regex_match(s,m,*this); }
+    typedef XTL_REGEX_ENGINE engine;
+
+#if XTL_REGEX_SETS
+    regex_base(const char* re) : regex_base(compiled_regex_entry<engine>(re)) {}
+    regex_base(const compiled_regex_entry_type<engine>& e) : m_re(*e.second), m_text(e.first.c_str()) {}
+#else
+    regex_base(const char* re) : m_re(compiled_regex<engine>(re)) {}
+#endif
+
+    /// Matches entire [b,e) and stores boundaries of the capture groups into sub
+    bool match(const char* b, const char* e, const char* (&sub)[2*N+1]) const
+    {
+    #if XTL_REGEX_SETS
+        if (regex_scope* s = regex_scope::current())
+            switch (s->test(m_re, m_text, b, e))
+            {
+            case regex_scope::no_match:    return false;
+            case regex_scope::first_match: if (N == 0) return true; break; // Only capture groups are left to find
+            case regex_scope::unknown:     break;
+            }
+    #endif
+        return engine::match(m_re, b, e, sub, N);
+    }
+
+    const engine::compiled_type& m_re; ///< Compiled regular expression shared by all patterns with the same string
+#if XTL_REGEX_SETS
+    const char* m_text; ///< Text of the expression kept by the table of mch::compiled_regex
+#endif
+};
+
+//------------------------------------------------------------------------------
+
+/// RegEx pattern of 0 arguments
+struct regex0 : regex_base<0>
+{
+    regex0(const char* re) : regex_base<0>(re) {}
+    bool operator()(const std::string& s) const noexcept { return operator()(s.data(), s.data() + s.size()); }
+    bool operator()(const char*        s) const noexcept { return operator()(s, s + std::strlen(s)); }
+#if XTL_SUPPORT(string_view)
+    bool operator()(std::string_view   s) const noexcept { return operator()(s.data(), s.data() + s.size()); }
+#endif
+    bool operator()(const char* b, const char* e) const noexcept { const char* sub[1]; return match(b,e,sub); }
 };
 
 //------------------------------------------------------------------------------
 
 /// RegEx pattern of 1 arguments
 template <typename P1>
-struct regex1 : std::regex
+struct regex1 : regex_base<1>
 {
     static_assert(is_pattern<P1>::value,    "Argument P1 of a regex-pattern must be a pattern");
 
-    /// Type function returning a type that will be accepted by the pattern for
-    /// a given subject type S. We use type function instead of an associated 
-    /// type, because there is no a single accepted type for a #wildcard pattern
-    /// for example. Requirement of #Pattern concept.
-    template <typename S> struct accepted_type_for { typedef std::string type; };
-
-    regex1(const char* re, const P1&  p1) noexcept : std::regex(re), m_p1(          p1 ) {}
-    regex1(const char* re,       P1&& p1) noexcept : std::regex(re), m_p1(std::move(p1)) {}
-    regex1(const regex1&  src) noexcept : std::regex(src), m_p1(          src.m_p1 ) {} ///< Copy constructor    
-    regex1(      regex1&& src) noexcept : std::regex(src), m_p1(std::move(src.m_p1)) {} ///< Move constructor
+    regex1(const char* re, const P1&  p1) noexcept : regex_base<1>(re), m_p1(          p1 ) {}
+    regex1(const char* re,       P1&& p1) noexcept : regex_base<1>(re), m_p1(std::move(p1)) {}
+    regex1(const regex1&  src) noexcept : regex_base<1>(src), m_p1(          src.m_p1 ) {} ///< Copy constructor    
+    regex1(      regex1&& src) noexcept : regex_base<1>(src), m_p1(std::move(src.m_p1)) {} ///< Move constructor
     regex1& operator=(const regex1&); ///< Assignment is not allowed for this class
 
-    bool operator()(const std::string& s) const noexcept { return operator()(s.c_str()); }
-    bool operator()(const char*        s) const noexcept
+    bool operator()(const std::string& s) const noexcept { return operator()(s.data(), s.data() + s.size()); }
+    bool operator()(const char*        s) const noexcept { return operator()(s, s + std::strlen(s)); }
+#if XTL_SUPPORT(string_view)
+    bool operator()(std::string_view   s) const noexcept { return operator()(s.data(), s.data() + s.size()); }
+#endif
+    bool operator()(const char* b, const char* e) const noexcept
     {
-        std::cmatch m; 
-
-        if (regex_match(s,m,*this))
-        {
-            XTL_ASSERT(m.size() > 1);   // There should be enough capture groups for each of the pattern arguments
-            typename P1::template accepted_type_for<std::string>::type m1;
-            std::stringstream ss(m[1]); // m[0] is the entire expression
-            return (ss >> m1) && m_p1(m1);
-        }
-
-        return false;
+        const char* sub[3];
+        return match(b,e,sub)
+            && match_capture_group(m_p1, sub[0], sub[1]);
     }
     P1 m_p1;
 };
@@ -109,45 +499,30 @@ struct regex1 : std::regex
 
 /// RegEx pattern of 2 arguments
 template <typename P1, typename P2>
-struct regex2 : std::regex
+struct regex2 : regex_base<2>
 {
     static_assert(is_pattern<P1>::value,    "Argument P1 of a regex-pattern must be a pattern");
     static_assert(is_pattern<P2>::value,    "Argument P2 of a regex-pattern must be a pattern");
 
-    /// Type function returning a type that will be accepted by the pattern for
-    /// a given subject type S. We use type function instead of an associated 
-    /// type, because there is no a single accepted type for a #wildcard pattern
-    /// for example. Requirement of #Pattern concept.
-    template <typename S> struct accepted_type_for { typedef std::string type; };
-
-    regex2(const char* re, const P1&  p1, const P2&  p2) noexcept : std::regex(re), m_p1(          p1 ), m_p2(          p2 ) {}
-    regex2(const char* re,       P1&& p1, const P2&  p2) noexcept : std::regex(re), m_p1(std::move(p1)), m_p2(          p2 ) {}
-    regex2(const char* re, const P1&  p1,       P2&& p2) noexcept : std::regex(re), m_p1(          p1 ), m_p2(std::move(p2)) {}
-    regex2(const char* re,       P1&& p1,       P2&& p2) noexcept : std::regex(re), m_p1(std::move(p1)), m_p2(std::move(p2)) {}
-    regex2(const regex2&  src) noexcept : std::regex(src), m_p1(          src.m_p1 ), m_p2(          src.m_p2 ) {} ///< Copy constructor    
-    regex2(      regex2&& src) noexcept : std::regex(src), m_p1(std::move(src.m_p1)), m_p2(std::move(src.m_p2)) {} ///< Move constructor
+    regex2(const char* re, const P1&  p1, const P2&  p2) noexcept : regex_base<2>(re), m_p1(          p1 ), m_p2(          p2 ) {}
+    regex2(const char* re,       P1&& p1, const P2&  p2) noexcept : regex_base<2>(re), m_p1(std::move(p1)), m_p2(          p2 ) {}
+    regex2(const char* re, const P1&  p1,       P2&& p2) noexcept : regex_base<2>(re), m_p1(          p1 ), m_p2(std::move(p2)) {}
+    regex2(const char* re,       P1&& p1,       P2&& p2) noexcept : regex_base<2>(re), m_p1(std::move(p1)), m_p2(std::move(p2)) {}
+    regex2(const regex2&  src) noexcept : regex_base<2>(src), m_p1(          src.m_p1 ), m_p2(          src.m_p2 ) {} ///< Copy constructor    
+    regex2(      regex2&& src) noexcept : regex_base<2>(src), m_p1(std::move(src.m_p1)), m_p2(std::move(src.m_p2)) {} ///< Move constructor
     regex2& operator=(const regex2&); ///< Assignment is not allowed for this class
 
-    bool operator()(const std::string& s) const noexcept { return operator()(s.c_str()); }
-    bool operator()(const char*        s) const noexcept
+    bool operator()(const std::string& s) const noexcept { return operator()(s.data(), s.data() + s.size()); }
+    bool operator()(const char*        s) const noexcept { return operator()(s, s + std::strlen(s)); }
+#if XTL_SUPPORT(string_view)
+    bool operator()(std::string_view   s) const noexcept { return operator()(s.data(), s.data() + s.size()); }
+#endif
+    bool operator()(const char* b, const char* e) const noexcept
     {
-        std::cmatch m; 
-
-        if (regex_match(s,m,*this))
-        {
-            XTL_ASSERT(m.size() > 2);   // There should be enough capture groups for each of the pattern arguments
-            typename P1::template accepted_type_for<std::string>::type m1;
-            std::stringstream ss1(m[1]); // m[0] is the entire expression
-
-            if ((ss1 >> m1) && m_p1(m1))
-            {
-                typename P2::template accepted_type_for<std::string>::type m2;
-                std::stringstream ss2(m[2]); // FIX: Was unable to reuse ss1 for some rason
-                return (ss2 >> m2) && m_p2(m2);
-            }
-        }
-
-        return false;
+        const char* sub[5];
+        return match(b,e,sub)
+            && match_capture_group(m_p1, sub[0], sub[1])
+            && match_capture_group(m_p2, sub[2], sub[3]);
     }
     P1 m_p1;
     P2 m_p2;
@@ -157,56 +532,36 @@ struct regex2 : std::regex
 
 /// RegEx pattern of 3 arguments
 template <typename P1, typename P2, typename P3>
-struct regex3 : std::regex
+struct regex3 : regex_base<3>
 {
     static_assert(is_pattern<P1>::value,    "Argument P1 of a regex-pattern must be a pattern");
     static_assert(is_pattern<P2>::value,    "Argument P2 of a regex-pattern must be a pattern");
     static_assert(is_pattern<P3>::value,    "Argument P3 of a regex-pattern must be a pattern");
 
-    /// Type function returning a type that will be accepted by the pattern for
-    /// a given subject type S. We use type function instead of an associated 
-    /// type, because there is no a single accepted type for a #wildcard pattern
-    /// for example. Requirement of #Pattern concept.
-    template <typename S> struct accepted_type_for { typedef std::string type; };
-
-    regex3(const char* re, const P1&  p1, const P2&  p2, const P3&  p3) noexcept : std::regex(re), m_p1(          p1 ), m_p2(          p2 ), m_p3(          p3 ) {}
-    regex3(const char* re,       P1&& p1, const P2&  p2, const P3&  p3) noexcept : std::regex(re), m_p1(std::move(p1)), m_p2(          p2 ), m_p3(          p3 ) {}
-    regex3(const char* re, const P1&  p1,       P2&& p2, const P3&  p3) noexcept : std::regex(re), m_p1(          p1 ), m_p2(std::move(p2)), m_p3(          p3 ) {}
-    regex3(const char* re,       P1&& p1,       P2&& p2, const P3&  p3) noexcept : std::regex(re), m_p1(std::move(p1)), m_p2(std::move(p2)), m_p3(          p3 ) {}
-    regex3(const char* re, const P1&  p1, const P2&  p2,       P3&& p3) noexcept : std::regex(re), m_p1(          p1 ), m_p2(          p2 ), m_p3(std::move(p3)) {}
-    regex3(const char* re,       P1&& p1, const P2&  p2,       P3&& p3) noexcept : std::regex(re), m_p1(std::move(p1)), m_p2(          p2 ), m_p3(std::move(p3)) {}
-    regex3(const char* re, const P1&  p1,       P2&& p2,       P3&& p3) noexcept : std::regex(re), m_p1(          p1 ), m_p2(std::move(p2)), m_p3(std::move(p3)) {}
-    regex3(const char* re,       P1&& p1,       P2&& p2,       P3&& p3) noexcept : std::regex(re), m_p1(std::move(p1)), m_p2(std::move(p2)), m_p3(std::move(p3)) {}
-    regex3(const regex3&  src) noexcept : std::regex(src), m_p1(          src.m_p1 ), m_p2(          src.m_p2 ), m_p3(          src.m_p3 ) {} ///< Copy constructor    
-    regex3(      regex3&& src) noexcept : std::regex(src), m_p1(std::move(src.m_p1)), m_p2(std::move(src.m_p2)), m_p3(std::move(src.m_p3)) {} ///< Move constructor
+    regex3(const char* re, const P1&  p1, const P2&  p2, const P3&  p3) noexcept : regex_base<3>(re), m_p1(          p1 ), m_p2(          p2 ), m_p3(          p3 ) {}
+    regex3(const char* re,       P1&& p1, const P2&  p2, const P3&  p3) noexcept : regex_base<3>(re), m_p1(std::move(p1)), m_p2(          p2 ), m_p3(          p3 ) {}
+    regex3(const char* re, const P1&  p1,       P2&& p2, const P3&  p3) noexcept : regex_base<3>(re), m_p1(          p1 ), m_p2(std::move(p2)), m_p3(          p3 ) {}
+    regex3(const char* re,       P1&& p1,       P2&& p2, const P3&  p3) noexcept : regex_base<3>(re), m_p1(std::move(p1)), m_p2(std::move(p2)), m_p3(          p3 ) {}
+    regex3(const char* re, const P1&  p1, const P2&  p2,       P3&& p3) noexcept : regex_base<3>(re), m_p1(          p1 ), m_p2(          p2 ), m_p3(std::move(p3)) {}
+    regex3(const char* re,       P1&& p1, const P2&  p2,       P3&& p3) noexcept : regex_base<3>(re), m_p1(std::move(p1)), m_p2(          p2 ), m_p3(std::move(p3)) {}
+    regex3(const char* re, const P1&  p1,       P2&& p2,       P3&& p3) noexcept : regex_base<3>(re), m_p1(          p1 ), m_p2(std::move(p2)), m_p3(std::move(p3)) {}
+    regex3(const char* re,       P1&& p1,       P2&& p2,       P3&& p3) noexcept : regex_base<3>(re), m_p1(std::move(p1)), m_p2(std::move(p2)), m_p3(std::move(p3)) {}
+    regex3(const regex3&  src) noexcept : regex_base<3>(src), m_p1(          src.m_p1 ), m_p2(          src.m_p2 ), m_p3(          src.m_p3 ) {} ///< Copy constructor    
+    regex3(      regex3&& src) noexcept : regex_base<3>(src), m_p1(std::move(src.m_p1)), m_p2(std::move(src.m_p2)), m_p3(std::move(src.m_p3)) {} ///< Move constructor
     regex3& operator=(const regex3&); ///< Assignment is not allowed for this class
 
-    bool operator()(const std::string& s) const noexcept { return operator()(s.c_str()); }
-    bool operator()(const char*        s) const noexcept
+    bool operator()(const std::string& s) const noexcept { return operator()(s.data(), s.data() + s.size()); }
+    bool operator()(const char*        s) const noexcept { return operator()(s, s + std::strlen(s)); }
+#if XTL_SUPPORT(string_view)
+    bool operator()(std::string_view   s) const noexcept { return operator()(s.data(), s.data() + s.size()); }
+#endif
+    bool operator()(const char* b, const char* e) const noexcept
     {
-        std::cmatch m; 
-
-        if (regex_match(s,m,*this))
-        {
-            XTL_ASSERT(m.size() > 3);   // There should be enough capture groups for each of the pattern arguments
-            typename P1::template accepted_type_for<std::string>::type m1;
-            std::stringstream ss1(m[1]); // m[0] is the entire expression
-
-            if ((ss1 >> m1) && m_p1(m1))
-            {
-                typename P2::template accepted_type_for<std::string>::type m2;
-                std::stringstream ss2(m[2]); // FIX: Was unable to reuse ss1 for some rason
-
-                if ((ss2 >> m2) && m_p2(m2))
-                {
-                    typename P3::template accepted_type_for<std::string>::type m3;
-                    std::stringstream ss3(m[3]); // FIX: Was unable to reuse ss1 for some rason
-                    return (ss3 >> m3) && m_p3(m3);
-                }
-            }
-        }
-
-        return false;
+        const char* sub[7];
+        return match(b,e,sub)
+            && match_capture_group(m_p1, sub[0], sub[1])
+            && match_capture_group(m_p2, sub[2], sub[3])
+            && match_capture_group(m_p3, sub[4], sub[5]);
     }
     P1 m_p1;
     P2 m_p2;
@@ -267,6 +622,17 @@ template <typename P1>                           struct is_pattern_<regex1<P1>>
 template <typename P1, typename P2>              struct is_pattern_<regex2<P1,P2>>    { static const bool value = true; };
 template <typename P1, typename P2, typename P3> struct is_pattern_<regex3<P1,P2,P3>> { static const bool value = true; };
 
+template <>                                      struct pattern_cost_<regex0>           { static const unsigned int value = cost_of_regex; };
+template <typename P1>                           struct pattern_cost_<regex1<P1>>       { static const unsigned int value = cost_of_regex + pattern_cost<P1>::value; };
+template <typename P1, typename P2>              struct pattern_cost_<regex2<P1,P2>>    { static const unsigned int value = cost_of_regex + pattern_cost<P1>::value + pattern_cost<P2>::value; };
+template <typename P1, typename P2, typename P3> struct pattern_cost_<regex3<P1,P2,P3>> { static const unsigned int value = cost_of_regex + pattern_cost<P1>::value + pattern_cost<P2>::value + pattern_cost<P3>::value; };
+
+/// #is_hoistable_ is a helper meta-predicate telling whether a pattern can be constructed once per clause
+template <>                                      struct is_hoistable_<regex0>           { static const bool value = true; };
+template <typename P1>                           struct is_hoistable_<regex1<P1>>       { static const bool value = is_hoistable<P1>::value; };
+template <typename P1, typename P2>              struct is_hoistable_<regex2<P1,P2>>    { static const bool value = is_hoistable<P1>::value && is_hoistable<P2>::value; };
+template <typename P1, typename P2, typename P3> struct is_hoistable_<regex3<P1,P2,P3>> { static const bool value = is_hoistable<P1>::value && is_hoistable<P2>::value && is_hoistable<P3>::value; };
+
 //------------------------------------------------------------------------------
 
 } // of namespace mch
@@ -44,14 +44,89 @@
 
 #pragma once
 
-#include "common.hpp"
-#include <vector>
+#include "primitive.hpp" // FIX: Ideally this should be common.hpp, but GCC seem to disagree: http://gcc.gnu.org/bugzilla/show_bug.cgi?id=55460
+#include <cstddef>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
 
 namespace mch ///< Mach7 library namespace
 {
 
 //------------------------------------------------------------------------------
 
+namespace detail
+{
+    using std::begin;
+    using std::end;
+
+    /// Finds begin of a range the way range-based for does: through std::begin
+    /// for arrays and containers and through ADL for user-defined ranges.
+    template <typename R>
+    inline auto range_begin(const R& r) -> decltype(begin(r)) { return begin(r); }
+
+    /// Finds end of a range the way range-based for does.
+    template <typename R>
+    inline auto range_end(const R& r) -> decltype(end(r)) { return end(r); }
+} // of namespace detail
+
+//------------------------------------------------------------------------------
+
+/// Type function returning the iterator type of a range R viewed as constant
+template <typename R>
+struct range_iterator
+{
+    typedef decltype(detail::range_begin(std::declval<const R&>())) type;
+};
+
+/// Meta-predicate telling whether iterators of type I are random-access, which
+/// lets patterns on sequences find lengths and elements without stepping
+template <typename I>
+struct is_random_access : std::is_base_of<std::random_access_iterator_tag, typename std::iterator_traits<I>::iterator_category> {};
+
+//------------------------------------------------------------------------------
+
+/// Non-owning view of elements in [first,last) of any iterator category.
+/// It lets patterns on sequences match iterator pairs - e.g. of a
+/// std::istream_iterator or of a generator - without materializing them in a
+/// container. Single-pass iterators are consumed only as far as the pattern
+/// needs to look at them.
+template <typename I>
+struct range_view
+{
+    typedef I                                                 iterator;
+    typedef I                                                 const_iterator;
+    typedef typename std::iterator_traits<I>::value_type      value_type;
+    typedef typename std::iterator_traits<I>::reference       reference;
+    typedef typename std::iterator_traits<I>::difference_type difference_type;
+
+    range_view() : m_begin(), m_end() {}
+    range_view(const I& b, const I& e) : m_begin(b), m_end(e) {}
+
+    I    begin() const { return m_begin; }
+    I    end()   const { return m_end; }
+    bool empty() const { return m_begin == m_end; }
+
+    I m_begin;
+    I m_end;
+};
+
+//------------------------------------------------------------------------------
+
+/// Creates a #range_view of elements in [first,last)
+template <typename I>
+inline range_view<I> range(I first, I last) { return range_view<I>(first, last); }
+
+/// Type function returning the type of #range_view bound by sequence patterns
+/// applied to a range of type R, e.g. var<view_of<std::vector<int>>::type>
+template <typename R>
+struct view_of
+{
+    typedef range_view<typename range_iterator<R>::type> type;
+};
+
+//------------------------------------------------------------------------------
+
 template <typename I>
 struct sequence
 {
@@ -68,13 +143,13 @@ struct sequence
     template <typename C>
     bool operator()(const C& c) const 
     {
-        m_begin = c.begin();
-        m_end   = c.end();
+        m_begin = detail::range_begin(c);
+        m_end   = detail::range_end(c);
         return true; 
     }
 
-    I m_begin;
-    I m_end;
+    mutable I m_begin; ///< Binding patterns modify their state on match, just like #var does
+    mutable I m_end;
 };
 
 //------------------------------------------------------------------------------
@@ -84,10 +159,310 @@ template <typename I> struct is_pattern_<sequence<I>> { static const bool value
 
 //------------------------------------------------------------------------------
 
-template <typename T, typename A>
-sequence<typename std::vector<T,A>::const_iterator> seq(const std::vector<T,A>& v)
+/// Creates a #sequence pattern for a range of type R: any container, array,
+/// #range_view or user-defined type with ADL-visible begin and end.
+template <typename R>
+inline sequence<typename range_iterator<R>::type> seq(const R& r)
+{
+    return sequence<typename range_iterator<R>::type>(detail::range_begin(r),detail::range_end(r));
+}
+
+//------------------------------------------------------------------------------
+
+/// Pattern matching empty ranges only, which #list uses to close the sequence
+struct empty_range
+{
+    /// Type function returning a type that will be accepted by the pattern for
+    /// a given subject type S. We use type function instead of an associated 
+    /// type, because there is no a single accepted type for a #wildcard pattern
+    /// for example. Requirement of #Pattern concept.
+    template <typename S> struct accepted_type_for { typedef S type; };
+
+    template <typename C>
+    bool operator()(const C& c) const { return !(detail::range_begin(c) != detail::range_end(c)); }
+};
+
+//------------------------------------------------------------------------------
+
+/// Pattern matching a range whose leading elements match patterns P1..Pn and
+/// whose remaining elements, passed as a #range_view, match the last pattern.
+/// The view refers to the elements of the subject in place: nothing is copied
+/// and single-pass ranges are advanced only past the elements matched by the
+/// leading patterns.
+template <typename... Ps>
+struct head_tail
+{
+    static_assert(sizeof...(Ps) > 0, "Head/tail pattern needs at least a pattern for the tail");
+
+    enum { head_count = sizeof...(Ps) - 1 };
+
+    explicit head_tail(const Ps&... ps) : m_patterns(ps...) {}
+    explicit head_tail(Ps&&... ps) noexcept : m_patterns(std::move(ps)...) {}
+    head_tail(const head_tail&  src) : m_patterns(src.m_patterns) {} ///< Copy constructor
+    head_tail(      head_tail&& src) noexcept : m_patterns(std::move(src.m_patterns)) {} ///< Move constructor
+    head_tail& operator=(const head_tail&); ///< Assignment is not allowed for this class
+
+    /// Type function returning a type that will be accepted by the pattern for
+    /// a given subject type S. We use type function instead of an associated 
+    /// type, because there is no a single accepted type for a #wildcard pattern
+    /// for example. Requirement of #Pattern concept.
+    template <typename S> struct accepted_type_for { typedef S type; };
+
+    /// Type of the pattern matched against the rest of the range
+    typedef typename std::tuple_element<head_count, std::tuple<Ps...>>::type tail_type;
+
+    template <typename C>
+    bool operator()(const C& c) const 
+    {
+        typename range_iterator<C>::type p = detail::range_begin(c);
+        return match(p, detail::range_end(c), is_random_access<typename range_iterator<C>::type>());
+    }
+
+    /// Ranges of other categories are matched element by element, checking for
+    /// the end of the range before each of the leading patterns
+    template <typename I>
+    bool match(I& p, const I& e, std::false_type) const { return match_from<0>(p, e); }
+
+    /// Random-access ranges too short for the leading patterns, or of a different
+    /// length when the rest must be empty as in #list, are refuted before any of
+    /// the elements is looked at. The rest are matched without checking for the end.
+    template <typename I>
+    bool match_random_access(const I& p, const I& e, std::true_type)  const { return e - p == head_count && match_at<0>(p, e); }
+    template <typename I>
+    bool match_random_access(const I& p, const I& e, std::false_type) const { return e - p >= head_count && match_at<0>(p, e); }
+    template <typename I>
+    bool match(I& p, const I& e, std::true_type) const { return match_random_access(p, e, std::is_same<tail_type,empty_range>()); }
+
+    template <size_t i, typename I>
+    typename std::enable_if<(i < head_count), bool>::type match_at(const I& p, const I& e) const
+    {
+        return std::get<i>(m_patterns)(p[i]) && match_at<i+1>(p, e);
+    }
+
+    template <size_t i, typename I>
+    typename std::enable_if<(i == head_count), bool>::type match_at(const I& p, const I& e) const
+    {
+        return std::get<i>(m_patterns)(range_view<I>(p + head_count, e));
+    }
+
+    template <size_t i, typename I>
+    typename std::enable_if<(i < head_count), bool>::type match_from(I& p, const I& e) const
+    {
+        if (p == e || !std::get<i>(m_patterns)(*p))
+            return false;
+        ++p;
+        return match_from<i+1>(p, e);
+    }
+
+    template <size_t i, typename I>
+    typename std::enable_if<(i == head_count), bool>::type match_from(I& p, const I& e) const
+    {
+        return std::get<i>(m_patterns)(range_view<I>(p, e));
+    }
+
+    std::tuple<Ps...> m_patterns;
+};
+
+//------------------------------------------------------------------------------
+
+/// #is_pattern_ is a helper meta-predicate capable of distinguishing all our patterns
+template <typename... Ps> struct is_pattern_<head_tail<Ps...>> { static const bool value = true; };
+template <>               struct is_pattern_<empty_range>      { static const bool value = true; };
+
+//------------------------------------------------------------------------------
+
+/// Sum of estimated costs of patterns Ps
+template <typename... Ps> struct pattern_cost_sum;
+template <>                           struct pattern_cost_sum<>      { static const unsigned int value = 0; };
+template <typename P, typename... Ps> struct pattern_cost_sum<P,Ps...> { static const unsigned int value = pattern_cost<P>::value + pattern_cost_sum<Ps...>::value; };
+
+/// #pattern_cost_ is a helper meta-function estimating the cost of trying a pattern
+template <typename... Ps> struct pattern_cost_<head_tail<Ps...>> { static const unsigned int value = cost_of_value*sizeof...(Ps) + pattern_cost_sum<Ps...>::value; };
+template <>               struct pattern_cost_<empty_range>      { static const unsigned int value = cost_of_value; };
+
+/// Whether all patterns Ps are #is_hoistable
+template <typename... Ps> struct is_hoistable_sequence;
+template <>                           struct is_hoistable_sequence<>      { static const bool value = true; };
+template <typename P, typename... Ps> struct is_hoistable_sequence<P,Ps...> { static const bool value = is_hoistable<P>::value && is_hoistable_sequence<Ps...>::value; };
+
+/// #is_hoistable_ is a helper meta-predicate telling whether a pattern can be constructed once per clause
+template <typename... Ps> struct is_hoistable_<head_tail<Ps...>> : is_hoistable_sequence<Ps...> {};
+template <>               struct is_hoistable_<empty_range>      { static const bool value = true; };
+
+//------------------------------------------------------------------------------
+
+/// Creates a pattern matching [p1, ..., pn, tail...]: the first n elements of a
+/// range are matched against p1..pn and the #range_view of the rest against
+/// tail, which typically is a var<view_of<R>::type>, another #cons or #_.
+template <typename... Ps>
+inline auto cons(Ps&&... ps) noexcept
+        -> head_tail<typename underlying<decltype(filter(std::forward<Ps>(ps)))>::type...>
+{
+    return head_tail<typename underlying<decltype(filter(std::forward<Ps>(ps)))>::type...>(
+                filter(std::forward<Ps>(ps))...
+            );
+}
+
+/// Creates a pattern matching ranges of exactly n elements matching p1..pn
+template <typename... Ps>
+inline auto list(Ps&&... ps) noexcept
+        -> head_tail<typename underlying<decltype(filter(std::forward<Ps>(ps)))>::type..., empty_range>
+{
+    return head_tail<typename underlying<decltype(filter(std::forward<Ps>(ps)))>::type..., empty_range>(
+                filter(std::forward<Ps>(ps))..., empty_range()
+            );
+}
+
+//------------------------------------------------------------------------------
+
+/// Pattern matching ranges whose number of elements matches P1. The number is
+/// found in constant time for random-access ranges and by stepping through the
+/// range otherwise.
+template <typename P1>
+struct range_length
+{
+    static_assert(is_pattern<P1>::value, "Argument P1 of a range length pattern must be a pattern");
+
+    explicit range_length(const P1&  p1) noexcept : m_p1(p1) {}
+    explicit range_length(      P1&& p1) noexcept : m_p1(std::move(p1)) {}
+    range_length(const range_length&  src) noexcept : m_p1(src.m_p1) {}            ///< Copy constructor
+    range_length(      range_length&& src) noexcept : m_p1(std::move(src.m_p1)) {} ///< Move constructor
+    range_length& operator=(const range_length&); ///< Assignment is not allowed for this class
+
+    /// Type function returning a type that will be accepted by the pattern for
+    /// a given subject type S. We use type function instead of an associated 
+    /// type, because there is no a single accepted type for a #wildcard pattern
+    /// for example. Requirement of #Pattern concept.
+    template <typename S> struct accepted_type_for { typedef S type; };
+
+    template <typename C>
+    bool operator()(const C& c) const { return m_p1(std::size_t(std::distance(detail::range_begin(c), detail::range_end(c)))); }
+
+    P1 m_p1; ///< Pattern the number of elements is matched with
+};
+
+//------------------------------------------------------------------------------
+
+/// Pattern matching ranges of at least m_count elements. Random-access ranges
+/// are checked in constant time, others are stepped through for at most 
+/// m_count elements.
+struct min_length
+{
+    explicit min_length(std::size_t n) noexcept : m_count(n) {}
+
+    /// Type function returning a type that will be accepted by the pattern for
+    /// a given subject type S. We use type function instead of an associated 
+    /// type, because there is no a single accepted type for a #wildcard pattern
+    /// for example. Requirement of #Pattern concept.
+    template <typename S> struct accepted_type_for { typedef S type; };
+
+    template <typename C>
+    bool operator()(const C& c) const 
+    {
+        return match(detail::range_begin(c), detail::range_end(c), is_random_access<typename range_iterator<C>::type>());
+    }
+
+    template <typename I>
+    bool match(const I& b, const I& e, std::true_type) const { return std::size_t(e - b) >= m_count; }
+
+    template <typename I>
+    bool match(I p, const I& e, std::false_type) const
+    {
+        for (std::size_t n = 0; n < m_count; ++n, ++p)
+            if (!(p != e))
+                return false;
+
+        return true;
+    }
+
+    std::size_t m_count; ///< Minimal number of elements
+};
+
+//------------------------------------------------------------------------------
+
+/// Pattern matching ranges whose element at position m_index exists and 
+/// matches P1. Random-access ranges index the element directly, others are
+/// stepped through up to it.
+template <typename P1>
+struct range_element
+{
+    static_assert(is_pattern<P1>::value, "Argument P1 of a range element pattern must be a pattern");
+
+    range_element(std::size_t i, const P1&  p1) noexcept : m_index(i), m_p1(p1) {}
+    range_element(std::size_t i,       P1&& p1) noexcept : m_index(i), m_p1(std::move(p1)) {}
+    range_element(const range_element&  src) noexcept : m_index(src.m_index), m_p1(src.m_p1) {}            ///< Copy constructor
+    range_element(      range_element&& src) noexcept : m_index(src.m_index), m_p1(std::move(src.m_p1)) {} ///< Move constructor
+    range_element& operator=(const range_element&); ///< Assignment is not allowed for this class
+
+    /// Type function returning a type that will be accepted by the pattern for
+    /// a given subject type S. We use type function instead of an associated 
+    /// type, because there is no a single accepted type for a #wildcard pattern
+    /// for example. Requirement of #Pattern concept.
+    template <typename S> struct accepted_type_for { typedef S type; };
+
+    template <typename C>
+    bool operator()(const C& c) const 
+    {
+        return match(detail::range_begin(c), detail::range_end(c), is_random_access<typename range_iterator<C>::type>());
+    }
+
+    template <typename I>
+    bool match(const I& b, const I& e, std::true_type) const { return std::size_t(e - b) > m_index && m_p1(b[m_index]); }
+
+    template <typename I>
+    bool match(I p, const I& e, std::false_type) const
+    {
+        for (std::size_t n = 0; n < m_index; ++n, ++p)
+            if (!(p != e))
+                return false;
+
+        return p != e && m_p1(*p);
+    }
+
+    std::size_t m_index; ///< Position of the element
+    P1          m_p1;    ///< Pattern the element is matched with
+};
+
+//------------------------------------------------------------------------------
+
+/// #is_pattern_ is a helper meta-predicate capable of distinguishing all our patterns
+template <typename P1> struct is_pattern_<range_length<P1>>  { static const bool value = true; };
+template <>            struct is_pattern_<min_length>        { static const bool value = true; };
+template <typename P1> struct is_pattern_<range_element<P1>> { static const bool value = true; };
+
+/// #pattern_cost_ is a helper meta-function estimating the cost of trying a pattern
+template <typename P1> struct pattern_cost_<range_length<P1>>  { static const unsigned int value = cost_of_value + pattern_cost<P1>::value; };
+template <>            struct pattern_cost_<min_length>        { static const unsigned int value = cost_of_value; };
+template <typename P1> struct pattern_cost_<range_element<P1>> { static const unsigned int value = cost_of_value + pattern_cost<P1>::value; };
+
+/// #is_hoistable_ is a helper meta-predicate telling whether a pattern can be constructed once per clause
+template <typename P1> struct is_hoistable_<range_length<P1>>  : is_hoistable<P1> {};
+template <>            struct is_hoistable_<min_length>        { static const bool value = true; };
+template <typename P1> struct is_hoistable_<range_element<P1>> : is_hoistable<P1> {};
+
+//------------------------------------------------------------------------------
+
+/// Creates a pattern matching ranges whose number of elements matches p1
+template <typename P1>
+inline auto length(P1&& p1) noexcept
+        -> range_length<typename underlying<decltype(filter(std::forward<P1>(p1)))>::type>
+{
+    return range_length<typename underlying<decltype(filter(std::forward<P1>(p1)))>::type>(filter(std::forward<P1>(p1)));
+}
+
+/// Creates a pattern matching ranges of exactly n elements
+inline range_length<value<std::size_t>> exactly(std::size_t n) noexcept { return range_length<value<std::size_t>>(value<std::size_t>(n)); }
+
+/// Creates a pattern matching ranges of at least n elements
+inline min_length at_least(std::size_t n) noexcept { return min_length(n); }
+
+/// Creates a pattern matching ranges whose element at position i matches p1,
+/// e.g. nth(2, x) binds the third element to var x
+template <typename P1>
+inline auto nth(std::size_t i, P1&& p1) noexcept
+        -> range_element<typename underlying<decltype(filter(std::forward<P1>(p1)))>::type>
 {
-    return sequence<typename std::vector<T,A>::const_iterator>(v.begin(),v.end());
+    return range_element<typename underlying<decltype(filter(std::forward<P1>(p1)))>::type>(i, filter(std::forward<P1>(p1)));
 }
 
 //------------------------------------------------------------------------------
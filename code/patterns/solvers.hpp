@@ -54,7 +54,7 @@ namespace mch ///< Mach7 library namespace
 
 // Solver for value
 template <typename T, typename S>
-inline bool solve(const value<T>& e, const S& r)
+XTL_CONSTEXPR14 bool solve(const value<T>& e, const S& r)
 {
     return e(r);
 }
@@ -63,7 +63,7 @@ inline bool solve(const value<T>& e, const S& r)
 
 // Solver for variable
 template <typename T, typename S>
-inline bool solve(const var<T>& e, const S& r)
+XTL_CONSTEXPR14 bool solve(const var<T>& e, const S& r)
 {
     return e(r);
 }
@@ -72,7 +72,7 @@ inline bool solve(const var<T>& e, const S& r)
 
 // Solver for variable (reference)
 template <typename T, typename S>
-inline bool solve(const ref2<T>& e, const S& r)
+XTL_CONSTEXPR14 bool solve(const ref2<T>& e, const S& r)
 {
     return e(r);
 }
@@ -81,7 +81,7 @@ inline bool solve(const ref2<T>& e, const S& r)
 
 // Solver for the only argument of unary_minus: -a == r => a == -r
 template <typename E1, typename S>
-inline bool solve(const expr<unary_minus,E1>& e, const S& r)
+XTL_CONSTEXPR14 bool solve(const expr<unary_minus,E1>& e, const S& r)
 {
     return solve(e.m_e1,-r);
 }
@@ -90,7 +90,7 @@ inline bool solve(const expr<unary_minus,E1>& e, const S& r)
 
 // Solver for the only argument of bit_complement: ~a == r => a == ~r
 template <typename E1, typename S>
-inline bool solve(const expr<bit_complement,E1>& e, const S& r)
+XTL_CONSTEXPR14 bool solve(const expr<bit_complement,E1>& e, const S& r)
 {
     return solve(e.m_e1,~r);
 }
@@ -99,7 +99,7 @@ inline bool solve(const expr<bit_complement,E1>& e, const S& r)
 
 // Solver for the only argument of bool_complement: !a == r => a == !r
 template <typename E1, typename S>
-inline bool solve(const expr<bool_complement,E1>& e, const S& r)
+XTL_CONSTEXPR14 bool solve(const expr<bool_complement,E1>& e, const S& r)
 {
     return solve(e.m_e1,!r);
 }
@@ -108,7 +108,7 @@ inline bool solve(const expr<bool_complement,E1>& e, const S& r)
 
 // Solver for the first argument of addition: a+b == r => a == r-b
 template <typename E1, typename T, typename S>
-inline bool solve(const expr<addition,E1,value<T>>& e, const S& r)
+XTL_CONSTEXPR14 bool solve(const expr<addition,E1,value<T>>& e, const S& r)
 {
     //typedef S source_type;               // The type a subject
     typedef typename E1::result_type target_type; // The type of a target expression
@@ -118,25 +118,23 @@ inline bool solve(const expr<addition,E1,value<T>>& e, const S& r)
     //       opposed making enable_if-ed overloads is to avoid the exponensial
     //       explosion of cases we'll have to add to make overloading unambiguous!
     // FIX:  Move first condition of && into if and make both solve calls in else 
-    // FIX:  Why is condition strict v < r? Shouldn't it be v <= r?
     XTL_STATIC_IF(std::is_unsigned<target_type>::value) 
-        return e.m_e2.m_value < r && solve(e.m_e1,r-e.m_e2.m_value);
+        return e.m_e2.m_value <= r && solve(e.m_e1,r-e.m_e2.m_value);
     else
         return solve(e.m_e1,r-e.m_e2.m_value);
 }
 
 // Solver for the second argument of addition: a+b == r => b == r-a
 template <typename E1, typename T, typename S>
-inline bool solve(const expr<addition,value<T>,E1>& e, const S& r)
+XTL_CONSTEXPR14 bool solve(const expr<addition,value<T>,E1>& e, const S& r)
 {
     // NOTE: The following conditions are known at compile time and we rely here
     //       on compiler eliminating dead branches. The reason we do this as 
     //       opposed making enable_if-ed overloads is to avoid the exponensial
     //       explosion of cases we'll have to add to make overloading unambiguous!
     // FIX:  Move first condition of && into if and make both solve calls in else 
-    // FIX:  Why is condition strict v < r? Shouldn't it be v <= r?
     XTL_STATIC_IF(std::is_unsigned<typename E1::result_type>::value) 
-        return e.m_e1.m_value < r && solve(e.m_e2,r-e.m_e1.m_value);
+        return e.m_e1.m_value <= r && solve(e.m_e2,r-e.m_e1.m_value);
     else
         return solve(e.m_e2,r-e.m_e1.m_value);
 }
@@ -145,7 +143,7 @@ inline bool solve(const expr<addition,value<T>,E1>& e, const S& r)
 
 // Solver for the first argument of addition: a+b == r => a == r-b
 template <typename E1, typename E2, typename S>
-inline bool solve(const expr<addition,E1,equivalence<E2>>& e, const S& r)
+XTL_CONSTEXPR14 bool solve(const expr<addition,E1,equivalence<E2>>& e, const S& r)
 {
     //typedef S source_type;               // The type a subject
     typedef typename E1::result_type target_type; // The type of a target expression
@@ -155,27 +153,25 @@ inline bool solve(const expr<addition,E1,equivalence<E2>>& e, const S& r)
     //       opposed making enable_if-ed overloads is to avoid the exponensial
     //       explosion of cases we'll have to add to make overloading unambiguous!
     // FIX:  Move first condition of && into if and make both solve calls in else 
-    // FIX:  Why is condition strict v < r? Shouldn't it be v <= r?
     auto v = eval(e.m_e2);
     XTL_STATIC_IF(std::is_unsigned<target_type>::value) 
-        return v < r && solve(e.m_e1,r-v);
+        return v <= r && solve(e.m_e1,r-v);
     else
         return solve(e.m_e1,r-v);
 }
 
 // Solver for the second argument of addition: a+b == r => b == r-a
 template <typename E1, typename E2, typename S>
-inline bool solve(const expr<addition,equivalence<E1>,E2>& e, const S& r)
+XTL_CONSTEXPR14 bool solve(const expr<addition,equivalence<E1>,E2>& e, const S& r)
 {
     // NOTE: The following conditions are known at compile time and we rely here
     //       on compiler eliminating dead branches. The reason we do this as 
     //       opposed making enable_if-ed overloads is to avoid the exponensial
     //       explosion of cases we'll have to add to make overloading unambiguous!
     // FIX:  Move first condition of && into if and make both solve calls in else 
-    // FIX:  Why is condition strict v < r? Shouldn't it be v <= r?
     auto v = eval(e.m_e1);
     XTL_STATIC_IF(std::is_unsigned<typename E2::result_type>::value) 
-        return v < r && solve(e.m_e2,r-v);
+        return v <= r && solve(e.m_e2,r-v);
     else
         return solve(e.m_e2,r-v);
 }
@@ -184,7 +180,7 @@ inline bool solve(const expr<addition,equivalence<E1>,E2>& e, const S& r)
 
 // Solver for the first argument of subtraction: a-b == r => a == r+b
 template <typename E1, typename T, typename S>
-inline bool solve(const expr<subtraction,E1,value<T>>& e, const S& r)
+XTL_CONSTEXPR14 bool solve(const expr<subtraction,E1,value<T>>& e, const S& r)
 {
     // FIX:  Shouldn't there be a similar is_unsigned check?
     return solve(e.m_e1,r+e.m_e2.m_value) && eval(e) == r;
@@ -192,7 +188,7 @@ inline bool solve(const expr<subtraction,E1,value<T>>& e, const S& r)
 
 // Solver for the second argument of subtraction: a-b == r => b == a-r
 template <typename E1, typename T, typename S>
-inline bool solve(const expr<subtraction,value<T>,E1>& e, const S& r)
+XTL_CONSTEXPR14 bool solve(const expr<subtraction,value<T>,E1>& e, const S& r)
 {
     // FIX:  Shouldn't there be a similar is_unsigned check?
     return solve(e.m_e2,e.m_e1.m_value-r) && eval(e) == r;
@@ -202,68 +198,107 @@ inline bool solve(const expr<subtraction,value<T>,E1>& e, const S& r)
 
 // Solver for the first argument of subtraction: a-b == r => a == r+b
 template <typename E1, typename E2, typename S>
-inline bool solve(const expr<subtraction,E1,equivalence<E2>>& e, const S& r)
+XTL_CONSTEXPR14 bool solve(const expr<subtraction,E1,equivalence<E2>>& e, const S& r)
 {
     // FIX:  Shouldn't there be a similar is_unsigned check?
-    return solve(e.m_e1,r+eval(e.m_e2)) && eval(e) == r;
+    auto v = eval(e.m_e2); // Evaluate the equivalence only once
+    return solve(e.m_e1,r+v) && eval(e.m_e1)-v == r;
 }
 
 // Solver for the second argument of subtraction: a-b == r => b == a-r
 template <typename E1, typename E2, typename S>
-inline bool solve(const expr<subtraction,equivalence<E1>,E2>& e, const S& r)
+XTL_CONSTEXPR14 bool solve(const expr<subtraction,equivalence<E1>,E2>& e, const S& r)
 {
     // FIX:  Shouldn't there be a similar is_unsigned check?
-    return solve(e.m_e2,eval(e.m_e1)-r) && eval(e) == r;
+    auto v = eval(e.m_e1); // Evaluate the equivalence only once
+    return solve(e.m_e2,v-r) && v-eval(e.m_e2) == r;
 }
 
 //------------------------------------------------------------------------------
 
-// Solver for the first argument of multiplication: a*b == r => a == r/b
+/// Solves a*k == r for a, where k is already known. For integral types there is
+/// a solution only when k divides r, which we check before binding anything, we
+/// thus never have to re-evaluate a subexpression e1 after it was solved.
 template <typename E1, typename T, typename S>
-inline bool solve(const expr<multiplication,E1,value<T>>& e, const S& r)
+inline bool solve_multiplication(const E1& e1, const T& k, const S& r)
 {
     // NOTE: The following conditions are known at compile time and we rely here
     //       on compiler eliminating dead branches. The reason we do this as 
     //       opposed making enable_if-ed overloads is to avoid the exponensial
     //       explosion of cases we'll have to add to make overloading unambiguous!
     XTL_STATIC_IF(std::is_integral<typename E1::result_type>::value) 
-        //return r % e.m_e2.m_value == 0 ? solve(e.m_e1,r/e.m_e2.m_value) : false;
-        return solve(e.m_e1,r/e.m_e2.m_value) && eval(e) == r; // NOTE: Somehow this one is faster than the above commented out one
+    {
+        auto q = r/k; // Compilers combine it with q*k below when k is a constant
+        return q*k == r && solve(e1,q);
+    }
     else
-        return solve(e.m_e1,r/e.m_e2.m_value);
+        return solve(e1,r/k);
+}
+
+/// Solves a/k == r for a, where k is already known. Among the integral solutions 
+/// [r*k,r*k+k) we pick r*k, checking for overflow before binding anything.
+template <typename E1, typename T, typename S>
+inline bool solve_division(const E1& e1, const T& k, const S& r)
+{
+    auto a = r*k;
+    return a/k == r && solve(e1,a);
+}
+
+//------------------------------------------------------------------------------
+
+// Solver for the first argument of multiplication: a*b == r => a == r/b
+template <typename E1, typename T, typename S>
+XTL_CONSTEXPR14 bool solve(const expr<multiplication,E1,value<T>>& e, const S& r)
+{
+    return solve_multiplication(e.m_e1,e.m_e2.m_value,r);
 }
 
 // Solver for the second argument of multiplication: a*b == r => b == r/a
 template <typename E1, typename T, typename S>
-inline bool solve(const expr<multiplication,value<T>,E1>& e, const S& r)
+XTL_CONSTEXPR14 bool solve(const expr<multiplication,value<T>,E1>& e, const S& r)
 {
-    // NOTE: The following conditions are known at compile time and we rely here
-    //       on compiler eliminating dead branches. The reason we do this as 
-    //       opposed making enable_if-ed overloads is to avoid the exponensial
-    //       explosion of cases we'll have to add to make overloading unambiguous!
-    XTL_STATIC_IF(std::is_integral<typename E1::result_type>::value) 
-        //return r % e.m_e1.m_value == 0 ? solve(e.m_e2,r/e.m_e1.m_value) : false;
-        return solve(e.m_e2,r/e.m_e1.m_value) && eval(e) == r; // NOTE: Somehow this one is faster than the above commented out one
-    else
-        return solve(e.m_e2,r/e.m_e1.m_value);
+    return solve_multiplication(e.m_e2,e.m_e1.m_value,r);
+}
+
+//------------------------------------------------------------------------------
+
+// Solver for the first argument of multiplication: a*b == r => a == r/b
+template <typename E1, typename E2, typename S>
+XTL_CONSTEXPR14 bool solve(const expr<multiplication,E1,equivalence<E2>>& e, const S& r)
+{
+    return solve_multiplication(e.m_e1,eval(e.m_e2),r);
+}
+
+// Solver for the second argument of multiplication: a*b == r => b == r/a
+template <typename E1, typename E2, typename S>
+XTL_CONSTEXPR14 bool solve(const expr<multiplication,equivalence<E1>,E2>& e, const S& r)
+{
+    return solve_multiplication(e.m_e2,eval(e.m_e1),r);
 }
 
 //------------------------------------------------------------------------------
 
 // Solver for the first argument of division: a/b == r => a == r*b
 template <typename E1, typename T, typename S>
-inline bool solve(const expr<division,E1,value<T>>& e, const S& r)
+XTL_CONSTEXPR14 bool solve(const expr<division,E1,value<T>>& e, const S& r)
 {
-    return solve(e.m_e1,r*e.m_e2.m_value) && eval(e) == r;
+    return solve_division(e.m_e1,e.m_e2.m_value,r);
 }
 
 // Solver for the second argument of division: a/b == r => b == a/r
 template <typename E1, typename T, typename S>
-inline bool solve(const expr<division,value<T>,E1>& e, const S& r)
+XTL_CONSTEXPR14 bool solve(const expr<division,value<T>,E1>& e, const S& r)
 {
     return solve(e.m_e2,e.m_e1.m_value/r) && eval(e) == r;
 }
 
+// Solver for the first argument of division: a/b == r => a == r*b
+template <typename E1, typename E2, typename S>
+XTL_CONSTEXPR14 bool solve(const expr<division,E1,equivalence<E2>>& e, const S& r)
+{
+    return solve_division(e.m_e1,eval(e.m_e2),r);
+}
+
 //------------------------------------------------------------------------------
 
 template <typename T1, typename T2>
@@ -298,7 +333,7 @@ solve(const expr<multiplication,E1,value<T>>& e, const S& r)
 }
 */
 template <typename E1, typename E2, typename S>
-inline bool solve(
+XTL_CONSTEXPR14 bool solve(
     const expr<addition,
                expr<multiplication,
                     E1,
@@ -9,14 +9,54 @@
 
 #pragma once
 
-/// At the moment some of the nodes do not have their own kind, so we use polymorphic encoding
+#if !defined(XTL_IPR_CATEGORY_DISPATCH)
+/// Whether Match statements on IPR nodes switch on Node::category, relying on
+/// the base classes listed with BCS below for nodes matched by their bases,
+/// instead of using vtbl maps.
+#define XTL_IPR_CATEGORY_DISPATCH 0
+#endif
+
+#if XTL_IPR_CATEGORY_DISPATCH
+/// Categories are dense (\see ipr_categories_are_dense), so the switch becomes a jump table
+#define XTL_DEFAULT_SYNTAX 'F'
+#else
+/// Polymorphic encoding remains the default as it does not depend on category values
 #define XTL_DEFAULT_SYNTAX 'P'
+#endif
+
+#if !defined(XTL_IPR_MEMOIZE)
+/// Whether the pattern-matching printer memoizes text of types and names, which
+/// are shared across the IPR graph, instead of matching them on every visit,
+/// \see node_memo.hpp
+#define XTL_IPR_MEMOIZE 0
+#endif
+
+/// Printers run Match statements concurrently, \see parallel_traversal.hpp
+#if !defined(XTL_MULTI_THREADING)
+#define XTL_MULTI_THREADING 1
+#endif
 
 #include "match.hpp"
 #include <ipr/interface>  // Pivot interfaces
 
 using namespace ipr;
 
+//------------------------------------------------------------------------------
+
+/// Categories in the order of node-category.def
+constexpr Category_code ipr_categories[] = {
+#include "node-category.def"
+};
+
+/// Checks that node-category.def enumerates categories 0,1,2,... without gaps,
+/// so that case labels of a Match dispatching on them form a dense jump table.
+constexpr bool ipr_categories_are_dense(size_t i = 0)
+{
+    return i == sizeof(ipr_categories)/sizeof(ipr_categories[0]) || (ipr_categories[i] == Category_code(i) && ipr_categories_are_dense(i+1));
+}
+
+static_assert(ipr_categories_are_dense(), "Categories of node-category.def are expected to be dense");
+
 //template <Category_code c, class T>
 //Category<c,T> get_category_helper(const Category<c,T>&);
 //
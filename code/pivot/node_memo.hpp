@@ -0,0 +1,85 @@
+///
+/// \file node_memo.hpp
+///
+/// This file defines memoization of results computed by Match statements on
+/// nodes of a DAG, whose shared nodes would otherwise be matched and
+/// decomposed again on every visit.
+///
+/// \author Yuriy Solodkyy
+/// Copyright (C) 2011, Texas A&M University.  All rights reserved.
+///
+/// \note Only results that depend on nothing but the node itself may be
+///       memoized, e.g. text of IPR types and names, which are unified and
+///       never change once created.
+///
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <unordered_map>
+
+/// Pattern-matching version of C++ printer
+namespace cxxm
+{
+
+//------------------------------------------------------------------------------
+
+/// Epoch of the current pass. Addresses of nodes freed between passes may be
+/// reused by new nodes, so results memoized in earlier epochs are discarded.
+inline std::atomic<size_t>& memo_epoch()
+{
+    static std::atomic<size_t> epoch(0);
+    return epoch;
+}
+
+/// Starts a new pass, invalidating results memoized by all threads so far
+inline void begin_pass() { ++memo_epoch(); }
+
+//------------------------------------------------------------------------------
+
+/// Results of type R computed on nodes, keyed on the node's address.
+/// The memo is not synchronized and is meant to be thread_local, so that
+/// concurrent printers (\see parallel_traversal.hpp) each keep their own.
+template <typename R>
+class node_memo
+{
+public:
+
+    node_memo() : m_epoch(memo_epoch()) {}
+
+    /// Returns result of f on n, calling f only on the first visit of n in
+    /// the current pass.
+    template <typename N, typename F>
+    R get(const N& n, F f)
+    {
+        size_t epoch = memo_epoch().load(std::memory_order_relaxed);
+
+        if (m_epoch != epoch)
+        {
+            m_results.clear();
+            m_epoch = epoch;
+        }
+
+        typename std::unordered_map<const void*, R>::const_iterator p = m_results.find(&n);
+
+        if (p != m_results.end())
+            return p->second;
+
+        R result = f(n); // f may recurse into get and rehash the table, so we insert only after
+        m_results.emplace(&n, result);
+        return result;
+    }
+
+    /// Number of nodes with memoized results
+    size_t size() const { return m_results.size(); }
+
+private:
+
+    std::unordered_map<const void*, R> m_results; ///< Results of the epoch m_epoch
+    size_t                             m_epoch;   ///< Epoch in which results were computed
+};
+
+//------------------------------------------------------------------------------
+
+} // of namespace cxxm
@@ -0,0 +1,187 @@
+///
+/// \file parallel_traversal.hpp
+///
+/// This file defines a work-stealing traversal of trees, whose subtrees are
+/// processed concurrently by visitors based on pattern matching.
+///
+/// \author Yuriy Solodkyy
+/// Copyright (C) 2011, Texas A&M University.  All rights reserved.
+///
+/// \note Match statements executed by the visitors have to be compiled with
+///       XTL_MULTI_THREADING, which makes their vtbl maps thread-safe,
+///       \see match_ipr.hpp
+///
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// Parallel version of C++ printer and the traversal it is built on
+namespace cxxp
+{
+
+//------------------------------------------------------------------------------
+
+/// Traversal of a tree of nodes of type Node by a given number of threads.
+/// A visitor handed a node may spawn any of its subtrees instead of descending
+/// into it, which makes the subtree a task processed by the same or another
+/// thread. Each thread keeps the tasks it spawned in its own deque, takes them
+/// from the back, so that it continues with the subtree it just saw, and when
+/// it has none left, steals from the front of deques of other threads, which
+/// gives it the largest subtrees spawned earliest.
+template <typename Node>
+class work_stealing_traversal
+{
+public:
+
+    /// Handle through which visitors spawn subtrees on the thread they run on
+    class spawner
+    {
+    public:
+
+        /// Makes subtree rooted at n a task to be visited independently
+        void spawn(const Node& n) { m_traversal.push(m_thread, &n); }
+
+        /// Number of the thread the visitor runs on, between 0 and threads()-1
+        size_t thread() const { return m_thread; }
+
+    private:
+
+        friend class work_stealing_traversal;
+        spawner(work_stealing_traversal& t, size_t i) : m_traversal(t), m_thread(i) {}
+
+        work_stealing_traversal& m_traversal;
+        size_t                   m_thread;
+    };
+
+    /// Creates a traversal with a given number of threads, one per hardware
+    /// thread by default
+    explicit work_stealing_traversal(size_t threads = 0) :
+        m_queues(threads ? threads : std::max(1u, std::thread::hardware_concurrency())),
+        m_pending(0),
+        m_failed(false)
+    {}
+
+    /// Number of threads the traversal uses, including the calling one
+    size_t threads() const { return m_queues.size(); }
+
+    /// Calls visit(const Node&, spawner&) on root and on every subtree spawned
+    /// by the calls, concurrently, and returns once all of them have finished.
+    /// The first exception thrown by a call stops the traversal and is
+    /// rethrown by run.
+    template <typename Visitor>
+    void run(const Node& root, Visitor& visit)
+    {
+        m_failed = false;
+        m_error  = std::exception_ptr();
+        push(0, &root);
+
+        std::vector<std::thread> helpers;
+
+        for (size_t i = 1; i < threads(); ++i)
+            helpers.push_back(std::thread(&work_stealing_traversal::template work<Visitor>, this, i, std::ref(visit)));
+
+        work(0, visit);
+
+        for (size_t i = 0; i < helpers.size(); ++i)
+            helpers[i].join();
+
+        if (m_error)
+            std::rethrow_exception(m_error);
+    }
+
+private:
+
+    /// Tasks spawned by a thread
+    struct queue
+    {
+        std::mutex               mutex;
+        std::deque<const Node*>  tasks;
+    };
+
+    void push(size_t i, const Node* n)
+    {
+        ++m_pending; // Before the task can be taken, so that it is never seen as done too early
+        std::lock_guard<std::mutex> guard(m_queues[i].mutex);
+        m_queues[i].tasks.push_back(n);
+    }
+
+    /// Takes the newest task of thread i or the oldest one of another thread
+    const Node* take(size_t i)
+    {
+        {
+            std::lock_guard<std::mutex> guard(m_queues[i].mutex);
+
+            if (!m_queues[i].tasks.empty())
+            {
+                const Node* n = m_queues[i].tasks.back();
+                m_queues[i].tasks.pop_back();
+                return n;
+            }
+        }
+
+        for (size_t k = 1; k < threads(); ++k)
+        {
+            queue& victim = m_queues[(i + k) % threads()];
+            std::lock_guard<std::mutex> guard(victim.mutex);
+
+            if (!victim.tasks.empty())
+            {
+                const Node* n = victim.tasks.front();
+                victim.tasks.pop_front();
+                return n;
+            }
+        }
+
+        return 0;
+    }
+
+    template <typename Visitor>
+    void work(size_t i, Visitor& visit)
+    {
+        spawner s(*this, i);
+
+        // Tasks can only be spawned by tasks in progress, which are pending, so
+        // once no task is pending, none will appear
+        while (m_pending)
+        {
+            if (const Node* n = take(i))
+            {
+                if (!m_failed)
+                {
+                    try
+                    {
+                        visit(*n, s);
+                    }
+                    catch (...)
+                    {
+                        std::lock_guard<std::mutex> guard(m_error_mutex);
+
+                        if (!m_failed.exchange(true))
+                            m_error = std::current_exception();
+                    }
+                }
+
+                --m_pending;
+            }
+            else
+                std::this_thread::yield();
+        }
+    }
+
+    std::vector<queue>  m_queues;      ///< Tasks spawned by each thread
+    std::atomic<size_t> m_pending;     ///< Tasks spawned and not finished yet
+    std::atomic<bool>   m_failed;      ///< Whether a visitor has thrown
+    std::mutex          m_error_mutex; ///< Guards m_error
+    std::exception_ptr  m_error;       ///< The first exception thrown by a visitor
+};
+
+//------------------------------------------------------------------------------
+
+} // of namespace cxxp
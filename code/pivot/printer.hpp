@@ -28,6 +28,15 @@ namespace cxxv
     void print_cpp(const ipr::Node& n, std::ostream& os, comments_interface& c);
 }
 
+/// Parallel version of C++ printer, \see parallel_traversal.hpp
+namespace cxxp
+{
+    /// Prints top-level declarations of the unit concurrently on a given number
+    /// of threads (one per hardware thread by default) with the pattern-matching
+    /// printer, writing them in their original order.
+    void print_cpp(const ipr::Unit& unit, std::ostream& os = std::cout, size_t threads = 0);
+}
+
 namespace cxx
 {
     using cxxm::print_cpp;
@@ -14,6 +14,8 @@
 #include <algorithm>
 #include <iomanip>
 #include <iterator>
+#include <string>
+#include <type_traits>
 #include <vector>
 
 //------------------------------------------------------------------------------
@@ -54,6 +56,80 @@ inline std::string prefix(const std::string& declarator)
     return !declarator.empty() && isid(declarator[declarator.length()-1]) ? declarator+' ' : declarator;
 }
 
+//==============================================================================
+// output_buffer
+//==============================================================================
+
+/// Bulk output buffer used by printers instead of writing every token through
+/// std::ostream. Text either accumulates in a string owned by the caller or in
+/// a chunk written to the stream once it is full and when the buffer is
+/// destroyed. The chunk keeps its capacity after being written, so only the
+/// first one is allocated, and integers are formatted in place without
+/// locales or stream state.
+class output_buffer
+{
+public:
+
+    /// Size of chunks written to the stream at once
+    static const size_t chunk_size = 64*1024;
+
+    explicit output_buffer(std::ostream& os) : m_os(&os), m_text(m_chunk) { m_chunk.reserve(chunk_size); }
+    explicit output_buffer(std::string&  s)  : m_os(0),   m_text(s)       {}
+            ~output_buffer() { flush(); }
+
+    output_buffer& operator<<(char c)                 { m_text.push_back(c); return written(); }
+    output_buffer& operator<<(const char* str)        { m_text.append(str);  return written(); }
+    output_buffer& operator<<(const std::string& str) { m_text.append(str);  return written(); }
+
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value && !std::is_same<T,bool>::value, output_buffer&>::type
+    operator<<(T n)
+    {
+        typedef typename std::make_unsigned<T>::type U;
+        char  digits[3*sizeof(T)+1];
+        char* p = digits + sizeof(digits);
+        U     u = n < 0 ? U(0) - U(n) : U(n); // Well defined for the smallest value as well
+
+        do { *--p = char('0' + u % 10); } while (u /= 10);
+
+        if (n < 0)
+            *--p = '-';
+
+        m_text.append(p, digits + sizeof(digits));
+        return written();
+    }
+
+    /// Appends n copies of c
+    output_buffer& fill(size_t n, char c = ' ') { m_text.append(n,c); return written(); }
+
+    /// Writes buffered text to the stream, if buffer has one
+    void flush()
+    {
+        if (m_os && !m_text.empty())
+        {
+            m_os->write(m_text.data(), m_text.size());
+            m_text.clear(); // Keeps capacity
+        }
+    }
+
+private:
+
+    output_buffer(const output_buffer&);            // = delete
+    output_buffer& operator=(const output_buffer&); // = delete
+
+    output_buffer& written()
+    {
+        if (m_os && m_text.size() >= chunk_size)
+            flush();
+
+        return *this;
+    }
+
+    std::ostream* m_os;    ///< Stream the text goes to, 0 when it stays in a string
+    std::string   m_chunk; ///< Chunk of pending text for the stream
+    std::string&  m_text;  ///< Where the text is appended: either m_chunk or user's string
+};
+
 //==============================================================================
 // cxx_printer_base
 //==============================================================================
@@ -67,8 +143,8 @@ class cxx_printer_base
 {
 protected:
 
-    const std::ostream& base() const { return m_os; }
-          std::ostream& base()       { return m_os; }
+    const output_buffer& base() const { return m_out; }
+          output_buffer& base()       { return m_out; }
 
 public:
 
@@ -76,7 +152,7 @@ public:
         std::ostream&       os, 
         bool                part_of_expression
     ) :
-        m_os(os),
+        m_out(os),
         m_part_of_expression(part_of_expression),
         m_indent_level(0),
         m_commenter(0)
@@ -86,7 +162,7 @@ public:
         std::ostream&       os,
         int                 indent_level = 0
     ) :
-        m_os(os),
+        m_out(os),
         m_part_of_expression(false),
         m_indent_level(indent_level),
         m_commenter(0)
@@ -97,19 +173,30 @@ public:
         comments_interface& c,
         int                 indent_level = 0
     ) :
-        m_os(os),
+        m_out(os),
         m_part_of_expression(false),
         m_indent_level(indent_level),
         m_commenter(&c)
     {}
 
+    /// Printers of subcomponents append their text directly to a string
+    cxx_printer_base(
+        std::string&        s,
+        bool                part_of_expression = false
+    ) :
+        m_out(s),
+        m_part_of_expression(part_of_expression),
+        m_indent_level(0),
+        m_commenter(0)
+    {}
+
     bool is_part_of_expression() const { return m_part_of_expression; }
     int  indent_level() const { return m_indent_level; }
 
 //protected:
 
-    /// The actual stream we are wrapping
-    std::ostream& m_os;
+    /// Buffer over the actual stream or string we are wrapping
+    output_buffer m_out;
 
     /// Indicates that corresponding statement is printed as part of expression
     /// and thus trailing ; as well as new-lines and comments should be avoided.
@@ -137,6 +224,7 @@ public:
     cxx_printer_of(std::ostream& os, bool part_of_expression)                     : cxx_printer_base(os,part_of_expression) {}
     cxx_printer_of(std::ostream& os, int  indent_level = 0)                       : cxx_printer_base(os,indent_level)       {}
     cxx_printer_of(std::ostream& os, comments_interface& c, int indent_level = 0) : cxx_printer_base(os,c,indent_level)     {}
+    cxx_printer_of(std::string&  s,  bool part_of_expression = false)             : cxx_printer_base(s,part_of_expression)  {}
 
     const Derived& derived() const { return *static_cast<const Derived*>(this); }
           Derived& derived()       { return *static_cast<      Derived*>(this); }
@@ -195,13 +283,12 @@ public:
     {
         if (!m_part_of_expression)
         {
-            base() << std::endl;
+            base() << '\n';
 
             if (empty_line)
-                base() << std::endl;
+                base() << '\n';
 
-            if (m_indent_level)
-                base() << std::setw(m_indent_level*4) << ' ';
+            base().fill(m_indent_level*4);
         }
 
         return derived();
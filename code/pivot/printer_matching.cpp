@@ -10,6 +10,7 @@
 #include "printer_matching.hpp"
 #include "precedence.hpp"
 #include "match_ipr.hpp"         // Pattern-matching bindings for IPR hierarchy.
+#include "node_memo.hpp"
 
 /// Pattern-matching version of C++ printer
 namespace cxxm
@@ -17,7 +18,15 @@ namespace cxxm
 
 //------------------------------------------------------------------------------
 
-std::string eval_name(const ipr::Name& name)
+#if XTL_IPR_MEMOIZE
+/// Text of unified types and names printed by this thread in the current pass
+thread_local node_memo<std::string> names_memo;
+thread_local node_memo<std::string> types_memo;
+#endif
+
+//------------------------------------------------------------------------------
+
+static std::string match_name(const ipr::Name& name)
 {
     Match(name)
     {
@@ -64,9 +73,20 @@ std::string eval_name(const ipr::Name& name)
     EndMatch
 }
 
+std::string eval_name(const ipr::Name& name)
+{
+#if XTL_IPR_MEMOIZE
+    // Rname nodes are resolved through the parameters of templates being
+    // printed, so text of names is only memoized outside of templates.
+    if (template_parameters_stack.empty())
+        return names_memo.get(name, &match_name);
+#endif
+    return match_name(name);
+}
+
 //------------------------------------------------------------------------------
 
-std::string eval_type(const ipr::Type& n, const std::string& declarator, size_t decl_precedence) 
+static std::string match_type(const ipr::Type& n, const std::string& declarator, size_t decl_precedence)
 {
     const std::string& t = ::precedence(n) < decl_precedence ? '(' + declarator + ')' : declarator;
     std::string result;
@@ -144,6 +164,17 @@ std::string eval_type(const ipr::Type& n, const std::string& declarator, size_t
     return result;
 }
 
+std::string eval_type(const ipr::Type& n, const std::string& declarator, size_t decl_precedence) 
+{
+#if XTL_IPR_MEMOIZE
+    // Only the text of the type itself is shared by all its uses, not the one
+    // with a declarator woven into it.
+    if (declarator.empty() && decl_precedence == 0 && template_parameters_stack.empty())
+        return types_memo.get(n, [](const ipr::Type& t) { return match_type(t, std::string(), 0); });
+#endif
+    return match_type(n, declarator, decl_precedence);
+}
+
 //------------------------------------------------------------------------------
 
 std::string eval_classic(const ipr::Classic& n)
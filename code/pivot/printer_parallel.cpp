@@ -0,0 +1,82 @@
+///
+/// \file printer_parallel.cpp
+///
+/// Implementation of a C++ pretty-printer for Pivot that prints top-level
+/// declarations of a translation unit concurrently with the pattern-matching
+/// printer.
+///
+/// \author Yuriy Solodkyy
+/// Copyright (C) 2011, Texas A&M University.  All rights reserved.
+///
+
+#include "printer.hpp"
+#include "match_ipr.hpp"         // Pattern-matching bindings for IPR hierarchy.
+#include "parallel_traversal.hpp"
+#include "node_memo.hpp"
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+/// Parallel version of C++ printer
+namespace cxxp
+{
+
+//------------------------------------------------------------------------------
+
+/// Visitor of the traversal that spawns every top-level declaration of a unit
+/// and prints each of them with the pattern-matching printer into its own slot.
+struct top_level_printer
+{
+    typedef work_stealing_traversal<ipr::Node> traversal;
+
+    explicit top_level_printer(const ipr::Sequence<ipr::Decl>& decls) : slots(decls.size())
+    {
+        // Slots are assigned before the traversal, so that threads only read the index
+        for (int i = 0; i < decls.size(); ++i)
+            index[&decls[i]] = i;
+    }
+
+    void operator()(const ipr::Node& n, traversal::spawner& s)
+    {
+        Match(n)
+        {
+            Case(ipr::Unit, global_scope) s.spawn(global_scope); return;
+            Case(ipr::Global_scope, members)
+            {
+                for (int i = 0; i < members.size(); ++i)
+                    s.spawn(members[i]);
+
+                return;
+            }
+        }
+        EndMatch
+
+        std::ostringstream ss;
+        cxxm::print_cpp(n, ss);
+        slots[index.at(&n)] = ss.str(); // Distinct slot per declaration, no synchronization needed
+    }
+
+    std::unordered_map<const ipr::Node*, size_t> index; ///< Slot of each top-level declaration
+    std::vector<std::string>                     slots; ///< Text of each top-level declaration
+};
+
+//------------------------------------------------------------------------------
+
+void print_cpp(const ipr::Unit& unit, std::ostream& os, size_t threads)
+{
+    cxxm::begin_pass(); // Nodes memoized by earlier passes may have been freed since
+
+    top_level_printer            printer(unit.get_global_scope().members());
+    top_level_printer::traversal traversal(threads);
+
+    traversal.run(unit, printer);
+
+    // Declarations are written in their original order regardless of which
+    // thread printed them
+    for (size_t i = 0; i < printer.slots.size(); ++i)
+        os << printer.slots[i];
+}
+
+//------------------------------------------------------------------------------
+
+} // of namespace cxxp
@@ -21,7 +21,8 @@ namespace cxxv {
 
 /// Set of template parameters with corresponding nesting of the currently
 /// processed template to be resolved for Rname nodes.
-std::deque<const ipr::Parameter_list*> template_parameters_stack; // FIX: Make this thread local somehow
+/// The stack is per thread, since templates are printed concurrently by cxxp::print_cpp.
+thread_local std::deque<const ipr::Parameter_list*> template_parameters_stack;
 
 //------------------------------------------------------------------------------
 
@@ -44,6 +45,7 @@ public:
     cxx_printer(std::ostream& os, bool part_of_expression)                     : base_type(os,part_of_expression) {}
     cxx_printer(std::ostream& os, int  indent_level = 0)                       : base_type(os,indent_level)       {}
     cxx_printer(std::ostream& os, comments_interface& c, int indent_level = 0) : base_type(os,c,indent_level)     {}
+    cxx_printer(std::string&  s,  bool part_of_expression = false)             : base_type(s,part_of_expression)  {}
 
     using base_type::operator<<;
 
@@ -145,20 +147,18 @@ std::string eval_expr(const ipr::Expr& n)
     // and we assume here that only the cases that won't print newlines etc. can
     // happen there.
 
-    std::stringstream ss;
-    cxx_printer cxx(ss);
-    cxx << n;
-    return ss.str();
+    std::string result;
+    cxx_printer(result) << n;
+    return result;
 }
 
 //------------------------------------------------------------------------------
 
 std::string eval_decl(const ipr::Decl& n)
 {
-    std::stringstream ss;
-    cxx_printer cxx(ss,true);
-    cxx << n;
-    return ss.str();
+    std::string result;
+    cxx_printer(result,true) << n;
+    return result;
 }
 
 //------------------------------------------------------------------------------
@@ -0,0 +1,90 @@
+///
+/// \file time_printers.cpp
+///
+/// Timing of the visitor-based, pattern-matching and parallel pattern-matching
+/// C++ printers for Pivot on a given translation unit.
+///
+/// \author Yuriy Solodkyy
+/// Copyright (C) 2011, Texas A&M University.  All rights reserved.
+///
+/// \note Build it with and without -DXTL_IPR_CATEGORY_DISPATCH=1 to compare
+///       dispatch on categories with the default vtbl-based one.
+/// \note Build it with and without -DXTL_IPR_MEMOIZE=1 to compare memoized
+///       printing of types and names with matching them on every visit.
+/// \note The unit is expected to be loaded by the driver linking this file
+///       together with printer_parallel.cpp, printer_matching.cpp and
+///       printer_visitors.cpp, e.g. from a whole-program IPR dump.
+///
+
+#include "config.hpp"
+#include "printer.hpp"
+#include "node_memo.hpp"
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <thread>
+
+#if !defined(XTL_IPR_CATEGORY_DISPATCH)
+#define XTL_IPR_CATEGORY_DISPATCH 0 // Has to be the same as for printers, \see match_ipr.hpp
+#endif
+
+#if !defined(XTL_IPR_MEMOIZE)
+#define XTL_IPR_MEMOIZE 0 // Has to be the same as for printers, \see match_ipr.hpp
+#endif
+
+//------------------------------------------------------------------------------
+
+/// Returns time in milliseconds of the fastest of a given number of runs of f
+template <typename F>
+double fastest_of(size_t runs, F f)
+{
+    double best = 0.0;
+
+    for (size_t i = 0; i < runs; ++i)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        f();
+        std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - start;
+
+        if (i == 0 || ms.count() < best)
+            best = ms.count();
+    }
+
+    return best;
+}
+
+//------------------------------------------------------------------------------
+
+/// Prints timings of the printers on a unit to report and asserts that the 
+/// parallel matching printer prints it as the sequential one does.
+void time_printers(const ipr::Unit& unit, std::ostream& report, size_t runs = 5)
+{
+    const ipr::Sequence<ipr::Decl>& decls = unit.get_global_scope().members();
+
+    double tv = fastest_of(runs, [&]{ std::ostringstream os; cxxv::print_cpp(unit, os); });
+    double tm = fastest_of(runs, [&]{ std::ostringstream os; cxxm::begin_pass(); cxxm::print_cpp(unit, os); });
+
+    report << "Dispatch:     " << (XTL_IPR_CATEGORY_DISPATCH ? "category" : "vtbl") << std::endl
+           << "Memoization:  " << (XTL_IPR_MEMOIZE ? "on" : "off") << std::endl
+           << "Declarations: " << decls.size() << std::endl
+           << "Visitors:     " << tv << " ms" << std::endl
+           << "Matching:     " << tm << " ms (" << tv/tm << "x)" << std::endl;
+
+    // Parallel printer writes each top-level declaration as sequential one does on its own
+    std::ostringstream expected;
+
+    for (int i = 0; i < decls.size(); ++i)
+        cxxm::print_cpp(decls[i], expected);
+
+    for (size_t threads = 1; threads <= std::max(1u, std::thread::hardware_concurrency()); threads *= 2)
+    {
+        std::ostringstream actual;
+        cxxp::print_cpp(unit, actual, threads);
+        XTL_ASSERT(actual.str() == expected.str());
+
+        double tp = fastest_of(runs, [&]{ std::ostringstream os; cxxp::print_cpp(unit, os, threads); });
+        report << "Parallel " << threads << ":   " << tp << " ms (" << tv/tp << "x)" << std::endl;
+    }
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,262 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library.
+///
+/// Collection of polymorphic objects derived from Base that keeps objects of 
+/// the same dynamic type next to each other in a segment of their own, like 
+/// Boost.PolyCollection does:
+/// \code
+///     mch::poly_collection<Shape> shapes;
+///     shapes.insert(Circle(1));
+///     shapes.emplace<Square>(2);
+///     shapes.for_each(
+///         mch::case_<Circle>([&](const Circle& c) { area += 3*c.r*c.r; }),
+///         mch::case_<Square>([&](const Square& q) { area += q.s*q.s;   }),
+///         mch::otherwise    ([&](const Shape&  x) { ++unknown;         }));
+/// \endcode
+/// for_each takes the same clauses as mch::match, but selects the clause only
+/// once per segment and then calls it on all the objects of the segment in a 
+/// loop of their own, without dispatching on each of them.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#pragma once
+
+// --------------------[ Design Notes ]--------------------
+// - A segment is a std::vector of objects of one dynamic type, created when 
+//   the first object of that type is inserted. Inserting objects thus may 
+//   move the other objects of the same type, like push_back of a vector does.
+// - Objects are visited segment by segment in the order the segments were 
+//   created and in the order of insertion within each segment.
+// - The clause is selected with the first object of a segment, which is valid
+//   for all of them since they share the dynamic type, and so is the offset of
+//   the target type of the clause from Base. The loop over the segment only 
+//   adds the offset to the address of Base in each object.
+// - Selection does not go through a vtbl map: for_each costs as many 
+//   dynamic_cast per segment as a cache miss of mch::match would, which is 
+//   small next to the loops over the segments.
+//------------------------------------------------------------------------------
+
+#include "match_function.hpp"
+#include <memory>
+#include <typeindex>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+namespace mch ///< Mach7 library namespace
+{
+
+//------------------------------------------------------------------------------
+
+/// Calls clause c with the subject adjusted to its target type, ignoring the result
+template <typename S, typename T, typename F>
+inline void apply_clause(case_clause<T,F>& c, const S* s, std::ptrdiff_t offset)
+{
+    c.function(*adjust_ptr_if_polymorphic<T>(s, offset));
+}
+
+template <typename S, typename F>
+inline void apply_clause(otherwise_clause<F>& c, const S* s, std::ptrdiff_t)
+{
+    c.function(*s);
+}
+
+/// Entry I of the jump table of poly_collection::for_each: calls clause I on 
+/// n subjects of the same dynamic type that are stride bytes apart
+template <size_t I, typename S, typename Cs>
+void apply_clause_to_all(Cs& cs, const char* p, size_t n, size_t stride, std::ptrdiff_t offset)
+{
+    for (const char* e = p + n*stride; p != e; p += stride)
+        apply_clause(std::get<I>(cs), reinterpret_cast<const S*>(p), offset);
+}
+
+/// Last entry of the jump table, taken when no clause accepts the subjects
+template <typename S, typename Cs>
+void apply_no_clause(Cs&, const char*, size_t, size_t, std::ptrdiff_t)
+{
+}
+
+//------------------------------------------------------------------------------
+
+/// Collection of objects derived from Base segregated by their dynamic type
+/// \see poly_collection.hpp
+template <typename Base>
+class poly_collection
+{
+public:
+
+    static_assert(std::is_polymorphic<Base>::value, "mch::poly_collection requires a polymorphic base class");
+
+    poly_collection() : m_size(0) {}
+    poly_collection(poly_collection&& other) : m_segments(std::move(other.m_segments)), m_index(std::move(other.m_index)), m_size(other.m_size) { other.m_size = 0; }
+
+    /// Copies or moves object x into the segment of its class D, which has to
+    /// be its dynamic type too, and returns the object in the segment
+    template <typename X>
+    typename std::decay<X>::type& insert(X&& x)
+    {
+        typedef typename std::decay<X>::type D;
+        XTL_ASSERT(typeid(x) == typeid(D)); // It would be sliced otherwise
+        return segment_for<D>().add(std::forward<X>(x));
+    }
+
+    /// Constructs an object of class D in its segment from arguments a
+    template <typename D, typename... A>
+    D& emplace(A&&... a)
+    {
+        return segment_for<D>().add(D(std::forward<A>(a)...));
+    }
+
+    /// Total number of objects
+    size_t size() const noexcept { return m_size; }
+
+    /// Whether there are no objects
+    bool empty() const noexcept { return m_size == 0; }
+
+    /// Number of dynamic types of the objects inserted so far
+    size_t segments() const noexcept { return m_segments.size(); }
+
+    /// Number of objects of dynamic type D
+    template <typename D>
+    size_t count() const
+    {
+        typename index_type::const_iterator p = m_index.find(std::type_index(typeid(D)));
+        return p == m_index.end() ? 0 : p->second->size();
+    }
+
+    /// Destroys all the objects, keeping the segments for objects inserted next
+    void clear()
+    {
+        for (size_t i = 0; i < m_segments.size(); ++i)
+            m_segments[i]->clear();
+
+        m_size = 0;
+    }
+
+    /// Calls the first of clauses made by mch::case_ and mch::otherwise that 
+    /// accepts the dynamic type of each object with that object. The clause 
+    /// is selected once per segment rather than once per object.
+    template <typename... C>
+    void for_each(C&&... clauses) const
+    {
+        std::tuple<typename std::decay<C>::type...> cs(std::forward<C>(clauses)...);
+        for_each_in(cs, typename make_clause_indices<sizeof...(C)>::type());
+    }
+
+private:
+
+    /// Objects of one dynamic type
+    struct segment
+    {
+        explicit segment(size_t s) : stride(s) {}
+        virtual ~segment() {}
+        virtual size_t      size()  const = 0;
+        virtual const Base* first() const = 0; ///< Base of the first object
+        virtual void        clear()       = 0;
+        const size_t stride;                   ///< Distance between the objects
+    };
+
+    /// Segment of objects of class D
+    template <typename D>
+    struct segment_of : segment
+    {
+        static_assert(std::is_base_of<Base,D>::value, "mch::poly_collection requires classes derived from its base class");
+
+        segment_of() : segment(sizeof(D)) {}
+
+        D& add(D&& x)      { objects.push_back(std::move(x)); return objects.back(); }
+        D& add(const D& x) { objects.push_back(x);            return objects.back(); }
+
+        size_t      size()  const { return objects.size(); }
+        const Base* first() const { return &objects.front(); }
+        void        clear()       { objects.clear(); }
+
+        std::vector<D> objects;
+    };
+
+    /// Segment of objects of class D, created if there is none yet
+    template <typename D>
+    segment_of<D>& segment_for()
+    {
+        segment*& s = m_index[std::type_index(typeid(D))];
+
+        if (!s)
+        {
+            m_segments.push_back(std::unique_ptr<segment>(new segment_of<D>));
+            s = m_segments.back().get();
+        }
+
+        ++m_size;
+        return static_cast<segment_of<D>&>(*s);
+    }
+
+    template <typename Cs, size_t... I>
+    void for_each_in(Cs& cs, clause_indices<I...>) const
+    {
+        typedef void (*entry_type)(Cs&, const char*, size_t, size_t, std::ptrdiff_t);
+        static const entry_type table[] = { &apply_clause_to_all<I,Base,Cs>..., &apply_no_clause<Base,Cs> };
+
+        for (size_t i = 0; i < m_segments.size(); ++i)
+        {
+            const segment& s = *m_segments[i];
+
+            if (const size_t n = s.size())
+            {
+                const Base* b = s.first();
+                type_switch_info<1> si;
+                si.offset[0] = 0;                   // Stays so when no clause accepts b
+                resolve_clause<0>(si, b, std::get<I>(cs)...);
+                table[si.target-1](cs, reinterpret_cast<const char*>(b), n, s.stride, si.offset[0]);
+            }
+        }
+    }
+
+    typedef std::unordered_map<std::type_index, segment*> index_type;
+
+    std::vector<std::unique_ptr<segment>> m_segments; ///< Segments in the order of their creation
+    index_type                            m_index;    ///< Segment of each dynamic type
+    size_t                                m_size;     ///< Total number of objects
+};
+
+//------------------------------------------------------------------------------
+
+} // of namespace mch
@@ -0,0 +1,133 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// \file
+///
+/// This file defines static probes fired on the slow paths of vtbl maps and
+/// memoized_cast, to which tools like bpftrace, perf or SystemTap attach in a
+/// running program to find where it keeps missing, e.g.:
+///
+///     bpftrace -e 'usdt:./a.out:mach7:vtbl_miss { @[arg0, arg1] = count(); }'
+///
+/// Probes of provider mach7 and their arguments:
+/// - vtbl_miss(map, vtbl)       : lookup in a vtbl map did not find vtbl where expected
+/// - vtbl_update(map, vtbl)     : the map rearranges its cache because of vtbl
+/// - descriptor_swap(map, vtbl) : a multi-threaded vtblmap replaced its cache descriptor
+/// - cast_miss(vtbl, target)    : memoized_cast calls dynamic_cast to learn an offset
+///
+/// The address of a map identifies the Match statement it belongs to, the
+/// vtbl is the first one of the subjects for maps on several of them.
+///
+/// \note This file is included by vtbl maps and memoized_cast when 
+///       #XTL_STATIC_PROBES is enabled.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#pragma once
+
+// --------------------[ Design Notes ]--------------------
+// - Probes follow the SystemTap SDT convention: a nop in the code and a note
+//   in section .note.stapsdt that gives its address and where to find its
+//   arguments. Tools attaching to a probe replace the nop with a breakpoint.
+// - <sys/sdt.h> is used when available. Otherwise the note is emitted here 
+//   for x86-64 and AArch64, which only needs the assembler, so that probes do
+//   not depend on systemtap-sdt-dev being installed on the build machine.
+// - Arguments are passed in registers ("8@%rax"), which is the only operand
+//   form every consumer of the notes understands.
+// - ETW on Windows needs a provider registered by one translation unit of the
+//   program, which a header-only library cannot own. Such programs define
+//   XTL_PROBE(name,a0,a1) themselves, e.g. as TraceLoggingWrite of their
+//   provider, before including Mach7 headers.
+
+#include "config.hpp"
+#include <cstdint>
+
+#if !defined(XTL_PROBE)
+
+#if defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#define XTL_HAS_SYS_SDT 1
+#endif
+#endif
+
+#if defined(XTL_HAS_SYS_SDT)
+
+#include <sys/sdt.h>
+
+/// Fires probe mach7:name with two pointer-sized arguments
+#define XTL_PROBE(name,a0,a1) DTRACE_PROBE2(mach7, name, (std::uintptr_t)(a0), (std::uintptr_t)(a1))
+
+#elif defined(__ELF__) && (defined(__x86_64__) || defined(__aarch64__))
+
+/// Fires probe mach7:name with two pointer-sized arguments.
+/// Emits the same note as STAP_PROBE2 of <sys/sdt.h> with no semaphore.
+#define XTL_PROBE(name,a0,a1)                                                   \
+    __asm__ __volatile__(                                                       \
+        "990: nop\n"                                                            \
+        ".pushsection .note.stapsdt,\"\",\"note\"\n"                            \
+        ".balign 4\n"                                                           \
+        ".4byte 992f-991f, 994f-993f, 3\n"                                      \
+        "991: .asciz \"stapsdt\"\n"                                             \
+        "992: .balign 4\n"                                                      \
+        "993: .8byte 990b\n"                                                    \
+        ".8byte _.stapsdt.base\n"                                               \
+        ".8byte 0\n"                                                            \
+        ".asciz \"mach7\"\n"                                                    \
+        ".asciz \"" #name "\"\n"                                                \
+        ".asciz \"8@%0 8@%1\"\n"                                                \
+        "994: .balign 4\n"                                                      \
+        ".popsection\n"                                                         \
+        ".ifndef _.stapsdt.base\n"                                              \
+        ".pushsection .stapsdt.base,\"aG\",\"progbits\",.stapsdt.base,comdat\n" \
+        ".weak _.stapsdt.base\n"                                                \
+        ".hidden _.stapsdt.base\n"                                              \
+        "_.stapsdt.base: .space 1\n"                                            \
+        ".size _.stapsdt.base, 1\n"                                             \
+        ".popsection\n"                                                         \
+        ".endif\n"                                                              \
+        :: "r"((std::uintptr_t)(a0)), "r"((std::uintptr_t)(a1)))
+
+#else
+
+/// No probes on this platform unless the program defines XTL_PROBE itself
+#define XTL_PROBE(name,a0,a1) ((void)0)
+
+#endif
+
+#endif
@@ -54,6 +54,9 @@
 #if defined(_MSC_VER)
     #include <excpt.h>
 #endif
+#if XTL_USE_PDEP
+    #include <immintrin.h> // _pdep_u32
+#endif
 #if !defined(_MSC_VER) || _MSC_VER >= 1600 
     #include <cstdint>
 #else
@@ -84,6 +87,20 @@ namespace mch ///< Mach7 library namespace
 
 //------------------------------------------------------------------------------
 
+/// Address of the vtbl that a vtbl-pointer stored in an object points to, 
+/// without the authentication code or tag some platforms keep in its high 
+/// bits \see #XTL_STRIP_VTBL_SIGNATURES
+inline std::intptr_t vtbl_address(std::intptr_t vtbl) noexcept
+{
+#if XTL_STRIP_VTBL_SIGNATURES && XTL_VTBL_ADDRESS_BITS
+    return vtbl & ((std::intptr_t(1) << XTL_VTBL_ADDRESS_BITS) - 1);
+#elif XTL_STRIP_VTBL_SIGNATURES && defined(XTL_STRIP_VTBL_SIGNATURE)
+    return XTL_STRIP_VTBL_SIGNATURE(vtbl);
+#else
+    return vtbl;
+#endif
+}
+
 /// Generic function that obtains a value of a primary vtbl-pointer from a 
 /// polymorphic object, pointed to by p.
 /// \note This default implementation assumes the vtbl-pointer is located at 
@@ -91,7 +108,7 @@ namespace mch ///< Mach7 library namespace
 ///       to overload this function for class hierarchies, where this is not the case.
 inline std::intptr_t vtbl_of(const void* p) noexcept
 {
-    return *reinterpret_cast<const std::intptr_t*>(p);
+    return vtbl_address(*reinterpret_cast<const std::intptr_t*>(p));
 }
 
 //------------------------------------------------------------------------------
@@ -106,6 +123,36 @@ template <typename T, typename S> inline auto adjust_ptr_if_polymorphic(      S*
 
 //------------------------------------------------------------------------------
 
+/// Whether objects of static type S are always of dynamic type S too, as they
+/// are when S is final. Specialize it for classes that are known to have no
+/// derived classes without being declared final. \see #XTL_EXACT_SUBJECTS
+template <typename S>
+struct is_exact_type : std::integral_constant<bool, XTL_EXACT_SUBJECTS && std::is_polymorphic<S>::value && XTL_IS_FINAL(S)> {};
+
+/// Whether subjects of static type S are dispatched on their dynamic type
+template <typename S>
+struct is_dispatched_type : std::integral_constant<bool, std::is_polymorphic<S>::value && !is_exact_type<S>::value> {};
+
+/// Subject p of exact type S (\see is_exact_type) as its target type T, which
+/// is either S or its accessible and unambiguous base. Clauses whose target is 
+/// not are never taken, so for them this returns null.
+template <typename T, typename S> inline auto exact_target(const S* p, std::true_type ) noexcept -> const T* { return &static_cast<const T&>(*p); }
+template <typename T, typename S> inline auto exact_target(const S*  , std::false_type) noexcept -> const T* { return nullptr; }
+template <typename T, typename S> inline auto exact_target(      S* p, std::true_type ) noexcept ->       T* { return &static_cast<      T&>(*p); }
+template <typename T, typename S> inline auto exact_target(      S*  , std::false_type) noexcept ->       T* { return nullptr; }
+
+template <typename T, typename S> inline auto exact_target(const S* p) noexcept -> const T* { return exact_target<T>(p, std::integral_constant<bool, std::is_convertible<const S*,const T*>::value>()); }
+template <typename T, typename S> inline auto exact_target(      S* p) noexcept ->       T* { return exact_target<T>(p, std::integral_constant<bool, std::is_convertible<      S*,      T*>::value>()); }
+
+/// Subject p as its target type T: at offset given for subjects dispatched on
+/// their dynamic type and at the one known statically for those of exact types
+template <typename T, typename S> inline auto adjust_ptr_unless_exact(const S* p, std::ptrdiff_t offset) noexcept -> typename std::enable_if<!is_exact_type<S>::value,const T*>::type { return adjust_ptr_if_polymorphic<T>(p, offset); }
+template <typename T, typename S> inline auto adjust_ptr_unless_exact(const S* p, std::ptrdiff_t       ) noexcept -> typename std::enable_if< is_exact_type<S>::value,const T*>::type { return exact_target<T>(p); }
+template <typename T, typename S> inline auto adjust_ptr_unless_exact(      S* p, std::ptrdiff_t offset) noexcept -> typename std::enable_if<!is_exact_type<S>::value,      T*>::type { return adjust_ptr_if_polymorphic<T>(p, offset); }
+template <typename T, typename S> inline auto adjust_ptr_unless_exact(      S* p, std::ptrdiff_t       ) noexcept -> typename std::enable_if< is_exact_type<S>::value,      T*>::type { return exact_target<T>(p); }
+
+//------------------------------------------------------------------------------
+
 template <typename T> inline const T* addr(const T* t) noexcept { return t; }
 template <typename T> inline       T* addr(      T* t) noexcept { return t; }
 template <typename T> inline const T* addr(const T& t) noexcept { return std::addressof(t); }
@@ -118,6 +165,7 @@ template <typename T, typename U> inline       T* stat_cast(      U* p) noexcept
 
 //------------------------------------------------------------------------------
 
+#if XTL_RTTI
 template <typename T> const std::type_info& vtbl_typeid(std::intptr_t vtbl) noexcept
 {
 #ifdef _MSC_VER
@@ -151,6 +199,28 @@ struct polymorphic_dummy { virtual ~polymorphic_dummy(){} };
 
 inline const std::type_info& vtbl_typeid(std::intptr_t vtbl) noexcept { return vtbl_typeid<polymorphic_dummy>(vtbl); }
 inline const std::type_info& vtbl_typeid(const void* p)      noexcept { return vtbl_typeid<polymorphic_dummy>(p); }
+#endif
+
+/// Whether two vtbl pointers are copies of the same vtbl, e.g. emitted by 
+/// different shared libraries: they describe the same sub-object of the same 
+/// class, so a pointer to it needs the same adjustments in either case.
+inline bool vtbl_aliases(std::intptr_t vtbl1, std::intptr_t vtbl2) noexcept
+{
+    if (vtbl1 == vtbl2)
+        return true;
+
+#if defined(_MSC_VER) || !XTL_RTTI
+    // FIX: The offset of the sub-object is in the complete object locator of MSVC
+    // Without RTTI there is no type_info to tell copies of a vtbl from vtbls of
+    // other classes, so they are treated as different vtbls
+    return false;
+#else
+    // Itanium C++ ABI: offset to top and type_info precede the virtual functions
+    const std::intptr_t* v1 = reinterpret_cast<const std::intptr_t*>(vtbl1);
+    const std::intptr_t* v2 = reinterpret_cast<const std::intptr_t*>(vtbl2);
+    return v1[-2] == v2[-2] && vtbl_typeid(vtbl1) == vtbl_typeid(vtbl2);
+#endif
+}
 
 //------------------------------------------------------------------------------
 
@@ -187,6 +257,101 @@ inline uint32_t trailing_zeros(uint32_t v) noexcept
 
 //------------------------------------------------------------------------------
 
+/// Probe classes with different number of virtual functions, whose vtbl-pointers
+/// are used by vtbl_irrelevant_bits() to measure alignment of vtbl-pointers.
+struct vtbl_probe1 { virtual ~vtbl_probe1() {} };
+struct vtbl_probe2 : vtbl_probe1 { virtual void f() {} };
+struct vtbl_probe3 : vtbl_probe2 { virtual void g() {} };
+struct vtbl_probe4 : vtbl_probe3 { virtual void h() {} };
+struct vtbl_probe5 { virtual ~vtbl_probe5() {} virtual void f() {} };
+struct vtbl_probe6 : vtbl_probe5 { virtual void g() {} virtual void h() {} virtual void i() {} };
+
+/// Returns the number of irrelevant lowest bits in vtbl-pointers on this platform.
+/// The value is measured once from the vtbl-pointers of several probe classes
+/// with vtbls of different sizes: bits that are 0 in all of them are assumed
+/// to be 0 in all vtbl-pointers. The result never exceeds #XTL_IRRELEVANT_VTBL_BITS
+/// by more than 2, so that an accidental alignment of the probes does not make 
+/// the initial hashing drop relevant bits.
+/// \note Returns #XTL_IRRELEVANT_VTBL_BITS when #XTL_CALIBRATE_VTBL_BITS is 0.
+inline size_t vtbl_irrelevant_bits() noexcept
+{
+#if XTL_CALIBRATE_VTBL_BITS
+    struct calibration
+    {
+        static size_t measure() noexcept
+        {
+            const vtbl_probe1 p1; const vtbl_probe2 p2; const vtbl_probe3 p3;
+            const vtbl_probe4 p4; const vtbl_probe5 p5; const vtbl_probe6 p6;
+            const std::intptr_t v = vtbl_of(&p1) | vtbl_of(&p2) | vtbl_of(&p3)
+                                  | vtbl_of(&p4) | vtbl_of(&p5) | vtbl_of(&p6);
+            const size_t limit = XTL_IRRELEVANT_VTBL_BITS + 2;
+            size_t r = 0;
+
+            while (r < limit && !(v & (std::intptr_t(1) << r)))
+                ++r;
+
+            return r;
+        }
+    };
+
+    static const size_t bits = calibration::measure();
+    return bits;
+#else
+    return XTL_IRRELEVANT_VTBL_BITS;
+#endif
+}
+
+//------------------------------------------------------------------------------
+
+#if XTL_VTBL_INVALIDATION
+/// Range [begin,end) of addresses of vtbls, e.g. of a shared library about 
+/// to be unloaded, whose entries have to be dropped from caches keyed by them.
+struct vtbl_range
+{
+    std::intptr_t begin; ///< First address in the range
+    std::intptr_t end;   ///< Address past the last one in the range
+
+    bool contains(std::intptr_t vtbl) const noexcept { return begin <= vtbl && vtbl < end; }
+};
+
+/// Node of the intrusive list of functions that drop entries of vtbl-pointers
+/// within a range from all the caches of a kind, e.g. all vtblmap<T> for a 
+/// given T. Each kind of caches registers its node once through a static of 
+/// this type. \see invalidate_vtbl_range()
+struct vtbl_invalidator
+{
+    explicit vtbl_invalidator(size_t (*f)(const vtbl_range&)) noexcept : invalidate(f), next(head()) { head() = this; }
+
+    /// Head of the list of all the nodes
+    static vtbl_invalidator*& head() noexcept { static vtbl_invalidator* list = 0; return list; }
+
+    size_t          (*invalidate)(const vtbl_range&); ///< Drops entries of vtbls in the range and returns their number
+    vtbl_invalidator* next;                           ///< Next node in the list
+};
+
+/// Drops entries of vtbl-pointers within [begin,end) from vtbl_map<N,T> and
+/// vtblmap<T> instances of Match statements and of memoized_cast, so that 
+/// vtbls of other classes later loaded at the same addresses are not taken
+/// for them. Only the maps that have such entries are rebuilt, the others 
+/// are not touched.
+/// \note Invalidates references previously returned by lookups into the maps
+///       that had such entries, so it may not be called while a Match 
+///       statement is being executed, e.g. call it right before dlclose.
+/// \returns The number of entries dropped.
+inline size_t invalidate_vtbl_range(const void* begin, const void* end)
+{
+    const vtbl_range range = { reinterpret_cast<std::intptr_t>(begin), reinterpret_cast<std::intptr_t>(end) };
+    size_t dropped = 0;
+
+    for (vtbl_invalidator* p = vtbl_invalidator::head(); p; p = p->next)
+        dropped += p->invalidate(range);
+
+    return dropped;
+}
+#endif
+
+//------------------------------------------------------------------------------
+
 /// Counts the number of bits set in v (the Brian Kernighan's way)
 /// The following code to count set bits was taken from:
 /// http://graphics.stanford.edu/~seander/bithacks.html#CountBitsSetKernighan
@@ -335,6 +500,10 @@ inline uint32_t interleave(
     register uint32_t y  ///< are in the even positions and bits from y in the odd;
 ) noexcept
 {
+#if XTL_USE_PDEP
+    // Deposits lower bits of the arguments into the positions of mask bits
+    return _pdep_u32(x, 0x55555555) | _pdep_u32(y, 0xAAAAAAAA);
+#else
     x &= 0xFFFF;
     y &= 0xFFFF;
 
@@ -349,6 +518,7 @@ inline uint32_t interleave(
     y = (y | (y << 1)) & 0x55555555; // 01010101010101010101010101010101
 
     return x | (y << 1); // the resulting 32-bit Morton Number.  
+#endif
 }
 
 //------------------------------------------------------------------------------
@@ -397,6 +567,9 @@ inline uint32_t interleave(
     register uint32_t z  ///< and bits from z in mod 2 positions;
 ) noexcept
 {
+#if XTL_USE_PDEP
+    return _pdep_u32(x, 0x09249249) | _pdep_u32(y, 0x12492492) | _pdep_u32(z, 0x24924924);
+#else
     x &= 0x03FF;
     y &= 0x03FF;
     z &= 0x03FF;
@@ -417,6 +590,7 @@ inline uint32_t interleave(
     z = (z | (z <<  2)) & 0x09249249;
 
     return x | (y << 1) | (z << 2);
+#endif
 }
 
 //------------------------------------------------------------------------------
@@ -467,6 +641,9 @@ inline uint32_t interleave(
     register uint32_t w
 ) noexcept
 {
+#if XTL_USE_PDEP
+    return _pdep_u32(x, 0x11111111) | _pdep_u32(y, 0x22222222) | _pdep_u32(z, 0x44444444) | _pdep_u32(w, 0x88888888);
+#else
     x &= 0xFF;                        // x = 00000000 00000000 00000000 ABCDEFGH
     y &= 0xFF;                        // y = 00000000 00000000 00000000 ABCDEFGH
     z &= 0xFF;                        // z = 00000000 00000000 00000000 ABCDEFGH
@@ -488,6 +665,7 @@ inline uint32_t interleave(
     w = (w | (w <<  3)) & 0x11111111; // w = 000A000B 000C000D 000E000F 000G000H
 
     return x | (y << 1) | (z << 2) | (w << 3); // the resulting 32-bit Morton Number.  
+#endif
 }
 
 //------------------------------------------------------------------------------
@@ -519,10 +697,18 @@ inline T interleave(const T (&vtbl)[N]) noexcept
 // 8x4 - 56% faster V= 61 M= 39 * - 68% slower V= 60 M=101   -306% slower V= 54 M=222 + - 70% slower V= 53 M= 92 *
 // 4x4 - 48% faster V= 65 M= 44   - 59% faster V= 60 M= 37 * -866% slower V= 52 M=508   -107% slower V= 55 M=114  
 
+// With PDEP a single instruction per argument beats any of the above.
+
 inline intptr_t interleave(const intptr_t (&vtbl)[1]) noexcept { return vtbl[0]; }
+#if XTL_USE_PDEP
+inline intptr_t interleave(const intptr_t (&vtbl)[2]) noexcept { return interleave(vtbl[0],vtbl[1]); }
+#else
 inline intptr_t interleave(const intptr_t (&vtbl)[2]) noexcept { return interleave8x2(vtbl[0],vtbl[1]); }
+#endif
 inline intptr_t interleave(const intptr_t (&vtbl)[3]) noexcept { return interleave(vtbl[0],vtbl[1],vtbl[2]); }
-#if defined(__GNUC__)
+#if XTL_USE_PDEP
+inline intptr_t interleave(const intptr_t (&vtbl)[4]) noexcept { return interleave(vtbl[0],vtbl[1],vtbl[2],vtbl[3]); }
+#elif defined(__GNUC__)
 inline intptr_t interleave(const intptr_t (&vtbl)[4]) noexcept { return interleave4x4(vtbl[0],vtbl[1],vtbl[2],vtbl[3]); }
 #elif defined(_MSC_VER)
 inline intptr_t interleave(const intptr_t (&vtbl)[4]) noexcept { return interleave8x4(vtbl[0],vtbl[1],vtbl[2],vtbl[3]); }
@@ -0,0 +1,166 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library.
+///
+/// Term rewriting to a fixpoint with memoization. Rules and the traversal of
+/// subterms are user functions, typically written as Match statements:
+/// \code
+///     // Rewrites root of the term or returns it as is when no rule applies
+///     const Expr* simplify(const Expr* e)
+///     {
+///         var<const Expr*> x;
+///         Match(e)
+///         {
+///             Case(C<Plus>(x, C<Value>(0))) return x;
+///             Case(C<Times>(x, C<Value>(1))) return x;
+///         }
+///         EndMatch
+///         return e;
+///     }
+///
+///     // Rebuilds term from its subterms mapped by f, or returns it as is 
+///     // when f did not change any of them
+///     struct map_children
+///     {
+///         template <typename F> const Expr* operator()(const Expr* e, F& f) const;
+///     };
+///
+///     auto rewrite = mch::make_rewriter<Expr>(simplify, map_children());
+///     const Expr* n = rewrite(e);
+/// \endcode
+/// Rules are applied bottom-up: subterms are brought to normal form first, 
+/// then the rules are applied to the term rebuilt from them, and whatever 
+/// they turn it into is normalized again until no rule applies. The normal 
+/// form of every term visited is remembered, so subterms the rules did not 
+/// touch are never revisited, either in the same run or in later runs on 
+/// terms sharing them, e.g. after an optimizer modified a part of the tree.
+///
+/// \note Terms are compared by address, so the memoization is only effective
+///       for hash-consed terms, i.e. when the factory building them returns 
+///       the same object for structurally equal terms. Terms have to outlive
+///       the rewriter and may not be modified.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#pragma once
+
+#include "config.hpp"
+#include <cstddef>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+namespace mch ///< Mach7 library namespace
+{
+
+//------------------------------------------------------------------------------
+
+/// Rewriter of terms of type T to their normal forms under Rules. 
+/// \see rewrite.hpp for the requirements on Rules and Children.
+template <typename T, typename Rules, typename Children>
+class rewriter
+{
+public:
+
+    rewriter(Rules r, Children c) : rules(r), children(c), visited(0), rewritten(0) {}
+
+    /// Normal form of term t
+    const T* operator()(const T* t)
+    {
+        typename memo_type::const_iterator p = memo.find(t);
+
+        if (p != memo.end())
+            return p->second;
+
+        ++visited;
+        const T* u = children(t, *this); // Term with subterms in normal form
+        const T* v = rules(u);
+        const T* r = u;
+
+        if (v != u)
+        {
+            ++rewritten;
+            r = (*this)(v);              // Subterms of v not in normal form yet are new
+        }
+
+        memo[t] = r;
+
+        if (u != t)
+            memo[u] = r;
+
+        return r;
+    }
+
+    /// Forgets all normal forms, e.g. when terms they refer to are released
+    void clear() { memo.clear(); }
+
+    size_t visits()   const { return visited; }   ///< Number of terms whose normal form was computed
+    size_t rewrites() const { return rewritten; } ///< Number of times a rule applied
+    size_t size()     const { return memo.size(); } ///< Number of terms whose normal form is known
+
+private:
+
+    typedef std::unordered_map<const T*,const T*> memo_type;
+
+    Rules     rules;     ///< Rewrites the root of a term whose subterms are in normal form
+    Children  children;  ///< Rebuilds a term from its subterms mapped by the rewriter
+    memo_type memo;      ///< Normal forms of terms visited
+    size_t    visited;
+    size_t    rewritten;
+};
+
+//------------------------------------------------------------------------------
+
+/// Rewriter of terms of type T applying rules until no rule applies. Rules 
+/// is a function const T*(const T*) returning its argument when no rule 
+/// applies to its root. Children is a function object whose call operator,
+/// templated on F, takes const T* and F& and returns the term with each of 
+/// its subterms s replaced by f(s), or the term itself when f returned all 
+/// subterms as is. F is the rewriter itself.
+template <typename T, typename Rules, typename Children>
+inline rewriter<T,typename std::decay<Rules>::type,typename std::decay<Children>::type> make_rewriter(Rules&& r, Children&& c)
+{
+    return rewriter<T,typename std::decay<Rules>::type,typename std::decay<Children>::type>(std::forward<Rules>(r), std::forward<Children>(c));
+}
+
+//------------------------------------------------------------------------------
+
+} // of namespace mch
@@ -0,0 +1,164 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file defines a hook that Match statements call on a sample of their
+/// executions, letting a profiler find the sites that dominate CPU time
+/// without rebuilding the program with #XTL_DUMP_PERFORMANCE.
+///
+/// \note This file is included by the headers defining Match statements when
+///       #XTL_SAMPLE_MATCH_SITES is enabled.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#pragma once
+
+// --------------------[ Design Notes ]--------------------
+// - The decision to sample is a decrement and a branch on a countdown shared
+//   by all Match statements of a thread, so sites are sampled in proportion to
+//   how often they execute rather than once in N executions of each of them.
+// - A sampled execution reads the time stamp counter on entry into the Match
+//   statement and once more when leaving its scope, which includes the case 
+//   clause that was executed and any way of leaving it: break, return, throw.
+// - The target label is read on exit since on the first execution of the
+//   statement for a given type it is only known once a clause has matched.
+// - Time stamp counter is read with #XTL_CYCLE_COUNTER: the rdtsc instruction 
+//   used by the timing of our benchmarks in test/time/timing.hpp, but without
+//   cpuid serialization that costs more than many Match statements do. 
+//   Platforms without it fall back on clock().
+//------------------------------------------------------------------------------
+
+#include "config.hpp"
+#include <cstddef>
+
+#if XTL_MULTI_THREADING && !XTL_SUPPORT(thread_local)
+#error XTL_SAMPLE_MATCH_SITES with XTL_MULTI_THREADING requires compiler support of thread_local storage duration
+#endif
+
+namespace mch ///< Mach7 library namespace
+{
+
+//------------------------------------------------------------------------------
+
+/// Identity of a Match statement in the source code. Its address is unique
+/// for each Match statement and can be used as an identifier of the site.
+struct match_site
+{
+    match_site(const char* fl, size_t ln, const char* fn) : file(fl), line(ln), func(fn) {}
+
+    const char* file; ///< File of the Match statement
+    size_t      line; ///< Line of the Match statement in that file
+    const char* func; ///< Function containing the Match statement
+};
+
+/// Type of the function called on sampled executions of Match statements.
+/// \param site   The Match statement that was executed
+/// \param target Its target_label, i.e. the case clause jumped to, or the 
+///               kind of the subject for MatchK
+/// \param cycles The number of cycles spent in the statement
+typedef void (*match_sample_hook)(const match_site& site, size_t target, unsigned long long cycles);
+
+/// The hook Match statements call on sampled executions, null by default.
+inline match_sample_hook& match_sampling_hook() { static match_sample_hook hook = 0; return hook; }
+
+/// One out of how many executions of Match statements are sampled.
+/// \note Changes take effect after the current countdown expires.
+inline size_t& match_sampling_period() { static size_t period = XTL_MATCH_SAMPLING_PERIOD; return period; }
+
+//------------------------------------------------------------------------------
+
+/// Scope guard that Match statements declare on entry to time a sample of
+/// their executions and report them to match_sampling_hook().
+class match_sample
+{
+public:
+
+    match_sample(const match_site& s) : site(s), target(0), read(0), start(0), sampled(false)
+    {
+    #if XTL_MULTI_THREADING
+        static thread_local size_t countdown = 0;
+    #else
+        static size_t countdown = 0;
+    #endif
+
+        if (XTL_UNLIKELY(countdown-- == 0))
+        {
+            countdown = match_sampling_period() - 1;
+
+            if (match_sampling_hook())
+            {
+                sampled = true;
+                start   = XTL_CYCLE_COUNTER();
+            }
+        }
+    }
+
+   ~match_sample()
+    {
+        if (XTL_UNLIKELY(sampled))
+        {
+            const unsigned long long cycles = XTL_CYCLE_COUNTER() - start;
+
+            if (match_sample_hook hook = match_sampling_hook())
+                hook(site, read ? read(target) : 0, cycles);
+        }
+    }
+
+    /// Lets the guard read the target label of the Match statement on exit
+    template <typename L>
+    void observe(const L& label) { target = &label; read = &read_label<L>; }
+
+private:
+
+    template <typename L>
+    static size_t read_label(const void* label) { return size_t(*static_cast<const L*>(label)); }
+
+    match_sample(const match_sample&);            ///< No copy constructor
+    match_sample& operator=(const match_sample&); ///< No assignment operator
+
+    const match_site&  site;                   ///< Match statement being executed
+    const void*        target;                 ///< Location of its target label
+    size_t           (*read)(const void*);     ///< Reads label of its actual type from #target
+    unsigned long long start;                  ///< Time stamp on entry
+    bool               sampled;                ///< Whether this execution is sampled
+};
+
+//------------------------------------------------------------------------------
+
+} // of namespace mch
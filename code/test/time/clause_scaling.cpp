@@ -0,0 +1,192 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Builds a single Match statement with #XTL_SCALING_CLAUSES Case clauses, 
+/// as generated from schemas, to see how the library scales with the number
+/// of clauses rather than with the number of sites (\see code_size.cpp):
+/// - Cold misses: the statement sees each class for the first time, in 
+///   random order, so every call takes the miss path, whose cost is that of 
+///   the sequence of dynamic_cast over the clauses before the one that applies.
+/// - Steady state: the same statement on objects of random classes once all 
+///   of them were seen.
+/// - Cascade: the sequence of dynamic_cast over all the clauses written by 
+///   hand, which is what each cold miss does and what the statement replaces.
+/// The clauses target of the Makefile builds it for 10, 100, 500 and 1000 
+/// clauses and reports the compile time and the size of .text of the object 
+/// file next to the times per call reported by the program itself.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#if !defined(XTL_SCALING_CLAUSES)
+    /// Number of Case clauses of the statement, one of 10, 100, 500 or 1000
+    #define XTL_SCALING_CLAUSES 10
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "match.hpp"
+
+//------------------------------------------------------------------------------
+
+#define XTL_SCALING_10(F,n)   F(n##0) F(n##1) F(n##2) F(n##3) F(n##4) F(n##5) F(n##6) F(n##7) F(n##8) F(n##9)
+#define XTL_SCALING_100(F,n)  XTL_SCALING_10(F,n##0) XTL_SCALING_10(F,n##1) XTL_SCALING_10(F,n##2) XTL_SCALING_10(F,n##3) XTL_SCALING_10(F,n##4) XTL_SCALING_10(F,n##5) XTL_SCALING_10(F,n##6) XTL_SCALING_10(F,n##7) XTL_SCALING_10(F,n##8) XTL_SCALING_10(F,n##9)
+#define XTL_SCALING_500(F)    XTL_SCALING_100(F,5) XTL_SCALING_100(F,6) XTL_SCALING_100(F,7) XTL_SCALING_100(F,8) XTL_SCALING_100(F,9)
+#define XTL_SCALING_1000(F,n) XTL_SCALING_100(F,n##0) XTL_SCALING_100(F,n##1) XTL_SCALING_100(F,n##2) XTL_SCALING_100(F,n##3) XTL_SCALING_100(F,n##4) XTL_SCALING_100(F,n##5) XTL_SCALING_100(F,n##6) XTL_SCALING_100(F,n##7) XTL_SCALING_100(F,n##8) XTL_SCALING_100(F,n##9)
+
+/// Applies F to the numbers of all the classes: XTL_SCALING_CLAUSES..2*XTL_SCALING_CLAUSES-1,
+/// which avoids leading zeros that would make them octal
+#if   XTL_SCALING_CLAUSES == 10
+    #define XTL_SCALING_FOR_EACH_CLASS(F) XTL_SCALING_10(F,1)
+#elif XTL_SCALING_CLAUSES == 100
+    #define XTL_SCALING_FOR_EACH_CLASS(F) XTL_SCALING_100(F,1)
+#elif XTL_SCALING_CLAUSES == 500
+    #define XTL_SCALING_FOR_EACH_CLASS(F) XTL_SCALING_500(F)
+#elif XTL_SCALING_CLAUSES == 1000
+    #define XTL_SCALING_FOR_EACH_CLASS(F) XTL_SCALING_1000(F,1)
+#else
+    #error XTL_SCALING_CLAUSES has to be one of 10, 100, 500 or 1000
+#endif
+
+//------------------------------------------------------------------------------
+
+struct Shape                  { virtual ~Shape() {} };
+template <size_t K> struct shape_kind : Shape {};
+
+//------------------------------------------------------------------------------
+
+XTL_DO_NOT_INLINE_BEGIN size_t do_match(const Shape& s)
+{
+    Match(s)
+    {
+        #define XTL_SCALING_CASE(K) Case(shape_kind<K>) return K;
+        XTL_SCALING_FOR_EACH_CLASS(XTL_SCALING_CASE)
+        #undef  XTL_SCALING_CASE
+    }
+    EndMatch
+
+    return 0;
+}
+XTL_DO_NOT_INLINE_END
+
+XTL_DO_NOT_INLINE_BEGIN size_t do_cascade(const Shape& s)
+{
+    #define XTL_SCALING_CAST(K) if (dynamic_cast<const shape_kind<K>*>(&s)) return K;
+    XTL_SCALING_FOR_EACH_CLASS(XTL_SCALING_CAST)
+    #undef  XTL_SCALING_CAST
+
+    return 0;
+}
+XTL_DO_NOT_INLINE_END
+
+//------------------------------------------------------------------------------
+
+/// Object of class number k
+Shape* make_object(size_t k)
+{
+    switch (k)
+    {
+        #define XTL_SCALING_MAKE(K) case K: return new shape_kind<K>;
+        XTL_SCALING_FOR_EACH_CLASS(XTL_SCALING_MAKE)
+        #undef  XTL_SCALING_MAKE
+    }
+
+    return 0;
+}
+
+/// Nanoseconds per call of f on all the objects, repeated r times
+template <typename F>
+double time_calls(F f, const std::vector<Shape*>& objects, size_t r, size_t& result)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    for (size_t p = 0; p < r; ++p)
+        for (size_t i = 0; i < objects.size(); ++i)
+            result += f(*objects[i]);
+
+    return double(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()) / double(objects.size()*r);
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    const size_t n = 4096;  // Objects dispatched on in steady state
+    const size_t r = 1000;  // Passes over them
+
+    std::mt19937 gen(42);
+    std::vector<Shape*> firsts;  // One object of each class in random order
+    std::vector<Shape*> objects; // Objects of random classes
+
+    for (size_t k = XTL_SCALING_CLAUSES; k < 2*XTL_SCALING_CLAUSES; ++k)
+        firsts.push_back(make_object(k));
+
+    std::shuffle(firsts.begin(), firsts.end(), gen);
+    std::uniform_int_distribution<size_t> classes(XTL_SCALING_CLAUSES, 2*XTL_SCALING_CLAUSES-1);
+
+    for (size_t i = 0; i < n; ++i)
+        objects.push_back(make_object(classes(gen)));
+
+    size_t result = 0;
+
+    // Every call of the first pass misses
+    const double cold    = time_calls(do_match,   firsts,  1, result);
+    const double steady  = time_calls(do_match,   objects, r, result);
+    // Roughly as long as the steady state of 10 clauses takes for 1000 passes
+    const double cascade = time_calls(do_cascade, objects, std::max<size_t>(1, 10*r/XTL_SCALING_CLAUSES), result);
+
+    std::cout << "clauses=" << XTL_SCALING_CLAUSES
+              << " cold-ns/miss="   << cold
+              << " steady-ns/call=" << steady
+              << " cascade-ns/call="<< cascade
+              << " (checksum " << result << ')' << std::endl;
+
+    for (size_t i = 0; i < firsts.size(); ++i)
+        delete firsts[i];
+
+    for (size_t i = 0; i < n; ++i)
+        delete objects[i];
+}
+
+//------------------------------------------------------------------------------
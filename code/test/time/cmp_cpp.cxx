@@ -56,11 +56,26 @@ struct shape_kind : OtherBase, Shape
 #if XTL_DEFAULT_SYNTAX == 'K' || XTL_DEFAULT_SYNTAX == 'k' || XTL_DEFAULT_SYNTAX == 'F' || XTL_DEFAULT_SYNTAX == 'f'
     shape_kind() : Shape(tag<N>::value) {}
 #endif
-    void accept(ShapeVisitor&) const {}
+    void accept(ShapeVisitor&) const;
 };
 
 //------------------------------------------------------------------------------
 
+struct ShapeVisitor
+{
+    ShapeVisitor() : result(invalid) {}
+    #define FOR_EACH_MAX  NUMBER_OF_DERIVED-1
+    #define FOR_EACH_N(N) virtual void visit(const shape_kind<N>&) { result = N; }
+    #include "loop_over_numbers.hpp"
+    #undef  FOR_EACH_N
+    #undef  FOR_EACH_MAX
+    size_t result;
+};
+
+template <size_t N> void shape_kind<N>::accept(ShapeVisitor& v) const { v.visit(*this); }
+
+//------------------------------------------------------------------------------
+
 #if XTL_DEFAULT_SYNTAX == 'K' || XTL_DEFAULT_SYNTAX == 'k'
 
 namespace mch ///< Mach7 library namespace
@@ -95,6 +110,18 @@ template <>         struct bindings<Shape>         { KS(Shape::m_kind); KV(Shape
 
 //------------------------------------------------------------------------------
 
+#if defined(XTL_CMP_VISITOR)
+
+// Visitors in place of Match for the comparison with the same workload
+size_t do_match(const Shape& s)
+{
+    ShapeVisitor v;
+    s.accept(v);
+    return v.result;
+}
+
+#else
+
 size_t do_match(const Shape& s)
 {
     Match(s)
@@ -109,6 +136,8 @@ size_t do_match(const Shape& s)
     return invalid;
 }
 
+#endif
+
 Shape* make_shape(int i)
 {
     switch (i % NUMBER_OF_DERIVED)
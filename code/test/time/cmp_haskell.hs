@@ -1,6 +1,6 @@
 import Text.Printf
 import Data.List
-import System.CPUTime.Rdtsc
+import System.CPUTime
 
 data Shape = Shape00 | Shape01 | Shape02 | Shape03 | Shape04 | Shape05 | Shape06 | Shape07 | Shape08 | Shape09
            | Shape10 | Shape11 | Shape12 | Shape13 | Shape14 | Shape15 | Shape16 | Shape17 | Shape18 | Shape19
@@ -248,14 +248,15 @@ main = do
     let shapes  = [make_shape (i `mod` k) | i <- [1..n]]
     return $! length shapes
 
-    t1 <- rdtsc
+    t1 <- getCPUTime
     let matches = map do_match shapes
     return $! matches
-    t2 <- rdtsc
+    t2 <- getCPUTime
 
-    t3 <- rdtsc
+    -- CPU time is measured in picoseconds, like clock() of the C++ version
+    t3 <- getCPUTime
     let t = test m 0 shapes
     return $! t
-    t4 <- rdtsc
-    let secs = (fromIntegral(t4 - t3)::Double) / ((fromIntegral(m)::Double)*2530000000)
+    t4 <- getCPUTime
+    let secs = (fromIntegral(t4 - t3)::Double) / ((fromIntegral(m)::Double)*1.0e12)
     printf "\nAverage time for %d runs takes %.5f seconds: %d\n" (n::Int) secs (t::Int)
@@ -0,0 +1,101 @@
+// Rust version of cmp_cpp.cxx for comparison with other languages: matches
+// an enum of 100 variants just like cmp_ocaml.ml and cmp_haskell.hs do.
+
+use std::time::Instant;
+
+#[derive(Clone, Copy)]
+enum Shape {
+        Shape00, Shape01, Shape02, Shape03, Shape04,
+        Shape05, Shape06, Shape07, Shape08, Shape09,
+        Shape10, Shape11, Shape12, Shape13, Shape14,
+        Shape15, Shape16, Shape17, Shape18, Shape19,
+        Shape20, Shape21, Shape22, Shape23, Shape24,
+        Shape25, Shape26, Shape27, Shape28, Shape29,
+        Shape30, Shape31, Shape32, Shape33, Shape34,
+        Shape35, Shape36, Shape37, Shape38, Shape39,
+        Shape40, Shape41, Shape42, Shape43, Shape44,
+        Shape45, Shape46, Shape47, Shape48, Shape49,
+        Shape50, Shape51, Shape52, Shape53, Shape54,
+        Shape55, Shape56, Shape57, Shape58, Shape59,
+        Shape60, Shape61, Shape62, Shape63, Shape64,
+        Shape65, Shape66, Shape67, Shape68, Shape69,
+        Shape70, Shape71, Shape72, Shape73, Shape74,
+        Shape75, Shape76, Shape77, Shape78, Shape79,
+        Shape80, Shape81, Shape82, Shape83, Shape84,
+        Shape85, Shape86, Shape87, Shape88, Shape89,
+        Shape90, Shape91, Shape92, Shape93, Shape94,
+        Shape95, Shape96, Shape97, Shape98, Shape99,
+}
+
+fn make_shape(n: usize) -> Shape {
+    match n {
+         0 => Shape::Shape00,  1 => Shape::Shape01,  2 => Shape::Shape02,  3 => Shape::Shape03,  4 => Shape::Shape04,
+         5 => Shape::Shape05,  6 => Shape::Shape06,  7 => Shape::Shape07,  8 => Shape::Shape08,  9 => Shape::Shape09,
+        10 => Shape::Shape10, 11 => Shape::Shape11, 12 => Shape::Shape12, 13 => Shape::Shape13, 14 => Shape::Shape14,
+        15 => Shape::Shape15, 16 => Shape::Shape16, 17 => Shape::Shape17, 18 => Shape::Shape18, 19 => Shape::Shape19,
+        20 => Shape::Shape20, 21 => Shape::Shape21, 22 => Shape::Shape22, 23 => Shape::Shape23, 24 => Shape::Shape24,
+        25 => Shape::Shape25, 26 => Shape::Shape26, 27 => Shape::Shape27, 28 => Shape::Shape28, 29 => Shape::Shape29,
+        30 => Shape::Shape30, 31 => Shape::Shape31, 32 => Shape::Shape32, 33 => Shape::Shape33, 34 => Shape::Shape34,
+        35 => Shape::Shape35, 36 => Shape::Shape36, 37 => Shape::Shape37, 38 => Shape::Shape38, 39 => Shape::Shape39,
+        40 => Shape::Shape40, 41 => Shape::Shape41, 42 => Shape::Shape42, 43 => Shape::Shape43, 44 => Shape::Shape44,
+        45 => Shape::Shape45, 46 => Shape::Shape46, 47 => Shape::Shape47, 48 => Shape::Shape48, 49 => Shape::Shape49,
+        50 => Shape::Shape50, 51 => Shape::Shape51, 52 => Shape::Shape52, 53 => Shape::Shape53, 54 => Shape::Shape54,
+        55 => Shape::Shape55, 56 => Shape::Shape56, 57 => Shape::Shape57, 58 => Shape::Shape58, 59 => Shape::Shape59,
+        60 => Shape::Shape60, 61 => Shape::Shape61, 62 => Shape::Shape62, 63 => Shape::Shape63, 64 => Shape::Shape64,
+        65 => Shape::Shape65, 66 => Shape::Shape66, 67 => Shape::Shape67, 68 => Shape::Shape68, 69 => Shape::Shape69,
+        70 => Shape::Shape70, 71 => Shape::Shape71, 72 => Shape::Shape72, 73 => Shape::Shape73, 74 => Shape::Shape74,
+        75 => Shape::Shape75, 76 => Shape::Shape76, 77 => Shape::Shape77, 78 => Shape::Shape78, 79 => Shape::Shape79,
+        80 => Shape::Shape80, 81 => Shape::Shape81, 82 => Shape::Shape82, 83 => Shape::Shape83, 84 => Shape::Shape84,
+        85 => Shape::Shape85, 86 => Shape::Shape86, 87 => Shape::Shape87, 88 => Shape::Shape88, 89 => Shape::Shape89,
+        90 => Shape::Shape90, 91 => Shape::Shape91, 92 => Shape::Shape92, 93 => Shape::Shape93, 94 => Shape::Shape94,
+        95 => Shape::Shape95, 96 => Shape::Shape96, 97 => Shape::Shape97, 98 => Shape::Shape98, 99 => Shape::Shape99,
+        _ => Shape::Shape00,
+    }
+}
+
+#[inline(never)]
+fn do_match(s: &Shape) -> usize {
+    match *s {
+        Shape::Shape00 =>  0, Shape::Shape01 =>  1, Shape::Shape02 =>  2, Shape::Shape03 =>  3, Shape::Shape04 =>  4,
+        Shape::Shape05 =>  5, Shape::Shape06 =>  6, Shape::Shape07 =>  7, Shape::Shape08 =>  8, Shape::Shape09 =>  9,
+        Shape::Shape10 => 10, Shape::Shape11 => 11, Shape::Shape12 => 12, Shape::Shape13 => 13, Shape::Shape14 => 14,
+        Shape::Shape15 => 15, Shape::Shape16 => 16, Shape::Shape17 => 17, Shape::Shape18 => 18, Shape::Shape19 => 19,
+        Shape::Shape20 => 20, Shape::Shape21 => 21, Shape::Shape22 => 22, Shape::Shape23 => 23, Shape::Shape24 => 24,
+        Shape::Shape25 => 25, Shape::Shape26 => 26, Shape::Shape27 => 27, Shape::Shape28 => 28, Shape::Shape29 => 29,
+        Shape::Shape30 => 30, Shape::Shape31 => 31, Shape::Shape32 => 32, Shape::Shape33 => 33, Shape::Shape34 => 34,
+        Shape::Shape35 => 35, Shape::Shape36 => 36, Shape::Shape37 => 37, Shape::Shape38 => 38, Shape::Shape39 => 39,
+        Shape::Shape40 => 40, Shape::Shape41 => 41, Shape::Shape42 => 42, Shape::Shape43 => 43, Shape::Shape44 => 44,
+        Shape::Shape45 => 45, Shape::Shape46 => 46, Shape::Shape47 => 47, Shape::Shape48 => 48, Shape::Shape49 => 49,
+        Shape::Shape50 => 50, Shape::Shape51 => 51, Shape::Shape52 => 52, Shape::Shape53 => 53, Shape::Shape54 => 54,
+        Shape::Shape55 => 55, Shape::Shape56 => 56, Shape::Shape57 => 57, Shape::Shape58 => 58, Shape::Shape59 => 59,
+        Shape::Shape60 => 60, Shape::Shape61 => 61, Shape::Shape62 => 62, Shape::Shape63 => 63, Shape::Shape64 => 64,
+        Shape::Shape65 => 65, Shape::Shape66 => 66, Shape::Shape67 => 67, Shape::Shape68 => 68, Shape::Shape69 => 69,
+        Shape::Shape70 => 70, Shape::Shape71 => 71, Shape::Shape72 => 72, Shape::Shape73 => 73, Shape::Shape74 => 74,
+        Shape::Shape75 => 75, Shape::Shape76 => 76, Shape::Shape77 => 77, Shape::Shape78 => 78, Shape::Shape79 => 79,
+        Shape::Shape80 => 80, Shape::Shape81 => 81, Shape::Shape82 => 82, Shape::Shape83 => 83, Shape::Shape84 => 84,
+        Shape::Shape85 => 85, Shape::Shape86 => 86, Shape::Shape87 => 87, Shape::Shape88 => 88, Shape::Shape89 => 89,
+        Shape::Shape90 => 90, Shape::Shape91 => 91, Shape::Shape92 => 92, Shape::Shape93 => 93, Shape::Shape94 => 94,
+        Shape::Shape95 => 95, Shape::Shape96 => 96, Shape::Shape97 => 97, Shape::Shape98 => 98, Shape::Shape99 => 99,
+    }
+}
+
+fn main() {
+    let n = 1000000; // The amount of times visitor and matching procedure is invoked in one time measuring
+    let m = 101;     // The amount of times time measuring is done
+    let k = 100;     // Maximum number of shapes that can be created
+    let array: Vec<Shape> = (0..n).map(|i| make_shape(i % k)).collect();
+    let mut z: usize = 0;
+    let mut total_time = 0.0;
+
+    for _ in 0..m {
+        let before = Instant::now();
+
+        for j in 0..n {
+            z = z.wrapping_add(do_match(&array[j]));
+        }
+
+        total_time += before.elapsed().as_secs_f64();
+    }
+
+    println!("\nAverage time for {} runs takes {:.5} seconds: {}", n, total_time / m as f64, z);
+}
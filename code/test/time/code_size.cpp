@@ -0,0 +1,290 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Builds the same dispatch over #XTL_SIZE_CLASSES classes at #XTL_SIZE_SITES
+/// different sites with one of the approaches selected by #XTL_SIZE_DISPATCH:
+/// - 'm': Match statement on the class of the object;
+/// - 'v': visitor local to the site, overriding a visit per class;
+/// - 's': std::visit of a std::variant of all the classes (needs C++17).
+/// Every site is an instantiation of site<S>, so that the code of each, 
+/// including the visit functions of its visitor and the dispatch tables 
+/// std::visit instantiates for site_visitor<S>, can be told apart in the 
+/// symbol table. The size target of the Makefile builds all the approaches 
+/// for 10, 100 and 1000 classes and reports the size of .text and of the 
+/// code of an average site, while the program itself reports the time and 
+/// the misses of the instruction cache per call when all the sites are 
+/// called in turn on objects of random classes.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#if !defined(XTL_SIZE_CLASSES)
+    /// Number of classes dispatched on, one of 10, 100 or 1000
+    #define XTL_SIZE_CLASSES 10
+#endif
+
+#if !defined(XTL_SIZE_SITES)
+    /// Number of sites dispatching on all the classes
+    #define XTL_SIZE_SITES 16
+#endif
+
+#if !defined(XTL_SIZE_DISPATCH)
+    /// Dispatch used by the sites: 'm' for Match, 'v' for visitors and 's' for std::variant
+    #define XTL_SIZE_DISPATCH 'm'
+#endif
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+#if XTL_SIZE_DISPATCH == 's'
+#include <variant>
+#endif
+#include "match.hpp"
+#include "timing.hpp"
+
+//------------------------------------------------------------------------------
+
+#define XTL_SIZE_10(F,n)   F(n##0) F(n##1) F(n##2) F(n##3) F(n##4) F(n##5) F(n##6) F(n##7) F(n##8) F(n##9)
+#define XTL_SIZE_100(F,n)  XTL_SIZE_10(F,n##0) XTL_SIZE_10(F,n##1) XTL_SIZE_10(F,n##2) XTL_SIZE_10(F,n##3) XTL_SIZE_10(F,n##4) XTL_SIZE_10(F,n##5) XTL_SIZE_10(F,n##6) XTL_SIZE_10(F,n##7) XTL_SIZE_10(F,n##8) XTL_SIZE_10(F,n##9)
+#define XTL_SIZE_1000(F,n) XTL_SIZE_100(F,n##0) XTL_SIZE_100(F,n##1) XTL_SIZE_100(F,n##2) XTL_SIZE_100(F,n##3) XTL_SIZE_100(F,n##4) XTL_SIZE_100(F,n##5) XTL_SIZE_100(F,n##6) XTL_SIZE_100(F,n##7) XTL_SIZE_100(F,n##8) XTL_SIZE_100(F,n##9)
+
+/// Applies F to the numbers of all the classes: XTL_SIZE_CLASSES..2*XTL_SIZE_CLASSES-1,
+/// which avoids leading zeros that would make them octal
+#if   XTL_SIZE_CLASSES == 10
+    #define XTL_SIZE_FOR_EACH_CLASS(F) XTL_SIZE_10(F,1)
+#elif XTL_SIZE_CLASSES == 100
+    #define XTL_SIZE_FOR_EACH_CLASS(F) XTL_SIZE_100(F,1)
+#elif XTL_SIZE_CLASSES == 1000
+    #define XTL_SIZE_FOR_EACH_CLASS(F) XTL_SIZE_1000(F,1)
+#else
+    #error XTL_SIZE_CLASSES has to be one of 10, 100 or 1000
+#endif
+
+//------------------------------------------------------------------------------
+
+struct ShapeVisitor;
+
+struct Shape
+{
+    virtual ~Shape() {}
+    virtual void accept(ShapeVisitor&) const = 0;
+};
+
+template <size_t K>
+struct shape_kind : Shape
+{
+    void accept(ShapeVisitor&) const;
+};
+
+struct ShapeVisitor
+{
+    virtual ~ShapeVisitor() {}
+    #define XTL_SIZE_VISIT(K) virtual void visit(const shape_kind<K>&) {}
+    XTL_SIZE_FOR_EACH_CLASS(XTL_SIZE_VISIT)
+    #undef  XTL_SIZE_VISIT
+};
+
+template <size_t K> void shape_kind<K>::accept(ShapeVisitor& v) const { v.visit(*this); }
+
+//------------------------------------------------------------------------------
+
+#if XTL_SIZE_DISPATCH == 'm'
+
+typedef Shape object; ///< Objects the sites dispatch on
+
+template <size_t S>
+XTL_DO_NOT_INLINE_BEGIN size_t site(const object& s)
+{
+    Match(s)
+    {
+        #define XTL_SIZE_CASE(K) Case(shape_kind<K>) return K*S;
+        XTL_SIZE_FOR_EACH_CLASS(XTL_SIZE_CASE)
+        #undef  XTL_SIZE_CASE
+    }
+    EndMatch
+
+    return 0;
+}
+XTL_DO_NOT_INLINE_END
+
+#elif XTL_SIZE_DISPATCH == 'v'
+
+typedef Shape object; ///< Objects the sites dispatch on
+
+template <size_t S>
+XTL_DO_NOT_INLINE_BEGIN size_t site(const object& s)
+{
+    struct Visitor : ShapeVisitor
+    {
+        Visitor() : result(0) {}
+        #define XTL_SIZE_VISIT(K) virtual void visit(const shape_kind<K>&) { result = K*S; }
+        XTL_SIZE_FOR_EACH_CLASS(XTL_SIZE_VISIT)
+        #undef  XTL_SIZE_VISIT
+        size_t result;
+    };
+
+    Visitor v;
+    s.accept(v);
+    return v.result;
+}
+XTL_DO_NOT_INLINE_END
+
+#elif XTL_SIZE_DISPATCH == 's'
+
+/// Ends the list of alternatives, which the commas after each class require
+struct end_of_shapes {};
+
+/// Objects the sites dispatch on
+#define XTL_SIZE_ALTERNATIVE(K) shape_kind<K>,
+typedef std::variant<XTL_SIZE_FOR_EACH_CLASS(XTL_SIZE_ALTERNATIVE) end_of_shapes> object;
+#undef  XTL_SIZE_ALTERNATIVE
+
+/// Overloads of the site, which local classes could not have as templates
+template <size_t S>
+struct site_visitor
+{
+    template <size_t K>
+    size_t operator()(const shape_kind<K>&) const { return K*S; }
+    size_t operator()(const end_of_shapes&) const { return 0; }
+};
+
+template <size_t S>
+XTL_DO_NOT_INLINE_BEGIN size_t site(const object& s)
+{
+    return std::visit(site_visitor<S>(), s);
+}
+XTL_DO_NOT_INLINE_END
+
+#else
+    #error XTL_SIZE_DISPATCH has to be one of 'm', 'v' or 's'
+#endif
+
+//------------------------------------------------------------------------------
+
+typedef size_t (*site_function)(const object&);
+
+template <size_t... S> struct site_list {};
+
+template <size_t N, size_t... S> struct make_sites : make_sites<N-1, N-1, S...> {};
+template <size_t... S>           struct make_sites<0, S...> { typedef site_list<S...> type; };
+
+/// Instantiates all the sites
+template <size_t... S>
+std::vector<site_function> all_sites(site_list<S...>)
+{
+    site_function sites[] = { &site<S>... };
+    return std::vector<site_function>(sites, sites + sizeof...(S));
+}
+
+//------------------------------------------------------------------------------
+
+/// Object of class number k
+object* make_object(size_t k)
+{
+    switch (k)
+    {
+    #if XTL_SIZE_DISPATCH == 's'
+        #define XTL_SIZE_MAKE(K) case K: return new object(shape_kind<K>());
+    #else
+        #define XTL_SIZE_MAKE(K) case K: return new shape_kind<K>;
+    #endif
+        XTL_SIZE_FOR_EACH_CLASS(XTL_SIZE_MAKE)
+        #undef  XTL_SIZE_MAKE
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    const std::vector<site_function> sites = all_sites(make_sites<XTL_SIZE_SITES>::type());
+    const size_t n = 4096;  // Objects dispatched on
+    const size_t r = 1000;  // Passes over them
+
+    std::vector<object*> objects;
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<size_t> classes(XTL_SIZE_CLASSES, 2*XTL_SIZE_CLASSES-1);
+
+    for (size_t i = 0; i < n; ++i)
+        objects.push_back(make_object(classes(gen)));
+
+    size_t result = 0;
+
+    // Warm up: every site sees every object once
+    for (size_t i = 0; i < n; ++i)
+        for (size_t j = 0; j < sites.size(); ++j)
+            result += sites[j](*objects[i]);
+
+#if defined(XTL_TIMING_METHOD_5)
+    mch::perf_counter misses(mch::cache_read_misses(PERF_COUNT_HW_CACHE_L1I), PERF_TYPE_HW_CACHE);
+    const uint64_t m0 = misses.read();
+#endif
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    // Every call goes to the next site, so that all of them compete for the instruction cache
+    for (size_t p = 0; p < r; ++p)
+        for (size_t i = 0; i < n; ++i)
+            result += sites[(i+p) % sites.size()](*objects[i]);
+
+    const double ns = double(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+
+    std::cout << "dispatch=" << char(XTL_SIZE_DISPATCH) << " classes=" << XTL_SIZE_CLASSES << " sites=" << XTL_SIZE_SITES
+              << " ns/call=" << ns/(n*r);
+
+#if defined(XTL_TIMING_METHOD_5)
+    if (misses.available())
+        std::cout << " icache-misses/call=" << double(misses.read() - m0)/(n*r);
+    else
+#endif
+        std::cout << " icache-misses/call=n/a";
+
+    std::cout << " (checksum " << result << ')' << std::endl;
+
+    for (size_t i = 0; i < n; ++i)
+        delete objects[i];
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,150 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Measures selection of telemetry records by constructor patterns applied to
+/// each record of an array against the same patterns evaluated over columns
+/// of a struct-of-arrays copy of the records, \see patterns/columnar.hpp.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include "patterns/all.hpp"
+#include "patterns/columnar.hpp"
+#include "rnd.hpp"
+#include "timing.hpp"
+
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+//------------------------------------------------------------------------------
+
+/// Number of records, large enough for them not to fit into caches
+const size_t records_num = 1 << 22;
+
+/// Number of runs of each selection, of which the fastest is reported
+const size_t runs = 11;
+
+//------------------------------------------------------------------------------
+
+struct Sample
+{
+    uint32_t device;
+    uint16_t sensor;
+    int16_t  value;
+    uint64_t time;
+};
+
+namespace mch ///< Mach7 library namespace
+{
+template <> struct bindings<Sample> { Members(Sample::device, Sample::sensor, Sample::value, Sample::time); };
+} // of namespace mch
+
+//------------------------------------------------------------------------------
+
+/// Returns the fastest of several runs of f in nanoseconds per record
+template <typename F>
+double fastest(F f)
+{
+    double best = 0.0;
+
+    for (size_t r = 0; r < runs; ++r)
+    {
+        mch::time_stamp start = mch::get_time_stamp();
+        f();
+        mch::time_stamp finish = mch::get_time_stamp();
+        double ns = (finish - start) * 1e9 / mch::get_frequency() / records_num;
+
+        if (r == 0 || ns < best)
+            best = ns;
+    }
+
+    return best;
+}
+
+/// Reports time per record of applying p to each record and to columns, which
+/// have to select as many records
+template <typename P>
+void report(const char* name, const P& p, const std::vector<Sample>& records, const mch::columns<Sample,4>& c)
+{
+    size_t rows = 0, cols = 0;
+    mch::selection s;
+
+    double r = fastest([&]{ rows = 0; for (size_t i = 0; i < records.size(); ++i) rows += p(records[i]) != 0; });
+    double k = fastest([&]{ cols = mch::select(p, c, s); });
+
+    std::cout << std::setw(12) << name << ": Records " << std::fixed << std::setprecision(2) << r 
+              << "ns Columns " << k << "ns (" << std::setprecision(0) << 100*(r-k)/r << "% faster) selected " << cols << std::endl;
+    XTL_ASSERT(rows == cols);
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    using namespace mch;
+
+    std::mt19937 engine(XTL_RND_SEED);
+    std::uniform_int_distribution<uint32_t> device(0, 999);
+    std::uniform_int_distribution<int>      sensor(0, 7);
+    std::uniform_int_distribution<int>      value(-1000, 1000);
+    std::vector<Sample> records(records_num);
+
+    for (size_t i = 0; i < records_num; ++i)
+    {
+        Sample r = { device(engine), uint16_t(sensor(engine)), int16_t(value(engine)), uint64_t(i) };
+        records[i] = r;
+    }
+
+    columns<Sample,4> c(records.begin(), records.end());
+
+    var<int16_t>  v;
+    var<uint64_t> t;
+
+    report("device",       C<Sample>(42, _),                                         records, c);
+    report("sensor&value", C<Sample>(_, 3, v |= v > 900),                            records, c);
+    report("range",        C<Sample>(_, _, v |= v > -10 && v < 10, t |= t % 2 == 0), records, c);
+}
+
+//------------------------------------------------------------------------------
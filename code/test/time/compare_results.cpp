@@ -0,0 +1,164 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Compares results of two runs of benchmarks recorded in #XTL_RESULTS_FILE
+/// and reports tests that got slower by more than a threshold:
+/// \code
+///     compare_results baseline.jsonl current.jsonl [threshold-in-percent]
+/// \endcode
+/// Each test is represented by the median of medians of all its experiments.
+/// A change is only reported when it also exceeds the deviations of both runs,
+/// so noisy tests do not get flagged. Exits with 1 when there were regressions.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include "testresults.hpp"
+
+//------------------------------------------------------------------------------
+
+typedef std::map<std::string,test_results> run_results;
+
+//------------------------------------------------------------------------------
+
+bool load(const char* file_name, run_results& results)
+{
+    std::ifstream file(file_name);
+
+    if (!file)
+    {
+        std::cerr << "ERROR: Cannot open " << file_name << std::endl;
+        return false;
+    }
+
+    for (std::string line; std::getline(file, line); )
+    {
+        if (line.empty())
+            continue;
+
+        test_results& r = results[field(line,"benchmark") + "/" + field(line,"test")];
+        r.medians.push_back(std::atof(field(line,"median").c_str()));
+        r.deviations.push_back(std::atof(field(line,"stddev").c_str()));
+        r.unit     = field(line,"unit");
+        r.compiler = field(line,"compiler");
+        r.config   = field(line,"config");
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " baseline.jsonl current.jsonl [threshold-in-percent]" << std::endl;
+        return 2;
+    }
+
+    const double threshold = argc > 3 ? std::atof(argv[3]) : 5.0;
+    run_results  baseline, current;
+
+    if (!load(argv[1], baseline) || !load(argv[2], current))
+        return 2;
+
+    size_t regressions = 0;
+
+    for (run_results::const_iterator p = current.begin(); p != current.end(); ++p)
+    {
+        run_results::const_iterator q = baseline.find(p->first);
+
+        if (q == baseline.end())
+        {
+            std::cout << "NEW         " << p->first << std::endl;
+            continue;
+        }
+
+        const test_results& b = q->second;
+        const test_results& c = p->second;
+
+        if (b.unit != c.unit)
+        {
+            std::cout << "INCOMPARABLE " << p->first << ": measured in " << b.unit << " and " << c.unit << std::endl;
+            continue;
+        }
+
+        if (b.compiler != c.compiler)
+            std::cout << "WARNING: " << p->first << " was built with " << b.compiler << " and " << c.compiler << std::endl;
+
+        if (b.config != c.config)
+            std::cout << "WARNING: " << p->first << " was built with different configuration" << std::endl;
+
+        const double old_median = median(b.medians);
+        const double new_median = median(c.medians);
+        const double noise      = median(b.deviations) + median(c.deviations);
+        const double change     = old_median > 0 ? (new_median-old_median)*100/old_median : 0.0;
+        const bool   beyond     = std::abs(new_median-old_median) > noise;
+        const char*  verdict    = change >  threshold && beyond ? "REGRESSION  "
+                                : change < -threshold && beyond ? "IMPROVEMENT "
+                                                                : "SAME        ";
+
+        regressions += change > threshold && beyond;
+
+        std::cout << verdict << p->first << ": " 
+                  << std::fixed << std::setprecision(2) << old_median << " -> " << new_median << ' ' << c.unit
+                  << " (" << std::showpos << change << std::noshowpos << "%)" << std::endl;
+    }
+
+    for (run_results::const_iterator q = baseline.begin(); q != baseline.end(); ++q)
+        if (current.find(q->first) == current.end())
+            std::cout << "MISSING     " << q->first << std::endl;
+
+    std::cout << regressions << " regression(s) above " << threshold << '%' << std::endl;
+    return regressions != 0;
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,458 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Measures interpreter-style dispatch on a realistic workload instead of a
+/// synthetic one: a small stack-machine bytecode interpreter runs standard
+/// programs (Fibonacci numbers, Collatz sequences and Euclid's algorithm) with
+/// instructions dispatched by a switch on opcodes, virtual functions, visitors,
+/// a Match statement and, with C++17, std::visit on std::variant. All of them
+/// execute the same instruction semantics, so the difference in time per 
+/// executed instruction is the cost of dispatch.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include "type_switchN-patterns.hpp"
+#include "patterns/constructor.hpp"
+#include "patterns/primitive.hpp"
+#include "timing.hpp"
+
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#if XTL_SUPPORT(variant)
+#include <variant>
+#endif
+
+//------------------------------------------------------------------------------
+
+/// Number of runs of each program, of which the fastest is reported
+const size_t runs = 5;
+
+/// Program counter returned by the instruction stopping the machine
+const size_t halted = size_t(-1);
+
+typedef std::uint64_t word; ///< Arithmetic wraps around instead of overflowing
+
+/// State of the stack machine, except for the program counter
+struct Machine
+{
+    Machine() : sp(0) { for (word& s : slots) s = 0; }
+    word   slots[4];
+    word   stack[8];
+    size_t sp;
+};
+
+//------------------------------------------------------------------------------
+
+/// Instructions as plain data shared by all the ways of dispatching them
+namespace op
+{
+struct Push  { word   value;  };
+struct Load  { size_t slot;   };
+struct Store { size_t slot;   };
+struct Add   {};
+struct Sub   {};
+struct Mul   {};
+struct Div   {};
+struct Mod   {};
+struct Less  {};
+struct Jz    { size_t target; };
+struct Jmp   { size_t target; };
+struct Halt  {};
+} // of namespace op
+
+// Semantics of each instruction: returns the next program counter
+
+inline size_t step(const op::Push&  i, Machine& m, size_t pc) { m.stack[m.sp++] = i.value;          return pc+1; }
+inline size_t step(const op::Load&  i, Machine& m, size_t pc) { m.stack[m.sp++] = m.slots[i.slot];  return pc+1; }
+inline size_t step(const op::Store& i, Machine& m, size_t pc) { m.slots[i.slot] = m.stack[--m.sp];  return pc+1; }
+inline size_t step(const op::Add&,     Machine& m, size_t pc) { --m.sp; m.stack[m.sp-1] += m.stack[m.sp]; return pc+1; }
+inline size_t step(const op::Sub&,     Machine& m, size_t pc) { --m.sp; m.stack[m.sp-1] -= m.stack[m.sp]; return pc+1; }
+inline size_t step(const op::Mul&,     Machine& m, size_t pc) { --m.sp; m.stack[m.sp-1] *= m.stack[m.sp]; return pc+1; }
+inline size_t step(const op::Div&,     Machine& m, size_t pc) { --m.sp; m.stack[m.sp-1] /= m.stack[m.sp]; return pc+1; }
+inline size_t step(const op::Mod&,     Machine& m, size_t pc) { --m.sp; m.stack[m.sp-1] %= m.stack[m.sp]; return pc+1; }
+inline size_t step(const op::Less&,    Machine& m, size_t pc) { --m.sp; m.stack[m.sp-1] = m.stack[m.sp-1] < m.stack[m.sp]; return pc+1; }
+inline size_t step(const op::Jz&    i, Machine& m, size_t pc) { return m.stack[--m.sp] == 0 ? i.target : pc+1; }
+inline size_t step(const op::Jmp&   i, Machine&,   size_t)    { return i.target; }
+inline size_t step(const op::Halt&,    Machine&,   size_t)    { return halted; }
+
+//------------------------------------------------------------------------------
+
+/// Source form of programs, also interpreted by a switch on the opcode
+struct Code
+{
+    enum Opcode { push, load, store, add, sub, mul, div, mod, less, jz, jmp, halt };
+    Opcode opcode;
+    word   arg;
+};
+
+/// Emits instructions of a program and resolves forward jumps
+struct Program
+{
+    std::vector<Code> code;
+
+    Program& operator()(Code::Opcode opcode, word arg = 0) { Code c = { opcode, arg }; code.push_back(c); return *this; }
+    size_t   here() const       { return code.size(); }
+    size_t   jump(Code::Opcode j) { operator()(j); return here()-1; }
+    void     bind(size_t jump)  { code[jump].arg = here(); }
+};
+
+/// Sets slot 0 to the n-th Fibonacci number, n is in slot 1
+Program fibonacci()
+{
+    Program p;
+    p(Code::push,0)(Code::store,0)(Code::push,1)(Code::store,2);
+    size_t loop = p.here();
+    p(Code::push,0)(Code::load,1)(Code::less);
+    size_t exit = p.jump(Code::jz);
+    p(Code::load,0)(Code::load,2)(Code::add)(Code::store,3)     // t = a + b
+     (Code::load,2)(Code::store,0)(Code::load,3)(Code::store,2) // a = b; b = t
+     (Code::load,1)(Code::push,1)(Code::sub)(Code::store,1)(Code::jmp,loop);
+    p.bind(exit);
+    p(Code::halt);
+    return p;
+}
+
+/// Sets slot 0 to the total length of Collatz sequences starting at 1..n, 
+/// n is in slot 1
+Program collatz()
+{
+    Program p;
+    p(Code::push,0)(Code::store,0);
+    size_t outer = p.here();
+    p(Code::push,0)(Code::load,1)(Code::less);
+    size_t done = p.jump(Code::jz);
+    p(Code::load,1)(Code::store,2);
+    size_t inner = p.here();
+    p(Code::push,1)(Code::load,2)(Code::less);
+    size_t next = p.jump(Code::jz);
+    p(Code::load,2)(Code::push,2)(Code::mod);
+    size_t even = p.jump(Code::jz);
+    p(Code::load,2)(Code::push,3)(Code::mul)(Code::push,1)(Code::add)(Code::store,2);
+    size_t count = p.jump(Code::jmp);
+    p.bind(even);
+    p(Code::load,2)(Code::push,2)(Code::div)(Code::store,2);
+    p.bind(count);
+    p(Code::load,0)(Code::push,1)(Code::add)(Code::store,0)(Code::jmp,inner);
+    p.bind(next);
+    p(Code::load,1)(Code::push,1)(Code::sub)(Code::store,1)(Code::jmp,outer);
+    p.bind(done);
+    p(Code::halt);
+    return p;
+}
+
+/// Sets slot 0 to the sum of gcd(i,360360) for i in 1..n, n is in slot 1
+Program euclid()
+{
+    Program p;
+    p(Code::push,0)(Code::store,0);
+    size_t outer = p.here();
+    p(Code::push,0)(Code::load,1)(Code::less);
+    size_t done = p.jump(Code::jz);
+    p(Code::push,360360)(Code::store,2)(Code::load,1)(Code::store,3);
+    size_t inner = p.here();
+    p(Code::push,0)(Code::load,3)(Code::less);
+    size_t found = p.jump(Code::jz);
+    p(Code::load,2)(Code::load,3)(Code::mod)                    // r = a % b
+     (Code::load,3)(Code::store,2)(Code::store,3)(Code::jmp,inner); // a = b; b = r
+    p.bind(found);
+    p(Code::load,0)(Code::load,2)(Code::add)(Code::store,0)
+     (Code::load,1)(Code::push,1)(Code::sub)(Code::store,1)(Code::jmp,outer);
+    p.bind(done);
+    p(Code::halt);
+    return p;
+}
+
+//------------------------------------------------------------------------------
+
+/// The same programs computed natively, to check the interpreters
+word native_fibonacci(word n) { word a = 0, b = 1; while (n--) { word t = a + b; a = b; b = t; } return a; }
+word native_collatz(word n)   { word s = 0; for (; n; --n) for (word k = n; 1 < k; ++s) k = k % 2 ? 3*k+1 : k/2; return s; }
+word native_gcd(word a, word b) { while (b) { word r = a % b; a = b; b = r; } return a; }
+word native_euclid(word n)    { word s = 0; for (; n; --n) s += native_gcd(360360, n); return s; }
+
+//------------------------------------------------------------------------------
+
+/// Runs a program with instructions dispatched by f and returns slot 0
+template <typename Instructions, typename F>
+word run(const Instructions& code, word arg, F f, size_t* executed = 0)
+{
+    Machine m;
+    m.slots[1] = arg;
+    size_t n = 0;
+
+    for (size_t pc = 0; pc != halted; ++n)
+        pc = f(code[pc], m, pc);
+
+    if (executed)
+        *executed = n;
+
+    return m.slots[0];
+}
+
+/// Dispatch by a switch on opcodes of the source form
+inline size_t switch_step(const Code& c, Machine& m, size_t pc)
+{
+    switch (c.opcode)
+    {
+    case Code::push:  { op::Push  i = { c.arg };         return step(i, m, pc); }
+    case Code::load:  { op::Load  i = { size_t(c.arg) }; return step(i, m, pc); }
+    case Code::store: { op::Store i = { size_t(c.arg) }; return step(i, m, pc); }
+    case Code::add:   return step(op::Add(),  m, pc);
+    case Code::sub:   return step(op::Sub(),  m, pc);
+    case Code::mul:   return step(op::Mul(),  m, pc);
+    case Code::div:   return step(op::Div(),  m, pc);
+    case Code::mod:   return step(op::Mod(),  m, pc);
+    case Code::less:  return step(op::Less(), m, pc);
+    case Code::jz:    { op::Jz    i = { size_t(c.arg) }; return step(i, m, pc); }
+    case Code::jmp:   { op::Jmp   i = { size_t(c.arg) }; return step(i, m, pc); }
+    case Code::halt:  return step(op::Halt(), m, pc);
+    }
+
+    return halted;
+}
+
+//------------------------------------------------------------------------------
+
+template <class T> struct Node;
+
+/// Visitor over polymorphic instructions
+struct Visitor
+{
+    virtual void visit(const Node<op::Push>&)  = 0;
+    virtual void visit(const Node<op::Load>&)  = 0;
+    virtual void visit(const Node<op::Store>&) = 0;
+    virtual void visit(const Node<op::Add>&)   = 0;
+    virtual void visit(const Node<op::Sub>&)   = 0;
+    virtual void visit(const Node<op::Mul>&)   = 0;
+    virtual void visit(const Node<op::Div>&)   = 0;
+    virtual void visit(const Node<op::Mod>&)   = 0;
+    virtual void visit(const Node<op::Less>&)  = 0;
+    virtual void visit(const Node<op::Jz>&)    = 0;
+    virtual void visit(const Node<op::Jmp>&)   = 0;
+    virtual void visit(const Node<op::Halt>&)  = 0;
+};
+
+/// Polymorphic instruction that can execute itself, accept a visitor or be
+/// the subject of a Match statement
+struct Instr
+{
+    virtual ~Instr() {}
+    virtual size_t exec(Machine& m, size_t pc) const = 0;
+    virtual void   accept(Visitor& v) const = 0;
+};
+
+template <class T>
+struct Node : Instr, T
+{
+    Node(const T& t) : T(t) {}
+    size_t exec(Machine& m, size_t pc) const override { return step(static_cast<const T&>(*this), m, pc); }
+    void   accept(Visitor& v) const override { v.visit(*this); }
+};
+
+/// Visitor executing the instruction it visits
+struct Stepper : Visitor
+{
+    Stepper(Machine& m, size_t pc) : m(m), pc(pc) {}
+    void visit(const Node<op::Push>&  i) override { pc = step(i, m, pc); }
+    void visit(const Node<op::Load>&  i) override { pc = step(i, m, pc); }
+    void visit(const Node<op::Store>& i) override { pc = step(i, m, pc); }
+    void visit(const Node<op::Add>&   i) override { pc = step(i, m, pc); }
+    void visit(const Node<op::Sub>&   i) override { pc = step(i, m, pc); }
+    void visit(const Node<op::Mul>&   i) override { pc = step(i, m, pc); }
+    void visit(const Node<op::Div>&   i) override { pc = step(i, m, pc); }
+    void visit(const Node<op::Mod>&   i) override { pc = step(i, m, pc); }
+    void visit(const Node<op::Less>&  i) override { pc = step(i, m, pc); }
+    void visit(const Node<op::Jz>&    i) override { pc = step(i, m, pc); }
+    void visit(const Node<op::Jmp>&   i) override { pc = step(i, m, pc); }
+    void visit(const Node<op::Halt>&  i) override { pc = step(i, m, pc); }
+    Machine& m;
+    size_t   pc;
+};
+
+/// Dispatch by a Match statement on the dynamic type of the instruction
+inline size_t match_step(const Instr* i, Machine& m, size_t pc)
+{
+    using mch::C;
+
+    Match(i)
+    {
+        Case(C<Node<op::Push>>())  return step(match0, m, pc);
+        Case(C<Node<op::Load>>())  return step(match0, m, pc);
+        Case(C<Node<op::Store>>()) return step(match0, m, pc);
+        Case(C<Node<op::Add>>())   return step(match0, m, pc);
+        Case(C<Node<op::Sub>>())   return step(match0, m, pc);
+        Case(C<Node<op::Mul>>())   return step(match0, m, pc);
+        Case(C<Node<op::Div>>())   return step(match0, m, pc);
+        Case(C<Node<op::Mod>>())   return step(match0, m, pc);
+        Case(C<Node<op::Less>>())  return step(match0, m, pc);
+        Case(C<Node<op::Jz>>())    return step(match0, m, pc);
+        Case(C<Node<op::Jmp>>())   return step(match0, m, pc);
+        Case(C<Node<op::Halt>>())  return step(match0, m, pc);
+    }
+    EndMatch
+
+    return halted;
+}
+
+/// Polymorphic form of a program
+std::vector<std::unique_ptr<Instr>> objects_of(const Program& p)
+{
+    std::vector<std::unique_ptr<Instr>> v;
+
+    for (const Code& c : p.code)
+        switch (c.opcode)
+        {
+        case Code::push:  { op::Push  i = { c.arg };         v.emplace_back(new Node<op::Push>(i));  break; }
+        case Code::load:  { op::Load  i = { size_t(c.arg) }; v.emplace_back(new Node<op::Load>(i));  break; }
+        case Code::store: { op::Store i = { size_t(c.arg) }; v.emplace_back(new Node<op::Store>(i)); break; }
+        case Code::add:   v.emplace_back(new Node<op::Add>(op::Add()));   break;
+        case Code::sub:   v.emplace_back(new Node<op::Sub>(op::Sub()));   break;
+        case Code::mul:   v.emplace_back(new Node<op::Mul>(op::Mul()));   break;
+        case Code::div:   v.emplace_back(new Node<op::Div>(op::Div()));   break;
+        case Code::mod:   v.emplace_back(new Node<op::Mod>(op::Mod()));   break;
+        case Code::less:  v.emplace_back(new Node<op::Less>(op::Less())); break;
+        case Code::jz:    { op::Jz    i = { size_t(c.arg) }; v.emplace_back(new Node<op::Jz>(i));    break; }
+        case Code::jmp:   { op::Jmp   i = { size_t(c.arg) }; v.emplace_back(new Node<op::Jmp>(i));   break; }
+        case Code::halt:  v.emplace_back(new Node<op::Halt>(op::Halt())); break;
+        }
+
+    return v;
+}
+
+//------------------------------------------------------------------------------
+
+#if XTL_SUPPORT(variant)
+
+typedef std::variant<op::Push, op::Load, op::Store, op::Add, op::Sub, op::Mul, op::Div, op::Mod, op::Less, op::Jz, op::Jmp, op::Halt> Variant;
+
+/// Form of a program as std::variant values
+std::vector<Variant> variants_of(const Program& p)
+{
+    std::vector<Variant> v;
+
+    for (const Code& c : p.code)
+        switch (c.opcode)
+        {
+        case Code::push:  v.push_back(op::Push{c.arg});          break;
+        case Code::load:  v.push_back(op::Load{size_t(c.arg)});  break;
+        case Code::store: v.push_back(op::Store{size_t(c.arg)}); break;
+        case Code::add:   v.push_back(op::Add());  break;
+        case Code::sub:   v.push_back(op::Sub());  break;
+        case Code::mul:   v.push_back(op::Mul());  break;
+        case Code::div:   v.push_back(op::Div());  break;
+        case Code::mod:   v.push_back(op::Mod());  break;
+        case Code::less:  v.push_back(op::Less()); break;
+        case Code::jz:    v.push_back(op::Jz{size_t(c.arg)});    break;
+        case Code::jmp:   v.push_back(op::Jmp{size_t(c.arg)});   break;
+        case Code::halt:  v.push_back(op::Halt()); break;
+        }
+
+    return v;
+}
+
+#endif
+
+//------------------------------------------------------------------------------
+
+/// Times a way of dispatching a program and reports ns per instruction.
+/// Asserts that the program computes the expected result.
+template <typename Instructions, typename F>
+void measure(const char* name, const Instructions& code, word arg, word expected, size_t executed, F f)
+{
+    double best = 0.0;
+    word   r    = 0;
+
+    for (size_t i = 0; i < runs; ++i)
+    {
+        mch::time_stamp start = mch::get_time_stamp();
+        r = run(code, arg, f);
+        mch::time_stamp finish = mch::get_time_stamp();
+        double ns = (finish - start) * 1e9 / mch::get_frequency() / executed;
+
+        if (i == 0 || ns < best)
+            best = ns;
+    }
+
+    std::cout << std::setw(10) << name << ": " << std::fixed << std::setprecision(2) << best << "ns/op" << std::endl;
+    XTL_ASSERT(r == expected);
+}
+
+/// Runs a program with all ways of dispatching its instructions
+void benchmark(const char* name, const Program& p, word arg, word expected)
+{
+    size_t executed = 0;
+    const word r    = run(p.code, arg, switch_step, &executed);
+
+    XTL_ASSERT(r == expected);
+
+    std::cout << name << "(" << arg << "): " << executed << " instructions" << std::endl;
+
+    std::vector<std::unique_ptr<Instr>> objects = objects_of(p);
+
+    measure("switch", p.code, arg, expected, executed, switch_step);
+    measure("virtual", objects, arg, expected, executed,
+            [](const std::unique_ptr<Instr>& i, Machine& m, size_t pc) { return i->exec(m, pc); });
+    measure("visitor", objects, arg, expected, executed,
+            [](const std::unique_ptr<Instr>& i, Machine& m, size_t pc) { Stepper s(m, pc); i->accept(s); return s.pc; });
+    measure("Match", objects, arg, expected, executed,
+            [](const std::unique_ptr<Instr>& i, Machine& m, size_t pc) { return match_step(i.get(), m, pc); });
+#if XTL_SUPPORT(variant)
+    std::vector<Variant> variants = variants_of(p);
+    measure("variant", variants, arg, expected, executed,
+            [](const Variant& v, Machine& m, size_t pc) { return std::visit([&](const auto& i) { return step(i, m, pc); }, v); });
+#endif
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    benchmark("fibonacci", fibonacci(), 1000000, native_fibonacci(1000000));
+    benchmark("collatz",   collatz(),   10000,   native_collatz(10000));
+    benchmark("euclid",    euclid(),    100000,  native_euclid(100000));
+}
+
+//------------------------------------------------------------------------------
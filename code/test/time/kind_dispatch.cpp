@@ -0,0 +1,217 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Measures kind-based Match statements of GPU kernels (\see kind_match.hpp)
+/// on items of 8 kinds, each with its own computation, in two orders:
+/// - divergent: kinds drawn at random, so that threads of a warp take 
+///   different clauses and the warp executes them one after another;
+/// - sorted: the same items sorted by kind, so that a warp takes one clause.
+/// Built by nvcc (\see device target of the Makefile) the items are processed
+/// by a CUDA kernel with a thread per item. Built by a host compiler the same
+/// function is called in a loop, where the difference between the orders is
+/// that of branch prediction of the switch.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include "kind_match.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#if defined(__CUDACC__)
+#include <cuda_runtime.h>
+#endif
+
+//------------------------------------------------------------------------------
+
+/// Item of a simulation whose kind selects the computation done on it
+struct item { unsigned kind; float x; float y; };
+
+namespace mch ///< Mach7 library namespace
+{
+template <>            struct bindings<item>   { KS(item::kind); };
+template <size_t K>    struct bindings<item,K> { KV(item,K); };
+} // of namespace mch
+
+/// Number of items processed, a multiple of the number of threads in a block
+const size_t items = 1 << 22;
+
+/// Number of runs of each order, of which the fastest is reported
+const size_t runs = 11;
+
+//------------------------------------------------------------------------------
+
+/// Iterations of the computation of kind K, which differ so that clauses differ in cost
+#define XTL_KIND_WORK(K) { float r = matched->x; for (int i = 0; i < 4*(K+1); ++i) r = r*matched->y + float(K); return r; }
+
+XTL_HOST_DEVICE inline float process(const item& t)
+{
+    MatchUD(t)
+    {
+    CaseUD(0) XTL_KIND_WORK(0)
+    CaseUD(1) XTL_KIND_WORK(1)
+    CaseUD(2) XTL_KIND_WORK(2)
+    CaseUD(3) XTL_KIND_WORK(3)
+    CaseUD(4) XTL_KIND_WORK(4)
+    CaseUD(5) XTL_KIND_WORK(5)
+    CaseUD(6) XTL_KIND_WORK(6)
+    CaseUD(7) XTL_KIND_WORK(7)
+    }
+    EndMatchUD
+
+    return 0.0f;
+}
+
+//------------------------------------------------------------------------------
+
+#if defined(__CUDACC__)
+
+__global__ void process_all(const item* in, float* out, size_t n)
+{
+    size_t i = size_t(blockIdx.x)*blockDim.x + threadIdx.x;
+
+    if (i < n)
+        out[i] = process(in[i]);
+}
+
+/// Fastest time in milliseconds of processing items on the device
+double time_items(const std::vector<item>& in, std::vector<float>& out)
+{
+    item*  d_in  = 0;
+    float* d_out = 0;
+    cudaMalloc(&d_in,  in.size()*sizeof(item));
+    cudaMalloc(&d_out, in.size()*sizeof(float));
+    cudaMemcpy(d_in, &in[0], in.size()*sizeof(item), cudaMemcpyHostToDevice);
+
+    cudaEvent_t start, stop;
+    cudaEventCreate(&start);
+    cudaEventCreate(&stop);
+
+    const unsigned threads = 256;
+    const unsigned blocks  = unsigned((in.size() + threads - 1) / threads);
+    float best = 1e30f;
+
+    for (size_t r = 0; r < runs; ++r)
+    {
+        cudaEventRecord(start);
+        process_all<<<blocks,threads>>>(d_in, d_out, in.size());
+        cudaEventRecord(stop);
+        cudaEventSynchronize(stop);
+
+        float ms = 0;
+        cudaEventElapsedTime(&ms, start, stop);
+        best = std::min(best, ms);
+    }
+
+    cudaMemcpy(&out[0], d_out, out.size()*sizeof(float), cudaMemcpyDeviceToHost);
+    cudaEventDestroy(start);
+    cudaEventDestroy(stop);
+    cudaFree(d_in);
+    cudaFree(d_out);
+    return best;
+}
+
+#else
+
+/// Fastest time in milliseconds of processing items on the host
+double time_items(const std::vector<item>& in, std::vector<float>& out)
+{
+    double best = 1e30;
+
+    for (size_t r = 0; r < runs; ++r)
+    {
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+        for (size_t i = 0; i < in.size(); ++i)
+            out[i] = process(in[i]);
+
+        std::chrono::duration<double,std::milli> ms = std::chrono::high_resolution_clock::now() - start;
+        best = std::min(best, ms.count());
+    }
+
+    return best;
+}
+
+#endif
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    std::mt19937 engine(42);
+    std::uniform_int_distribution<unsigned> kind(0, 7);
+    std::uniform_real_distribution<float>   value(0.5f, 1.0f);
+    std::vector<item> divergent(items);
+
+    for (size_t i = 0; i < items; ++i)
+    {
+        divergent[i].kind = kind(engine);
+        divergent[i].x    = value(engine);
+        divergent[i].y    = value(engine);
+    }
+
+    std::vector<item> sorted(divergent);
+    std::stable_sort(sorted.begin(), sorted.end(), [](const item& a, const item& b) { return a.kind < b.kind; });
+
+    std::vector<float> out_divergent(items), out_sorted(items);
+    const double t_divergent = time_items(divergent, out_divergent);
+    const double t_sorted    = time_items(sorted,    out_sorted);
+
+    // Results of both orders have to be the same up to the order
+    std::sort(out_divergent.begin(), out_divergent.end());
+    std::sort(out_sorted.begin(),    out_sorted.end());
+    const bool same = out_divergent == out_sorted;
+
+#if defined(__CUDACC__)
+    std::cout << "Device: ";
+#else
+    std::cout << "Host: ";
+#endif
+    std::cout << items << " items, divergent " << t_divergent << " ms, sorted " << t_sorted 
+              << " ms (" << t_divergent/t_sorted << "x)" << (same ? "" : ", results differ!") << std::endl;
+
+    return !same;
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,298 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Compares learned_ptr_map<K,V> with std::unordered_map<K,V> and with the 
+/// design of vtbl maps of vtblmap1.hpp and vtblmap2.hpp, which put a direct-
+/// mapped cache of 2^7 entries hashed by a fixed shift in front of 
+/// std::unordered_map, on sets of pointers of different sizes and layouts:
+/// \code
+///     learned_ptr_map [rounds]
+/// \endcode
+/// For each set it reports ns per key to build the map, ns per lookup of keys
+/// in the map and of keys not in it, and ns per erasure followed by insertion
+/// of a key, as well as bytes used by learned_ptr_map and the shift it learned.
+///
+/// \note vtblmap1.hpp and vtblmap2.hpp themselves cannot be included next to
+///       other vtbl maps, so their design is reproduced here by cached_map.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "learned_ptr_map.hpp"
+
+//------------------------------------------------------------------------------
+
+typedef const void* key_type;
+
+//------------------------------------------------------------------------------
+
+/// Design of vtblmap1.hpp: direct-mapped cache in front of std::unordered_map
+template <typename V, size_t cache_bits = 7, size_t irrelevant_bits = 3>
+class cached_map
+{
+public:
+
+    cached_map() { std::fill(cache, cache + cache_size, cache_entry()); }
+
+    V& operator[](key_type k)
+    {
+        cache_entry& ce = entry(k);
+
+        if (ce.key != k)
+        {
+            ce.ptr = &table[k]; // Nodes of std::unordered_map stay put on rehash
+            ce.key = k;
+        }
+
+        return *ce.ptr;
+    }
+
+    const V* find(key_type k)
+    {
+        cache_entry& ce = entry(k);
+
+        if (ce.key == k)
+            return ce.ptr;
+
+        typename table_type::iterator q = table.find(k);
+        return q != table.end() ? &q->second : 0;
+    }
+
+    void erase(key_type k)
+    {
+        cache_entry& ce = entry(k);
+
+        if (ce.key == k)
+            ce = cache_entry();
+
+        table.erase(k);
+    }
+
+private:
+
+    enum { cache_size = 1 << cache_bits };
+
+    struct cache_entry
+    {
+        cache_entry() : key(0), ptr(0) {}
+        key_type key;
+        V*       ptr;
+    };
+
+    typedef std::unordered_map<key_type,V> table_type;
+
+    cache_entry& entry(key_type k) { return cache[(reinterpret_cast<std::uintptr_t>(k) >> irrelevant_bits) & (cache_size-1)]; }
+
+    cache_entry cache[cache_size];
+    table_type  table;
+};
+
+//------------------------------------------------------------------------------
+
+/// Uniform interface to lookups of the compared maps
+template <typename M> inline const int* find(M& m, key_type k) { typename M::iterator p = m.find(k); return p != m.end() ? &p->second : 0; }
+template <typename V> inline const int* find(cached_map<V>& m, key_type k) { return m.find(k); }
+
+//------------------------------------------------------------------------------
+
+/// Time in ns
+inline long long now() { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(); }
+
+/// Times of operations on one map in ns per operation
+struct timings
+{
+    double build;
+    double hit;
+    double miss;
+    double churn;
+};
+
+//------------------------------------------------------------------------------
+
+/// Runs operations on map M with keys in the set and absent keys not in it
+template <typename M>
+timings measure(const std::vector<key_type>& keys, const std::vector<key_type>& absent, size_t rounds, long long& checksum)
+{
+    timings t;
+    long long start = now();
+
+    for (size_t r = 0; r < rounds; ++r)
+    {
+        M m;
+
+        for (size_t i = 0; i < keys.size(); ++i)
+            m[keys[i]] = int(i);
+
+        checksum += *find(m, keys[0]);
+    }
+
+    t.build = double(now() - start) / (rounds*keys.size());
+
+    M m;
+
+    for (size_t i = 0; i < keys.size(); ++i)
+        m[keys[i]] = int(i);
+
+    std::vector<key_type> order(keys);
+    std::random_shuffle(order.begin(), order.end());
+
+    start = now();
+
+    for (size_t r = 0; r < rounds; ++r)
+        for (size_t i = 0; i < order.size(); ++i)
+            checksum += *find(m, order[i]);
+
+    t.hit = double(now() - start) / (rounds*order.size());
+    start = now();
+
+    for (size_t r = 0; r < rounds; ++r)
+        for (size_t i = 0; i < absent.size(); ++i)
+            checksum += find(m, absent[i]) != 0;
+
+    t.miss = double(now() - start) / (rounds*absent.size());
+    start = now();
+
+    for (size_t r = 0; r < rounds; ++r)
+        for (size_t i = 0; i < order.size(); ++i)
+        {
+            m.erase(order[i]);
+            m[order[i]] = int(r);
+        }
+
+    t.churn = double(now() - start) / (rounds*order.size());
+    return t;
+}
+
+//------------------------------------------------------------------------------
+
+/// Set of n keys named by layout at offsets f(i) from base
+template <typename F>
+std::pair<std::string,std::vector<key_type> > make_set(const std::string& layout, const char* base, size_t n, F f)
+{
+    std::vector<key_type> keys(n);
+
+    for (size_t i = 0; i < n; ++i)
+        keys[i] = base + f(i);
+
+    return std::make_pair(layout, keys);
+}
+
+//------------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    const size_t rounds = argc > 1 ? std::strtoul(argv[1], 0, 10) : 1000;
+    const size_t sizes[] = {8, 64, 512, 4096};
+    static char arena[2*4096*4096]; // Keys point into it, but are never dereferenced
+    std::vector<char*> heap;
+    long long checksum = 0;
+
+    std::cout << std::setw(24) << std::left << "layout" << std::right 
+              << std::setw(8) << "keys" 
+              << std::setw(30) << "learned_ptr_map"
+              << std::setw(30) << "cached_map"
+              << std::setw(30) << "std::unordered_map"
+              << std::setw(8) << "bytes" << std::setw(6) << "shift" << std::endl;
+    std::cout << std::setw(32) << "";
+
+    for (size_t i = 0; i < 3; ++i)
+        std::cout << std::setw(9) << "build" << std::setw(7) << "hit" << std::setw(7) << "miss" << std::setw(7) << "churn";
+
+    std::cout << std::endl;
+
+    for (size_t s = 0; s < sizeof(sizes)/sizeof(sizes[0]); ++s)
+    {
+        const size_t n = sizes[s];
+
+        for (size_t i = heap.size(); i < 2*n; ++i)
+            heap.push_back(new char[1 + std::rand() % 200]);
+
+        std::vector<std::pair<std::string,std::vector<key_type> > > sets;
+        sets.push_back(make_set("stride 16",       arena, 2*n, [](size_t i) { return 16*i; }));
+        sets.push_back(make_set("stride 4096",     arena, 2*n, [](size_t i) { return 4096*i; }));
+        sets.push_back(make_set("stride 128*16+8", arena, 2*n, [](size_t i) { return 128*16*i + 8; }));
+        sets.push_back(make_set("heap",            0,     2*n, [&](size_t i) { return size_t(heap[i]); }));
+
+        for (size_t j = 0; j < sets.size(); ++j)
+        {
+            // Every other key of the set is in the map, others are looked up as absent
+            std::vector<key_type> keys, absent;
+
+            for (size_t i = 0; i < sets[j].second.size(); ++i)
+                (i % 2 ? absent : keys).push_back(sets[j].second[i]);
+
+            const size_t r = std::max(size_t(1), rounds * 64 / n);
+            timings t[3] = {
+                measure<mch::learned_ptr_map<key_type,int> >(keys, absent, r, checksum),
+                measure<cached_map<int> >                   (keys, absent, r, checksum),
+                measure<std::unordered_map<key_type,int> >  (keys, absent, r, checksum)
+            };
+
+            mch::learned_ptr_map<key_type,int> m;
+
+            for (size_t i = 0; i < keys.size(); ++i)
+                m[keys[i]] = int(i);
+
+            std::cout << std::setw(24) << std::left << sets[j].first << std::right << std::setw(8) << n << std::fixed << std::setprecision(1);
+
+            for (size_t i = 0; i < 3; ++i)
+                std::cout << std::setw(9) << t[i].build << std::setw(7) << t[i].hit << std::setw(7) << t[i].miss << std::setw(7) << t[i].churn;
+
+            std::cout << std::setw(8) << m.memory_used() << std::setw(6) << m.shift() << std::endl;
+        }
+    }
+
+    for (size_t i = 0; i < heap.size(); ++i)
+        delete[] heap[i];
+
+    std::cerr << "Checksum: " << checksum << std::endl;
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,223 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Merges profiles saved by many processes of the same build, e.g. on all the
+/// hosts of a fleet, into one profile for all of them:
+/// \code
+///     merge_profiles output-prefix input...
+/// \endcode
+/// Each input is either a type profile saved by mch::type_profile::save() or 
+/// counts of classes written into #XTL_FREQUENCY_COUNTS, told apart by their
+/// first line. Neither depends on addresses, so they merge regardless of 
+/// where each process had its vtables.
+///
+/// Type profiles are merged into output-prefix.profile for loading with 
+/// mch::type_profile::load() at startup. When profiles disagree about the 
+/// jump target or offsets for the same types in a Match statement, the record
+/// saved by most of them wins. Records saved by more profiles come first, 
+/// which is the order in which Match statements recall them.
+///
+/// Counts are added up into output-prefix.counts, which can be merged again,
+/// and into output-prefix.frequency.hpp to build with as #XTL_FREQUENCY_PROFILE.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include "vtblprofile.hpp"
+#include "frequency.hpp"
+
+//------------------------------------------------------------------------------
+
+/// Jump target and offsets that profiles have recorded for the same types
+typedef std::pair<std::size_t,std::vector<std::ptrdiff_t>> variant;
+
+/// Number of profiles that recorded each variant for the same types
+typedef std::map<variant,size_t> votes;
+
+/// Votes for all combinations of types of each Match statement
+typedef std::map<std::string,std::map<std::vector<std::string>,votes>> ballot;
+
+//------------------------------------------------------------------------------
+
+/// Record that got most votes and the number of them
+std::pair<mch::type_profile_record,size_t> winner(const std::vector<std::string>& names, const votes& v)
+{
+    votes::const_iterator best = v.begin();
+
+    for (votes::const_iterator p = v.begin(); p != v.end(); ++p)
+        if (p->second > best->second)
+            best = p;
+
+    mch::type_profile_record rec;
+    rec.names   = names;
+    rec.target  = best->first.first;
+    rec.offsets = best->first.second;
+    return std::make_pair(rec, best->second);
+}
+
+//------------------------------------------------------------------------------
+
+/// Whether r1 was saved by more profiles than r2
+bool more_votes(const std::pair<mch::type_profile_record,size_t>& r1, const std::pair<mch::type_profile_record,size_t>& r2)
+{
+    return r1.second > r2.second;
+}
+
+//------------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " output-prefix input..." << std::endl;
+        return 2;
+    }
+
+    const std::string     prefix = argv[1];
+    ballot                profiles;
+    mch::frequency_counts counts;
+    size_t                type_profiles  = 0;
+    size_t                count_profiles = 0;
+
+    for (int i = 2; i < argc; ++i)
+    {
+        std::ifstream file(argv[i]);
+        std::string   first;
+
+        if (!file || !std::getline(file, first))
+        {
+            std::cerr << "ERROR: Cannot read " << argv[i] << std::endl;
+            return 2;
+        }
+
+        if (!first.empty() && first[first.size()-1] == '\r')
+            first.erase(first.size()-1);
+
+        bool good = false;
+
+        if (first == "# Mach7 type profile")
+        {
+            mch::type_profile_records loaded;
+            good = mch::read_type_profile(file, loaded);
+
+            for (mch::type_profile_records::const_iterator p = loaded.begin(); p != loaded.end(); ++p)
+                for (size_t j = 0; j < p->second.size(); ++j)
+                {
+                    const mch::type_profile_record& rec = p->second[j];
+                    ++profiles[p->first][rec.names][variant(rec.target, rec.offsets)];
+                }
+
+            ++type_profiles;
+        }
+        else
+        if (first == "# Mach7 frequency counts")
+        {
+            good = mch::read_frequency_counts(file, counts);
+            ++count_profiles;
+        }
+
+        if (!good)
+        {
+            std::cerr << "ERROR: " << argv[i] << " is not a well-formed profile" << std::endl;
+            return 2;
+        }
+    }
+
+    if (type_profiles)
+    {
+        std::ofstream os((prefix + ".profile").c_str());
+        size_t        records   = 0;
+        size_t        conflicts = 0;
+
+        os << "# Mach7 type profile\n"
+              "# Merged from " << type_profiles << " profiles\n";
+
+        for (ballot::const_iterator p = profiles.begin(); p != profiles.end(); ++p)
+        {
+            std::vector<std::pair<mch::type_profile_record,size_t>> ranked;
+
+            for (std::map<std::vector<std::string>,votes>::const_iterator q = p->second.begin(); q != p->second.end(); ++q)
+            {
+                ranked.push_back(winner(q->first, q->second));
+                conflicts += q->second.size() > 1;
+            }
+
+            std::stable_sort(ranked.begin(), ranked.end(), more_votes);
+
+            std::vector<mch::type_profile_record> site;
+
+            for (size_t j = 0; j < ranked.size(); ++j)
+                site.push_back(ranked[j].first);
+
+            mch::write_type_profile_site(os, p->first, site);
+            records += site.size();
+        }
+
+        std::cout << "Merged " << type_profiles << " type profiles into " << records << " records of " << profiles.size() << " Match statements";
+
+        if (conflicts)
+            std::cout << " (" << conflicts << " records differed between profiles, the most common one was kept)";
+
+        std::cout << std::endl;
+    }
+
+    if (count_profiles)
+    {
+        std::ofstream raw((prefix + ".counts").c_str());
+        mch::write_frequency_counts(raw, counts);
+
+        std::ofstream hints((prefix + ".frequency.hpp").c_str());
+        mch::write_frequency_hints(hints, counts);
+
+        std::cout << "Merged " << count_profiles << " frequency counts of " << counts.size() << " classes" << std::endl;
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,151 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Measures mch::match called on each object of a vector of pointers to 
+/// objects of random classes against poly_collection::for_each with the same
+/// clauses on the same objects kept in segments of their classes, which 
+/// selects the clause once per segment instead of once per object, 
+/// \see poly_collection.hpp.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include "poly_collection.hpp"
+#include "rnd.hpp"
+#include "timing.hpp"
+
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+//------------------------------------------------------------------------------
+
+/// Number of objects, large enough for them not to fit into caches
+const size_t objects_num = 1 << 20;
+
+/// Number of runs of each loop, of which the fastest is reported
+const size_t runs = 11;
+
+//------------------------------------------------------------------------------
+
+struct Entity                 { virtual ~Entity() {} float x = 0, y = 0; };
+struct Mover   : Entity       { float dx = 1, dy = 2; };
+struct Spinner : Entity       { float angle = 0, rate = 3; };
+struct Emitter : Entity       { unsigned particles = 0, rate = 4; };
+struct Static  : Entity       {};
+
+//------------------------------------------------------------------------------
+
+/// Returns the fastest of several runs of f in nanoseconds per object
+template <typename F>
+double fastest(F f)
+{
+    double best = 0.0;
+
+    for (size_t r = 0; r < runs; ++r)
+    {
+        mch::time_stamp start = mch::get_time_stamp();
+        f();
+        mch::time_stamp finish = mch::get_time_stamp();
+        double ns = (finish - start) * 1e9 / mch::get_frequency() / objects_num;
+
+        if (r == 0 || ns < best)
+            best = ns;
+    }
+
+    return best;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    std::mt19937 engine(XTL_RND_SEED);
+    std::uniform_int_distribution<int> kind(0, 3);
+    std::vector<std::unique_ptr<Entity>> pointers;
+    mch::poly_collection<Entity> segments;
+
+    for (size_t i = 0; i < objects_num; ++i)
+        switch (kind(engine))
+        {
+        case 0: pointers.emplace_back(new Mover);   segments.emplace<Mover>();   break;
+        case 1: pointers.emplace_back(new Spinner); segments.emplace<Spinner>(); break;
+        case 2: pointers.emplace_back(new Emitter); segments.emplace<Emitter>(); break;
+        case 3: pointers.emplace_back(new Static);  segments.emplace<Static>();  break;
+        }
+
+    double sum_pointers = 0.0, sum_segments = 0.0;
+
+    // Both loops only read the objects, so they sum up what an update would write
+    auto clauses = [](double& sum)
+    {
+        return std::make_tuple(
+            mch::case_<Mover>  ([&sum](const Mover&   m) { sum += m.x + m.dx + m.y + m.dy; }),
+            mch::case_<Spinner>([&sum](const Spinner& s) { sum += s.angle + s.rate; }),
+            mch::case_<Emitter>([&sum](const Emitter& e) { sum += e.particles + e.rate; }),
+            mch::otherwise     ([&sum](const Entity&  x) { sum += x.x; }));
+    };
+
+    double p = fastest([&]
+    {
+        sum_pointers = 0.0;
+        auto cs = clauses(sum_pointers);
+
+        for (size_t i = 0; i < pointers.size(); ++i)
+            mch::match(*pointers[i], std::get<0>(cs), std::get<1>(cs), std::get<2>(cs), std::get<3>(cs));
+    });
+
+    double s = fastest([&]
+    {
+        sum_segments = 0.0;
+        auto cs = clauses(sum_segments);
+        segments.for_each(std::get<0>(cs), std::get<1>(cs), std::get<2>(cs), std::get<3>(cs));
+    });
+
+    std::cout << "Pointers " << std::fixed << std::setprecision(2) << p << "ns Segments " << s 
+              << "ns (" << std::setprecision(0) << 100*(p-s)/p << "% faster)" << std::endl;
+
+    XTL_ASSERT(sum_pointers == sum_segments);
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,141 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Times unification of hash-consed Prolog terms of prolog-terms.hpp:
+/// - cold: every unification gets a fresh table, so building its terms and 
+///   unifier allocates every one of them, as heap-allocated terms do;
+/// - warm: all unifications share a table, so every term they build is found
+///   in it and unification is left with dispatch and pointer comparisons.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include "../unit/prolog-terms.hpp"
+#include "timing.hpp"
+#include <iostream>
+#include <sstream>
+
+//------------------------------------------------------------------------------
+
+/// Number of elements in the lists unified by each iteration
+const size_t length = 64;
+
+/// Number of unifications timed in each mode
+const size_t iterations = 10000;
+
+//------------------------------------------------------------------------------
+
+/// Builds list(E0,list(E1,...list(En-1,nil))) of variables Ei and the same
+/// list of integers i with variables in every other element, then unifies
+/// them and applies the unifier to the first one. Asserts that every element
+/// gets the expected value.
+void unify_lists(term_table& table)
+{
+    static std::vector<std::string> names;
+
+    for (size_t i = names.size(); i < length; ++i)
+    {
+        std::stringstream ss;
+        ss << 'E' << i;
+        names.push_back(ss.str());
+    }
+
+    const Atom* list = table.atom("list");
+    const Term* vars = table.atom("nil");
+    const Term* ints = vars;
+
+    for (size_t i = length; i-- > 0; )
+    {
+        const Variable* v = table.variable(names[i]);
+        vars = table.structure(list, { v, vars });
+        ints = table.structure(list, { i % 2 ? static_cast<const Term*>(v) : table.integer(int(i)), ints });
+    }
+
+    substitution_map s;
+    const bool unified = unify(vars, ints, s);
+    XTL_ASSERT(unified);
+    const Term* t = apply(vars, s, table);
+
+    for (size_t i = 0; i < length; ++i)
+    {
+        const Structure* cell = static_cast<const Structure*>(t);
+        const Term* expected = i % 2 ? nullptr : table.integer(int(i));
+        XTL_ASSERT(expected ? cell->terms[0] == expected : dynamic_cast<const Variable*>(cell->terms[0]) != 0);
+        t = cell->terms[1];
+    }
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    mch::time_stamp cold_start = mch::get_time_stamp();
+
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        term_table table;
+        unify_lists(table);
+    }
+
+    mch::time_stamp cold_finish = mch::get_time_stamp();
+
+    term_table shared;
+    unify_lists(shared); // Make all the terms once
+    size_t terms = shared.size();
+
+    mch::time_stamp warm_start = mch::get_time_stamp();
+
+    for (size_t i = 0; i < iterations; ++i)
+        unify_lists(shared);
+
+    mch::time_stamp warm_finish = mch::get_time_stamp();
+
+    XTL_ASSERT(shared.size() == terms); // Warm unifications do not create terms
+
+    double cold = (cold_finish - cold_start) * 1e6 / mch::get_frequency() / iterations;
+    double warm = (warm_finish - warm_start) * 1e6 / mch::get_frequency() / iterations;
+
+    std::cout << "Unification of lists of " << length << " elements (" << terms << " distinct terms)" << std::endl
+              << "  cold: " << cold << "us" << std::endl
+              << "  warm: " << warm << "us (" << cold/warm << "x)" << std::endl;
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,251 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Recommends the configuration of the library for a workload from results of
+/// a sweep over configurations recorded in #XTL_RESULTS_FILE (\see sweep
+/// target of the Makefile):
+/// \code
+///     recommend_config sweep.jsonl [test-prefix[=weight] ...]
+/// \endcode
+/// The workload profile consists of tests whose "benchmark/test" names start
+/// with any of the given prefixes, all tests by default. Each configuration is
+/// scored by the geometric mean, weighted as given, of how much slower than the
+/// best configuration it was on every test of the profile. Only configurations
+/// measured on all tests of the profile are ranked. Configurations are shown 
+/// by the macros in which they differ from the others.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include "testresults.hpp"
+
+//------------------------------------------------------------------------------
+
+/// Results of each configuration for each test
+typedef std::map<std::string,std::map<std::string,test_results> > sweep_results;
+
+//------------------------------------------------------------------------------
+
+bool load(const char* file_name, sweep_results& results)
+{
+    std::ifstream file(file_name);
+
+    if (!file)
+    {
+        std::cerr << "ERROR: Cannot open " << file_name << std::endl;
+        return false;
+    }
+
+    for (std::string line; std::getline(file, line); )
+    {
+        if (line.empty())
+            continue;
+
+        std::string   config = field(line,"config");
+        test_results& r = results[field(line,"benchmark") + "/" + field(line,"test")][config];
+        r.medians.push_back(std::atof(field(line,"median").c_str()));
+        r.deviations.push_back(std::atof(field(line,"stddev").c_str()));
+        r.unit     = field(line,"unit");
+        r.compiler = field(line,"compiler");
+        r.config   = config;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+
+/// Command-line definitions of macros in which the configuration differs from others
+std::string describe(const std::string& config, const std::set<std::string>& varying)
+{
+    std::map<std::string,std::string> m = macros(config);
+    std::string result;
+
+    for (std::set<std::string>::const_iterator p = varying.begin(); p != varying.end(); ++p)
+        result += " -D" + *p + "=" + (m[*p].empty() ? std::string("<default>") : m[*p]);
+
+    return result.empty() ? std::string(" <default>") : result;
+}
+
+//------------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " sweep.jsonl [test-prefix[=weight] ...]" << std::endl;
+        return 2;
+    }
+
+    sweep_results results;
+
+    if (!load(argv[1], results))
+        return 2;
+
+    // Workload profile: prefixes of test names with their weights
+    std::vector<std::pair<std::string,double> > profile;
+
+    for (int i = 2; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        std::string::size_type eq = arg.find('=');
+        profile.push_back(std::make_pair(arg.substr(0,eq), eq == std::string::npos ? 1.0 : std::atof(arg.substr(eq+1).c_str())));
+    }
+
+    if (profile.empty())
+        profile.push_back(std::make_pair(std::string(), 1.0));
+
+    std::set<std::string>        configs;
+    std::map<std::string,double> weights; // Tests of the profile with their weights
+
+    for (sweep_results::const_iterator p = results.begin(); p != results.end(); ++p)
+    {
+        for (size_t i = 0; i < profile.size(); ++i)
+            if (p->first.compare(0, profile[i].first.size(), profile[i].first) == 0)
+            {
+                weights[p->first] = profile[i].second;
+                break;
+            }
+
+        for (std::map<std::string,test_results>::const_iterator q = p->second.begin(); q != p->second.end(); ++q)
+            configs.insert(q->first);
+    }
+
+    if (weights.empty())
+    {
+        std::cerr << "ERROR: No tests match the profile" << std::endl;
+        return 2;
+    }
+
+    // Macros that differ between configurations
+    std::set<std::string> varying;
+    std::map<std::string,std::string> first = macros(*configs.begin());
+
+    for (std::set<std::string>::const_iterator c = configs.begin(); c != configs.end(); ++c)
+    {
+        std::map<std::string,std::string> m = macros(*c);
+
+        for (std::map<std::string,std::string>::const_iterator p = m.begin(); p != m.end(); ++p)
+            if (first[p->first] != p->second)
+                varying.insert(p->first);
+    }
+
+    // Per-configuration weighted sum of logs of slowdowns relative to the best
+    std::map<std::string,double> logs;
+    std::map<std::string,size_t> tests;
+    double total_weight = 0.0;
+
+    for (std::map<std::string,double>::const_iterator t = weights.begin(); t != weights.end(); ++t)
+    {
+        const std::map<std::string,test_results>& r = results[t->first];
+        const std::string& unit = r.begin()->second.unit;
+        std::string best_config;
+        double      best = 0.0;
+
+        for (std::map<std::string,test_results>::const_iterator q = r.begin(); q != r.end(); ++q)
+        {
+            if (q->second.unit != unit)
+            {
+                std::cout << "WARNING: " << t->first << " was measured in " << unit << " and " << q->second.unit << std::endl;
+                best = 0.0;
+                break;
+            }
+
+            double m = median(q->second.medians);
+
+            if (best_config.empty() || m < best)
+            {
+                best = m;
+                best_config = q->first;
+            }
+        }
+
+        if (best <= 0.0)
+            continue;
+
+        std::cout << "BEST  " << t->first << ": " << std::fixed << std::setprecision(2) 
+                  << best << ' ' << unit << " with" << describe(best_config, varying) << std::endl;
+
+        for (std::map<std::string,test_results>::const_iterator q = r.begin(); q != r.end(); ++q)
+        {
+            logs[q->first]  += t->second * std::log(std::max(median(q->second.medians), best)/best);
+            tests[q->first] += 1;
+        }
+
+        total_weight += t->second;
+    }
+
+    // Rank configurations measured on every test of the profile
+    std::vector<std::pair<double,std::string> > ranking;
+    size_t profile_tests = 0;
+
+    for (std::map<std::string,size_t>::const_iterator p = tests.begin(); p != tests.end(); ++p)
+        profile_tests = std::max(profile_tests, p->second);
+
+    for (std::map<std::string,double>::const_iterator p = logs.begin(); p != logs.end(); ++p)
+        if (tests[p->first] == profile_tests && total_weight > 0)
+            ranking.push_back(std::make_pair(std::exp(p->second/total_weight), p->first));
+        else
+            std::cout << "SKIP " << describe(p->first, varying) << ": not measured on all " << profile_tests << " tests" << std::endl;
+
+    if (ranking.empty())
+    {
+        std::cerr << "ERROR: No configuration was measured on all the tests of the profile" << std::endl;
+        return 2;
+    }
+
+    std::sort(ranking.begin(), ranking.end());
+
+    for (size_t i = 0; i < ranking.size(); ++i)
+        std::cout << "RANK " << std::setw(2) << i+1 << ": " << std::fixed << std::setprecision(2) << std::setw(7)
+                  << (ranking[i].first-1.0)*100 << "% slower than best on average" << describe(ranking[i].second, varying) << std::endl;
+
+    std::cout << "RECOMMENDED:" << describe(ranking[0].second, varying) << std::endl;
+    return 0;
+}
+
+//------------------------------------------------------------------------------
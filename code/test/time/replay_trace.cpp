@@ -0,0 +1,355 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Replays traces of Match statements recorded with #XTL_TRACE_MATCH_SITES
+/// through vtbl maps of several policies and reports for each site and each
+/// policy how many lookups hit and missed, how many misses collided, how many
+/// times the cache was rearranged and how much memory it took in the end:
+/// \code
+///     replay_trace trace-file [site ...]
+/// \endcode
+/// Only the given sites (ids of \see mch::match_trace_site) are replayed when
+/// any are given. Policies differ in probing and hashing (\see vtbl_map_policy),
+/// in the log of the largest increase of the cache on update (#XTL_MAX_LOG_INC)
+/// and, with #XTL_PERFECT_HASHING, include a map frozen after the first replay
+/// and replayed once more. #XTL_MIN_LOG_SIZE is a constant of the library, so 
+/// its values are compared by building the replay with each of them (\see replay
+/// target of the Makefile).
+///
+/// \note Vtbl pointers of the trace are only compared with each other, so the 
+///       replay does not need the classes of the traced program.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#if !defined(XTL_VTBL_STATISTICS)
+#define XTL_VTBL_STATISTICS 1 // Maps count their hits, misses, collisions and updates
+#endif
+#if !defined(XTL_PERFECT_HASHING)
+#define XTL_PERFECT_HASHING 1 // Maps can be frozen
+#endif
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include "tracing.hpp"
+#include "vtblmap4.hpp"
+
+//------------------------------------------------------------------------------
+
+/// Largest number of polymorphic subjects of a Match statement that is replayed
+const size_t max_subjects = 4;
+
+/// Vtbl pointers of polymorphic subjects of one execution of a Match statement
+typedef std::vector<std::intptr_t> vtbl_tuple;
+
+/// Executions of one Match statement in the order they were recorded
+struct site_trace
+{
+    site_trace() : subjects(0), skipped(0) {}
+    size_t                  subjects; ///< Number of polymorphic subjects
+    std::vector<vtbl_tuple> tuples;   ///< Vtbl pointers of each execution
+    size_t                  skipped;  ///< Executions with fewer subjects, e.g. a null subject
+};
+
+/// What a replay of a site through a map with a given policy did
+struct replay_result
+{
+    replay_result() : hits(0), misses(0), collisions(0), updates(0), log_size(0), memory(0) {}
+    size_t hits;
+    size_t misses;
+    size_t collisions;
+    size_t updates;
+    size_t log_size;
+    size_t memory;
+
+    replay_result& operator+=(const replay_result& r)
+    {
+        hits += r.hits; misses += r.misses; collisions += r.collisions; updates += r.updates; memory += r.memory;
+        log_size = (std::max)(log_size, r.log_size); // Of the largest cache
+        return *this;
+    }
+};
+
+//------------------------------------------------------------------------------
+
+/// Reads the records of a file written by mch::match_trace_flush() into the
+/// traces of their sites. Vtbl pointers of non-polymorphic subjects are 0 in
+/// the records and are dropped.
+bool load(const char* file_name, std::map<std::uint32_t,site_trace>& sites)
+{
+    std::ifstream file(file_name, std::ios::binary);
+    mch::match_trace_header header;
+
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, "MACH7TRC", sizeof(header.magic)) != 0 ||
+        header.record_size != 16 + header.subjects*sizeof(std::intptr_t))
+    {
+        std::cerr << "ERROR: " << file_name << " is not a trace of Match statements of this platform" << std::endl;
+        return false;
+    }
+
+    std::vector<char> record(header.record_size);
+
+    for (std::uint64_t i = 0; i < header.records && file.read(&record[0], std::streamsize(record.size())); ++i)
+    {
+        std::uint32_t site;
+        std::memcpy(&site, &record[8], sizeof(site));
+
+        vtbl_tuple tuple;
+
+        for (size_t j = 0; j < header.subjects; ++j)
+        {
+            std::intptr_t vtbl;
+            std::memcpy(&vtbl, &record[16 + j*sizeof(vtbl)], sizeof(vtbl));
+
+            if (vtbl)
+                tuple.push_back(vtbl);
+        }
+
+        site_trace& s = sites[site];
+        s.subjects = (std::max)(s.subjects, tuple.size());
+        s.tuples.push_back(tuple);
+    }
+
+    // Executions with fewer vtbl pointers than the site has cannot be replayed
+    for (std::map<std::uint32_t,site_trace>::iterator p = sites.begin(); p != sites.end(); ++p)
+    {
+        std::vector<vtbl_tuple>& tuples = p->second.tuples;
+        const size_t n = tuples.size();
+
+        for (size_t i = 0; i < tuples.size(); )
+            if (tuples[i].size() != p->second.subjects)
+            {
+                tuples[i] = tuples.back();
+                tuples.pop_back();
+            }
+            else
+                ++i;
+
+        p->second.skipped = n - tuples.size();
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+
+/// Statistics of the map whose Match statement is said to be in file tag
+replay_result statistics_of(const char* tag)
+{
+    replay_result result;
+
+    mch::for_each_vtbl_site([&](const mch::vtbl_site_statistics& s)
+    {
+        if (s.file == tag)
+        {
+            result.hits       = s.hits;
+            result.misses     = s.misses;
+            result.collisions = s.collisions;
+            result.updates    = s.updates;
+            result.log_size   = s.log_size;
+            result.memory     = s.memory;
+        }
+    });
+
+    return result;
+}
+
+//------------------------------------------------------------------------------
+
+/// Replays tuples through a map of N subjects with policy P. A frozen map is
+/// replayed once to learn the tuples, frozen and replayed again, which is 
+/// what is reported for it.
+template <size_t N, typename P>
+replay_result replay(const std::vector<vtbl_tuple>& tuples, bool frozen)
+{
+    static const char tag[] = "replay"; // Tells the map apart from others in the list of all maps
+    const mch::vtbl_count_t clauses = 0;
+    mch::vtbl_map<N,mch::type_switch_info<N>,P> map(tag, 0, "", clauses);
+    intptr_t vtbl[N];
+    replay_result before;
+
+    for (size_t r = 0; r < (frozen ? 2 : 1); ++r)
+    {
+        if (r)
+        {
+            XTL_PERFECT_HASHING_ONLY(map.freeze());
+            before = statistics_of(tag);
+        }
+
+        for (size_t i = 0; i < tuples.size(); ++i)
+        {
+            std::copy(tuples[i].begin(), tuples[i].end(), &vtbl[0]);
+            map.get(vtbl);
+        }
+    }
+
+    replay_result result = statistics_of(tag);
+    result.hits       -= before.hits;
+    result.misses     -= before.misses;
+    result.collisions -= before.collisions;
+    result.updates    -= before.updates;
+    return result;
+}
+
+//------------------------------------------------------------------------------
+
+/// Replay of tuples of N subjects with all the policies
+template <size_t N>
+void replay_all(const std::vector<vtbl_tuple>& tuples, std::vector<std::pair<std::string,replay_result> >& results)
+{
+    using namespace mch;
+    typedef adaptive_update<initial_collisions_before_update,0> log_inc0;
+    typedef adaptive_update<initial_collisions_before_update,1> log_inc1;
+    typedef adaptive_update<initial_collisions_before_update,2> log_inc2;
+    typedef adaptive_update<initial_collisions_before_update,3> log_inc3;
+
+    results.push_back(std::make_pair("default",                         replay<N,vtbl_map_policy<> >(tuples,false)));
+    results.push_back(std::make_pair("lcg_probing",                     replay<N,vtbl_map_policy<lcg_probing> >(tuples,false)));
+    results.push_back(std::make_pair("linear_probing",                  replay<N,vtbl_map_policy<linear_probing> >(tuples,false)));
+    results.push_back(std::make_pair("group_probing",                   replay<N,vtbl_map_policy<group_probing> >(tuples,false)));
+    results.push_back(std::make_pair("cuckoo_probing",                  replay<N,vtbl_map_policy<cuckoo_probing<> > >(tuples,false)));
+    results.push_back(std::make_pair("xor_hashing",                     replay<N,vtbl_map_policy<default_probing,xor_hashing> >(tuples,false)));
+    results.push_back(std::make_pair("multiplicative_hashing",          replay<N,vtbl_map_policy<default_probing,multiplicative_hashing> >(tuples,false)));
+    results.push_back(std::make_pair("XTL_MAX_LOG_INC=0",               replay<N,vtbl_map_policy<default_probing,default_hashing,log_inc0> >(tuples,false)));
+    results.push_back(std::make_pair("XTL_MAX_LOG_INC=1",               replay<N,vtbl_map_policy<default_probing,default_hashing,log_inc1> >(tuples,false)));
+    results.push_back(std::make_pair("XTL_MAX_LOG_INC=2",               replay<N,vtbl_map_policy<default_probing,default_hashing,log_inc2> >(tuples,false)));
+    results.push_back(std::make_pair("XTL_MAX_LOG_INC=3",               replay<N,vtbl_map_policy<default_probing,default_hashing,log_inc3> >(tuples,false)));
+#if XTL_PERFECT_HASHING
+    results.push_back(std::make_pair("frozen (XTL_PERFECT_HASHING)",    replay<N,vtbl_map_policy<> >(tuples,true)));
+#endif
+}
+
+//------------------------------------------------------------------------------
+
+void print(std::ostream& os, const std::vector<std::pair<std::string,replay_result> >& results)
+{
+    os << "    " << std::left << std::setw(30) << "policy" << std::right 
+       << std::setw(12) << "hits" << std::setw(10) << "misses" << std::setw(11) << "collisions" 
+       << std::setw(8)  << "updates" << std::setw(5) << "log" << std::setw(10) << "memory" << std::endl;
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const replay_result& r = results[i].second;
+        os << "    " << std::left << std::setw(30) << results[i].first << std::right 
+           << std::setw(12) << r.hits << std::setw(10) << r.misses << std::setw(11) << r.collisions 
+           << std::setw(8)  << r.updates << std::setw(5) << r.log_size << std::setw(10) << r.memory << std::endl;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " trace-file [site ...]" << std::endl;
+        return 1;
+    }
+
+    std::map<std::uint32_t,site_trace> sites;
+
+    if (!load(argv[1], sites))
+        return 1;
+
+    std::set<std::uint32_t> selected;
+
+    for (int i = 2; i < argc; ++i)
+        selected.insert(std::uint32_t(std::atoi(argv[i])));
+
+    std::cout << "Replay of " << argv[1] << " with XTL_MIN_LOG_SIZE=" << XTL_MIN_LOG_SIZE << std::endl;
+
+    std::vector<std::pair<std::string,replay_result> > total;
+
+    for (std::map<std::uint32_t,site_trace>::const_iterator p = sites.begin(); p != sites.end(); ++p)
+    {
+        const site_trace& s = p->second;
+
+        if (!selected.empty() && !selected.count(p->first))
+            continue;
+
+        std::cout << "Site " << p->first << ": " << s.subjects << " subjects, " << s.tuples.size() << " executions";
+
+        if (s.skipped)
+            std::cout << " (" << s.skipped << " with null subjects skipped)";
+
+        std::cout << std::endl;
+
+        std::vector<std::pair<std::string,replay_result> > results;
+
+        switch (s.subjects)
+        {
+        case 1: replay_all<1>(s.tuples, results); break;
+        case 2: replay_all<2>(s.tuples, results); break;
+        case 3: replay_all<3>(s.tuples, results); break;
+        case 4: replay_all<4>(s.tuples, results); break;
+        default:
+            std::cout << "    not replayed: only sites of 1 to " << max_subjects << " polymorphic subjects are" << std::endl;
+            continue;
+        }
+
+        print(std::cout, results);
+
+        if (total.empty())
+            total = results;
+        else
+            for (size_t i = 0; i < total.size(); ++i)
+                total[i].second += results[i].second;
+    }
+
+    if (!total.empty())
+    {
+        std::cout << "All sites:" << std::endl;
+        print(std::cout, total);
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,198 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Compares visitors, Match and chains of dynamic and memoized casts on a generated 
+/// hierarchy with multiple inheritance and Zipf-distributed dynamic types, 
+/// \see testhierarchy.hpp for the parameters of the hierarchy.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include "testhierarchy.hpp"
+#include "match.hpp"
+#undef memoized_cast // match.hpp maps it to dynamic_cast unless XTL_USE_MEMOIZED_CAST
+#include "memoized_cast.hpp"
+
+//------------------------------------------------------------------------------
+
+/// Number of experiments and measurements per experiment. Smaller than usual 
+/// as a miss of the dynamic cast chain costs a cast per class.
+const size_t experiments  = 5;
+const size_t measurements = 11;
+
+//------------------------------------------------------------------------------
+
+struct kind_visitor : node_visitor
+{
+    kind_visitor() : result(0) {}
+    #define FOR_EACH_MAX  XTL_GEN_CLASSES-1
+    #define FOR_EACH_N(N) virtual void visit(const node<N>&) { result = N; }
+    #include "loop_over_numbers.hpp"
+    #undef  FOR_EACH_N
+    #undef  FOR_EACH_MAX
+    size_t result;
+};
+
+XTL_TIMED_FUNC_BEGIN
+size_t do_visit(const node<0>& n)
+{
+    kind_visitor v;
+    n.accept(v);
+    return v.result;
+}
+XTL_TIMED_FUNC_END
+
+// Clauses of Match and of the cast chain go from the most derived classes to
+// the root, which ensures the first matching clause is the dynamic type.
+
+XTL_TIMED_FUNC_BEGIN
+size_t do_match(const node<0>& n)
+{
+    MatchP(n)
+    {
+        #define FOR_EACH_MAX  XTL_GEN_CLASSES-1
+        #define FOR_EACH_N(N) CaseP(node<XTL_GEN_CLASSES-1-N>) return XTL_GEN_CLASSES-1-N;
+        #include "loop_over_numbers.hpp"
+        #undef  FOR_EACH_N
+        #undef  FOR_EACH_MAX
+    }
+    EndMatchP
+    return size_t(-1);
+}
+XTL_TIMED_FUNC_END
+
+XTL_TIMED_FUNC_BEGIN
+size_t do_cast(const node<0>& n)
+{
+    #define FOR_EACH_MAX  XTL_GEN_CLASSES-1
+    #define FOR_EACH_N(N) if (dynamic_cast<const node<XTL_GEN_CLASSES-1-N>*>(&n)) return XTL_GEN_CLASSES-1-N;
+    #include "loop_over_numbers.hpp"
+    #undef  FOR_EACH_N
+    #undef  FOR_EACH_MAX
+    return size_t(-1);
+}
+XTL_TIMED_FUNC_END
+
+XTL_TIMED_FUNC_BEGIN
+size_t do_memoized(const node<0>& n)
+{
+    #define FOR_EACH_MAX  XTL_GEN_CLASSES-1
+    #define FOR_EACH_N(N) if (memoized_cast<const node<XTL_GEN_CLASSES-1-N>*>(&n)) return XTL_GEN_CLASSES-1-N;
+    #include "loop_over_numbers.hpp"
+    #undef  FOR_EACH_N
+    #undef  FOR_EACH_MAX
+    return size_t(-1);
+}
+XTL_TIMED_FUNC_END
+
+//------------------------------------------------------------------------------
+
+/// Runs the experiments with function f over objects and returns the median
+/// time of a pass over them. Asserts that f gets every dynamic type right.
+long long run(const char* name, size_t (*f)(const node<0>&), const std::vector<node<0>*>& objects)
+{
+    const size_t n = objects.size();
+    std::vector<long long> medians(experiments);
+    std::vector<long long> timings(measurements);
+    size_t a = 0;
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        const size_t kind = f(*objects[i]);
+        XTL_ASSERT(kind == objects[i]->m_kind);
+    }
+
+    for (size_t k = 0; k < experiments; ++k)
+    {
+        for (size_t m = 0; m < measurements; ++m)
+        {
+            mch::time_stamp liStart  = mch::get_time_stamp();
+
+            for (size_t i = 0; i < n; ++i)
+                a += f(*objects[i]);
+
+            mch::time_stamp liFinish = mch::get_time_stamp();
+            timings[m] = liFinish-liStart;
+        }
+
+        medians[k] = mch::display(name, timings, n);
+    }
+
+    if (a == size_t(-1)) std::cout << ' '; // Keeps a alive
+
+    std::sort(medians.begin(), medians.end());
+    return medians[experiments/2];
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    size_t multiple = 0;
+
+    #define FOR_EACH_MAX  XTL_GEN_CLASSES-1
+    #define FOR_EACH_N(N) if (mch::node_has_second_base(N)) ++multiple;
+    #include "loop_over_numbers.hpp"
+    #undef  FOR_EACH_N
+    #undef  FOR_EACH_MAX
+
+    std::cout << "Hierarchy: " << XTL_GEN_CLASSES << " classes, fan-out " 
+              << XTL_GEN_FANOUT << ", depth " << mch::node_level(XTL_GEN_CLASSES-1) 
+              << ", " << multiple << " with a second " 
+              << (XTL_GEN_VIRTUAL ? "virtual " : "") << "base, Zipf exponent " 
+              << XTL_ZIPF_EXPONENT << std::endl;
+
+    std::vector<node<0>*> objects = mch::make_zipf_nodes(mch::N);
+
+    long long v = run("Visitor", do_visit, objects);
+    long long m = run("Match",   do_match, objects);
+    long long c = run("Cast",    do_cast,  objects);
+    long long d = run("Memoized",do_memoized, objects);
+
+    std::cout << "OVERALL: "
+              << "Visitor: " << mch::verdict(objects.size(), v, m) << "; "
+              << "Cast: "    << mch::verdict(objects.size(), c, m) << "; "
+              << "Memoized: "<< mch::verdict(objects.size(), d, m)
+              << std::endl;
+
+    for (size_t i = 0; i < objects.size(); ++i)
+        delete objects[i];
+}
@@ -0,0 +1,202 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Samples latency of individual calls of Match, rather than of batches of
+/// them, to expose the tail: first sight of a dynamic type by a match 
+/// statement and rehashing of its vtbl map as the number of seen types grows.
+/// Every one of #sites match statements starts cold, so that the cold-to-warm 
+/// transition gets sampled repeatedly. Latencies are split into:
+/// - calls on dynamic types seen for the first time by the statement;
+/// - the remaining calls, in windows of growing number of preceding calls.
+/// Histograms of cold and warm calls in nanoseconds are written in .hgrm 
+/// format of HdrHistogram. Visitors are sampled the same way for reference.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include "testhierarchy.hpp"
+#include "match.hpp"
+
+//------------------------------------------------------------------------------
+
+/// Number of independent match statements, each started cold
+const size_t sites = 10;
+
+/// Latency in nanoseconds is taken from a time source cheap enough to read 
+/// around every call, which counters of timing method 5 are not.
+#if defined(XTL_TIMING_METHOD_4) || defined(XTL_TIMING_METHOD_5)
+inline long long call_stamp() { return mch::steady_time_stamp(); }
+inline double    nanoseconds(long long t) { return double(t); }
+#else
+inline long long call_stamp() { return mch::get_time_stamp(); }
+inline double    nanoseconds(long long t) { return t * 1e9 / mch::get_frequency(); }
+#endif
+
+//------------------------------------------------------------------------------
+
+struct kind_visitor : node_visitor
+{
+    kind_visitor() : result(0) {}
+    #define FOR_EACH_MAX  XTL_GEN_CLASSES-1
+    #define FOR_EACH_N(N) virtual void visit(const node<N>&) { result = N; }
+    #include "loop_over_numbers.hpp"
+    #undef  FOR_EACH_N
+    #undef  FOR_EACH_MAX
+    size_t result;
+};
+
+XTL_TIMED_FUNC_BEGIN
+size_t do_visit(const node<0>& n)
+{
+    kind_visitor v;
+    n.accept(v);
+    return v.result;
+}
+XTL_TIMED_FUNC_END
+
+/// Each instantiation is a separate match statement with its own vtbl map
+template <size_t Site>
+XTL_TIMED_FUNC_BEGIN
+size_t do_match(const node<0>& n)
+{
+    MatchP(n)
+    {
+        #define FOR_EACH_MAX  XTL_GEN_CLASSES-1
+        #define FOR_EACH_N(N) CaseP(node<XTL_GEN_CLASSES-1-N>) return XTL_GEN_CLASSES-1-N;
+        #include "loop_over_numbers.hpp"
+        #undef  FOR_EACH_N
+        #undef  FOR_EACH_MAX
+    }
+    EndMatchP
+    return size_t(-1);
+}
+XTL_TIMED_FUNC_END
+
+typedef size_t (*node_function)(const node<0>&);
+
+const node_function visit_sites[sites] = { do_visit, do_visit, do_visit, do_visit, do_visit, do_visit, do_visit, do_visit, do_visit, do_visit };
+const node_function match_sites[sites] = { do_match<0>, do_match<1>, do_match<2>, do_match<3>, do_match<4>, do_match<5>, do_match<6>, do_match<7>, do_match<8>, do_match<9> };
+
+//------------------------------------------------------------------------------
+
+/// Windows of calls made by a statement before the sampled call
+const size_t windows = 4;
+const size_t window_start[windows+1] = { 0, 10, 100, 1000, size_t(-1) };
+
+/// Samples every call of each site on objects and reports latency distributions
+void sample(const char* name, const node_function (&functions)[sites], const std::vector<node<0>*>& objects)
+{
+    // Cost of reading the time source, subtracted from every sample
+    std::vector<long long> empty(1001);
+
+    for (size_t i = 0; i < empty.size(); ++i)
+    {
+        long long t0 = call_stamp();
+        empty[i] = call_stamp() - t0;
+    }
+
+    std::sort(empty.begin(), empty.end());
+    const long long overhead = empty[empty.size()/2];
+
+    mch::latency_histogram cold, warm, window[windows];
+
+    for (size_t s = 0; s < sites; ++s)
+    {
+        std::vector<bool> seen(XTL_GEN_CLASSES);
+
+        // Each site starts at a different object to see a different sequence of types
+        for (size_t i = 0, j = s*objects.size()/sites; i < objects.size(); ++i, j = (j+1) % objects.size())
+        {
+            const node<0>& n = *objects[j];
+            long long t0 = call_stamp();
+            size_t    r  = functions[s](n);
+            long long t1 = call_stamp();
+            unsigned long long latency = (unsigned long long)nanoseconds((std::max)(t1 - t0 - overhead, 0LL));
+
+            XTL_ASSERT(r == n.m_kind);
+
+            if (!seen[n.m_kind])
+            {
+                seen[n.m_kind] = true;
+                cold.record(latency);
+                continue;
+            }
+
+            warm.record(latency);
+
+            for (size_t w = 0; w < windows; ++w)
+                if (i < window_start[w+1])
+                {
+                    window[w].record(latency);
+                    break;
+                }
+        }
+    }
+
+    std::cout << name << " (time source overhead of " << nanoseconds(overhead) << "ns subtracted)" << std::endl;
+    cold.display("  first sight of a type ");
+    warm.display("  types seen before     ");
+
+    for (size_t w = 0; w < windows; ++w)
+    {
+        std::stringstream ss;
+        ss << "  after " << std::setw(5) << window_start[w] << "+ calls    ";
+        window[w].display(ss.str().c_str());
+    }
+
+    std::ofstream cold_file((std::string(name) + "-cold.hgrm").c_str());
+    std::ofstream warm_file((std::string(name) + "-warm.hgrm").c_str());
+    cold.write_percentiles(cold_file);
+    warm.write_percentiles(warm_file);
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    std::vector<node<0>*> objects = mch::make_zipf_nodes(mch::N);
+
+    sample("Visitor", visit_sites, objects);
+    sample("Match",   match_sites, objects);
+
+    for (size_t i = 0; i < objects.size(); ++i)
+        delete objects[i];
+}
@@ -0,0 +1,229 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Measures how placement of objects in memory affects the cost of matching
+/// them. The same sequence of dynamic types drawn from a Zipf distribution is
+/// allocated in three ways:
+/// - scattered: with new, in a random order and interleaved with unrelated 
+///   allocations of random size, as nodes built over time by a compiler are;
+/// - sequential: with new, one after another in the order of traversal;
+/// - arena: in mch::arena<node<0>>, packed in the order of traversal.
+/// Every layout is traversed in the same order by visitors and by Match, so
+/// that the difference is only in the memory the vtbl-pointers are read from.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include "testhierarchy.hpp"
+#include "arena.hpp"
+#include "match.hpp"
+
+//------------------------------------------------------------------------------
+
+/// Number of objects traversed, large enough for them not to fit into caches
+const size_t objects = 64*mch::N;
+
+/// Number of traversals of each layout, of which the fastest is reported
+const size_t runs = 11;
+
+//------------------------------------------------------------------------------
+
+struct kind_visitor : node_visitor
+{
+    kind_visitor() : result(0) {}
+    #define FOR_EACH_MAX  XTL_GEN_CLASSES-1
+    #define FOR_EACH_N(N) virtual void visit(const node<N>&) { result = N; }
+    #include "loop_over_numbers.hpp"
+    #undef  FOR_EACH_N
+    #undef  FOR_EACH_MAX
+    size_t result;
+};
+
+XTL_TIMED_FUNC_BEGIN
+size_t do_visit(const node<0>& n)
+{
+    kind_visitor v;
+    n.accept(v);
+    return v.result;
+}
+XTL_TIMED_FUNC_END
+
+XTL_TIMED_FUNC_BEGIN
+size_t do_match(const node<0>& n)
+{
+    MatchP(n)
+    {
+        #define FOR_EACH_MAX  XTL_GEN_CLASSES-1
+        #define FOR_EACH_N(N) CaseP(node<XTL_GEN_CLASSES-1-N>) return XTL_GEN_CLASSES-1-N;
+        #include "loop_over_numbers.hpp"
+        #undef  FOR_EACH_N
+        #undef  FOR_EACH_MAX
+    }
+    EndMatchP
+    return size_t(-1);
+}
+XTL_TIMED_FUNC_END
+
+//------------------------------------------------------------------------------
+
+/// Makes an object of class number i in a given arena
+inline node<0>* make_node(mch::arena<node<0>>& a, size_t i)
+{
+    node<0>* result = 0;
+
+    switch (i % XTL_GEN_CLASSES)
+    {
+        #define FOR_EACH_MAX  XTL_GEN_CLASSES-1
+        #define FOR_EACH_N(N) case N: result = a.make<node<N>>(); break;
+        #include "loop_over_numbers.hpp"
+        #undef  FOR_EACH_N
+        #undef  FOR_EACH_MAX
+    }
+
+    result->m_kind = i % XTL_GEN_CLASSES;
+    return result;
+}
+
+//------------------------------------------------------------------------------
+
+/// Returns the fastest of several traversals of objects with f in nanoseconds
+/// per call and asserts that every call returns the class of its object
+double traverse(size_t (*f)(const node<0>&), const std::vector<node<0>*>& nodes)
+{
+    double best = 0.0;
+
+    for (size_t r = 0; r < runs; ++r)
+    {
+        size_t wrong = 0;
+        mch::time_stamp start = mch::get_time_stamp();
+
+        for (size_t i = 0; i < nodes.size(); ++i)
+            wrong += f(*nodes[i]) != nodes[i]->m_kind;
+
+        mch::time_stamp finish = mch::get_time_stamp();
+        double ns = (finish - start) * 1e9 / mch::get_frequency() / nodes.size();
+
+        if (r == 0 || ns < best)
+            best = ns;
+
+        XTL_ASSERT(wrong == 0);
+    }
+
+    return best;
+}
+
+/// Reports time per call of visitors and Match on objects of a given layout
+void report(const char* name, const std::vector<node<0>*>& nodes)
+{
+    double v = traverse(do_visit, nodes);
+    double m = traverse(do_match, nodes);
+
+    std::cout << std::setw(10) << name << ": Visitor " << std::fixed << std::setprecision(2) << v 
+              << "ns Match " << m << "ns (" << std::setprecision(0) << 100*(v-m)/v << "% faster)" << std::endl;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    std::mt19937 engine(XTL_RND_SEED);
+    std::vector<node<0>*> zipf = mch::make_zipf_nodes(objects);
+    std::vector<size_t>   kinds(objects);
+
+    for (size_t i = 0; i < objects; ++i)
+    {
+        kinds[i] = zipf[i]->m_kind;
+        delete zipf[i];
+    }
+
+    // Scattered: objects are created in a random order among unrelated blocks
+    {
+        std::vector<size_t> order(objects);
+        std::vector<char*>  fillers(objects);
+        std::vector<node<0>*> nodes(objects);
+        std::uniform_int_distribution<size_t> filler_size(16, 256);
+
+        for (size_t i = 0; i < objects; ++i)
+            order[i] = i;
+
+        std::shuffle(order.begin(), order.end(), engine);
+
+        for (size_t i = 0; i < objects; ++i)
+        {
+            nodes[order[i]] = make_node(kinds[order[i]]);
+            fillers[i] = new char[filler_size(engine)];
+        }
+
+        report("scattered", nodes);
+
+        for (size_t i = 0; i < objects; ++i)
+        {
+            delete nodes[i];
+            delete[] fillers[i];
+        }
+    }
+
+    // Sequential: objects are created with new in the order of traversal
+    {
+        std::vector<node<0>*> nodes(objects);
+
+        for (size_t i = 0; i < objects; ++i)
+            nodes[i] = make_node(kinds[i]);
+
+        report("sequential", nodes);
+
+        for (size_t i = 0; i < objects; ++i)
+            delete nodes[i];
+    }
+
+    // Arena: objects are packed in the order of traversal
+    {
+        mch::arena<node<0>>   a;
+        std::vector<node<0>*> nodes(objects);
+
+        for (size_t i = 0; i < objects; ++i)
+            nodes[i] = make_node(a, kinds[i]);
+
+        report("arena", nodes);
+    }
+}
+
+//------------------------------------------------------------------------------
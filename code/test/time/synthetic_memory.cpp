@@ -0,0 +1,287 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Measures memory used by the dispatch tables of many Match statements over
+/// a generated hierarchy, \see testhierarchy.hpp for its parameters. Reports 
+/// bytes used by vtbl maps of type switches, by the offsets memoized by 
+/// memoized_cast and by the maps of Match statements on kinds, as the number
+/// of dynamic types seen by each statement grows. With #XTL_MEMORY_BUDGET set,
+/// exceeding the given number of bytes in total makes it exit with 1, which 
+/// lets the benchmark catch memory regressions of the dispatch structures.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#if !defined(XTL_VTBL_STATISTICS)
+#define XTL_VTBL_STATISTICS 1 // Keep the registry of maps, which memory accounting needs
+#endif
+
+#include "testhierarchy.hpp"
+#include "match.hpp"
+#undef memoized_cast // match.hpp maps it to dynamic_cast unless XTL_USE_MEMOIZED_CAST
+#include "memoized_cast.hpp"
+
+#if !XTL_VTBL_STATISTICS
+    #error Memory accounting of dispatch tables requires XTL_VTBL_STATISTICS
+#endif
+
+//------------------------------------------------------------------------------
+
+#if !defined(XTL_MEMORY_SITES)
+    /// Number of Match statements of each kind, at most 100
+    #define XTL_MEMORY_SITES 32
+#endif
+
+#if !defined(XTL_MEMORY_BUDGET)
+    /// Largest number of bytes all dispatch tables may use together, 0 for no limit
+    #define XTL_MEMORY_BUDGET 0
+#endif
+
+static_assert(XTL_MEMORY_SITES >= 1 && XTL_MEMORY_SITES <= 100, "XTL_MEMORY_SITES has to be within 1..100");
+
+/// Match statements on kinds use static casts, which virtual bases do not allow
+#define XTL_MEMORY_KINDS !XTL_GEN_VIRTUAL
+
+//------------------------------------------------------------------------------
+
+#if XTL_MEMORY_KINDS
+/// Tag precedence list of class I: the class itself followed by its primary 
+/// bases up to the root
+template <size_t I, typename... B>
+struct kinds_of_node
+{
+    typedef typename kinds_of_node<mch::node_parent(I), B..., node<mch::node_parent(I)>>::type type;
+};
+
+template <typename... B>
+struct kinds_of_node<0, B...>
+{
+    typedef mch::kinds_of<B...> type;
+};
+
+namespace mch ///< Mach7 library namespace
+{
+template <>                 struct bindings<node<0>>   { KS(node<0>::m_kind); KV(node<0>,0); static const lbl_type* get_kinds() { return kinds_of_node<0,node<0>,node<0>>::type::get(); } };
+template <size_t I, bool B> struct bindings<node<I,B>> {                      KV(node<0>,I); static const lbl_type* get_kinds() { return kinds_of_node<I,node<I>,node<I>>::type::get(); } };
+} // of namespace mch
+#endif
+
+//------------------------------------------------------------------------------
+
+/// Each instantiation is a separate type switch with its own vtbl map
+template <size_t Site>
+size_t do_match(const node<0>& n)
+{
+    MatchP(n)
+    {
+        #define FOR_EACH_MAX  XTL_GEN_CLASSES-1
+        #define FOR_EACH_N(N) CaseP(node<XTL_GEN_CLASSES-1-N>) return XTL_GEN_CLASSES-1-N;
+        #include "loop_over_numbers.hpp"
+        #undef  FOR_EACH_N
+        #undef  FOR_EACH_MAX
+    }
+    EndMatchP
+    return size_t(-1);
+}
+
+/// Casts from the root to every class go through the same memoized offsets
+size_t do_memoized(const node<0>& n)
+{
+    #define FOR_EACH_MAX  XTL_GEN_CLASSES-1
+    #define FOR_EACH_N(N) if (memoized_cast<const node<XTL_GEN_CLASSES-1-N>*>(&n)) return XTL_GEN_CLASSES-1-N;
+    #include "loop_over_numbers.hpp"
+    #undef  FOR_EACH_N
+    #undef  FOR_EACH_MAX
+    return size_t(-1);
+}
+
+#if XTL_MEMORY_KINDS
+/// Number of classes with their own clause in Match statements on kinds: the
+/// root and the classes directly derived from it.
+#define XTL_MEMORY_CLAUSES (XTL_GEN_FANOUT < XTL_GEN_CLASSES-1 ? XTL_GEN_FANOUT : XTL_GEN_CLASSES-1)
+
+/// Each instantiation is a separate Match statement on kinds with its own map
+/// of kinds to clauses. Deeper classes are dispatched by walking their tag 
+/// precedence list to the class among the root's children they derive from.
+template <size_t Site>
+size_t do_kinds(const node<0>& n)
+{
+    MatchF(n)
+    {
+        #define FOR_EACH_MAX  XTL_MEMORY_CLAUSES
+        #define FOR_EACH_N(N) CaseF(node<N>) return N;
+        #include "loop_over_numbers.hpp"
+        #undef  FOR_EACH_N
+        #undef  FOR_EACH_MAX
+    }
+    EndMatchF
+    return size_t(-1);
+}
+#endif
+
+typedef size_t (*node_function)(const node<0>&);
+
+const node_function match_sites[XTL_MEMORY_SITES] = {
+    #define FOR_EACH_MAX  XTL_MEMORY_SITES-1
+    #define FOR_EACH_N(N) do_match<N>,
+    #include "loop_over_numbers.hpp"
+    #undef  FOR_EACH_N
+    #undef  FOR_EACH_MAX
+};
+
+#if XTL_MEMORY_KINDS
+const node_function kind_sites[XTL_MEMORY_SITES] = {
+    #define FOR_EACH_MAX  XTL_MEMORY_SITES-1
+    #define FOR_EACH_N(N) do_kinds<N>,
+    #include "loop_over_numbers.hpp"
+    #undef  FOR_EACH_N
+    #undef  FOR_EACH_MAX
+};
+#endif
+
+//------------------------------------------------------------------------------
+
+/// Bytes used by dispatch tables of each kind
+struct footprint
+{
+    size_t type_switches; ///< vtbl maps of the type switches
+    size_t casts;         ///< Offsets memoized by memoized_cast
+    size_t kinds;         ///< Tag precedence lists and maps of kinds to clauses
+    size_t total() const { return type_switches + casts + kinds; }
+};
+
+footprint measure()
+{
+    footprint f = { 0, mch::memoized_casts_memory_used(), 0 };
+
+    mch::vtblmap<mch::type_switch_info>::for_each_map([&f](const mch::vtblmap<mch::type_switch_info>& m) { f.type_switches += m.memory_used(); });
+
+#if XTL_MEMORY_KINDS
+    f.kinds = mch::kind_to_clause_maps_memory_used();
+    #define FOR_EACH_MAX  XTL_GEN_CLASSES-1
+    #define FOR_EACH_N(N) f.kinds += mch::kind_to_kinds_memory_used<node<N>>();
+    #include "loop_over_numbers.hpp"
+    #undef  FOR_EACH_N
+    #undef  FOR_EACH_MAX
+#endif
+
+    return f;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+#if XTL_MEMORY_KINDS
+    // Tag precedence lists are only associated with kinds of classes whose 
+    // bindings are instantiated, which clauses alone do not do for all of them.
+    #define FOR_EACH_MAX  XTL_GEN_CLASSES-1
+    #define FOR_EACH_N(N) mch::bindings<node<N>>::get_kinds();
+    #include "loop_over_numbers.hpp"
+    #undef  FOR_EACH_N
+    #undef  FOR_EACH_MAX
+#endif
+
+    std::vector<node<0>*> objects(XTL_GEN_CLASSES);
+
+    for (size_t i = 0; i < objects.size(); ++i)
+        objects[i] = make_node(i);
+
+    const footprint empty = measure();
+
+    std::cout << "Hierarchy: " << XTL_GEN_CLASSES << " classes, fan-out " 
+              << XTL_GEN_FANOUT << ", depth " << mch::node_level(XTL_GEN_CLASSES-1) 
+              << "; " << XTL_MEMORY_SITES << " statements of each kind" << std::endl;
+    std::cout << "Before first use: " << empty.total() << " bytes" << std::endl;
+    std::cout << std::setw(8) << "Classes" << std::setw(16) << "Type switches" 
+              << std::setw(12) << "Casts" << std::setw(12) << "Kinds" 
+              << std::setw(12) << "Total" << std::setw(16) << "Bytes/class" << std::endl;
+
+    // Dynamic types are introduced in quarters of the hierarchy to show how
+    // the footprint grows with the number of dynamic types seen
+    for (size_t q = 1, seen = 0; q <= 4; ++q)
+    {
+        const size_t classes = std::max(size_t(1), XTL_GEN_CLASSES*q/4);
+
+        for (; seen < classes; ++seen)
+            for (size_t r = 0; r < 3; ++r) // Repeated to let the maps settle after updates
+            {
+                const node<0>& n = *objects[seen];
+
+                for (size_t s = 0; s < XTL_MEMORY_SITES; ++s)
+                {
+                    const size_t kind = match_sites[s](n);
+                    XTL_ASSERT(kind == n.m_kind);
+                #if XTL_MEMORY_KINDS
+                    const size_t ancestor = kind_sites[s](n);
+                    XTL_ASSERT(ancestor == mch::node_ancestor(n.m_kind, 1));
+                #endif
+                }
+
+                const size_t kind = do_memoized(n);
+                XTL_ASSERT(kind == n.m_kind);
+            }
+
+        const footprint f = measure();
+
+        std::cout << std::setw(8)  << classes 
+                  << std::setw(16) << f.type_switches 
+                  << std::setw(12) << f.casts 
+                  << std::setw(12) << f.kinds 
+                  << std::setw(12) << f.total() 
+                  << std::setw(16) << (f.total()-empty.total())/classes << std::endl;
+    }
+
+    const footprint f = measure();
+
+    std::cout << "Per statement: type switch " << f.type_switches/XTL_MEMORY_SITES 
+              << " bytes, on kinds " << f.kinds/XTL_MEMORY_SITES << " bytes" << std::endl;
+
+    for (size_t i = 0; i < objects.size(); ++i)
+        delete objects[i];
+
+    if (XTL_MEMORY_BUDGET && f.total() > size_t(XTL_MEMORY_BUDGET))
+    {
+        std::cout << "OVER BUDGET: " << f.total() << " > " << XTL_MEMORY_BUDGET << " bytes" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,310 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Measures how Match statements and memoized_cast scale with the number of 
+/// threads sharing them under #XTL_MULTI_THREADING. For each number of threads
+/// from 1 up to #XTL_MAX_THREADS it reports:
+/// - Cold start: all threads start together on a Match statement (or a target
+///   type of memoized_cast) that has not seen any subject yet, so they all miss
+///   and update the same vtbl map at once. Reported is the time per call of 
+///   the slowest thread.
+/// - Steady state: the same statement once every subject has been seen. 
+///   Reported is the throughput per thread and its ratio to that of 1 thread.
+/// - Cache misses per call in steady state when performance counters are 
+///   available, which is where contention on shared cache lines shows.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_MULTI_THREADING 1 // Use multi-threaded vtbl maps
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "testshape.hpp"
+#include "match.hpp"
+#undef  memoized_cast   // match.hpp makes it dynamic_cast unless Match uses it
+#include "memoized_cast.hpp"
+
+#if !defined(XTL_MAX_THREADS)
+    /// Largest number of threads to measure with, 0 for all CPUs
+    #define XTL_MAX_THREADS 0
+#endif
+
+//------------------------------------------------------------------------------
+
+template <size_t N>
+struct shape_kind : OtherBase, Shape
+{
+    typedef Shape base_class;
+    shape_kind(size_t n = N) : base_class(n) {}
+    void accept(ShapeVisitor&) const {}
+};
+
+//------------------------------------------------------------------------------
+
+/// Distinct Match statements for each number of threads, so each of them starts cold
+template <size_t Site>
+XTL_TIMED_FUNC_BEGIN
+size_t do_match(const Shape& s)
+{
+    MatchP(s)
+    {
+        #define FOR_EACH_MAX  NUMBER_OF_DERIVED-1
+        #define FOR_EACH_N(N) CaseP(shape_kind<N>) return N;
+        #include "loop_over_numbers.hpp"
+        #undef  FOR_EACH_N
+        #undef  FOR_EACH_MAX
+    }
+    EndMatchP
+    return invalid;
+}
+XTL_TIMED_FUNC_END
+
+/// Distinct target types of memoized_cast for each number of threads
+template <size_t Site>
+XTL_TIMED_FUNC_BEGIN
+size_t do_cast(const Shape& s)
+{
+    return memoized_cast<const shape_kind<Site>*>(&s) != 0;
+}
+XTL_TIMED_FUNC_END
+
+//------------------------------------------------------------------------------
+
+Shape* make_shape(size_t i)
+{
+    switch (i % NUMBER_OF_DERIVED)
+    {
+        #define FOR_EACH_MAX  NUMBER_OF_DERIVED-1
+        #define FOR_EACH_N(N) case N: return new shape_kind<N>;
+        #include "loop_over_numbers.hpp"
+        #undef  FOR_EACH_N
+        #undef  FOR_EACH_MAX
+    }
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+typedef size_t (*workload)(const Shape&);
+
+/// Number of different sites, which limits how many thread counts are measured
+const size_t number_of_sites = 10;
+
+const workload match_sites[number_of_sites] = { do_match<0>, do_match<1>, do_match<2>, do_match<3>, do_match<4>, do_match<5>, do_match<6>, do_match<7>, do_match<8>, do_match<9> };
+const workload cast_sites [number_of_sites] = { do_cast<0>,  do_cast<1>,  do_cast<2>,  do_cast<3>,  do_cast<4>,  do_cast<5>,  do_cast<6>,  do_cast<7>,  do_cast<8>,  do_cast<9>  };
+
+/// Number of passes over all subjects in steady state
+const size_t steady_passes = 20;
+
+//------------------------------------------------------------------------------
+
+/// Threads inherit affinity of the timing thread, which is pinned to one CPU
+/// \see #XTL_TIMING_PIN_CPU. Spread them instead.
+inline void pin_to_cpu(size_t cpu)
+{
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(int(cpu % CPU_SETSIZE), &set);
+    sched_setaffinity(0, sizeof(set), &set);
+#else
+    XTL_UNUSED(cpu);
+#endif
+}
+
+//------------------------------------------------------------------------------
+
+/// What a thread measured
+struct thread_result
+{
+    double cold_ns;      ///< Nanoseconds of the first pass over subjects
+    double steady_ns;    ///< Nanoseconds of all the passes in steady state
+    double cache_misses; ///< Cache misses in steady state, negative if unknown
+    size_t checksum;     ///< Sum of results to keep calls from being optimized away
+};
+
+inline double elapsed_ns(std::chrono::steady_clock::time_point start)
+{
+    return double(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+//------------------------------------------------------------------------------
+
+void worker(
+        size_t                     t, 
+        workload                   f, 
+        const std::vector<Shape*>& shapes, 
+        std::atomic<size_t>&       ready, 
+        std::atomic<bool>&         go, 
+        thread_result&             result
+    )
+{
+    const size_t n = shapes.size();
+    size_t a = 0;
+    pin_to_cpu(t);
+
+#if defined(XTL_TIMING_METHOD_5)
+    mch::perf_counter misses(PERF_COUNT_HW_CACHE_MISSES); // Counts this thread only
+#endif
+
+    ++ready;
+    while (!go.load(std::memory_order_acquire)) {} // All threads start at once
+
+    // Every thread walks subjects from its own position, so they discover
+    // the same dynamic types in different order
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < n; ++i)
+        a += f(*shapes[(i + t*n/7) % n]);
+
+    result.cold_ns = elapsed_ns(start);
+
+#if defined(XTL_TIMING_METHOD_5)
+    uint64_t m0 = misses.read();
+#endif
+
+    start = std::chrono::steady_clock::now();
+
+    for (size_t r = 0; r < steady_passes; ++r)
+        for (size_t i = 0; i < n; ++i)
+            a += f(*shapes[(i + t*n/7) % n]);
+
+    result.steady_ns = elapsed_ns(start);
+
+#if defined(XTL_TIMING_METHOD_5)
+    result.cache_misses = misses.available() ? double(misses.read() - m0) : -1.0;
+#else
+    result.cache_misses = -1.0;
+#endif
+    result.checksum = a;
+}
+
+//------------------------------------------------------------------------------
+
+/// Measures workload f on T threads and prints a line of results
+/// \returns Throughput per thread in calls per microsecond
+double measure(const char* name, workload f, size_t T, const std::vector<Shape*>& shapes, double base_throughput)
+{
+    std::vector<thread_result> results(T);
+    std::vector<std::thread>   threads;
+    std::atomic<size_t>        ready(0);
+    std::atomic<bool>          go(false);
+
+    for (size_t t = 0; t < T; ++t)
+        threads.push_back(std::thread(worker, t, f, std::cref(shapes), std::ref(ready), std::ref(go), std::ref(results[t])));
+
+    while (ready.load() != T) {}
+    go.store(true, std::memory_order_release);
+
+    for (size_t t = 0; t < T; ++t)
+        threads[t].join();
+
+    const double calls  = double(shapes.size());
+    double cold = 0, steady = 0, misses = 0;
+    bool   known = true;
+
+    for (size_t t = 0; t < T; ++t)
+    {
+        cold    = std::max(cold, results[t].cold_ns/calls);
+        steady += calls*steady_passes*1000/results[t].steady_ns/T; // Mean calls per microsecond
+        misses += results[t].cache_misses/(calls*steady_passes)/T;
+        known   = known && results[t].cache_misses >= 0;
+    }
+
+    std::cout << std::setw(8)  << name 
+              << std::setw(8)  << T
+              << std::setw(14) << std::fixed << std::setprecision(1) << cold
+              << std::setw(16) << steady
+              << std::setw(10) << std::setprecision(2) << (base_throughput > 0 ? steady/base_throughput : 1.0);
+
+    if (known)
+        std::cout << std::setw(14) << std::setprecision(3) << misses;
+    else
+        std::cout << std::setw(14) << "n/a";
+
+    std::cout << std::endl;
+    return steady;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    const size_t cpus = std::max(1u, std::thread::hardware_concurrency());
+    const size_t max_threads = XTL_MAX_THREADS ? XTL_MAX_THREADS : cpus;
+    std::vector<size_t> counts;
+
+    for (size_t T = 1; T < max_threads && counts.size() < number_of_sites-1; T *= 2)
+        counts.push_back(T);
+
+    counts.push_back(max_threads);
+
+    std::vector<Shape*> shapes(mch::N);
+
+    for (size_t i = 0; i < shapes.size(); ++i)
+        shapes[i] = make_shape(rand());
+
+    std::cout << "Subjects: " << shapes.size() << " of " << NUMBER_OF_DERIVED << " types; CPUs: " << cpus << std::endl
+              << "Workload Threads  Cold ns/call  Calls/us/thread  Scaling  Misses/call" << std::endl;
+
+    double base = 0;
+
+    for (size_t i = 0; i < counts.size(); ++i)
+    {
+        double throughput = measure("Match", match_sites[i], counts[i], shapes, base);
+        if (i == 0) base = throughput;
+    }
+
+    base = 0;
+
+    for (size_t i = 0; i < counts.size(); ++i)
+    {
+        double throughput = measure("Cast", cast_sites[i], counts[i], shapes, base);
+        if (i == 0) base = throughput;
+    }
+
+    for (size_t i = 0; i < shapes.size(); ++i)
+        delete shapes[i];
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,147 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Same as synthetic_select.cpp, but with the function form of Match from
+/// match_function.hpp instead of the macros.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include "testshape.hpp"
+#include "match_function.hpp"
+
+//------------------------------------------------------------------------------
+
+template <size_t N>
+struct shape_kind : OtherBase, Shape
+{
+    typedef Shape base_class;
+    shape_kind(size_t n = N) : base_class(n) {}
+    void accept(ShapeVisitor&) const;
+};
+
+//------------------------------------------------------------------------------
+
+struct ShapeVisitor
+{
+    #define FOR_EACH_MAX NUMBER_OF_DERIVED-1
+    #define FOR_EACH_N(N) virtual void visit(const shape_kind<N>&) {}
+    #include "loop_over_numbers.hpp"
+    #undef  FOR_EACH_N
+    #undef  FOR_EACH_MAX
+};
+
+//------------------------------------------------------------------------------
+
+template <size_t N> void shape_kind<N>::accept(ShapeVisitor& v) const { v.visit(*this); }
+
+XTL_TIMED_FUNC_BEGIN
+size_t do_match(const Shape& s, size_t)
+{
+    return mch::match(s,
+        #define FOR_EACH_MAX  NUMBER_OF_DERIVED-1
+        #define FOR_EACH_N(N) mch::case_<shape_kind<N>>([](const shape_kind<N>&) { return size_t(N); }),
+        #include "loop_over_numbers.hpp"
+        #undef  FOR_EACH_N
+        #undef  FOR_EACH_MAX
+        mch::otherwise([](const Shape&) { return size_t(invalid); })
+    );
+}
+XTL_TIMED_FUNC_END
+
+//------------------------------------------------------------------------------
+
+XTL_TIMED_FUNC_BEGIN
+size_t do_visit(const Shape& s, size_t)
+{
+    struct Visitor : ShapeVisitor
+    {
+        #define FOR_EACH_MAX  NUMBER_OF_DERIVED-1
+        #define FOR_EACH_N(N) virtual void visit(const shape_kind<N>&) { result = N; }
+        #include "loop_over_numbers.hpp"
+        #undef  FOR_EACH_N
+        #undef  FOR_EACH_MAX
+        size_t result;
+    };
+
+    Visitor v;
+    v.result = invalid;
+    s.accept(v);
+    return v.result;
+}
+XTL_TIMED_FUNC_END
+
+//------------------------------------------------------------------------------
+
+Shape* make_shape(size_t i)
+{
+    switch (i % NUMBER_OF_DERIVED)
+    {
+        #define FOR_EACH_MAX  NUMBER_OF_DERIVED-1
+        #define FOR_EACH_N(N) case N: return new shape_kind<N>;
+        #include "loop_over_numbers.hpp"
+        #undef  FOR_EACH_N
+        #undef  FOR_EACH_MAX
+    }
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+#include "testvismat1.hpp"    // Utilities for timing tests
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    using namespace mch; // Mach7's library namespace
+
+    verdict pp = test_repetitive();
+//    verdict ps = test_sequential();
+    verdict pr = test_randomized();
+    std::cout << "OVERALL: "
+              << "Repetitive: " << pp << "; "
+//              << "Sequential: " << ps << "; "
+              << "Random: "     << pr 
+              << std::endl; 
+}
+
+//------------------------------------------------------------------------------
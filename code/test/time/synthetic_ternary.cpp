@@ -0,0 +1,195 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Compares memory used and lookup time of vtbl maps with the default policy,
+/// #mch::vtbl_matrix_policy and #mch::vtbl_curried_policy on a sparse ternary
+/// dispatch table: each class in the first position meets only a few pairs 
+/// of classes in the other two, as in ternary multi-methods of which only 
+/// few combinations are ever called.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include "vtblcurried.hpp"
+#include "vtblmatrix.hpp"
+#include "rnd.hpp"
+#include "timing.hpp"
+
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+//------------------------------------------------------------------------------
+
+/// Number of classes in the hierarchy
+const size_t classes_num = 40;
+
+/// Number of pairs of classes each class in the first position meets
+const size_t pairs_num = 3;
+
+/// Number of tuples looked up by each run, large enough to hide timer overhead
+const size_t tuples_num = 1 << 16;
+
+/// Number of runs of each policy, of which the fastest is reported
+const size_t runs = 31;
+
+//------------------------------------------------------------------------------
+
+struct Node
+{
+    virtual ~Node() {}
+    virtual int kind() const = 0;
+};
+
+template <int N>
+struct Leaf : Node
+{
+    int kind() const { return N; }
+};
+
+//------------------------------------------------------------------------------
+
+/// Tuple of subjects of a ternary dispatch
+struct triple
+{
+    const Node* a;
+    const Node* b;
+    const Node* c;
+};
+
+/// Value all policies should associate with the dynamic types of t
+inline int expected(const triple& t) { return (t.a->kind()*int(classes_num) + t.b->kind())*int(classes_num) + t.c->kind(); }
+
+//------------------------------------------------------------------------------
+
+/// Returns the fastest of several runs of f in nanoseconds per tuple
+template <typename F>
+double fastest(F f)
+{
+    double best = 0.0;
+
+    for (size_t r = 0; r < runs; ++r)
+    {
+        mch::time_stamp start = mch::get_time_stamp();
+        f();
+        mch::time_stamp finish = mch::get_time_stamp();
+        double ns = (finish - start) * 1e9 / mch::get_frequency() / tuples_num;
+
+        if (r == 0 || ns < best)
+            best = ns;
+    }
+
+    return best;
+}
+
+//------------------------------------------------------------------------------
+
+/// Populates a vtbl map of policy P with the tuples, times lookups of them 
+/// and reports the time and the memory used. Asserts that lookups find the
+/// values stored for the tuples.
+template <typename P>
+void measure(const char* name, const std::vector<triple>& tuples)
+{
+    static const mch::vtbl_count_t clauses = mch::vtbl_count_t(classes_num*pairs_num);
+    mch::vtbl_map<3,int,P> map(clauses);
+
+    for (size_t i = 0; i < tuples.size(); ++i)
+        map.get(tuples[i].a, tuples[i].b, tuples[i].c) = expected(tuples[i]);
+
+    long long sum = 0;
+    double    ns  = fastest([&]{ sum = 0; for (size_t i = 0; i < tuples.size(); ++i) sum += map.get(tuples[i].a, tuples[i].b, tuples[i].c); });
+    long long exp = 0;
+
+    for (size_t i = 0; i < tuples.size(); ++i)
+        exp += expected(tuples[i]);
+
+    std::cout << std::setw(8) << name << ": " << std::fixed << std::setprecision(2) << ns << "ns "
+              << std::setw(8) << map.memory_used() << " bytes" << std::endl;
+
+    XTL_ASSERT(sum == exp);
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    typedef Node* (*factory)();
+    #define XTL_FACTORIES(i,...) []() -> Node* { return new Leaf<i>; }, []() -> Node* { return new Leaf<i+10>; }, \
+                                 []() -> Node* { return new Leaf<i+20>; }, []() -> Node* { return new Leaf<i+30>; },
+    const factory make[] = { XTL_REPEAT(10,XTL_FACTORIES) };
+    static_assert(XTL_ARR_SIZE(make) == classes_num, "One factory per class");
+
+    std::vector<Node*> nodes(classes_num);
+
+    for (size_t i = 0; i < classes_num; ++i)
+        nodes[i] = make[i]();
+
+    std::mt19937 engine(XTL_RND_SEED);
+    std::uniform_int_distribution<size_t> kind(0, classes_num-1);
+    std::uniform_int_distribution<size_t> pair(0, pairs_num-1);
+
+    // The pairs each class in the first position meets
+    std::vector<triple> combinations;
+
+    for (size_t i = 0; i < classes_num; ++i)
+        for (size_t j = 0; j < pairs_num; ++j)
+        {
+            triple t = { nodes[i], nodes[kind(engine)], nodes[kind(engine)] };
+            combinations.push_back(t);
+        }
+
+    std::vector<triple> tuples(tuples_num);
+
+    for (size_t i = 0; i < tuples_num; ++i)
+        tuples[i] = combinations[kind(engine)*pairs_num + pair(engine)];
+
+    std::cout << combinations.size() << " combinations of " << classes_num*classes_num*classes_num << std::endl;
+
+    measure<mch::vtbl_map_policy<> >("default", tuples);
+    measure<mch::vtbl_matrix_policy>("matrix",  tuples); // Does not count its caches of class indices
+    measure<mch::vtbl_curried_policy<> >("curried", tuples);
+
+    for (size_t i = 0; i < classes_num; ++i)
+        delete nodes[i];
+}
+
+//------------------------------------------------------------------------------
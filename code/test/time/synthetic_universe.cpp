@@ -0,0 +1,153 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Measures how vtblmap<T> of memoized_cast and MatchP scales to programs with
+/// up to 10^5 polymorphic classes, e.g. rule engines with generated plugin 
+/// hierarchies: the time it takes to learn all the vtbl pointers, the time of
+/// lookups in random order and the memory used. Generating that many classes 
+/// is impractical, so objects are words holding addresses laid out the way a
+/// linker places vtbls of different sizes one after another. Maps never 
+/// dereference them.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include "vtblmap3st.hpp"
+#include "rnd.hpp"
+#include "timing.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+//------------------------------------------------------------------------------
+
+/// Number of lookups timed by each run, large enough to hide timer overhead
+const size_t lookups_num = 1 << 20;
+
+/// Number of runs of lookups, of which the fastest is reported
+const size_t runs = 11;
+
+//------------------------------------------------------------------------------
+
+/// Seconds between two time stamps
+inline double seconds(mch::time_stamp start, mch::time_stamp finish)
+{
+    return double(finish - start) / mch::get_frequency();
+}
+
+//------------------------------------------------------------------------------
+
+/// Learns n vtbl pointers, times lookups of them and reports the times and 
+/// the memory used. Asserts that lookups find the values learned.
+void measure(size_t n, std::mt19937& engine)
+{
+    // Vtbls of 2 to 32 virtual functions plus offset-to-top and RTTI pointers
+    std::uniform_int_distribution<size_t> functions(2, 32);
+    std::vector<intptr_t> objects(n); // Each object is just its vtbl pointer
+    intptr_t address = 0x400000;
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        objects[i] = address + 2*sizeof(void*);
+        address += (2 + functions(engine))*sizeof(void*);
+    }
+
+    std::shuffle(objects.begin(), objects.end(), engine);
+
+    mch::vtblmap<size_t> map;
+
+    mch::time_stamp start = mch::get_time_stamp();
+
+    for (size_t i = 0; i < n; ++i)
+        map.get(&objects[i]) = i+1;
+
+    mch::time_stamp finish = mch::get_time_stamp();
+    const double learning = seconds(start, finish);
+
+    std::uniform_int_distribution<size_t> pick(0, n-1);
+    std::vector<size_t> order(lookups_num);
+
+    for (size_t i = 0; i < lookups_num; ++i)
+        order[i] = pick(engine);
+
+    double best = 0.0;
+
+    for (size_t r = 0; r < runs; ++r)
+    {
+        size_t sum = 0;
+        start = mch::get_time_stamp();
+
+        for (size_t i = 0; i < lookups_num; ++i)
+            sum += map.get(&objects[order[i]]);
+
+        finish = mch::get_time_stamp();
+        const double ns = seconds(start, finish) * 1e9 / lookups_num;
+
+        if (r == 0 || ns < best)
+            best = ns;
+
+        size_t expected = 0;
+
+        for (size_t i = 0; i < lookups_num; ++i)
+            expected += order[i]+1;
+
+        XTL_ASSERT(sum == expected);
+    }
+
+    std::cout << std::setw(7) << n << " classes: learned in " << std::fixed << std::setprecision(3) << learning << "s "
+              << std::setprecision(2) << std::setw(6) << best << "ns per lookup "
+              << std::setw(9) << map.memory_used() << " bytes" << std::endl;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    std::mt19937 engine(XTL_RND_SEED);
+
+    for (size_t n = 1000; n <= 100000; n *= 10)
+        measure(n, engine);
+}
+
+//------------------------------------------------------------------------------
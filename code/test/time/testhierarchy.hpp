@@ -0,0 +1,241 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Generates a class hierarchy node<0>..node<XTL_GEN_CLASSES-1> for benchmarks
+/// that should resemble real ones more than flat hierarchies of testshape.hpp.
+/// Classes form a tree numbered in breadth-first order, with:
+/// - #XTL_GEN_FANOUT derived classes per class;
+/// - at most #XTL_GEN_DEPTH levels below the root, after which classes attach
+///   to the deepest allowed level;
+/// - every #XTL_GEN_MULTIPLE-th class having a second base class. It is an 
+///   unrelated mixin placed first, so the root is at a non-zero offset in it, 
+///   or, under #XTL_GEN_VIRTUAL, the preceding class, forming a diamond.
+/// Since bases always precede derived classes, a class with a higher number
+/// is never a base of a class with a lower one.
+///
+/// Dynamic types of objects are drawn by make_zipf_nodes() from a Zipf 
+/// distribution, as dynamic types of real programs tend to follow one.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "rnd.hpp"
+#include "testutils.hpp"
+
+//------------------------------------------------------------------------------
+
+#if !defined(XTL_GEN_CLASSES)
+    /// Number of classes in the hierarchy, at most 100 \see loop_over_numbers.hpp
+    #define XTL_GEN_CLASSES 64
+#endif
+
+#if !defined(XTL_GEN_FANOUT)
+    /// Number of classes directly derived from each class
+    #define XTL_GEN_FANOUT 3
+#endif
+
+#if !defined(XTL_GEN_DEPTH)
+    /// Largest number of levels of classes below the root
+    #define XTL_GEN_DEPTH 5
+#endif
+
+#if !defined(XTL_GEN_MULTIPLE)
+    /// Every this many classes has a second base class, 0 for none
+    #define XTL_GEN_MULTIPLE 4
+#endif
+
+#if !defined(XTL_GEN_VIRTUAL)
+    /// Whether classes derive from their bases virtually
+    #define XTL_GEN_VIRTUAL 0
+#endif
+
+#if !defined(XTL_ZIPF_EXPONENT)
+    /// Exponent s of the Zipf distribution of dynamic types: the k-th most
+    /// frequent type occurs with probability proportional to 1/k^s
+    #define XTL_ZIPF_EXPONENT 1.0
+#endif
+
+static_assert(XTL_GEN_CLASSES >= 1 && XTL_GEN_CLASSES <= 100, "XTL_GEN_CLASSES has to be within 1..100");
+static_assert(XTL_GEN_FANOUT  >= 1, "XTL_GEN_FANOUT has to be positive");
+static_assert(XTL_GEN_DEPTH   >= 1, "XTL_GEN_DEPTH has to be positive");
+
+#if XTL_GEN_VIRTUAL
+    #define XTL_GEN_INHERIT virtual public
+#else
+    #define XTL_GEN_INHERIT public
+#endif
+
+//------------------------------------------------------------------------------
+
+namespace mch ///< Mach7 library namespace
+{
+
+/// Level of class i in the tree of classes, root being at level 0
+constexpr size_t node_level(size_t i) { return i == 0 ? 0 : 1 + node_level((i-1)/XTL_GEN_FANOUT); }
+
+/// Ancestor of class i on the given level or i itself when it is higher
+constexpr size_t node_ancestor(size_t i, size_t level) { return node_level(i) <= level ? i : node_ancestor((i-1)/XTL_GEN_FANOUT, level); }
+
+/// Base class of class i > 0 in the tree
+constexpr size_t node_parent(size_t i) { return node_ancestor((i-1)/XTL_GEN_FANOUT, XTL_GEN_DEPTH-1); }
+
+/// Whether class i has a second base class
+constexpr bool node_has_second_base(size_t i) { return XTL_GEN_MULTIPLE && i >= 2 && i % (XTL_GEN_MULTIPLE ? XTL_GEN_MULTIPLE : 1) == 0 && i-1 != node_parent(i); }
+
+} // of namespace mch
+
+//------------------------------------------------------------------------------
+
+struct node_visitor;
+
+/// Class number I of the hierarchy, the second parameter tells whether it
+/// has a second base class
+template <size_t I, bool = mch::node_has_second_base(I)> struct node;
+
+/// Root of the hierarchy
+template <>
+struct node<0>
+{
+    node() : m_kind(0) {}
+    virtual ~node() {}
+    virtual void accept(node_visitor&) const;
+    size_t m_kind; ///< Number of the most derived class, set by make_node
+};
+
+/// Unrelated polymorphic base of classes with multiple inheritance
+template <size_t I>
+struct mixin
+{
+    mixin() : m_mixin(I) {}
+    virtual ~mixin() {}
+    size_t m_mixin;
+};
+
+template <size_t I, bool>
+struct node : XTL_GEN_INHERIT node<mch::node_parent(I)>
+{
+    void accept(node_visitor&) const;
+};
+
+template <size_t I>
+#if XTL_GEN_VIRTUAL
+struct node<I,true> : virtual public node<mch::node_parent(I)>, virtual public node<I-1>
+#else
+struct node<I,true> : mixin<I>, node<mch::node_parent(I)>
+#endif
+{
+    void accept(node_visitor&) const;
+};
+
+//------------------------------------------------------------------------------
+
+struct node_visitor
+{
+    virtual ~node_visitor() {}
+    #define FOR_EACH_MAX  XTL_GEN_CLASSES-1
+    #define FOR_EACH_N(N) virtual void visit(const node<N>&) {}
+    #include "loop_over_numbers.hpp"
+    #undef  FOR_EACH_N
+    #undef  FOR_EACH_MAX
+};
+
+inline                      void node<0>::accept(node_visitor& v)      const { v.visit(*this); }
+template <size_t I, bool B> void node<I,B>::accept(node_visitor& v)    const { v.visit(*this); }
+template <size_t I>         void node<I,true>::accept(node_visitor& v) const { v.visit(*this); }
+
+//------------------------------------------------------------------------------
+
+/// Makes an object of class number i
+inline node<0>* make_node(size_t i)
+{
+    node<0>* result = 0;
+
+    switch (i % XTL_GEN_CLASSES)
+    {
+        #define FOR_EACH_MAX  XTL_GEN_CLASSES-1
+        #define FOR_EACH_N(N) case N: result = new node<N>; break;
+        #include "loop_over_numbers.hpp"
+        #undef  FOR_EACH_N
+        #undef  FOR_EACH_MAX
+    }
+
+    result->m_kind = i % XTL_GEN_CLASSES;
+    return result;
+}
+
+//------------------------------------------------------------------------------
+
+namespace mch ///< Mach7 library namespace
+{
+
+/// Makes n objects with dynamic types drawn from a Zipf distribution. Which 
+/// classes are more frequent is a random permutation, so that frequency does
+/// not follow the depth of classes in the hierarchy.
+inline std::vector<node<0>*> make_zipf_nodes(size_t n, unsigned int seed = XTL_RND_SEED)
+{
+    std::mt19937        engine(seed);
+    std::vector<size_t> ranks(XTL_GEN_CLASSES);
+    std::vector<double> weights(XTL_GEN_CLASSES);
+
+    for (size_t k = 0; k < ranks.size(); ++k)
+    {
+        ranks[k]   = k;
+        weights[k] = 1.0/std::pow(double(k+1), XTL_ZIPF_EXPONENT);
+    }
+
+    std::shuffle(ranks.begin(), ranks.end(), engine);
+
+    std::discrete_distribution<size_t> zipf(weights.begin(), weights.end());
+    std::vector<node<0>*> result(n);
+
+    for (size_t i = 0; i < n; ++i)
+        result[i] = make_node(ranks[zipf(engine)]);
+
+    return result;
+}
+
+} // of namespace mch
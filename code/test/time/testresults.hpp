@@ -0,0 +1,123 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Reading of the results that benchmarks record in #XTL_RESULTS_FILE, shared
+/// by compare_results.cpp and recommend_config.cpp.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#pragma once
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------
+
+/// Experiments of one test in one run
+struct test_results
+{
+    std::vector<double> medians;
+    std::vector<double> deviations;
+    std::string         unit;
+    std::string         compiler;
+    std::string         config;
+};
+
+//------------------------------------------------------------------------------
+
+/// Raw text of the value of the given key in a line of JSON written by record_result
+inline std::string field(const std::string& line, const std::string& key)
+{
+    std::string::size_type p = line.find("\"" + key + "\":");
+
+    if (p == std::string::npos)
+        return std::string();
+
+    p += key.size() + 3;
+
+    if (line[p] == '"')
+        return line.substr(p+1, line.find('"', p+1)-p-1);
+
+    if (line[p] == '{')
+        return line.substr(p, line.find('}', p)-p+1);
+
+    return line.substr(p, line.find_first_of(",}", p)-p);
+}
+
+//------------------------------------------------------------------------------
+
+/// Macro definitions of the configuration object recorded by record_result
+inline std::map<std::string,std::string> macros(const std::string& config)
+{
+    std::map<std::string,std::string> result;
+    std::string::size_type p = 0;
+
+    while ((p = config.find('"', p)) != std::string::npos)
+    {
+        std::string::size_type q = config.find('"', p+1);   // End of name
+        std::string::size_type r = config.find('"', q+1);   // Start of value
+        std::string::size_type s = r;                       // End of value
+
+        while ((s = config.find('"', s+1)) != std::string::npos && config[s-1] == '\\')
+            ;
+
+        if (q == std::string::npos || r == std::string::npos || s == std::string::npos)
+            break;
+
+        result[config.substr(p+1, q-p-1)] = config.substr(r+1, s-r-1);
+        p = s+1;
+    }
+
+    return result;
+}
+
+//------------------------------------------------------------------------------
+
+inline double median(std::vector<double> v)
+{
+    std::sort(v.begin(), v.end());
+    return v.empty() ? 0.0 : v[v.size()/2];
+}
+
+//------------------------------------------------------------------------------
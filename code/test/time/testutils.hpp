@@ -48,11 +48,13 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstdlib>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <iterator>
 #include <numeric>
+#include <sstream>
 #include <string>
 #include <typeinfo>
 #include <vector>
@@ -62,6 +64,15 @@
 
 #define NO_RANDOMIZATION
 
+#if defined(XTL_LAYOUT_PADDING) && defined(__GNUC__) && defined(__ELF__)
+    // Shifts code, constants and virtual tables of the benchmark by the given
+    // number of bytes, so that make variance can measure how much its timings
+    // depend on their layout rather than on the library.
+    __asm__(".pushsection .text\n"         ".skip " XTL_STRING_LITERAL(XTL_LAYOUT_PADDING) "\n.popsection\n"
+            ".pushsection .rodata\n"       ".skip " XTL_STRING_LITERAL(XTL_LAYOUT_PADDING) "\n.popsection\n"
+            ".pushsection .data.rel.ro\n"  ".skip " XTL_STRING_LITERAL(XTL_LAYOUT_PADDING) "\n.popsection");
+#endif
+
 #if defined(_MSC_VER)
     // Visual C++ 2010 and 2012 don't seem to provide implementation of std::cbrt
     namespace std
@@ -83,6 +94,33 @@ namespace mch ///< Mach7 library namespace
     XTL_MESSAGE("Timing method 2: based on rdtsc register")
 #elif defined(XTL_TIMING_METHOD_3)
     XTL_MESSAGE("Timing method 3: based on clock()")
+#elif defined(XTL_TIMING_METHOD_4)
+    XTL_MESSAGE("Timing method 4: based on std::chrono::steady_clock")
+#elif defined(XTL_TIMING_METHOD_5)
+    XTL_MESSAGE("Timing method 5: based on performance counters of Linux")
+#endif
+
+//------------------------------------------------------------------------------
+
+#if !defined(XTL_TIMING_WARMUP)
+    /// Number of first measurements of each experiment that are discarded as 
+    /// warm-up of caches, branch predictors and vtbl maps
+    #define XTL_TIMING_WARMUP 1
+#endif
+
+#if !defined(XTL_TIMING_OUTLIERS)
+    /// Measurements farther than this many median absolute deviations from 
+    /// the median are discarded as outliers, e.g. caused by interrupts. 0 keeps
+    /// all the measurements.
+    #define XTL_TIMING_OUTLIERS 5
+#endif
+
+#if !defined(XTL_HARDWARE_COUNTERS)
+    /// Whether get_timings1..4 count instructions, L1D, LLC and dTLB misses and
+    /// branch mispredictions of both timed loops and print them per iteration 
+    /// next to timings. Requires #XTL_TIMING_METHOD_5 and prints n/a for 
+    /// counters the CPU or virtual machine does not provide.
+    #define XTL_HARDWARE_COUNTERS 0
 #endif
 
 //------------------------------------------------------------------------------
@@ -167,9 +205,44 @@ inline typename Container::value_type deviation(const Container& c)
 
 //------------------------------------------------------------------------------
 
+/// Removes warm-up measurements from the front and outliers among the rest
+/// \see #XTL_TIMING_WARMUP \see #XTL_TIMING_OUTLIERS
+template <typename T>
+inline void reject_outliers(std::vector<T>& measurements)
+{
+    if (measurements.size() > XTL_TIMING_WARMUP)
+        measurements.erase(measurements.begin(), measurements.begin() + XTL_TIMING_WARMUP);
+
+    if (!XTL_TIMING_OUTLIERS || measurements.size() < 3)
+        return;
+
+    std::sort(measurements.begin(), measurements.end());
+    const T med = measurements[measurements.size()/2];
+    std::vector<T> deviations;
+
+    for (typename std::vector<T>::const_iterator p = measurements.begin(); p != measurements.end(); ++p)
+        deviations.push_back(*p < med ? med - *p : *p - med);
+
+    std::sort(deviations.begin(), deviations.end());
+    const T mad = deviations[deviations.size()/2];
+
+    if (mad > 0)
+        measurements.erase(
+            std::remove_if(
+                measurements.begin(), 
+                measurements.end(), 
+                [med,mad](const T& t) { return (t < med ? med - t : t - med) > XTL_TIMING_OUTLIERS*mad; }
+            ),
+            measurements.end()
+        );
+}
+
+//------------------------------------------------------------------------------
+
 template <typename T>
 inline void statistics(std::vector<T>& measurements, T& min, T& max, T& avg, T& med, T& dev)
 {
+    reject_outliers(measurements);
     std::sort(measurements.begin(), measurements.end());
     min = measurements.front();
     max = measurements.back();
@@ -180,11 +253,241 @@ inline void statistics(std::vector<T>& measurements, T& min, T& max, T& avg, T&
 
 //------------------------------------------------------------------------------
 
-inline long long display(const char* name, std::vector<long long>& timings, size_t N)
+/// Histogram of latencies of individual calls in the style of HdrHistogram:
+/// values are counted in buckets of powers of 2, each split into 2^precision
+/// linear sub-buckets, so that any value is recorded with relative error below
+/// 2^-precision at a fixed memory cost regardless of its magnitude. Unlike 
+/// statistics of batches of calls, it keeps the tail of the distribution.
+/// \see http://hdrhistogram.org
+class latency_histogram
+{
+public:
+
+    enum { precision = 7, sub_buckets = 1 << precision };
+
+    latency_histogram() : counts((64-precision+2)*sub_buckets), total(0), largest(0) {}
+
+    void record(unsigned long long value)
+    {
+        ++counts[index(value)];
+        ++total;
+        largest = (std::max)(largest, value);
+    }
+
+    latency_histogram& operator+=(const latency_histogram& other)
+    {
+        for (size_t i = 0; i < counts.size(); ++i)
+            counts[i] += other.counts[i];
+
+        total  += other.total;
+        largest = (std::max)(largest, other.largest);
+        return *this;
+    }
+
+    unsigned long long count() const { return total; }
+    unsigned long long max()   const { return largest; }
+
+    /// Smallest recorded value, up to precision, at or below which are the given percent of values
+    unsigned long long percentile(double percent) const
+    {
+        const unsigned long long rank = (std::max)(1ULL, (unsigned long long)std::ceil(percent*total/100));
+        unsigned long long seen = 0;
+
+        for (size_t i = 0; i < counts.size(); ++i)
+            if ((seen += counts[i]) >= rank)
+                return (std::min)(highest_equivalent(i), largest);
+
+        return largest;
+    }
+
+    /// Prints p50, p99, p99.9 and max on a single line
+    void display(const char* name, std::ostream& os = std::cout) const
+    {
+        os << name << " Latency: [p50=" << std::setw(5) << percentile(50)
+                   << " p99="  << std::setw(6) << percentile(99)
+                   << " p99.9="<< std::setw(7) << percentile(99.9)
+                   << " max="  << std::setw(8) << max()
+                   << "] of "  << count() << " calls" << std::endl;
+    }
+
+    /// Writes percentile distribution in the .hgrm format of HdrHistogram that
+    /// its plotter accepts
+    void write_percentiles(std::ostream& os) const
+    {
+        os << std::setw(12) << "Value" << ' ' << std::setw(14) << "Percentile" << ' ' 
+           << std::setw(10) << "TotalCount" << ' ' << std::setw(14) << "1/(1-Percentile)" << std::endl << std::endl;
+
+        std::ios_base::fmtflags fmt = os.flags();
+        unsigned long long seen = 0;
+        os << std::fixed;
+
+        for (size_t i = 0; i < counts.size(); ++i)
+            if (counts[i])
+            {
+                const double fraction = double(seen += counts[i])/total;
+                os << std::setw(12) << std::setprecision(3) << double((std::min)(highest_equivalent(i), largest))
+                   << ' '       << std::setprecision(12) << fraction
+                   << ' '       << std::setw(10) << seen;
+
+                if (fraction < 1.0)
+                    os << ' ' << std::setw(14) << std::setprecision(2) << 1.0/(1.0-fraction);
+
+                os << std::endl;
+            }
+
+        os.flags(fmt);
+        os << "#[Max     = " << largest << ", Total count    = " << total << "]" << std::endl;
+    }
+
+private:
+
+    /// Bucket k > 0 holds values [2^(k+p), 2^(k+p+1)) in sub-buckets of 2^k values,
+    /// while bucket 0 holds values [0, 2^(p+1)) exactly
+    static size_t index(unsigned long long value)
+    {
+        size_t shift = 0;
+
+        while ((value >> shift) >= 2*sub_buckets)
+            ++shift;
+
+        return shift*sub_buckets + size_t(value >> shift);
+    }
+
+    /// Largest value that falls into the same sub-bucket as values of index i
+    static unsigned long long highest_equivalent(size_t i)
+    {
+        if (i < 2*sub_buckets)
+            return i;
+
+        const size_t shift = i/sub_buckets - 1;
+        return ((unsigned long long)(i - shift*sub_buckets + 1) << shift) - 1;
+    }
+
+    std::vector<unsigned long long> counts;
+    unsigned long long total;
+    unsigned long long largest;
+};
+
+//------------------------------------------------------------------------------
+
+#if !defined(XTL_RESULTS_FILE)
+    /// File to which every experiment appends its statistics as a line of JSON,
+    /// for compare_results.cpp to compare two runs. Empty string disables it.
+    #define XTL_RESULTS_FILE "results.jsonl"
+#endif
+
+#if !defined(XTL_BENCHMARK_NAME)
+    #if defined(__BASE_FILE__)
+        /// Name of the benchmark recorded with its results
+        #define XTL_BENCHMARK_NAME __BASE_FILE__
+    #else
+        #define XTL_BENCHMARK_NAME "unknown"
+    #endif
+#endif
+
+/// Appends statistics of an experiment to #XTL_RESULTS_FILE. The layout in
+/// which the benchmark ran is taken from environment variable XTL_LAYOUT, set
+/// by make variance, \see variance_report.cpp
+inline void record_result(const char* name, size_t N, long long min, long long max, long long avg, long long med, long long dev);
+
+//------------------------------------------------------------------------------
+
+/// Hardware events accumulated over timed loops \see #XTL_HARDWARE_COUNTERS
+struct hardware_events
+{
+    enum event { instructions, l1d_misses, llc_misses, dtlb_misses, branch_misses, event_count };
+
+    hardware_events() { std::fill(values, values + event_count, 0LL); }
+
+    /// Current values of the counters, zeros when they are not collected
+    static hardware_events now()
+    {
+        hardware_events result;
+#if XTL_HARDWARE_COUNTERS && defined(XTL_TIMING_METHOD_5)
+        result.values[instructions]  = instruction_counter().read();
+        result.values[l1d_misses]    = l1d_miss_counter().read();
+        result.values[llc_misses]    = llc_miss_counter().read();
+        result.values[dtlb_misses]   = dtlb_miss_counter().read();
+        result.values[branch_misses] = branch_miss_counter().read();
+#endif
+        return result;
+    }
+
+    /// Whether a counter of the given event is collected
+    static bool available(event e)
+    {
+#if XTL_HARDWARE_COUNTERS && defined(XTL_TIMING_METHOD_5)
+        switch (e)
+        {
+        case instructions:  return instruction_counter().available();
+        case l1d_misses:    return l1d_miss_counter().available();
+        case llc_misses:    return llc_miss_counter().available();
+        case dtlb_misses:   return dtlb_miss_counter().available();
+        case branch_misses: return branch_miss_counter().available();
+        default:            return false;
+        }
+#else
+        XTL_UNUSED(e);
+        return false;
+#endif
+    }
+
+    hardware_events operator-(const hardware_events& other) const
+    {
+        hardware_events result;
+
+        for (size_t i = 0; i < event_count; ++i)
+            result.values[i] = values[i] - other.values[i];
+
+        return result;
+    }
+
+    hardware_events& operator+=(const hardware_events& other)
+    {
+        for (size_t i = 0; i < event_count; ++i)
+            values[i] += other.values[i];
+
+        return *this;
+    }
+
+    long long values[event_count];
+};
+
+/// Prints hardware events per iteration of N iterations. Prints nothing 
+/// unless #XTL_HARDWARE_COUNTERS is set.
+inline void display(const char* name, const hardware_events& events, size_t N)
+{
+    if (!XTL_HARDWARE_COUNTERS)
+        return;
+
+    static const char* const names[hardware_events::event_count] = {"Instructions", "L1D", "LLC", "dTLB", "Branch"};
+    std::ios_base::fmtflags fmt = std::cout.flags();
+
+    std::cout << name << " Events/iteration: [" << std::fixed << std::setprecision(2);
+
+    for (size_t i = 0; i < hardware_events::event_count; ++i)
+    {
+        std::cout << (i ? " " : "") << names[i] << '=';
+
+        if (hardware_events::available(hardware_events::event(i)))
+            std::cout << double(events.values[i])/N;
+        else
+            std::cout << "n/a";
+    }
+
+    std::cout << ']' << std::endl;
+    std::cout.flags(fmt);
+}
+
+//------------------------------------------------------------------------------
+
+inline long long display(const char* name, std::vector<long long>& measurements, size_t N)
 {
     long long min, max, avg, med, dev;
+    std::vector<long long> timings(measurements); // Callers reuse measurements for the next experiment
 
     statistics(timings, min, max, avg, med, dev); // Get statistics from timings
+    record_result(name, N, min, max, avg, med, dev);
 
     std::fstream file;
    
@@ -212,7 +515,7 @@ inline long long display(const char* name, std::vector<long long>& timings, size
               << std::setw(4) << microseconds(med) << " --"
               << std::setw(5) << microseconds(max) << "] Dev = " 
               << std::setw(4) << microseconds(dev)
-#if   defined(XTL_TIMING_METHOD_1) || defined(XTL_TIMING_METHOD_2)
+#if   defined(XTL_TIMING_METHOD_1) || defined(XTL_TIMING_METHOD_2) || defined(XTL_TIMING_METHOD_5)
               << " Cycles/iteration: ["
               << std::setw(4) << cycles(min)/N << " --" 
               << std::setw(5) << cycles(avg)/N << "/" 
@@ -440,7 +743,9 @@ inline size_t get_timings1(
         std::vector<long long>& timings1, 
         std::vector<long long>& timings2,
         R&                      a1,
-        R&                      a2
+        R&                      a2,
+        hardware_events&        e1,
+        hardware_events&        e2
      )
 {
     XTL_ASSERT(timings1.size() == timings2.size());
@@ -450,19 +755,23 @@ inline size_t get_timings1(
 
     for (size_t m = 0; m < M; ++m)
     {
+        hardware_events hwStart1 = hardware_events::now();
         time_stamp liStart1 = get_time_stamp();
 
         for (size_t i = 0; i < N; ++i)
             a1 += f1(arguments[i]);
 
         time_stamp liFinish1 = get_time_stamp();
+        e1 += hardware_events::now() - hwStart1;
 
+        hardware_events hwStart2 = hardware_events::now();
         time_stamp liStart2 = get_time_stamp();
 
         for (size_t i = 0; i < N; ++i)
             a2 += f2(arguments[i]);
 
         time_stamp liFinish2 = get_time_stamp();
+        e2 += hardware_events::now() - hwStart2;
 
         XTL_ASSERT(a1==a2);
 
@@ -488,9 +797,13 @@ inline verdict get_timings1(std::vector<typename underlying<A>::type>& arguments
 
     for (size_t k = 0; k < K; ++k)
     {
-        N = get_timings1<R,A,f1,f2>(arguments, timings1, timings2, a1, a2);
+        hardware_events events1;
+        hardware_events events2;
+        N = get_timings1<R,A,f1,f2>(arguments, timings1, timings2, a1, a2, events1, events2);
         medians1[k] = display("F1", timings1, N);
         medians2[k] = display("F2", timings2, N);
+        display("F1", events1, N*M);
+        display("F2", events2, N*M);
         
         std::ios_base::fmtflags fmt = std::cout.flags(); // use cout flags function to save original format
         std::cout << "\t\t" << verdict(N, medians1[k], medians2[k]) << "\t\t" 
@@ -519,7 +832,9 @@ inline size_t get_timings2(
         std::vector<long long>& timings1, 
         std::vector<long long>& timings2,
         R&                      a1,
-        R&                      a2
+        R&                      a2,
+        hardware_events&        e1,
+        hardware_events&        e2
      )
 {
     XTL_ASSERT(timings1.size() == timings2.size());
@@ -529,19 +844,23 @@ inline size_t get_timings2(
 
     for (size_t m = 0; m < M; ++m)
     {
+        hardware_events hwStart1 = hardware_events::now();
         time_stamp liStart1 = get_time_stamp();
 
         for (size_t i = 0; i < N-1; i += 2)
             a1 += f1(arguments[i],arguments[i+1]);
 
         time_stamp liFinish1 = get_time_stamp();
+        e1 += hardware_events::now() - hwStart1;
 
+        hardware_events hwStart2 = hardware_events::now();
         time_stamp liStart2 = get_time_stamp();
 
         for (size_t i = 0; i < N-1; i += 2)
             a2 += f2(arguments[i],arguments[i+1]);
 
         time_stamp liFinish2 = get_time_stamp();
+        e2 += hardware_events::now() - hwStart2;
 
         XTL_ASSERT(a1==a2);
 
@@ -567,9 +886,13 @@ inline verdict get_timings2(std::vector<typename underlying<A>::type>& arguments
 
     for (size_t k = 0; k < K; ++k)
     {
-        N = get_timings2<R,A,f1,f2>(arguments, timings1, timings2, a1, a2);
+        hardware_events events1;
+        hardware_events events2;
+        N = get_timings2<R,A,f1,f2>(arguments, timings1, timings2, a1, a2, events1, events2);
         medians1[k] = display("F1", timings1, N);
         medians2[k] = display("F2", timings2, N);
+        display("F1", events1, N*M);
+        display("F2", events2, N*M);
         
         std::ios_base::fmtflags fmt = std::cout.flags(); // use cout flags function to save original format
         std::cout << "\t\t" << verdict(N, medians1[k], medians2[k]) << "\t\t" 
@@ -598,7 +921,9 @@ inline size_t get_timings3(
         std::vector<long long>& timings1, 
         std::vector<long long>& timings2,
         R&                      a1,
-        R&                      a2
+        R&                      a2,
+        hardware_events&        e1,
+        hardware_events&        e2
      )
 {
     XTL_ASSERT(timings1.size() == timings2.size());
@@ -608,19 +933,23 @@ inline size_t get_timings3(
 
     for (size_t m = 0; m < M; ++m)
     {
+        hardware_events hwStart1 = hardware_events::now();
         time_stamp liStart1 = get_time_stamp();
 
         for (size_t i = 0; i < N-2; i += 3)
             a1 += f1(arguments[i],arguments[i+1],arguments[i+2]);
 
         time_stamp liFinish1 = get_time_stamp();
+        e1 += hardware_events::now() - hwStart1;
 
+        hardware_events hwStart2 = hardware_events::now();
         time_stamp liStart2 = get_time_stamp();
 
         for (size_t i = 0; i < N-2; i += 3)
             a2 += f2(arguments[i],arguments[i+1],arguments[i+2]);
 
         time_stamp liFinish2 = get_time_stamp();
+        e2 += hardware_events::now() - hwStart2;
 
         XTL_ASSERT(a1==a2);
 
@@ -646,9 +975,13 @@ inline verdict get_timings3(std::vector<typename underlying<A>::type>& arguments
 
     for (size_t k = 0; k < K; ++k)
     {
-        N = get_timings3<R,A,f1,f2>(arguments, timings1, timings2, a1, a2);
+        hardware_events events1;
+        hardware_events events2;
+        N = get_timings3<R,A,f1,f2>(arguments, timings1, timings2, a1, a2, events1, events2);
         medians1[k] = display("F1", timings1, N);
         medians2[k] = display("F2", timings2, N);
+        display("F1", events1, N*M);
+        display("F2", events2, N*M);
         
         std::ios_base::fmtflags fmt = std::cout.flags(); // use cout flags function to save original format
         std::cout << "\t\t" << verdict(N, medians1[k], medians2[k]) << "\t\t" 
@@ -677,7 +1010,9 @@ inline size_t get_timings4(
         std::vector<long long>& timings1, 
         std::vector<long long>& timings2,
         R&                      a1,
-        R&                      a2
+        R&                      a2,
+        hardware_events&        e1,
+        hardware_events&        e2
      )
 {
     XTL_ASSERT(timings1.size() == timings2.size());
@@ -687,19 +1022,23 @@ inline size_t get_timings4(
 
     for (size_t m = 0; m < M; ++m)
     {
+        hardware_events hwStart1 = hardware_events::now();
         time_stamp liStart1 = get_time_stamp();
 
         for (size_t i = 0; i < N-3; i += 4)
             a1 += f1(arguments[i],arguments[i+1],arguments[i+2],arguments[i+3]);
 
         time_stamp liFinish1 = get_time_stamp();
+        e1 += hardware_events::now() - hwStart1;
 
+        hardware_events hwStart2 = hardware_events::now();
         time_stamp liStart2 = get_time_stamp();
 
         for (size_t i = 0; i < N-3; i += 4)
             a2 += f2(arguments[i],arguments[i+1],arguments[i+2],arguments[i+3]);
 
         time_stamp liFinish2 = get_time_stamp();
+        e2 += hardware_events::now() - hwStart2;
 
         XTL_ASSERT(a1==a2);
 
@@ -725,9 +1064,13 @@ inline verdict get_timings4(std::vector<typename underlying<A>::type>& arguments
 
     for (size_t k = 0; k < K; ++k)
     {
-        N = get_timings4<R,A,f1,f2>(arguments, timings1, timings2, a1, a2);
+        hardware_events events1;
+        hardware_events events2;
+        N = get_timings4<R,A,f1,f2>(arguments, timings1, timings2, a1, a2, events1, events2);
         medians1[k] = display("F1", timings1, N);
         medians2[k] = display("F2", timings2, N);
+        display("F1", events1, N*M);
+        display("F2", events2, N*M);
         
         std::ios_base::fmtflags fmt = std::cout.flags(); // use cout flags function to save original format
         std::cout << "\t\t" << verdict(N, medians1[k], medians2[k]) << "\t\t" 
@@ -782,6 +1125,12 @@ inline void print_xtl_macros(std::ostream& os = std::clog)
     os << "XTL_PRELOAD_LOCAL_STATIC_VARIABLES=" << std::endl;
 #endif
 
+#if defined(XTL_STRIP_VTBL_SIGNATURES)
+    os << "XTL_STRIP_VTBL_SIGNATURES=" << XTL_STRING_LITERAL(XTL_STRIP_VTBL_SIGNATURES) << std::endl;
+#else
+    os << "XTL_STRIP_VTBL_SIGNATURES=" << std::endl;
+#endif
+
 #if defined(XTL_RANDOMIZE_TAGS)
     os << "XTL_RANDOMIZE_TAGS=" << XTL_STRING_LITERAL(XTL_RANDOMIZE_TAGS) << std::endl;
 #else
@@ -824,6 +1173,12 @@ inline void print_xtl_macros(std::ostream& os = std::clog)
     os << "XTL_MIN_LOG_SIZE=" << std::endl;
 #endif
 
+#if defined(XTL_USE_LCG_WALK)
+    os << "XTL_USE_LCG_WALK=" << XTL_STRING_LITERAL(XTL_USE_LCG_WALK) << std::endl;
+#else
+    os << "XTL_USE_LCG_WALK=" << std::endl;
+#endif
+
 #if defined(XTL_REDUNDANCY_CHECKING)
     os << "XTL_REDUNDANCY_CHECKING=" << XTL_STRING_LITERAL(XTL_REDUNDANCY_CHECKING) << std::endl;
 #else
@@ -872,6 +1227,23 @@ inline void print_xtl_macros(std::ostream& os = std::clog)
     os << "XTL_RND_SEED=" << std::endl;
 #endif
 
+#if defined(XTL_HARDWARE_COUNTERS)
+    os << "XTL_HARDWARE_COUNTERS=" << XTL_STRING_LITERAL(XTL_HARDWARE_COUNTERS) << std::endl;
+#else
+    os << "XTL_HARDWARE_COUNTERS=" << std::endl;
+#endif
+#if defined(XTL_TIMING_WARMUP)
+    os << "XTL_TIMING_WARMUP=" << XTL_STRING_LITERAL(XTL_TIMING_WARMUP) << std::endl;
+#else
+    os << "XTL_TIMING_WARMUP=" << std::endl;
+#endif
+
+#if defined(XTL_TIMING_OUTLIERS)
+    os << "XTL_TIMING_OUTLIERS=" << XTL_STRING_LITERAL(XTL_TIMING_OUTLIERS) << std::endl;
+#else
+    os << "XTL_TIMING_OUTLIERS=" << std::endl;
+#endif
+
 //#if defined(XTL_SUPPORTS_ALLOCA)
 //    os << "XTL_SUPPORTS_ALLOCA=" << XTL_STRING_LITERAL(XTL_SUPPORTS_ALLOCA) << std::endl;
 //#else
@@ -917,4 +1289,121 @@ inline void print_xtl_macros(std::ostream& os = std::clog)
 
 //------------------------------------------------------------------------------
 
+/// Name and version of the compiler the benchmark was built with
+inline std::string compiler_version()
+{
+#if defined(__clang__)
+    return "clang " __clang_version__;
+#elif defined(__GNUC__)
+    return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+    return "msvc " XTL_STRING_LITERAL(_MSC_FULL_VER);
+#else
+    return "unknown";
+#endif
+}
+
+/// Architecture the benchmark was built for
+inline const char* target_architecture()
+{
+#if defined(__arm64e__)
+    return "arm64e";
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    return "arm64";
+#elif defined(__x86_64__) || defined(_M_X64)
+    return "x86_64";
+#elif defined(__i386__) || defined(_M_IX86)
+    return "x86";
+#else
+    return "unknown";
+#endif
+}
+
+/// Unit of values reported by #cycles on this platform
+inline const char* timing_unit()
+{
+#if defined(XTL_TIMING_METHOD_5)
+    return cycle_counter().available() ? "cycles" : "ns";
+#elif defined(XTL_TIMING_METHOD_4)
+    return "ns";
+#elif defined(XTL_TIMING_METHOD_3)
+    return "ticks";
+#else
+    return "cycles";
+#endif
+}
+
+/// Writes s as a JSON string literal
+inline std::ostream& json_string(std::ostream& os, const std::string& s)
+{
+    os << '"';
+
+    for (std::string::const_iterator p = s.begin(); p != s.end(); ++p)
+        if (*p == '"' || *p == '\\')
+            os << '\\' << *p;
+        else
+        if ((unsigned char)*p < ' ')
+            os << ' ';
+        else
+            os << *p;
+
+    return os << '"';
+}
+
+/// Configuration reported by #print_xtl_macros as a JSON object
+inline const std::string& xtl_macros_json()
+{
+    static std::string json;
+
+    if (json.empty())
+    {
+        std::stringstream macros;
+        std::ostringstream os;
+        std::string line;
+        print_xtl_macros(macros);
+        os << '{';
+
+        for (bool first = true; std::getline(macros, line); first = false)
+        {
+            std::string::size_type eq = line.find('=');
+            json_string(os << (first ? "" : ","), line.substr(0,eq)) << ':';
+            json_string(os, eq == std::string::npos ? std::string() : line.substr(eq+1));
+        }
+
+        json = os.str() + '}';
+    }
+
+    return json;
+}
+
+inline void record_result(const char* name, size_t N, long long min, long long max, long long avg, long long med, long long dev)
+{
+    if (!*XTL_RESULTS_FILE)
+        return;
+
+    std::ofstream file(XTL_RESULTS_FILE, std::ofstream::out | std::ofstream::app);
+
+    if (!file)
+        return;
+
+    const std::string benchmark = XTL_BENCHMARK_NAME;
+    const double n = double(N);
+    file << "{\"benchmark\":";    json_string(file, benchmark.substr(benchmark.find_last_of("/\\")+1));
+    file << ",\"test\":";         json_string(file, name);
+    file << ",\"compiler\":";     json_string(file, compiler_version());
+    file << ",\"arch\":";         json_string(file, target_architecture());
+    file << ",\"layout\":";       json_string(file, std::getenv("XTL_LAYOUT") ? std::getenv("XTL_LAYOUT") : "");
+    file << ",\"unit\":";         json_string(file, timing_unit());
+    file << ",\"iterations\":"    << N
+         << ",\"min\":"           << cycles(min)/n
+         << ",\"median\":"        << cycles(med)/n
+         << ",\"mean\":"          << cycles(avg)/n
+         << ",\"max\":"           << cycles(max)/n
+         << ",\"stddev\":"        << cycles(dev)/n
+         << ",\"config\":"        << xtl_macros_json()
+         << '}' << std::endl;
+}
+
+//------------------------------------------------------------------------------
+
 } // of namespace mch
@@ -67,25 +67,31 @@ size_t run_timings(
 
     size_t N = shapes.size();
     size_t M = timingsV.size();
+    hardware_events eV;
+    hardware_events eM;
 
     for (size_t m = 0; m < M; ++m)
     {
         unsigned char j = 0;
+        hardware_events hwStart1 = hardware_events::now();
         time_stamp liStart1 = get_time_stamp();
 
         for (size_t i = 0; i < N; ++i)
             aV += do_visit(*shapes[i],some_numbers[j++]);
 
         time_stamp liFinish1 = get_time_stamp();
+        eV += hardware_events::now() - hwStart1;
 
         j = 0;
 
+        hardware_events hwStart2 = hardware_events::now();
         time_stamp liStart2 = get_time_stamp();
 
         for (size_t i = 0; i < N; ++i)
             aM += do_match(*shapes[i],some_numbers[j++]);
 
         time_stamp liFinish2 = get_time_stamp();
+        eM += hardware_events::now() - hwStart2;
 
         XTL_ASSERT(aV==aM);
 
@@ -93,6 +99,9 @@ size_t run_timings(
         timingsM[m] = liFinish2-liStart2;
     }
 
+    display("AreaVis", eV, N*M); // Instructions per call among them, \see make lean
+    display("AreaMat", eM, N*M);
+
     return N; // Number of iterations per measurement
 }
 
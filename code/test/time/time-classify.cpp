@@ -0,0 +1,132 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <iostream>
+#include "testutils.hpp"
+#include "type_switchN-patterns.hpp"
+#include "patterns/guard.hpp"
+#include "patterns/n+k.hpp"
+#include "classify.hpp"
+
+//------------------------------------------------------------------------------
+
+using namespace mch;
+
+//------------------------------------------------------------------------------
+
+/// Number of readings classified by each call
+enum { chunk_size = classify_block_size, number_of_chunks = 64 };
+
+/// Sensor readings, whose chunks are chosen randomly by arguments
+std::vector<double> readings(chunk_size*number_of_chunks);
+
+//------------------------------------------------------------------------------
+
+/// Classification of a single reading
+inline size_t classify_reading(double r)
+{
+    var<double> x;
+
+    Match(r)
+    {
+        Case(x |= x < 0.0)   return 0;
+        Case(x |= x > 100.0) return 1;
+        Case(x |= x > 90.0)  return 2;
+    }
+    EndMatch
+
+    return 3;
+}
+
+//------------------------------------------------------------------------------
+
+XTL_TIMED_FUNC_BEGIN
+size_t do_match(size_t c)
+{
+    const double* first = &readings[c*chunk_size];
+    size_t        result = 0;
+
+    for (size_t i = 0; i < chunk_size; ++i)
+        result += classify_reading(first[i]);
+
+    return result;
+}
+XTL_TIMED_FUNC_END
+
+//------------------------------------------------------------------------------
+
+XTL_TIMED_FUNC_BEGIN
+size_t do_classify(size_t c)
+{
+    const double* first = &readings[c*chunk_size];
+    unsigned char kinds[chunk_size];
+    var<double>   x;
+    size_t        result = 0;
+
+    classify(first, first+chunk_size, kinds, x |= x < 0.0, x |= x > 100.0, x |= x > 90.0);
+
+    for (size_t i = 0; i < chunk_size; ++i)
+        result += kinds[i];
+
+    return result;
+}
+XTL_TIMED_FUNC_END
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    for (size_t i = 0; i < readings.size(); ++i)
+        readings[i] = rand() % 12000 / 100.0 - 10.0; // From -10 to 110
+
+    std::vector<size_t> arguments(N);
+
+    for (size_t i = 0; i < N; ++i)
+        arguments[i] = rand() % number_of_chunks;
+
+    verdict v = get_timings1<size_t,size_t,do_match,do_classify>(arguments);
+    std::cout << "Verdict: \t" << v << std::endl;
+}
+
+//------------------------------------------------------------------------------
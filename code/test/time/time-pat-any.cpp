@@ -0,0 +1,106 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Times one-of patterns built with mch::any against a switch statement with
+/// several labels per branch.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <iostream>
+#include "type_switchN-patterns.hpp"
+#include "patterns/all.hpp"
+#include "testutils.hpp"
+
+//------------------------------------------------------------------------------
+
+using namespace mch;
+
+//------------------------------------------------------------------------------
+
+extern int f1(int);
+extern int f2(int);
+
+//------------------------------------------------------------------------------
+
+XTL_TIMED_FUNC_BEGIN
+int f1(int n)
+{
+    switch (n)
+    {
+    case 1: case 3: case 5: case 7: case 9: return 1;
+    case 0: case 2: case 4: case 6: case 8: return 2;
+    default:                                return 3;
+    }
+}
+XTL_TIMED_FUNC_END
+
+//------------------------------------------------------------------------------
+
+XTL_TIMED_FUNC_BEGIN
+int f2(int n)
+{
+    Match(n)
+    {
+    Case(any({1,3,5,7,9})) return 1;
+    Case(any({0,2,4,6,8})) return 2;
+    Otherwise()            return 3;
+    }
+    EndMatch
+
+    XTL_UNREACHABLE; // To avoid warning that control may reach end of a non-void function
+}
+XTL_TIMED_FUNC_END
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    std::vector<int> arguments(N);
+
+    for (size_t i = 0; i < N; ++i)
+        arguments[i] = rand() % 12;
+
+    verdict v = get_timings1<int,int,f1,f2>(arguments);
+    std::cout << "Verdict: \t" << v << std::endl;
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,112 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Times equivalence patterns, which compare a subject with a value bound 
+/// earlier in the same Case clause, against comparing the subjects directly.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <iostream>
+#include "type_switchN-patterns.hpp"
+#include "patterns/all.hpp"
+#include "testutils.hpp"
+
+//------------------------------------------------------------------------------
+
+using namespace mch;
+
+//------------------------------------------------------------------------------
+
+typedef std::pair<int,int> arg_type;
+
+//------------------------------------------------------------------------------
+
+extern int f1(int, int);
+extern int f2(int, int);
+
+inline int f1(const arg_type a) { return f1(a.first,a.second); }
+inline int f2(const arg_type a) { return f2(a.first,a.second); }
+
+//------------------------------------------------------------------------------
+
+XTL_TIMED_FUNC_BEGIN
+int f1(int a, int b)
+{
+    if (a == b)   return 0;
+    if (a == b+1) return 1;
+    return 2;
+}
+XTL_TIMED_FUNC_END
+
+//------------------------------------------------------------------------------
+
+XTL_TIMED_FUNC_BEGIN
+int f2(int a, int b)
+{
+    var<int> x;
+
+    Match(a,b)
+    {
+    Case(x,+x)       return 0;
+    Case(x,+(x-1))   return 1;
+    Case(_,_)        return 2;
+    }
+    EndMatch
+
+    XTL_UNREACHABLE; // To avoid warning that control may reach end of a non-void function
+}
+XTL_TIMED_FUNC_END
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    std::vector<arg_type> arguments(N);
+
+    for (size_t i = 0; i < N; ++i)
+        arguments[i] = arg_type(rand() % 4, rand() % 4);
+
+    verdict v = get_timings1<int,arg_type,f1,f2>(arguments);
+    std::cout << "Verdict: \t" << v << std::endl;
+}
+
+//------------------------------------------------------------------------------
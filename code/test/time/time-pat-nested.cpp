@@ -0,0 +1,178 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Times nested constructor patterns C<T>(...) against the same decomposition
+/// with a chain of dynamic_cast. The depth of nesting is set with NESTING_DEPTH
+/// from 1 to 4, \see the patterns target of the Makefile.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <iostream>
+#include "type_switchN-patterns.hpp"
+#include "patterns/all.hpp"
+#include "testutils.hpp"
+
+//------------------------------------------------------------------------------
+
+using namespace mch;
+
+//------------------------------------------------------------------------------
+
+#if !defined(NESTING_DEPTH)
+#define NESTING_DEPTH 2
+#endif
+
+#if NESTING_DEPTH < 1 || NESTING_DEPTH > 4
+#error NESTING_DEPTH has to be between 1 and 4
+#endif
+
+//------------------------------------------------------------------------------
+
+struct Term           { virtual ~Term() {} };
+struct Leaf  : Term   { Leaf(int v) : value(v) {} int value; };
+struct Other : Term   {};
+
+/// Wrapper at a given level of nesting. Each level is a separate class because
+/// C<T>(p) applies p to the subject itself rather than to its member when p 
+/// accepts T, so C<Wrap>(C<Wrap>(...)) would not descend.
+template <int L>
+struct Wrap  : Term   { Wrap(const Term* t) : inner(t) {} const Term* inner; };
+
+namespace mch ///< Mach7 library namespace
+{
+template <>        struct bindings<Leaf>    { Members(Leaf::value); };
+template <int L>   struct bindings<Wrap<L>> { Members(Wrap<L>::inner); };
+} // of namespace mch
+
+//------------------------------------------------------------------------------
+
+extern int f1(const Term*);
+extern int f2(const Term*);
+
+//------------------------------------------------------------------------------
+
+XTL_TIMED_FUNC_BEGIN
+int f1(const Term* t)
+{
+    if (const Wrap<1>* w1 = dynamic_cast<const Wrap<1>*>(t))
+#if NESTING_DEPTH > 1
+    if (const Wrap<2>* w2 = dynamic_cast<const Wrap<2>*>(w1->inner))
+#if NESTING_DEPTH > 2
+    if (const Wrap<3>* w3 = dynamic_cast<const Wrap<3>*>(w2->inner))
+#if NESTING_DEPTH > 3
+    if (const Wrap<4>* w4 = dynamic_cast<const Wrap<4>*>(w3->inner))
+    if (const Leaf* l  = dynamic_cast<const Leaf*>(w4->inner))
+#else
+    if (const Leaf* l  = dynamic_cast<const Leaf*>(w3->inner))
+#endif
+#else
+    if (const Leaf* l  = dynamic_cast<const Leaf*>(w2->inner))
+#endif
+#else
+    if (const Leaf* l  = dynamic_cast<const Leaf*>(w1->inner))
+#endif
+        return l->value;
+
+    if (const Leaf* l = dynamic_cast<const Leaf*>(t))
+        return -l->value;
+
+    return 0;
+}
+XTL_TIMED_FUNC_END
+
+//------------------------------------------------------------------------------
+
+XTL_TIMED_FUNC_BEGIN
+int f2(const Term* t)
+{
+    var<int> v;
+
+    Match(t)
+    {
+#if   NESTING_DEPTH == 1
+    Case(C<Wrap<1>>(C<Leaf>(v)))                                        return v;
+#elif NESTING_DEPTH == 2
+    Case(C<Wrap<1>>(C<Wrap<2>>(C<Leaf>(v))))                            return v;
+#elif NESTING_DEPTH == 3
+    Case(C<Wrap<1>>(C<Wrap<2>>(C<Wrap<3>>(C<Leaf>(v)))))                return v;
+#else
+    Case(C<Wrap<1>>(C<Wrap<2>>(C<Wrap<3>>(C<Wrap<4>>(C<Leaf>(v))))))    return v;
+#endif
+    Case(C<Leaf>(v))                                                    return -v;
+    Otherwise()                                                         return 0;
+    }
+    EndMatch
+
+    XTL_UNREACHABLE; // To avoid warning that control may reach end of a non-void function
+}
+XTL_TIMED_FUNC_END
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    std::vector<const Term*> arguments(N);
+
+    // Chains of 0 to NESTING_DEPTH+1 wrappers around a leaf or another term,
+    // so that nested patterns fail at every depth as well as succeed
+    for (size_t i = 0; i < N; ++i)
+    {
+        const Term* t = rand() % 4 ? static_cast<const Term*>(new Leaf(rand() % 100)) : new Other;
+
+        switch (rand() % (NESTING_DEPTH + 2))
+        {
+        case 5: t = new Wrap<5>(t); // fall through
+        case 4: t = new Wrap<4>(t); // fall through
+        case 3: t = new Wrap<3>(t); // fall through
+        case 2: t = new Wrap<2>(t); // fall through
+        case 1: t = new Wrap<1>(t); // fall through
+        case 0: break;
+        }
+
+        arguments[i] = t;
+    }
+
+    verdict v = get_timings1<int,const Term*,f1,f2>(arguments);
+    std::cout << "Verdict: \t" << v << std::endl;
+}
+
+//------------------------------------------------------------------------------
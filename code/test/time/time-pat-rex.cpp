@@ -0,0 +1,124 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Times regular expression patterns against calling the same regular expression
+/// engine directly. Both sides use std::regex compiled once, so the difference 
+/// is the cost of the pattern and its conversion of capture groups.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <iostream>
+#include "type_switchN-patterns.hpp"
+#include "patterns/all.hpp"
+#include "testutils.hpp"
+
+//------------------------------------------------------------------------------
+
+using namespace mch;
+
+//------------------------------------------------------------------------------
+
+#include <cstdlib>
+#include <regex>
+
+//------------------------------------------------------------------------------
+
+extern int f1(const std::string&);
+extern int f2(const std::string&);
+
+//------------------------------------------------------------------------------
+
+XTL_TIMED_FUNC_BEGIN
+int f1(const std::string& s)
+{
+    static const std::regex pair_re("([0-9]+)-([0-9]+)");
+    static const std::regex word_re("[a-z]+");
+    std::smatch m;
+
+    if (std::regex_match(s, m, pair_re))
+        return std::atoi(m[1].str().c_str()) + std::atoi(m[2].str().c_str());
+
+    if (std::regex_match(s, word_re))
+        return 0;
+
+    return -1;
+}
+XTL_TIMED_FUNC_END
+
+//------------------------------------------------------------------------------
+
+XTL_TIMED_FUNC_BEGIN
+int f2(const std::string& s)
+{
+    var<int> x, y;
+
+    Match(s)
+    {
+    Case(rex("([0-9]+)-([0-9]+)", x, y)) return x + y;
+    Case(rex("[a-z]+"))                  return 0;
+    Otherwise()                          return -1;
+    }
+    EndMatch
+
+    XTL_UNREACHABLE; // To avoid warning that control may reach end of a non-void function
+}
+XTL_TIMED_FUNC_END
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    std::vector<std::string> arguments(N);
+
+    for (size_t i = 0; i < N; ++i)
+        switch (rand() % 3)
+        {
+        case 0:  arguments[i] = std::to_string(rand() % 1000) + '-' + std::to_string(rand() % 1000); break;
+        case 1:  arguments[i] = std::string(rand() % 8 + 1, char('a' + rand() % 26)); break;
+        default: arguments[i] = std::to_string(rand() % 1000) + '+'; break;
+        }
+
+    verdict v = get_timings1<int,const std::string&,f1,f2>(arguments);
+    std::cout << "Verdict: \t" << v << std::endl;
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,137 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Compares a Match statement on boost::any values of many types, which looks
+/// up the pointer to type() of the subject once and jumps to its clause, with
+/// a chain of any_cast calls, each comparing type_info.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <iostream>
+#include "testutils.hpp"
+#include "type_switchN-patterns-xtl.hpp"
+#include "patterns/constructor.hpp"
+#include "adapters/boost/adapt_boost_any.hpp"
+
+template <int I> struct T { int m_t; T(int i = 0) : m_t(i) {} };
+
+typedef boost::any VP;
+
+//------------------------------------------------------------------------------
+
+XTL_TIMED_FUNC_BEGIN
+int do_mach7(const VP& vp)
+{
+    using mch::C;
+
+    Match(vp)
+    {
+        Case(C<T<0>>()) return 0*100 + match0.m_t;
+        Case(C<T<1>>()) return 1*100 + match0.m_t;
+        Case(C<T<2>>()) return 2*100 + match0.m_t;
+        Case(C<T<3>>()) return 3*100 + match0.m_t;
+        Case(C<T<4>>()) return 4*100 + match0.m_t;
+        Case(C<T<5>>()) return 5*100 + match0.m_t;
+        Case(C<T<6>>()) return 6*100 + match0.m_t;
+        Case(C<T<7>>()) return 7*100 + match0.m_t;
+    }
+    EndMatch
+
+    XTL_ASSERT(!"Not exhaustive");
+    return -1;
+}
+XTL_TIMED_FUNC_END
+
+//------------------------------------------------------------------------------
+
+XTL_TIMED_FUNC_BEGIN
+int do_visit(const VP& vp)
+{
+    if (const T<0>* p = boost::any_cast<T<0>>(&vp)) { return 0*100 + p->m_t; }
+    if (const T<1>* p = boost::any_cast<T<1>>(&vp)) { return 1*100 + p->m_t; }
+    if (const T<2>* p = boost::any_cast<T<2>>(&vp)) { return 2*100 + p->m_t; }
+    if (const T<3>* p = boost::any_cast<T<3>>(&vp)) { return 3*100 + p->m_t; }
+    if (const T<4>* p = boost::any_cast<T<4>>(&vp)) { return 4*100 + p->m_t; }
+    if (const T<5>* p = boost::any_cast<T<5>>(&vp)) { return 5*100 + p->m_t; }
+    if (const T<6>* p = boost::any_cast<T<6>>(&vp)) { return 6*100 + p->m_t; }
+    if (const T<7>* p = boost::any_cast<T<7>>(&vp)) { return 7*100 + p->m_t; }
+
+    XTL_ASSERT(!"Not exhaustive");
+    return -1;
+}
+XTL_TIMED_FUNC_END
+
+//------------------------------------------------------------------------------
+
+static VP make(int i)
+{
+    switch (i % 8)
+    {
+    case 0:  return T<0>(i);
+    case 1:  return T<1>(i);
+    case 2:  return T<2>(i);
+    case 3:  return T<3>(i);
+    case 4:  return T<4>(i);
+    case 5:  return T<5>(i);
+    case 6:  return T<6>(i);
+    default: return T<7>(i);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    using namespace mch;
+
+    std::vector<VP> arguments(N);
+
+    for (size_t i = 0; i < N; ++i)
+        arguments[i] = make(rand() % 80);
+
+    verdict v = get_timings1<int,const VP&,do_visit,do_mach7>(arguments);
+
+    std::cout << std::endl;
+    std::cout << "Verdict: \t" << v << std::endl;
+}
+
+//------------------------------------------------------------------------------
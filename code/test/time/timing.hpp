@@ -46,19 +46,25 @@
 
 // This one is for pure convenience to let us choose which method to measure
 // with when several are available.
-#if (!defined(XTL_TIMING_METHOD_1) && !defined(XTL_TIMING_METHOD_2) && !defined(XTL_TIMING_METHOD_3))
+#if (!defined(XTL_TIMING_METHOD_1) && !defined(XTL_TIMING_METHOD_2) && !defined(XTL_TIMING_METHOD_3) && !defined(XTL_TIMING_METHOD_4) && !defined(XTL_TIMING_METHOD_5))
     #if   defined(_MSC_VER)
         /// This timing method would work on Windows systems starting from Windows 2000
         #define XTL_TIMING_METHOD_1
-    #elif defined(__GNUC__)
-        /// This timing method would work on any Pentium processor when compiled with GCC
-        #define XTL_TIMING_METHOD_2
+    #elif defined(__linux__)
+        /// This timing method counts cycles of the CPU with the performance 
+        /// counters of Linux, falling back to method 4 when they are not available
+        #define XTL_TIMING_METHOD_5
     #else
-        /// This timing method is the least precise, relying only on standard functions from time.h
-        #define XTL_TIMING_METHOD_3
+        /// This timing method would work on any platform with a C++11 library, 
+        /// but measures time rather than cycles
+        #define XTL_TIMING_METHOD_4
     #endif
 #endif
 
+// Method 2 reads rdtsc, which only exists on x86 and counts at a constant rate
+// rather than in cycles of a CPU with frequency scaling. It is kept for 
+// comparison with older results, but has to be requested explicitly.
+
 #if defined(XTL_TIMING_METHOD_1)
 
     #if !defined(NOMINMAX)
@@ -157,15 +163,150 @@ namespace mch ///< Mach7 library namespace
     inline time_stamp_diff cycles(time_stamp_diff tsd)  { return tsd; }
 } // of namespace mch
 
+#elif defined(XTL_TIMING_METHOD_4) || defined(XTL_TIMING_METHOD_5)
+
+    #include <chrono>
+    #include <stdint.h>
+
+    #if defined(XTL_TIMING_METHOD_5)
+    #include <cstring>
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+    #endif
+
+namespace mch ///< Mach7 library namespace
+{
+    /// The type used to record a time stamp. The type must have operator- defined.
+    typedef int64_t   time_stamp;
+    /// The type capable of holding a difference of two time stamps.
+    typedef int64_t   time_stamp_diff;
+
+    /// Nanoseconds since an arbitrary point that are not affected by changes of system time
+    inline time_stamp steady_time_stamp()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+#if defined(XTL_TIMING_METHOD_5)
+    /// A hardware performance counter of the calling thread and its descendants,
+    /// counting in user mode only, which unprivileged processes are allowed to.
+    class perf_counter
+    {
+    public:
+        explicit perf_counter(uint64_t event, uint32_t type = PERF_TYPE_HARDWARE)
+        {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.type           = type;
+            attr.size           = sizeof(attr);
+            attr.config         = event;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv     = 1;
+            attr.inherit        = 1;
+            fd = int(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+       ~perf_counter() { if (fd >= 0) close(fd); }
+
+        /// Whether the counter could be opened. It can not be e.g. in virtual 
+        /// machines without virtualized performance counters.
+        bool available() const { return fd >= 0; }
+
+        /// Current value of the counter or 0 when it is not available
+        uint64_t read() const
+        {
+            uint64_t value = 0;
+            return fd >= 0 && ::read(fd, &value, sizeof(value)) == sizeof(value) ? value : 0;
+        }
+
+    private:
+        perf_counter(const perf_counter&);            ///< No copy constructor
+        perf_counter& operator=(const perf_counter&); ///< No assignment
+        int fd; ///< File descriptor of the counter
+    };
+
+    /// Counter of CPU cycles used for time stamps
+    inline const perf_counter& cycle_counter()       { static const perf_counter counter(PERF_COUNT_HW_CPU_CYCLES);   return counter; }
+    /// Counter of retired instructions, available for reports alongside cycles
+    inline const perf_counter& instruction_counter() { static const perf_counter counter(PERF_COUNT_HW_INSTRUCTIONS); return counter; }
+
+    /// Event of PERF_TYPE_HW_CACHE type for read misses of a given cache
+    inline uint64_t cache_read_misses(uint64_t cache) { return cache | PERF_COUNT_HW_CACHE_OP_READ << 8 | PERF_COUNT_HW_CACHE_RESULT_MISS << 16; }
+
+    /// Counters explaining timings, \see XTL_HARDWARE_COUNTERS
+    inline const perf_counter& l1d_miss_counter()    { static const perf_counter counter(cache_read_misses(PERF_COUNT_HW_CACHE_L1D),  PERF_TYPE_HW_CACHE); return counter; }
+    inline const perf_counter& llc_miss_counter()    { static const perf_counter counter(PERF_COUNT_HW_CACHE_MISSES); return counter; }
+    inline const perf_counter& dtlb_miss_counter()   { static const perf_counter counter(cache_read_misses(PERF_COUNT_HW_CACHE_DTLB), PERF_TYPE_HW_CACHE); return counter; }
+    inline const perf_counter& branch_miss_counter() { static const perf_counter counter(PERF_COUNT_HW_BRANCH_MISSES); return counter; }
+
+    /// Returns a current time stamp.
+    inline time_stamp get_time_stamp() { return cycle_counter().available() ? time_stamp(cycle_counter().read()) : steady_time_stamp(); }
+    /// Returns how many time stamps are there in 1 second (frequency). Cycles 
+    /// are only counted while the thread runs, so we spin rather than sleep.
+    inline time_stamp get_frequency()
+    {
+        if (!cycle_counter().available())
+            return 1000000000;
+
+        time_stamp t0 = steady_time_stamp(), c0 = get_time_stamp(), t1;
+
+        do t1 = steady_time_stamp(); while (t1 - t0 < 100000000); // Spin for 1/10th of a second
+
+        return (get_time_stamp()-c0)*1000000000/(t1-t0);
+    }
+    /// Estimates the number of cycles in a given time_stamp_diff value. Those
+    /// are nanoseconds when performance counters are not available.
+    inline time_stamp_diff cycles(time_stamp_diff tsd)  { return tsd; }
+#else
+    /// Returns a current time stamp.
+    inline time_stamp get_time_stamp() { return steady_time_stamp(); }
+    /// Returns how many time stamps are there in 1 second (frequency).
+    inline time_stamp get_frequency()  { return 1000000000; }
+    /// Estimates the number of cycles in a given time_stamp_diff value
+    /// FIX: These are nanoseconds, use method 5 to count actual cycles
+    inline time_stamp_diff cycles(time_stamp_diff tsd)  { return tsd; }
+#endif
+
+} // of namespace mch
+
 #else
 
     #error Timing method has not been chosen
 
 #endif
 
+#if !defined(XTL_TIMING_PIN_CPU)
+    /// Whether the timing thread is pinned to the CPU it starts on, so that 
+    /// its measurements are not disturbed by migrating between CPUs
+    #define XTL_TIMING_PIN_CPU 1
+#endif
+
+#if XTL_TIMING_PIN_CPU && defined(__linux__)
+    #include <sched.h>
+#endif
+
 namespace mch ///< Mach7 library namespace
 {
 
+/// Pins the calling thread to the CPU it currently runs on \see #XTL_TIMING_PIN_CPU
+inline bool pin_to_current_cpu()
+{
+#if XTL_TIMING_PIN_CPU && defined(_MSC_VER)
+    return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << GetCurrentProcessorNumber()) != 0;
+#elif XTL_TIMING_PIN_CPU && defined(__linux__)
+    const int cpu = sched_getcpu();
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu < 0 ? 0 : cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+/// Timing thread gets pinned before the frequency is estimated
+static const bool time_stamp_pinned = pin_to_current_cpu();
 static const time_stamp time_stamp_frequency = get_frequency();
 
 inline long long       seconds(const long long& l) { return l/time_stamp_frequency; }
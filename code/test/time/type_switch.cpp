@@ -43,7 +43,7 @@
 ///
 
 #include "testshape.hpp"
-#include "type_switch.hpp"        // Slower by now than the above
+#include "type_switch1.hpp"        // The single-subject type switch that type_switch.hpp used to be
 
 //------------------------------------------------------------------------------
 
@@ -0,0 +1,257 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Times the strategies of vtbl maps among which type_switch.hpp picks one for
+/// the compiler and architecture it is built with under 
+/// #XTL_TUNED_VTBL_MAP_POLICY, on Match
+/// statements with one and two polymorphic subjects, and reports the fastest
+/// strategy next to the one picked. When they differ on a compiler or
+/// architecture, the table in type_switch.hpp is the one to update.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_TUNED_VTBL_MAP_POLICY 1 // To report the strategy of the table
+#include "type_switch.hpp"
+#include "vtblstatic.hpp"
+#include "rnd.hpp"
+#include "timing.hpp"
+
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#define XTL_POLICY_STRING(...)  XTL_POLICY_STRING_(__VA_ARGS__)
+#define XTL_POLICY_STRING_(...) #__VA_ARGS__
+
+/// Strategy picked by type_switch.hpp, before the functions below redefine it
+const char* const picked_policy = XTL_POLICY_STRING(XTL_VTBL_MAP_POLICY);
+
+//------------------------------------------------------------------------------
+
+/// Number of objects matched by each run, large enough to hide timer overhead
+const size_t objects_num = 1 << 16;
+
+/// Number of runs of each strategy, of which the fastest is reported
+const size_t runs = 31;
+
+//------------------------------------------------------------------------------
+
+struct Node
+{
+    virtual ~Node() {}
+    virtual int kind() const = 0;
+};
+
+template <int N>
+struct Leaf : Node
+{
+    int kind() const { return N; }
+};
+
+//------------------------------------------------------------------------------
+
+#define XTL_UNARY_CLAUSES(i)  Case(mch::C<Leaf<i>>()) return i; Case(mch::C<Leaf<i+10>>()) return i+10;
+#define XTL_BINARY_CLAUSES(i) Case(mch::C<Leaf<i>>(), mch::C<Leaf<i/2>>()) return i; Case(mch::C<Leaf<i>>(), mch::C<Leaf<i+10>>()) return i+10;
+
+/// Clauses are spelled out as Case itself expands into XTL_REPEAT, which thus
+/// cannot be used to repeat them
+#define XTL_CLAUSES(m) m(0) m(1) m(2) m(3) m(4) m(5) m(6) m(7) m(8) m(9)
+
+/// Defines unary and binary Match functions with vtbl maps of the policy
+/// given by #XTL_VTBL_MAP_POLICY at the point of use
+#define XTL_STRATEGY_FUNCTIONS(name)                                           \
+    int name##_unary(const Node& a)                                            \
+    {                                                                          \
+        Match(a)                                                               \
+        {                                                                      \
+            XTL_CLAUSES(XTL_UNARY_CLAUSES)                                     \
+        }                                                                      \
+        EndMatch                                                               \
+        return -1;                                                             \
+    }                                                                          \
+    int name##_binary(const Node& a, const Node& b)                            \
+    {                                                                          \
+        Match(a,b)                                                             \
+        {                                                                      \
+            XTL_CLAUSES(XTL_BINARY_CLAUSES)                                    \
+        }                                                                      \
+        EndMatch                                                               \
+        return -1;                                                             \
+    }
+
+//------------------------------------------------------------------------------
+
+XTL_STRATEGY_FUNCTIONS(picked)
+
+#undef  XTL_VTBL_MAP_POLICY
+#define XTL_VTBL_MAP_POLICY mch::vtbl_map_policy<mch::lcg_probing, mch::interleave_hashing>
+XTL_STRATEGY_FUNCTIONS(lcg_interleave)
+
+#undef  XTL_VTBL_MAP_POLICY
+#define XTL_VTBL_MAP_POLICY mch::vtbl_map_policy<mch::linear_probing, mch::interleave_hashing>
+XTL_STRATEGY_FUNCTIONS(linear_interleave)
+
+#undef  XTL_VTBL_MAP_POLICY
+#define XTL_VTBL_MAP_POLICY mch::vtbl_map_policy<mch::lcg_probing, mch::multiplicative_hashing>
+XTL_STRATEGY_FUNCTIONS(lcg_multiplicative)
+
+#undef  XTL_VTBL_MAP_POLICY
+#define XTL_VTBL_MAP_POLICY mch::vtbl_map_policy<mch::linear_probing, mch::multiplicative_hashing>
+XTL_STRATEGY_FUNCTIONS(linear_multiplicative)
+
+#if !XTL_MULTI_THREADING
+#undef  XTL_VTBL_MAP_POLICY
+#define XTL_VTBL_MAP_POLICY mch::vtbl_map_policy<mch::cuckoo_probing<>, mch::interleave_hashing>
+XTL_STRATEGY_FUNCTIONS(cuckoo_interleave)
+
+#undef  XTL_VTBL_MAP_POLICY
+#define XTL_VTBL_MAP_POLICY mch::vtbl_static_policy<>
+XTL_STRATEGY_FUNCTIONS(static_storage)
+#endif
+
+//------------------------------------------------------------------------------
+
+/// Returns the fastest of several runs of f in nanoseconds per object
+template <typename F>
+double fastest(F f)
+{
+    double best = 0.0;
+
+    for (size_t r = 0; r < runs; ++r)
+    {
+        mch::time_stamp start = mch::get_time_stamp();
+        f();
+        mch::time_stamp finish = mch::get_time_stamp();
+        double ns = (finish - start) * 1e9 / mch::get_frequency() / objects_num;
+
+        if (r == 0 || ns < best)
+            best = ns;
+    }
+
+    return best;
+}
+
+//------------------------------------------------------------------------------
+
+struct strategy
+{
+    const char* name;
+    int (*unary)(const Node&);
+    int (*binary)(const Node&, const Node&);
+};
+
+#define XTL_STRATEGY(name) { #name, &name##_unary, &name##_binary }
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    typedef Node* (*factory)();
+    #define XTL_FACTORIES(i,...) []() -> Node* { return new Leaf<i>; }, []() -> Node* { return new Leaf<i+10>; },
+    const factory make[] = { XTL_REPEAT(10,XTL_FACTORIES) };
+
+    std::mt19937 engine(XTL_RND_SEED);
+    std::uniform_int_distribution<size_t> kind(0, XTL_ARR_SIZE(make)-1);
+    std::vector<Node*> objects(objects_num);
+
+    for (size_t i = 0; i < objects_num; ++i)
+        objects[i] = make[kind(engine)]();
+
+    // What every strategy has to return, computed with virtual functions
+    int expected_unary = 0, expected_binary = 0;
+
+    for (size_t i = 0; i+1 < objects_num; ++i)
+    {
+        int k = objects[i]->kind(), l = objects[i+1]->kind();
+        expected_unary  += k;
+        expected_binary += k < 10 && l == k/2 ? k : k < 10 && l == k+10 ? k+10 : -1;
+    }
+
+    const strategy strategies[] = {
+        XTL_STRATEGY(picked),
+        XTL_STRATEGY(lcg_interleave),
+        XTL_STRATEGY(linear_interleave),
+        XTL_STRATEGY(lcg_multiplicative),
+        XTL_STRATEGY(linear_multiplicative),
+    #if !XTL_MULTI_THREADING
+        XTL_STRATEGY(cuckoo_interleave),
+        XTL_STRATEGY(static_storage),
+    #endif
+    };
+
+    size_t best   = 1;
+    double picked = 0.0, fastest_time = 0.0;
+
+    for (size_t s = 0; s < XTL_ARR_SIZE(strategies); ++s)
+    {
+        int u = 0, b = 0;
+
+        double tu = fastest([&]{ u = 0; for (size_t i = 0; i+1 < objects_num; ++i) u += strategies[s].unary(*objects[i]); });
+        double tb = fastest([&]{ b = 0; for (size_t i = 0; i+1 < objects_num; ++i) b += strategies[s].binary(*objects[i], *objects[i+1]); });
+
+        XTL_ASSERT(u == expected_unary);
+        XTL_ASSERT(b == expected_binary);
+
+        if (s == 0)
+            picked = tu + tb;
+        else
+        if (s == 1 || tu + tb < fastest_time)
+        {
+            best         = s;
+            fastest_time = tu + tb;
+        }
+
+        std::cout << std::setw(22) << strategies[s].name << ": Unary " << std::fixed << std::setprecision(2) << tu
+                  << "ns Binary " << tb << "ns" << std::endl;
+    }
+
+    std::cout << "Picked:  " << picked_policy << std::endl
+              << "Fastest: " << strategies[best].name << " (" << std::setprecision(0)
+              << 100*(picked-fastest_time)/picked << "% faster than picked)" << std::endl;
+
+    for (size_t i = 0; i < objects_num; ++i)
+        delete objects[i];
+}
+
+//------------------------------------------------------------------------------
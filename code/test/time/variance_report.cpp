@@ -0,0 +1,170 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Reports how much timings of benchmarks recorded in #XTL_RESULTS_FILE vary
+/// with the layout of the process they ran in (\see variance target of the
+/// Makefile):
+/// \code
+///     variance_report variance.jsonl [threshold-in-percent]
+/// \endcode
+/// Each layout of a test is represented by the median of medians of all its 
+/// runs in that layout. The spread of a test is the difference between its
+/// slowest and fastest layouts relative to the fastest. Tests whose spread 
+/// exceeds the threshold are marked as noisy: a speedup of them smaller than 
+/// their spread may be due to a luckier layout of vtables and code rather than
+/// to a change in the library.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include "testresults.hpp"
+
+//------------------------------------------------------------------------------
+
+/// Results of each layout for each test
+typedef std::map<std::string,std::map<std::string,test_results> > variance_results;
+
+//------------------------------------------------------------------------------
+
+bool load(const char* file_name, variance_results& results)
+{
+    std::ifstream file(file_name);
+
+    if (!file)
+    {
+        std::cerr << "ERROR: Cannot open " << file_name << std::endl;
+        return false;
+    }
+
+    for (std::string line; std::getline(file, line); )
+    {
+        if (line.empty())
+            continue;
+
+        std::string   layout = field(line,"layout");
+        test_results& r = results[field(line,"benchmark") + "/" + field(line,"test")][layout.empty() ? "default" : layout];
+        r.medians.push_back(std::atof(field(line,"median").c_str()));
+        r.deviations.push_back(std::atof(field(line,"stddev").c_str()));
+        r.unit     = field(line,"unit");
+        r.compiler = field(line,"compiler");
+        r.config   = field(line,"config");
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " variance.jsonl [threshold-in-percent]" << std::endl;
+        return 2;
+    }
+
+    const double     threshold = argc > 2 ? std::atof(argv[2]) : 5.0;
+    variance_results results;
+
+    if (!load(argv[1], results))
+        return 2;
+
+    std::vector<double> spreads;
+    size_t noisy = 0;
+
+    for (variance_results::const_iterator p = results.begin(); p != results.end(); ++p)
+    {
+        const std::map<std::string,test_results>& r = p->second;
+        const std::string& unit = r.begin()->second.unit;
+        std::string fastest, slowest;
+        double      best = 0.0, worst = 0.0;
+
+        for (std::map<std::string,test_results>::const_iterator q = r.begin(); q != r.end(); ++q)
+        {
+            if (q->second.unit != unit)
+            {
+                std::cout << "WARNING: " << p->first << " was measured in " << unit << " and " << q->second.unit << std::endl;
+                best = 0.0;
+                break;
+            }
+
+            double m = median(q->second.medians);
+
+            if (fastest.empty() || m < best)  { best  = m; fastest = q->first; }
+            if (slowest.empty() || m > worst) { worst = m; slowest = q->first; }
+        }
+
+        if (best <= 0.0)
+            continue;
+
+        if (r.size() < 2)
+        {
+            std::cout << "SINGLE  " << p->first << ": only measured in layout " << fastest << std::endl;
+            continue;
+        }
+
+        const double spread = (worst - best) / best * 100;
+        const bool   is_noisy = spread > threshold;
+
+        spreads.push_back(spread);
+        noisy += is_noisy;
+
+        std::cout << (is_noisy ? "NOISY   " : "STABLE  ") << p->first << ": " << std::fixed << std::setprecision(2)
+                  << best << " (" << fastest << ") to " << worst << " (" << slowest << ") " << unit 
+                  << " across " << r.size() << " layouts, spread " << spread << '%' << std::endl;
+    }
+
+    if (spreads.empty())
+    {
+        std::cerr << "ERROR: No test was measured in more than one layout" << std::endl;
+        return 2;
+    }
+
+    std::cout << "SUMMARY: " << noisy << " of " << spreads.size() << " tests spread over " << threshold 
+              << "%; median spread " << std::fixed << std::setprecision(2) << median(spreads) 
+              << "%, largest " << *std::max_element(spreads.begin(), spreads.end()) << '%' << std::endl;
+    return 0;
+}
@@ -0,0 +1,192 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Compares evaluation of pattern trees of virpat.hpp, as in virpat0-3.cpp,
+/// with evaluation of the same trees compiled into flat_pattern. Rules are 
+/// built once, as a rule engine loading them from a configuration would, and
+/// classify objects by the first rule that accepts them (F1: trees, F2: flat).
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <iostream>
+#include <utility>
+
+//------------------------------------------------------------------------------
+
+template <typename A, typename B>
+std::ostream& operator<<(std::ostream& os, const std::pair<A,B>& p)
+{
+    return os << '(' << p.first << ',' << p.second << ')';
+}
+
+//------------------------------------------------------------------------------
+
+typedef std::pair<int,int> loc;
+
+//------------------------------------------------------------------------------
+
+#include "virpat.hpp"
+#include "testutils.hpp"
+
+//------------------------------------------------------------------------------
+
+using namespace mch;
+
+//------------------------------------------------------------------------------
+
+struct Shape : object
+{
+    virtual bool operator==(const object& obj) const { return typeid(*this) == typeid(obj); }
+    virtual std::ostream& operator>>(std::ostream& os) const { return os << "Shape()"; }
+};
+
+struct Circle : Shape
+{
+    Circle(const loc& c, unsigned int r) : center(c), radius(r) {}
+    object_of<loc>          center;
+    object_of<unsigned int> radius;
+};
+
+struct Square : Shape
+{
+    Square(const loc& c, unsigned int s) : upper_left(c), side(s) {}
+    object_of<loc>          upper_left;
+    object_of<unsigned int> side;
+};
+
+struct Group : Shape
+{
+    Group(const Shape& a, const Shape& b) : a(&a), b(&b) {}
+    const Shape& first()  const { return *a; }
+    const Shape& second() const { return *b; }
+    const Shape* a;
+    const Shape* b;
+};
+
+namespace mch ///< Mach7 library namespace
+{
+template <> struct bindings<Circle> { Members(Circle::center    , Circle::radius); };
+template <> struct bindings<Square> { Members(Square::upper_left, Square::side);   };
+template <> struct bindings<Group>  { Members(Group::first      , Group::second);  };
+} // of namespace mch
+
+//------------------------------------------------------------------------------
+
+wildcard                 wc;
+var_of<unsigned int>     r, s, k;
+value_of<loc>            origin(loc(0,0));
+value_of<unsigned int>   one(1);
+equivalence              same_r(r);
+p_times_c<unsigned int>  twice(k, 2);
+p_plus_c<unsigned int>   inc(same_r, 1);
+
+cls_of2<Circle>          unit_at_origin(origin, one);  // 1: Unit circle at origin
+cls_of2<Circle>          circle_r(wc, r);
+cls_of2<Square>          square_r(wc, same_r);
+cls_of2<Group>           inscribed(circle_r, square_r); // 2: Circle and square of the same size
+cls_of2<Square>          square_r1(wc, inc);
+cls_of2<Group>           bigger(circle_r, square_r1);  // 3: Square one larger than circle
+cls_of2<Square>          even_square(origin, twice);   // 4: Square of even side at origin
+cls_of2<Group>           pair(wc, wc);                 // 5: Any other group
+cls_of2<Circle>          circle(wc, s);                // 6: Any other circle
+
+pattern* rules[] = {&unit_at_origin, &inscribed, &bigger, &even_square, &pair, &circle};
+const size_t number_of_rules = sizeof(rules)/sizeof(rules[0]);
+
+//------------------------------------------------------------------------------
+
+extern int classify_tree(const object*);
+extern int classify_flat(const object*);
+
+XTL_TIMED_FUNC_BEGIN
+int classify_tree(const object* obj)
+{
+    for (size_t i = 0; i < number_of_rules; ++i)
+        if (rules[i]->matches(*obj))
+            return int(i+1);
+
+    return 0;
+}
+XTL_TIMED_FUNC_END
+
+std::vector<flat_pattern> flat_rules;
+
+XTL_TIMED_FUNC_BEGIN
+int classify_flat(const object* obj)
+{
+    for (size_t i = 0; i < number_of_rules; ++i)
+        if (flat_rules[i].matches(*obj))
+            return int(i+1);
+
+    return 0;
+}
+XTL_TIMED_FUNC_END
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    for (size_t i = 0; i < number_of_rules; ++i)
+        flat_rules.push_back(flat_pattern(*rules[i]));
+
+    std::vector<const object*> shapes(N);
+
+    for (size_t i = 0; i < N; ++i)
+    {
+        const unsigned int n = std::rand() % 4;
+        const loc          l(std::rand() % 2, 0);
+        const Shape*       c = new Circle(l, n);
+        const Shape*       q = new Square(l, n + std::rand() % 2);
+
+        switch (std::rand() % 3)
+        {
+        case 0:  shapes[i] = c; break;
+        case 1:  shapes[i] = q; break;
+        default: shapes[i] = new Group(*c, *q); break;
+        }
+    }
+
+    verdict v = get_timings1<int,const object*,classify_tree,classify_flat>(shapes);
+    std::cout << "Verdict: \t" << v << std::endl;
+}
+
+//------------------------------------------------------------------------------
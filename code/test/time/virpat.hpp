@@ -35,6 +35,16 @@
 ///
 /// This file is a part of Mach7 library test suite.
 ///
+/// Patterns as run-time trees of objects with virtual calls, for patterns that
+/// are only known at run time. A tree can be compiled into a flat_pattern, 
+/// which evaluates the same tree as a contiguous array of steps in one loop:
+/// \code
+///     var_of<double> r;
+///     cls_of2<Circle> rule(wc, r);   // Built once, e.g. from a configuration
+///     flat_pattern    flat(rule);    // Compiled once
+///     if (flat.matches(obj)) ...     // Binds r just like rule.matches(obj)
+/// \endcode
+///
 /// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
 ///
 /// \see https://parasol.tamu.edu/mach7/
@@ -42,9 +52,13 @@
 /// \see https://github.com/solodon4/SELL
 ///
 
+#include <cstddef>
+#include <new>
 #include <typeinfo>
 #include <type_traits>
 #include <ostream>
+#include <vector>
+#include "memoized_cast.hpp"
 
 //------------------------------------------------------------------------------
 
@@ -123,14 +137,120 @@ unbox(const object& obj)
 
 //------------------------------------------------------------------------------
 
+class flat_pattern;
+
+//------------------------------------------------------------------------------
+
 struct pattern
 {
     virtual ~pattern() {}
     virtual bool matches(const object&) = 0;
+
+    /// Appends to code the steps matching the object in its subject register.
+    /// Patterns that do not know how to compile themselves are called as is.
+    virtual void compile(flat_pattern& code, unsigned int subject);
+};
+
+//------------------------------------------------------------------------------
+
+/// Pattern tree flattened into an array of steps, each a function with its 
+/// node and registers, run in order until one fails. Steps are laid out in 
+/// the order the tree would evaluate its nodes, so bindings happen in the
+/// same order. Nodes with sub-patterns put the sub-objects they pass down
+/// into new subject registers; leaves are called without virtual dispatch;
+/// wildcards are compiled away. The tree has to outlive the flat pattern,
+/// whose registers and temporaries make it non-reentrant, just like the tree.
+class flat_pattern
+{
+public:
+
+    struct step;
+
+    /// Function of a step, returning whether matching goes on
+    typedef bool (*step_function)(flat_pattern&, const step&);
+
+    struct step
+    {
+        step_function fn;      ///< What the step does
+        pattern*      node;    ///< Node of the tree the step is for
+        unsigned int  src;     ///< Register of the object the step looks at
+        unsigned int  dst;     ///< Register the step puts a sub-object into
+        size_t        scratch; ///< Offset of memory of the step's temporary object
+    };
+
+    explicit flat_pattern(pattern& p) : m_subjects(1), m_scratch_size(0)
+    {
+        p.compile(*this, 0);
+        m_scratch.resize((m_scratch_size + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t));
+    }
+
+    bool matches(const object& obj)
+    {
+        m_subjects[0] = &obj;
+
+        for (const step* s = m_steps.data(), *e = s + m_steps.size(); s != e; ++s)
+            if (!s->fn(*this, *s))
+                return false;
+
+        return true;
+    }
+
+    /// Number of steps the tree was compiled to
+    size_t size() const { return m_steps.size(); }
+
+    ///@{
+    /// Interface used by pattern::compile
+    unsigned int new_subject() { m_subjects.push_back(0); return unsigned(m_subjects.size() - 1); }
+
+    template <typename U>
+    size_t new_scratch()
+    {
+        const size_t offset = (m_scratch_size + std::alignment_of<U>::value - 1) / std::alignment_of<U>::value * std::alignment_of<U>::value;
+        m_scratch_size = offset + sizeof(U);
+        return offset;
+    }
+
+    void emit(step_function fn, pattern* node, unsigned int src, unsigned int dst = 0, size_t scratch = 0)
+    {
+        step s = {fn, node, src, dst, scratch};
+        m_steps.push_back(s);
+    }
+    ///@}
+
+    ///@{
+    /// Interface used by steps
+    const object& subject(unsigned int i) const      { return *m_subjects[i]; }
+    void set_subject(unsigned int i, const object& o) { m_subjects[i] = &o; }
+    void* scratch(size_t offset)                     { return reinterpret_cast<char*>(m_scratch.data()) + offset; }
+
+    /// Leaf N matching its subject, without virtual dispatch
+    template <typename N>
+    static bool leaf(flat_pattern& code, const step& s) { return static_cast<N*>(s.node)->N::matches(code.subject(s.src)); }
+
+    /// Object as T with dynamic casts memoized per dynamic type of the object
+    template <typename T>
+    static typename std::enable_if<std::is_polymorphic<T>::value, const T*>::type unbox(const object& obj) { return typeid(obj) == typeid(T) ? static_cast<const T*>(&obj) : ::memoized_cast<const T*>(&obj); }
+    template <typename T>
+    static typename std::enable_if<!std::is_polymorphic<T>::value, const T*>::type unbox(const object& obj) { return ::unbox<T>(obj); }
+
+    /// Node not compiled any further
+    static bool call(flat_pattern& code, const step& s) { return s.node->matches(code.subject(s.src)); }
+    ///@}
+
+private:
+
+    std::vector<step>             m_steps;        ///< Steps in the order of evaluation
+    std::vector<const object*>    m_subjects;     ///< Registers of objects matched by steps, the 0th is the subject
+    std::vector<std::max_align_t> m_scratch;      ///< Memory of temporary objects of steps
+    size_t                        m_scratch_size; ///< Bytes of temporary objects requested so far
 };
 
 //------------------------------------------------------------------------------
 
+inline void pattern::compile(flat_pattern& code, unsigned int subject) { code.emit(&flat_pattern::call, this, subject); }
+
+//------------------------------------------------------------------------------
+
 struct expression_pattern : pattern
 {
     virtual bool current_value_is(const object&) const = 0;
@@ -141,6 +261,7 @@ struct expression_pattern : pattern
 struct wildcard : pattern
 {
     virtual bool matches(const object&) { return true; }
+    virtual void compile(flat_pattern&, unsigned int) {}
 };
 
 //------------------------------------------------------------------------------
@@ -150,6 +271,7 @@ struct value : expression_pattern
     value(const object& obj) : m_obj(obj) {}
     virtual bool matches(const object& obj) { return m_obj == obj; }
     virtual bool current_value_is(const object& obj) const { return m_obj == obj; }
+    virtual void compile(flat_pattern& code, unsigned int subject) { code.emit(&flat_pattern::leaf<value>, this, subject); }
 
 private:
     value& operator=(const value&); ///< No assignment operator
@@ -175,6 +297,7 @@ struct value_of : expression_pattern
         else
             return false; 
     }
+    virtual void compile(flat_pattern& code, unsigned int subject) { code.emit(&flat_pattern::leaf<value_of>, this, subject); }
     const T m_value;
 
 private:
@@ -195,6 +318,7 @@ struct variable : expression_pattern
     {
         return m_obj_ref && *m_obj_ref == obj; 
     }
+    virtual void compile(flat_pattern& code, unsigned int subject) { code.emit(&flat_pattern::leaf<variable>, this, subject); }
     object* m_obj_ref;
 
 private:
@@ -225,6 +349,7 @@ struct ref_of : expression_pattern
     {
         return m_var && *m_var == obj; 
     }
+    virtual void compile(flat_pattern& code, unsigned int subject) { code.emit(&flat_pattern::leaf<ref_of>, this, subject); }
     const T* m_var;
 };
 
@@ -250,6 +375,7 @@ struct var_of : expression_pattern
         const T* p = ::unbox<T>(obj);
         return p && *p == m_var; 
     }
+    virtual void compile(flat_pattern& code, unsigned int subject) { code.emit(&flat_pattern::leaf<var_of>, this, subject); }
     operator const T&() const { return m_var; }
     operator       T&()       { return m_var; }
     T m_var;
@@ -272,6 +398,7 @@ struct cls_of0 : pattern
     {
         return unbox<T>(obj) != 0;
     }
+    virtual void compile(flat_pattern& code, unsigned int subject) { code.emit(&flat_pattern::leaf<cls_of0>, this, subject); }
 };
 
 //------------------------------------------------------------------------------
@@ -290,6 +417,23 @@ struct cls_of1 : pattern
         else
             return false; 
     }
+    virtual void compile(flat_pattern& code, unsigned int subject)
+    {
+        const unsigned int a1 = code.new_subject();
+        code.emit(&members, this, subject, a1);
+        m_p1.compile(code, a1);
+    }
+    /// Puts the member of the subject into the register of the sub-pattern
+    static bool members(flat_pattern& code, const flat_pattern::step& s)
+    {
+        if (const T* p = flat_pattern::unbox<T>(code.subject(s.src)))
+        {
+            code.set_subject(s.dst, mch::apply_member(p,mch::bindings<T>::member0()));
+            return true;
+        }
+        else
+            return false; 
+    }
 
 private:
     cls_of1& operator=(const cls_of1&); ///< No assignment operator
@@ -311,6 +455,26 @@ struct cls_of2 : pattern
         else
             return false; 
     }
+    virtual void compile(flat_pattern& code, unsigned int subject)
+    {
+        const unsigned int a1 = code.new_subject();
+        const unsigned int a2 = code.new_subject();
+        code.emit(&members, this, subject, a1);
+        m_p1.compile(code, a1);
+        m_p2.compile(code, a2);
+    }
+    /// Puts the members of the subject into the consecutive registers of the sub-patterns
+    static bool members(flat_pattern& code, const flat_pattern::step& s)
+    {
+        if (const T* p = flat_pattern::unbox<T>(code.subject(s.src)))
+        {
+            code.set_subject(s.dst,   mch::apply_member(p,mch::bindings<T>::member0()));
+            code.set_subject(s.dst+1, mch::apply_member(p,mch::bindings<T>::member1()));
+            return true;
+        }
+        else
+            return false; 
+    }
 
 private:
     cls_of2& operator=(const cls_of2&); ///< No assignment operator
@@ -340,6 +504,28 @@ struct p_plus_c : pattern
         else
             return false; 
     }
+    virtual void compile(flat_pattern& code, unsigned int subject)
+    {
+        const unsigned int a = code.new_subject();
+        code.emit(&solve, this, subject, a, code.new_scratch<object_of<T>>());
+        m_p.compile(code, a);
+    }
+    /// Puts the object the sub-pattern is matched against into a temporary
+    static bool solve(flat_pattern& code, const flat_pattern::step& s)
+    {
+        const p_plus_c& n = *static_cast<const p_plus_c*>(s.node);
+
+        if (const T* p = unbox<T>(code.subject(s.src)))
+        {
+            if (std::is_unsigned<T>::value && n.m_c > *p) 
+                return false;
+
+            code.set_subject(s.dst, *new(code.scratch(s.scratch)) object_of<T>(*p - n.m_c));
+            return true;
+        }
+        else
+            return false; 
+    }
 
 private:
     p_plus_c& operator=(const p_plus_c&); ///< No assignment operator
@@ -369,6 +555,28 @@ struct c_minus_p : pattern
         else
             return false; 
     }
+    virtual void compile(flat_pattern& code, unsigned int subject)
+    {
+        const unsigned int a = code.new_subject();
+        code.emit(&solve, this, subject, a, code.new_scratch<object_of<T>>());
+        m_p.compile(code, a);
+    }
+    /// Puts the object the sub-pattern is matched against into a temporary
+    static bool solve(flat_pattern& code, const flat_pattern::step& s)
+    {
+        const c_minus_p& n = *static_cast<const c_minus_p*>(s.node);
+
+        if (const T* p = unbox<T>(code.subject(s.src)))
+        {
+            if (std::is_unsigned<T>::value && n.m_c < *p) 
+                return false;
+
+            code.set_subject(s.dst, *new(code.scratch(s.scratch)) object_of<T>(n.m_c-*p));
+            return true;
+        }
+        else
+            return false; 
+    }
 
 private:
     c_minus_p& operator=(const c_minus_p&); ///< No assignment operator
@@ -395,6 +603,28 @@ struct p_times_c : pattern
         else
             return false; 
     }
+    virtual void compile(flat_pattern& code, unsigned int subject)
+    {
+        const unsigned int a = code.new_subject();
+        code.emit(&solve, this, subject, a, code.new_scratch<object_of<T>>());
+        m_p.compile(code, a);
+    }
+    /// Puts the object the sub-pattern is matched against into a temporary
+    static bool solve(flat_pattern& code, const flat_pattern::step& s)
+    {
+        const p_times_c& n = *static_cast<const p_times_c*>(s.node);
+
+        if (const T* p = unbox<T>(code.subject(s.src)))
+        {
+            if (std::is_integral<T>::value && *p % n.m_c != 0) 
+                return false;
+
+            code.set_subject(s.dst, *new(code.scratch(s.scratch)) object_of<T>(*p/n.m_c));
+            return true;
+        }
+        else
+            return false; 
+    }
 
 private:
     p_times_c& operator=(const p_times_c&); ///< No assignment operator
@@ -410,6 +640,7 @@ struct equivalence : expression_pattern
     equivalence(expression_pattern& p) : m_p(p) {}
     virtual bool matches(const object& obj) { return current_value_is(obj); }
     virtual bool current_value_is(const object& obj) const { return m_p.current_value_is(obj); }
+    virtual void compile(flat_pattern& code, unsigned int subject) { code.emit(&flat_pattern::leaf<equivalence>, this, subject); }
 
 private:
     equivalence& operator=(const equivalence&); ///< No assignment operator
@@ -0,0 +1,280 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Stresses vtbl maps with sets of vtbl pointers laid out adversarially for
+/// the shift of the map, the way vtables of classes from separate shared 
+/// libraries or in aligned allocations get laid out, and reports for each set 
+/// how many times the map was rearranged while it learned the set and after,
+/// how the tuples of the set share their home entries under the shift the map
+/// ended up with, and the latency of lookups in the steady state:
+/// \code
+///     vtbl_collisions [vtbls-per-set [rounds]]
+/// \endcode
+/// Vtbl pointers are synthesized around the vtable of a class of this program,
+/// so maps never dereference them. Maps of both versions, single- and multi-
+/// threaded, cannot be in the same program, so the benchmark is built once
+/// for each of them with #XTL_VTBL_MAP_VERSION and #XTL_MULTI_THREADING 
+/// (\see collisions target of the Makefile).
+///
+/// \note Sharing of home entries is only computed for vtbl_map<N,T> with the
+///       default policy, which exposes its shift; for vtblmap<T> the steady
+///       updates and the tail of the latency tell collisions apart.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#if !defined(XTL_VTBL_MAP_VERSION)
+#define XTL_VTBL_MAP_VERSION 4 // Stress vtbl_map<N,T> of type_switchN.hpp, 3 for vtblmap<T> of match.hpp
+#endif
+#if !defined(XTL_VTBL_STATISTICS)
+#define XTL_VTBL_STATISTICS 1 // Maps count their hits, misses and collisions
+#endif
+#if !defined(XTL_OVERHEAD_ACCOUNTING)
+#define XTL_OVERHEAD_ACCOUNTING 1 // Maps count their updates
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#if XTL_VTBL_MAP_VERSION == 3
+#include "vtblmap.hpp"
+#else
+#include "vtblmap4.hpp"
+#endif
+
+//------------------------------------------------------------------------------
+
+/// What a map did on one set of vtbl pointers
+struct stress_result
+{
+    stress_result() : warm_updates(0), steady_updates(0), homes(0), longest_chain(0), misses(0), lookups(0), memory(0), median(0), p99(0), worst(0) {}
+    size_t warm_updates;   ///< Updates while the map was learning the set
+    size_t steady_updates; ///< Updates after that
+    size_t homes;          ///< Distinct home entries of the set, 0 when unknown
+    size_t longest_chain;  ///< Largest number of vtbl pointers sharing a home entry, 0 when unknown
+    size_t misses;         ///< Lookups of the steady state that missed their home entry
+    size_t lookups;        ///< Lookups of the steady state
+    size_t memory;         ///< Bytes used by the map in the end
+    long long median;      ///< Latency of lookups in the steady state in ns
+    long long p99;
+    long long worst;
+};
+
+//------------------------------------------------------------------------------
+
+/// Set of n vtbl pointers named by layout with stride and offset of the i-th 
+/// pointer from base given by f(i)
+template <typename F>
+std::pair<std::string,std::vector<intptr_t> > make_set(const char* layout, intptr_t base, size_t n, F f)
+{
+    std::vector<intptr_t> vtbls(n);
+
+    for (size_t i = 0; i < n; ++i)
+        vtbls[i] = base + f(intptr_t(i));
+
+    return std::make_pair(std::string(layout), vtbls);
+}
+
+//------------------------------------------------------------------------------
+
+/// Latency of lookups through a clock whose own overhead is subtracted
+inline long long now() { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(); }
+
+//------------------------------------------------------------------------------
+
+#if XTL_VTBL_MAP_VERSION == 3
+
+typedef mch::vtblmap<mch::type_switch_info> stressed_map;
+
+/// Objects are represented by their vtbl pointer, which is all maps read of them
+inline void lookup(stressed_map& map, const intptr_t& object) { map.get(&object).target = 1; }
+
+/// vtblmap<T> does not expose its shift
+inline void home_entries(const stressed_map&, const std::vector<intptr_t>&, stress_result&) {}
+
+/// vtblmap<T> only counts its misses with #XTL_DUMP_PERFORMANCE
+inline size_t misses_of(const char*) { return 0; }
+
+#else
+
+typedef mch::vtbl_map<1,mch::type_switch_info<1> > stressed_map;
+
+inline void lookup(stressed_map& map, const intptr_t& object) { intptr_t vtbl[1] = {object}; map.get(vtbl).target = 1; }
+
+/// Home entries of the set under the shift and size the map ended up with
+inline void home_entries(const stressed_map& map, const std::vector<intptr_t>& vtbls, stress_result& r)
+{
+    std::map<size_t,size_t> chains;
+    const size_t mask = (size_t(1) << map.log_size()) - 1;
+
+    for (size_t i = 0; i < vtbls.size(); ++i)
+        r.longest_chain = (std::max)(r.longest_chain, ++chains[size_t(vtbls[i] >> map.shift(0)) & mask]);
+
+    r.homes = chains.size();
+}
+
+/// Misses counted by the statistics of the map whose Match statement is said to be in file tag
+inline size_t misses_of(const char* tag)
+{
+    size_t misses = 0;
+    mch::for_each_vtbl_site([&](const mch::vtbl_site_statistics& s) { if (s.file == tag) misses = s.misses; });
+    return misses;
+}
+
+#endif
+
+//------------------------------------------------------------------------------
+
+/// Learns vtbls in a fresh map, then looks them up rounds times in a shuffled
+/// order timing every lookup
+stress_result stress(const std::vector<intptr_t>& vtbls, size_t rounds)
+{
+    stress_result r;
+    static const char tag[] = "stress"; // Tells the map apart from others in the list of all maps
+#if XTL_VTBL_MAP_VERSION == 3
+    stressed_map map;   // Of the smallest expected size
+#else
+    const mch::vtbl_count_t clauses = 0;
+    stressed_map map(tag, 0, "", clauses);
+#endif
+    mch::overhead_snapshot before = mch::overhead_report();
+
+    // Learning: every vtbl pointer is seen for the first time in order
+    for (size_t j = 0; j < 2; ++j)
+        for (size_t i = 0; i < vtbls.size(); ++i)
+            lookup(map, vtbls[i]);
+
+    r.warm_updates = (mch::overhead_report() - before).vtbl_updates;
+    before = mch::overhead_report();
+
+    const size_t misses = misses_of(tag);
+    std::vector<long long> latencies;
+    latencies.reserve(rounds*vtbls.size());
+    unsigned int lcg = 12345;
+
+    for (size_t j = 0; j < rounds; ++j)
+        for (size_t i = 0; i < vtbls.size(); ++i)
+        {
+            lcg = lcg*1103515245 + 12345;
+            const intptr_t& vtbl = vtbls[(lcg >> 8) % vtbls.size()];
+            long long start = now();
+            lookup(map, vtbl);
+            latencies.push_back(now() - start);
+        }
+
+    r.steady_updates = (mch::overhead_report() - before).vtbl_updates;
+    r.lookups = latencies.size();
+    r.misses = misses_of(tag) - misses;
+    r.memory = map.memory_used();
+    home_entries(map, vtbls, r);
+
+    // Overhead of the clock itself is the fastest of the timings
+    const long long clock = *std::min_element(latencies.begin(), latencies.end());
+    std::sort(latencies.begin(), latencies.end());
+    r.median = latencies[latencies.size()/2]         - clock;
+    r.p99    = latencies[latencies.size()*99/100]    - clock;
+    r.worst  = latencies.back()                      - clock;
+    return r;
+}
+
+//------------------------------------------------------------------------------
+
+/// Any polymorphic class whose vtable tells where vtables of this program are
+struct anchor { virtual ~anchor() {} };
+
+//------------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    const size_t n      = argc > 1 ? std::max(2, std::atoi(argv[1])) : 64;
+    const size_t rounds = argc > 2 ? std::max(1, std::atoi(argv[2])) : 10000;
+
+    anchor a;
+    const intptr_t base = mch::vtbl_of(&a);
+
+    std::vector<std::pair<std::string,std::vector<intptr_t> > > sets;
+    // Vtables of one binary, as the library expects them
+    sets.push_back(make_set("contiguous",        base, n, [](intptr_t i) { return i*40; }));
+    // Vtables in allocations aligned on pages, e.g. of a JIT
+    sets.push_back(make_set("page-aligned",      base, n, [](intptr_t i) { return i*4096; }));
+    // Vtable at the same offset in each of many shared libraries
+    sets.push_back(make_set("one-per-dso",       base, n, [](intptr_t i) { return i*(intptr_t(1)<<21) + 0x1d48; }));
+    // Half of the vtables in this binary, half in shared libraries: no single shift separates both halves
+    sets.push_back(make_set("mixed-strides",     base, n, [](intptr_t i) { return i%2 ? (i/2+1)*(intptr_t(1)<<21) : (i/2)*16; }));
+    // Vtables differing only in bits above those any cache of the library indexes with
+    sets.push_back(make_set("high-bits-only",    base, n, [](intptr_t i) { return i*(intptr_t(1)<<(sizeof(intptr_t) > 4 ? 36 : 24)); }));
+
+    std::cout << "Stress of " << (XTL_VTBL_MAP_VERSION == 3 ? "vtblmap<T>" : "vtbl_map<N,T>") 
+              << (XTL_MULTI_THREADING ? " (multi-threaded)" : " (single-threaded)") 
+              << " with " << n << " vtbl pointers per set and " << rounds << " rounds" << std::endl;
+    std::cout << "    " << std::left << std::setw(16) << "layout" << std::right 
+              << std::setw(8) << "warm" << std::setw(8) << "steady" << std::setw(7) << "homes" << std::setw(7) << "chain" 
+              << std::setw(9) << "miss%" << std::setw(10) << "memory" << std::setw(8) << "median" << std::setw(8) << "p99" << std::setw(10) << "worst" << std::endl;
+
+    for (size_t i = 0; i < sets.size(); ++i)
+    {
+        stress_result r = stress(sets[i].second, rounds);
+        std::cout << "    " << std::left << std::setw(16) << sets[i].first << std::right 
+                  << std::setw(8) << r.warm_updates << std::setw(8) << r.steady_updates;
+
+        if (r.homes)
+            std::cout << std::setw(7) << r.homes << std::setw(7) << r.longest_chain 
+                      << std::setw(9) << std::fixed << std::setprecision(2) << 100.0*r.misses/r.lookups;
+        else
+            std::cout << std::setw(7) << '-' << std::setw(7) << '-' << std::setw(9) << '-';
+
+        std::cout << std::setw(10) << r.memory << std::setw(8) << r.median << std::setw(8) << r.p99 << std::setw(10) << r.worst << std::endl;
+    }
+
+    std::cout << "warm/steady - updates while learning the set/after; homes - distinct home entries of the set;" << std::endl
+              << "chain - most vtbl pointers sharing a home entry; median, p99, worst - lookup latency in ns" << std::endl;
+    return 0;
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,323 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Generates a GNU ld script that places vtables of classes seen by Match 
+/// statements of a trace recorded with #XTL_TRACE_MATCH_SITES one after 
+/// another at addresses a power of 2 apart, so that vtbl pointers of classes 
+/// seen by the same Match statement differ in consecutive values of the bits
+/// vtbl maps take their cache index from and do not collide:
+/// \code
+///     vtbl_sections trace-file symbols-file [log-stride] > vtbls.ld
+/// \endcode
+/// The symbols file is the output of <tt>nm -S --defined-only</tt> of the 
+/// program that recorded the trace, which has to be linked with -no-pie for
+/// vtbl pointers of the trace to be addresses of its symbols. The program is 
+/// then relinked with -fdata-sections and <tt>-Wl,-T,vtbls.ld</tt> (\see 
+/// vtbl-sections target of the Makefile). Sites are taken in the order of 
+/// their number of executions and vtables of each site in the order of their
+/// frequency, so the hottest sites get their vtables contiguous. Vtables of
+/// classes shared by sites are placed once, which is why the collisions still
+/// predicted for each site with the smallest cache that fits its classes are
+/// reported on the standard error.
+///
+/// \note The linker only aligns the start of each vtable, so the stride is 
+///       the smallest power of 2 the largest vtable fits in, unless given.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cxxabi.h>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "tracing.hpp"
+
+//------------------------------------------------------------------------------
+
+/// Vtable symbol of the program that recorded the trace
+struct vtbl_symbol
+{
+    vtbl_symbol() : address(0), size(0), executions(0) {}
+    std::uintptr_t address;    ///< Address of the vtable, not of its vtbl pointer
+    std::uintptr_t size;       ///< Size of the vtable in bytes
+    std::string    name;       ///< Mangled name of the vtable
+    std::uint64_t  executions; ///< Number of traced executions that saw it
+};
+
+/// Vtables seen by one Match statement and how many times each
+struct site_vtbls
+{
+    site_vtbls() : executions(0) {}
+    std::uint64_t                 executions; ///< Number of traced executions of the site
+    std::map<size_t,std::uint64_t> seen;       ///< Index of the vtable symbol to the number of its executions
+};
+
+//------------------------------------------------------------------------------
+
+/// Reads vtable symbols from the output of nm -S, sorted by address
+bool load_symbols(const char* file_name, std::vector<vtbl_symbol>& symbols)
+{
+    std::ifstream file(file_name);
+
+    if (!file)
+    {
+        std::cerr << "ERROR: Cannot open " << file_name << std::endl;
+        return false;
+    }
+
+    std::string line;
+
+    while (std::getline(file, line))
+    {
+        std::istringstream ss(line);
+        std::string address, size, type;
+        vtbl_symbol s;
+
+        // Symbols without size have only 3 fields and are not of interest
+        if (ss >> address >> size >> type >> s.name && s.name.compare(0, 4, "_ZTV") == 0)
+        {
+            s.address = std::uintptr_t(std::strtoull(address.c_str(), 0, 16));
+            s.size    = std::uintptr_t(std::strtoull(size.c_str(),    0, 16));
+            symbols.push_back(s);
+        }
+    }
+
+    std::sort(symbols.begin(), symbols.end(), [](const vtbl_symbol& a, const vtbl_symbol& b) { return a.address < b.address; });
+    return true;
+}
+
+//------------------------------------------------------------------------------
+
+/// Index of the vtable symbol the vtbl pointer points into or symbols.size()
+size_t symbol_of(const std::vector<vtbl_symbol>& symbols, std::intptr_t vtbl)
+{
+    const std::uintptr_t a = std::uintptr_t(vtbl);
+    std::vector<vtbl_symbol>::const_iterator p = std::upper_bound(
+        symbols.begin(), symbols.end(), a, 
+        [](std::uintptr_t x, const vtbl_symbol& s) { return x < s.address; }
+    );
+
+    if (p == symbols.begin() || a >= (p-1)->address + (p-1)->size)
+        return symbols.size();
+
+    return size_t(p - symbols.begin()) - 1;
+}
+
+//------------------------------------------------------------------------------
+
+/// Reads the records of a file written by mch::match_trace_flush() into the
+/// vtables seen by each site. Vtbl pointers that are not in any vtable symbol,
+/// e.g. of a program linked as position independent, are counted in unknown.
+bool load_trace(const char* file_name, std::vector<vtbl_symbol>& symbols, std::map<std::uint32_t,site_vtbls>& sites, size_t& unknown)
+{
+    std::ifstream file(file_name, std::ios::binary);
+    mch::match_trace_header header;
+
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, "MACH7TRC", sizeof(header.magic)) != 0 ||
+        header.record_size != 16 + header.subjects*sizeof(std::intptr_t))
+    {
+        std::cerr << "ERROR: " << file_name << " is not a trace of Match statements of this platform" << std::endl;
+        return false;
+    }
+
+    std::vector<char> record(header.record_size);
+
+    for (std::uint64_t i = 0; i < header.records && file.read(&record[0], std::streamsize(record.size())); ++i)
+    {
+        std::uint32_t site;
+        std::memcpy(&site, &record[8], sizeof(site));
+
+        site_vtbls& s = sites[site];
+        ++s.executions;
+
+        for (size_t j = 0; j < header.subjects; ++j)
+        {
+            std::intptr_t vtbl;
+            std::memcpy(&vtbl, &record[16 + j*sizeof(vtbl)], sizeof(vtbl));
+
+            if (!vtbl)
+                continue;
+
+            const size_t k = symbol_of(symbols, vtbl);
+
+            if (k == symbols.size())
+                ++unknown;
+            else
+            {
+                ++s.seen[k];
+                ++symbols[k].executions;
+            }
+        }
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+
+/// Demangled name of a symbol for comments in the script
+std::string demangled(const std::string& name)
+{
+    int status = 0;
+    char* d = abi::__cxa_demangle(name.c_str(), 0, 0, &status);
+    std::string result = status == 0 && d ? d : name;
+    std::free(d);
+    return result;
+}
+
+//------------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " trace-file symbols-file [log-stride]" << std::endl;
+        return 1;
+    }
+
+    std::vector<vtbl_symbol> symbols;
+    std::map<std::uint32_t,site_vtbls> sites;
+    size_t unknown = 0;
+
+    if (!load_symbols(argv[2], symbols) || !load_trace(argv[1], symbols, sites, unknown))
+        return 1;
+
+    if (unknown)
+        std::cerr << "WARNING: " << unknown << " vtbl pointers of the trace are not in vtables of " << argv[2] 
+                  << ", was the program linked with -no-pie?" << std::endl;
+
+    // Sites in the order of their number of executions
+    std::vector<std::uint32_t> order;
+
+    for (std::map<std::uint32_t,site_vtbls>::const_iterator p = sites.begin(); p != sites.end(); ++p)
+        order.push_back(p->first);
+
+    std::stable_sort(order.begin(), order.end(), [&](std::uint32_t a, std::uint32_t b) { return sites[a].executions > sites[b].executions; });
+
+    // Vtables of each site in the order of their frequency, each placed once
+    std::vector<size_t> placed;
+    std::map<size_t,size_t> position; // Index of the vtable symbol to its position in placed
+
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        const site_vtbls& s = sites[order[i]];
+        std::vector<std::pair<std::uint64_t,size_t> > seen;
+
+        for (std::map<size_t,std::uint64_t>::const_iterator p = s.seen.begin(); p != s.seen.end(); ++p)
+            seen.push_back(std::make_pair(p->second, p->first));
+
+        std::stable_sort(seen.begin(), seen.end(), [](const std::pair<std::uint64_t,size_t>& a, const std::pair<std::uint64_t,size_t>& b) { return a.first > b.first; });
+
+        for (size_t j = 0; j < seen.size(); ++j)
+            if (position.insert(std::make_pair(seen[j].second, placed.size())).second)
+                placed.push_back(seen[j].second);
+    }
+
+    if (placed.empty())
+    {
+        std::cerr << "ERROR: No vtables of " << argv[2] << " were seen in " << argv[1] << std::endl;
+        return 1;
+    }
+
+    size_t log_stride = 0;
+
+    if (argc > 3)
+        log_stride = size_t(std::atoi(argv[3]));
+    else
+        for (size_t i = 0; i < placed.size(); ++i)
+            while ((std::uintptr_t(1) << log_stride) < symbols[placed[i]].size)
+                ++log_stride;
+
+    const std::uintptr_t stride = std::uintptr_t(1) << log_stride;
+
+    // Collisions left for each site in the smallest cache its vtables fit in, 
+    // when indexed by the bits above the stride
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        const site_vtbls& s = sites[order[i]];
+        size_t log_size = 0;
+
+        while ((size_t(1) << log_size) < s.seen.size())
+            ++log_size;
+
+        std::set<size_t> indices;
+
+        for (std::map<size_t,std::uint64_t>::const_iterator p = s.seen.begin(); p != s.seen.end(); ++p)
+            indices.insert(position[p->first] & ((size_t(1) << log_size) - 1));
+
+        std::cerr << "Site " << order[i] << ": " << s.executions << " executions, " << s.seen.size() 
+                  << " vtables, " << s.seen.size() - indices.size() << " predicted collisions in a cache of " 
+                  << (size_t(1) << log_size) << " entries" << std::endl;
+    }
+
+    std::cout << "/* Generated by vtbl_sections from " << argv[1] << ": " << placed.size() 
+              << " vtables " << stride << " bytes apart */" << std::endl
+              << "SECTIONS" << std::endl
+              << "{" << std::endl
+              << "    .data.rel.ro.mach7.vtbls ALIGN(" << stride << ") :" << std::endl
+              << "    {" << std::endl;
+
+    for (size_t i = 0; i < placed.size(); ++i)
+    {
+        const vtbl_symbol& s = symbols[placed[i]];
+
+        if (s.size > stride)
+            std::cerr << "WARNING: " << demangled(s.name) << " of " << s.size << " bytes does not fit the stride" << std::endl;
+
+        std::cout << "        . = ALIGN(" << stride << "); /* " << demangled(s.name) << ", " << s.executions << " executions */" << std::endl
+                  << "        KEEP(*(.data.rel.ro." << s.name << " .data.rel.ro.local." << s.name << " .rodata." << s.name << "))" << std::endl;
+    }
+
+    std::cout << "    }" << std::endl
+              << "}" << std::endl
+              << "INSERT AFTER .data.rel.ro;" << std::endl;
+}
+
+//------------------------------------------------------------------------------
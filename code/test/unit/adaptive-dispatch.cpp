@@ -0,0 +1,211 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that vtbl maps of Match statements pick their engine from the 
+/// profile of their lookups: compares with the only or the few tuples of vtbl
+/// pointers a site sees and the hash for the others, that a site seeing other 
+/// tuples too often profiles again, and that the decisions are reported with 
+/// the rest of the statistics (#XTL_ADAPTIVE_DISPATCH).
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_ADAPTIVE_DISPATCH       1
+#define XTL_ADAPTIVE_PROFILE_LENGTH 64
+#define XTL_VTBL_STATISTICS         1 // To see the decisions
+
+#include <cstring>
+#include <iostream>
+#include "type_switchN-patterns.hpp"
+#include "patterns/constructor.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Shape                  { virtual ~Shape() {} };
+struct Circle   : Shape       {};
+struct Square   : Shape       {};
+struct Triangle : Shape       {};
+struct Polygon  : Shape       {};
+struct Ellipse  : Shape       {};
+struct Rhombus  : Shape       {};
+
+//------------------------------------------------------------------------------
+
+using mch::C;
+
+int monomorphic(const Shape& s)
+{
+    Match(s)
+    {
+        Case(C<Circle>())   return 1;
+        Case(C<Square>())   return 2;
+        Case(C<Triangle>()) return 3;
+        Otherwise()         return 0;
+    }
+    EndMatch
+
+    return -1;
+}
+
+int polymorphic(const Shape& s)
+{
+    Match(s)
+    {
+        Case(C<Circle>())   return 1;
+        Case(C<Square>())   return 2;
+        Otherwise()         return 0;
+    }
+    EndMatch
+
+    return -1;
+}
+
+int megamorphic(const Shape& s)
+{
+    Match(s)
+    {
+        Case(C<Circle>())   return 1;
+        Case(C<Square>())   return 2;
+        Case(C<Triangle>()) return 3;
+        Case(C<Polygon>())  return 4;
+        Case(C<Ellipse>())  return 5;
+        Otherwise()         return 0;
+    }
+    EndMatch
+
+    return -1;
+}
+
+int intersect(const Shape& a, const Shape& b)
+{
+    Match(a,b)
+    {
+        Case(C<Circle>(), C<Circle>()) return 11;
+        Case(C<Circle>(), C<Square>()) return 12;
+        Case(C<Square>(), C<Circle>()) return 21;
+        Otherwise()                    return 0;
+    }
+    EndMatch
+
+    return -1;
+}
+
+int drifting(const Shape& s)
+{
+    Match(s)
+    {
+        Case(C<Circle>())   return 1;
+        Case(C<Square>())   return 2;
+        Case(C<Triangle>()) return 3;
+        Otherwise()         return 0;
+    }
+    EndMatch
+
+    return -1;
+}
+
+//------------------------------------------------------------------------------
+
+/// Statistics of the site in the function with the given name
+mch::vtbl_site_statistics site(const char* func)
+{
+    mch::vtbl_site_statistics r = {};
+    mch::for_each_vtbl_site([&r,func](const mch::vtbl_site_statistics& s) { if (std::strcmp(s.func, func) == 0) r = s; });
+    return r;
+}
+
+/// Whether the site compares with the tuples seen by its profile or went back
+/// to the hash because compares were measured slower than it
+bool uses(const mch::vtbl_site_statistics& s, const char* engine)
+{
+    return std::strcmp(s.engine, engine) == 0 ? s.engine_hits != 0 : std::strcmp(s.engine, "hashing") == 0 && s.benefit() < 0;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    const int n = 8*XTL_ADAPTIVE_PROFILE_LENGTH;
+
+    Circle c; Square s; Triangle t; Polygon p; Ellipse e; Rhombus r;
+    const Shape* all[] = {&c, &s, &t, &p, &e, &r};
+    const int    ids[] = { 1,  2,  3,  4,  5,  0};
+
+    for (int i = 0; i < n; ++i)
+    {
+        XTL_VERIFY(monomorphic(t) == 3);
+        XTL_VERIFY(polymorphic(*all[i%2]) == ids[i%2]);
+        XTL_VERIFY(megamorphic(*all[i%6]) == ids[i%6]);
+        XTL_VERIFY(intersect(*all[i%3/2], *all[(i+1)%3/2]) == (i%3 == 0 ? 11 : i%3 == 1 ? 12 : 21));
+    }
+
+    mch::vtbl_site_statistics mono = site("monomorphic");
+    mch::vtbl_site_statistics poly = site("polymorphic");
+    mch::vtbl_site_statistics mega = site("megamorphic");
+    mch::vtbl_site_statistics pair = site("intersect");
+
+    XTL_VERIFY(uses(mono, "monomorphic"));
+    XTL_VERIFY(uses(poly, "polymorphic"));
+    XTL_VERIFY(uses(pair, "polymorphic"));
+    XTL_VERIFY(std::strcmp(mega.engine, "hashing") == 0);
+    XTL_VERIFY(mega.engine_hits == 0);
+    XTL_VERIFY(mega.benefit() == 0);
+    XTL_VERIFY(mono.profile_cycles > 0);
+    XTL_VERIFY(mono.engine_switches != 0);
+
+    // Starts monomorphic, then sees 3 types in turn
+    for (int i = 0; i < n; ++i)
+        XTL_VERIFY(drifting(c) == 1);
+
+    mch::vtbl_site_statistics before = site("drifting");
+
+    for (int i = 0; i < n; ++i)
+        XTL_VERIFY(drifting(*all[i%3]) == ids[i%3]);
+
+    mch::vtbl_site_statistics after = site("drifting");
+
+    XTL_VERIFY(uses(before, "monomorphic"));
+    XTL_VERIFY(std::strcmp(after.engine, "hashing") == 0);  // 3 tuples are too many for N=1
+    if (std::strcmp(before.engine, "monomorphic") == 0) // Unless it went back to the hash
+        XTL_VERIFY(after.engine_switches > before.engine_switches);
+}
+
+//------------------------------------------------------------------------------
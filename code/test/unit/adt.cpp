@@ -0,0 +1,184 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that values of mch::adt are matched by MatchK on their tag, that
+/// recursive terms of it can live in an arena, and that alternatives are 
+/// copied, moved and destroyed as they would have been on their own.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <iostream>
+#include <string>
+#include "adt.hpp"
+#include "arena.hpp"
+#include "match.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Num; struct Add; struct Mul;
+
+typedef mch::adt<Num,Add,Mul> Expr; ///< ML: type expr = Num of int | Add of expr * expr | Mul of expr * expr
+
+struct Num { int value; };
+struct Add { const Expr* e1; const Expr* e2; };
+struct Mul { const Expr* e1; const Expr* e2; };
+
+namespace mch ///< Mach7 library namespace
+{
+template <> struct bindings<Num> { Members(Num::value); };
+template <> struct bindings<Add> { Members(Add::e1, Add::e2); };
+template <> struct bindings<Mul> { Members(Mul::e1, Mul::e2); };
+} // of namespace mch
+
+//------------------------------------------------------------------------------
+
+int eval(const Expr& e)
+{
+    MatchK(e)
+    {
+        CaseK(Num, n)     return n;
+        CaseK(Add, e1,e2) return eval(*e1) + eval(*e2);
+        CaseK(Mul, e1,e2) return eval(*e1) * eval(*e2);
+    }
+    EndMatchK
+
+    return -1;
+}
+
+//------------------------------------------------------------------------------
+
+int probes = 0; ///< Number of Probe objects alive
+
+struct Text  { std::string text; };
+struct Probe { Probe(int t) : tag(t) { ++probes; } Probe(const Probe& p) : tag(p.tag) { ++probes; } ~Probe() { --probes; } int tag; };
+
+typedef mch::adt<int,Text,Probe> Value;
+
+namespace mch ///< Mach7 library namespace
+{
+template <> struct bindings<Text>  { Members(Text::text); };
+template <> struct bindings<Probe> { Members(Probe::tag); };
+} // of namespace mch
+
+int size(const Value& v)
+{
+    MatchK(v)
+    {
+        CaseK(int)     return 1;
+        CaseK(Text, t) return int(t.size());
+        CaseK(Probe)   return -matched->tag;
+    }
+    EndMatchK
+
+    return -1;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    // Tag is the first byte followed by alternatives of at most two pointers
+    static_assert(sizeof(Expr) == 3*sizeof(void*), "Expected the tag and the largest alternative");
+    static_assert(std::is_trivially_destructible<Expr>::value, "Expected trivial destructor of trivial alternatives");
+    static_assert(!std::is_trivially_destructible<Value>::value, "Expected destructor of non-trivial alternatives");
+    static_assert(Expr::kind_of<Mul>() == 2, "Expected kinds numbered in the order of alternatives");
+
+    {
+        mch::arena<Expr> a(256); // Small chunks to make the terms span several of them
+
+        const Expr* e = a.make<Expr>(Num{1});
+
+        for (int i = 2; i <= 50; ++i)
+            e = a.make<Expr>(i % 2 ? Expr(Add{e, a.make<Expr>(Num{i})}) : Expr(Mul{a.make<Expr>(Num{1}), e}));
+
+        XTL_VERIFY(eval(*e) == 625); // Odd numbers up to 49 added, multiplications by 1 don't change it
+        XTL_VERIFY(a.size() == 1 + 49*2);
+
+        Expr x = Add{a.make<Expr>(Num{6}), a.make<Expr>(Num{7})};
+        XTL_VERIFY(eval(x) == 13);
+        XTL_VERIFY(x.get<Add>().e1->get_if<Num>()->value == 6);
+        XTL_VERIFY(x.get_if<Num>() == nullptr);
+
+        x.emplace<Mul>(x.get<Add>().e1, x.get<Add>().e2);
+        XTL_VERIFY(x.kind() == Expr::kind_of<Mul>());
+        XTL_VERIFY(eval(x) == 42);
+    }
+
+    {
+        Value v; // Default-constructs the first alternative
+        XTL_VERIFY(v.is<int>());
+        XTL_VERIFY(size(v) == 1);
+
+        v = Text{"abcd"};
+        XTL_VERIFY(size(v) == 4);
+
+        Value w = v;
+        w.get<Text>().text += "ef";
+        XTL_VERIFY(size(v) == 4);
+        XTL_VERIFY(size(w) == 6);
+
+        v = std::move(w);
+        XTL_VERIFY(size(v) == 6);
+
+        v = Probe(1);                  // Temporaries made on the way are destroyed
+        XTL_VERIFY(size(v) == -1);
+        XTL_VERIFY(probes == 1);
+
+        Value c(v);
+        c.get<Probe>().tag = 2;
+        XTL_VERIFY(size(c) == -2);
+        XTL_VERIFY(size(v) == -1);
+        XTL_VERIFY(probes == 2);
+
+        c = v;                         // Same alternative is assigned
+        XTL_VERIFY(size(c) == -1);
+        XTL_VERIFY(probes == 2);
+
+        c = 7;                         // Destroys the Probe it held
+        XTL_VERIFY(probes == 1);
+        XTL_VERIFY(c.get<int>() == 7);
+    }
+
+    XTL_VERIFY(probes == 0);             // v destroyed its Probe at the end of the scope
+}
+
+//------------------------------------------------------------------------------
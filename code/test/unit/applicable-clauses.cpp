@@ -0,0 +1,155 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that under XTL_APPLICABLE_CLAUSES fall-through Match statements run
+/// the bodies of the same clauses on cache hits, where applicability of the 
+/// clauses comes from the vtbl map, as on the miss that tested them, including
+/// when a break leaves some clauses untested.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_FALL_THROUGH       1
+#define XTL_APPLICABLE_CLAUSES 1
+
+#include <iostream>
+#include <string>
+#include "type_switchN-patterns.hpp"
+#include "patterns/primitive.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Shape              { virtual ~Shape() {} bool last = false; };
+struct Circle : Shape     {};
+struct Oval   : Circle    {};
+struct Square : Shape     {};
+struct Cube   : Square    {};
+
+//------------------------------------------------------------------------------
+
+/// Labels of all clauses that apply to s, stopping after the clause with break
+std::string all_fits(const Shape& shape)
+{
+    mch::var<const Oval&>   o;
+    mch::var<const Circle&> c;
+    mch::var<const Cube&>   q;
+    mch::var<const Square&> s;
+    mch::var<const Shape&>  x;
+    std::string r;
+
+    Match(shape)
+    {
+    Case(o) r += 'o';
+    Case(c) r += 'c'; if (shape.last) break;
+    Case(q) r += 'q';
+    Case(s) r += 's';
+    Case(x) r += 'x';
+    }
+    EndMatch
+
+    return r;
+}
+
+/// Labels of all clauses that apply to a pair of shapes
+std::string all_fits(const Shape& a, const Shape& b)
+{
+    mch::var<const Circle&> c1, c2;
+    mch::var<const Square&> s2;
+    mch::var<const Shape&>  x1, x2;
+    std::string r;
+
+    Match(a,b)
+    {
+    Case(c1, c2) r += '1';
+    Case(c1, x2) r += '2';
+    Case(x1, s2) r += '3';
+    Case(x1, x2) r += '4';
+    }
+    EndMatch
+
+    return r;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename T> bool is(const Shape& s) { return dynamic_cast<const T*>(&s) != 0; }
+
+std::string expected(const Shape& s)
+{
+    std::string r;
+    if (is<Oval>(s))   r += 'o';
+    if (is<Circle>(s)) { r += 'c'; if (s.last) return r; }
+    if (is<Cube>(s))   r += 'q';
+    if (is<Square>(s)) r += 's';
+    r += 'x';
+    return r;
+}
+
+std::string expected(const Shape& a, const Shape& b)
+{
+    std::string r;
+    if (is<Circle>(a) && is<Circle>(b)) r += '1';
+    if (is<Circle>(a))                  r += '2';
+    if (is<Square>(b))                  r += '3';
+    r += '4';
+    return r;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    Shape x; Circle c; Oval o; Square s; Cube q;
+    Circle c2; c2.last = true;
+    Oval   o2; o2.last = true;
+    Shape* shapes[] = { &c2, &x, &c, &o, &s, &q, &o2 };
+    const size_t n = XTL_ARR_SIZE(shapes);
+
+    for (size_t r = 0; r < 3; ++r)
+        for (size_t i = 0; i < n; ++i)
+        {
+            XTL_VERIFY(all_fits(*shapes[i]) == expected(*shapes[i]));
+
+            for (size_t j = 0; j < n; ++j)
+                XTL_VERIFY(all_fits(*shapes[i],*shapes[j]) == expected(*shapes[i],*shapes[j]));
+        }
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,138 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that objects of a hierarchy made in mch::arena are matched as those
+/// made with new, are properly aligned and laid out in order of creation, and
+/// that only destructors that are not trivial get called, in reverse order.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "arena.hpp"
+#include "match.hpp"
+
+//------------------------------------------------------------------------------
+
+std::vector<int> destroyed; ///< Tags of destroyed objects in order of destruction
+
+struct Node                    { virtual ~Node() {} };
+struct Leaf  : Node            { Leaf(int v) : value(v) {} int value; };
+struct Pair  : Node            { Pair(const Node* l, const Node* r) : left(l), right(r) {} const Node* left; const Node* right; };
+struct Name  : Node            { Name(const char* s, int t) : text(s), tag(t) {} ~Name() { destroyed.push_back(tag); } std::string text; int tag; };
+struct alignas(32) Wide : Node { double d[3]; };
+
+namespace mch ///< Mach7 library namespace
+{
+template <> struct bindings<Leaf> { Members(Leaf::value); };
+template <> struct bindings<Pair> { Members(Pair::left, Pair::right); };
+template <> struct bindings<Name> { Members(Name::text); };
+} // of namespace mch
+
+//------------------------------------------------------------------------------
+
+/// Sum of leaves plus lengths of names in a tree
+int eval(const Node& n)
+{
+    Match(n)
+    {
+        Case(Leaf, v)    return v;
+        Case(Pair, l, r) return eval(*l) + eval(*r);
+        Case(Name, s)    return int(s.size());
+    }
+    EndMatch
+
+    return -1;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    {
+        mch::arena<Node> a(256); // Small chunks to make the test span several of them
+
+        std::vector<const Node*> leaves;
+
+        for (int i = 0; i < 100; ++i)
+            leaves.push_back(a.make<Leaf>(i));
+
+        // Leaves of a chunk follow each other in memory
+        XTL_VERIFY(reinterpret_cast<const char*>(leaves[1]) - reinterpret_cast<const char*>(leaves[0]) == sizeof(Leaf));
+
+        const Node* tree = a.make<Name>("abc", 1);
+
+        for (size_t i = 0; i < leaves.size(); ++i)
+        {
+            if (i == 50)
+                tree = a.make<Pair>(tree, a.make<Name>("de", 2));
+
+            tree = a.make<Pair>(tree, leaves[i]);
+        }
+
+        XTL_VERIFY(eval(*tree) == 4950 + 3 + 2);
+
+        Wide* w = a.make<Wide>();
+        XTL_VERIFY(reinterpret_cast<uintptr_t>(w) % alignof(Wide) == 0);
+        XTL_VERIFY(eval(*w) == -1);
+
+        // Object larger than a chunk gets a chunk of its own
+        struct Big : Node { char bytes[1000]; };
+        XTL_VERIFY(a.make<Big>() != 0);
+
+        XTL_VERIFY(a.size() == 100 + 1 + 2 + 100 + 1 + 1); // Leaves, names and pairs, Wide and Big
+        XTL_VERIFY(destroyed.empty());
+
+        a.clear();
+        XTL_VERIFY(a.size() == 0);
+        XTL_VERIFY(destroyed == std::vector<int>({2, 1})); // Only Name has a destructor to run
+
+        // Arena can be reused after it was cleared
+        a.make<Name>("f", 3);
+        XTL_VERIFY(eval(*a.make<Leaf>(7)) == 7);
+    }
+
+    XTL_VERIFY(destroyed == std::vector<int>({2, 1, 3}));
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,246 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Decomposes tuple-like types and, with C++17, aggregates with bindings that
+/// are derived from them rather than written with #CM, and checks that the 
+/// members the patterns are applied to are the elements themselves.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include "type_switchN-patterns.hpp"
+#include "patterns/all.hpp"
+#include "adapters/std/adapt_std_tuple.hpp"
+
+#include <iostream>
+#include <string>
+
+//------------------------------------------------------------------------------
+
+namespace geo
+{
+    /// Tuple-like class with its own get found by argument-dependent lookup
+    struct Segment { int from; int to; };
+
+    template <size_t I> const int& get(const Segment& s) noexcept { return I == 0 ? s.from : s.to; }
+    template <size_t I>       int& get(      Segment& s) noexcept { return I == 0 ? s.from : s.to; }
+}
+
+#if XTL_SUPPORT(structured_bindings)
+struct Point { int x; int y; };
+struct Named { std::string name; double weight; char grade; };
+
+static_assert(mch::aggregate_arity<Point>::value == 2, "Point has 2 data members");
+static_assert(mch::aggregate_arity<Named>::value == 3, "Named has 3 data members");
+#endif
+
+namespace mch ///< Mach7 library namespace
+{
+template <> struct bindings<geo::Segment> : tuple_bindings<geo::Segment> {};
+#if XTL_SUPPORT(structured_bindings)
+template <> struct bindings<Point> : aggregate_bindings<Point> {};
+template <> struct bindings<Named> : aggregate_bindings<Named> {};
+#endif
+} // of namespace mch
+
+// Match statements take commas in template arguments as separators of subjects
+typedef std::tuple<int,double,char> triple;
+typedef std::pair<int,int>          couple;
+typedef std::array<int,3>           vector3;
+
+//------------------------------------------------------------------------------
+
+int classify(const triple& t)
+{
+    using namespace mch;
+
+    var<double> d;
+    var<char>   c;
+
+    Match(t)
+    {
+        Case(C<triple>(0, _, _))                           return 0;
+        Case(C<triple>(1, d |= d > 0.5, _))                return 1;
+        Case(C<triple>(_, _, c |= c == 'x'))               return 2;
+    }
+    EndMatch
+
+    return 3;
+}
+
+int classify(const couple& p)
+{
+    using namespace mch;
+
+    var<int> n;
+
+    Match(p)
+    {
+        Case(C<couple>(n, +n))                             return 0;   // Same value twice
+        Case(C<couple>(_, 0))                              return 1;
+    }
+    EndMatch
+
+    return 2;
+}
+
+int classify(const vector3& a)
+{
+    using namespace mch;
+
+    var<int> n;
+
+    Match(a)
+    {
+        Case(C<vector3>(0, 0, 0))                          return 0;
+        Case(C<vector3>(_, n |= n < 0, _))                 return 1;
+    }
+    EndMatch
+
+    return 2;
+}
+
+int classify(const geo::Segment& s)
+{
+    using namespace mch;
+
+    var<int> n;
+
+    Match(s)
+    {
+        Case(C<geo::Segment>(n, +n))                       return 0;   // Empty
+        Case(C<geo::Segment>(0, _))                        return 1;
+    }
+    EndMatch
+
+    return 2;
+}
+
+#if XTL_SUPPORT(structured_bindings)
+int classify(const Point& p)
+{
+    using namespace mch;
+
+    var<int> n;
+
+    Match(p)
+    {
+        Case(C<Point>(0, 0))                               return 0;
+        Case(C<Point>(n, +n))                              return 1;   // On the diagonal
+        Case(C<Point>(_, n |= n < 0))                      return 2;
+    }
+    EndMatch
+
+    return 3;
+}
+
+int classify(const Named& v)
+{
+    using namespace mch;
+
+    var<double> w;
+
+    Match(v)
+    {
+        Case(C<Named>(std::string("root"), _, _))          return 0;
+        Case(C<Named>(_, w |= w > 1.0, 'A'))               return 1;
+    }
+    EndMatch
+
+    return 2;
+}
+#endif
+
+//------------------------------------------------------------------------------
+
+/// Address of the object the I-th member of bindings of T refers to in t
+template <typename T, size_t I>
+const void* address_of_member(const T& t)
+{
+    return &mch::apply_member(&t, mch::binding_of<mch::bindings<T>,I>::get());
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    XTL_VERIFY(classify(std::make_tuple(0, 0.0, 'a')) == 0);
+    XTL_VERIFY(classify(std::make_tuple(1, 0.7, 'a')) == 1);
+    XTL_VERIFY(classify(std::make_tuple(1, 0.2, 'x')) == 2);
+    XTL_VERIFY(classify(std::make_tuple(2, 0.2, 'y')) == 3);
+
+    XTL_VERIFY(classify(std::make_pair(4, 4))         == 0);
+    XTL_VERIFY(classify(std::make_pair(4, 0))         == 1);
+    XTL_VERIFY(classify(std::make_pair(4, 5))         == 2);
+
+    std::array<int,3> a0 = {{0, 0, 0}}, a1 = {{1,-1, 1}}, a2 = {{1, 1, 1}};
+    XTL_VERIFY(classify(a0) == 0);
+    XTL_VERIFY(classify(a1) == 1);
+    XTL_VERIFY(classify(a2) == 2);
+
+    geo::Segment s0 = {3, 3}, s1 = {0, 3}, s2 = {1, 3};
+    XTL_VERIFY(classify(s0) == 0);
+    XTL_VERIFY(classify(s1) == 1);
+    XTL_VERIFY(classify(s2) == 2);
+
+    std::pair<int,int> p(1, 2);
+    XTL_VERIFY((address_of_member<std::pair<int,int>,1>(p) == &p.second));
+    XTL_VERIFY((address_of_member<geo::Segment,1>(s1)      == &s1.to));
+    XTL_VERIFY((address_of_member<std::array<int,3>,2>(a1) == &a1[2]));
+
+#if XTL_SUPPORT(structured_bindings)
+    Point q0 = {0, 0}, q1 = {2, 2}, q2 = {1, -1}, q3 = {1, 2};
+    XTL_VERIFY(classify(q0) == 0);
+    XTL_VERIFY(classify(q1) == 1);
+    XTL_VERIFY(classify(q2) == 2);
+    XTL_VERIFY(classify(q3) == 3);
+
+    Named n0 = {"root", 0.0, 'B'}, n1 = {"leaf", 2.0, 'A'}, n2 = {"leaf", 0.5, 'A'};
+    XTL_VERIFY(classify(n0) == 0);
+    XTL_VERIFY(classify(n1) == 1);
+    XTL_VERIFY(classify(n2) == 2);
+
+    XTL_VERIFY((address_of_member<Point,1>(q3) == &q3.y));
+    XTL_VERIFY((address_of_member<Named,2>(n1) == &n1.grade));
+#endif
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,150 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that memoization of members lets Qua and When sub-clauses testing
+/// the same members call each accessor only once per Match statement.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_MEMOIZE_MEMBERS 1 // Memoize values of members during Match statements
+
+#include "match.hpp"                // Support for Match statement
+#include "patterns/constructor.hpp" // Support for constructor patterns
+#include "patterns/guard.hpp"       // Support for guard patterns
+#include "patterns/n+k.hpp"         // Support for n+k patterns
+#include <iostream>
+
+//------------------------------------------------------------------------------
+
+static size_t calls = 0; ///< Number of calls to accessors of Point
+
+struct Shape { virtual ~Shape() {} };
+
+struct Point : Shape
+{
+    Point(int x, int y) : m_x(x), m_y(y) {}
+    virtual const int& x() const { ++calls; return m_x; }
+    virtual       int  y() const { ++calls; return m_y; }
+    int m_x;
+    int m_y;
+};
+
+struct Other : Shape {};
+
+namespace mch ///< Mach7 library namespace
+{
+template <> struct bindings<Point> { Members(Point::x, Point::y); };
+} // of namespace mch
+
+//------------------------------------------------------------------------------
+
+int classify(const Shape* s)
+{
+    mch::var<int> v, w;
+
+    Match(s)
+    {
+        Qua(Point,v |= v > 5, w)      return 1;
+         When(v |= v > 3, w |= w > 3) return 2;
+         When(v |= v > 3, w)          return 3;
+         When(v, w |= w > 0)          return 4 + v;
+         When(v, w)                   return 0;
+        Qua(Other)                    return -1;
+    }
+    EndMatch
+
+    return -2;
+}
+
+//------------------------------------------------------------------------------
+
+int expected(const Shape* s)
+{
+    if (const Point* p = dynamic_cast<const Point*>(s))
+    {
+        if (p->m_x > 5)                return 1;
+        if (p->m_x > 3 && p->m_y > 3)  return 2;
+        if (p->m_x > 3)                return 3;
+        if (p->m_y > 0)                return 4 + p->m_x;
+        return 0;
+    }
+
+    return -1;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    size_t points = 0;
+    Other  other;
+
+    for (int x = -1; x < 8; ++x)
+        for (int y = -1; y < 5; ++y)
+        {
+            Point p(x, y);
+
+            XTL_VERIFY(classify(&p) == expected(&p));
+
+            ++points;
+        }
+
+    XTL_VERIFY(classify(&other) == expected(&other));
+
+    // Each accessor is called at most once per Match statement
+    std::cout << "Calls: " << calls << " for " << points << " points" << std::endl;
+
+    XTL_VERIFY(calls <= 2 * points);
+
+    // Outside of Match statements accessors are called every time
+    const Point p(1, 2);
+    const size_t before = calls;
+    const int& x1 = mch::apply_member(&p, &Point::x);
+    const int& x2 = mch::apply_member(&p, &Point::x);
+
+    XTL_VERIFY(calls == before + 2);
+    XTL_VERIFY(&x1 == &p.m_x);
+    XTL_VERIFY(&x2 == &p.m_x);
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,233 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that bit-field patterns decode CHIP-8 instructions the same way as
+/// hand-written decoding, and that mch::bit_decoder finds the same first
+/// matching clause as trying the clauses one after another: for every 16-bit
+/// word with the CHIP-8 instruction set and for random 32-bit sets of masks 
+/// with overlapping clauses. The decoder also selects the clauses of MatchU.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include "match.hpp"                // Support for Match statement
+#include "patterns/bitfield.hpp"    // Support for bit-field patterns
+#include "patterns/combinators.hpp" // Support for pattern combinators
+
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+//------------------------------------------------------------------------------
+
+/// Instructions of CHIP-8 in the order they are tried: SYS follows CLS and RET,
+/// which it would match too
+enum
+{
+    CLS, RET, SYS, JP, CALL, SE_kk, SNE_kk, SE_xy, LD_kk, ADD_kk, LD_xy, OR, AND, 
+    XOR, ADD_xy, SUB, SHR, SUBN, SHL, SNE_xy, LD_I, JP_V0, RND, DRW, SKP, SKNP, 
+    LD_DT, LD_K, SET_DT, SET_ST, ADD_I, LD_F, LD_B, STORE, LOAD, INVALID
+};
+
+const mch::bits_pattern chip8[] = 
+{
+    mch::bits(0xFFFF,0x00E0), mch::bits(0xFFFF,0x00EE), mch::bits(0xF000,0x0000), mch::bits(0xF000,0x1000),
+    mch::bits(0xF000,0x2000), mch::bits(0xF000,0x3000), mch::bits(0xF000,0x4000), mch::bits(0xF00F,0x5000),
+    mch::bits(0xF000,0x6000), mch::bits(0xF000,0x7000), mch::bits(0xF00F,0x8000), mch::bits(0xF00F,0x8001),
+    mch::bits(0xF00F,0x8002), mch::bits(0xF00F,0x8003), mch::bits(0xF00F,0x8004), mch::bits(0xF00F,0x8005),
+    mch::bits(0xF00F,0x8006), mch::bits(0xF00F,0x8007), mch::bits(0xF00F,0x800E), mch::bits(0xF00F,0x9000),
+    mch::bits(0xF000,0xA000), mch::bits(0xF000,0xB000), mch::bits(0xF000,0xC000), mch::bits(0xF000,0xD000),
+    mch::bits(0xF0FF,0xE09E), mch::bits(0xF0FF,0xE0A1), mch::bits(0xF0FF,0xF007), mch::bits(0xF0FF,0xF00A),
+    mch::bits(0xF0FF,0xF015), mch::bits(0xF0FF,0xF018), mch::bits(0xF0FF,0xF01E), mch::bits(0xF0FF,0xF029),
+    mch::bits(0xF0FF,0xF033), mch::bits(0xF0FF,0xF055), mch::bits(0xF0FF,0xF065)
+};
+
+const mch::bit_decoder<std::uint16_t> chip8_decoder(std::begin(chip8), std::end(chip8));
+
+/// Index of the first clause of [b,e) matching w, trying them one by one
+template <typename T>
+size_t first_match(const mch::bits_pattern* b, const mch::bits_pattern* e, T w)
+{
+    for (const mch::bits_pattern* p = b; p != e; ++p)
+        if ((*p)(w))
+            return size_t(p - b);
+
+    return size_t(e - b);
+}
+
+//------------------------------------------------------------------------------
+
+/// Instruction word, whose kind is found by the decoder
+struct Chip8 { std::uint16_t word; };
+
+size_t        kind_of(const Chip8& i) { return chip8_decoder(i.word); }
+unsigned int  x_of   (const Chip8& i) { return (i.word >> 8) & 0xF; }
+unsigned int  y_of   (const Chip8& i) { return (i.word >> 4) & 0xF; }
+unsigned int  kk_of  (const Chip8& i) { return i.word & 0xFF; }
+unsigned int  nnn_of (const Chip8& i) { return i.word & 0xFFF; }
+
+namespace mch ///< Mach7 library namespace
+{
+template <> struct bindings<Chip8>         { KS(kind_of); };
+template <> struct bindings<Chip8,CLS>     { KV(Chip8,CLS); };
+template <> struct bindings<Chip8,JP>      { KV(Chip8,JP);     Members(nnn_of); };
+template <> struct bindings<Chip8,SE_kk>   { KV(Chip8,SE_kk);  Members(x_of,kk_of); };
+template <> struct bindings<Chip8,LD_kk>   { KV(Chip8,LD_kk);  Members(x_of,kk_of); };
+template <> struct bindings<Chip8,ADD_xy>  { KV(Chip8,ADD_xy); Members(x_of,y_of); };
+template <> struct bindings<Chip8,SKP>     { KV(Chip8,SKP);    Members(x_of); };
+template <> struct bindings<Chip8,LD_DT>   { KV(Chip8,LD_DT);  Members(x_of); };
+} // of namespace mch
+
+/// Summary of an instruction: its kind and operands
+unsigned int summary(unsigned int kind, unsigned int a = 0, unsigned int b = 0) { return kind << 16 | a << 8 | b; }
+
+/// Decodes by hand
+unsigned int by_hand(std::uint16_t w)
+{
+    const unsigned int x = (w >> 8) & 0xF, y = (w >> 4) & 0xF, kk = w & 0xFF;
+
+    switch (w >> 12)
+    {
+    case 0x0: return w == 0x00E0 ? summary(CLS) : w == 0x00EE ? summary(RET) : summary(SYS);
+    case 0x1: return summary(JP, w >> 8 & 0xF, kk);
+    case 0x3: return summary(SE_kk, x, kk);
+    case 0x6: return summary(LD_kk, x, kk);
+    case 0x8: return (w & 0xF) == 4 ? summary(ADD_xy, x, y) : summary(first_match(std::begin(chip8), std::end(chip8), w));
+    case 0xE: return kk == 0x9E ? summary(SKP, x) : kk == 0xA1 ? summary(SKNP) : summary(INVALID);
+    case 0xF: return kk == 0x07 ? summary(LD_DT, x) : summary(first_match(std::begin(chip8), std::end(chip8), w));
+    default:  return summary(first_match(std::begin(chip8), std::end(chip8), w));
+    }
+}
+
+/// Decodes with clauses of bit-field patterns tried one after another
+unsigned int sequential(std::uint16_t w)
+{
+    using namespace mch;
+
+    var<unsigned int> x, y, kk, nnn;
+
+    Match(w)
+    {
+        With(bits(0xFFFF,0x00E0))                                        return summary(CLS);
+        With(bits(0xF000,0x1000) && bitfield(0,12,nnn))                  return summary(JP, nnn >> 8, nnn & 0xFF);
+        With(bits(0xF000,0x3000) && bitfield(8,4,x) && bitfield(0,8,kk)) return summary(SE_kk, x, kk);
+        With(bits(0xF000,0x6000) && bitfield(8,4,x) && bitfield(0,8,kk)) return summary(LD_kk, x, kk);
+        With(bits(0xF00F,0x8004) && bitfield(8,4,x) && bitfield(4,4,y))  return summary(ADD_xy, x, y);
+        With(bits(0xF0FF,0xE09E) && bitfield(8,4,x))                     return summary(SKP, x);
+        With(bits(0xF0FF,0xF007) && bitfield(8,4,x))                     return summary(LD_DT, x);
+        Otherwise()                                                      return summary(first_match(std::begin(chip8), std::end(chip8), w));
+    }
+    EndMatch
+
+    return 0;
+}
+
+/// Decodes with clauses of MatchU selected by the decision tree
+unsigned int decoded(const Chip8& i)
+{
+    MatchU(i)
+    {
+    CaseU(CLS)        return summary(CLS);
+    CaseU(JP,nnn)     return summary(JP, nnn >> 8, nnn & 0xFF);
+    CaseU(SE_kk,x,kk) return summary(SE_kk, x, kk);
+    CaseU(LD_kk,x,kk) return summary(LD_kk, x, kk);
+    CaseU(ADD_xy,x,y) return summary(ADD_xy, x, y);
+    CaseU(SKP,x)      return summary(SKP, x);
+    CaseU(LD_DT,x)    return summary(LD_DT, x);
+    }
+    EndMatchU
+
+    return summary(kind_of(i));
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    for (std::uint32_t w = 0; w < 0x10000; ++w)
+    {
+        const std::uint16_t word = std::uint16_t(w);
+        const Chip8 instr = { word };
+
+        XTL_VERIFY(chip8_decoder(word) == first_match(std::begin(chip8), std::end(chip8), word));
+
+        const unsigned int e = by_hand(word);
+
+        XTL_VERIFY(sequential(word) == e);
+        XTL_VERIFY(decoded(instr) == e);
+    }
+
+    // Random sets of clauses on 32-bit words with masks of different density,
+    // including ones matching everything and ones that never match
+    std::mt19937 engine(7);
+
+    for (int set = 0; set < 20; ++set)
+    {
+        std::vector<mch::bits_pattern> clauses;
+
+        for (int i = 0; i < 100; ++i)
+        {
+            std::uint32_t m = engine();
+
+            for (int k = engine() % 4; k > 0; --k)
+                m &= engine();
+
+            if (i % 37 == 36)
+                m = 0;
+
+            std::uint32_t v = engine() & (i % 41 == 40 ? ~std::uint32_t(0) : m);
+            clauses.push_back(mch::bits(m, v));
+        }
+
+        const mch::bit_decoder<std::uint32_t> decoder(clauses.begin(), clauses.end());
+
+        for (int i = 0; i < 20000; ++i)
+        {
+            const mch::bits_pattern& c = clauses[engine() % clauses.size()];
+            const std::uint32_t w = i % 2 ? std::uint32_t(engine()) : std::uint32_t((engine() & ~c.m_mask) | c.m_value);
+
+            XTL_VERIFY(decoder(w) == first_match(clauses.data(), clauses.data() + clauses.size(), w));
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
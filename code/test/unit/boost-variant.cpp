@@ -0,0 +1,164 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks Match statements on boost::variant, which switch on which() of the
+/// subject, and those on two variants, which go through the vtbl map.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <iostream>
+#include <vector>
+#include "type_switchN-patterns-xtl.hpp"
+#include "patterns/all.hpp"
+#include "adapters/boost/adapt_boost_variant.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Shape            { int id; Shape(int i = 0) : id(i) {} };
+struct Circle : Shape   { Circle(int i = 0) : Shape(i) {} };
+struct Square : Shape   { Square(int i = 0) : Shape(i) {} };
+
+typedef boost::variant<int, double, Circle, Square> value;
+
+static_assert( xtl::is_subtype<int,   value>::value, "int <: value");
+static_assert( xtl::is_subtype<Circle,value>::value, "Circle <: value");
+static_assert(!xtl::is_subtype<float, value>::value, "float </: value");
+static_assert( mch::indexed_subject<value>::size == 4, "One jump target per alternative");
+
+//------------------------------------------------------------------------------
+
+int expected(const value& v)
+{
+    if (const int*    p = boost::get<int>(&v))    return 10 + *p;
+    if (const double* p = boost::get<double>(&v)) return 20 + int(*p);
+    if (const Circle* p = boost::get<Circle>(&v)) return 30 + p->id;
+    if (const Square* p = boost::get<Square>(&v)) return 40 + p->id;
+    return 1;
+}
+
+/// Clauses on alternatives
+int do_match(const value& v)
+{
+    mch::var<int>    n;
+    mch::var<double> d;
+
+    Match(v)
+    {
+        Case(mch::C<int>(n))    return 10 + n;
+        Case(mch::C<double>(d)) return 20 + int(d);
+        Case(mch::C<Circle>())  return 30 + match0.id;
+        Case(mch::C<Square>())  return 40 + match0.id;
+        Otherwise()             return 1;
+    }
+    EndMatch
+
+    return -1;
+}
+
+/// Clauses that do not cover all the alternatives
+int do_match_partial(const value& v)
+{
+    Match(v)
+    {
+        Case(mch::C<Square>()) return match0.id;
+        Case(mch::C<int>())    return match0;
+    }
+    EndMatch
+
+    return -1;
+}
+
+/// Match on two variants goes through the vtbl map
+int do_match_pair(const value& a, const value& b)
+{
+    Match(a, b)
+    {
+        Case(mch::C<int>(), mch::C<Circle>()) return match0 + match1.id;
+        Case(mch::C<int>(), mch::C<int>())    return match0 + match1;
+        Otherwise()                           return -3;
+    }
+    EndMatch
+
+    return -1;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    std::vector<value> values(8);
+
+    values[0] = 1;
+    values[1] = 2.5;
+    values[2] = Circle(3);
+    values[3] = Square(4);
+    values[4] = 5;
+    values[5] = 7;
+    values[6] = Circle(8);
+    values[7] = Square(9);
+
+    for (size_t r = 0; r < 3; ++r)
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            const value& v = values[i];
+
+            XTL_VERIFY(do_match(v) == expected(v));
+
+            const int partial = boost::get<Square>(&v) ? boost::get<Square>(v).id 
+                              : boost::get<int>(&v)    ? boost::get<int>(v) 
+                                                       : -1;
+            XTL_VERIFY(do_match_partial(v) == partial);
+
+            for (size_t j = 0; j < values.size(); ++j)
+            {
+                const value& w = values[j];
+                const int*   n = boost::get<int>(&v);
+                const int    x = !n                        ? -3 
+                                 : boost::get<Circle>(&w) ? *n + boost::get<Circle>(w).id
+                                 : boost::get<int>(&w)    ? *n + boost::get<int>(w)
+                                                          : -3;
+                XTL_VERIFY(do_match_pair(v, w) == x);
+            }
+        }
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,129 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks zero-copy patterns on strings and byte buffers, making sure the
+/// views they bind point into the subject.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "match.hpp"                // Support for Match statement
+#include "patterns/bytes.hpp"       // Support for buffer patterns
+#include "patterns/guard.hpp"       // Support for guard patterns
+#include "patterns/n+k.hpp"         // Support for relational operators in guards
+
+//------------------------------------------------------------------------------
+
+/// Returns a kind of an HTTP-like request line and binds its path
+int request(const std::string& line, mch::string_view& path)
+{
+    using namespace mch;
+
+    var<string_view> p, q;
+
+    Match(line)
+    {
+      With(prefix("GET ",  suffix(" HTTP/1.1", split('?', p, q)))) path = p; return 2;
+      With(prefix("GET ",  suffix(" HTTP/1.1", p)))                path = p; return 1;
+      With(prefix("POST ", split(' ', p, _)))                     path = p; return 3;
+    }
+    EndMatch
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    using namespace mch;
+
+    string_view path;
+    std::string get   = "GET /index.html HTTP/1.1";
+    std::string query = "GET /find?q=mach7 HTTP/1.1";
+    std::string post  = "POST /submit HTTP/1.0";
+
+    XTL_VERIFY(request(get, path) == 1);
+    XTL_VERIFY(path == "/index.html");
+    XTL_VERIFY(path.data() == get.data() + 4);
+    XTL_VERIFY(request(query, path) == 2);
+    XTL_VERIFY(path == "/find");
+    XTL_VERIFY(request(post, path) == 3);
+    XTL_VERIFY(path == "/submit");
+    XTL_VERIFY(request("PUT / HTTP/1.1", path) == 0);
+    XTL_VERIFY(request("GET", path) == 0);
+
+    // Fields of a record separated by a delimiter
+    var<string_view> a, b, c;
+    const string_view key = "key";
+    XTL_VERIFY(split(',', a, split(',', b, c))("x,,zz"));
+    XTL_VERIFY(a.value() == "x");
+    XTL_VERIFY(b.value() == "");
+    XTL_VERIFY(c.value() == "zz");
+    XTL_VERIFY(!split(',', a, b)("xyz"));
+    XTL_VERIFY(!split(',', a, b)(""));
+    XTL_VERIFY(split('=', a |= a == key, b)("key=value"));
+    XTL_VERIFY(b.value() == "value");
+    XTL_VERIFY(!split('=', a |= a == key, b)("yek=value"));
+
+    // Fixed-width fields of a binary header: magic, length, payload
+    const unsigned char raw[] = {'M', '7', 0, 3, 'a', 'b', 'c'};
+    std::vector<unsigned char> frame(raw, raw + sizeof(raw));
+    var<byte_view> magic, len, payload;
+    XTL_VERIFY(field(2, magic, field(2, len, payload))(frame));
+    XTL_VERIFY(magic.end() - magic.begin() == 2);
+    XTL_VERIFY(magic.begin()[1] == '7');
+    XTL_VERIFY(len.begin()[1] == 3);
+    XTL_VERIFY(len.begin() == frame.data() + 2);
+    XTL_VERIFY(payload.begin() == frame.data() + 4);
+    XTL_VERIFY(payload.end() == frame.data() + frame.size());
+    XTL_VERIFY(prefix("M7", field(2, _, payload))(byte_view(raw, raw + sizeof(raw))));
+    XTL_VERIFY(payload.begin() == raw + 4);
+    XTL_VERIFY(!field(8, _, _)(frame));
+    XTL_VERIFY(split(0, magic, _)(frame));
+    XTL_VERIFY(magic.begin() == frame.data());
+    XTL_VERIFY(magic.end() == frame.data() + 2);
+}
+
+//------------------------------------------------------------------------------
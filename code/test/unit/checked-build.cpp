@@ -0,0 +1,108 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that a checked debug build (#XTL_CHECKED) compiles and runs Match
+/// statements and vtbl maps, whose updates now check the consistency of the
+/// whole map, through tuned caches as well as open addressing ones.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#if !defined(_DEBUG)
+#define _DEBUG
+#endif
+#define XTL_CHECKED 1
+
+#include <iostream>
+#include <vector>
+#include "match.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Shape              { virtual ~Shape() {} };
+struct Circle   : Shape   {};
+struct Square   : Shape   {};
+struct Triangle : Shape   {};
+
+int classify(const Shape& s)
+{
+    Match(s)
+    {
+        Case(Circle)   return 1;
+        Case(Square)   return 2;
+        Case(Triangle) return 3;
+    }
+    EndMatch
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    Circle c; Square s; Triangle t; Shape x;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        XTL_VERIFY(classify(c) == 1);
+        XTL_VERIFY(classify(s) == 2);
+        XTL_VERIFY(classify(t) == 3);
+        XTL_VERIFY(classify(x) == 0);
+    }
+
+    // Objects are words holding fake vtbl pointers, which maps never dereference
+    const size_t n = 5000;
+    std::vector<intptr_t> objects(n);
+
+    for (size_t i = 0; i < n; ++i)
+        objects[i] = 0x400000 + intptr_t((3*i + i%7) * 2*sizeof(void*));
+
+    mch::vtblmap<size_t> map;
+
+    for (size_t i = 0; i < n; ++i)
+        map.get(&objects[i]) = i+1;
+
+    for (size_t i = 0; i < n; ++i)
+        XTL_VERIFY(map.get(&objects[i]) == i+1);
+}
+
+//------------------------------------------------------------------------------
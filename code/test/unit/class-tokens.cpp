@@ -0,0 +1,169 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+///
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Subjects resolved once with mch::resolve() into class tokens and then
+/// passed through a series of Match statements: checks that they select the 
+/// same clauses and adjust subjects to the same targets, including bases at
+/// non-zero offsets, as the statements on the subjects themselves.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include "type_switchN-patterns.hpp"
+#include "patterns/all.hpp"
+
+#include <iostream>
+#include <vector>
+
+//------------------------------------------------------------------------------
+
+struct Node   { virtual ~Node() {} };
+struct Named  { virtual ~Named() {} const char* name; Named() : name("named") {} };
+struct Lit    : Node { int value; Lit(int v) : value(v) {} };
+struct Var    : Node, Named {};
+struct Add    : Node { Add(Node* a, Node* b) : lhs(a), rhs(b) {} Node* lhs; Node* rhs; };
+
+namespace mch ///< Mach7 library namespace
+{
+template <> struct bindings<Lit> { Members(Lit::value); };
+} // of namespace mch
+
+//------------------------------------------------------------------------------
+
+/// Statements of a pass over subjects of type T, which is either a Node or a 
+/// token of one
+
+template <typename T>
+int kind(const T& n)
+{
+    using namespace mch;
+
+    Match(n)
+    {
+        Case(C<Lit>()) return 1;
+        Case(C<Var>()) return 2;
+        Case(C<Add>()) return 3;
+    }
+    EndMatch
+
+    return 0;
+}
+
+template <typename T>
+int value(const T& n)
+{
+    using namespace mch;
+
+    var<int> v;
+
+    Match(n)
+    {
+        Case(C<Lit>(v)) return v;
+        Otherwise()     return -1;
+    }
+    EndMatch
+
+    return 0;
+}
+
+template <typename T>
+char initial(const T& n)
+{
+    Match(n)
+    {
+        Case(mch::C<Named>()) return match0.name[0]; // Base of Var at non-zero offset
+        Otherwise()           return '?';
+    }
+    EndMatch
+
+    return 0;
+}
+
+template <typename T>
+int arity(const T& n, const Node& other)
+{
+    using namespace mch;
+
+    Match(n, other)
+    {
+        Case(C<Add>(), C<Lit>()) return 21;
+        Case(C<Add>(), _)        return 2;
+        Case(_,        _)        return 0;
+    }
+    EndMatch
+
+    return -1;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    Lit  one(1);
+    Lit  two(2);
+    Var  x;
+    Add  sum(&one, &x);
+
+    std::vector<const Node*> nodes;
+    nodes.push_back(&one);
+    nodes.push_back(&x);
+    nodes.push_back(&sum);
+    nodes.push_back(&two);
+
+    for (int pass = 0; pass < 3; ++pass)
+        for (size_t i = 0; i < nodes.size(); ++i)
+        {
+            const Node& n = *nodes[i];
+            auto        t = mch::resolve(n);
+
+            XTL_VERIFY(kind(t)        == kind(n));
+            XTL_VERIFY(value(t)       == value(n));
+            XTL_VERIFY(initial(t)     == initial(n));
+            XTL_VERIFY(arity(t, one)  == arity(n, one));
+            XTL_VERIFY(arity(t, x)    == arity(n, x));
+        }
+
+    XTL_VERIFY(kind(mch::resolve(sum)) == 3);
+    XTL_VERIFY(value(mch::resolve(two)) == 2);
+    XTL_VERIFY(initial(mch::resolve(x)) == 'n');
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,132 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that classify assigns to each element of an array the same clause a 
+/// Match statement with the same patterns would choose.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <iostream>
+#include <vector>
+#include "type_switchN-patterns.hpp" // Support for Match statement
+#include "patterns/guard.hpp"        // Support for guard patterns
+#include "patterns/n+k.hpp"          // Support for n+k patterns
+#include "classify.hpp"
+
+//------------------------------------------------------------------------------
+
+using namespace mch;
+
+//------------------------------------------------------------------------------
+
+int scalar_classify(int n)
+{
+    var<int> v;
+
+    Match(n)
+    {
+        Case(0)                return 0;
+        Case(v |= v > 1000)    return 1;
+        Case(2*v+1)            return 2;
+        Case(v |= v < -10)     return 3;
+    }
+    EndMatch
+
+    return 4;
+}
+
+//------------------------------------------------------------------------------
+
+int scalar_classify(double x)
+{
+    var<double> v;
+
+    Match(x)
+    {
+        Case(v |= v < 0.0)     return 0;
+        Case(v |= v > 100.0)   return 1;
+        Case(50.0)             return 2;
+    }
+    EndMatch
+
+    return 3;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    // Odd size to have a partial block at the end
+    std::vector<int>    ns(3*classify_block_size + 17);
+    std::vector<double> xs(ns.size());
+
+    for (size_t i = 0; i < ns.size(); ++i)
+    {
+        ns[i] = int(i*37 % 2501) - 1250;
+        xs[i] = 0.25*ns[i];
+    }
+
+    ns[5] = 0;
+    xs[7] = 50.0;
+
+    std::vector<unsigned char> ks(ns.size(), 0xFF);
+    std::vector<int>           kx(xs.size(), -1);
+
+    var<int>    v;
+    var<double> d;
+
+    unsigned char* e = classify(&ns[0], &ns[0]+ns.size(), &ks[0], 0, v |= v > 1000, 2*v+1, v |= v < -10);
+    classify(&xs[0], &xs[0]+xs.size(), &kx[0], d |= d < 0.0, d |= d > 100.0, 50.0);
+
+    XTL_VERIFY(e == &ks[0]+ks.size());
+
+    for (size_t i = 0; i < ns.size(); ++i)
+    {
+        XTL_VERIFY(ks[i] == scalar_classify(ns[i]));
+        XTL_VERIFY(kx[i] == scalar_classify(xs[i]));
+    }
+
+    // Empty array
+    XTL_VERIFY(classify(&ns[0], &ns[0], &ks[0], 0) == &ks[0]);
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,134 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Selects telemetry records with constructor patterns evaluated over their
+/// columns and checks that the selection is the same as when the patterns are
+/// applied to each record.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include "patterns/all.hpp"
+#include "patterns/columnar.hpp"
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+//------------------------------------------------------------------------------
+
+/// Sample of telemetry reported by a device
+struct Sample
+{
+    uint32_t device;
+    uint16_t sensor;
+    int16_t  value;
+    double   time() const { return seconds; }
+    double   seconds;
+};
+
+namespace mch ///< Mach7 library namespace
+{
+template <> struct bindings<Sample> { Members(Sample::device, Sample::sensor, Sample::value, Sample::time); };
+} // of namespace mch
+
+//------------------------------------------------------------------------------
+
+/// Compares selection by pattern p over columns c with applying p to each of records
+template <typename P>
+void check(const P& p, const std::vector<Sample>& records, const mch::columns<Sample,4>& c, size_t expected)
+{
+    mch::selection s;
+
+    XTL_VERIFY(mch::select(p, c, s) == expected);
+
+    for (size_t i = 0; i < records.size(); ++i)
+        XTL_VERIFY(mch::selected(s, i) == (p(records[i]) != 0));
+
+    XTL_VERIFY(s.size() == (records.size() + 63) / 64);
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    using namespace mch;
+
+    std::vector<Sample> records;
+
+    for (uint32_t i = 0; i < 1000; ++i)
+    {
+        Sample r = { i % 13, uint16_t(i % 5), int16_t(int(i % 301) - 150), i * 0.25 };
+        records.push_back(r);
+    }
+
+    columns<Sample,4> c(records.begin(), records.end());
+
+    XTL_VERIFY(c.size() == records.size());
+    XTL_VERIFY(c.column<2>()[7] == records[7].value);
+    XTL_VERIFY(c.column<3>()[9] == records[9].time());
+
+    var<int16_t> v;
+    var<double>  t;
+
+    size_t all = records.size(), device3 = 0, hot = 0, late = 0;
+
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        device3 += records[i].device == 3;
+        hot     += records[i].sensor == 2 && records[i].value > 100;
+        late    += records[i].device == 3 && records[i].time() >= 200;
+    }
+
+    check(C<Sample>(_, _),                            records, c, all);
+    check(C<Sample>(3, _),                            records, c, device3);
+    check(C<Sample>(_, 2, v |= v > 100),              records, c, hot);
+    check(C<Sample>(3, _, _, t |= t >= 200),          records, c, late);
+    check(C<Sample>(3, 2, v |= v > 150, _),           records, c, 0);
+
+    // Records appended later are selected as well
+    records.push_back(records[3]);
+    c.push_back(records[3]);
+    check(C<Sample>(3, _), records, c, device3 + 1);
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,123 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+///
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Match statements jumping to the addresses of their clauses remembered in 
+/// their vtbl maps (\see #XTL_USE_COMPUTED_GOTO): several of them in the same
+/// function, nested ones, fall-through, break and subjects none of the clauses
+/// take, checked over several passes so that later ones take the jumps.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#if defined(__GNUC__) && !defined(__clang__)
+#define XTL_USE_COMPUTED_GOTO 1 // Labels as values are only used with GCC
+#endif
+
+#include "type_switchN-patterns.hpp"
+#include "patterns/all.hpp"
+
+#include <iostream>
+
+//------------------------------------------------------------------------------
+
+struct Shape  { virtual ~Shape() {} };
+struct Circle : Shape {};
+struct Square : Shape {};
+struct Disc   : Circle {};
+struct Rect   : Shape {};
+
+//------------------------------------------------------------------------------
+
+/// Two statements in the same function, the second one nested in a clause of 
+/// the first, with fall-through and break
+int classify(const Shape& a, const Shape& b)
+{
+    using namespace mch;
+
+    int result = 0;
+
+    Match(a)
+    {
+        Case(C<Disc>())   result += 1;    // Falls through to the next clause
+        Case(C<Circle>()) result += 10;   break;
+        Case(C<Square>())
+            Match(b)
+            {
+                Case(C<Circle>()) result += 100;  break;
+                Otherwise()       result += 1000; break;
+            }
+            EndMatch
+            break;
+    }
+    EndMatch
+
+    Match(a, b)
+    {
+        Case(C<Circle>(), C<Square>()) result += 10000;
+        Case(C<Square>(), C<Square>()) result += 20000;
+    }
+    EndMatch
+
+    return result;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    Shape  shape;
+    Circle circle;
+    Square square;
+    Disc   disc;
+    Rect   rect;
+
+    for (int pass = 0; pass < 3; ++pass)
+    {
+        XTL_VERIFY(classify(disc,   square) == 11 + 10000);
+        XTL_VERIFY(classify(circle, circle) == 10);
+        XTL_VERIFY(classify(square, circle) == 100);
+        XTL_VERIFY(classify(square, square) == 1000 + 20000);
+        XTL_VERIFY(classify(rect,   square) == 0);
+        XTL_VERIFY(classify(shape,  disc)   == 0);
+    }
+}
+
+//------------------------------------------------------------------------------
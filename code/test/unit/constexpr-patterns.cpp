@@ -0,0 +1,162 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that value, variable, wildcard, n+k and constructor patterns can be
+/// applied in constant expressions, e.g. to validate static configuration or
+/// to generate tables at compile time.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_CONSTEXPR_VARIABLES 1  // Let var<int> be bound in constexpr functions
+
+#include <iostream>
+#include "patterns/constructor.hpp" // Support for constructor patterns
+#include "patterns/n+k.hpp"         // Support for n+k patterns
+#include "patterns/primitive.hpp"   // Support for primitive patterns
+
+//------------------------------------------------------------------------------
+
+/// A literal type describing a port of a statically configured device
+struct port
+{
+    constexpr port(int n, int w) : number(n), width(w) {}
+    int number;
+    int width;
+};
+
+namespace mch ///< Mach7 library namespace
+{
+    template <> struct bindings<port> { Members(port::number, port::width); };
+} // of namespace mch
+
+using namespace mch;
+
+//------------------------------------------------------------------------------
+
+// Patterns that do not bind can be applied in C++11 constant expressions
+static_assert(value<int>(42)(42),  "Value pattern must accept an equal value");
+static_assert(!value<int>(42)(7),  "Value pattern must refute a different value");
+static_assert(wildcard()(3.1415),  "Wildcard pattern must accept anything");
+
+//------------------------------------------------------------------------------
+
+#if XTL_SUPPORT(relaxed_constexpr)
+
+/// Factorial written with an n+k pattern, so the function can be evaluated at
+/// compile time as well as at run time
+constexpr int factorial(int n)
+{
+    var<int> m;
+
+    if (value<int>(0)(n))
+        return 1;
+    if ((m+1)(n))
+        return (m+1)*factorial(m);
+
+    return 0;
+}
+
+/// Width of a port if the port is wired to line 0 or 1, and 0 otherwise 
+constexpr int wired_width(const port& p)
+{
+    var<int> w;
+
+    if (C<port>(0, w)(p) || C<port>(1, w)(p))
+        return w;
+    if (C<port>(_, w)(p))
+        return 0;
+
+    return -1;
+}
+
+/// Static configuration validated at compile time
+constexpr port config[] = { port(0, 8), port(1, 16), port(5, 32) };
+
+static_assert(factorial(5) == 120,         "n+k pattern must bind the variable at compile time");
+static_assert(wired_width(config[0]) ==  8, "Constructor pattern must bind the member at compile time");
+static_assert(wired_width(config[1]) == 16, "Constructor pattern must bind the member at compile time");
+static_assert(wired_width(config[2]) ==  0, "Constructor pattern must refute a different member");
+
+/// A table generated at compile time
+template <int N> struct factorials { static constexpr int value = factorial(N); };
+static_assert(factorials<7>::value == 5040, "Table entries must be computed at compile time");
+
+#else
+
+// The same functions are still available at run time
+inline int factorial(int n)
+{
+    var<int> m;
+
+    if (value<int>(0)(n))
+        return 1;
+    if ((m+1)(n))
+        return (m+1)*factorial(m);
+
+    return 0;
+}
+
+inline int wired_width(const port& p)
+{
+    var<int> w;
+
+    if (C<port>(0, w)(p) || C<port>(1, w)(p))
+        return w;
+    if (C<port>(_, w)(p))
+        return 0;
+
+    return -1;
+}
+
+#endif
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    // The same functions must also work at run time on values unknown at compile time
+    volatile int five = 5;
+
+    XTL_VERIFY(factorial(five) == 120);
+    XTL_VERIFY(wired_width(port(1, five)) == five);
+    XTL_VERIFY(wired_width(port(five, 8)) == 0);
+}
@@ -0,0 +1,145 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that clauses with nested constructor patterns give the same results
+/// when their type tests are memoized and shared between the clauses.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_MEMOIZE_NESTED_TYPE_TESTS 1 // Memoize outcomes of nested type tests
+
+#include <iostream>
+#include "type_switchN-patterns.hpp"
+#include "patterns/constructor.hpp"
+#include "patterns/primitive.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Expr          { virtual ~Expr() {} };
+struct Value  : Expr { int value; Value (int v) : value(v) {} };
+struct Plus   : Expr { const Expr* exp1; const Expr* exp2; Plus (const Expr* e1, const Expr* e2) : exp1(e1), exp2(e2) {} };
+struct Times  : Expr { const Expr* exp1; const Expr* exp2; Times(const Expr* e1, const Expr* e2) : exp1(e1), exp2(e2) {} };
+
+namespace mch ///< Mach7 library namespace
+{
+template <> struct bindings<Value> { Members(Value::value);             };
+template <> struct bindings<Plus>  { Members(Plus::exp1  , Plus::exp2);  };
+template <> struct bindings<Times> { Members(Times::exp1 , Times::exp2); };
+} // of namespace mch
+
+//------------------------------------------------------------------------------
+
+/// Several clauses test the type of the same members of Plus
+int classify(const Expr* e)
+{
+    mch::var<const Expr*> a, b, c, d;
+    mch::var<int> n;
+
+    Match(e)
+    {
+    Case(mch::C<Plus>(mch::C<Times>(a,b), mch::C<Times>(c,d))) return 1;
+    Case(mch::C<Plus>(mch::C<Times>(a,b), mch::C<Value>(n)))   return 2;
+    Case(mch::C<Plus>(mch::C<Times>(a,b), c))                  return 3;
+    Case(mch::C<Plus>(mch::C<Value>(n),   mch::C<Times>(c,d))) return 4;
+    Case(mch::C<Plus>(a, b))                                   return 5;
+    Case(mch::C<Times>(mch::C<Value>(n), b))                   return 6 + n;
+    Otherwise()                                                return 0;
+    }
+    EndMatch
+
+    return -1;
+}
+
+//------------------------------------------------------------------------------
+
+/// The same classification written by hand with dynamic_cast
+int expected(const Expr* e)
+{
+    if (const Plus* p = dynamic_cast<const Plus*>(e))
+    {
+        const bool t1 = dynamic_cast<const Times*>(p->exp1) != 0;
+        const bool t2 = dynamic_cast<const Times*>(p->exp2) != 0;
+        const bool v1 = dynamic_cast<const Value*>(p->exp1) != 0;
+        const bool v2 = dynamic_cast<const Value*>(p->exp2) != 0;
+
+        if (t1 && t2) return 1;
+        if (t1 && v2) return 2;
+        if (t1)       return 3;
+        if (v1 && t2) return 4;
+        return 5;
+    }
+
+    if (const Times* t = dynamic_cast<const Times*>(e))
+        if (const Value* v = dynamic_cast<const Value*>(t->exp1))
+            return 6 + v->value;
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    Value v1(1), v2(2), v3(3), v4(4), v5(5), v6(6), v7(7);
+    Plus  p56(&v5, &v6);
+    Times t34(&v3, &v4), t567(&p56, &v7);
+
+    const Expr* leaves[] = { &v1, &v2, &t34, &t567 };
+    const size_t n = sizeof(leaves)/sizeof(leaves[0]);
+
+    for (size_t r = 0; r < 3; ++r) // Repeat to use the memoized outcomes
+        for (size_t i = 0; i < n; ++i)
+        {
+            XTL_VERIFY(classify(leaves[i]) == expected(leaves[i]));
+
+            for (size_t j = 0; j < n; ++j)
+            {
+                Plus  p(leaves[i], leaves[j]);
+                Times t(leaves[i], leaves[j]);
+
+                XTL_VERIFY(classify(&p) == expected(&p));
+                XTL_VERIFY(classify(&t) == expected(&t));
+            }
+        }
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,140 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that values of multi-threaded vtblmap<T> stay where they are while
+/// its descriptors get replaced and deallocated by #XTL_RECLAIM_DESCRIPTORS.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_MULTI_THREADING     1 // Use multi-threaded vtblmap
+#define XTL_RECLAIM_DESCRIPTORS 1 // Deallocate its replaced descriptors
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <thread>
+#include <vector>
+#include "vtblmap.hpp"
+
+//------------------------------------------------------------------------------
+
+static std::atomic<size_t> deallocations(0); ///< Number of calls to global operator delete
+
+void* operator new(size_t n)
+{
+    if (void* p = std::malloc(n ? n : 1))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t n)       { return operator new(n); }
+void  operator delete(void* p)   noexcept { if (p) ++deallocations; std::free(p); }
+void  operator delete[](void* p) noexcept { operator delete(p); }
+
+//------------------------------------------------------------------------------
+
+struct Shape                 { virtual ~Shape() {} };
+template <int I> struct Leaf : Shape {};
+
+static const int classes = 64;
+
+/// Fills shapes with one object of each Leaf<I> for I in [0,N)
+template <int N> struct make_leaves     { static void into(std::vector<Shape*>& v) { make_leaves<N-1>::into(v); v.push_back(new Leaf<N-1>); } };
+template <>      struct make_leaves<0>  { static void into(std::vector<Shape*>&)   {} };
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    std::vector<Shape*> shapes;
+    make_leaves<classes>::into(shapes);
+
+    {
+        // Growth in a single thread: each update reclaims what the previous ones retired
+        mch::vtblmap<size_t> map(1);
+        size_t before = deallocations;
+
+        for (int i = 0; i < classes; ++i)
+            map.get(shapes[i]) = i+1;
+
+        for (int i = 0; i < classes; ++i)
+            XTL_VERIFY(map.get(shapes[i]) == size_t(i+1));
+
+        XTL_VERIFY(deallocations != before);
+    }
+
+    // Growth in many threads: every thread sees each value at the same address
+    mch::vtblmap<size_t> map(1);
+    std::vector<std::atomic<const size_t*>> addresses(classes);
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < classes; ++i)
+        addresses[i] = nullptr;
+
+    for (size_t t = 0; t < 8; ++t)
+        threads.push_back(std::thread([&,t]()
+        {
+            for (size_t r = 0; r < 200; ++r)
+                for (size_t i = 0; i < size_t(classes); ++i)
+                {
+                    size_t k = (i*(2*t+1) + r) % classes;
+                    const size_t* expected = nullptr;
+                    const size_t* address  = &map.get(shapes[k]);
+
+                    if (!addresses[k].compare_exchange_strong(expected, address))
+                        XTL_VERIFY(expected == address);
+                }
+        }));
+
+    for (size_t t = 0; t < threads.size(); ++t)
+        threads[t].join();
+
+    for (int i = 0; i < classes; ++i)
+        XTL_VERIFY(&map.get(shapes[i]) == addresses[i].load());
+
+    for (size_t i = 0; i < shapes.size(); ++i)
+        delete shapes[i];
+}
+
+//------------------------------------------------------------------------------
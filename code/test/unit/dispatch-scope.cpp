@@ -0,0 +1,197 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that Match statements executed in a loop under mch::dispatch_scope
+/// dispatch the same way as without it, including when their caches grow in 
+/// the middle of the loop, when the loop executes several Match statements 
+/// and when a recursive call executes the same Match statement in its own 
+/// scope.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <iostream>
+#include <vector>
+#include "type_switchN-patterns.hpp"
+#include "patterns/constructor.hpp"
+#include "patterns/primitive.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Shape                { virtual ~Shape() {} virtual int id() const = 0; };
+template <int I> struct Kind : Shape { int id() const { return I; } };
+
+struct Node                 { virtual ~Node() {} };
+struct Leaf   : Node        { Leaf(int v) : value(v) {} int value; };
+struct Branch : Node        { std::vector<const Node*> children; };
+
+//------------------------------------------------------------------------------
+
+using mch::C;
+
+/// Sum of ids of kinds 0..3 and tens for all other kinds over shapes
+int classify(const std::vector<const Shape*>& shapes)
+{
+    int sum = 0;
+    DispatchScope;
+
+    for (size_t i = 0; i < shapes.size(); ++i)
+        Match(*shapes[i])
+        {
+        Case(C<Kind<0>>()) sum += 0; break;
+        Case(C<Kind<1>>()) sum += 1; break;
+        Case(C<Kind<2>>()) sum += 2; break;
+        Case(C<Kind<3>>()) sum += 3; break;
+        Otherwise()        sum += 10;
+        }
+        EndMatch
+
+    return sum;
+}
+
+/// The same with two Match statements taking turns in the loop
+int classify2(const std::vector<const Shape*>& shapes)
+{
+    int sum = 0;
+    DispatchScope;
+
+    for (size_t i = 0; i < shapes.size(); ++i)
+    {
+        Match(*shapes[i])
+        {
+        Case(C<Kind<1>>()) sum += 1; break;
+        Otherwise()        sum += 0;
+        }
+        EndMatch
+
+        Match(*shapes[i])
+        {
+        Case(C<Kind<2>>()) sum += 2; break;
+        Case(C<Kind<3>>()) sum += 3; break;
+        Otherwise()        sum += 10;
+        }
+        EndMatch
+    }
+
+    return sum;
+}
+
+/// Sum of values of leaves, whose loop over children recurses into branches
+int total(const Node& n)
+{
+    int sum = 0;
+    const Branch* b = dynamic_cast<const Branch*>(&n);
+    DispatchScope;
+
+    for (size_t i = 0; b && i < b->children.size(); ++i)
+        Match(*b->children[i])
+        {
+        Case(C<Leaf>())   sum += match0.value; break;
+        Case(C<Branch>()) sum += total(match0); break;
+        }
+        EndMatch
+
+    return sum;
+}
+
+//------------------------------------------------------------------------------
+
+/// Shapes of kinds 0..K-1 in a round-robin order, repeated n times
+template <int... K>
+std::vector<const Shape*> shapes_of(size_t n)
+{
+    static const Shape* const all[] = { new Kind<K>... };
+    std::vector<const Shape*> result;
+
+    for (size_t r = 0; r < n; ++r)
+        result.insert(result.end(), &all[0], &all[sizeof...(K)]);
+
+    return result;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    // A few kinds first, then many more, whose misses grow the cache mid-loop
+    std::vector<const Shape*> few  = shapes_of<0,1,2,3>(10);
+    std::vector<const Shape*> many = shapes_of<0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20,21,22,23,24,25,26,27,28,29,30,31>(3);
+
+    XTL_VERIFY(classify(few) == 10*6);
+
+    const size_t epoch = mch::vtbl_descriptor_epoch();
+
+    XTL_VERIFY(classify(many) == 3*(6 + 28*10));
+#if !XTL_MULTI_THREADING
+    XTL_VERIFY(mch::vtbl_descriptor_epoch() != epoch); // The cache had to grow, releasing the pinned descriptor
+#else
+    XTL_UNUSED(epoch); // Multi-threaded maps do not pin their caches
+#endif
+    XTL_VERIFY(classify(many) == 3*(6 + 28*10));
+    XTL_VERIFY(classify(few) == 10*6);
+
+    XTL_VERIFY(classify2(few) == 10*(1 + 5 + 2*10));
+    XTL_VERIFY(classify2(many) == 3*(1 + 5 + 30*10));
+
+    // A tree whose branches at every level hold new kinds of nodes for the
+    // recursive calls to miss on, while outer loops have their caches pinned
+    Branch root;
+    Branch* level = &root;
+    int expected = 0;
+
+    for (int d = 0; d < 6; ++d)
+    {
+        Branch* next = new Branch;
+        level->children.push_back(new Leaf(d));
+        level->children.push_back(next);
+        level->children.push_back(new Leaf(10*d));
+        expected += 11*d;
+        level = next;
+    }
+
+    level->children.push_back(new Leaf(1000));
+    expected += 1000;
+
+    XTL_VERIFY(total(root) == expected);
+    XTL_VERIFY(total(root) == expected);
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,165 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that the vtbl maps of Match statements are preallocated in the 
+/// sections of dispatch statics, those with mch::hot_dispatch policy in their
+/// own, and that write_hot_vtbl_sites() lists the most executed statement.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_DISPATCH_SECTIONS 1 // Place vtbl maps into sections of their own
+#define XTL_VTBL_STATISTICS   1 // To find the sites of the vtbl maps
+
+#include <iostream>
+#include <sstream>
+#include "type_switchN-patterns.hpp"
+#include "patterns/constructor.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Shape            { virtual ~Shape() {} };
+struct Circle : Shape   {};
+struct Square : Shape   {};
+
+//------------------------------------------------------------------------------
+
+int cold_match(const Shape* a)
+{
+    Match(a)
+    {
+    Case(mch::C<Circle>()) return 1;
+    Case(mch::C<Square>()) return 2;
+    }
+    EndMatch
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+#undef  XTL_VTBL_MAP_POLICY
+#define XTL_VTBL_MAP_POLICY mch::hot_dispatch<>
+
+const size_t hot_line = __LINE__ + 4; ///< Line of the Match statement below
+
+int hot_match(const Shape* a)
+{
+    Match(a)
+    {
+    Case(mch::C<Circle>()) return 3;
+    Case(mch::C<Square>()) return 4;
+    }
+    EndMatch
+
+    return 0;
+}
+
+#undef  XTL_VTBL_MAP_POLICY
+#define XTL_VTBL_MAP_POLICY mch::vtbl_map_policy<>
+
+//------------------------------------------------------------------------------
+
+#if defined(__ELF__) && defined(__GNUC__) && !XTL_MULTI_THREADING
+// Defined by the linker around sections whose names are identifiers. Weak as 
+// GCC does not honor section attributes on static members of class templates,
+// in which case the sections are not there.
+extern "C" __attribute__((weak)) char __start_mch_dispatch[],     __stop_mch_dispatch[];
+extern "C" __attribute__((weak)) char __start_mch_hot_dispatch[], __stop_mch_hot_dispatch[];
+
+/// Whether p lies in [first,last)
+bool within(const void* p, const char* first, const char* last)
+{
+    return first <= static_cast<const char*>(p) && static_cast<const char*>(p) < last;
+}
+
+/// Checks that each vtbl map is in the section its statement asks for
+void check_sections()
+{
+    if (!__start_mch_dispatch || !__start_mch_hot_dispatch)
+        return;
+
+    size_t maps   = 0;
+
+    for (mch::vtbl_map_node* p = mch::vtbl_map_node::head(); p; p = p->next)
+    {
+        mch::vtbl_site_statistics s;
+
+        if (!p->request(p->map, mch::statistics_request, &s))
+            continue;
+
+        ++maps;
+
+        XTL_VERIFY(s.line == hot_line ? within(p->map, __start_mch_hot_dispatch, __stop_mch_hot_dispatch)
+                                      : within(p->map, __start_mch_dispatch,     __stop_mch_dispatch));
+    }
+
+    XTL_VERIFY(maps == 2);
+}
+#else
+void check_sections() {}
+#endif
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    Circle c;
+    Square s;
+
+    for (int i = 0; i < 100; ++i)
+        XTL_VERIFY(hot_match(&c) == 3 && hot_match(&s) == 4);
+
+    XTL_VERIFY(cold_match(&c) == 1);
+    XTL_VERIFY(cold_match(&s) == 2);
+
+    check_sections();
+
+    // The hot statement takes most of the lookups on its own
+    std::ostringstream os;
+    mch::write_hot_vtbl_sites(os, 0.5);
+    std::ostringstream expected;
+    expected << __FILE__ << ':' << hot_line << '\n';
+
+    XTL_VERIFY(os.str() == expected.str());
+}
+
+//------------------------------------------------------------------------------
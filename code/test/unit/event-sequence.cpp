@@ -0,0 +1,164 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that mch::event_sequence reports an occurrence at exactly those 
+/// events of a random stream at which a search over the whole history finds
+/// one ending within the window, including for sequences that repeat a type 
+/// and steps that are subhierarchies.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include "event_sequence.hpp"
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+//------------------------------------------------------------------------------
+
+struct Event                   { virtual ~Event() {} };
+struct Login       : Event     {};
+struct Logout      : Event     {};
+struct Failure     : Event     {};
+struct BadPassword : Failure   {};
+struct Timeout     : Failure   {};
+struct Heartbeat   : Event     {};
+
+//------------------------------------------------------------------------------
+
+/// Whether history[0..i] has an occurrence of steps ending at i within window,
+/// found by trying all positions of all steps
+template <typename... S>
+bool occurs_at(const std::vector<const Event*>& history, size_t i, size_t window)
+{
+    typedef bool (*test)(const Event*);
+    const test steps[] = { [](const Event* e) { return dynamic_cast<const S*>(e) != nullptr; }... };
+    const size_t n = sizeof...(S);
+
+    if (!steps[n-1](history[i]))
+        return false;
+
+    // Scanning backwards, the latest event matching each earlier step leaves
+    // the most room for the steps before it
+    size_t j = n-1, k = i;
+
+    while (j > 0)
+    {
+        if (k == 0 || i - (k-1) > window)
+            return false;
+
+        --k;
+
+        if (steps[j-1](history[k]))
+            --j;
+    }
+
+    return true;
+}
+
+template <typename... S>
+void check(const std::vector<const Event*>& history, size_t window)
+{
+    mch::event_sequence<Event, S...> detector(window);
+    size_t found = 0;
+
+    for (size_t i = 0; i < history.size(); ++i)
+    {
+        bool expected = occurs_at<S...>(history, i, window);
+        XTL_VERIFY(detector(*history[i]) == expected);
+        found += expected;
+
+        if (expected)
+            XTL_VERIFY(i - detector.last_start() <= window);
+    }
+
+    XTL_VERIFY(detector.found() == found);
+    XTL_VERIFY(detector.position() == history.size());
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    std::mt19937 engine(11);
+    std::vector<std::unique_ptr<Event>> owner;
+    std::vector<const Event*> history;
+
+    for (size_t i = 0; i < 20000; ++i)
+    {
+        switch (engine() % 6)
+        {
+        case 0: owner.emplace_back(new Login);       break;
+        case 1: owner.emplace_back(new Logout);      break;
+        case 2: owner.emplace_back(new BadPassword); break;
+        case 3: owner.emplace_back(new Timeout);     break;
+        case 4: owner.emplace_back(new Heartbeat);   break;
+        case 5: owner.emplace_back(new Heartbeat);   break;
+        }
+
+        history.push_back(owner.back().get());
+    }
+
+    check<Login, Logout>(history, 3);
+    check<Login, Failure, Logout>(history, 5);
+    check<BadPassword, BadPassword, BadPassword>(history, 6);
+    check<Event, Timeout>(history, 1);
+    check<Failure>(history, 0);
+
+    // Hand-written stream: Login, Heartbeat, BadPassword, Logout
+    Login l; Heartbeat h; BadPassword b; Logout o;
+    mch::event_sequence<Event, Login, Failure, Logout> alert(3);
+    XTL_VERIFY(!alert(l));
+    XTL_VERIFY(!alert(h));
+    XTL_VERIFY(!alert(b));
+    XTL_VERIFY(alert(o));
+    XTL_VERIFY(alert.last_start() == 0);
+    XTL_VERIFY(!alert(o));  // Another Logout is 4 events after the Login
+    alert.reset();
+    XTL_VERIFY(!alert(l));
+    XTL_VERIFY(!alert(h));
+    XTL_VERIFY(!alert(h));
+    XTL_VERIFY(!alert(b));
+    XTL_VERIFY(!alert(o));  // Logout is 4 events after Login
+}
+
+//------------------------------------------------------------------------------
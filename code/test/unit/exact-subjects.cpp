@@ -0,0 +1,175 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that subjects of final classes and of classes declared exact with
+/// mch::is_exact_type select clauses of Match statements at compile time,
+/// without a vtbl map, and take part in no lookups next to other subjects
+/// (#XTL_EXACT_SUBJECTS).
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_VTBL_STATISTICS 1 // To count the sites and lookups of vtbl maps
+
+#include <iostream>
+#include "type_switchN-patterns.hpp"
+#include "patterns/constructor.hpp"
+#include "patterns/primitive.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Shape                                { virtual ~Shape() {} };
+struct Named                                { virtual ~Named() {} int tag = 7; };
+struct Circle final : Shape                 { int r = 3; };
+struct Label  final : Shape, Named          {};            // Named at a non-zero offset
+struct Square       : Shape                 {};
+struct Leaf         : Shape                 {};            // Not final, but known to be exact
+
+namespace mch ///< Mach7 library namespace
+{
+template <> struct is_exact_type<Leaf> : std::true_type {};
+} // of namespace mch
+
+static_assert( mch::is_exact_type<Circle>::value, "Final classes are exact");
+static_assert(!mch::is_exact_type<Square>::value, "Classes that are not final are not");
+static_assert(!mch::is_exact_type<int>::value,    "Only polymorphic classes are exact");
+
+//------------------------------------------------------------------------------
+
+using mch::C;
+
+int circle(const Circle& c)
+{
+    Match(c)
+    {
+        Case(C<Square>())  return 1;            // Never: not a base of Circle
+        Case(C<Named>())   return 2;            // Never: no cross-cast possible
+        Case(C<Circle>())  return match0.r;
+        Case(C<Shape>())   return 4;
+    }
+    EndMatch
+
+    return 0;
+}
+
+int label(Label& l)
+{
+    Match(l)
+    {
+        Case(C<Circle>())  return 1;
+        Case(C<Named>())   return 10 + match0.tag;
+    }
+    EndMatch
+
+    return 0;
+}
+
+int leaf(const Leaf& f)
+{
+    Match(f)
+    {
+        Case(C<Square>())  return 1;
+        Otherwise()        return 2;
+    }
+    EndMatch
+
+    return 0;
+}
+
+int pair(const Circle& c, const Shape& s)
+{
+    Match(c, s)
+    {
+        Case(C<Circle>(), C<Square>()) return match0.r;
+        Case(C<Shape>(),  C<Circle>()) return 10 + match1.r;
+        Case(C<Shape>(),  C<Label>())  return 20 + match1.tag;
+    }
+    EndMatch
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+/// Number of vtbl maps and the total of their misses and hits
+void vtbl_usage(size_t& maps, size_t& lookups)
+{
+    maps = lookups = 0;
+    mch::for_each_vtbl_site([&](const mch::vtbl_site_statistics& s) { ++maps; lookups += s.hits + s.misses; });
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    Circle c;
+    Label  l;
+    Square s;
+    Leaf   f;
+
+    for (int i = 0; i < 10; ++i)
+    {
+        XTL_VERIFY(circle(c) == 3);
+        XTL_VERIFY(label(l)  == 17);
+        XTL_VERIFY(leaf(f)   == 2);
+    }
+
+    size_t maps, lookups;
+    vtbl_usage(maps, lookups);
+
+    XTL_VERIFY(maps <= 1);      // Statements on exact subjects have no vtbl map
+    XTL_VERIFY(lookups == 0);
+
+    XTL_VERIFY(pair(c, s) == 3);
+    XTL_VERIFY(pair(c, c) == 13);
+    XTL_VERIFY(pair(c, l) == 27);
+    XTL_VERIFY(pair(c, s) == 3);
+
+    mch::vtbl_site_statistics p = {};
+    vtbl_usage(maps, lookups);
+    mch::for_each_vtbl_site([&](const mch::vtbl_site_statistics& s) { p = s; });
+
+    XTL_VERIFY(maps == 1);      // Only the statement on two subjects has one
+    XTL_VERIFY(lookups == 4);
+    XTL_VERIFY(p.subjects == 1); // ... keyed by the second subject alone
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,124 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that MatchE statements that do not raise the subject select the 
+/// same clauses as catch handlers would, including cross casts as well as 
+/// ambiguous and inaccessible bases.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_EXCEPTION_FREE_MATCHE 1 // Select clauses of MatchE without exceptions
+
+#include "match.hpp"                // Support for Match statement
+#include <iostream>
+
+//------------------------------------------------------------------------------
+
+struct Base    { virtual ~Base() {} virtual void raise() const = 0; };
+struct Mixin   { virtual ~Mixin() {} };
+struct A       : Base                { void raise() const { throw *this; } };
+struct B       : A                   { void raise() const { throw *this; } };
+struct X       : Base, Mixin         { void raise() const { throw *this; } };
+struct L       : Mixin               {};
+struct R       : Mixin               {};
+struct Diamond : Base, L, R          { void raise() const { throw *this; } };
+struct Private : Base, private Mixin { void raise() const { throw *this; } };
+struct Z       : Base                { void raise() const { throw *this; } };
+
+//------------------------------------------------------------------------------
+
+int match_e(const Base* b)
+{
+    MatchE(b)
+    {
+    CaseE(B)     return 1;
+    CaseE(Mixin) return 2;
+    CaseE(A)     return 3;
+    CaseE(Base)  return 4;
+    }
+    EndMatchE
+
+    return 0;
+}
+
+/// Mixin is a statically ambiguous base of the subject here
+int match_diamond(const Diamond* d)
+{
+    MatchE(d)
+    {
+    CaseE(Mixin) return 2;
+    CaseE(Base)  return 4;
+    }
+    EndMatchE
+
+    return 0;
+}
+
+/// The same selection made by raising the subject
+int expected(const Base* b)
+{
+    try { b->raise(); }
+    catch (B&)     { return 1; }
+    catch (Mixin&) { return 2; }
+    catch (A&)     { return 3; }
+    catch (Base&)  { return 4; }
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    A a; B b; X x; Diamond d; Private p; Z z;
+
+    const Base* subjects[] = { &a, &b, &x, &d, &p, &z };
+    const size_t n = sizeof(subjects)/sizeof(subjects[0]);
+
+    for (size_t r = 0; r < 3; ++r) // Later rounds use the memoized clauses
+        for (size_t i = 0; i < n; ++i)
+            XTL_VERIFY(match_e(subjects[i]) == expected(subjects[i]));
+
+    XTL_VERIFY(match_diamond(&d) == expected(&d));
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,137 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks under #XTL_EXTRACTORS_MIGHT_THROW that only constructor patterns 
+/// applying accessors that might throw are guarded, and that an exception 
+/// thrown by such an accessor makes its clause fail to match.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_EXTRACTORS_MIGHT_THROW 1
+
+#include "match.hpp"                // Support for Match statement
+#include "patterns/constructor.hpp" // Support for constructor patterns
+#include "patterns/guard.hpp"       // Support for guard patterns
+#include "patterns/n+k.hpp"         // Support for n+k patterns
+#include "patterns/primitive.hpp"   // Support for primitive patterns
+#include <iostream>
+#include <stdexcept>
+
+//------------------------------------------------------------------------------
+
+struct Shape { virtual ~Shape() {} };
+
+struct Circle : Shape
+{
+    explicit Circle(double r) : radius(r) {}
+
+    /// Refuses to compute the area of circles with negative radius
+    double area() const { if (radius < 0) throw std::domain_error("negative radius"); return 3 * radius * radius; }
+
+    /// Diameter cannot throw
+    double diameter() const noexcept { return 2 * radius; }
+
+    double radius;
+};
+
+struct Square : Shape
+{
+    explicit Square(double s) : side(s) {}
+    double side;
+};
+
+enum { checked = 1 };
+
+namespace mch ///< Mach7 library namespace
+{
+template <> struct bindings<Circle>         { Members(Circle::radius, Circle::area); };
+template <> struct bindings<Circle,checked> { Members(Circle::diameter); };
+template <> struct bindings<Square>         { Members(Square::side); };
+} // of namespace mch
+
+//------------------------------------------------------------------------------
+
+mch::var<double> v;
+mch::wildcard    _;
+
+// Data members never throw and members matched against a wildcard are not loaded
+static_assert(!mch::extractors_might_throw<decltype(mch::C<Square>(v))>::value,          "Data member was taken to throw");
+static_assert(!mch::extractors_might_throw<decltype(mch::C<Circle>(v,_))>::value,        "Member matched against wildcard was taken to throw");
+static_assert( mch::extractors_might_throw<decltype(mch::C<Circle>(_,v))>::value,        "Member function that may throw was taken not to throw");
+static_assert( mch::extractors_might_throw<decltype(mch::C<Circle>(v,v |= v > 1))>::value, "Guard hides accessor that may throw");
+static_assert(!mch::extractors_might_throw<decltype(mch::C<Circle>())>::value,           "Type pattern was taken to throw");
+
+// Without noexcept in function types it is not known that diameter() cannot throw
+static_assert(mch::extractors_might_throw<decltype(mch::C<Circle,checked>(v))>::value == !XTL_SUPPORT(noexcept_function_type), "noexcept of accessor was not detected");
+
+//------------------------------------------------------------------------------
+
+/// Returns 1 for circles with an area, 2 for the other circles, 3 for squares
+int classify(const Shape* s)
+{
+    MatchP(s)
+    {
+    QuaP(Circle,_,v)  return 1;
+    QuaP(Circle)      return 2;
+    QuaP(Square,v)    return 3;
+    }
+    EndMatchP
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    Circle good(1.0);
+    Circle bad(-1.0);
+    Square square(2.0);
+
+    // Run twice to also go through the memoized jumps to the clauses
+    for (int i = 0; i < 2; ++i)
+    {
+        XTL_VERIFY(classify(&good)   == 1);
+        XTL_VERIFY(classify(&bad)    == 2);
+        XTL_VERIFY(classify(&square) == 3);
+    }
+}
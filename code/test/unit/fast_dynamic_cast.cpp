@@ -0,0 +1,163 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that fast_dynamic_cast gives the same results as dynamic_cast on 
+/// up-, down- and cross-casts, casts to void* and to references in a hierarchy
+/// with virtual, multiple and repeated inheritance.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <iostream>
+#include <vector>
+#include "fast_dynamic_cast.hpp"
+
+//------------------------------------------------------------------------------
+
+struct A                     { virtual ~A() {} int a; };
+struct B : virtual A         { int b; };
+struct C : virtual A, B      { int c; };
+struct D : virtual A, B      { int d; };
+struct E : C, D              { int e; }; // Two B subobjects, one A
+struct F                     { virtual ~F() {} int f; };
+struct G : F, C              { int g; };
+struct H : B                 { int h; }; // Only B and A
+
+//------------------------------------------------------------------------------
+
+/// Compares fast_dynamic_cast<T*> and dynamic_cast<T*> of p
+template <typename T, typename S>
+void check(S* p)
+{
+    XTL_VERIFY(mch::fast_dynamic_cast<T*>(p) == dynamic_cast<T*>(p));
+}
+
+/// Compares fast_dynamic_cast<T&> and dynamic_cast<T&> of s, including failures
+template <typename T, typename S>
+void check_ref(S& s)
+{
+    const T* fast = 0; bool fast_threw = false;
+    const T* slow = 0; bool slow_threw = false;
+
+    try { fast = &mch::fast_dynamic_cast<T&>(s); } catch (const std::bad_cast&) { fast_threw = true; }
+    try { slow = &dynamic_cast<T&>(s);           } catch (const std::bad_cast&) { slow_threw = true; }
+
+    XTL_VERIFY(fast == slow);
+    XTL_VERIFY(fast_threw == slow_threw);
+}
+
+/// All casts from a pointer to A
+void check_all(const A* p)
+{
+    check<const A>(p);
+    check<const B>(p); // Ambiguous for E
+    check<const C>(p);
+    check<const D>(p);
+    check<const E>(p);
+    check<const F>(p);
+    check<const G>(p);
+    check<const H>(p);
+    check<const void>(p);
+    check_ref<const C>(*p);
+    check_ref<const F>(*p);
+}
+
+/// All casts from a pointer to F, which is unrelated to A
+void check_all(F* p)
+{
+    check<A>(p);
+    check<B>(p);
+    check<C>(p);
+    check<G>(p);
+    check<void>(p);
+    check<const C>(p);
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    A* a = new A; B* b = new B; C* c = new C; D* d = new D; 
+    E* e = new E; G* g = new G; H* h = new H;
+    F* f = new F;
+
+    // Pointers to A subobjects of all the classes, and to each B subobject 
+    // of E, which share their A
+    std::vector<const A*> as;
+    as.push_back(a);
+    as.push_back(b);
+    as.push_back(c);
+    as.push_back(d);
+    as.push_back(e);
+    as.push_back(g);
+    as.push_back(h);
+    as.push_back(static_cast<const B*>(static_cast<const C*>(e)));
+    as.push_back(static_cast<const B*>(static_cast<const D*>(e)));
+    as.push_back(static_cast<const A*>(0));
+
+    for (size_t r = 0; r < 3; ++r)
+    {
+        for (size_t i = 0; i < as.size(); ++i)
+            if (as[i])
+                check_all(as[i]);
+            else
+                check<const C>(as[i]);
+
+        check_all(f);
+        check_all(static_cast<F*>(g));
+
+        // From each B subobject of E separately
+        const B* cb = static_cast<const C*>(e);
+        const B* db = static_cast<const D*>(e);
+        check<const C>(cb); check<const D>(cb); check<const E>(cb); check<const void>(cb);
+        check<const C>(db); check<const D>(db); check<const E>(db); check<const void>(db);
+
+        // Upcasts are resolved statically
+        check<A>(e);
+        check<C>(e);
+        check<F>(g);
+        check<B>(g);
+    }
+
+    delete a; delete b; delete c; delete d; delete e; delete g; delete h; delete f;
+}
+
+//------------------------------------------------------------------------------
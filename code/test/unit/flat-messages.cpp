@@ -0,0 +1,225 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Routes serialized messages of a FlatBuffers-like format with MatchU on the
+/// union tag kept in the buffer (#KSB) and binds their fields at fixed (#CMB) 
+/// and indirect (#CMBI) offsets without deserializing the messages, checking
+/// the results against decoding the buffers by hand. Bounds are verified once
+/// when a view of the received bytes is made, so truncated messages and those
+/// with offsets outside of the buffer are seen as messages with no value.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include "match.hpp"
+
+//------------------------------------------------------------------------------
+
+/// Byte 0 keeps the tag of the message, the rest depends on it:
+/// - order:  uint32 id at 4, uint32 offset of the double price at 8, 
+///           uint32 quantity at 12, the price itself usually at 16;
+/// - cancel: uint32 id at 4;
+/// - ping:   nothing else.
+enum { none_tag = 0, order_tag = 1, cancel_tag = 2, ping_tag = 3 };
+
+/// Number of bytes each kind of message takes at least
+const size_t extents[] = { 0, 16, 8, 1 };
+
+/// A view of received bytes verified to hold a well-formed message
+class Message
+{
+public:
+
+    /// Checks bounds of all the fields once, the view is empty when they fail
+    Message(const unsigned char* bytes, size_t n) : m_bytes(bytes), m_size(0)
+    {
+        if (n == 0 || bytes[0] == none_tag || bytes[0] > ping_tag || n < extents[bytes[0]])
+            return;
+
+        if (bytes[0] == order_tag)
+        {
+            std::uint32_t o;
+            std::memcpy(&o, bytes + 8, sizeof(o));
+
+            if (o > n || n - o < sizeof(double))
+                return;
+        }
+
+        m_size = n;
+    }
+
+    const unsigned char* data() const noexcept { return m_bytes; }
+    size_t               size() const noexcept { return m_size; }
+
+private:
+
+    const unsigned char* m_bytes;
+    size_t               m_size;
+};
+
+//------------------------------------------------------------------------------
+
+namespace mch ///< Mach7 library namespace
+{
+template <> struct bindings<Message>            { KSB(Message,std::uint8_t,0); };
+template <> struct bindings<Message,order_tag>  { KV(Message,order_tag);  CMB(0,Message,std::uint32_t,4); CMBI(1,Message,double,8); CMB(2,Message,std::uint32_t,12); };
+template <> struct bindings<Message,cancel_tag> { KV(Message,cancel_tag); CMB(0,Message,std::uint32_t,4); };
+template <> struct bindings<Message,ping_tag>   { KV(Message,ping_tag); };
+} // of namespace mch
+
+//------------------------------------------------------------------------------
+
+/// Serializes messages into a byte vector
+struct Writer
+{
+    std::vector<unsigned char> bytes;
+
+    template <typename T>
+    void put(size_t at, T v)
+    {
+        if (bytes.size() < at + sizeof(T))
+            bytes.resize(at + sizeof(T));
+
+        std::memcpy(&bytes[at], &v, sizeof(T));
+    }
+};
+
+std::vector<unsigned char> order(std::uint32_t id, double price, std::uint32_t qty, std::uint32_t price_at = 16)
+{
+    Writer w;
+    w.put<std::uint8_t>(0, order_tag);
+    w.put(4, id);
+    w.put(8, price_at);
+    w.put(12, qty);
+    w.put(price_at, price);
+    return w.bytes;
+}
+
+std::vector<unsigned char> cancel(std::uint32_t id)
+{
+    Writer w;
+    w.put<std::uint8_t>(0, cancel_tag);
+    w.put(4, id);
+    return w.bytes;
+}
+
+std::vector<unsigned char> ping()
+{
+    return std::vector<unsigned char>(1, ping_tag);
+}
+
+//------------------------------------------------------------------------------
+
+/// Value of the book change a message makes
+double effect(const Message& m)
+{
+    MatchU(m)
+    {
+    CaseU(order_tag,id,price,qty)  return id + price * qty;
+    CaseU(cancel_tag,id)           return -double(id);
+    CaseU(ping_tag)                return 0.5;
+    }
+    EndMatchU
+
+    return -1.0;
+}
+
+/// Same, decoding the buffer by hand
+double effect_by_hand(const unsigned char* b, size_t n)
+{
+    if (n == 0 || b[0] == none_tag || b[0] > ping_tag || n < extents[b[0]])
+        return -1.0;
+
+    std::uint32_t id, qty, o;
+    double price;
+
+    switch (b[0])
+    {
+    case order_tag:
+        std::memcpy(&o, b + 8, sizeof(o));
+        if (o > n || n - o < sizeof(double))
+            return -1.0;
+        std::memcpy(&id,    b + 4,  sizeof(id));
+        std::memcpy(&qty,   b + 12, sizeof(qty));
+        std::memcpy(&price, b + o,  sizeof(price));
+        return id + price * qty;
+    case cancel_tag:
+        std::memcpy(&id, b + 4, sizeof(id));
+        return -double(id);
+    case ping_tag:
+        return 0.5;
+    }
+
+    return -1.0;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    std::vector<std::vector<unsigned char>> messages = {
+        order(1, 99.5, 10), order(42, 0.25, 3, 20), cancel(7), ping(),
+        order(3, 1.0, 1, 1000), std::vector<unsigned char>(1, none_tag), std::vector<unsigned char>(1, 9)
+    };
+
+    // Truncated copies of every message, including empty ones
+    for (size_t i = 0, n = messages.size(); i < n; ++i)
+        for (size_t k = 0; k < messages[i].size(); ++k)
+            messages.push_back(std::vector<unsigned char>(messages[i].begin(), messages[i].begin() + k));
+
+    // Odd positions in a larger buffer, so that fields are not aligned
+    std::vector<unsigned char> arena;
+
+    for (const std::vector<unsigned char>& v : messages)
+    {
+        arena.assign(1, 0xFF);
+        arena.insert(arena.end(), v.begin(), v.end());
+
+        const unsigned char* b = arena.data() + 1;
+        XTL_VERIFY(effect(Message(b, v.size())) == effect_by_hand(b, v.size()));
+    }
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,129 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that && and || in lazy expressions of guards only evaluate their
+/// second operand when the first one does not determine the result, and that
+/// guards refer to the variables they bind rather than to copies of them.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include "patterns/all.hpp"
+#include <iostream>
+
+//------------------------------------------------------------------------------
+
+/// Number of comparisons of probes evaluated so far
+static int comparisons = 0;
+
+/// Value whose comparisons are counted
+struct probe { int n; };
+
+inline bool operator<(const probe& p, int k) { ++comparisons; return p.n < k; }
+inline bool operator>(const probe& p, int k) { ++comparisons; return p.n > k; }
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    using namespace mch;
+
+    var<int> x;
+    var<probe> p;
+
+    // Division by zero in the second operand is never evaluated
+    auto ratio = x |= x != 0 && 100 / x > 3;
+    XTL_VERIFY(!ratio(0));
+    XTL_VERIFY(ratio(20));
+    XTL_VERIFY(!ratio(50));
+
+    auto either = x |= x == 0 || 100 / x > 3;
+    XTL_VERIFY(either(0));
+    XTL_VERIFY(either(20));
+    XTL_VERIFY(!either(50));
+
+    // Only the comparisons needed to decide the outcome are made
+    auto range = p |= p > 0 && p < 10;
+    probe below = {-5}, inside = {5}, above = {50};
+
+    comparisons = 0;
+    XTL_VERIFY(!range(below));
+    XTL_VERIFY(comparisons == 1);
+
+    comparisons = 0;
+    XTL_VERIFY(range(inside));
+    XTL_VERIFY(comparisons == 2);
+
+    auto outside = p |= p < 0 || p > 10 || p < -100;
+
+    comparisons = 0;
+    XTL_VERIFY(outside(below));
+    XTL_VERIFY(comparisons == 1);
+
+    comparisons = 0;
+    XTL_VERIFY(outside(above));
+    XTL_VERIFY(comparisons == 2);
+
+    comparisons = 0;
+    XTL_VERIFY(!outside(inside));
+    XTL_VERIFY(comparisons == 3);
+
+    // Logical expressions made directly, rather than by combinators for && and ||
+    auto range_expr = p |= make_expr<bool_and>(p > 0, p < 10);
+
+    comparisons = 0;
+    XTL_VERIFY(!range_expr(below));
+    XTL_VERIFY(comparisons == 1);
+
+    auto outside_expr = p |= make_expr<bool_or>(p < 0, p > 10);
+
+    comparisons = 0;
+    XTL_VERIFY(outside_expr(below));
+    XTL_VERIFY(comparisons == 1);
+
+    // Copies of a guard refer to the same variable rather than to its copy
+    auto copy = ratio;
+    XTL_VERIFY(copy(25));
+    XTL_VERIFY(int(x) == 25);
+}
+
+//------------------------------------------------------------------------------
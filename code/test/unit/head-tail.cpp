@@ -0,0 +1,129 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks head/tail sequence patterns, which bind leading elements and a view
+/// of the remaining elements in place, on a toy framing protocol.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <vector>
+#include "match.hpp"                // Support for Match statement
+#include "patterns/guard.hpp"       // Support for guard patterns
+#include "patterns/n+k.hpp"         // Support for relational operators in guards
+#include "patterns/sequence.hpp"    // Support for sequence patterns
+
+//------------------------------------------------------------------------------
+
+typedef std::vector<unsigned char> frame;
+typedef mch::view_of<frame>::type  frame_view;
+
+const unsigned char SOF = 0x7E, PING = 1, DATA = 2;
+
+/// Frames are [SOF, kind, payload...]. Returns payload size of data frames, 0 
+/// for pings and -1 for malformed frames.
+int parse(const frame& f, frame_view& payload)
+{
+    using namespace mch;
+
+    var<unsigned char> kind;
+    var<frame_view>    rest;
+
+    Match(f)
+    {
+      With(list(SOF, PING))              payload = frame_view(); return 0;
+      With(cons(SOF, DATA, rest))        payload = rest;         return int(std::distance(rest.begin(), rest.end()));
+      With(cons(SOF, kind |= kind > 2, _)) return -int(kind);
+    }
+    EndMatch
+
+    return -1;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    using namespace mch;
+
+    frame_view payload;
+    frame      ping = {SOF, PING};
+    frame      data = {SOF, DATA, 'a', 'b', 'c'};
+    frame      long_ping = {SOF, PING, 0};
+    frame      other = {SOF, 9, 1, 2};
+    frame      empty;
+
+    XTL_VERIFY(parse(ping, payload) == 0);
+    XTL_VERIFY(parse(data, payload) == 3);
+    XTL_VERIFY(payload.begin() == data.begin() + 2);
+    XTL_VERIFY(payload.end() == data.end());
+    XTL_VERIFY(parse(long_ping, payload) == -1);
+    XTL_VERIFY(parse(other, payload) == -9);
+    XTL_VERIFY(parse(empty, payload) == -1);
+
+    // Tails can be destructured further and work on arrays
+    var<int> x, y;
+    var<view_of<int[4]>::type> rest;
+    const int a[] = {1,2,3,4};
+    XTL_VERIFY(cons(x, cons(y, rest))(a));
+    XTL_VERIFY(x == 1);
+    XTL_VERIFY(y == 2);
+    XTL_VERIFY(rest.begin() == a+2);
+    XTL_VERIFY(!list(_, _, _)(a));
+    XTL_VERIFY(list(_, _, _, _)(a));
+    XTL_VERIFY(cons(rest)(a));
+    XTL_VERIFY(rest.begin() == a);
+    XTL_VERIFY(rest.end() == a+4);
+    XTL_VERIFY(cons(x |= x == 1, y |= y == x + 1, _)(a));
+    XTL_VERIFY(!cons(_, _, _, _, _, _)(a));
+
+    // Input streams are read only as far as the heads
+    std::istringstream in("7 8 9");
+    var<view_of<range_view<std::istream_iterator<int>>>::type> stream_rest;
+    XTL_VERIFY(cons(7, x, stream_rest)(range(std::istream_iterator<int>(in), std::istream_iterator<int>())));
+    XTL_VERIFY(x == 8);
+    XTL_VERIFY(*stream_rest.begin() == 9);
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,159 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that under #XTL_HOIST_PATTERNS patterns of a clause that do not refer
+/// to variables are constructed once, while patterns binding variables still
+/// bind the variables of the current execution.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_HOIST_PATTERNS 1
+
+#include <iostream>
+#include "match.hpp"                // Support for Match statement
+#include "patterns/constructor.hpp" // Support for constructor patterns
+#include "patterns/primitive.hpp"   // Support for primitive patterns
+
+//------------------------------------------------------------------------------
+
+/// A constant pattern that counts how many times it was constructed
+struct counted
+{
+    counted() { ++constructed; }
+    counted(const counted&) { ++constructed; }
+    template <typename S> struct accepted_type_for { typedef int type; };
+    bool operator()(int t) const { return t % 2 == 0; }
+    static size_t constructed;
+};
+
+size_t counted::constructed = 0;
+
+namespace mch ///< Mach7 library namespace
+{
+template <> struct is_pattern_<counted>   { static const bool value = true; };
+template <> struct is_hoistable_<counted> { static const bool value = true; };
+} // of namespace mch
+
+//------------------------------------------------------------------------------
+
+struct Node          { virtual ~Node() {} };
+struct Leaf : Node   { Leaf(int v) : value(v) {} int value; };
+struct Pair : Node   { Pair(const Node* l, const Node* r) : left(l), right(r) {} const Node* left; const Node* right; };
+
+namespace mch ///< Mach7 library namespace
+{
+template <> struct bindings<Leaf> { Members(Leaf::value); };
+template <> struct bindings<Pair> { Members(Pair::left, Pair::right); };
+} // of namespace mch
+
+//------------------------------------------------------------------------------
+
+/// Kinds of leaves: 1 for even, 2 for 7, 3 for others; -1 for pairs
+int kind(const Node& n)
+{
+    using namespace mch;
+
+    Match(n)
+    {
+      Qua(Leaf, counted())  return 1;
+      Qua(Leaf, 7)          return 2;
+      Qua(Leaf)             return 3;
+      Otherwise()           return -1;
+    }
+    EndMatch
+}
+
+/// Sum of the leaves, which re-enters the Match statement with its own variables
+int sum(const Node& n)
+{
+    using namespace mch;
+
+    var<const Node*> l, r;
+    var<int>         v;
+
+    Match(n)
+    {
+      Qua(Leaf, v)     return v;
+      Qua(Pair, l, r)  return sum(*l) + sum(*r);
+    }
+    EndMatch
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    using namespace mch;
+
+    static_assert( is_hoistable<constr1<Leaf,default_layout,value<int>>>::value, "Values are constant");
+    static_assert(!is_hoistable<constr1<Leaf,default_layout,ref2<var<int>>>>::value, "Variables are bound");
+
+    Leaf a(4), b(7), c(9);
+    Pair p(&a, &b), q(&p, &c);
+
+    for (int i = 0; i < 3; ++i)
+    {
+        XTL_VERIFY(kind(a) == 1);
+        XTL_VERIFY(kind(b) == 2);
+        XTL_VERIFY(kind(c) == 3);
+        XTL_VERIFY(kind(p) == -1);
+    }
+
+    size_t constructed = counted::constructed;
+
+    for (int i = 0; i < 100; ++i)
+        XTL_VERIFY(kind(a) == 1);
+
+    XTL_VERIFY(counted::constructed == constructed); // No more constructions
+    XTL_VERIFY(counted::constructed <= 3);           // Once, plus copies into C<Leaf> and into the static
+    XTL_VERIFY(sum(q) == 20);
+
+    // Outside of a clause patterns are constructed as usual
+    for (int i = 0; i < 10; ++i)
+        XTL_VERIFY(counted()(i*2));
+
+    XTL_VERIFY(counted::constructed == constructed + 10);
+}
+
+//------------------------------------------------------------------------------
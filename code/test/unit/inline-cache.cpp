@@ -0,0 +1,171 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that per-site statistics of vtbl maps enumerated with 
+/// mch::for_each_vtbl_site() identify their Match statements and account
+/// Match statements whose vtbl maps have an inline cache of the 2 most recently
+/// seen tuples of vtbl pointers: checks that they select the same clauses as 
+/// before, that lookups of long runs of the same types are answered by the 
+/// inline cache, and that lookups alternating between more types than it holds
+/// are not.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_INLINE_CACHE_SIZE 2 // Keep the 2 most recent tuples in front of the cache
+#define XTL_VTBL_STATISTICS   1 // Keep per-site statistics of vtbl maps
+
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include "type_switchN-patterns.hpp"
+#include "patterns/primitive.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Shape            { virtual ~Shape() {} };
+struct Circle : Shape   {};
+struct Square : Shape   {};
+
+/// A family of otherwise unrelated classes to make the cache grow
+template <int I> struct Other : Shape {};
+
+//------------------------------------------------------------------------------
+
+size_t runs_line  = 0; ///< Line of the Match statement in runs()
+size_t mixed_line = 0; ///< Line of the Match statement in mixed()
+
+int runs(const Shape* a, const Shape* b)
+{
+    mch::var<const Circle&> c;
+    mch::wildcard           _;
+
+    runs_line = __LINE__ + 1;
+    Match(a,b)
+    {
+    Case(c,c)   return 1;
+    Case(c,_)   return 2;
+    Otherwise() return 0;
+    }
+    EndMatch
+
+    return -1;
+}
+
+int mixed(const Shape* a)
+{
+    mch::var<const Circle&> c;
+    mch::var<const Square&> s;
+
+    mixed_line = __LINE__ + 1;
+    Match(a)
+    {
+    Case(c)     return 1;
+    Case(s)     return 2;
+    Otherwise() return 0;
+    }
+    EndMatch
+
+    return -1;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    std::vector<Shape*> shapes;
+
+    shapes.push_back(new Circle);
+    shapes.push_back(new Square);
+    shapes.push_back(new Other<0>);
+    shapes.push_back(new Other<1>);
+    shapes.push_back(new Other<2>);
+    shapes.push_back(new Other<3>);
+
+    const size_t rounds = 100;
+
+    // Long runs of the same pair of types
+    for (size_t i = 0; i < shapes.size(); ++i)
+        for (size_t r = 0; r < rounds; ++r)
+            XTL_VERIFY(runs(shapes[i], shapes[0]) == (i == 0 ? 1 : 0));
+
+    // Types change on every lookup and only come back after 5 others
+    for (size_t r = 0; r < rounds; ++r)
+        for (size_t i = 0; i < shapes.size(); ++i)
+            XTL_VERIFY(mixed(shapes[i]) == (i < 2 ? int(i+1) : 0));
+
+    size_t seen = 0;
+
+    mch::for_each_vtbl_site(
+        [&](const mch::vtbl_site_statistics& s)
+        {
+            if (std::strcmp(s.file, __FILE__) != 0)
+                return;
+
+            ++seen;
+
+            std::cout << s.func << ':' << s.line 
+                      << " hits="   << s.hits
+                      << " inline=" << s.inline_hits
+                      << " misses=" << s.misses
+                      << " ratio="  << s.inline_ratio()
+                      << std::endl;
+
+            XTL_VERIFY(s.hits + s.misses == rounds*shapes.size());
+            XTL_VERIFY(s.inline_hits <= s.hits);
+
+            // All but the first lookup of each run come from the inline cache
+            if (s.line == runs_line)
+                XTL_VERIFY(s.inline_hits >= (rounds-2)*shapes.size());
+
+            // None come from it, since there are more types than it holds
+            if (s.line == mixed_line)
+                XTL_VERIFY(s.inline_hits == 0);
+        }
+    );
+
+    XTL_VERIFY(seen == 2);
+
+    for (size_t i = 0; i < shapes.size(); ++i)
+        delete shapes[i];
+}
+
+//------------------------------------------------------------------------------
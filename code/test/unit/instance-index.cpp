@@ -0,0 +1,182 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that searches of instance_index over a graph of expressions made in
+/// an arena find the same nodes as matching every node of the graph, including
+/// nodes whose target class is a base at a non-zero offset, sequentially and
+/// on several threads.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include "type_switchN-patterns.hpp"
+#include "patterns/all.hpp"
+#include "instance_index.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------
+
+struct Expr     { virtual ~Expr() {} };
+struct Literal  : Expr { Literal(int v) : value(v) {} int value; };
+struct Id_expr  : Expr { Id_expr(const char* n) : name(n) {} std::string name; };
+struct Call     : Expr { Call(const Expr* f, const Expr* a) : fn(f), arg(a) {} const Expr* fn; const Expr* arg; };
+struct Located  { virtual ~Located() {} int line = 0; };
+struct Located_call : Located, Call { Located_call(const Expr* f, const Expr* a) : Call(f, a) {} }; // Call at non-zero offset
+
+namespace mch ///< Mach7 library namespace
+{
+template <> struct bindings<Literal> { Members(Literal::value); };
+template <> struct bindings<Id_expr> { Members(Id_expr::name); };
+template <> struct bindings<Call>    { Members(Call::fn, Call::arg); };
+} // of namespace mch
+
+//------------------------------------------------------------------------------
+
+/// Whether e is a call of function named name
+bool is_call_of(const Expr& e, const std::string& name)
+{
+    using namespace mch;
+
+    var<std::string> n;
+    return C<Call>(C<Id_expr>(n), _)(e) && static_cast<const std::string&>(n) == name;
+}
+
+template <typename T>
+std::vector<const T*> sorted(std::vector<const T*> v) { std::sort(v.begin(), v.end()); return v; }
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    using namespace mch;
+
+    const char* names[] = {"f", "g", "h"};
+    arena<Expr>          nodes;
+    instance_index<Expr> index;
+    std::vector<const Expr*> all; // Every node, as a traversal of the graph would visit them
+
+    nodes.observe(&index);
+
+    for (int i = 0; i < 5000; ++i)
+    {
+        const Expr* e;
+
+        switch (std::rand() % 5)
+        {
+        case 0:  e = nodes.make<Literal>(i); break;
+        case 1:  e = nodes.make<Id_expr>(names[std::rand() % 3]); break;
+        default:
+            {
+                const Expr* f = all.empty() ? nodes.make<Id_expr>("f") : all[std::rand() % all.size()];
+                const Expr* a = all.empty() ? nodes.make<Literal>(0)   : all[std::rand() % all.size()];
+
+                if (all.empty())
+                {
+                    all.push_back(f);
+                    all.push_back(a);
+                }
+
+                e = i % 2 ? static_cast<const Expr*>(nodes.make<Call>(f, a)) : nodes.make<Located_call>(f, a);
+            }
+        }
+
+        all.push_back(e);
+    }
+
+    XTL_VERIFY(index.size() == all.size());
+    XTL_VERIFY(index.classes() == 4);
+
+    // Calls of f by a pattern with a variable
+    var<std::string> name;
+    std::vector<const Call*> expected;
+
+    for (size_t i = 0; i < all.size(); ++i)
+        if (is_call_of(*all[i], "f"))
+            expected.push_back(dynamic_cast<const Call*>(all[i]));
+
+    std::vector<const Call*> found;
+    index.for_each_match(C<Call>(C<Id_expr>(name), _), [&](const Call& c) { if (static_cast<const std::string&>(name) == "f") found.push_back(&c); });
+    XTL_VERIFY(!expected.empty());
+    XTL_VERIFY(sorted(found) == sorted(expected));
+
+    std::vector<const Call*> parallel = index.parallel_find_all<Call>([](const Call& c) { return is_call_of(c, "f"); }, 4);
+    XTL_VERIFY(sorted(parallel) == sorted(expected));
+
+    // ... in the same order as sequential search
+    XTL_VERIFY(parallel == found);
+
+    // All calls whose argument is a literal
+    var<int> v;
+    std::vector<const Call*> with_literals = index.find_all(C<Call>(_, C<Literal>(v)));
+    expected.clear();
+
+    for (size_t i = 0; i < all.size(); ++i)
+        if (const Call* c = dynamic_cast<const Call*>(all[i]))
+            if (dynamic_cast<const Literal*>(c->arg))
+                expected.push_back(c);
+
+    XTL_VERIFY(sorted(with_literals) == sorted(expected));
+
+    // Located objects through a class unrelated to Expr
+    size_t located = 0;
+    index.for_each_instance<Located>([&](const Located& l) { located += l.line == 0; });
+    XTL_VERIFY(located == size_t(std::count_if(all.begin(), all.end(), [](const Expr* e) { return dynamic_cast<const Located*>(e) != 0; })));
+
+    // Removal
+    const Expr* victim = expected.empty() ? all.back() : expected.front();
+    XTL_VERIFY(index.remove(victim));
+    XTL_VERIFY(!index.remove(victim));
+    XTL_VERIFY(index.size() == all.size() - 1);
+    std::vector<const Call*> after = index.find_all(C<Call>(_, C<Literal>(v)));
+    XTL_VERIFY(std::find(after.begin(), after.end(), victim) == after.end());
+
+    // Clearing the arena clears the index
+    nodes.clear();
+    XTL_VERIFY(index.size() == 0);
+    XTL_VERIFY(index.find_all(C<Call>()).empty());
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,175 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that interval patterns accept the values of their half-open ranges
+/// and that #interval_table finds for each value the same first range as a 
+/// chain of clauses with interval and value patterns would, with and without
+/// a lookup table.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <climits>
+#include <cmath>
+#include <iostream>
+#include "match.hpp"                // Support for Match statement
+#include "patterns/interval.hpp"    // Support for interval patterns
+#include "patterns/primitive.hpp"   // Support for primitive patterns
+
+//------------------------------------------------------------------------------
+
+/// Checks that table t finds for each value in [lo,hi] the position that f does
+template <typename T, typename F>
+void check(const mch::interval_table<T>& t, F f, T lo, T hi, T step = T(1))
+{
+    for (T v = lo; v <= hi; v += step)
+    {
+        XTL_VERIFY(t.find(v) == f(v));
+
+        if (v > hi - step)
+            break; // Avoid overflow of v at the end of the domain
+    }
+}
+
+//------------------------------------------------------------------------------
+
+/// Grades by chain of clauses, first of them wins
+size_t grade_chain(int x)
+{
+    using namespace mch;
+
+    Match(x)
+    {
+        With(in(90,101)) return 0;
+        With(in(80,90))  return 1;
+        With(val(77))    return 2; // Lucky score before its interval
+        With(in(70,80))  return 3;
+        With(in(0,70))   return 4;
+        With(in(60,75))  return 5; // Never chosen, covered by the previous ones
+    }
+    EndMatch
+
+    return mch::interval_table<int>::npos;
+}
+
+const mch::interval_table<int> grades(mch::in(90,101), mch::in(80,90), mch::val(77), mch::in(70,80), mch::in(0,70), mch::in(60,75));
+
+/// Grades by a single clause switching on position in the table
+size_t grade_table(int x)
+{
+    using namespace mch;
+
+    var<size_t> i;
+
+    Match(x)
+    {
+        With(interval_of(grades, i)) return i;
+    }
+    EndMatch
+
+    return mch::interval_table<int>::npos;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    using namespace mch;
+
+    // Interval patterns are half-open
+    XTL_VERIFY(in(10,20)(10));
+    XTL_VERIFY(!in(10,20)(20));
+    XTL_VERIFY(!in(10,20)(9));
+    XTL_VERIFY(in(0.5,1.0)(0.75));
+
+    // Small integral domain uses lookup table
+    XTL_VERIFY(grades.tabulated());
+
+    check(grades, grade_chain, -20, 120);
+    check(grades, grade_table, -20, 120);
+
+    // Wide integral domain uses binary search
+    const interval_table<long> wide(in(-1000000L,-1000L), 0L, in(1L,100000L), 5L, in(50000L,10000000L));
+
+    XTL_VERIFY(!wide.tabulated());
+
+    check(wide,
+          [](long v) -> size_t { return -1000000 <= v && v < -1000 ? 0 : v == 0 ? 1 : 1 <= v && v < 100000 ? 2 : 1 <= v && v < 10000000 ? 4 : interval_table<long>::npos; },
+          -2000000L, 12000000L, 997L);
+    check(wide,
+          [](long v) -> size_t { return -1000000 <= v && v < -1000 ? 0 : v == 0 ? 1 : 1 <= v && v < 100000 ? 2 : 1 <= v && v < 10000000 ? 4 : interval_table<long>::npos; },
+          -1010L, 1010L);
+
+    // Literals and intervals at the ends of the domain
+    const interval_table<int> ends(INT_MAX, in(INT_MIN, INT_MIN+2), in(INT_MAX-3, INT_MAX));
+
+    check(ends,
+          [](int v) -> size_t { return v == INT_MAX ? 0 : v < INT_MIN+2 ? 1 : v >= INT_MAX-3 ? 2 : interval_table<int>::npos; },
+          INT_MIN, INT_MIN+10);
+    check(ends,
+          [](int v) -> size_t { return v == INT_MAX ? 0 : v < INT_MIN+2 ? 1 : v >= INT_MAX-3 ? 2 : interval_table<int>::npos; },
+          INT_MAX-10, INT_MAX);
+
+    const interval_table<unsigned char> bytes(in(0,32), 127, in(32,127), 255);
+
+    XTL_VERIFY(bytes.tabulated());
+
+    check(bytes,
+          [](unsigned char v) -> size_t { return v < 32 ? 0 : v == 127 ? 1 : v < 127 ? 2 : v == 255 ? 3 : interval_table<unsigned char>::npos; },
+          (unsigned char)0, (unsigned char)255);
+
+    // Floating-point ranges, where literals only contain themselves
+    const interval_table<double> reals(in(0.0,0.5), 0.75, in(0.5,1.0), in(-1.0,0.0));
+
+    XTL_VERIFY(reals.find(0.75) == 1);
+    XTL_VERIFY(reals.find(std::nextafter(0.75,1.0)) == 2);
+    XTL_VERIFY(reals.find(0.5) == 2);
+    XTL_VERIFY(reals.find(-0.0) == 0);
+    XTL_VERIFY(reals.find(-1.0) == 3);
+    XTL_VERIFY(reals.find(1.0) == interval_table<double>::npos);
+    XTL_VERIFY(reals.find(std::nan("")) == interval_table<double>::npos);
+
+    check(reals,
+          [](double v) -> size_t { return 0.0 <= v && v < 0.5 ? 0 : v == 0.75 ? 1 : 0.5 <= v && v < 1.0 ? 2 : -1.0 <= v && v < 0.0 ? 3 : interval_table<double>::npos; },
+          -2.0, 2.0, 0.0625);
+}
+
+//------------------------------------------------------------------------------
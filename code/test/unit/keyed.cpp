@@ -0,0 +1,157 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Dispatches calls to built-in functions by name with a single clause that 
+/// looks the name up in a #key_table and checks that it chooses the same 
+/// function as a chain of clauses comparing the name with each of the keys.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include "type_switchN-patterns.hpp"
+#include "patterns/all.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------
+
+/// Call of a function by name
+struct Call
+{
+    std::string name;
+    int         arg;
+};
+
+namespace mch ///< Mach7 library namespace
+{
+template <> struct bindings<Call> { Members(Call::name, Call::arg); };
+} // of namespace mch
+
+//------------------------------------------------------------------------------
+
+// The second "abs" is never chosen, as in a chain of clauses
+const mch::key_table<std::string> builtins = { "abs", "neg", "sqr", "inc", "dec", "abs", "half" };
+
+int eval_keyed(const Call& c)
+{
+    using namespace mch;
+
+    var<size_t> i;
+    var<int>    a;
+
+    Match(c)
+    {
+        Case(C<Call>(key_of(builtins, i), a))
+            switch (i)
+            {
+            case 0: return a < 0 ? -a : a;
+            case 1: return -a;
+            case 2: return a * a;
+            case 3: return a + 1;
+            case 4: return a - 1;
+            case 5: return 0;
+            case 6: return a / 2;
+            }
+        Case(C<Call>(key_of(builtins, 1), a)) return 1000; // Never chosen, neg handled above
+        Case(C<Call>(_, a))                   return -1000 + a;
+    }
+    EndMatch
+
+    return -2000;
+}
+
+int eval_chain(const Call& c)
+{
+    using namespace mch;
+
+    var<int> a;
+
+    Match(c)
+    {
+        Case(C<Call>(std::string("abs"),  a)) return a < 0 ? -a : a;
+        Case(C<Call>(std::string("neg"),  a)) return -a;
+        Case(C<Call>(std::string("sqr"),  a)) return a * a;
+        Case(C<Call>(std::string("inc"),  a)) return a + 1;
+        Case(C<Call>(std::string("dec"),  a)) return a - 1;
+        Case(C<Call>(std::string("abs"),  a)) return 0;
+        Case(C<Call>(std::string("half"), a)) return a / 2;
+        Case(C<Call>(_, a))                   return -1000 + a;
+    }
+    EndMatch
+
+    return -2000;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    const char* names[] = { "abs", "neg", "sqr", "inc", "dec", "half", "", "ab", "absx", "Neg", "cube" };
+
+    for (size_t n = 0; n < XTL_ARR_SIZE(names); ++n)
+        for (int a = -3; a <= 3; ++a)
+        {
+            Call c = { names[n], a };
+            XTL_VERIFY(eval_keyed(c) == eval_chain(c));
+        }
+
+    // Positions of keys, including of a table large enough to have collisions
+    XTL_VERIFY(builtins.find("half") == 6);
+    XTL_VERIFY(builtins.find("abs")  == 0);
+    XTL_VERIFY(builtins.find("cube") == mch::key_table<std::string>::npos);
+
+    std::vector<int> numbers;
+
+    for (int k = 0; k < 1000; ++k)
+        numbers.push_back(k * 7919);
+
+    mch::key_table<int> large(numbers.begin(), numbers.end());
+
+    for (int k = 0; k < 1000; ++k)
+    {
+        XTL_VERIFY(large.find(k * 7919) == size_t(k));
+        XTL_VERIFY(large.find(k * 7919 + 1) == mch::key_table<int>::npos);
+    }
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,140 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks on the host the subset of Match statements on kinds that GPU 
+/// kernels can use (\see kind_match.hpp): a class hierarchy with kinds in a
+/// data member and a single class with layouts told apart by a function.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include "kind_match.hpp"
+#include <iostream>
+
+//------------------------------------------------------------------------------
+
+enum cell_kind { fluid, solid, void_cell };
+
+struct Cell           { cell_kind kind; double mass; Cell(cell_kind k, double m) : kind(k), mass(m) {} };
+struct Fluid : Cell   { double pressure; Fluid(double m, double p) : Cell(fluid, m), pressure(p) {} };
+struct Solid : Cell   { double stress;   Solid(double m, double s) : Cell(solid, m), stress(s)   {} };
+
+/// Particle whose kind is in the lowest bits of its flags
+struct Particle       { unsigned flags; float charge; };
+
+enum { neutral, ion, electron };
+
+XTL_HOST_DEVICE inline unsigned particle_kind(const Particle& p) { return p.flags & 3; }
+
+namespace mch ///< Mach7 library namespace
+{
+template <> struct bindings<Cell>               { KS(Cell::kind); };
+template <> struct bindings<Fluid>              { KV(Cell,fluid); };
+template <> struct bindings<Solid>              { KV(Cell,solid); };
+template <> struct bindings<Particle>           { KS(particle_kind); };
+template <> struct bindings<Particle,neutral>   { KV(Particle,neutral); };
+template <> struct bindings<Particle,ion>       { KV(Particle,ion); };
+template <> struct bindings<Particle,electron>  { KV(Particle,electron); };
+} // of namespace mch
+
+//------------------------------------------------------------------------------
+
+XTL_HOST_DEVICE double weight(const Cell& c)
+{
+    MatchKD(c)
+    {
+    CaseKD(Fluid)  return matched->mass * matched->pressure;
+    CaseKD(Solid)  return matched->mass + matched->stress;
+    OtherwiseKD()  return -matched->mass;
+    }
+    EndMatchKD
+}
+
+XTL_HOST_DEVICE void scale(Cell* c)
+{
+    MatchKD(c)
+    {
+    CaseKD(Fluid)  matched->pressure *= 2;  // Through a non-const pointer
+    CaseKD(Solid)  matched->stress   *= 3;
+    }
+    EndMatchKD
+}
+
+XTL_HOST_DEVICE float force(const Particle& p)
+{
+    MatchUD(p)
+    {
+    CaseUD(ion)      return matched->charge;
+    CaseUD(electron) return -1.0f;
+    }
+    EndMatchUD
+
+    return 0.0f;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    Fluid f(2.0, 3.0);
+    Solid s(2.0, 3.0);
+    Cell  v(void_cell, 1.0);
+
+    XTL_VERIFY(weight(f) == 6.0);
+    XTL_VERIFY(weight(s) == 5.0);
+    XTL_VERIFY(weight(v) == -1.0);
+
+    scale(&f);
+    scale(&s);
+    scale(&v);
+
+    XTL_VERIFY(f.pressure == 6.0);
+    XTL_VERIFY(s.stress == 9.0);
+
+    Particle p[] = { {neutral, 1.0f}, {ion | 4, 2.0f}, {electron, 3.0f}, {3, 4.0f} };
+
+    XTL_VERIFY(force(p[0]) == 0.0f);
+    XTL_VERIFY(force(p[1]) == 2.0f);
+    XTL_VERIFY(force(p[2]) == -1.0f);
+    XTL_VERIFY(force(p[3]) == 0.0f);
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,163 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that subjects of kinds without case clauses of their own keep being
+/// dispatched to the clause of their closest base class once Match statements
+/// remember it.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include "match.hpp"                // Support for Match statement
+#include <iostream>
+
+//------------------------------------------------------------------------------
+
+struct Node
+{
+    enum Kind { K_Node, K_Unary, K_Neg, K_Not, K_Binary, K_Add, K_Sub, K_Leaf };
+    Node(Kind k) : kind(k) {}
+    Kind kind;
+};
+
+struct Unary  : Node   { Unary (Kind k = K_Unary)  : Node(k)       {} };
+struct Neg    : Unary  { Neg   ()                  : Unary(K_Neg)  {} };
+struct Not    : Unary  { Not   ()                  : Unary(K_Not)  {} };
+struct Binary : Node   { Binary(Kind k = K_Binary) : Node(k)       {} };
+struct Add    : Binary { Add   ()                  : Binary(K_Add) {} };
+struct Sub    : Binary { Sub   ()                  : Binary(K_Sub) {} };
+struct Leaf   : Node   { Leaf  ()                  : Node(K_Leaf)  {} };
+
+namespace mch ///< Mach7 library namespace
+{
+template <> struct bindings<Node>   { KS(Node::kind); KV(Node,Node::K_Node); };
+template <> struct bindings<Unary>  { KV(Node,Node::K_Unary);  BCS(Unary,Node);         };
+template <> struct bindings<Neg>    { KV(Node,Node::K_Neg);    BCS(Neg,Unary,Node);     };
+template <> struct bindings<Not>    { KV(Node,Node::K_Not);    BCS(Not,Unary,Node);     };
+template <> struct bindings<Binary> { KV(Node,Node::K_Binary); BCS(Binary,Node);        };
+template <> struct bindings<Add>    { KV(Node,Node::K_Add);    BCS(Add,Binary,Node);    };
+template <> struct bindings<Sub>    { KV(Node,Node::K_Sub);    BCS(Sub,Binary,Node);    };
+template <> struct bindings<Leaf>   { KV(Node,Node::K_Leaf);   BCS(Leaf,Node);          };
+} // of namespace mch
+
+//------------------------------------------------------------------------------
+
+/// Clause of the closest class among Neg, Unary, Binary and Node
+int expected(const Node* n)
+{
+    switch (n->kind)
+    {
+    case Node::K_Neg:    return 1;
+    case Node::K_Unary:
+    case Node::K_Not:    return 2;
+    case Node::K_Binary:
+    case Node::K_Add:
+    case Node::K_Sub:    return 3;
+    default:             return 4;
+    }
+}
+
+int match_f(const Node* n)
+{
+    MatchF(n)
+    {
+    CaseF(Neg)    return 1;
+    CaseF(Unary)  return 2;
+    CaseF(Binary) return 3;
+    CaseF(Node)   return 4;
+    }
+    EndMatchF
+
+    return 0;
+}
+
+int match_q(const Node* n)
+{
+    Match(n)
+    {
+    Case(Neg)    return 1;
+    Case(Unary)  return 2;
+    Case(Binary) return 3;
+    Case(Node)   return 4;
+    }
+    EndMatch
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    Node   node(Node::K_Node);
+    Unary  unary;
+    Neg    neg;
+    Not    not_;
+    Binary binary;
+    Add    add;
+    Sub    sub;
+    Leaf   leaf;
+
+    const Node* nodes[] = { &leaf, &add, &neg, &not_, &sub, &unary, &binary, &node };
+    const size_t n = sizeof(nodes)/sizeof(nodes[0]);
+
+    // The first round walks precedence lists, the others use remembered clauses
+    for (size_t r = 0; r < 3; ++r)
+        for (size_t i = 0; i < n; ++i)
+        {
+            XTL_VERIFY(match_f(nodes[i]) == expected(nodes[i]));
+            XTL_VERIFY(match_q(nodes[i]) == expected(nodes[i]));
+        }
+
+    // Precedence lists are kept in a dense array indexed by remapped kind
+    const mch::lbl_type* kinds = mch::get_kinds<Node>(mch::original2remapped<Node>(mch::tag_type(Node::K_Add)));
+
+    XTL_VERIFY(kinds);
+    XTL_VERIFY(kinds[0] == mch::remapped<Add>::lbl);
+    XTL_VERIFY(kinds[1] == mch::remapped<Binary>::lbl);
+    XTL_VERIFY(kinds[2] == mch::remapped<Node>::lbl);
+    XTL_VERIFY(!kinds[3]);
+
+    XTL_VERIFY(mch::get_kinds<Node>(mch::lbl_type(1000)) == 0);
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,166 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// \file
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that subtype tests on kinds answer the same with preorder ranges of
+/// single-inheritance hierarchies as with walks of tag precedence lists, to 
+/// which hierarchies with multiple inheritance fall back.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include "match.hpp"                // Support for Match statement
+#include <iostream>
+
+//------------------------------------------------------------------------------
+
+// Kinds are deliberately not in preorder
+struct Node
+{
+    enum Kind { K_Node, K_Add, K_Unary, K_Binary, K_Neg, K_Leaf, K_Sub };
+    Node(Kind k) : kind(k) {}
+    Kind kind;
+};
+
+struct Unary  : Node   { Unary (Kind k = K_Unary)  : Node(k)       {} };
+struct Neg    : Unary  { Neg   ()                  : Unary(K_Neg)  {} };
+struct Binary : Node   { Binary(Kind k = K_Binary) : Node(k)       {} };
+struct Add    : Binary { Add   ()                  : Binary(K_Add) {} };
+struct Sub    : Binary { Sub   ()                  : Binary(K_Sub) {} };
+struct Leaf   : Node   { Leaf  ()                  : Node(K_Leaf)  {} };
+
+// Diamond-free multiple inheritance
+struct Shape
+{
+    enum Kind { K_Shape, K_Named, K_Circle, K_Label };
+    Shape(Kind k) : kind(k) {}
+    Kind kind;
+};
+
+struct Named  { const char* name; };
+struct Circle : Shape        { Circle(Kind k = K_Circle) : Shape(k) {} };
+struct Label  : Circle, Named { Label() : Circle(K_Label) {} };
+
+namespace mch ///< Mach7 library namespace
+{
+template <> struct bindings<Node>   { KS(Node::kind); KV(Node,Node::K_Node); BCS(Node); };
+template <> struct bindings<Unary>  { KV(Node,Node::K_Unary);  BCS(Unary,Node);         };
+template <> struct bindings<Neg>    { KV(Node,Node::K_Neg);    BCS(Neg,Unary,Node);     };
+template <> struct bindings<Binary> { KV(Node,Node::K_Binary); BCS(Binary,Node);        };
+template <> struct bindings<Add>    { KV(Node,Node::K_Add);    BCS(Add,Binary,Node);    };
+template <> struct bindings<Sub>    { KV(Node,Node::K_Sub);    BCS(Sub,Binary,Node);    };
+template <> struct bindings<Leaf>   { KV(Node,Node::K_Leaf);   BCS(Leaf,Node);          };
+
+template <> struct bindings<Shape>  { KS(Shape::kind); KV(Shape,Shape::K_Shape); BCS(Shape); };
+template <> struct bindings<Circle> { KV(Shape,Shape::K_Circle); BCS(Circle,Shape);       };
+template <> struct bindings<Label>  { KV(Shape,Shape::K_Label);  BCS(Label,Circle,Shape); };
+} // of namespace mch
+
+//------------------------------------------------------------------------------
+
+template <typename B, typename D, typename S>
+void check()
+{
+    const bool result = mch::is_base_and_derived_kinds<S>(mch::remapped<B>::lbl, mch::remapped<D>::lbl);
+    XTL_VERIFY((result == std::is_base_of<B,D>::value));
+}
+
+template <typename B>
+void check_nodes()
+{
+    check<B,Node,Node>(); check<B,Unary,Node>(); check<B,Neg,Node>(); check<B,Binary,Node>();
+    check<B,Add,Node>();  check<B,Sub,Node>();   check<B,Leaf,Node>();
+}
+
+int classify(const Node* n)
+{
+    MatchF(n)
+    {
+    CaseF(Neg)    return 1;
+    CaseF(Unary)  return 2;
+    CaseF(Binary) return 3;
+    CaseF(Node)   return 4;
+    }
+    EndMatchF
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    XTL_VERIFY(mch::get_kind_preorder<Node>().is_tree());
+
+    check_nodes<Node>(); check_nodes<Unary>(); check_nodes<Neg>(); check_nodes<Binary>();
+    check_nodes<Add>();  check_nodes<Sub>();   check_nodes<Leaf>();
+
+    // Subtrees of Unary and Binary are numbered within their own ranges
+    XTL_VERIFY(mch::get_kind_preorder<Unary>().is_tree());
+    XTL_VERIFY(mch::get_kind_preorder<Binary>().is_tree());
+
+    check<Binary,Add,Binary>(); check<Binary,Sub,Binary>(); check<Unary,Neg,Unary>();
+
+    Neg neg; Add add; Leaf leaf; Unary unary;
+
+    XTL_VERIFY(classify(&neg) == 1);
+    XTL_VERIFY(classify(&unary) == 2);
+    XTL_VERIFY(classify(&add) == 3);
+    XTL_VERIFY(classify(&leaf) == 4);
+
+    // Named has no kind, so the list of Label is still its kind followed by 
+    // that of its parent and the hierarchy is numbered
+    XTL_VERIFY(mch::get_kind_preorder<Shape>().is_tree());
+
+    check<Shape,Label,Shape>(); check<Circle,Label,Shape>(); check<Label,Circle,Shape>(); check<Circle,Shape,Shape>();
+
+    // Lists that do not form a tree fall back to walks
+    static const mch::lbl_type bad[] = { mch::remapped<Label>::lbl, mch::remapped<Shape>::lbl, mch::remapped<Circle>::lbl, mch::lbl_type(0) };
+    mch::set_kinds<Shape>(mch::remapped<Label>::lbl, bad);
+
+    XTL_VERIFY(!mch::get_kind_preorder<Shape>().is_tree());
+
+    check<Shape,Label,Shape>(); check<Circle,Label,Shape>(); check<Label,Circle,Shape>(); check<Circle,Shape,Shape>();
+}
+
+//------------------------------------------------------------------------------
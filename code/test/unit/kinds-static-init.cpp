@@ -0,0 +1,136 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that tag precedence lists are available during dynamic 
+/// initialization of the program and that Match statements executed then
+/// still dispatch subjects to the clauses of their exact kinds.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include "match.hpp"                // Support for Match statement
+#include <iostream>
+
+//------------------------------------------------------------------------------
+
+struct Node
+{
+    enum Kind { K_Node, K_Unary, K_Binary, K_Add };
+    Node(Kind k) : kind(k) {}
+    Kind kind;
+};
+
+struct Unary  : Node   { Unary ()                  : Node(K_Unary) {} };
+struct Binary : Node   { Binary(Kind k = K_Binary) : Node(k)       {} };
+struct Add    : Binary { Add   ()                  : Binary(K_Add) {} };
+
+namespace mch ///< Mach7 library namespace
+{
+template <> struct bindings<Node>   { KS(Node::kind); KV(Node,Node::K_Node); };
+template <> struct bindings<Unary>  { KV(Node,Node::K_Unary);  BCS(Unary,Node);      };
+template <> struct bindings<Binary> { KV(Node,Node::K_Binary); BCS(Binary,Node);     };
+template <> struct bindings<Add>    { KV(Node,Node::K_Add);    BCS(Add,Binary,Node); };
+} // of namespace mch
+
+//------------------------------------------------------------------------------
+
+int match_f(const Node* n)
+{
+    MatchF(n)
+    {
+    CaseF(Unary)  return 1;
+    CaseF(Binary) return 2;
+    CaseF(Add)    return 3;
+    CaseF(Node)   return 4;
+    }
+    EndMatchF
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+/// Checks run during dynamic initialization
+bool check_during_initialization()
+{
+    // Lists are constant arrays that need no initialization
+    const mch::lbl_type* kinds = mch::bindings<Add>::get_kinds();
+
+    XTL_VERIFY(kinds[0] == mch::remapped<Add>::lbl);
+    XTL_VERIFY(kinds[1] == mch::remapped<Binary>::lbl);
+    XTL_VERIFY(kinds[2] == mch::remapped<Node>::lbl);
+    XTL_VERIFY(!kinds[3]);
+
+    Node   node(Node::K_Node);
+    Unary  unary;
+    Binary binary;
+
+    XTL_VERIFY(match_f(&unary)  == 1);
+    XTL_VERIFY(match_f(&binary) == 2);
+    XTL_VERIFY(match_f(&node)   == 4);
+
+    return true;
+}
+
+static const bool checked_during_initialization = check_during_initialization();
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    XTL_VERIFY(checked_during_initialization);
+
+    Node   node(Node::K_Node);
+    Unary  unary;
+    Binary binary;
+    Add    add;
+
+    const Node*  nodes[]    = { &node, &unary, &binary, &add };
+    const int    expected[] = { 4, 1, 2, 3 };
+    const size_t n = sizeof(nodes)/sizeof(nodes[0]);
+
+    for (size_t r = 0; r < 2; ++r)
+        for (size_t i = 0; i < n; ++i)
+            XTL_VERIFY(match_f(nodes[i]) == expected[i]);
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,149 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that vtbl maps of Match statements do not allocate until the first
+/// time the statement is executed and allocate only once then.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include "match.hpp"
+
+//------------------------------------------------------------------------------
+
+static size_t allocations = 0; ///< Number of calls to global operator new
+
+void* operator new(size_t n)
+{
+    ++allocations;
+
+    if (void* p = std::malloc(n ? n : 1))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t n)       { return operator new(n); }
+void  operator delete(void* p)   noexcept { std::free(p); }
+void  operator delete[](void* p) noexcept { std::free(p); }
+
+//------------------------------------------------------------------------------
+
+struct Shape                { virtual ~Shape() {} };
+struct Circle   : Shape     {};
+struct Square   : Shape     {};
+struct Triangle : Shape     {};
+
+//------------------------------------------------------------------------------
+
+int classify(const Shape& s)
+{
+    Match(s)
+    {
+        Case(Circle)   return 1;
+        Case(Square)   return 2;
+        Case(Triangle) return 3;
+    }
+    EndMatch
+
+    return 0;
+}
+
+/// Never called, so its vtbl map should never allocate
+int never_called(const Shape& s)
+{
+    Match(s)
+    {
+        Case(Circle)   return 4;
+        Case(Square)   return 5;
+    }
+    EndMatch
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    {
+        size_t before = allocations;
+        mch::vtblmap<mch::type_switch_info> map(20);
+        XTL_VERIFY(allocations == before);         // Constructed without allocating
+        XTL_VERIFY(map.memory_used() == sizeof(map));
+
+        Circle c;
+        Square s;
+        map.get(&c).target = 1;
+        XTL_VERIFY(allocations != before);         // Allocated on first lookup
+        XTL_VERIFY(map.memory_used() != sizeof(map));
+
+        size_t after = allocations;
+        map.get(&s).target = 2;
+        XTL_VERIFY(allocations == after);          // Second vtbl fits the cache without allocating
+        XTL_VERIFY(map.get(&c).target == 1);
+        XTL_VERIFY(map.get(&s).target == 2);
+    }
+
+    Circle   c;
+    Square   s;
+    Triangle t;
+    Shape    x;
+
+    size_t before = allocations;
+    XTL_VERIFY(classify(c) == 1);
+    XTL_VERIFY(allocations != before);             // The map of classify allocated now
+
+    size_t after = allocations;
+    XTL_VERIFY(classify(s) == 2);
+    XTL_VERIFY(classify(t) == 3);
+    XTL_VERIFY(classify(x) == 0);
+    XTL_VERIFY(classify(c) == 1);
+    XTL_VERIFY(allocations == after);              // ... and only once for a few classes
+
+    if (allocations > 1000000)
+        XTL_VERIFY(never_called(c) == 4);          // Not executed, only to instantiate the map
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,194 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks learned_ptr_map against std::map on random insertions, lookups and
+/// erasures of pointers to objects, pointers to functions and integers.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <vector>
+#include "learned_ptr_map.hpp"
+
+//------------------------------------------------------------------------------
+
+/// Compares content of learned_ptr_map m with that of std::map r
+template <typename K, typename V>
+void check(const mch::learned_ptr_map<K,V>& m, const std::map<K,V>& r)
+{
+    XTL_VERIFY(m.size() == r.size());
+    size_t n = 0;
+
+    for (typename mch::learned_ptr_map<K,V>::const_iterator p = m.begin(); p != m.end(); ++p, ++n)
+    {
+        typename std::map<K,V>::const_iterator q = r.find(p->first);
+        XTL_VERIFY(q != r.end() && q->second == p->second);
+    }
+
+    for (typename std::map<K,V>::const_iterator q = r.begin(); q != r.end(); ++q)
+    {
+        typename mch::learned_ptr_map<K,V>::const_iterator p = m.find(q->first);
+        XTL_VERIFY(p != m.end() && p->second == q->second);
+    }
+
+    XTL_VERIFY(n == r.size());
+}
+
+//------------------------------------------------------------------------------
+
+/// Inserts, looks up and erases random keys from keys in m and in std::map
+template <typename K>
+void random_test(const std::vector<K>& keys, size_t steps)
+{
+    mch::learned_ptr_map<K,int> m;
+    std::map<K,int>             r;
+
+    for (size_t i = 0; i < steps; ++i)
+    {
+        const K& k = keys[std::rand() % keys.size()];
+
+        switch (std::rand() % 4)
+        {
+        case 0:
+        case 1: m[k] = int(i); r[k] = int(i); break;
+        case 2: XTL_VERIFY(m.count(k) == r.count(k)); break;
+        case 3: XTL_VERIFY(m.erase(k) == r.erase(k)); break;
+        }
+
+        if (i % 64 == 0)
+            check(m, r);
+    }
+
+    check(m, r);
+
+    // Erase through iterators until empty
+    while (!m.empty())
+    {
+        r.erase(m.begin()->first);
+        m.erase(m.begin());
+        check(m, r);
+    }
+
+    XTL_VERIFY(r.empty());
+    XTL_VERIFY(m.begin() == m.end());
+}
+
+//------------------------------------------------------------------------------
+
+void f0() {} void f1() {} void f2() {} void f3() {} void f4() {} void f5() {} void f6() {} void f7() {}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    // Pointers to objects with uniform stride, whose lowest bits never differ
+    {
+        static double objects[300];
+        std::vector<const double*> keys;
+
+        for (size_t i = 0; i < 300; ++i)
+            keys.push_back(&objects[i]);
+
+        random_test(keys, 20000);
+
+        // Bulk insertion learns once and places every key in its home slot
+        std::vector<std::pair<const double*,int>> kvs;
+
+        for (size_t i = 0; i < 100; ++i)
+            kvs.push_back(std::make_pair(keys[i], int(i)));
+
+        mch::learned_ptr_map<const double*,int> m(kvs.begin(), kvs.end());
+        XTL_VERIFY(m.size() == 100);
+        XTL_VERIFY(m.displaced() == 0);
+        XTL_VERIFY(m.shift() == 3);
+
+        for (size_t i = 0; i < 100; ++i)
+            XTL_VERIFY(m[keys[i]] == int(i));
+
+        std::pair<mch::learned_ptr_map<const double*,int>::iterator,bool> p = m.insert(std::make_pair(keys[7], -1));
+        XTL_VERIFY(!p.second);
+        XTL_VERIFY(p.first->second == 7);
+        p = m.insert(std::make_pair(keys[200], -1));
+        XTL_VERIFY(p.second);
+        XTL_VERIFY(p.first->second == -1);
+        XTL_VERIFY(m.size() == 101);
+
+        m.clear();
+        XTL_VERIFY(m.empty());
+        XTL_VERIFY(m.count(keys[7]) == 0);
+        XTL_VERIFY(m.memory_used() == sizeof(m));
+    }
+
+    // Pointers to heap objects of different sizes
+    {
+        std::vector<char*> keys;
+
+        for (size_t i = 0; i < 200; ++i)
+            keys.push_back(new char[1 + std::rand() % 100]);
+
+        random_test(keys, 20000);
+
+        for (size_t i = 0; i < keys.size(); ++i)
+            delete[] keys[i];
+    }
+
+    // Pointers to functions
+    {
+        typedef void (*fun)();
+        fun fs[] = {&f0, &f1, &f2, &f3, &f4, &f5, &f6, &f7};
+        random_test(std::vector<fun>(fs, fs + 8), 2000);
+    }
+
+    // Integers with only high bits differing, as in interned handles
+    {
+        std::vector<unsigned long> keys;
+
+        for (unsigned long i = 1; i <= 1000; ++i)
+            keys.push_back(i << 12 | 0x5);
+
+        random_test(keys, 50000);
+    }
+}
+
+//------------------------------------------------------------------------------
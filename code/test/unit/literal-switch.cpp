@@ -0,0 +1,116 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Decodes opcodes with #MatchL, whose literal clauses become case labels of a
+/// switch statement, and checks that guarded clauses keep their order against 
+/// a sequence of comparisons made by hand.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include "match.hpp"                // Support for Match statement
+#include "patterns/all.hpp"         // Support for patterns in When sub-clauses
+#include <iostream>
+
+//------------------------------------------------------------------------------
+
+enum class color { red, green, blue, black };
+
+int decode(int opcode)
+{
+    mch::var<int> n;
+
+    MatchL(opcode)
+    {
+    CaseL(0)                          return 0;
+    CaseL(1,2,3) WhenL(n |= n % 2)    return 10 + n;   // Odd of 1,2,3
+    CaseL(4,5)                        return 20;
+    CaseL(7)     WhenL(7)             return 30;
+                 WhenL(n |= n > 100)  return 31;       // Never accepts 7
+    CaseL(9)                          return 40;
+    CaseL(8)                          return 50;
+    OtherwiseL() WhenL(n |= n >= 100) return 60;
+                 WhenL()              return 70;       // Reached by 2 falling through from the clause on 1,2,3
+    }
+    EndMatchL
+
+    return -1;
+}
+
+int decode_by_hand(int opcode)
+{
+    if (opcode == 0)                                return 0;
+    if ((opcode == 1 || opcode == 3))               return 10 + opcode;
+    if (opcode == 4 || opcode == 5)                 return 20;
+    if (opcode == 7)                                return 30;
+    if (opcode == 9)                                return 40;
+    if (opcode == 8)                                return 50;
+    if (opcode >= 100)                              return 60;
+    return 70;
+}
+
+int name_length(color c)
+{
+    MatchL(c)
+    {
+    CaseL(color::red)              return 3;
+    CaseL(color::green)            return 5;
+    CaseL(color::blue)             return 4;
+    }
+    EndMatchL
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    for (int i = -5; i < 120; ++i)
+        XTL_VERIFY(decode(i) == decode_by_hand(i));
+
+    XTL_VERIFY(name_length(color::red)   == 3);
+    XTL_VERIFY(name_length(color::green) == 5);
+    XTL_VERIFY(name_length(color::blue)  == 4);
+    XTL_VERIFY(name_length(color::black) == 0);
+}
+
+//------------------------------------------------------------------------------
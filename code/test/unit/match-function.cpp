@@ -0,0 +1,149 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that the function form of Match selects the same clauses as the
+/// equivalent sequence of dynamic casts, adjusts the subject to the target
+/// type of the clause and returns results of clauses without copying them.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "match_function.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Shape            { virtual ~Shape() {} };
+struct Circle : Shape   { Circle(int r) : radius(r) {} int radius; };
+struct Square : Shape   { Square(int s) : side(s)   {} int side;   };
+struct Other            { virtual ~Other() {} int dummy; };
+struct Both : Other, Circle { Both() : Circle(7) {} }; ///< Non-zero offset to Shape
+
+/// A family of otherwise unrelated classes to make the vtbl maps grow
+template <int I> struct More : Shape {};
+
+template <int I> void make_more(std::vector<Shape*>& shapes) { make_more<I-1>(shapes); shapes.push_back(new More<I>); }
+template <>      void make_more<0>(std::vector<Shape*>& shapes) { shapes.push_back(new More<0>); }
+
+//------------------------------------------------------------------------------
+
+int expected(const Shape* a)
+{
+    if (const Circle* c = dynamic_cast<const Circle*>(a)) return c->radius;
+    if (const Square* s = dynamic_cast<const Square*>(a)) return 100 + s->side;
+    return 0;
+}
+
+int match_int(const Shape& a)
+{
+    return mch::match(a,
+        mch::case_<Circle>([](const Circle& c) { return c.radius; }),
+        mch::case_<Square>([](const Square& s) { return 100 + s.side; }),
+        mch::otherwise    ([](const Shape&)    { return 0; })
+    );
+}
+
+//------------------------------------------------------------------------------
+
+/// Counts copies of itself to check results are moved out of clauses
+struct counted
+{
+    counted(int v = 0) : value(v) {}
+    counted(const counted& c) : value(c.value) { ++copies; }
+    counted(counted&& c) noexcept : value(c.value) {}
+    int value;
+    static size_t copies;
+};
+
+size_t counted::copies = 0;
+
+counted match_counted(const Shape& a)
+{
+    return mch::match(a,
+        mch::case_<Square>([](const Square& s) { return counted(100 + s.side); }),
+        mch::case_<Circle>([](const Circle& c) { return counted(c.radius); })
+    ); // Value-initialized counted(0) when neither matches
+}
+
+/// Clauses with results of different types are converted to their common type
+std::unique_ptr<std::string> match_name(const Shape& a)
+{
+    return mch::match(a,
+        mch::case_<Circle>([](const Circle&) { return std::unique_ptr<std::string>(new std::string("circle")); }),
+        mch::otherwise    ([](const Shape&)  { return std::unique_ptr<std::string>(); })
+    );
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    std::vector<Shape*> shapes;
+
+    shapes.push_back(new Circle(3));
+    shapes.push_back(new Square(4));
+    shapes.push_back(new Both);
+    make_more<30>(shapes);
+
+    for (size_t r = 0; r < 3; ++r)
+        for (size_t i = 0; i < shapes.size(); ++i)
+        {
+            int e = expected(shapes[i]);
+
+            XTL_VERIFY(match_int(*shapes[i]) == e);
+
+            XTL_VERIFY(match_counted(*shapes[i]).value == e);
+
+            std::unique_ptr<std::string> name = match_name(*shapes[i]);
+
+            XTL_VERIFY((name && *name == "circle") == (dynamic_cast<const Circle*>(shapes[i]) != 0));
+        }
+
+    XTL_VERIFY(counted::copies == 0);
+
+    for (size_t i = 0; i < shapes.size(); ++i)
+        delete shapes[i];
+}
+
+//------------------------------------------------------------------------------
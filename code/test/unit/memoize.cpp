@@ -0,0 +1,137 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that recursive functions defined by Match statements compute the 
+/// same results when memoized with mch::memoized, calling themselves only 
+/// once per distinct argument, and that memoization within a table too small
+/// for all the arguments stays correct.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <iostream>
+#include "memoize.hpp"
+#include "type_switchN-patterns.hpp"
+#include "patterns/guard.hpp"
+#include "patterns/n+k.hpp"
+#include "patterns/primitive.hpp"
+
+//------------------------------------------------------------------------------
+
+using namespace mch;
+
+size_t calls = 0; ///< Number of calls of the pattern-defined functions
+
+//------------------------------------------------------------------------------
+
+long long fib(int n);
+
+/// Exponential definition of Fibonacci numbers
+long long fib_match(int n)
+{
+    ++calls;
+    var<int> m;
+
+    Match(n)
+    {
+        Case(0)     return 0;
+        Case(1)     return 1;
+        Case(m+2)   return fib(m+1) + fib(m);
+    }
+    EndMatch
+
+    return -1;
+}
+
+memoized<long long(int)> memo_fib(fib_match);
+
+long long fib(int n) { return memo_fib(n); }
+
+//------------------------------------------------------------------------------
+
+/// Binomial coefficients through Pascal's triangle, on pairs of subjects
+long long choose(int n, int k);
+
+long long choose_match(int n, int k)
+{
+    ++calls;
+    var<int> x, y;
+
+    Match(n, k)
+    {
+        Case(_, 0)              return 1;
+        Case(x, +x)             return 1;
+        Case(x, y)              return choose(x-1, y-1) + choose(x-1, y);
+    }
+    EndMatch
+
+    return -1;
+}
+
+memoized<long long(int,int)> memo_choose(choose_match, 4); // Only 16 slots
+
+long long choose(int n, int k) { return memo_choose(n, k); }
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    calls = 0;
+    XTL_VERIFY(fib(90) == 2880067194370816120LL);
+    XTL_VERIFY(calls == 91);               // Once per argument 0..90
+    XTL_VERIFY(memo_fib.misses() == 91);
+
+    calls = 0;
+    XTL_VERIFY(fib(50) == 12586269025LL);  // Remembered
+    XTL_VERIFY(calls == 0);
+
+    memo_fib.clear();
+    XTL_VERIFY(fib(10) == 55);
+    XTL_VERIFY(calls == 11);
+
+    // Far more arguments than slots: results stay correct while old ones are replaced
+    calls = 0;
+    XTL_VERIFY(choose(30, 15) == 155117520LL);
+    XTL_VERIFY(memo_choose.capacity() == 16);
+    XTL_VERIFY(memo_choose.hits() != 0); // Still reuses recent results
+}
+
+//------------------------------------------------------------------------------
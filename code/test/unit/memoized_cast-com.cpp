@@ -0,0 +1,207 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that with #XTL_USE_MEMOIZED_CAST the user-defined casts plugged into
+/// type_switchN-patterns-xtl.hpp through xtl::subtype_dynamic_cast, here the 
+/// QueryInterface of a COM-like component model, are memoized per dynamic type
+/// and target type, so that nested patterns call QueryInterface only once per
+/// pair of them.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_USE_MEMOIZED_CAST 1
+
+#include <iostream>
+#include "type_switchN-patterns-xtl.hpp"
+#include "patterns/all.hpp"
+
+//------------------------------------------------------------------------------
+
+static size_t queries = 0; ///< Number of calls to QueryInterface
+
+enum interface_id { IID_IUnknown, IID_IShape, IID_IColored, IID_IContainer };
+
+struct IUnknown
+{
+    virtual ~IUnknown() {}
+    virtual bool QueryInterface(interface_id iid, const void** ppv) const = 0;
+};
+
+struct IShape     : IUnknown { static const interface_id iid = IID_IShape;     virtual int area()  const = 0; };
+struct IColored   : IUnknown { static const interface_id iid = IID_IColored;   virtual int color() const = 0; };
+struct IContainer : IUnknown { static const interface_id iid = IID_IContainer; virtual const IUnknown* item() const = 0; };
+
+struct Square : IShape, IColored
+{
+    Square(int s, int c) : side(s), shade(c) {}
+    bool QueryInterface(interface_id iid, const void** ppv) const override
+    {
+        ++queries;
+        switch (iid)
+        {
+        case IID_IUnknown:
+        case IID_IShape:   *ppv = static_cast<const IShape*>(this);   return true;
+        case IID_IColored: *ppv = static_cast<const IColored*>(this); return true;
+        default:           *ppv = nullptr;                            return false;
+        }
+    }
+    int area()  const override { return side*side; }
+    int color() const override { return shade; }
+    int side, shade;
+};
+
+struct Dot : IColored
+{
+    explicit Dot(int c) : shade(c) {}
+    bool QueryInterface(interface_id iid, const void** ppv) const override
+    {
+        ++queries;
+        *ppv = iid == IID_IUnknown || iid == IID_IColored ? static_cast<const IColored*>(this) : nullptr;
+        return *ppv != nullptr;
+    }
+    int color() const override { return shade; }
+    int shade;
+};
+
+struct Box : IContainer
+{
+    explicit Box(const IUnknown* i) : content(i) {}
+    bool QueryInterface(interface_id iid, const void** ppv) const override
+    {
+        ++queries;
+        *ppv = iid == IID_IUnknown || iid == IID_IContainer ? static_cast<const IContainer*>(this) : nullptr;
+        return *ppv != nullptr;
+    }
+    const IUnknown* item() const override { return content; }
+    const IUnknown* content;
+};
+
+namespace xtl
+{
+    template <>
+    struct is_poly_morphic<IUnknown>
+    {
+        static const bool value = true;
+    };
+
+    /// Interfaces are only reachable from each other through QueryInterface
+    template <class T>
+    inline typename std::enable_if<std::is_base_of<IUnknown,T>::value && !std::is_same<T,IUnknown>::value, const T*>::type
+    subtype_dynamic_cast_impl(target<const T*>, const IUnknown* p) noexcept
+    {
+        const void* q;
+        return p->QueryInterface(T::iid, &q) ? static_cast<const T*>(q) : nullptr;
+    }
+}
+
+namespace mch ///< Mach7 library namespace
+{
+template <> struct bindings<IShape>     { Members(IShape::area); };
+template <> struct bindings<IColored>   { Members(IColored::color); };
+template <> struct bindings<IContainer> { Members(IContainer::item); };
+} // of namespace mch
+
+//------------------------------------------------------------------------------
+
+using mch::C;
+
+/// Content of a box: the nested patterns test the type of the item every time
+int content(const IUnknown& u)
+{
+    mch::var<int> n;
+
+    Match(u)
+    {
+        Case(C<IContainer>(C<IShape>(n)))   return 1000 + n;
+        Case(C<IContainer>(C<IColored>(n))) return 2000 + n;
+        Case(C<IContainer>())               return 3000;
+        Otherwise()                         return 0;
+    }
+    EndMatch
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    Square s(3, 7);
+    Dot    d(5);
+    Box    bs(static_cast<const IShape*>(&s)), bd(&d), bb(&bs);
+
+    for (int i = 0; i < 10; ++i)
+    {
+        XTL_VERIFY(content(bs) == 1009);
+        XTL_VERIFY(content(bd) == 2005);
+        XTL_VERIFY(content(bb) == 3000);
+        XTL_VERIFY(content(static_cast<const IShape&>(s)) == 0);
+    }
+
+    // One query per dynamic type, among Box, Square, Dot, and interface tried on it
+    const size_t first = queries;
+    XTL_VERIFY(first <= 10);
+
+    for (int i = 0; i < 10; ++i)
+    {
+        XTL_VERIFY(content(bs) == 1009);
+        XTL_VERIFY(content(bd) == 2005);
+    }
+
+    XTL_VERIFY(queries == first);
+
+    // Direct casts are memoized too and agree with QueryInterface
+    const IUnknown* u = static_cast<const IShape*>(&s);
+    size_t second = 0;
+
+    for (int i = 0; i < 10; ++i)
+    {
+        XTL_VERIFY(dynamic_cast<const IColored*>(u)   == static_cast<const IColored*>(&s));
+        XTL_VERIFY(dynamic_cast<const IContainer*>(u) == nullptr);
+
+        if (i == 0)
+            second = queries;
+    }
+
+    XTL_VERIFY(second <= first + 2);
+    XTL_VERIFY(queries == second);
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,152 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that mch::invalidate_vtbl_range() drops entries of vtbl pointers in
+/// the range from vtblmap<T> of Match statements on a single subject and of 
+/// memoized_cast, and keeps their results correct afterwards.
+/// \see vtbl-invalidation.cpp for vtbl_map<N,T>
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_VTBL_INVALIDATION 1 // Allow dropping entries of unloaded vtbls
+#define XTL_USE_MEMOIZED_CAST 1 // Type tests of Match statements use memoized_cast as well
+
+#include <iostream>
+#include <typeinfo>
+#include "match.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Shape            { virtual ~Shape() {} };
+struct Circle : Shape   {};
+struct Oval   : Circle  {};
+struct Square : Shape   {};
+struct Cube   : Square  {};
+
+/// Range of addresses covering only the vtbl of the dynamic type of s, as if
+/// it was in a shared library about to be unloaded
+inline const void* vtbl_begin(const Shape& s) { return reinterpret_cast<const void*>(mch::vtbl_of(&s)); }
+inline const void* vtbl_end(const Shape& s)   { return reinterpret_cast<const void*>(mch::vtbl_of(&s)+1); }
+
+//------------------------------------------------------------------------------
+
+/// dynamic_cast is memoized here, so results are computed from typeid
+int expected(const Shape* a)
+{
+    if (typeid(*a) == typeid(Oval))   return 1;
+    if (typeid(*a) == typeid(Circle)) return 2;
+    if (typeid(*a) == typeid(Cube))   return 4;
+    if (typeid(*a) == typeid(Square)) return 3;
+    return 0;
+}
+
+bool is_circle(const Shape* a) { return typeid(*a) == typeid(Circle) || typeid(*a) == typeid(Oval); }
+
+//------------------------------------------------------------------------------
+
+/// Statement on a single subject, which uses vtblmap<T>
+int classify(const Shape* a)
+{
+    MatchP(a)
+    {
+    CaseP(Oval)   return 1;
+    CaseP(Circle) return 2;
+    CaseP(Cube)   return 4;
+    CaseP(Square) return 3;
+    }
+    EndMatchP
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+void check(const Shape* const (&shapes)[5])
+{
+    for (size_t r = 0; r < 2; ++r)
+        for (size_t i = 0; i < XTL_ARR_SIZE(shapes); ++i)
+        {
+            XTL_VERIFY(classify(shapes[i]) == expected(shapes[i]));
+
+            XTL_VERIFY((memoized_cast<const Circle*>(shapes[i]) != 0) == is_circle(shapes[i]));
+        }
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    Shape  x;
+    Circle c;
+    Oval   o;
+    Square s;
+    Cube   q;
+
+    const Shape* const shapes[] = {&x, &c, &o, &s, &q};
+    check(shapes);
+
+    // Maps that have not seen the class keep their entries in place
+    static const mch::vtbl_count_t clauses = 4;
+    mch::vtblmap<int> untouched(clauses);
+    mch::vtblmap<int> touched(clauses);
+    untouched.get(&s) = 3;
+    touched.get(&s)   = 3;
+    touched.get(&c)   = 2;
+    const int* before = &untouched.get(&s);
+
+    // Circle is in the maps of classify, memoized_cast and touched
+    XTL_VERIFY(mch::invalidate_vtbl_range(vtbl_begin(c), vtbl_end(c)) == 3);
+
+    // Nothing left to drop
+    XTL_VERIFY(mch::invalidate_vtbl_range(vtbl_begin(c), vtbl_end(c)) == 0);
+
+    XTL_VERIFY(&untouched.get(&s) == before);
+    XTL_VERIFY(untouched.get(&s) == 3);
+
+    // The entry of Circle is gone, while the others keep their values
+    XTL_VERIFY(touched.get(&c) == 0);
+    XTL_VERIFY(touched.get(&s) == 3);
+
+    check(shapes);
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,130 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that memoized_cast gives the same results as dynamic_cast when many
+/// threads cast concurrently to more target types than fit a single segment
+/// of memoized offsets.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_MULTI_THREADING 1 // Use multi-threaded vtblmap in memoized_cast
+
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "memoized_cast.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Shape            { virtual ~Shape() {} int s; };
+struct Extra            { virtual ~Extra() {} int e; };
+
+/// A family of classes, every other of which also derives from Extra
+template <int I> struct Leaf  : Shape        { int l; };
+template <int I> struct Mixed : Shape, Extra { int m; };
+
+static const int targets = 24; ///< Number of each kind of target types
+
+//------------------------------------------------------------------------------
+
+/// Casts p to each Leaf<I> and Mixed<I> with memoized_cast and dynamic_cast
+template <int I>
+void check(const Shape* p, std::integral_constant<int,I>)
+{
+    XTL_VERIFY(memoized_cast<const Leaf<I>*> (p) == dynamic_cast<const Leaf<I>*> (p));
+    XTL_VERIFY(memoized_cast<const Mixed<I>*>(p) == dynamic_cast<const Mixed<I>*>(p));
+    check(p, std::integral_constant<int,I+1>());
+}
+
+inline void check(const Shape*, std::integral_constant<int,targets>) {}
+
+/// Cross-cast to a sibling base class
+inline void check_cross(const Shape* p)
+{
+    XTL_VERIFY(memoized_cast<const Extra*>(p) == dynamic_cast<const Extra*>(p));
+}
+
+//------------------------------------------------------------------------------
+
+template <int I>
+void make(std::vector<Shape*>& shapes, std::integral_constant<int,I>)
+{
+    shapes.push_back(new Leaf<I>);
+    shapes.push_back(new Mixed<I>);
+    make(shapes, std::integral_constant<int,I+1>());
+}
+
+inline void make(std::vector<Shape*>&, std::integral_constant<int,targets>) {}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    std::vector<Shape*> shapes;
+
+    make(shapes, std::integral_constant<int,0>());
+
+    const size_t n = shapes.size();
+    std::vector<std::thread> threads;
+
+    // Every thread walks the subjects in its own order, so that threads learn
+    // new vtbls and new target types concurrently.
+    for (size_t t = 0; t < 8; ++t)
+        threads.push_back(std::thread([&shapes,n,t]()
+        {
+            for (size_t r = 0; r < 200; ++r)
+                for (size_t i = 0; i < n; ++i)
+                {
+                    const Shape* p = shapes[(i*(2*t+1) + r) % n];
+                    check(p, std::integral_constant<int,0>());
+                    check_cross(p);
+                }
+        }));
+
+    for (size_t t = 0; t < threads.size(); ++t)
+        threads[t].join();
+
+    for (size_t i = 0; i < n; ++i)
+        delete shapes[i];
+}
+
+//------------------------------------------------------------------------------
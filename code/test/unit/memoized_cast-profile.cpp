@@ -0,0 +1,141 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that #XTL_CAST_PROFILING counts calls, misses and failures of 
+/// memoized_cast separately for each pair of source and target types, and 
+/// reports the vtbls known to the offsets of the source type.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_CAST_PROFILING 1
+
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <vector>
+#include "memoized_cast.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Shape                 { virtual ~Shape() {} int s; };
+struct Extra                 { virtual ~Extra() {} int e; };
+struct Circle : Shape        { int c; };
+struct Square : Shape, Extra { int q; };
+
+//------------------------------------------------------------------------------
+
+/// Profile of casts from S to T or null if there were none
+template <typename S, typename T>
+const mch::cast_profile* find_profile()
+{
+    const mch::cast_profile* result = 0;
+    mch::for_each_cast_profile([&result](const mch::cast_profile& p) { if (p.source == typeid(S) && p.target == typeid(T)) result = &p; });
+    return result;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    XTL_VERIFY(mch::cast_profile::first() == 0); // Nothing is profiled before the first cast
+
+    Circle c;
+    Square q;
+    Shape* shapes[] = { &c, &q, &c, &q, &c };
+
+    for (size_t r = 0; r < 3; ++r)
+        for (size_t i = 0; i < 5; ++i)
+        {
+            XTL_VERIFY(memoized_cast<Square*>(shapes[i]) == dynamic_cast<Square*>(shapes[i]));
+            XTL_VERIFY(memoized_cast<Extra*> (shapes[i]) == dynamic_cast<Extra*> (shapes[i]));
+        }
+
+    const mch::cast_profile* square = find_profile<Shape,Square>();
+    const mch::cast_profile* extra  = find_profile<Shape,Extra>();
+
+    XTL_VERIFY(square);
+    XTL_VERIFY(extra);
+    XTL_VERIFY((!find_profile<Shape,Circle>()));
+
+    if (square && extra)
+    {
+        // Each vtbl misses once per target type, Circle never casts to either
+        XTL_VERIFY(square->calls() == 15);
+        XTL_VERIFY(square->misses() == 2);
+        XTL_VERIFY(square->hits() == 13);
+        XTL_VERIFY(square->failures() == 9);
+        XTL_VERIFY(extra->calls() == 15);
+        XTL_VERIFY(extra->misses() == 2);
+        XTL_VERIFY(extra->hits() == 13);
+        XTL_VERIFY(extra->failures() == 9);
+
+        // Both target types share the offsets of Shape
+        XTL_VERIFY(square->source_vtbls() == 2);
+        XTL_VERIFY(extra->source_vtbls() == 2);
+        XTL_VERIFY(square->source_memory_used() != 0);
+        XTL_VERIFY(square->source_memory_used() == extra->source_memory_used());
+    }
+
+    // Range casts are counted per element, a run of the same vtbl misses once
+    Circle* circles[5];
+    memoized_cast_range<Circle*>(shapes, shapes + 5, circles);
+    const mch::cast_profile* circle = find_profile<Shape,Circle>();
+    XTL_VERIFY(circle);
+
+    if (circle)
+    {
+        XTL_VERIFY(circle->calls() == 5);
+        XTL_VERIFY(circle->misses() == 2);
+        XTL_VERIFY(circle->failures() == 2);
+    }
+
+    // Busiest pairs are printed first
+    std::ostringstream dump;
+    mch::dump_cast_profiles(dump);
+    const std::string text = dump.str();
+    XTL_VERIFY(text.find(typeid(Circle).name()) != std::string::npos);
+    XTL_VERIFY(text.find(typeid(Circle).name()) >= text.find(typeid(Extra).name()));
+
+    std::cout << text;
+}
+
+//------------------------------------------------------------------------------
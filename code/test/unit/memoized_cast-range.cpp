@@ -0,0 +1,125 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that memoized_cast_range gives the same results as dynamic_cast on
+/// every element of a range, including null pointers, runs of objects of the
+/// same class, cross-casts and casts that do not exist.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <iostream>
+#include <iterator>
+#include <vector>
+#include "memoized_cast.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Shape                 { virtual ~Shape() {} int s; };
+struct Extra                 { virtual ~Extra() {} int e; };
+struct Circle : Shape        { int c; };
+struct Square : Shape, Extra { int q; };
+struct Cube   : Square       { int k; };
+
+//------------------------------------------------------------------------------
+
+/// Compares memoized_cast_range<T> on shapes with dynamic_cast<T> of each element
+template <typename T, typename S>
+void check(const std::vector<S*>& shapes)
+{
+    std::vector<T> result;
+
+    memoized_cast_range<T>(shapes.begin(), shapes.end(), std::back_inserter(result));
+
+    XTL_VERIFY(result.size() == shapes.size());
+
+    for (size_t i = 0; i < shapes.size() && i < result.size(); ++i)
+        XTL_VERIFY(result[i] == dynamic_cast<T>(shapes[i]));
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    std::vector<Shape*> shapes;
+
+    // Runs of objects of the same class interleaved with others and nulls
+    for (size_t i = 0; i < 100; ++i)
+        switch (i / 7 % 5)
+        {
+        case 0: shapes.push_back(new Circle); break;
+        case 1: shapes.push_back(new Square); break;
+        case 2: shapes.push_back(new Cube);   break;
+        case 3: shapes.push_back(i % 2 ? new Circle : 0); break;
+        case 4: shapes.push_back(i % 3 ? static_cast<Shape*>(new Cube) : new Square); break;
+        }
+
+    std::vector<const Shape*> const_shapes(shapes.begin(), shapes.end());
+
+    for (size_t r = 0; r < 2; ++r)
+    {
+        check<Circle*>(shapes);
+        check<Square*>(shapes);
+        check<Cube*>  (shapes);
+        check<Extra*> (shapes);
+        check<const Square*>(shapes);
+        check<const Extra*> (const_shapes);
+        check<const Cube*>  (const_shapes);
+    }
+
+    // Range casts and single casts share memoized offsets
+    for (size_t i = 0; i < shapes.size(); ++i)
+        XTL_VERIFY(memoized_cast<Extra*>(shapes[i]) == dynamic_cast<Extra*>(shapes[i]));
+
+    // Plain arrays work as well
+    Shape* array[3] = { shapes[7], shapes[14], shapes[0] };
+    Cube*  cubes[3];
+
+    XTL_VERIFY(memoized_cast_range<Cube*>(array, array + 3, cubes) == cubes + 3);
+    XTL_VERIFY(cubes[0] == 0);
+    XTL_VERIFY(cubes[1] == dynamic_cast<Cube*>(array[1]));
+    XTL_VERIFY(cubes[2] == 0);
+
+    for (size_t i = 0; i < shapes.size(); ++i)
+        delete shapes[i];
+}
+
+//------------------------------------------------------------------------------
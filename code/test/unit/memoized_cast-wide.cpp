@@ -0,0 +1,103 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks memoized_cast from a source type used with many target types, most
+/// of which no given dynamic type can be cast to, against dynamic_cast.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <iostream>
+#include <vector>
+#include "memoized_cast.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Shape { virtual ~Shape() {} int s; };
+
+/// A wide hierarchy: each Leaf<I> with I > 1 derives from Leaf<I/2>, so it 
+/// can only be cast to a handful of the target types: its ancestors.
+template <int I> struct Leaf     : Leaf<I/2> { int l; };
+template <>      struct Leaf<1>  : Shape     { int l; };
+
+static const int targets = 200; ///< Number of target types
+
+//------------------------------------------------------------------------------
+
+/// Casts p to each Leaf<I> with memoized_cast and dynamic_cast
+template <int I>
+void check(const Shape* p, std::integral_constant<int,I>)
+{
+    XTL_VERIFY(memoized_cast<const Leaf<I>*>(p) == dynamic_cast<const Leaf<I>*>(p));
+    check(p, std::integral_constant<int,I+1>());
+}
+
+inline void check(const Shape*, std::integral_constant<int,targets>) {}
+
+//------------------------------------------------------------------------------
+
+template <int I>
+void make(std::vector<Shape*>& shapes, std::integral_constant<int,I>)
+{
+    if (I % 7 == 0 || I > targets - 5)
+        shapes.push_back(new Leaf<I>);
+    make(shapes, std::integral_constant<int,I+1>());
+}
+
+inline void make(std::vector<Shape*>&, std::integral_constant<int,targets>) {}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    std::vector<Shape*> shapes;
+
+    make(shapes, std::integral_constant<int,2>());
+
+    for (size_t r = 0; r < 3; ++r)
+        for (size_t i = 0; i < shapes.size(); ++i)
+            check(shapes[i], std::integral_constant<int,1>());
+
+    for (size_t i = 0; i < shapes.size(); ++i)
+        delete shapes[i];
+}
+
+//------------------------------------------------------------------------------
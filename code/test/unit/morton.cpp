@@ -44,6 +44,7 @@
 
 #include <iostream>
 #include <iomanip>
+#include <random>
 #include "ptrtools.hpp"
 
 template <typename T, size_t N>
@@ -122,6 +123,37 @@ void test4()
     }
 }
 
+/// Compares all the implementations of interleave with my_interleave on random
+/// numbers, whose bits above those interleaved should be ignored. With 
+/// XTL_USE_PDEP the overloads of interleave are the ones based on PDEP.
+void check(size_t samples)
+{
+    using namespace mch;
+
+    std::mt19937 engine(42);
+
+    for (size_t i = 0; i < samples; ++i)
+    {
+        uint32_t x = engine(), y = engine(), z = engine(), w = engine();
+
+        intptr_t v2[2] = { x & 0xFFFF, y & 0xFFFF };
+        intptr_t v3[3] = { x & 0x03FF, y & 0x03FF, z & 0x03FF };
+        intptr_t v4[4] = { x & 0x00FF, y & 0x00FF, z & 0x00FF, w & 0x00FF };
+        intptr_t m2 = my_interleave(v2), m3 = my_interleave(v3), m4 = my_interleave(v4);
+
+        XTL_VERIFY(interleave(x,y)                           == m2);
+        XTL_VERIFY(interleave8x2(v2[0],v2[1])                == m2);
+        XTL_VERIFY(interleave4x2(v2[0],v2[1])                == m2);
+        XTL_VERIFY(interleave(v2)                            == m2);
+        XTL_VERIFY(interleave(x,y,z)                         == m3);
+        XTL_VERIFY(interleave(v3)                            == m3);
+        XTL_VERIFY(interleave(x,y,z,w)                       == m4);
+        XTL_VERIFY(interleave8x4(v4[0],v4[1],v4[2],v4[3])    == m4);
+        XTL_VERIFY(interleave4x4(v4[0],v4[1],v4[2],v4[3])    == m4);
+        XTL_VERIFY(interleave(v4)                            == m4);
+    }
+}
+
 void MortonTable4()
 {
     for (uint32_t i = 0; i < 256; ++i)
@@ -141,4 +173,7 @@ int main()
     //test2();
     //test3();
     //test4();
+
+    check(1000000);
+    std::cout << "PDEP: " << XTL_USE_PDEP << std::endl;
 }
@@ -0,0 +1,135 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Matches expression trees whose operands are never null, as declared with 
+/// #NN, and checks that patterns on the operands give the same results as on
+/// a layout without the declaration, while skipping their null checks.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include "type_switchN-patterns.hpp"
+#include "patterns/all.hpp"
+
+#include <iostream>
+
+//------------------------------------------------------------------------------
+
+struct Expr  { virtual ~Expr() {} };
+struct Value : Expr { Value(int v) : value(v) {} int value; };
+struct Plus  : Expr { Plus(const Expr* a, const Expr* b) : e1(a), e2(b) {} const Expr* e1; const Expr* e2; };
+
+enum { checked = 1 }; // Layout of Plus without the declaration of non-null operands
+
+namespace mch ///< Mach7 library namespace
+{
+template <> struct bindings<Value>          { Members(Value::value); };
+template <> struct bindings<Plus>           { Members(Plus::e1, Plus::e2); NN(0,1); };
+template <> struct bindings<Plus,checked>   { Members(Plus::e1, Plus::e2); };
+} // of namespace mch
+
+typedef mch::view<Plus,checked> checked_plus;
+
+//------------------------------------------------------------------------------
+
+/// Pattern accepting any operand that counts how it was applied
+struct probe
+{
+    template <typename S> struct accepted_type_for { typedef const Expr* type; };
+    bool operator()(const Expr* e) const { ++with_check; return e != 0; }
+    static int with_check;
+    static int without_check;
+};
+
+int probe::with_check    = 0;
+int probe::without_check = 0;
+
+namespace mch ///< Mach7 library namespace
+{
+template <> struct is_pattern_<probe>   { static const bool value = true; };
+template <> struct dereferences_<probe> { static const bool value = true; };
+template <> struct nonnull_application_<probe>
+{
+    static bool apply(const probe&, const Expr* e) { ++probe::without_check; return e != 0; }
+};
+} // of namespace mch
+
+//------------------------------------------------------------------------------
+
+template <typename P>
+int evaluate(const Expr& e)
+{
+    using namespace mch;
+
+    var<int> a, b;
+    var<const Expr*> x, y;
+
+    if (C<P>(&C<Value>(a), &C<Value>(b))(e)) return a + b;
+    if (C<P>(C<Value>(a), _)(e))             return 100 + a;
+    if (C<P>(x, y)(e))                       return 1000 + evaluate<P>(*x.m_value) + evaluate<P>(*y.m_value);
+    if (C<Value>(a)(e))                      return a;
+    return -1;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    Value one(1), two(2), three(3);
+    Plus  p12(&one, &two), p3(&p12, &three), p33(&three, &p3), p(&p33, &p12);
+    const Expr* exprs[] = { &one, &p12, &p3, &p33, &p };
+
+    for (size_t i = 0; i < XTL_ARR_SIZE(exprs); ++i)
+        XTL_VERIFY(evaluate<Plus>(*exprs[i]) == evaluate<checked_plus>(*exprs[i]));
+
+    XTL_VERIFY(evaluate<Plus>(p12) == 3);
+    XTL_VERIFY(evaluate<Plus>(p3)  == 1000 + 3 + 3);
+
+    // Only operands of the layout without the declaration are checked for null
+    mch::C<Plus>(probe(), probe())(p12);
+    XTL_VERIFY(probe::with_check == 0);
+    XTL_VERIFY(probe::without_check == 2);
+    mch::C<checked_plus>(probe(), probe())(p12);
+    XTL_VERIFY(probe::with_check == 2);
+    XTL_VERIFY(probe::without_check == 2);
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,151 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Decomposes wire-format record headers with offset-based bindings (#CMO) 
+/// under two layouts and checks that matching gives the same results as with
+/// bindings through pointers to members and accessor functions (#CM).
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include "type_switchN-patterns.hpp"
+#include "patterns/all.hpp"
+
+#include <cstdint>
+#include <iostream>
+
+//------------------------------------------------------------------------------
+
+/// Header of a record as it arrives from the wire
+struct Header
+{
+    uint8_t  kind;
+    uint8_t  flags;
+    uint16_t length;
+    uint32_t sequence;
+};
+
+inline const uint16_t& header_length(const Header& h) { return h.length; }
+
+// Layouts: by offsets (default), only flags and sequence by offsets, and the 
+// same as the default one through pointers to members and accessor functions
+enum { offsets = mch::default_layout, control = 1, accessors = 2 };
+
+namespace mch ///< Mach7 library namespace
+{
+template <> struct bindings<Header, offsets>   { CMO(0,Header,kind); CMO(1,Header,flags); CMO(2,Header,length); CMO(3,Header,sequence); };
+template <> struct bindings<Header, control>   { CMO(0,Header,flags); CMO(1,Header,sequence); };
+template <> struct bindings<Header, accessors> { Members(Header::kind, Header::flags, header_length, Header::sequence); };
+} // of namespace mch
+
+typedef mch::view<Header,control>   control_view;
+typedef mch::view<Header,accessors> accessor_view;
+
+//------------------------------------------------------------------------------
+
+int classify(const Header& h)
+{
+    using namespace mch;
+
+    var<uint16_t> n;
+    var<uint32_t> s;
+
+    Match(h)
+    {
+        Case(C<control_view>(0, 0))                    return 0;       // Keep-alive
+        Case(C<Header>(1, _, n |= n <= 64, _))         return 100 + n; // Short data
+        Case(C<Header>(1, _, n, s))                    return 200 + (n + s) % 7;
+        Case(C<control_view>(_, s |= s > 1000))        return 300;     // Late record of another kind
+        Case(C<Header>(_, _, _, _))                    return 400;
+    }
+    EndMatch
+
+    return -1;
+}
+
+int classify_with_accessors(const Header& h)
+{
+    using namespace mch;
+
+    var<uint16_t> n;
+    var<uint32_t> s;
+    var<uint8_t>  f;
+
+    Match(h)
+    {
+        Case(C<accessor_view>(_, f |= f == 0, _, s |= s == 0)) return 0;
+        Case(C<accessor_view>(1, _, n |= n <= 64, _))          return 100 + n;
+        Case(C<accessor_view>(1, _, n, s))                     return 200 + (n + s) % 7;
+        Case(C<accessor_view>(_, _, _, s |= s > 1000))         return 300;
+        Case(C<accessor_view>(_, _, _, _))                     return 400;
+    }
+    EndMatch
+
+    return -1;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    Header records[] = {
+        {0, 0,    0,    0},
+        {1, 0,   12,    1},
+        {1, 3, 1500,   17},
+        {2, 1,   40, 2000},
+        {3, 0,    0,    5},
+        {0, 0,    7,    0},
+    };
+
+    const int expected[] = { 0, 112, 200 + (1500 + 17) % 7, 300, 400, 0 };
+
+    for (size_t i = 0; i < XTL_ARR_SIZE(records); ++i)
+    {
+        XTL_VERIFY(classify(records[i]) == expected[i]);
+        XTL_VERIFY(classify_with_accessors(records[i]) == expected[i]);
+    }
+
+    // Offset-based members are bound by reference into the record itself
+    const uint16_t& length = mch::apply_member(&records[2], mch::bindings<Header>::member2());
+    XTL_VERIFY(&length == &records[2].length);
+}
+
+//------------------------------------------------------------------------------
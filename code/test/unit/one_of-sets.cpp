@@ -0,0 +1,103 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks one-of patterns with values known at run time and at compile time, 
+/// for sets that are looked up linearly, with a bitset and with binary search.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <iostream>
+#include "match.hpp"                // Support for Match statement
+#include "patterns/any.hpp"         // Support for one-of patterns
+#include "patterns/primitive.hpp"   // Support for primitive patterns
+
+//------------------------------------------------------------------------------
+
+/// Checks that pattern p matches exactly the values in [first,last) among [lo,hi]
+template <typename P, typename T>
+void check(const P& p, const T* first, const T* last, T lo, T hi)
+{
+    for (T v = lo; v <= hi; ++v)
+        XTL_VERIFY(p(v) == (std::find(first, last, v) != last));
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    using namespace mch;
+
+    static_assert(one_of_c<int,1,5,7>::lookup == one_of_linear, "Small sets should be scanned");
+    static_assert(one_of_c<int,-300,-3,0,2,7,100,400,500,511>::lookup == one_of_bitset, "Sets in small range should use bitset");
+    static_assert(one_of_c<long,-100000,3,5,8,13,21,34,55,89,100000>::lookup == one_of_sorted, "Sparse sets should be sorted");
+
+    const int  small[]  = {1,5,7};
+    const int  dense[]  = {-300,-3,0,2,7,100,400,500,511};
+    const long sparse[] = {-100000,3,5,8,13,21,34,55,89,100000};
+
+    check(any<int,1,5,7>(),                          small,  small+3,  -10, 10);
+    check(any<int,-300,-3,0,2,7,100,400,500,511>(),  dense,  dense+9,  -1000, 1000);
+    check(any<long,-100000,3,5,8,13,21,34,55,89,100000>(), sparse, sparse+10, -200000L, 200000L);
+
+    // The list is copied, so the pattern can outlive the full expression
+    auto p = any({100000,3,2,1});
+    const int copied[] = {100000,3,2,1};
+    check(p, copied, copied+4, -10, 10);
+    check(p, copied, copied+4, 99990, 100010);
+
+    // Inside Match
+    for (int i = 0; i < 20; ++i)
+    {
+        int kind = 0;
+
+        Match(i)
+        {
+            With(any({0,2,4,6,8}))                      kind = 1; break;
+            With(any<int,1,3,5,7,9,11,13,15,17,19>())  kind = 2; break;
+        }
+        EndMatch
+
+        XTL_VERIFY(kind == (i < 10 && i % 2 == 0 ? 1 : i % 2 == 1 ? 2 : 0));
+    }
+}
+
+//------------------------------------------------------------------------------
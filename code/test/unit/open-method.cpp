@@ -0,0 +1,137 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that open multi-methods dispatch to the most specific overrider, 
+/// adjust arguments to subobjects of multiple inheritance, report ambiguous
+/// and unhandled combinations with the value-initialized result and pick up 
+/// overriders defined after calls.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include "open_method.hpp"
+#include <iostream>
+
+//------------------------------------------------------------------------------
+
+struct Shape                   { virtual ~Shape() {} };
+struct Named                   { virtual ~Named() {} int tag = 7; };
+struct Circle   : Shape        { int r = 1; };
+struct Square   : Named, Shape { int s = 2; }; // Shape subobject is not first
+struct Cube     : Square       {};
+struct Triangle : Shape        {};
+
+//------------------------------------------------------------------------------
+
+/// The method, declared as local static so that overriders can be defined 
+/// during static initialization in any order
+mch::open_method<int(const Shape&, const Shape&)>& collide()
+{
+    static mch::open_method<int(const Shape&, const Shape&)> method;
+    return method;
+}
+
+// Overriders as another translation unit would define them
+
+int collide_ss(const Shape&,  const Shape&)   { return 1; }
+int collide_cs(const Circle&  c, const Shape&)  { return 10 + c.r; }
+int collide_sq(const Shape&,  const Square& q){ return 20 + q.s + q.tag; }
+int collide_qq(const Square& a, const Square& b) { return 30 + a.s + b.s; }
+int collide_ct(const Circle&, const Triangle&) { return 40; }
+int collide_tc(const Triangle&, const Circle&) { return 50; }
+
+static bool r1 = collide().define(&collide_ss);
+static bool r2 = collide().define(&collide_cs);
+static bool r3 = collide().define(&collide_sq);
+static bool r4 = collide().define(&collide_qq);
+static bool r5 = collide().define(&collide_ct);
+
+//------------------------------------------------------------------------------
+
+/// Method on mutable arguments without a fallback for everything
+mch::open_method<int(Shape&)>& grow()
+{
+    static mch::open_method<int(Shape&)> method;
+    return method;
+}
+
+int grow_circle(Circle& c) { return c.r += 1; }
+int grow_square(Square& q) { return q.s *= 2; }
+
+static bool r6 = grow().define(&grow_circle);
+static bool r7 = grow().define(&grow_square);
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    Shape    x;
+    Circle   c;
+    Square   q;
+    Cube     k;
+    Triangle t;
+
+    for (int i = 0; i < 2; ++i) // Second time all come from the vtbl map
+    {
+        XTL_VERIFY(collide()(x, x) == 1);
+        XTL_VERIFY(collide()(c, x) == 11);
+        XTL_VERIFY(collide()(x, q) == 29);
+        XTL_VERIFY(collide()(q, k) == 34);
+        XTL_VERIFY(collide()(k, k) == 34);
+        XTL_VERIFY(collide()(c, t) == 40);
+        XTL_VERIFY(collide()(t, c) == 1);
+        XTL_VERIFY(collide()(c, q) == 0);  // Ambiguous between collide_cs and collide_sq
+    }
+
+    collide().define(&collide_tc);      // Defined after calls
+    XTL_VERIFY(collide()(t, c) == 50);
+    XTL_VERIFY(collide()(c, t) == 40);
+    XTL_VERIFY(collide().size() == 6);
+
+    XTL_VERIFY(grow()(c) == 2);
+    XTL_VERIFY(grow()(c) == 3);
+    XTL_VERIFY(c.r == 3);
+    XTL_VERIFY(grow()(k) == 4);
+    XTL_VERIFY(k.s == 4);
+    XTL_VERIFY(grow()(t) == 0);           // No overrider applies
+}
+
+//------------------------------------------------------------------------------
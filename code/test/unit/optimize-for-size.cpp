@@ -0,0 +1,149 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that Match statements on one and two subjects work when they are
+/// compiled for size, with the handling of misses in their vtbl maps and the
+/// dynamic casts in their clauses outlined.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_OPTIMIZE_FOR_SIZE 1    // Outline the slow path of Match statements
+
+#include <iostream>
+#include <vector>
+#include "type_switchN-patterns.hpp"
+#include "patterns/primitive.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Shape            { virtual ~Shape() {} };
+struct Circle : Shape   {};
+struct Square : Shape   {};
+
+/// A family of otherwise unrelated classes to make the vtbl maps grow
+template <int I> struct Other : Shape {};
+
+template <int I> void make_others(std::vector<Shape*>& shapes) { make_others<I-1>(shapes); shapes.push_back(new Other<I>); }
+template <>      void make_others<0>(std::vector<Shape*>& shapes) { shapes.push_back(new Other<0>); }
+
+//------------------------------------------------------------------------------
+
+int expected(const Shape* a)
+{
+    if (dynamic_cast<const Circle*>(a)) return 1;
+    if (dynamic_cast<const Square*>(a)) return 2;
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+int match1(const Shape* a)
+{
+    mch::var<const Circle&> c;
+    mch::var<const Square&> s;
+    mch::var<const Shape&>  x;          // Upcast, which stays in place
+
+    Match(a)
+    {
+    Case(c)     return 1;
+    Case(s)     return 2;
+    Case(x)     return 0;
+    }
+    EndMatch
+
+    return -1;
+}
+
+//------------------------------------------------------------------------------
+
+int match2(const Shape* a, const Shape* b)
+{
+    mch::var<const Circle&> c1, c2;
+    mch::var<const Square&> s1, s2;
+    mch::var<const Shape&>  x;
+
+    Match(a,b)
+    {
+    Case(c1,c2) return 3;
+    Case(c1,s2) return 4;
+    Case(s1,c2) return 5;
+    Case(s1,s2) return 6;
+    Case(c1,x)  return 3;
+    Case(s1,x)  return 6;
+    Otherwise() return 0;
+    }
+    EndMatch
+
+    return -1;
+}
+
+/// Mirrors the clauses of match2 with dynamic casts
+int expected(const Shape* a, const Shape* b)
+{
+    const int ea = expected(a), eb = expected(b);
+    return ea == 0 ? 0 : eb == 0 ? 3*ea : 2*ea + eb;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    std::vector<Shape*> shapes;
+
+    shapes.push_back(new Circle);
+    shapes.push_back(new Square);
+    make_others<40>(shapes);
+
+    for (size_t r = 0; r < 3; ++r)
+        for (size_t i = 0; i < shapes.size(); ++i)
+        {
+            XTL_VERIFY(match1(shapes[i]) == expected(shapes[i]));
+
+            for (size_t j = 0; j < shapes.size(); ++j)
+                XTL_VERIFY(match2(shapes[i],shapes[j]) == expected(shapes[i],shapes[j]));
+        }
+
+    for (size_t i = 0; i < shapes.size(); ++i)
+        delete shapes[i];
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,126 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that with XTL_OVERHEAD_ACCOUNTING the allocations and dynamic_casts
+/// of Match statements and memoized_cast are counted while they warm up, and 
+/// that none are made once they have seen all the classes.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_OVERHEAD_ACCOUNTING 1
+#define XTL_USE_MEMOIZED_CAST   1 // Casts to Extra below are memoized, Match statements make them
+
+#include <iostream>
+#include "match.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Shape                   { virtual ~Shape() {} };
+struct Extra                   { virtual ~Extra() {} };
+struct Circle   : Shape        {};
+struct Square   : Shape        {};
+struct Triangle : Shape, Extra {};
+
+//------------------------------------------------------------------------------
+
+int classify(const Shape& s)
+{
+    Match(s)
+    {
+        Case(Circle)   return 1;
+        Case(Square)   return 2;
+        Case(Triangle) return 3;
+    }
+    EndMatch
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+/// Runs the workload and checks its results
+void run(const Shape* const* shapes, const int* expected, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        XTL_VERIFY(classify(*shapes[i]) == expected[i]);
+        XTL_VERIFY(memoized_cast<const Extra*>(shapes[i]) == dynamic_cast<const Extra*>(shapes[i]));
+    }
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    Circle   c;
+    Square   s;
+    Triangle t;
+    Shape    x;
+
+    const Shape* shapes[]   = { &c, &s, &t, &x, &t, &s, &c, &x };
+    const int    expected[] = {  1,  2,  3,  0,  3,  2,  1,  0 };
+    const size_t n = sizeof(shapes)/sizeof(shapes[0]);
+
+    mch::overhead_snapshot start = mch::overhead_report();
+    run(shapes, expected, n);
+    mch::overhead_snapshot warm  = mch::overhead_report();
+
+    for (size_t r = 0; r < 100; ++r)
+        run(shapes, expected, n);
+
+    mch::overhead_snapshot warmup = warm - start;
+    mch::overhead_snapshot steady = mch::overhead_report() - warm;
+
+    std::cout << "Warm-up: " << warmup << std::endl
+              << "Steady:  " << steady << std::endl;
+
+    XTL_VERIFY(warmup.dynamic_casts != 0);   // Each class was cast at least once
+    XTL_VERIFY(mch::overhead_report().allocations != 0); // Maps and offsets were allocated at some point
+
+    XTL_VERIFY(steady.allocations     == 0); // Nothing is allocated once all classes were seen
+    XTL_VERIFY(steady.allocated_bytes == 0);
+    XTL_VERIFY(steady.dynamic_casts   == 0); // ... nor cast
+    XTL_VERIFY(steady.vtbl_updates    == 0);
+    XTL_VERIFY(steady.regex_compiles  == 0);
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,126 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks the size of vtbl map entries with packed type_switch_info 
+/// (\see #XTL_PACKED_SWITCH_INFO) and that Match statements still adjust 
+/// subjects by the this-pointer offsets stored in them, negative ones included.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_PACKED_SWITCH_INFO 1 // Case labels and offsets in 32 bits
+
+#include <iostream>
+#include "type_switchN-patterns.hpp"
+#include "patterns/constructor.hpp"
+#include "patterns/primitive.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Shape                        { virtual ~Shape() {} };
+struct Named                        { virtual ~Named() {} char name[100]; };
+struct Circle : Named, Shape        { Circle() : radius(1) {} int radius; };
+struct Square : Named, Shape        { Square() : side(2)   {} int side;   };
+struct Cube   : Named, Square       { Cube()   : depth(3)  {} int depth;  };
+
+//------------------------------------------------------------------------------
+
+/// Reads a member of the derived class, so a wrong offset gives a wrong value
+int measure(const Shape* a)
+{
+    Match(a)
+    {
+    Case(mch::C<Circle>()) return match0.radius;
+    Case(mch::C<Cube>())   return match0.depth*10 + match0.side;
+    Case(mch::C<Square>()) return match0.side;
+    }
+    EndMatch
+
+    return 0;
+}
+
+int measure2(const Shape* a, const Shape* b)
+{
+    Match(a,b)
+    {
+    Case(mch::C<Circle>(),mch::C<Square>()) return match0.radius*100 + match1.side;
+    Case(mch::C<Square>(),mch::C<Circle>()) return match0.side*100 + match1.radius;
+    }
+    EndMatch
+
+    return measure(a)*100 + measure(b);
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    Shape  x;
+    Circle c;
+    Square s;
+    Cube   q;
+
+    const Shape* shapes[] = {&x, &c, &s, &q};
+    const int    measures[] = {0, 1, 2, 32};
+    const int    measures2[][4] = {
+        {  0,   1,   2,  32},
+        {100, 101, 102, 102}, // A Cube is taken as a Square with side 2
+        {200, 201, 202, 232},
+        {3200,201,3202,3232}
+    };
+
+#if !XTL_USE_COMPUTED_GOTO
+    // A key of one subject and two 32-bit fields share 16 bytes
+    if (sizeof(void*) == 8)
+        XTL_VERIFY(sizeof(mch::stored_type_for<1,mch::type_switch_info<1>>) == 16);
+#endif
+
+    for (size_t r = 0; r < 2; ++r)
+        for (size_t i = 0; i < XTL_ARR_SIZE(shapes); ++i)
+        {
+            XTL_VERIFY(measure(shapes[i]) == measures[i]);
+
+            for (size_t j = 0; j < XTL_ARR_SIZE(shapes); ++j)
+                XTL_VERIFY(measure2(shapes[i], shapes[j]) == measures2[i][j]);
+        }
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,138 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that mch::parallel_match reduces the same results as a sequential
+/// loop of mch::match over ranges of pointers and of objects, whatever the
+/// number of threads, and that it rethrows exceptions thrown by clauses.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_MULTI_THREADING 1 // Use multi-threaded vtbl_map in Match statements
+
+#include "parallel_match.hpp"
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+//------------------------------------------------------------------------------
+
+struct Shape            { virtual ~Shape() {} };
+struct Circle : Shape   { explicit Circle(size_t r) : r(r) {} size_t r; };
+struct Square : Shape   { explicit Square(size_t s) : s(s) {} size_t s; };
+struct Cube   : Square  { explicit Cube  (size_t s) : Square(s) {} };
+struct Other  : Shape   {};
+
+//------------------------------------------------------------------------------
+
+size_t area(const Shape& s)
+{
+    return mch::match(s,
+        mch::case_<Circle>([](const Circle& c) { return 3*c.r*c.r; }),
+        mch::case_<Cube>  ([](const Cube&   k) { return 6*k.s*k.s; }),
+        mch::case_<Square>([](const Square& q) { return q.s*q.s; }),
+        mch::otherwise    ([](const Shape&)    { return size_t(1); }));
+}
+
+size_t parallel_area(const std::vector<Shape*>& shapes)
+{
+    return mch::parallel_match(shapes, size_t(0), std::plus<size_t>(),
+        mch::case_<Circle>([](const Circle& c) { return 3*c.r*c.r; }),
+        mch::case_<Cube>  ([](const Cube&   k) { return 6*k.s*k.s; }),
+        mch::case_<Square>([](const Square& q) { return q.s*q.s; }),
+        mch::otherwise    ([](const Shape&)    { return size_t(1); }));
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    std::mt19937 engine(7);
+    std::vector<std::unique_ptr<Shape>> owner;
+    std::vector<Shape*> shapes;
+
+    for (size_t i = 0; i < 100000; ++i)
+    {
+        switch (engine() % 4)
+        {
+        case 0: owner.emplace_back(new Circle(i % 100)); break;
+        case 1: owner.emplace_back(new Square(i % 100)); break;
+        case 2: owner.emplace_back(new Cube  (i % 100)); break;
+        case 3: owner.emplace_back(new Other);           break;
+        }
+
+        shapes.push_back(owner.back().get());
+    }
+
+    size_t expected = 0;
+
+    for (Shape* p : shapes)
+        expected += area(*p);
+
+    for (size_t threads = 1; threads <= 8; threads *= 2)
+    {
+        mch::parallel_match_threads() = threads;
+        XTL_VERIFY(parallel_area(shapes) == expected);
+        XTL_VERIFY(parallel_area(std::vector<Shape*>(shapes.begin(), shapes.begin()+3)) == area(*shapes[0]) + area(*shapes[1]) + area(*shapes[2]));
+        XTL_VERIFY(parallel_area(std::vector<Shape*>()) == 0);
+    }
+
+    // Elements that are subjects themselves
+    std::vector<Circle> circles(1000, Circle(2));
+    XTL_VERIFY(mch::parallel_match(circles, size_t(0), std::plus<size_t>(), mch::case_<Circle>([](const Circle& c) { return c.r; })) == 2000);
+
+    // The first exception thrown by a clause is rethrown
+    try
+    {
+        mch::parallel_match(shapes, size_t(0), std::plus<size_t>(),
+            mch::case_<Other>([](const Other&) -> size_t { throw std::runtime_error("other"); }),
+            mch::otherwise   ([](const Shape&) { return size_t(0); }));
+        XTL_VERIFY(!"The exception was not rethrown");
+    }
+    catch (const std::runtime_error&)
+    {
+    }
+}
+
+//------------------------------------------------------------------------------
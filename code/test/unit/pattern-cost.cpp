@@ -0,0 +1,100 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that with XTL_REORDER_BY_COST conjunction and disjunction patterns 
+/// try cheaper operands first, but never before patterns whose variables they
+/// might use.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_REORDER_BY_COST 1
+
+#include <iostream>
+#include "patterns/combinators.hpp" // Support for pattern combinators
+#include "patterns/guard.hpp"       // Support for guard patterns
+#include "patterns/n+k.hpp"         // Support for n+k patterns
+
+//------------------------------------------------------------------------------
+
+/// A pattern that pretends to be expensive and counts how many times it was tried
+struct expensive
+{
+    template <typename S> struct accepted_type_for { typedef S type; };
+    template <typename T> bool operator()(const T& t) const { ++tries; return t % 2 == 0; }
+    static size_t tries;
+};
+
+size_t expensive::tries = 0;
+
+namespace mch ///< Mach7 library namespace
+{
+template <> struct is_pattern_<expensive>   { static const bool value = true; };
+template <> struct pattern_cost_<expensive> { static const unsigned int value = cost_of_regex; };
+} // of namespace mch
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    using namespace mch;
+
+    // The value is tried first, so expensive is not tried on 3 
+    XTL_VERIFY((expensive() && 4)(4));
+    XTL_VERIFY(!(expensive() && 4)(3));
+    XTL_VERIFY(expensive::tries == 1);
+
+    // The value is tried first, so expensive is not tried on 4
+    expensive::tries = 0;
+    XTL_VERIFY((expensive() || 4)(4));
+    XTL_VERIFY((expensive() || 4)(6));
+    XTL_VERIFY(!(expensive() || 4)(5));
+    XTL_VERIFY(expensive::tries == 2);
+
+    // Variable binds before the guard that uses it regardless of the order
+    var<int> x, y;
+    XTL_VERIFY((expensive() && x && (y |= y == x))(8));
+    XTL_VERIFY(!(expensive() && x && (y |= y > x))(8));
+    XTL_VERIFY(((y |= y > 10) && x)(12));
+    XTL_VERIFY(int(x) == 12);
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,132 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that mch::poly_collection keeps objects in segments of their dynamic
+/// types and that its for_each calls the clause selected for each segment on
+/// all of its objects, including those whose base class or target of the 
+/// clause is at a non-zero offset.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <iostream>
+#include <string>
+#include "poly_collection.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Tagged                     { virtual ~Tagged() {} int tag = 7; };
+struct Shape                      { virtual ~Shape() {} };
+struct Circle   : Shape           { Circle(int r) : r(r) {} int r; };
+struct Square   : Shape           { Square(int s) : s(s) {} int s; };
+struct Label    : Tagged, Shape   { Label(std::string t) : text(t) {} std::string text; }; // Shape at a non-zero offset
+struct Ring     : Circle          { Ring(int r, int w) : Circle(r), w(w) {} int w; };
+struct Blank    : Shape           {};
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    mch::poly_collection<Shape> shapes;
+
+    shapes.insert(Circle(1));
+    shapes.emplace<Square>(2);
+    shapes.insert(Label("ab"));
+    shapes.insert(Circle(3));
+    shapes.emplace<Ring>(5, 1);
+    shapes.emplace<Blank>();
+    shapes.emplace<Square>(4);
+    shapes.insert(Label("cde"));
+
+    XTL_VERIFY(shapes.size() == 8);
+    XTL_VERIFY(shapes.segments() == 5);
+    XTL_VERIFY(shapes.count<Circle>() == 2);
+    XTL_VERIFY(shapes.count<Ring>() == 1);
+    XTL_VERIFY(shapes.count<Label>() == 2);
+    XTL_VERIFY(shapes.count<Shape>() == 0);
+
+    std::string order;
+    int radii = 0, sides = 0, tags = 0, chars = 0, others = 0;
+
+    shapes.for_each(
+        mch::case_<Square>([&](const Square& q) { sides += q.s; order += 's'; }),
+        mch::case_<Circle>([&](const Circle& c) { radii += c.r; order += 'c'; }), // Also Ring
+        mch::case_<Tagged>([&](const Tagged& t) { tags  += t.tag; order += 't'; }), // Cross-cast from Shape
+        mch::otherwise    ([&](const Shape&)    { ++others; order += 'o'; }));
+
+    XTL_VERIFY(order == "ccssttco"); // Segments in the order of creation
+    XTL_VERIFY(radii == 9);
+    XTL_VERIFY(sides == 6);
+    XTL_VERIFY(tags == 14);
+    XTL_VERIFY(others == 1);
+
+    // Segments nothing applies to are skipped
+    order.clear();
+    shapes.for_each(
+        mch::case_<Label>([&](const Label& l) { chars += int(l.text.size()); order += 'l'; }),
+        mch::case_<Ring> ([&](const Ring&   r) { radii += r.w;               order += 'r'; }));
+
+    XTL_VERIFY(order == "llr");
+    XTL_VERIFY(chars == 5);
+    XTL_VERIFY(radii == 10);
+
+    // Objects of the same class added later join their segment
+    shapes.emplace<Circle>(7);
+    radii = 0;
+    shapes.for_each(mch::case_<Circle>([&](const Circle& c) { radii += c.r; }));
+
+    XTL_VERIFY(radii == 16);
+    XTL_VERIFY(shapes.segments() == 5);
+
+    mch::poly_collection<Shape> moved(std::move(shapes));
+    XTL_VERIFY(moved.size() == 9);
+    XTL_VERIFY(shapes.empty());
+
+    moved.clear();
+    others = 0;
+    moved.for_each(mch::otherwise([&](const Shape&) { ++others; }));
+
+    XTL_VERIFY(moved.empty());
+    XTL_VERIFY(others == 0);
+    XTL_VERIFY(moved.segments() == 5);
+}
+
+//------------------------------------------------------------------------------
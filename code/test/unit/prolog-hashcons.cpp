@@ -0,0 +1,147 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Unifies the terms of prolog.cpp represented with hash-consed immutable 
+/// terms of prolog-terms.hpp and checks the unifiers, as well as that repeated 
+/// unifications find all the terms they build already in the table.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include "prolog-terms.hpp"
+#include <iostream>
+#include <sstream>
+
+//------------------------------------------------------------------------------
+
+term_table table; ///< All the terms of this example
+
+inline const Atom*      A(const char* v) { return table.atom(v); }
+inline const Integer*   I(int v)         { return table.integer(v); }
+inline const Variable*  V(const char* n) { return table.variable(n); }
+inline const Structure* S(const char* n, std::initializer_list<const Term*> args) { return table.structure(n, args); }
+
+//------------------------------------------------------------------------------
+
+/// Unifies two terms and returns their unifier as text with one binding per 
+/// variable in the order of names, or ERROR when there is no unifier
+std::string unify(const Term* t1, const Term* t2)
+{
+    substitution_map         s;
+    std::vector<std::string> bindings;
+    std::string              result;
+
+    if (unify(t1, t2, s))
+    {
+        for (substitution_map::const_iterator p = s.begin(); p != s.end(); ++p)
+        {
+            std::stringstream ss;
+            ss << p->first->name << "->" << *apply(p->first, s, table);
+            bindings.push_back(ss.str());
+        }
+
+        std::sort(bindings.begin(), bindings.end());
+
+        for (size_t i = 0; i < bindings.size(); ++i)
+            result += (i ? " " : "") + bindings[i];
+    }
+    else
+        result = "ERROR";
+
+    std::cout << "Unifying " << *t1 << " and " << *t2 << ": " << result << std::endl;
+    return result;
+}
+
+//------------------------------------------------------------------------------
+
+/// Unifies the examples of prolog.cpp and checks their unifiers
+void unify_examples()
+{
+    XTL_VERIFY(unify(S("f",{A("a"),  V("X"), S("g",{A("y"),V("Y")})}),
+                     S("f",{V("Y"),  A("b"), V("Z")}))
+               == "X->b Y->a Z->g(y,a)");
+
+    // Unify f(X, Y, g(Z)) and f(X, g(h(Z)), Y)
+    XTL_VERIFY(unify(S("f",{V("X"), V("Y"), S("g",{V("Z")})}),
+                     S("f",{V("X"), S("g",{S("h",{V("Z")})}), V("Y")}))
+               == "ERROR");
+
+    // Unify p(f(a); g(x)) and p(y; y)
+    XTL_VERIFY(unify(S("p",{S("f",{V("A")}), S("g",{V("X")})}),
+                     S("p",{V("Y"), V("Y")}))
+               == "ERROR");
+
+    // Unify p(a; x; h(g(z))) and p(z; h(y); h(y))
+    XTL_VERIFY(unify(S("p",{A("a"), V("X"), S("h",{S("g",{V("Z")})})}),
+                     S("p",{V("Z"), S("h",{V("Y")}), S("h",{V("Y")})}))
+               == "X->h(g(a)) Y->g(a) Z->a");
+
+    // Unify E = f(x; b; g(z)); and F = f(f(y); y; g(u)):
+    XTL_VERIFY(unify(S("f",{V("X"), A("b"), S("g",{V("Z")})}),
+                     S("f",{S("f",{V("Y")}), V("Y"), S("g",{V("U")})}))
+               == "X->f(b) Y->b Z->U");
+
+    // Unify p(x; x) and p(y; f(y)).
+    XTL_VERIFY(unify(S("p",{V("X"), V("Y")}),
+                     S("p",{V("X"), S("f",{V("Y")})}))
+               == "ERROR");
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    // Structurally equal terms are the same object
+    XTL_VERIFY(S("f",{A("a"), I(42), V("X")}) == S("f",{A("a"), I(42), V("X")}));
+    XTL_VERIFY(S("f",{A("a")}) != S("f",{A("b")}));
+    XTL_VERIFY(S("f",{A("a")}) != S("g",{A("a")}));
+    XTL_VERIFY(S("f",{A("a")}) != static_cast<const Term*>(A("a")));
+    XTL_VERIFY(I(1) != I(2));
+
+    unify_examples();
+
+    // The second time around, every term, including unifiers, exists already
+    size_t terms = table.size();
+    unify_examples();
+    XTL_VERIFY(table.size() == terms);
+}
+
+//------------------------------------------------------------------------------
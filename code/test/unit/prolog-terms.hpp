@@ -0,0 +1,292 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Immutable Prolog terms, which are hash-consed: a term_table creates every
+/// distinct term only once, so that structurally equal terms are the same 
+/// object and their comparison is a comparison of pointers. Terms live in an 
+/// arena of the table, which keeps terms built together next to each other.
+/// Unification of such terms with Match spends its time on dispatch rather than
+/// on allocating and comparing terms.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#pragma once
+
+#include "arena.hpp"
+#include "type_switchN-patterns.hpp"
+#include "patterns/constructor.hpp"
+#include "patterns/primitive.hpp"
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+//------------------------------------------------------------------------------
+
+/// Terms can only be created by term_table, \see prolog.cpp for the meaning
+/// of each kind of terms
+struct Term
+{
+    virtual ~Term() {}
+};
+
+struct Atom : Term
+{
+    explicit Atom(const std::string& s) : value(s) {}
+    const std::string value;
+};
+
+struct Integer : Term
+{
+    explicit Integer(int v) : value(v) {}
+    const int value;
+};
+
+struct Variable : Term
+{
+    explicit Variable(const std::string& n) : name(n) {}
+    const std::string name;
+};
+
+/// Arguments of a structure are hash-consed terms themselves, so two 
+/// structures are equal when they have the same functor and the same 
+/// pointers for arguments.
+struct Structure : Term
+{
+    Structure(const Atom* f, const std::vector<const Term*>& a) : functor(f), terms(a) {}
+    size_t arity() const { return terms.size(); }
+    const Atom*                    const functor;
+    const std::vector<const Term*>       terms;
+};
+
+//------------------------------------------------------------------------------
+
+/// Owner of all the terms created through it, which returns the same object
+/// for structurally equal terms.
+class term_table
+{
+public:
+
+    const Atom* atom(const std::string& s)
+    {
+        const Atom*& t = m_atoms[s];
+        return t ? t : t = m_terms.make<Atom>(s);
+    }
+
+    const Integer* integer(int v)
+    {
+        const Integer*& t = m_integers[v];
+        return t ? t : t = m_terms.make<Integer>(v);
+    }
+
+    const Variable* variable(const std::string& n)
+    {
+        const Variable*& t = m_variables[n];
+        return t ? t : t = m_terms.make<Variable>(n);
+    }
+
+    const Structure* structure(const Atom* f, const std::vector<const Term*>& args)
+    {
+        Structure key(f, args); // Not in the arena as it is likely to exist already
+        structure_set::const_iterator p = m_structures.find(&key);
+        return p != m_structures.end() ? *p : *m_structures.insert(m_terms.make<Structure>(f, args)).first;
+    }
+
+    const Structure* structure(const std::string& f, std::initializer_list<const Term*> args)
+    {
+        return structure(atom(f), std::vector<const Term*>(args));
+    }
+
+    /// Number of distinct terms created so far
+    size_t size() const { return m_terms.size(); }
+
+private:
+
+    struct structure_hash
+    {
+        size_t operator()(const Structure* s) const
+        {
+            std::hash<const void*> h;
+            size_t result = h(s->functor);
+
+            for (size_t i = 0; i < s->terms.size(); ++i)
+                result = result * 31 + h(s->terms[i]);
+
+            return result;
+        }
+    };
+
+    struct structure_equal
+    {
+        bool operator()(const Structure* a, const Structure* b) const { return a->functor == b->functor && a->terms == b->terms; }
+    };
+
+    typedef std::unordered_set<const Structure*, structure_hash, structure_equal> structure_set;
+
+    mch::arena<Term>                                 m_terms;
+    std::unordered_map<std::string, const Atom*>     m_atoms;
+    std::unordered_map<int,         const Integer*>  m_integers;
+    std::unordered_map<std::string, const Variable*> m_variables;
+    structure_set                                    m_structures;
+};
+
+//------------------------------------------------------------------------------
+
+namespace mch ///< Mach7 library namespace
+{
+template <> struct bindings<Atom>      { Members(Atom::value);     };
+template <> struct bindings<Integer>   { Members(Integer::value);  };
+template <> struct bindings<Variable>  { Members(Variable::name);  };
+template <> struct bindings<Structure> { Members(Structure::functor, Structure::arity, Structure::terms); };
+} // of namespace mch
+
+//------------------------------------------------------------------------------
+
+inline std::ostream& operator<<(std::ostream& os, const Term& t)
+{
+    Match(t)
+    {
+    Case(mch::C<Atom>())     return os << match0.value;
+    Case(mch::C<Integer>())  return os << match0.value;
+    Case(mch::C<Variable>()) return os << match0.name;
+    Case(mch::C<Structure>())
+        os << match0.functor->value << '(';
+        for (size_t i = 0; i < match0.terms.size(); ++i)
+            os << (i ? "," : "") << *match0.terms[i];
+        return os << ')';
+    }
+    EndMatch
+
+    return os << "???";
+}
+
+//------------------------------------------------------------------------------
+
+/// Bindings of variables made by unification, in which bound terms may still 
+/// refer to other bound variables
+typedef std::unordered_map<const Variable*, const Term*> substitution_map;
+
+/// Follows bindings of a variable until reaching a term that is not a bound variable
+inline const Term* resolve(const Term* t, const substitution_map& s)
+{
+    for (substitution_map::const_iterator p; (p = s.find(dynamic_cast<const Variable*>(t))) != s.end(); )
+        t = p->second;
+
+    return t;
+}
+
+/// Whether variable v occurs in term t under substitution s
+inline bool occurs(const Variable* v, const Term* t, const substitution_map& s)
+{
+    t = resolve(t, s);
+
+    if (t == v)
+        return true;
+
+    Match(*t)
+    {
+    Case(mch::C<Structure>())
+        for (size_t i = 0; i < match0.terms.size(); ++i)
+            if (occurs(v, match0.terms[i], s))
+                return true;
+    }
+    EndMatch
+
+    return false;
+}
+
+/// Extends substitution s to make terms a and b equal, if possible
+inline bool unify(const Term* a, const Term* b, substitution_map& s)
+{
+    a = resolve(a, s);
+    b = resolve(b, s);
+
+    if (a == b) // Equal terms are the same object
+        return true;
+
+    mch::wildcard _;
+
+    Match(*a, *b)
+    {
+    Case(mch::C<Variable>(), _) return !occurs(&match0, b, s) && s.insert(substitution_map::value_type(&match0, b)).second;
+    Case(_, mch::C<Variable>()) return !occurs(&match1, a, s) && s.insert(substitution_map::value_type(&match1, a)).second;
+    Case(mch::C<Structure>(), mch::C<Structure>())
+        if (match0.functor != match1.functor || match0.arity() != match1.arity())
+            return false;
+
+        for (size_t i = 0; i < match0.arity(); ++i)
+            if (!unify(match0.terms[i], match1.terms[i], s))
+                return false;
+
+        return true;
+    }
+    EndMatch
+
+    return false; // Distinct atoms or integers, or atomic term against a structure
+}
+
+/// Term t with all the bound variables replaced by their values. Since terms 
+/// already built are found in the table, no term is created twice.
+inline const Term* apply(const Term* t, const substitution_map& s, term_table& table)
+{
+    t = resolve(t, s);
+
+    Match(*t)
+    {
+    Case(mch::C<Structure>())
+        std::vector<const Term*> args(match0.terms.size());
+
+        for (size_t i = 0; i < args.size(); ++i)
+            args[i] = apply(match0.terms[i], s, table);
+
+        return table.structure(match0.functor, args);
+    }
+    EndMatch
+
+    return t;
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,143 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks Match statements on google::protobuf::Any, whose vtbl maps cache the
+/// clause for each interned type URL, using the well-known types that come 
+/// with the Protocol Buffers library. Built only when its headers are found; 
+/// link with -lprotobuf.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <iostream>
+
+#if defined(__has_include)
+    #if __has_include(<google/protobuf/any.pb.h>)
+        #define XTL_TEST_PROTOBUF 1
+    #endif
+#endif
+
+#if defined(XTL_TEST_PROTOBUF)
+
+#include <google/protobuf/duration.pb.h>
+#include <google/protobuf/wrappers.pb.h>
+#include "type_switchN-patterns-xtl.hpp"
+#include "patterns/all.hpp"
+#include "adapters/protobuf/adapt_protobuf_any.hpp"
+
+//------------------------------------------------------------------------------
+
+namespace pb = google::protobuf;
+
+static_assert( xtl::is_subtype<pb::Duration,   pb::Any>::value, "Duration <: Any");
+static_assert( xtl::is_subtype<pb::Any,        pb::Any>::value, "Any <: Any");
+static_assert(!xtl::is_subtype<int,            pb::Any>::value, "int </: Any");
+
+namespace mch ///< Mach7 library namespace
+{
+template <> struct bindings<pb::Duration>   { Members(pb::Duration::seconds, pb::Duration::nanos); };
+template <> struct bindings<pb::Int32Value> { Members(pb::Int32Value::value); };
+} // of namespace mch
+
+//------------------------------------------------------------------------------
+
+using mch::C;
+
+int classify(const pb::Any& a)
+{
+    mch::var<std::int64_t> s;
+    mch::var<std::int32_t> n;
+
+    Match(a)
+    {
+        Case(C<pb::Duration>(s,n))     return int(1000 + 10*s + n);
+        Case(C<pb::Int32Value>(n))     return 2000 + n;
+        Case(C<pb::StringValue>())     return 3000 + int(match0.value().size());
+        Otherwise()                    return 0;
+    }
+    EndMatch
+}
+
+template <typename T>
+pb::Any pack(const T& m)
+{
+    pb::Any a;
+    a.PackFrom(m);
+    return a;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    pb::Duration    d; d.set_seconds(4); d.set_nanos(2);
+    pb::Int32Value  i; i.set_value(17);
+    pb::StringValue t; t.set_value("hello");
+    pb::BoolValue   b; b.set_value(true);
+
+    pb::Any broken = pack(i);
+    broken.set_value("\xff\xff\xff");   // Fails to parse
+
+    XTL_VERIFY(mch::interned_type_url(pack(d).type_url()) == mch::interned_type_url(std::string(pack(d).type_url())));
+    XTL_VERIFY(mch::interned_type_url(pack(d).type_url()) != mch::interned_type_url(pack(i).type_url()));
+
+    for (int k = 0; k < 3; ++k) // Repeatedly to go through cached clauses
+    {
+        d.set_nanos(k);
+        XTL_VERIFY(classify(pack(d)) == 1040 + k);
+        XTL_VERIFY(classify(pack(i)) == 2017);
+        XTL_VERIFY(classify(pack(t)) == 3005);
+        XTL_VERIFY(classify(pack(b)) == 0);
+        XTL_VERIFY(classify(pb::Any()) == 0);
+        XTL_VERIFY(classify(broken) == 2000);
+    }
+}
+
+#else
+
+int main()
+{
+    std::cout << "Protocol Buffers are not available" << std::endl;
+}
+
+#endif
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,174 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks Match statements on oneof fields of Protocol Buffers messages, which
+/// switch on the field number returned by the generated *_case() accessor and
+/// bind to the results of the generated accessors of the alternatives. The 
+/// messages are written by hand the way protoc generates them for:
+///
+/// \code
+///     message Click { int32 x = 1; int32 y = 2; }
+///     message Event { oneof kind { Click click = 3; string text = 5; int32 key = 9; bool quit = 12; } }
+/// \endcode
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include "type_switchN-patterns-xtl.hpp"
+#include "patterns/all.hpp"
+#include "adapters/protobuf/adapt_protobuf_oneof.hpp"
+
+//------------------------------------------------------------------------------
+
+class Click
+{
+public:
+    Click(std::int32_t x = 0, std::int32_t y = 0) : x_(x), y_(y) {}
+    std::int32_t x() const { return x_; }
+    std::int32_t y() const { return y_; }
+private:
+    std::int32_t x_, y_;
+};
+
+class Event
+{
+public:
+    enum KindCase { kClick = 3, kText = 5, kKey = 9, kQuit = 12, KIND_NOT_SET = 0 };
+
+    Event() : kind_case_(KIND_NOT_SET), key_(0) {}
+
+    KindCase kind_case() const { return kind_case_; }
+
+    const Click&       click() const { return click_; }
+    const std::string& text()  const { return text_; }
+    std::int32_t       key()   const { return kind_case_ == kKey ? key_ : 0; }
+    bool               quit()  const { return kind_case_ == kQuit; }
+
+    void set_click(const Click& c)       { kind_case_ = kClick; click_ = c; }
+    void set_text(const std::string& s)  { kind_case_ = kText;  text_  = s; }
+    void set_key(std::int32_t k)         { kind_case_ = kKey;   key_   = k; }
+    void set_quit(bool)                  { kind_case_ = kQuit; }
+    void clear_kind()                    { kind_case_ = KIND_NOT_SET; }
+
+private:
+    KindCase     kind_case_;
+    Click        click_;
+    std::string  text_;
+    std::int32_t key_;
+};
+
+typedef mch::oneof<Event, Event::KindCase, &Event::kind_case,
+            mch::oneof_alternative<Event, Event::kClick, Click,        &Event::click>,
+            mch::oneof_alternative<Event, Event::kText,  std::string,  &Event::text>,
+            mch::oneof_scalar     <Event, Event::kKey,   std::int32_t, &Event::key>
+        > event_kind; // quit is deliberately not listed
+
+namespace mch ///< Mach7 library namespace
+{
+template <> struct bindings<Click> { Members(Click::x, Click::y); };
+} // of namespace mch
+
+static_assert( xtl::is_subtype<Click,       event_kind>::value, "Click <: event_kind");
+static_assert( xtl::is_subtype<std::int32_t,event_kind>::value, "int32_t <: event_kind");
+static_assert(!xtl::is_subtype<bool,        event_kind>::value, "bool </: event_kind");
+static_assert( mch::indexed_subject<event_kind>::value,          "event_kind has a jump table");
+static_assert( mch::indexed_subject<event_kind>::size == 10,     "indexed by field numbers up to 9");
+
+//------------------------------------------------------------------------------
+
+using mch::C;
+
+int classify(const Event& e)
+{
+    mch::var<std::int32_t> x, y;
+
+    Match(event_kind(e))
+    {
+        Case(C<Click>(x,y))        return 100 + 10*x + y;
+        Case(C<std::string>())     return 200 + int(match0.size());
+        Case(C<std::int32_t>())    return 300 + match0;
+        Otherwise()                return e.kind_case() == Event::kQuit ? 400 : 0;
+    }
+    EndMatch
+}
+
+/// Same classification with a guard on the scalar alternative
+int guarded(const Event& e)
+{
+    mch::var<std::int32_t> k;
+
+    Match(event_kind(e))
+    {
+        Case(C<std::int32_t>(k) |= k > 5)  return 1;
+        Case(C<std::int32_t>(k))           return 2;
+        Case(C<Click>())                   return 3;
+    }
+    EndMatch
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    Event e;
+
+    for (int i = 0; i < 3; ++i) // Repeatedly to go through filled entries of the jump table
+    {
+        e.clear_kind();          XTL_VERIFY(classify(e) == 0);
+        e.set_click(Click(3,4)); XTL_VERIFY(classify(e) == 134);
+        e.set_text("hello");     XTL_VERIFY(classify(e) == 205);
+        e.set_key(7 + i);        XTL_VERIFY(classify(e) == 307 + i);
+        e.set_quit(true);        XTL_VERIFY(classify(e) == 400);
+        e.set_click(Click(i,1)); XTL_VERIFY(classify(e) == 101 + 10*i);
+
+        e.set_key(4 + i);        XTL_VERIFY(guarded(e) == (i < 2 ? 2 : 1));
+        e.set_key(9);            XTL_VERIFY(guarded(e) == 1);
+        e.set_click(Click());    XTL_VERIFY(guarded(e) == 3);
+        e.set_text("");          XTL_VERIFY(guarded(e) == 0);
+    }
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,124 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks existential and universal quantifiers with the parallel execution
+/// policy against their sequential counterparts, making sure threads stop
+/// soon after a witness is found and exceptions reach the caller.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <atomic>
+#include <iostream>
+#include <list>
+#include <stdexcept>
+#include <vector>
+#include "match.hpp"                // Support for Match statement
+#include "patterns/predicate.hpp"   // Support for predicate patterns
+#include "patterns/quantifiers.hpp" // Support for quantifier patterns
+
+//------------------------------------------------------------------------------
+
+std::atomic<size_t> evaluated(0); ///< Number of elements the predicates below looked at
+
+bool is_negative(int n) { ++evaluated; return n <  0; }
+bool is_small(int n)    { ++evaluated; return n < 1000; }
+bool throws(int n)      { if (n == 777) throw std::runtime_error("777"); return false; }
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    using namespace mch;
+
+    const size_t N = 4*1024*1024;
+
+    std::vector<int> v(N);
+
+    for (size_t i = 0; i < N; ++i)
+        v[i] = int(i % 1000);
+
+    // Same answers as sequential quantifiers
+    XTL_VERIFY(!exist(par,    is_negative)(v));
+    XTL_VERIFY(!exist(is_negative)(v));
+    XTL_VERIFY(all  (par,    is_small)(v));
+    XTL_VERIFY(all  (is_small)(v));
+    XTL_VERIFY(!exist(par(1), is_negative)(v));
+    XTL_VERIFY(exist(par(3), 999)(v));
+    XTL_VERIFY(!exist(par,    _)(std::vector<int>()));
+    XTL_VERIFY(all  (par,    0)(std::vector<int>()));
+    XTL_VERIFY(exist(par,    7)(std::list<int>(3, 7)));
+
+    // Threads stop at their next block after a witness
+    v[N/2] = -1;
+    evaluated = 0;
+    XTL_VERIFY(exist(par(4), is_negative)(v));
+    XTL_VERIFY(evaluated < N);
+
+    v[N/2] = 1000;
+    evaluated = 0;
+    XTL_VERIFY(!all(par(4), is_small)(v));
+    XTL_VERIFY(evaluated < N);
+
+    // Exceptions are rethrown in the calling thread
+    bool caught = false;
+
+    try { exist(par(4), throws)(v); }
+    catch (const std::runtime_error&) { caught = true; }
+
+    XTL_VERIFY(caught);
+
+    // Inside Match
+    int clause = 0;
+
+    Match(v)
+    {
+      With(all(par, is_small))      clause = 1; break;
+      With(exist(par, is_negative)) clause = 2; break;
+      With(exist(par, 1000))        clause = 3; break;
+      With(_)                       clause = 4; break;
+    }
+    EndMatch
+
+    XTL_VERIFY(clause == 3);
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,144 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks existential and universal quantifiers and sequence patterns over
+/// containers, arrays, input streams and unbounded generators, making sure
+/// quantifiers stop at the first witness or counterexample.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <iostream>
+#include <iterator>
+#include <list>
+#include <sstream>
+#include <vector>
+#include "match.hpp"                // Support for Match statement
+#include "patterns/guard.hpp"       // Support for guard patterns
+#include "patterns/n+k.hpp"         // Support for relational operators in guards
+#include "patterns/quantifiers.hpp" // Support for quantifier patterns
+
+//------------------------------------------------------------------------------
+
+/// An unbounded single-pass generator of 0,1,2,... that counts how many
+/// values were pulled out of it.
+struct naturals : std::iterator<std::input_iterator_tag, int>
+{
+    naturals(int* pulled = nullptr) : m_value(0), m_pulled(pulled) {}
+    int       operator*() const { return m_value; }
+    naturals& operator++()      { ++m_value; ++*m_pulled; return *this; }
+    bool operator==(const naturals&) const { return false; } // Never ends
+    bool operator!=(const naturals&) const { return true;  }
+    int  m_value;
+    int* m_pulled;
+};
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    using namespace mch;
+
+    var<int> n;
+
+    // Containers and arrays
+    std::vector<int> v = {1,3,5,8,9};
+    std::list<int>   l = {2,4,6};
+    const int        a[] = {7,7,7};
+
+    XTL_VERIFY(exist(n |= n % 2 == 0)(v));
+    XTL_VERIFY(n == 8);
+    XTL_VERIFY(!all(n |= n < 9)(v));
+    XTL_VERIFY(n == 9);
+    XTL_VERIFY(all(n |= n % 2 == 0)(l));
+    XTL_VERIFY(!exist(7)(l));
+    XTL_VERIFY(all(7)(a));
+    XTL_VERIFY(all(0)(std::vector<int>()));
+    XTL_VERIFY(!exist(_)(std::list<int>()));
+
+    // Input streams are consumed only up to the witness
+    std::istringstream in("1 2 5 7 9");
+    XTL_VERIFY(exist(5)(range(std::istream_iterator<int>(in), std::istream_iterator<int>())));
+    int rest = 0;
+    XTL_VERIFY((in >> rest));
+    XTL_VERIFY(rest == 7);
+
+    std::istringstream bad("2 4 5 6 8");
+    XTL_VERIFY(!all(n |= n % 2 == 0)(range(std::istream_iterator<int>(bad), std::istream_iterator<int>())));
+    XTL_VERIFY(n == 5);
+    XTL_VERIFY((bad >> rest));
+    XTL_VERIFY(rest == 6);
+
+    // Unbounded generators terminate as soon as the answer is known
+    int pulled = 0;
+    XTL_VERIFY(exist(n |= n * n > 50)(range(naturals(&pulled), naturals())));
+    XTL_VERIFY(n == 8);
+    XTL_VERIFY(pulled == 8);
+    pulled = 0;
+    XTL_VERIFY(!all(n |= n < 3)(range(naturals(&pulled), naturals())));
+    XTL_VERIFY(pulled == 3);
+
+    // Sequence patterns bind the bounds of any range
+    auto s = seq(l);
+    XTL_VERIFY(s(l));
+    XTL_VERIFY(s.m_begin == l.begin());
+    XTL_VERIFY(s.m_end == l.end());
+    auto t = seq(a);
+    XTL_VERIFY(t(a));
+    XTL_VERIFY(t.m_begin == a);
+    XTL_VERIFY(t.m_end == a+3);
+
+    // Inside Match
+    int clause = 0;
+
+    Match(v)
+    {
+      With(all(n |= n < 0))   clause = 1; break;
+      With(exist(n |= n > 4)) clause = 2; break;
+      With(_)                 clause = 3; break;
+    }
+    EndMatch
+
+    XTL_VERIFY(clause == 2);
+    XTL_VERIFY(n == 5);
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,129 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks length and element patterns on sequences, which random-access ranges
+/// answer without stepping through their elements, against the same patterns
+/// on lists, and that sequence patterns refute random-access ranges of a wrong
+/// length without looking at their elements.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <iostream>
+#include <list>
+#include <vector>
+#include "patterns/primitive.hpp"   // Support for var and value patterns
+#include "patterns/sequence.hpp"    // Support for sequence patterns
+
+//------------------------------------------------------------------------------
+
+/// Pattern accepting any element that counts how many elements it was applied to
+struct probe
+{
+    template <typename S> struct accepted_type_for { typedef S type; };
+    template <typename T> bool operator()(const T&) const { ++applied; return true; }
+    static int applied;
+};
+
+int probe::applied = 0;
+
+namespace mch ///< Mach7 library namespace
+{
+template <> struct is_pattern_<probe> { static const bool value = true; };
+} // of namespace mch
+
+//------------------------------------------------------------------------------
+
+/// Classifies a range with the patterns on lengths and elements
+template <typename R>
+int classify(const R& r)
+{
+    using namespace mch;
+
+    var<int>         x;
+    var<std::size_t> n;
+
+    if (exactly(0)(r))                  return 0;
+    if (list(1, x)(r))                  return 10 + x;
+    if (nth(2, 7)(r) && at_least(5)(r)) return 20;
+    if (nth(3, x)(r) && length(n)(r))   return int(100 * n) + x;
+    if (at_least(2)(r))                 return 30;
+    return 40;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    const int data[][6] = {
+        {0},
+        {1, 5},
+        {1, 5, 8},
+        {4, 4, 7, 4, 4, 4},
+        {4, 4, 7, 4},
+        {9},
+        {2, 3},
+    };
+    const std::size_t sizes[] = { 0, 2, 3, 6, 4, 1, 2 };
+    const int expected[] = { 0, 15, 30, 20, 404, 40, 30 };
+
+    for (std::size_t i = 0; i < XTL_ARR_SIZE(data); ++i)
+    {
+        std::vector<int> v(data[i], data[i] + sizes[i]);
+        std::list<int>   l(data[i], data[i] + sizes[i]);
+
+        XTL_VERIFY(classify(v) == expected[i]);
+        XTL_VERIFY(classify(l) == expected[i]);
+    }
+
+    // Random-access ranges of a wrong length are refuted before any of their elements is looked at
+    std::vector<int> v(data[3], data[3] + sizes[3]);
+    std::list<int>   l(data[3], data[3] + sizes[3]);
+
+    XTL_VERIFY(!mch::list(probe(), probe())(v));
+    XTL_VERIFY(probe::applied == 0);
+    XTL_VERIFY(!mch::cons(probe(), probe(), probe(), probe(), probe(), probe(), probe(), mch::_)(v));
+    XTL_VERIFY(probe::applied == 0);
+    XTL_VERIFY(!mch::list(probe(), probe())(l));
+    XTL_VERIFY(probe::applied == 2);
+}
+
+//------------------------------------------------------------------------------
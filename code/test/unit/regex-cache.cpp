@@ -0,0 +1,96 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that rex() patterns share the compiled form of equal regular 
+/// expressions instead of compiling them again on every evaluation.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include "match.hpp"                // Support for Match statement
+#include "patterns/primitive.hpp"   // Support for primitive patterns
+#include "patterns/regex.hpp"       // Support for regular expression patterns
+
+#include <iostream>
+#include <string>
+
+//------------------------------------------------------------------------------
+
+int classify(const std::string& s)
+{
+    using namespace mch;
+
+    var<int> n;
+
+    Match(s)
+    {
+        With(rex("([0-9]+)-([0-9]+)", n)) return n;
+        With(rex("[0-9]+"))               return 0;
+        Otherwise()                       return -1;
+    }
+    EndMatch
+
+    return -2;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    // Equal expressions coming from different buffers are compiled once
+    std::string copy = "[0-9]+";
+
+    XTL_VERIFY(&mch::compiled_regex("[0-9]+") == &mch::compiled_regex(copy.c_str()));
+
+    XTL_VERIFY(&mch::compiled_regex("[0-9]+") != &mch::compiled_regex("[a-z]+"));
+
+    // Patterns refer to the shared compiled form
+    XTL_VERIFY(&mch::rex("[0-9]+").m_re == &mch::compiled_regex("[0-9]+"));
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        XTL_VERIFY(classify(std::to_string(i) + "-7") == i);
+        XTL_VERIFY(classify(std::to_string(i))        == 0);
+        XTL_VERIFY(classify("x" + std::to_string(i))  == -1);
+    }
+}
+
+//------------------------------------------------------------------------------
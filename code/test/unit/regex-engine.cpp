@@ -0,0 +1,127 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that regex patterns can use a regular-expression engine other than
+/// the default one and still bind capture groups to their argument patterns.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <regex>
+#include <string>
+
+//------------------------------------------------------------------------------
+
+/// Engine that counts the expressions it compiled and the matches it ran. It 
+/// keeps its match state in static storage just like an engine with reusable
+/// scratch space would.
+struct counting_engine
+{
+    typedef std::regex compiled_type;
+
+    static size_t compiled;
+    static size_t matched;
+
+    static compiled_type* compile(const char* re) { ++compiled; return new std::regex(re); }
+
+    static bool match(const compiled_type& re, const char* b, const char* e, const char** sub, size_t n)
+    {
+        static std::cmatch m;
+
+        ++matched;
+
+        if (!std::regex_match(b, e, m, re) || m.size() <= n)
+            return false;
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            sub[2*i]   = m[i+1].first;
+            sub[2*i+1] = m[i+1].second;
+        }
+
+        return true;
+    }
+};
+
+size_t counting_engine::compiled = 0;
+size_t counting_engine::matched  = 0;
+
+#define XTL_REGEX_ENGINE counting_engine
+
+#include "match.hpp"                // Support for Match statement
+#include "patterns/primitive.hpp"   // Support for primitive patterns
+#include "patterns/regex.hpp"       // Support for regular expression patterns
+
+#include <iostream>
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    using namespace mch;
+
+    var<int> k, v;
+
+    for (int i = 0; i < 100; ++i)
+    {
+        const std::string s = "ab" + std::to_string(i) + "=" + std::to_string(2*i);
+
+        // The argument pattern is itself a regex pattern run by the same engine
+        XTL_VERIFY(rex("([a-z0-9]+)=([0-9]+)", rex("[a-z]+([0-9]+)", k), v)(s));
+        XTL_VERIFY(k == i);
+        XTL_VERIFY(v == 2*i);
+
+        XTL_VERIFY(!rex("[a-z]+")(s.c_str()));
+
+    #if XTL_SUPPORT(string_view)
+        // Only the part of the buffer the view covers is matched
+        XTL_VERIFY(rex("[a-z]+([0-9]+)", k)(std::string_view(s.data(), s.find('='))));
+        XTL_VERIFY(k == i);
+    #endif
+    }
+
+    std::cout << "Compiled: " << counting_engine::compiled << std::endl;
+
+    XTL_VERIFY(counting_engine::compiled == 3);
+    XTL_VERIFY(counting_engine::matched >= 300);
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,152 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that Match statements combining the expressions of their rex() 
+/// clauses into one set (#XTL_REGEX_SETS) take the same clauses as the same
+/// patterns applied one after another outside of a Match statement, including
+/// when argument patterns of the first matching expression reject the subject,
+/// when expressions repeat or have back-references and when Match statements
+/// are nested.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_REGEX_SETS 1
+
+#include "match.hpp"                // Support for Match statement
+#include "patterns/combinators.hpp" // Support for pattern combinators
+#include "patterns/guard.hpp"       // Support for guard patterns
+#include "patterns/n+k.hpp"         // Support for n+k patterns
+#include "patterns/primitive.hpp"   // Support for primitive patterns
+#include "patterns/regex.hpp"       // Support for regular expression patterns
+
+#include <iostream>
+#include <string>
+
+//------------------------------------------------------------------------------
+
+/// Kind of a word evaluated by a Match statement nested in another one
+int inner(const std::string& s)
+{
+    Match(s)
+    {
+        With(mch::rex("[a-z]+"))  return 1;
+        With(mch::rex("[A-Z]+"))  return 2;
+        Otherwise()               return 0;
+    }
+    EndMatch
+
+    return -1;
+}
+
+#define CLAUSES(CASE,OTHERWISE)                                                                      \
+    CASE(mch::rex("([0-9]{4})-([0-9]{2})-([0-9]{2})", year, month, day), 1000 + m)                   \
+    CASE(mch::rex("([0-9]{4})-([0-9]{2})-([0-9]{2})", year, day, month), 2000 + m)                   \
+    CASE(mch::rex("([0-9]+)-([0-9]+)-([0-9]+)", 979),                    3)                          \
+    CASE(mch::rex("([0-9]+)-([0-9]+)-([0-9]+)", area |= area >= 970 && area <= 980), 4000 + area)    \
+    CASE(mch::rex("([0-9]+)-([0-9]+)-([0-9]+)", area),                   5000 + area)                \
+    CASE(mch::rex("(a+)b\\1"),                                           6)                          \
+    CASE(mch::rex("(x+)(y+)\\2\\1"),                                     7)                          \
+    CASE(mch::rex("[0-9]{3}"),                                           8)                          \
+    CASE(mch::rex("[0-9]+"),                                             9)                          \
+    CASE(mch::rex("([a-z]+)=([A-Za-z]+)", word),                         10 + inner(word))           \
+    CASE(mch::rex("[A-Za-z_][A-Za-z_0-9]*"),                             20)                         \
+    CASE(mch::rex(""),                                                   21)                         \
+    OTHERWISE(0)
+
+/// Clauses of a Match statement, which scan the subject once
+int classify(const std::string& s)
+{
+    using namespace mch;
+
+    var<int> area, y, m, d;
+    var<std::string> word;
+    auto year  = y |= y > 0;
+    auto month = m |= m > 0 && m < 13;
+    auto day   = d |= d > 0 && d < 31;
+
+    #define MATCH_CASE(p,r) With(p) return r;
+    #define MATCH_OTHERWISE(r) Otherwise() return r;
+
+    Match(s)
+    {
+        CLAUSES(MATCH_CASE,MATCH_OTHERWISE)
+    }
+    EndMatch
+
+    return -1;
+}
+
+/// Same patterns applied one by one outside of any Match statement
+int expected(const std::string& s)
+{
+    using namespace mch;
+
+    var<int> area, y, m, d;
+    var<std::string> word;
+    auto year  = y |= y > 0;
+    auto month = m |= m > 0 && m < 13;
+    auto day   = d |= d > 0 && d < 31;
+
+    #define IF_CASE(p,r) if ((p)(s)) return r;
+    #define IF_OTHERWISE(r) return r;
+
+    CLAUSES(IF_CASE,IF_OTHERWISE)
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    const char* strings[] = 
+    {
+        "1977-04-01", "1977-20-01", "1977-20-40", "979-739-3587", "571-739-3587", 
+        "975-739-3587", "XXX-739-3587", "aab", "aabaa", "aaba", "xxyyyyxx", "xyyx",
+        "xyx", "123", "1234", "12a", "k=abc", "k=ABC", "k=aBc", "K=abc", "var1", 
+        "_", "", " ", "a-b"
+    };
+
+    for (int pass = 0; pass < 2; ++pass) // The second pass uses sets of all the expressions
+        for (const char* s : strings)
+            XTL_VERIFY(classify(s) == expected(s));
+}
+
+//------------------------------------------------------------------------------
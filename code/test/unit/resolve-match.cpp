@@ -0,0 +1,172 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that Resolve statements on one and two subjects select the same 
+/// clauses as the equivalent Match statements, and that their resolutions 
+/// can be consumed after the statements, the way a coroutine would after 
+/// resuming from suspension.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <iostream>
+#include <vector>
+#include "type_switchN-patterns.hpp"
+#include "patterns/primitive.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Request          { virtual ~Request() {} };
+struct Get : Request    { Get(int k) : key(k) {} int key; };
+struct Put : Request    { Put(int k, int v) : key(k), value(v) {} int key, value; };
+
+/// A family of otherwise unrelated requests to make the vtbl maps grow
+template <int I> struct Other : Request {};
+
+template <int I> void make_others(std::vector<Request*>& requests) { make_others<I-1>(requests); requests.push_back(new Other<I>); }
+template <>      void make_others<0>(std::vector<Request*>& requests) { requests.push_back(new Other<0>); }
+
+//------------------------------------------------------------------------------
+
+/// What the clauses below compute from the request, resolved or not
+int expected(const Request* a)
+{
+    if (const Get* g = dynamic_cast<const Get*>(a)) return 100 + g->key;
+    if (const Put* p = dynamic_cast<const Put*>(a)) return p->value;
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+mch::resolution<1> resolve1(const Request* a)
+{
+    mch::var<const Get&> g;
+    mch::var<const Put&> p;
+
+    mch::resolution<1> r;
+
+    Resolve(r, a)
+    Clause(g)
+    Clause(p)
+    OtherwiseClause()
+    EndResolve
+
+    return r;
+}
+
+/// Consumes resolution of the request once resolve1 has returned
+int consume1(const mch::resolution<1>& r)
+{
+    switch (r.clause)
+    {
+    case 1:  return 100 + r.as<Get>().key;
+    case 2:  return r.as<Put>().value;
+    case 3:  return 0;
+    default: return -1;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+/// Requests with the same key in both
+bool same_key(const Request* a, const Request* b)
+{
+    mch::var<const Get&> g1, g2;
+    mch::var<const Put&> p1, p2;
+
+    mch::resolution<2> r;
+
+    Resolve(r, a, b)
+    Clause(g1,g2)
+    Clause(p1,p2)
+    EndResolve
+
+    switch (r.clause)
+    {
+    case 1:  return r.as<Get,0>().key == r.as<Get,1>().key;
+    case 2:  return r.as<Put,0>().key == r.as<Put,1>().key;
+    default: return false;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    std::vector<Request*> requests;
+
+    for (int i = 0; i < 4; ++i)
+    {
+        requests.push_back(new Get(i));
+        requests.push_back(new Put(i%2,i));
+    }
+
+    make_others<20>(requests);
+
+    for (size_t r = 0; r < 3; ++r)
+    {
+        /// Resolve everything first and consume afterwards
+        std::vector<mch::resolution<1> > resolved;
+
+        for (size_t i = 0; i < requests.size(); ++i)
+            resolved.push_back(resolve1(requests[i]));
+
+        for (size_t i = 0; i < requests.size(); ++i)
+            XTL_VERIFY(consume1(resolved[i]) == expected(requests[i]));
+
+        for (size_t i = 0; i < requests.size(); ++i)
+            for (size_t j = 0; j < requests.size(); ++j)
+            {
+                const Get* g1 = dynamic_cast<const Get*>(requests[i]);
+                const Get* g2 = dynamic_cast<const Get*>(requests[j]);
+                const Put* p1 = dynamic_cast<const Put*>(requests[i]);
+                const Put* p2 = dynamic_cast<const Put*>(requests[j]);
+                bool e = (g1 && g2 && g1->key == g2->key) || (p1 && p2 && p1->key == p2->key);
+
+                XTL_VERIFY(same_key(requests[i],requests[j]) == e);
+            }
+    }
+
+    for (size_t i = 0; i < requests.size(); ++i)
+        delete requests[i];
+}
+
+//------------------------------------------------------------------------------
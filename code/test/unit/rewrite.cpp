@@ -0,0 +1,222 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that mch::rewriter brings hash-consed expressions to the normal form
+/// of simplification rules written as Match statements, including rules that
+/// build new subterms, and that after a change to one leaf of a large term 
+/// only the path to that leaf is visited again.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include "rewrite.hpp"
+#include "type_switchN-patterns.hpp"
+#include "patterns/constructor.hpp"
+#include "patterns/primitive.hpp"
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+//------------------------------------------------------------------------------
+
+struct Expr                 { virtual ~Expr() {} };
+struct Value    : Expr      { explicit Value(int v) : value(v) {} const int value; };
+struct Variable : Expr      { explicit Variable(const std::string& n) : name(n) {} const std::string name; };
+struct Plus     : Expr      { Plus (const Expr* a, const Expr* b) : e1(a), e2(b) {} const Expr* const e1; const Expr* const e2; };
+struct Times    : Expr      { Times(const Expr* a, const Expr* b) : e1(a), e2(b) {} const Expr* const e1; const Expr* const e2; };
+
+namespace mch ///< Mach7 library namespace
+{
+template <> struct bindings<Value>    { Members(Value::value); };
+template <> struct bindings<Variable> { Members(Variable::name); };
+template <> struct bindings<Plus>     { Members(Plus::e1, Plus::e2); };
+template <> struct bindings<Times>    { Members(Times::e1, Times::e2); };
+} // of namespace mch
+
+//------------------------------------------------------------------------------
+
+/// Creates every distinct expression only once
+class expr_table
+{
+public:
+
+    const Expr* value(int v)                     { return make<Value>(values, v, v); }
+    const Expr* variable(const std::string& n)   { return make<Variable>(variables, n, n); }
+    const Expr* plus (const Expr* a, const Expr* b) { return make<Plus> (sums,     std::make_pair(a,b), a, b); }
+    const Expr* times(const Expr* a, const Expr* b) { return make<Times>(products, std::make_pair(a,b), a, b); }
+
+    size_t size() const { return terms.size(); }
+
+private:
+
+    template <typename E, typename M, typename K, typename... A>
+    const Expr* make(M& m, const K& key, const A&... args)
+    {
+        const Expr*& e = m[key];
+
+        if (!e)
+        {
+            terms.emplace_back(new E(args...));
+            e = terms.back().get();
+        }
+
+        return e;
+    }
+
+    typedef std::pair<const Expr*,const Expr*> pair_type;
+    std::map<int,const Expr*>         values;
+    std::map<std::string,const Expr*> variables;
+    std::map<pair_type,const Expr*>   sums;
+    std::map<pair_type,const Expr*>   products;
+    std::vector<std::unique_ptr<Expr>> terms;
+};
+
+expr_table table;
+
+//------------------------------------------------------------------------------
+
+/// Rules of simplification applied to the root of an expression whose 
+/// subexpressions are simplified already
+const Expr* simplify(const Expr* e)
+{
+    mch::var<int> a, b;
+    mch::var<const Expr*> x, y, z;
+
+    Match(e)
+    {
+        Case(mch::C<Plus> (mch::C<Value>(a), mch::C<Value>(b))) return table.value(a+b);
+        Case(mch::C<Plus> (x, mch::C<Value>(0)))                return x;
+        Case(mch::C<Plus> (mch::C<Value>(0), x))                return x;
+        Case(mch::C<Times>(mch::C<Value>(a), mch::C<Value>(b))) return table.value(a*b);
+        Case(mch::C<Times>(x, mch::C<Value>(1)))                return x;
+        Case(mch::C<Times>(mch::C<Value>(1), x))                return x;
+        Case(mch::C<Times>(x, mch::C<Value>(0)))                return table.value(0);
+        Case(mch::C<Times>(x, mch::C<Plus>(y, z)))              return table.plus(table.times(x,y), table.times(x,z));
+    }
+    EndMatch
+
+    return e;
+}
+
+/// Rebuilds expression from its subexpressions mapped by f
+struct map_children
+{
+    template <typename F>
+    const Expr* operator()(const Expr* e, F& f) const
+    {
+        Match(e)
+        {
+            Case(mch::C<Plus>())
+            {
+                const Expr* a = f(match0.e1);
+                const Expr* b = f(match0.e2);
+                return a == match0.e1 && b == match0.e2 ? e : table.plus(a, b);
+            }
+            Case(mch::C<Times>())
+            {
+                const Expr* a = f(match0.e1);
+                const Expr* b = f(match0.e2);
+                return a == match0.e1 && b == match0.e2 ? e : table.times(a, b);
+            }
+        }
+        EndMatch
+
+        return e; // Values and variables have no subexpressions
+    }
+};
+
+//------------------------------------------------------------------------------
+
+/// Balanced sum of leaf(i) for i in [first,last)
+template <typename F>
+const Expr* sum(size_t first, size_t last, F leaf)
+{
+    if (last - first == 1)
+        return leaf(first);
+
+    size_t middle = (first + last) / 2;
+    return table.plus(sum(first, middle, leaf), sum(middle, last, leaf));
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    auto rewrite = mch::make_rewriter<Expr>(&simplify, map_children());
+
+    const Expr* x = table.variable("x");
+    const Expr* y = table.variable("y");
+
+    // (x * (y + 0)) * 1 => x * y
+    XTL_VERIFY(rewrite(table.times(table.times(x, table.plus(y, table.value(0))), table.value(1))) == table.times(x, y));
+
+    // 2 * (3 + y) => 2 * 3 + 2 * y => 6 + 2 * y, in which 2 * y is built by a rule
+    XTL_VERIFY(rewrite(table.times(table.value(2), table.plus(table.value(3), y))) == table.plus(table.value(6), table.times(table.value(2), y)));
+
+    // x * ((y + 0) * 0) => 0
+    XTL_VERIFY(rewrite(table.times(x, table.times(table.plus(y, table.value(0)), table.value(0)))) == table.value(0));
+
+    // Sum of (v_i + 0) * 1 => sum of v_i
+    auto variable = [](size_t i) { return table.variable("v" + std::to_string(i)); };
+    auto original = [&](size_t i) { return table.times(table.plus(variable(i), table.value(0)), table.value(1)); };
+    auto edited   = [&](size_t i) { return i == 5 ? table.times(table.value(3), table.value(4)) : original(i); };
+    auto expected = [&](size_t i) { return i == 5 ? table.value(12) : variable(i); };
+
+    const size_t leaves = 1024;
+    const Expr*  big    = sum(0, leaves, original);
+
+    XTL_VERIFY(rewrite(big) == sum(0, leaves, variable));
+    size_t visits = rewrite.visits();
+    XTL_VERIFY(rewrite(big) == sum(0, leaves, variable));
+    XTL_VERIFY(rewrite.visits() == visits); // Everything is memoized
+
+    // Changing one leaf revisits only the 10 sums on the path to it and the 
+    // new leaf: 3*4, 4 (3 is known already) and 12 it is rewritten to
+    XTL_VERIFY(rewrite(sum(0, leaves, edited)) == sum(0, leaves, expected));
+    XTL_VERIFY(rewrite.visits() - visits == 13);
+
+    std::cout << "Visits: " << rewrite.visits() << " Rewrites: " << rewrite.rewrites() << " Terms: " << table.size() << std::endl;
+}
+
+//------------------------------------------------------------------------------
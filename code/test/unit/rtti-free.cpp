@@ -0,0 +1,210 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that Match statements resolve their type tests without RTTI through
+/// mch::cast_hook: with classof in the style of LLVM, with kinds of a closed 
+/// hierarchy and with a specialization of the hook. The test passes when built
+/// with -fno-rtti as well.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_RTTI 0 // Resolve type tests as if built with -fno-rtti
+
+#include <iostream>
+#include "type_switchN-patterns.hpp"
+#include "patterns/constructor.hpp"
+#include "patterns/primitive.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Tagged { virtual ~Tagged() {} int tag; };
+
+/// Closed hierarchy with kinds
+struct Expr
+{
+    enum Kind { K_Value, K_Plus, K_Times, K_Minus };
+    Expr(Kind k) : kind(k) {}
+    virtual ~Expr() {}
+    Kind kind;
+};
+
+struct Value : Expr         { Value(int v)                        : Expr(K_Value), value(v)         {} int value; };
+struct Plus  : Expr         { Plus (const Expr* a, const Expr* b) : Expr(K_Plus),  exp1(a), exp2(b) {} const Expr* exp1; const Expr* exp2; };
+struct Times : Tagged, Expr { Times(const Expr* a, const Expr* b) : Expr(K_Times), exp1(a), exp2(b) {} const Expr* exp1; const Expr* exp2; };
+struct Minus : Tagged, Expr { Minus(const Expr* a, const Expr* b) : Expr(K_Minus), exp1(a), exp2(b) {} const Expr* exp1; const Expr* exp2; };
+
+namespace mch ///< Mach7 library namespace
+{
+template <> struct bindings<Expr>  { KS(Expr::kind); };
+template <> struct bindings<Value> { KV(Expr,Expr::K_Value); Members(Value::value);            };
+template <> struct bindings<Plus>  { KV(Expr,Expr::K_Plus);  Members(Plus::exp1 , Plus::exp2);  };
+template <> struct bindings<Times> { KV(Expr,Expr::K_Times); Members(Times::exp1, Times::exp2); };
+template <> struct bindings<Minus> { KV(Expr,Expr::K_Minus); Members(Minus::exp1, Minus::exp2); };
+
+template <> struct class_hierarchy<Expr> : classes<Value,Plus,Times,Minus> {};
+} // of namespace mch
+
+//------------------------------------------------------------------------------
+
+/// Open hierarchy with classof in the style of LLVM
+struct Shape
+{
+    enum Kind { K_Circle, K_Square, K_Cube, K_Last_Square };
+    Shape(Kind k) : kind(k) {}
+    virtual ~Shape() {}
+    Kind kind;
+};
+
+struct Circle : Shape  { Circle()              : Shape(K_Circle) {}                    static bool classof(const Shape* s) { return s->kind == K_Circle; } };
+struct Square : Shape  { Square(Kind k = K_Square) : Shape(k)    {}                    static bool classof(const Shape* s) { return s->kind >= K_Square && s->kind < K_Last_Square; } };
+struct Cube   : Square { Cube()                : Square(K_Cube)  {}                    static bool classof(const Shape* s) { return s->kind == K_Cube; } };
+
+//------------------------------------------------------------------------------
+
+/// Hierarchy resolved by a hook the user provides
+struct Animal { virtual ~Animal() {} virtual int legs() const = 0; };
+struct Bird : Animal { int legs() const { return 2; } };
+struct Dog  : Animal { int legs() const { return 4; } };
+
+namespace mch ///< Mach7 library namespace
+{
+template <> struct cast_hook<Bird,Animal> { static const Bird* go(const Animal* a) noexcept { return a->legs() == 2 ? static_cast<const Bird*>(a) : nullptr; } };
+template <> struct cast_hook<Dog, Animal> { static const Dog*  go(const Animal* a) noexcept { return a->legs() == 4 ? static_cast<const Dog*> (a) : nullptr; } };
+} // of namespace mch
+
+//------------------------------------------------------------------------------
+
+int evaluate(const Expr* e)
+{
+    mch::var<const Expr*> a, b;
+    mch::var<int> n;
+
+    Match(e)
+    {
+    Case(mch::C<Value>(n))    return n;
+    Case(mch::C<Plus>(a,b))   return evaluate(a) + evaluate(b);
+    Case(mch::C<Times>(a,b))  return evaluate(a) * evaluate(b);
+    Otherwise()               return -1000;
+    }
+    EndMatch
+
+    return 0;
+}
+
+/// The same evaluation written by hand with kinds
+int expected(const Expr* e)
+{
+    switch (e->kind)
+    {
+    case Expr::K_Value: return static_cast<const Value*>(e)->value;
+    case Expr::K_Plus:  return expected(static_cast<const Plus*>(e)->exp1)  + expected(static_cast<const Plus*>(e)->exp2);
+    case Expr::K_Times: return expected(static_cast<const Times*>(e)->exp1) * expected(static_cast<const Times*>(e)->exp2);
+    default:            return -1000;
+    }
+}
+
+int classify(const Shape* s)
+{
+    Match(s)
+    {
+    Case(mch::C<Cube>())   return 3; // More derived first
+    Case(mch::C<Square>()) return 2;
+    Case(mch::C<Circle>()) return 1;
+    }
+    EndMatch
+
+    return 0;
+}
+
+int legs(const Animal* a)
+{
+    Match(a)
+    {
+    Case(mch::C<Dog>())  return 4;
+    Case(mch::C<Bird>()) return 2;
+    }
+    EndMatch
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    Value v2(2), v3(3), v5(5);
+    Minus m(&v2, &v3);             // Only handled by Otherwise
+    Times t(&v3, &v5);             // Expr subobject is not at offset 0
+    Plus  p1(&v2, &t);
+    Times t2(&p1, &v5);
+    Plus  p2(&t2, &m);
+
+    const Expr* exprs[] = { &p2, &t2, &p1, &t, &m, &v2 };
+
+    Circle c; Square q; Cube k;
+    Bird   b; Dog    d;
+
+    for (size_t r = 0; r < 3; ++r)
+    {
+        for (size_t i = 0; i < sizeof(exprs)/sizeof(exprs[0]); ++i)
+            XTL_VERIFY(evaluate(exprs[i]) == expected(exprs[i]));
+
+        XTL_VERIFY(classify(&c) == 1);
+        XTL_VERIFY(classify(&q) == 2);
+        XTL_VERIFY(classify(&k) == 3);
+        XTL_VERIFY(legs(&b) == 2);
+        XTL_VERIFY(legs(&d) == 4);
+    }
+
+    // Hooked casts behave as dynamic_cast on null pointers and references
+    const Shape* null_shape = 0;
+    Shape&       shape      = c;
+    XTL_VERIFY(mch::hooked_cast<const Circle*>(null_shape) == 0);
+    XTL_VERIFY(mch::hooked_cast<Cube*>(static_cast<Shape*>(&k)) == &k);
+    XTL_VERIFY(&mch::hooked_cast<Circle&>(shape) == &c);
+    XTL_VERIFY(mch::hooked_cast<const Expr*>(&t) == static_cast<const Expr*>(&t)); // Upcast
+    XTL_VERIFY(mch::hooked_cast<const Times*>(static_cast<const Expr*>(&t)) == &t); // Kind of a subobject not at offset 0
+
+    try { mch::hooked_cast<Square&>(shape); XTL_VERIFY(!"std::bad_cast was not thrown"); } catch (const std::bad_cast&) {}
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,126 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that with #XTL_RUNTIME_TUNING the cache size vtbl maps start with
+/// comes from the environment and from mch::vtbl_tuning(), while malformed 
+/// values in the environment leave the compile-time defaults.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_RUNTIME_TUNING 1
+
+#include <cstdlib>
+#include <iostream>
+#include <unistd.h>
+#include "type_switchN.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Shape                { virtual ~Shape() {} };
+struct Circle   : Shape     {};
+struct Square   : Shape     {};
+struct Triangle : Shape     {};
+
+//------------------------------------------------------------------------------
+
+int classify(const Shape& s)
+{
+    Match(s)
+    {
+        Case(Circle)   return 1;
+        Case(Square)   return 2;
+        Case(Triangle) return 3;
+    }
+    EndMatch
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+int main(int, char* argv[])
+{
+    // Maps of Match statements may be constructed during static initialization
+    // (\see #XTL_PRELOAD_LOCAL_STATIC_VARIABLES), which is why the environment 
+    // is set for the test by running it again
+    if (!std::getenv("XTL_MIN_LOG_SIZE"))
+    {
+        setenv("XTL_MIN_LOG_SIZE",       "6",   1);
+        setenv("XTL_MAX_LOG_INC",        "two", 1);
+        setenv("XTL_INITIAL_COLLISIONS", "0",   1);
+        execv(argv[0], argv);
+        std::cerr << "Cannot run " << argv[0] << " again" << std::endl;
+        return 1;
+    }
+
+    const mch::vtbl_count_t clauses = 3;
+
+    {
+        mch::vtbl_map<1,int> map(clauses);
+        XTL_VERIFY(map.log_size() == 6);
+    }
+
+    XTL_VERIFY(mch::vtbl_tuning().max_log_inc        == XTL_MAX_LOG_INC); // Not a number
+    XTL_VERIFY(mch::vtbl_tuning().initial_collisions == mch::initial_collisions_before_update); // Out of range
+
+    mch::vtbl_tuning().min_log_size = 2;
+
+    {
+        mch::vtbl_map<1,int> map(clauses);
+        XTL_VERIFY(map.log_size() == 2);
+    }
+
+    Circle   c;
+    Square   s;
+    Triangle t;
+    Shape    x;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        XTL_VERIFY(classify(c) == 1);
+        XTL_VERIFY(classify(s) == 2);
+        XTL_VERIFY(classify(t) == 3);
+        XTL_VERIFY(classify(x) == 0);
+    }
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,178 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that under XTL_SEPARATE_DEFAULTS a Match statement with a few Case
+/// clauses and an Otherwise() clause that sees a hundred classes keeps a cache
+/// sized for the classes taken by the Case clauses, while the classes taken by
+/// Otherwise() share one value outside of it.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_SEPARATE_DEFAULTS 1
+#define XTL_VTBL_STATISTICS   1
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "type_switchN-patterns.hpp"
+#include "patterns/primitive.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Shape            { virtual ~Shape() {} };
+struct Circle : Shape   {};
+struct Square : Shape   {};
+struct Oval   : Circle  {};
+
+/// A family of classes none of the Case clauses takes
+template <int I> struct Other : Shape {};
+
+template <int I> void make_others(std::vector<Shape*>& shapes) { make_others<I-1>(shapes); shapes.push_back(new Other<I>); }
+template <>      void make_others<0>(std::vector<Shape*>& shapes) { shapes.push_back(new Other<0>); }
+
+//------------------------------------------------------------------------------
+
+int classify(const Shape* a)
+{
+    mch::var<const Oval&>   o;
+    mch::var<const Circle&> c;
+    mch::var<const Square&> s;
+
+    Match(a)
+    {
+    Case(o)     return 1;
+    Case(c)     return 2;
+    Case(s)     return 3;
+    Otherwise() return 4;
+    }
+    EndMatch
+
+    return -1;
+}
+
+/// The same without Otherwise() clause, where default is the end of the statement
+int classify_no_otherwise(const Shape* a)
+{
+    mch::var<const Oval&>   o;
+    mch::var<const Circle&> c;
+    mch::var<const Square&> s;
+
+    Match(a)
+    {
+    Case(o)     return 1;
+    Case(c)     return 2;
+    Case(s)     return 3;
+    }
+    EndMatch
+
+    return 4;
+}
+
+int expected(const Shape* a)
+{
+    if (dynamic_cast<const Oval*>(a))   return 1;
+    if (dynamic_cast<const Circle*>(a)) return 2;
+    if (dynamic_cast<const Square*>(a)) return 3;
+    return 4;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    std::vector<Shape*> shapes;
+
+    shapes.push_back(new Circle);
+    shapes.push_back(new Oval);
+    make_others<60>(shapes);
+    shapes.push_back(new Square);
+    make_others<120>(shapes);
+
+    for (size_t r = 0; r < 3; ++r)
+        for (size_t i = 0; i < shapes.size(); ++i)
+        {
+            XTL_VERIFY(classify(shapes[i])              == expected(shapes[i]));
+            XTL_VERIFY(classify_no_otherwise(shapes[i]) == expected(shapes[i]));
+        }
+
+    {
+        const mch::vtbl_count_t clauses = 3;
+        mch::vtbl_map<1,int> map(clauses);
+
+        for (size_t r = 0; r < 2; ++r)
+            for (size_t i = 0; i < shapes.size(); ++i)
+            {
+                int& v = map.get(shapes[i]);
+
+                if (!v && (v = expected(shapes[i])) == 4)
+                    map.set_default(v);
+
+                XTL_VERIFY(v == expected(shapes[i]));
+            }
+
+        XTL_VERIFY(map.default_count() == 121); // All 121 classes Other<I> share the default
+        XTL_VERIFY(map.log_size() <= 3); // ... and left the cache small
+
+        size_t tuples = 0;
+        map.for_each([&tuples](const intptr_t (&)[1], int) { ++tuples; });
+        XTL_VERIFY(tuples == 124); // Every class is visited once
+    }
+
+    size_t sites = 0;
+
+    mch::for_each_vtbl_site(
+        [&](const mch::vtbl_site_statistics& s)
+        {
+            if (s.func != std::string("classify") && s.func != std::string("classify_no_otherwise"))
+                return;
+
+            ++sites;
+
+            XTL_VERIFY(s.log_size <= 5); // Cache for 3 classes of Case clauses and a few defaults, not for 124 classes
+        });
+
+    XTL_VERIFY(sites == 2);
+
+    for (size_t i = 0; i < shapes.size(); ++i)
+        delete shapes[i];
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,98 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that solvers of n+k patterns bind variables only in the values they 
+/// can actually be matched with, including forms k*v+c, v*k, v/k and those with
+/// equivalence operands.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <iostream>
+#include "patterns/n+k.hpp"       // Support for n+k patterns
+#include "patterns/equivalence.hpp" // Support for equivalence patterns
+
+//------------------------------------------------------------------------------
+
+/// Checks that matching succeeded as expected and bound v to expected value
+template <typename T, typename U>
+void check(bool matched, bool expected, const mch::var<T>& v, U value)
+{
+    XTL_VERIFY(matched == expected);
+
+    if (expected)
+        XTL_VERIFY(T(v) == T(value));
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    using namespace mch;
+
+    var<int>         m;
+    var<int>         k;
+    var<unsigned>    u;
+    var<signed char> c;
+
+    k = 3;
+
+    for (int r = -100; r <= 100; ++r)
+    {
+        check((2*m)(r),     r%2 == 0,       m, r/2);
+        check((2*m+1)(r),   (r-1)%2 == 0,   m, (r-1)/2);
+        check((m*3)(r),     r%3 == 0,       m, r/3);
+        check((m*3-1)(r),   (r+1)%3 == 0,   m, (r+1)/3);
+        check((m/4)(r),     true,           m, r*4);
+        check((m*+k)(r),    r%3 == 0,       m, r/3);
+        check((+k*m)(r),    r%3 == 0,       m, r/3);
+        check((m/+k)(r),    true,           m, r*3);
+        check((m-+k)(r),    true,           m, r+3);
+        check((+k-m)(r),    true,           m, 3-r);
+        check((2*u+1)(unsigned(r+100)), (r+100)%2 == 1, u, (r+99)/2);
+        check((2*c)(r*3),   r%2 == 0 && r*3/2 >= -128 && r*3/2 < 128, c, r*3/2);
+    }
+
+    // Overflow of the binding is not a solution
+    check((2*c)(600), false, c, 0);
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,127 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that Case clauses find their targets with static_cast when no 
+/// virtual base is on the path from the type of the subject to the target
+/// (#XTL_STATIC_OFFSETS), and that they still find the right sub-object 
+/// through virtual bases and after a cross-cast from a repeated base.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_STATIC_OFFSETS 1
+
+#include <iostream>
+#include "type_switchN-patterns.hpp"
+#include "patterns/constructor.hpp"
+#include "patterns/primitive.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Shape                      { virtual ~Shape() {} };
+struct Named                      { virtual ~Named() {} int id = 0; };
+struct Circle : Shape             { int r = 1; };
+struct Label  : Shape, Named      { int l = 2; };               // Named at a non-zero offset
+struct Ring   : virtual Shape     { int w = 3; };               // Offset depends on the dynamic type
+struct Disc   : Circle            {};
+struct Left   : Shape             {};
+struct Right  : Shape             {};
+struct Both   : Left, Right       { int b = 4; };               // Two Shape sub-objects
+
+static_assert( mch::has_static_offset<Shape,Circle>::value, "Single inheritance has a static offset");
+static_assert( mch::has_static_offset<Named,Label>::value,  "Non-virtual multiple inheritance has a static offset");
+static_assert(!mch::has_static_offset<Shape,Ring>::value,   "Virtual inheritance does not");
+
+//------------------------------------------------------------------------------
+
+using mch::C;
+
+const void* target_of(const Shape& s)
+{
+    Match(s)
+    {
+        Case(C<Circle>()) return &match0;
+        Case(C<Ring>())   return &match0;
+        Case(C<Left>())   return &match0;
+    }
+    EndMatch
+
+    return nullptr;
+}
+
+const void* target_of(const Named& n)
+{
+    Match(n)
+    {
+        Case(C<Label>())  return &match0;
+    }
+    EndMatch
+
+    return nullptr;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    Circle c; Label l; Ring r; Disc d; Both b;
+
+    for (int i = 0; i < 2; ++i) // Cache misses, then hits
+    {
+        XTL_VERIFY(target_of(static_cast<const Shape&>(c)) == &c);
+        XTL_VERIFY(target_of(static_cast<const Shape&>(d)) == static_cast<const Circle*>(&d));
+        XTL_VERIFY(target_of(static_cast<const Named&>(l)) == &l);
+        XTL_VERIFY(target_of(static_cast<const Shape&>(r)) == &r);
+    }
+
+    // The Shape of Right in Both reaches Left only through a cross-cast, 
+    // which static_cast does not follow
+    const Shape& rs = static_cast<const Right&>(b);
+    const Shape& ls = static_cast<const Left&>(b);
+
+    for (int i = 0; i < 2; ++i)
+    {
+        XTL_VERIFY(target_of(ls) == static_cast<const Left*>(&b));
+        XTL_VERIFY(target_of(rs) == static_cast<const Left*>(&b));
+    }
+}
+
+//------------------------------------------------------------------------------
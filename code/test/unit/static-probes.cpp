@@ -0,0 +1,119 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that with XTL_STATIC_PROBES Match statements and memoized_cast work
+/// as before, while the executable carries SystemTap notes of probes mach7:*
+/// on their slow paths, which tools like bpftrace attach to.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_STATIC_PROBES     1
+#define XTL_USE_MEMOIZED_CAST 1 // Casts to Extra below are memoized, Match statements make them
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include "match.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Shape                 { virtual ~Shape() {} };
+struct Extra                 { virtual ~Extra() {} };
+struct Circle   : Shape      {};
+struct Square   : Shape      {};
+struct Triangle : Shape, Extra {};
+
+//------------------------------------------------------------------------------
+
+int classify(const Shape& s)
+{
+    Match(s)
+    {
+        Case(Circle)   return 1;
+        Case(Square)   return 2;
+        Case(Triangle) return 3;
+    }
+    EndMatch
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+/// Returns whether file has a note of probe mach7:name
+bool has_probe(const std::string& image, const char* name)
+{
+    return image.find(std::string("mach7\0", 6) + name + '\0') != std::string::npos;
+}
+
+//------------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    Circle   c;
+    Square   s;
+    Triangle t;
+    Shape    x;
+
+    const Shape* shapes[] = { &c, &s, &t, &x, &t, &s, &c, &x };
+    const int    expected[] = { 1, 2, 3, 0, 3, 2, 1, 0 };
+
+    for (size_t r = 0; r < 3; ++r)
+        for (size_t i = 0; i < sizeof(shapes)/sizeof(shapes[0]); ++i)
+        {
+            XTL_VERIFY(classify(*shapes[i]) == expected[i]);
+            XTL_VERIFY(memoized_cast<const Extra*>(shapes[i]) == dynamic_cast<const Extra*>(shapes[i]));
+        }
+
+#if defined(__ELF__) && (defined(__x86_64__) || defined(__aarch64__))
+    std::ifstream exe(argc > 0 ? argv[0] : "", std::ios::binary);
+    std::string   image((std::istreambuf_iterator<char>(exe)), std::istreambuf_iterator<char>());
+
+    XTL_VERIFY(!image.empty());
+    XTL_VERIFY(has_probe(image, "vtbl_miss"));
+    XTL_VERIFY(has_probe(image, "vtbl_update"));
+    XTL_VERIFY(has_probe(image, "cast_miss"));
+#endif
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,171 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks Match statements on std::any, whose vtbl maps cache the clause for 
+/// each address of std::type_info of the value held. Without C++17 there is 
+/// nothing to check.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <iostream>
+#include "type_switchN-patterns-xtl.hpp"
+
+#if XTL_SUPPORT(any)
+
+#include <vector>
+#include "patterns/all.hpp"
+#include "adapters/std/adapt_std_any.hpp"
+
+//------------------------------------------------------------------------------
+
+struct P { int m_p; P(int i = 0) : m_p(i) {} };
+struct Q { int m_q; Q(int i = 0) : m_q(i) {} };
+
+static_assert( xtl::is_subtype<P,       std::any>::value, "P <: any");
+static_assert( xtl::is_subtype<std::any,std::any>::value, "any <: any");
+
+int expected(const std::any& a)
+{
+    if (const P*   p = std::any_cast<P>(&a))   return 100 + p->m_p;
+    if (const Q*   q = std::any_cast<Q>(&a))   return 200 + q->m_q;
+    if (const int* n = std::any_cast<int>(&a)) return 300 + *n;
+    return 0;
+}
+
+int do_match(const std::any& a)
+{
+    using mch::C;
+
+    Match(a)
+    {
+        Case(C<P>())   return 100 + match0.m_p;
+        Case(C<Q>())   return 200 + match0.m_q;
+        Case(C<int>()) return 300 + match0;
+        Otherwise()    return 0;
+    }
+    EndMatch
+
+    return -1;
+}
+
+int do_match(const std::any& a, const std::any& b)
+{
+    using mch::C;
+
+    Match(a, b)
+    {
+        Case(C<P>(), C<Q>()) return match0.m_p * 1000 + match1.m_q;
+        Case(C<Q>(), C<P>()) return match0.m_q * 1000 + match1.m_p;
+        Otherwise()          return 0;
+    }
+    EndMatch
+
+    return -1;
+}
+
+/// Doubles values held by a mutable subject in place
+void twice(std::any& a)
+{
+    using mch::C;
+
+    Match(a)
+    {
+        Case(C<P>())   match0.m_p *= 2; break;
+        Case(C<int>()) match0     *= 2; break;
+    }
+    EndMatch
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    std::vector<std::any> values;
+
+    for (int i = 0; i < 30; ++i)
+        switch (i % 5)
+        {
+        case 0: values.push_back(P(i));         break;
+        case 1: values.push_back(Q(i));         break;
+        case 2: values.push_back(i);            break;
+        case 3: values.push_back(double(i));    break;
+        case 4: values.push_back(std::any());   break; // Empty
+        }
+
+    for (size_t r = 0; r < 3; ++r)
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            XTL_VERIFY(do_match(values[i]) == expected(values[i]));
+
+            for (size_t j = 0; j < values.size(); ++j)
+            {
+                const P* p = std::any_cast<P>(&values[i]);
+                const Q* q = std::any_cast<Q>(&values[i]);
+                const P* s = std::any_cast<P>(&values[j]);
+                const Q* t = std::any_cast<Q>(&values[j]);
+                const int x = p && t ? p->m_p * 1000 + t->m_q 
+                            : q && s ? q->m_q * 1000 + s->m_p
+                                     : 0;
+                XTL_VERIFY(do_match(values[i], values[j]) == x);
+            }
+        }
+
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        const int before = expected(values[i]);
+        twice(values[i]);
+        const int after  = expected(values[i]);
+
+        XTL_VERIFY((before / 100 == 1 || before / 100 == 3) ? after == 2 * before - before / 100 * 100 : after == before);
+    }
+}
+
+#else
+
+int main()
+{
+    std::cout << "std::any is not supported" << std::endl;
+}
+
+#endif
+
+//------------------------------------------------------------------------------
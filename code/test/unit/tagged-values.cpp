@@ -0,0 +1,178 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Matches values of a small interpreter that keep their type tags in the 
+/// lowest bits of aligned pointers (#KSM) and in NaN-boxed doubles (#KSN) 
+/// with MatchU, without unboxing them first, and checks the results against
+/// decoding the tags by hand.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include "match.hpp"
+
+//------------------------------------------------------------------------------
+
+/// A value tagged in the lowest 3 bits: small integers are shifted by 3 bits
+/// and have tag 0, pointers to pairs have tag 1 and pointers to names tag 2.
+struct Value { std::uintptr_t bits; };
+
+enum { fixnum_tag = 0, pair_tag = 1, name_tag = 2, tag_mask = 7 };
+
+struct alignas(8) Pair { Value car; Value cdr; };
+struct alignas(8) Name { const char* text; };
+
+Value       fixnum(std::intptr_t n)  { Value v = { std::uintptr_t(n) << 3 }; return v; }
+Value       cons(Pair* p)            { Value v = { reinterpret_cast<std::uintptr_t>(p) | pair_tag }; return v; }
+Value       name(Name* n)            { Value v = { reinterpret_cast<std::uintptr_t>(n) | name_tag }; return v; }
+std::intptr_t fixnum_of(const Value& v) { return std::intptr_t(v.bits) >> 3; }
+const Pair* pair_of(const Value& v)  { return reinterpret_cast<const Pair*>(v.bits & ~std::uintptr_t(tag_mask)); }
+Value       car_of(const Value& v)   { return pair_of(v)->car; }
+Value       cdr_of(const Value& v)   { return pair_of(v)->cdr; }
+const char* text_of(const Value& v)  { return reinterpret_cast<const Name*>(v.bits & ~std::uintptr_t(tag_mask))->text; }
+
+//------------------------------------------------------------------------------
+
+/// A NaN-boxed value: doubles as they are, everything else in the payload of 
+/// negative quiet NaNs with tag in bits 48-50: 1 for integers and 2 for booleans.
+struct Boxed { double d; };
+
+enum { double_tag = 0, int_tag = 1, bool_tag = 2 };
+
+const std::uint64_t box_tag_mask = 0x0007000000000000ULL;
+
+Boxed box(double d)             { Boxed b = { d }; return b; }
+Boxed box_bits(std::uint64_t w) { Boxed b; std::memcpy(&b.d, &w, sizeof(w)); return b; }
+Boxed box(std::int32_t i)       { return box_bits(0xFFF8000000000000ULL | (std::uint64_t(int_tag)  << 48) | std::uint32_t(i)); }
+Boxed box(bool b)               { return box_bits(0xFFF8000000000000ULL | (std::uint64_t(bool_tag) << 48) | std::uint64_t(b)); }
+std::uint64_t bits_of(const Boxed& b) { std::uint64_t w; std::memcpy(&w, &b.d, sizeof(w)); return w; }
+std::int32_t  int_of(const Boxed& b)  { return std::int32_t(std::uint32_t(bits_of(b))); }
+bool          bool_of(const Boxed& b) { return bits_of(b) & 1; }
+double        double_of(const Boxed& b) { return b.d; }
+
+//------------------------------------------------------------------------------
+
+namespace mch ///< Mach7 library namespace
+{
+template <> struct bindings<Value>          { KSM(Value,bits,tag_mask); };
+template <> struct bindings<Value,fixnum_tag> { KV(Value,fixnum_tag); Members(fixnum_of); };
+template <> struct bindings<Value,pair_tag>   { KV(Value,pair_tag);   Members(car_of,cdr_of); };
+template <> struct bindings<Value,name_tag>   { KV(Value,name_tag);   Members(text_of); };
+
+template <> struct bindings<Boxed>            { KSN(Boxed,d,box_tag_mask); };
+template <> struct bindings<Boxed,double_tag> { KV(Boxed,double_tag); Members(double_of); };
+template <> struct bindings<Boxed,int_tag>    { KV(Boxed,int_tag);    Members(int_of); };
+template <> struct bindings<Boxed,bool_tag>   { KV(Boxed,bool_tag);   Members(bool_of); };
+} // of namespace mch
+
+//------------------------------------------------------------------------------
+
+/// Sums the integers in a tree of pairs, counting each name as 100
+std::intptr_t sum(const Value& v)
+{
+    MatchU(v)
+    {
+    CaseU(fixnum_tag,n)  return n;
+    CaseU(pair_tag,a,d)  return sum(a) + sum(d);
+    CaseU(name_tag,t)    XTL_UNUSED(t); return 100;
+    }
+    EndMatchU
+
+    return -1;
+}
+
+/// Decodes the tags by hand
+std::intptr_t sum_by_hand(const Value& v)
+{
+    switch (v.bits & tag_mask)
+    {
+    case fixnum_tag: return fixnum_of(v);
+    case pair_tag:   return sum_by_hand(car_of(v)) + sum_by_hand(cdr_of(v));
+    case name_tag:   return 100;
+    }
+
+    return -1;
+}
+
+/// Turns a NaN-boxed value into a double
+double numeric(const Boxed& b)
+{
+    MatchU(b)
+    {
+    CaseU(double_tag,x)  return x;
+    CaseU(int_tag,i)     return i;
+    CaseU(bool_tag,f)    return f ? 1.0 : 0.0;
+    }
+    EndMatchU
+
+    return -1.0;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    // Tagged pointers
+    Name x = { "x" };
+    Pair p3 = { fixnum(-4), name(&x) };
+    Pair p2 = { fixnum(7),  cons(&p3) };
+    Pair p1 = { cons(&p2),  fixnum(35) };
+    const Value values[] = { fixnum(0), fixnum(-1), fixnum(12345), name(&x), cons(&p3), cons(&p2), cons(&p1) };
+
+    for (const Value& v : values)
+        XTL_VERIFY(sum(v) == sum_by_hand(v));
+
+    // NaN-boxed values, including NaNs and infinities that are doubles
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const Boxed boxes[] = { box(1.5), box(-0.0), box(std::numeric_limits<double>::infinity()), box(-nan), box(nan),
+                            box(std::int32_t(-42)), box(std::int32_t(7)), box(true), box(false) };
+    const double expected[] = { 1.5, -0.0, std::numeric_limits<double>::infinity(), nan, nan, -42.0, 7.0, 1.0, 0.0 };
+
+    for (size_t i = 0; i < sizeof(boxes)/sizeof(boxes[0]); ++i)
+    {
+        const double r = numeric(boxes[i]);
+        XTL_VERIFY(r == expected[i] || (r != r && expected[i] != expected[i])); // NaN is not equal to itself
+    }
+}
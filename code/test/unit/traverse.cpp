@@ -0,0 +1,189 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that mch::traverse visits trees in pre- and post-order with children
+/// pushed by Match statements or found through #bindings, and that it walks 
+/// chains much deeper than recursion over them could.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "arena.hpp"
+#include "traverse.hpp"
+#include "type_switchN-patterns.hpp"
+#include "patterns/constructor.hpp"
+#include "patterns/primitive.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Expr                   { virtual ~Expr() {} };
+struct Value : Expr           { Value(int v) : value(v) {}                                    int value; };
+struct Neg   : Expr           { Neg(const Expr* e) : e1(e) {}                                 const Expr* e1; };
+struct Plus  : Expr           { Plus(const Expr* a, const Expr* b) : e1(a), e2(b) {}          const Expr* e1; const Expr* e2; };
+struct Times : Expr           { Times(const Expr* a, const Expr* b) : e1(a), e2(b), tag(7) {} const Expr* e1; const Expr* e2; int tag; };
+
+namespace mch ///< Mach7 library namespace
+{
+template <> struct bindings<Value> { Members(Value::value); };
+template <> struct bindings<Neg>   { Members(Neg::e1); };
+template <> struct bindings<Plus>  { Members(Plus::e1, Plus::e2); };
+template <> struct bindings<Times> { Members(Times::tag, Times::e1, Times::e2); }; // Non-pointer member first
+template <> struct class_hierarchy<Expr> : classes<Value,Neg,Plus,Times> {};
+} // of namespace mch
+
+using namespace mch;
+
+//------------------------------------------------------------------------------
+
+/// Evaluates expressions in post-order with a stack of values
+struct evaluator : traversal_visitor<Expr>
+{
+    void children(const Expr* e, traversal_stack<Expr>& stack)
+    {
+        var<const Expr*> x, y;
+
+        Match(e)
+        {
+            Case(C<Neg>(x))     stack.push(x);                break;
+            Case(C<Plus>(x,y))  stack.push(x); stack.push(y); break;
+            Case(C<Times>())    push_members<Expr>(match0, stack); break;
+        }
+        EndMatch
+    }
+
+    void post(const Expr* e)
+    {
+        Match(e)
+        {
+            Case(C<Value>())  values.push_back(match0.value); break;
+            Case(C<Neg>())    values.back() = -values.back(); break;
+            Case(C<Plus>())   { int b = pop(); values.back() += b; } break;
+            Case(C<Times>())  { int b = pop(); values.back() *= b; } break;
+        }
+        EndMatch
+    }
+
+    int pop() { int v = values.back(); values.pop_back(); return v; }
+
+    std::vector<int> values;
+};
+
+//------------------------------------------------------------------------------
+
+/// Records the order of visiting with the default children found through bindings
+struct recorder : traversal_visitor<Expr>
+{
+    explicit recorder(const Expr* skip = nullptr) : skipped(skip) {}
+
+    bool pre(const Expr* e)  { order += '<' + name(e); return e != skipped; }
+    void post(const Expr* e) { order += name(e) + '>'; }
+
+    static std::string name(const Expr* e)
+    {
+        Match(e)
+        {
+            Case(C<Value>()) return std::to_string(match0.value);
+            Case(C<Neg>())   return "-";
+            Case(C<Plus>())  return "+";
+            Case(C<Times>()) return "*";
+        }
+        EndMatch
+
+        return "?";
+    }
+
+    const Expr* skipped;
+    std::string order;
+};
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    arena<Expr> a;
+
+    // -(1 + 2) * 3
+    const Expr* e = a.make<Times>(a.make<Neg>(a.make<Plus>(a.make<Value>(1), a.make<Value>(2))), a.make<Value>(3));
+
+    evaluator ev;
+    traverse(e, ev);
+    XTL_VERIFY(ev.values.size() == 1 && ev.values[0] == -9);
+
+    recorder r;
+    traverse(e, r);
+    XTL_VERIFY(r.order == "<*<-<+<11><22>+>-><33>*>");
+
+    // Children of a node whose pre() returned false are not visited
+    recorder s(static_cast<const Times*>(e)->e1);
+    traverse(e, s);
+    XTL_VERIFY(s.order == "<*<--><33>*>");
+
+    // Null children are ignored
+    recorder n;
+    traverse<Expr>(a.make<Plus>(nullptr, a.make<Value>(4)), n);
+    XTL_VERIFY(n.order == "<+<44>+>");
+
+    // Chain far deeper than the call stack could take recursively, walked twice
+    // by the same traverser, which does not grow its stack the second time
+    const int depth = 1000000;
+    const Expr* chain = a.make<Value>(5);
+
+    for (int i = 0; i < depth; ++i)
+        chain = i % 2 ? static_cast<const Expr*>(a.make<Neg>(chain)) : a.make<Plus>(a.make<Value>(1), chain);
+
+    traverser<Expr> t;
+    evaluator deep;
+    t(chain, deep);
+    XTL_VERIFY(deep.values.size() == 1 && deep.values[0] == 5); // Every Neg cancels the +1 of the Plus below it
+
+    size_t capacity = t.stack().capacity();
+    XTL_VERIFY(capacity >= size_t(depth));
+
+    recorder count;
+    t(chain, count);
+    XTL_VERIFY(t.stack().capacity() == capacity);
+    XTL_VERIFY(count.order.size() >= size_t(4*depth));
+}
+
+//------------------------------------------------------------------------------
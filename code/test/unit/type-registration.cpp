@@ -0,0 +1,163 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that Match statements enroll with mch::type_registry before main()
+/// and that classes registered with mch::register_types are resolved against
+/// them with the same targets and offsets as cache misses would, so that their
+/// first executions on those classes do not miss (#XTL_TYPE_REGISTRATION).
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_TYPE_REGISTRATION 1
+#define XTL_VTBL_STATISTICS   1 // To count classes in vtbl maps
+
+#include <iostream>
+#include "type_switchN-patterns.hpp"
+#include "patterns/constructor.hpp"
+#include "patterns/primitive.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Shape                      { virtual ~Shape() {} };
+struct Named                      { virtual ~Named() {} int tag = 7; };
+struct Circle : Shape             {};
+struct Square : Shape             {};
+struct Label  : Shape, Named      {};                       // Named at a non-zero offset
+struct Sized  : Shape             { Sized(int s) : size(s) {} int size; }; // No default constructor
+struct Wide   : Shape             {};                       // Never registered
+
+struct Node                       { virtual ~Node() {} };
+struct Leaf   : Node              {};
+struct Pair   : Node              { int n = 2; };
+struct Branch : Node              { virtual void f() = 0; }; // Abstract, skipped by registration
+
+namespace mch ///< Mach7 library namespace
+{
+template <> struct class_hierarchy<Node> : classes<Leaf,Pair,Branch> {};
+} // of namespace mch
+
+//------------------------------------------------------------------------------
+
+using mch::C;
+
+int classify(const Shape& s)
+{
+    Match(s)
+    {
+        Case(C<Circle>()) return 1;
+        Case(C<Square>()) return 2;
+        Case(C<Named>())  return 10 + match0.tag; // Cross-cast
+        Case(C<Sized>())  return 100 + match0.size;
+    }
+    EndMatch
+
+    return 0;
+}
+
+int other(const Shape& s)
+{
+    Match(s)
+    {
+        Case(C<Circle>()) return 1;
+        Otherwise()       return 2;
+    }
+    EndMatch
+
+    return 0;
+}
+
+int arity(const Node& n)
+{
+    Match(n)
+    {
+        Case(C<Leaf>()) return 0;
+        Case(C<Pair>()) return match0.n;
+    }
+    EndMatch
+
+    return -1;
+}
+
+//------------------------------------------------------------------------------
+
+/// Total number of classes known to all the vtbl maps
+size_t entries()
+{
+    size_t n = 0;
+    mch::for_each_vtbl_site([&n](const mch::vtbl_site_statistics& s) { n += s.entries; });
+    return n;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    // Statements enrolled before any of them was executed
+    XTL_VERIFY(mch::type_registry<Shape>::sites() == 2);
+    XTL_VERIFY(mch::type_registry<Node>::sites()  == 1);
+
+    mch::register_types<Shape,Circle,Square,Label>();
+    mch::register_object<Shape>(Sized(0));
+    mch::register_types<Node>();                  // Classes of class_hierarchy<Node>
+
+    XTL_VERIFY(mch::type_registry<Shape>::classes() == 4);
+    XTL_VERIFY(mch::type_registry<Node>::classes()  == 2);
+
+    Circle c; Square s; Label l; Sized z(5); Leaf f; Pair p;
+
+    const size_t before = entries();
+
+    XTL_VERIFY(classify(c) == 1);
+    XTL_VERIFY(classify(s) == 2);
+    XTL_VERIFY(classify(l) == 17);
+    XTL_VERIFY(classify(z) == 105);
+    XTL_VERIFY(other(l) == 2);
+    XTL_VERIFY(arity(f) == 0);
+    XTL_VERIFY(arity(p) == 2);
+    XTL_VERIFY(entries() == before);                // Registered classes were known
+
+    Wide w;
+    XTL_VERIFY(classify(w) == 0);
+    XTL_VERIFY(entries() == before + 1);            // Others are learned on a miss
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,157 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that vtbl maps get the memory for their caches through the allocator
+/// installed with mch::vtbl_allocator_hook() while still returning the memory
+/// they got before that to the global heap.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_VTBL_ALLOCATOR 1 // Get memory of vtbl maps through vtbl_allocator_hook()
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include "type_switchN-patterns.hpp"
+#include "patterns/primitive.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Shape            { virtual ~Shape() {} };
+struct Circle : Shape   {};
+struct Oval   : Circle  {};
+struct Square : Shape   {};
+struct Cube   : Square  {};
+
+/// A family of otherwise unrelated classes to make the cache grow
+template <int I> struct Other : Shape {};
+
+template <int I> void make_others(std::vector<Shape*>& shapes) { make_others<I-1>(shapes); shapes.push_back(new Other<I>); }
+template <>      void make_others<0>(std::vector<Shape*>& shapes) { shapes.push_back(new Other<0>); }
+
+//------------------------------------------------------------------------------
+
+/// Stands for an allocator of huge pages or of memory on a given NUMA node
+size_t allocated   = 0;
+size_t deallocated = 0;
+
+void* counting_allocate(size_t size) { ++allocated;   return std::malloc(size); }
+void  counting_deallocate(void* p)   { ++deallocated; std::free(p); }
+
+//------------------------------------------------------------------------------
+
+int expected(const Shape* a)
+{
+    if (dynamic_cast<const Oval*>(a))   return 1;
+    if (dynamic_cast<const Circle*>(a)) return 2;
+    if (dynamic_cast<const Cube*>(a))   return 4;
+    if (dynamic_cast<const Square*>(a)) return 3;
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+int do_match(const Shape* a)
+{
+    mch::var<const Oval&>   o;
+    mch::var<const Circle&> c;
+    mch::var<const Square&> s;
+    mch::var<const Cube&>   q;
+
+    Match(a)
+    {
+    Case(o)    return 1;
+    Case(c)    return 2;
+    Case(q)    return 4;
+    Case(s)    return 3;
+    Otherwise()return 0;
+    }
+    EndMatch
+
+    return -1;
+}
+
+//------------------------------------------------------------------------------
+
+void check(const std::vector<Shape*>& shapes)
+{
+    for (size_t i = 0; i < shapes.size(); ++i)
+        XTL_VERIFY(do_match(shapes[i]) == expected(shapes[i]));
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    std::vector<Shape*> shapes;
+
+    shapes.push_back(new Circle);
+    shapes.push_back(new Oval);
+    shapes.push_back(new Square);
+    shapes.push_back(new Cube);
+
+    // The map of the Match statement may have already been preloaded from the heap
+    check(shapes);
+
+    mch::vtbl_allocator_hook().allocate   = &counting_allocate;
+    mch::vtbl_allocator_hook().deallocate = &counting_deallocate;
+
+    // Growing the cache replaces memory obtained from the heap with ours
+    make_others<40>(shapes);
+
+    for (size_t r = 0; r < 3; ++r)
+        check(shapes);
+
+    std::cout << "Allocated: " << (allocated > 0) << std::endl;
+
+    XTL_VERIFY(deallocated <= allocated);
+
+#if !XTL_VTBL_ARENA
+    // The arena may still have room in the chunk it got from the heap
+    XTL_VERIFY(allocated > 0);
+#endif
+
+    for (size_t i = 0; i < shapes.size(); ++i)
+        delete shapes[i];
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,133 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that Match statements on subjects of a closed hierarchy, switching
+/// on the kinds of subjects, bind the same subobjects as dynamic_cast does,
+/// including in recursive executions of the same statement.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <iostream>
+#include "type_switchN-patterns.hpp"
+#include "patterns/constructor.hpp"
+#include "patterns/primitive.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Tagged { virtual ~Tagged() {} int tag; };
+
+struct Expr
+{
+    enum Kind { K_Value, K_Plus, K_Times, K_Minus };
+    Expr(Kind k) : kind(k) {}
+    virtual ~Expr() {}
+    Kind kind;
+};
+
+struct Value : Expr         { Value(int v)                            : Expr(K_Value), value(v)         {} int value; };
+struct Plus  : Expr         { Plus (const Expr* a, const Expr* b)     : Expr(K_Plus),  exp1(a), exp2(b) {} const Expr* exp1; const Expr* exp2; };
+struct Times : Tagged, Expr { Times(const Expr* a, const Expr* b)     : Expr(K_Times), exp1(a), exp2(b) {} const Expr* exp1; const Expr* exp2; };
+struct Minus : Tagged, Expr { Minus(const Expr* a, const Expr* b)     : Expr(K_Minus), exp1(a), exp2(b) {} const Expr* exp1; const Expr* exp2; };
+
+namespace mch ///< Mach7 library namespace
+{
+template <> struct bindings<Expr>  { KS(Expr::kind); };
+template <> struct bindings<Value> { KV(Expr,Expr::K_Value); Members(Value::value);            };
+template <> struct bindings<Plus>  { KV(Expr,Expr::K_Plus);  Members(Plus::exp1 , Plus::exp2);  };
+template <> struct bindings<Times> { KV(Expr,Expr::K_Times); Members(Times::exp1, Times::exp2); };
+template <> struct bindings<Minus> { KV(Expr,Expr::K_Minus); Members(Minus::exp1, Minus::exp2); };
+
+template <> struct class_hierarchy<Expr> : classes<Value,Plus,Times,Minus> {};
+} // of namespace mch
+
+static_assert(mch::is_closed_hierarchy<Expr>::value, "Expr is declared as a closed hierarchy");
+
+//------------------------------------------------------------------------------
+
+int evaluate(const Expr* e)
+{
+    mch::var<const Expr*> a, b;
+    mch::var<int> n;
+
+    Match(e)
+    {
+    Case(mch::C<Value>(n))    return n;
+    Case(mch::C<Plus>(a,b))   return evaluate(a) + evaluate(b);
+    Case(mch::C<Times>(a,b))  return evaluate(a) * evaluate(b);
+    Otherwise()               return -1000;
+    }
+    EndMatch
+
+    return 0;
+}
+
+/// The same evaluation written by hand with dynamic_cast
+int expected(const Expr* e)
+{
+    if (const Value* p = dynamic_cast<const Value*>(e)) return p->value;
+    if (const Plus*  p = dynamic_cast<const Plus*>(e))  return expected(p->exp1) + expected(p->exp2);
+    if (const Times* p = dynamic_cast<const Times*>(e)) return expected(p->exp1) * expected(p->exp2);
+    return -1000;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    Value v2(2), v3(3), v5(5);
+    Minus m(&v2, &v3);             // Only handled by Otherwise
+    Times t(&v3, &v5);             // Expr subobject is not at offset 0
+    Plus  p1(&v2, &t);
+    Times t2(&p1, &v5);
+    Plus  p2(&t2, &m);
+
+    // Subjects of new kinds are first seen deep in the recursion
+    const Expr* exprs[] = { &p2, &t2, &p1, &t, &m, &v2 };
+    const size_t n = sizeof(exprs)/sizeof(exprs[0]);
+
+    for (size_t r = 0; r < 3; ++r)
+        for (size_t i = 0; i < n; ++i)
+            XTL_VERIFY(evaluate(exprs[i]) == expected(exprs[i]));
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,166 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that compaction of vtbl maps releases memory of Match statements
+/// that are no longer executed and keeps results of all of them correct.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_VTBL_COMPACTION 1 // Allow compacting vtbl maps of Match statements
+
+#include <iostream>
+#include <vector>
+#include "type_switchN-patterns.hpp"
+#include "patterns/primitive.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Shape            { virtual ~Shape() {} };
+struct Circle : Shape   {};
+struct Oval   : Circle  {};
+struct Square : Shape   {};
+struct Cube   : Square  {};
+
+/// A family of otherwise unrelated classes to make the cache grow
+template <int I> struct Other : Shape {};
+
+//------------------------------------------------------------------------------
+
+int expected(const Shape* a)
+{
+    if (dynamic_cast<const Oval*>(a))   return 1;
+    if (dynamic_cast<const Circle*>(a)) return 2;
+    if (dynamic_cast<const Cube*>(a))   return 4;
+    if (dynamic_cast<const Square*>(a)) return 3;
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+/// The same Match statement instantiated at different sites
+template <int I>
+int do_match(const Shape* a)
+{
+    mch::var<const Oval&>   o;
+    mch::var<const Circle&> c;
+    mch::var<const Square&> s;
+    mch::var<const Cube&>   q;
+
+    Match(a)
+    {
+    Case(o)    return 1;
+    Case(c)    return 2;
+    Case(q)    return 4;
+    Case(s)    return 3;
+    Otherwise()return 0;
+    }
+    EndMatch
+
+    return -1;
+}
+
+//------------------------------------------------------------------------------
+
+template <int I>
+void check(const std::vector<Shape*>& shapes)
+{
+    for (size_t i = 0; i < shapes.size(); ++i)
+        XTL_VERIFY(do_match<I>(shapes[i]) == expected(shapes[i]));
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    std::vector<Shape*> shapes;
+
+    shapes.push_back(new Circle);
+    shapes.push_back(new Oval);
+    shapes.push_back(new Square);
+    shapes.push_back(new Cube);
+    shapes.push_back(new Other<0>);
+    shapes.push_back(new Other<1>);
+    shapes.push_back(new Other<2>);
+    shapes.push_back(new Other<3>);
+    shapes.push_back(new Other<4>);
+    shapes.push_back(new Other<5>);
+    shapes.push_back(new Other<6>);
+    shapes.push_back(new Other<7>);
+    shapes.push_back(new Other<8>);
+    shapes.push_back(new Other<9>);
+
+    check<0>(shapes);
+    check<1>(shapes);
+
+    // Within budget: nothing is released, only the epoch ends
+    mch::vtbl_memory_budget() = size_t(~0);
+
+    const size_t before = mch::vtbl_maps_memory_used();
+
+    XTL_VERIFY(mch::compact_vtbl_maps() == 0);
+
+    // Only the first Match statement is executed during this epoch
+    check<0>(shapes);
+
+    // Over budget: the second Match statement loses its entries
+    mch::vtbl_memory_budget() = 0;
+
+    const size_t released = mch::compact_vtbl_maps();
+    const size_t after    = mch::vtbl_maps_memory_used();
+
+    std::cout << "Released: " << (released > 0) << std::endl;
+
+    XTL_VERIFY(released > 0);
+    XTL_VERIFY(after + released == before);
+
+    // Both Match statements still work and the second one learns again
+    for (size_t r = 0; r < 3; ++r)
+    {
+        check<0>(shapes);
+        check<1>(shapes);
+    }
+
+    for (size_t i = 0; i < shapes.size(); ++i)
+        delete shapes[i];
+}
+
+//------------------------------------------------------------------------------
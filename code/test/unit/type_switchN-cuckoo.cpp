@@ -0,0 +1,164 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that vtbl maps and Match statements with two-choice (cuckoo) probing
+/// find values of all the classes they have seen, including when the 
+/// displacements don't succeed and the cache has to grow.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <iostream>
+#include <vector>
+#include "type_switchN-patterns.hpp"
+#include "patterns/primitive.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Shape            { virtual ~Shape() {} };
+struct Circle : Shape   {};
+struct Oval   : Circle  {};
+struct Square : Shape   {};
+struct Cube   : Square  {};
+
+/// A family of otherwise unrelated classes to fill the cache
+template <int I> struct Other : Shape {};
+
+template <int I> void make_others(std::vector<Shape*>& shapes) { make_others<I-1>(shapes); shapes.push_back(new Other<I>); }
+template <>      void make_others<0>(std::vector<Shape*>& shapes) { shapes.push_back(new Other<0>); }
+
+//------------------------------------------------------------------------------
+
+int expected(const Shape* a)
+{
+    if (dynamic_cast<const Oval*>(a))   return 1;
+    if (dynamic_cast<const Circle*>(a)) return 2;
+    if (dynamic_cast<const Cube*>(a))   return 4;
+    if (dynamic_cast<const Square*>(a)) return 3;
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+typedef mch::vtbl_map_policy<mch::cuckoo_probing<> >                  cuckoo_policy;
+typedef mch::vtbl_map_policy<mch::cuckoo_probing<0>,mch::xor_hashing> no_displacement_policy;
+
+//------------------------------------------------------------------------------
+
+#undef  XTL_VTBL_MAP_POLICY
+#define XTL_VTBL_MAP_POLICY cuckoo_policy
+
+int do_match(const Shape* a)
+{
+    mch::var<const Oval&>   o;
+    mch::var<const Circle&> c;
+    mch::var<const Square&> s;
+    mch::var<const Cube&>   q;
+
+    Match(a)
+    {
+    Case(o)    return 1;
+    Case(c)    return 2;
+    Case(q)    return 4;
+    Case(s)    return 3;
+    Otherwise()return 0;
+    }
+    EndMatch
+
+    return -1;
+}
+
+//------------------------------------------------------------------------------
+
+/// Memoizes expected results of shapes and of their pairs in vtbl maps with policy P
+template <typename P>
+void check_map(const std::vector<Shape*>& shapes)
+{
+    const mch::vtbl_count_t clauses = 4; // Keeps a reference to the number of clauses
+    mch::vtbl_map<1,int,P> map1(clauses);
+    mch::vtbl_map<2,int,P> map2(clauses);
+
+    for (size_t r = 0; r < 3; ++r)
+        for (size_t i = 0; i < shapes.size(); ++i)
+        {
+            const Shape* a = shapes[i];
+            int& v1 = map1.get(a);
+
+            if (!v1) v1 = expected(a)+1;
+
+            XTL_VERIFY(v1 == expected(a)+1);
+
+            for (size_t j = 0; j < shapes.size(); j += 3)
+            {
+                const Shape* b = shapes[j];
+                int& v2 = map2.get(a,b);
+
+                if (!v2) v2 = expected(a)*5+expected(b)+1;
+
+                XTL_VERIFY(v2 == expected(a)*5+expected(b)+1);
+            }
+        }
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    std::vector<Shape*> shapes;
+
+    shapes.push_back(new Circle);
+    shapes.push_back(new Oval);
+    shapes.push_back(new Square);
+    shapes.push_back(new Cube);
+    make_others<40>(shapes);
+
+    check_map<cuckoo_policy>(shapes);
+    check_map<no_displacement_policy>(shapes);
+
+    for (size_t r = 0; r < 3; ++r)
+        for (size_t i = 0; i < shapes.size(); ++i)
+            XTL_VERIFY(do_match(shapes[i]) == expected(shapes[i]));
+
+    for (size_t i = 0; i < shapes.size(); ++i)
+        delete shapes[i];
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,254 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that Match statements on two, three and four subjects using vtbl 
+/// maps with #mch::vtbl_curried_policy dispatch correctly, including when 
+/// nested Match statements populate other paths of the outer one, and that 
+/// the maps only keep the tuples of vtbl pointers actually seen.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <iostream>
+#include <set>
+#include <vector>
+#include "type_switchN-patterns.hpp"
+#include "vtblcurried.hpp"
+#include "patterns/primitive.hpp"
+
+#undef  XTL_VTBL_MAP_POLICY
+#define XTL_VTBL_MAP_POLICY mch::vtbl_curried_policy<>
+
+//------------------------------------------------------------------------------
+
+struct Shape            { virtual ~Shape() {} };
+struct Circle : Shape   {};
+struct Oval   : Circle  {};
+struct Square : Shape   {};
+struct Cube   : Square  {};
+
+/// A family of otherwise unrelated classes to populate more paths
+template <int I> struct Other : Shape {};
+
+template <int I> void make_others(std::vector<Shape*>& shapes) { make_others<I-1>(shapes); shapes.push_back(new Other<I>); }
+template <>      void make_others<0>(std::vector<Shape*>& shapes) { shapes.push_back(new Other<0>); }
+
+//------------------------------------------------------------------------------
+
+/// Matches pairs, recursing into itself on other pairs before it's done
+int match2(const Shape* a, const Shape* b, const std::vector<Shape*>& shapes, size_t depth)
+{
+    mch::var<const Circle&> c1, c2;
+    mch::var<const Square&> s1, s2;
+    mch::wildcard           _;
+
+    Match(a,b)
+    {
+    Case(c1,c2) return 1;
+    Case(c1,s2) return 2;
+    Case(s1,_)  return 3;
+    Otherwise()
+        // Nested Match statement may populate other paths of the trie
+        if (depth < shapes.size() && match2(shapes[depth], shapes[shapes.size()-1-depth], shapes, depth+1) < 0)
+            return -2;
+
+        return 0;
+    }
+    EndMatch
+
+    return -1;
+}
+
+int expected(const Shape* a, const Shape* b)
+{
+    if (dynamic_cast<const Circle*>(a) && dynamic_cast<const Circle*>(b)) return 1;
+    if (dynamic_cast<const Circle*>(a) && dynamic_cast<const Square*>(b)) return 2;
+    if (dynamic_cast<const Square*>(a))                                   return 3;
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+int match3(const Shape* a, const Shape* b, const Shape* c)
+{
+    mch::var<const Circle&> c1, c2, c3;
+    mch::var<const Cube&>   q3;
+    mch::wildcard           _;
+
+    Match(a,b,c)
+    {
+    Case(c1,c2,c3) return 3;
+    Case(c1,c2,q3) return 4;
+    Case(c1,c2,_)  return 2;
+    Case(c1,_,_)   return 1;
+    Otherwise()    return 0;
+    }
+    EndMatch
+
+    return -1;
+}
+
+int expected(const Shape* a, const Shape* b, const Shape* c)
+{
+    if (!dynamic_cast<const Circle*>(a)) return 0;
+    if (!dynamic_cast<const Circle*>(b)) return 1;
+    if ( dynamic_cast<const Circle*>(c)) return 3;
+    if ( dynamic_cast<const Cube*>(c))   return 4;
+    return 2;
+}
+
+//------------------------------------------------------------------------------
+
+int match4(const Shape* a, const Shape* b, const Shape* c, const Shape* d)
+{
+    mch::var<const Circle&> c1, c2, c3, c4;
+    mch::var<const Square&> s4;
+    mch::wildcard           _;
+
+    Match(a,b,c,d)
+    {
+    Case(c1,c2,c3,c4) return 4;
+    Case(c1,_,c3,s4)  return 3;
+    Case(_,_,_,c4)    return 1;
+    Otherwise()       return 0;
+    }
+    EndMatch
+
+    return -1;
+}
+
+int expected(const Shape* a, const Shape* b, const Shape* c, const Shape* d)
+{
+    bool ca = dynamic_cast<const Circle*>(a) != 0;
+    bool cb = dynamic_cast<const Circle*>(b) != 0;
+    bool cc = dynamic_cast<const Circle*>(c) != 0;
+    bool cd = dynamic_cast<const Circle*>(d) != 0;
+    bool sd = dynamic_cast<const Square*>(d) != 0;
+
+    if (ca && cb && cc && cd) return 4;
+    if (ca && cc && sd)       return 3;
+    if (cd)                   return 1;
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+/// Collects the tuples of vtbl pointers in a map
+struct collect
+{
+    collect(std::set<std::vector<intptr_t> >& tuples) : tuples(tuples) {}
+
+    template <size_t N, typename T>
+    void operator()(const intptr_t (&vtbl)[N], const T&) const { tuples.insert(std::vector<intptr_t>(&vtbl[0], &vtbl[N])); }
+
+    std::set<std::vector<intptr_t> >& tuples;
+};
+
+/// Checks that a map with the curried policy keeps exactly the tuples looked
+/// up in it and that its memory only grows with the paths populated
+void check_map(const std::vector<Shape*>& shapes)
+{
+    static const mch::vtbl_count_t clauses = 4;
+    mch::vtbl_map<3,int,mch::vtbl_curried_policy<> > map(clauses);
+    std::set<std::vector<intptr_t> > seen;
+    size_t memory = map.memory_used();
+
+    // Sparse: each class meets only two others in the remaining positions
+    for (size_t i = 0; i < shapes.size(); ++i)
+    {
+        const Shape* b = shapes[(i+1) % shapes.size()];
+        const Shape* c = shapes[(i+2) % shapes.size()];
+
+        map.get(shapes[i], b, c) = int(i);
+        map.get(shapes[i], c, b) = int(i);
+        seen.insert({mch::vtbl_of(shapes[i]), mch::vtbl_of(b), mch::vtbl_of(c)});
+        seen.insert({mch::vtbl_of(shapes[i]), mch::vtbl_of(c), mch::vtbl_of(b)});
+
+        XTL_VERIFY(map.memory_used() >= memory);
+
+        memory = map.memory_used();
+    }
+
+    // Repeated lookups find the values stored and populate nothing new
+    for (size_t i = 0; i < shapes.size(); ++i)
+        XTL_VERIFY(map.get(shapes[i], shapes[(i+1) % shapes.size()], shapes[(i+2) % shapes.size()]) == int(i));
+
+    XTL_VERIFY(map.memory_used() == memory);
+
+    std::set<std::vector<intptr_t> > tuples;
+    map.for_each(collect(tuples));
+    XTL_VERIFY(tuples == seen);
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    std::vector<Shape*> shapes;
+
+    shapes.push_back(new Circle);
+    shapes.push_back(new Oval);
+    shapes.push_back(new Square);
+    shapes.push_back(new Cube);
+    make_others<12>(shapes);
+
+    check_map(shapes);
+
+    for (size_t r = 0; r < 2; ++r)
+        for (size_t i = 0; i < shapes.size(); ++i)
+            for (size_t j = 0; j < shapes.size(); ++j)
+            {
+                XTL_VERIFY(match2(shapes[i], shapes[j], shapes, 0) == expected(shapes[i], shapes[j]));
+
+                for (size_t k = 0; k < shapes.size(); ++k)
+                {
+                    XTL_VERIFY(match3(shapes[i], shapes[j], shapes[k]) == expected(shapes[i], shapes[j], shapes[k]));
+
+                    for (size_t l = 0; l < shapes.size(); l += 3)
+                        XTL_VERIFY(match4(shapes[i], shapes[j], shapes[k], shapes[l]) == expected(shapes[i], shapes[j], shapes[k], shapes[l]));
+                }
+            }
+
+    for (size_t i = 0; i < shapes.size(); ++i)
+        delete shapes[i];
+}
+
+//------------------------------------------------------------------------------
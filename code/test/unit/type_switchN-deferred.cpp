@@ -0,0 +1,183 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that Match statements keep giving correct results while their vtbl
+/// maps defer rearrangements of their caches to mch::rearrange_vtbl_maps(), 
+/// which under multi-threading is called by a helper thread.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_DEFERRED_VTBL_UPDATES 1 // Leave rearrangements to rearrange_vtbl_maps()
+#define XTL_VTBL_STATISTICS       1 // To see the number of updates
+
+#include <iostream>
+#include <vector>
+#include "type_switchN-patterns.hpp"
+#include "patterns/primitive.hpp"
+
+#if XTL_MULTI_THREADING
+#include <atomic>
+#include <thread>
+#endif
+
+//------------------------------------------------------------------------------
+
+struct Shape            { virtual ~Shape() {} };
+struct Circle : Shape   {};
+struct Oval   : Circle  {};
+struct Square : Shape   {};
+struct Cube   : Square  {};
+
+/// A family of otherwise unrelated classes to cause collisions
+template <int I> struct Other : Shape {};
+
+template <int I> void make_others(std::vector<Shape*>& shapes) { make_others<I-1>(shapes); shapes.push_back(new Other<I>); }
+template <>      void make_others<0>(std::vector<Shape*>& shapes) { shapes.push_back(new Other<0>); }
+
+//------------------------------------------------------------------------------
+
+int expected(const Shape* a)
+{
+    if (dynamic_cast<const Oval*>(a))   return 1;
+    if (dynamic_cast<const Circle*>(a)) return 2;
+    if (dynamic_cast<const Cube*>(a))   return 4;
+    if (dynamic_cast<const Square*>(a)) return 3;
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+int do_match(const Shape* a)
+{
+    mch::var<const Oval&>   o;
+    mch::var<const Circle&> c;
+    mch::var<const Square&> s;
+    mch::var<const Cube&>   q;
+
+    Match(a)
+    {
+    Case(o)    return 1;
+    Case(c)    return 2;
+    Case(q)    return 4;
+    Case(s)    return 3;
+    Otherwise()return 0;
+    }
+    EndMatch
+
+    return -1;
+}
+
+//------------------------------------------------------------------------------
+
+void check(const std::vector<Shape*>& shapes, size_t rounds, size_t n = ~size_t(0))
+{
+    for (size_t r = 0; r < rounds; ++r)
+        for (size_t i = 0; i < shapes.size() && i < n; ++i)
+            XTL_VERIFY(do_match(shapes[i]) == expected(shapes[i]));
+}
+
+//------------------------------------------------------------------------------
+
+size_t updates()
+{
+    size_t result = 0;
+    mch::for_each_vtbl_site([&result](const mch::vtbl_site_statistics& s) { result += s.updates; });
+    return result;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    std::vector<Shape*> shapes;
+
+    shapes.push_back(new Circle);
+    shapes.push_back(new Oval);
+    shapes.push_back(new Square);
+    shapes.push_back(new Cube);
+    make_others<60>(shapes);
+
+    size_t rearranged = 0;
+
+    // New classes keep coming in between the collisions of those already seen,
+    // while the rearrangements happen only in between the calls to check()
+    for (size_t n = 1; n <= shapes.size(); ++n)
+    {
+        check(shapes, 3, n);
+
+        const size_t before = updates();
+        const size_t count  = mch::rearrange_vtbl_maps();
+
+        XTL_VERIFY(updates() == before + count);
+
+        rearranged += count;
+    }
+
+    std::cout << "Rearranged: " << (rearranged > 0) << std::endl;
+
+    XTL_VERIFY(rearranged > 0);
+
+    // Nothing is pending right after rearrangement
+    XTL_VERIFY(mch::rearrange_vtbl_maps() == 0);
+
+    check(shapes, 10);
+
+#if XTL_MULTI_THREADING
+    // A helper thread rearranges caches while other threads execute Match
+    std::atomic<bool> done(false);
+    std::thread helper([&done]() { while (!done.load()) mch::rearrange_vtbl_maps(); });
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < 4; ++t)
+        workers.push_back(std::thread([&shapes]() { check(shapes, 100); }));
+
+    for (size_t t = 0; t < workers.size(); ++t)
+        workers[t].join();
+
+    done = true;
+    helper.join();
+#endif
+
+    for (size_t i = 0; i < shapes.size(); ++i)
+        delete shapes[i];
+}
+
+//------------------------------------------------------------------------------
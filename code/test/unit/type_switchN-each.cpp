@@ -0,0 +1,161 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks MatchEach statements and batch lookups in vtbl maps against the
+/// results of single-subject Match statements on the same subjects.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <iostream>
+#include <vector>
+#include "type_switchN-patterns.hpp"
+#include "patterns/primitive.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Shape            { virtual ~Shape() {} };
+struct Circle : Shape   {};
+struct Oval   : Circle  {};
+struct Square : Shape   {};
+struct Cube   : Square  {};
+
+/// A family of otherwise unrelated classes to make the cache grow and rearrange
+template <int I> struct Other : Shape {};
+
+//------------------------------------------------------------------------------
+
+int do_match(const Shape* a)
+{
+    mch::var<const Oval&>   o;
+    mch::var<const Circle&> c;
+    mch::var<const Square&> s;
+    mch::var<const Cube&>   q;
+
+    Match(a)
+    {
+    Case(o)    return 1;
+    Case(c)    return 2;
+    Case(q)    return 4;
+    Case(s)    return 3;
+    Otherwise()return 0;
+    }
+    EndMatch
+
+    return -1;
+}
+
+//------------------------------------------------------------------------------
+
+void do_match_each(const Shape* const* shapes, size_t n, std::vector<int>& results)
+{
+    mch::var<const Oval&>   o;
+    mch::var<const Circle&> c;
+    mch::var<const Square&> s;
+    mch::var<const Cube&>   q;
+
+    MatchEach(shapes, n)
+    {
+    Case(o)    results.push_back(1); break;
+    Case(c)    results.push_back(2); break;
+    Case(q)    results.push_back(4); break;
+    Case(s)    results.push_back(3); break;
+    Otherwise()results.push_back(0); break;
+    }
+    EndMatchEach
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    std::vector<const Shape*> shapes;
+
+    // More subjects than XTL_BATCH_SIZE and not a multiple of it, with new 
+    // types showing up in later batches to trigger updates in between.
+    for (size_t i = 0; i < 100; ++i)
+    {
+        switch (i % 13)
+        {
+        case  0: shapes.push_back(new Circle);   break;
+        case  1: shapes.push_back(new Oval);     break;
+        case  2: shapes.push_back(new Square);   break;
+        case  3: shapes.push_back(new Cube);     break;
+        case  4: shapes.push_back(i < 50 ? static_cast<Shape*>(new Oval) : new Other<0>); break;
+        case  5: shapes.push_back(new Other<1>); break;
+        case  6: shapes.push_back(new Other<2>); break;
+        case  7: shapes.push_back(new Other<3>); break;
+        case  8: shapes.push_back(new Other<4>); break;
+        case  9: shapes.push_back(new Other<5>); break;
+        case 10: shapes.push_back(i < 50 ? static_cast<Shape*>(new Cube) : new Other<6>); break;
+        case 11: shapes.push_back(new Other<7>); break;
+        default: shapes.push_back(new Shape);    break;
+        }
+    }
+
+    const size_t n = shapes.size();
+
+    for (size_t r = 0; r < 3; ++r)
+    {
+        std::vector<int> results;
+        do_match_each(&shapes[0], n, results);
+
+        XTL_VERIFY(results.size() == n);
+
+        for (size_t i = 0; i < results.size(); ++i)
+            XTL_VERIFY(results[i] == do_match(shapes[i]));
+    }
+
+    // Direct use of the batch lookup on a map of our own
+    mch::vtbl_count_t clauses = 1;
+    mch::vtbl_map<1,size_t> map(XTL_VTBL_COUNTERS_ONLY(__FILE__,__LINE__,XTL_FUNCTION,)clauses);
+    std::vector<size_t*> values(n);
+
+    map.get_batch(&shapes[0], n, &values[0]);
+
+    for (size_t i = 0; i < n; ++i)
+        XTL_VERIFY(values[i] == &map.get(shapes[i]));
+
+    for (size_t i = 0; i < n; ++i)
+        delete shapes[i];
+}
+
+//------------------------------------------------------------------------------
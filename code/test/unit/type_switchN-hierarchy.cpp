@@ -0,0 +1,132 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that Match statements on subjects with a declared class hierarchy
+/// select the same clauses and bind the same subobjects as with dynamic_cast,
+/// including for virtual and repeated bases and for undeclared classes.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_HIERARCHY_INDEX 1 // Resolve cache misses with the declared class hierarchy
+
+#include <iostream>
+#include <vector>
+#include "type_switchN-patterns.hpp"
+#include "patterns/primitive.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Shape                         { virtual ~Shape() {} int s; };
+struct Named                         { virtual ~Named() {} int n; };
+struct Circle : virtual Shape        { int c; };
+struct Oval   : Circle, Named        { int o; };
+struct Square : virtual Shape, Named { int q; };
+struct Both   : Oval, Square         { int b; }; // Named is ambiguous in Both
+struct Cube   : Square               { int k; }; // Not declared below
+
+namespace mch ///< Mach7 library namespace
+{
+template <> struct class_hierarchy<Shape> : classes<Shape,Circle,Oval,Square,Both> {};
+} // of namespace mch
+
+//------------------------------------------------------------------------------
+
+/// Address of the subobject the Match statement is expected to bind
+const void* expected(const Shape* a, int& clause)
+{
+    if (const Oval*   p = dynamic_cast<const Oval*>(a))   { clause = 1; return p; }
+    if (const Named*  p = dynamic_cast<const Named*>(a))  { clause = 2; return p; }
+    if (const Circle* p = dynamic_cast<const Circle*>(a)) { clause = 3; return p; }
+    if (const Square* p = dynamic_cast<const Square*>(a)) { clause = 4; return p; }
+    clause = 0;
+    return a;
+}
+
+//------------------------------------------------------------------------------
+
+const void* do_match(const Shape* a, int& clause)
+{
+    mch::var<const Oval&>   o;
+    mch::var<const Named&>  n;
+    mch::var<const Circle&> c;
+    mch::var<const Square&> q;
+
+    Match(a)
+    {
+    Case(o)     clause = 1; return &static_cast<const Oval&>(o);
+    Case(n)     clause = 2; return &static_cast<const Named&>(n);
+    Case(c)     clause = 3; return &static_cast<const Circle&>(c);
+    Case(q)     clause = 4; return &static_cast<const Square&>(q);
+    Otherwise() clause = 0; return a;
+    }
+    EndMatch
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    std::vector<Shape*> shapes;
+
+    shapes.push_back(new Shape);
+    shapes.push_back(new Circle);
+    shapes.push_back(new Oval);
+    shapes.push_back(new Square);
+    shapes.push_back(new Both);
+    shapes.push_back(new Cube);
+
+    for (size_t r = 0; r < 2; ++r)
+        for (size_t i = 0; i < shapes.size(); ++i)
+        {
+            int clause = -1, expected_clause = -2;
+
+            XTL_VERIFY(do_match(shapes[i],clause) == expected(shapes[i],expected_clause));
+            XTL_VERIFY(clause == expected_clause);
+        }
+
+    for (size_t i = 0; i < shapes.size(); ++i)
+        delete shapes[i];
+}
+
+//------------------------------------------------------------------------------
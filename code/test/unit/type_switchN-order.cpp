@@ -0,0 +1,144 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that Match statements resolving cache misses in learned order of
+/// their Case clauses select the same clauses as top to bottom resolution 
+/// when no class derives from target types of two different clauses.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_LEARNED_CASE_ORDER 1 // Try most often selected clauses first on misses
+
+#include <iostream>
+#include <vector>
+#include "type_switchN-patterns.hpp"
+#include "patterns/constructor.hpp"
+#include "patterns/primitive.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Shape { virtual ~Shape() {} };
+
+/// Unrelated classes matched by the clauses, each with its own Case
+template <int I> struct Leaf : Shape { Leaf() : id(I) {} int id; };
+
+/// Classes first seen after the Match statement learned its clauses
+template <int I, int J> struct Derived : Leaf<I> {};
+
+/// Classes no clause matches
+template <int I> struct Other : Shape {};
+
+//------------------------------------------------------------------------------
+
+namespace mch ///< Mach7 library namespace
+{
+template <int I> struct bindings<Leaf<I>> { Members(Leaf<I>::id); };
+} // of namespace mch
+
+//------------------------------------------------------------------------------
+
+int expected(const Shape* a)
+{
+    if (dynamic_cast<const Leaf<0>*>(a)) return 1;
+    if (dynamic_cast<const Leaf<1>*>(a)) return 2;
+    if (dynamic_cast<const Leaf<2>*>(a)) return 3;
+    if (dynamic_cast<const Leaf<3>*>(a)) return 4;
+    if (dynamic_cast<const Leaf<4>*>(a)) return 5;
+    if (dynamic_cast<const Leaf<5>*>(a)) return 6;
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+int do_match(const Shape* a)
+{
+    mch::var<int> n;
+
+    Match(a)
+    {
+    Case(mch::C<Leaf<0>>(n)) return n+1;
+    Case(mch::C<Leaf<1>>(n)) return n+1;
+    Case(mch::C<Leaf<2>>(9)) return -1; // Never matches: falls through to the next clause
+    Case(mch::C<Leaf<2>>(n)) return n+1;
+    Case(mch::C<Leaf<3>>(n)) return n+1;
+    Case(mch::C<Leaf<4>>(n)) return n+1;
+    Case(mch::C<Leaf<5>>(n)) return n+1;
+    Otherwise()              return 0;
+    }
+    EndMatch
+
+    return -1;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    std::vector<Shape*> shapes;
+
+    // The most frequent classes are the last ones in the Match statement
+    shapes.push_back(new Leaf<5>);
+    shapes.push_back(new Leaf<4>);
+    shapes.push_back(new Other<0>);
+    shapes.push_back(new Leaf<3>);
+    shapes.push_back(new Leaf<2>);
+    shapes.push_back(new Leaf<1>);
+    shapes.push_back(new Leaf<0>);
+    shapes.push_back(new Derived<5,0>);
+    shapes.push_back(new Derived<5,1>);
+    shapes.push_back(new Derived<5,2>);
+    shapes.push_back(new Derived<4,0>);
+    shapes.push_back(new Derived<4,1>);
+    shapes.push_back(new Derived<2,0>); // Needs offset and fall through of the learned clause
+    shapes.push_back(new Derived<0,0>);
+    shapes.push_back(new Other<1>);
+
+    // Every class misses the cache only in the first round
+    for (size_t r = 0; r < 3; ++r)
+        for (size_t i = 0; i < shapes.size(); ++i)
+            XTL_VERIFY(do_match(shapes[i]) == expected(shapes[i]));
+
+    for (size_t i = 0; i < shapes.size(); ++i)
+        delete shapes[i];
+}
+
+//------------------------------------------------------------------------------
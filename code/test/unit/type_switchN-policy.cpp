@@ -0,0 +1,192 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that vtbl maps and Match statements give the same results under 
+/// different combinations of probing, hashing and update policies. Match
+/// statements pick their policy with #XTL_VTBL_MAP_POLICY.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <iostream>
+#include <vector>
+#include "type_switchN-patterns.hpp"
+#include "patterns/primitive.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Shape            { virtual ~Shape() {} };
+struct Circle : Shape   {};
+struct Oval   : Circle  {};
+struct Square : Shape   {};
+struct Cube   : Square  {};
+
+/// A family of otherwise unrelated classes to cause collisions
+template <int I> struct Other : Shape {};
+
+//------------------------------------------------------------------------------
+
+int expected(const Shape* a)
+{
+    if (dynamic_cast<const Oval*>(a))   return 1;
+    if (dynamic_cast<const Circle*>(a)) return 2;
+    if (dynamic_cast<const Cube*>(a))   return 4;
+    if (dynamic_cast<const Square*>(a)) return 3;
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+typedef mch::vtbl_map_policy<mch::linear_probing>                                        linear_policy;
+typedef mch::vtbl_map_policy<mch::lcg_probing,mch::xor_hashing>                          xor_policy;
+typedef mch::vtbl_map_policy<mch::linear_probing,mch::xor_hashing,mch::adaptive_update<2,1>> eager_policy;
+typedef mch::vtbl_map_policy<mch::linear_probing,mch::multiplicative_hashing>             fibonacci_policy;
+
+//------------------------------------------------------------------------------
+
+#define MATCH_SHAPE(a)             \
+    mch::var<const Oval&>   o;     \
+    mch::var<const Circle&> c;     \
+    mch::var<const Square&> s;     \
+    mch::var<const Cube&>   q;     \
+                                   \
+    Match(a)                       \
+    {                              \
+    Case(o)    return 1;           \
+    Case(c)    return 2;           \
+    Case(q)    return 4;           \
+    Case(s)    return 3;           \
+    Otherwise()return 0;           \
+    }                              \
+    EndMatch                       \
+                                   \
+    return -1
+
+int match_default(const Shape* a) { MATCH_SHAPE(a); }
+
+#undef  XTL_VTBL_MAP_POLICY
+#define XTL_VTBL_MAP_POLICY linear_policy
+int match_linear(const Shape* a) { MATCH_SHAPE(a); }
+
+#undef  XTL_VTBL_MAP_POLICY
+#define XTL_VTBL_MAP_POLICY xor_policy
+int match_xor(const Shape* a) { MATCH_SHAPE(a); }
+
+#undef  XTL_VTBL_MAP_POLICY
+#define XTL_VTBL_MAP_POLICY eager_policy
+int match_eager(const Shape* a) { MATCH_SHAPE(a); }
+
+#undef  XTL_VTBL_MAP_POLICY
+#define XTL_VTBL_MAP_POLICY fibonacci_policy
+int match_fibonacci(const Shape* a) { MATCH_SHAPE(a); }
+
+#undef  XTL_VTBL_MAP_POLICY
+#define XTL_VTBL_MAP_POLICY mch::vtbl_map_policy<>
+
+//------------------------------------------------------------------------------
+
+/// Memoizes expected results of pairs of shapes in a vtbl map with policy P
+template <typename P>
+void check_map(const std::vector<Shape*>& shapes)
+{
+    const mch::vtbl_count_t clauses = mch::vtbl_count_t(shapes.size()); // Keeps a reference to the number of clauses
+    mch::vtbl_map<1,int,P> map1(clauses);
+    mch::vtbl_map<2,int,P> map2(clauses);
+
+    for (size_t r = 0; r < 3; ++r)
+        for (size_t i = 0; i < shapes.size(); ++i)
+            for (size_t j = 0; j < shapes.size(); ++j)
+            {
+                const Shape* a = shapes[i];
+                const Shape* b = shapes[j];
+                int& v1 = map1.get(a);
+                int& v2 = map2.get(a,b);
+
+                if (!v1) v1 = expected(a)+1;
+                if (!v2) v2 = expected(a)*5+expected(b)+1;
+
+                XTL_VERIFY(v1 == expected(a)+1);
+                XTL_VERIFY(v2 == expected(a)*5+expected(b)+1);
+            }
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    std::vector<Shape*> shapes;
+
+    shapes.push_back(new Circle);
+    shapes.push_back(new Oval);
+    shapes.push_back(new Square);
+    shapes.push_back(new Cube);
+    shapes.push_back(new Other<0>);
+    shapes.push_back(new Other<1>);
+    shapes.push_back(new Other<2>);
+    shapes.push_back(new Other<3>);
+    shapes.push_back(new Other<4>);
+    shapes.push_back(new Other<5>);
+    shapes.push_back(new Other<6>);
+    shapes.push_back(new Other<7>);
+
+    check_map<mch::vtbl_map_policy<> >(shapes);
+    check_map<linear_policy>(shapes);
+    check_map<xor_policy>(shapes);
+    check_map<eager_policy>(shapes);
+    check_map<fibonacci_policy>(shapes);
+
+    for (size_t r = 0; r < 3; ++r)
+        for (size_t i = 0; i < shapes.size(); ++i)
+        {
+            const int e = expected(shapes[i]);
+
+            XTL_VERIFY(match_default(shapes[i])   == e);
+            XTL_VERIFY(match_linear(shapes[i])    == e);
+            XTL_VERIFY(match_xor(shapes[i])       == e);
+            XTL_VERIFY(match_eager(shapes[i])     == e);
+            XTL_VERIFY(match_fibonacci(shapes[i]) == e);
+        }
+
+    for (size_t i = 0; i < shapes.size(); ++i)
+        delete shapes[i];
+}
+
+//------------------------------------------------------------------------------
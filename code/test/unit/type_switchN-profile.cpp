@@ -0,0 +1,162 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Tests saving and loading of what Match statements have learned.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_TYPE_PROFILE 1 // Let Match statements save and load what they learned
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "type_switchN-patterns.hpp"
+#include "patterns/primitive.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Shape            { virtual ~Shape() {} };
+struct Circle : Shape   {};
+struct Oval   : Circle  {};
+struct Square : Shape   {};
+struct Cube   : Square  {};
+
+//------------------------------------------------------------------------------
+
+/// The same logic as in #do_match expressed with explicit dynamic_cast
+int expected(const Shape* a, const Shape* b)
+{
+    if (dynamic_cast<const Oval*>(a)   && dynamic_cast<const Oval*>(b))   return 1;
+    if (dynamic_cast<const Circle*>(a) && dynamic_cast<const Circle*>(b)) return 2;
+    if (dynamic_cast<const Circle*>(a) && dynamic_cast<const Square*>(b)) return 3;
+    if (dynamic_cast<const Cube*>(a)   && dynamic_cast<const Shape*>(b))  return 4;
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+/// Every instantiation has its own vtbl_map, but all of them share the same
+/// file, line, function and static types of subjects and thus the profile.
+template <int I>
+int do_match(const Shape* a, const Shape* b)
+{
+    mch::var<const Oval&>   o;
+    mch::var<const Circle&> c;
+    mch::var<const Square&> s;
+    mch::var<const Cube&>   q;
+    mch::var<const Shape&>  x;
+
+    Match(a,b)
+    {
+    Case(o, o) return 1;
+    Case(c, c) return 2;
+    Case(c, s) return 3;
+    Case(q, x) return 4;
+    Otherwise()return 0;
+    }
+    EndMatch
+
+    return -1;
+}
+
+//------------------------------------------------------------------------------
+
+/// Number of records with jump targets in the profile
+size_t records(const std::string& profile)
+{
+    std::istringstream ss(profile);
+    size_t n = 0;
+
+    for (std::string line; std::getline(ss, line);)
+        n += line.compare(0, 5, "case\t") == 0;
+
+    return n;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    std::vector<Shape*> shapes;
+
+    shapes.push_back(new Shape);
+    shapes.push_back(new Circle);
+    shapes.push_back(new Oval);
+    shapes.push_back(new Square);
+    shapes.push_back(new Cube);
+
+    const size_t n = shapes.size();
+
+    // Learn all combinations in one Match statement and save the profile
+    for (size_t i = 0; i < n; ++i)
+        for (size_t j = 0; j < n; ++j)
+            XTL_VERIFY(do_match<0>(shapes[i],shapes[j]) == expected(shapes[i],shapes[j]));
+
+    std::stringstream saved;
+    mch::type_profile::save(saved);
+    const std::string profile = saved.str();
+
+    // Load it back: the other instantiation should be fully preloaded on its 
+    // first execution since all the type names have been seen already.
+    XTL_VERIFY(mch::type_profile::load(saved));
+
+    XTL_VERIFY(do_match<1>(shapes[0],shapes[0]) == expected(shapes[0],shapes[0]));
+
+    std::stringstream resaved;
+    mch::type_profile::save(resaved);
+
+    std::cout << "Records saved: " << records(profile) << std::endl;
+    std::cout << "Records after preloading: " << records(resaved.str()) << std::endl;
+
+    XTL_VERIFY(records(profile)       ==   n*n);
+    XTL_VERIFY(records(resaved.str()) == 2*n*n);
+
+    for (size_t i = 0; i < n; ++i)
+        for (size_t j = 0; j < n; ++j)
+            XTL_VERIFY(do_match<1>(shapes[i],shapes[j]) == expected(shapes[i],shapes[j]));
+
+    for (size_t i = 0; i < n; ++i)
+        delete shapes[i];
+}
+
+//------------------------------------------------------------------------------
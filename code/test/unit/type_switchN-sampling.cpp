@@ -0,0 +1,135 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that Match statements call the hook of mch::match_sampling_hook() 
+/// on one out of mch::match_sampling_period() executions with their site and
+/// the case clause they executed.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_SAMPLE_MATCH_SITES 1 // Call the hook on sampled executions of Match statements
+
+#include <iostream>
+#include <vector>
+#include "type_switchN-patterns.hpp"
+#include "patterns/primitive.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Shape            { virtual ~Shape() {} };
+struct Circle : Shape   {};
+struct Square : Shape   {};
+
+//------------------------------------------------------------------------------
+
+size_t match_line = 0; ///< Line of the Match statement in do_match()
+
+int do_match(const Shape* a)
+{
+    mch::var<const Circle&> c;
+    mch::var<const Square&> s;
+
+    match_line = __LINE__ + 1;
+    Match(a)
+    {
+    Case(c)     return 1;
+    Case(s)     return 2;
+    Otherwise() return 0;
+    }
+    EndMatch
+
+    return -1;
+}
+
+//------------------------------------------------------------------------------
+
+size_t samples      = 0; ///< Number of times the hook was called
+size_t sample_line  = 0; ///< Line of the Match statement of the last sample
+size_t sample_label = 0; ///< target_label of the last sample
+
+void hook(const mch::match_site& site, size_t target, unsigned long long)
+{
+    ++samples;
+    sample_line  = site.line;
+    sample_label = target;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    Circle circle;
+    Square square;
+
+    // Nothing is sampled without a hook
+    for (size_t i = 0; i < 100; ++i)
+        XTL_VERIFY(do_match(&circle) == 1);
+
+    mch::match_sampling_hook()   = &hook;
+    mch::match_sampling_period() = 10;
+
+    // Countdown set with the default period has to expire first
+    for (size_t i = 0; i < XTL_MATCH_SAMPLING_PERIOD; ++i)
+        XTL_VERIFY(do_match(&circle) == 1);
+
+    samples = 0;
+
+    for (size_t i = 0; i < 1000; ++i)
+        XTL_VERIFY(do_match(&square) == 2);
+
+    std::cout << "Samples: " << samples << std::endl;
+
+    XTL_VERIFY(samples == 1000/10);
+    XTL_VERIFY(sample_line == match_line);
+
+    // Target labels differ for different case clauses
+    const size_t square_label = sample_label;
+
+    for (size_t i = 0; i < 10; ++i)
+        XTL_VERIFY(do_match(&circle) == 1);
+
+    XTL_VERIFY(sample_label != square_label);
+
+    mch::match_sampling_hook() = 0;
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,173 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that per-site statistics of vtbl maps enumerated with 
+/// mch::for_each_vtbl_site() identify their Match statements and account
+/// for every lookup made by them.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_VTBL_STATISTICS 1 // Keep per-site statistics of vtbl maps
+
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include "type_switchN-patterns.hpp"
+#include "patterns/primitive.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Shape            { virtual ~Shape() {} };
+struct Circle : Shape   {};
+struct Square : Shape   {};
+
+/// A family of otherwise unrelated classes to make the cache grow
+template <int I> struct Other : Shape {};
+
+//------------------------------------------------------------------------------
+
+size_t match1_line = 0; ///< Line of the Match statement in match1()
+size_t match2_line = 0; ///< Line of the Match statement in match2()
+
+int match1(const Shape* a)
+{
+    mch::var<const Circle&> c;
+    mch::var<const Square&> s;
+
+    match1_line = __LINE__ + 1;
+    Match(a)
+    {
+    Case(c)     return 1;
+    Case(s)     return 2;
+    Otherwise() return 0;
+    }
+    EndMatch
+
+    return -1;
+}
+
+int match2(const Shape* a, const Shape* b)
+{
+    mch::var<const Circle&> c;
+    mch::wildcard           _;
+
+    match2_line = __LINE__ + 1;
+    Match(a,b)
+    {
+    Case(c,c)   return 1;
+    Case(c,_)   return 2;
+    Otherwise() return 0;
+    }
+    EndMatch
+
+    return -1;
+}
+
+//------------------------------------------------------------------------------
+
+/// Checks statistics of Match statements of this file
+struct checker
+{
+    checker(size_t n1, size_t n2) : lookups1(n1), lookups2(n2), seen(0) {}
+
+    void operator()(const mch::vtbl_site_statistics& s)
+    {
+        if (std::strcmp(s.file, __FILE__) != 0)
+            return;
+
+        ++seen;
+
+        std::cout << s.func << ':' << s.line 
+                  << " N="        << s.subjects
+                  << " entries="  << s.entries
+                  << " hits="     << s.hits
+                  << " misses="   << s.misses
+                  << " ratio="    << s.hit_ratio()
+                  << std::endl;
+
+        const size_t lookups = s.line == match1_line ? lookups1 : lookups2;
+
+        XTL_VERIFY(s.line == match1_line || s.line == match2_line);
+        XTL_VERIFY(s.subjects == size_t(s.line == match1_line ? 1 : 2));
+        XTL_VERIFY(s.hits + s.misses == lookups);
+        XTL_VERIFY(s.entries > 0 && s.entries <= size_t(1) << s.log_size);
+        XTL_VERIFY(s.memory > 0);
+        XTL_VERIFY(s.hit_ratio() >= 0.0 && s.hit_ratio() <= 1.0);
+    }
+
+    size_t lookups1;
+    size_t lookups2;
+    size_t seen;
+};
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    std::vector<Shape*> shapes;
+
+    shapes.push_back(new Circle);
+    shapes.push_back(new Square);
+    shapes.push_back(new Other<0>);
+    shapes.push_back(new Other<1>);
+    shapes.push_back(new Other<2>);
+    shapes.push_back(new Other<3>);
+
+    const size_t rounds = 100;
+
+    for (size_t r = 0; r < rounds; ++r)
+        for (size_t i = 0; i < shapes.size(); ++i)
+        {
+            XTL_VERIFY(match1(shapes[i]) == (i < 2 ? int(i+1) : 0));
+            XTL_VERIFY(match2(shapes[i], shapes[0]) == (i == 0 ? 1 : 0));
+        }
+
+    checker check(rounds*shapes.size(), rounds*shapes.size());
+    mch::for_each_vtbl_site([&check](const mch::vtbl_site_statistics& s) { check(s); });
+
+    XTL_VERIFY(check.seen == 2);
+
+    for (size_t i = 0; i < shapes.size(); ++i)
+        delete shapes[i];
+}
+
+//------------------------------------------------------------------------------
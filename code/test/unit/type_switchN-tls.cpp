@@ -0,0 +1,185 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Same as type_switchN-mt.cpp, but with per-thread front caches enabled.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_MULTI_THREADING    1 // Use multi-threaded vtbl_map in Match statements
+#define XTL_THREAD_LOCAL_CACHE 1 // Front shared vtbl_map with per-thread caches
+
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "type_switchN-patterns.hpp"
+#include "patterns/primitive.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Shape            { virtual ~Shape() {} };
+struct Circle : Shape   {};
+struct Oval   : Circle  {};
+struct Square : Shape   {};
+struct Cube   : Square  {};
+
+/// A family of otherwise unrelated classes to make the cache grow and rearrange
+template <int I> struct Other : Shape {};
+
+//------------------------------------------------------------------------------
+
+/// The same logic as in #do_match expressed with explicit dynamic_cast
+int expected(const Shape* a, const Shape* b)
+{
+    if (dynamic_cast<const Oval*>(a)   && dynamic_cast<const Oval*>(b))   return 1;
+    if (dynamic_cast<const Circle*>(a) && dynamic_cast<const Circle*>(b)) return 2;
+    if (dynamic_cast<const Circle*>(a) && dynamic_cast<const Square*>(b)) return 3;
+    if (dynamic_cast<const Cube*>(a)   && dynamic_cast<const Shape*>(b))  return 4;
+    if (dynamic_cast<const Square*>(a) && dynamic_cast<const Circle*>(b)) return 5;
+    if (dynamic_cast<const Shape*>(a)  && dynamic_cast<const Cube*>(b))   return 6;
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+int do_match(const Shape* a, const Shape* b)
+{
+    mch::var<const Oval&>   o;
+    mch::var<const Circle&> c;
+    mch::var<const Square&> s;
+    mch::var<const Cube&>   q;
+    mch::var<const Shape&>  x;
+
+    Match(a,b)
+    {
+    Case(o, o) return 1;
+    Case(c, c) return 2;
+    Case(c, s) return 3;
+    Case(q, x) return 4;
+    Case(s, c) return 5;
+    Case(x, q) return 6;
+    Otherwise()return 0;
+    }
+    EndMatch
+
+    return -1;
+}
+
+//------------------------------------------------------------------------------
+
+int do_match(const Shape* a)
+{
+    mch::var<const Oval&>   o;
+    mch::var<const Circle&> c;
+    mch::var<const Square&> s;
+    mch::var<const Cube&>   q;
+
+    Match(a)
+    {
+    Case(o)    return 1;
+    Case(c)    return 2;
+    Case(q)    return 4;
+    Case(s)    return 3;
+    Otherwise()return 0;
+    }
+    EndMatch
+
+    return -1;
+}
+
+//------------------------------------------------------------------------------
+
+int expected(const Shape* a)
+{
+    if (dynamic_cast<const Oval*>(a))   return 1;
+    if (dynamic_cast<const Circle*>(a)) return 2;
+    if (dynamic_cast<const Cube*>(a))   return 4;
+    if (dynamic_cast<const Square*>(a)) return 3;
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    std::vector<Shape*> shapes;
+
+    shapes.push_back(new Circle);
+    shapes.push_back(new Oval);
+    shapes.push_back(new Square);
+    shapes.push_back(new Cube);
+    shapes.push_back(new Other<0>);
+    shapes.push_back(new Other<1>);
+    shapes.push_back(new Other<2>);
+    shapes.push_back(new Other<3>);
+    shapes.push_back(new Other<4>);
+    shapes.push_back(new Other<5>);
+    shapes.push_back(new Other<6>);
+    shapes.push_back(new Other<7>);
+
+    const size_t n = shapes.size();
+    std::vector<std::thread> threads;
+
+    // Every thread walks all pairs of subjects in its own order, so that
+    // threads discover new combinations and trigger updates concurrently.
+    for (size_t t = 0; t < 8; ++t)
+        threads.push_back(std::thread([&shapes,n,t]()
+        {
+            for (size_t r = 0; r < 1000; ++r)
+                for (size_t i = 0; i < n*n; ++i)
+                {
+                    size_t k = (i*(2*t+1) + r) % (n*n);
+                    const Shape* a = shapes[k / n];
+                    const Shape* b = shapes[k % n];
+
+                    XTL_VERIFY(do_match(a,b) == expected(a,b));
+                    XTL_VERIFY(do_match(a)   == expected(a));
+                }
+        }));
+
+    for (size_t t = 0; t < threads.size(); ++t)
+        threads[t].join();
+
+    for (size_t i = 0; i < n; ++i)
+        delete shapes[i];
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,171 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that Match statements append records of their executions to the 
+/// buffer of the thread and that mch::match_trace_flush() and 
+/// mch::match_trace_dump() write and print them in the order of executions.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_TRACE_MATCH_SITES 1 // Record executions of Match statements
+#define XTL_TRACE_BUFFER_SIZE 64
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include "type_switchN-patterns.hpp"
+#include "patterns/primitive.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Shape            { virtual ~Shape() {} };
+struct Circle : Shape   {};
+struct Square : Shape   {};
+
+//------------------------------------------------------------------------------
+
+size_t match_line = 0; ///< Line of the Match statement in do_match()
+
+int do_match(const Shape* a, const Shape* b)
+{
+    mch::var<const Circle&> c;
+    mch::var<const Square&> s;
+
+    match_line = __LINE__ + 1;
+    Match(a,b)
+    {
+    Case(c,c)   return 1;
+    Case(c,s)   return 2;
+    Case(s,mch::_) return 3;
+    Otherwise() return 0;
+    }
+    EndMatch
+
+    return -1;
+}
+
+//------------------------------------------------------------------------------
+
+/// Reads records of a file written by mch::match_trace_flush()
+std::vector<mch::match_trace_record> read_trace(const char* path)
+{
+    std::ifstream is(path, std::ios::binary);
+    mch::match_trace_header header;
+    std::vector<mch::match_trace_record> records;
+
+    if (is.read(reinterpret_cast<char*>(&header), sizeof(header)))
+    {
+        records.resize(size_t(header.records));
+
+        if (!records.empty())
+            is.read(reinterpret_cast<char*>(&records[0]), std::streamsize(records.size()*sizeof(records[0])));
+    }
+
+    return records;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    const char* path = "type_switchN-tracing.trace";
+    Circle circle;
+    Square square;
+
+    XTL_VERIFY(do_match(&circle, &circle) == 1);
+    XTL_VERIFY(do_match(&circle, &square) == 2);
+    XTL_VERIFY(do_match(&square, &circle) == 3);
+    XTL_VERIFY(do_match(&circle, &circle) == 1);
+
+    XTL_VERIFY(mch::match_trace_flush(path));
+
+    std::vector<mch::match_trace_record> records = read_trace(path);
+    std::cout << "Records: " << records.size() << std::endl;
+
+    XTL_VERIFY(records.size() == 4);
+    else
+    {
+        const mch::match_trace_site* site = mch::match_trace_log::get().site(records[0].site);
+
+        XTL_VERIFY(site && site->line == match_line);
+
+        // Same case clause for the same types, different for different ones
+        XTL_VERIFY(records[0].target == records[3].target);
+        XTL_VERIFY(records[0].target != records[1].target);
+        XTL_VERIFY(records[1].target != records[2].target);
+
+        // Vtbl pointers of subjects in the order of subjects and time stamps in the order of executions
+        XTL_VERIFY(records[1].vtbl[0] == mch::vtbl_of(&circle));
+        XTL_VERIFY(records[1].vtbl[1] == mch::vtbl_of(&square));
+
+        for (size_t i = 1; i < records.size(); ++i)
+            XTL_VERIFY(records[i].tsc >= records[i-1].tsc);
+    }
+
+    // Classes of subjects are printed by name
+    std::ostringstream os;
+
+    XTL_VERIFY(mch::match_trace_dump(os, path) == 4);
+
+    std::cout << os.str();
+
+    XTL_VERIFY(os.str().find(typeid(Square).name()) != std::string::npos);
+
+    // Flush empties the buffer, which then keeps only the latest records
+    for (size_t i = 0; i < 100; ++i)
+        XTL_VERIFY(do_match(&square, &square) == 3);
+
+    XTL_VERIFY(do_match(&circle, &square) == 2);
+
+    XTL_VERIFY(mch::match_trace_flush(path));
+
+    records = read_trace(path);
+
+    XTL_VERIFY(records.size() == XTL_TRACE_BUFFER_SIZE);
+    XTL_VERIFY(records.back().vtbl[0] == mch::vtbl_of(&circle));
+
+    std::remove(path);
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,148 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that every rearrangement of the cache of a Match statement is timed
+/// and accounted for in mch::vtbl_update_histogram of its site.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_VTBL_UPDATE_HISTOGRAM 1 // Time updates of vtbl maps and keep per-site statistics
+
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include "type_switchN-patterns.hpp"
+#include "patterns/primitive.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Shape            { virtual ~Shape() {} };
+struct Circle : Shape   {};
+struct Square : Shape   {};
+
+/// A family of otherwise unrelated classes to make the cache grow
+template <int I> struct Other : Shape {};
+
+template <int I> void make_others(std::vector<Shape*>& shapes) { make_others<I-1>(shapes); shapes.push_back(new Other<I>); }
+template <>      void make_others<0>(std::vector<Shape*>& shapes) { shapes.push_back(new Other<0>); }
+
+//------------------------------------------------------------------------------
+
+int do_match(const Shape* a)
+{
+    mch::var<const Circle&> c;
+    mch::var<const Square&> s;
+
+    Match(a)
+    {
+    Case(c)     return 1;
+    Case(s)     return 2;
+    Otherwise() return 0;
+    }
+    EndMatch
+
+    return -1;
+}
+
+//------------------------------------------------------------------------------
+
+/// Checks the histogram of the Match statement of this file
+struct checker
+{
+    checker() : seen(0) {}
+
+    void operator()(const mch::vtbl_site_statistics& s)
+    {
+        if (std::strcmp(s.file, __FILE__) != 0)
+            return;
+
+        ++seen;
+
+        const mch::vtbl_update_histogram& h = s.update_costs;
+        size_t total = 0;
+
+        for (size_t b = 0; b < mch::vtbl_update_histogram::buckets; ++b)
+            total += h.bucket[b];
+
+        std::cout << "Updates: "     << (h.count > 0)
+                  << " log size: "   << h.last.new_log_size
+                  << " collisions: " << h.last.collisions_after
+                  << std::endl;
+
+        XTL_VERIFY(h.count > 0);
+        XTL_VERIFY(h.count == s.updates);
+        XTL_VERIFY(total == h.count);
+        XTL_VERIFY(h.last.new_log_size == s.log_size);
+        XTL_VERIFY(h.last.old_log_size <= h.last.new_log_size);
+        XTL_VERIFY(h.last.collisions_after <= s.entries);
+        XTL_VERIFY(h.last.cycles <= h.worst.cycles);
+        XTL_VERIFY(h.worst.cycles <= h.total_cycles);
+        XTL_VERIFY(h.worst.cycles <= h.percentile(1.0));
+    }
+
+    size_t seen;
+};
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    std::vector<Shape*> shapes;
+
+    shapes.push_back(new Circle);
+    shapes.push_back(new Square);
+    make_others<40>(shapes);
+
+    for (size_t r = 0; r < 3; ++r)
+        for (size_t i = 0; i < shapes.size(); ++i)
+            XTL_VERIFY(do_match(shapes[i]) == (i < 2 ? int(i+1) : 0));
+
+    checker check;
+    mch::for_each_vtbl_site([&check](const mch::vtbl_site_statistics& s) { check(s); });
+
+    XTL_VERIFY(check.seen == 1);
+
+    for (size_t i = 0; i < shapes.size(); ++i)
+        delete shapes[i];
+}
+
+//------------------------------------------------------------------------------
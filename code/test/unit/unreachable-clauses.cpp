@@ -0,0 +1,146 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Match statements with clauses that no subject can reach but by falling 
+/// through from preceding ones (\see #XTL_STATIC_REDUNDANCY_CHECKING), and 
+/// checks that such clauses are still taken on fall through, without being 
+/// reported, while others are not affected.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_STATIC_REDUNDANCY_CHECKING 1
+
+#include "type_switchN-patterns.hpp"
+#include "patterns/all.hpp"
+
+#include <iostream>
+
+//------------------------------------------------------------------------------
+
+struct Shape  { virtual ~Shape() {} };
+struct Circle : Shape {};
+struct Square : Shape {};
+struct Disc   : Circle {};
+
+//------------------------------------------------------------------------------
+
+/// Bits of the clauses taken by falling through all of them
+int taken(const Shape& s)
+{
+    using namespace mch;
+
+    int result = 0;
+
+    Match(s)
+    {
+        Case(C<Circle>()) result |= 1;
+        Case(C<Disc>())   result |= 2; // Unreachable but by falling through
+        Case(C<Square>()) result |= 4;
+        Case(C<Shape>())  result |= 8;
+        Case(C<Circle>()) result |= 16; // Unreachable but by falling through
+    }
+    EndMatch
+
+    return result;
+}
+
+/// Clause taken first, with refutable clauses not hiding those that follow
+int first(const Shape& s, int n)
+{
+    using namespace mch;
+
+    var<int> k;
+
+    Match(s, n)
+    {
+        Case(C<Circle>(), 0)             return 1;
+        Case(C<Circle>(), k |= k > 0)    return 2;
+        Case(C<Circle>(), _)             return 3;
+        Case(C<Disc>(),   1)             return 4; // Unreachable
+        Case(C<Shape>(),  k)             return 5;
+        Otherwise()                      return 6; // Unreachable, but not reported
+    }
+    EndMatch
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+typedef mch::subject_pattern<Shape,mch::constr0<Circle,mch::default_layout>> circle;
+typedef mch::subject_pattern<Shape,mch::constr0<Disc,  mch::default_layout>> disc;
+typedef mch::subject_pattern<int,  mch::wildcard>                            any;
+typedef mch::subject_pattern<int,  mch::value<int>>                          zero;
+
+typedef mch::clauses<mch::clause_rank<1>,mch::no_clauses,circle,zero> first_clause;
+typedef mch::clauses<mch::clause_rank<2>,first_clause,   circle,any>  second_clause;
+
+static_assert(!mch::clauses<mch::clause_rank<2>,first_clause, disc,zero>::subsumed, "Refutable clauses do not hide others");
+static_assert( mch::clauses<mch::clause_rank<3>,second_clause,disc,zero>::subsumed, "Disc is a Circle");
+static_assert(!mch::clauses<mch::clause_rank<3>,second_clause,mch::subject_pattern<Shape,mch::constr0<Shape,mch::default_layout>>,any>::subsumed, "Not every Shape is a Circle");
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    Shape  shape;
+    Circle circle;
+    Square square;
+    Disc   disc;
+
+    // Several passes, so that clauses are also taken from the learned entries
+    for (int pass = 0; pass < 3; ++pass)
+    {
+        XTL_VERIFY(taken(shape)  == 8);
+        XTL_VERIFY(taken(circle) == 1+8+16);
+        XTL_VERIFY(taken(square) == 4+8);
+        XTL_VERIFY(taken(disc)   == 1+2+8+16);
+
+        XTL_VERIFY(first(circle, 0) == 1);
+        XTL_VERIFY(first(circle, 7) == 2);
+        XTL_VERIFY(first(disc,  -1) == 3);
+        XTL_VERIFY(first(disc,   1) == 2);
+        XTL_VERIFY(first(square, 1) == 5);
+        XTL_VERIFY(first(shape,  0) == 5);
+    }
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,222 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Matches shapes together with integral and enumeration codes, which the vtbl
+/// map of the Match statement uses as keys next to the vtbl pointers of shapes
+/// (\see #XTL_VALUE_SUBJECT_DISPATCH), and checks that clauses with literal
+/// codes, wildcards, variables and guards are chosen as by a chain of ifs,
+/// including codes that are negative or wider than a pointer. Codes that are
+/// only bound to variables must not grow the map.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_VALUE_SUBJECT_DISPATCH 1
+#define XTL_VTBL_STATISTICS        1 // To see the number of entries
+
+#include "type_switchN-patterns.hpp"
+#include "patterns/all.hpp"
+
+#include <iostream>
+
+//------------------------------------------------------------------------------
+
+struct Shape  { virtual ~Shape() {} };
+struct Circle : Shape {};
+struct Square : Shape {};
+struct Rect   : Shape {};
+
+enum class Color { red, green, blue };
+
+//------------------------------------------------------------------------------
+
+int draw(const Shape& s, int code)
+{
+    using namespace mch;
+
+    var<int> n;
+
+    Match(s, code)
+    {
+        Case(C<Circle>(), 1)          return 11;
+        Case(C<Square>(), 1)          return 21;
+        Case(C<Circle>(), 2)          return 12;
+        Case(C<Shape>(),  n |= n < 0) return -n;
+        Case(C<Square>(), 3)          return 23;
+        Case(C<Circle>(), _)          return 10;
+        Case(C<Shape>(),  n)          return 100 + n;
+    }
+    EndMatch
+
+    return -1;
+}
+
+int draw_chain(const Shape& s, int code)
+{
+    const bool circle = dynamic_cast<const Circle*>(&s) != 0;
+    const bool square = dynamic_cast<const Square*>(&s) != 0;
+
+    if (circle && code == 1) return 11;
+    if (square && code == 1) return 21;
+    if (circle && code == 2) return 12;
+    if (code < 0)            return -code;
+    if (square && code == 3) return 23;
+    if (circle)              return 10;
+    return 100 + code;
+}
+
+//------------------------------------------------------------------------------
+
+int paint(Color c, const Shape& s)
+{
+    using namespace mch;
+
+    Match(c, s)
+    {
+        Case(Color::red,   C<Circle>()) return 1;
+        Case(Color::green, C<Circle>()) return 2;
+        Case(Color::red,   C<Shape>())  return 3;
+        Case(_,            C<Square>()) return 4;
+        Otherwise()                     return 5;
+    }
+    EndMatch
+
+    return -1;
+}
+
+int paint_chain(Color c, const Shape& s)
+{
+    const bool circle = dynamic_cast<const Circle*>(&s) != 0;
+    const bool square = dynamic_cast<const Square*>(&s) != 0;
+
+    if (c == Color::red   && circle) return 1;
+    if (c == Color::green && circle) return 2;
+    if (c == Color::red)             return 3;
+    if (square)                      return 4;
+    return 5;
+}
+
+//------------------------------------------------------------------------------
+
+int measure(const Shape& s, long long code)
+{
+    using namespace mch;
+
+    Match(s, code)
+    {
+        Case(C<Circle>(), 1LL << 61) return 1;
+        Case(C<Circle>(), 0LL)       return 2;
+        Case(C<Circle>(), -1LL)      return 3;
+        Otherwise()                  return 4;
+    }
+    EndMatch
+
+    return -1;
+}
+
+int measure_chain(const Shape& s, long long code)
+{
+    const bool circle = dynamic_cast<const Circle*>(&s) != 0;
+
+    if (circle && code == 1LL << 61) return 1;
+    if (circle && code == 0)         return 2;
+    if (circle && code == -1)        return 3;
+    return 4;
+}
+
+//------------------------------------------------------------------------------
+
+const size_t label_line = __LINE__ + 9; ///< Line of the Match statement below
+
+/// Only binds the code to a variable, so the code is not part of the key
+int label(const Shape& s, int code)
+{
+    using namespace mch;
+
+    var<int> n;
+
+    Match(s, code)
+    {
+        Case(C<Circle>(), n) return n;
+        Otherwise()          return -1;
+    }
+    EndMatch
+
+    return -2;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    Circle circle;
+    Square square;
+    Rect   rect;
+    const Shape* shapes[] = { &circle, &square, &rect };
+
+    // Several passes, so that clauses are also taken from the learned entries
+    for (int pass = 0; pass < 3; ++pass)
+        for (size_t i = 0; i < XTL_ARR_SIZE(shapes); ++i)
+        {
+            for (int code = -2; code <= 4; ++code)
+                XTL_VERIFY(draw(*shapes[i], code) == draw_chain(*shapes[i], code));
+
+            for (int c = 0; c < 3; ++c)
+                XTL_VERIFY(paint(Color(c), *shapes[i]) == paint_chain(Color(c), *shapes[i]));
+
+            // Codes that only differ in their top bits, or from -1 in the low ones
+            const long long codes[] = { 0, 1LL << 61, 1LL << 62, -1, -1LL << 1, -1LL << 61, 1LL << 32 };
+
+            for (size_t j = 0; j < XTL_ARR_SIZE(codes); ++j)
+                XTL_VERIFY(measure(*shapes[i], codes[j]) == measure_chain(*shapes[i], codes[j]));
+        }
+
+    // One entry per shape, however many codes went through
+    for (int code = 0; code < 1000; ++code)
+        for (size_t i = 0; i < XTL_ARR_SIZE(shapes); ++i)
+            XTL_VERIFY(label(*shapes[i], code) == (i == 0 ? code : -1));
+
+    size_t entries = 0;
+    mch::for_each_vtbl_site([&entries](const mch::vtbl_site_statistics& s) { if (s.line == label_line) entries = s.entries; });
+
+    XTL_VERIFY(entries == XTL_ARR_SIZE(shapes));
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,120 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that binding heavy members by reference does not copy them and that
+/// values computed for the match are moved into variables instead of copied.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <iostream>
+#include <string>
+#include "match.hpp"                // Support for Match statement
+#include "patterns/constructor.hpp" // Support for constructor patterns
+#include "patterns/primitive.hpp"   // Support for primitive patterns
+
+//------------------------------------------------------------------------------
+
+/// A payload that counts its copies
+struct heavy
+{
+    heavy(const char* s = "") : text(s) {}
+    heavy(const heavy& h) : text(h.text) { ++copies; }
+    heavy(heavy&& h) noexcept : text(std::move(h.text)) {}
+    heavy& operator=(const heavy& h) { text = h.text; ++copies; return *this; }
+    heavy& operator=(heavy&& h) noexcept { text = std::move(h.text); return *this; }
+    std::string text;
+    static size_t copies;
+};
+
+size_t heavy::copies = 0;
+
+struct Message          { virtual ~Message() {} };
+struct Request : Message 
+{
+    Request(const char* h, const char* b) : header(h), body(b) {}
+    heavy summary() const { return heavy(header.text.c_str()); } ///< Computed on each call
+    heavy header;
+    heavy body;
+};
+
+namespace mch ///< Mach7 library namespace
+{
+template <> struct bindings<Request> { Members(Request::header, Request::body, Request::summary); };
+} // of namespace mch
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    using namespace mch;
+
+    Request r("GET", "payload");
+    const Message& m = r;
+
+    // By reference: no copies, and the variables refer to the members
+    var<const heavy&> h, b;
+
+    Match(m)
+    {
+      Qua(Request, h, b)
+        XTL_VERIFY(&h.value() == &r.header);
+        XTL_VERIFY(b->text == "payload");
+    }
+    EndMatch
+
+    XTL_VERIFY(heavy::copies == 0);
+
+    // By value: data members are copied, computed values are moved
+    var<heavy> header, summary;
+
+    Match(m)
+    {
+      Qua(Request, header, _, summary)
+        XTL_VERIFY(header.text == "GET");
+        XTL_VERIFY(summary.text == "GET");
+    }
+    EndMatch
+
+    XTL_VERIFY(heavy::copies == 1); // Only the data member
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,169 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks constructor patterns decomposing more than 4 members and Match
+/// statements on more than 4 subjects, some of which are not polymorphic.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <iostream>
+#include "type_switchN-patterns.hpp"
+#include "patterns/constructor.hpp"
+#include "patterns/primitive.hpp"
+
+//------------------------------------------------------------------------------
+
+/// A protocol record with 6 fields
+struct record
+{
+    int      version;
+    int      type;
+    int      flags;
+    unsigned length;
+    unsigned checksum;
+    int      payload;
+};
+
+namespace mch ///< Mach7 library namespace
+{
+template <> struct bindings<record> { Members(record::version, record::type, record::flags, record::length, record::checksum, record::payload); };
+} // of namespace mch
+
+//------------------------------------------------------------------------------
+
+/// Classifies records: 1 - v2 data, 2 - v2 control with flags, 3 - any v1, 0 - other
+int classify(const record& r)
+{
+    using namespace mch;
+
+    wildcard      _;
+    var<int>      f;
+    var<unsigned> n;
+
+    if (C<record>(2,0,_,n,_,_)(r) && n > 0u) return 1;
+    if (C<record>(2,1,f,_,_,_)(r) && f != 0) return 2;
+    if (C<record>(1,_,_,_,_,_)(r))           return 3;
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+/// Binds all 6 members of a record and checks they took the right values
+void check_bindings(const record& r)
+{
+    mch::var<int>      v, t, f, p;
+    mch::var<unsigned> n, c;
+
+    XTL_VERIFY(mch::C<record>(v,t,f,n,c,p)(r));
+    XTL_VERIFY(v == r.version);
+    XTL_VERIFY(t == r.type);
+    XTL_VERIFY(f == r.flags);
+    XTL_VERIFY(n == r.length);
+    XTL_VERIFY(c == r.checksum);
+    XTL_VERIFY(p == r.payload);
+}
+
+//------------------------------------------------------------------------------
+
+struct Shape            { virtual ~Shape() {} };
+struct Circle : Shape   {};
+struct Square : Shape   {};
+
+/// Number of circles among 5 subjects, one of which is not polymorphic
+int circles(const Shape* a, const Shape* b, const record* r, const Shape* c, const Shape* d)
+{
+    mch::var<const Circle&> c1, c2, c3, c4;
+    mch::var<const Shape&>  s1, s2, s3, s4;
+    mch::var<const record&> x;
+
+    Match(a,b,r,c,d)
+    {
+    Case(c1,c2,x,c3,c4) return 4;
+    Case(c1,c2,x,c3,s4) return 3;
+    Case(c1,c2,x,s3,s4) return 2;
+    Case(c1,s2,x,s3,s4) return 1;
+    Case(s1,s2,x,s3,s4) return 0;
+    }
+    EndMatch
+
+    return -1;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    const record records[] = {
+        {2,0,0,16,1,7},
+        {2,0,5, 0,1,7},
+        {2,1,3, 8,2,9},
+        {2,1,0, 8,2,9},
+        {1,4,4, 4,4,4},
+        {3,0,0, 1,0,0}
+    };
+    const int expected[] = {1,0,2,0,3,0};
+
+    for (size_t i = 0; i < sizeof(records)/sizeof(records[0]); ++i)
+    {
+        XTL_VERIFY(classify(records[i]) == expected[i]);
+        check_bindings(records[i]);
+    }
+
+    Circle circle;
+    Square square;
+    const Shape* shapes[] = {&circle, &square};
+
+    for (int i = 0; i < 16; ++i)
+    {
+        const Shape* a = shapes[!(i & 8)];
+        const Shape* b = shapes[!(i & 4)];
+        const Shape* c = shapes[!(i & 2)];
+        const Shape* d = shapes[!(i & 1)];
+        // The clauses only count a prefix of circles
+        const int n = (i & 8) ? (i & 4) ? (i & 2) ? (i & 1) ? 4 : 3 : 2 : 1 : 0;
+
+        for (int r = 0; r < 2; ++r)
+            XTL_VERIFY(circles(a,b,&records[0],c,d) == n);
+    }
+}
+
+//------------------------------------------------------------------------------
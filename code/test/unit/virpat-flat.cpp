@@ -0,0 +1,183 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that pattern trees of virpat.hpp compiled into flat_pattern accept 
+/// the same objects and bind the same values as the trees themselves.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <iostream>
+#include <utility>
+
+//------------------------------------------------------------------------------
+
+template <typename A, typename B>
+std::ostream& operator<<(std::ostream& os, const std::pair<A,B>& p)
+{
+    return os << '(' << p.first << ',' << p.second << ')';
+}
+
+//------------------------------------------------------------------------------
+
+typedef std::pair<double,double> loc;
+
+//------------------------------------------------------------------------------
+
+#include "../time/virpat.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Shape : object
+{
+    virtual bool operator==(const object& obj) const { return typeid(*this) == typeid(obj); }
+    virtual std::ostream& operator>>(std::ostream& os) const { return os << "Shape()"; }
+};
+
+struct Circle : Shape
+{
+    Circle(const loc& c, double r) : center(c), radius(r) {}
+    object_of<loc>    center;
+    object_of<double> radius;
+};
+
+struct Square : Shape
+{
+    Square(const loc& c, double s) : upper_left(c), side(s) {}
+    object_of<loc>    upper_left;
+    object_of<double> side;
+};
+
+/// Circle or square of a shape and a size
+struct Pair : Shape
+{
+    Pair(Shape* a, Shape* b) : a(a), b(b) {}
+    const Shape& first()  const { return *a; }
+    const Shape& second() const { return *b; }
+    const Shape* a;
+    const Shape* b;
+};
+
+namespace mch ///< Mach7 library namespace
+{
+template <> struct bindings<Circle> { Members(Circle::center    , Circle::radius); };
+template <> struct bindings<Square> { Members(Square::upper_left, Square::side);   };
+template <> struct bindings<Pair>   { Members(Pair::first       , Pair::second);   };
+} // of namespace mch
+
+//------------------------------------------------------------------------------
+
+/// Pattern that does not know how to compile itself
+struct small : pattern
+{
+    virtual bool matches(const object& obj) { const double* d = unbox<double>(obj); return d && *d < 10; }
+};
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    std::vector<object*> objects;
+
+    for (int i = 0; i < 40; ++i)
+    {
+        objects.push_back(new Circle(loc(i % 3, 0), i % 7));
+        objects.push_back(new Square(loc(0, i % 2), 2.0 * (i % 5)));
+        objects.push_back(new object_of<unsigned int>(i));
+        objects.push_back(new Pair(new Circle(loc(0,0), i), new Square(loc(0,0), i % 11)));
+    }
+
+    objects.push_back(new Shape);
+
+    wildcard                wc;
+    var_of<loc>             l;
+    var_of<double>          r, d;
+    var_of<unsigned int>    n;
+    value_of<double>        one(1.0);
+    value_of<loc>           origin(loc(0,0));
+    ref_of<Circle>          c;
+    small                   s;
+    equivalence             same_r(r);
+
+    cls_of2<Circle>         unit(wc, one);                      // Unit circles
+    cls_of2<Circle>         circle(l, r);                       // Any circle
+    cls_of2<Square>         at_origin(origin, d);               // Squares at origin
+    p_times_c<unsigned int> even(n, 2u);                        // Halves of even numbers
+    p_plus_c<unsigned int>  pred(n, 3u);
+    c_minus_p<unsigned int> diff(100u, n);
+    cls_of2<Circle>         circle_r(wc, r);
+    cls_of2<Square>         square_r(wc, same_r);
+    cls_of2<Pair>           same(circle_r, square_r);           // Pairs of circle and square of the same size
+    cls_of1<Square>         small_side(wc);
+    cls_of2<Square>         odd(wc, s);                         // Compiled through its virtual call
+
+    pattern* rules[] = {&unit, &circle, &at_origin, &even, &pred, &diff, &same, &small_side, &odd, &c, &wc};
+
+    for (size_t i = 0; i < sizeof(rules)/sizeof(rules[0]); ++i)
+    {
+        flat_pattern flat(*rules[i]);
+
+        for (size_t j = 0; j < objects.size(); ++j)
+        {
+            const bool   t  = rules[i]->matches(*objects[j]);
+            const loc    tl = l; const double tr = r, td = d; const unsigned int tn = n; const Circle* tc = c.m_var;
+            const bool   f  = flat.matches(*objects[j]);
+
+            XTL_VERIFY(t == f);
+
+            if (t)
+            {
+                XTL_VERIFY(tl == l.m_var);
+                XTL_VERIFY(tr == r.m_var);
+                XTL_VERIFY(td == d.m_var);
+                XTL_VERIFY(tn == n.m_var);
+                XTL_VERIFY(tc == c.m_var);
+            }
+        }
+    }
+
+    // Wildcards compile away, other leaves and nodes compile to one step each
+    XTL_VERIFY(flat_pattern(wc).size() == 0);
+    XTL_VERIFY(flat_pattern(unit).size() == 2);
+    XTL_VERIFY(flat_pattern(same).size() == 5);
+}
+
+//------------------------------------------------------------------------------
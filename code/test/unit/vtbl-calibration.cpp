@@ -0,0 +1,113 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that the number of irrelevant bits of vtbl-pointers measured at run
+/// time by mch::vtbl_irrelevant_bits() only drops bits that are 0 in the 
+/// vtbl-pointers of classes unrelated to the probes, and that a vtbl map 
+/// starts hashing vtbl-pointers with that shift and other keys without any.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include <iostream>
+#include "vtblmap4.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Shape            { virtual ~Shape() {} };
+struct Circle : Shape   { virtual void draw() {} };
+struct Square : Shape   { virtual void draw() {} virtual void fill() {} };
+
+/// A family of otherwise unrelated classes with vtbls of different sizes
+template <int I> struct Other : Shape { virtual void f() {} };
+template <int I> struct Wider : Other<I> { virtual void g() {} virtual void h() {} };
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    const size_t bits = mch::vtbl_irrelevant_bits();
+    const std::intptr_t mask = (std::intptr_t(1) << bits) - 1;
+
+    Circle c; Square s; Other<0> o0; Other<1> o1; Wider<0> w0; Wider<1> w1;
+    const Shape* shapes[] = { &c, &s, &o0, &o1, &w0, &w1 };
+
+    // Dropped bits have to be 0 in every vtbl-pointer
+    for (const Shape* p : shapes)
+        XTL_VERIFY((mch::vtbl_of(p) & mask) == 0);
+
+    // Calibration is measured once
+    XTL_VERIFY(mch::vtbl_irrelevant_bits() == bits);
+
+    // The first vtbl-pointer looked up sets the shift of a map on vtbl-pointers
+    static const mch::vtbl_count_t clauses = 1; // Maps keep a reference to it
+    mch::vtbl_map<1,int> vm(clauses);
+
+    for (size_t i = 0; i < sizeof(shapes)/sizeof(shapes[0]); ++i)
+        vm.get(shapes[i]) = int(i);
+
+    XTL_VERIFY(vm.shift(0) >= bits);
+
+    for (size_t i = 0; i < sizeof(shapes)/sizeof(shapes[0]); ++i)
+        XTL_VERIFY(vm.get(shapes[i]) == int(i));
+
+    // Keys that are not aligned as vtbl-pointers are hashed without a shift
+    mch::vtbl_map<1,int> km(clauses);
+    const std::intptr_t first[1] = { 5 };
+    km.get(first) = 5;
+
+    if (bits)
+        XTL_VERIFY(km.shift(0) == 0);
+
+    for (std::intptr_t k = 0; k < 64; ++k)
+    {
+        const std::intptr_t key[1] = { k };
+        km.get(key) = int(k);
+    }
+
+    for (std::intptr_t k = 0; k < 64; ++k)
+    {
+        const std::intptr_t key[1] = { k };
+        XTL_VERIFY(km.get(key) == int(k));
+    }
+
+    std::cout << "Irrelevant vtbl bits: " << bits << " (compile-time guess " << XTL_IRRELEVANT_VTBL_BITS << ')' << std::endl;
+}
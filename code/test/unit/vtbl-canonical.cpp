@@ -0,0 +1,139 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that under XTL_CANONICAL_VTBLS vtbl maps and Match statements give a
+/// copy of a vtbl, as a shared library would have emitted it, the value learned
+/// for the original, while sub-objects of the same class are kept apart.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_CANONICAL_VTBLS 1
+
+#include <algorithm>
+#include <iostream>
+#include "type_switchN.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Shape            { virtual ~Shape() {} };
+struct Circle : Shape   {};
+struct Square : Shape   {};
+
+struct Left             { virtual ~Left()  {} };
+struct Right            { virtual ~Right() {} };
+struct Both : Left, Right {};
+
+//------------------------------------------------------------------------------
+
+/// Number of words of a vtbl of Shape: offset to top, type_info and 2 destructors
+const size_t vtbl_words = 4;
+
+/// Makes s use a copy of its vtbl, the way an object created in another shared
+/// library would use the copy of the vtbl emitted there
+template <typename S>
+void use_vtbl_copy(S& s, intptr_t (&copy)[vtbl_words])
+{
+    const intptr_t* v = reinterpret_cast<const intptr_t*>(mch::vtbl_of(&s));
+    std::copy(v-2, v-2+vtbl_words, copy);
+    *reinterpret_cast<intptr_t*>(&s) = intptr_t(copy+2);
+}
+
+//------------------------------------------------------------------------------
+
+int classify(const Shape* s)
+{
+    Match(s)
+    {
+    Case(Circle) return 1;
+    Case(Square) return 2;
+    Otherwise()  return 0;
+    }
+    EndMatch
+
+    return -1;
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    Circle c, c2; intptr_t circle_copy[vtbl_words];
+    Square s, s2; intptr_t square_copy[vtbl_words];
+    use_vtbl_copy(c2, circle_copy);
+    use_vtbl_copy(s2, square_copy);
+
+    XTL_VERIFY(mch::vtbl_of(&c) != mch::vtbl_of(&c2)); // Copies are distinct vtbls
+    XTL_VERIFY(mch::vtbl_aliases(mch::vtbl_of(&c),mch::vtbl_of(&c2))); // ... of the same class
+    XTL_VERIFY(!mch::vtbl_aliases(mch::vtbl_of(&c),mch::vtbl_of(&s2)));
+
+    Both b;
+    XTL_VERIFY(!mch::vtbl_aliases(mch::vtbl_of(static_cast<Left*>(&b)),mch::vtbl_of(static_cast<Right*>(&b)))); // Different sub-objects
+
+    {
+        const mch::vtbl_count_t clauses = 2;
+        mch::vtbl_map<1,int> map1(clauses);
+        mch::vtbl_map<2,int> map2(clauses);
+
+        map1.get(&c) = 1;
+        map1.get(&s) = 2;
+        map2.get(&c,&s) = 12;
+
+        XTL_VERIFY(map1.get(&c2) == 1); // Copies take values of originals
+        XTL_VERIFY(map1.get(&s2) == 2);
+        XTL_VERIFY(map2.get(&c2,&s2) == 12);
+        XTL_VERIFY(map2.get(&s2,&c2) == 0); // ... but only of the same classes
+        XTL_VERIFY(map2.get(&c,&c2) == 0);
+
+        map1.get(&c2) = 3;                    // Hits stay keyed by vtbl pointers
+        XTL_VERIFY(map1.get(&c) == 1);
+        XTL_VERIFY(map1.get(&c2) == 3);
+    }
+
+    for (size_t r = 0; r < 3; ++r)
+    {
+        XTL_VERIFY(classify(&c)  == 1);
+        XTL_VERIFY(classify(&c2) == 1);
+        XTL_VERIFY(classify(&s2) == 2);
+        XTL_VERIFY(classify(&s)  == 2);
+    }
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,173 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that mch::invalidate_vtbl_range() drops entries of vtbl pointers in
+/// the range from vtbl_map<N,T> of Match statements, leaves the maps without
+/// such entries untouched and keeps results of all of them correct afterwards.
+/// \see memoized_cast-invalidation.cpp for vtblmap<T>
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_VTBL_INVALIDATION 1 // Allow dropping entries of unloaded vtbls
+
+#include <iostream>
+#include "type_switchN-patterns.hpp"
+#include "patterns/constructor.hpp"
+#include "patterns/primitive.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Shape            { virtual ~Shape() {} };
+struct Circle : Shape   {};
+struct Oval   : Circle  {};
+struct Square : Shape   {};
+struct Cube   : Square  {};
+
+/// Range of addresses covering only the vtbl of the dynamic type of s, as if
+/// it was in a shared library about to be unloaded
+inline const void* vtbl_begin(const Shape& s) { return reinterpret_cast<const void*>(mch::vtbl_of(&s)); }
+inline const void* vtbl_end(const Shape& s)   { return reinterpret_cast<const void*>(mch::vtbl_of(&s)+1); }
+
+//------------------------------------------------------------------------------
+
+int expected(const Shape* a)
+{
+    if (dynamic_cast<const Oval*>(a))   return 1;
+    if (dynamic_cast<const Circle*>(a)) return 2;
+    if (dynamic_cast<const Cube*>(a))   return 4;
+    if (dynamic_cast<const Square*>(a)) return 3;
+    return 0;
+}
+
+int expected(const Shape* a, const Shape* b)
+{
+    return expected(a)*10 + expected(b);
+}
+
+//------------------------------------------------------------------------------
+
+/// Match statement on a single subject, which uses vtbl_map<1,T>
+int classify(const Shape* a)
+{
+    Match(a)
+    {
+    Case(mch::C<Oval>())   return 1;
+    Case(mch::C<Circle>()) return 2;
+    Case(mch::C<Cube>())   return 4;
+    Case(mch::C<Square>()) return 3;
+    }
+    EndMatch
+
+    return 0;
+}
+
+/// Match statement on two subjects, which uses vtbl_map<2,T>
+int match2(const Shape* a, const Shape* b)
+{
+    mch::wildcard _;
+
+    Match(a,b)
+    {
+    Case(mch::C<Oval>(),  _) return 10 + classify(b);
+    Case(mch::C<Circle>(),_) return 20 + classify(b);
+    Case(mch::C<Cube>(),  _) return 40 + classify(b);
+    Case(mch::C<Square>(),_) return 30 + classify(b);
+    }
+    EndMatch
+
+    return classify(b);
+}
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    Shape  x;
+    Circle c;
+    Oval   o;
+    Square s;
+    Cube   q;
+
+    const Shape* shapes[] = {&x, &c, &o, &s, &q};
+
+    // Maps that have not seen the class keep their entries in place
+    static const mch::vtbl_count_t clauses = 4;
+    mch::vtbl_map<1,int> untouched(clauses);
+    mch::vtbl_map<1,int> touched(clauses);
+    untouched.get(&s) = 3;
+    touched.get(&s)   = 3;
+    touched.get(&c)   = 2;
+    const int* before = &untouched.get(&s);
+
+    for (size_t r = 0; r < 2; ++r)
+        for (size_t i = 0; i < XTL_ARR_SIZE(shapes); ++i)
+        {
+            XTL_VERIFY(classify(shapes[i]) == expected(shapes[i]));
+
+            for (size_t j = 0; j < XTL_ARR_SIZE(shapes); ++j)
+                XTL_VERIFY(match2(shapes[i], shapes[j]) == expected(shapes[i], shapes[j]));
+        }
+
+    // Circle is in the maps of classify, match2 (with any of 5 classes) and touched
+    XTL_VERIFY(mch::invalidate_vtbl_range(vtbl_begin(c), vtbl_end(c)) == 1+9+1);
+
+    // Nothing left to drop
+    XTL_VERIFY(mch::invalidate_vtbl_range(vtbl_begin(c), vtbl_end(c)) == 0);
+
+    XTL_VERIFY(&untouched.get(&s) == before);
+    XTL_VERIFY(untouched.get(&s) == 3);
+
+    // The entry of Circle is gone, while the others keep their values
+    XTL_VERIFY(touched.get(&c) == 0);
+    XTL_VERIFY(touched.get(&s) == 3);
+
+    for (size_t r = 0; r < 2; ++r)
+        for (size_t i = 0; i < XTL_ARR_SIZE(shapes); ++i)
+        {
+            XTL_VERIFY(classify(shapes[i]) == expected(shapes[i]));
+
+            for (size_t j = 0; j < XTL_ARR_SIZE(shapes); ++j)
+                XTL_VERIFY(match2(shapes[i], shapes[j]) == expected(shapes[i], shapes[j]));
+        }
+}
+
+//------------------------------------------------------------------------------
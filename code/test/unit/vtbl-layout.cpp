@@ -0,0 +1,202 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that layouts of the caches of vtbl maps enumerated with 
+/// mch::for_each_vtbl_layout() agree with the statistics of their sites, 
+/// count the lookups of every tuple of vtbl pointers and that 
+/// mch::write_vtbl_layouts() exports them as JSON (#XTL_VTBL_LAYOUT).
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_VTBL_LAYOUT 1 // Export layouts of vtbl maps
+
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include "type_switchN-patterns.hpp"
+#include "patterns/constructor.hpp"
+#include "patterns/primitive.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Shape            { virtual ~Shape() {} };
+struct Circle : Shape   {};
+struct Square : Shape   {};
+
+/// A family of otherwise unrelated classes to make the cache grow
+template <int I> struct Other : Shape {};
+
+//------------------------------------------------------------------------------
+
+using mch::C;
+
+size_t match1_line = 0; ///< Line of the Match statement in match1()
+
+int match1(const Shape* a)
+{
+    match1_line = __LINE__ + 1;
+    Match(a)
+    {
+    Case(C<Circle>()) return 1;
+    Case(C<Square>()) return 2;
+    Case(C<Shape>())  return 0;
+    }
+    EndMatch
+
+    return -1;
+}
+
+int match2(const Shape* a, const Shape* b)
+{
+    Match(a,b)
+    {
+    Case(C<Circle>(),C<Circle>()) return 1;
+    Case(C<Circle>(),C<Shape>())  return 2;
+    Case(C<Shape>(), C<Shape>())  return 0;
+    }
+    EndMatch
+
+    return -1;
+}
+
+//------------------------------------------------------------------------------
+
+/// Checks layouts of Match statements of this file
+struct checker
+{
+    checker(size_t r, size_t n) : rounds(r), tuples(n), seen(0) {}
+
+    void operator()(const mch::vtbl_site_layout& l)
+    {
+        const mch::vtbl_site_statistics& s = l.statistics;
+
+        if (std::strcmp(s.file, __FILE__) != 0)
+            return;
+
+        ++seen;
+
+        XTL_VERIFY(l.slots == size_t(1) << s.log_size);
+        XTL_VERIFY(l.entries.size() == s.entries);
+        XTL_VERIFY(l.entries.size() == tuples);
+        XTL_VERIFY(l.shifts.size() == s.subjects);
+        XTL_VERIFY(l.used_bits.size() == s.subjects);
+        XTL_VERIFY(l.varying.size() == s.subjects);
+
+        size_t lookups = 0;
+
+        for (size_t i = 0; i < l.entries.size(); ++i)
+        {
+            const mch::vtbl_entry_layout& e = l.entries[i];
+
+            XTL_VERIFY(e.slot < l.slots);
+            XTL_VERIFY(e.home < l.slots);
+            XTL_VERIFY(e.vtbl.size() == s.subjects);
+            XTL_VERIFY((e.probes == 0) == (e.slot == e.home));
+            if (i) XTL_VERIFY(e.slot > l.entries[i-1].slot);
+            XTL_VERIFY(e.lookups == rounds); // Every tuple was looked up once a round
+
+            lookups += e.lookups;
+        }
+
+        XTL_VERIFY(lookups == s.hits + s.misses);
+
+        // Vtbl pointers of different classes differ and at least as many bits
+        // as the log size of the cache are used to index it
+        XTL_VERIFY(l.varying[0] != 0);
+        XTL_VERIFY(l.used_bits[0] != 0);
+
+        if (s.subjects == 1) // Bits below the shift of a single vtbl pointer are irrelevant
+            XTL_VERIFY((l.used_bits[0] & ((intptr_t(1) << l.shifts[0]) - 1)) == 0);
+    }
+
+    size_t rounds;
+    size_t tuples;
+    size_t seen;
+};
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    std::vector<Shape*> shapes;
+
+    shapes.push_back(new Circle);
+    shapes.push_back(new Square);
+    shapes.push_back(new Other<0>);
+    shapes.push_back(new Other<1>);
+    shapes.push_back(new Other<2>);
+    shapes.push_back(new Other<3>);
+
+    const size_t rounds = 10;
+
+    for (size_t r = 0; r < rounds; ++r)
+        for (size_t i = 0; i < shapes.size(); ++i)
+        {
+            XTL_VERIFY(match1(shapes[i]) == (i < 2 ? int(i+1) : 0));
+            XTL_VERIFY(match2(shapes[i], shapes[0]) == (i == 0 ? 1 : 0));
+        }
+
+    checker check(rounds, shapes.size());
+    mch::for_each_vtbl_layout([&check](const mch::vtbl_site_layout& l) { check(l); });
+
+    XTL_VERIFY(check.seen == 2);
+
+    std::ostringstream os;
+    mch::write_vtbl_layouts(os);
+    const std::string json = os.str();
+
+    std::ostringstream line;
+    line << "\"line\":" << match1_line << ',';
+
+    XTL_VERIFY(!json.empty() && json[0] == '[');
+    XTL_VERIFY(json.find(line.str()) != std::string::npos);
+    XTL_VERIFY(json.find("\"occupancy\":\"") != std::string::npos);
+    XTL_VERIFY(json.find("\"table\":[") != std::string::npos);
+
+    std::cout << json;
+
+    for (size_t i = 0; i < shapes.size(); ++i)
+        delete shapes[i];
+}
+
+//------------------------------------------------------------------------------
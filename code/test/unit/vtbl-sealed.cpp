@@ -0,0 +1,201 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that mch::seal_vtbl_maps() keeps results of Match statements correct
+/// in a forked process, which finds the tuples seen before sealing in the 
+/// read-only caches and puts new ones into the overflow maps.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_SEALED_VTBL_MAPS 1 // Allow sealing vtbl maps before fork
+
+#include <iostream>
+#include "type_switchN-patterns.hpp"
+#include "patterns/constructor.hpp"
+#include "patterns/primitive.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+//------------------------------------------------------------------------------
+
+struct Shape            { virtual ~Shape() {} };
+struct Circle : Shape   {};
+struct Oval   : Circle  {};
+struct Square : Shape   {};
+struct Cube   : Square  {};
+
+//------------------------------------------------------------------------------
+
+int expected(const Shape* a)
+{
+    if (dynamic_cast<const Oval*>(a))   return 1;
+    if (dynamic_cast<const Circle*>(a)) return 2;
+    if (dynamic_cast<const Cube*>(a))   return 4;
+    if (dynamic_cast<const Square*>(a)) return 3;
+    return 0;
+}
+
+int expected(const Shape* a, const Shape* b)
+{
+    return expected(a)*10 + expected(b);
+}
+
+//------------------------------------------------------------------------------
+
+/// Match statement on a single subject, which uses vtbl_map<1,T>
+int classify(const Shape* a)
+{
+    Match(a)
+    {
+    Case(mch::C<Oval>())   return 1;
+    Case(mch::C<Circle>()) return 2;
+    Case(mch::C<Cube>())   return 4;
+    Case(mch::C<Square>()) return 3;
+    }
+    EndMatch
+
+    return 0;
+}
+
+/// Match statement on two subjects, which uses vtbl_map<2,T>
+int match2(const Shape* a, const Shape* b)
+{
+    mch::wildcard _;
+
+    Match(a,b)
+    {
+    Case(mch::C<Oval>(),  _) return 10 + classify(b);
+    Case(mch::C<Circle>(),_) return 20 + classify(b);
+    Case(mch::C<Cube>(),  _) return 40 + classify(b);
+    Case(mch::C<Square>(),_) return 30 + classify(b);
+    }
+    EndMatch
+
+    return classify(b);
+}
+
+/// Checks the results of the Match statements on the first n shapes
+void check(const Shape* const* shapes, size_t n)
+{
+    for (size_t r = 0; r < 2; ++r)
+        for (size_t i = 0; i < n; ++i)
+        {
+            XTL_VERIFY(classify(shapes[i]) == expected(shapes[i]));
+
+            for (size_t j = 0; j < n; ++j)
+                XTL_VERIFY(match2(shapes[i], shapes[j]) == expected(shapes[i], shapes[j]));
+        }
+}
+
+/// Counts tuples of a map
+struct counter
+{
+    explicit counter(size_t& n) : count(n) {}
+    template <size_t N> void operator()(const intptr_t (&)[N], int) const { ++count; }
+    size_t& count;
+};
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    Shape  x;
+    Circle c;
+    Oval   o;
+    Square s;
+    Cube   q;
+
+    // Only the first 3 classes are seen before sealing
+    const Shape* shapes[] = {&x, &c, &o, &s, &q};
+    check(shapes, 3);
+
+    static const mch::vtbl_count_t clauses = 4;
+    mch::vtbl_map<1,int> learned(clauses);
+    mch::vtbl_map<1,int> empty(clauses);
+    learned.get(&c) = 2;
+    learned.get(&o) = 1;
+
+    // The maps of classify, match2 and learned, but not the empty one
+    XTL_VERIFY(mch::seal_vtbl_maps() == 3);
+
+    XTL_VERIFY(learned.is_sealed());
+    XTL_VERIFY(!empty.is_sealed());
+
+    // Nothing left to seal
+    XTL_VERIFY(mch::seal_vtbl_maps() == 0);
+
+    // Sealed values are still there, while a new class goes to the overflow map
+    const size_t memory = learned.memory_used();
+    learned.get(&s) = 3;
+    size_t tuples = 0;
+    learned.for_each(counter(tuples));
+
+    XTL_VERIFY(learned.get(&c) == 2);
+    XTL_VERIFY(learned.get(&o) == 1);
+    XTL_VERIFY(learned.get(&s) == 3);
+    XTL_VERIFY(learned.memory_used() == memory);
+    XTL_VERIFY(tuples == 3);
+
+#if defined(__unix__) || defined(__APPLE__)
+    // A worker sees all the classes, which would crash on a write into the sealed caches
+    pid_t pid = fork();
+
+    if (pid == 0)
+    {
+        check(shapes, XTL_ARR_SIZE(shapes));
+        _exit(0);
+    }
+
+    int status = 0;
+
+    XTL_VERIFY(pid >= 0);
+    XTL_VERIFY(waitpid(pid, &status, 0) == pid);
+    XTL_VERIFY(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+#endif
+
+    check(shapes, XTL_ARR_SIZE(shapes));
+}
+
+//------------------------------------------------------------------------------
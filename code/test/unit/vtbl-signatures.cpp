@@ -0,0 +1,105 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that vtbl-pointers that differ only in the high bits, where arm64e 
+/// keeps their authentication codes, are the same vtbl to vtbl maps when 
+/// those bits are stripped (#XTL_STRIP_VTBL_SIGNATURES). Such pointers are 
+/// emulated here by clearing bits above #XTL_VTBL_ADDRESS_BITS instead.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#define XTL_STRIP_VTBL_SIGNATURES 1
+#define XTL_VTBL_ADDRESS_BITS    48 // User-space addresses of x86-64 and arm64
+#define XTL_VTBL_STATISTICS       1 // To count misses of the vtbl map
+
+#include <iostream>
+#include "vtblmap4.hpp"
+
+//------------------------------------------------------------------------------
+
+struct Shape            { virtual ~Shape() {} };
+struct Circle : Shape   {};
+struct Square : Shape   {};
+
+/// Object whose vtbl-pointer is that of a given object with a signature in 
+/// its high bits. Only its vtbl-pointer is ever read.
+struct signed_object
+{
+    signed_object(const Shape& s, std::intptr_t signature) 
+        : vtbl(*reinterpret_cast<const std::intptr_t*>(&s) | signature << XTL_VTBL_ADDRESS_BITS) {}
+
+    const Shape* as_shape() const { return reinterpret_cast<const Shape*>(this); }
+
+    std::intptr_t vtbl;
+};
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    Circle c;
+    Square s;
+
+    XTL_VERIFY(mch::vtbl_of(signed_object(c, 0x5A).as_shape()) == mch::vtbl_of(&c));
+
+    static const mch::vtbl_count_t clauses = 2; // The map keeps a reference to it
+    mch::vtbl_map<1,int> map(clauses);
+
+    map.get(&c) = 1;
+    map.get(&s) = 2;
+
+    for (std::intptr_t signature = 1; signature < 1 << 15; signature = signature * 3 + 1)
+    {
+        signed_object sc(c, signature);
+        signed_object ss(s, signature ^ 0x7FFF);
+
+        XTL_VERIFY(map.get(sc.as_shape()) == 1);
+        XTL_VERIFY(map.get(ss.as_shape()) == 2);
+    }
+
+    size_t misses = 0;
+    mch::for_each_vtbl_site([&misses](const mch::vtbl_site_statistics& s) { misses += s.misses; });
+
+    XTL_VERIFY(misses == 2); // Only the first lookups of each vtbl
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,91 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library test suite.
+///
+/// Checks that vtblmap<T> keeps the values of 10^5 vtbl pointers once its 
+/// cache outgrows 2^#XTL_MAX_TUNED_LOG_SIZE entries and turns into an open
+/// addressing table, and that references to the values survive the growth.
+/// Objects are words holding fake vtbl pointers, which maps never dereference.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#include "vtblmap3st.hpp"
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <vector>
+
+//------------------------------------------------------------------------------
+
+const size_t n = 100000; ///< Number of classes
+
+//------------------------------------------------------------------------------
+
+int main()
+{
+    std::mt19937 engine(42);
+    std::uniform_int_distribution<size_t> functions(2, 32);
+    std::vector<intptr_t> objects(n);
+    intptr_t address = 0x400000;
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        objects[i] = address + 2*sizeof(void*);
+        address += (2 + functions(engine))*sizeof(void*);
+    }
+
+    std::shuffle(objects.begin(), objects.end(), engine);
+
+    mch::vtblmap<size_t> map;
+    size_t& first = map.get(&objects[0]);
+    first = 1;
+
+    for (size_t i = 1; i < n; ++i)
+        map.get(&objects[i]) = i+1;
+
+    for (size_t i = 0; i < n; ++i)
+        XTL_VERIFY(map.get(&objects[i]) == i+1);
+
+    XTL_VERIFY(&map.get(&objects[0]) == &first);  // Entries never move
+    XTL_VERIFY(map.memory_used() >= n*sizeof(size_t));
+}
+
+//------------------------------------------------------------------------------
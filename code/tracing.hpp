@@ -0,0 +1,465 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file defines a recorder of the sequence of executions of Match 
+/// statements on vtbl pointers: which statement, with which dynamic types of
+/// subjects, which case clause and when, for tuning dispatch on the sequences
+/// seen in production.
+///
+/// \note This file is included by the headers defining Match statements when
+///       #XTL_TRACE_MATCH_SITES is enabled.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#pragma once
+
+// --------------------[ Design Notes ]--------------------
+// - Records have fixed size, so that a ring buffer is an array indexed by the
+//   number of records appended modulo its size, and a file of records can be
+//   mapped into memory and read without parsing.
+// - A record is appended when the Match statement is left, since on the first
+//   execution of the statement for given types its case clause is only known
+//   once a clause has matched. The time stamp is taken on entry, so records of
+//   nested Match statements precede the record of the one containing them.
+// - Each thread appends to its own buffer without synchronization. Buffers are
+//   owned by mch::match_trace_log, so records of finished threads stay until 
+//   flushed. Flushing while other threads execute traced Match statements may
+//   write records they are overwriting at the same time.
+// - Sites are identified by indices given in the order of their first 
+//   execution and subjects by raw vtbl pointers. Both are only meaningful in 
+//   the process that recorded them, which is why mch::match_trace_dump() is 
+//   meant to be called in that process: it maps sites to their file and line
+//   and vtbl pointers to names of classes with vtbl_typeid().
+// - The file is written and read through mmap() on POSIX systems and through
+//   file streams elsewhere.
+//------------------------------------------------------------------------------
+
+#include "config.hpp"
+#include "ptrtools.hpp"    // vtbl_of, vtbl_typeid
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <type_traits>
+#include <vector>
+
+#if XTL_MULTI_THREADING
+#include <mutex>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>         // open
+#include <sys/mman.h>      // mmap
+#include <sys/stat.h>      // fstat
+#include <unistd.h>        // ftruncate, close
+#else
+#include <fstream>
+#include <iterator>
+#endif
+
+#if XTL_MULTI_THREADING && !XTL_SUPPORT(thread_local)
+#error XTL_TRACE_MATCH_SITES with XTL_MULTI_THREADING requires compiler support of thread_local storage duration
+#endif
+
+static_assert((XTL_TRACE_BUFFER_SIZE & (XTL_TRACE_BUFFER_SIZE-1)) == 0, "XTL_TRACE_BUFFER_SIZE has to be a power of 2");
+
+namespace mch ///< Mach7 library namespace
+{
+
+//------------------------------------------------------------------------------
+
+/// One execution of a Match statement
+struct match_trace_record
+{
+    std::uint64_t tsc;                          ///< Time stamp counter on entry into the statement
+    std::uint32_t site;                         ///< Id of the Match statement \see match_trace_site
+    std::uint32_t target;                       ///< Its target_label, i.e. the case clause jumped to
+    std::intptr_t vtbl[XTL_TRACE_MAX_SUBJECTS]; ///< Vtbl pointers of subjects, 0 for non-polymorphic ones and those not there
+};
+
+/// Header of a file written by match_trace_flush(), followed by the records
+struct match_trace_header
+{
+    char          magic[8];    ///< "MACH7TRC"
+    std::uint32_t record_size; ///< sizeof(match_trace_record) of the program that wrote the file
+    std::uint32_t subjects;    ///< #XTL_TRACE_MAX_SUBJECTS of that program
+    std::uint64_t records;     ///< Number of records that follow
+};
+
+//------------------------------------------------------------------------------
+
+/// Match statement whose executions are traced. Its address is unique for 
+/// each Match statement, while its id is unique within the trace.
+struct match_trace_site
+{
+    match_trace_site(const char* fl, size_t ln, const char* fn);
+
+    const char*   file; ///< File of the Match statement
+    size_t        line; ///< Line of the Match statement in that file
+    const char*   func; ///< Function containing the Match statement
+    std::uint32_t id;   ///< Index of the site in the order of first executions
+};
+
+//------------------------------------------------------------------------------
+
+/// Ring buffer of the records of one thread
+struct match_trace_buffer
+{
+    match_trace_buffer() : count(0) {}
+
+    /// Record to fill next, overwriting the oldest one when the buffer is full
+    match_trace_record& next() noexcept { return records[count++ & (XTL_TRACE_BUFFER_SIZE-1)]; }
+
+    /// Number of records the buffer holds
+    size_t size() const noexcept { return count < XTL_TRACE_BUFFER_SIZE ? size_t(count) : size_t(XTL_TRACE_BUFFER_SIZE); }
+
+    /// Copies the records from the oldest to the newest into out and empties
+    /// the buffer. Returns the position after them.
+    char* drain(char* out) noexcept
+    {
+        const size_t n     = size();
+        const size_t first = size_t(count - n) & (XTL_TRACE_BUFFER_SIZE-1); // Oldest record
+        const size_t head  = (std::min)(n, size_t(XTL_TRACE_BUFFER_SIZE) - first);
+
+        std::memcpy(out, &records[first], head*sizeof(match_trace_record));
+        out += head*sizeof(match_trace_record);
+        std::memcpy(out, &records[0], (n-head)*sizeof(match_trace_record));
+        out += (n-head)*sizeof(match_trace_record);
+        count = 0;
+        return out;
+    }
+
+    std::uint64_t      count;                          ///< Number of records appended since the last flush
+    match_trace_record records[XTL_TRACE_BUFFER_SIZE]; ///< The ring
+};
+
+//------------------------------------------------------------------------------
+
+#if XTL_MULTI_THREADING
+typedef std::mutex                  match_trace_mutex;
+typedef std::lock_guard<std::mutex> match_trace_lock;
+#else
+struct match_trace_mutex {};
+struct match_trace_lock { match_trace_lock(match_trace_mutex&) {} };
+#endif
+
+//------------------------------------------------------------------------------
+
+/// Sites and buffers of all the threads that executed traced Match statements
+class match_trace_log
+{
+public:
+
+    /// The log of the program. Sites get it in their constructors, which makes
+    /// it outlive all of them.
+    static match_trace_log& get()
+    {
+        static match_trace_log log;
+        return log;
+    }
+
+    /// Buffer of the calling thread
+    static match_trace_buffer& buffer()
+    {
+    #if XTL_MULTI_THREADING
+        static thread_local match_trace_buffer* b = 0;
+    #else
+        static match_trace_buffer* b = 0;
+    #endif
+
+        if (XTL_UNLIKELY(!b))
+            b = get().add_buffer();
+
+        return *b;
+    }
+
+    /// Gives an id to a Match statement executed for the first time
+    std::uint32_t enroll(const match_trace_site& s)
+    {
+        match_trace_lock guard(mutex);
+        sites.push_back(&s);
+        return std::uint32_t(sites.size()-1);
+    }
+
+    /// Match statement with a given id or nullptr when there is none
+    const match_trace_site* site(std::uint32_t id) const
+    {
+        match_trace_lock guard(mutex);
+        return id < sites.size() ? sites[id] : 0;
+    }
+
+    /// Writes the records of all the buffers into file path and empties them.
+    /// Records of each thread are from the oldest to the newest, those of 
+    /// different threads follow each other.
+    bool flush(const char* path);
+
+    /// Prints records of file path written by flush() in this process, one
+    /// per line: time stamp, file, line and function of the Match statement,
+    /// case clause, and names of the dynamic types of subjects. Returns the 
+    /// number of records printed or 0 when the file cannot be read.
+    size_t dump(std::ostream& os, const char* path) const;
+
+   ~match_trace_log()
+    {
+    #if defined(XTL_TRACE_FILE)
+        flush(XTL_TRACE_FILE);
+    #endif
+
+        for (size_t i = 0; i < buffers.size(); ++i)
+            delete buffers[i];
+    }
+
+private:
+
+    match_trace_log() {}
+    match_trace_log(const match_trace_log&);            ///< No copy constructor
+    match_trace_log& operator=(const match_trace_log&); ///< No assignment operator
+
+    match_trace_buffer* add_buffer()
+    {
+        match_trace_lock guard(mutex);
+        buffers.push_back(new match_trace_buffer);
+        return buffers.back();
+    }
+
+    /// Prints the records of a file mapped into memory at data
+    size_t print(std::ostream& os, const char* data, size_t bytes) const;
+
+    std::vector<const match_trace_site*> sites;   ///< Match statements by id
+    std::vector<match_trace_buffer*>     buffers; ///< Buffers of all the threads
+    mutable match_trace_mutex            mutex;   ///< Guards sites and buffers
+};
+
+//------------------------------------------------------------------------------
+
+inline match_trace_site::match_trace_site(const char* fl, size_t ln, const char* fn) 
+  : file(fl), line(ln), func(fn), id(match_trace_log::get().enroll(*this)) 
+{
+}
+
+//------------------------------------------------------------------------------
+
+inline bool match_trace_log::flush(const char* path)
+{
+    match_trace_lock guard(mutex);
+    match_trace_header header;
+
+    std::memcpy(header.magic, "MACH7TRC", sizeof(header.magic));
+    header.record_size = std::uint32_t(sizeof(match_trace_record));
+    header.subjects    = std::uint32_t(XTL_TRACE_MAX_SUBJECTS);
+    header.records     = 0;
+
+    for (size_t i = 0; i < buffers.size(); ++i)
+        header.records += buffers[i]->size();
+
+    const size_t bytes = sizeof(header) + size_t(header.records)*sizeof(match_trace_record);
+
+#if defined(__unix__) || defined(__APPLE__)
+    const int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+    if (fd < 0)
+        return false;
+
+    void* data = ftruncate(fd, off_t(bytes)) == 0 ? mmap(0, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+
+    if (data == MAP_FAILED)
+        return false;
+#else
+    std::vector<char> image(bytes);
+    char* data = image.data();
+#endif
+
+    char* out = static_cast<char*>(data);
+    std::memcpy(out, &header, sizeof(header));
+    out += sizeof(header);
+
+    for (size_t i = 0; i < buffers.size(); ++i)
+        out = buffers[i]->drain(out);
+
+#if defined(__unix__) || defined(__APPLE__)
+    return munmap(data, bytes) == 0;
+#else
+    std::ofstream os(path, std::ios::binary);
+    os.write(data, std::streamsize(bytes));
+    return bool(os);
+#endif
+}
+
+//------------------------------------------------------------------------------
+
+inline size_t match_trace_log::dump(std::ostream& os, const char* path) const
+{
+#if defined(__unix__) || defined(__APPLE__)
+    const int fd = open(path, O_RDONLY);
+
+    if (fd < 0)
+        return 0;
+
+    struct stat st;
+    const size_t bytes = fstat(fd, &st) == 0 ? size_t(st.st_size) : 0;
+    void* data = bytes ? mmap(0, bytes, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+
+    if (data == MAP_FAILED)
+        return 0;
+
+    const size_t result = print(os, static_cast<const char*>(data), bytes);
+    munmap(data, bytes);
+    return result;
+#else
+    std::ifstream is(path, std::ios::binary);
+    std::vector<char> image((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+    return print(os, image.data(), image.size());
+#endif
+}
+
+//------------------------------------------------------------------------------
+
+inline size_t match_trace_log::print(std::ostream& os, const char* data, size_t bytes) const
+{
+    match_trace_header header;
+
+    if (bytes < sizeof(header))
+        return 0;
+
+    std::memcpy(&header, data, sizeof(header));
+
+    if (std::memcmp(header.magic, "MACH7TRC", sizeof(header.magic)) != 0 ||
+        header.record_size != sizeof(match_trace_record) ||
+        header.subjects    != XTL_TRACE_MAX_SUBJECTS     ||
+        header.records     != (bytes - sizeof(header))/sizeof(match_trace_record))
+        return 0;
+
+    for (size_t i = 0; i < header.records; ++i)
+    {
+        match_trace_record r;
+        std::memcpy(&r, data + sizeof(header) + i*sizeof(r), sizeof(r));
+
+        os << r.tsc << ' ';
+
+        if (const match_trace_site* s = site(r.site))
+            os << s->file << '(' << s->line << ") " << s->func;
+        else
+            os << "site " << r.site;
+
+        os << " case " << r.target;
+
+        for (size_t j = 0; j < XTL_TRACE_MAX_SUBJECTS; ++j)
+            if (r.vtbl[j])
+                os << ' ' << vtbl_typeid(r.vtbl[j]).name();
+
+        os << '\n';
+    }
+
+    return size_t(header.records);
+}
+
+//------------------------------------------------------------------------------
+
+/// Writes the records of all the threads into file path \see match_trace_log::flush
+inline bool match_trace_flush(const char* path) { return match_trace_log::get().flush(path); }
+
+/// Prints records of file path with names of classes \see match_trace_log::dump
+inline size_t match_trace_dump(std::ostream& os, const char* path) { return match_trace_log::get().dump(os, path); }
+
+//------------------------------------------------------------------------------
+
+/// Scope guard that Match statements declare on entry to append a record of
+/// their execution to the buffer of the thread when they are left.
+class match_trace
+{
+public:
+
+    match_trace(const match_trace_site& s) noexcept : target(0), read(0)
+    {
+        record.tsc  = XTL_CYCLE_COUNTER();
+        record.site = s.id;
+        std::fill(&record.vtbl[0], &record.vtbl[XTL_TRACE_MAX_SUBJECTS], std::intptr_t(0));
+    }
+
+   ~match_trace()
+    {
+        record.target = read ? std::uint32_t(read(target)) : 0;
+        match_trace_log::buffer().next() = record;
+    }
+
+    /// Lets the guard read the target label of the Match statement on exit
+    /// and takes vtbl pointers of its subjects
+    template <typename L, typename... S>
+    void observe(const L& label, const S*... subjects) noexcept
+    {
+        target = &label;
+        read   = &read_label<L>;
+        take(0, subjects...);
+    }
+
+private:
+
+    template <typename L>
+    static size_t read_label(const void* label) { return size_t(*static_cast<const L*>(label)); }
+
+    void take(size_t) noexcept {}
+
+    template <typename S, typename... Ss>
+    void take(size_t i, const S* s, const Ss*... ss) noexcept
+    {
+        if (i < XTL_TRACE_MAX_SUBJECTS)
+        {
+            record.vtbl[i] = vtbl_of_subject(s, std::is_polymorphic<S>());
+            take(i+1, ss...);
+        }
+    }
+
+    template <typename S> static std::intptr_t vtbl_of_subject(const S* s, std::true_type)  noexcept { return s ? vtbl_of(s) : 0; }
+    template <typename S> static std::intptr_t vtbl_of_subject(const S*,   std::false_type) noexcept { return 0; }
+
+    match_trace(const match_trace&);            ///< No copy constructor
+    match_trace& operator=(const match_trace&); ///< No assignment operator
+
+    match_trace_record record;              ///< Record being filled
+    const void*        target;              ///< Location of the target label
+    size_t           (*read)(const void*);  ///< Reads label of its actual type from #target
+};
+
+//------------------------------------------------------------------------------
+
+} // of namespace mch
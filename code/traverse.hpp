@@ -0,0 +1,315 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file is a part of Mach7 library.
+///
+/// Traversal of trees of polymorphic nodes without recursion. The driver keeps
+/// nodes to visit on an explicit work stack, so the depth of trees it can walk
+/// is limited by the heap rather than the call stack, and calls hooks of a 
+/// visitor in pre- and post-order:
+/// \code
+///     struct evaluator : mch::traversal_visitor<Expr>
+///     {
+///         // Nodes whose children are visited, in the order of their pushes
+///         void children(const Expr* e, mch::traversal_stack<Expr>& stack)
+///         {
+///             var<const Expr*> x, y;
+///             Match(e)
+///             {
+///                 Case(C<Plus>(x,y))  stack.push(x); stack.push(y); break;
+///                 Case(C<Minus>(x))   stack.push(x);                break;
+///             }
+///             EndMatch
+///         }
+///         // Called once all the children of e have been visited
+///         void post(const Expr* e) { ... }
+///     };
+///
+///     evaluator ev;
+///     mch::traverse(root, ev);
+/// \endcode
+/// Visitor V of nodes of static type S has to provide:
+/// - bool pre(const S*), called before the children of a node are pushed. When
+///   it returns false, the children of the node are not visited.
+/// - void children(const S*, traversal_stack<S>&), pushing children of a node
+///   in the order in which they should be visited. Null children are ignored.
+/// - void post(const S*), called after all the children of a node have been
+///   visited, or right after pre() when it returned false.
+///
+/// mch::traversal_visitor provides defaults for all three: pre() and post() 
+/// do nothing, while children() pushes the members of #bindings of the 
+/// dynamic class of a node that point to S, for which the dynamic classes have
+/// to be declared with #class_hierarchy. Such members of a particular class 
+/// can also be pushed from a Match statement with mch::push_members.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#pragma once
+
+#include "config.hpp"
+#include "hierarchy.hpp"            // Dynamic classes of nodes for push_children
+#include "patterns/constructor.hpp" // Access to members of bindings
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+// --------------------[ Design Notes ]--------------------
+// - Each entry of the work stack is a node and whether its children were 
+//   already pushed. An entry stays on the stack while its subtree is being 
+//   visited and is popped for post() when it surfaces again, so post-order 
+//   needs no second stack.
+// - Children are pushed in the order of visiting and reversed in place, so 
+//   that visitors write them down naturally while the first one is on top.
+// - Every pushed child is prefetched: the first of them is visited next and
+//   the loads of its siblings overlap with visiting its subtree.
+// - A traverser keeps its stack between traversals, so traversing many trees
+//   with the same traverser allocates only until the stack is as deep as the
+//   deepest of them.
+//------------------------------------------------------------------------------
+
+namespace mch ///< Mach7 library namespace
+{
+
+template <typename S> class traverser;
+
+//------------------------------------------------------------------------------
+
+/// Explicit work stack of a traversal of nodes of static type S
+template <typename S>
+class traversal_stack
+{
+public:
+
+    /// Schedules node n to be visited after the other children of the same node
+    /// pushed before it. Null pointers are ignored.
+    void push(const S* n)
+    {
+        if (n)
+        {
+            XTL_PREFETCH(n);
+            m_entries.push_back(entry(n));
+        }
+    }
+
+    void   operator()(const S* n) { push(n); } ///< Makes the stack usable as a function object pushing nodes
+    size_t size()     const { return m_entries.size(); }     ///< Number of nodes on the stack
+    size_t capacity() const { return m_entries.capacity(); } ///< Number of nodes the stack can hold without allocating
+    void   reserve(size_t n)    { m_entries.reserve(n); }    ///< Makes the stack hold n nodes without allocating
+
+private:
+
+    friend class traverser<S>;
+
+    struct entry
+    {
+        explicit entry(const S* n) : node(n), expanded(false) {}
+        const S* node;     ///< Node to visit
+        bool     expanded; ///< Whether pre() was called and the children were pushed
+    };
+
+    std::vector<entry> m_entries; ///< Nodes whose subtrees are being visited or are to be visited
+};
+
+//------------------------------------------------------------------------------
+
+/// Driver of traversals of trees of nodes of static type S with a reusable
+/// work stack. \see traverse.hpp for requirements on visitors.
+template <typename S>
+class traverser
+{
+public:
+
+    /// Visits the tree rooted at root with visitor v
+    template <typename V>
+    void operator()(const S* root, V& v)
+    {
+        std::vector<typename traversal_stack<S>::entry>& s = m_stack.m_entries;
+
+        s.clear(); // Left over by a visitor that threw
+        m_stack.push(root);
+
+        while (!s.empty())
+        {
+            const S* n = s.back().node;
+
+            if (s.back().expanded)
+            {
+                s.pop_back();
+                v.post(n);
+                continue;
+            }
+
+            s.back().expanded = true;
+
+            if (v.pre(n))
+            {
+                std::size_t first = s.size();
+                v.children(n, m_stack);
+                std::reverse(s.begin() + first, s.end()); // The first child on top
+            }
+        }
+    }
+
+    traversal_stack<S>&       stack()       { return m_stack; } ///< Work stack, e.g. to reserve it
+    const traversal_stack<S>& stack() const { return m_stack; } ///< Work stack, e.g. to see its capacity
+
+private:
+    traversal_stack<S> m_stack; ///< Work stack of the current traversal, kept between traversals
+};
+
+//------------------------------------------------------------------------------
+
+/// Visits the tree rooted at root with visitor v \see traverse.hpp
+template <typename S, typename V>
+inline void traverse(const S* root, V&& v)
+{
+    traverser<S> t;
+    t(root, v);
+}
+
+//------------------------------------------------------------------------------
+
+/// Whether bindings B describe the I-th member of decomposition
+template <typename B, size_t I, typename Condition = void> struct has_binding : std::false_type {};
+
+#define XTL_HAS_BINDING(I,...) template <typename B> struct has_binding<B,I,decltype((void)B::member##I())> : std::true_type {};
+XTL_REPEAT(10, XTL_HAS_BINDING, dummy)
+#undef  XTL_HAS_BINDING
+
+/// Pushes value m of a member when it points to S
+template <typename S, typename M, typename F> inline void push_member_value(M&&,   F&,      std::false_type) {}
+template <typename S, typename M, typename F> inline void push_member_value(M&& m, F& push, std::true_type)  { push(static_cast<const S*>(m)); }
+
+/// Pushes the I-th member of t described by bindings B when it points to S
+template <typename S, typename B, size_t I, typename T, typename F>
+inline void push_member(const T& t, F& push)
+{
+    typedef decltype(apply_member(&t, binding_of<B,I>::get())) member_type;
+    push_member_value<S>(apply_member(&t, binding_of<B,I>::get()), push, std::is_convertible<member_type, const S*>());
+}
+
+/// Pushes members I, I+1, ... of t described by bindings B that point to S
+template <typename S, typename B, size_t I, typename T, typename F>
+inline void push_members_from(const T&, F&, std::false_type) {}
+
+template <typename S, typename B, size_t I, typename T, typename F>
+inline void push_members_from(const T& t, F& push, std::true_type)
+{
+    push_member<S,B,I>(t, push);
+    push_members_from<S,B,I+1>(t, push, has_binding<B,I+1>());
+}
+
+//------------------------------------------------------------------------------
+
+/// Pushes members of #bindings of T that point to S, in the order of their 
+/// declaration, onto a traversal stack or into any other function object push.
+/// Intended for case clauses of Match statements in children() of visitors:
+/// \code
+///     Case(C<Plus>()) mch::push_members<Expr>(match0, stack); break;
+/// \endcode
+template <typename S, typename T, typename F>
+inline void push_members(const T& t, F& push)
+{
+    push_members_from<S,bindings<T>,0>(t, push, has_binding<bindings<T>,0>());
+}
+
+//------------------------------------------------------------------------------
+
+#if XTL_RTTI
+
+/// Pushes members of the complete object of class D that point to S
+template <typename S, typename D>
+inline void push_members_of_complete(const void* complete, traversal_stack<S>& stack)
+{
+    push_members<S>(*static_cast<const D*>(complete), stack);
+}
+
+/// Pushes members of node n pointing to S according to #bindings of its dynamic
+/// class among Ds. Nodes of other classes are treated as leaves.
+template <typename S, typename... Ds>
+inline void push_declared_children(const S* n, traversal_stack<S>& stack, const classes<Ds...>*)
+{
+    typedef void (*push_type)(const void*, traversal_stack<S>&);
+    static const push_type table[] = { &push_members_of_complete<S,Ds>... };
+
+    std::size_t i = classes<Ds...>::index_of(typeid(*n));
+
+    if (XTL_LIKELY(i < sizeof...(Ds)))
+        table[i](dynamic_cast<const void*>(n), stack); // Only reads the offset to the complete object from the vtbl
+}
+
+/// Dynamic classes of S were not declared
+template <typename S>
+inline void push_declared_children(const S*, traversal_stack<S>&, const void*)
+{
+    static_assert(class_hierarchy<S>::declared, "Default children() of traversal_visitor<S> needs dynamic classes of S declared with class_hierarchy<S>");
+}
+
+/// Pushes members of node n pointing to S according to #bindings of its dynamic
+/// class, which has to be declared with #class_hierarchy.
+template <typename S>
+inline void push_children(const S* n, traversal_stack<S>& stack)
+{
+    push_declared_children(n, stack, static_cast<const class_hierarchy<S>*>(nullptr));
+}
+
+#endif
+
+//------------------------------------------------------------------------------
+
+/// Base of visitors providing the default hooks \see traverse.hpp
+template <typename S>
+struct traversal_visitor
+{
+    bool pre(const S*)  { return true; } ///< Visits children of every node
+    void post(const S*) {}               ///< Does nothing after children of a node were visited
+
+#if XTL_RTTI
+    /// Visits children found among members of #bindings of the dynamic class of n
+    void children(const S* n, traversal_stack<S>& stack) { push_children(n, stack); }
+#endif
+};
+
+//------------------------------------------------------------------------------
+
+} // of namespace mch
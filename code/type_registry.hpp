@@ -0,0 +1,216 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// \file
+///
+/// This file defines class type_registry<S> through which classes known at 
+/// startup are resolved against all the Match statements on subjects of 
+/// static type S before any of them is executed, so that none of them takes a
+/// cache miss on those classes.
+///
+/// \note This file is not meant to be included directly. It is included by
+///       type_switchN-patterns.hpp when #XTL_TYPE_REGISTRATION is enabled.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#pragma once
+
+// --------------------[ Design Notes ]--------------------
+// - Each Case clause, Otherwise() and EndMatch of a Match statement on a 
+//   single polymorphic subject instantiate a static member of a class 
+//   template, whose initialization before main() enrolls the clause with the
+//   statement and the statement with type_registry<S>. This only depends on
+//   the statement being compiled, not executed.
+// - Vtbl maps are looked up by vtbl pointers, which only objects have, so 
+//   classes are registered through prototype objects. register_types<S,Ds...>
+//   default-constructs one of each Ds and destroys it once all the statements
+//   have been filled with it. Classes without default constructor can be 
+//   registered with register_object().
+// - A statement fills its vtbl map for a prototype the way its first cache 
+//   miss on it would have: the target is the first clause whose target type 
+//   the prototype has. For classes declared with #class_hierarchy of S, the 
+//   conversion to the target type is the static_cast of the hierarchy tables
+//   instead of a dynamic_cast.
+// - Statements are only filled with prototypes registered after they were 
+//   enrolled. Registration is thus meant to happen in main() or later, when
+//   vtbl maps of all the statements have been constructed; prototypes of a
+//   dynamically loaded library's statements are registered after loading it.
+// - Registration is serialized by a mutex and is never on the hot path.
+//------------------------------------------------------------------------------
+
+#include "config.hpp"
+#include "hierarchy.hpp"
+#include <cstddef>
+#include <mutex>
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
+
+namespace mch ///< Mach7 library namespace
+{
+
+//------------------------------------------------------------------------------
+
+/// Registry of Match statements on subjects of static type S and of the 
+/// classes resolved against them at startup
+template <typename S>
+class type_registry
+{
+public:
+
+    /// Fills vtbl map of a Match statement with the jump target for prototype,
+    /// whose class is at position index among the classes declared with 
+    /// #class_hierarchy of S or beyond them when it is not declared there.
+    typedef void (*fill_type)(const S* prototype, std::size_t index);
+
+    /// Remembers Match statement, whose vtbl map is filled by fill
+    static void enroll(fill_type fill)
+    {
+        state& s = get_state();
+        std::lock_guard<std::mutex> guard(s.mutex);
+        s.sites.push_back(fill);
+    }
+
+    /// Fills vtbl maps of all the enrolled Match statements for prototype
+    static void learn(const S* prototype)
+    {
+        state& s = get_state();
+        std::lock_guard<std::mutex> guard(s.mutex);
+        const std::size_t index = index_of(prototype, std::integral_constant<bool,XTL_RTTI && class_hierarchy<S>::declared>());
+
+        for (std::size_t i = 0; i < s.sites.size(); ++i)
+            s.sites[i](prototype, index);
+
+        ++s.classes;
+    }
+
+    /// Number of Match statements enrolled so far
+    static std::size_t sites()   { state& s = get_state(); std::lock_guard<std::mutex> guard(s.mutex); return s.sites.size(); }
+
+    /// Number of prototypes registered so far
+    static std::size_t classes() { state& s = get_state(); std::lock_guard<std::mutex> guard(s.mutex); return s.classes; }
+
+private:
+
+    struct state
+    {
+        state() : classes(0) {}
+        std::mutex             mutex;   ///< Serializes enrollment and registration
+        std::vector<fill_type> sites;   ///< Enrolled Match statements
+        std::size_t            classes; ///< Number of prototypes registered
+    };
+
+    /// Function-local to be usable from initializers of other static objects
+    static state& get_state() { static state s; return s; }
+
+#if XTL_RTTI
+    static std::size_t index_of(const S* p, std::true_type /*declared*/) { return class_hierarchy<S>::index_of(typeid(*p)); }
+#endif
+    static std::size_t index_of(const S*,   std::false_type)             { return unknown_class_index; }
+};
+
+//------------------------------------------------------------------------------
+
+/// Resolves class of prototype against all the Match statements on subjects 
+/// of static type S and fills their vtbl maps with the result
+template <typename S>
+inline void register_object(const S& prototype)
+{
+    type_registry<S>::learn(&prototype);
+}
+
+/// Registers a default-constructed object of D
+template <typename S, typename D>
+inline void register_default(std::true_type /*default constructible*/)
+{
+    const D prototype{};
+    register_object<S>(prototype);
+}
+
+/// Abstract classes and classes without default constructor are skipped
+template <typename S, typename D>
+inline void register_default(std::false_type) {}
+
+/// Registers classes declared with #class_hierarchy of S
+template <typename S, typename... Ds>
+inline void register_declared(const classes<Ds...>*)
+{
+    const int dummy[] = { 0, (register_default<S,Ds>(std::is_default_constructible<Ds>()), 0)... };
+    XTL_UNUSED(dummy);
+}
+
+template <typename S>
+inline void register_declared(const void*)
+{
+    static_assert(class_hierarchy<S>::declared, "Either list classes to register or declare them with class_hierarchy of the static type");
+}
+
+/// Registers classes declared with #class_hierarchy of S when none are listed
+template <typename S>
+inline void register_listed(std::true_type /*none listed*/)
+{
+    register_declared<S>(static_cast<const class_hierarchy<S>*>(nullptr));
+}
+
+/// Registers listed classes Ds
+template <typename S, typename... Ds>
+inline void register_listed(std::false_type)
+{
+    const int dummy[] = { (register_default<S,Ds>(std::true_type()), 0)... };
+    XTL_UNUSED(dummy);
+}
+
+/// Resolves classes Ds against all the Match statements on subjects of static
+/// type S and fills their vtbl maps with the results. Without Ds, the classes
+/// declared with #class_hierarchy of S are registered. Classes are registered
+/// through their default-constructed objects \see register_object.
+/// \code
+///     int main() { mch::register_types<Shape,Circle,Square,Triangle>(); ... }
+/// \endcode
+template <typename S, typename... Ds>
+inline void register_types()
+{
+    static_assert(std::is_polymorphic<S>::value, "Classes can only be registered for Match statements on polymorphic subjects");
+
+    register_listed<S,Ds...>(std::integral_constant<bool,sizeof...(Ds) == 0>());
+}
+
+//------------------------------------------------------------------------------
+
+} // of namespace mch
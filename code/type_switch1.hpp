@@ -126,7 +126,7 @@
                 __switch_info.offset = intptr_t(__casted_ptr)-intptr_t(subject_ptr); \
             }                                                                  \
         case target_label:                                                     \
-            auto& match1 = *adjust_ptr<C>(subject_ptr,__switch_info.offset);   \
+            auto& match1 = *mch::adjust_ptr<C>(subject_ptr,__switch_info.offset); \
             XTL_UNUSED(match1);
 
 #define EndMatch                                                               \
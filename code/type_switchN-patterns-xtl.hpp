@@ -54,30 +54,127 @@
 #include "vtblmap4.hpp"
 #include "metatools.hpp"
 
+#if XTL_SAMPLE_MATCH_SITES
+#include "sampling.hpp"    // Hook called on sampled executions of Match statements
+#endif
+
+#if XTL_REGEX_SETS
+#include "patterns/regex.hpp" // Sets of expressions of rex() clauses
+#endif
+
+#if XTL_USE_MEMOIZED_CAST
+#include "memoized_offsets.hpp" // Memoized offsets of user-defined casts
+#endif
+
 //------------------------------------------------------------------------------
 
+#if XTL_USE_MEMOIZED_CAST
+#define dynamic_cast xtl::memoized_subtype_dynamic_cast
+#else
 #define dynamic_cast xtl::subtype_dynamic_cast
+#endif
 
 namespace mch ///< Mach7 library namespace
 {
 
-    template <typename T, typename S> inline auto adjust_ptr_if_xtl_polymorphic(const S* p, std::ptrdiff_t offset) -> typename std::enable_if< xtl::is_poly_morphic<S>::value,const T*>::type { return  reinterpret_cast<const T*>(reinterpret_cast<const char*>(p)+offset); }
+/// Subjects that hold their value apart from themselves, e.g. boost::any, 
+/// cannot be adjusted by a fixed offset to get to the value. They specialize
+/// this trait with value = true and static functions get<T>(S*) and 
+/// get<T>(const S*) returning their value, which is known to be of type T.
+template <typename S>
+struct indirect_subject
+{
+    static const bool value = false;
+};
+
+} // of namespace mch
+
+#if XTL_USE_MEMOIZED_CAST
+namespace xtl
+{
+    /// Offsets of all target types of subtype_dynamic_cast from S for the vtbl
+    /// of p, kept in the same form as those of memoized_cast
+    template <class S>
+    inline mch::per_source_offsets& subtype_cast_offsets_of(const S* p)
+    {
+        static const mch::vtbl_count_t no_clauses = 0; // The map keeps a reference to it
+        static mch::vtbl_map<1,mch::per_source_offsets> offsets(XTL_VTBL_COUNTERS_ONLY(__FILE__,__LINE__,XTL_FUNCTION,) no_clauses);
+        return offsets.get(p);
+    }
+
+    template <class S, class T>
+    inline S memoized_subtype_dynamic_cast(T* t, std::true_type)
+    {
+        typedef typename mch::cast_target<S>::type target_type;
+        typedef typename std::remove_cv<T>::type   source_type;
+
+        if (XTL_UNLIKELY(!t))
+            return nullptr;
+
+        const size_t ti = mch::specific_to<source_type>::template type_index_of<target_type>();
+        mch::per_source_offsets& offsets = subtype_cast_offsets_of<source_type>(t);
+        const std::ptrdiff_t offset = offsets.get(ti);
+
+        if (XTL_UNLIKELY(offset == mch::unknown_offset))
+        {
+            S s = subtype_dynamic_cast<S>(t);
+            offsets.set(ti, s ? reinterpret_cast<const char*>(s)-reinterpret_cast<const char*>(t) : mch::no_cast_exists);
+            return s;
+        }
+
+        return offset == mch::no_cast_exists ? nullptr : mch::adjust_ptr<target_type>(t, offset);
+    }
+
+    template <class S, class T>
+    inline S memoized_subtype_dynamic_cast(T* t, std::false_type) noexcept { return subtype_dynamic_cast<S>(t); }
+
+    /// Behaves as subtype_dynamic_cast, but memoizes the offsets of casts from
+    /// C++-polymorphic classes per vtbl-pointer and target type the way 
+    /// memoized_cast does, so that a user-defined cast, e.g. QueryInterface of
+    /// a COM-like component model, is called once per dynamic type. Subjects 
+    /// that are not C++-polymorphic or hold their value apart from themselves
+    /// are cast as before. \see #XTL_USE_MEMOIZED_CAST
+    template <class S, class T>
+    inline S memoized_subtype_dynamic_cast(T* t)
+    {
+        return memoized_subtype_dynamic_cast<S>(t, std::integral_constant<bool, std::is_polymorphic<T>::value && !mch::indirect_subject<typename std::remove_cv<T>::type>::value>());
+    }
+} // of namespace xtl
+#endif
+
+namespace mch ///< Mach7 library namespace
+{
+
+    template <typename T, typename S> inline auto adjust_ptr_if_xtl_polymorphic(const S* p, std::ptrdiff_t offset) -> typename std::enable_if< xtl::is_poly_morphic<S>::value && !indirect_subject<S>::value,const T*>::type { return  reinterpret_cast<const T*>(reinterpret_cast<const char*>(p)+offset); }
+    template <typename T, typename S> inline auto adjust_ptr_if_xtl_polymorphic(const S* p, std::ptrdiff_t       ) -> typename std::enable_if< xtl::is_poly_morphic<S>::value &&  indirect_subject<S>::value,const T*>::type { return  indirect_subject<S>::template get<T>(p); }
     template <typename T, typename S> inline auto adjust_ptr_if_xtl_polymorphic(const S* p, std::ptrdiff_t       ) -> typename std::enable_if<!xtl::is_poly_morphic<S>::value,const T*>::type { return  reinterpret_cast<const T*>(reinterpret_cast<const char*>(p)); }
-    template <typename T, typename S> inline auto adjust_ptr_if_xtl_polymorphic(      S* p, std::ptrdiff_t offset) -> typename std::enable_if< xtl::is_poly_morphic<S>::value,      T*>::type { return  reinterpret_cast<      T*>(reinterpret_cast<      char*>(p)+offset); }
+    template <typename T, typename S> inline auto adjust_ptr_if_xtl_polymorphic(      S* p, std::ptrdiff_t offset) -> typename std::enable_if< xtl::is_poly_morphic<S>::value && !indirect_subject<S>::value,      T*>::type { return  reinterpret_cast<      T*>(reinterpret_cast<      char*>(p)+offset); }
+    template <typename T, typename S> inline auto adjust_ptr_if_xtl_polymorphic(      S* p, std::ptrdiff_t       ) -> typename std::enable_if< xtl::is_poly_morphic<S>::value &&  indirect_subject<S>::value,      T*>::type { return  indirect_subject<S>::template get<T>(p); }
     template <typename T, typename S> inline auto adjust_ptr_if_xtl_polymorphic(      S* p, std::ptrdiff_t       ) -> typename std::enable_if<!xtl::is_poly_morphic<S>::value,      T*>::type { return  reinterpret_cast<      T*>(reinterpret_cast<      char*>(p)); }
 
 //------------------------------------------------------------------------------
 
 /// FIX: This specialization doesn't actually help/work as expected as get<UID>
 ///      at the time of this instantiation is not yet set<UID>.
-template <size_t N, typename T, typename UID>
-struct preallocated<vtbl_map<N,T>,UID>
+template <size_t N, typename T, typename P, typename UID>
+struct preallocated<vtbl_map<N,T,P>,UID>
 {
-    static vtbl_map<N,T> value;
+    static vtbl_map<N,T,P> value;
 };
 
-template <size_t N, typename T, typename UID>
-vtbl_map<N,T> preallocated<vtbl_map<N,T>,UID>::value(deferred_constant<vtbl_count_t>::get<UID>::value);
+template <size_t N, typename T, typename P, typename UID>
+XTL_DISPATCH_PLACEMENT vtbl_map<N,T,P> preallocated<vtbl_map<N,T,P>,UID>::value(deferred_constant<vtbl_count_t>::get<UID>::value);
+
+/// Vtbl maps of Match statements with policy hot_dispatch are placed apart 
+/// from the others, \see #XTL_DISPATCH_SECTIONS
+template <size_t N, typename T, typename P, typename UID>
+struct preallocated<vtbl_map<N,T,hot_dispatch<P>>,UID>
+{
+    static vtbl_map<N,T,hot_dispatch<P>> value;
+};
+
+template <size_t N, typename T, typename P, typename UID>
+XTL_HOT_DISPATCH_PLACEMENT vtbl_map<N,T,hot_dispatch<P>> preallocated<vtbl_map<N,T,hot_dispatch<P>>,UID>::value(deferred_constant<vtbl_count_t>::get<UID>::value);
 
 template <typename S, typename C = void>
 struct dynamic_cast_when_polymorphic_helper
@@ -105,6 +202,51 @@ inline auto dynamic_cast_when_polymorphic(S* s) noexcept -> XTL_RETURN
 
 //------------------------------------------------------------------------------
 
+/// Subjects whose dynamic type is identified by a small dense index, e.g. the
+/// alternative held by a variant, specialize this trait with value = true,
+/// the number of indices as size and an index_of(const S*) function. Match 
+/// statements on a single such subject index a table of jump targets with it
+/// instead of looking up the vtbl map.
+template <typename S>
+struct indexed_subject
+{
+    static const bool value = false;
+};
+
+/// Jump target of a Match statement on several subjects or on a subject 
+/// without a dense index is looked up in its vtbl map.
+template <typename UID, typename Map, typename... S>
+inline auto xtl_switch_info_of(Map& map, const S*... s) -> decltype(map.xtl_get(s...))
+{
+    return map.xtl_get(s...);
+}
+
+/// Subject without a dense index
+template <typename UID, typename Map, typename S>
+inline auto xtl_switch_info_of(Map& map, const S* s, std::false_type) -> decltype(map.xtl_get(s))
+{
+    return map.xtl_get(s);
+}
+
+/// Subject with a dense index: one entry per index for each Match statement
+template <typename UID, typename Map, typename S>
+inline auto xtl_switch_info_of(Map& map, const S* s, std::true_type) -> decltype(map.xtl_get(s))
+{
+    typedef typename std::remove_reference<decltype(map.xtl_get(s))>::type info_type;
+    static info_type table[indexed_subject<S>::size];
+    XTL_ASSERT(indexed_subject<S>::index_of(s) < indexed_subject<S>::size);
+    return table[indexed_subject<S>::index_of(s)];
+}
+
+/// Jump target of a Match statement on a single subject
+template <typename UID, typename Map, typename S>
+inline auto xtl_switch_info_of(Map& map, const S* s) -> decltype(map.xtl_get(s))
+{
+    return xtl_switch_info_of<UID>(map, s, std::integral_constant<bool,indexed_subject<S>::value>());
+}
+
+//------------------------------------------------------------------------------
+
 // We use this helper to avoid warning about access to array with index -1, which
 // only happens in inapplicable conditions when is_polymorphic=false where no
 // access needed.
@@ -185,9 +327,14 @@ struct type_switch_info_offset_helper<false, SwitchInfo>
         };                                                                     \
         XTL_REPEAT(N,XTL_MATCH_SUBJECT_POLYMORPHIC_FROM,__VA_ARGS__)           \
         enum { number_of_polymorphic_subjects = XTL_REPEAT_WITH(+,N, XTL_PREFIX, is_polymorphic) }; \
-        typedef mch::vtbl_map<number_of_polymorphic_subjects,mch::type_switch_info<number_of_polymorphic_subjects>> vtbl_map_type; \
-        XTL_PRELOADABLE_LOCAL_STATIC(vtbl_map_type,__vtbl2case_map,match_uid_type,XTL_DUMP_PERFORMANCE_ONLY(__FILE__,__LINE__,XTL_FUNCTION,)XTL_GET_TYPES_NUM_ESTIMATE);\
-        mch::type_switch_info<number_of_polymorphic_subjects>& __switch_info = __vtbl2case_map.xtl_get(XTL_ENUM(N,XTL_PREFIX,subject_ptr)); \
+        typedef mch::vtbl_map<number_of_polymorphic_subjects,mch::type_switch_info<number_of_polymorphic_subjects>,XTL_VTBL_MAP_POLICY> vtbl_map_type; \
+        XTL_PRELOADABLE_LOCAL_STATIC(vtbl_map_type,__vtbl2case_map,match_uid_type,XTL_VTBL_COUNTERS_ONLY(__FILE__,__LINE__,XTL_FUNCTION,)XTL_GET_TYPES_NUM_ESTIMATE);\
+        XTL_LOCATE_VTBL_MAP(__vtbl2case_map);                                  \
+        XTL_SAMPLE_MATCH_SITES_ONLY(static const mch::match_site __match_site(__FILE__,__LINE__,XTL_FUNCTION); mch::match_sample __match_sample(__match_site);) \
+        XTL_MEMOIZE_MEMBERS_ONLY(mch::member_memo_scope __member_memo_scope;)  \
+        XTL_REGEX_SETS_ONLY(static mch::regex_site __regex_site; mch::regex_scope __regex_scope(__regex_site);) \
+        mch::type_switch_info<number_of_polymorphic_subjects>& __switch_info = mch::xtl_switch_info_of<match_uid_type>(__vtbl2case_map,XTL_ENUM(N,XTL_PREFIX,subject_ptr)); \
+        XTL_SAMPLE_MATCH_SITES_ONLY(__match_sample.observe(__switch_info.target);) \
         switch (number_of_polymorphic_subjects ? __switch_info.target : 0) {   \
         default: {{{
 
@@ -210,7 +357,7 @@ struct type_switch_info_offset_helper<false, SwitchInfo>
 #define XTL_ASSIGN_OFFSET(i,...) mch::type_switch_info_offset_helper<is_polymorphic##i,decltype(__switch_info)>::set_offset(__switch_info, polymorphic_index##i, intptr_t(__casted_ptr##i)-intptr_t(subject_ptr##i));
 //#define XTL_ADJUST_PTR_FROM(i,...) auto& match##i = *mch::adjust_ptr_if_polymorphic<target_type##i>(subject_ptr##i,__switch_info.offset[polymorphic_index##i]);
 #define XTL_ADJUST_PTR_FROM(i,...) auto& match##i = *mch::adjust_ptr_if_xtl_polymorphic<target_type##i>(subject_ptr##i,mch::type_switch_info_offset_helper<is_polymorphic##i,decltype(__switch_info)>::get_offset(__switch_info, polymorphic_index##i));
-#define XTL_MATCH_PATTERN_TO_TARGET(i,...) mch::filter(XTL_SELECT_ARG(i,__VA_ARGS__))(match##i)
+#define XTL_MATCH_PATTERN_TO_TARGET(i,...) XTL_HOIST_PATTERN(mch::filter(XTL_SELECT_ARG(i,__VA_ARGS__)))(match##i)
 
 /// Helper macro for #Case
 /// NOTE: It is possible to have if conditions sequenced instead of &&, but that
@@ -227,8 +374,8 @@ struct type_switch_info_offset_helper<false, SwitchInfo>
             XTL_STATIC_IF(number_of_polymorphic_subjects)                      \
             if (XTL_LIKELY(__switch_info.target == 0))                         \
             {                                                                  \
-                __switch_info.target = target_label;                           \
                 XTL_REPEAT(N, XTL_ASSIGN_OFFSET, XTL_EMPTY())                  \
+                __switch_info.target = target_label;                           \
             }                                                                  \
         case target_label:                                                     \
             XTL_REPEAT(N, XTL_ADJUST_PTR_FROM, __VA_ARGS__)                    \
@@ -51,6 +51,29 @@
 
 #include "vtblmap4.hpp"
 #include "metatools.hpp"
+#include "cast_hook.hpp"   // Type tests without RTTI
+#include "hierarchy.hpp"   // Declarations of closed class hierarchies
+#include <vector>          // Order of subjects of MatchGrouped statements
+
+#if XTL_TYPE_PROFILE
+#include "vtblprofile.hpp" // Saving and loading of what Match statements have learned
+#endif
+
+#if XTL_TYPE_REGISTRATION
+#include "type_registry.hpp" // Classes resolved against Match statements at startup
+#endif
+
+#if XTL_SAMPLE_MATCH_SITES
+#include "sampling.hpp"    // Hook called on sampled executions of Match statements
+#endif
+
+#if XTL_TRACE_MATCH_SITES
+#include "tracing.hpp"     // Records of executions of Match statements
+#endif
+
+#if XTL_REGEX_SETS
+#include "patterns/regex.hpp" // Sets of expressions of rex() clauses
+#endif
 
 namespace mch ///< Mach7 library namespace
 {
@@ -59,14 +82,25 @@ namespace mch ///< Mach7 library namespace
 
 /// FIX: This specialization doesn't actually help/work as expected as get<UID>
 ///      at the time of this instantiation is not yet set<UID>.
-template <size_t N, typename T, typename UID>
-struct preallocated<vtbl_map<N,T>,UID>
+template <size_t N, typename T, typename P, typename UID>
+struct preallocated<vtbl_map<N,T,P>,UID>
 {
-    static vtbl_map<N,T> value;
+    static vtbl_map<N,T,P> value;
 };
 
-template <size_t N, typename T, typename UID>
-vtbl_map<N,T> preallocated<vtbl_map<N,T>,UID>::value(deferred_constant<vtbl_count_t>::get<UID>::value);
+template <size_t N, typename T, typename P, typename UID>
+XTL_DISPATCH_PLACEMENT vtbl_map<N,T,P> preallocated<vtbl_map<N,T,P>,UID>::value(deferred_constant<vtbl_count_t>::get<UID>::value);
+
+/// Vtbl maps of Match statements with policy hot_dispatch are placed apart 
+/// from the others, \see #XTL_DISPATCH_SECTIONS
+template <size_t N, typename T, typename P, typename UID>
+struct preallocated<vtbl_map<N,T,hot_dispatch<P>>,UID>
+{
+    static vtbl_map<N,T,hot_dispatch<P>> value;
+};
+
+template <size_t N, typename T, typename P, typename UID>
+XTL_HOT_DISPATCH_PLACEMENT vtbl_map<N,T,hot_dispatch<P>> preallocated<vtbl_map<N,T,hot_dispatch<P>>,UID>::value(deferred_constant<vtbl_count_t>::get<UID>::value);
 
 template <typename S, typename C = void>
 struct dynamic_cast_when_polymorphic_helper
@@ -75,12 +109,46 @@ struct dynamic_cast_when_polymorphic_helper
     static inline const S* go(const S* s) { return s; }
 };
 
+#if XTL_OPTIMIZE_FOR_SIZE || XTL_LEAN_MATCH
+/// The dynamic_cast of case clauses shared by all those that cast from S to T
+/// \see #XTL_OPTIMIZE_FOR_SIZE, #XTL_LEAN_MATCH
+template <typename T, typename S>
+XTL_DO_NOT_INLINE_BEGIN T shared_dynamic_cast(const S* s) noexcept { XTL_OVERHEAD_ACCOUNTING_ONLY(mch::count_type_test_cast<typename std::remove_pointer<T>::type,S>()); return hooked_cast<T>(s); } XTL_DO_NOT_INLINE_END
+
+/// Upcasts do not depend on the dynamic type and are cheaper done in place
+template <typename T, typename S>
+inline T outlined_dynamic_cast(const S* s, std::true_type)  noexcept { return s; }
+template <typename T, typename S>
+inline T outlined_dynamic_cast(const S* s, std::false_type) noexcept { return shared_dynamic_cast<T>(s); }
+#endif
+
 template <typename S>
-struct dynamic_cast_when_polymorphic_helper<S, typename std::enable_if<std::is_polymorphic<S>::value>::type> 
+struct dynamic_cast_when_polymorphic_helper<S, typename std::enable_if<is_dispatched_type<S>::value>::type> 
 {
     template <typename T>
-    static inline T go(const S* s) { return dynamic_cast<T>(s); }
+#if XTL_OPTIMIZE_FOR_SIZE || XTL_LEAN_MATCH
+    static inline T go(const S* s) { return outlined_dynamic_cast<T>(s, std::is_base_of<typename std::remove_cv<typename std::remove_pointer<T>::type>::type,S>()); }
+#else
+    static inline T go(const S* s) { XTL_OVERHEAD_ACCOUNTING_ONLY(mch::count_type_test_cast<typename std::remove_pointer<T>::type,S>()); return hooked_cast<T>(s); }
+#endif
+};
+
+/// Subjects of exact types are their own dynamic types, so whether they are 
+/// of type T is known at compile time \see is_exact_type
+template <typename S>
+struct dynamic_cast_when_polymorphic_helper<S, typename std::enable_if<is_exact_type<S>::value>::type> 
+{
+    template <typename T>
+    static inline T go(const S* s) noexcept { return exact_target<typename std::remove_pointer<T>::type>(s); }
 };
+
+/// Stands for subjects of exact types in lookups of vtbl maps, which, not 
+/// being polymorphic, do not take part in them \see is_exact_type
+struct exact_subject {};
+
+/// Subject s as a vtbl map of a Match statement sees it
+template <typename S> inline auto dispatched_subject(const S* s) noexcept -> typename std::enable_if<!is_exact_type<S>::value,const S*>::type { return s; }
+template <typename S> inline auto dispatched_subject(const S*  ) noexcept -> typename std::enable_if< is_exact_type<S>::value,const exact_subject*>::type { return nullptr; }
 /*
 /// Behaves as dynamic_cast on pointers when argument is polymorphic.
 template <typename T, typename S>
@@ -103,6 +171,26 @@ inline auto dynamic_cast_when_polymorphic(const S* s) -> XTL_RETURN
     dynamic_cast_when_polymorphic_helper<S>::template go<T>(s)
 )
 
+/// Behaves as dynamic_cast_when_polymorphic unless a class hierarchy is 
+/// declared for S, in which case the cast is done with class_index_cast().
+/// Without RTTI the dynamic class cannot be looked up by its type_info, and
+/// #cast_hook uses the declared hierarchy through kinds instead.
+template <typename S, typename C = void>
+struct class_index_cast_helper
+{
+    template <typename T>
+    static inline const void* go(const S* s, std::size_t&) { return dynamic_cast_when_polymorphic<const T*>(s); }
+};
+
+#if XTL_RTTI
+template <typename S>
+struct class_index_cast_helper<S, typename std::enable_if<class_hierarchy<S>::declared && !is_exact_type<S>::value>::type> 
+{
+    template <typename T>
+    static inline const void* go(const S* s, std::size_t& index) { return class_index_cast<T>(s,index); }
+};
+#endif
+
 //------------------------------------------------------------------------------
 
 // We use this helper to avoid warning about access to array with index -1, which
@@ -129,8 +217,567 @@ struct type_switch_info_offset_helper<false, SwitchInfo>
     static inline ptrdiff_t get_offset(SwitchInfo&, size_t) { return 0; }; // Result is unused, so return anything
 };
 
+//------------------------------------------------------------------------------
+
+#if XTL_STATIC_OFFSETS
+/// Meta-predicate telling whether a T in a polymorphic subject of static type 
+/// S is at an offset known at compile time. static_cast from S to T compiles
+/// only when no virtual base is on the path between them. \see #XTL_STATIC_OFFSETS
+template <typename S, typename T, typename = void>
+struct has_static_offset : std::false_type {};
+
+template <typename S, typename T>
+struct has_static_offset<S, T, decltype(void(static_cast<const T*>(std::declval<const S*>())))> : std::is_polymorphic<S> {};
+
+/// Added to the case label of a clause whose target in some subject is not 
+/// where static_cast finds it, so that the clause uses remembered offsets
+const type_switch_target_t dynamic_offsets_label = type_switch_target_t(1) << 30;
+
+/// Whether target t found in subject s by the dynamic cast of a Case clause
+/// on a cache miss is not where static_cast finds it. This happens when the 
+/// dynamic type of s has several sub-objects of type S and t was reached by
+/// a cross-cast from one that is not a base of T.
+template <typename T, typename S>
+inline bool static_offset_differs(const S* s, const void* t, std::true_type /*static offset*/) noexcept
+{
+    return static_cast<const void*>(&static_cast<const T&>(*s)) != t;
+}
+
+template <typename T, typename S>
+inline bool static_offset_differs(const S*, const void*, std::false_type /*static offset*/) noexcept { return false; }
+
+/// Target of a Case clause in subject s at an offset known at compile time,
+/// unless the label of the clause in si says otherwise
+template <typename T, typename S, typename SwitchInfo>
+inline auto subject_target(S* s, SwitchInfo& si, size_t index, std::true_type /*static offset*/) noexcept
+    -> decltype(adjust_ptr_if_polymorphic<T>(s, 0))
+{
+    typedef decltype(adjust_ptr_if_polymorphic<T>(s, 0)) target_ptr;
+    return XTL_LIKELY(si.target < dynamic_offsets_label)
+         ? &static_cast<typename std::remove_pointer<target_ptr>::type&>(*s) // Through reference to skip the test for null
+         : adjust_ptr_if_polymorphic<T>(s, si.offset[index]);
+}
+
+/// Target of a Case clause in subject s at the offset remembered in si
+template <typename T, typename S, typename SwitchInfo>
+inline auto subject_target(S* s, SwitchInfo& si, size_t index, std::false_type /*static offset*/) noexcept
+    -> decltype(adjust_ptr_if_polymorphic<T>(s, 0))
+{
+    return adjust_ptr_unless_exact<T>(s, type_switch_info_offset_helper<is_dispatched_type<S>::value,SwitchInfo>::get_offset(si, index));
+}
+
+/// Label of the clause that a target of type_switch_info stands for
+inline std::size_t clause_label_of(std::size_t target) noexcept { return target & (dynamic_offsets_label-1); }
+#else
+/// Label of the clause that a target of type_switch_info stands for
+inline std::size_t clause_label_of(std::size_t target) noexcept { return target; }
+#endif
+
+//------------------------------------------------------------------------------
+
+/// Added to the case label of a #CaseSym clause that accepts the subjects of
+/// its #MatchSym statement in the order opposite to the canonical one
+const type_switch_target_t symmetric_flipped_label = type_switch_target_t(1) << 29;
+
+/// Tests whether subjects s0 and s1 are T0 and T1 in this or the opposite 
+/// order, trying this order first. On success t0 and t1 point to the T0 and 
+/// T1 found, and flipped tells whether t0 was found in s1.
+template <typename T0, typename T1, typename S>
+inline bool symmetric_cast(const S* s0, const S* s1, const void*& t0, const void*& t1, bool& flipped)
+{
+    if ((t0 = dynamic_cast_when_polymorphic<const T0*>(s0)) != 0 && (t1 = dynamic_cast_when_polymorphic<const T1*>(s1)) != 0)
+    {
+        flipped = false;
+        return true;
+    }
+
+    if ((t0 = dynamic_cast_when_polymorphic<const T0*>(s1)) != 0 && (t1 = dynamic_cast_when_polymorphic<const T1*>(s0)) != 0)
+    {
+        flipped = true;
+        return true;
+    }
+
+    return false;
+}
+
+//------------------------------------------------------------------------------
+
+#if XTL_LEARNED_CASE_ORDER
+/// Tests whether subject of static type S is a T and computes the this-pointer
+/// offset to it the same way Case clauses do.
+template <typename T, typename S>
+bool probe_case(const void* subject, std::ptrdiff_t& offset)
+{
+    const S*    s = static_cast<const S*>(subject);
+    const void* t = dynamic_cast_when_polymorphic<const T*>(s);
+
+    if (t)
+        offset = intptr_t(t)-intptr_t(s);
+
+    // Clauses whose targets are not where static_cast finds them resolve without prediction
+    XTL_STATIC_OFFSETS_ONLY(if (t && static_offset_differs<T>(s, t, std::integral_constant<bool, has_static_offset<S,T>::value>())) return false;)
+
+    return t != 0;
+}
+
+/// Learned order of Case clauses of a Match statement on a single subject
+/// (\see #XTL_LEARNED_CASE_ORDER). Clauses selected by the regular top to 
+/// bottom resolution of cache misses enroll here with a function testing 
+/// their target type, and later misses try them in the order of how often 
+/// they have been selected.
+class case_order
+{
+public:
+
+    /// Type of functions testing the target type of a clause \see probe_case
+    typedef bool (*probe_type)(const void* subject, std::ptrdiff_t& offset);
+
+    case_order() : size(0) {}
+
+    /// Remembers clause with jump target label, replacing the least selected 
+    /// one when there is no room left. 
+    void learn(std::size_t label, probe_type probe) noexcept
+    {
+        for (std::size_t i = 0; i < size; ++i)
+            if (candidates[i].label == label)
+                return;
+
+        candidate& c = candidates[size < XTL_CASE_CANDIDATES ? size++ : size-1];
+        c.label = label;
+        c.hits  = 0;
+        c.probe = probe;
+    }
+
+    /// Tries remembered clauses on subject in learned order.
+    /// \returns Whether one of them was accepted and si was set to jump there.
+    template <typename SwitchInfo>
+    bool predict(SwitchInfo& si, const void* subject) noexcept
+    {
+        std::ptrdiff_t offset;
+
+        for (std::size_t i = 0; i < size; ++i)
+            if (candidates[i].probe(subject,offset))
+            {
+                si.offset[0] = offset;
+                si.target    = candidates[i].label;
+                ++candidates[i].hits;
+
+                // Keep candidates sorted by decreasing number of hits
+                for (; i && candidates[i-1].hits < candidates[i].hits; --i)
+                    std::swap(candidates[i-1],candidates[i]);
+
+                return true;
+            }
+
+        return false;
+    }
+
+private:
+
+    /// A remembered Case clause
+    struct candidate
+    {
+        std::size_t label; ///< Case label of the clause in the switch of Match statement
+        std::size_t hits;  ///< Number of misses resolved to this clause with predict()
+        probe_type  probe; ///< Test of the target type of the clause
+    };
+
+    std::size_t size;                            ///< Number of remembered clauses
+    candidate   candidates[XTL_CASE_CANDIDATES]; ///< Remembered clauses by decreasing hits
+};
+#endif
+
+//------------------------------------------------------------------------------
+
+#if XTL_TYPE_REGISTRATION
+/// Target T of a registered prototype s, converted with the tables of the 
+/// hierarchy declared for S when its class is among the declared ones
+template <typename T, typename S>
+inline const void* registered_target(const S* s, std::size_t index, std::true_type /*declared*/)
+{
+    return index < std::size_t(class_hierarchy<S>::size)
+         ? class_hierarchy<S>::template upcasts<T>::table[index](dynamic_cast<const void*>(s))
+         : dynamic_cast_when_polymorphic<const T*>(s);
+}
+
+template <typename T, typename S>
+inline const void* registered_target(const S* s, std::size_t, std::false_type /*declared*/)
+{
+    return dynamic_cast_when_polymorphic<const T*>(s);
+}
+
+/// Clauses of the Match statement identified by UID on a single polymorphic
+/// subject of static type S, whose vtbl map is of type Map. The statement 
+/// enrolls with type_registry<S> along with its first clause \see #XTL_TYPE_REGISTRATION
+template <typename Map, typename UID, typename S>
+struct registered_site
+{
+    /// Tests whether prototype s is accepted by a clause and computes the 
+    /// this-pointer offset to its target and the label to jump to
+    typedef bool (*probe_type)(const S* s, std::size_t index, std::ptrdiff_t& offset, std::size_t& label);
+
+    /// An enrolled clause
+    struct clause
+    {
+        std::size_t label; ///< Case label of the clause in the switch of Match statement
+        probe_type  probe; ///< Test of the target type of the clause
+    };
+
+    /// Clauses in the order of their labels
+    static std::vector<clause>& clauses() { static std::vector<clause> c; return c; }
+
+    /// Adds clause with jump target label, whose target type is T or which 
+    /// accepts any subject when T is void
+    template <typename T>
+    static bool enroll(std::size_t label)
+    {
+        std::vector<clause>& c = clauses();
+
+        if (c.empty())
+            type_registry<S>::enroll(&fill);
+
+        typename std::vector<clause>::iterator p = c.begin();
+
+        while (p != c.end() && p->label < label)
+            ++p;
+
+        const clause cl = { label, &probe<T> };
+        c.insert(p, cl);
+        return true;
+    }
+
+    /// Sets the jump target for prototype the way the first cache miss on it
+    /// would, unless it has already been set
+    static void fill(const S* prototype, std::size_t index)
+    {
+        Map& map = preallocated<Map,UID>::value;
+        auto& info = switch_info_of<UID>(map, prototype);
+        const std::vector<clause>& c = clauses();
+
+        for (std::size_t i = 0; info.target == 0 && i < c.size(); ++i)
+        {
+            std::ptrdiff_t offset = 0;
+            std::size_t    label  = c[i].label;
+
+            if (c[i].probe(prototype, index, offset, label))
+            {
+                // Offset must be set before target to be seen by other threads
+                type_switch_info_offset_helper<true,typename std::remove_reference<decltype(info)>::type>::set_offset(info, 0, offset);
+                info.target = label;
+            }
+        }
+    }
+
+    template <typename T>
+    static bool probe(const S* s, std::size_t index, std::ptrdiff_t& offset, std::size_t& label)
+    {
+        return accepts<T>(s, index, offset, label, std::is_void<T>());
+    }
+
+    /// Otherwise() and EndMatch accept any subject
+    template <typename T>
+    static bool accepts(const S*, std::size_t, std::ptrdiff_t&, std::size_t&, std::true_type /*void*/) { return true; }
+
+    template <typename T>
+    static bool accepts(const S* s, std::size_t index, std::ptrdiff_t& offset, std::size_t& label, std::false_type /*void*/)
+    {
+        const void* t = registered_target<T>(s, index, std::integral_constant<bool,class_hierarchy<S>::declared>());
+
+        if (!t)
+            return false;
+
+        offset = intptr_t(t)-intptr_t(s);
+
+        // Clauses whose targets are not where static_cast finds them use remembered offsets
+        XTL_STATIC_OFFSETS_ONLY(if (static_offset_differs<T>(s, t, std::integral_constant<bool, has_static_offset<S,T>::value>())) label += dynamic_offsets_label;)
+        XTL_UNUSED(label);
+        return true;
+    }
+};
+
+/// Static member, whose initialization before main() enrolls the clause with
+/// jump target label and target type T (or void for the default) of the 
+/// Match statement identified by UID, when it is enabled for registration
+template <bool enabled, typename Map, typename UID, typename S, typename T, std::size_t label>
+struct registered_clause
+{
+    static const bool enrolled;
+};
+
+template <bool enabled, typename Map, typename UID, typename S, typename T, std::size_t label>
+const bool registered_clause<enabled,Map,UID,S,T,label>::enrolled = registered_site<Map,UID,S>::template enroll<T>(label);
+
+/// Statements on several subjects, non-polymorphic subjects or values do not enroll
+template <typename Map, typename UID, typename S, typename T, std::size_t label>
+struct registered_clause<false,Map,UID,S,T,label>
+{
+    enum { enrolled = false };
+};
+#endif
+
+//------------------------------------------------------------------------------
+
+/// Looks up switch info of subjects s in map, by vtbl pointers of the 
+/// polymorphic ones as well as values of those integral ones that are tested
+/// against literals \see #XTL_VALUE_SUBJECT_DISPATCH, literal_bit
+template <typename UID, typename Map, typename... S>
+inline auto keyed_switch_info_of(Map&& map, std::true_type, unsigned int literals, no_class_id, const S*... s) -> decltype(map.get_keyed(literals, s...))
+{
+    return map.get_keyed(literals, s...);
+}
+
+/// Looks up switch info of subjects s in map by vtbl pointers only
+template <typename UID, typename Map, typename... S>
+inline auto keyed_switch_info_of(Map&& map, std::false_type, unsigned int, no_class_id, const S*... s) -> decltype(switch_info_of<UID>(map, s...))
+{
+    return switch_info_of<UID>(map, s...);
+}
+
+/// Looks up switch info of a single subject resolved into a class token with
+/// given id in the table of the statement indexed by it \see class_token
+template <typename UID, typename Map, typename S>
+inline auto keyed_switch_info_of(Map&& map, std::false_type, unsigned int, std::size_t id, const S* s) -> decltype(map.get(s))
+{
+    typedef typename std::remove_reference<decltype(map.get(s))>::type info_type;
+    return indexed_switch_table<UID,info_type>::get(id);
+}
+
+/// Class tokens among several subjects are looked up by their vtbl pointers
+template <typename UID, typename Map, typename K, typename... S>
+inline auto keyed_switch_info_of(Map&& map, K keyed, unsigned int literals, std::size_t, const S*... s) -> decltype(keyed_switch_info_of<UID>(map, keyed, literals, no_class_id(), s...))
+{
+    return keyed_switch_info_of<UID>(map, keyed, literals, no_class_id(), s...);
+}
+
+template <typename T> struct value;
+struct wildcard;
+
+/// Whether pattern P applied to a subject that is a key of the vtbl map only 
+/// depends on the key, in which case clauses are selected by it with the target types
+template <typename P> struct is_key_determined           : std::false_type {};
+template <typename T> struct is_key_determined<value<T>> : std::true_type  {};
+template <>           struct is_key_determined<wildcard> : std::true_type  {};
+
+/// Whether pattern P tests a subject against a literal
+template <typename P> struct is_literal           : std::false_type {};
+template <typename T> struct is_literal<value<T>> : std::true_type  {};
+
+/// Static member, whose initialization before main() records that a clause of
+/// the Match statement identified by UID tests its subject in position I, 
+/// which is a key of the vtbl map, against a literal \see literal_bit
+template <typename UID, std::size_t I, bool literal>
+struct literal_mark
+{
+    static bool* const marked;
+};
+
+template <typename UID, std::size_t I, bool literal>
+bool* const literal_mark<UID,I,literal>::marked = deferred_constant<bool>::set<literal_mark<UID,I,true>,true>::value_ptr;
+
+/// Clauses that do not test a subject against a literal leave it unmarked
+template <typename UID, std::size_t I>
+struct literal_mark<UID,I,false>
+{
+    enum { marked = false };
+};
+
+/// Bit I of the mask of subjects of the Match statement identified by UID that
+/// some clause tests against a literal, so that the vtbl map takes their 
+/// values into account, while the values of other subjects, which select the
+/// same clause anyway, do not take their own entries in it \see value_keys_of
+template <typename UID, std::size_t I>
+inline unsigned int literal_bit(std::true_type) noexcept
+{
+    return deferred_constant<bool>::get<literal_mark<UID,I,true>>::value ? 1u << I : 0;
+}
+
+template <typename UID, std::size_t I>
+inline unsigned int literal_bit(std::false_type) noexcept { return 0; }
+
+template <typename P, typename S>
+inline bool value_key_test(const P& p, const S& s, std::true_type)  { return p(s); }
+template <typename P, typename S>
+inline bool value_key_test(const P&,   const S&,   std::false_type) { return true; }
+
+/// Tests pattern p on subject s as part of finding the clause the vtbl map 
+/// should remember, which is only done for subjects that are keys of the map 
+/// and patterns that only depend on them
+template <bool IsValueKey, typename P, typename S>
+inline bool value_key_test(const P& p, const S& s)
+{
+    return value_key_test(p, s, std::integral_constant<bool, IsValueKey && is_key_determined<P>::value>());
+}
+
+//------------------------------------------------------------------------------
+
+template <typename T, size_t layout> struct constr0;
+template <class T> struct var;
+template <class E> struct ref2;
+
+/// Rank converting to the rank of any clause of a Match statement
+const size_t max_clause_rank = 1024;
+
+/// Rank of a clause of a Match statement. The clause with label L declares an
+/// overload of __clauses taking clause_rank<L>, so that overload resolution on
+/// clause_rank<M> finds the last clause preceding label M or at it, since the
+/// nearer a base is, the better the conversion to it. \see #XTL_STATIC_REDUNDANCY_CHECKING
+template <size_t L> struct clause_rank : clause_rank<L-1>
+{
+    static_assert(L <= max_clause_rank, "Match statement has more clauses than mch::max_clause_rank");
+    static const size_t label = L;
+};
+template <>         struct clause_rank<0>                 { static const size_t label = 0; };
+
+// Completing ranks in steps keeps recursion of instantiating the largest one 
+// within the default template instantiation depth of compilers
+static_assert(sizeof(clause_rank<256>) && sizeof(clause_rank<512>) && sizeof(clause_rank<768>) && sizeof(clause_rank<max_clause_rank>), "Ranks of clauses have to be complete");
+
+/// Whether all of B are true
+template <bool... B> struct all_true : std::is_same<all_true<B...,true>, all_true<true,B...>> {};
+
+/// Whether pattern P accepts every subject of its target type, which makes the
+/// clause whose patterns are all such accept every subject of its target types
+template <typename P>           struct is_type_pattern                : std::false_type {};
+template <>                     struct is_type_pattern<wildcard>      : std::true_type  {};
+template <typename T, size_t L> struct is_type_pattern<constr0<T,L>>  : std::true_type  {};
+template <typename T>           struct is_type_pattern<ref2<var<T>>>  : std::true_type  {};
+
+/// Pattern P of a clause applied to subject of type S
+template <typename S, typename P>
+struct subject_pattern
+{
+    typedef typename underlying<P>::type pattern_type;
+    typedef typename std::remove_cv<typename pattern_type::template accepted_type_for<S>::type>::type target_type;
+    static const bool accepts_all = is_type_pattern<pattern_type>::value;
+};
+
+/// Whether every object of type U is also a T
+template <typename T, typename U>
+constexpr bool is_target_subsumed() { return std::is_same<T,U>::value || std::is_base_of<T,U>::value; }
+
+/// Clauses preceding the first clause of a Match statement
+struct no_clauses
+{
+    typedef no_clauses taking_all; ///< The last clause taking every subject of its target types
+    template <typename... T> static constexpr bool subsumes() { return false; }
+};
+
+/// Clause with label Rank::label and patterns SP applied to the subjects of a 
+/// Match statement, preceded by clauses Prev
+template <typename Rank, typename Prev, typename... SP>
+struct clauses
+{
+    static const size_t label = Rank::label;
+
+    /// Whether the clause takes every subject of its target types
+    static const bool accepts_all = all_true<SP::accepts_all...>::value;
+
+    /// Only clauses taking every subject of their target types can hide those
+    /// that follow, so the others are skipped when looking for them
+    typedef typename std::conditional<accepts_all, clauses, typename Prev::taking_all>::type taking_all;
+
+    /// Whether this or a preceding clause taking every subject of its target
+    /// types takes every subject of target types T. Only called on taking_all. 
+    template <typename... T> 
+    static constexpr bool subsumes() 
+    { 
+        return all_true<is_target_subsumed<typename SP::target_type,T>()...>::value 
+            || Prev::taking_all::template subsumes<T...>();
+    }
+
+    /// Whether a preceding clause takes every subject this clause could
+    static const bool subsumed = Prev::taking_all::template subsumes<typename SP::target_type...>();
+};
+
+/// Otherwise() clause with label Rank::label, which takes every subject
+template <typename Rank>
+struct otherwise_clauses
+{
+    static const size_t label = Rank::label;
+    typedef otherwise_clauses taking_all;
+    template <typename... T> static constexpr bool subsumes() { return true; }
+};
+
+/// Case clauses whose subjects are all taken by preceding clauses call this 
+/// overload, which makes the compiler report them
+XTL_DEPRECATED("Case clause is unreachable: a preceding clause takes every subject of its target types")
+inline void unreachable_clause(std::true_type)  noexcept {}
+inline void unreachable_clause(std::false_type) noexcept {}
+
+//------------------------------------------------------------------------------
+
+/// Outcome of a #Resolve statement on N subjects: which of its clauses was 
+/// selected and where the subjects are as target types of that clause. The
+/// outcome refers to the subjects rather than copying them, so it can be 
+/// consumed later, e.g. after a coroutine resumes, for as long as they live.
+template <size_t N>
+struct resolution
+{
+    resolution() : clause(0) {}
+
+    /// Subject I as target type T of the selected clause
+    template <typename T, size_t I = 0>
+    const T& as() const noexcept { static_assert(I < N, "Subject index out of range"); return *static_cast<const T*>(subjects[I]); }
+
+    /// 1-based position of the selected clause in its #Resolve statement or 0 
+    /// when none was selected. Positions are only dense with XTL_COUNTER being
+    /// __COUNTER__, otherwise they are offsets in lines from the statement.
+    size_t clause;
+
+    /// Subjects adjusted to target types of the selected #Clause
+    const void* subjects[N];
+};
+
+//------------------------------------------------------------------------------
+
+/// Order in which a #MatchGrouped statement visits its subjects: grouped by 
+/// the case label their dynamic types are mapped to in the vtbl map, and in 
+/// their original order within a group. Subjects of types the map has not
+/// seen yet have label 0 and come first.
+template <typename T>
+struct clause_groups
+{
+    template <typename M, typename S>
+    clause_groups(M& map, const S* const* subjects, std::size_t n) : infos(n), order(n)
+    {
+        for (std::size_t i = 0; i < n; i += XTL_BATCH_SIZE)
+        {
+            XTL_PREFETCH_SUBJECTS_ONLY(map.prefetch_batch(subjects + i, n - i);)
+            map.get_batch(subjects + i, n - i < XTL_BATCH_SIZE ? n - i : XTL_BATCH_SIZE, infos.data() + i);
+        }
+
+        // Counting sort of subjects by labels, which are dense and few
+        std::size_t labels = 1;
+
+        for (std::size_t i = 0; i < n; ++i)
+            labels = (std::max)(labels, clause_label_of(infos[i]->target) + 1);
+
+        std::vector<std::size_t> first(labels + 1);
+
+        for (std::size_t i = 0; i < n; ++i)
+            ++first[clause_label_of(infos[i]->target) + 1];
+
+        for (std::size_t l = 1; l < labels; ++l)
+            first[l] += first[l-1];
+
+        for (std::size_t i = 0; i < n; ++i)
+            order[first[clause_label_of(infos[i]->target)]++] = i;
+    }
+
+    std::vector<T*>          infos; ///< Values of the map for subjects in their original order
+    std::vector<std::size_t> order; ///< Positions of subjects in the order of visiting
+};
+
 } // of namespace mch
 
+/// Scope of Match statements outside of any #DispatchScope. Match statements 
+/// inside one find its local of the same name first.
+static const mch::no_dispatch_scope __dispatch_scope = mch::no_dispatch_scope();
+
+/// Declares mch::dispatch_scope, which keeps the parameters of the cache of a
+/// Match statement executed in the loop that follows in locals \see mch::dispatch_scope
+#define DispatchScope mch::dispatch_scope __dispatch_scope
+
 #define XTL_GET_TYPES_NUM_ESTIMATE   (mch::deferred_constant<mch::vtbl_count_t>::get<match_uid_type>::value)
 #define XTL_SET_TYPES_NUM_ESTIMATE(N) mch::deferred_constant<mch::vtbl_count_t>::set<match_uid_type,(N)>::value_ptr
 
@@ -149,7 +796,8 @@ struct type_switch_info_offset_helper<false, SwitchInfo>
         typedef XTL_CPP0X_TYPENAME mch::underlying<decltype(*subject_ptr##N)>::type source_type##N; \
         typedef source_type##N target_type##N XTL_UNUSED_TYPEDEF;              \
         XTL_ASSERT(xtl_failure("Trying to match against a nullptr",subject_ptr##N)); \
-        enum { is_polymorphic##N = std::is_polymorphic<source_type##N>::value, \
+        enum { is_polymorphic##N = mch::is_dispatched_type<source_type##N>::value, \
+               is_value_key##N = mch::is_value_key<source_type##N>::value,     \
                polymorphic_index##N = XTL_CONCAT(polymorphic_index,XTL_PREV(N)) + is_polymorphic##N }; \
         auto& match##N = *subject_ptr##N;                                      \
         XTL_UNUSED(match##N);
@@ -161,7 +809,8 @@ struct type_switch_info_offset_helper<false, SwitchInfo>
 #define XTL_MATCH_SUBJECT_POLYMORPHIC(N,s)                                     \
         XTL_MATCH_SUBJECT(N,s)                                                 \
         /*static_assert(std::is_polymorphic<source_type##N>::value, "Type of subject " #N " should be polymorphic when you use Match");*/\
-        register const void* __casted_ptr##N = 0;
+        register const void* __casted_ptr##N = 0;                              \
+        XTL_HIERARCHY_INDEX_ONLY(std::size_t __class_index##N = mch::unknown_class_index; XTL_UNUSED(__class_index##N);)
 
 /// Extension of #XTL_MATCH_SUBJECT_POLYMORPHIC where a list of subjects is 
 /// passed and we have to pick up i-th subject. Used in repetitions.
@@ -173,6 +822,10 @@ struct type_switch_info_offset_helper<false, SwitchInfo>
 #define XTL_PREFIX(n,...) __VA_ARGS__##n
 
 #define XTL_GET_VTLB_OF_SUBJECT(N,...) mch::vtbl_of(subject_ptr##N)
+/// Bit of the subject in position N in the mask of subjects tested against literals \see mch::literal_bit
+#define XTL_LITERAL_BIT(N,...) mch::literal_bit<match_uid_type,N>(std::integral_constant<bool,is_value_key##N && number_of_value_keys != 0>())
+/// Subject in position N as the vtbl map of a Match statement sees it
+#define XTL_DISPATCHED_SUBJECT(N,...) mch::dispatched_subject(subject_ptr##N)
 #define XTL_POLY_INDEX(N,...) 
 
 //------------------------------------------------------------------------------
@@ -188,11 +841,24 @@ struct type_switch_info_offset_helper<false, SwitchInfo>
         };                                                                     \
         XTL_REPEAT(N,XTL_MATCH_SUBJECT_POLYMORPHIC_FROM,__VA_ARGS__)           \
         enum { number_of_polymorphic_subjects = XTL_REPEAT_WITH(+,N, XTL_PREFIX, is_polymorphic) }; \
+        enum { number_of_value_keys = number_of_polymorphic_subjects ? mch::value_keys_size<XTL_ENUM(N,XTL_PREFIX,source_type)>::value : 0 }; \
         /*const intptr_t __vtbl[N] = {XTL_ENUM(N,XTL_GET_VTLB_OF_SUBJECT, XTL_EMPTY())};*/      \
-        typedef mch::vtbl_map<number_of_polymorphic_subjects,mch::type_switch_info<number_of_polymorphic_subjects>> vtbl_map_type; \
-        XTL_PRELOADABLE_LOCAL_STATIC(vtbl_map_type,__vtbl2case_map,match_uid_type,XTL_DUMP_PERFORMANCE_ONLY(__FILE__,__LINE__,XTL_FUNCTION,)XTL_GET_TYPES_NUM_ESTIMATE);\
-        mch::type_switch_info<number_of_polymorphic_subjects>& __switch_info = __vtbl2case_map.get(XTL_ENUM(N,XTL_PREFIX,subject_ptr)); \
+        typedef mch::vtbl_map<number_of_polymorphic_subjects+number_of_value_keys,mch::type_switch_info<number_of_polymorphic_subjects>,XTL_VTBL_MAP_POLICY> vtbl_map_type; \
+        XTL_PRELOADABLE_LOCAL_STATIC(vtbl_map_type,__vtbl2case_map,match_uid_type,XTL_VTBL_COUNTERS_ONLY(__FILE__,__LINE__,XTL_FUNCTION,)XTL_GET_TYPES_NUM_ESTIMATE);\
+        XTL_LOCATE_VTBL_MAP(__vtbl2case_map);                                  \
+        XTL_SAMPLE_MATCH_SITES_ONLY(static const mch::match_site __match_site(__FILE__,__LINE__,XTL_FUNCTION); mch::match_sample __match_sample(__match_site);) \
+        XTL_TRACE_MATCH_SITES_ONLY(static const mch::match_trace_site __trace_site(__FILE__,__LINE__,XTL_FUNCTION); mch::match_trace __match_trace(__trace_site);) \
+        XTL_MEMOIZE_MEMBERS_ONLY(mch::member_memo_scope __member_memo_scope;)  \
+        XTL_REGEX_SETS_ONLY(static mch::regex_site __regex_site; mch::regex_scope __regex_scope(__regex_site);) \
+        XTL_TYPE_PROFILE_ONLY(static auto* const __profile_site = mch::type_profile::enroll(__vtbl2case_map,__FILE__,__LINE__,XTL_FUNCTION,XTL_ENUM(N,XTL_DISPATCHED_SUBJECT,XTL_EMPTY()));) \
+        mch::type_switch_info<number_of_polymorphic_subjects>& __switch_info = mch::keyed_switch_info_of<match_uid_type>(__dispatch_scope.pin(__vtbl2case_map),std::integral_constant<bool,number_of_value_keys != 0>(),XTL_REPEAT_WITH(|,N,XTL_LITERAL_BIT,XTL_EMPTY()),mch::class_id_of(subject_ref0),XTL_ENUM(N,XTL_DISPATCHED_SUBJECT,XTL_EMPTY())); \
+        XTL_SAMPLE_MATCH_SITES_ONLY(__match_sample.observe(__switch_info.target);) \
+        XTL_TRACE_MATCH_SITES_ONLY(__match_trace.observe(__switch_info.target,XTL_ENUM(N,XTL_PREFIX,subject_ptr));) \
+        XTL_TYPE_PROFILE_ONLY(if (XTL_UNLIKELY(__switch_info.target == 0)) mch::type_profile::recall(__profile_site,__switch_info,XTL_ENUM(N,XTL_DISPATCHED_SUBJECT,XTL_EMPTY()));) \
+        XTL_LEARNED_CASE_ORDER_ONLY(XTL_PREDICT_CASE(subject_ptr0))            \
+        XTL_JUMP_TO_TARGET                                                     \
         switch (number_of_polymorphic_subjects ? __switch_info.target : 0) {                                        \
+        XTL_NO_CLAUSES                                                         \
         default: {{{
 
 #if defined(_MSC_VER)
@@ -208,13 +874,117 @@ struct type_switch_info_offset_helper<false, SwitchInfo>
 #define XTL_DECLARE_TARGET_TYPES(i,...)                                        \
         typedef XTL_CPP0X_TYPENAME mch::underlying<decltype(mch::filter(XTL_SELECT_ARG(i,__VA_ARGS__)))>::type type_of_pattern##i; \
         static_assert(mch::is_pattern<type_of_pattern##i>::value,"Case-clause expects patterns as its arguments"); \
-        typedef XTL_CPP0X_TYPENAME mch::underlying<type_of_pattern##i>::type::/*XTL_CPP0X_TEMPLATE*/ accepted_type_for<source_type##i>::type target_type##i;
-#define XTL_DYN_CAST_FROM(i,...) (__casted_ptr##i = mch::dynamic_cast_when_polymorphic<const target_type##i*>(subject_ptr##i)) != 0
+        typedef XTL_CPP0X_TYPENAME mch::underlying<type_of_pattern##i>::type::/*XTL_CPP0X_TEMPLATE*/ accepted_type_for<source_type##i>::type target_type##i; \
+        XTL_UNUSED((mch::literal_mark<match_uid_type,i,is_value_key##i && number_of_value_keys != 0 && mch::is_literal<type_of_pattern##i>::value>::marked))
+#if XTL_HIERARCHY_INDEX
+#define XTL_DYN_CAST_FROM(i,...) (__casted_ptr##i = mch::class_index_cast_helper<source_type##i>::template go<target_type##i>(subject_ptr##i,__class_index##i)) != 0 && XTL_VALUE_KEY_TEST(i,__VA_ARGS__)
+#else
+#define XTL_DYN_CAST_FROM(i,...) (__casted_ptr##i = mch::dynamic_cast_when_polymorphic<const target_type##i*>(subject_ptr##i)) != 0 && XTL_VALUE_KEY_TEST(i,__VA_ARGS__)
+#endif
+/// Literal values for subjects that are keys of the vtbl map are tested with 
+/// the target types, so that the map learns the clause they select
+#define XTL_VALUE_KEY_TEST(i,...) (!(is_value_key##i && number_of_value_keys != 0) || mch::value_key_test<is_value_key##i && number_of_value_keys != 0>(mch::filter(XTL_SELECT_ARG(i,__VA_ARGS__)),*subject_ptr##i))
+#if XTL_STATIC_OFFSETS
+/// Whether the target of a clause in subject i is at an offset known at compile time \see #XTL_STATIC_OFFSETS
+#define XTL_STATIC_OFFSET_OF(i) std::integral_constant<bool,is_polymorphic##i && mch::has_static_offset<source_type##i,target_type##i>::value>()
+#define XTL_ASSIGN_OFFSET(i,...) mch::type_switch_info_offset_helper<is_polymorphic##i,decltype(__switch_info)>::set_offset(__switch_info, polymorphic_index##i, intptr_t(__casted_ptr##i)-intptr_t(subject_ptr##i));
+/// Makes the clause use remembered offsets when the target in subject i is not where static_cast finds it
+#define XTL_CHECK_STATIC_OFFSET(i,...) if (mch::static_offset_differs<target_type##i>(subject_ptr##i, __casted_ptr##i, XTL_STATIC_OFFSET_OF(i))) __switch_info.target = target_label + mch::dynamic_offsets_label;
+/// Case label of the clause when it uses remembered offsets
+#define XTL_DYNAMIC_OFFSETS_CASE case target_label + mch::dynamic_offsets_label:
+#define XTL_ADJUST_PTR_FROM(i,...) auto& match##i = *mch::subject_target<target_type##i>(subject_ptr##i, __switch_info, polymorphic_index##i, XTL_STATIC_OFFSET_OF(i));
+#else
 //#define XTL_ASSIGN_OFFSET(i,...) XTL_STATIC_IF(is_polymorphic##i) __switch_info.offset[polymorphic_index##i] = intptr_t(__casted_ptr##i)-intptr_t(subject_ptr##i);
 #define XTL_ASSIGN_OFFSET(i,...) mch::type_switch_info_offset_helper<is_polymorphic##i,decltype(__switch_info)>::set_offset(__switch_info, polymorphic_index##i, intptr_t(__casted_ptr##i)-intptr_t(subject_ptr##i));
 //#define XTL_ADJUST_PTR_FROM(i,...) auto& match##i = *mch::adjust_ptr_if_polymorphic<target_type##i>(subject_ptr##i,__switch_info.offset[polymorphic_index##i]);
-#define XTL_ADJUST_PTR_FROM(i,...) auto& match##i = *mch::adjust_ptr_if_polymorphic<target_type##i>(subject_ptr##i,mch::type_switch_info_offset_helper<is_polymorphic##i,decltype(__switch_info)>::get_offset(__switch_info, polymorphic_index##i));
-#define XTL_MATCH_PATTERN_TO_TARGET(i,...) mch::filter(XTL_SELECT_ARG(i,__VA_ARGS__))(match##i)
+#define XTL_ADJUST_PTR_FROM(i,...) auto& match##i = *mch::adjust_ptr_unless_exact<target_type##i>(subject_ptr##i,mch::type_switch_info_offset_helper<is_polymorphic##i,decltype(__switch_info)>::get_offset(__switch_info, polymorphic_index##i));
+#endif
+#define XTL_MATCH_PATTERN_TO_TARGET(i,...) XTL_HOIST_PATTERN(mch::filter(XTL_SELECT_ARG(i,__VA_ARGS__)))(match##i)
+
+/// Resolves a cache miss of a Match statement on a single polymorphic subject
+/// with clauses remembered in learned order \see #XTL_LEARNED_CASE_ORDER
+#define XTL_PREDICT_CASE(subject)                                              \
+        static mch::case_order __case_order;                                   \
+        XTL_STATIC_IF(number_of_subjects == 1 && number_of_polymorphic_subjects == 1) \
+        if (XTL_UNLIKELY(__switch_info.target == 0))                           \
+            __case_order.predict(__switch_info,subject);
+/// Remembers the Case clause a cache miss was resolved to \see #XTL_LEARNED_CASE_ORDER
+#define XTL_LEARN_CASE                                                         \
+        XTL_STATIC_IF(number_of_subjects == 1 && number_of_polymorphic_subjects == 1) \
+            __case_order.learn(target_label,&mch::probe_case<target_type0,source_type0>);
+/// Makes clause with jump target label and target type T (void for defaults)
+/// enroll before main() \see #XTL_TYPE_REGISTRATION
+#define XTL_ENROLL_CLAUSE(T,label)                                             \
+        XTL_UNUSED((mch::registered_clause<number_of_subjects == 1 && number_of_polymorphic_subjects == 1 && number_of_value_keys == 0,vtbl_map_type,match_uid_type,source_type0,T,label>::enrolled))
+
+#if XTL_STATIC_REDUNDANCY_CHECKING
+/// Subject in position i with the pattern applied to it by a clause
+#define XTL_SUBJECT_PATTERN(i,...) mch::subject_pattern<source_type##i,decltype(mch::filter(XTL_SELECT_ARG(i,__VA_ARGS__)))>
+/// Declaration at the beginning of the switch of a Match statement that 
+/// the clauses of XTL_CLAUSE_DECLARATION are preceded by none
+#define XTL_NO_CLAUSES mch::no_clauses __clauses(mch::clause_rank<0>, match_uid_type*);
+/// Declaration of a Case clause on N subjects, visible to the clauses that follow \see mch::clause_rank
+#define XTL_CLAUSE_DECLARATION(N,...) auto __clauses(mch::clause_rank<XTL_COUNTER-__base_counter> r, match_uid_type*) -> mch::clauses<decltype(r),decltype(__clauses(r,(match_uid_type*)0)),XTL_ENUM(N,XTL_SUBJECT_PATTERN,__VA_ARGS__)>;
+/// Declaration of an Otherwise() clause
+#define XTL_OTHERWISE_DECLARATION auto __clauses(mch::clause_rank<XTL_COUNTER-__base_counter> r, match_uid_type*) -> mch::otherwise_clauses<decltype(r)>;
+/// Type of the clause whose scope this is
+#define XTL_THIS_CLAUSE typedef decltype(__clauses(mch::clause_rank<mch::max_clause_rank>(),(match_uid_type*)0)) __this_clause;
+#if XTL_FALL_THROUGH
+/// Falling through from preceding clauses reaches any clause
+#define XTL_CHECK_REACHABLE
+#else
+/// Makes the compiler report the clause when it is unreachable
+#define XTL_CHECK_REACHABLE mch::unreachable_clause(std::integral_constant<bool,__this_clause::subsumed>());
+#endif
+/// Whether the dynamic casts of a clause can succeed: on cache misses, when 
+/// no clause has been taken yet, a clause whose subjects are all taken by 
+/// preceding clauses cannot be taken either
+#define XTL_CLAUSE_REACHABLE (!__this_clause::subsumed || !number_of_polymorphic_subjects || __switch_info.target != 0) &&
+#define XTL_CLAUSE_LABEL __this_clause::label
+#else
+#define XTL_NO_CLAUSES
+#define XTL_CLAUSE_DECLARATION(N,...)
+#define XTL_OTHERWISE_DECLARATION
+#define XTL_THIS_CLAUSE
+#define XTL_CHECK_REACHABLE
+#define XTL_CLAUSE_REACHABLE
+#define XTL_CLAUSE_LABEL XTL_COUNTER-__base_counter
+#endif
+
+#if XTL_APPLICABLE_CLAUSES
+/// Test of a clause that falls back to its dynamic casts only until the info
+/// of the subjects knows whether the clause applies. Casts still run while 
+/// no clause is taken, since they compute the offsets. \see #XTL_APPLICABLE_CLAUSES
+#define XTL_CLAUSE_APPLIES(...)                                                \
+        (number_of_polymorphic_subjects && __switch_info.target != 0 && (__switch_info.tested & mch::clause_bit(clause_label)) \
+            ? (__switch_info.applicable & mch::clause_bit(clause_label)) != 0  \
+            : mch::remember_clause(__switch_info, mch::clause_bit(clause_label), number_of_polymorphic_subjects != 0, (__VA_ARGS__)))
+#else
+#define XTL_CLAUSE_APPLIES(...) __VA_ARGS__
+#endif
+
+#if XTL_SEPARATE_DEFAULTS
+/// Tells the vtbl map that the subjects resolved to the default \see #XTL_SEPARATE_DEFAULTS
+#define XTL_SET_DEFAULT XTL_STATIC_IF(number_of_polymorphic_subjects) mch::set_default_of(__vtbl2case_map, __switch_info, 0);
+#else
+#define XTL_SET_DEFAULT
+#endif
+
+#if XTL_USE_COMPUTED_GOTO
+/// Jumps to the address of the clause remembered for the subjects, skipping 
+/// the switch that would find it by its label \see #XTL_USE_COMPUTED_GOTO
+#define XTL_JUMP_TO_TARGET if (number_of_polymorphic_subjects && XTL_LIKELY(__switch_info.jump != 0)) goto *static_cast<void*>(__switch_info.jump);
+/// Declaration of the label of a clause, which has to open its block
+#define XTL_DECLARE_JUMP_TARGET __label__ __jump_target;
+/// Remembers the address of the label of the clause next to its case label
+#define XTL_REMEMBER_JUMP_TARGET __switch_info.jump = &&__jump_target;
+#define XTL_JUMP_TARGET __jump_target:
+#else
+#define XTL_JUMP_TO_TARGET
+#define XTL_DECLARE_JUMP_TARGET
+#define XTL_REMEMBER_JUMP_TARGET
+#define XTL_JUMP_TARGET
+#endif
 
 /// Helper macro for #Case
 /// NOTE: It is possible to have if conditions sequenced instead of &&, but that
@@ -222,18 +992,29 @@ struct type_switch_info_offset_helper<false, SwitchInfo>
 /// FIX: Neither mentioning only type nor omitting variable name works.
 #define CaseN(N, ...)                                                          \
         }}}                                                                    \
+        XTL_CLAUSE_DECLARATION(N,__VA_ARGS__)                                  \
         {                                                                      \
+        XTL_DECLARE_JUMP_TARGET                                                \
         XTL_REPEAT(N, XTL_DECLARE_TARGET_TYPES, __VA_ARGS__)                   \
-        if (XTL_REPEAT_WITH(&&, N, XTL_DYN_CAST_FROM, __VA_ARGS__))            \
+        XTL_THIS_CLAUSE                                                        \
+        XTL_CHECK_REACHABLE                                                    \
+        enum { clause_label = XTL_CLAUSE_LABEL };                              \
+        XTL_TYPE_REGISTRATION_ONLY(XTL_ENROLL_CLAUSE(target_type0,clause_label)) \
+        if (XTL_CLAUSE_APPLIES(XTL_CLAUSE_REACHABLE XTL_REPEAT_WITH(&&, N, XTL_DYN_CAST_FROM, __VA_ARGS__))) \
         {                                                                      \
             static_assert(number_of_subjects == N, "Number of targets in the case clause must be the same as the number of subjects in the Match statement"); \
-            enum { target_label = XTL_COUNTER-__base_counter, is_inside_case_clause = 1 }; \
+            enum { target_label = clause_label, is_inside_case_clause = 1 };   \
             XTL_STATIC_IF(number_of_polymorphic_subjects)                      \
             if (XTL_LIKELY(__switch_info.target == 0))                         \
             {                                                                  \
-                __switch_info.target = target_label;                           \
                 XTL_REPEAT(N, XTL_ASSIGN_OFFSET, XTL_EMPTY())                  \
+                __switch_info.target = target_label;                           \
+                XTL_STATIC_OFFSETS_ONLY(XTL_REPEAT(N, XTL_CHECK_STATIC_OFFSET, XTL_EMPTY())) \
+                XTL_REMEMBER_JUMP_TARGET                                       \
+                XTL_LEARNED_CASE_ORDER_ONLY(XTL_LEARN_CASE)                    \
             }                                                                  \
+        XTL_JUMP_TARGET                                                        \
+        XTL_STATIC_OFFSETS_ONLY(XTL_DYNAMIC_OFFSETS_CASE)                      \
         case target_label:                                                     \
             XTL_REPEAT(N, XTL_ADJUST_PTR_FROM, __VA_ARGS__)                    \
             if (XTL_REPEAT_WITH(&&, N, XTL_MATCH_PATTERN_TO_TARGET, __VA_ARGS__)) {
@@ -252,10 +1033,19 @@ struct type_switch_info_offset_helper<false, SwitchInfo>
 #define Otherwise()                                                            \
             static_assert(is_inside_case_clause, "Otherwise() must follow actual clauses! If you are trying to use it as a default sub-clause, use When() instead"); \
         }}}                                                                    \
+        XTL_OTHERWISE_DECLARATION                                              \
         {{{                                                                    \
-            enum { target_label = XTL_COUNTER-__base_counter, is_inside_case_clause = 1 }; \
+            XTL_DECLARE_JUMP_TARGET                                            \
+            XTL_THIS_CLAUSE                                                    \
+            enum { target_label = XTL_CLAUSE_LABEL, is_inside_case_clause = 1 }; \
+            XTL_TYPE_REGISTRATION_ONLY(XTL_ENROLL_CLAUSE(void,target_label))   \
             if (XTL_LIKELY(__switch_info.target == 0))                         \
+            {                                                                  \
                 __switch_info.target = target_label;                           \
+                XTL_REMEMBER_JUMP_TARGET                                       \
+                XTL_SET_DEFAULT                                                \
+            }                                                                  \
+        XTL_JUMP_TARGET                                                        \
         case target_label:
 
 /// General EndMatch statement
@@ -264,11 +1054,216 @@ struct type_switch_info_offset_helper<false, SwitchInfo>
         XTL_STATIC_IF(number_of_polymorphic_subjects)                          \
         if (XTL_UNLIKELY((__switch_info.target == 0)))                         \
         {                                                                      \
+            XTL_DECLARE_JUMP_TARGET                                            \
             enum { target_label = XTL_COUNTER-__base_counter };                \
             XTL_SET_TYPES_NUM_ESTIMATE(target_label-1);                        \
+            XTL_TYPE_REGISTRATION_ONLY(XTL_ENROLL_CLAUSE(void,target_label))   \
             __switch_info.target = target_label;                               \
+            XTL_REMEMBER_JUMP_TARGET                                           \
+            XTL_SET_DEFAULT                                                    \
+            XTL_JUMP_TARGET                                                    \
             case target_label: ;                                               \
         }                                                                      \
         }}
 
 //------------------------------------------------------------------------------
+
+/// Match statement that only resolves which of its clauses accepts subjects, 
+/// recording it together with the adjusted subjects in r of type 
+/// mch::resolution<N>. Dispatch is that of #Match, but no user code runs 
+/// inside of it, which keeps it out of the switch statement Match expands to, 
+/// where co_await and other suspensions are problematic. Has to list #Clause
+/// and optionally #OtherwiseClause only and end with #EndResolve.
+/// \code
+///     mch::resolution<1> r;
+///     Resolve(r, request) Clause(get) Clause(put) OtherwiseClause() EndResolve
+///     switch (r.clause) { case 1: co_await serve(r.as<Get>()); ... }
+/// \endcode
+#define Resolve(r, ...) {                                                      \
+        auto& __resolution = r;                                                \
+        __resolution.clause = 0;                                               \
+        Match(__VA_ARGS__)
+
+/// Records address of the subject in position i once matched to the clause
+#define XTL_RESOLVE_SUBJECT(i,...) __resolution.subjects[i] = mch::addr(match##i);
+
+/// Helper macro for #Clause
+#define ClauseN(N, ...)                                                        \
+        CaseN(N, __VA_ARGS__)                                                  \
+            static_assert(sizeof(__resolution.subjects) == N*sizeof(const void*), "Resolution must be for the same number of subjects as the Resolve statement"); \
+            XTL_REPEAT(N, XTL_RESOLVE_SUBJECT, XTL_EMPTY())                    \
+            __resolution.clause = target_label;                                \
+            break;
+
+#if defined(_MSC_VER)
+    /// FIX: For some reason we need to make this extra hoop to make MSVC preprocessor do what we want
+    #define Clause_(N,...) XTL_APPLY_VARIADIC_MACRO(ClauseN,(N,__VA_ARGS__))
+    /// Clause of #Resolve statement with the same patterns as #Case
+    #define Clause(...) Clause_(XTL_NARG(__VA_ARGS__),__VA_ARGS__)
+#else
+    /// Clause of #Resolve statement with the same patterns as #Case
+    #define Clause(...) ClauseN(XTL_NARG(__VA_ARGS__), __VA_ARGS__)
+#endif
+
+/// Default clause of #Resolve statement. Leaves subjects of the resolution as
+/// they were, since the original subjects can be used instead.
+#define OtherwiseClause()                                                      \
+        Otherwise()                                                            \
+            __resolution.clause = target_label;                                \
+            break;
+
+/// Closes #Resolve statement
+#define EndResolve EndMatch }
+
+//------------------------------------------------------------------------------
+
+/// Match statement on an unordered pair of polymorphic subjects of the same 
+/// static type, e.g. for commutative operations like collision detection. The
+/// subjects are ordered by their vtbl-pointers before the lookup, so that 
+/// (a,b) and (b,a) share an entry of the vtbl map, and each #CaseSym clause 
+/// accepts them in either order, binding match0 and match1 in the order of 
+/// its patterns:
+/// \code
+///     MatchSym(s1, s2)
+///     {
+///         CaseSym(C<Circle>(), C<Circle>()) return circles(match0, match1);
+///         CaseSym(C<Circle>(), C<Square>()) return mixed(match0, match1); // Also takes (Square,Circle)
+///     }
+///     EndMatchSym
+/// \endcode
+/// Each clause is tried with the subjects in both orders before the next one.
+/// When target types of a clause accept the subjects in both orders, they are
+/// passed in the canonical order, which depends on where the vtbls are, and 
+/// patterns of the clause are applied in that order only, so such clauses
+/// have to be commutative. Has to use #CaseSym and Otherwise() clauses only.
+#define MatchSym(s0, s1) {                                                     \
+        auto const __sym_ptr0 = mch::addr(s0);                                 \
+        auto const __sym_ptr1 = mch::addr(s1);                                 \
+        static_assert(std::is_same<XTL_CPP0X_TYPENAME mch::underlying<decltype(*__sym_ptr0)>::type, XTL_CPP0X_TYPENAME mch::underlying<decltype(*__sym_ptr1)>::type>::value, "Subjects of MatchSym must have the same static type"); \
+        static_assert(std::is_polymorphic<XTL_CPP0X_TYPENAME mch::underlying<decltype(*__sym_ptr0)>::type>::value, "Subjects of MatchSym must be polymorphic"); \
+        const bool __sym_swap = mch::vtbl_of(__sym_ptr1) < mch::vtbl_of(__sym_ptr0); \
+        bool __sym_flipped = false;                                            \
+        XTL_UNUSED(__sym_flipped);                                             \
+        MatchN(2, *(__sym_swap ? __sym_ptr1 : __sym_ptr0), *(__sym_swap ? __sym_ptr0 : __sym_ptr1))
+
+/// Clause of #MatchSym statement with patterns for both subjects, which it 
+/// accepts in either order. Remembers the order in the case label.
+#define CaseSym(...)                                                           \
+        }}}                                                                    \
+        XTL_CLAUSE_DECLARATION(2,__VA_ARGS__)                                  \
+        {                                                                      \
+        XTL_DECLARE_TARGET_TYPES(0,__VA_ARGS__)                                \
+        XTL_DECLARE_TARGET_TYPES(1,__VA_ARGS__)                                \
+        XTL_THIS_CLAUSE                                                        \
+        XTL_CHECK_REACHABLE                                                    \
+        enum { clause_label = XTL_CLAUSE_LABEL };                              \
+        if (XTL_CLAUSE_REACHABLE mch::symmetric_cast<target_type0,target_type1>(subject_ptr0,subject_ptr1,__casted_ptr0,__casted_ptr1,__sym_flipped)) \
+        {                                                                      \
+            static_assert(XTL_NARG(__VA_ARGS__) == 2, "CaseSym takes patterns for both subjects of MatchSym"); \
+            enum { target_label = clause_label, is_inside_case_clause = 1 };   \
+            if (XTL_LIKELY(__switch_info.target == 0))                         \
+            {                                                                  \
+                __switch_info.offset[0] = intptr_t(__casted_ptr0)-intptr_t(__sym_flipped ? subject_ptr1 : subject_ptr0); \
+                __switch_info.offset[1] = intptr_t(__casted_ptr1)-intptr_t(__sym_flipped ? subject_ptr0 : subject_ptr1); \
+                __switch_info.target = target_label + (__sym_flipped ? mch::symmetric_flipped_label : 0); \
+            }                                                                  \
+            if (0) { case target_label:                                   __sym_flipped = false; } \
+            if (0) { case target_label + mch::symmetric_flipped_label:    __sym_flipped = true;  } \
+            auto& match0 = *mch::adjust_ptr_if_polymorphic<target_type0>(__sym_flipped ? subject_ptr1 : subject_ptr0, __switch_info.offset[0]); \
+            auto& match1 = *mch::adjust_ptr_if_polymorphic<target_type1>(__sym_flipped ? subject_ptr0 : subject_ptr1, __switch_info.offset[1]); \
+            if (XTL_MATCH_PATTERN_TO_TARGET(0,__VA_ARGS__) && XTL_MATCH_PATTERN_TO_TARGET(1,__VA_ARGS__)) {
+
+/// Closes #MatchSym statement
+#define EndMatchSym EndMatch }
+
+//------------------------------------------------------------------------------
+
+/// Match statement on each of n polymorphic subjects in the array subjects,
+/// resolving jump targets of up to #XTL_BATCH_SIZE of them at a time with 
+/// vtbl_map::get_batch(). Case clauses are the same as in single-subject 
+/// #Match and are executed for every subject in order; break leaves the 
+/// clause and continues with the next subject. Has to end with #EndMatchEach.
+#define MatchEach(subjects, n) {                                               \
+        struct match_uid_type {};                                              \
+        enum {                                                                 \
+            is_inside_case_clause = 0,                                         \
+            number_of_subjects = 1,                                            \
+            number_of_polymorphic_subjects = 1,                                \
+            number_of_value_keys = 0,                                          \
+            polymorphic_index00 = -1,                                          \
+            __base_counter = XTL_COUNTER                                       \
+        };                                                                     \
+        auto const __each_subjects = subjects;                                 \
+        const std::size_t __each_count = n;                                    \
+        static_assert(std::is_polymorphic<XTL_CPP0X_TYPENAME mch::underlying<decltype(**__each_subjects)>::type>::value, "MatchEach requires polymorphic subjects"); \
+        typedef mch::vtbl_map<1,mch::type_switch_info<1>,XTL_VTBL_MAP_POLICY> vtbl_map_type; \
+        XTL_PRELOADABLE_LOCAL_STATIC(vtbl_map_type,__vtbl2case_map,match_uid_type,XTL_VTBL_COUNTERS_ONLY(__FILE__,__LINE__,XTL_FUNCTION,)XTL_GET_TYPES_NUM_ESTIMATE);\
+        XTL_LOCATE_VTBL_MAP(__vtbl2case_map);                                  \
+        mch::type_switch_info<1>* __each_infos[XTL_BATCH_SIZE];               \
+        for (std::size_t __each_first = 0; __each_first < __each_count; __each_first += XTL_BATCH_SIZE) { \
+        const std::size_t __each_size = __each_count - __each_first < XTL_BATCH_SIZE ? __each_count - __each_first : XTL_BATCH_SIZE; \
+        XTL_PREFETCH_SUBJECTS_ONLY(__vtbl2case_map.prefetch_batch(__each_subjects + __each_first, __each_count - __each_first);) \
+        __vtbl2case_map.get_batch(__each_subjects + __each_first, __each_size, __each_infos); \
+        for (std::size_t __each_i = 0; __each_i < __each_size; ++__each_i) { \
+        XTL_MATCH_SUBJECT_POLYMORPHIC(0,__each_subjects[__each_first + __each_i]) \
+        mch::type_switch_info<1>& __switch_info = *__each_infos[__each_i];     \
+        XTL_LEARNED_CASE_ORDER_ONLY(XTL_PREDICT_CASE(subject_ptr0))            \
+        XTL_JUMP_TO_TARGET                                                     \
+        switch (__switch_info.target) {                                        \
+        XTL_NO_CLAUSES                                                         \
+        default: {{{
+
+/// Closes #MatchEach statement
+#define EndMatchEach EndMatch }}
+
+//------------------------------------------------------------------------------
+
+/// Match statement on each of n polymorphic subjects in the array subjects 
+/// that executes its Case clauses grouped by clause rather than in the order 
+/// of subjects. Clauses of all the subjects are looked up in the vtbl map 
+/// first, then subjects are ordered by them with a counting sort and switched
+/// on in that order, so each clause runs over all of its subjects back to 
+/// back, with the jump to it predicted and its code in cache. Subjects of the
+/// same clause are visited in their original order, whose position is 
+/// subject_index inside the clauses, and subjects of types the statement has 
+/// not seen yet are visited first. Clauses are those of #MatchEach; the 
+/// statement has to end with #EndMatchGrouped.
+/// \code
+///     MatchGrouped(shapes, n)
+///     {
+///     Case(C<Circle>(r)) areas[subject_index] = pi*r*r; break;
+///     Case(C<Square>(a)) areas[subject_index] = a*a;    break;
+///     }
+///     EndMatchGrouped
+/// \endcode
+#define MatchGrouped(subjects, n) {                                            \
+        struct match_uid_type {};                                              \
+        enum {                                                                 \
+            is_inside_case_clause = 0,                                         \
+            number_of_subjects = 1,                                            \
+            number_of_polymorphic_subjects = 1,                                \
+            number_of_value_keys = 0,                                          \
+            polymorphic_index00 = -1,                                          \
+            __base_counter = XTL_COUNTER                                       \
+        };                                                                     \
+        auto const __each_subjects = subjects;                                 \
+        static_assert(std::is_polymorphic<XTL_CPP0X_TYPENAME mch::underlying<decltype(**__each_subjects)>::type>::value, "MatchGrouped requires polymorphic subjects"); \
+        typedef mch::vtbl_map<1,mch::type_switch_info<1>,XTL_VTBL_MAP_POLICY> vtbl_map_type; \
+        XTL_PRELOADABLE_LOCAL_STATIC(vtbl_map_type,__vtbl2case_map,match_uid_type,XTL_VTBL_COUNTERS_ONLY(__FILE__,__LINE__,XTL_FUNCTION,)XTL_GET_TYPES_NUM_ESTIMATE);\
+        XTL_LOCATE_VTBL_MAP(__vtbl2case_map);                                  \
+        const mch::clause_groups<mch::type_switch_info<1> > __groups(__vtbl2case_map, __each_subjects, n); \
+        for (std::size_t __each_k = 0; __each_k < __groups.order.size(); ++__each_k) { \
+        const std::size_t subject_index = __groups.order[__each_k];            \
+        XTL_UNUSED(subject_index);                                             \
+        XTL_MATCH_SUBJECT_POLYMORPHIC(0,__each_subjects[subject_index])        \
+        mch::type_switch_info<1>& __switch_info = *__groups.infos[subject_index]; \
+        XTL_LEARNED_CASE_ORDER_ONLY(XTL_PREDICT_CASE(subject_ptr0))            \
+        XTL_JUMP_TO_TARGET                                                     \
+        switch (__switch_info.target) {                                        \
+        XTL_NO_CLAUSES                                                         \
+        default: {{{
+
+/// Closes #MatchGrouped statement
+#define EndMatchGrouped EndMatch }
+
+//------------------------------------------------------------------------------
@@ -52,6 +52,18 @@
 #include "vtblmap4.hpp"
 #include "metatools.hpp"
 
+#if XTL_TYPE_PROFILE
+#include "vtblprofile.hpp" // Saving and loading of what Match statements have learned
+#endif
+
+#if XTL_SAMPLE_MATCH_SITES
+#include "sampling.hpp"    // Hook called on sampled executions of Match statements
+#endif
+
+#if XTL_TRACE_MATCH_SITES
+#include "tracing.hpp"     // Records of executions of Match statements
+#endif
+
 namespace mch ///< Mach7 library namespace
 {
 
@@ -59,14 +71,14 @@ namespace mch ///< Mach7 library namespace
 
 /// FIX: This specialization doesn't actually help/work as expected as get<UID>
 ///      at the time of this instantiation is not yet set<UID>.
-template <size_t N, typename T, typename UID>
-struct preallocated<vtbl_map<N,T>,UID>
+template <size_t N, typename T, typename P, typename UID>
+struct preallocated<vtbl_map<N,T,P>,UID>
 {
-    static vtbl_map<N,T> value;
+    static vtbl_map<N,T,P> value;
 };
 
-template <size_t N, typename T, typename UID>
-vtbl_map<N,T> preallocated<vtbl_map<N,T>,UID>::value(deferred_constant<vtbl_count_t>::get<UID>::value);
+template <size_t N, typename T, typename P, typename UID>
+vtbl_map<N,T,P> preallocated<vtbl_map<N,T,P>,UID>::value(deferred_constant<vtbl_count_t>::get<UID>::value);
 
 } // of namespace mch
 
@@ -121,9 +133,17 @@ enum { default_layout = size_t(~0) };
         enum { __base_counter = XTL_COUNTER };                                 \
         XTL_REPEAT(N,XTL_MATCH_SUBJECT_POLYMORPHIC_FROM,__VA_ARGS__)           \
         const intptr_t __vtbl[N] = {XTL_ENUM(N,XTL_GET_VTLB_OF_SUBJECT, XTL_EMPTY())}; \
-        typedef mch::vtbl_map<N,mch::type_switch_info<N>> vtbl_map_type;       \
-        XTL_PRELOADABLE_LOCAL_STATIC(vtbl_map_type,__vtbl2case_map,match_uid_type,XTL_DUMP_PERFORMANCE_ONLY(__FILE__,__LINE__,XTL_FUNCTION,)XTL_GET_TYPES_NUM_ESTIMATE);\
+        typedef mch::vtbl_map<N,mch::type_switch_info<N>,XTL_VTBL_MAP_POLICY> vtbl_map_type; \
+        XTL_PRELOADABLE_LOCAL_STATIC(vtbl_map_type,__vtbl2case_map,match_uid_type,XTL_VTBL_COUNTERS_ONLY(__FILE__,__LINE__,XTL_FUNCTION,)XTL_GET_TYPES_NUM_ESTIMATE);\
+        XTL_LOCATE_VTBL_MAP(__vtbl2case_map);                                  \
+        XTL_SAMPLE_MATCH_SITES_ONLY(static const mch::match_site __match_site(__FILE__,__LINE__,XTL_FUNCTION); mch::match_sample __match_sample(__match_site);) \
+        XTL_TRACE_MATCH_SITES_ONLY(static const mch::match_trace_site __trace_site(__FILE__,__LINE__,XTL_FUNCTION); mch::match_trace __match_trace(__trace_site);) \
+        XTL_MEMOIZE_MEMBERS_ONLY(mch::member_memo_scope __member_memo_scope;)  \
+        XTL_TYPE_PROFILE_ONLY(static auto* const __profile_site = mch::type_profile::enroll(__vtbl2case_map,__FILE__,__LINE__,XTL_FUNCTION,XTL_ENUM(N,XTL_PREFIX,subject_ptr));) \
         mch::type_switch_info<N>& __switch_info = __vtbl2case_map.get(__vtbl); \
+        XTL_SAMPLE_MATCH_SITES_ONLY(__match_sample.observe(__switch_info.target);) \
+        XTL_TRACE_MATCH_SITES_ONLY(__match_trace.observe(__switch_info.target,XTL_ENUM(N,XTL_PREFIX,subject_ptr));) \
+        XTL_TYPE_PROFILE_ONLY(if (XTL_UNLIKELY(__switch_info.target == 0)) mch::type_profile::recall(__profile_site,__switch_info,XTL_ENUM(N,XTL_PREFIX,subject_ptr));) \
         switch (__switch_info.target) {                                        \
         default: {
 
@@ -148,7 +168,7 @@ enum { default_layout = size_t(~0) };
 //#define Match7(x0,x1,x2,x3,x4,x5,x6)    MatchN(7,x0,x1,x2,x3,x4,x5,x6)   
 //#define Match8(x0,x1,x2,x3,x4,x5,x6,x7) MatchN(8,x0,x1,x2,x3,x4,x5,x6,x7)
 
-#define XTL_DYN_CAST_FROM(i,...) (__casted_ptr##i = dynamic_cast<const XTL_SELECT_ARG(i,__VA_ARGS__)*>(subject_ptr##i)) != 0
+#define XTL_DYN_CAST_FROM(i,...) (XTL_OVERHEAD_ACCOUNTING_ONLY(mch::count_type_test_cast<XTL_SELECT_ARG(i,__VA_ARGS__),source_type##i>(),) __casted_ptr##i = dynamic_cast<const XTL_SELECT_ARG(i,__VA_ARGS__)*>(subject_ptr##i)) != 0
 #define XTL_ASSIGN_OFFSET(i,...) __switch_info.offset[i] = intptr_t(__casted_ptr##i)-intptr_t(subject_ptr##i);
 #define XTL_ADJUST_PTR_FROM(i,...) auto& match##i = *mch::adjust_ptr<XTL_SELECT_ARG(i,__VA_ARGS__)>(subject_ptr##i,__switch_info.offset[i]); XTL_UNUSED(match##i)
 
@@ -163,8 +183,8 @@ enum { default_layout = size_t(~0) };
             enum { target_label = XTL_COUNTER-__base_counter, is_inside_case_clause = 1 }; \
             if (XTL_LIKELY(__switch_info.target == 0))                         \
             {                                                                  \
-                __switch_info.target = target_label;                           \
                 XTL_REPEAT(N, XTL_ASSIGN_OFFSET, XTL_EMPTY())                  \
+                __switch_info.target = target_label;                           \
             }                                                                  \
         case target_label:                                                     \
             XTL_REPEAT(N, XTL_ADJUST_PTR_FROM, __VA_ARGS__)
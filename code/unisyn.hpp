@@ -45,12 +45,21 @@
 
 #pragma once
 
+#include "cast_hook.hpp"     // Type tests without RTTI
 #include "has_member.hpp"    // Meta-functions to check use of certain #bindings facilities
 #include "patterns/bindings.hpp"
 #include "vtblmap.hpp"
-#include <unordered_map>
+#include <algorithm>
 #include <vector>
 
+#if XTL_OVERHEAD_ACCOUNTING
+#include "overhead.hpp"  // Counters of allocations, casts and updates
+#endif
+
+#if XTL_TRACE_FREQUENCY
+#include "frequency.hpp"     // Counts of classes seen by Match statements
+#endif
+
 namespace mch ///< Mach7 library namespace
 {
 
@@ -72,11 +81,6 @@ enum lbl_type { min_lbl = size_t(0), max_lbl = ~size_t(0) };
 
 } // of namespace mch
 
-namespace std
-{
-    template <> struct hash<mch::lbl_type> { size_t operator()(const mch::lbl_type& l) const noexcept { return l; } };
-} // of namespace std
-
 namespace mch ///< Mach7 library namespace
 {
 
@@ -116,7 +120,10 @@ template <typename T> inline lbl_type original2remapped(tag_type t) { return lbl
 
 //------------------------------------------------------------------------------
 
-typedef std::unordered_map<lbl_type, const lbl_type*> kind_to_kinds_map;
+/// Tag precedence lists of all the kinds of a class hierarchy indexed by their
+/// remapped kind. Remapped kinds are close to 0, so a dense array of them is
+/// small, while getting a list becomes a single indexed load.
+typedef std::vector<const lbl_type*> kind_to_kinds_map;
 
 template <typename T>
 inline kind_to_kinds_map& get_kind_to_kinds_map() noexcept 
@@ -124,31 +131,233 @@ inline kind_to_kinds_map& get_kind_to_kinds_map() noexcept
     static kind_to_kinds_map k2k;
     return k2k;
 }
-/*
-template <typename T>
-struct kind_to_kinds_map_of
+
+/// Preorder numbering of the kinds of a single-inheritance class hierarchy.
+/// Kinds derived from a given one are numbered right after it, so a kind is
+/// derived from another one when its number falls into the range of numbers of
+/// the other one's subtree. This turns subtype tests into two compares instead
+/// of a walk of the tag precedence list. The kinds are user-assigned, so the
+/// numbers live in a table indexed by the remapped kind rather than replace it.
+class kind_preorder
 {
-    static kind_to_kinds_map k2k;
+public:
+
+    kind_preorder() : m_tree(false) {}
+
+    /// Whether the tag precedence lists seen so far form a tree
+    bool is_tree() const noexcept { return m_tree; }
+
+    /// Number of derived_kind falls into the range of base_kind. Only meaningful
+    /// when both kinds have their numbers, \see has_range.
+    bool contains(lbl_type base_kind, lbl_type derived_kind) const noexcept
+    {
+        const range& b = m_ranges[base_kind];
+        const size_t d = m_ranges[derived_kind].first;
+        return b.first <= d && d <= b.last;
+    }
+
+    /// Whether the tag precedence list of kind has been associated yet
+    bool has_range(lbl_type kind) const noexcept
+    {
+        return size_t(kind) < m_ranges.size() && m_ranges[kind].first;
+    }
+
+    /// Renumbers the kinds from their tag precedence lists. A hierarchy is 
+    /// numbered only when every list is its kind followed by the list of its 
+    /// parent, which is the first kind after it. Kinds whose parent's list is
+    /// not known are roots, as long as no other kind on their list is known.
+    void rebuild(const kind_to_kinds_map& k2k)
+    {
+        const size_t n = k2k.size();
+        std::vector<size_t> parent(n, 0);
+
+        m_ranges.assign(n, range());
+        m_tree = true;
+
+        for (size_t k = 0; k < n && m_tree; ++k)
+        {
+            const lbl_type* kinds = k2k[k];
+
+            if (!kinds)
+                continue;
+
+            if (size_t(kinds[0]) != k)
+                m_tree = false;
+            else
+            if (known(kinds[1], k2k))
+                m_tree = same_list(kinds+1, k2k[kinds[1]]) && (parent[k] = kinds[1]);
+            else
+                for (const lbl_type* p = kinds+1; *p && m_tree; ++p)
+                    m_tree = !known(*p, k2k);
+        }
+
+        if (!m_tree)
+            return;
+
+        // Siblings are linked in reverse to keep the children in kind order
+        std::vector<size_t> child(n, 0), sibling(n, 0);
+
+        for (size_t k = n; k-- > 0; )
+            if (parent[k])
+                sibling[k] = child[parent[k]], child[parent[k]] = k;
+
+        size_t number = 0;
+
+        for (size_t k = 0; k < n; ++k)
+            if (k2k[k] && !parent[k])
+                number = enumerate(k, child, sibling, number);
+    }
+
+    /// Number of bytes used by the numbering
+    size_t memory_used() const noexcept { return sizeof(*this) + m_ranges.capacity()*sizeof(range); }
+
+private:
+
+    /// Numbers of a kind and of the last kind in its subtree. 0 is not a number.
+    struct range { range() : first(0), last(0) {} size_t first, last; };
+
+    static bool known(lbl_type kind, const kind_to_kinds_map& k2k) noexcept
+    {
+        return kind && size_t(kind) < k2k.size() && k2k[kind];
+    }
+
+    static bool same_list(const lbl_type* a, const lbl_type* b) noexcept
+    {
+        while (*a && *a == *b)
+            ++a, ++b;
+
+        return *a == *b;
+    }
+
+    /// Numbers kind and the kinds derived from it starting with number+1 and
+    /// returns the last number used.
+    size_t enumerate(size_t kind, const std::vector<size_t>& child, const std::vector<size_t>& sibling, size_t number)
+    {
+        m_ranges[kind].first = ++number;
+
+        for (size_t k = child[kind]; k; k = sibling[k])
+            number = enumerate(k, child, sibling, number);
+
+        return m_ranges[kind].last = number;
+    }
+
+    bool               m_tree;   ///< Numbering is valid
+    std::vector<range> m_ranges; ///< Ranges indexed by kind
 };
 
 template <typename T>
-kind_to_kinds_map kind_to_kinds_map_of<T>::k2k;
-*/
+inline kind_preorder& get_kind_preorder() noexcept
+{
+    static kind_preorder po;
+    return po;
+}
+
+/// Number of bytes used by the map of tag precedence lists of classes derived 
+/// from T and by their preorder numbering. The lists themselves are constant 
+/// arrays, \see mch::kinds_of.
+template <typename T>
+inline size_t kind_to_kinds_memory_used() noexcept
+{
+    const kind_to_kinds_map& k2k = get_kind_to_kinds_map<T>();
+    return sizeof(k2k) + k2k.capacity()*sizeof(const lbl_type*) + get_kind_preorder<T>().memory_used();
+}
 
 /// Gets all the kinds of a class with static type T and dynamic type represented 
 /// by kind. The first element of the returned list will always be equal to kind,
 /// the last to a dedicated value and those in between to the kinds of base classes.
+/// \note Returns 0 for kinds whose base classes were not specified.
 template <typename T>
 inline const lbl_type* get_kinds(lbl_type kind) noexcept
 {
-    return get_kind_to_kinds_map<T>()[kind];
+    const kind_to_kinds_map& k2k = get_kind_to_kinds_map<T>();
+    return XTL_LIKELY(size_t(kind) < k2k.size()) ? k2k[kind] : 0;
 }
 
 template <typename T>
 inline const lbl_type* set_kinds(lbl_type kind, const lbl_type* kinds) noexcept
 {
-    return get_kind_to_kinds_map<T>()[kind] = kinds;
+    kind_to_kinds_map& k2k = get_kind_to_kinds_map<T>();
+
+    if (size_t(kind) >= k2k.size())
+        k2k.resize(kind+1);
+
+    k2k[kind] = kinds;
+    // Lists are only associated during dynamic initialization, so renumbering
+    // on each of them keeps the numbers ready without checks on the fast path.
+    get_kind_preorder<T>().rebuild(k2k);
+    return kinds;
+}
+
+/// Case labels of the clauses that subjects of each kind have been dispatched 
+/// to by a given Match statement, indexed by the remapped kind of the subject.
+/// The first time a kind without a case clause of its own is seen, its tag
+/// precedence list is walked until a case clause is found, after which 
+/// subjects of that kind jump directly to that clause.
+class kind_to_clause_map
+{
+public:
+
+#if XTL_VTBL_STATISTICS
+    kind_to_clause_map() { maps().push_back(this); }
+   ~kind_to_clause_map() { maps().erase(std::find(maps().begin(), maps().end(), this)); }
+
+    /// Calls f(const kind_to_clause_map&) for every map currently alive
+    template <typename F>
+    static void for_each_map(F f)
+    {
+        for (size_t i = 0; i < maps().size(); ++i)
+            f(*maps()[i]);
+    }
+#endif
+
+    /// Marks the entries of kinds that have not been dispatched yet
+    static lbl_type unknown() noexcept { return max_lbl; }
+
+    /// Case label subjects of a given kind were dispatched to or unknown()
+    lbl_type get(lbl_type kind) const noexcept
+    {
+        return XTL_LIKELY(size_t(kind) < m_targets.size()) ? m_targets[kind] : unknown();
+    }
+
+    /// Records the kind of the tag precedence list of kind tried next
+    void set(lbl_type kind, lbl_type target)
+    {
+        if (XTL_UNLIKELY(size_t(kind) >= m_targets.size()))
+        {
+            XTL_OVERHEAD_ACCOUNTING_ONLY(const size_t capacity = m_targets.capacity());
+            m_targets.resize(kind+1, unknown());
+            XTL_OVERHEAD_ACCOUNTING_ONLY(mch::count_growth(m_targets, capacity));
+        }
+
+        m_targets[kind] = target;
+    }
+
+    /// Number of bytes used by the map
+    size_t memory_used() const noexcept { return sizeof(*this) + m_targets.capacity()*sizeof(lbl_type); }
+
+private:
+
+#if XTL_VTBL_STATISTICS
+    /// All the maps currently alive
+    static std::vector<const kind_to_clause_map*>& maps()
+    {
+        static std::vector<const kind_to_clause_map*> all;
+        return all;
+    }
+#endif
+
+    std::vector<lbl_type> m_targets; ///< Case labels indexed by kind
+};
+
+#if XTL_VTBL_STATISTICS
+/// Number of bytes used by the maps of all the Match statements on kinds alive
+inline size_t kind_to_clause_maps_memory_used() noexcept
+{
+    size_t result = 0;
+    kind_to_clause_map::for_each_map([&result](const kind_to_clause_map& m) { result += m.memory_used(); });
+    return result;
 }
+#endif
 
 template <typename D, typename B>
 struct associate_kinds
@@ -160,14 +369,48 @@ struct associate_kinds
 template <typename D, typename B>
 const lbl_type* associate_kinds<D,B>::kinds = set_kinds<B>(remapped<D>::lbl, bindings<D>::get_kinds());
 
+/// Tag precedence list of class D with base classes B... listed by #BCS. 
+/// The list is a constant array, whose initializer only involves kinds known
+/// at compile time, so it is initialized statically without any startup code.
+/// What remains done during dynamic initialization is the association of the
+/// list with the kind of D in the maps of its base classes, since the set of
+/// classes derived from a given one is only known once the program is linked.
+template <typename D, typename... B>
+struct kinds_of
+{
+    static const lbl_type value[sizeof...(B)+1]; ///< Kinds of B... followed by end of list
+
+    static const lbl_type* get() noexcept
+    {
+        const int associated[] = { 0, (ignore_unused(associate_kinds<D,B>::kinds), 0)... };
+        ignore_unused(associated);
+        return value;
+    }
+
+    template <typename T> static void ignore_unused(const T&) noexcept {}
+};
+
+template <typename D, typename... B>
+const lbl_type kinds_of<D,B...>::value[sizeof...(B)+1] = { remapped<B>::lbl..., lbl_type(0) };
+
 /// Checks whether a given base_kind belongs to the tag precedence list of derived_kind
 template <typename T>
 inline bool is_base_and_derived_kinds(lbl_type base_kind, lbl_type derived_kind) noexcept
 {
+    // Exact matches do not depend on whether the list has been associated yet
+    if (base_kind == derived_kind)
+        return true;
+
+    const kind_preorder& po = get_kind_preorder<T>();
+
+    // Single-inheritance hierarchies answer with a range compare
+    if (XTL_LIKELY(po.is_tree() && po.has_range(base_kind) && po.has_range(derived_kind)))
+        return po.contains(base_kind, derived_kind);
+
     const lbl_type* all_kinds = get_kinds<T>(derived_kind);
 
     if (!all_kinds)
-        return base_kind == derived_kind;
+        return false;
 
     while (*all_kinds)
         if (*all_kinds++ == base_kind)
@@ -178,6 +421,13 @@ inline bool is_base_and_derived_kinds(lbl_type base_kind, lbl_type derived_kind)
 
 //------------------------------------------------------------------------------
 
+/// Frequency given to #FQ in bindings of T, call with 0 as argument
+template <typename T> constexpr size_t expected_frequency(decltype(bindings<T>::fq)*) { return bindings<T>::fq; }
+/// Bindings of T without #FQ
+template <typename T> constexpr size_t expected_frequency(...) { return 0; }
+
+//------------------------------------------------------------------------------
+
 /// A traits-like class used by pattern matching library to unify the syntax of
 /// open and close cases. This is different from defining the XTL_DEFAULT_SYNTAX, 
 /// which will make the choice global for every class hierarchy and Match 
@@ -324,6 +574,7 @@ public:
     {
         const void*       casted_ptr;
         type_switch_info* switch_info_ptr;
+        XTL_USE_VTBL_FREQUENCY_ONLY(static_data_type* map;) ///< Map of switch_info_ptr
     };
 
     /// Meta function that defines some case labels required to support extended switch.
@@ -341,8 +592,12 @@ public:
     };
 
     /// Function used to get the value we'll be switching on
+    /// \note Under #XTL_TRACE_FREQUENCY, classes of subjects are counted per 
+    ///       source type rather than per Match statement
     static inline size_t choose(const source_type* subject_ptr, static_data_type& static_data, local_data_type& local_data) noexcept
     {
+        XTL_TRACE_FREQUENCY_ONLY(static frequency_site site; site.hit(subject_ptr);)
+        XTL_USE_VTBL_FREQUENCY_ONLY(local_data.map = &static_data;)
         local_data.switch_info_ptr = &static_data.get(subject_ptr);
         return local_data.switch_info_ptr->target;
     }
@@ -407,7 +662,14 @@ public:
             /// during the fall-through behavior.
             static inline bool main_condition(const source_type* subject_ptr, local_data_type& local_data) noexcept
             {
-                return (local_data.casted_ptr = dynamic_cast<const target_type*>(subject_ptr)) != 0;
+                XTL_TRACE_FREQUENCY_ONLY(static const bool bound = frequency_profile::get().bind<target_type>(); XTL_UNUSED(bound))
+                local_data.casted_ptr = hooked_cast<const target_type*>(subject_ptr);
+            #if XTL_USE_VTBL_FREQUENCY
+                // Only classes of subjects themselves, not their bases, tell how often vtbl is requested
+                if (local_data.casted_ptr && local_data.switch_info_ptr->target == 0 && typeid(*subject_ptr) == typeid(target_type))
+                    local_data.map->expect(*local_data.switch_info_ptr, expected_frequency<target_type>(0));
+            #endif
+                return local_data.casted_ptr != 0;
             }
 
             /// Performs the necessary conversion of the original subject into the proper
@@ -458,14 +720,15 @@ public:
 
     /// Type of data that has to be statically allocated inside the block 
     /// containg extended switch
-    typedef std::vector<const lbl_type*> static_data_type;
+    typedef kind_to_clause_map static_data_type;
 
     /// Type of data that has to be automatically allocated inside the block 
     /// containg extended switch
     struct local_data_type
     {
-        local_data_type() : kinds(0)/*, attempt(0)*/ {} // NOTE: attempt is not intialized on purpose for performance reasons. It will be initialized before use in on_default.
+        local_data_type() : kinds(0)/*, attempt(0)*/ {} // NOTE: attempt and derived are not intialized on purpose for performance reasons. They will be initialized before use in on_default.
         const lbl_type* kinds;
+        lbl_type        derived; ///< Kind of the subject whose tag precedence list is walked
         //size_t          attempt;
     };
 
@@ -511,18 +774,28 @@ public:
             /// FIX: The use of vector and resize in it assumes at the moment small tags in 
             ///      region 0..k. Tag randomization will overuse memory!
 
+            // Kinds dispatched before jump directly to their clause
+            const lbl_type target = static_data.get(lbl_type(jump_target));
+
+            if (XTL_LIKELY(target != kind_to_clause_map::unknown()))
+            {
+                jump_target = target;
+                return true;
+            }
+
             //local_data.attempt = 0;
-            if (XTL_UNLIKELY(jump_target >= static_data.size()))
-                static_data.resize(jump_target+1);
-            local_data.kinds = static_data[jump_target];
-            if (!local_data.kinds)
-                local_data.kinds = static_data[jump_target] = get_kinds<source_type>(lbl_type(jump_target));
+            local_data.derived = lbl_type(jump_target);
+            local_data.kinds   = get_kinds<source_type>(lbl_type(jump_target));
         }
         XTL_ASSERT(xtl_failure("Base classes for this kind were not specified",local_data.kinds));
         //XTL_ASSERT(xtl_failure("Invalid list of kinds",local_data.kinds[local_data.attempt]==jump_target));
         //jump_target = local_data.kinds ? local_data.kinds[++local_data.attempt] : lbl_type(match_exit_label);
         XTL_ASSERT(xtl_failure("Invalid list of kinds",*local_data.kinds==jump_target));
         jump_target = local_data.kinds ? *++local_data.kinds : lbl_type(match_exit_label);
+        // The last kind tried is the one that has a clause, which is remembered
+        // unless the list has not been associated with the kind yet
+        if (XTL_LIKELY(local_data.kinds))
+            static_data.set(local_data.derived, lbl_type(jump_target));
         return true;
     }
     /// Structure used to disambiguate whether first argument is a type or a value.
@@ -0,0 +1,170 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file defines class vtbl_front_cache<N,T> - a small per-thread 
+/// direct-mapped cache that multi-threaded vtbl maps consult before looking 
+/// into their shared data structure.
+///
+/// \note This file is not meant to be included directly. It is included by
+///       vtblmap3mt.hpp and vtblmap4mt.hpp when #XTL_THREAD_LOCAL_CACHE is enabled.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#pragma once
+
+// --------------------[ Design Notes ]--------------------
+// - Every thread has one table of 2^XTL_LOCAL_CACHE_LOG_SIZE entries per
+//   instantiation vtbl_front_cache<N,T>. The table is shared by all the maps
+//   with the same N and T, so each entry is tagged with a unique id of the
+//   map that filled it. Ids are never reused, thus entries filled by a map
+//   that has been destroyed can never be mistaken for those of a new map
+//   allocated at the same address.
+// - Entries only store a pointer to the value inside the shared map. Both 
+//   multi-threaded maps guarantee that such values never move or get 
+//   deallocated until the map itself is destroyed.
+// - The hit path only touches thread-local memory and performs no atomic 
+//   operations. A miss just overwrites the entry with the result of the 
+//   lookup in the shared map - there is no eviction policy, and no 
+//   invalidation is needed since the shared map never changes the value
+//   address associated with given vtbl pointers.
+//------------------------------------------------------------------------------
+
+#include "config.hpp"    // Various compiler/platform dependent macros
+#include <atomic>
+
+#if !XTL_SUPPORT(thread_local)
+#error XTL_THREAD_LOCAL_CACHE requires compiler support of thread_local storage duration
+#endif
+
+namespace mch ///< Mach7 library namespace
+{
+
+//------------------------------------------------------------------------------
+
+/// Per-thread direct-mapped cache of N vtbl-pointers to addresses of values 
+/// of type T stored in a shared map. An object of this class is a member of 
+/// the shared map and only holds the map's id, while the entries themselves
+/// live in thread-local storage.
+template <size_t N, typename T>
+class vtbl_front_cache
+{
+public:
+
+    /// Log of the number of entries in each thread's table
+    static const size_t log_size = XTL_LOCAL_CACHE_LOG_SIZE;
+
+    vtbl_front_cache() : id(next_id()) {}
+
+    /// Returns the value associated with vtbl pointers from the thread's table
+    /// or, when not there, the value returned by shared_get(), remembering it.
+    /// \note shared_get must be callable without arguments and return T&.
+    template <typename F>
+    inline T& get(const intptr_t (&vtbl)[N], F shared_get) noexcept
+    {
+        entry& e = table()[index(vtbl)];
+
+        if (XTL_LIKELY(e.is_for(id, vtbl)))
+            return *e.value;
+
+        T& result = shared_get();
+
+        for (size_t i = 0; i < N; ++i)
+            e.vtbl[i] = vtbl[i];
+
+        e.value = &result;
+        e.owner = id;
+        return result;
+    }
+
+private:
+
+    /// Entry of the thread's table. Zero-initialized entries have owner 0,
+    /// which is never assigned to any map.
+    struct entry
+    {
+        bool is_for(size_t map, const intptr_t (&vt)[N]) const noexcept
+        {
+            if (owner != map)
+                return false;
+
+            for (size_t i = 0; i < N; ++i)
+                if (vtbl[i] != vt[i])
+                    return false;
+
+            return true;
+        }
+
+        size_t   owner;   ///< Id of the map this entry belongs to
+        intptr_t vtbl[N]; ///< Vtbl pointers of the entry
+        T*       value;   ///< Address of the value in the shared map
+    };
+
+    /// The table of the calling thread
+    static entry* table() noexcept
+    {
+        static thread_local entry entries[1 << log_size]; // Zero-initialized
+        return entries;
+    }
+
+    /// Index of the entry for given vtbl pointers of this map
+    inline size_t index(const intptr_t (&vtbl)[N]) const noexcept
+    {
+        size_t h = id;
+
+        for (size_t i = 0; i < N; ++i)
+            h = (h ^ (size_t(vtbl[i]) >> XTL_IRRELEVANT_VTBL_BITS)) * 2654435761u; // Knuth's multiplicative hashing
+
+        return (h ^ (h >> 16)) & ((1 << log_size) - 1);
+    }
+
+    /// Generates unique id for every new map
+    static size_t next_id() noexcept
+    {
+        static std::atomic<size_t> last(0);
+        return ++last;
+    }
+
+    /// Id of the map owning this object
+    const size_t id;
+};
+
+//------------------------------------------------------------------------------
+
+} // of namespace mch
@@ -0,0 +1,248 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file defines vtbl_curried_policy of class vtbl_map<N,T,P>, under which
+/// a map of N polymorphic subjects resolves the vtbl pointer of the first 
+/// subject into a map of the remaining N-1 subjects, and so on, allocating 
+/// the maps only for the prefixes of tuples actually seen.
+///
+/// To use it in Match statements on several subjects include this file and 
+/// define #XTL_VTBL_MAP_POLICY as mch::vtbl_curried_policy<> before them.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#pragma once
+
+// --------------------[ Design Notes ]--------------------
+// - A single cache keyed by the interleaved tuple of N vtbl pointers is sized
+//   after the number of tuples seen, while the bits of the key taken from 
+//   each position are fewer the more positions there are, so tuples differing
+//   in one position collide the more the larger N is. Here every level of 
+//   the trie is a vtbl_map<1> with the level policy of the curried one, whose
+//   key is a single vtbl pointer and whose size only grows with the number 
+//   of classes seen in that position after the given prefix.
+// - Submaps are allocated on the first lookup of their prefix, so the memory 
+//   used is proportional to the number of distinct prefixes of tuples seen,
+//   not to the product of the numbers of classes in each position as with 
+//   vtbl_matrix_policy. Each submap though starts with a cache of 
+//   2^min_log_size entries, so when few tuples share a prefix the single 
+//   cache of the default policy remains smaller.
+// - A hit costs N lookups into vtbl_map<1>, each of which is a shift, a mask 
+//   and a compare, instead of one lookup with an N-fold compare. The policy 
+//   thus pays off when tuples of the default policy keep colliding, not on 
+//   lookup time in general: test/time/synthetic_ternary.cpp compares them.
+// - Submaps never move, so references to values returned by a lookup remain
+//   valid while a nested Match statement populates other paths.
+// - Not available with #XTL_MULTI_THREADING, #XTL_VTBL_COMPACTION or 
+//   #XTL_VTBL_INVALIDATION: entries of the levels own their submaps and may 
+//   not be dropped behind their back.
+//------------------------------------------------------------------------------
+
+#include "vtblmap4.hpp"
+
+#if XTL_MULTI_THREADING
+#error vtbl_curried_policy is only available in single-threaded vtbl maps
+#endif
+
+#if XTL_VTBL_COMPACTION || XTL_VTBL_INVALIDATION
+#error vtbl_curried_policy is not available with compaction or invalidation of vtbl maps
+#endif
+
+namespace mch ///< Mach7 library namespace
+{
+
+//------------------------------------------------------------------------------
+
+/// Policy of vtbl_map<N,T,P> that resolves subjects one at a time through a
+/// trie of vtbl_map<1,...,LevelPolicy>. \see vtblcurried.hpp
+template <typename LevelPolicy = vtbl_map_policy<> >
+struct vtbl_curried_policy
+{
+    typedef LevelPolicy level_policy; ///< Policy of the vtbl_map<1> on each level of the trie
+};
+
+//------------------------------------------------------------------------------
+
+/// This specialization is used when none of the arguments of Match-statement is polymorphic.
+template <typename T, typename P>
+class vtbl_map<0,T,vtbl_curried_policy<P> > : public vtbl_map<0,T,vtbl_map_policy<> >
+{
+public:
+    vtbl_map(XTL_VTBL_COUNTERS_ONLY(const char* file, size_t line, const char* func,) const vtbl_count_t& num_clauses)
+        : vtbl_map<0,T,vtbl_map_policy<> >(XTL_VTBL_COUNTERS_ONLY(file,line,func,) num_clauses) {}
+};
+
+//------------------------------------------------------------------------------
+
+/// The last level of the trie is a vtbl_map<1> with the level policy.
+template <typename T, typename P>
+class vtbl_map<1,T,vtbl_curried_policy<P> > : public vtbl_map<1,T,P>
+{
+public:
+    vtbl_map(XTL_VTBL_COUNTERS_ONLY(const char* file, size_t line, const char* func,) const vtbl_count_t& num_clauses)
+        : vtbl_map<1,T,P>(XTL_VTBL_COUNTERS_ONLY(file,line,func,) num_clauses) {}
+};
+
+//------------------------------------------------------------------------------
+
+/// Map of N polymorphic subjects to values of type T that resolves the first
+/// subject into a map of the remaining N-1 subjects.
+template <size_t N, typename T, typename P>
+class vtbl_map<N,T,vtbl_curried_policy<P> > : public vtbl_map_subjects<vtbl_map<N,T,vtbl_curried_policy<P> >,T>
+{
+private:
+
+    typedef vtbl_curried_policy<P>     policy;
+    typedef vtbl_map<N-1,T,policy>     rest_map; ///< Map of the remaining subjects
+    typedef vtbl_map<1,rest_map*,P>    head_map; ///< Map of the first subject to the map of the remaining ones
+
+public:
+
+#if XTL_VTBL_COUNTERS
+    vtbl_map(const char* file, size_t line, const char* func, const vtbl_count_t& num_clauses) : head(file, line, func, num_clauses) {}
+#endif
+    vtbl_map(const vtbl_count_t& num_clauses) : head(num_clauses) {}
+
+   ~vtbl_map() { head.for_each(release()); }
+
+    /// Main function that will be used to get a reference to the stored element. 
+    inline T& get(const intptr_t (&vtbl)[N]) noexcept
+    {
+        const intptr_t first[1] = {vtbl[0]};
+        rest_map*& rest = head.get(first);
+
+        if (XTL_UNLIKELY(!rest))
+            rest = new rest_map(unknown_clauses);
+
+        intptr_t others[N-1];
+        std::copy(&vtbl[1], &vtbl[N], others);
+        return rest->get(others);
+    }
+
+    // Lookups by subjects are inherited from vtbl_map_subjects
+    using vtbl_map_subjects<vtbl_map<N,T,policy>,T>::get;
+    using vtbl_map_subjects<vtbl_map<N,T,policy>,T>::xtl_get;
+
+    /// Calls f(vtbl,value) for each tuple of vtbl pointers in the map.
+    template <typename F>
+    void for_each(F f) const { head.for_each(prepend<F>(f)); }
+
+    /// Log of the capacity of the first level
+    size_t log_size() const { return head.log_size(); }
+
+    /// The trie does not keep the site of its Match statement. \see vtbl_map::locate
+    XTL_VTBL_COUNTERS_ONLY(bool locate(const char*, size_t, const char*) { return true; })
+
+    /// Number of irrelevant bits of vtbl pointers of the first subject
+    bit_offset_t shift(size_t) const { return head.shift(0); }
+
+    /// Memory in bytes used by all levels of the trie
+    size_t memory_used() const 
+    {
+        size_t bytes = sizeof(*this) - sizeof(head) + head.memory_used();
+        head.for_each(measure(bytes));
+        return bytes;
+    }
+
+private:
+
+    vtbl_map(const vtbl_map&);            ///< No copy constructor
+    vtbl_map& operator=(const vtbl_map&); ///< No assignment operator
+
+    /// Deletes the submaps of the first level
+    struct release
+    {
+        void operator()(const intptr_t (&)[1], rest_map* rest) const { delete rest; }
+    };
+
+    /// Adds up the memory used by the submaps of the first level
+    struct measure
+    {
+        measure(size_t& bytes) : bytes(bytes) {}
+        void operator()(const intptr_t (&)[1], const rest_map* rest) const { if (rest) bytes += rest->memory_used(); }
+        size_t& bytes;
+    };
+
+    /// Passes the tuples of a submap to f with the vtbl pointer of the first subject in front
+    template <typename F>
+    struct prepend
+    {
+        prepend(F& f) : f(f) {}
+
+        void operator()(const intptr_t (&first)[1], const rest_map* rest) const
+        {
+            if (rest)
+                rest->for_each(append(f, first[0]));
+        }
+
+        struct append
+        {
+            append(F& f, intptr_t first) : f(f), first(first) {}
+
+            void operator()(const intptr_t (&others)[N-1], const T& value) const
+            {
+                intptr_t vtbl[N] = {first};
+                std::copy(&others[0], &others[N-1], &vtbl[1]);
+                f(vtbl, value);
+            }
+
+            F&       f;
+            intptr_t first;
+        };
+
+        F& f;
+    };
+
+    /// Map of the first subject to the submaps of the remaining ones
+    head_map head;
+
+    /// Submaps only hold the classes seen after their prefix, so the number 
+    /// of case clauses of the Match statement is no estimate of their size
+    static const vtbl_count_t unknown_clauses;
+};
+
+//------------------------------------------------------------------------------
+
+template <size_t N, typename T, typename P>
+const vtbl_count_t vtbl_map<N,T,vtbl_curried_policy<P> >::unknown_clauses = 0;
+
+//------------------------------------------------------------------------------
+
+} // of namespace mch
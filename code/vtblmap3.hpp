@@ -826,6 +826,7 @@ struct type_switch_info
 {
     std::ptrdiff_t offset; ///< Required this-pointer offset to the source sub-object
     std::size_t    target; ///< Case label of the jump target of Match statement
+    XTL_COMPUTED_GOTO_ONLY(void* jump;) ///< Address of the jump target of MatchP \see #XTL_USE_COMPUTED_GOTO
 };
 
 //------------------------------------------------------------------------------
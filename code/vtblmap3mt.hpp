@@ -76,6 +76,24 @@
 //   when that vtbl conflicts with some that was not in conflict before.
 //------------------------------------------------------------------------------
 
+// --------------------[ Memory Ordering ]--------------------
+// - Operations outside of the hit path keep the default sequentially 
+//   consistent ordering. The hit path only uses what it needs, since on ARM
+//   and POWER stronger loads cost barriers on every lookup:
+// - The descriptor is loaded with acquire. It pairs with the release part of
+//   the exchange that published it, after which its cache and all the entries
+//   it can point to have been constructed.
+// - The shift is loaded relaxed. Any value of it gives an index within the 
+//   mask and a stale one only results in a miss, which rereads it.
+// - The cache cell is loaded relaxed. Cells only ever point to entries that
+//   were constructed before the descriptor was published, which the acquire
+//   load of the descriptor has already ordered.
+// - The vtbl pointer of the entry is loaded relaxed. Entries are claimed by
+//   an exchange of vtbl pointer 0 for the new one and nothing else is 
+//   published with it: the value is filled by the caller of get() after the
+//   claim, so acquire would not order anything more for the hit path.
+//------------------------------------------------------------------------------
+
 #include <algorithm>
 #include <atomic>
 #include <cmath>
@@ -83,6 +101,22 @@
 #include "ptrtools.hpp"  // Helper functions to work with pointers
 #include "config.hpp"    // Various compiler/platform dependent macros
 
+#if XTL_STATIC_PROBES
+#include "probes.hpp"    // Static probes on misses and updates
+#endif
+
+#if XTL_OVERHEAD_ACCOUNTING
+#include "overhead.hpp"  // Counters of allocations, casts and updates
+#endif
+
+#if XTL_THREAD_LOCAL_CACHE
+#include "vtblcache.hpp" // Per-thread front cache of the map
+#endif
+
+#if XTL_RECLAIM_DESCRIPTORS
+#include "vtblreclaim.hpp" // Deallocation of replaced descriptors
+#endif
+
 #if XTL_DUMP_PERFORMANCE
 // For print out purposes only
 #include <bitset>
@@ -92,6 +126,11 @@
 #include <vector>
 #endif
 
+#if XTL_VTBL_STATISTICS
+#include <mutex>         // Registry of all maps is shared between threads
+#include <vector>
+#endif
+
 namespace mch ///< Mach7 library namespace
 {
 
@@ -116,6 +155,11 @@ const bit_offset_t max_log_inc       = XTL_MAX_LOG_INC;  ///< Log of the maximum
 const vtbl_count_t min_expected_size = 1 << min_log_size;
 const bit_offset_t irrelevant_bits   = XTL_IRRELEVANT_VTBL_BITS;
 const int initial_collisions_before_update = 1;
+
+/// Shift new caches start with: the measured alignment of vtbl-pointers, but 
+/// not less than #irrelevant_bits, since the lowest relevant bits of vtbls of
+/// small classes carry little entropy as well. \see vtbl_irrelevant_bits
+inline size_t initial_shift() noexcept { return std::max<size_t>(irrelevant_bits, vtbl_irrelevant_bits()); }
 const int renewed_collisions_before_update = 16;
 
 /// Natural logarithm of 2 needed for conversion into log base 2.
@@ -131,6 +175,9 @@ const double ln2 = 0.69314718055994528622676398299518041312694549560546875;
 /// reallocate the contained data. The reason is that all the applications that
 /// use the vtblmap so far rely on the reference to an element associated with 
 /// given vtbl-pointer to not change throughout the lifetime of application. 
+/// Elements thus live in segments owned by the map, while descriptors only 
+/// index them, so that replaced descriptors can be deallocated independently
+/// of the elements, \see #XTL_RECLAIM_DESCRIPTORS.
 template <typename T>
 class vtblmap
 {
@@ -147,11 +194,23 @@ private:
 
             std::atomic<intptr_t> vtbl;  ///< v-table pointer of the value
             T                     value; ///< value associated with the v-table pointer vtbl
+        };
 
-            /// Helper function to in-place construct stored_type inside uninitialized memory
-            void construct()    { new(this) stored_type(); }
-            /// Helper function to manually destroy stored_type
-            void destroy()      { this->~stored_type(); }
+        /// Entries allocated together when the cache grows. Segments are linked
+        /// from the newest to the oldest and never deallocated before the map.
+        struct segment
+        {
+            segment(size_t n, size_t f, const segment* o) : older(o), first(f), begin(new stored_type[n]), end(begin+n) { XTL_OVERHEAD_ACCOUNTING_ONLY(mch::count_allocation(sizeof(*this) + n*sizeof(stored_type))); }
+           ~segment() { delete[] begin; }
+
+            const segment*     const older; ///< Segment allocated before this one
+            const size_t             first; ///< Index of the cache entry its first element was allocated for
+            stored_type*       const begin; ///< First element of the segment
+            stored_type*       const end;   ///< One past the last element of the segment
+
+        private:
+            segment(const segment&);            ///< No copy constructor
+            segment& operator=(const segment&); ///< No assignment operator
         };
 
         /// Cache mask to access entries. Always cache_size-1 since cache_size is a power of 2
@@ -173,19 +232,14 @@ private:
 
         /// Lock-free programming does not have a reliable way so far to detect 
         /// when old descriptor can be destroyed - not without garbage collection
-        /// at least. Every successful replacement of descriptor thus keeps a 
-        /// pointer to its predecessor. We need this also to be able to traverse
-        /// stored values to which cache entires are pointing to.
+        /// at least. Unless #XTL_RECLAIM_DESCRIPTORS retires it, every successful
+        /// replacement of descriptor thus keeps a pointer to its predecessor, 
+        /// which is deallocated together with this descriptor.
         cache_descriptor*  predecessor;
 
-        /// This is the pointer to array of the entires that this descriptor own.
-        /// Descriptor manages not only own entries, but also the entries it 
-        /// inherited from its predecessor.
-        stored_type* const own_entries_begin;
-
-        /// This is the pointer to one past the end of the array pointed to by 
-        /// own_entries_begin. \warning This value should never be dereferenced!
-        stored_type* const own_entries_end;
+        /// Segment allocated for this descriptor, through which the entries of
+        /// all the descriptors it replaced can be traversed as well.
+        segment* const     entries;
 
         /// Variable-sized array with actual pointers to stored_type
         /// \warning: This must be the last member of this class!
@@ -195,13 +249,13 @@ private:
             #undef new
         #endif
 
-        /// We pass log_size as parameter and allocate enough space to have both
-        /// cache and owned entries be allocated together with the object to
-        /// improve cache locality.
-        void* operator new(size_t s, size_t cache_size, size_t elements_size)
+        /// We pass cache size as parameter and allocate enough space to have 
+        /// the cache allocated together with the object.
+        void* operator new(size_t s, size_t cache_size)
         {
             // FIX: Ensure proper alignment requirements
-            return ::new char[s + (cache_size-XTL_VARIABLE_SIZE_ARRAY)*sizeof(std::atomic<stored_type*>) + elements_size*sizeof(stored_type)];
+            XTL_OVERHEAD_ACCOUNTING_ONLY(mch::count_allocation(s + (cache_size-XTL_VARIABLE_SIZE_ARRAY)*sizeof(std::atomic<stored_type*>)));
+            return ::new char[s + (cache_size-XTL_VARIABLE_SIZE_ARRAY)*sizeof(std::atomic<stored_type*>)];
         }
 
         #if defined(DBG_NEW)
@@ -209,29 +263,25 @@ private:
         #endif
 
         /// We need to declare this placement delete operator since we overload new.
-        void operator delete(void* p, size_t, size_t) { ::delete(static_cast<char*>(p)); }
+        void operator delete(void* p, size_t) { ::delete[](static_cast<char*>(p)); }
 
         /// We also provide non-placement delete operator since it doesn't really depend on extra arguments.
-        void operator delete(void* p)                 { ::delete(static_cast<char*>(p)); }
+        void operator delete(void* p)         { ::delete[](static_cast<char*>(p)); }
 
         /// Creates new cache_descriptor based on parameters k and l of the hashing function
         cache_descriptor(
             const size_t log_size,               ///< Parameter k of the cache - the log of the size of the cache
-            const size_t shift = irrelevant_bits ///< Parameter l of the cache - number of irrelevant bits on the right to remove
+            const size_t shift = initial_shift() ///< Parameter l of the cache - number of irrelevant bits on the right to remove
         ) :
             cache_mask( (1<<log_size) - 1 ),
             optimal_shift(shift),
             used(0),
             predecessor(nullptr),
-            own_entries_begin(reinterpret_cast<stored_type*>(&cache[0]+(1<<log_size))),
-            own_entries_end(own_entries_begin + (1<<log_size))
+            entries(new segment(size_t(1)<<log_size, 0, nullptr))
         {
             // Initialize pointers from cache to newly allocated cache entries
             for (size_t i = 0; i <= cache_mask; ++i)
-            {
-                own_entries_begin[i].construct();  // Initialize uninitialized memory
-                cache[i] = &own_entries_begin[i];  // Make cache point to actual entries
-            }
+                cache[i] = &entries->begin[i];  // Make cache point to actual entries
         }
 
         /// Creates new cache_descriptor based on parameters k and l of the 
@@ -246,39 +296,26 @@ private:
             optimal_shift(shift),
             used(old.size()),
             predecessor(&old),
-            own_entries_begin(reinterpret_cast<stored_type*>(&cache[0]+(1<<log_size))),
-            own_entries_end(own_entries_begin + (cache_mask - old.cache_mask))
+            entries(new segment(cache_mask - old.cache_mask, old.size(), old.entries))
         {
             XTL_ASSERT(cache_mask > old.cache_mask);   // Since we are going to inherit all its existing elements
             XTL_ASSERT(old.used.load() == old.size()); // Since we replace descriptors only when they are full
 
-            // Initialize remaining pointers from cache to newly allocated cache entries
-            for (size_t j = 0, i = old.size(); i <= cache_mask; ++i, ++j)
-            {
-                own_entries_begin[j].construct();  // Initialize uninitialized memory
-                cache[i] = &own_entries_begin[j];  // Make cache point to actual entries
-            }
-
-            // Initialize cache pointers to cache entries from old caches.
+            // Initialize cache pointers to the entries of this and old segments.
             // NOTE: we have to initialize it to addresses of actual entries
             //       instead of just copying the content of old cache because
             //       the content of cache may still be changing by other threads
             //       making us see some values twice or none times.
-            for (cache_descriptor* dsc = &old; dsc; dsc = dsc->predecessor)
-            {
-                for (size_t j = 0, i = dsc->predecessor ? dsc->predecessor->size() : 0; i <= dsc->cache_mask; ++i, ++j)
-                    cache[i] = &dsc->own_entries_begin[j];  // Make cache point to actual entries
-            }
+            for (const segment* seg = entries; seg; seg = seg->older)
+                for (size_t j = 0; seg->begin + j != seg->end; ++j)
+                    cache[seg->first + j] = &seg->begin[j];  // Make cache point to actual entries
         }
 
-        /// Deallocates memory used for elements.
+        /// Deallocates descriptors kept alive by this one. Segments are owned by the map.
         /// \note Lock-free programming practices do not have reliable way of 
         ///       knowing when an old atomic descriptor can be destroyed.
         ~cache_descriptor()
         {
-            for (stored_type* p = own_entries_begin; p != own_entries_end; ++p)
-                p->destroy();
-
             if (predecessor)
                 delete predecessor;
         }
@@ -286,8 +323,17 @@ private:
         bool is_full() const { return used > cache_mask; } ///< Checks whether cache is full
         size_t  size() const { return cache_mask+1; }      ///< Number of entries in cache
 
-        const stored_type* operator[](intptr_t vtbl) const { return cache[(vtbl>>optimal_shift) & cache_mask]; }
-              stored_type* operator[](intptr_t vtbl)       { return cache[(vtbl>>optimal_shift) & cache_mask]; }
+        /// Number of bytes used by the descriptor and its predecessors, not counting the segments
+        size_t memory_used() const
+        {
+            return sizeof(cache_descriptor) 
+                 + (size()-XTL_VARIABLE_SIZE_ARRAY)*sizeof(std::atomic<stored_type*>) 
+                 + (predecessor ? predecessor->memory_used() : 0);
+        }
+
+        /// Entry in the cell vtbl maps to. Only for the hit path, \see Memory Ordering.
+        XTL_HOT_PATH const stored_type* operator[](intptr_t vtbl) const { return cache[(vtbl>>optimal_shift.load(std::memory_order_relaxed)) & cache_mask].load(std::memory_order_relaxed); }
+        XTL_HOT_PATH       stored_type* operator[](intptr_t vtbl)       { return cache[(vtbl>>optimal_shift.load(std::memory_order_relaxed)) & cache_mask].load(std::memory_order_relaxed); }
 
         /// Eagerly check if vtbl is elsewhere in the cache.
         /// \note This might fail while vtbl is in the cache because
@@ -312,8 +358,8 @@ private:
         inline stored_type* thorough_find(const intptr_t vtbl, std::atomic<stored_type*>*& pce) noexcept
         {
             // Search own storage first
-            for (cache_descriptor* dsc = this; dsc; dsc = dsc->predecessor)
-                for (stored_type* p = dsc->own_entries_begin; p != dsc->own_entries_end; ++p)
+            for (const segment* seg = entries; seg; seg = seg->older)
+                for (const stored_type* p = seg->begin; p != seg->end; ++p)
                     if (p->vtbl == vtbl)
                     {
                         // Loop infinitely till we find it in cache
@@ -333,10 +379,10 @@ private:
             //      consideration
             intptr_t diff = 0;
 
-            for (const cache_descriptor* dsc = this; dsc; dsc = dsc->predecessor)
+            for (const segment* seg = entries; seg; seg = seg->older)
             {
                 // Compute bits in which existing vtbl, including the newly added one, differ
-                for (const stored_type* p = dsc->own_entries_begin; p != dsc->own_entries_end; ++p)
+                for (const stored_type* p = seg->begin; p != seg->end; ++p)
                     if (intptr_t vtbl = p->vtbl)
                     {
                         diff |= prev ^ vtbl;
@@ -465,7 +511,7 @@ public:
         #undef new
     #endif
     vtblmap(const char* fl, size_t ln, const char* fn, const vtbl_count_t expected_size = min_expected_size) : 
-        descriptor(new(1<<req_bits(expected_size-1),1<<req_bits(expected_size-1)) cache_descriptor(req_bits(expected_size-1))),
+        descriptor(new(1<<req_bits(expected_size-1)) cache_descriptor(req_bits(expected_size-1))),
         last_table_size(0),
         collisions_before_update(initial_collisions_before_update),
         file(fl), 
@@ -476,7 +522,9 @@ public:
         hits(0),
         misses(0),
         collisions(0)
-    {}
+    {
+        XTL_VTBL_STATISTICS_ONLY(register_map();)
+    }
     #if defined(DBG_NEW)
         #define new DBG_NEW
     #endif
@@ -486,10 +534,12 @@ public:
         #undef new
     #endif
     vtblmap(const vtbl_count_t expected_size = min_expected_size) :
-        descriptor(new(1<<req_bits(expected_size-1),1<<req_bits(expected_size-1)) cache_descriptor(req_bits(expected_size-1))),
+        descriptor(new(1<<req_bits(expected_size-1)) cache_descriptor(req_bits(expected_size-1))),
         collisions_before_update(initial_collisions_before_update)
         XTL_DUMP_PERFORMANCE_ONLY(,file("unspecified"), line(0), func("unspecified"), updates(0), clauses(expected_size), hits(0), misses(0), collisions(0))
-    {}
+    {
+        XTL_VTBL_STATISTICS_ONLY(register_map();)
+    }
     #if defined(DBG_NEW)
         #define new DBG_NEW
     #endif
@@ -497,7 +547,10 @@ public:
    ~vtblmap()
     {
         XTL_DUMP_PERFORMANCE_ONLY(std::clog << *this << std::endl);
-        delete descriptor.load(); // FIX: in lock free?
+        XTL_VTBL_STATISTICS_ONLY(unregister_map();)
+        cache_descriptor* dsc = descriptor.load();
+        delete_segments(dsc->entries);
+        delete dsc; // FIX: in lock free?
     }
 
     /// This is the main function to get the value of type T associated with
@@ -505,17 +558,31 @@ public:
     ///
     /// \note The function returns the value "by reference" to indicate that you 
     ///       may take address or change the value of the cell!
-    inline T& get(const void* p) noexcept
+    XTL_HOT_PATH inline T& get(const void* p) noexcept
+    {
+    #if XTL_THREAD_LOCAL_CACHE
+        const intptr_t vtbl[1] = {*reinterpret_cast<const intptr_t*>(p)};
+        return front_cache.get(vtbl, [this,p]() -> T& { return this->shared_get(p); });
+    #else
+        return shared_get(p);
+    #endif
+    }
+
+    /// Looks up the value associated with the vtbl of a given pointer in the
+    /// data structure shared by all threads.
+    XTL_HOT_PATH inline T& shared_get(const void* p) noexcept
     {
         typedef typename cache_descriptor::stored_type stored_type;
 
-        cache_descriptor* dsc = descriptor; // Load atomic value for this thread since it may change
+        XTL_RECLAIM_DESCRIPTORS_ONLY(reader_pass done_with_descriptor;) // Whichever way we leave
+
+        cache_descriptor* dsc = descriptor.load(std::memory_order_acquire); // Load atomic value for this thread since it may change
 
         XTL_ASSERT(dsc); // Allocated in constructor, deallocated in destructor, atomically replaced
 
         const intptr_t vtbl = *reinterpret_cast<const intptr_t*>(p);
         stored_type* const st   = (*dsc)[vtbl];
-        const intptr_t cur_vtbl = st->vtbl;
+        const intptr_t cur_vtbl = st->vtbl.load(std::memory_order_relaxed);
 
         XTL_ASSERT(vtbl); // Since this represents VTBL pointer it cannot be null
         XTL_ASSERT(st);   // Since we use stub entry with vtbl==0 to indicate an empty one
@@ -524,6 +591,7 @@ public:
         {
             XTL_DUMP_PERFORMANCE_ONLY(++misses);
             XTL_DUMP_PERFORMANCE_ONLY(if (cur_vtbl) ++collisions);
+            XTL_STATIC_PROBES_ONLY(XTL_PROBE(vtbl_miss, this, vtbl));
 
             if (dsc->is_full()                            // No entries left for possibly new vtbl in the cache
                 || (cur_vtbl                              // Collision - the entry for vtbl is already occupied
@@ -547,6 +615,49 @@ public:
     /// A function that gets called when the cache is either too inefficient or full.
     T& update(intptr_t vtbl);
 
+#if XTL_USE_VTBL_FREQUENCY
+    /// Entries of this map do not count requests, so expected frequencies are ignored
+    void expect(T&, size_t) noexcept {}
+#endif
+
+    /// Number of bytes used by the map, not counting memory owned by its values
+    /// \note Not synchronized with concurrent updates of the map
+    size_t memory_used() const
+    {
+        const cache_descriptor* dsc = descriptor.load();
+        size_t result = sizeof(vtblmap) + dsc->memory_used() XTL_RECLAIM_DESCRIPTORS_ONLY(+ retired.memory_used());
+
+        for (const typename cache_descriptor::segment* seg = dsc->entries; seg; seg = seg->older)
+            result += sizeof(*seg) + (seg->end - seg->begin)*sizeof(typename cache_descriptor::stored_type);
+
+        return result;
+    }
+
+    /// Calls f with the value associated with each vtbl pointer in the map
+    /// \note Not synchronized with concurrent updates of the map
+    template <typename F>
+    void for_each_value(F f) const
+    {
+        for (const typename cache_descriptor::segment* seg = descriptor.load()->entries; seg; seg = seg->older)
+            for (const typename cache_descriptor::stored_type* p = seg->begin; p != seg->end; ++p)
+                if (p->vtbl)
+                    f(p->value);
+    }
+
+#if XTL_VTBL_STATISTICS
+    /// Calls f(const vtblmap&) for every map with values of type T currently alive
+    /// \note f is called under the lock of the list of maps and thus must not 
+    ///       create or destroy maps with values of type T.
+    template <typename F>
+    static void for_each_map(F f)
+    {
+        std::lock_guard<std::mutex> guard(maps_mutex());
+
+        for (size_t i = 0; i < maps().size(); ++i)
+            f(*maps()[i]);
+    }
+#endif
+
 #if XTL_DUMP_PERFORMANCE
     std::ostream& operator>>(std::ostream& os) const;
     friend std::ostream& operator<<(std::ostream& os, const vtblmap& m) { return m >> os; }
@@ -554,9 +665,58 @@ public:
 
 private:
 
+#if XTL_VTBL_STATISTICS
+    /// All the maps with values of type T currently alive
+    static std::vector<const vtblmap*>& maps()
+    {
+        static std::vector<const vtblmap*> all;
+        return all;
+    }
+
+    /// Mutex guarding maps()
+    static std::mutex& maps_mutex()
+    {
+        static std::mutex m;
+        return m;
+    }
+
+    void register_map()
+    {
+        std::lock_guard<std::mutex> guard(maps_mutex());
+        maps().push_back(this);
+    }
+
+    void unregister_map()
+    {
+        std::lock_guard<std::mutex> guard(maps_mutex());
+        maps().erase(std::find(maps().begin(), maps().end(), this));
+    }
+#endif
+
+    /// Deallocates segments of entries from the given one to the oldest
+    static void delete_segments(const typename cache_descriptor::segment* seg)
+    {
+        while (seg)
+        {
+            const typename cache_descriptor::segment* older = seg->older;
+            delete seg;
+            seg = older;
+        }
+    }
+
     /// Cached mappings of vtbl to some indecies
     std::atomic<cache_descriptor*> descriptor;
 
+#if XTL_RECLAIM_DESCRIPTORS
+    /// Replaced descriptors some threads may still be reading
+    retired_list<cache_descriptor> retired;
+#endif
+
+#if XTL_THREAD_LOCAL_CACHE
+    /// Per-thread cache consulted before descriptor
+    vtbl_front_cache<1,T> front_cache;
+#endif
+
     /// Memoized table.size() during last cache rearranging
     std::atomic<size_t> last_table_size;
 
@@ -588,8 +748,15 @@ T& vtblmap<T>::update(intptr_t vtbl)
 #endif
 
     XTL_DUMP_PERFORMANCE_ONLY(++updates); // Record update
+    XTL_STATIC_PROBES_ONLY(XTL_PROBE(vtbl_update, this, vtbl));
+    XTL_OVERHEAD_ACCOUNTING_ONLY(mch::count_vtbl_update());
     collisions_before_update = renewed_collisions_before_update;      // Reset collisions counter
 
+#if XTL_RECLAIM_DESCRIPTORS
+    if (!retired.empty())
+        retired.reclaim(); // Free descriptors replaced earlier that no thread can still be reading
+#endif
+
 ReStart:
 
     cache_descriptor* dsc = descriptor; // Load atomic value for this thread since it may change
@@ -626,8 +793,8 @@ ReStart:
             XTL_BIT_SET(cache_histogram, (vtbl >> j) & cache_mask);               // Mark the entry for new vtbl
 
             // Iterate over vtbl in old cache and see where they are mapped with log size i and offset j
-            for (cache_descriptor* d = dsc; d; d = d->predecessor)
-                for (cache_descriptor::stored_type* p = d->own_entries_begin; p != d->own_entries_end; ++p)
+            for (const typename cache_descriptor::segment* seg = dsc->entries; seg; seg = seg->older)
+                for (const typename cache_descriptor::stored_type* p = seg->begin; p != seg->end; ++p)
                     if (intptr_t vtbl = p->vtbl)
                         XTL_BIT_SET(cache_histogram, (vtbl >> j) & cache_mask); // Mark the entry for each vtbl
 
@@ -663,7 +830,7 @@ ReStart:
         #if defined(DBG_NEW)
             #undef new
         #endif
-        cache_descriptor* new_dsc = new(1<<no,(1<<no)-dsc->cache_mask-1) cache_descriptor(no,zo,*dsc);
+        cache_descriptor* new_dsc = new(1<<no) cache_descriptor(no,zo,*dsc);
         #if defined(DBG_NEW)
             #define new DBG_NEW
         #endif
@@ -671,11 +838,19 @@ ReStart:
         if (descriptor.compare_exchange_strong(dsc, new_dsc)) // descriptor = new_dsc;
         {
             // We successfully updated descriptor
+            XTL_STATIC_PROBES_ONLY(XTL_PROBE(descriptor_swap, this, vtbl));
+        #if XTL_RECLAIM_DESCRIPTORS
+            new_dsc->predecessor = nullptr;
+            retired.retire(dsc);
+        #endif
             dsc = descriptor;
         }
         else
         {
-            // Someone else has replaced descriptor in the mean time
+            // Someone else has replaced descriptor in the mean time. The old
+            // descriptor is now kept alive by the winner, not by us.
+            new_dsc->predecessor = nullptr;
+            delete new_dsc->entries;
             delete new_dsc;
             // dsc now holds the new value of descriptor
         }
@@ -912,6 +1087,7 @@ struct type_switch_info
 {
     std::ptrdiff_t offset; ///< Required this-pointer offset to the source sub-object
     std::size_t    target; ///< Case label of the jump target of Match statement
+    XTL_COMPUTED_GOTO_ONLY(void* jump;) ///< Address of the jump target of MatchP \see #XTL_USE_COMPUTED_GOTO
 };
 
 //------------------------------------------------------------------------------
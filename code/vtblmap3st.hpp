@@ -78,17 +78,26 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <cstring>
+#include <vector>        // Scratch space of rearrangements of large caches
 #include "ptrtools.hpp"  // Helper functions to work with pointers
 #include "config.hpp"    // Various compiler/platform dependent macros
 
+#if XTL_STATIC_PROBES
+#include "probes.hpp"    // Static probes on misses and updates
+#endif
+
+#if XTL_OVERHEAD_ACCOUNTING
+#include "overhead.hpp"  // Counters of allocations, casts and updates
+#endif
+
 #if XTL_DUMP_PERFORMANCE
 // For print out purposes only
 #include <bitset>
 #include <iostream>
 #include <iomanip>
 #include <string>
-#include <vector>
 #endif
 
 namespace mch ///< Mach7 library namespace
@@ -103,18 +112,25 @@ typedef unsigned char  bit_offset_t;
 /// The smallest integral type capable of representing the amount N of different 
 /// vtbl pointers in the program. Roughly N should be equal to some constant c
 /// multiplied by the amount of different classes polymorphic classes in the 
-/// program. Constant c accounts for potential multiple inheritance.
-typedef unsigned short vtbl_count_t;
+/// program. Constant c accounts for potential multiple inheritance. Programs 
+/// with generated hierarchies of more than 2^16 classes exist.
+typedef unsigned int vtbl_count_t;
 //typedef size_t vtbl_count_t;
 
 //------------------------------------------------------------------------------
 
 const bit_offset_t min_log_size      = XTL_MIN_LOG_SIZE; ///< Log of the smallest cache size to start from
 const bit_offset_t max_log_size      = XTL_MAX_LOG_SIZE; ///< Log of the largest cache size to try
+const bit_offset_t max_tuned_log_size= XTL_MAX_TUNED_LOG_SIZE; ///< Log of the largest cache size whose shift is tuned to its vtbl pointers
 const bit_offset_t max_log_inc       = XTL_MAX_LOG_INC;  ///< Log of the maximum allowed increased from the minimum requred log size (1 means twice from the min required size)
 const vtbl_count_t min_expected_size = 1 << min_log_size;
 const bit_offset_t irrelevant_bits   = XTL_IRRELEVANT_VTBL_BITS;
 const int initial_collisions_before_update = 1;
+
+/// Shift new caches start with: the measured alignment of vtbl-pointers, but 
+/// not less than #irrelevant_bits, since the lowest relevant bits of vtbls of
+/// small classes carry little entropy as well. \see vtbl_irrelevant_bits
+inline size_t initial_shift() noexcept { return std::max<size_t>(irrelevant_bits, vtbl_irrelevant_bits()); }
 const int renewed_collisions_before_update = 16;
 
 /// Natural logarithm of 2 needed for conversion into log base 2.
@@ -142,10 +158,11 @@ private:
         /// Type of the stored values, which is a pair of vtbl-pointer and T value.
         struct stored_type
         {
-            stored_type(intptr_t v = 0) : vtbl(v), value() {}
+            constexpr stored_type(intptr_t v = 0) : vtbl(v), value() XTL_USE_VTBL_FREQUENCY_ONLY(, hits(0)) {}
 
             intptr_t vtbl;  ///< v-table pointer of the value
             T        value; ///< value associated with the v-table pointer vtbl
+            XTL_USE_VTBL_FREQUENCY_ONLY(size_t hits;) ///< Number of requests of vtbl since the last update
 
             /// Helper function to in-place construct stored_type inside uninitialized memory
             void construct()    { new(this) stored_type(); }
@@ -178,6 +195,7 @@ private:
         void* operator new(size_t s, size_t log_size)
         {
             // FIX: Ensure proper alignment requirements
+            XTL_OVERHEAD_ACCOUNTING_ONLY(mch::count_allocation(s + ((1<<log_size)-XTL_VARIABLE_SIZE_ARRAY)*sizeof(stored_type*)));
             return ::new char[s + ((1<<log_size)-XTL_VARIABLE_SIZE_ARRAY)*sizeof(stored_type*)];
         }
 
@@ -191,10 +209,14 @@ private:
         /// We also provide non-placement delete operator since it doesn't really depend on extra arguments.
         void operator delete(void* p)         { ::delete(static_cast<char*>(p)); } // We cast to char* to avoid warning on deleting void*, which is undefined
 
+        /// Creates a descriptor of a single never occupied entry e that looks
+        /// full, so that the first lookup through it goes to vtblmap::update().
+        constexpr cache_descriptor(stored_type* e) : cache_mask(0), optimal_shift(0), used(1), cache{e} {}
+
         /// Creates new cache_descriptor based on parameters k and l of the hashing function
         cache_descriptor(
             const size_t log_size,               ///< Parameter k of the cache - the log of the size of the cache
-            const size_t shift = irrelevant_bits ///< Parameter l of the cache - number of irrelevant bits on the right to remove
+            const size_t shift = initial_shift() ///< Parameter l of the cache - number of irrelevant bits on the right to remove
         ) :
             cache_mask( (1<<log_size) - 1 ),
             optimal_shift(shift),
@@ -203,6 +225,7 @@ private:
             // Allocate all cache entries in one chunk for better cache performance.
             // Only allocate the difference from need and already present in old ones
             stored_type* cache_entries = new stored_type[1<<log_size];
+            XTL_OVERHEAD_ACCOUNTING_ONLY(mch::count_allocation((1<<log_size)*sizeof(stored_type)));
 
             // Initialize pointers from cache to newly allocated cache entries
             for (size_t i = 0; i <= cache_mask; ++i)
@@ -230,6 +253,7 @@ private:
             {
                 cache[i] = 0;
                 std::swap(cache[i],old.cache[i]);
+                XTL_USE_VTBL_FREQUENCY_ONLY(cache[i]->hits /= 2); // Let older requests fade out
             }
 
             if (cache_mask - old.cache_mask)
@@ -237,6 +261,7 @@ private:
                 // Allocate all cache entries in one chunk for better cache performance.
                 // Only allocate the difference from need and already present in old ones
                 stored_type* cache_entries = new stored_type[cache_mask - old.cache_mask];
+                XTL_OVERHEAD_ACCOUNTING_ONLY(mch::count_allocation((cache_mask - old.cache_mask)*sizeof(stored_type)));
 
                 // Initialize remaining pointers from cache to newly allocated cache entries
                 for (size_t j = 0; i <= cache_mask; ++i, ++j)
@@ -270,8 +295,71 @@ private:
         bool is_full() const { return used > cache_mask; } ///< Checks whether cache is full
         size_t  size() const { return cache_mask+1; }      ///< Number of entries in cache
 
-        const stored_type*& operator[](intptr_t vtbl) const { return cache[(vtbl>>optimal_shift) & cache_mask]; }
-              stored_type*& operator[](intptr_t vtbl)       { return cache[(vtbl>>optimal_shift) & cache_mask]; }
+        /// Whether the cache is larger than 2^#max_tuned_log_size entries. The shift
+        /// of such cache is not tuned to its vtbl pointers anymore. Instead, 
+        /// each of them is in the first entry not taken by others, starting 
+        /// from its expected one. \see probe()
+        bool open_addressing() const { return (cache_mask >> max_tuned_log_size) != 0; }
+
+        /// Entry of vtbl or the vacant one it should take in an open addressing cache
+        stored_type* probe(const intptr_t vtbl) const noexcept
+        {
+            size_t j = (vtbl>>optimal_shift) & cache_mask;
+
+            while (cache[j]->vtbl != vtbl && cache[j]->vtbl)
+                j = (j+1) & cache_mask;
+
+            return cache[j];
+        }
+
+        /// Rearranges the pointers to entries of an open addressing cache, so 
+        /// that probe() finds the occupied ones. Entries themselves stay where 
+        /// they are, so references to their values remain valid.
+        void place_by_probing()
+        {
+            std::vector<stored_type*> entries(&cache[0], &cache[cache_mask+1]);
+            std::fill(&cache[0], &cache[cache_mask+1], static_cast<stored_type*>(0));
+
+            for (size_t i = 0; i <= cache_mask; ++i)
+                if (entries[i]->vtbl)
+                {
+                    size_t j = (entries[i]->vtbl>>optimal_shift) & cache_mask;
+                    while (cache[j]) j = (j+1) & cache_mask;
+                    cache[j] = entries[i];
+                }
+
+            // Vacant entries take the remaining slots
+            for (size_t i = 0, j = 0; i <= cache_mask; ++i)
+                if (!entries[i]->vtbl)
+                {
+                    while (cache[j]) ++j;
+                    cache[j] = entries[i];
+                }
+        }
+
+        /// Number of bytes used by the descriptor and the entries it points to
+        size_t memory_used() const { return sizeof(cache_descriptor) + (size()-XTL_VARIABLE_SIZE_ARRAY)*sizeof(stored_type*) + size()*sizeof(stored_type); }
+
+        XTL_HOT_PATH const stored_type*& operator[](intptr_t vtbl) const { return cache[(vtbl>>optimal_shift) & cache_mask]; }
+        XTL_HOT_PATH       stored_type*& operator[](intptr_t vtbl)       { return cache[(vtbl>>optimal_shift) & cache_mask]; }
+
+        /// Whether all entries are allocated and the occupied ones hold used 
+        /// distinct vtbl pointers. Takes time linear in the size of the cache,
+        /// so it is only checked on the update path. \see #XTL_CONSISTENCY_CHECK
+        bool consistent() const
+        {
+            std::vector<intptr_t> vtbls;
+
+            for (size_t i = 0; i <= cache_mask; ++i)
+                if (!cache[i])
+                    return false;
+                else
+                if (cache[i]->vtbl)
+                    vtbls.push_back(cache[i]->vtbl);
+
+            std::sort(vtbls.begin(), vtbls.end());
+            return vtbls.size() == used && std::adjacent_find(vtbls.begin(), vtbls.end()) == vtbls.end();
+        }
 
         /// Main function that will be used to get a reference to the stored element. 
         inline stored_type*& get(const intptr_t vtbl) noexcept
@@ -313,6 +401,12 @@ private:
                 // returned entry to ensure it has vtbl he was looking for.
                 return ce;
 Swap:
+            #if XTL_USE_VTBL_FREQUENCY
+                // Leave the entry where it is when the slot is taken by a
+                // more frequently requested vtbl that also belongs there.
+                if (ce->vtbl && &(*this)[ce->vtbl] == &ce && (*cv)->hits < ce->hits)
+                    return *cv;
+            #endif
                 std::swap(ce,*cv);
             }
 
@@ -320,15 +414,32 @@ Swap:
         }
     };
 
+    /// Descriptor shared by all the maps with values of type T that have not 
+    /// been looked up yet. Its only entry is never occupied and the descriptor
+    /// looks full, so the first lookup through a map misses and allocates the
+    /// map's own descriptor in update(), while the hit path stays unchanged.
+    /// The descriptor is in a union to never be destroyed as it owns nothing.
+    struct empty_cache
+    {
+        constexpr empty_cache() : entry(), descriptor(&entry) {}
+       ~empty_cache() {}
+
+        typename cache_descriptor::stored_type entry;
+        union { cache_descriptor descriptor; };
+    };
+
+    static empty_cache empty;
+
 public:
     
+    /// \note Maps do not allocate until their first lookup and constructors 
+    ///       only take constant arguments, which makes maps with values of 
+    ///       literal type constant-initialized, \see #XTL_PRELOAD_LOCAL_STATIC_VARIABLES.
 #if XTL_DUMP_PERFORMANCE
-    #if defined(DBG_NEW)
-        #undef new
-    #endif
     vtblmap(const char* fl, size_t ln, const char* fn, const vtbl_count_t expected_size = min_expected_size) : 
-        descriptor(new(req_bits(expected_size-1)) cache_descriptor(req_bits(expected_size-1))),
+        descriptor(&empty.descriptor),
         last_table_size(0),
+        expected_size(expected_size),
         collisions_before_update(initial_collisions_before_update),
         file(fl), 
         line(ln),
@@ -339,27 +450,27 @@ public:
         misses(0),
         collisions(0)
     {}
-    #if defined(DBG_NEW)
-        #define new DBG_NEW
-    #endif
 #endif
 
-    #if defined(DBG_NEW)
-        #undef new
-    #endif
-    vtblmap(const vtbl_count_t expected_size = min_expected_size) :
-        descriptor(new(req_bits(expected_size-1)) cache_descriptor(req_bits(expected_size-1))),
+    constexpr vtblmap(const vtbl_count_t expected_size = min_expected_size) :
+        descriptor(&empty.descriptor),
+        last_table_size(0),
+        expected_size(expected_size),
         collisions_before_update(initial_collisions_before_update)
         XTL_DUMP_PERFORMANCE_ONLY(,file("unspecified"), line(0), func("unspecified"), updates(0), clauses(expected_size), hits(0), misses(0), collisions(0))
     {}
-    #if defined(DBG_NEW)
-        #define new DBG_NEW
-    #endif
 
    ~vtblmap()
     {
         XTL_DUMP_PERFORMANCE_ONLY(std::clog << *this << std::endl);
-        delete descriptor;
+
+        if (allocated())
+        {
+        #if XTL_VTBL_STATISTICS || XTL_VTBL_INVALIDATION
+            maps().erase(std::find(maps().begin(), maps().end(), this));
+        #endif
+            delete descriptor;
+        }
     }
 
     /// This is the main function to get the value of type T associated with
@@ -367,9 +478,9 @@ public:
     ///
     /// \note The function returns the value "by reference" to indicate that you 
     ///       may take address or change the value of the cell!
-    inline T& get(const void* p) noexcept
+    XTL_HOT_PATH inline T& get(const void* p) noexcept
     {
-        XTL_ASSERT(descriptor); // Allocated in constructor, deallocated in destructor
+        XTL_ASSERT(descriptor); // Empty one until the first lookup, deallocated in destructor
 
         const intptr_t vtbl = *reinterpret_cast<const intptr_t*>(p);
         typename cache_descriptor::stored_type*& ce = (*descriptor)[vtbl];
@@ -381,6 +492,10 @@ public:
         {
             XTL_DUMP_PERFORMANCE_ONLY(++misses);
             XTL_DUMP_PERFORMANCE_ONLY(if (ce->vtbl) ++collisions);
+            XTL_STATIC_PROBES_ONLY(XTL_PROBE(vtbl_miss, this, vtbl));
+
+            if (XTL_UNLIKELY(descriptor->open_addressing()))
+                return get_probed(vtbl);
 
             if (descriptor->is_full()                     // No entries left for possibly new vtbl in the cache
                 || (ce->vtbl                              // Collision - the entry for vtbl is already occupied
@@ -389,17 +504,132 @@ public:
                 return update(vtbl); // try to rearrange cache
 
             // Try to find entry with our vtbl and swap it with where it is expected to be
-            descriptor->get(vtbl); // This will bring correct pointer into ce
-            XTL_ASSERT(ce->vtbl == vtbl);
+            typename cache_descriptor::stored_type* res = descriptor->get(vtbl); // This will normally bring correct pointer into ce
+            XTL_ASSERT(res->vtbl == vtbl);
+            XTL_USE_VTBL_FREQUENCY_ONLY(++res->hits);
+            return res->value;
         }
         XTL_DUMP_PERFORMANCE_ONLY(else ++hits);
+        XTL_USE_VTBL_FREQUENCY_ONLY(++ce->hits);
 
         return ce->value;
     }
 
-    /// A function that gets called when the cache is either too inefficient or full.
+    /// Looks up values associated with vtbl pointers of n subjects at once and
+    /// stores pointers to them in out. The pointers remain valid for the 
+    /// lifetime of the map. Subjects are taken in groups of #XTL_BATCH_SIZE: 
+    /// the expected cache entries of the whole group are probed first in a 
+    /// loop without stores into the cache, then misses are resolved with get().
+    template <typename S>
+    void get_batch(const S* const* subjects, size_t n, T** out) noexcept
+    {
+        XTL_ASSERT(descriptor); // Empty one until the first lookup, deallocated in destructor
+
+        intptr_t vtbl[XTL_BATCH_SIZE];
+
+        for (size_t i = 0; i < n; i += XTL_BATCH_SIZE, subjects += XTL_BATCH_SIZE, out += XTL_BATCH_SIZE)
+        {
+            const size_t m = std::min(n-i, size_t(XTL_BATCH_SIZE));
+            const cache_descriptor& d = *descriptor; // Can only change while resolving misses below
+
+            for (size_t j = 0; j < m; ++j)
+                vtbl[j] = *reinterpret_cast<const intptr_t*>(subjects[j]);
+
+            for (size_t j = 0; j < m; ++j)
+            {
+                typename cache_descriptor::stored_type* ce = d.cache[(vtbl[j]>>d.optimal_shift) & d.cache_mask];
+                out[j] = ce->vtbl == vtbl[j] ? &ce->value : 0;
+            }
+
+            for (size_t j = 0; j < m; ++j)
+                if (XTL_UNLIKELY(!out[j]))
+                    out[j] = &get(subjects[j]);
+                XTL_DUMP_PERFORMANCE_ONLY(else ++hits);
+        }
+    }
+
+    /// A function that gets called when the cache is either too inefficient or 
+    /// full, which is also the case for the empty one on the first lookup.
     T& update(intptr_t vtbl);
 
+    /// Handles a miss of get() in an open addressing cache, which doubles once
+    /// it is 3/4 full. \see cache_descriptor::open_addressing()
+    T& get_probed(intptr_t vtbl);
+
+    /// Replaces descriptor with an open addressing one of the given log size.
+    /// Its shift only drops the bits in which vtbl pointers never differ, as
+    /// a shift tuned to few of them would pile up many in the same entries.
+    void rehash(size_t log_size);
+
+#if XTL_USE_VTBL_FREQUENCY
+    /// Makes the entry of a value returned by get() count as requested at least
+    /// n times, so that the expected frequency of the class of its vtbl (\see FQ)
+    /// guides rearrangements before the actual requests have been counted.
+    void expect(T& value, size_t n) noexcept
+    {
+        typedef typename cache_descriptor::stored_type stored_type;
+        stored_type* ce = reinterpret_cast<stored_type*>(reinterpret_cast<char*>(&value) - offsetof(stored_type,value));
+
+        if (ce->hits < n)
+            ce->hits = n;
+    }
+#endif
+
+    /// Number of bytes used by the map, not counting memory owned by its values
+    size_t memory_used() const { return sizeof(vtblmap) + (allocated() ? descriptor->memory_used() : 0); }
+
+    /// Calls f with the value associated with each vtbl pointer in the map
+    template <typename F>
+    void for_each_value(F f) const
+    {
+        for (size_t i = 0; i <= descriptor->cache_mask; ++i)
+            if (descriptor->cache[i]->vtbl)
+                f(descriptor->cache[i]->value);
+    }
+
+#if XTL_VTBL_STATISTICS
+    /// Calls f(const vtblmap&) for every map with values of type T currently alive
+    template <typename F>
+    static void for_each_map(F f)
+    {
+        for (size_t i = 0; i < maps().size(); ++i)
+            f(*maps()[i]);
+    }
+#endif
+
+#if XTL_VTBL_INVALIDATION
+    /// Drops the entries of vtbl pointers in range. Lookups find vtbl pointers
+    /// anywhere in the cache, so the entries are just vacated in place, after
+    /// which an open addressing cache puts the remaining ones back on their 
+    /// probing sequences. 
+    /// \see invalidate_vtbl_range()
+    /// \note Invalidates references previously returned by get() for them.
+    /// \returns The number of entries dropped.
+    size_t invalidate(const vtbl_range& range)
+    {
+        size_t dropped = 0;
+
+        for (size_t i = 0; i <= descriptor->cache_mask; ++i)
+        {
+            typename cache_descriptor::stored_type* e = descriptor->cache[i];
+
+            if (e->vtbl && range.contains(e->vtbl))
+            {
+                e->destroy();
+                e->construct();
+                --descriptor->used;
+                ++dropped;
+            }
+        }
+
+        if (dropped && descriptor->open_addressing())
+            descriptor->place_by_probing(); // Vacated entries may have been on the way to others
+
+        last_table_size = std::min(last_table_size, descriptor->used);
+        return dropped;
+    }
+#endif
+
 #if XTL_DUMP_PERFORMANCE
     std::ostream& operator>>(std::ostream& os) const;
     friend std::ostream& operator<<(std::ostream& os, const vtblmap& m) { return m >> os; }
@@ -407,12 +637,42 @@ public:
 
 private:
 
+    /// Checks whether the map has its own descriptor, which happens on first lookup
+    bool allocated() const { return descriptor != &empty.descriptor; }
+
+#if XTL_VTBL_STATISTICS || XTL_VTBL_INVALIDATION
+    /// All the maps with values of type T that have allocated their cache.
+    /// \note Never destroyed, since maps of Match statements are constant-
+    ///       initialized and thus destroyed after it.
+    static std::vector<vtblmap*>& maps()
+    {
+        static std::vector<vtblmap*>* all = new std::vector<vtblmap*>;
+        return *all;
+    }
+#endif
+
+#if XTL_VTBL_INVALIDATION
+    /// Drops entries of vtbl pointers in range from all the maps with values of type T
+    static size_t invalidate_maps(const vtbl_range& range)
+    {
+        size_t dropped = 0;
+
+        for (size_t i = 0; i < maps().size(); ++i)
+            dropped += maps()[i]->invalidate(range);
+
+        return dropped;
+    }
+#endif
+
     /// Cached mappings of vtbl to some indecies
     cache_descriptor* descriptor;
 
     /// Memoized table.size() during last cache rearranging
     size_t last_table_size;
 
+    /// Number of vtbl pointers expected, which determines size of the first cache allocated
+    vtbl_count_t expected_size;
+
     /// Number of colisions that we will still tolerate before next update
     int collisions_before_update;
 
@@ -431,12 +691,48 @@ private:
 
 //------------------------------------------------------------------------------
 
+template <typename T>
+typename vtblmap<T>::empty_cache vtblmap<T>::empty;
+
+//------------------------------------------------------------------------------
+
 template <typename T>
 T& vtblmap<T>::update(intptr_t vtbl)
 {
-    XTL_ASSERT(descriptor); // Allocated in constructor, deallocated in destructor
+    XTL_ASSERT(descriptor); // Empty one until the first lookup, deallocated in destructor
+    XTL_STATIC_PROBES_ONLY(XTL_PROBE(vtbl_update, this, vtbl));
+    XTL_OVERHEAD_ACCOUNTING_ONLY(mch::count_vtbl_update());
     XTL_ASSERT(last_table_size < descriptor->used || descriptor->is_full()); // We will only call this if size changed
 
+    if (XTL_UNLIKELY(!allocated()))
+    {
+        // First lookup through this map: allocate its own cache
+        #if defined(DBG_NEW)
+            #undef new
+        #endif
+        descriptor = new(req_bits(expected_size-1)) cache_descriptor(req_bits(expected_size-1));
+        #if defined(DBG_NEW)
+            #define new DBG_NEW
+        #endif
+    #if XTL_VTBL_STATISTICS || XTL_VTBL_INVALIDATION
+        maps().push_back(this);
+    #endif
+    #if XTL_VTBL_INVALIDATION
+        static vtbl_invalidator invalidator(&invalidate_maps); // Registered along with the first map of T
+    #endif
+        typename cache_descriptor::stored_type* res = descriptor->get(vtbl); // The cache is empty, so vtbl takes its entry
+        XTL_ASSERT(res->vtbl == vtbl);
+        XTL_USE_VTBL_FREQUENCY_ONLY(++res->hits);
+        return res->value;
+    }
+
+    if (XTL_UNLIKELY(req_bits(descriptor->used) > max_tuned_log_size))
+    {
+        // The largest cache tuned to its vtbl pointers is full
+        rehash(max_tuned_log_size+1);
+        return get_probed(vtbl);
+    }
+
     // FIX: vtbl might already exist in old descriptor and if it happens to be the first one, it won't be taken into consideration
     intptr_t diff = 0;
     intptr_t prev = vtbl;
@@ -465,14 +761,14 @@ T& vtblmap<T>::update(intptr_t vtbl)
     bit_offset_t n  = bit_offset_t(req_bits(descriptor->used));       // needed  log_size
     bit_offset_t m  = bit_offset_t(req_bits(diff));                   // highest bit in which vtbls differ
     bit_offset_t z  = bit_offset_t(trailing_zeros(static_cast<unsigned int>(diff))); // amount of lowest bits in which vtbls do not differ
-    bit_offset_t l1 = std::min(max_log_size,std::max(k,n));                          // lower bound for log_size iteration
-    bit_offset_t l2 = std::min(max_log_size,std::max(k,bit_offset_t(n+max_log_inc)));// upper bound for log_size iteration
+    bit_offset_t l1 = std::min(max_tuned_log_size,std::max(k,n));                          // lower bound for log_size iteration
+    bit_offset_t l2 = std::min(max_tuned_log_size,std::max(k,bit_offset_t(n+max_log_inc)));// upper bound for log_size iteration
     bit_offset_t no = l1;                                             // current estimate of the best log_size
     bit_offset_t zo = z;                                              // current estimate of the best offset
 
     // We do this to not resort to vectors and heap and keep counting on stack
     const size_t cache_histogram_size = 1 + ((1<<l2) - 1)/XTL_BIT_SIZE(intptr_t);
-    XTL_VLA(cache_histogram, intptr_t, cache_histogram_size, 1 + ((1<<max_log_size) - 1)/XTL_BIT_SIZE(intptr_t)); // intptr_t cache_histogram[cache_histogram_size];
+    XTL_VLA(cache_histogram, intptr_t, cache_histogram_size, 1 + ((1<<max_tuned_log_size) - 1)/XTL_BIT_SIZE(intptr_t)); // intptr_t cache_histogram[cache_histogram_size];
 
     size_t max_cache_entries = 0;
 
@@ -543,12 +839,56 @@ T& vtblmap<T>::update(intptr_t vtbl)
 //#endif
     typename cache_descriptor::stored_type* res = descriptor->get(vtbl);
     XTL_ASSERT(res && res->vtbl == vtbl); // We have ensured enough space, so no need to check this explicitly
+    XTL_CONSISTENCY_CHECK(descriptor->consistent());
+    XTL_USE_VTBL_FREQUENCY_ONLY(++res->hits);
     last_table_size = descriptor->used;   // Update memoized value
     return res->value;
 }
 
 //------------------------------------------------------------------------------
 
+template <typename T>
+T& vtblmap<T>::get_probed(intptr_t vtbl)
+{
+    typename cache_descriptor::stored_type* res = descriptor->probe(vtbl);
+
+    if (!res->vtbl) // vtbl is not in the cache
+    {
+        if (4*(descriptor->used+1) > 3*descriptor->size())
+        {
+            rehash(req_bits(descriptor->cache_mask)+1);
+            res = descriptor->probe(vtbl);
+        }
+
+        res->vtbl = vtbl;
+        last_table_size = ++descriptor->used;
+    }
+
+    XTL_USE_VTBL_FREQUENCY_ONLY(++res->hits);
+    return res->value;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename T>
+void vtblmap<T>::rehash(size_t log_size)
+{
+    XTL_DUMP_PERFORMANCE_ONLY(++updates); // Record update
+    cache_descriptor* old = descriptor;
+    #if defined(DBG_NEW)
+        #undef new
+    #endif
+    descriptor = new(log_size) cache_descriptor(log_size,initial_shift(),std::move(*old));
+    #if defined(DBG_NEW)
+        #define new DBG_NEW
+    #endif
+    delete old;
+    descriptor->place_by_probing();
+    XTL_CONSISTENCY_CHECK(descriptor->consistent());
+}
+
+//------------------------------------------------------------------------------
+
 #if XTL_DUMP_PERFORMANCE
 
 template <typename T>
@@ -572,13 +912,11 @@ std::ostream& vtblmap<T>::operator>>(std::ostream& os) const
 
     os << file << '[' << line << ']' << ' ' << func << std::endl;
 
-    size_t vtbl_count = descriptor->used;
+    size_t vtbl_count = allocated() ? descriptor->used : 0;
     size_t log_size   = req_bits(descriptor->cache_mask);
     size_t cache_size = (1<<log_size);
 
-    // We do this to not resort to vectors and heap and keep counting on stack
-    XTL_VLAZ(cache_histogram, vtbl_count_t, cache_size, 1<<max_log_size); // vtbl_count_t cache_histogram[cache_size];
-
+    std::vector<vtbl_count_t> cache_histogram(cache_size); // Open addressing caches can be larger than 2^max_log_size
     std::vector<intptr_t> vtbls(vtbl_count);
     std::vector<intptr_t>::iterator q = vtbls.begin();
 
@@ -757,6 +1095,7 @@ struct type_switch_info
 {
     std::ptrdiff_t offset; ///< Required this-pointer offset to the source sub-object
     std::size_t    target; ///< Case label of the jump target of Match statement
+    XTL_COMPUTED_GOTO_ONLY(void* jump;) ///< Address of the jump target of MatchP \see #XTL_USE_COMPUTED_GOTO
 };
 
 //------------------------------------------------------------------------------
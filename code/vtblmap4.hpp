@@ -78,11 +78,51 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstdlib>
 #include <cstring>
 #include <cstdarg>
+#include <cstdint>
+#include <type_traits>
 #include "ptrtools.hpp"  // Helper functions to work with pointers
 #include "xtl.hpp"       // XTL subtyping definitions
 
+#if XTL_STATIC_PROBES
+#include "probes.hpp"    // Static probes on misses and updates
+#endif
+
+#if XTL_OVERHEAD_ACCOUNTING
+#include "overhead.hpp"  // Counters of allocations, casts and updates
+#endif
+
+#if XTL_MULTI_THREADING
+#include <atomic>        // Fields of type_switch_info are accessed atomically
+#include <mutex>         // List of all vtbl maps is guarded under multi-threading
+#endif
+
+#if XTL_PERFECT_HASHING
+#include <vector>        // Scratch space of vtbl_map::freeze()
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>   // Fingerprints of group_probing are compared 16 at a time
+#endif
+
+#if XTL_SEALED_VTBL_MAPS && (defined(__unix__) || defined(__APPLE__))
+#include <sys/mman.h>    // Read-only segment of sealed vtbl maps
+#include <unistd.h>      // Page size
+#endif
+
+#if XTL_VTBL_STATISTICS
+#include <ostream>       // Sites listed by write_hot_vtbl_sites()
+#include <vector>        // Sites sorted by their lookups
+#endif
+
+#if XTL_VTBL_LAYOUT
+#include <ostream>       // JSON of write_vtbl_layouts()
+#include <string>        // Occupancy of each cache in the JSON
+#include <vector>        // Entries of vtbl_site_layout
+#endif
+
 #if XTL_DUMP_PERFORMANCE
 // For print out purposes only
 #include <array>
@@ -103,6 +143,45 @@
 #define XTL_USE_LCG_WALK 1
 #endif
 
+/// Whether vtbl maps combine vtbl pointers of N-ary Match statements with 
+/// multiplicative_hashing instead of interleave_hashing by default
+#if !defined(XTL_USE_MULTIPLICATIVE_HASHING)
+#define XTL_USE_MULTIPLICATIVE_HASHING 0
+#endif
+
+/// Policy of vtbl_map<N,T,P> used by the Match statements that follow. It can
+/// be redefined between Match statements to pick a different combination of 
+/// probing, hashing and update policies for some of them.
+/// \see mch::vtbl_map_policy
+#if !defined(XTL_VTBL_MAP_POLICY)
+#if XTL_STATIC_VTBL_MAPS
+#define XTL_VTBL_MAP_POLICY mch::vtbl_static_policy<>
+#else
+#define XTL_VTBL_MAP_POLICY mch::vtbl_map_policy<>
+#endif
+#endif
+
+/// Statement of a Match statement that lets its vtbl map learn the site of 
+/// the statement once, when the map is preallocated and thus could not get it 
+/// through its constructor (\see #XTL_PRELOAD_LOCAL_STATIC_VARIABLES).
+#if XTL_VTBL_COUNTERS && XTL_PRELOAD_LOCAL_STATIC_VARIABLES
+#define XTL_LOCATE_VTBL_MAP(Map) static const bool __vtbl_map_located = Map.locate(__FILE__,__LINE__,XTL_FUNCTION); XTL_UNUSED(__vtbl_map_located)
+#else
+#define XTL_LOCATE_VTBL_MAP(Map)
+#endif
+
+/// Whether instances of vtbl_map<N,T> register themselves in a list that lets
+/// functions like freeze_vtbl_maps(), compact_vtbl_maps(), rearrange_vtbl_maps(),
+/// invalidate_vtbl_range(), seal_vtbl_maps() and for_each_vtbl_site() reach
+/// all of them.
+#if XTL_PERFECT_HASHING || XTL_VTBL_COMPACTION || XTL_VTBL_STATISTICS || XTL_DEFERRED_VTBL_UPDATES || XTL_VTBL_INVALIDATION || XTL_SEALED_VTBL_MAPS
+#define XTL_VTBL_MAP_REGISTRY 1
+#else
+#define XTL_VTBL_MAP_REGISTRY 0
+#endif
+
+#define XTL_VTBL_MAP_REGISTRY_ONLY(...) XTL_IF(XTL_NOT(XTL_VTBL_MAP_REGISTRY), XTL_EMPTY(), XTL_EXPAND(__VA_ARGS__))
+
 namespace mch ///< Mach7 library namespace
 {
 
@@ -115,8 +194,9 @@ typedef size_t  bit_offset_t;
 /// The smallest integral type capable of representing the number N of different 
 /// vtbl pointers in the program. Roughly N should be equal to some constant c
 /// multiplied by the number of different classes polymorphic classes in the 
-/// program. Constant c accounts for potential multiple inheritance.
-typedef unsigned short vtbl_count_t;
+/// program. Constant c accounts for potential multiple inheritance. Programs 
+/// with generated hierarchies of more than 2^16 classes exist.
+typedef unsigned int vtbl_count_t;
 //typedef size_t vtbl_count_t;
 
 //------------------------------------------------------------------------------
@@ -128,13 +208,55 @@ const bit_offset_t max_log_inc       = XTL_MAX_LOG_INC;  ///< Log of the maximum
 const bit_offset_t irrelevant_bits   = 0; // XTL_IRRELEVANT_VTBL_BITS; // FIX: temporarily set to 0 for experiments with XTL subtyping where we don't work with vtbl-pointers
 const int initial_collisions_before_update = 16;
 
-#if XTL_USE_LCG_WALK
+#if XTL_RUNTIME_TUNING
+/// Under-the-hood constants of vtbl maps that can be set at run time
+/// \see #XTL_RUNTIME_TUNING
+struct vtbl_map_tuning
+{
+    bit_offset_t min_log_size;       ///< Log of the cache size maps start with, #XTL_MIN_LOG_SIZE by default
+    bit_offset_t max_log_inc;        ///< Log of the largest increase of the cache on update, #XTL_MAX_LOG_INC by default
+    int          initial_collisions; ///< Collisions before the first update, #initial_collisions_before_update by default
+};
+
+/// Value of environment variable name when it is a number in [lo,hi] and 
+/// default_value otherwise
+inline int tuning_from_environment(const char* name, int default_value, int lo, int hi)
+{
+    const char* value = std::getenv(name);
+    char*       end   = 0;
+    const long  v     = value ? std::strtol(value, &end, 10) : 0;
+
+    if (!value || end == value || *end || v < lo || v > hi)
+        return default_value;
+
+    return int(v);
+}
+
+/// Tuning of vtbl maps, read from the environment on first use. Maps 
+/// constructed afterwards start with its min_log_size, while all maps read
+/// the other values each time they update their cache.
+inline vtbl_map_tuning& vtbl_tuning()
+{
+    static vtbl_map_tuning tuning = {
+        bit_offset_t(tuning_from_environment("XTL_MIN_LOG_SIZE",       min_log_size,                     1, XTL_MAX_LOG_SIZE)),
+        bit_offset_t(tuning_from_environment("XTL_MAX_LOG_INC",        max_log_inc,                      0, 8)),
+                     tuning_from_environment("XTL_INITIAL_COLLISIONS", initial_collisions_before_update, 1, 1 << 20)
+    };
+    return tuning;
+}
+
+/// Log of the cache size new maps start with
+inline bit_offset_t initial_log_size() { return vtbl_tuning().min_log_size; }
+#else
+/// Log of the cache size new maps start with
+inline bit_offset_t initial_log_size() { return min_log_size; }
+#endif
+
 // In case of collisions in cache, we are going try finding next available slot
 // with LCG. This should avoid accumulating collisions in few places and instead
 // distribute them over the entire cache.
 const size_t lcg_a = 5;   ///< \see http://en.wikipedia.org/wiki/Linear_congruential_generator and Hull-Dobell Theorem
 const size_t lcg_c = 131; ///< \see http://en.wikipedia.org/wiki/Linear_congruential_generator and Hull-Dobell Theorem
-#endif
 
 //------------------------------------------------------------------------------
 
@@ -250,11 +372,13 @@ inline void array_fill(const T (&a)[N], const T& v)
 template <size_t N, typename T>
 struct stored_type_for
 {
-    stored_type_for() : XTL_VTBL_HASHING(hash(0),) vtbl(), value() {}
+    stored_type_for() : XTL_VTBL_HASHING(hash(0),) vtbl(), value() XTL_USE_VTBL_FREQUENCY_ONLY(, hits(0)) XTL_VTBL_LAYOUT_ONLY(, lookups(0)) {}
 
     XTL_VTBL_HASHING(intptr_t hash;)     ///< hash of vtbl[i] for comparing vtbl for large N (> 2)
     intptr_t vtbl[N];  ///< v-table pointers of the value
     T        value;    ///< value associated with the v-table pointers vtbl[]
+    XTL_USE_VTBL_FREQUENCY_ONLY(size_t hits;) ///< Number of requests of vtbl[] (halved on every rearrangement)
+    XTL_VTBL_LAYOUT_ONLY(size_t lookups;)     ///< Number of lookups that found vtbl[] \see #XTL_VTBL_LAYOUT
 
     /// Helper function to in-place construct stored_type inside uninitialized memory
     void construct()    { new(this) stored_type_for(); }
@@ -279,10 +403,12 @@ struct stored_type_for
 template <typename T>
 struct stored_type_for<1,T>
 {
-    stored_type_for() : vtbl(), value() {}
+    stored_type_for() : vtbl(), value() XTL_USE_VTBL_FREQUENCY_ONLY(, hits(0)) XTL_VTBL_LAYOUT_ONLY(, lookups(0)) {}
 
     intptr_t vtbl[1];  ///< v-table pointers of the value
     T        value;    ///< value associated with the v-table pointers vtbl[]
+    XTL_USE_VTBL_FREQUENCY_ONLY(size_t hits;) ///< Number of requests of vtbl[] (halved on every rearrangement)
+    XTL_VTBL_LAYOUT_ONLY(size_t lookups;)     ///< Number of lookups that found vtbl[] \see #XTL_VTBL_LAYOUT
 
     /// Helper function to in-place construct stored_type inside uninitialized memory
     void construct()    { new(this) stored_type_for(); }
@@ -302,925 +428,3797 @@ struct stored_type_for<1,T>
 
 //------------------------------------------------------------------------------
 
-template <size_t N, typename T>
-class vtbl_map
-{
-private:
+/// Number of types among Ss that satisfy type predicate Is
+template <template <typename> class Is, typename... Ss> struct count_types_if;
+template <template <typename> class Is>                 struct count_types_if<Is>         { static const size_t value = 0; };
+template <template <typename> class Is, typename S, typename... Ss> 
+struct count_types_if<Is,S,Ss...> { static const size_t value = (Is<S>::value ? 1 : 0) + count_types_if<Is,Ss...>::value; };
 
-    /// A helper data structure that is swapped during updates to 
-    /// cache parameters k and l.
-    struct cache_descriptor
-    {
-        /// Type of the stored values, which is a pair of vtbl-pointer and T value.
-        typedef stored_type_for<N,T> stored_type;
+/// Stores vtbl-pointers of those subjects whose types satisfy Is into
+/// consecutive elements of vtbl. The choice of subjects is made at compile
+/// time, so once inlined this is as cheap as initializing the array by hand.
+template <template <typename> class Is>
+inline void vtbls_of(intptr_t*) noexcept {}
 
-        /// Cache mask to access entries. Always cache_size-1 since cache_size is a power of 2
-        /// \note We currently rely in constructors on this member be first in 
-        ///       declaration order so that it is initialized first!
-        const size_t cache_mask;
-        
-        /// Optimal shift computed based on the vtbl pointers already in the map.
-        /// Most of the time this value would be equal to #irrelevant_bits, but not
-        /// necessarily always. In case of collisions, optimal_shift will have
-        /// a value of a shift that maximizes entropy of caching vtbl pointers (which 
-        /// effectively also minimizes probability of not finding something in cache)
-        /*const*/ bit_offset_t optimal_shift[N];
+template <template <typename> class Is, typename S, typename... Ss>
+inline void vtbls_of(intptr_t* vtbl, const S* s, const Ss*... ss) noexcept;
 
-        /// Total number of vtbl-pointers in the cache
-        size_t used;
+/// Subject s satisfies Is: take its vtbl-pointer
+template <template <typename> class Is, typename S, typename... Ss>
+inline void vtbls_of_if(std::true_type, intptr_t* vtbl, const S* s, const Ss*... ss) noexcept { *vtbl = vtbl_of(s); vtbls_of<Is>(vtbl+1, ss...); }
 
-        /// Variable-sized array with actual pointers to stored_type
-        stored_type* cache[XTL_VARIABLE_SIZE_ARRAY];
+/// Subject s does not satisfy Is: skip it
+template <template <typename> class Is, typename S, typename... Ss>
+inline void vtbls_of_if(std::false_type, intptr_t* vtbl, const S*, const Ss*... ss) noexcept { vtbls_of<Is>(vtbl, ss...); }
 
-        #if defined(DBG_NEW)
-            #undef new
-        #endif
+template <template <typename> class Is, typename S, typename... Ss>
+inline void vtbls_of(intptr_t* vtbl, const S* s, const Ss*... ss) noexcept
+{
+    vtbls_of_if<Is>(std::integral_constant<bool, Is<S>::value>(), vtbl, s, ss...);
+}
 
-        void* operator new(size_t s, size_t log_size)
-        {
-            // FIX: Ensure proper alignment requirements
-            return ::new char[s + ((1<<log_size)-XTL_VARIABLE_SIZE_ARRAY)*sizeof(stored_type*)];
-        }
+//------------------------------------------------------------------------------
 
-        #if defined(DBG_NEW)
-            #define new DBG_NEW
-        #endif
+/// Whether subjects of type S take part in lookups of vtbl maps by their value
+/// next to the vtbl pointers of polymorphic subjects \see #XTL_VALUE_SUBJECT_DISPATCH
+template <typename S>
+struct is_value_key : std::integral_constant<bool, XTL_VALUE_SUBJECT_DISPATCH && (std::is_integral<S>::value || std::is_enum<S>::value)> {};
+
+/// Number of elements of keys of vtbl maps that the value of a subject of type
+/// S takes, so that values wider than intptr_t are kept whole
+template <typename S>
+struct value_key_size : std::integral_constant<size_t, is_value_key<S>::value ? (sizeof(S)+sizeof(intptr_t)-1)/sizeof(intptr_t) : 0> {};
+
+/// Number of elements of keys of vtbl maps that values of subjects S take
+template <typename... Ss>               struct value_keys_size;
+template <>                             struct value_keys_size<>        : std::integral_constant<size_t, 0> {};
+template <typename S, typename... Ss>   struct value_keys_size<S,Ss...> : std::integral_constant<size_t, value_key_size<S>::value + value_keys_size<Ss...>::value> {};
+
+/// Key of an integral subject is its object representation, which tells apart
+/// all its values. Values of subjects that no clause tests against a literal 
+/// select the same clause, so they all share the key 0 instead.
+template <typename S>
+inline void value_key_of(intptr_t* key, const S* s, bool literal, std::true_type) noexcept
+{
+    std::fill(key, key + value_key_size<S>::value, intptr_t(0));
 
-        /// We need to declare this placement delete operator since we overload new.
-        void operator delete(void* p, size_t) { ::delete(static_cast<char*>(p)); } // We cast to char* to avoid warning on deleting void*, which is undefined
+    if (literal)
+        std::memcpy(key, s, sizeof(S));
+}
 
-        /// We also provide non-placement delete operator since it doesn't really depend on extra arguments.
-        void operator delete(void* p)         { ::delete(static_cast<char*>(p)); } // We cast to char* to avoid warning on deleting void*, which is undefined
+template <typename S>
+inline void value_key_of(intptr_t*, const S*, bool, std::false_type) noexcept {}
 
-        /// Creates new cache_descriptor based on parameters k and l of the hashing function
-        cache_descriptor(
-            const size_t       log_size,               ///< Parameter k of the cache - the log of the size of the cache
-            const bit_offset_t shift = irrelevant_bits ///< Parameter l of the cache - number of irrelevant bits on the right to remove
-        );
+/// Stores keys of those subjects that are value keys into consecutive elements
+/// of key, where bit i of literals tells whether the subject in position i is
+/// tested against a literal by some clause \see vtbls_of
+inline void value_keys_of(intptr_t*, unsigned int) noexcept {}
 
-        /// Creates new cache_descriptor based on parameters k and l of the 
-        /// hashing function as well as a reference to the cache_descriptor it
-        /// is going to replace.
-        cache_descriptor(
-            const size_t       log_size,    ///< Parameter k of the cache - the log of the size of the cache                
-            const bit_offset_t (&shifts)[N],///< Parameter l of the cache - number of irrelevant bits on the right to remove
-        #if defined(XTL_NO_RVALREF)
-            cache_descriptor&  old          ///< cache_descriptor we will supposedly replace
-        #else
-            cache_descriptor&& old          ///< cache_descriptor we will supposedly replace
-        #endif
-        );
+template <typename S, typename... Ss>
+inline void value_keys_of(intptr_t* key, unsigned int literals, const S* s, const Ss*... ss) noexcept
+{
+    value_key_of(key, s, literals & 1, is_value_key<S>());
+    value_keys_of(key + value_key_size<S>::value, literals >> 1, ss...);
+}
 
-        /// Deallocates memory used for elements.
-       ~cache_descriptor();
+//------------------------------------------------------------------------------
 
-        bool    is_full() const { return used > cache_mask; } ///< Checks whether cache is full
-        size_t     size() const { return cache_mask+1; }      ///< Number of entries in cache
-        size_t lcg_next(size_t j) const { return (lcg_a*j + lcg_c) & cache_mask; }
+/// Number of cache descriptors of single-threaded vtbl maps released so far.
+/// A dispatch_pin taken before a change of it may point to a released one.
+inline size_t& vtbl_descriptor_epoch() noexcept { static size_t epoch = 0; return epoch; }
 
-        size_t memory_used() const 
-        {
-            return sizeof(cache_descriptor)                                   // Descriptor itself
-                + (cache_mask+1-XTL_VARIABLE_SIZE_ARRAY)*sizeof(stored_type*) // Pointers in cache
-                + (cache_mask+1)*sizeof(stored_type);                         // Actual cached values pointers in cache point to
-        }
+/// Parameters of the cache of a vtbl_map<N,T> copied out of its descriptor, 
+/// which a dispatch_scope keeps across the iterations of a loop, so that a 
+/// lookup does not have to load them from the descriptor after loading it.
+struct dispatch_pin
+{
+    enum { max_subjects = 4 }; ///< Maps on more subjects do not pin their caches
+
+    dispatch_pin() : map(0), descriptor(0), epoch(0), cache_mask(0) XTL_PERFECT_HASHING_ONLY(, multiplier(1), multiplier_shift(0)) {}
+
+    const void*  map;                  ///< Map whose cache is pinned or 0
+    const void*  descriptor;           ///< Its cache descriptor
+    size_t       epoch;                ///< vtbl_descriptor_epoch() when pinned
+    size_t       cache_mask;           ///< Mask of the cache
+    bit_offset_t shift[max_subjects];  ///< Optimal shifts of the subjects
+#if XTL_PERFECT_HASHING
+    size_t       multiplier;           ///< Multiplier of the perfect hash function
+    bit_offset_t multiplier_shift;     ///< Number of lower bits of the product to drop
+#endif
+};
 
-        /// Global function computing cache index for a given vtbl pointers, offsets and cache mask
-        static inline size_t cache_index(const intptr_t vtbl[N], const bit_offset_t shifts[N], size_t cache_mask)
-        {
-            intptr_t vtbl_shifted[N];
+//------------------------------------------------------------------------------
 
-            for (size_t i = 0; i < N; ++i)
-                vtbl_shifted[i] = vtbl[i] >> shifts[i];
+/// Helper base class that turns pointers to subjects of a Match statement into
+/// the array of vtbl-pointers of its polymorphic subjects and forwards the
+/// lookup to Derived::get(const intptr_t (&)[N]). This lets single-threaded
+/// and multi-threaded implementations of vtbl_map share the same interface.
+template <typename Derived, typename T>
+struct vtbl_map_subjects
+{
+    /// Looks up the value associated with the dynamic types of the subjects 
+    /// whose static types are polymorphic in the sense of xtl::is_poly_morphic.
+    template <typename... S> 
+    inline auto xtl_get(const S*... s) -> typename std::enable_if<(count_types_if<xtl::is_poly_morphic,S...>::value > 0),T&>::type
+    {
+        return get_if<xtl::is_poly_morphic>(s...);
+    }
 
-            return interleave(vtbl_shifted) & cache_mask;
-        }
+    /// Looks up the value associated with the dynamic types of the subjects
+    /// whose static types are polymorphic. Subjects of non-polymorphic types
+    /// do not participate in the lookup.
+    template <typename... S> 
+    inline auto get(const S*... s) -> typename std::enable_if<(count_types_if<std::is_polymorphic,S...>::value > 0),T&>::type
+    {
+        return get_if<std::is_polymorphic>(s...);
+    }
 
-        /// Computes cache index for current optimal offsets and cache mask.
-        size_t cache_index(const intptr_t vtbl[N]) const { return cache_index(vtbl,optimal_shift,cache_mask); }
+    /// Looks up the value associated with the dynamic types of polymorphic 
+    /// subjects together with the values of integral ones, which follow the 
+    /// vtbl pointers in the key \see is_value_key, value_keys_of
+    template <typename... S> 
+    inline auto get_keyed(unsigned int literals, const S*... s) -> typename std::enable_if<(count_types_if<std::is_polymorphic,S...>::value > 0),T&>::type
+    {
+        intptr_t key[count_types_if<std::is_polymorphic,S...>::value + value_keys_size<S...>::value];
+        vtbls_of<std::is_polymorphic>(key, s...);
+        value_keys_of(key + count_types_if<std::is_polymorphic,S...>::value, literals, s...);
+        return self().get(key);
+    }
 
-        /// Re-establishes invariant that vtbls can only be in the cache 
-        /// entry that correspond to their cache index, unless that entry
-        /// is already taken.
-        void put_entries_in_right_place();
+    /// Looks up the value associated with the dynamic types of polymorphic
+    /// subjects as get() does, but with the parameters of the cache pinned 
+    /// in p \see dispatch_scope
+    template <typename... S> 
+    inline auto get_pinned(dispatch_pin& p, const S*... s) -> typename std::enable_if<(count_types_if<std::is_polymorphic,S...>::value > 0),T&>::type
+    {
+        intptr_t vtbl[count_types_if<std::is_polymorphic,S...>::value];
+        vtbls_of<std::is_polymorphic>(vtbl, s...);
+        return self().lookup_pinned(vtbl, p);
+    }
 
-        /// Main function that will be used to get a reference to the stored element. 
-        stored_type* get(const intptr_t (&vtbl)[N]) noexcept { return get(vtbl,cache_index(vtbl)); }
+    /// Maps that cannot pin their caches look vtbl up as usual
+    template <size_t K>
+    inline T& lookup_pinned(const intptr_t (&vtbl)[K], dispatch_pin&) { return self().get(vtbl); }
 
-        /// Optimization for when the cache index has already been computed
-        stored_type* get(const intptr_t (&vtbl)[N], size_t j) noexcept;
+    /// Looks up values associated with dynamic types of n subjects at once and
+    /// stores pointers to them in out. The pointers remain valid for the 
+    /// lifetime of the map. Maps that can probe several subjects at once 
+    /// provide their own version of this function.
+    template <typename S>
+    void get_batch(const S* const* subjects, size_t n, T** out)
+    {
+        for (size_t i = 0; i < n; ++i)
+            out[i] = &self().get(subjects[i]);
+    }
 
-        /// Computes the number of entries an existing set of vtbl-pointer tuples 
-        /// extended with the new one will occupy in cache of a given #log_size 
-        /// with given #offsets
-        size_t entries_for(const intptr_t (&vtbl)[N], size_t log_size, const bit_offset_t (&offsets)[N]) const;
+private:
 
-    private:
+    /// Forwards the vtbl-pointers of the subjects whose types satisfy Is to
+    /// the lookup of the derived class
+    template <template <typename> class Is, typename... S>
+    inline T& get_if(const S*... s)
+    {
+        intptr_t vtbl[count_types_if<Is,S...>::value];
+        vtbls_of<Is>(vtbl, s...);
+        return self().get(vtbl);
+    }
 
-        cache_descriptor(const cache_descriptor&);            ///< No copy constructor
-        cache_descriptor& operator=(const cache_descriptor&); ///< No assignment operator
+    /// Access to the derived class implementing the actual lookup
+    Derived& self() { return static_cast<Derived&>(*this); }
+};
 
-    }; // of class cache_descriptor
+//------------------------------------------------------------------------------
 
-private:
+/// Map of a Match statement executed inside a dispatch_scope, whose lookups
+/// by subjects go through the pin of the scope
+template <typename Map>
+struct pinned_map
+{
+    pinned_map(Map& m, dispatch_pin& p) : map(m), pin(p) {}
 
-    vtbl_map(const vtbl_map&);            ///< No copy constructor
-    vtbl_map& operator=(const vtbl_map&); ///< No assignment operator
+    template <typename... S>
+    auto get(const S*... s) -> decltype(std::declval<Map&>().get(s...)) { return map.get_pinned(pin, s...); }
 
-public:
-    
-#if XTL_DUMP_PERFORMANCE
-    #if defined(DBG_NEW)
-        #undef new
-    #endif
-    vtbl_map(const char* fl, size_t ln, const char* fn, const vtbl_count_t& num_clauses) : 
-        descriptor(new(min_log_size) cache_descriptor(min_log_size)),
-        case_clauses(num_clauses),
-        last_table_size(0),
-        collisions_before_update(initial_collisions_before_update),
-        prev_collisions_before_update(initial_collisions_before_update),
-        file(fl), 
-        line(ln),
-        func(fn),
-        updates(0), 
-        hits(0),
-        misses(0),
-        collisions(0)
-    {}
-    #if defined(DBG_NEW)
-        #define new DBG_NEW
-    #endif
-#endif
+    /// Values of integral subjects are looked up without the pin
+    template <typename... S>
+    auto get_keyed(unsigned int literals, const S*... s) -> decltype(std::declval<Map&>().get_keyed(literals, s...)) { return map.get_keyed(literals, s...); }
 
-    #if defined(DBG_NEW)
-        #undef new
-    #endif
-    vtbl_map(const vtbl_count_t& num_clauses) : 
-        descriptor(new(min_log_size) cache_descriptor(min_log_size)),
-        case_clauses(num_clauses),
-        last_table_size(0),
-        collisions_before_update(initial_collisions_before_update),
-        prev_collisions_before_update(initial_collisions_before_update)
-        XTL_DUMP_PERFORMANCE_ONLY(,file("unspecified"), line(0), func("unspecified"), updates(0), hits(0), misses(0), collisions(0))
-    {}
-    #if defined(DBG_NEW)
-        #define new DBG_NEW
-    #endif
+    Map&          map; ///< Map of the Match statement
+    dispatch_pin& pin; ///< Pin of the enclosing scope
+};
 
-   ~vtbl_map()
-    {
-        XTL_DUMP_PERFORMANCE_ONLY(std::clog << *this << std::endl);
-        delete descriptor;
-    }
+/// Keeps the descriptor of the cache of a Match statement together with its 
+/// mask and shifts in locals across the iterations of a loop executing that
+/// statement, instead of loading them from its vtbl_map every time. They are
+/// re-read after a miss, when the loop moves to another Match statement or 
+/// whenever any cache descriptor was released since. Declared with 
+/// #DispatchScope right before the loop:
+/// \code
+///     DispatchScope;
+///     for (Node* n : nodes)
+///         Match(*n) { ... } EndMatch
+/// \endcode
+/// \note Only Match statements on up to dispatch_pin::max_subjects polymorphic
+///       subjects of single-threaded vtbl maps pin their caches. Lookups 
+///       through the pin skip the inline cache \see #XTL_INLINE_CACHE_SIZE.
+struct dispatch_scope
+{
+    template <typename Map>
+    pinned_map<Map> pin(Map& map) noexcept { return pinned_map<Map>(map, p); }
 
-    size_t memory_used() const 
-    {
-        XTL_ASSERT(descriptor);
-        return sizeof(vtbl_map) + descriptor->memory_used();
-    }
+    dispatch_pin p; ///< Cache of the Match statement executed last
+};
 
-    /// This is the main function to get the value of type T associated with
-    /// the (vtbl0,...,vtblN) of given pointers.
-    ///
-    /// \note The function returns the value "by reference" to indicate that you 
-    ///       may take address or change the value of the cell!
-    /*
-    inline T& get(intptr_t vtbl0, ...) noexcept
-    {
-        XTL_ASSERT(descriptor); // Allocated in constructor, deallocated in destructor
+/// Scope of Match statements outside of any #DispatchScope, which do their
+/// lookups directly in their maps
+struct no_dispatch_scope
+{
+    template <typename Map>
+    Map& pin(Map& map) const noexcept { return map; }
+};
 
-        intptr_t vtbl[N] = {vtbl0};
+//------------------------------------------------------------------------------
 
-        va_list vl;
-        va_start(vl,vtbl0);
+// Policies of vtbl_map<N,T,P>. Which combination works best depends on the 
+// class hierarchy and on the sequence of dynamic types a Match statement sees,
+// so they can be picked per Match statement with #XTL_VTBL_MAP_POLICY.
 
-        for (size_t i = 1; i < N; i++)
-        {
-            intptr_t vtbl_i = va_arg(vl,intptr_t);
-            XTL_ASSERT(vtbl_i); // Must be a valid vtbl pointer
-            vtbl[i] = vtbl_i;
-        }
+/// Probing policy of vtbl_map that walks the entries in the order of LCG when
+/// the expected entry is taken, distributing collisions over the entire cache.
+struct lcg_probing
+{
+    enum { choices = 0 }; ///< The walk is not bounded
+    static size_t next(size_t j, size_t cache_mask) noexcept { return (lcg_a*j + lcg_c) & cache_mask; }
+};
 
-        va_end(vl);
-        return get(vtbl);
-    }
-    */
-    inline T& get(const intptr_t (&vtbl)[N]) noexcept
-    {
-        size_t j = descriptor->cache_index(vtbl);  // Index of location where it should be
-        typename cache_descriptor::stored_type*& ce = descriptor->cache[j]; // Location where it should be
+/// Probing policy of vtbl_map that tries the entries following the expected one.
+struct linear_probing
+{
+    enum { choices = 0 }; ///< The walk is not bounded
+    static size_t next(size_t j, size_t cache_mask) noexcept { return (j+1) & cache_mask; }
+};
 
-        XTL_ASSERT(ce);   // Since we pre-allocate all entries
+/// Probing policy of vtbl_map that tries the entries following the expected one
+/// as #linear_probing does, but keeps a 1-byte fingerprint of every entry next
+/// to the cache pointers. A miss of the expected entry then compares the 
+/// fingerprints of 16 consecutive entries at once (with a single SSE2 compare
+/// when available) and only looks at the entries whose fingerprint matches, 
+/// instead of at every entry on the walk. The expected entry is still checked
+/// first by vtbl_map::get(), so lookups that do not collide cost the same.
+struct group_probing
+{
+    enum { choices = 0 };     ///< The walk is not bounded
+    enum { group_size = 16 }; ///< Number of entries whose fingerprints are compared at once
+    static size_t next(size_t j, size_t cache_mask) noexcept { return (j+1) & cache_mask; }
+};
 
-        if (XTL_LIKELY(ce->is_for(vtbl)))
-        {
-            XTL_DUMP_PERFORMANCE_ONLY(++hits);
-            return ce->value;
-        }
-        else
-        {
-            XTL_DUMP_PERFORMANCE_ONLY(++misses);
-            XTL_DUMP_PERFORMANCE_ONLY(if (ce->occupied()) ++collisions);
-
-            if (XTL_UNLIKELY(
-                descriptor->is_full()                     // No entries left for possibly new vtbl in the cache
-                || (ce->occupied()                        // Collision - the entry for vtbl is already occupied
-                && --collisions_before_update <= 0        // We had sufficiently many collisions to justify call
-                && descriptor->used != last_table_size))) // There was at least one vtbl added since last update
-                return update(vtbl);                      // try to rearrange cache
-
-            // Try to find entry with our vtbl and swap it with where it is expected to be
-            descriptor->get(vtbl,j); // This will bring correct pointer into ce
-            XTL_ASSERT(ce->is_for(vtbl));
-            return ce->value;
-        }
-    }
+/// Number of entries whose fingerprints a probing policy compares at once, 
+/// which is 0 for policies that do not keep fingerprints.
+template <typename Probing> struct probing_group_size                { enum { value = 0 }; };
+template <>                 struct probing_group_size<group_probing> { enum { value = group_probing::group_size }; };
 
-//------------------------------------------------------------------------------
+/// Bit mask of those of the 16 bytes starting at g that are equal to t
+inline uint32_t group_matches(const unsigned char* g, unsigned char t) noexcept
+{
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(g));
+    return uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(char(t)))));
+#else
+    uint32_t result = 0;
 
-    // FIX: temporary copypaste of get overloads below into xtl_get. Make get more generic to work with both cases
-
-    //template <typename S1> inline auto xtl_get(const S1* s1) -> typename std::enable_if<!xtl::is_poly_morphic<S1>::value,T&>::type { static T dummy; return dummy; }
-    template <typename S1> inline auto xtl_get(const S1* s1) -> typename std::enable_if< xtl::is_poly_morphic<S1>::value,T&>::type { intptr_t vtbl[1] = {vtbl_of(s1)}; return get(vtbl); }
-
-    //template <typename S1, typename S2> inline auto xtl_get(const S1* s1, const S2* s2) -> typename std::enable_if<!xtl::is_poly_morphic<S1>::value && !xtl::is_poly_morphic<S2>::value,T&>::type { static T dummy; return dummy; }
-    template <typename S1, typename S2> inline auto xtl_get(const S1*   , const S2* s2) -> typename std::enable_if<!xtl::is_poly_morphic<S1>::value &&  xtl::is_poly_morphic<S2>::value,T&>::type { intptr_t vtbl[1] = {            vtbl_of(s2)}; return get(vtbl); }
-    template <typename S1, typename S2> inline auto xtl_get(const S1* s1, const S2*   ) -> typename std::enable_if< xtl::is_poly_morphic<S1>::value && !xtl::is_poly_morphic<S2>::value,T&>::type { intptr_t vtbl[1] = {vtbl_of(s1)            }; return get(vtbl); }
-    template <typename S1, typename S2> inline auto xtl_get(const S1* s1, const S2* s2) -> typename std::enable_if< xtl::is_poly_morphic<S1>::value &&  xtl::is_poly_morphic<S2>::value,T&>::type { intptr_t vtbl[2] = {vtbl_of(s1),vtbl_of(s2)}; return get(vtbl); }
-
-    //template <typename S1, typename S2, typename S3> inline auto xtl_get(const S1*   , const S2*   , const S3*   ) -> typename std::enable_if<!xtl::is_poly_morphic<S1>::value && !xtl::is_poly_morphic<S2>::value && !xtl::is_poly_morphic<S3>::value,T&>::type { static T dummy; return dummy; }
-    template <typename S1, typename S2, typename S3> inline auto xtl_get(const S1*   , const S2*   , const S3* s3) -> typename std::enable_if<!xtl::is_poly_morphic<S1>::value && !xtl::is_poly_morphic<S2>::value &&  xtl::is_poly_morphic<S3>::value,T&>::type { intptr_t vtbl[1] = {                        vtbl_of(s3)}; return get(vtbl); }
-    template <typename S1, typename S2, typename S3> inline auto xtl_get(const S1*   , const S2* s2, const S3*   ) -> typename std::enable_if<!xtl::is_poly_morphic<S1>::value &&  xtl::is_poly_morphic<S2>::value && !xtl::is_poly_morphic<S3>::value,T&>::type { intptr_t vtbl[1] = {            vtbl_of(s2)            }; return get(vtbl); }
-    template <typename S1, typename S2, typename S3> inline auto xtl_get(const S1*   , const S2* s2, const S3* s3) -> typename std::enable_if<!xtl::is_poly_morphic<S1>::value &&  xtl::is_poly_morphic<S2>::value &&  xtl::is_poly_morphic<S3>::value,T&>::type { intptr_t vtbl[2] = {            vtbl_of(s2),vtbl_of(s3)}; return get(vtbl); }
-    template <typename S1, typename S2, typename S3> inline auto xtl_get(const S1* s1, const S2*   , const S3*   ) -> typename std::enable_if< xtl::is_poly_morphic<S1>::value && !xtl::is_poly_morphic<S2>::value && !xtl::is_poly_morphic<S3>::value,T&>::type { intptr_t vtbl[1] = {vtbl_of(s1)                        }; return get(vtbl); }
-    template <typename S1, typename S2, typename S3> inline auto xtl_get(const S1* s1, const S2*   , const S3* s3) -> typename std::enable_if< xtl::is_poly_morphic<S1>::value && !xtl::is_poly_morphic<S2>::value &&  xtl::is_poly_morphic<S3>::value,T&>::type { intptr_t vtbl[2] = {vtbl_of(s1),            vtbl_of(s3)}; return get(vtbl); }
-    template <typename S1, typename S2, typename S3> inline auto xtl_get(const S1* s1, const S2* s2, const S3*   ) -> typename std::enable_if< xtl::is_poly_morphic<S1>::value &&  xtl::is_poly_morphic<S2>::value && !xtl::is_poly_morphic<S3>::value,T&>::type { intptr_t vtbl[2] = {vtbl_of(s1),vtbl_of(s2)            }; return get(vtbl); }
-    template <typename S1, typename S2, typename S3> inline auto xtl_get(const S1* s1, const S2* s2, const S3* s3) -> typename std::enable_if< xtl::is_poly_morphic<S1>::value &&  xtl::is_poly_morphic<S2>::value &&  xtl::is_poly_morphic<S3>::value,T&>::type { intptr_t vtbl[3] = {vtbl_of(s1),vtbl_of(s2),vtbl_of(s3)}; return get(vtbl); }
-
-    //template <typename S1, typename S2, typename S3, typename S4> inline auto xtl_get(const S1* s1, const S2* s2, const S3* s3, const S4* s4) -> typename std::enable_if<!xtl::is_poly_morphic<S1>::value && !xtl::is_poly_morphic<S2>::value && !xtl::is_poly_morphic<S3>::value && !xtl::is_poly_morphic<S4>::value,T&>::type { static T dummy; return dummy; }
-    template <typename S1, typename S2, typename S3, typename S4> inline auto xtl_get(const S1*   , const S2*   , const S3*   , const S4* s4) -> typename std::enable_if<!xtl::is_poly_morphic<S1>::value && !xtl::is_poly_morphic<S2>::value && !xtl::is_poly_morphic<S3>::value &&  xtl::is_poly_morphic<S4>::value,T&>::type { intptr_t vtbl[1] = {                                    vtbl_of(s4)}; return get(vtbl); }
-    template <typename S1, typename S2, typename S3, typename S4> inline auto xtl_get(const S1*   , const S2*   , const S3* s3, const S4*   ) -> typename std::enable_if<!xtl::is_poly_morphic<S1>::value && !xtl::is_poly_morphic<S2>::value &&  xtl::is_poly_morphic<S3>::value && !xtl::is_poly_morphic<S4>::value,T&>::type { intptr_t vtbl[1] = {                        vtbl_of(s3)            }; return get(vtbl); }
-    template <typename S1, typename S2, typename S3, typename S4> inline auto xtl_get(const S1*   , const S2*   , const S3* s3, const S4* s4) -> typename std::enable_if<!xtl::is_poly_morphic<S1>::value && !xtl::is_poly_morphic<S2>::value &&  xtl::is_poly_morphic<S3>::value &&  xtl::is_poly_morphic<S4>::value,T&>::type { intptr_t vtbl[2] = {                        vtbl_of(s3),vtbl_of(s4)}; return get(vtbl); }
-    template <typename S1, typename S2, typename S3, typename S4> inline auto xtl_get(const S1*   , const S2* s2, const S3*   , const S4*   ) -> typename std::enable_if<!xtl::is_poly_morphic<S1>::value &&  xtl::is_poly_morphic<S2>::value && !xtl::is_poly_morphic<S3>::value && !xtl::is_poly_morphic<S4>::value,T&>::type { intptr_t vtbl[1] = {            vtbl_of(s2)                        }; return get(vtbl); }
-    template <typename S1, typename S2, typename S3, typename S4> inline auto xtl_get(const S1*   , const S2* s2, const S3*   , const S4* s4) -> typename std::enable_if<!xtl::is_poly_morphic<S1>::value &&  xtl::is_poly_morphic<S2>::value && !xtl::is_poly_morphic<S3>::value &&  xtl::is_poly_morphic<S4>::value,T&>::type { intptr_t vtbl[2] = {            vtbl_of(s2),            vtbl_of(s4)}; return get(vtbl); }
-    template <typename S1, typename S2, typename S3, typename S4> inline auto xtl_get(const S1*   , const S2* s2, const S3* s3, const S4*   ) -> typename std::enable_if<!xtl::is_poly_morphic<S1>::value &&  xtl::is_poly_morphic<S2>::value &&  xtl::is_poly_morphic<S3>::value && !xtl::is_poly_morphic<S4>::value,T&>::type { intptr_t vtbl[2] = {            vtbl_of(s2),vtbl_of(s3)            }; return get(vtbl); }
-    template <typename S1, typename S2, typename S3, typename S4> inline auto xtl_get(const S1*   , const S2* s2, const S3* s3, const S4* s4) -> typename std::enable_if<!xtl::is_poly_morphic<S1>::value &&  xtl::is_poly_morphic<S2>::value &&  xtl::is_poly_morphic<S3>::value &&  xtl::is_poly_morphic<S4>::value,T&>::type { intptr_t vtbl[3] = {            vtbl_of(s2),vtbl_of(s3),vtbl_of(s4)}; return get(vtbl); }
-    template <typename S1, typename S2, typename S3, typename S4> inline auto xtl_get(const S1* s1, const S2*   , const S3*   , const S4*   ) -> typename std::enable_if< xtl::is_poly_morphic<S1>::value && !xtl::is_poly_morphic<S2>::value && !xtl::is_poly_morphic<S3>::value && !xtl::is_poly_morphic<S4>::value,T&>::type { intptr_t vtbl[1] = {vtbl_of(s1)                                    }; return get(vtbl); }
-    template <typename S1, typename S2, typename S3, typename S4> inline auto xtl_get(const S1* s1, const S2*   , const S3*   , const S4* s4) -> typename std::enable_if< xtl::is_poly_morphic<S1>::value && !xtl::is_poly_morphic<S2>::value && !xtl::is_poly_morphic<S3>::value &&  xtl::is_poly_morphic<S4>::value,T&>::type { intptr_t vtbl[2] = {vtbl_of(s1),                        vtbl_of(s4)}; return get(vtbl); }
-    template <typename S1, typename S2, typename S3, typename S4> inline auto xtl_get(const S1* s1, const S2*   , const S3* s3, const S4*   ) -> typename std::enable_if< xtl::is_poly_morphic<S1>::value && !xtl::is_poly_morphic<S2>::value &&  xtl::is_poly_morphic<S3>::value && !xtl::is_poly_morphic<S4>::value,T&>::type { intptr_t vtbl[2] = {vtbl_of(s1),            vtbl_of(s3)            }; return get(vtbl); }
-    template <typename S1, typename S2, typename S3, typename S4> inline auto xtl_get(const S1* s1, const S2*   , const S3* s3, const S4* s4) -> typename std::enable_if< xtl::is_poly_morphic<S1>::value && !xtl::is_poly_morphic<S2>::value &&  xtl::is_poly_morphic<S3>::value &&  xtl::is_poly_morphic<S4>::value,T&>::type { intptr_t vtbl[3] = {vtbl_of(s1),            vtbl_of(s3),vtbl_of(s4)}; return get(vtbl); }
-    template <typename S1, typename S2, typename S3, typename S4> inline auto xtl_get(const S1* s1, const S2* s2, const S3*   , const S4*   ) -> typename std::enable_if< xtl::is_poly_morphic<S1>::value &&  xtl::is_poly_morphic<S2>::value && !xtl::is_poly_morphic<S3>::value && !xtl::is_poly_morphic<S4>::value,T&>::type { intptr_t vtbl[2] = {vtbl_of(s1),vtbl_of(s2)                        }; return get(vtbl); }
-    template <typename S1, typename S2, typename S3, typename S4> inline auto xtl_get(const S1* s1, const S2* s2, const S3*   , const S4* s4) -> typename std::enable_if< xtl::is_poly_morphic<S1>::value &&  xtl::is_poly_morphic<S2>::value && !xtl::is_poly_morphic<S3>::value &&  xtl::is_poly_morphic<S4>::value,T&>::type { intptr_t vtbl[3] = {vtbl_of(s1),vtbl_of(s2),            vtbl_of(s4)}; return get(vtbl); }
-    template <typename S1, typename S2, typename S3, typename S4> inline auto xtl_get(const S1* s1, const S2* s2, const S3* s3, const S4*   ) -> typename std::enable_if< xtl::is_poly_morphic<S1>::value &&  xtl::is_poly_morphic<S2>::value &&  xtl::is_poly_morphic<S3>::value && !xtl::is_poly_morphic<S4>::value,T&>::type { intptr_t vtbl[3] = {vtbl_of(s1),vtbl_of(s2),vtbl_of(s3)            }; return get(vtbl); }
-    template <typename S1, typename S2, typename S3, typename S4> inline auto xtl_get(const S1* s1, const S2* s2, const S3* s3, const S4* s4) -> typename std::enable_if< xtl::is_poly_morphic<S1>::value &&  xtl::is_poly_morphic<S2>::value &&  xtl::is_poly_morphic<S3>::value &&  xtl::is_poly_morphic<S4>::value,T&>::type { intptr_t vtbl[4] = {vtbl_of(s1),vtbl_of(s2),vtbl_of(s3),vtbl_of(s4)}; return get(vtbl); }
+    for (uint32_t i = 0; i < 16; ++i)
+        result |= uint32_t(g[i] == t) << i;
 
-//------------------------------------------------------------------------------
+    return result;
+#endif
+}
 
-  //template <typename S1> inline auto get(const S1* s1) -> typename std::enable_if<!std::is_polymorphic<S1>::value,T&>::type { static T dummy; return dummy; }
-    template <typename S1> inline auto get(const S1* s1) -> typename std::enable_if< std::is_polymorphic<S1>::value,T&>::type { intptr_t vtbl[1] = {vtbl_of(s1)}; return get(vtbl); }
-
-  //template <typename S1, typename S2> inline auto get(const S1* s1, const S2* s2) -> typename std::enable_if<!std::is_polymorphic<S1>::value && !std::is_polymorphic<S2>::value,T&>::type { static T dummy; return dummy; }
-    template <typename S1, typename S2> inline auto get(const S1*   , const S2* s2) -> typename std::enable_if<!std::is_polymorphic<S1>::value &&  std::is_polymorphic<S2>::value,T&>::type { intptr_t vtbl[1] = {            vtbl_of(s2)}; return get(vtbl); }
-    template <typename S1, typename S2> inline auto get(const S1* s1, const S2*   ) -> typename std::enable_if< std::is_polymorphic<S1>::value && !std::is_polymorphic<S2>::value,T&>::type { intptr_t vtbl[1] = {vtbl_of(s1)            }; return get(vtbl); }
-    template <typename S1, typename S2> inline auto get(const S1* s1, const S2* s2) -> typename std::enable_if< std::is_polymorphic<S1>::value &&  std::is_polymorphic<S2>::value,T&>::type { intptr_t vtbl[2] = {vtbl_of(s1),vtbl_of(s2)}; return get(vtbl); }
-
-  //template <typename S1, typename S2, typename S3> inline auto get(const S1*   , const S2*   , const S3*   ) -> typename std::enable_if<!std::is_polymorphic<S1>::value && !std::is_polymorphic<S2>::value && !std::is_polymorphic<S3>::value,T&>::type { static T dummy; return dummy; }
-    template <typename S1, typename S2, typename S3> inline auto get(const S1*   , const S2*   , const S3* s3) -> typename std::enable_if<!std::is_polymorphic<S1>::value && !std::is_polymorphic<S2>::value &&  std::is_polymorphic<S3>::value,T&>::type { intptr_t vtbl[1] = {                        vtbl_of(s3)}; return get(vtbl); }
-    template <typename S1, typename S2, typename S3> inline auto get(const S1*   , const S2* s2, const S3*   ) -> typename std::enable_if<!std::is_polymorphic<S1>::value &&  std::is_polymorphic<S2>::value && !std::is_polymorphic<S3>::value,T&>::type { intptr_t vtbl[1] = {            vtbl_of(s2)            }; return get(vtbl); }
-    template <typename S1, typename S2, typename S3> inline auto get(const S1*   , const S2* s2, const S3* s3) -> typename std::enable_if<!std::is_polymorphic<S1>::value &&  std::is_polymorphic<S2>::value &&  std::is_polymorphic<S3>::value,T&>::type { intptr_t vtbl[2] = {            vtbl_of(s2),vtbl_of(s3)}; return get(vtbl); }
-    template <typename S1, typename S2, typename S3> inline auto get(const S1* s1, const S2*   , const S3*   ) -> typename std::enable_if< std::is_polymorphic<S1>::value && !std::is_polymorphic<S2>::value && !std::is_polymorphic<S3>::value,T&>::type { intptr_t vtbl[1] = {vtbl_of(s1)                        }; return get(vtbl); }
-    template <typename S1, typename S2, typename S3> inline auto get(const S1* s1, const S2*   , const S3* s3) -> typename std::enable_if< std::is_polymorphic<S1>::value && !std::is_polymorphic<S2>::value &&  std::is_polymorphic<S3>::value,T&>::type { intptr_t vtbl[2] = {vtbl_of(s1),            vtbl_of(s3)}; return get(vtbl); }
-    template <typename S1, typename S2, typename S3> inline auto get(const S1* s1, const S2* s2, const S3*   ) -> typename std::enable_if< std::is_polymorphic<S1>::value &&  std::is_polymorphic<S2>::value && !std::is_polymorphic<S3>::value,T&>::type { intptr_t vtbl[2] = {vtbl_of(s1),vtbl_of(s2)            }; return get(vtbl); }
-    template <typename S1, typename S2, typename S3> inline auto get(const S1* s1, const S2* s2, const S3* s3) -> typename std::enable_if< std::is_polymorphic<S1>::value &&  std::is_polymorphic<S2>::value &&  std::is_polymorphic<S3>::value,T&>::type { intptr_t vtbl[3] = {vtbl_of(s1),vtbl_of(s2),vtbl_of(s3)}; return get(vtbl); }
-
-  //template <typename S1, typename S2, typename S3, typename S4> inline auto get(const S1* s1, const S2* s2, const S3* s3, const S4* s4) -> typename std::enable_if<!std::is_polymorphic<S1>::value && !std::is_polymorphic<S2>::value && !std::is_polymorphic<S3>::value && !std::is_polymorphic<S4>::value,T&>::type { static T dummy; return dummy; }
-    template <typename S1, typename S2, typename S3, typename S4> inline auto get(const S1*   , const S2*   , const S3*   , const S4* s4) -> typename std::enable_if<!std::is_polymorphic<S1>::value && !std::is_polymorphic<S2>::value && !std::is_polymorphic<S3>::value &&  std::is_polymorphic<S4>::value,T&>::type { intptr_t vtbl[1] = {                                    vtbl_of(s4)}; return get(vtbl); }
-    template <typename S1, typename S2, typename S3, typename S4> inline auto get(const S1*   , const S2*   , const S3* s3, const S4*   ) -> typename std::enable_if<!std::is_polymorphic<S1>::value && !std::is_polymorphic<S2>::value &&  std::is_polymorphic<S3>::value && !std::is_polymorphic<S4>::value,T&>::type { intptr_t vtbl[1] = {                        vtbl_of(s3)            }; return get(vtbl); }
-    template <typename S1, typename S2, typename S3, typename S4> inline auto get(const S1*   , const S2*   , const S3* s3, const S4* s4) -> typename std::enable_if<!std::is_polymorphic<S1>::value && !std::is_polymorphic<S2>::value &&  std::is_polymorphic<S3>::value &&  std::is_polymorphic<S4>::value,T&>::type { intptr_t vtbl[2] = {                        vtbl_of(s3),vtbl_of(s4)}; return get(vtbl); }
-    template <typename S1, typename S2, typename S3, typename S4> inline auto get(const S1*   , const S2* s2, const S3*   , const S4*   ) -> typename std::enable_if<!std::is_polymorphic<S1>::value &&  std::is_polymorphic<S2>::value && !std::is_polymorphic<S3>::value && !std::is_polymorphic<S4>::value,T&>::type { intptr_t vtbl[1] = {            vtbl_of(s2)                        }; return get(vtbl); }
-    template <typename S1, typename S2, typename S3, typename S4> inline auto get(const S1*   , const S2* s2, const S3*   , const S4* s4) -> typename std::enable_if<!std::is_polymorphic<S1>::value &&  std::is_polymorphic<S2>::value && !std::is_polymorphic<S3>::value &&  std::is_polymorphic<S4>::value,T&>::type { intptr_t vtbl[2] = {            vtbl_of(s2),            vtbl_of(s4)}; return get(vtbl); }
-    template <typename S1, typename S2, typename S3, typename S4> inline auto get(const S1*   , const S2* s2, const S3* s3, const S4*   ) -> typename std::enable_if<!std::is_polymorphic<S1>::value &&  std::is_polymorphic<S2>::value &&  std::is_polymorphic<S3>::value && !std::is_polymorphic<S4>::value,T&>::type { intptr_t vtbl[2] = {            vtbl_of(s2),vtbl_of(s3)            }; return get(vtbl); }
-    template <typename S1, typename S2, typename S3, typename S4> inline auto get(const S1*   , const S2* s2, const S3* s3, const S4* s4) -> typename std::enable_if<!std::is_polymorphic<S1>::value &&  std::is_polymorphic<S2>::value &&  std::is_polymorphic<S3>::value &&  std::is_polymorphic<S4>::value,T&>::type { intptr_t vtbl[3] = {            vtbl_of(s2),vtbl_of(s3),vtbl_of(s4)}; return get(vtbl); }
-    template <typename S1, typename S2, typename S3, typename S4> inline auto get(const S1* s1, const S2*   , const S3*   , const S4*   ) -> typename std::enable_if< std::is_polymorphic<S1>::value && !std::is_polymorphic<S2>::value && !std::is_polymorphic<S3>::value && !std::is_polymorphic<S4>::value,T&>::type { intptr_t vtbl[1] = {vtbl_of(s1)                                    }; return get(vtbl); }
-    template <typename S1, typename S2, typename S3, typename S4> inline auto get(const S1* s1, const S2*   , const S3*   , const S4* s4) -> typename std::enable_if< std::is_polymorphic<S1>::value && !std::is_polymorphic<S2>::value && !std::is_polymorphic<S3>::value &&  std::is_polymorphic<S4>::value,T&>::type { intptr_t vtbl[2] = {vtbl_of(s1),                        vtbl_of(s4)}; return get(vtbl); }
-    template <typename S1, typename S2, typename S3, typename S4> inline auto get(const S1* s1, const S2*   , const S3* s3, const S4*   ) -> typename std::enable_if< std::is_polymorphic<S1>::value && !std::is_polymorphic<S2>::value &&  std::is_polymorphic<S3>::value && !std::is_polymorphic<S4>::value,T&>::type { intptr_t vtbl[2] = {vtbl_of(s1),            vtbl_of(s3)            }; return get(vtbl); }
-    template <typename S1, typename S2, typename S3, typename S4> inline auto get(const S1* s1, const S2*   , const S3* s3, const S4* s4) -> typename std::enable_if< std::is_polymorphic<S1>::value && !std::is_polymorphic<S2>::value &&  std::is_polymorphic<S3>::value &&  std::is_polymorphic<S4>::value,T&>::type { intptr_t vtbl[3] = {vtbl_of(s1),            vtbl_of(s3),vtbl_of(s4)}; return get(vtbl); }
-    template <typename S1, typename S2, typename S3, typename S4> inline auto get(const S1* s1, const S2* s2, const S3*   , const S4*   ) -> typename std::enable_if< std::is_polymorphic<S1>::value &&  std::is_polymorphic<S2>::value && !std::is_polymorphic<S3>::value && !std::is_polymorphic<S4>::value,T&>::type { intptr_t vtbl[2] = {vtbl_of(s1),vtbl_of(s2)                        }; return get(vtbl); }
-    template <typename S1, typename S2, typename S3, typename S4> inline auto get(const S1* s1, const S2* s2, const S3*   , const S4* s4) -> typename std::enable_if< std::is_polymorphic<S1>::value &&  std::is_polymorphic<S2>::value && !std::is_polymorphic<S3>::value &&  std::is_polymorphic<S4>::value,T&>::type { intptr_t vtbl[3] = {vtbl_of(s1),vtbl_of(s2),            vtbl_of(s4)}; return get(vtbl); }
-    template <typename S1, typename S2, typename S3, typename S4> inline auto get(const S1* s1, const S2* s2, const S3* s3, const S4*   ) -> typename std::enable_if< std::is_polymorphic<S1>::value &&  std::is_polymorphic<S2>::value &&  std::is_polymorphic<S3>::value && !std::is_polymorphic<S4>::value,T&>::type { intptr_t vtbl[3] = {vtbl_of(s1),vtbl_of(s2),vtbl_of(s3)            }; return get(vtbl); }
-    template <typename S1, typename S2, typename S3, typename S4> inline auto get(const S1* s1, const S2* s2, const S3* s3, const S4* s4) -> typename std::enable_if< std::is_polymorphic<S1>::value &&  std::is_polymorphic<S2>::value &&  std::is_polymorphic<S3>::value &&  std::is_polymorphic<S4>::value,T&>::type { intptr_t vtbl[4] = {vtbl_of(s1),vtbl_of(s2),vtbl_of(s3),vtbl_of(s4)}; return get(vtbl); }
+/// Probing policy of vtbl_map that keeps each tuple of vtbl pointers in one of 
+/// only two entries: the expected one and the alternative one, computed with an
+/// independent hash of the vtbl pointers. Lookups thus never take more than two
+/// probes. When both entries are taken, vtbl_map::update() moves their occupants
+/// to their own alternative entries, at most Displacements times, and grows
+/// the cache when that does not succeed. Caches are kept at most half full.
+/// \note Single-threaded vtbl maps only.
+template <size_t Displacements = 32>
+struct cuckoo_probing
+{
+    enum { choices = 2 };                       ///< Number of entries a tuple can be in
+    enum { max_displacements = Displacements }; ///< Moves before the cache has to grow
+    static size_t next(size_t j, size_t cache_mask) noexcept { return (j+1) & cache_mask; }
+
+    /// The alternative entry of vtbl. Unlike the expected entry, it depends on 
+    /// all the bits of the vtbl pointers, so that growing the cache eventually
+    /// separates tuples whose expected and alternative entries coincide.
+    template <size_t N>
+    static size_t alternate(const intptr_t (&vtbl)[N], size_t cache_mask) noexcept
+    {
+        size_t h = 0;
 
-    /// A function that gets called when the cache is either too inefficient or full.
-    T& update(const intptr_t (&vtbl)[N]);
+        for (size_t i = 0; i < N; ++i)
+            h = (h ^ size_t(vtbl[i])) * size_t(0x9E3779B97F4A7C15ULL); // Fibonacci hashing
 
-#if XTL_DUMP_PERFORMANCE
-    std::ostream& operator>>(std::ostream& os) const;
-    friend std::ostream& operator<<(std::ostream& os, const vtbl_map& m) { return m >> os; }
-#endif
+        return (h >> (XTL_BIT_SIZE(size_t)/2)) & cache_mask;
+    }
+};
 
-private:
+/// Hashing policy of vtbl_map that interleaves bits of the shifted vtbl pointers
+struct interleave_hashing
+{
+    enum { shift_search = 1 }; ///< Index depends on shifts, which vtbl_map::update() has to choose
+    template <size_t N>
+    static size_t key(const intptr_t (&vtbl)[N]) noexcept { return interleave(vtbl); }
+};
 
-    /// Cached mappings of vtbl to some indecies
-    cache_descriptor* descriptor;
+/// Hashing policy of vtbl_map that XORs shifted vtbl pointers, each additionally
+/// shifted left by its position to tell apart tuples of the same vtbl pointers.
+struct xor_hashing
+{
+    enum { shift_search = 1 }; ///< Index depends on shifts, which vtbl_map::update() has to choose
+    template <size_t N>
+    static size_t key(const intptr_t (&vtbl)[N]) noexcept 
+    {
+        size_t result = size_t(vtbl[0]);
+        for (size_t i = 1; i < N; ++i) result ^= size_t(vtbl[i]) << i;
+        return result;
+    }
+};
 
-    /// A reference to a global variable that will be initialized with the 
-    /// number of case clauses of a given match statement
-    const vtbl_count_t& case_clauses;
+/// Hashing policy of vtbl_map that combines the vtbl pointers with Fibonacci
+/// hashing and takes the middle bits of the product, which depend on all the 
+/// lower bits of every vtbl pointer. Which bits vary in vtbl pointers, and thus
+/// how the allocator or linker placed the vtbls, matters much less than with 
+/// the other policies, so vtbl_map::update() only chooses the size of the 
+/// cache and does not search for per-argument shifts, at the cost of a 
+/// multiplication per argument on every lookup.
+struct multiplicative_hashing
+{
+    enum { shift_search = 0 }; ///< Index does not depend on shifts enough to search for them
+    template <size_t N>
+    static size_t key(const intptr_t (&vtbl)[N]) noexcept 
+    {
+        size_t h = 0;
 
-    /// Memoized table.size() during last cache rearranging
-    size_t last_table_size;
+        for (size_t i = 0; i < N; ++i)
+            h = (h ^ size_t(vtbl[i])) * size_t(0x9E3779B97F4A7C15ULL);
 
-    /// Number of colisions that we will still tolerate before next update
-    int collisions_before_update;
+        return h >> (XTL_BIT_SIZE(size_t)/2);
+    }
+};
 
-    /// Previous number of colisions that we will still tolerate before next update
-    int prev_collisions_before_update;
+/// Update policy of vtbl_map that rearranges the cache after Collisions
+/// collisions, doubling this number whenever rearrangement does not change
+/// cache parameters, and considers caches of up to 2^LogInc times the 
+/// required size.
+template <int Collisions = initial_collisions_before_update, bit_offset_t LogInc = max_log_inc>
+struct adaptive_update
+{
+    static const int          initial_collisions = Collisions;
+    static const bit_offset_t log_increment      = LogInc;
+    static int          collisions() noexcept { return Collisions; }
+    static bit_offset_t log_inc()    noexcept { return LogInc; }
+};
 
-#if XTL_DUMP_PERFORMANCE
-    const char* file;      ///< File in which this vtblmap_of is instantiated
-    size_t      line;      ///< Line in the file where it is instantiated
-    const char* func;      ///< Function in which this vtblmap_of is instantiated
-    size_t      updates;   ///< Amount of reconfigurations performed at run time
-    size_t      hits;      ///< The number of cache hits
-    size_t      misses;    ///< The number of cache misses
-    size_t      collisions;///< Out of all the misses, how many were actual collisions
+#if XTL_RUNTIME_TUNING
+/// Update policy of vtbl_map that behaves as adaptive_update with the values
+/// of vtbl_tuning() at the time of each update.
+struct tuned_update
+{
+    static int          collisions() noexcept { return vtbl_tuning().initial_collisions; }
+    static bit_offset_t log_inc()    noexcept { return vtbl_tuning().max_log_inc; }
+};
+typedef tuned_update      default_update; ///< Update policy used by default
+#else
+typedef adaptive_update<> default_update; ///< Update policy used by default
+#endif
+
+#if XTL_USE_LCG_WALK
+typedef lcg_probing    default_probing; ///< Probing policy used by default
+#else
+typedef linear_probing default_probing; ///< Probing policy used by default
+#endif
+
+#if XTL_USE_MULTIPLICATIVE_HASHING
+typedef multiplicative_hashing default_hashing; ///< Hashing policy used by default
+#else
+typedef interleave_hashing     default_hashing; ///< Hashing policy used by default
 #endif
 
+/// Combination of probing, hashing and update policies of vtbl_map<N,T,P>
+template <typename Probing = default_probing, typename Hashing = default_hashing, typename Update = default_update>
+struct vtbl_map_policy
+{
+    typedef Probing probing; ///< Order of entries to try when the expected one is taken
+    typedef Hashing hashing; ///< Combination of shifted vtbl pointers into key
+    typedef Update  update;  ///< When and how the cache is rearranged
 };
 
+/// Policy P of the vtbl maps of Match statements that are executed often, 
+/// which under #XTL_DISPATCH_SECTIONS are preallocated next to each other in
+/// #XTL_HOT_DISPATCH_SECTION. Redefine #XTL_VTBL_MAP_POLICY as, e.g. 
+/// mch::hot_dispatch<> around such statements. \see write_hot_vtbl_sites()
+template <typename P = vtbl_map_policy<> >
+struct hot_dispatch : P {};
+
+//------------------------------------------------------------------------------
+
+/// Forward declaration of the map used by Match statements on N polymorphic subjects
+template <size_t N, typename T, typename P = vtbl_map_policy<> > class vtbl_map;
+
 //------------------------------------------------------------------------------
 
 /// This specialization is used when none of the arguments of Match-statement is polymorphic.
-template <typename T>
-class vtbl_map<0,T>
+template <typename T, typename P>
+class vtbl_map<0,T,P>
 {
 public:
-    vtbl_map(XTL_DUMP_PERFORMANCE_ONLY(const char*, size_t, const char*,) const vtbl_count_t&) {}
+    vtbl_map(XTL_VTBL_COUNTERS_ONLY(const char*, size_t, const char*,) const vtbl_count_t&) {}
+    XTL_VTBL_COUNTERS_ONLY(vtbl_map(const vtbl_count_t&) {}) // Preallocated maps have no site
     inline T& get(...) noexcept { return dummy; }
+    inline T& get_pinned(dispatch_pin&, ...) noexcept { return dummy; }
+    XTL_VTBL_COUNTERS_ONLY(bool locate(const char*, size_t, const char*) { return true; })
     static T dummy; 
 };
 
-template <typename T> T vtbl_map<0,T>::dummy;
+template <typename T, typename P> T vtbl_map<0,T,P>::dummy;
 
 //------------------------------------------------------------------------------
 
-template <size_t N, typename T>
-vtbl_map<N,T>::cache_descriptor::cache_descriptor(
-    const size_t       log_size, ///< Parameter k of the cache - the log of the size of the cache
-    const bit_offset_t shift     ///< Parameter l of the cache - number of irrelevant bits on the right to remove
-) :
-    cache_mask( (1<<log_size) - 1 ),
-    //optimal_shift(shift),
-    used(0)
+#if XTL_VTBL_MAP_REGISTRY
+/// Requests that functions working on all instances of vtbl_map<N,T> can 
+/// send to each of them through vtbl_map_node.
+enum vtbl_map_request
+{
+    freeze_request,    ///< vtbl_map::freeze()
+    memory_request,    ///< vtbl_map::memory_used()
+    age_request,       ///< vtbl_map::compact(false)
+    compact_request,   ///< vtbl_map::compact(true)
+    rearrange_request, ///< vtbl_map::rearrange()
+    statistics_request,///< Fill in vtbl_site_statistics passed as argument
+    invalidate_request,///< vtbl_map::invalidate() of vtbl_range passed as argument
+    seal_size_request, ///< vtbl_map::seal_size()
+    seal_request,      ///< vtbl_map::seal() into vtbl_seal_segment passed as argument
+    layout_request     ///< Fill in vtbl_site_layout passed as argument
+};
+
+/// Node of the intrusive list of all instances of vtbl_map<N,T> that lets 
+/// functions like freeze_vtbl_maps() reach maps of different N and T.
+struct vtbl_map_node
+{
+    vtbl_map_node(void* m, size_t (*r)(void*, vtbl_map_request, void*)) : map(m), request(r)
+    {
+    #if XTL_MULTI_THREADING
+        std::lock_guard<std::mutex> guard(mutex());
+    #endif
+        next   = head();
+        head() = this;
+
+    #if XTL_VTBL_INVALIDATION
+        static vtbl_invalidator invalidator(&invalidate_all); // Registered along with the first map
+    #endif
+    }
+   ~vtbl_map_node()
+    {
+    #if XTL_MULTI_THREADING
+        std::lock_guard<std::mutex> guard(mutex());
+    #endif
+
+        for (vtbl_map_node** p = &head(); *p; p = &(*p)->next)
+            if (*p == this) { *p = next; break; }
+    }
+
+    /// Head of the list of all the nodes
+    static vtbl_map_node*& head() { static vtbl_map_node* list = 0; return list; }
+
+#if XTL_MULTI_THREADING
+    /// Guards the list against maps of different Match statements being 
+    /// created and destroyed concurrently
+    static std::mutex& mutex() { static std::mutex m; return m; }
+#endif
+
+    /// Sends request r with an optional argument to every map in the list and
+    /// sums up their answers
+    static size_t request_all(vtbl_map_request r, void* arg = 0)
+    {
+    #if XTL_MULTI_THREADING
+        std::lock_guard<std::mutex> guard(mutex());
+    #endif
+        size_t result = 0;
+
+        for (vtbl_map_node* p = head(); p; p = p->next)
+            result += p->request(p->map, r, arg);
+
+        return result;
+    }
+
+#if XTL_VTBL_INVALIDATION
+    /// Drops entries of vtbl pointers in range from all the maps. \see invalidate_vtbl_range()
+    static size_t invalidate_all(const vtbl_range& range) { return request_all(invalidate_request, const_cast<vtbl_range*>(&range)); }
+#endif
+
+    void*          map;                                      ///< vtbl_map<N,T> this node belongs to
+    size_t       (*request)(void*, vtbl_map_request, void*); ///< Handles the request with an optional argument on #map
+    vtbl_map_node* next;                                     ///< Next node in the list
+};
+
+//------------------------------------------------------------------------------
+
+/// Total number of bytes used by all existing vtbl_map<N,T> instances
+inline size_t vtbl_maps_memory_used() { return vtbl_map_node::request_all(memory_request); }
+#endif
+
+#if XTL_DEFERRED_VTBL_UPDATES
+/// Rearranges the caches of all vtbl_map<N,T> instances that asked for it 
+/// since the previous call (\see vtbl_map::rearrange()).
+/// \note Single-threaded maps have to be rearranged when no Match statement
+///       is being executed, e.g. between requests handled by a server, while
+///       multi-threaded ones can be rearranged by a helper thread at any time.
+/// \returns The number of maps whose caches were rearranged.
+inline size_t rearrange_vtbl_maps() { return vtbl_map_node::request_all(rearrange_request); }
+#endif
+
+/// Engines a vtbl_map<N,T> serves its lookups with \see #XTL_ADAPTIVE_DISPATCH
+enum dispatch_engine
+{
+    profiling_engine,   ///< Hash of the cache, while the lookups are profiled
+    monomorphic_engine, ///< Compare with the only tuple of vtbl pointers seen
+    polymorphic_engine, ///< Compares with the few tuples of vtbl pointers seen
+    hashing_engine      ///< Hash of the cache
+};
+
+/// Name of the engine for reports
+inline const char* dispatch_engine_name(dispatch_engine e)
+{
+    static const char* names[] = {"profiling", "monomorphic", "polymorphic", "hashing"};
+    return names[e];
+}
+
+#if XTL_VTBL_UPDATE_HISTOGRAM
+/// What a single rearrangement of the cache of a vtbl_map<N,T> did and cost.
+/// \see vtbl_map::update()
+struct vtbl_update_record
+{
+    unsigned long long cycles;            ///< Cycles spent in the update
+    size_t             old_log_size;      ///< Log size of the cache before the update
+    size_t             new_log_size;      ///< Log size of the cache after the update
+    size_t             collisions_before; ///< Tuples outside of their home entries before the update
+    size_t             collisions_after;  ///< Tuples outside of their home entries after the update
+};
+
+/// Histogram of the cost of the updates of a vtbl_map<N,T>, where bucket i 
+/// counts the updates that took [2^i,2^(i+1)) cycles.
+struct vtbl_update_histogram
+{
+    enum { buckets = 8*sizeof(unsigned long long) };
+
+    vtbl_update_histogram() : bucket(), count(0), total_cycles(0), last(), worst() {}
+
+    /// Accounts for another update
+    void record(const vtbl_update_record& r)
+    {
+        size_t b = 0;
+
+        for (unsigned long long c = r.cycles; c >>= 1; )
+            ++b;
+
+        ++bucket[b];
+        ++count;
+        total_cycles += r.cycles;
+        last = r;
+
+        if (r.cycles >= worst.cycles)
+            worst = r;
+    }
+
+    /// An upper bound on the cycles taken by fraction q of the updates, 
+    /// e.g. percentile(0.99) is a bound on the 99th percentile.
+    unsigned long long percentile(double q) const
+    {
+        size_t n = 0;
+
+        for (size_t b = 0; b < buckets; ++b)
+            if ((n += bucket[b]) >= q*count && n)
+                return b+1 < buckets ? (1ULL << (b+1)) - 1 : ~0ULL;
+
+        return 0;
+    }
+
+    size_t             bucket[buckets]; ///< Number of updates by log of their cycles
+    size_t             count;           ///< Number of updates
+    unsigned long long total_cycles;    ///< Cycles taken by all the updates
+    vtbl_update_record last;            ///< The most recent update
+    vtbl_update_record worst;           ///< The most expensive update
+};
+#endif
+
+#if XTL_VTBL_STATISTICS
+/// Snapshot of the statistics a vtbl_map<N,T> of a Match statement keeps.
+/// \see for_each_vtbl_site()
+struct vtbl_site_statistics
+{
+    const char* file;       ///< File of the Match statement
+    size_t      line;       ///< Line of the Match statement in that file
+    const char* func;       ///< Function containing the Match statement
+    size_t      subjects;   ///< Number N of polymorphic subjects
+    size_t      log_size;   ///< Log of the number of entries in the cache
+    size_t      entries;    ///< Number of tuples of vtbl pointers in the cache
+    size_t      memory;     ///< Bytes used by the map (\see vtbl_map::memory_used())
+    size_t      hits;       ///< Lookups that found their tuple in its home entry
+    size_t      misses;     ///< Lookups that did not
+    size_t      collisions; ///< Misses whose home entry was taken by another tuple
+    size_t      updates;    ///< Rearrangements of the cache
+    size_t      inline_hits;///< Hits found in the inline cache \see #XTL_INLINE_CACHE_SIZE
+    const char* engine;     ///< Name of the engine serving the lookups \see #XTL_ADAPTIVE_DISPATCH
+    size_t      engine_hits;///< Hits served by compares of that engine without the hash
+    size_t      engine_switches; ///< Times the site started serving lookups with another engine
+    double      profile_cycles;  ///< Cycles between lookups in the last profile, 0 until profiled
+    double      engine_cycles;   ///< Cycles between lookups with the engine it chose, 0 until timed
+#if XTL_VTBL_UPDATE_HISTOGRAM
+    vtbl_update_histogram update_costs; ///< Timing of the rearrangements
+#endif
+
+    /// Fraction of lookups that were hits or 1 if there were no lookups yet
+    double hit_ratio() const { return hits + misses ? double(hits) / double(hits + misses) : 1.0; }
+
+    /// Fraction of hits found in the inline cache or 0 if there were no hits 
+    /// yet. A site whose ratio stays low pays for the compares of the inline 
+    /// cache on every lookup without saving the computation of the cache index.
+    double inline_ratio() const { return hits ? double(inline_hits) / double(hits) : 0.0; }
+
+    /// Cycles per lookup saved by the engine chosen by the last profile, which 
+    /// is negative when it was slower than the hash and 0 until it was timed. 
+    /// The cycles include whatever the program does between the lookups, so 
+    /// only sites with a steady workload are measured meaningfully.
+    double benefit() const { return engine_cycles > 0.0 ? profile_cycles - engine_cycles : 0.0; }
+};
+
+/// Calls f(const vtbl_site_statistics&) for every live vtbl_map<N,T>, which 
+/// normally means every Match statement executed at least once, e.g. to 
+/// export them into a metrics system.
+/// \note Under #XTL_MULTI_THREADING f is called under the lock of the list 
+///       and thus must not execute Match statements seen for the first time.
+template <typename F>
+void for_each_vtbl_site(F f)
+{
+#if XTL_MULTI_THREADING
+    std::lock_guard<std::mutex> guard(vtbl_map_node::mutex());
+#endif
+
+    for (vtbl_map_node* p = vtbl_map_node::head(); p; p = p->next)
+    {
+        vtbl_site_statistics s;
+
+        if (p->request(p->map, statistics_request, &s))
+            f(static_cast<const vtbl_site_statistics&>(s));
+    }
+}
+
+/// Writes file:line of the Match statements that did the most lookups, most 
+/// frequent first, until they account for the given share of all lookups. 
+/// These are the ones worth the mch::hot_dispatch policy in the next build.
+/// \see #XTL_DISPATCH_SECTIONS
+inline void write_hot_vtbl_sites(std::ostream& os, double share = 0.9)
+{
+    std::vector<vtbl_site_statistics> sites;
+    size_t total = 0;
+
+    for_each_vtbl_site([&sites,&total](const vtbl_site_statistics& s) { sites.push_back(s); total += s.hits + s.misses; });
+    std::stable_sort(sites.begin(), sites.end(), [](const vtbl_site_statistics& a, const vtbl_site_statistics& b) { return a.hits + a.misses > b.hits + b.misses; });
+
+    size_t covered = 0;
+
+    for (size_t i = 0; i < sites.size() && covered < share*total; ++i)
+    {
+        os << sites[i].file << ':' << sites[i].line << '\n';
+        covered += sites[i].hits + sites[i].misses;
+    }
+}
+#endif
+
+#if XTL_VTBL_LAYOUT
+/// Tuple of vtbl pointers in an occupied entry of the cache of a vtbl_map<N,T>
+/// \see vtbl_site_layout
+struct vtbl_entry_layout
+{
+    size_t                slot;    ///< Entry of the cache the tuple is in
+    size_t                home;    ///< Expected entry of the tuple, which its lookups try first
+    size_t                probes;  ///< Steps of the probing sequence from home to slot
+    size_t                lookups; ///< Lookups that found the tuple
+    std::vector<intptr_t> vtbl;    ///< Vtbl pointers of the tuple
+};
+
+/// Layout of the cache of a vtbl_map<N,T> of a Match statement.
+/// \see for_each_vtbl_layout(), write_vtbl_layouts()
+struct vtbl_site_layout
+{
+    vtbl_site_statistics           statistics; ///< Counters of the site
+    size_t                         slots;      ///< Number of entries in the cache
+    std::vector<size_t>            shifts;     ///< optimal_shift of each subject
+    std::vector<intptr_t>          used_bits;  ///< Bits of each vtbl pointer the expected entry depends on
+    std::vector<intptr_t>          varying;    ///< Bits in which vtbl pointers of each subject differ
+    std::vector<vtbl_entry_layout> entries;    ///< Occupied entries in the order of slots
+};
+
+/// Calls f(const vtbl_site_layout&) for every live single-threaded 
+/// vtbl_map<N,T>. Unlike for_each_vtbl_site() it copies the entire cache.
+template <typename F>
+void for_each_vtbl_layout(F f)
+{
+#if XTL_MULTI_THREADING
+    std::lock_guard<std::mutex> guard(vtbl_map_node::mutex());
+#endif
+
+    for (vtbl_map_node* p = vtbl_map_node::head(); p; p = p->next)
+    {
+        vtbl_site_layout l;
+
+        if (p->request(p->map, layout_request, &l))
+            f(static_cast<const vtbl_site_layout&>(l));
+    }
+}
+
+/// Writes s as a JSON string
+inline void write_json_string(std::ostream& os, const char* s)
+{
+    os << '"';
+
+    for (; s && *s; ++s)
+        if (*s == '"' || *s == '\\')
+            os << '\\' << *s;
+        else
+        if ((unsigned char)*s < 0x20)
+            os << ' ';
+        else
+            os << *s;
+
+    os << '"';
+}
+
+/// Writes a JSON array of hexadecimal strings, which unlike JSON numbers keep
+/// all the bits of vtbl pointers
+inline void write_json_hex(std::ostream& os, const std::vector<intptr_t>& v)
+{
+    std::ios::fmtflags fmt = os.flags();
+    os << '[' << std::hex;
+
+    for (size_t i = 0; i < v.size(); ++i)
+        os << (i ? "," : "") << "\"0x" << (unsigned long long)v[i] << '"';
+
+    os << ']';
+    os.flags(fmt);
+}
+
+/// Writes the layouts of the caches of all live vtbl maps as a JSON array with
+/// an object per Match statement. Besides the counters of the site, each object
+/// has an occupancy string with a character per entry of the cache: '.' for a
+/// vacant entry, a digit for the number of probes the tuple in it is away from 
+/// its expected entry or '+' for 10 and more. It is followed by the shifts and
+/// the bits of each vtbl pointer the expected entry depends on, the bits in 
+/// which vtbl pointers differ and the occupied entries with their lookups.
+/// Bits that differ but are not used are those that could have told apart 
+/// tuples that collide.
+inline void write_vtbl_layouts(std::ostream& os)
+{
+    bool first = true;
+    os << '[';
+
+    for_each_vtbl_layout([&os,&first](const vtbl_site_layout& l)
+    {
+        const vtbl_site_statistics& s = l.statistics;
+        std::string occupancy(l.slots, '.');
+
+        for (size_t i = 0; i < l.entries.size(); ++i)
+            occupancy[l.entries[i].slot] = l.entries[i].probes < 10 ? char('0' + l.entries[i].probes) : '+';
+
+        os << (first ? "\n" : ",\n") << "{\"file\":";   write_json_string(os, s.file);
+        os << ",\"line\":" << s.line << ",\"func\":"; write_json_string(os, s.func);
+        os << ",\"subjects\":"   << s.subjects
+           << ",\"log_size\":"   << s.log_size
+           << ",\"slots\":"      << l.slots
+           << ",\"entries\":"    << l.entries.size()
+           << ",\"hits\":"       << s.hits
+           << ",\"misses\":"     << s.misses
+           << ",\"collisions\":" << s.collisions
+           << ",\"updates\":"    << s.updates
+           << ",\"occupancy\":\"" << occupancy << '"'
+           << ",\"shifts\":[";
+
+        for (size_t i = 0; i < l.shifts.size(); ++i)
+            os << (i ? "," : "") << l.shifts[i];
+
+        os << "],\"used_bits\":"; write_json_hex(os, l.used_bits);
+        os << ",\"varying_bits\":"; write_json_hex(os, l.varying);
+        os << ",\"table\":[";
+
+        for (size_t i = 0; i < l.entries.size(); ++i)
+        {
+            const vtbl_entry_layout& e = l.entries[i];
+            os << (i ? "," : "") << "\n {\"slot\":" << e.slot 
+               << ",\"home\":"    << e.home 
+               << ",\"probes\":"  << e.probes 
+               << ",\"lookups\":" << e.lookups
+               << ",\"vtbl\":";
+            write_json_hex(os, e.vtbl);
+            os << '}';
+        }
+
+        os << "]}";
+        first = false;
+    });
+
+    os << "\n]\n";
+}
+#endif
+
+//------------------------------------------------------------------------------
+
+#if !XTL_MULTI_THREADING
+
+#if defined(DBG_NEW)
+    #undef new
+#endif
+
+#if XTL_VTBL_ALLOCATOR
+/// Functions through which vtbl_map<N,T> gets the memory for its cache 
+/// descriptors and cache entries, e.g. from huge pages or from the NUMA node of
+/// the thread executing the Match statement. The memory does not have to be
+/// aligned: the maps align it at #XTL_CACHE_LINE_SIZE themselves.
+struct vtbl_allocator
+{
+    void* (*allocate)(size_t size); ///< Gets size bytes of memory
+    void  (*deallocate)(void* p);   ///< Returns memory obtained from allocate
+};
+
+/// Global heap, which vtbl maps use until the hook is changed
+inline void* vtbl_heap_allocate(size_t size) { return ::operator new(size); }
+inline void  vtbl_heap_deallocate(void* p)   { ::operator delete(p); }
+
+/// The allocator used for the memory of all single-threaded vtbl maps.
+/// \note Memory is always returned to the allocator it came from, so the hook
+///       can be changed at any time, including after preloaded vtbl maps made
+///       their first allocations during static initialization.
+inline vtbl_allocator& vtbl_allocator_hook()
+{
+    static vtbl_allocator hook = { &vtbl_heap_allocate, &vtbl_heap_deallocate };
+    return hook;
+}
+
+/// Header that precedes every block of memory obtained from vtbl_allocator_hook()
+struct vtbl_block
+{
+    void* memory;               ///< Pointer returned by vtbl_allocator::allocate
+    void  (*deallocate)(void*); ///< Function to return it with
+};
+
+/// Gets size bytes aligned at #XTL_CACHE_LINE_SIZE from vtbl_allocator_hook()
+inline void* vtbl_block_allocate(size_t size)
+{
+    const vtbl_allocator allocator = vtbl_allocator_hook();
+    char* p = static_cast<char*>(allocator.allocate(size + sizeof(vtbl_block) + XTL_CACHE_LINE_SIZE));
+    char* q = p + sizeof(vtbl_block);
+    q += (XTL_CACHE_LINE_SIZE - intptr_t(q) % XTL_CACHE_LINE_SIZE) % XTL_CACHE_LINE_SIZE;
+    vtbl_block* b = reinterpret_cast<vtbl_block*>(q) - 1;
+    b->memory     = p;
+    b->deallocate = allocator.deallocate;
+    return q;
+}
+
+/// Returns memory obtained with vtbl_block_allocate() to its allocator
+inline void vtbl_block_deallocate(void* q)
+{
+    if (q)
+    {
+        const vtbl_block* b = static_cast<vtbl_block*>(q) - 1;
+        b->deallocate(b->memory);
+    }
+}
+#endif
+
+//------------------------------------------------------------------------------
+
+#if XTL_VTBL_ARENA
+/// Dedicated memory for cache descriptors and cache entries of vtbl_map<N,T>.
+/// Memory is handed out in pieces aligned at #XTL_CACHE_LINE_SIZE from chunks
+/// of #XTL_VTBL_ARENA_CHUNK_SIZE bytes and is only returned to the heap at the
+/// end of the program.
+/// \note The arena is constructed by the first allocation of the first vtbl 
+///       map and is thus destroyed after all of them.
+class vtbl_arena
+{
+public:
+
+    /// Allocates size bytes aligned at #XTL_CACHE_LINE_SIZE
+    static void* allocate(size_t size) { return instance().get(size); }
+
+private:
+
+    vtbl_arena() : chunks(0), next(0), left(0) {}
+
+   ~vtbl_arena()
+    {
+        while (chunks)
+        {
+            void* p = chunks;
+            chunks = *static_cast<void**>(p);
+        #if XTL_VTBL_ALLOCATOR
+            vtbl_block_deallocate(p);
+        #else
+            ::operator delete(p);
+        #endif
+        }
+    }
+
+    static vtbl_arena& instance() { static vtbl_arena arena; return arena; }
+
+    void* get(size_t size)
+    {
+        size = (size + XTL_CACHE_LINE_SIZE-1) & ~size_t(XTL_CACHE_LINE_SIZE-1);
+
+        if (size > left)
+        {
+            // Chunks are linked through their first bytes, which precede the first cache line we hand out
+            const size_t chunk = std::max(size, size_t(XTL_VTBL_ARENA_CHUNK_SIZE));
+        #if XTL_VTBL_ALLOCATOR
+            char* p = static_cast<char*>(vtbl_block_allocate(chunk + XTL_CACHE_LINE_SIZE));
+        #else
+            char* p = static_cast<char*>(::operator new(chunk + XTL_CACHE_LINE_SIZE));
+        #endif
+            *reinterpret_cast<void**>(p) = chunks;
+            chunks = p;
+            next = p + XTL_CACHE_LINE_SIZE - intptr_t(p) % XTL_CACHE_LINE_SIZE;
+            left = chunk;
+        }
+
+        void* result = next;
+        next += size;
+        left -= size;
+        return result;
+    }
+
+    void*  chunks; ///< The most recently allocated chunk, which points to the previous one
+    char*  next;   ///< Next free byte in the most recent chunk
+    size_t left;   ///< Number of free bytes left in the most recent chunk
+};
+#endif
+
+//------------------------------------------------------------------------------
+
+/// Allocates memory for vtbl_map<N,T> aligned at #XTL_CACHE_LINE_SIZE
+inline void* vtbl_allocate(size_t size)
+{
+    XTL_OVERHEAD_ACCOUNTING_ONLY(mch::count_allocation(size));
+#if XTL_VTBL_ARENA
+    return vtbl_arena::allocate(size);
+#elif XTL_VTBL_ALLOCATOR
+    return vtbl_block_allocate(size);
+#else
+    // The pointer returned by the global new is kept right before the aligned memory
+    char*  p = static_cast<char*>(::operator new(size + sizeof(void*) + XTL_CACHE_LINE_SIZE));
+    char*  q = p + sizeof(void*);
+    q += (XTL_CACHE_LINE_SIZE - intptr_t(q) % XTL_CACHE_LINE_SIZE) % XTL_CACHE_LINE_SIZE;
+    reinterpret_cast<void**>(q)[-1] = p;
+    return q;
+#endif
+}
+
+/// Deallocates memory allocated with vtbl_allocate()
+inline void vtbl_deallocate(void* p)
+{
+#if XTL_VTBL_ARENA
+    XTL_UNUSED(p); // Arena memory is only released at the end of the program
+#elif XTL_VTBL_ALLOCATOR
+    vtbl_block_deallocate(p);
+#else
+    if (p)
+        ::operator delete(static_cast<void**>(p)[-1]);
+#endif
+}
+
+#if defined(DBG_NEW)
+    #define new DBG_NEW
+#endif
+
+//------------------------------------------------------------------------------
+
+#if XTL_PERFECT_HASHING
+/// Freezes all existing vtbl_map<N,T> instances (\see vtbl_map::freeze()).
+/// Call it once the program has seen all the dynamic types it is going to 
+/// see, e.g. at the end of the warm-up phase.
+/// \returns The number of maps that now have collision-free caches.
+inline size_t freeze_vtbl_maps() { return vtbl_map_node::request_all(freeze_request); }
+#endif
+
+#if XTL_VTBL_COMPACTION
+/// Number of bytes all vtbl_map<N,T> instances together may use before 
+/// compact_vtbl_maps() starts compacting them.
+inline size_t& vtbl_memory_budget() { static size_t budget = XTL_VTBL_MEMORY_BUDGET; return budget; }
+
+/// Ends the current epoch of all existing vtbl_map<N,T> instances and, when 
+/// their memory use exceeds vtbl_memory_budget(), compacts them 
+/// (\see vtbl_map::compact()). 
+/// \note Compaction invalidates references into the maps, so this has to be
+///       called when no Match statement is being executed, e.g. between 
+///       requests handled by a server.
+/// \returns The number of bytes released.
+inline size_t compact_vtbl_maps()
+{
+    return vtbl_map_node::request_all(vtbl_maps_memory_used() > vtbl_memory_budget() ? compact_request : age_request);
+}
+#endif
+
+#if XTL_SEALED_VTBL_MAPS
+/// Memory that sealed vtbl_map<N,T> instances keep their caches in. It is 
+/// handed out in pieces aligned at #XTL_CACHE_LINE_SIZE and is never released.
+/// \see seal_vtbl_maps()
+struct vtbl_seal_segment
+{
+    /// Number of bytes a piece of size bytes takes in the segment
+    static size_t piece(size_t size) { return (size + XTL_CACHE_LINE_SIZE-1) & ~size_t(XTL_CACHE_LINE_SIZE-1); }
+
+    /// Takes size bytes from the segment
+    void* allocate(size_t size)
+    {
+        XTL_ASSERT(next + piece(size) <= end);
+        void* result = next;
+        next += piece(size);
+        return result;
+    }
+
+    char* next; ///< Next free byte of the segment
+    char* end;  ///< End of the segment
+};
+
+/// Seals all existing vtbl_map<N,T> instances that are not empty 
+/// (\see vtbl_map::seal()): their caches are copied into one segment of 
+/// memory, which is then made read-only where the platform allows it. A 
+/// prefork server calls it in the parent process once it has warmed up and 
+/// before it forks its workers, so that the workers share the pages of the 
+/// caches instead of each getting a copy of them. Lookups of tuples of vtbl
+/// pointers the parent has not seen go into process-local overflow maps.
+/// \note Values associated with the sealed tuples cannot be changed anymore,
+///       which Match statements only do before they complete for the first 
+///       time on the given tuple.
+/// \returns The number of maps sealed.
+inline size_t seal_vtbl_maps()
+{
+    const size_t size = vtbl_map_node::request_all(seal_size_request);
+
+    if (!size)
+        return 0; // Nothing to seal
+
+#if defined(__unix__) || defined(__APPLE__)
+    const size_t page  = size_t(sysconf(_SC_PAGESIZE));
+    const size_t bytes = (size + page-1) & ~(page-1);
+    void* p = mmap(0, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (p == MAP_FAILED)
+        return 0; // The maps remain writable
+#else
+    void* p = vtbl_allocate(size);
+#endif
+
+    vtbl_seal_segment segment = { static_cast<char*>(p), static_cast<char*>(p) + size };
+    const size_t sealed = vtbl_map_node::request_all(seal_request, &segment);
+    XTL_ASSERT(segment.next == segment.end);
+
+#if defined(__unix__) || defined(__APPLE__)
+    mprotect(p, bytes, PROT_READ);
+#endif
+
+    return sealed;
+}
+#endif
+
+//------------------------------------------------------------------------------
+
+#if XTL_SEPARATE_DEFAULTS
+/// Set of tuples of N vtbl pointers kept in open addressing table of words, 
+/// used by vtbl_map to remember the tuples that take the default value 
+/// without giving each of them an entry of its cache \see #XTL_SEPARATE_DEFAULTS
+template <size_t N>
+class vtbl_tuple_set
+{
+public:
+
+    vtbl_tuple_set() : slots(0), log_size(0), used(0) {}
+   ~vtbl_tuple_set() { delete[] slots; }
+
+    /// Number of tuples in the set
+    size_t size() const noexcept { return used; }
+
+    /// Bytes used by the table of the set
+    size_t memory_used() const noexcept { return slots ? (size_t(1) << log_size)*N*sizeof(intptr_t) : 0; }
+
+    /// Whether vtbl was inserted into the set
+    bool contains(const intptr_t (&vtbl)[N]) const noexcept
+    {
+        return used && array_equal(slot(vtbl),vtbl);
+    }
+
+    /// Inserts vtbl into the set unless it is already there
+    void insert(const intptr_t (&vtbl)[N])
+    {
+        if (2*(used+1) > (size_t(1) << log_size)) // Kept at most half full
+            grow();
+
+        intptr_t (&s)[N] = slot(vtbl);
+
+        if (!s[0])
+        {
+            array_copy(vtbl,s);
+            ++used;
+        }
+    }
+
+    /// Calls f(vtbl) for every tuple in the set
+    template <typename F>
+    void for_each(F f) const
+    {
+        for (size_t i = 0, n = slots ? size_t(1) << log_size : 0; i < n; ++i)
+            if (slots[i][0])
+                f(slots[i]);
+    }
+
+private:
+
+    /// Slot of vtbl or the vacant slot where it would be inserted
+    intptr_t (&slot(const intptr_t (&vtbl)[N]) const noexcept)[N]
+    {
+        size_t h = 0;
+
+        for (size_t i = 0; i < N; ++i)
+            h = (h ^ size_t(vtbl[i])) * size_t(0x9E3779B97F4A7C15ull); // Fibonacci hashing
+
+        const size_t mask = (size_t(1) << log_size) - 1;
+
+        for (size_t j = h >> (XTL_BIT_SIZE(size_t) - log_size); ; j = (j+1) & mask) // Linear probing
+            if (!slots[j][0] || array_equal(slots[j],vtbl))
+                return slots[j];
+    }
+
+    /// Doubles the table, starting with 8 slots
+    void grow()
+    {
+        intptr_t (*old)[N] = slots;
+        const size_t n = old ? size_t(1) << log_size : 0;
+
+        log_size = log_size ? log_size+1 : 3;
+        slots = new intptr_t[size_t(1) << log_size][N]();
+        XTL_OVERHEAD_ACCOUNTING_ONLY(mch::count_allocation((size_t(1) << log_size)*sizeof(intptr_t[N])));
+
+        for (size_t i = 0; i < n; ++i)
+            if (old[i][0])
+                array_copy(old[i],slot(old[i]));
+
+        delete[] old;
+    }
+
+    intptr_t (*slots)[N]; ///< Table of 2^log_size tuples, vacant ones start with 0
+    size_t   log_size;    ///< Log of the number of slots in the table
+    size_t   used;        ///< Number of tuples in the set
+};
+#endif
+
+//------------------------------------------------------------------------------
+
+template <size_t N, typename T, typename P>
+class vtbl_map : public vtbl_map_subjects<vtbl_map<N,T,P>,T>
+{
+private:
+
+    /// A helper data structure that is swapped during updates to 
+    /// cache parameters k and l.
+    struct cache_descriptor
+    {
+        /// Type of the stored values, which is a pair of vtbl-pointer and T value.
+        typedef stored_type_for<N,T> stored_type;
+
+        /// Cache mask to access entries. Always cache_size-1 since cache_size is a power of 2
+        /// \note We currently rely in constructors on this member be first in 
+        ///       declaration order so that it is initialized first!
+        const size_t cache_mask;
+        
+        /// Optimal shift computed based on the vtbl pointers already in the map.
+        /// Most of the time this value would be equal to #irrelevant_bits, but not
+        /// necessarily always. In case of collisions, optimal_shift will have
+        /// a value of a shift that maximizes entropy of caching vtbl pointers (which 
+        /// effectively also minimizes probability of not finding something in cache)
+        /*const*/ bit_offset_t optimal_shift[N];
+
+        /// Total number of vtbl-pointers in the cache
+        size_t used;
+
+        /// Set when a two-choice cache could not give some tuple of vtbl 
+        /// pointers one of its two entries. Such a descriptor has to be
+        /// replaced with a larger one before its next lookup.
+        bool misplaced;
+
+    #if XTL_PERFECT_HASHING
+        /// Multiplier of the perfect hash function found by vtbl_map::freeze()
+        /// or 1 when the cache uses adaptive scheme.
+        size_t multiplier;
+
+        /// Number of lower bits of the product with #multiplier to drop
+        bit_offset_t multiplier_shift;
+    #endif
+
+        /// Variable-sized array with actual pointers to stored_type
+        stored_type* cache[XTL_VARIABLE_SIZE_ARRAY];
+
+        #if defined(DBG_NEW)
+            #undef new
+        #endif
+
+        /// Descriptors start at the cache line boundary, \see vtbl_allocate()
+        void* operator new(size_t, size_t log_size)
+        {
+            return vtbl_allocate(header_size(size_t(1)<<log_size));
+        }
+
+        #if defined(DBG_NEW)
+            #define new DBG_NEW
+        #endif
+
+        /// We need to declare this placement delete operator since we overload new.
+        void operator delete(void* p, size_t) { vtbl_deallocate(p); }
+
+        /// We also provide non-placement delete operator since it doesn't really depend on extra arguments.
+        void operator delete(void* p)         { vtbl_deallocate(p); }
+
+        /// Allocates an array of n vacant cache entries starting at the cache line
+        /// boundary. With #XTL_VTBL_ARENA they also immediately follow the 
+        /// descriptor allocated before them.
+        static stored_type* new_entries(size_t n)
+        {
+            stored_type* entries = static_cast<stored_type*>(vtbl_allocate(n*sizeof(stored_type)));
+
+            for (size_t i = 0; i < n; ++i)
+                entries[i].construct();
+
+            return entries;
+        }
+
+        /// Creates new cache_descriptor based on parameters k and l of the hashing function
+        cache_descriptor(
+            const size_t       log_size,               ///< Parameter k of the cache - the log of the size of the cache
+            const bit_offset_t shift = irrelevant_bits ///< Parameter l of the cache - number of irrelevant bits on the right to remove
+        );
+
+        /// Creates new cache_descriptor based on parameters k and l of the 
+        /// hashing function as well as a reference to the cache_descriptor it
+        /// is going to replace.
+        cache_descriptor(
+            const size_t       log_size,    ///< Parameter k of the cache - the log of the size of the cache                
+            const bit_offset_t (&shifts)[N],///< Parameter l of the cache - number of irrelevant bits on the right to remove
+        #if defined(XTL_NO_RVALREF)
+            cache_descriptor&  old          ///< cache_descriptor we will supposedly replace
+        #else
+            cache_descriptor&& old          ///< cache_descriptor we will supposedly replace
+        #endif
+        #if XTL_PERFECT_HASHING
+          , const size_t       mult = 1     ///< Multiplier of the perfect hash function or 1 for adaptive scheme
+        #endif
+        );
+
+        /// Deallocates memory used for elements.
+       ~cache_descriptor();
+
+        bool    is_full() const { return used > cache_mask; } ///< Checks whether cache is full
+        size_t     size() const { return cache_mask+1; }      ///< Number of entries in cache
+        size_t     next(size_t j) const { return P::probing::next(j,cache_mask); } ///< Next entry to try in case of collision
+
+        /// Whether tuples of vtbl pointers can only be in one of two entries \see cuckoo_probing
+        typedef std::integral_constant<bool, P::probing::choices == 2> two_choice;
+
+        /// Whether entries have fingerprints compared a group at a time \see group_probing
+        typedef std::integral_constant<bool, probing_group_size<typename P::probing>::value != 0> grouped;
+
+        /// Walk of get() on a miss of the expected entry: one entry at a time,
+        /// two choices or groups of fingerprints.
+        struct group_walk {};
+        typedef typename std::conditional<grouped::value, group_walk, two_choice>::type walk;
+
+        /// Fingerprints of vacant entries and of the bytes padding the 
+        /// fingerprints of a cache smaller than a group, which are neither 
+        /// vacant nor a fingerprint of an occupied entry.
+        enum { vacant_tag = 0, padding_tag = 1 };
+
+        /// Number of bytes of fingerprints following n cache pointers: one per
+        /// entry, but at least a group, so that a small cache can load one.
+        static size_t tag_bytes(size_t n) { return grouped::value ? std::max<size_t>(n, probing_group_size<typename P::probing>::value) : 0; }
+
+        /// Number of bytes taken by a descriptor of a cache with n entries
+        static size_t header_size(size_t n) { return sizeof(cache_descriptor) + (n-XTL_VARIABLE_SIZE_ARRAY)*sizeof(stored_type*) + tag_bytes(n); }
+
+        /// Fingerprints of the entries of a #grouped cache follow the pointers
+              unsigned char* tags()       noexcept { return reinterpret_cast<      unsigned char*>(&cache[cache_mask+1]); }
+        const unsigned char* tags() const noexcept { return reinterpret_cast<const unsigned char*>(&cache[cache_mask+1]); }
+
+        /// Fingerprint of an entry for vtbl: 7 upper bits of its Fibonacci hash,
+        /// which do not take part in the cache index, with the upper bit set to
+        /// tell it from #vacant_tag and #padding_tag.
+        static unsigned char tag_of(const intptr_t (&vtbl)[N]) noexcept
+        {
+            size_t h = 0;
+
+            for (size_t i = 0; i < N; ++i)
+                h = (h ^ size_t(vtbl[i])) * size_t(0x9E3779B97F4A7C15ULL);
+
+            return static_cast<unsigned char>(0x80 | (h >> (XTL_BIT_SIZE(size_t)-7)));
+        }
+
+        /// Recomputes fingerprints of all the entries of a #grouped cache
+        void retag() noexcept
+        {
+            unsigned char* const t = tags();
+
+            for (size_t i = 0; i <= cache_mask; ++i)
+                t[i] = cache[i] && cache[i]->occupied() ? tag_of(cache[i]->vtbl) : static_cast<unsigned char>(vacant_tag);
+
+            std::fill(t+size(), t+tag_bytes(size()), static_cast<unsigned char>(padding_tag));
+        }
+
+        /// Index of the entry of vtbl, whose fingerprint is t, in a #grouped 
+        /// cache, found by walking the groups from the one of expected index j.
+        /// When vtbl is not in the cache, sets found to false and returns the 
+        /// index of the first vacant entry on the walk or size() when there is none.
+        size_t probe_groups(const intptr_t (&vtbl)[N], size_t j, unsigned char t, bool& found) const noexcept;
+
+        /// Alternative entry of a two-choice cache for given vtbl pointers
+        size_t alternate_index(const intptr_t (&vtbl)[N]) const { return P::probing::alternate(vtbl,cache_mask); }
+
+    #if XTL_VTBL_UPDATE_HISTOGRAM
+        /// Number of tuples of vtbl pointers that are not in their home entries
+        size_t displaced() const
+        {
+            size_t result = 0;
+
+            for (size_t i = 0; i <= cache_mask; ++i)
+                if (cache[i]->occupied() && cache_index(cache[i]->vtbl) != i)
+                    ++result;
+
+            return result;
+        }
+    #endif
+
+        size_t memory_used() const 
+        {
+            return header_size(cache_mask+1)                                  // Descriptor itself with pointers in cache
+                + (cache_mask+1)*sizeof(stored_type);                         // Actual cached values pointers in cache point to
+        }
+
+        /// Global function computing the key that gets hashed into cache index for given vtbl pointers and offsets
+        static inline size_t cache_key(const intptr_t vtbl[N], const bit_offset_t shifts[N])
+        {
+            intptr_t vtbl_shifted[N];
+
+            for (size_t i = 0; i < N; ++i)
+                vtbl_shifted[i] = vtbl[i] >> shifts[i];
+
+            return P::hashing::key(vtbl_shifted);
+        }
+
+        /// Global function computing cache index for a given vtbl pointers, offsets and cache mask
+        static inline size_t cache_index(const intptr_t vtbl[N], const bit_offset_t shifts[N], size_t cache_mask)
+        {
+            return cache_key(vtbl,shifts) & cache_mask;
+        }
+
+        /// Computes cache index for current optimal offsets and cache mask.
+    #if XTL_PERFECT_HASHING
+        size_t cache_index(const intptr_t vtbl[N]) const { return ((cache_key(vtbl,optimal_shift)*multiplier) >> multiplier_shift) & cache_mask; }
+    #else
+        size_t cache_index(const intptr_t vtbl[N]) const { return cache_index(vtbl,optimal_shift,cache_mask); }
+    #endif
+
+        /// Picks the initial shift of each key in a still empty cache from the
+        /// first tuple looked up, so that the first tuples do not collide only
+        /// because of the irrelevant bits of vtbl-pointers. Keys aligned as 
+        /// vtbl-pointers are \see vtbl_irrelevant_bits start with that shift, 
+        /// others (values or class ids of XTL subtyping) start with 0.
+        void calibrate_shifts(const intptr_t vtbl[N])
+        {
+            XTL_ASSERT(used == 0);
+            const size_t bits = vtbl_irrelevant_bits();
+
+            for (size_t i = 0; i < N; ++i)
+                optimal_shift[i] = bit_offset_t(vtbl[i] & ((intptr_t(1) << bits) - 1) ? 0 : bits);
+        }
+
+        /// Re-establishes invariant that vtbls can only be in the cache 
+        /// entry that correspond to their cache index, unless that entry
+        /// is already taken.
+        void put_entries_in_right_place();
+
+    #if XTL_USE_VTBL_FREQUENCY
+        /// Checks whether entry ce, which is the expected location of e, should 
+        /// rather keep its current value because it is at its own expected 
+        /// location and has been requested more often than e.
+        bool keeps(stored_type* const& ce, const stored_type* e) const { return ce->occupied() && &cache[cache_index(ce->vtbl)] == &ce && e->hits < ce->hits; }
+    #endif
+
+        /// Main function that will be used to get a reference to the stored element. 
+        /// \note With #XTL_USE_VTBL_FREQUENCY the returned entry may stay away from
+        ///       its expected location when a more frequent entry occupies it.
+        stored_type* get(const intptr_t (&vtbl)[N]) noexcept { return get(vtbl,cache_index(vtbl)); }
+
+        /// Optimization for when the cache index has already been computed.
+        /// Returns nullptr when there is no room for vtbl.
+        stored_type* get(const intptr_t (&vtbl)[N], size_t j) noexcept { return get(vtbl,j,walk()); }
+
+        /// Walks the entries in the order of the probing policy
+        stored_type* get(const intptr_t (&vtbl)[N], size_t j, std::false_type) noexcept;
+
+        /// Only looks at the expected and the alternative entries
+        stored_type* get(const intptr_t (&vtbl)[N], size_t j, std::true_type) noexcept;
+
+        /// Walks the entries a group at a time, looking only at those with 
+        /// matching fingerprints
+        stored_type* get(const intptr_t (&vtbl)[N], size_t j, group_walk) noexcept;
+
+        /// Puts vtbl, which is in neither of its two entries of a two-choice 
+        /// cache, into one of them by moving their occupants to their own 
+        /// alternative entries. Returns nullptr when the cache is full and sets
+        /// #misplaced when the displacements did not succeed.
+        stored_type* displace(const intptr_t (&vtbl)[N]) noexcept;
+
+        /// Puts occupied entry e taken from another descriptor into the empty
+        /// cache pointers of this one being constructed. Returns the entry that
+        /// was left without place.
+        stored_type* settle(stored_type* e, std::false_type) noexcept;
+        stored_type* settle(stored_type* e, std::true_type)  noexcept;
+
+        /// Computes the number of entries an existing set of vtbl-pointer tuples 
+        /// extended with the new one will occupy in cache of a given #log_size 
+        /// with given #offsets
+        size_t entries_for(const intptr_t (&vtbl)[N], size_t log_size, const bit_offset_t (&offsets)[N]) const;
+
+    private:
+
+        cache_descriptor(const cache_descriptor&);            ///< No copy constructor
+        cache_descriptor& operator=(const cache_descriptor&); ///< No assignment operator
+
+    }; // of class cache_descriptor
+
+private:
+
+    vtbl_map(const vtbl_map&);            ///< No copy constructor
+    vtbl_map& operator=(const vtbl_map&); ///< No assignment operator
+
+    /// The map keeps a reference to the number of case clauses, which update()
+    /// reads long after construction, so it cannot be a temporary
+    vtbl_map(vtbl_count_t&&) = delete;
+#if XTL_VTBL_COUNTERS
+    vtbl_map(const char*, size_t, const char*, vtbl_count_t&&) = delete;
+#endif
+
+public:
+    
+#if XTL_VTBL_COUNTERS
+    #if defined(DBG_NEW)
+        #undef new
+    #endif
+    vtbl_map(const char* fl, size_t ln, const char* fn, const vtbl_count_t& num_clauses) : 
+        descriptor(new(initial_log_size()) cache_descriptor(initial_log_size())),
+        case_clauses(num_clauses),
+        last_table_size(0),
+        collisions_before_update(P::update::collisions()),
+        prev_collisions_before_update(P::update::collisions()),
+        file(fl), 
+        line(ln),
+        func(fn),
+        updates(0), 
+        hits(0),
+        misses(0),
+        collisions(0)
+        XTL_INLINE_CACHE_ONLY(, inline_hits(0))
+        XTL_ADAPTIVE_DISPATCH_ONLY(, engine_hits(0))
+        XTL_ADAPTIVE_DISPATCH_ONLY(, engine(profiling_engine), engine_switches(0), profile_cycles(0), engine_cycles(0))
+        XTL_DEFERRED_VTBL_UPDATES_ONLY(, pending_update(false))
+        XTL_INCREMENTAL_VTBL_UPDATES_ONLY(, search())
+        XTL_VTBL_COMPACTION_ONLY(, touched(true))
+        XTL_SEALED_VTBL_MAPS_ONLY(, overflow(0), sealed(false))
+        XTL_SEPARATE_DEFAULTS_ONLY(, fallback(), defaults_in_cache(0))
+        XTL_VTBL_MAP_REGISTRY_ONLY(, node(this, &request))
+    {
+        XTL_INLINE_CACHE_ONLY(forget_inline());
+        XTL_ADAPTIVE_DISPATCH_ONLY(restart_profile());
+    }
+    #if defined(DBG_NEW)
+        #define new DBG_NEW
+    #endif
+#endif
+
+    #if defined(DBG_NEW)
+        #undef new
+    #endif
+    vtbl_map(const vtbl_count_t& num_clauses) : 
+        descriptor(new(initial_log_size()) cache_descriptor(initial_log_size())),
+        case_clauses(num_clauses),
+        last_table_size(0),
+        collisions_before_update(P::update::collisions()),
+        prev_collisions_before_update(P::update::collisions())
+        XTL_VTBL_COUNTERS_ONLY(,file("unspecified"), line(0), func("unspecified"), updates(0), hits(0), misses(0), collisions(0) XTL_INLINE_CACHE_ONLY(, inline_hits(0)) XTL_ADAPTIVE_DISPATCH_ONLY(, engine_hits(0)))
+        XTL_ADAPTIVE_DISPATCH_ONLY(, engine(profiling_engine), engine_switches(0), profile_cycles(0), engine_cycles(0))
+        XTL_DEFERRED_VTBL_UPDATES_ONLY(, pending_update(false))
+        XTL_INCREMENTAL_VTBL_UPDATES_ONLY(, search())
+        XTL_VTBL_COMPACTION_ONLY(, touched(true))
+        XTL_SEALED_VTBL_MAPS_ONLY(, overflow(0), sealed(false))
+        XTL_SEPARATE_DEFAULTS_ONLY(, fallback(), defaults_in_cache(0))
+        XTL_VTBL_MAP_REGISTRY_ONLY(, node(this, &request))
+    {
+        XTL_INLINE_CACHE_ONLY(forget_inline());
+        XTL_ADAPTIVE_DISPATCH_ONLY(restart_profile());
+    }
+    #if defined(DBG_NEW)
+        #define new DBG_NEW
+    #endif
+
+   ~vtbl_map()
+    {
+        XTL_DUMP_PERFORMANCE_ONLY(std::clog << *this << std::endl);
+    #if XTL_SEALED_VTBL_MAPS
+        delete overflow;
+        if (sealed) return; // The cache is in the segment, which is never released
+    #endif
+        delete descriptor;
+    }
+
+    size_t memory_used() const 
+    {
+        XTL_ASSERT(descriptor);
+        return sizeof(vtbl_map) + descriptor->memory_used() XTL_SEPARATE_DEFAULTS_ONLY(+ defaults.memory_used());
+    }
+
+    /// Calls f(vtbl,value) for every tuple of vtbl pointers stored in the map.
+    template <typename F>
+    void for_each(F f) const
+    {
+        XTL_ASSERT(descriptor);
+
+        for (size_t i = 0; i <= descriptor->cache_mask; ++i)
+            if (descriptor->cache[i]->occupied())
+                f(descriptor->cache[i]->vtbl, descriptor->cache[i]->value);
+
+        XTL_SEALED_VTBL_MAPS_ONLY(if (overflow) overflow->for_each(f));
+    #if XTL_SEPARATE_DEFAULTS
+        const T& value = fallback;
+        defaults.for_each([&](const intptr_t (&vtbl)[N]) { if (!this->in_cache(vtbl)) f(vtbl, value); });
+    #endif
+    }
+
+#if XTL_SEPARATE_DEFAULTS
+    /// Tells the map that value, which one of its lookups has just returned, 
+    /// is the default one: the tuple it belongs to and all tuples found to 
+    /// take it later on share one value outside of the cache, which only 
+    /// keeps entries of tuples with other values. \see #XTL_SEPARATE_DEFAULTS
+    void set_default(T& value)
+    {
+        for (size_t i = 0; i <= descriptor->cache_mask; ++i)
+            if (&descriptor->cache[i]->value == &value)
+            {
+                if (descriptor->cache[i]->occupied() && !defaults.contains(descriptor->cache[i]->vtbl))
+                {
+                    fallback = value;
+                    defaults.insert(descriptor->cache[i]->vtbl);
+                    ++defaults_in_cache; // Until purge_defaults() drops it from the cache
+                }
+
+                return;
+            }
+    }
+
+    /// Number of tuples that take the default value
+    size_t default_count() const noexcept { return defaults.size(); }
+#endif
+
+    /// Log of the number of entries in the cache
+    size_t log_size() const { return req_bits(descriptor->cache_mask); }
+
+#if XTL_VTBL_COUNTERS
+    /// Sets the site of the Match statement the map belongs to, which a 
+    /// preallocated map could not receive through its constructor.
+    /// \see #XTL_LOCATE_VTBL_MAP
+    bool locate(const char* fl, size_t ln, const char* fn) { file = fl; line = ln; func = fn; return true; }
+#endif
+
+#if XTL_VTBL_UPDATE_HISTOGRAM
+    /// Timing of the rearrangements of the cache done so far
+    const vtbl_update_histogram& update_histogram() const { return update_costs; }
+#endif
+
+    /// Shift applied to i-th vtbl pointer when computing cache index
+    bit_offset_t shift(size_t i) const { return descriptor->optimal_shift[i]; }
+
+    /// This is the main function to get the value of type T associated with
+    /// the (vtbl0,...,vtblN) of given pointers.
+    ///
+    /// \note The function returns the value "by reference" to indicate that you 
+    ///       may take address or change the value of the cell!
+    /*
+    inline T& get(intptr_t vtbl0, ...) noexcept
+    {
+        XTL_ASSERT(descriptor); // Allocated in constructor, deallocated in destructor
+
+        intptr_t vtbl[N] = {vtbl0};
+
+        va_list vl;
+        va_start(vl,vtbl0);
+
+        for (size_t i = 1; i < N; i++)
+        {
+            intptr_t vtbl_i = va_arg(vl,intptr_t);
+            XTL_ASSERT(vtbl_i); // Must be a valid vtbl pointer
+            vtbl[i] = vtbl_i;
+        }
+
+        va_end(vl);
+        return get(vtbl);
+    }
+    */
+    inline T& get(const intptr_t (&vtbl)[N]) noexcept
+    {
+        XTL_VTBL_COMPACTION_ONLY(touched = true);  // The map is in use in the current epoch
+
+    #if XTL_ADAPTIVE_DISPATCH
+        if (XTL_UNLIKELY(window))
+            observe(vtbl);  // Profiling the lookups or timing the engine chosen by them
+
+        // Compares with the tuples of a site that sees a few of them
+        for (size_t i = 0; i < engine_tuples; ++i)
+            if (array_equal(engine_vtbl[i],vtbl))
+            {
+                XTL_VTBL_COUNTERS_ONLY(++hits; ++engine_hits);
+                XTL_USE_VTBL_FREQUENCY_ONLY(++engine_entry[i]->hits);
+                XTL_VTBL_LAYOUT_ONLY(++engine_entry[i]->lookups);
+                return engine_entry[i]->value;
+            }
+
+        if (XTL_UNLIKELY(engine_tuples) && ++mispredictions > XTL_ADAPTIVE_PROFILE_LENGTH/8)
+            restart_profile(); // The site sees other tuples too often for its compares
+    #endif
+
+    #if XTL_INLINE_CACHE
+        // Straight compares with the most recently seen tuples come first
+        for (size_t i = 0; i < XTL_INLINE_CACHE_SIZE; ++i)
+            if (array_equal(inline_vtbl[i],vtbl))
+            {
+                XTL_VTBL_COUNTERS_ONLY(++hits; ++inline_hits);
+                XTL_USE_VTBL_FREQUENCY_ONLY(++inline_entry[i]->hits);
+                XTL_VTBL_LAYOUT_ONLY(++inline_entry[i]->lookups);
+                return inline_entry[i]->value;
+            }
+    #endif
+
+        size_t j = descriptor->cache_index(vtbl);  // Index of location where it should be
+        typename cache_descriptor::stored_type*& ce = descriptor->cache[j]; // Location where it should be
+
+        XTL_ASSERT(ce);   // Since we pre-allocate all entries
+
+        if (XTL_LIKELY(ce->is_for(vtbl)))
+        {
+            XTL_VTBL_COUNTERS_ONLY(++hits);
+            XTL_USE_VTBL_FREQUENCY_ONLY(++ce->hits);
+            XTL_VTBL_LAYOUT_ONLY(++ce->lookups);
+            XTL_INLINE_CACHE_ONLY(remember_inline(vtbl,ce));
+            return ce->value;
+        }
+        else
+            return get_missed_copy(vtbl,j);
+    }
+
+    /// Looks vtbl up as get() does, but with the descriptor, mask and shifts
+    /// of the cache pinned in p, which are only re-read when p has pinned
+    /// another map or some descriptor was released since \see dispatch_scope
+    T& lookup_pinned(const intptr_t (&vtbl)[N], dispatch_pin& p) noexcept
+    {
+        return lookup_pinned(vtbl, p, std::integral_constant<bool, N <= dispatch_pin::max_subjects>());
+    }
+
+    T& lookup_pinned(const intptr_t (&vtbl)[N], dispatch_pin&, std::false_type) noexcept { return get(vtbl); }
+
+    T& lookup_pinned(const intptr_t (&vtbl)[N], dispatch_pin& p, std::true_type) noexcept
+    {
+        if (XTL_UNLIKELY(p.map != this || p.epoch != vtbl_descriptor_epoch()))
+            pin(p);
+
+        XTL_VTBL_COMPACTION_ONLY(touched = true);  // The map is in use in the current epoch
+
+        const cache_descriptor* d = static_cast<const cache_descriptor*>(p.descriptor);
+    #if XTL_PERFECT_HASHING
+        size_t j = ((cache_descriptor::cache_key(vtbl,p.shift)*p.multiplier) >> p.multiplier_shift) & p.cache_mask;
+    #else
+        size_t j = cache_descriptor::cache_index(vtbl,p.shift,p.cache_mask);
+    #endif
+        typename cache_descriptor::stored_type* ce = d->cache[j];
+
+        if (XTL_LIKELY(ce->is_for(vtbl)))
+        {
+            XTL_VTBL_COUNTERS_ONLY(++hits);
+            XTL_USE_VTBL_FREQUENCY_ONLY(++ce->hits);
+            XTL_VTBL_LAYOUT_ONLY(++ce->lookups);
+            return ce->value;
+        }
+
+        return get_missed_copy(vtbl,j); // The pin is re-read next time if this released the descriptor
+    }
+
+    /// Copies the parameters of the cache into p
+    void pin(dispatch_pin& p) const noexcept
+    {
+        p.map        = this;
+        p.descriptor = descriptor;
+        p.epoch      = vtbl_descriptor_epoch();
+        p.cache_mask = descriptor->cache_mask;
+        array_copy(descriptor->optimal_shift, *reinterpret_cast<bit_offset_t (*)[N]>(&p.shift[0]));
+        XTL_PERFECT_HASHING_ONLY(p.multiplier = descriptor->multiplier; p.multiplier_shift = descriptor->multiplier_shift);
+    }
+
+    /// Hands get_missed() a copy of vtbl, whose address then is the only one 
+    /// taken, so that the array of the caller can stay in registers on hits
+    /// \see #XTL_LEAN_MATCH
+    T& get_missed_copy(const intptr_t (&vtbl)[N], size_t j) noexcept
+    {
+    #if XTL_LEAN_MATCH
+        intptr_t key[N];
+        array_copy(vtbl,key);
+        return get_missed(key,j);
+    #else
+        return get_missed(vtbl,j);
+    #endif
+    }
+
+    /// Handles a miss of get() on vtbl, whose expected location in the cache is j.
+    /// Made out-of-line under #XTL_OPTIMIZE_FOR_SIZE and #XTL_LEAN_MATCH, so that Match statements 
+    /// only inline the test for a hit. \see #XTL_COLD_PATH_BEGIN
+    XTL_COLD_PATH_BEGIN T& get_missed(const intptr_t (&vtbl)[N], size_t j) noexcept
+    {
+    #if XTL_SEPARATE_DEFAULTS
+        if (defaults.contains(vtbl))
+        {
+            XTL_VTBL_COUNTERS_ONLY(++misses);
+            return fallback;
+        }
+
+        if (XTL_UNLIKELY(defaults_in_cache != 0 XTL_SEALED_VTBL_MAPS_ONLY(&& !sealed) && (descriptor->is_full() || descriptor->cache[j]->occupied())))
+        {
+            purge_defaults();                   // The cache is pressed: make room by dropping the default tuples
+            j = descriptor->cache_index(vtbl);
+        }
+    #endif
+    #if XTL_CANONICAL_VTBLS
+        const size_t used = descriptor->used;
+        T& value = get_placed(vtbl,j);
+        return descriptor->used == used ? value : adopt_alias(vtbl,value);
+    #else
+        return get_placed(vtbl,j);
+    #endif
+    } XTL_COLD_PATH_END
+
+    /// Brings the entry of vtbl into the cache on a miss of get(), adding it
+    /// when vtbl is seen for the first time
+    inline T& get_placed(const intptr_t (&vtbl)[N], size_t j) noexcept
+    {
+    #if XTL_SEALED_VTBL_MAPS
+        if (XTL_UNLIKELY(sealed))                    // The cache cannot be written
+            return get_sealed(vtbl,j);
+    #endif
+
+        if (XTL_UNLIKELY(descriptor->used == 0)) // The first tuple looked up in the map
+        {
+            descriptor->calibrate_shifts(vtbl);
+            j = descriptor->cache_index(vtbl);
+        }
+
+    #if XTL_INCREMENTAL_VTBL_UPDATES
+        if (XTL_UNLIKELY(search.descriptor) && advance_update()) // The step of the search in progress rebuilt the cache
+            j = descriptor->cache_index(vtbl);
+    #endif
+
+        typename cache_descriptor::stored_type*& ce = descriptor->cache[j]; // Location where it should be
+
+        XTL_VTBL_COUNTERS_ONLY(++misses);
+        XTL_VTBL_COUNTERS_ONLY(if (ce->occupied()) ++collisions);
+        XTL_STATIC_PROBES_ONLY(XTL_PROBE(vtbl_miss, this, vtbl[0]));
+
+    #if XTL_PERFECT_HASHING
+        if (XTL_UNLIKELY(descriptor->multiplier != 1)) // New vtbl in the frozen map
+            return update(vtbl);                       // falls back to adaptive scheme
+    #endif
+
+        if (cache_descriptor::two_choice::value)
+        {
+            // vtbl is either in its alternative entry or gets a vacant one of the two
+            typename cache_descriptor::stored_type* res = descriptor->get(vtbl,j);
+
+            if (XTL_UNLIKELY(!res))
+                return update(vtbl);                  // displace occupants of both entries
+
+            XTL_USE_VTBL_FREQUENCY_ONLY(++res->hits);
+            XTL_VTBL_LAYOUT_ONLY(++res->lookups);
+            XTL_INLINE_CACHE_ONLY(remember_inline(vtbl,res));
+            return res->value;
+        }
+
+    #if XTL_DEFERRED_VTBL_UPDATES
+        if (XTL_UNLIKELY(descriptor->is_full()))      // No entries left for possibly new vtbl in the cache
+            return update(vtbl);                      // grow the cache right away
+
+        if (XTL_UNLIKELY(
+            ce->occupied()                            // Collision - the entry for vtbl is already occupied
+            && --collisions_before_update <= 0        // We had sufficiently many collisions to justify call
+            && descriptor->used != last_table_size))  // There was at least one vtbl added since last update
+            pending_update = true;                    // leave rearrangement to rearrange_vtbl_maps()
+    #elif XTL_INCREMENTAL_VTBL_UPDATES
+        bool start_search = false;
+
+        if (XTL_UNLIKELY(descriptor->is_full()))      // No entries left for possibly new vtbl in the cache
+        {
+            grow();                                   // double the cache with current shifts right away
+            j = descriptor->cache_index(vtbl);
+            start_search = true;
+        }
+        else
+        if (XTL_UNLIKELY(
+            ce->occupied()                            // Collision - the entry for vtbl is already occupied
+            && !search.descriptor                     // No search for better log size and shifts in progress
+            && --collisions_before_update <= 0        // We had sufficiently many collisions to justify call
+            && descriptor->used != last_table_size))  // There was at least one vtbl added since last update
+            start_search = true;
+    #else
+        if (XTL_UNLIKELY(
+            descriptor->is_full()                     // No entries left for possibly new vtbl in the cache
+            || (ce->occupied()                        // Collision - the entry for vtbl is already occupied
+            && --collisions_before_update <= 0        // We had sufficiently many collisions to justify call
+            && descriptor->used != last_table_size))) // There was at least one vtbl added since last update
+            return update(vtbl);                      // try to rearrange cache
+    #endif
+
+        // Try to find entry with our vtbl and swap it with where it is expected to be
+        typename cache_descriptor::stored_type* res = descriptor->get(vtbl,j); // This will normally bring correct pointer into ce
+        XTL_ASSERT(res && res->is_for(vtbl));
+    #if XTL_INCREMENTAL_VTBL_UPDATES
+        if (XTL_UNLIKELY(start_search))
+            begin_update(vtbl);                       // search over the next misses, entries keep their addresses
+    #endif
+        XTL_USE_VTBL_FREQUENCY_ONLY(++res->hits);
+        XTL_VTBL_LAYOUT_ONLY(++res->lookups);
+        XTL_INLINE_CACHE_ONLY(remember_inline(vtbl,res));
+        return res->value;
+    }
+
+#if XTL_CANONICAL_VTBLS
+    /// Gives value of a tuple just added to the map the value of another tuple
+    /// in it, whose vtbl pointers are aliases of those in vtbl, if any
+    /// \see #XTL_CANONICAL_VTBLS
+    T& adopt_alias(const intptr_t (&vtbl)[N], T& value) noexcept
+    {
+        for (size_t i = 0; i <= descriptor->cache_mask; ++i)
+        {
+            const typename cache_descriptor::stored_type* ce = descriptor->cache[i];
+
+            if (ce->occupied() && !ce->is_for(vtbl) && tuple_aliases(ce->vtbl,vtbl))
+            {
+                value = ce->value;
+                break;
+            }
+        }
+
+        return value;
+    }
+
+    /// Whether every vtbl pointer of one tuple is an alias of the corresponding one of the other
+    static bool tuple_aliases(const intptr_t (&vtbl1)[N], const intptr_t (&vtbl2)[N]) noexcept
+    {
+        for (size_t i = 0; i < N; ++i)
+            if (!vtbl_aliases(vtbl1[i],vtbl2[i]))
+                return false;
+
+        return true;
+    }
+#endif
+
+#if XTL_SEALED_VTBL_MAPS
+    /// Handles a miss of get() on vtbl in a sealed map without writing into its
+    /// cache. Tuples placed away from their expected location j are found along
+    /// the probing sequence, while the tuples the cache has never seen go into 
+    /// the overflow map.
+    T& get_sealed(const intptr_t (&vtbl)[N], size_t j) noexcept
+    {
+        XTL_VTBL_COUNTERS_ONLY(++misses);
+
+        if (typename cache_descriptor::stored_type* res = find_sealed(vtbl,j,typename cache_descriptor::two_choice()))
+            return res->value;
+
+        if (XTL_UNLIKELY(!overflow))
+        {
+        #if defined(DBG_NEW)
+            #undef new
+        #endif
+            overflow = new vtbl_map(case_clauses);
+        #if defined(DBG_NEW)
+            #define new DBG_NEW
+        #endif
+            XTL_VTBL_COUNTERS_ONLY(overflow->locate(file,line,func));
+        }
+
+        return overflow->get(vtbl);
+    }
+
+    /// Entry of vtbl away from its expected location j in a sealed cache, if any
+    typename cache_descriptor::stored_type* find_sealed(const intptr_t (&vtbl)[N], size_t j, std::false_type) const noexcept
+    {
+        const cache_descriptor& d = *descriptor;
+
+        if (cache_descriptor::grouped::value)
+        {
+            bool found;
+            const size_t i = d.probe_groups(vtbl,j,cache_descriptor::tag_of(vtbl),found);
+            return found ? d.cache[i] : 0;
+        }
+
+        // As in cache_descriptor::get(), the first vacant entry ends the walk
+        for (size_t i = 0; i < d.cache_mask && d.cache[j]->occupied(); ++i)
+            if (d.cache[j = d.next(j)]->is_for(vtbl))
+                return d.cache[j];
+
+        return 0;
+    }
+
+    typename cache_descriptor::stored_type* find_sealed(const intptr_t (&vtbl)[N], size_t, std::true_type) const noexcept
+    {
+        typename cache_descriptor::stored_type* const ae = descriptor->cache[descriptor->alternate_index(vtbl)];
+        return ae->is_for(vtbl) ? ae : 0;
+    }
+#endif
+
+//------------------------------------------------------------------------------
+
+    // Lookups by subjects are inherited from vtbl_map_subjects
+    using vtbl_map_subjects<vtbl_map<N,T,P>,T>::get;
+    using vtbl_map_subjects<vtbl_map<N,T,P>,T>::xtl_get;
+
+    /// Looks up values associated with dynamic types of n subjects at once and
+    /// stores pointers to them in out. The pointers remain valid for the 
+    /// lifetime of the map. Subjects are taken in groups of #XTL_BATCH_SIZE: 
+    /// the expected cache entries of the whole group are probed first in a 
+    /// loop without stores into the cache, then misses are resolved with get().
+    template <typename S>
+    void get_batch(const S* const* subjects, size_t n, T** out) noexcept
+    {
+        static_assert(N == 1, "Batch lookups are only supported for maps on a single subject");
+
+        intptr_t vtbl[XTL_BATCH_SIZE][1];
+
+        for (size_t i = 0; i < n; i += XTL_BATCH_SIZE, subjects += XTL_BATCH_SIZE, out += XTL_BATCH_SIZE)
+        {
+            const size_t m = std::min(n-i, size_t(XTL_BATCH_SIZE));
+            const cache_descriptor& d = *descriptor; // Can only change while resolving misses below
+
+            for (size_t j = 0; j < m; ++j)
+                vtbl[j][0] = vtbl_of(subjects[j]);
+
+            for (size_t j = 0; j < m; ++j)
+            {
+                typename cache_descriptor::stored_type* ce = d.cache[d.cache_index(vtbl[j])];
+                out[j] = ce->vtbl[0] == vtbl[j][0] ? &ce->value : 0;
+                XTL_VTBL_LAYOUT_ONLY(if (out[j]) ++ce->lookups);
+            }
+
+            for (size_t j = 0; j < m; ++j)
+                if (XTL_UNLIKELY(!out[j]))
+                    out[j] = &get(vtbl[j]);
+                XTL_VTBL_COUNTERS_ONLY(else ++hits);
+        }
+    }
+
+    /// Issues a prefetch for the expected cache entry of vtbl. It only needs 
+    /// the vtbl pointers, not the entry, to compute its location.
+    void prefetch(const intptr_t (&vtbl)[N]) const noexcept
+    {
+        const cache_descriptor& d = *descriptor;
+        XTL_PREFETCH(d.cache[d.cache_index(vtbl)]);
+    }
+
+    /// Issues prefetches for subjects beyond the #XTL_BATCH_SIZE of n subjects
+    /// that get_batch() is about to look up: the expected cache entries of the
+    /// next batch, whose objects the previous call prefetched, and the objects
+    /// of the batch after it.
+    template <typename S>
+    void prefetch_batch(const S* const* subjects, size_t n) const noexcept
+    {
+        static_assert(N == 1, "Batch lookups are only supported for maps on a single subject");
+
+        for (size_t j = XTL_BATCH_SIZE; j < n && j < 2*XTL_BATCH_SIZE; ++j)
+        {
+            const intptr_t vtbl[1] = {vtbl_of(subjects[j])};
+            prefetch(vtbl);
+        }
+
+        for (size_t j = 2*XTL_BATCH_SIZE; j < n && j < 3*XTL_BATCH_SIZE; ++j)
+            XTL_PREFETCH(subjects[j]);
+    }
+
+    /// A function that gets called when the cache is either too inefficient or full.
+    T& update(const intptr_t (&vtbl)[N]);
+
+#if XTL_INCREMENTAL_VTBL_UPDATES
+    /// Starts the search update() would do for the tuples in the cache, one of
+    /// which is vtbl, leaving its candidates to advance_update().
+    /// \see #XTL_INCREMENTAL_VTBL_UPDATES
+    void begin_update(const intptr_t (&vtbl)[N]);
+
+    /// Tries the next candidate log size and shifts of the search in progress.
+    /// \returns Whether the search is over and the cache was rebuilt.
+    bool advance_update();
+
+    /// Ends the search in progress, rebuilding the cache with the best log 
+    /// size and shifts it found, when they differ from the current ones.
+    /// \returns Whether the cache was rebuilt.
+    bool finish_update();
+#endif
+
+    /// Gets entry for vtbl from descriptor that was given enough room for it.
+    /// Two-choice caches may still have to displace entries or grow for it.
+    typename cache_descriptor::stored_type* place(const intptr_t (&vtbl)[N]) { return place(vtbl,typename cache_descriptor::two_choice()); }
+    typename cache_descriptor::stored_type* place(const intptr_t (&vtbl)[N], std::false_type);
+    typename cache_descriptor::stored_type* place(const intptr_t (&vtbl)[N], std::true_type);
+
+    /// Replaces descriptor with the one twice as large with the same shifts
+    void grow();
+
+#if XTL_SEPARATE_DEFAULTS
+    /// Whether vtbl has an entry in the cache
+    bool in_cache(const intptr_t (&vtbl)[N]) const noexcept
+    {
+        for (size_t i = 0; i <= descriptor->cache_mask; ++i)
+            if (descriptor->cache[i]->is_for(vtbl))
+                return true;
+
+        return false;
+    }
+
+    /// Rebuilds the cache of the same size without the entries of tuples that 
+    /// take the default value
+    /// \note Invalidates references previously returned by get().
+    void purge_defaults();
+#endif
+
+#if XTL_PERFECT_HASHING
+    /// Rearranges the cache so that every tuple of vtbl pointers already in 
+    /// the map gets its own entry and thus lookups of them never collide. 
+    /// A tuple seen for the first time afterwards reverts the map to the 
+    /// adaptive scheme.
+    /// \returns Whether a collision-free arrangement was found.
+    bool freeze();
+#endif
+
+#if XTL_VTBL_COMPACTION
+    /// Ends the current epoch of the map. When release is set, also rebuilds
+    /// the cache: a map that has not been used during the epoch loses all 
+    /// its entries, while a map whose cache is less than a quarter occupied 
+    /// moves them into a smaller cache.
+    /// \note Invalidates references previously returned by get().
+    /// \returns The number of bytes released.
+    size_t compact(bool release = true);
+#endif
+
+#if XTL_VTBL_INVALIDATION
+    /// Drops the entries of tuples with any vtbl pointer in range by moving 
+    /// the remaining ones into a cache of the same size and shifts. Maps 
+    /// without such entries are left as they are. \see invalidate_vtbl_range()
+    /// \note Invalidates references previously returned by get().
+    /// \returns The number of entries dropped.
+    size_t invalidate(const vtbl_range& range);
+#endif
+
+#if XTL_SEALED_VTBL_MAPS
+    /// Number of bytes seal() takes from the segment, which is 0 for maps that
+    /// are sealed or have not seen any tuples yet.
+    size_t seal_size() const
+    {
+        return sealed || descriptor->used == 0 ? 0 :
+            vtbl_seal_segment::piece(cache_descriptor::header_size(descriptor->cache_mask+1))
+          + vtbl_seal_segment::piece((descriptor->cache_mask+1)*sizeof(typename cache_descriptor::stored_type));
+    }
+
+    /// Moves the cache into the segment, after which lookups never write into
+    /// it again and the map is not rearranged, frozen or compacted anymore. 
+    /// \see seal_vtbl_maps()
+    /// \note Invalidates references previously returned by get().
+    /// \returns Whether the map was sealed by this call.
+    bool seal(vtbl_seal_segment& segment);
+
+    /// Whether the cache is in the read-only segment \see seal()
+    bool is_sealed() const { return sealed; }
+#endif
+
+#if XTL_DEFERRED_VTBL_UPDATES
+    /// Does the rearrangement of the cache that lookups asked for since the
+    /// previous call, if any. \see rearrange_vtbl_maps()
+    /// \returns Whether the cache was rearranged.
+    bool rearrange();
+#endif
+
+#if XTL_DUMP_PERFORMANCE
+    std::ostream& operator>>(std::ostream& os) const;
+    friend std::ostream& operator<<(std::ostream& os, const vtbl_map& m) { return m >> os; }
+#endif
+
+private:
+
+    /// Cached mappings of vtbl to some indecies
+    cache_descriptor* descriptor;
+
+    /// A reference to a global variable that will be initialized with the 
+    /// number of case clauses of a given match statement
+    const vtbl_count_t& case_clauses;
+
+    /// Memoized table.size() during last cache rearranging
+    size_t last_table_size;
+
+    /// Number of colisions that we will still tolerate before next update
+    int collisions_before_update;
+
+    /// Previous number of colisions that we will still tolerate before next update
+    int prev_collisions_before_update;
+
+#if XTL_VTBL_COUNTERS
+    const char* file;      ///< File in which this vtblmap_of is instantiated
+    size_t      line;      ///< Line in the file where it is instantiated
+    const char* func;      ///< Function in which this vtblmap_of is instantiated
+    size_t      updates;   ///< Amount of reconfigurations performed at run time
+    size_t      hits;      ///< The number of cache hits
+    size_t      misses;    ///< The number of cache misses
+    size_t      collisions;///< Out of all the misses, how many were actual collisions
+#if XTL_INLINE_CACHE
+    size_t      inline_hits;///< Out of all the hits, how many were found in the inline cache
+#endif
+#if XTL_ADAPTIVE_DISPATCH
+    size_t      engine_hits;///< Out of all the hits, how many were served by compares of the engine
+#endif
+#endif
+
+#if XTL_INLINE_CACHE
+    /// Tuples of vtbl pointers most recently looked up in the cache, the most 
+    /// recent first, with all 0 in slots not taken yet \see #XTL_INLINE_CACHE_SIZE
+    intptr_t inline_vtbl[XTL_INLINE_CACHE_SIZE][N];
+
+    /// Cache entries of the tuples in #inline_vtbl. Entries only get a tuple 
+    /// once and are only released by compact(), so they are not checked again.
+    typename cache_descriptor::stored_type* inline_entry[XTL_INLINE_CACHE_SIZE];
+
+    /// Puts vtbl found in entry e in front of the inline cache, dropping the 
+    /// least recently used tuple
+    void remember_inline(const intptr_t (&vtbl)[N], typename cache_descriptor::stored_type* e) noexcept
+    {
+        for (size_t i = XTL_INLINE_CACHE_SIZE-1; i > 0; --i)
+        {
+            array_copy(inline_vtbl[i-1],inline_vtbl[i]);
+            inline_entry[i] = inline_entry[i-1];
+        }
+
+        array_copy(vtbl,inline_vtbl[0]);
+        inline_entry[0] = e;
+    }
+
+    /// Empties the inline cache
+    void forget_inline() noexcept
+    {
+        std::memset(inline_vtbl, 0, sizeof(inline_vtbl));
+        std::memset(inline_entry,0, sizeof(inline_entry));
+    }
+#endif
+
+#if XTL_ADAPTIVE_DISPATCH
+    /// Most tuples of vtbl pointers served by compares. A single vtbl pointer
+    /// is hashed with a shift and a mask, which is not worth more than 2.
+    enum { adaptive_tuples = N > 1 ? 4 : 2 };
+
+    dispatch_engine    engine;          ///< Engine serving the lookups \see #XTL_ADAPTIVE_DISPATCH
+    size_t             engine_switches; ///< Times the map started serving lookups with another engine
+    unsigned long long profile_cycles;  ///< Cycles of the timed_intervals() of the last profile
+    unsigned long long engine_cycles;   ///< Cycles of as many intervals with the engine chosen by it
+    unsigned long long window_start;    ///< Cycle counter at the first timed lookup of the window
+    size_t             window;          ///< Lookups left to profile or time, 0 when neither is done
+    size_t             profiled;        ///< Distinct tuples seen by the current profile, adaptive_tuples+1 for more
+    size_t             mispredictions;  ///< Lookups that were not in #engine_vtbl since the engine was chosen
+    size_t             engine_tuples;   ///< Tuples in #engine_vtbl compared before the hash, 0 for the hash alone
+
+    /// Tuples of vtbl pointers seen by the profile and then compared with
+    intptr_t engine_vtbl[adaptive_tuples][N];
+
+    /// Cache entries of the first #engine_tuples tuples of #engine_vtbl
+    typename cache_descriptor::stored_type* engine_entry[adaptive_tuples];
+
+    /// Number of intervals between lookups that are timed at the end of each
+    /// window, which leaves out the misses of the types seen first
+    static size_t timed_intervals() noexcept { return XTL_ADAPTIVE_PROFILE_LENGTH/2 - 1; }
+
+    /// Makes the hash serve the next lookups while they are profiled
+    void restart_profile() noexcept
+    {
+        if (engine != profiling_engine)
+            ++engine_switches;
+
+        engine         = profiling_engine;
+        engine_tuples  = 0;
+        engine_cycles  = 0;
+        profiled       = 0;
+        mispredictions = 0;
+        window         = XTL_ADAPTIVE_PROFILE_LENGTH;
+    }
+
+    /// Accounts for the lookup of vtbl in the current profile or timing 
+    /// window and acts on the window once it is over
+    void observe(const intptr_t (&vtbl)[N]) noexcept
+    {
+        if (window == XTL_ADAPTIVE_PROFILE_LENGTH/2)
+            window_start = XTL_CYCLE_COUNTER();
+
+        if (engine == profiling_engine && profiled <= adaptive_tuples)
+        {
+            size_t i = 0;
+
+            while (i < profiled && !array_equal(engine_vtbl[i],vtbl))
+                ++i;
+
+            if (i == profiled)
+            {
+                if (i < adaptive_tuples)
+                    array_copy(vtbl,engine_vtbl[i]);
+
+                ++profiled;
+            }
+        }
+
+        if (--window == 0)
+        {
+            unsigned long long cycles = XTL_CYCLE_COUNTER() - window_start;
+
+            if (engine == profiling_engine)
+            {
+                profile_cycles = cycles;
+                choose_engine();
+            }
+            else
+            {
+                engine_cycles = cycles;
+
+                if (engine_cycles > profile_cycles + profile_cycles/4)
+                    use_hash(); // Compares turned out slower than the hash
+            }
+        }
+    }
+
+    /// Picks the engine for the tuples seen by the profile. Since the map is 
+    /// not in the middle of a lookup here, this is a safe point to switch.
+    void choose_engine() noexcept
+    {
+        if (profiled <= adaptive_tuples)
+        {
+            for (engine_tuples = 0; engine_tuples < profiled; ++engine_tuples)
+            {
+                typename cache_descriptor::stored_type* e = descriptor->cache[descriptor->cache_index(engine_vtbl[engine_tuples])];
+
+                if (!e->is_for(engine_vtbl[engine_tuples]))
+                    break;  // Not in its home entry, e.g. not added yet
+
+                engine_entry[engine_tuples] = e;
+            }
+
+            if (engine_tuples == profiled)
+            {
+                engine = profiled == 1 ? monomorphic_engine : polymorphic_engine;
+                ++engine_switches;
+                window = XTL_ADAPTIVE_PROFILE_LENGTH; // Time the engine next
+                return;
+            }
+        }
+
+        use_hash();
+    }
+
+    /// Makes the hash alone serve the lookups
+    void use_hash() noexcept
+    {
+        ++engine_switches;
+        engine        = hashing_engine;
+        engine_tuples = 0;
+        window        = 0;
+    }
+#endif
+
+#if XTL_VTBL_UPDATE_HISTOGRAM
+    vtbl_update_histogram update_costs; ///< Timing of the calls to update()
+#endif
+
+#if XTL_DEFERRED_VTBL_UPDATES
+    /// Whether lookups had enough collisions to ask for a rearrangement
+    bool pending_update;
+#endif
+
+#if XTL_INCREMENTAL_VTBL_UPDATES
+    /// Progress of the search for new log size and shifts of the cache that 
+    /// update() does at once, while here it is spread over subsequent misses
+    struct update_search
+    {
+        const cache_descriptor* descriptor; ///< Cache the search is for, 0 when there is no search in progress
+        intptr_t     vtbl[N]; ///< One of the tuples in the cache, for which entries_for() is asked
+        bit_offset_t l2;      ///< Upper bound for log size iteration
+        bit_offset_t i;       ///< Log size being tried
+        size_t       s;       ///< Argument position whose shifts are being tried
+        bit_offset_t t;       ///< Next shift of argument position s to try
+        bit_offset_t no;      ///< Best log size so far
+        bit_offset_t zo[N];   ///< Best shifts so far
+        bit_offset_t m[N];    ///< Highest bits in which vtbls differ
+        bit_offset_t z[N];    ///< Lowest bits in which vtbls do not differ
+        size_t       best;    ///< Number of entries used with log size no and shifts zo
+    } search;
+#endif
+
+#if XTL_VTBL_COMPACTION
+    /// Whether the map has been used since the beginning of the current epoch
+    bool touched;
+#endif
+
+#if XTL_SEALED_VTBL_MAPS
+    /// Process-local map of tuples seen for the first time after sealing. It
+    /// is registered on its own and thus reports its memory use separately.
+    vtbl_map* overflow;
+
+    /// Whether the cache is in the read-only segment \see seal()
+    bool sealed;
+#endif
+
+#if XTL_SEPARATE_DEFAULTS
+    /// Value shared by the tuples in defaults \see set_default()
+    T fallback;
+
+    /// Tuples that take the default value
+    vtbl_tuple_set<N> defaults;
+
+    /// Number of tuples in defaults that still have an entry in the cache
+    size_t defaults_in_cache;
+#endif
+
+#if XTL_VTBL_LAYOUT
+    /// Copies the layout of the cache into l \see write_vtbl_layouts()
+    void layout(vtbl_site_layout& l) const;
+
+    /// Number of steps of the probing sequence from entry home to entry slot
+    /// or the number of entries when slot is not on the sequence
+    size_t probes(size_t home, size_t slot) const
+    {
+        if (cache_descriptor::two_choice::value)
+            return slot != home; // The alternative entry is the only other one
+
+        size_t n = 0;
+
+        for (size_t j = home; j != slot && n <= descriptor->cache_mask; j = descriptor->next(j))
+            ++n;
+
+        return n;
+    }
+#endif
+
+#if XTL_VTBL_MAP_REGISTRY
+    /// Type-erased handling of requests sent to all maps through vtbl_map_node
+    static size_t request(void* m, vtbl_map_request r, void* arg)
+    {
+        vtbl_map& map = *static_cast<vtbl_map*>(m);
+        XTL_UNUSED(arg);
+
+    #if XTL_SEALED_VTBL_MAPS
+        if (map.sealed && r != memory_request && r != statistics_request)
+            return 0; // A sealed cache is never rebuilt
+    #endif
+
+        switch (r)
+        {
+        case memory_request:  return map.memory_used();
+    #if XTL_VTBL_STATISTICS
+        case statistics_request:
+            {
+                vtbl_site_statistics& s = *static_cast<vtbl_site_statistics*>(arg);
+                s.file       = map.file;
+                s.line       = map.line;
+                s.func       = map.func;
+                s.subjects   = N;
+                s.log_size   = map.log_size();
+                s.entries    = map.descriptor->used;
+                s.memory     = map.memory_used();
+                s.hits       = map.hits;
+                s.misses     = map.misses;
+                s.collisions = map.collisions;
+                s.updates    = map.updates;
+                s.inline_hits = XTL_IF(XTL_INLINE_CACHE, map.inline_hits, 0);
+            #if XTL_ADAPTIVE_DISPATCH
+                s.engine          = dispatch_engine_name(map.engine);
+                s.engine_hits     = map.engine_hits;
+                s.engine_switches = map.engine_switches;
+                s.profile_cycles  = double(map.profile_cycles) / double(map.timed_intervals());
+                s.engine_cycles   = double(map.engine_cycles)  / double(map.timed_intervals());
+            #else
+                s.engine          = dispatch_engine_name(hashing_engine);
+                s.engine_hits     = 0;
+                s.engine_switches = 0;
+                s.profile_cycles  = 0;
+                s.engine_cycles   = 0;
+            #endif
+                XTL_VTBL_UPDATE_HISTOGRAM_ONLY(s.update_costs = map.update_costs);
+                return 1;
+            }
+    #endif
+    #if XTL_VTBL_LAYOUT
+        case layout_request:
+            {
+                vtbl_site_layout& l = *static_cast<vtbl_site_layout*>(arg);
+                request(m, statistics_request, &l.statistics);
+                map.layout(l);
+                return 1;
+            }
+    #endif
+    #if XTL_PERFECT_HASHING
+        case freeze_request:  return map.freeze();
+    #endif
+    #if XTL_VTBL_COMPACTION
+        case age_request:     return map.compact(false);
+        case compact_request: return map.compact(true);
+    #endif
+    #if XTL_DEFERRED_VTBL_UPDATES
+        case rearrange_request: return map.rearrange();
+    #endif
+    #if XTL_VTBL_INVALIDATION
+        case invalidate_request: return map.invalidate(*static_cast<const vtbl_range*>(arg));
+    #endif
+    #if XTL_SEALED_VTBL_MAPS
+        case seal_size_request: return map.seal_size();
+        case seal_request:      return map.seal(*static_cast<vtbl_seal_segment*>(arg));
+    #endif
+        default:              return 0;
+        }
+    }
+
+    /// Registration of this map in the list of all maps. 
+    /// \note Has to be declared last as it is initialized with this.
+    vtbl_map_node node;
+#endif
+
+};
+
+//------------------------------------------------------------------------------
+
+
+template <size_t N, typename T, typename P>
+vtbl_map<N,T,P>::cache_descriptor::cache_descriptor(
+    const size_t       log_size, ///< Parameter k of the cache - the log of the size of the cache
+    const bit_offset_t shift     ///< Parameter l of the cache - number of irrelevant bits on the right to remove
+) :
+    cache_mask( (1<<log_size) - 1 ),
+    //optimal_shift(shift),
+    used(0),
+    misplaced(false)
+    XTL_PERFECT_HASHING_ONLY(, multiplier(1), multiplier_shift(0))
+{
+    // Initialize all optimal_shift values with the same value
+    std::fill(&optimal_shift[0],&optimal_shift[N],shift);
+
+    // Allocate all cache entries in one chunk for better cache performance.
+    // Only allocate the difference from need and already present in old ones
+    stored_type* cache_entries = new_entries(1<<log_size);
+
+    // Initialize pointers from cache to newly allocated cache entries
+    // NOTE: We allocate them in the order of LCG traversal to improve
+    //       cache locality in the use of cache_entries later.
+    for (size_t i = 0, j = 0; i <= cache_mask; ++i)
+    {
+        cache[j] = &cache_entries[i];
+        j++; //j = lcg_next(j);
+    }
+
+    if (grouped::value)
+        retag();
+}
+
+//------------------------------------------------------------------------------
+
+template <size_t N, typename T, typename P>
+vtbl_map<N,T,P>::cache_descriptor::cache_descriptor(
+    const size_t       log_size,    ///< Parameter k of the cache - the log of the size of the cache                
+    const bit_offset_t (&shifts)[N],///< Parameter l of the cache - number of irrelevant bits on the right to remove
+#if defined(XTL_NO_RVALREF)
+    cache_descriptor&  old          ///< cache_descriptor we will supposedly replace
+#else
+    cache_descriptor&& old          ///< cache_descriptor we will supposedly replace
+#endif
+#if XTL_PERFECT_HASHING
+  , const size_t       mult         ///< Multiplier of the perfect hash function or 1 for adaptive scheme
+#endif
+) :
+    cache_mask( (1<<log_size) - 1 ),
+    used(old.used),
+    misplaced(false)
+    XTL_PERFECT_HASHING_ONLY(, multiplier(mult), multiplier_shift(mult == 1 ? 0 : XTL_BIT_SIZE(size_t)-log_size))
+{
+    XTL_ASSERT(cache_mask >= old.cache_mask); // Since we are going to inherit all its existing elements
+
+    array_copy(shifts,optimal_shift);         // Initialize optimal shifts
+
+    // We'll be initializing cache pointers out of order for performance reasons
+    // so zero them out first to see which ones we have alredy initialized
+    for (size_t i = 0; i <= cache_mask; ++i) cache[i] = 0;
+
+#if XTL_USE_VTBL_FREQUENCY
+    // Place more frequently requested entries first so that they get their 
+    // expected locations, while rarer ones get pushed along the LCG walk.
+    std::stable_sort(
+        &old.cache[0], 
+        &old.cache[old.cache_mask+1],
+        [](const stored_type* a, const stored_type* b) { return a->hits > b->hits; }
+    );
+#endif
+
+    // Initialize first cache pointers to occupied cache entries in the old cache
+    for (size_t i = 0; i <= old.cache_mask; ++i)
+    {
+        XTL_ASSERT(old.cache[i]); // Since we pre-allocate them
+
+        if (old.cache[i]->occupied())
+        {
+            XTL_USE_VTBL_FREQUENCY_ONLY(old.cache[i]->hits /= 2); // Let older requests fade out
+            old.cache[i] = settle(old.cache[i],two_choice()); // Entry left without place stays for the loop below
+        }
+    }
+
+    size_t j = 0;
+
+    // Now copy the rest of allocated but vacant entries
+    for (size_t i = 0; i <= old.cache_mask; ++i)
+    {
+        if (old.cache[i])
+        {
+            XTL_ASSERT(old.cache[i]->vacant() || two_choice::value);
+
+            if (old.cache[i]->occupied())
+                misplaced = true; // Only when displacements in two-choice cache did not succeed
+
+            // Skip initialized entries if needed
+            while (cache[j])
+            {
+                j++; //j = lcg_next(j);
+                XTL_ASSERT(j <= cache_mask);
+            }
+
+            std::swap(old.cache[i],cache[j]);
+        }
+    }
+
+    if (cache_mask - old.cache_mask)
+    {
+        // Allocate all cache entries in one chunk for better cache performance.
+        // Only allocate the difference from need and already present in old ones
+        stored_type* cache_entries = new_entries(cache_mask - old.cache_mask);
+
+        // Initialize remaining pointers from cache to newly allocated cache entries
+        // NOTE: We allocate them in the order of LCG traversal to improve
+        //       cache locality in the use of cache_entries later.
+        for (size_t i = 0; i < cache_mask-old.cache_mask; ++i)
+        {
+            // Skip initialized entries if needed
+            while (cache[j])
+            {
+                j++; //j = lcg_next(j);
+                XTL_ASSERT(j <= cache_mask);
+            }
+
+            cache[j] = &cache_entries[i];
+        }
+    }
+
+    if (grouped::value)
+        retag(); // Entries were settled without their fingerprints
+}
+
+//------------------------------------------------------------------------------
+
+template <size_t N, typename T, typename P>
+vtbl_map<N,T,P>::cache_descriptor::~cache_descriptor()
+{
+    ++vtbl_descriptor_epoch(); // Pins of it are no longer valid
+
+    // The elements will be pointing into separate arrays, we want to
+    // find all the beginnings of arrays to deallocate them
+    std::sort(&cache[0], &cache[cache_mask+1]);
+
+    for (size_t i = 0; i <= cache_mask;)
+    {
+        if (cache[i]) // We check because subsequent descriptor could have moved out entries from this one
+        {
+            size_t j = i+1;
+            for (; j <= cache_mask && intptr_t(cache[j])-intptr_t(cache[j-1]) == sizeof(stored_type); ++j);
+            for (size_t k = i; k < j; ++k) cache[k]->destroy();
+            vtbl_deallocate(cache[i]);
+            i = j;
+        }
+        else
+            ++i;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+template <size_t N, typename T, typename P>
+void vtbl_map<N,T,P>::cache_descriptor::put_entries_in_right_place()
+{
+    for (size_t i = 0; i <= cache_mask; ++i)
+    {
+        if (cache[i]->occupied()) // There is a valid tuple of vtbl pointers in the entry
+        {
+            XTL_ASSERT(cache[i]->vtbl[N-1] || XTL_VALUE_SUBJECT_DISPATCH); // Either all 0 or all non 0, unless values end the key
+
+            size_t q = cache_index(cache[i]->vtbl); // Index of location where it should be (equivalence class)
+
+            if (i == q) break;                      // The entity is in the right place
+
+            size_t j = q;                           // Current position to try placing in
+
+            for (size_t j = q; cache[i]->occupied(); j = next(j))
+                std::swap(cache[i],cache[j]);
+
+            while (cache[j]->occupied())
+            {
+                size_t k = cache_index(cache[j]->vtbl);
+
+                if (k == j || // the entry is occupied by the right entity
+                    k == q)   // or by another entity in the same equivalence class
+                    j = next(j); // get next cache entry to try
+                else
+                    break;
+
+                if (j == i)   // this is an entry in the equivalence class
+                    goto next;// break out of both loops
+            }
+
+            // entry in j is neither in its rightful place, not an entry from equivalence class q
+            std::swap(cache[i],cache[j]); // swap current to where it should be and continue looking at current
+        }
+next:   ;
+    }
+
+    if (grouped::value)
+        retag();
+}
+
+//------------------------------------------------------------------------------
+
+template <size_t N, typename T, typename P>
+auto vtbl_map<N,T,P>::cache_descriptor::get(const intptr_t (&vtbl)[N], size_t j, std::false_type) noexcept -> stored_type*
+{
+    XTL_ASSERT(j == cache_index(vtbl)); // j must be index of location where vtbl should be
+    stored_type*& ce = cache[j]; // Location where it should be
+
+    XTL_ASSERT(ce);   // Since we pre-allocate all entries
+
+    // Precompute hash of the vtbl array for faster comparisons.
+    XTL_VTBL_HASHING(const intptr_t vtbl_hash = get_hash(vtbl);)
+
+    // See if (vtbl0,...,vtblN) is elsewhere in the cache
+    // Start from j (to account if it is already there) and walk all entries
+    // in the order of the probing policy. We are guaranteed to hit each entry 
+    // only once. Since entries are never removed, the first vacant entry on
+    // the walk means the combination is not in the cache.
+    for (size_t i = 0; i <= cache_mask; ++i)
+    {
+        if (XTL_UNLIKELY(cache[j]->vacant())) // we found an empty slot
+        {
+            XTL_ASSERT(cache[j]->vtbl[N-1] == 0); // Either all 0 or all non 0
+            *cache[j] = vtbl; //array_copy(vtbl,cache[i]->vtbl);
+            ++used;
+            XTL_USE_VTBL_FREQUENCY_ONLY(if (keeps(ce,cache[j])) return cache[j]);
+            std::swap(ce,cache[j]); // swap it with the right position
+            return ce;
+        }
+        else
+        if (XTL_UNLIKELY(cache[j]->is_for(vtbl XTL_VTBL_HASHING(,vtbl_hash)))) // if so ...
+        {
+            XTL_USE_VTBL_FREQUENCY_ONLY(if (keeps(ce,cache[j])) return cache[j]);
+            std::swap(ce,cache[j]); // swap it with the right position
+            return ce;
+        }
+
+        j = next(j);
+    }
+
+    // There are no empty slots, we return nullptr to indicate this
+    XTL_ASSERT(is_full());
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+template <size_t N, typename T, typename P>
+size_t vtbl_map<N,T,P>::cache_descriptor::probe_groups(const intptr_t (&vtbl)[N], size_t j, unsigned char t, bool& found) const noexcept
+{
+    const size_t         g     = probing_group_size<typename P::probing>::value;
+    const unsigned char* tg    = tags();
+    const size_t         first = j & ~(g-1);                  // Group containing the expected entry
+    const uint32_t       from  = ~uint32_t(0) << (j - first); // Its entries starting from the expected one
+
+    // Fingerprints of all the entries of a group are compared, while only its
+    // vacant entries that are on the walk from j end the walk. A cache smaller
+    // than a group has a single group padded with #padding_tag.
+    for (size_t k = 0, s = first; k <= cache_mask; k += g, s = (s+g) & cache_mask)
+    {
+        for (uint32_t m = group_matches(tg+s,t); m; m &= m-1)
+        {
+            const size_t i = s + trailing_zeros(m);
+
+            if (cache[i]->is_for(vtbl))
+                return found = true, i;
+        }
+
+        if (const uint32_t m = group_matches(tg+s,vacant_tag) & (k ? ~uint32_t(0) : from))
+            return found = false, s + trailing_zeros(m);
+    }
+
+    // The walk ends with the entries of the first group preceding j
+    const uint32_t m = group_matches(tg+first,vacant_tag) & ~from;
+    found = false;
+    return m ? first + trailing_zeros(m) : size();
+}
+
+//------------------------------------------------------------------------------
+
+template <size_t N, typename T, typename P>
+auto vtbl_map<N,T,P>::cache_descriptor::get(const intptr_t (&vtbl)[N], size_t j, group_walk) noexcept -> stored_type*
+{
+    XTL_ASSERT(j == cache_index(vtbl)); // j must be index of location where vtbl should be
+    stored_type*&        ce = cache[j]; // Location where it should be
+    unsigned char* const tg = tags();
+    const unsigned char  t  = tag_of(vtbl);
+    bool found;
+    const size_t i = probe_groups(vtbl,j,t,found);
+
+    if (XTL_UNLIKELY(i > cache_mask))
+    {
+        // There are no empty slots, we return nullptr to indicate this
+        XTL_ASSERT(is_full());
+        return 0;
+    }
+
+    if (!found) // i is the first vacant entry on the walk
+    {
+        XTL_ASSERT(cache[i]->vtbl[N-1] == 0); // Either all 0 or all non 0
+        *cache[i] = vtbl;
+        tg[i] = t;
+        ++used;
+    }
+
+    XTL_USE_VTBL_FREQUENCY_ONLY(if (keeps(ce,cache[i])) return cache[i]);
+    std::swap(ce,cache[i]); // swap it with the right position
+    std::swap(tg[j],tg[i]); // along with its fingerprint
+    return ce;
+}
+
+//------------------------------------------------------------------------------
+
+template <size_t N, typename T, typename P>
+auto vtbl_map<N,T,P>::cache_descriptor::get(const intptr_t (&vtbl)[N], size_t j, std::true_type) noexcept -> stored_type*
+{
+    XTL_ASSERT(j == cache_index(vtbl)); // j must be index of location where vtbl should be
+    XTL_ASSERT(!misplaced);             // Such descriptor is replaced before any lookup
+
+    // Precompute hash of the vtbl array for faster comparisons.
+    XTL_VTBL_HASHING(const intptr_t vtbl_hash = get_hash(vtbl);)
+
+    stored_type* const ce = cache[j];                      // Expected entry
+    stored_type* const ae = cache[alternate_index(vtbl)];  // Alternative entry
+
+    if (XTL_LIKELY(ce->is_for(vtbl XTL_VTBL_HASHING(,vtbl_hash)))) return ce;
+    if (XTL_LIKELY(ae->is_for(vtbl XTL_VTBL_HASHING(,vtbl_hash)))) return ae;
+
+    // vtbl is not in the cache since it can't be anywhere else
+    stored_type* const e = ce->vacant() ? ce : ae->vacant() ? ae : 0;
+
+    if (e)
+    {
+        *e = vtbl;
+        ++used;
+    }
+
+    return e; // nullptr when both entries are taken
+}
+
+//------------------------------------------------------------------------------
+
+template <size_t N, typename T, typename P>
+auto vtbl_map<N,T,P>::cache_descriptor::displace(const intptr_t (&vtbl)[N]) noexcept -> stored_type*
+{
+    XTL_ASSERT(two_choice::value);
+
+    size_t v = 0;
+
+    // Take any vacant entry
+    while (v <= cache_mask && cache[v]->occupied()) ++v;
+
+    if (v > cache_mask)
+        return 0; // The cache is full
+
+    stored_type* const res = cache[v];
+    *res = vtbl;
+    ++used;
+    cache[v] = 0; // Slot v becomes empty until the end of displacement
+
+    stored_type* e = settle(res,two_choice());
+
+    if (e && e->occupied())
+        misplaced = true; // The displaced entry left without place waits in slot v for a larger cache
+
+    if (e)
+        cache[v] = e;     // Otherwise the displacement ended in slot v
+
+    return res;
+}
+
+//------------------------------------------------------------------------------
+
+template <size_t N, typename T, typename P>
+auto vtbl_map<N,T,P>::cache_descriptor::settle(stored_type* e, std::false_type) noexcept -> stored_type*
+{
+    size_t j = cache_index(e->vtbl);
+    while (cache[j]) j = next(j);
+    cache[j] = e;
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+template <size_t N, typename T, typename P>
+auto vtbl_map<N,T,P>::cache_descriptor::settle(stored_type* e, std::true_type) noexcept -> stored_type*
+{
+    size_t j = cache_index(e->vtbl);
+
+    if (cache[j] && cache[j]->occupied())
+        j = alternate_index(e->vtbl); // Expected entry is taken, try the alternative one first
+
+    // Empty slots and vacant entries can take e, while the occupants of the 
+    // others are moved to their other entry
+    for (size_t k = 0; k <= size_t(P::probing::max_displacements); ++k)
+    {
+        std::swap(e,cache[j]);
+
+        if (!e || e->vacant())
+            return e;
+
+        const size_t h = cache_index(e->vtbl);
+        j = h == j ? alternate_index(e->vtbl) : h;
+    }
+
+    return e; // Occupied entry left without place
+}
+
+//------------------------------------------------------------------------------
+
+template <size_t N, typename T, typename P>
+size_t vtbl_map<N,T,P>::cache_descriptor::entries_for(const intptr_t (&vtbl)[N], size_t log_size, const bit_offset_t (&offsets)[N]) const
+{
+    // NOTE: This function should not be inlined because of the use of VLA or 
+    //       alloca. Some compilers have been reported to have errors inlining 
+    //       such functions in a loop. 
+    // NOTE: The use of alloca is discouraged in general! We do this for 
+    //       performance to not resort to vectors and heap and keep counting on stack
+    // NOTE: For very large #log_size values (e.g. #log_size > #max_stack_log_size+3)
+    //       the function does not return the actual number of occupied entires but
+    //       only approximation of thereof (at least that value or larger). This is
+    //       because we wrap over on the largest bit size of the stack allowed.
+    const intptr_t new_cache_mask       = (1<<log_size)-1; // Actual cache mask for the hash function
+    const intptr_t max_stack_mask       = (1<<(max_stack_log_size+3))-1; // Mask for the largest number of bits we are allowed to allocate on stack: +3 is *8 for the number of bits in the allowed stack size
+    const size_t   cache_histogram_size = 1 + std::min(new_cache_mask,max_stack_mask)/XTL_BIT_SIZE(intptr_t); // Number of elements in intptr_t array allocated on the stack
+    XTL_VLAZ(cache_histogram, intptr_t, cache_histogram_size, 1 + max_stack_mask/XTL_BIT_SIZE(intptr_t)); // Declares intptr_t cache_histogram[cache_histogram_size] = {0};
+    XTL_BIT_SET(cache_histogram, cache_index(vtbl,offsets,new_cache_mask) & max_stack_mask); // Mark the entry for new vtbl
+
+    // Iterate over vtbl in old cache and see where they are mapped with log size i and offset j
+    for (size_t c = 0; c <= this->cache_mask; ++c)
+    {
+        stored_type* const st = cache[c];
+
+        XTL_ASSERT(st);
+
+        if (st->occupied())
+            XTL_BIT_SET(cache_histogram, cache_index(st->vtbl,offsets,new_cache_mask) & max_stack_mask); // Mark the entry for each vtbl
+    }
+
+    size_t entries = 0;
+
+    // Count the number of used entries
+    for (size_t h = 0; h < cache_histogram_size; ++h)
+        entries += bits_set(cache_histogram[h]);
+
+    return entries;
+}
+
+//------------------------------------------------------------------------------
+
+template <size_t N, typename T, typename P>
+T& vtbl_map<N,T,P>::update(const intptr_t (&vtbl)[N])
+{
+    XTL_ASSERT(descriptor); // Allocated in constructor, deallocated in destructor
+    XTL_ASSERT(last_table_size < descriptor->used || descriptor->is_full() || cache_descriptor::two_choice::value XTL_PERFECT_HASHING_ONLY(|| descriptor->multiplier != 1)); // We will only call this if size changed
+    XTL_STATIC_PROBES_ONLY(XTL_PROBE(vtbl_update, this, vtbl[0]));
+    XTL_OVERHEAD_ACCOUNTING_ONLY(mch::count_vtbl_update());
+
+    // FIX: vtbl might already exist in old descriptor and if it happens to be the first one, it won't be taken into consideration
+    intptr_t prev[N];
+    intptr_t diff[N] = {};
+
+    array_copy(vtbl,prev);
+
+    // Compute bits in which existing vtbl, including the newly added one, differ
+    for (size_t i = 0; i <= descriptor->cache_mask; ++i)
+    {
+        typename cache_descriptor::stored_type* const st = descriptor->cache[i];
+
+        XTL_ASSERT(st);
+
+        for (size_t s = 0; s < N; s++)
+            if (intptr_t vtbl = st->vtbl[s])
+            {
+                diff[s] |= prev[s] ^ vtbl;
+                prev[s] = vtbl;
+            }
+    }
+
+//#if XTL_DUMP_PERFORMANCE
+//        std::clog << "\nVtbl:New";
+//        vtbl_bin_print(vtbl,std::clog); // Show binary value of vtbl pointer
+//        std::clog << " -> " << descriptor->cache_index(vtbl) << '\t';
+//        vtbl_class_print(vtbl,std::clog); // Show name of the class of this vtbl
+//        std::clog << std::endl;
+//        *this >> std::clog;       
+//#endif
+
+    XTL_VTBL_COUNTERS_ONLY(++updates); // Record update
+    XTL_DEFERRED_VTBL_UPDATES_ONLY(pending_update = false); // This update takes into account all vtbl pointers so far
+
+#if XTL_VTBL_UPDATE_HISTOGRAM
+    vtbl_update_record record;
+    record.old_log_size      = req_bits(descriptor->cache_mask);
+    record.collisions_before = descriptor->displaced();
+    const unsigned long long start = XTL_CYCLE_COUNTER();
+#endif
+
+    bit_offset_t k  = bit_offset_t(req_bits(descriptor->cache_mask));     // current log_size
+    bit_offset_t n  = bit_offset_t(req_bits(descriptor->used << cache_descriptor::two_choice::value)); // needed log_size, two-choice caches are kept at most half full
+    bit_offset_t c  = bit_offset_t(req_bits(case_clauses));               // log_size estimate. NOTE: case_clauses will be initialized by now
+    bit_offset_t l1 = std::max(std::max(k,c),n);                          // lower bound for log_size iteration
+    bit_offset_t l2 = std::max(std::max(k,c),bit_offset_t(n+P::update::log_inc()));// upper bound for log_size iteration
+    bit_offset_t no = l1; // current estimate of the best log_size
+    bit_offset_t zo[N];   // current estimate of the best offset
+    bit_offset_t m[N];    // highest bit in which vtbls differ
+    bit_offset_t z[N];    // lowest bits in which vtbls do not differ
+
+    for (size_t i = 0; i < N; ++i)
+    {
+        if (diff[i])  // We have to check for non-zero as trailing_zeros will return -127 for 0
+        {
+            m[i] = bit_offset_t(req_bits(diff[i])); // highest bit in which vtbls differ
+            z[i] = bit_offset_t(trailing_zeros(static_cast<unsigned int>(diff[i]))); // lowest bits in which vtbls do not differ. 
+        }
+        else
+            m[i] = z[i] = descriptor->optimal_shift[i];
+
+        zo[i] = z[i]; // current estimate of the best offset
+    }
+
+    //std::clog << "Iterate between: ";
+    //std::copy(&z[0],&z[N],std::ostream_iterator<bit_offset_t>(std::clog,","));
+    //std::clog << " and ";
+    //std::copy(&m[0],&m[N],std::ostream_iterator<bit_offset_t>(std::clog,","));
+    //std::clog << std::endl;
+
+#if 0
+    size_t max_cache_entries = 0;
+
+    // Iterate over allowed log sizes
+    for (bit_offset_t i = l1; i <= l2; ++i)
+    {
+        bit_offset_t mm[N]; // Largest offset to iterate to taking into account the number of useful bits in argument position s.
+
+        for (size_t s = 0; s < N; ++s) 
+        {
+            bit_offset_t bits_in_arg_mask = (i+N-1-s)/N;
+            mm[s] = m[s] > bits_in_arg_mask && m[s] - bits_in_arg_mask >= z[s] ? m[s] - bits_in_arg_mask : m[s];
+        }
+
+        size_t q = 0;
+        union { bit_offset_t x[N+1]; bit_offset_t j[N]; };
+
+        array_copy(z,j); // Copy lowest offsets to try
+        x[N] = 0;        // The extra element of the array must be 0 and will become 1 when we iterated over all offsets
+
+        // Iterate over possible offsets
+        do
+        {
+            size_t entries = descriptor->entries_for(vtbl, i, j); // Count the number of used entries
+
+            //std::clog << "Trying size: " << i << " offset ";
+            //std::copy(&x[0],&x[N],std::ostream_iterator<bit_offset_t>(std::clog,","));
+            //std::clog << " entries: " << entries << std::endl;
+
+            // Update best estimates
+            if (entries > max_cache_entries)
+            {
+                max_cache_entries = entries;
+                no = i;
+                array_copy(j,zo);
+
+                if (entries == descriptor->used+1)
+                {
+                    // We found size and offset without conflicts, exit both loops
+                    i = l2+1; // to exit both for loops
+                    break;
+                }
+            }
+
+            // Update current offsets to next ones
+            while (x[q] == mm[q])
+            {
+                x[q] = z[q];
+                ++q;
+            }
+
+            ++x[q];
+            q = 0;
+        } while (x[N]==0);
+    }
+
+#else
+
+    size_t max_cache_entries = descriptor->entries_for(vtbl, l1, descriptor->optimal_shift);
+    array_copy(descriptor->optimal_shift,zo); // Copy current solution as current optimal
+    no = l1;
+
+    // Iterate over allowed log sizes
+    for (bit_offset_t i = l1; i <= l2; ++i)
+    {
+        if (!P::hashing::shift_search)
+        {
+            // Only the log size is chosen, current shifts are kept
+            size_t entries = i == l1 ? max_cache_entries : descriptor->entries_for(vtbl, i, zo);
+
+            if (entries > max_cache_entries)
+            {
+                max_cache_entries = entries;
+                no = i;
+            }
+
+            if (entries == descriptor->used+1)
+                break; // No conflicts with this size
+
+            continue;
+        }
+
+//        size_t saved_max_cache_entries = 0;
+
+        // We iterate until we can make improvements to the number of used cache entries
+//        while (max_cache_entries > saved_max_cache_entries)
+        {
+//            saved_max_cache_entries = max_cache_entries;
+
+            // Try to improve independently each argument position
+            for (size_t s = 0; s < N; ++s) 
+            {
+                bit_offset_t bits_in_arg_mask = (i+N-1-s)/N;
+                bit_offset_t mm = m[s] > bits_in_arg_mask && m[s] - bits_in_arg_mask >= z[s] ? m[s] - bits_in_arg_mask : m[s];
+                bit_offset_t cur = zo[s];
+
+                //XTL_ASSERT(z[s] <= cur && cur <= mm);
+
+                for (bit_offset_t t = z[s]; t <= mm; ++t)
+                {
+                    if (t != cur)
+                    {
+                        zo[s] = t;
+
+                        size_t entries = descriptor->entries_for(vtbl, i, zo); // Count the number of used entries
+
+                        // Update best estimates
+                        if (entries > max_cache_entries)
+                        {
+                            max_cache_entries = entries;
+                            no  = i;
+                            cur = t;
+
+                            if (entries == descriptor->used+1)
+                            {
+                                // We found size and offset without conflicts, exit both loops
+                                i = l2+1; // to exit both for loops
+                                zo[s] = cur;
+                                goto break_of_both_loops;
+                            }
+                        }
+                    }
+                }
+
+                zo[s] = cur;
+            } // of loop over argument positions
+
+break_of_both_loops: ;
+
+        } // of while there are improvements
+    } // of loop over possible log sizes
+#endif
+    if (no < k)
+        no = k; // We never shrink, while we preallocate based on number of case clauses or the minimum
+
+    if (no != k || !array_equal(descriptor->optimal_shift,zo) XTL_PERFECT_HASHING_ONLY(|| descriptor->multiplier != 1))
+    {
+        // OK, either log size or optimal shifts changed. Reset collisions counter to default one
+        // Having fixed initial collision count may be counterproductive for small type switches.
+        // We thus make this number proportional to the number of case clauses to somewhat estimate
+        // after how many collisions an update may be useful.
+        prev_collisions_before_update = collisions_before_update = case_clauses ? case_clauses : N*P::update::collisions();
+
+        cache_descriptor* old = descriptor;
+        #if defined(DBG_NEW)
+            #undef new
+        #endif
+        #if defined(XTL_NO_RVALREF)
+            descriptor = new(no) cache_descriptor(no,zo,*old);
+        #else
+            descriptor = new(no) cache_descriptor(no,zo,std::move(*old));
+        #endif
+        #if defined(DBG_NEW)
+            #define new DBG_NEW
+        #endif
+        delete old;
+    }
+    else
+    {
+        // Update hasn't changed anything, increase the number of colisions before next update
+        prev_collisions_before_update = collisions_before_update = prev_collisions_before_update*2;
+    }
+
+//#if XTL_DUMP_PERFORMANCE
+//        std::clog << "After" << std::endl;
+//        *this >> std::clog;       
+//#endif
+
+    // NOTE: Important to call descriptor's get instead of our own in order to 
+    //       not get into endless recursion update <-> get!
+    typename cache_descriptor::stored_type* res = place(vtbl);
+    XTL_ASSERT(res && res->is_for(vtbl)); // We have ensured enough space, so no need to check this explicitly
+    XTL_USE_VTBL_FREQUENCY_ONLY(++res->hits);
+    XTL_VTBL_LAYOUT_ONLY(++res->lookups);
+    last_table_size = descriptor->used;   // Update memoized value
+
+#if XTL_VTBL_UPDATE_HISTOGRAM
+    record.cycles           = XTL_CYCLE_COUNTER() - start;
+    record.new_log_size     = req_bits(descriptor->cache_mask);
+    record.collisions_after = descriptor->displaced();
+    update_costs.record(record);
+#endif
+
+    return res->value;
+}
+
+//------------------------------------------------------------------------------
+
+template <size_t N, typename T, typename P>
+auto vtbl_map<N,T,P>::place(const intptr_t (&vtbl)[N], std::false_type) -> typename cache_descriptor::stored_type*
+{
+    return descriptor->get(vtbl);
+}
+
+//------------------------------------------------------------------------------
+
+template <size_t N, typename T, typename P>
+auto vtbl_map<N,T,P>::place(const intptr_t (&vtbl)[N], std::true_type) -> typename cache_descriptor::stored_type*
+{
+    for (;;)
+    {
+        if (XTL_LIKELY(!descriptor->misplaced))
+        {
+            typename cache_descriptor::stored_type* res = descriptor->get(vtbl);
+
+            if (XTL_LIKELY(res))
+                return res;
+
+            res = descriptor->displace(vtbl);
+
+            if (res && !descriptor->misplaced)
+                return res;
+        }
+
+        // Either full or displacements didn't succeed: entries left without
+        // place, if any, get their entries in the larger cache
+        grow();
+    }
+}
+
+//------------------------------------------------------------------------------
+
+template <size_t N, typename T, typename P>
+void vtbl_map<N,T,P>::grow()
 {
-    // Initialize all optimal_shift values with the same value
-    std::fill(&optimal_shift[0],&optimal_shift[N],shift);
+    const size_t k = req_bits(descriptor->cache_mask)+1;
 
-    // Allocate all cache entries in one chunk for better cache performance.
-    // Only allocate the difference from need and already present in old ones
-    stored_type* cache_entries = new stored_type[1<<log_size];
+    XTL_VTBL_COUNTERS_ONLY(++updates); // Record update
 
-    // Initialize pointers from cache to newly allocated cache entries
-    // NOTE: We allocate them in the order of LCG traversal to improve
-    //       cache locality in the use of cache_entries later.
-    for (size_t i = 0, j = 0; i <= cache_mask; ++i)
-    {
-        cache[j] = &cache_entries[i];
-        j++; //j = lcg_next(j);
-    }
+    cache_descriptor* old = descriptor;
+    #if defined(DBG_NEW)
+        #undef new
+    #endif
+    #if defined(XTL_NO_RVALREF)
+        descriptor = new(k) cache_descriptor(k,old->optimal_shift,*old);
+    #else
+        descriptor = new(k) cache_descriptor(k,old->optimal_shift,std::move(*old));
+    #endif
+    #if defined(DBG_NEW)
+        #define new DBG_NEW
+    #endif
+    delete old;
 }
 
 //------------------------------------------------------------------------------
 
-template <size_t N, typename T>
-vtbl_map<N,T>::cache_descriptor::cache_descriptor(
-    const size_t       log_size,    ///< Parameter k of the cache - the log of the size of the cache                
-    const bit_offset_t (&shifts)[N],///< Parameter l of the cache - number of irrelevant bits on the right to remove
-#if defined(XTL_NO_RVALREF)
-    cache_descriptor&  old          ///< cache_descriptor we will supposedly replace
-#else
-    cache_descriptor&& old          ///< cache_descriptor we will supposedly replace
-#endif
-) :
-    cache_mask( (1<<log_size) - 1 ),
-    used(old.used)
+#if XTL_INCREMENTAL_VTBL_UPDATES
+template <size_t N, typename T, typename P>
+void vtbl_map<N,T,P>::begin_update(const intptr_t (&vtbl)[N])
 {
-    XTL_ASSERT(cache_mask >= old.cache_mask); // Since we are going to inherit all its existing elements
+    XTL_ASSERT(descriptor->used && !cache_descriptor::two_choice::value); // vtbl is already in the cache
+    XTL_STATIC_PROBES_ONLY(XTL_PROBE(vtbl_update, this, vtbl[0]));
+    XTL_OVERHEAD_ACCOUNTING_ONLY(mch::count_vtbl_update());
+    XTL_VTBL_COUNTERS_ONLY(++updates); // Record update
 
-    array_copy(shifts,optimal_shift);         // Initialize optimal shifts
+    intptr_t prev[N];
+    intptr_t diff[N] = {};
 
-    // We'll be initializing cache pointers out of order for performance reasons
-    // so zero them out first to see which ones we have alredy initialized
-    for (size_t i = 0; i <= cache_mask; ++i) cache[i] = 0;
+    array_copy(vtbl,prev);
 
-    // Initialize first cache pointers to occupied cache entries in the old cache
-    for (size_t i = 0; i <= old.cache_mask; ++i)
+    // Compute bits in which existing vtbl differ, as update() does
+    for (size_t i = 0; i <= descriptor->cache_mask; ++i)
     {
-        XTL_ASSERT(old.cache[i]); // Since we pre-allocate them
+        typename cache_descriptor::stored_type* const st = descriptor->cache[i];
 
-        if (old.cache[i]->occupied())
+        XTL_ASSERT(st);
+
+        for (size_t s = 0; s < N; s++)
+            if (intptr_t vtbl = st->vtbl[s])
+            {
+                diff[s] |= prev[s] ^ vtbl;
+                prev[s] = vtbl;
+            }
+    }
+
+    bit_offset_t k = bit_offset_t(req_bits(descriptor->cache_mask)); // current log_size
+    bit_offset_t n = bit_offset_t(req_bits(descriptor->used));       // needed log_size
+    bit_offset_t c = bit_offset_t(req_bits(case_clauses));           // log_size estimate
+
+    search.descriptor = descriptor;
+    search.l2 = std::max(std::max(k,c),bit_offset_t(n+P::update::log_inc()));
+    search.i  = search.no = std::max(std::max(k,c),n);
+    search.s  = 0;
+
+    array_copy(vtbl,search.vtbl);
+    array_copy(descriptor->optimal_shift,search.zo);
+
+    for (size_t i = 0; i < N; ++i)
+        if (diff[i])  // We have to check for non-zero as trailing_zeros will return -127 for 0
         {
-            size_t j = cache_index(old.cache[i]->vtbl);
-            while (cache[j]) j = lcg_next(j);
-            std::swap(old.cache[i],cache[j]);
+            search.m[i] = bit_offset_t(req_bits(diff[i]));
+            search.z[i] = bit_offset_t(trailing_zeros(static_cast<unsigned int>(diff[i])));
         }
-    }
+        else
+            search.m[i] = search.z[i] = descriptor->optimal_shift[i];
 
-    size_t j = 0;
+    search.t    = search.z[0];
+    search.best = descriptor->entries_for(vtbl, search.i, search.zo);
 
-    // Now copy the rest of allocated but vacant entries
-    for (size_t i = 0; i <= old.cache_mask; ++i)
+    if (search.best == descriptor->used)
+        finish_update(); // Current shifts have no conflicts with this size
+}
+
+//------------------------------------------------------------------------------
+
+template <size_t N, typename T, typename P>
+bool vtbl_map<N,T,P>::advance_update()
+{
+    if (XTL_UNLIKELY(search.descriptor != descriptor))
     {
-        if (old.cache[i])
+        // The cache was replaced since, e.g. grown, compacted or frozen
+        search.descriptor = 0;
+        return false;
+    }
+
+    // Same iteration as in update(), resumed where the previous call left it,
+    // until one candidate has been tried
+    for (;;)
+    {
+        if (!P::hashing::shift_search || search.s == N)
         {
-            XTL_ASSERT(old.cache[i]->vacant());
+            // All candidates of log size i have been tried
+            if (search.i >= search.l2)
+                return finish_update();
 
-            // Skip initialized entries if needed
-            while (cache[j])
+            ++search.i;
+            search.s = 0;
+            search.t = search.z[0];
+
+            if (!P::hashing::shift_search)
             {
-                j++; //j = lcg_next(j);
-                XTL_ASSERT(j <= cache_mask);
+                // Only the log size is chosen, current shifts are kept
+                size_t entries = descriptor->entries_for(search.vtbl, search.i, search.zo);
+
+                if (entries > search.best)
+                {
+                    search.best = entries;
+                    search.no   = search.i;
+                }
+
+                return entries == descriptor->used && finish_update(); // No conflicts with this size
             }
+        }
 
-            std::swap(old.cache[i],cache[j]);
+        const size_t       s  = search.s;
+        const bit_offset_t bits_in_arg_mask = bit_offset_t((search.i+N-1-s)/N);
+        const bit_offset_t mm = search.m[s] > bits_in_arg_mask && search.m[s] - bits_in_arg_mask >= search.z[s] ? search.m[s] - bits_in_arg_mask : search.m[s];
+
+        if (search.t > mm)
+        {
+            // All shifts of argument position s have been tried
+            if (++search.s < N)
+                search.t = search.z[search.s];
+
+            continue;
         }
-    }
 
-    if (cache_mask - old.cache_mask)
-    {
-        // Allocate all cache entries in one chunk for better cache performance.
-        // Only allocate the difference from need and already present in old ones
-        stored_type* cache_entries = new stored_type[cache_mask - old.cache_mask];
+        const bit_offset_t t = search.t++;
 
-        // Initialize remaining pointers from cache to newly allocated cache entries
-        // NOTE: We allocate them in the order of LCG traversal to improve
-        //       cache locality in the use of cache_entries later.
-        for (size_t i = 0; i < cache_mask-old.cache_mask; ++i)
+        if (t == search.zo[s])
+            continue;
+
+        bit_offset_t zo[N];
+        array_copy(search.zo,zo);
+        zo[s] = t;
+
+        size_t entries = descriptor->entries_for(search.vtbl, search.i, zo); // Count the number of used entries
+
+        if (entries > search.best)
         {
-            // Skip initialized entries if needed
-            while (cache[j])
-            {
-                j++; //j = lcg_next(j);
-                XTL_ASSERT(j <= cache_mask);
-            }
+            search.best  = entries;
+            search.no    = search.i;
+            search.zo[s] = t;
 
-            cache[j] = &cache_entries[i];
+            if (entries == descriptor->used)
+                return finish_update(); // We found size and offset without conflicts
         }
+
+        return false;
     }
 }
 
 //------------------------------------------------------------------------------
 
-template <size_t N, typename T>
-vtbl_map<N,T>::cache_descriptor::~cache_descriptor()
+template <size_t N, typename T, typename P>
+bool vtbl_map<N,T,P>::finish_update()
 {
-    // The elements will be pointing into separate arrays, we want to
-    // find all the beginnings of arrays to deallocate them
-    std::sort(&cache[0], &cache[cache_mask+1]);
+    const bit_offset_t k  = bit_offset_t(req_bits(descriptor->cache_mask));
+    const bit_offset_t no = std::max(search.no,k); // We never shrink
 
-    for (size_t i = 0; i <= cache_mask;)
+    search.descriptor = 0;
+    last_table_size   = descriptor->used;
+
+    if (no == k && array_equal(descriptor->optimal_shift,search.zo))
     {
-        if (cache[i]) // We check because subsequent descriptor could have moved out entries from this one
-        {
-            size_t j = i+1;
-            for (; j <= cache_mask && intptr_t(cache[j])-intptr_t(cache[j-1]) == sizeof(stored_type); ++j);
-            delete[] cache[i];
-            i = j;
-        }
-        else
-            ++i;
+        // Search hasn't changed anything, increase the number of colisions before next one
+        prev_collisions_before_update = collisions_before_update = prev_collisions_before_update*2;
+        return false;
     }
+
+    prev_collisions_before_update = collisions_before_update = case_clauses ? case_clauses : N*P::update::collisions();
+
+    // Entries only move to the new cache, so references to their values stay valid
+    cache_descriptor* old = descriptor;
+    #if defined(DBG_NEW)
+        #undef new
+    #endif
+    #if defined(XTL_NO_RVALREF)
+        descriptor = new(no) cache_descriptor(no,search.zo,*old);
+    #else
+        descriptor = new(no) cache_descriptor(no,search.zo,std::move(*old));
+    #endif
+    #if defined(DBG_NEW)
+        #define new DBG_NEW
+    #endif
+    delete old;
+    return true;
 }
+#endif
 
 //------------------------------------------------------------------------------
 
-template <size_t N, typename T>
-void vtbl_map<N,T>::cache_descriptor::put_entries_in_right_place()
+#if XTL_PERFECT_HASHING
+template <size_t N, typename T, typename P>
+bool vtbl_map<N,T,P>::freeze()
 {
-    for (size_t i = 0; i <= cache_mask; ++i)
+    XTL_ASSERT(descriptor); // Allocated in constructor, deallocated in destructor
+
+    if (descriptor->used == 0)
+        return false;
+
+    std::vector<const intptr_t*> vtbls; // Tuples of vtbl pointers in the map
+    vtbls.reserve(descriptor->used);
+
+    for (size_t i = 0; i <= descriptor->cache_mask; ++i)
+        if (descriptor->cache[i]->occupied())
+            vtbls.push_back(descriptor->cache[i]->vtbl);
+
+    const size_t n  = vtbls.size();
+    const size_t w  = XTL_BIT_SIZE(size_t);
+    bit_offset_t k0 = bit_offset_t(req_bits(descriptor->cache_mask)); // current log_size; we never shrink
+    std::vector<size_t> keys(n);
+    std::vector<bool>   seen;
+
+    if (req_bits(n-1) > k0)
+        k0 = bit_offset_t(req_bits(n-1));
+
+    // Iterate over allowed log sizes
+    for (bit_offset_t k = k0; k <= k0+P::update::log_inc(); ++k)
     {
-#if XTL_USE_LCG_WALK
-        if (cache[i]->occupied()) // There is a valid tuple of vtbl pointers in the entry
+        const size_t mask = (size_t(1)<<k)-1;
+
+        // Shifts to try: current optimal ones first, then the same shift in all argument positions
+        for (size_t c = 0; c <= XTL_BIT_SIZE(intptr_t)/2; ++c)
         {
-            XTL_ASSERT(cache[i]->vtbl[N-1]);        // Either all 0 or all non 0
+            bit_offset_t shifts[N];
 
-            size_t q = cache_index(cache[i]->vtbl); // Index of location where it should be (equivalence class)
+            if (c == 0)
+                array_copy(descriptor->optimal_shift,shifts);
+            else
+                std::fill(&shifts[0],&shifts[N],bit_offset_t(c-1));
 
-            if (i == q) break;                      // The entity is in the right place
+            for (size_t i = 0; i < n; ++i)
+                keys[i] = cache_descriptor::cache_key(vtbls[i],shifts);
 
-            size_t j = q;                           // Current position to try placing in
+            // No multiplier can separate tuples whose keys are the same
+            std::vector<size_t> sorted(keys);
+            std::sort(sorted.begin(),sorted.end());
 
-            for (size_t j = q; cache[i]->occupied(); j = lcg_next(j))
-                std::swap(cache[i],cache[j]);
+            if (std::adjacent_find(sorted.begin(),sorted.end()) != sorted.end())
+                continue;
 
-            while (cache[j]->occupied())
+            size_t seed = size_t(0x9E3779B97F4A7C15ULL);
+            size_t mult = 1; // 1 stands for the plain mask of the adaptive scheme
+
+            for (size_t attempt = 0; attempt <= XTL_PERFECT_HASH_ATTEMPTS; ++attempt)
             {
-                size_t k = cache_index(cache[j]->vtbl);
+                seen.assign(mask+1,false);
 
-                if (k == j || // the entry is occupied by the right entity
-                    k == q)   // or by another entity in the same equivalence class
-                    j = lcg_next(j); // get next cache entry to try
-                else
-                    break;
+                size_t i = 0;
 
-                if (j == i)   // this is an entry in the equivalence class
-                    goto next;// break out of both loops
-            }
+                for (; i < n; ++i)
+                {
+                    size_t j = mult == 1 ? keys[i] & mask : (keys[i]*mult) >> (w-k);
 
-            // entry in j is neither in its rightful place, not an entry from equivalence class q
-            std::swap(cache[i],cache[j]); // swap current to where it should be and continue looking at current
-        }
-next:   ;
-#else
-        size_t k = size_t(~0); // Keeps cache index of the previous swap.
+                    if (seen[j])
+                        break;
 
-        while (cache[i]->occupied()) // There is a valid tuple of vtbl pointers in the entry
-        {
-            XTL_ASSERT(cache[i]->vtbl[N-1]);        // Either all 0 or all non 0
-            size_t j = cache_index(cache[i]->vtbl); // Index of location where it should be
+                    seen[j] = true;
+                }
 
-            if (j != k && j != i) // where it should be is not where previous one was swapped to and not here
-            {
-                std::swap(cache[i],cache[j]); // swap current to where it should be
-                k = j;                        // remember where we swapped it to
+                if (i == n)
+                {
+                    // Collision-free arrangement found
+                    if (mult != 1 || k != req_bits(descriptor->cache_mask) || !array_equal(descriptor->optimal_shift,shifts) || descriptor->multiplier != 1)
+                    {
+                        cache_descriptor* old = descriptor;
+                        #if defined(DBG_NEW)
+                            #undef new
+                        #endif
+                        #if defined(XTL_NO_RVALREF)
+                            descriptor = new(k) cache_descriptor(k,shifts,*old,mult);
+                        #else
+                            descriptor = new(k) cache_descriptor(k,shifts,std::move(*old),mult);
+                        #endif
+                        #if defined(DBG_NEW)
+                            #define new DBG_NEW
+                        #endif
+                        delete old;
+                    }
+
+                    last_table_size = descriptor->used;
+                    return true;
+                }
+
+                // Next odd multiplier from 64-bit LCG by Knuth
+                seed = seed*size_t(6364136223846793005ULL) + size_t(1442695040888963407ULL);
+                mult = seed | 1;
             }
-            else
-                break;
         }
-#endif
     }
+
+    return false;
 }
+#endif
 
 //------------------------------------------------------------------------------
 
-template <size_t N, typename T>
-auto vtbl_map<N,T>::cache_descriptor::get(const intptr_t (&vtbl)[N], size_t j) noexcept -> stored_type*
+#if XTL_DEFERRED_VTBL_UPDATES
+template <size_t N, typename T, typename P>
+bool vtbl_map<N,T,P>::rearrange()
 {
-    XTL_ASSERT(j == cache_index(vtbl)); // j must be index of location where vtbl should be
-    stored_type*& ce = cache[j]; // Location where it should be
-
-    XTL_ASSERT(ce);   // Since we pre-allocate all entries
+    if (!pending_update)
+        return false;
 
-    // When the entry is occupied, our combination can be elsewhere in 
-    // the cache due to collisions, however when the entry is not 
-    // occupied, we do not have to search whether it is in the cache as
-    // constructor establishes invariant that entries can only be in
-    // their place.
-#if !XTL_USE_LCG_WALK
-    if (XTL_LIKELY(ce->occupied()))
-#endif
-    {
-        // Precompute hash of the vtbl array for faster comparisons.
-        XTL_VTBL_HASHING(const intptr_t vtbl_hash = get_hash(vtbl);)
+    // A synchronous update might have run since the request was made
+    if (descriptor->used == last_table_size)
+        return pending_update = false;
 
-#if XTL_USE_LCG_WALK
-        // See if (vtbl0,...,vtblN) is elsewhere in the cache
-        // Start from j (to account if it is already there) and walk all entries
-        // in the LCG order. We are guaranteed to hit each entry only once.
-        for (size_t i = 0; i <= cache_mask; ++i)
+    // Rearrange for the vtbl pointers already in the cache: update() will 
+    // find the one it places and return its entry, which we don't need
+    for (size_t i = 0; i <= descriptor->cache_mask; ++i)
+        if (descriptor->cache[i]->occupied())
         {
-            if (XTL_UNLIKELY(cache[j]->vacant())) // we found an empty slot
-            {
-                XTL_ASSERT(cache[j]->vtbl[N-1] == 0); // Either all 0 or all non 0
-                *cache[j] = vtbl; //array_copy(vtbl,cache[i]->vtbl);
-                ++used;
-                std::swap(ce,cache[j]); // swap it with the right position
-                return ce;
-            }
-            else
-            if (XTL_UNLIKELY(cache[j]->is_for(vtbl XTL_VTBL_HASHING(,vtbl_hash)))) // if so ...
-            {
-                std::swap(ce,cache[j]); // swap it with the right position
-                return ce;
-            }
-
-            j = lcg_next(j);
+            intptr_t vtbl[N];
+            array_copy(descriptor->cache[i]->vtbl, vtbl);
+            update(vtbl);
+            return true;
         }
-#else
-        // See if (vtbl0,...,vtblN) is elsewhere in the cache
-        // Start from j (to account if it is already there) till end
-        for (size_t i = j; i <= cache_mask; ++i)
-            if (XTL_UNLIKELY(cache[i]->is_for(vtbl XTL_VTBL_HASHING(,vtbl_hash)))) // if so ...
-            {
-                std::swap(ce,cache[i]); // swap it with the right position
-                return ce;
-            }
-        // If not found, continue from the beginning until j
-        for (size_t i = 0; i < j; ++i)
-            if (XTL_UNLIKELY(cache[i]->is_for(vtbl XTL_VTBL_HASHING(,vtbl_hash)))) // if so ...
-            {
-                std::swap(ce,cache[i]); // swap it with the right position
-                return ce;
-            }
-#endif
-    }
 
-    // (vtbl0,...,vtblN) is not in the cache
-    if (XTL_LIKELY(used <= cache_mask)) // there are empty slots in cache
-    {
-#if XTL_USE_LCG_WALK
-        XTL_ASSERT(!"Not possible to get here with LCG walk");
-#else
-        // Start from j (since it can be empty) till end
-        for (size_t i = j; i <= cache_mask; ++i)
-            if (XTL_UNLIKELY(cache[i]->vacant())) // find the first empty slot
-            {
-                XTL_ASSERT(cache[i]->vtbl[N-1] == 0); // Either all 0 or all non 0
-                *cache[i] = vtbl; //array_copy(vtbl,cache[i]->vtbl);
-                ++used;
-                std::swap(ce,cache[i]); // swap it with the right position
-                return ce;
-            }
-        // If not found, continue from the beginning until j
-        for (size_t i = 0; i < j; ++i)
-            if (XTL_UNLIKELY(cache[i]->vacant())) // find the first empty slot
-            {
-                XTL_ASSERT(cache[i]->vtbl[N-1] == 0); // Either all 0 or all non 0
-                *cache[i] = vtbl; //array_copy(vtbl,cache[i]->vtbl);
-                ++used;
-                std::swap(ce,cache[i]); // swap it with the right position
-                return ce;
-            }
-#endif
-    }
-
-    // There are no empty slots, we return nullptr to indicate this
-    return 0;
+    return pending_update = false;
 }
+#endif
 
 //------------------------------------------------------------------------------
 
-template <size_t N, typename T>
-size_t vtbl_map<N,T>::cache_descriptor::entries_for(const intptr_t (&vtbl)[N], size_t log_size, const bit_offset_t (&offsets)[N]) const
+#if XTL_VTBL_COMPACTION
+template <size_t N, typename T, typename P>
+size_t vtbl_map<N,T,P>::compact(bool release)
 {
-    // NOTE: This function should not be inlined because of the use of VLA or 
-    //       alloca. Some compilers have been reported to have errors inlining 
-    //       such functions in a loop. 
-    // NOTE: The use of alloca is discouraged in general! We do this for 
-    //       performance to not resort to vectors and heap and keep counting on stack
-    // NOTE: For very large #log_size values (e.g. #log_size > #max_stack_log_size+3)
-    //       the function does not return the actual number of occupied entires but
-    //       only approximation of thereof (at least that value or larger). This is
-    //       because we wrap over on the largest bit size of the stack allowed.
-    const intptr_t new_cache_mask       = (1<<log_size)-1; // Actual cache mask for the hash function
-    const intptr_t max_stack_mask       = (1<<(max_stack_log_size+3))-1; // Mask for the largest number of bits we are allowed to allocate on stack: +3 is *8 for the number of bits in the allowed stack size
-    const size_t   cache_histogram_size = 1 + std::min(new_cache_mask,max_stack_mask)/XTL_BIT_SIZE(intptr_t); // Number of elements in intptr_t array allocated on the stack
-    XTL_VLAZ(cache_histogram, intptr_t, cache_histogram_size, 1 + max_stack_mask/XTL_BIT_SIZE(intptr_t)); // Declares intptr_t cache_histogram[cache_histogram_size] = {0};
-    XTL_BIT_SET(cache_histogram, cache_index(vtbl,offsets,new_cache_mask) & max_stack_mask); // Mark the entry for new vtbl
+    XTL_ASSERT(descriptor); // Allocated in constructor, deallocated in destructor
 
-    // Iterate over vtbl in old cache and see where they are mapped with log size i and offset j
-    for (size_t c = 0; c <= this->cache_mask; ++c)
-    {
-        stored_type* const st = cache[c];
+    const bool used_in_epoch = touched;
+    touched = false;          // Next epoch begins
 
-        XTL_ASSERT(st);
+    if (!release)
+        return 0;
 
-        if (st->occupied())
-            XTL_BIT_SET(cache_histogram, cache_index(st->vtbl,offsets,new_cache_mask) & max_stack_mask); // Mark the entry for each vtbl
-    }
+    const size_t used = used_in_epoch ? descriptor->used : 0; // Unused maps lose all their entries
+    const size_t k    = std::max(size_t(initial_log_size()), req_bits(used << cache_descriptor::two_choice::value));
 
-    size_t entries = 0;
+    if (used == descriptor->used && (used*4 > descriptor->size() || k >= req_bits(descriptor->cache_mask)))
+        return 0;             // The map is neither stale nor sparse
+
+    const size_t before   = memory_used();
+    cache_descriptor* old = descriptor;
+    #if defined(DBG_NEW)
+        #undef new
+    #endif
+    descriptor = new(k) cache_descriptor(k,old->optimal_shift[0]);
+    #if defined(DBG_NEW)
+        #define new DBG_NEW
+    #endif
+    array_copy(old->optimal_shift,descriptor->optimal_shift);
+
+    // Move values of the remaining entries. The vtbl tuples that collide 
+    // in the smaller cache are placed according to the probing policy.
+    if (used)
+        for (size_t i = 0; i <= old->cache_mask; ++i)
+            if (old->cache[i]->occupied())
+            {
+                typename cache_descriptor::stored_type* res = place(old->cache[i]->vtbl);
+                XTL_ASSERT(res && res->is_for(old->cache[i]->vtbl)); // The smaller cache still fits all entries
+                res->value = old->cache[i]->value;
+                XTL_USE_VTBL_FREQUENCY_ONLY(res->hits = old->cache[i]->hits);
+            }
 
-    // Count the number of used entries
-    for (size_t h = 0; h < cache_histogram_size; ++h)
-        entries += bits_set(cache_histogram[h]);
+    delete old;
+    XTL_INLINE_CACHE_ONLY(forget_inline()); // Its entries were released with old
+    XTL_ADAPTIVE_DISPATCH_ONLY(restart_profile()); // ... and so were those of the engine
 
-    return entries;
+    XTL_VTBL_COUNTERS_ONLY(++updates); // Record update
+    last_table_size = descriptor->used;
+    prev_collisions_before_update = collisions_before_update = case_clauses ? case_clauses : N*P::update::collisions();
+    return before - memory_used();
 }
+#endif
 
 //------------------------------------------------------------------------------
 
-template <size_t N, typename T>
-T& vtbl_map<N,T>::update(const intptr_t (&vtbl)[N])
+#if XTL_VTBL_INVALIDATION
+template <size_t N, typename T, typename P>
+size_t vtbl_map<N,T,P>::invalidate(const vtbl_range& range)
 {
     XTL_ASSERT(descriptor); // Allocated in constructor, deallocated in destructor
-    XTL_ASSERT(last_table_size < descriptor->used || descriptor->is_full()); // We will only call this if size changed
-
-    // FIX: vtbl might already exist in old descriptor and if it happens to be the first one, it won't be taken into consideration
-    intptr_t prev[N];
-    intptr_t diff[N] = {};
 
-    array_copy(vtbl,prev);
+    size_t dropped = 0;
 
-    // Compute bits in which existing vtbl, including the newly added one, differ
     for (size_t i = 0; i <= descriptor->cache_mask; ++i)
-    {
-        typename cache_descriptor::stored_type* const st = descriptor->cache[i];
+        if (descriptor->cache[i]->occupied() && std::any_of(&descriptor->cache[i]->vtbl[0], &descriptor->cache[i]->vtbl[N], [&range](intptr_t v) { return range.contains(v); }))
+            ++dropped;
 
-        XTL_ASSERT(st);
+    if (!dropped)
+        return 0;             // The map has never seen vtbls of the range
 
-        for (size_t s = 0; s < N; s++)
-            if (intptr_t vtbl = st->vtbl[s])
-            {
-                diff[s] |= prev[s] ^ vtbl;
-                prev[s] = vtbl;
-            }
-    }
+    const size_t k        = req_bits(descriptor->cache_mask);
+    cache_descriptor* old = descriptor;
+    #if defined(DBG_NEW)
+        #undef new
+    #endif
+    descriptor = new(k) cache_descriptor(k,old->optimal_shift[0]);
+    #if defined(DBG_NEW)
+        #define new DBG_NEW
+    #endif
+    array_copy(old->optimal_shift,descriptor->optimal_shift);
 
-//#if XTL_DUMP_PERFORMANCE
-//        std::clog << "\nVtbl:New";
-//        vtbl_bin_print(vtbl,std::clog); // Show binary value of vtbl pointer
-//        std::clog << " -> " << descriptor->cache_index(vtbl) << '\t';
-//        vtbl_class_print(vtbl,std::clog); // Show name of the class of this vtbl
-//        std::clog << std::endl;
-//        *this >> std::clog;       
-//#endif
+    // Move values of the remaining entries, which all fit the cache of the same size
+    for (size_t i = 0; i <= old->cache_mask; ++i)
+        if (old->cache[i]->occupied() && std::none_of(&old->cache[i]->vtbl[0], &old->cache[i]->vtbl[N], [&range](intptr_t v) { return range.contains(v); }))
+        {
+            typename cache_descriptor::stored_type* res = place(old->cache[i]->vtbl);
+            XTL_ASSERT(res && res->is_for(old->cache[i]->vtbl));
+            res->value = old->cache[i]->value;
+            XTL_USE_VTBL_FREQUENCY_ONLY(res->hits = old->cache[i]->hits);
+        }
 
-    XTL_DUMP_PERFORMANCE_ONLY(++updates); // Record update
+    delete old;
+    XTL_INLINE_CACHE_ONLY(forget_inline()); // Its entries were released with old
+    XTL_ADAPTIVE_DISPATCH_ONLY(restart_profile()); // ... and so were those of the engine
 
-    bit_offset_t k  = bit_offset_t(req_bits(descriptor->cache_mask));     // current log_size
-    bit_offset_t n  = bit_offset_t(req_bits(descriptor->used));           // needed  log_size
-    bit_offset_t c  = bit_offset_t(req_bits(case_clauses));               // log_size estimate. NOTE: case_clauses will be initialized by now
-    bit_offset_t l1 = std::max(std::max(k,c),n);                          // lower bound for log_size iteration
-    bit_offset_t l2 = std::max(std::max(k,c),bit_offset_t(n+max_log_inc));// upper bound for log_size iteration
-    bit_offset_t no = l1; // current estimate of the best log_size
-    bit_offset_t zo[N];   // current estimate of the best offset
-    bit_offset_t m[N];    // highest bit in which vtbls differ
-    bit_offset_t z[N];    // lowest bits in which vtbls do not differ
+    XTL_VTBL_COUNTERS_ONLY(++updates); // Record update
+    last_table_size = descriptor->used;
+    return dropped;
+}
+#endif
 
-    for (size_t i = 0; i < N; ++i)
-    {
-        if (diff[i])  // We have to check for non-zero as trailing_zeros will return -127 for 0
-        {
-            m[i] = bit_offset_t(req_bits(diff[i])); // highest bit in which vtbls differ
-            z[i] = bit_offset_t(trailing_zeros(static_cast<unsigned int>(diff[i]))); // lowest bits in which vtbls do not differ. 
-        }
-        else
-            m[i] = z[i] = descriptor->optimal_shift[i];
+//------------------------------------------------------------------------------
 
-        zo[i] = z[i]; // current estimate of the best offset
-    }
+#if XTL_SEPARATE_DEFAULTS
+template <size_t N, typename T, typename P>
+void vtbl_map<N,T,P>::purge_defaults()
+{
+    XTL_ASSERT(descriptor); // Allocated in constructor, deallocated in destructor
 
-    //std::clog << "Iterate between: ";
-    //std::copy(&z[0],&z[N],std::ostream_iterator<bit_offset_t>(std::clog,","));
-    //std::clog << " and ";
-    //std::copy(&m[0],&m[N],std::ostream_iterator<bit_offset_t>(std::clog,","));
-    //std::clog << std::endl;
+    size_t used = 0;        // Entries of tuples with other values
 
-#if 0
-    size_t max_cache_entries = 0;
+    for (size_t i = 0; i <= descriptor->cache_mask; ++i)
+        if (descriptor->cache[i]->occupied() && !defaults.contains(descriptor->cache[i]->vtbl))
+            ++used;
 
-    // Iterate over allowed log sizes
-    for (bit_offset_t i = l1; i <= l2; ++i)
-    {
-        bit_offset_t mm[N]; // Largest offset to iterate to taking into account the number of useful bits in argument position s.
+    // The cache shrinks back to the size the remaining entries need, when default ones made it grow
+    const size_t k        = std::min(req_bits(descriptor->cache_mask), std::max(size_t(initial_log_size()), req_bits(used << cache_descriptor::two_choice::value)));
+    cache_descriptor* old = descriptor;
+    #if defined(DBG_NEW)
+        #undef new
+    #endif
+    descriptor = new(k) cache_descriptor(k,old->optimal_shift[0]);
+    #if defined(DBG_NEW)
+        #define new DBG_NEW
+    #endif
+    array_copy(old->optimal_shift,descriptor->optimal_shift);
 
-        for (size_t s = 0; s < N; ++s) 
+    // Move values of the entries with other values. The vtbl tuples that 
+    // collide in a smaller cache are placed according to the probing policy.
+    for (size_t i = 0; i <= old->cache_mask; ++i)
+        if (old->cache[i]->occupied() && !defaults.contains(old->cache[i]->vtbl))
         {
-            bit_offset_t bits_in_arg_mask = (i+N-1-s)/N;
-            mm[s] = m[s] > bits_in_arg_mask && m[s] - bits_in_arg_mask >= z[s] ? m[s] - bits_in_arg_mask : m[s];
+            typename cache_descriptor::stored_type* res = place(old->cache[i]->vtbl);
+            XTL_ASSERT(res && res->is_for(old->cache[i]->vtbl));
+            res->value = old->cache[i]->value;
+            XTL_USE_VTBL_FREQUENCY_ONLY(res->hits = old->cache[i]->hits);
         }
 
-        size_t q = 0;
-        union { bit_offset_t x[N+1]; bit_offset_t j[N]; };
-
-        array_copy(z,j); // Copy lowest offsets to try
-        x[N] = 0;        // The extra element of the array must be 0 and will become 1 when we iterated over all offsets
+    delete old;
+    XTL_INLINE_CACHE_ONLY(forget_inline()); // Its entries were released with old
+    XTL_ADAPTIVE_DISPATCH_ONLY(restart_profile()); // ... and so were those of the engine
 
-        // Iterate over possible offsets
-        do
-        {
-            size_t entries = descriptor->entries_for(vtbl, i, j); // Count the number of used entries
+    XTL_VTBL_COUNTERS_ONLY(++updates); // Record update
+    last_table_size   = descriptor->used;
+    defaults_in_cache = 0;
+    prev_collisions_before_update = collisions_before_update = case_clauses ? case_clauses : N*P::update::collisions();
+}
+#endif
 
-            //std::clog << "Trying size: " << i << " offset ";
-            //std::copy(&x[0],&x[N],std::ostream_iterator<bit_offset_t>(std::clog,","));
-            //std::clog << " entries: " << entries << std::endl;
+//------------------------------------------------------------------------------
 
-            // Update best estimates
-            if (entries > max_cache_entries)
-            {
-                max_cache_entries = entries;
-                no = i;
-                array_copy(j,zo);
+#if XTL_SEALED_VTBL_MAPS
+template <size_t N, typename T, typename P>
+bool vtbl_map<N,T,P>::seal(vtbl_seal_segment& segment)
+{
+    XTL_ASSERT(descriptor); // Allocated in constructor, deallocated in destructor
 
-                if (entries == descriptor->used+1)
-                {
-                    // We found size and offset without conflicts, exit both loops
-                    i = l2+1; // to exit both for loops
-                    break;
-                }
-            }
+    if (!seal_size())
+        return false;
 
-            // Update current offsets to next ones
-            while (x[q] == mm[q])
-            {
-                x[q] = z[q];
-                ++q;
-            }
+    typedef typename cache_descriptor::stored_type stored_type;
 
-            ++x[q];
-            q = 0;
-        } while (x[N]==0);
-    }
+    const size_t n      = descriptor->size();
+    const size_t header = cache_descriptor::header_size(n); // Including fingerprints of a grouped cache
+    cache_descriptor* d = static_cast<cache_descriptor*>(segment.allocate(header));
+    stored_type* entries = static_cast<stored_type*>(segment.allocate(n*sizeof(stored_type)));
 
-#else
+    // Parameters of the hash function stay, while entries follow in the order of the cache
+    std::memcpy(static_cast<void*>(d), descriptor, header);
 
-    size_t max_cache_entries = descriptor->entries_for(vtbl, l1, descriptor->optimal_shift);
-    array_copy(descriptor->optimal_shift,zo); // Copy current solution as current optimal
-    no = l1;
+    for (size_t i = 0; i < n; ++i)
+        d->cache[i] = new(&entries[i]) stored_type(*descriptor->cache[i]);
 
-    // Iterate over allowed log sizes
-    for (bit_offset_t i = l1; i <= l2; ++i)
-    {
-//        size_t saved_max_cache_entries = 0;
+    delete descriptor;
+    descriptor = d;
+    sealed = true;
+    XTL_INLINE_CACHE_ONLY(forget_inline());               // Its entries were released with the old cache
+    XTL_ADAPTIVE_DISPATCH_ONLY(restart_profile());        // ... and so were those of the engine
+    XTL_DEFERRED_VTBL_UPDATES_ONLY(pending_update = false); // The cache is never rearranged now
+    return true;
+}
+#endif
 
-        // We iterate until we can make improvements to the number of used cache entries
-//        while (max_cache_entries > saved_max_cache_entries)
-        {
-//            saved_max_cache_entries = max_cache_entries;
+//------------------------------------------------------------------------------
 
-            // Try to improve independently each argument position
-            for (size_t s = 0; s < N; ++s) 
-            {
-                bit_offset_t bits_in_arg_mask = (i+N-1-s)/N;
-                bit_offset_t mm = m[s] > bits_in_arg_mask && m[s] - bits_in_arg_mask >= z[s] ? m[s] - bits_in_arg_mask : m[s];
-                bit_offset_t cur = zo[s];
+#if XTL_VTBL_LAYOUT
+template <size_t N, typename T, typename P>
+void vtbl_map<N,T,P>::layout(vtbl_site_layout& l) const
+{
+    const cache_descriptor& d = *descriptor;
 
-                //XTL_ASSERT(z[s] <= cur && cur <= mm);
+    intptr_t first[N] = {}; // vtbl pointers of the first tuple
+    intptr_t diff[N]  = {}; // Bits in which vtbl pointers differ from those of the first tuple
+    intptr_t used[N]  = {}; // Bits whose change moves some tuple to another expected entry
 
-                for (bit_offset_t t = z[s]; t <= mm; ++t)
-                {
-                    if (t != cur)
-                    {
-                        zo[s] = t;
+    l.slots = d.size();
+    l.entries.clear();
 
-                        size_t entries = descriptor->entries_for(vtbl, i, zo); // Count the number of used entries
+    for (size_t i = 0; i <= d.cache_mask; ++i)
+    {
+        const typename cache_descriptor::stored_type* st = d.cache[i];
 
-                        // Update best estimates
-                        if (entries > max_cache_entries)
-                        {
-                            max_cache_entries = entries;
-                            no  = i;
-                            cur = t;
+        XTL_ASSERT(st); // Since we pre-allocate all entries
 
-                            if (entries == descriptor->used+1)
-                            {
-                                // We found size and offset without conflicts, exit both loops
-                                i = l2+1; // to exit both for loops
-                                zo[s] = cur;
-                                goto break_of_both_loops;
-                            }
-                        }
-                    }
-                }
+        if (st->vacant())
+            continue;
 
-                zo[s] = cur;
-            } // of loop over argument positions
+        vtbl_entry_layout e;
+        e.slot    = i;
+        e.home    = d.cache_index(st->vtbl);
+        e.probes  = probes(e.home, i);
+        e.lookups = st->lookups;
+        e.vtbl.assign(&st->vtbl[0], &st->vtbl[N]);
 
-break_of_both_loops: ;
+        for (size_t s = 0; s < N; ++s)
+        {
+            if (l.entries.empty())
+                first[s] = st->vtbl[s];
+            else
+                diff[s] |= first[s] ^ st->vtbl[s];
 
-        } // of while there are improvements
-    } // of loop over possible log sizes
-#endif
-    if (no < k)
-        no = k; // We never shrink, while we preallocate based on number of case clauses or the minimum
+            // Hashing policies differ in which bits they take, so we flip them one by one
+            for (size_t b = 0; b < XTL_BIT_SIZE(intptr_t); ++b)
+            {
+                intptr_t v[N];
+                array_copy(st->vtbl, v);
+                v[s] ^= intptr_t(uintptr_t(1) << b);
 
-    if (no != k || !array_equal(descriptor->optimal_shift,zo))
-    {
-        // OK, either log size or optimal shifts changed. Reset collisions counter to default one
-        // Having fixed initial collision count may be counterproductive for small type switches.
-        // We thus make this number proportional to the number of case clauses to somewhat estimate
-        // after how many collisions an update may be useful.
-        prev_collisions_before_update = collisions_before_update = case_clauses ? case_clauses : N*initial_collisions_before_update;
+                if (d.cache_index(v) != e.home)
+                    used[s] |= intptr_t(uintptr_t(1) << b);
+            }
+        }
 
-        cache_descriptor* old = descriptor;
-        #if defined(DBG_NEW)
-            #undef new
-        #endif
-        #if defined(XTL_NO_RVALREF)
-            descriptor = new(no) cache_descriptor(no,zo,*old);
-        #else
-            descriptor = new(no) cache_descriptor(no,zo,std::move(*old));
-        #endif
-        #if defined(DBG_NEW)
-            #define new DBG_NEW
-        #endif
-        delete old;
+        l.entries.push_back(e);
     }
-    else
-    {
-        // Update hasn't changed anything, increase the number of colisions before next update
-        prev_collisions_before_update = collisions_before_update = prev_collisions_before_update*2;
-    }
-
-//#if XTL_DUMP_PERFORMANCE
-//        std::clog << "After" << std::endl;
-//        *this >> std::clog;       
-//#endif
 
-    // NOTE: Important to call descriptor's get instead of our own in order to 
-    //       not get into endless recursion update <-> get!
-    typename cache_descriptor::stored_type* res = descriptor->get(vtbl);
-    XTL_ASSERT(res && res->is_for(vtbl)); // We have ensured enough space, so no need to check this explicitly
-    last_table_size = descriptor->used;   // Update memoized value
-    return res->value;
+    l.shifts.assign(&d.optimal_shift[0], &d.optimal_shift[N]);
+    l.used_bits.assign(&used[0], &used[N]);
+    l.varying.assign(&diff[0], &diff[N]);
 }
+#endif
 
 //------------------------------------------------------------------------------
 
 #if XTL_DUMP_PERFORMANCE
-template <size_t N, typename T>
-std::ostream& vtbl_map<N,T>::operator>>(std::ostream& os) const
+template <size_t N, typename T, typename P>
+std::ostream& vtbl_map<N,T,P>::operator>>(std::ostream& os) const
 {
     std::ios::fmtflags fmt = os.flags(); // store flags
 
@@ -1258,7 +4256,7 @@ std::ostream& vtbl_map<N,T>::operator>>(std::ostream& os) const
                 prev[s] = vtbl;
             }
 
-            cache_histogram[cache_descriptor::cache_index(to_array(a),descriptor->optimal_shift,descriptor->cache_mask)]++;
+            cache_histogram[descriptor->cache_index(to_array(a))]++;
             XTL_ASSERT(size_t(q-vtbls.begin()) < vtbl_count); // Since we preallocated only that much
             *q++ = a;
         }
@@ -1319,6 +4317,13 @@ std::ostream& vtbl_map<N,T>::operator>>(std::ostream& os) const
         << " hits="       << std::setw(8) << hits         // how many hits have we had
         << " misses="     << std::setw(8) << misses       // how many misses have we had
         << " collisions=" << std::setw(8) << collisions   // how many misses were actual collisions
+    #if XTL_INLINE_CACHE
+        << " inline="     << std::setw(8) << inline_hits  // how many hits were found in the inline cache
+    #endif
+    #if XTL_ADAPTIVE_DISPATCH
+        << " engine="     << dispatch_engine_name(engine) // engine serving the lookups
+        << " compared="   << std::setw(8) << engine_hits  // how many hits were served by its compares
+    #endif
         << " memory="     << std::setw(8) << memory_used()// number of bytes used
         << " Stmt: "      << file << '[' << line << ']' << ' ' << func
         << ";\n";
@@ -1329,7 +4334,7 @@ std::ostream& vtbl_map<N,T>::operator>>(std::ostream& os) const
     bit_offset_t m  = req_bits(diff);           // highest bit in which vtbls differ
     bit_offset_t z  = trailing_zeros(static_cast<unsigned int>(diff)); // number of lowest bits in which vtbls do not differ
     bit_offset_t l1 = std::min(k,n);
-    bit_offset_t l2 = std::max(k,bit_offset_t(n+max_log_inc));
+    bit_offset_t l2 = std::max(k,bit_offset_t(n+P::update::log_inc()));
 
     for (bit_offset_t i = l1; i <= l2; ++i)
     {
@@ -1412,25 +4417,126 @@ std::ostream& vtbl_map<N,T>::operator>>(std::ostream& os) const
 }
 #endif
 
+#endif // !XTL_MULTI_THREADING
+
 //------------------------------------------------------------------------------
 
+#if XTL_MULTI_THREADING
+
+/// A field of type_switch_info that may be written by one thread executing a
+/// Match statement while being read by another. Writes have release and reads
+/// have acquire semantics, so a thread that sees the target of a jump also
+/// sees the offsets assigned before it.
+/// \note Intentionally has no converting constructor so that expressions like
+///       cond ? info.target : 0 unambiguously convert it to T.
+template <typename T>
+struct type_switch_field
+{
+    operator T() const noexcept { return m_value.load(std::memory_order_acquire); }
+    type_switch_field& operator=(T v) noexcept { m_value.store(v, std::memory_order_release); return *this; }
+    std::atomic<T> m_value;
+};
+
+#define XTL_TYPE_SWITCH_FIELD(T) type_switch_field<T>
+#else
+#define XTL_TYPE_SWITCH_FIELD(T) T
+#endif
+
+#if XTL_PACKED_SWITCH_INFO
+typedef std::int32_t   type_switch_offset_t; ///< Type of this-pointer offsets in type_switch_info \see #XTL_PACKED_SWITCH_INFO
+typedef std::uint32_t  type_switch_target_t; ///< Type of case labels in type_switch_info \see #XTL_PACKED_SWITCH_INFO
+#else
+typedef std::ptrdiff_t type_switch_offset_t; ///< Type of this-pointer offsets in type_switch_info
+typedef std::size_t    type_switch_target_t; ///< Type of case labels in type_switch_info
+#endif
+typedef std::uint64_t  type_switch_clauses_t; ///< Set of clauses in type_switch_info, bit i-1 for label i \see #XTL_APPLICABLE_CLAUSES
+
 /// Data structure used by our Match statements to associate jump target and the 
 /// required offset with the vtbl-pointer.
 template <size_t N>
 struct type_switch_info
 {
-    std::ptrdiff_t offset[N]; ///< Required this-pointer offset to the source sub-object
-    std::size_t    target;    ///< Case label of the jump target of Match statement
+    XTL_TYPE_SWITCH_FIELD(type_switch_offset_t) offset[N]; ///< Required this-pointer offset to the source sub-object
+    XTL_TYPE_SWITCH_FIELD(type_switch_target_t) target;    ///< Case label of the jump target of Match statement
+    XTL_COMPUTED_GOTO_ONLY(XTL_TYPE_SWITCH_FIELD(void*)       jump;) ///< Address of the jump target \see #XTL_USE_COMPUTED_GOTO
+    XTL_APPLICABLE_CLAUSES_ONLY(XTL_TYPE_SWITCH_FIELD(type_switch_clauses_t) tested;)     ///< Clauses whose applicability is known \see #XTL_APPLICABLE_CLAUSES
+    XTL_APPLICABLE_CLAUSES_ONLY(XTL_TYPE_SWITCH_FIELD(type_switch_clauses_t) applicable;) ///< Clauses known to apply \see #XTL_APPLICABLE_CLAUSES
 };
 
 template <>
 struct type_switch_info<0>
 {
-    std::size_t    target;    ///< Case label of the jump target of Match statement
-    std::ptrdiff_t offset[XTL_VARIABLE_SIZE_ARRAY]; ///< Dummy array, not used. Ideally should be 0 size
+    XTL_TYPE_SWITCH_FIELD(type_switch_target_t) target;    ///< Case label of the jump target of Match statement
+    XTL_COMPUTED_GOTO_ONLY(XTL_TYPE_SWITCH_FIELD(void*)       jump;) ///< Address of the jump target \see #XTL_USE_COMPUTED_GOTO
+    XTL_APPLICABLE_CLAUSES_ONLY(XTL_TYPE_SWITCH_FIELD(type_switch_clauses_t) tested;)     ///< Clauses whose applicability is known \see #XTL_APPLICABLE_CLAUSES
+    XTL_APPLICABLE_CLAUSES_ONLY(XTL_TYPE_SWITCH_FIELD(type_switch_clauses_t) applicable;) ///< Clauses known to apply \see #XTL_APPLICABLE_CLAUSES
+    XTL_TYPE_SWITCH_FIELD(type_switch_offset_t) offset[XTL_VARIABLE_SIZE_ARRAY]; ///< Dummy array, not used. Ideally should be 0 size
 };
 
+#if XTL_SEPARATE_DEFAULTS
+/// Tells map that info, which it has just returned, took the default value,
+/// when the map can keep such tuples apart \see #XTL_SEPARATE_DEFAULTS
+template <typename M, typename Info>
+inline auto set_default_of(M& map, Info& info, int) -> decltype(map.set_default(info)) { map.set_default(info); }
+
+/// Maps that cannot keep default tuples apart store them as any other
+template <typename M, typename Info>
+inline void set_default_of(M&, Info&, long) {}
+#endif
+
+#if XTL_APPLICABLE_CLAUSES
+/// Bit of the clause with given label in the sets of type_switch_info, 0 for
+/// labels past the size of the set
+inline type_switch_clauses_t clause_bit(size_t label) noexcept
+{
+    return label-1 < XTL_BIT_SIZE(type_switch_clauses_t) ? type_switch_clauses_t(1) << (label-1) : 0;
+}
+
+/// Records in info whether the clause with given bit applies, when info is 
+/// kept for the dynamic types of subjects \returns applies
+template <typename Info>
+inline bool remember_clause(Info& info, type_switch_clauses_t bit, bool remember, bool applies) noexcept
+{
+    if (remember)
+    {
+        info.tested = info.tested | bit;
+
+        if (applies)
+            info.applicable = info.applicable | bit;
+    }
+
+    return applies;
+}
+#endif
+
+//------------------------------------------------------------------------------
+
+#if XTL_EXTERN_TEMPLATES && !XTL_MULTI_THREADING && !XTL_STATIC_VTBL_MAPS
+
+/// Out-of-line members of vtbl_map<N,type_switch_info<N>> holding the slow path
+/// of Match statements on N polymorphic subjects: the update on a cache miss,
+/// with everything it calls, and the release of the cache.
+#define XTL_VTBL_MAP_INSTANCES(Kind,N)                                                                                              \
+    Kind template                       vtbl_map<N,type_switch_info<N>,XTL_VTBL_MAP_POLICY>::cache_descriptor::~cache_descriptor(); \
+    Kind template type_switch_info<N>& vtbl_map<N,type_switch_info<N>,XTL_VTBL_MAP_POLICY>::update(const intptr_t (&)[N]); \
+    XTL_INCREMENTAL_VTBL_UPDATES_ONLY(                                                                                              \
+    Kind template void                 vtbl_map<N,type_switch_info<N>,XTL_VTBL_MAP_POLICY>::begin_update(const intptr_t (&)[N]); \
+    Kind template bool                 vtbl_map<N,type_switch_info<N>,XTL_VTBL_MAP_POLICY>::advance_update();)
+
+#if defined(XTL_INSTANTIATE_TEMPLATES)
+    /// The one translation unit that defines XTL_INSTANTIATE_TEMPLATES provides
+    /// the instantiations the others refer to. \see #XTL_EXTERN_TEMPLATES
+    XTL_VTBL_MAP_INSTANCES(       ,1)
+    XTL_VTBL_MAP_INSTANCES(       ,2)
+#else
+    XTL_VTBL_MAP_INSTANCES(extern ,1)
+    XTL_VTBL_MAP_INSTANCES(extern ,2)
+#endif
+
+#undef XTL_VTBL_MAP_INSTANCES
+
 //------------------------------------------------------------------------------
+#endif
 
 } // of namespace mch
 
@@ -1454,5 +4560,13 @@ struct type_switch_info<0>
 //#include "vtblmap4st-2.hpp" // Implementation of vtbl_map<2,T> partial specialization
 //#include "vtblmap4st-3.hpp" // Implementation of vtbl_map<3,T> partial specialization
 
+#if XTL_MULTI_THREADING
+#include "vtblmap4mt.hpp" // Multi-threaded implementation of vtbl_map<N,T> with wait-free lookups
+#endif
+
+#if XTL_STATIC_VTBL_MAPS
+#include "vtblstatic.hpp" // vtbl_map<N,T> with statically reserved storage of fixed capacity
+#endif
+
 //------------------------------------------------------------------------------
 #undef if
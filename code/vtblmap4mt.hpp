@@ -0,0 +1,912 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file defines multi-threaded version of class vtbl_map<N,T> used for
+/// fast mapping of N vtbl pointers to type T.
+///
+/// \note This file is not meant to be included directly. It is included by
+///       vtblmap4.hpp when #XTL_MULTI_THREADING is enabled.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#pragma once
+
+// --------------------[ Concurrency Model ]--------------------
+// - The map is published through a single atomic pointer to an immutable
+//   (in shape) cache_descriptor. Readers load it once and index into it.
+// - Cache cells are atomic pointers to stored entries. Vacant cells point to
+//   a shared sentinel entry with all vtbl pointers being 0, which never
+//   matches a real tuple of vtbl pointers, so the hit path has no extra checks.
+// - Stored entries are fully initialized before a pointer to them is
+//   published and their vtbl pointers never change afterwards. Entries are
+//   never moved or deallocated until the map is destroyed, so references
+//   returned by get() remain valid for the lifetime of the map.
+// - Modifications (insertion, moving entries to their home cell,
+//   rearrangement of the cache) are serialized by a mutex, which is only
+//   taken on a miss. The hit path is thus wait-free: two atomic loads with
+//   acquire semantics and a comparison.
+// - Rearranged cache is built off-line and swapped in atomically (RCU-style).
+//   Since we cannot know when the last reader has left the old descriptor,
+//   replaced descriptors are retired into a list and only deallocated with
+//   the map. Updates are rare and throttled, so the retired list stays short.
+//------------------------------------------------------------------------------
+
+#include <atomic>
+#include <mutex>
+
+#if XTL_THREAD_LOCAL_CACHE
+#include "vtblcache.hpp" // Per-thread front cache of the map
+#endif
+
+#if XTL_STATIC_PROBES
+#include "probes.hpp"    // Static probes on misses and updates
+#endif
+
+namespace mch ///< Mach7 library namespace
+{
+
+//------------------------------------------------------------------------------
+
+/// Class for efficient mapping of N vtbl-pointers to a value of type T.
+/// This version of the class is for use in the multi-threaded environment.
+/// Lookups that hit the cache are wait-free, while misses and updates are
+/// serialized between the threads.
+template <size_t N, typename T, typename P>
+class vtbl_map : public vtbl_map_subjects<vtbl_map<N,T,P>,T>
+{
+    static_assert(P::probing::choices == 0, "Two-choice probing is only supported by single-threaded vtbl maps");
+
+private:
+
+    /// Type of the stored values, which is a pair of vtbl-pointer and T value.
+    typedef stored_type_for<N,T> stored_type;
+
+    /// A helper data structure that is atomically swapped during updates to
+    /// cache parameters k and l.
+    struct cache_descriptor
+    {
+        /// Cache mask to access entries. Always cache_size-1 since cache_size is a power of 2
+        /// \note We currently rely in constructors on this member be first in
+        ///       declaration order so that it is initialized first!
+        const size_t cache_mask;
+
+        /// Optimal shift computed based on the vtbl pointers already in the map.
+        /// \note Unlike single-threaded version, this value never changes once
+        ///       descriptor has been published. A new descriptor is created
+        ///       instead.
+        bit_offset_t optimal_shift[N];
+
+        /// Total number of vtbl-pointers in the cache
+        /// \note Only accessed under the lock of the owning vtbl_map.
+        size_t used;
+
+        /// Descriptor that was replaced by this one. We keep it alive until
+        /// the map is destroyed since other threads may still be reading it.
+        cache_descriptor* retired;
+
+        /// Variable-sized array with actual pointers to stored_type
+        /// \warning: This must be the last member of this class!
+        std::atomic<stored_type*> cache[XTL_VARIABLE_SIZE_ARRAY];
+
+        #if defined(DBG_NEW)
+            #undef new
+        #endif
+
+        void* operator new(size_t s, size_t log_size)
+        {
+            // FIX: Ensure proper alignment requirements
+            XTL_OVERHEAD_ACCOUNTING_ONLY(mch::count_allocation(s + ((1<<log_size)-XTL_VARIABLE_SIZE_ARRAY)*sizeof(std::atomic<stored_type*>)));
+            return ::new char[s + ((1<<log_size)-XTL_VARIABLE_SIZE_ARRAY)*sizeof(std::atomic<stored_type*>)];
+        }
+
+        #if defined(DBG_NEW)
+            #define new DBG_NEW
+        #endif
+
+        /// We need to declare this placement delete operator since we overload new.
+        void operator delete(void* p, size_t) { ::delete(static_cast<char*>(p)); } // We cast to char* to avoid warning on deleting void*, which is undefined
+
+        /// We also provide non-placement delete operator since it doesn't really depend on extra arguments.
+        void operator delete(void* p)         { ::delete(static_cast<char*>(p)); } // We cast to char* to avoid warning on deleting void*, which is undefined
+
+        /// Creates new empty cache_descriptor based on parameters k and l of the hashing function
+        cache_descriptor(
+            const size_t       log_size,               ///< Parameter k of the cache - the log of the size of the cache
+            const bit_offset_t shift = irrelevant_bits ///< Parameter l of the cache - number of irrelevant bits on the right to remove
+        ) :
+            cache_mask( (1<<log_size) - 1 ),
+            used(0),
+            retired(nullptr)
+        {
+            std::fill(&optimal_shift[0],&optimal_shift[N],shift);
+
+            for (size_t i = 0; i <= cache_mask; ++i)
+                cache[i].store(&vacant, std::memory_order_relaxed);
+        }
+
+        /// Creates new cache_descriptor based on parameters k and l of the
+        /// hashing function that will hold all the entries of the old one.
+        /// \note The old descriptor is left intact as other threads may still
+        ///       be reading it.
+        cache_descriptor(
+            const size_t       log_size,    ///< Parameter k of the cache - the log of the size of the cache
+            const bit_offset_t (&shifts)[N],///< Parameter l of the cache - number of irrelevant bits on the right to remove
+            cache_descriptor&  old          ///< cache_descriptor we are going to replace
+        ) :
+            cache_mask( (1<<log_size) - 1 ),
+            used(old.used),
+            retired(&old)
+        {
+            XTL_ASSERT(cache_mask >= old.cache_mask); // Since we are going to inherit all its existing elements
+
+            array_copy(shifts,optimal_shift);
+
+            for (size_t i = 0; i <= cache_mask; ++i)
+                cache[i].store(&vacant, std::memory_order_relaxed);
+
+            // Put entries of the old cache into their home cells or along LCG walk from it
+            for (size_t i = 0; i <= old.cache_mask; ++i)
+            {
+                stored_type* st = old.cache[i].load(std::memory_order_relaxed);
+
+                if (st->occupied())
+                {
+                    size_t j = cache_index(st->vtbl);
+                    while (cache[j].load(std::memory_order_relaxed)->occupied()) j = next(j);
+                    cache[j].store(st, std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /// Deallocates retired descriptors. Stored entries are owned by vtbl_map.
+       ~cache_descriptor() { delete retired; }
+
+        bool is_full() const { return used > cache_mask; } ///< Checks whether cache is full
+        size_t  size() const { return cache_mask+1; }      ///< Number of entries in cache
+
+    #if XTL_VTBL_UPDATE_HISTOGRAM
+        /// Number of tuples of vtbl pointers that are not in their home cells
+        size_t displaced() const
+        {
+            size_t result = 0;
+
+            for (size_t i = 0; i <= cache_mask; ++i)
+            {
+                const stored_type* st = cache[i].load(std::memory_order_relaxed);
+
+                if (st->occupied() && cache_index(st->vtbl) != i)
+                    ++result;
+            }
+
+            return result;
+        }
+    #endif
+
+        /// Next cell to try in case of collision
+        size_t next(size_t j) const { return P::probing::next(j,cache_mask); }
+
+        size_t memory_used() const
+        {
+            return sizeof(cache_descriptor)                                                // Descriptor itself
+                + (cache_mask+1-XTL_VARIABLE_SIZE_ARRAY)*sizeof(std::atomic<stored_type*>) // Pointers in cache
+                + (retired ? retired->memory_used() : 0);                                  // Descriptors we replaced
+        }
+
+        /// Global function computing cache index for a given vtbl pointers, offsets and cache mask
+        static inline size_t cache_index(const intptr_t vtbl[N], const bit_offset_t shifts[N], size_t cache_mask)
+        {
+            intptr_t vtbl_shifted[N];
+
+            for (size_t i = 0; i < N; ++i)
+                vtbl_shifted[i] = vtbl[i] >> shifts[i];
+
+            return P::hashing::key(vtbl_shifted) & cache_mask;
+        }
+
+        /// Computes cache index for current optimal offsets and cache mask.
+        size_t cache_index(const intptr_t vtbl[N]) const { return cache_index(vtbl,optimal_shift,cache_mask); }
+
+        /// Finds or inserts entry for (vtbl0,...,vtblN) and makes sure it is
+        /// in its home cell j. Returns nullptr when the cache is full.
+        /// \note Must only be called under the lock of the owning vtbl_map.
+        stored_type* get(const intptr_t (&vtbl)[N], size_t j);
+
+        /// Computes the number of entries an existing set of vtbl-pointer tuples
+        /// extended with the new one will occupy in cache of a given #log_size
+        /// with given #offsets
+        size_t entries_for(const intptr_t (&vtbl)[N], size_t log_size, const bit_offset_t (&offsets)[N]) const;
+
+    private:
+
+        cache_descriptor(const cache_descriptor&);            ///< No copy constructor
+        cache_descriptor& operator=(const cache_descriptor&); ///< No assignment operator
+
+    }; // of class cache_descriptor
+
+private:
+
+    vtbl_map(const vtbl_map&);            ///< No copy constructor
+    vtbl_map& operator=(const vtbl_map&); ///< No assignment operator
+
+    /// The map keeps a reference to the number of case clauses, which update()
+    /// reads long after construction, so it cannot be a temporary
+    vtbl_map(vtbl_count_t&&) = delete;
+#if XTL_VTBL_COUNTERS
+    vtbl_map(const char*, size_t, const char*, vtbl_count_t&&) = delete;
+#endif
+
+public:
+
+#if XTL_VTBL_COUNTERS
+    #if defined(DBG_NEW)
+        #undef new
+    #endif
+    vtbl_map(const char* fl, size_t ln, const char* fn, const vtbl_count_t& num_clauses) :
+        descriptor(new(initial_log_size()) cache_descriptor(initial_log_size())),
+        case_clauses(num_clauses),
+        last_table_size(0),
+        collisions_before_update(P::update::collisions()),
+        prev_collisions_before_update(P::update::collisions()),
+        file(fl),
+        line(ln),
+        func(fn),
+        updates(0),
+        hits(0),
+        misses(0),
+        collisions(0)
+        XTL_DEFERRED_VTBL_UPDATES_ONLY(, pending_update(false))
+        XTL_VTBL_MAP_REGISTRY_ONLY(, node(this, &request))
+    {}
+    #if defined(DBG_NEW)
+        #define new DBG_NEW
+    #endif
+#endif
+
+    #if defined(DBG_NEW)
+        #undef new
+    #endif
+    vtbl_map(const vtbl_count_t& num_clauses) :
+        descriptor(new(initial_log_size()) cache_descriptor(initial_log_size())),
+        case_clauses(num_clauses),
+        last_table_size(0),
+        collisions_before_update(P::update::collisions()),
+        prev_collisions_before_update(P::update::collisions())
+        XTL_VTBL_COUNTERS_ONLY(,file("unspecified"), line(0), func("unspecified"), updates(0), hits(0), misses(0), collisions(0))
+        XTL_DEFERRED_VTBL_UPDATES_ONLY(, pending_update(false))
+        XTL_VTBL_MAP_REGISTRY_ONLY(, node(this, &request))
+    {}
+    #if defined(DBG_NEW)
+        #define new DBG_NEW
+    #endif
+
+   ~vtbl_map()
+    {
+        XTL_DUMP_PERFORMANCE_ONLY(std::clog << *this << std::endl);
+
+        cache_descriptor* dsc = descriptor.load();
+
+        // Current descriptor references all the entries ever created
+        for (size_t i = 0; i <= dsc->cache_mask; ++i)
+        {
+            stored_type* st = dsc->cache[i].load();
+
+            if (st != &vacant)
+                delete st;
+        }
+
+        delete dsc;
+    }
+
+    size_t memory_used() const
+    {
+        std::lock_guard<std::mutex> guard(update_mutex);
+        const cache_descriptor* dsc = descriptor.load(std::memory_order_relaxed);
+        return sizeof(vtbl_map) + dsc->memory_used() + dsc->used*sizeof(stored_type);
+    }
+
+    /// Calls f(vtbl,value) for every tuple of vtbl pointers stored in the map.
+    /// \note f is called under the lock and thus must not look up in this map.
+    template <typename F>
+    void for_each(F f) const
+    {
+        std::lock_guard<std::mutex> guard(update_mutex);
+        const cache_descriptor* dsc = descriptor.load(std::memory_order_relaxed);
+
+        for (size_t i = 0; i <= dsc->cache_mask; ++i)
+        {
+            const stored_type* st = dsc->cache[i].load(std::memory_order_relaxed);
+
+            if (st != &vacant)
+                f(st->vtbl, st->value);
+        }
+    }
+
+    /// Log of the number of cells in the cache
+    size_t log_size() const { return req_bits(descriptor.load(std::memory_order_acquire)->cache_mask); }
+
+#if XTL_VTBL_COUNTERS
+    /// Sets the site of the Match statement the map belongs to, which a 
+    /// preallocated map could not receive through its constructor.
+    /// \see #XTL_LOCATE_VTBL_MAP
+    bool locate(const char* fl, size_t ln, const char* fn)
+    {
+        std::lock_guard<std::mutex> guard(update_mutex);
+        file = fl; line = ln; func = fn;
+        return true;
+    }
+#endif
+
+#if XTL_VTBL_UPDATE_HISTOGRAM
+    /// Copy of the timing of the rearrangements of the cache done so far
+    vtbl_update_histogram update_histogram() const
+    {
+        std::lock_guard<std::mutex> guard(update_mutex);
+        return update_costs;
+    }
+#endif
+
+    /// Shift applied to i-th vtbl pointer when computing cache index
+    bit_offset_t shift(size_t i) const { return descriptor.load(std::memory_order_acquire)->optimal_shift[i]; }
+
+    /// Bring lookups by subjects into scope
+    using vtbl_map_subjects<vtbl_map<N,T,P>,T>::get;
+    using vtbl_map_subjects<vtbl_map<N,T,P>,T>::xtl_get;
+
+    /// This is the main function to get the value of type T associated with
+    /// the (vtbl0,...,vtblN) of given pointers.
+    ///
+    /// \note The function returns the value "by reference" to indicate that you
+    ///       may take address or change the value of the cell! Different
+    ///       threads will get the same reference for the same vtbl pointers.
+    inline T& get(const intptr_t (&vtbl)[N]) noexcept
+    {
+    #if XTL_THREAD_LOCAL_CACHE
+        return front_cache.get(vtbl, [this,&vtbl]() -> T& { return this->shared_get(vtbl); });
+    #else
+        return shared_get(vtbl);
+    #endif
+    }
+
+    /// Looks up the value associated with the (vtbl0,...,vtblN) in the data
+    /// structure shared by all threads.
+    inline T& shared_get(const intptr_t (&vtbl)[N]) noexcept
+    {
+        const cache_descriptor* const dsc = descriptor.load(std::memory_order_acquire);
+        stored_type* const st = dsc->cache[dsc->cache_index(vtbl)].load(std::memory_order_acquire);
+
+        XTL_ASSERT(st); // Since vacant cells point to the sentinel entry
+
+        if (XTL_LIKELY(st->is_for(vtbl)))
+        {
+            XTL_VTBL_COUNTERS_ONLY(hits.fetch_add(1, std::memory_order_relaxed));
+            return st->value;
+        }
+        else
+            return miss(vtbl);
+    }
+
+    /// A function that gets called when the vtbl pointers were not found in
+    /// their home cell.
+    T& miss(const intptr_t (&vtbl)[N]);
+
+    /// A function that gets called when the cache is either too inefficient or full.
+    /// \note Must only be called under the lock
+    T& update(const intptr_t (&vtbl)[N]);
+
+#if XTL_DEFERRED_VTBL_UPDATES
+    /// Does the rearrangement of the cache that lookups asked for since the
+    /// previous call, if any. Lookups that hit in the cache are not blocked
+    /// by it, as the new cache is published atomically once built.
+    /// \see rearrange_vtbl_maps()
+    /// \returns Whether the cache was rearranged.
+    bool rearrange();
+#endif
+
+#if XTL_DUMP_PERFORMANCE
+    std::ostream& operator>>(std::ostream& os) const;
+    friend std::ostream& operator<<(std::ostream& os, const vtbl_map& m) { return m >> os; }
+#endif
+
+private:
+
+    /// Shared entry all vacant cells point to
+    static stored_type vacant;
+
+    /// Cached mappings of vtbl to some indecies
+    std::atomic<cache_descriptor*> descriptor;
+
+    /// Serializes all modifications of the map
+    mutable std::mutex update_mutex;
+
+#if XTL_THREAD_LOCAL_CACHE
+    /// Per-thread cache consulted before descriptor
+    vtbl_front_cache<N,T> front_cache;
+#endif
+
+    /// A reference to a global variable that will be initialized with the
+    /// number of case clauses of a given match statement
+    const vtbl_count_t& case_clauses;
+
+    /// Memoized table.size() during last cache rearranging
+    size_t last_table_size;
+
+    /// Number of colisions that we will still tolerate before next update
+    int collisions_before_update;
+
+    /// Previous number of colisions that we will still tolerate before next update
+    int prev_collisions_before_update;
+
+#if XTL_VTBL_COUNTERS
+    const char* file;      ///< File in which this vtblmap_of is instantiated
+    size_t      line;      ///< Line in the file where it is instantiated
+    const char* func;      ///< Function in which this vtblmap_of is instantiated
+    size_t      updates;   ///< Amount of reconfigurations performed at run time
+    std::atomic<size_t> hits; ///< The number of cache hits
+    size_t      misses;    ///< The number of cache misses
+    size_t      collisions;///< Out of all the misses, how many were actual collisions
+#endif
+
+#if XTL_VTBL_UPDATE_HISTOGRAM
+    vtbl_update_histogram update_costs; ///< Timing of the calls to update()
+#endif
+
+#if XTL_DEFERRED_VTBL_UPDATES
+    /// Whether lookups had enough collisions to ask for a rearrangement
+    bool pending_update;
+#endif
+
+#if XTL_VTBL_MAP_REGISTRY
+    /// Type-erased handling of requests sent to all maps through vtbl_map_node.
+    /// \note Freezing and compaction are not supported under multi-threading.
+    static size_t request(void* m, vtbl_map_request r, void* arg)
+    {
+        vtbl_map& map = *static_cast<vtbl_map*>(m);
+        XTL_UNUSED(arg);
+
+        switch (r)
+        {
+        case memory_request:  return map.memory_used();
+    #if XTL_DEFERRED_VTBL_UPDATES
+        case rearrange_request: return map.rearrange();
+    #endif
+    #if XTL_VTBL_STATISTICS
+        case statistics_request:
+            {
+                vtbl_site_statistics& s = *static_cast<vtbl_site_statistics*>(arg);
+                s.memory = map.memory_used();
+
+                std::lock_guard<std::mutex> guard(map.update_mutex);
+                const cache_descriptor* dsc = map.descriptor.load(std::memory_order_relaxed);
+                s.file       = map.file;
+                s.line       = map.line;
+                s.func       = map.func;
+                s.subjects   = N;
+                s.log_size   = req_bits(dsc->cache_mask);
+                s.entries    = dsc->used;
+                s.hits       = map.hits.load(std::memory_order_relaxed);
+                s.misses     = map.misses;
+                s.collisions = map.collisions;
+                s.updates    = map.updates;
+                s.inline_hits = 0;
+                XTL_VTBL_UPDATE_HISTOGRAM_ONLY(s.update_costs = map.update_costs);
+                return 1;
+            }
+    #endif
+        default:              return 0;
+        }
+    }
+
+    /// Registration of this map in the list of all maps. 
+    /// \note Has to be declared last as it is initialized with this.
+    vtbl_map_node node;
+#endif
+
+};
+
+//------------------------------------------------------------------------------
+
+template <size_t N, typename T, typename P> stored_type_for<N,T> vtbl_map<N,T,P>::vacant;
+
+//------------------------------------------------------------------------------
+
+template <size_t N, typename T, typename P>
+auto vtbl_map<N,T,P>::cache_descriptor::get(const intptr_t (&vtbl)[N], size_t j) -> stored_type*
+{
+    XTL_ASSERT(j == cache_index(vtbl)); // j must be index of location where vtbl should be
+
+    // Precompute hash of the vtbl array for faster comparisons.
+    XTL_VTBL_HASHING(const intptr_t vtbl_hash = get_hash(vtbl);)
+
+    stored_type* const home = cache[j].load(std::memory_order_relaxed);
+
+    // See if (vtbl0,...,vtblN) is elsewhere in the cache. Start from j (to
+    // account if it is already there) and walk entries in the LCG order until
+    // the first vacant one, just like single-threaded version does.
+    for (size_t i = 0, k = j; i <= cache_mask; ++i, k = next(k))
+    {
+        stored_type* const st = cache[k].load(std::memory_order_relaxed);
+
+        if (XTL_UNLIKELY(st->vacant())) // we found an empty slot
+        {
+            #if defined(DBG_NEW)
+                #undef new
+            #endif
+            stored_type* const res = new stored_type;
+            XTL_OVERHEAD_ACCOUNTING_ONLY(mch::count_allocation(sizeof(stored_type)));
+            #if defined(DBG_NEW)
+                #define new DBG_NEW
+            #endif
+            *res = vtbl; // Fully initialize the entry before publishing it
+            ++used;
+            // Occupant of the home cell (if any) moves to the vacant cell
+            // first, so that it never disappears from the cache.
+            if (k != j) cache[k].store(home, std::memory_order_release);
+            cache[j].store(res, std::memory_order_release);
+            return res;
+        }
+        else
+        if (XTL_UNLIKELY(st->is_for(vtbl XTL_VTBL_HASHING(,vtbl_hash)))) // if so ...
+        {
+            if (k != j)
+            {
+                // Swap it with the right position. Readers in between may
+                // temporarily miss the other entry and will queue on the lock.
+                cache[j].store(st,   std::memory_order_release);
+                cache[k].store(home, std::memory_order_release);
+            }
+            return st;
+        }
+    }
+
+    // There are no empty slots, we return nullptr to indicate this
+    return nullptr;
+}
+
+//------------------------------------------------------------------------------
+
+template <size_t N, typename T, typename P>
+size_t vtbl_map<N,T,P>::cache_descriptor::entries_for(const intptr_t (&vtbl)[N], size_t log_size, const bit_offset_t (&offsets)[N]) const
+{
+    // NOTE: See single-threaded version for the notes on the use of VLA.
+    const intptr_t new_cache_mask       = (1<<log_size)-1; // Actual cache mask for the hash function
+    const intptr_t max_stack_mask       = (1<<(max_stack_log_size+3))-1; // Mask for the largest number of bits we are allowed to allocate on stack: +3 is *8 for the number of bits in the allowed stack size
+    const size_t   cache_histogram_size = 1 + std::min(new_cache_mask,max_stack_mask)/XTL_BIT_SIZE(intptr_t); // Number of elements in intptr_t array allocated on the stack
+    XTL_VLAZ(cache_histogram, intptr_t, cache_histogram_size, 1 + max_stack_mask/XTL_BIT_SIZE(intptr_t)); // Declares intptr_t cache_histogram[cache_histogram_size] = {0};
+    XTL_BIT_SET(cache_histogram, cache_index(vtbl,offsets,new_cache_mask) & max_stack_mask); // Mark the entry for new vtbl
+
+    // Iterate over vtbl in old cache and see where they are mapped with log size i and offset j
+    for (size_t c = 0; c <= this->cache_mask; ++c)
+    {
+        const stored_type* const st = cache[c].load(std::memory_order_relaxed);
+
+        if (st->occupied())
+            XTL_BIT_SET(cache_histogram, cache_index(st->vtbl,offsets,new_cache_mask) & max_stack_mask); // Mark the entry for each vtbl
+    }
+
+    size_t entries = 0;
+
+    // Count the number of used entries
+    for (size_t h = 0; h < cache_histogram_size; ++h)
+        entries += bits_set(cache_histogram[h]);
+
+    return entries;
+}
+
+//------------------------------------------------------------------------------
+
+template <size_t N, typename T, typename P>
+T& vtbl_map<N,T,P>::miss(const intptr_t (&vtbl)[N])
+{
+    std::lock_guard<std::mutex> guard(update_mutex);
+
+    cache_descriptor* const dsc = descriptor.load(std::memory_order_relaxed);
+    const size_t j  = dsc->cache_index(vtbl);  // Index of location where it should be
+    stored_type* ce = dsc->cache[j].load(std::memory_order_relaxed); // Entry in location where it should be
+
+    // Another thread might have brought our entry home while we were waiting
+    if (ce->is_for(vtbl))
+        return ce->value;
+
+    XTL_VTBL_COUNTERS_ONLY(++misses);
+    XTL_VTBL_COUNTERS_ONLY(if (ce->occupied()) ++collisions);
+    XTL_STATIC_PROBES_ONLY(XTL_PROBE(vtbl_miss, this, vtbl[0]));
+
+#if XTL_DEFERRED_VTBL_UPDATES
+    if (XTL_UNLIKELY(dsc->is_full()))             // No entries left for possibly new vtbl in the cache
+        return update(vtbl);                      // grow the cache right away
+
+    if (XTL_UNLIKELY(
+        ce->occupied()                            // Collision - the entry for vtbl is already occupied
+        && --collisions_before_update <= 0        // We had sufficiently many collisions to justify call
+        && dsc->used != last_table_size))         // There was at least one vtbl added since last update
+        pending_update = true;                    // leave rearrangement to rearrange_vtbl_maps()
+#else
+    if (XTL_UNLIKELY(
+        dsc->is_full()                            // No entries left for possibly new vtbl in the cache
+        || (ce->occupied()                        // Collision - the entry for vtbl is already occupied
+        && --collisions_before_update <= 0        // We had sufficiently many collisions to justify call
+        && dsc->used != last_table_size)))        // There was at least one vtbl added since last update
+        return update(vtbl);                      // try to rearrange cache
+#endif
+
+    ce = dsc->get(vtbl,j); // Brings entry for vtbl into its home cell j
+    XTL_ASSERT(ce && ce->is_for(vtbl));
+    return ce->value;
+}
+
+//------------------------------------------------------------------------------
+
+template <size_t N, typename T, typename P>
+T& vtbl_map<N,T,P>::update(const intptr_t (&vtbl)[N])
+{
+    cache_descriptor* dsc = descriptor.load(std::memory_order_relaxed);
+
+    XTL_ASSERT(dsc); // Allocated in constructor, deallocated in destructor
+    XTL_ASSERT(last_table_size < dsc->used || dsc->is_full()); // We will only call this if size changed
+    XTL_STATIC_PROBES_ONLY(XTL_PROBE(vtbl_update, this, vtbl[0]));
+    XTL_OVERHEAD_ACCOUNTING_ONLY(mch::count_vtbl_update());
+
+#if XTL_VTBL_UPDATE_HISTOGRAM
+    vtbl_update_record record;
+    record.old_log_size      = req_bits(dsc->cache_mask);
+    record.collisions_before = dsc->displaced();
+    const unsigned long long start = XTL_CYCLE_COUNTER();
+#endif
+
+    intptr_t prev[N];
+    intptr_t diff[N] = {};
+
+    array_copy(vtbl,prev);
+
+    // Compute bits in which existing vtbl, including the newly added one, differ
+    for (size_t i = 0; i <= dsc->cache_mask; ++i)
+    {
+        const stored_type* const st = dsc->cache[i].load(std::memory_order_relaxed);
+
+        for (size_t s = 0; s < N; s++)
+            if (intptr_t vtbl = st->vtbl[s])
+            {
+                diff[s] |= prev[s] ^ vtbl;
+                prev[s] = vtbl;
+            }
+    }
+
+    XTL_VTBL_COUNTERS_ONLY(++updates); // Record update
+    XTL_DEFERRED_VTBL_UPDATES_ONLY(pending_update = false); // This update takes into account all vtbl pointers so far
+
+    bit_offset_t k  = bit_offset_t(req_bits(dsc->cache_mask));            // current log_size
+    bit_offset_t n  = bit_offset_t(req_bits(dsc->used));                  // needed  log_size
+    bit_offset_t c  = bit_offset_t(req_bits(case_clauses));               // log_size estimate. NOTE: case_clauses will be initialized by now
+    bit_offset_t l1 = std::max(std::max(k,c),n);                          // lower bound for log_size iteration
+    bit_offset_t l2 = std::max(std::max(k,c),bit_offset_t(n+P::update::log_inc()));// upper bound for log_size iteration
+    bit_offset_t no = l1; // current estimate of the best log_size
+    bit_offset_t zo[N];   // current estimate of the best offset
+    bit_offset_t m[N];    // highest bit in which vtbls differ
+    bit_offset_t z[N];    // lowest bits in which vtbls do not differ
+
+    for (size_t i = 0; i < N; ++i)
+    {
+        if (diff[i])  // We have to check for non-zero as trailing_zeros will return -127 for 0
+        {
+            m[i] = bit_offset_t(req_bits(diff[i])); // highest bit in which vtbls differ
+            z[i] = bit_offset_t(trailing_zeros(static_cast<unsigned int>(diff[i]))); // lowest bits in which vtbls do not differ.
+        }
+        else
+            m[i] = z[i] = dsc->optimal_shift[i];
+    }
+
+    size_t max_cache_entries = dsc->entries_for(vtbl, l1, dsc->optimal_shift);
+    array_copy(dsc->optimal_shift,zo); // Copy current solution as current optimal
+
+    // Iterate over allowed log sizes
+    for (bit_offset_t i = l1; i <= l2; ++i)
+    {
+        if (!P::hashing::shift_search)
+        {
+            // Only the log size is chosen, current shifts are kept
+            size_t entries = i == l1 ? max_cache_entries : dsc->entries_for(vtbl, i, zo);
+
+            if (entries > max_cache_entries)
+            {
+                max_cache_entries = entries;
+                no = i;
+            }
+
+            if (entries == dsc->used+1)
+                break; // No conflicts with this size
+
+            continue;
+        }
+
+        // Try to improve independently each argument position
+        for (size_t s = 0; s < N; ++s)
+        {
+            bit_offset_t bits_in_arg_mask = (i+N-1-s)/N;
+            bit_offset_t mm = m[s] > bits_in_arg_mask && m[s] - bits_in_arg_mask >= z[s] ? m[s] - bits_in_arg_mask : m[s];
+            bit_offset_t cur = zo[s];
+
+            for (bit_offset_t t = z[s]; t <= mm; ++t)
+            {
+                if (t != cur)
+                {
+                    zo[s] = t;
+
+                    size_t entries = dsc->entries_for(vtbl, i, zo); // Count the number of used entries
+
+                    // Update best estimates
+                    if (entries > max_cache_entries)
+                    {
+                        max_cache_entries = entries;
+                        no  = i;
+                        cur = t;
+
+                        if (entries == dsc->used+1)
+                        {
+                            // We found size and offset without conflicts, exit both loops
+                            i = l2+1; // to exit both for loops
+                            zo[s] = cur;
+                            goto break_of_both_loops;
+                        }
+                    }
+                }
+            }
+
+            zo[s] = cur;
+        } // of loop over argument positions
+
+break_of_both_loops: ;
+
+    } // of loop over possible log sizes
+
+    if (no < k)
+        no = k; // We never shrink, while we preallocate based on number of case clauses or the minimum
+
+    if (no != k || !array_equal(dsc->optimal_shift,zo))
+    {
+        // OK, either log size or optimal shifts changed. Reset collisions counter to default one
+        prev_collisions_before_update = collisions_before_update = case_clauses ? case_clauses : N*P::update::collisions();
+
+        #if defined(DBG_NEW)
+            #undef new
+        #endif
+        dsc = new(no) cache_descriptor(no,zo,*dsc);
+        #if defined(DBG_NEW)
+            #define new DBG_NEW
+        #endif
+
+        // Publish fully built descriptor. The old one becomes retired.
+        descriptor.store(dsc, std::memory_order_release);
+        XTL_STATIC_PROBES_ONLY(XTL_PROBE(descriptor_swap, this, vtbl[0]));
+    }
+    else
+    {
+        // Update hasn't changed anything, increase the number of colisions before next update
+        prev_collisions_before_update = collisions_before_update = prev_collisions_before_update*2;
+    }
+
+    stored_type* res = dsc->get(vtbl,dsc->cache_index(vtbl));
+    XTL_ASSERT(res && res->is_for(vtbl)); // We have ensured enough space, so no need to check this explicitly
+    last_table_size = dsc->used;          // Update memoized value
+
+#if XTL_VTBL_UPDATE_HISTOGRAM
+    record.cycles           = XTL_CYCLE_COUNTER() - start;
+    record.new_log_size     = req_bits(dsc->cache_mask);
+    record.collisions_after = dsc->displaced();
+    update_costs.record(record);
+#endif
+
+    return res->value;
+}
+
+//------------------------------------------------------------------------------
+
+#if XTL_DEFERRED_VTBL_UPDATES
+template <size_t N, typename T, typename P>
+bool vtbl_map<N,T,P>::rearrange()
+{
+    std::lock_guard<std::mutex> guard(update_mutex);
+
+    if (!pending_update)
+        return false;
+
+    const cache_descriptor* const dsc = descriptor.load(std::memory_order_relaxed);
+
+    // A synchronous update might have run since the request was made
+    if (dsc->used == last_table_size)
+        return pending_update = false;
+
+    // Rearrange for the vtbl pointers already in the cache: update() will 
+    // find the one it places and return its entry, which we don't need
+    for (size_t i = 0; i <= dsc->cache_mask; ++i)
+    {
+        const stored_type* st = dsc->cache[i].load(std::memory_order_relaxed);
+
+        if (st->occupied())
+        {
+            intptr_t vtbl[N];
+            array_copy(st->vtbl, vtbl);
+            update(vtbl);
+            return true;
+        }
+    }
+
+    return pending_update = false;
+}
+#endif
+
+//------------------------------------------------------------------------------
+
+#if XTL_DUMP_PERFORMANCE
+template <size_t N, typename T, typename P>
+std::ostream& vtbl_map<N,T,P>::operator>>(std::ostream& os) const
+{
+    std::lock_guard<std::mutex> guard(update_mutex);
+    const cache_descriptor* dsc = descriptor.load(std::memory_order_relaxed);
+
+    os << file << '[' << line << "]: " << func << std::endl
+       << "\tN=" << N << " used=" << dsc->used << " size=" << dsc->size()
+       << " clauses=" << case_clauses << " updates=" << updates
+       << " hits=" << hits.load() << " misses=" << misses << " collisions=" << collisions
+       << " shifts=";
+
+    for (size_t i = 0; i < N; ++i)
+        os << (i ? "," : "") << size_t(dsc->optimal_shift[i]);
+
+    os << std::endl;
+
+    for (size_t i = 0; i <= dsc->cache_mask; ++i)
+    {
+        const stored_type* st = dsc->cache[i].load(std::memory_order_relaxed);
+
+        if (st->occupied())
+        {
+            os << '\t' << std::setw(4) << i << (dsc->cache_index(st->vtbl) == i ? " " : "*");
+            vtbl_class_print(st->vtbl, os);
+            os << std::endl;
+        }
+    }
+
+    return os;
+}
+#endif
+
+//------------------------------------------------------------------------------
+
+} // of namespace mch
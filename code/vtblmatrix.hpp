@@ -0,0 +1,274 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file defines vtbl_matrix_policy of class vtbl_map<N,T,P>, under which 
+/// the vtbl pointer of each subject is mapped to a dense index of its class 
+/// and the values are kept in an N-dimensional matrix indexed by them.
+///
+/// To use it in Match statements on several subjects include this file and 
+/// define #XTL_VTBL_MAP_POLICY as mch::vtbl_matrix_policy before them.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#pragma once
+
+// --------------------[ Design Notes ]--------------------
+// - Hashing tuples of vtbl pointers into a single cache needs cache size of 
+//   the order of the product of the numbers of classes seen in each position,
+//   while the entries of classes that differ in a single position compete for
+//   the same bits of the key and thus collide. Instead each position has its 
+//   own vtbl_map<1,size_t> from vtbl pointer to the dense index of the class
+//   among those seen in that position so far, in the order of appearance.
+//   These caches only grow with the number of classes in their position and 
+//   their lookups are independent of each other.
+// - The matrix has power of 2 extent in each dimension, so the index of a 
+//   cell is the concatenation of bits of the dense indices. An extent doubles
+//   when a class beyond it appears in its position, which only re-lays out 
+//   pointers to the values: the values themselves never move, so references
+//   to them remain valid while a nested Match statement seeing a new class 
+//   grows the matrix.
+// - Cells of combinations not seen yet are null pointers: only the values 
+//   of the combinations actually seen are allocated.
+// - Not available with #XTL_MULTI_THREADING.
+//------------------------------------------------------------------------------
+
+#include "vtblmap4.hpp"
+#include <deque>
+#include <vector>
+
+#if XTL_MULTI_THREADING
+#error vtbl_matrix_policy is only available in single-threaded vtbl maps
+#endif
+
+namespace mch ///< Mach7 library namespace
+{
+
+//------------------------------------------------------------------------------
+
+/// Policy of vtbl_map<N,T,P> that indexes an N-dimensional matrix of values 
+/// with dense indices of classes of the subjects. \see vtblmatrix.hpp
+struct vtbl_matrix_policy {};
+
+//------------------------------------------------------------------------------
+
+/// This specialization is used when none of the arguments of Match-statement is polymorphic.
+template <typename T>
+class vtbl_map<0,T,vtbl_matrix_policy> : public vtbl_map<0,T,vtbl_map_policy<> >
+{
+public:
+    vtbl_map(XTL_VTBL_COUNTERS_ONLY(const char* file, size_t line, const char* func,) const vtbl_count_t& num_clauses)
+        : vtbl_map<0,T,vtbl_map_policy<> >(XTL_VTBL_COUNTERS_ONLY(file,line,func,) num_clauses) {}
+};
+
+//------------------------------------------------------------------------------
+
+/// Map of N polymorphic subjects to values of type T kept in a matrix 
+/// indexed by dense indices of their classes.
+template <size_t N, typename T>
+class vtbl_map<N,T,vtbl_matrix_policy> : public vtbl_map_subjects<vtbl_map<N,T,vtbl_matrix_policy>,T>
+{
+private:
+
+    /// Cache of dense indices of classes seen in one position. The index is
+    /// stored plus one, so that 0 means not yet seen.
+    struct class_index_map : vtbl_map<1,size_t>
+    {
+        class_index_map() : vtbl_map<1,size_t>(XTL_VTBL_COUNTERS_ONLY("vtbl_matrix", 0, "class index",) unknown_clauses) {}
+        static const vtbl_count_t unknown_clauses;
+    };
+
+    /// Value with dense indices of its cell in the matrix
+    struct cell
+    {
+        T      value;
+        size_t index[N];
+    };
+
+public:
+
+#if XTL_VTBL_COUNTERS
+    vtbl_map(const char*, size_t, const char*, const vtbl_count_t& num_clauses) : cells(1,nullptr) { init(num_clauses); }
+#endif
+    vtbl_map(const vtbl_count_t& num_clauses) : cells(1,nullptr) { init(num_clauses); }
+
+    /// Main function that will be used to get a reference to the stored element. 
+    inline T& get(const intptr_t (&vtbl)[N]) noexcept
+    {
+        size_t index[N];
+
+        // Indices first, since a new class may grow the matrix
+        for (size_t i = 0; i < N; ++i)
+        {
+            const intptr_t v[1] = {vtbl[i]};
+            size_t& c = classes[i].get(v);
+
+            if (XTL_UNLIKELY(!c))
+                c = enumerate(i,vtbl[i]);
+
+            index[i] = c-1;
+        }
+
+        cell*& p = cells[cell_index(index)];
+
+        if (XTL_UNLIKELY(!p))
+        {
+            values.emplace_back();
+            p = &values.back();
+            std::copy(&index[0], &index[N], p->index);
+        }
+
+        return p->value;
+    }
+
+    // Lookups by subjects are inherited from vtbl_map_subjects
+    using vtbl_map_subjects<vtbl_map<N,T,vtbl_matrix_policy>,T>::get;
+    using vtbl_map_subjects<vtbl_map<N,T,vtbl_matrix_policy>,T>::xtl_get;
+
+    /// Looks up values associated with dynamic types of n subjects. \see vtbl_map::get_batch
+    template <typename S>
+    void get_batch(const S* const* subjects, size_t n, T** out) noexcept
+    {
+        for (size_t i = 0; i < n; ++i)
+            out[i] = &get(subjects[i]);
+    }
+
+    /// Issues prefetches for the objects beyond the batch get_batch() is about
+    /// to look up. \see vtbl_map::prefetch_batch
+    template <typename S>
+    void prefetch_batch(const S* const* subjects, size_t n) const noexcept
+    {
+        for (size_t j = XTL_BATCH_SIZE; j < n && j < 2*XTL_BATCH_SIZE; ++j)
+            XTL_PREFETCH(subjects[j]);
+    }
+
+    /// Calls f(vtbl,value) for each tuple of vtbl pointers in the map.
+    template <typename F>
+    void for_each(F f) const
+    {
+        intptr_t vtbl[N];
+
+        for (typename std::deque<cell>::const_iterator p = values.begin(); p != values.end(); ++p)
+        {
+            for (size_t i = 0; i < N; ++i)
+                vtbl[i] = vtbls[i][p->index[i]];
+
+            f(vtbl, p->value);
+        }
+    }
+
+    /// Log of the number of cells in the matrix
+    size_t log_size() const { size_t k = 0; for (size_t i = 0; i < N; ++i) k += log_extent[i]; return k; }
+
+    /// The matrix does not keep the site of its Match statement. \see vtbl_map::locate
+    XTL_VTBL_COUNTERS_ONLY(bool locate(const char*, size_t, const char*) { return true; })
+
+    /// Log of the extent of the matrix in dimension i
+    bit_offset_t shift(size_t i) const { return log_extent[i]; }
+
+    /// Memory in bytes used by the matrix and its values, not counting the caches of class indices
+    size_t memory_used() const { return cells.size()*sizeof(cell*) + values.size()*sizeof(cell); }
+
+private:
+
+    vtbl_map(const vtbl_map&);            ///< No copy constructor
+    vtbl_map& operator=(const vtbl_map&); ///< No assignment operator
+
+    /// The number of case clauses isn't needed: the matrix grows with classes
+    void init(const vtbl_count_t&) { std::fill(&log_extent[0], &log_extent[N], bit_offset_t(0)); }
+
+    /// Index of the cell with given dense indices of classes
+    size_t cell_index(const size_t (&index)[N]) const noexcept
+    {
+        size_t k = index[0];
+
+        for (size_t i = 1; i < N; ++i)
+            k = (k << log_extent[i]) | index[i];
+
+        return k;
+    }
+
+    /// Gives the next dense index to the class with vtbl in position i, 
+    /// growing the matrix when needed, and returns it plus one.
+    size_t enumerate(size_t i, intptr_t vtbl);
+
+    /// Caches of dense indices of classes in each position
+    class_index_map classes[N];
+
+    /// Vtbl pointers of classes in each position in the order of their indices
+    std::vector<intptr_t> vtbls[N];
+
+    /// Log of the extent of the matrix in each dimension
+    bit_offset_t log_extent[N];
+
+    /// The matrix with pointers to values or null pointers for not seen combinations
+    std::vector<cell*> cells;
+
+    /// The values, which never move
+    std::deque<cell> values;
+};
+
+//------------------------------------------------------------------------------
+
+template <size_t N, typename T>
+const vtbl_count_t vtbl_map<N,T,vtbl_matrix_policy>::class_index_map::unknown_clauses = 0;
+
+//------------------------------------------------------------------------------
+
+template <size_t N, typename T>
+size_t vtbl_map<N,T,vtbl_matrix_policy>::enumerate(size_t i, intptr_t vtbl)
+{
+    vtbls[i].push_back(vtbl);
+
+    if (vtbls[i].size() > (size_t(1) << log_extent[i]))
+    {
+        // Double the extent in dimension i and re-lay out pointers to values
+        ++log_extent[i];
+        cells.assign(size_t(1) << log_size(), nullptr);
+
+        for (typename std::deque<cell>::iterator p = values.begin(); p != values.end(); ++p)
+            cells[cell_index(p->index)] = &*p;
+    }
+
+    return vtbls[i].size();
+}
+
+//------------------------------------------------------------------------------
+
+} // of namespace mch
@@ -0,0 +1,592 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file defines class type_profile that lets Match statements save the
+/// jump targets and this-pointer offsets they have learned for combinations 
+/// of dynamic types of their subjects and reload them on the next run of the
+/// program to avoid paying for the learning again.
+///
+/// \note This file is not meant to be included directly. It is included by
+///       type_switchN*.hpp when #XTL_TYPE_PROFILE is enabled.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#pragma once
+
+// --------------------[ Design Notes ]--------------------
+// - Vtbl pointers are not stable between runs of the program, so the profile
+//   identifies dynamic types of polymorphic subjects by std::type_info::name()
+//   of each of them. Jump targets and this-pointer offsets are stable as long
+//   as the profile is loaded by the same build of the program that saved it.
+// - Match statements are identified by file, line, function and the static
+//   types of their subjects. The latter distinguishes instantiations of the
+//   same Match statement in a template, for which offsets may differ.
+// - A Match statement enrolls with the profile the first time it is executed.
+//   At that moment all the records for it, whose type names can be mapped to
+//   vtbl pointers seen so far (in any Match statement or via learn()), are 
+//   put into its vtbl_map before the first lookup. The remaining records are
+//   recalled lazily: when a new combination of vtbl pointers is seen, its type
+//   names are looked up among the records instead of trying case clauses.
+// - Type names seen with more than one vtbl pointer (e.g. through different
+//   base class sub-objects of the same class) are not used for preloading.
+// - The log size and shifts of each cache are saved for inspection only, 
+//   since their optimal values depend on the actual vtbl pointers.
+// - All the operations are serialized by a mutex. They are only performed on
+//   the first execution of each Match statement and when a new combination of
+//   vtbl pointers is seen, never on the hot path.
+// - Since nothing in a profile depends on addresses, profiles saved by the 
+//   same build on different hosts can be merged into one for all of them, 
+//   \see test/time/merge_profiles.cpp.
+//------------------------------------------------------------------------------
+
+#include "vtblmap4.hpp"
+#include <algorithm>
+#include <istream>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+namespace mch ///< Mach7 library namespace
+{
+
+//------------------------------------------------------------------------------
+
+/// Jump target and this-pointer offsets recorded for a combination of dynamic
+/// types of polymorphic subjects of a Match statement.
+struct type_profile_record
+{
+    std::vector<std::string>    names;   ///< std::type_info::name() of dynamic types of polymorphic subjects
+    std::vector<std::ptrdiff_t> offsets; ///< Required this-pointer offsets to the target sub-objects
+    std::size_t                 target;  ///< Case label of the jump target of Match statement
+};
+
+/// Records of Match statements by their keys
+typedef std::map<std::string,std::vector<type_profile_record>> type_profile_records;
+
+//------------------------------------------------------------------------------
+
+/// Adds records from src to dst, replacing the ones for the same types
+inline void merge_type_profile_records(std::vector<type_profile_record>& dst, const std::vector<type_profile_record>& src)
+{
+    for (size_t i = 0; i < src.size(); ++i)
+    {
+        size_t j = 0;
+
+        while (j < dst.size() && dst[j].names != src[i].names)
+            ++j;
+
+        if (j < dst.size())
+            dst[j] = src[i];
+        else
+            dst.push_back(src[i]);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+/// Reads records saved by type_profile::save() into loaded. Returns false on 
+/// malformed input, in which case the records read up to the error are kept.
+inline bool read_type_profile(std::istream& is, type_profile_records& loaded)
+{
+    std::string line;
+    std::string key;
+    size_t      n = 0;
+
+    while (std::getline(is, line))
+    {
+        if (!line.empty() && line[line.size()-1] == '\r')
+            line.erase(line.size()-1); // Profile might have been edited on another platform
+
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        std::vector<std::string> fields;
+        std::istringstream       ss(line);
+
+        for (std::string f; std::getline(ss, f, '\t');)
+            fields.push_back(f);
+
+        if (fields[0] == "site" && fields.size() >= 7)
+        {
+            size_t m = 0;
+            std::istringstream(fields[1]) >> n;
+            std::istringstream(fields[2]) >> m;
+
+            if (fields.size() != 6 + m + n + 1)
+                return false;
+
+            key = fields[3];
+
+            for (size_t i = 4; i < 6 + m; ++i)
+                key += '\t' + fields[i];
+
+            loaded[key];
+        }
+        else
+        if (fields[0] == "case" && !key.empty() && fields.size() == 2 + 2*n)
+        {
+            type_profile_record rec;
+            std::istringstream(fields[1]) >> rec.target;
+
+            for (size_t i = 0; i < n; ++i)
+            {
+                std::ptrdiff_t offset = 0;
+                std::istringstream(fields[2+2*i]) >> offset;
+                rec.offsets.push_back(offset);
+                rec.names.push_back(fields[3+2*i]);
+            }
+
+            if (rec.target == 0)
+                return false;
+
+            loaded[key].push_back(rec);
+        }
+        else
+            return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+
+/// Writes site line of a Match statement with given key and its records in the
+/// format of type_profile::save() for a Match statement that has not run yet
+inline void write_type_profile_site(std::ostream& os, const std::string& key, const std::vector<type_profile_record>& records)
+{
+    if (records.empty())
+        return;
+
+    const size_t n = records[0].names.size();
+    const size_t m = std::count(key.begin(), key.end(), '\t') - 2; // File, line and function are followed by static types of subjects
+
+    os << "site\t" << n << '\t' << m << '\t' << key << '\t' << 0;
+
+    for (size_t k = 0; k < n; ++k)
+        os << '\t' << 0;
+
+    os << '\n';
+
+    for (size_t j = 0; j < records.size(); ++j)
+    {
+        os << "case\t" << records[j].target;
+
+        for (size_t k = 0; k < n; ++k)
+            os << '\t' << records[j].offsets[k] << '\t' << records[j].names[k];
+
+        os << '\n';
+    }
+}
+
+//------------------------------------------------------------------------------
+
+/// Match statement enrolled with #type_profile
+class type_profile_site
+{
+public:
+
+    type_profile_site(const std::string& k, size_t n) : key(k), subjects(n) {}
+    virtual ~type_profile_site() {}
+
+    /// Writes site line and records of all the entries in the map
+    virtual void save(std::ostream& os) const = 0;
+
+    /// Puts into the map all the records whose type names are associated with 
+    /// unique vtbl pointers in vtbls.
+    virtual void preload(const std::map<std::string,std::intptr_t>& vtbls) = 0;
+
+    const std::string                key;      ///< File, line, function and static types of subjects separated by tabs
+    const size_t                     subjects; ///< Number of subjects of the Match statement
+    std::vector<type_profile_record> records;  ///< Records loaded for this Match statement
+
+private:
+
+    type_profile_site(const type_profile_site&);            ///< No copy constructor
+    type_profile_site& operator=(const type_profile_site&); ///< No assignment operator
+};
+
+//------------------------------------------------------------------------------
+
+/// Match statement on N polymorphic subjects enrolled with #type_profile
+template <size_t N, typename P = vtbl_map_policy<> >
+class type_profile_site_for : public type_profile_site
+{
+public:
+
+    typedef type_switch_info<N>         info_type;
+    typedef vtbl_map<N,info_type,P>     map_type;
+
+    type_profile_site_for(const std::string& k, size_t n, map_type& m) : type_profile_site(k,n), map(m) {}
+
+    virtual void save(std::ostream& os) const;
+    virtual void preload(const std::map<std::string,std::intptr_t>& vtbls);
+
+    /// Fills info from the record for the type names of vtbl, if there is one
+    bool recall(info_type& info, const intptr_t (&vtbl)[N]) const;
+
+private:
+
+    /// Sets offsets and target of info from the record unless already set
+    static void assign(info_type& info, const type_profile_record& rec)
+    {
+        if (info.target == 0)
+        {
+            // Offsets must be set before target to be seen by other threads
+            for (size_t i = 0; i < N; ++i)
+                info.offset[i] = rec.offsets[i];
+
+            info.target = rec.target;
+        }
+    }
+
+    map_type& map; ///< vtbl map of the Match statement
+};
+
+//------------------------------------------------------------------------------
+
+/// Registry of Match statements and of their type profiles.
+///
+/// Typical use is to call type_profile::load() at the beginning of main()
+/// (and optionally type_profile::learn() on some prototype objects to let 
+/// Match statements be preloaded on their first execution) and then to call
+/// type_profile::save() after a representative workload.
+class type_profile
+{
+public:
+
+    /// Writes records of all the Match statements enrolled or loaded so far
+    static void save(std::ostream& os);
+
+    /// Reads records saved by save(). Returns false on malformed input, in 
+    /// which case the records read up to the error are kept.
+    static bool load(std::istream& is);
+
+    /// Associates type name of the polymorphic object pointed to by p with its
+    /// vtbl pointer and preloads enrolled Match statements with records now 
+    /// having all the type names known.
+    static void learn(const void* p);
+
+    /// Enrolls Match statement with given vtbl map. The subjects are only
+    /// used to determine their static types.
+    template <size_t N, typename T, typename P, typename... S>
+    static type_profile_site_for<N,P>* enroll(vtbl_map<N,T,P>& map, const char* file, size_t line, const char* func, const S*... subjects);
+
+    /// No need to enroll Match statements without polymorphic subjects
+    template <typename T, typename P, typename... S>
+    static type_profile_site_for<0,P>* enroll(vtbl_map<0,T,P>&, const char*, size_t, const char*, const S*...) { return nullptr; }
+
+    /// Called by Match statement when info for the vtbl pointers of its 
+    /// subjects has not been set yet.
+    template <size_t N, typename P, typename T, typename... S>
+    static void recall(const type_profile_site_for<N,P>* site, T& info, const S*... subjects);
+
+    template <typename P, typename T, typename... S>
+    static void recall(const type_profile_site_for<0,P>*, T&, const S*...) {}
+
+private:
+
+    struct state
+    {
+       ~state() { for (size_t i = 0; i < sites.size(); ++i) delete sites[i]; }
+
+        std::mutex                                              mutex;   ///< Serializes all the operations
+        std::vector<type_profile_site*>                         sites;   ///< Enrolled Match statements
+        std::map<std::string,std::vector<type_profile_record>>  loaded;  ///< Loaded records by site key
+        std::map<std::string,std::intptr_t>                     vtbls;   ///< Vtbl pointers by type name, 0 when ambiguous
+    };
+
+    static state& get_state() { static state s; return s; }
+
+    /// Remembers vtbl under its type name. Returns true if the name is new.
+    static bool remember(state& s, std::intptr_t vtbl)
+    {
+        const char* name = vtbl_typeid(vtbl).name();
+        std::map<std::string,std::intptr_t>::iterator p = s.vtbls.find(name);
+
+        if (p == s.vtbls.end())
+        {
+            s.vtbls[name] = vtbl;
+            return true;
+        }
+
+        if (p->second != vtbl)
+            p->second = 0; // Ambiguous - can't be used for preloading
+
+        return false;
+    }
+
+    template <typename S> static void collect_one(std::intptr_t*& v, const S* s, std::true_type)  { *v++ = vtbl_of(s); }
+    template <typename S> static void collect_one(std::intptr_t*&,   const S*,   std::false_type) {}
+
+    /// Writes vtbl pointers of polymorphic subjects into v
+    static void collect(std::intptr_t*) {}
+    template <typename S, typename... R>
+    static void collect(std::intptr_t* v, const S* s, const R*... r)
+    {
+        collect_one(v, s, std::integral_constant<bool,std::is_polymorphic<S>::value>());
+        collect(v, r...);
+    }
+
+    static void key_of(std::string&) {}
+    template <typename S, typename... R>
+    static void key_of(std::string& key, const S*, const R*... r)
+    {
+        key += '\t';
+        key += typeid(S).name();
+        key_of(key, r...);
+    }
+};
+
+//------------------------------------------------------------------------------
+
+template <size_t N, typename P>
+void type_profile_site_for<N,P>::save(std::ostream& os) const
+{
+    os << "site\t" << N << '\t' << subjects << '\t' << key << '\t' << map.log_size();
+
+    for (size_t i = 0; i < N; ++i)
+        os << '\t' << map.shift(i);
+
+    os << '\n';
+
+    std::vector<std::vector<std::string>> saved;
+
+    map.for_each([&os,&saved](const intptr_t (&vtbl)[N], const info_type& info)
+    {
+        if (const size_t target = info.target)
+        {
+            std::vector<std::string> names(N);
+
+            os << "case\t" << target;
+
+            for (size_t i = 0; i < N; ++i)
+            {
+                names[i] = vtbl_typeid(vtbl[i]).name();
+                os << '\t' << std::ptrdiff_t(info.offset[i]) << '\t' << names[i];
+            }
+
+            os << '\n';
+            saved.push_back(names);
+        }
+    });
+
+    // Keep the records for types not seen during this run
+    for (size_t j = 0; j < records.size(); ++j)
+        if (std::find(saved.begin(), saved.end(), records[j].names) == saved.end())
+        {
+            os << "case\t" << records[j].target;
+
+            for (size_t i = 0; i < N; ++i)
+                os << '\t' << records[j].offsets[i] << '\t' << records[j].names[i];
+
+            os << '\n';
+        }
+}
+
+//------------------------------------------------------------------------------
+
+template <size_t N, typename P>
+void type_profile_site_for<N,P>::preload(const std::map<std::string,std::intptr_t>& vtbls)
+{
+    for (size_t j = 0; j < records.size(); ++j)
+    {
+        intptr_t vtbl[N];
+        size_t   i = 0;
+
+        for (; i < N; ++i)
+        {
+            std::map<std::string,std::intptr_t>::const_iterator p = vtbls.find(records[j].names[i]);
+
+            if (p == vtbls.end() || p->second == 0)
+                break;
+
+            vtbl[i] = p->second;
+        }
+
+        if (i == N)
+            assign(map.get(vtbl), records[j]);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+template <size_t N, typename P>
+bool type_profile_site_for<N,P>::recall(info_type& info, const intptr_t (&vtbl)[N]) const
+{
+    if (records.empty())
+        return false;
+
+    const char* names[N];
+
+    for (size_t i = 0; i < N; ++i)
+        names[i] = vtbl_typeid(vtbl[i]).name();
+
+    for (size_t j = 0; j < records.size(); ++j)
+    {
+        size_t i = 0;
+
+        while (i < N && records[j].names[i] == names[i])
+            ++i;
+
+        if (i == N)
+        {
+            assign(info, records[j]);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//------------------------------------------------------------------------------
+
+inline void type_profile::save(std::ostream& os)
+{
+    state& s = get_state();
+    std::lock_guard<std::mutex> guard(s.mutex);
+
+    os << "# Mach7 type profile\n";
+
+    for (size_t i = 0; i < s.sites.size(); ++i)
+        s.sites[i]->save(os);
+
+    // Keep the records of Match statements not executed during this run
+    for (std::map<std::string,std::vector<type_profile_record>>::const_iterator p = s.loaded.begin(); p != s.loaded.end(); ++p)
+    {
+        size_t i = 0;
+
+        while (i < s.sites.size() && s.sites[i]->key != p->first)
+            ++i;
+
+        if (i < s.sites.size() || p->second.empty())
+            continue;
+
+        write_type_profile_site(os, p->first, p->second);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+inline bool type_profile::load(std::istream& is)
+{
+    state& s = get_state();
+    std::lock_guard<std::mutex> guard(s.mutex);
+
+    type_profile_records loaded;
+    const bool           good = read_type_profile(is, loaded);
+
+    for (std::map<std::string,std::vector<type_profile_record>>::const_iterator p = loaded.begin(); p != loaded.end(); ++p)
+    {
+        merge_type_profile_records(s.loaded[p->first], p->second);
+
+        for (size_t i = 0; i < s.sites.size(); ++i)
+            if (s.sites[i]->key == p->first)
+            {
+                merge_type_profile_records(s.sites[i]->records, p->second);
+                s.sites[i]->preload(s.vtbls);
+            }
+    }
+
+    return good;
+}
+
+//------------------------------------------------------------------------------
+
+inline void type_profile::learn(const void* p)
+{
+    state& s = get_state();
+    std::lock_guard<std::mutex> guard(s.mutex);
+
+    if (remember(s, vtbl_of(p)))
+        for (size_t i = 0; i < s.sites.size(); ++i)
+            s.sites[i]->preload(s.vtbls);
+}
+
+//------------------------------------------------------------------------------
+
+template <size_t N, typename T, typename P, typename... S>
+type_profile_site_for<N,P>* type_profile::enroll(vtbl_map<N,T,P>& map, const char* file, size_t line, const char* func, const S*... subjects)
+{
+    std::ostringstream ss;
+    ss << file << '\t' << line << '\t' << func;
+    std::string key = ss.str();
+    key_of(key, subjects...);
+
+    state& s = get_state();
+    std::lock_guard<std::mutex> guard(s.mutex);
+
+    type_profile_site_for<N,P>* site = new type_profile_site_for<N,P>(key, sizeof...(S), map);
+    s.sites.push_back(site);
+
+    std::map<std::string,std::vector<type_profile_record>>::const_iterator p = s.loaded.find(key);
+
+    if (p != s.loaded.end())
+    {
+        merge_type_profile_records(site->records, p->second);
+        site->preload(s.vtbls);
+    }
+
+    return site;
+}
+
+//------------------------------------------------------------------------------
+
+template <size_t N, typename P, typename T, typename... S>
+void type_profile::recall(const type_profile_site_for<N,P>* site, T& info, const S*... subjects)
+{
+    intptr_t vtbl[N];
+    collect(vtbl, subjects...);
+
+    state& s = get_state();
+    std::lock_guard<std::mutex> guard(s.mutex);
+
+    for (size_t i = 0; i < N; ++i)
+        remember(s, vtbl[i]);
+
+    site->recall(info, vtbl);
+}
+
+//------------------------------------------------------------------------------
+
+} // of namespace mch
@@ -0,0 +1,297 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+///
+/// \file
+///
+/// This file defines class reader_epochs, which tracks the epochs threads
+/// reading shared vtbl maps have seen, and class retired_list<D> of descriptors
+/// replaced in such maps that are deallocated once no thread can be reading them.
+///
+/// \note This file is not meant to be included directly. It is included by
+///       vtblmap3mt.hpp when #XTL_RECLAIM_DESCRIPTORS is enabled.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#pragma once
+
+// --------------------[ Design Notes ]--------------------
+// - This is a quiescent-state based scheme with a global epoch. A descriptor
+//   is retired after it has been replaced, at which point the epoch advances
+//   to E. Every thread owns a record into which, each time it leaves a shared
+//   map, it copies the epoch it sees. The descriptor can be deallocated once
+//   every live thread has copied an epoch of at least E.
+// - A thread that copied E has read the epoch after it advanced, and thus
+//   after the descriptor was replaced, so none of its later lookups can load
+//   the replaced descriptor. Its earlier lookups are done with it, since the
+//   copy is a release store. Copying a counter of passes instead would not do:
+//   a bump can be delayed in the store buffer past the loads of the next 
+//   lookup, which may then load the descriptor that is about to be replaced.
+// - Leaving a map is thus a load of a read-mostly epoch and a release store 
+//   to a record only its thread writes. The hit path performs neither 
+//   read-modify-write operations nor fences. All the synchronization is paid
+//   by the update path that retires and reclaims descriptors.
+// - A thread registers on its first lookup, before it loads any descriptor, 
+//   copying the epoch with sequentially consistent operations. A reclaimer 
+//   that misses such a thread in the list of records thus has advanced the
+//   epoch before the thread read it.
+// - A thread that stopped dispatching holds back reclamation until it 
+//   dispatches again or exits. Descriptors that cannot be reclaimed earlier 
+//   are deallocated with their map, as they were without reclamation.
+// - Retiring and reclaiming descriptors of a map are serialized by a mutex.
+//   Reclamation is only attempted when the mutex is free, so updates never
+//   wait for each other because of it.
+// - Records are never deallocated. A record of an exited thread is reused by
+//   the next thread that registers, so there are never more records than the
+//   largest number of threads that were ever alive at the same time.
+//------------------------------------------------------------------------------
+
+#include "config.hpp"    // Various compiler/platform dependent macros
+#include <atomic>
+#include <mutex>
+
+#if !XTL_SUPPORT(thread_local)
+#error XTL_RECLAIM_DESCRIPTORS requires compiler support of thread_local storage duration
+#endif
+
+namespace mch ///< Mach7 library namespace
+{
+
+//------------------------------------------------------------------------------
+
+/// Epochs seen by all the threads reading shared vtbl maps
+class reader_epochs
+{
+public:
+
+    /// Record of a single thread
+    struct record
+    {
+        record() : seen(0), in_use(true), next(nullptr) {}
+
+        std::atomic<size_t> seen;   ///< Epoch its thread saw when it last left a map
+        std::atomic<bool>   in_use; ///< Whether a live thread owns the record
+        record*             next;   ///< Next record in the list of all records
+    };
+
+    /// Record of the calling thread, registering it on the first call. Must be
+    /// called before the thread loads a descriptor.
+    static record& enter() noexcept
+    {
+        static thread_local owner o;
+        return *o.rec;
+    }
+
+    /// Marks the end of a read of a shared map by the thread owning r
+    static void leave(record& r) noexcept
+    {
+        r.seen.store(epoch().load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    /// Starts a new epoch and returns it. Must be called after the descriptor
+    /// being retired has been replaced.
+    static size_t advance() noexcept
+    {
+        return epoch().fetch_add(1) + 1;
+    }
+
+    /// Whether every live thread has left a map in epoch e or later
+    static bool passed(size_t e) noexcept
+    {
+        for (const record* r = head().load(); r; r = r->next)
+            if (r->in_use.load() && r->seen.load(std::memory_order_acquire) < e)
+                return false;
+
+        return true;
+    }
+
+private:
+
+    /// Owner of the record of the calling thread, which releases it on exit
+    struct owner
+    {
+        owner() : rec(acquire()) { rec->seen.store(epoch().load()); }
+       ~owner() { rec->in_use.store(false); }
+        record* rec;
+    };
+
+    /// Reuses record of an exited thread or registers a new one
+    static record* acquire()
+    {
+        for (record* r = head().load(); r; r = r->next)
+        {
+            bool free = false;
+
+            if (r->in_use.compare_exchange_strong(free, true))
+                return r;
+        }
+
+        record* r = new record;
+        r->next = head().load();
+
+        while (!head().compare_exchange_weak(r->next, r))
+            ;
+
+        return r;
+    }
+
+    /// The current epoch
+    static std::atomic<size_t>& epoch() noexcept
+    {
+        static std::atomic<size_t> e(0);
+        return e;
+    }
+
+    /// List of all the records ever registered
+    static std::atomic<record*>& head() noexcept
+    {
+        static std::atomic<record*> h(nullptr);
+        return h;
+    }
+};
+
+/// Registers the calling thread's read of a shared map when constructed and
+/// marks its end when it goes out of scope, which covers all the exits of a
+/// lookup.
+class reader_pass
+{
+public:
+    reader_pass() noexcept : rec(reader_epochs::enter()) {}
+   ~reader_pass() { reader_epochs::leave(rec); }
+private:
+    reader_epochs::record& rec;
+};
+
+//------------------------------------------------------------------------------
+
+/// Descriptors of type D replaced in a shared map, each with the epoch that
+/// started when it was retired. D must be deletable and
+/// have member memory_used().
+template <typename D>
+class retired_list
+{
+public:
+
+    retired_list() : m_head(nullptr) {}
+   ~retired_list() { while (m_head) pop(); }
+
+    /// Retires descriptor already replaced in the map
+    void retire(D* d)
+    {
+        item* i = new item(d, reader_epochs::advance(), nullptr);
+        std::lock_guard<std::mutex> guard(m_mutex);
+        i->next = m_head.load(std::memory_order_relaxed);
+        m_head.store(i, std::memory_order_relaxed);
+    }
+
+    /// Deallocates descriptors no thread can be reading anymore. Gives up when
+    /// another thread is already busy with the list.
+    void reclaim() noexcept
+    {
+        std::unique_lock<std::mutex> guard(m_mutex, std::try_to_lock);
+
+        if (!guard.owns_lock())
+            return;
+
+        item*  kept = nullptr;
+        item** tail = &kept;
+
+        for (item* i = m_head.load(std::memory_order_relaxed), *n; i; i = n)
+        {
+            n = i->next;
+
+            if (reader_epochs::passed(i->epoch))
+            {
+                delete i->descriptor;
+                delete i;
+            }
+            else
+            {
+                *tail = i;
+                tail = &i->next;
+            }
+        }
+
+        *tail = nullptr;
+        m_head.store(kept, std::memory_order_relaxed);
+    }
+
+    /// Whether there are descriptors to reclaim. Only a hint under concurrent updates.
+    bool empty() const noexcept { return !m_head.load(std::memory_order_relaxed); }
+
+    /// Number of bytes used by the list and descriptors it holds
+    size_t memory_used() const
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        size_t result = 0;
+
+        for (const item* i = m_head.load(std::memory_order_relaxed); i; i = i->next)
+            result += sizeof(item) + i->descriptor->memory_used();
+
+        return result;
+    }
+
+private:
+
+    struct item
+    {
+        item(D* d, size_t e, item* n) : descriptor(d), epoch(e), next(n) {}
+
+        D*     descriptor; ///< Replaced descriptor
+        size_t epoch;      ///< Epoch started when it was retired
+        item*  next;       ///< Descriptor retired before
+    };
+
+    void pop() noexcept
+    {
+        item* i = m_head.load(std::memory_order_relaxed);
+        m_head.store(i->next, std::memory_order_relaxed);
+        delete i->descriptor;
+        delete i;
+    }
+
+    retired_list(const retired_list&);            ///< No copy constructor
+    retired_list& operator=(const retired_list&); ///< No assignment operator
+
+    std::atomic<item*> m_head;  ///< Most recently retired descriptor
+    mutable std::mutex m_mutex; ///< Serializes retiring and reclaiming
+};
+
+//------------------------------------------------------------------------------
+
+} // of namespace mch
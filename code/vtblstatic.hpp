@@ -0,0 +1,235 @@
+//
+//  Mach7: Pattern Matching Library for C++
+//
+//  Copyright 2011-2013, Texas A&M University.
+//  Copyright 2014 Yuriy Solodkyy.
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//
+//      * Neither the names of Mach7 project nor the names of its contributors
+//        may be used to endorse or promote products derived from this software
+//        without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+//  IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// \file
+///
+/// This file defines vtbl_static_policy of class vtbl_map<N,T,P>, under which
+/// the map keeps its entries in storage of fixed capacity inside the map 
+/// object itself, thus never allocating memory.
+///
+/// \note This file is included by vtblmap4.hpp when #XTL_STATIC_VTBL_MAPS is
+///       enabled. It can also be included directly to use the policy only for
+///       some Match statements via #XTL_VTBL_MAP_POLICY.
+///
+/// \author Yuriy Solodkyy <yuriy.solodkyy@gmail.com>
+///
+/// \see https://parasol.tamu.edu/mach7/
+/// \see https://github.com/solodon4/Mach7
+/// \see https://github.com/solodon4/SELL
+///
+
+#pragma once
+
+// --------------------[ Design Notes ]--------------------
+// - Vtbl maps of Match statements are function-local statics, so entries that
+//   are members of the map are reserved statically: in the zero-initialized 
+//   data of the program, constructed on the first execution of the statement.
+// - There is no rearrangement: the cache index is computed with the default 
+//   #irrelevant_bits and collisions are resolved by a linear walk of at most
+//   Probes entries, which also bounds the time of a lookup.
+// - When the walk finds neither the vtbl pointers nor a vacant entry, the map
+//   returns a value reset to T(). The Match statement then runs its case 
+//   clauses sequentially, as on the first execution, and whatever it records
+//   in the value is overwritten by the next such lookup.
+// - sizeof of each map is known at compile time. With #XTL_STATIC_VTBL_REPORT 
+//   the compiler reports it for each Match statement in a deprecation warning,
+//   while mch::static_vtbl_bytes() gives at run time the total for the maps
+//   constructed so far.
+// - Not available with #XTL_MULTI_THREADING or #XTL_VTBL_INVALIDATION, as the
+//   maps are not registered anywhere.
+//------------------------------------------------------------------------------
+
+#include "vtblmap4.hpp"
+
+#if XTL_MULTI_THREADING
+#error vtbl_static_policy is only available in single-threaded vtbl maps
+#endif
+
+#if XTL_VTBL_INVALIDATION
+#error vtbl_static_policy is not available with invalidation of vtbl maps
+#endif
+
+namespace mch ///< Mach7 library namespace
+{
+
+//------------------------------------------------------------------------------
+
+/// Policy of vtbl_map<N,T,P> that keeps up to 2^LogSize tuples of vtbl pointers
+/// in statically reserved storage, trying at most Probes entries per lookup.
+template <size_t LogSize = XTL_MAX_LOG_SIZE, size_t Probes = 8>
+struct vtbl_static_policy
+{
+    enum { log_size = LogSize }; ///< Log of the capacity
+    enum { probes   = Probes < (size_t(1) << LogSize) ? Probes : (size_t(1) << LogSize) }; ///< Entries to try before giving up
+};
+
+//------------------------------------------------------------------------------
+
+/// Total number of bytes reserved by vtbl maps with static storage constructed so far
+inline size_t& static_vtbl_bytes() { static size_t bytes = 0; return bytes; }
+
+#if XTL_STATIC_VTBL_REPORT
+/// Uses of this function make the compiler report Bytes in the instantiation 
+/// context of the deprecation warning.
+template <size_t Bytes>
+XTL_DEPRECATED("Bytes is the number of bytes reserved by a vtbl map with static storage")
+inline void static_vtbl_bytes_reserved() {}
+#endif
+
+//------------------------------------------------------------------------------
+
+/// This specialization is used when none of the arguments of Match-statement is polymorphic.
+template <typename T, size_t L, size_t K>
+class vtbl_map<0,T,vtbl_static_policy<L,K> > : public vtbl_map<0,T,vtbl_map_policy<> >
+{
+public:
+    vtbl_map(XTL_VTBL_COUNTERS_ONLY(const char* file, size_t line, const char* func,) const vtbl_count_t& num_clauses)
+        : vtbl_map<0,T,vtbl_map_policy<> >(XTL_VTBL_COUNTERS_ONLY(file,line,func,) num_clauses) {}
+};
+
+//------------------------------------------------------------------------------
+
+/// Map of N polymorphic subjects to values of type T with statically reserved
+/// storage for up to 2^L tuples of vtbl pointers.
+template <size_t N, typename T, size_t L, size_t K>
+class vtbl_map<N,T,vtbl_static_policy<L,K> > : public vtbl_map_subjects<vtbl_map<N,T,vtbl_static_policy<L,K> >,T>
+{
+private:
+
+    typedef vtbl_static_policy<L,K> policy;
+
+    /// Type of the stored values, which is a pair of vtbl-pointer and T value.
+    typedef stored_type_for<N,T> stored_type;
+
+    enum { cache_mask = (size_t(1) << L) - 1 };
+
+public:
+
+#if XTL_VTBL_COUNTERS
+    vtbl_map(const char*, size_t, const char*, const vtbl_count_t& num_clauses) : used(0) { init(num_clauses); }
+#endif
+    vtbl_map(const vtbl_count_t& num_clauses) : used(0) { init(num_clauses); }
+
+    /// Main function that will be used to get a reference to the stored element. 
+    inline T& get(const intptr_t (&vtbl)[N]) noexcept
+    {
+        intptr_t vtbl_shifted[N];
+
+        for (size_t i = 0; i < N; ++i)
+            vtbl_shifted[i] = vtbl[i] >> irrelevant_bits;
+
+        size_t j = size_t(interleave(vtbl_shifted)) & cache_mask;
+
+        for (size_t k = 0; k < size_t(policy::probes); ++k, j = (j+1) & cache_mask)
+        {
+            stored_type& e = cache[j];
+
+            if (XTL_LIKELY(e.is_for(vtbl)))
+                return e.value;
+
+            if (e.vacant())
+            {
+                e = vtbl;
+                ++used;
+                return e.value;
+            }
+        }
+
+        // No room: the Match statement will run its case clauses sequentially
+        overflow = T();
+        return overflow;
+    }
+
+    // Lookups by subjects are inherited from vtbl_map_subjects
+    using vtbl_map_subjects<vtbl_map<N,T,policy>,T>::get;
+    using vtbl_map_subjects<vtbl_map<N,T,policy>,T>::xtl_get;
+
+    /// Looks up values associated with dynamic types of n subjects. 
+    /// \note Pointers to the value of tuples that didn't fit are only valid 
+    ///       until the next lookup. \see vtbl_map::get_batch
+    template <typename S>
+    void get_batch(const S* const* subjects, size_t n, T** out) noexcept
+    {
+        for (size_t i = 0; i < n; ++i)
+            out[i] = &get(subjects[i]);
+    }
+
+    /// Issues prefetches for subjects beyond the batch get_batch() is about 
+    /// to look up. \see vtbl_map::prefetch_batch
+    template <typename S>
+    void prefetch_batch(const S* const* subjects, size_t n) const noexcept
+    {
+        for (size_t j = XTL_BATCH_SIZE; j < n && j < 2*XTL_BATCH_SIZE; ++j)
+            XTL_PREFETCH(&cache[size_t(vtbl_of(subjects[j]) >> irrelevant_bits) & cache_mask]);
+
+        for (size_t j = 2*XTL_BATCH_SIZE; j < n && j < 3*XTL_BATCH_SIZE; ++j)
+            XTL_PREFETCH(subjects[j]);
+    }
+
+    /// Calls f(vtbl,value) for each tuple of vtbl pointers in the map.
+    template <typename F>
+    void for_each(F f) const
+    {
+        for (size_t i = 0; i <= size_t(cache_mask); ++i)
+            if (cache[i].occupied())
+                f(cache[i].vtbl, cache[i].value);
+    }
+
+    size_t       log_size() const { return L; }                 ///< Log of the capacity
+    bit_offset_t shift(size_t) const { return irrelevant_bits; } ///< Number of irrelevant bits of vtbl pointers
+    size_t       memory_used() const { return sizeof(*this); }  ///< Bytes reserved by the map
+    bool         is_full() const { return used > size_t(cache_mask); } ///< Whether no new tuples will fit
+
+    /// The map does not keep the site of its Match statement. \see vtbl_map::locate
+    XTL_VTBL_COUNTERS_ONLY(bool locate(const char*, size_t, const char*) { return true; })
+
+private:
+
+    vtbl_map(const vtbl_map&);            ///< No copy constructor
+    vtbl_map& operator=(const vtbl_map&); ///< No assignment operator
+
+    /// The capacity doesn't depend on the number of case clauses
+    void init(const vtbl_count_t&)
+    {
+        static_vtbl_bytes() += sizeof(*this);
+        XTL_STATIC_VTBL_REPORT_ONLY(static_vtbl_bytes_reserved<sizeof(*this)>());
+    }
+
+    stored_type cache[cache_mask+1]; ///< Entries of the map
+    T           overflow;            ///< Value returned for tuples that didn't fit
+    size_t      used;                ///< Number of occupied entries
+};
+
+//------------------------------------------------------------------------------
+
+} // of namespace mch